@@ -196,6 +196,32 @@ osThreadId osThreadCreate (const osThreadDef_t *thread_def, void *argument)
   return handle;
 }
 
+/**
+* @brief  Create a thread with statically allocated stack and add it to Active Threads and set it to state READY.
+* @param  thread_def    thread definition referenced with \ref osThread.
+* @param  argument      pointer that is passed to the thread function as start argument.
+* @param  stack_buffer  stack of thread referenced with \ref osThreadStack.
+* @retval thread ID for reference by other functions or NULL in case of error.
+* @note   Stack is not freed when thread is terminated.
+*/
+osThreadId osThreadCreateStatic (const osThreadDef_t *thread_def, void *argument, StackType_t *stack_buffer)
+{
+  TaskHandle_t handle;
+  
+  
+  if (stack_buffer == NULL) {
+    return NULL;
+  }
+  
+  if (xTaskGenericCreate((TaskFunction_t)thread_def->pthread,(const portCHAR *)thread_def->name,
+              thread_def->stacksize, argument, makeFreeRtosPriority(thread_def->tpriority),
+              &handle, stack_buffer, NULL) != pdPASS)  {
+    return NULL;
+  }
+  
+  return handle;
+}
+
 /**
 * @brief  Return the thread ID of the current running thread.
 * @retval thread ID for reference by other functions or NULL in case of error.
@@ -442,6 +442,34 @@ const osThreadDef_t os_thread_def_##name = \
 /// \note MUST REMAIN UNCHANGED: \b osThreadCreate shall be consistent in every CMSIS-RTOS.
 osThreadId osThreadCreate (const osThreadDef_t *thread_def, void *argument);
 
+/// Create a Thread Definition with statically allocated stack.
+/// \param         name          name of the thread function.
+/// \param         priority      initial priority of the thread function.
+/// \param         stacksz       stack size in words for the thread function.
+/// \note Task control block is still taken from FreeRTOS heap, FreeRTOS V8.2.1 can not allocate it statically.
+#if defined (osObjectsExternal)  // object is external
+#define osThreadStaticDef(name, thread, priority, stacksz)  \
+extern StackType_t os_thread_stack_##name[]; \
+extern const osThreadDef_t os_thread_def_##name
+#else                            // define the object
+#define osThreadStaticDef(name, thread, priority, stacksz)  \
+StackType_t os_thread_stack_##name[stacksz]; \
+const osThreadDef_t os_thread_def_##name = \
+{ #name, (thread), (priority), 1, (stacksz)  }
+#endif
+
+/// Access a Thread stack defined with \ref osThreadStaticDef.
+/// \param         name          name of the thread definition object.
+#define osThreadStack(name)  \
+os_thread_stack_##name
+
+/// Create a thread with statically allocated stack and add it to Active Threads and set it to state READY.
+/// \param[in]     thread_def    thread definition referenced with \ref osThread.
+/// \param[in]     argument      pointer that is passed to the thread function as start argument.
+/// \param[in]     stack_buffer  stack of thread referenced with \ref osThreadStack, at least stacksize words long.
+/// \return thread ID for reference by other functions or NULL in case of error.
+osThreadId osThreadCreateStatic (const osThreadDef_t *thread_def, void *argument, StackType_t *stack_buffer);
+
 /// Return the thread ID of the current running thread.
 /// \return thread ID for reference by other functions or NULL in case of error.
 /// \note MUST REMAIN UNCHANGED: \b osThreadGetId shall be consistent in every CMSIS-RTOS.
@@ -943,6 +971,157 @@ osStatus osRecursiveMutexRelease (osMutexId mutex_id);
 */
 osStatus osRecursiveMutexWait (osMutexId mutex_id, uint32_t millisec);
 
+/*************************** Fast paths ***************************************/
+/* Inline versions of the most used calls, for code where context is known at compile time.
+   There is no handler mode check and no NULL check, each function maps to one FreeRTOS call.
+   FromISR functions must be called from interrupts only and FromThread functions from threads only.
+   Return values are the same as from functions without suffix. */
+
+/**
+* @brief  Convert timeout in milliseconds to FreeRTOS ticks, folded at compile time for constant argument
+* @param  millisec  timeout value, 0 in case of no time-out or osWaitForever.
+* @retval number of ticks, at least 1 for non-zero timeout.
+*/
+__STATIC_INLINE TickType_t osFastTicks (uint32_t millisec)
+{
+  if (millisec == osWaitForever) {
+    return portMAX_DELAY;
+  }
+  if (millisec != 0 && millisec < portTICK_PERIOD_MS) {
+    return 1;
+  }
+  return millisec / portTICK_PERIOD_MS;
+}
+
+#if INCLUDE_vTaskDelay
+/**
+* @brief  Wait for Timeout (Time Delay) from thread
+* @param  millisec  time delay value
+* @retval osOK.
+*/
+__STATIC_INLINE osStatus osDelayFromThread (uint32_t millisec)
+{
+  TickType_t ticks = millisec / portTICK_PERIOD_MS;
+  
+  vTaskDelay(ticks ? ticks : 1);          /* Minimum delay = 1 tick */
+  
+  return osOK;
+}
+#endif
+
+/**
+* @brief  Set the specified Signal Flags of an active thread from interrupt
+* @param  thread_id  thread ID obtained by \ref osThreadCreate or \ref osThreadGetId.
+* @param  signal     specifies the signal flags of the thread that should be set.
+* @retval osOK if successful, osErrorOS if failed.
+*/
+__STATIC_INLINE int32_t osSignalSetFromISR (osThreadId thread_id, int32_t signal)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  
+  if (xTaskNotifyFromISR(thread_id, (uint32_t)signal, eSetBits, &xHigherPriorityTaskWoken) != pdPASS) {
+    return osErrorOS;
+  }
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  
+  return osOK;
+}
+
+/**
+* @brief  Set the specified Signal Flags of an active thread from thread
+* @param  thread_id  thread ID obtained by \ref osThreadCreate or \ref osThreadGetId.
+* @param  signal     specifies the signal flags of the thread that should be set.
+* @retval osOK if successful, osErrorOS if failed.
+*/
+__STATIC_INLINE int32_t osSignalSetFromThread (osThreadId thread_id, int32_t signal)
+{
+  if (xTaskNotify(thread_id, (uint32_t)signal, eSetBits) != pdPASS) {
+    return osErrorOS;
+  }
+  
+  return osOK;
+}
+
+/**
+* @brief  Put a Message to a Queue from interrupt
+* @param  queue_id  message queue ID obtained with \ref osMessageCreate.
+* @param  info      message information.
+* @retval osOK if successful, osErrorOS if queue is full.
+*/
+__STATIC_INLINE osStatus osMessagePutFromISR (osMessageQId queue_id, uint32_t info)
+{
+  portBASE_TYPE taskWoken = pdFALSE;
+  
+  if (xQueueSendFromISR(queue_id, &info, &taskWoken) != pdTRUE) {
+    return osErrorOS;
+  }
+  portEND_SWITCHING_ISR(taskWoken);
+  
+  return osOK;
+}
+
+/**
+* @brief  Put a Message to a Queue from thread
+* @param  queue_id  message queue ID obtained with \ref osMessageCreate.
+* @param  info      message information.
+* @param  millisec  timeout value or 0 in case of no time-out.
+* @retval osOK if successful, osErrorOS if failed.
+*/
+__STATIC_INLINE osStatus osMessagePutFromThread (osMessageQId queue_id, uint32_t info, uint32_t millisec)
+{
+  if (xQueueSend(queue_id, &info, osFastTicks(millisec)) != pdTRUE) {
+    return osErrorOS;
+  }
+  
+  return osOK;
+}
+
+/**
+* @brief  Wait until a Semaphore token becomes available, from thread
+* @param  semaphore_id  semaphore object referenced with \ref osSemaphore.
+* @param  millisec      timeout value or 0 in case of no time-out.
+* @retval osOK if token was taken, osErrorOS if failed.
+*/
+__STATIC_INLINE int32_t osSemaphoreWaitFromThread (osSemaphoreId semaphore_id, uint32_t millisec)
+{
+  if (xSemaphoreTake(semaphore_id, osFastTicks(millisec)) != pdTRUE) {
+    return osErrorOS;
+  }
+  
+  return osOK;
+}
+
+/**
+* @brief  Release a Semaphore token from interrupt
+* @param  semaphore_id  semaphore object referenced with \ref osSemaphore.
+* @retval osOK if successful, osErrorOS if failed.
+*/
+__STATIC_INLINE osStatus osSemaphoreReleaseFromISR (osSemaphoreId semaphore_id)
+{
+  portBASE_TYPE taskWoken = pdFALSE;
+  
+  if (xSemaphoreGiveFromISR(semaphore_id, &taskWoken) != pdTRUE) {
+    return osErrorOS;
+  }
+  portEND_SWITCHING_ISR(taskWoken);
+  
+  return osOK;
+}
+
+/**
+* @brief  Release a Semaphore token from thread
+* @param  semaphore_id  semaphore object referenced with \ref osSemaphore.
+* @retval osOK if successful, osErrorOS if failed.
+*/
+__STATIC_INLINE osStatus osSemaphoreReleaseFromThread (osSemaphoreId semaphore_id)
+{
+  if (xSemaphoreGive(semaphore_id) != pdTRUE) {
+    return osErrorOS;
+  }
+  
+  return osOK;
+}
+
 #ifdef  __cplusplus
 }
 #endif
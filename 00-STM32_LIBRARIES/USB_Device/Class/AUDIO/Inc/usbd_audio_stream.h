@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file    usbd_audio_stream.h
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   header file for the usbd_audio_stream.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_AUDIO_STREAM_H
+#define __USB_AUDIO_STREAM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_audio_stream
+  * @brief This file is the Header file for usbd_audio_stream.c
+  * @{
+  */
+
+
+/** @defgroup usbd_audio_stream_Exported_Defines
+  * @{
+  */
+/* Sampling frequency for both directions */
+#ifndef USBD_AUDIO_STREAM_FREQ
+#define USBD_AUDIO_STREAM_FREQ              48000
+#endif
+
+/* Microphone function, device to host */
+#ifndef USBD_AUDIO_STREAM_USE_MIC
+#define USBD_AUDIO_STREAM_USE_MIC           1
+#endif
+#ifndef USBD_AUDIO_STREAM_MIC_CHANNELS
+#define USBD_AUDIO_STREAM_MIC_CHANNELS      1
+#endif
+
+/* Speaker function, host to device */
+#ifndef USBD_AUDIO_STREAM_USE_SPK
+#define USBD_AUDIO_STREAM_USE_SPK           1
+#endif
+#ifndef USBD_AUDIO_STREAM_SPK_CHANNELS
+#define USBD_AUDIO_STREAM_SPK_CHANNELS      1
+#endif
+
+/* Feedback is sent every 2^USBD_AUDIO_STREAM_FB_REFRESH frames, 1 to 9 */
+#ifndef USBD_AUDIO_STREAM_FB_REFRESH
+#define USBD_AUDIO_STREAM_FB_REFRESH        5
+#endif
+
+/* Endpoints, microphone data, speaker data and speaker feedback */
+#define AUDIO_STREAM_MIC_EP                 0x81
+#define AUDIO_STREAM_SPK_EP                 0x01
+#define AUDIO_STREAM_FB_EP                  0x82
+
+/* Samples in one frame, packets carry one more sample when clocks drift */
+#define AUDIO_STREAM_FRAME_SAMPLES          ((USBD_AUDIO_STREAM_FREQ + 999) / 1000)
+#define AUDIO_STREAM_MIC_PACKET             ((AUDIO_STREAM_FRAME_SAMPLES + 1) * USBD_AUDIO_STREAM_MIC_CHANNELS * 2)
+#define AUDIO_STREAM_SPK_PACKET             ((AUDIO_STREAM_FRAME_SAMPLES + 1) * USBD_AUDIO_STREAM_SPK_CHANNELS * 2)
+#define AUDIO_STREAM_FB_PACKET              3
+
+/* Interface numbers */
+#define AUDIO_STREAM_AC_ITF                 0x00
+#define AUDIO_STREAM_MIC_ITF                0x01
+#define AUDIO_STREAM_SPK_ITF                (0x01 + USBD_AUDIO_STREAM_USE_MIC)
+#define AUDIO_STREAM_NUM_ITF                (0x01 + USBD_AUDIO_STREAM_USE_MIC + USBD_AUDIO_STREAM_USE_SPK)
+
+/* Descriptor sizes, audio control header has one byte per streaming interface */
+#define AUDIO_STREAM_AC_DESC_SIZ            (8 + USBD_AUDIO_STREAM_USE_MIC * 22 + USBD_AUDIO_STREAM_USE_SPK * 22)
+#define USB_AUDIO_STREAM_CONFIG_DESC_SIZ    (9 + 9 + AUDIO_STREAM_AC_DESC_SIZ + USBD_AUDIO_STREAM_USE_MIC * 52 + USBD_AUDIO_STREAM_USE_SPK * 61)
+
+/* Check settings */
+#if !USBD_AUDIO_STREAM_USE_MIC && !USBD_AUDIO_STREAM_USE_SPK
+#error "At least one audio function must be enabled!"
+#endif
+#if USBD_AUDIO_STREAM_MIC_CHANNELS < 1 || USBD_AUDIO_STREAM_MIC_CHANNELS > 2 || USBD_AUDIO_STREAM_SPK_CHANNELS < 1 || USBD_AUDIO_STREAM_SPK_CHANNELS > 2
+#error "Audio stream supports 1 or 2 channels!"
+#endif
+#if AUDIO_STREAM_NUM_ITF > USBD_MAX_NUM_INTERFACES
+#error "USBD_MAX_NUM_INTERFACES is too small for audio stream interfaces!"
+#endif
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/* Interface callbacks, called from USB interrupt */
+typedef struct {
+  int8_t   (*Init)        (void);
+  int8_t   (*DeInit)      (void);
+  int8_t   (*MicStart)    (void);                               /* Host selected microphone streaming */
+  int8_t   (*MicStop)     (void);                               /* Host stopped microphone streaming */
+  uint16_t (*MicPacket)   (uint8_t *pbuf, uint16_t max_len);    /* Fill next packet, return length in bytes */
+  int8_t   (*SpkStart)    (void);                               /* Host selected speaker streaming */
+  int8_t   (*SpkStop)     (void);                               /* Host stopped speaker streaming */
+  void     (*SpkPacket)   (uint8_t *pbuf, uint16_t len);        /* Packet received from host */
+  uint32_t (*SpkFeedback) (void);                               /* Samples per frame in 10.14 format */
+} USBD_AUDIO_STREAM_ItfTypeDef;
+
+/* Class data for one USB device */
+typedef struct {
+  uint8_t mic_alt;                                              /* Microphone alternate setting */
+  uint8_t spk_alt;                                              /* Speaker alternate setting */
+  __IO uint8_t mic_busy;                                        /* Microphone packet is in transfer */
+  __IO uint8_t fb_busy;                                         /* Feedback packet is in transfer */
+  uint16_t fb_count;                                            /* Frames since last feedback */
+  uint8_t mic_buf[AUDIO_STREAM_MIC_PACKET];                     /* Microphone packet */
+  uint8_t spk_buf[AUDIO_STREAM_SPK_PACKET];                     /* Speaker packet */
+  uint8_t fb_buf[4];                                            /* Feedback value */
+  uint8_t ctrl_buf[8];                                          /* Class requests data */
+} USBD_AUDIO_STREAM_HandleTypeDef;
+
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_AUDIO_STREAM;
+#define USBD_AUDIO_STREAM_CLASS    &USBD_AUDIO_STREAM
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_AUDIO_STREAM_RegisterInterface (USBD_HandleTypeDef   *pdev,
+                                              USBD_AUDIO_STREAM_ItfTypeDef *fops);
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_AUDIO_STREAM_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,778 @@
+/**
+  ******************************************************************************
+  * @file    usbd_audio_stream.c
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   This file provides USB Audio 1.0 device with isochronous streaming:
+  *           - Microphone function on isochronous IN endpoint
+  *           - Speaker function on isochronous OUT endpoint with feedback endpoint
+  *           - Packets are scheduled on start of frame
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                           Audio Stream Class Driver Description
+  *          ===================================================================
+  *           Interface 0 is audio control interface without controls.
+  *           Microphone interface (EP 0x81) and speaker interface (EP 0x01, feedback EP 0x82)
+  *           have zero bandwidth alternate setting 0 and streaming alternate setting 1.
+  *
+  *           Both directions are asynchronous, sample clock is generated by device.
+  *           Microphone packets carry as many samples as were sampled since last frame,
+  *           speaker rate is adapted by host from value on feedback endpoint.
+  *
+  *           Data are 16-bit PCM, format conversion and buffering is done by interface.
+  *           Full speed only, 10.14 feedback format.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_audio_stream.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_AUDIO_STREAM
+  * @brief usbd core module
+  * @{
+  */
+
+/** @defgroup USBD_AUDIO_STREAM_Private_Defines
+  * @{
+  */
+#define AUDIO_STREAM_DESCRIPTOR_TYPE        0x24
+#define AUDIO_STREAM_ENDPOINT_TYPE          0x25
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_AUDIO_STREAM_Private_Macros
+  * @{
+  */
+
+/* Get handle for device */
+#define USBD_AUDIO_STREAM_HANDLE(pdev)      (&USBD_AUDIO_STREAM_Handle[(pdev)->id == 0 ? 0 : 1])
+
+/* Descriptor helpers */
+#define AUDIO_STREAM_FREQ_BYTES(frq)        (uint8_t)(frq), (uint8_t)((frq) >> 8), (uint8_t)((frq) >> 16)
+#define AUDIO_STREAM_CONFIG(ch)             ((ch) == 2 ? 0x03 : 0x00)
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_AUDIO_STREAM_Private_FunctionPrototypes
+  * @{
+  */
+
+static uint8_t  USBD_AUDIO_STREAM_Init (USBD_HandleTypeDef *pdev,
+                                        uint8_t cfgidx);
+
+static uint8_t  USBD_AUDIO_STREAM_DeInit (USBD_HandleTypeDef *pdev,
+                                          uint8_t cfgidx);
+
+static uint8_t  USBD_AUDIO_STREAM_Setup (USBD_HandleTypeDef *pdev,
+                                         USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_AUDIO_STREAM_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_AUDIO_STREAM_DataIn (USBD_HandleTypeDef *pdev,
+                                          uint8_t epnum);
+
+static uint8_t  USBD_AUDIO_STREAM_DataOut (USBD_HandleTypeDef *pdev,
+                                           uint8_t epnum);
+
+static uint8_t  USBD_AUDIO_STREAM_SOF (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_AUDIO_STREAM_IsoINIncomplete (USBD_HandleTypeDef *pdev,
+                                                   uint8_t epnum);
+
+static uint8_t  USBD_AUDIO_STREAM_IsoOUTIncomplete (USBD_HandleTypeDef *pdev,
+                                                    uint8_t epnum);
+
+static uint8_t  *USBD_AUDIO_STREAM_GetCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_AUDIO_STREAM_GetDeviceQualifierDescriptor (uint16_t *length);
+
+static void     USBD_AUDIO_STREAM_SetInterface (USBD_HandleTypeDef *pdev,
+                                                uint8_t itf, uint8_t alt);
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_STREAM_Private_Variables
+  * @{
+  */
+
+/* Class data for FS and HS device */
+static USBD_AUDIO_STREAM_HandleTypeDef USBD_AUDIO_STREAM_Handle[2];
+
+/* Audio stream interface class callbacks structure */
+USBD_ClassTypeDef  USBD_AUDIO_STREAM =
+{
+  USBD_AUDIO_STREAM_Init,
+  USBD_AUDIO_STREAM_DeInit,
+  USBD_AUDIO_STREAM_Setup,
+  NULL,                 /* EP0_TxSent, */
+  USBD_AUDIO_STREAM_EP0_RxReady,
+  USBD_AUDIO_STREAM_DataIn,
+  USBD_AUDIO_STREAM_DataOut,
+  USBD_AUDIO_STREAM_SOF,
+  USBD_AUDIO_STREAM_IsoINIncomplete,
+  USBD_AUDIO_STREAM_IsoOUTIncomplete,
+  USBD_AUDIO_STREAM_GetCfgDesc,
+  USBD_AUDIO_STREAM_GetCfgDesc,
+  USBD_AUDIO_STREAM_GetCfgDesc,
+  USBD_AUDIO_STREAM_GetDeviceQualifierDescriptor,
+};
+
+/* USB Standard Device Qualifier Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_AUDIO_STREAM_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+  USB_LEN_DEV_QUALIFIER_DESC,
+  USB_DESC_TYPE_DEVICE_QUALIFIER,
+  0x00,
+  0x02,
+  0x00,
+  0x00,
+  0x00,
+  0x40,
+  0x01,
+  0x00,
+};
+
+/* Configuration descriptor, full speed */
+__ALIGN_BEGIN static uint8_t USBD_AUDIO_STREAM_CfgDesc[USB_AUDIO_STREAM_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  /* Configuration Descriptor */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_CONFIGURATION,          /* bDescriptorType */
+  LOBYTE(USB_AUDIO_STREAM_CONFIG_DESC_SIZ), /* wTotalLength */
+  HIBYTE(USB_AUDIO_STREAM_CONFIG_DESC_SIZ),
+  AUDIO_STREAM_NUM_ITF,                 /* bNumInterfaces */
+  0x01,                                 /* bConfigurationValue */
+  0x00,                                 /* iConfiguration */
+  0xC0,                                 /* bmAttributes: self powered */
+  0x32,                                 /* bMaxPower 100 mA */
+
+  /* Audio control standard interface */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_INTERFACE,              /* bDescriptorType */
+  AUDIO_STREAM_AC_ITF,                  /* bInterfaceNumber */
+  0x00,                                 /* bAlternateSetting */
+  0x00,                                 /* bNumEndpoints */
+  0x01,                                 /* bInterfaceClass: Audio */
+  0x01,                                 /* bInterfaceSubClass: Audio control */
+  0x00,                                 /* bInterfaceProtocol */
+  0x00,                                 /* iInterface */
+
+  /* Audio control header */
+  0x08 + USBD_AUDIO_STREAM_USE_MIC + USBD_AUDIO_STREAM_USE_SPK, /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType: CS_INTERFACE */
+  0x01,                                 /* bDescriptorSubtype: Header */
+  0x00,                                 /* bcdADC 1.00 */
+  0x01,
+  LOBYTE(AUDIO_STREAM_AC_DESC_SIZ),     /* wTotalLength */
+  HIBYTE(AUDIO_STREAM_AC_DESC_SIZ),
+  USBD_AUDIO_STREAM_USE_MIC + USBD_AUDIO_STREAM_USE_SPK, /* bInCollection */
+#if USBD_AUDIO_STREAM_USE_MIC
+  AUDIO_STREAM_MIC_ITF,                 /* baInterfaceNr */
+#endif
+#if USBD_AUDIO_STREAM_USE_SPK
+  AUDIO_STREAM_SPK_ITF,                 /* baInterfaceNr */
+#endif
+
+#if USBD_AUDIO_STREAM_USE_MIC
+  /* Microphone input terminal, ID 1 */
+  0x0C,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x02,                                 /* bDescriptorSubtype: Input terminal */
+  0x01,                                 /* bTerminalID */
+  0x01,                                 /* wTerminalType: Microphone 0x0201 */
+  0x02,
+  0x00,                                 /* bAssocTerminal */
+  USBD_AUDIO_STREAM_MIC_CHANNELS,       /* bNrChannels */
+  AUDIO_STREAM_CONFIG(USBD_AUDIO_STREAM_MIC_CHANNELS), /* wChannelConfig */
+  0x00,
+  0x00,                                 /* iChannelNames */
+  0x00,                                 /* iTerminal */
+
+  /* USB streaming output terminal, ID 2 */
+  0x09,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x03,                                 /* bDescriptorSubtype: Output terminal */
+  0x02,                                 /* bTerminalID */
+  0x01,                                 /* wTerminalType: USB streaming 0x0101 */
+  0x01,
+  0x00,                                 /* bAssocTerminal */
+  0x01,                                 /* bSourceID */
+  0x00,                                 /* iTerminal */
+#endif
+
+#if USBD_AUDIO_STREAM_USE_SPK
+  /* USB streaming input terminal, ID 3 */
+  0x0C,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x02,                                 /* bDescriptorSubtype: Input terminal */
+  0x03,                                 /* bTerminalID */
+  0x01,                                 /* wTerminalType: USB streaming 0x0101 */
+  0x01,
+  0x00,                                 /* bAssocTerminal */
+  USBD_AUDIO_STREAM_SPK_CHANNELS,       /* bNrChannels */
+  AUDIO_STREAM_CONFIG(USBD_AUDIO_STREAM_SPK_CHANNELS), /* wChannelConfig */
+  0x00,
+  0x00,                                 /* iChannelNames */
+  0x00,                                 /* iTerminal */
+
+  /* Speaker output terminal, ID 4 */
+  0x09,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x03,                                 /* bDescriptorSubtype: Output terminal */
+  0x04,                                 /* bTerminalID */
+  0x01,                                 /* wTerminalType: Speaker 0x0301 */
+  0x03,
+  0x00,                                 /* bAssocTerminal */
+  0x03,                                 /* bSourceID */
+  0x00,                                 /* iTerminal */
+#endif
+
+#if USBD_AUDIO_STREAM_USE_MIC
+  /* Microphone streaming interface, alternate setting 0, zero bandwidth */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_INTERFACE,              /* bDescriptorType */
+  AUDIO_STREAM_MIC_ITF,                 /* bInterfaceNumber */
+  0x00,                                 /* bAlternateSetting */
+  0x00,                                 /* bNumEndpoints */
+  0x01,                                 /* bInterfaceClass: Audio */
+  0x02,                                 /* bInterfaceSubClass: Audio streaming */
+  0x00,                                 /* bInterfaceProtocol */
+  0x00,                                 /* iInterface */
+
+  /* Microphone streaming interface, alternate setting 1, operational */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_INTERFACE,              /* bDescriptorType */
+  AUDIO_STREAM_MIC_ITF,                 /* bInterfaceNumber */
+  0x01,                                 /* bAlternateSetting */
+  0x01,                                 /* bNumEndpoints */
+  0x01,                                 /* bInterfaceClass: Audio */
+  0x02,                                 /* bInterfaceSubClass: Audio streaming */
+  0x00,                                 /* bInterfaceProtocol */
+  0x00,                                 /* iInterface */
+
+  /* Audio streaming general */
+  0x07,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x01,                                 /* bDescriptorSubtype: General */
+  0x02,                                 /* bTerminalLink: USB streaming output terminal */
+  0x01,                                 /* bDelay */
+  0x01,                                 /* wFormatTag: PCM */
+  0x00,
+
+  /* Type I format */
+  0x0B,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x02,                                 /* bDescriptorSubtype: Format type */
+  0x01,                                 /* bFormatType: Type I */
+  USBD_AUDIO_STREAM_MIC_CHANNELS,       /* bNrChannels */
+  0x02,                                 /* bSubFrameSize: 2 bytes */
+  16,                                   /* bBitResolution */
+  0x01,                                 /* bSamFreqType: one frequency */
+  AUDIO_STREAM_FREQ_BYTES(USBD_AUDIO_STREAM_FREQ),
+
+  /* Isochronous IN endpoint, asynchronous */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_ENDPOINT,               /* bDescriptorType */
+  AUDIO_STREAM_MIC_EP,                  /* bEndpointAddress */
+  0x05,                                 /* bmAttributes: Isochronous, asynchronous */
+  LOBYTE(AUDIO_STREAM_MIC_PACKET),      /* wMaxPacketSize */
+  HIBYTE(AUDIO_STREAM_MIC_PACKET),
+  0x01,                                 /* bInterval: 1 ms */
+  0x00,                                 /* bRefresh */
+  0x00,                                 /* bSynchAddress */
+
+  /* Audio streaming endpoint */
+  0x07,                                 /* bLength */
+  AUDIO_STREAM_ENDPOINT_TYPE,           /* bDescriptorType: CS_ENDPOINT */
+  0x01,                                 /* bDescriptorSubtype: General */
+  0x00,                                 /* bmAttributes */
+  0x00,                                 /* bLockDelayUnits */
+  0x00,                                 /* wLockDelay */
+  0x00,
+#endif
+
+#if USBD_AUDIO_STREAM_USE_SPK
+  /* Speaker streaming interface, alternate setting 0, zero bandwidth */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_INTERFACE,              /* bDescriptorType */
+  AUDIO_STREAM_SPK_ITF,                 /* bInterfaceNumber */
+  0x00,                                 /* bAlternateSetting */
+  0x00,                                 /* bNumEndpoints */
+  0x01,                                 /* bInterfaceClass: Audio */
+  0x02,                                 /* bInterfaceSubClass: Audio streaming */
+  0x00,                                 /* bInterfaceProtocol */
+  0x00,                                 /* iInterface */
+
+  /* Speaker streaming interface, alternate setting 1, operational */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_INTERFACE,              /* bDescriptorType */
+  AUDIO_STREAM_SPK_ITF,                 /* bInterfaceNumber */
+  0x01,                                 /* bAlternateSetting */
+  0x02,                                 /* bNumEndpoints: data and feedback */
+  0x01,                                 /* bInterfaceClass: Audio */
+  0x02,                                 /* bInterfaceSubClass: Audio streaming */
+  0x00,                                 /* bInterfaceProtocol */
+  0x00,                                 /* iInterface */
+
+  /* Audio streaming general */
+  0x07,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x01,                                 /* bDescriptorSubtype: General */
+  0x03,                                 /* bTerminalLink: USB streaming input terminal */
+  0x01,                                 /* bDelay */
+  0x01,                                 /* wFormatTag: PCM */
+  0x00,
+
+  /* Type I format */
+  0x0B,                                 /* bLength */
+  AUDIO_STREAM_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  0x02,                                 /* bDescriptorSubtype: Format type */
+  0x01,                                 /* bFormatType: Type I */
+  USBD_AUDIO_STREAM_SPK_CHANNELS,       /* bNrChannels */
+  0x02,                                 /* bSubFrameSize: 2 bytes */
+  16,                                   /* bBitResolution */
+  0x01,                                 /* bSamFreqType: one frequency */
+  AUDIO_STREAM_FREQ_BYTES(USBD_AUDIO_STREAM_FREQ),
+
+  /* Isochronous OUT endpoint, asynchronous with feedback */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_ENDPOINT,               /* bDescriptorType */
+  AUDIO_STREAM_SPK_EP,                  /* bEndpointAddress */
+  0x05,                                 /* bmAttributes: Isochronous, asynchronous */
+  LOBYTE(AUDIO_STREAM_SPK_PACKET),      /* wMaxPacketSize */
+  HIBYTE(AUDIO_STREAM_SPK_PACKET),
+  0x01,                                 /* bInterval: 1 ms */
+  0x00,                                 /* bRefresh */
+  AUDIO_STREAM_FB_EP,                   /* bSynchAddress: feedback endpoint */
+
+  /* Audio streaming endpoint */
+  0x07,                                 /* bLength */
+  AUDIO_STREAM_ENDPOINT_TYPE,           /* bDescriptorType: CS_ENDPOINT */
+  0x01,                                 /* bDescriptorSubtype: General */
+  0x00,                                 /* bmAttributes */
+  0x00,                                 /* bLockDelayUnits */
+  0x00,                                 /* wLockDelay */
+  0x00,
+
+  /* Isochronous feedback IN endpoint */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_ENDPOINT,               /* bDescriptorType */
+  AUDIO_STREAM_FB_EP,                   /* bEndpointAddress */
+  0x11,                                 /* bmAttributes: Isochronous, feedback */
+  AUDIO_STREAM_FB_PACKET,               /* wMaxPacketSize */
+  0x00,
+  0x01,                                 /* bInterval: 1 ms */
+  USBD_AUDIO_STREAM_FB_REFRESH,         /* bRefresh */
+  0x00,                                 /* bSynchAddress */
+#endif
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_AUDIO_STREAM_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_AUDIO_STREAM_Init
+  *         Initialize the audio stream interfaces
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_Init (USBD_HandleTypeDef *pdev,
+                                        uint8_t cfgidx)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = USBD_AUDIO_STREAM_HANDLE(pdev);
+
+  memset(haudio, 0, sizeof(USBD_AUDIO_STREAM_HandleTypeDef));
+  pdev->pClassData = haudio;
+
+#if USBD_AUDIO_STREAM_USE_MIC
+  USBD_LL_OpenEP(pdev, AUDIO_STREAM_MIC_EP, USBD_EP_TYPE_ISOC, AUDIO_STREAM_MIC_PACKET);
+#endif
+#if USBD_AUDIO_STREAM_USE_SPK
+  USBD_LL_OpenEP(pdev, AUDIO_STREAM_SPK_EP, USBD_EP_TYPE_ISOC, AUDIO_STREAM_SPK_PACKET);
+  USBD_LL_OpenEP(pdev, AUDIO_STREAM_FB_EP, USBD_EP_TYPE_ISOC, AUDIO_STREAM_FB_PACKET);
+#endif
+
+  /* Packets are scheduled on start of frame, SOF interrupt is disabled by default */
+  ((PCD_HandleTypeDef *)pdev->pData)->Instance->GINTMSK |= USB_OTG_GINTMSK_SOFM;
+
+  if (((USBD_AUDIO_STREAM_ItfTypeDef *)pdev->pUserData)->Init() != 0)
+  {
+    return USBD_FAIL;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_DeInit
+  *         DeInitialize the audio stream interfaces
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_DeInit (USBD_HandleTypeDef *pdev,
+                                          uint8_t cfgidx)
+{
+  if (pdev->pClassData != NULL)
+  {
+    /* Stop streaming */
+#if USBD_AUDIO_STREAM_USE_MIC
+    USBD_AUDIO_STREAM_SetInterface(pdev, AUDIO_STREAM_MIC_ITF, 0);
+    USBD_LL_CloseEP(pdev, AUDIO_STREAM_MIC_EP);
+#endif
+#if USBD_AUDIO_STREAM_USE_SPK
+    USBD_AUDIO_STREAM_SetInterface(pdev, AUDIO_STREAM_SPK_ITF, 0);
+    USBD_LL_CloseEP(pdev, AUDIO_STREAM_SPK_EP);
+    USBD_LL_CloseEP(pdev, AUDIO_STREAM_FB_EP);
+#endif
+
+    ((USBD_AUDIO_STREAM_ItfTypeDef *)pdev->pUserData)->DeInit();
+    pdev->pClassData = NULL;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_SetInterface
+  *         Start or stop streaming on alternate setting change
+  * @param  pdev: device instance
+  * @param  itf: interface number
+  * @param  alt: alternate setting
+  * @retval None
+  */
+static void     USBD_AUDIO_STREAM_SetInterface (USBD_HandleTypeDef *pdev,
+                                                uint8_t itf, uint8_t alt)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+  USBD_AUDIO_STREAM_ItfTypeDef *fops = (USBD_AUDIO_STREAM_ItfTypeDef *)pdev->pUserData;
+
+#if USBD_AUDIO_STREAM_USE_MIC
+  if (itf == AUDIO_STREAM_MIC_ITF && alt != haudio->mic_alt)
+  {
+    haudio->mic_alt = alt;
+    if (alt)
+    {
+      haudio->mic_busy = 0;
+      fops->MicStart();
+    }
+    else
+    {
+      fops->MicStop();
+      USBD_LL_FlushEP(pdev, AUDIO_STREAM_MIC_EP);
+    }
+  }
+#endif
+
+#if USBD_AUDIO_STREAM_USE_SPK
+  if (itf == AUDIO_STREAM_SPK_ITF && alt != haudio->spk_alt)
+  {
+    haudio->spk_alt = alt;
+    if (alt)
+    {
+      haudio->fb_busy = 0;
+      haudio->fb_count = 0;
+      fops->SpkStart();
+
+      /* Prepare OUT endpoint to receive first packet */
+      USBD_LL_PrepareReceive(pdev, AUDIO_STREAM_SPK_EP, haudio->spk_buf, AUDIO_STREAM_SPK_PACKET);
+    }
+    else
+    {
+      fops->SpkStop();
+      USBD_LL_FlushEP(pdev, AUDIO_STREAM_SPK_EP);
+      USBD_LL_FlushEP(pdev, AUDIO_STREAM_FB_EP);
+    }
+  }
+#endif
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_Setup
+  *         Handle the audio specific requests
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_Setup (USBD_HandleTypeDef *pdev,
+                                         USBD_SetupReqTypedef *req)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+  uint16_t len = MIN(req->wLength, sizeof(haudio->ctrl_buf));
+  uint8_t itf = LOBYTE(req->wIndex);
+  uint8_t alt = 0;
+
+  switch (req->bmRequest & USB_REQ_TYPE_MASK)
+  {
+  case USB_REQ_TYPE_CLASS :
+    /* No controls, requests (sampling frequency for example) are accepted and ignored */
+    if (req->bmRequest & 0x80)
+    {
+      memset(haudio->ctrl_buf, 0, sizeof(haudio->ctrl_buf));
+      USBD_CtlSendData(pdev, haudio->ctrl_buf, len);
+    }
+    else if (len)
+    {
+      USBD_CtlPrepareRx(pdev, haudio->ctrl_buf, len);
+    }
+    break;
+
+  case USB_REQ_TYPE_STANDARD:
+    switch (req->bRequest)
+    {
+    case USB_REQ_GET_INTERFACE :
+#if USBD_AUDIO_STREAM_USE_MIC
+      if (itf == AUDIO_STREAM_MIC_ITF)
+      {
+        alt = haudio->mic_alt;
+      }
+#endif
+#if USBD_AUDIO_STREAM_USE_SPK
+      if (itf == AUDIO_STREAM_SPK_ITF)
+      {
+        alt = haudio->spk_alt;
+      }
+#endif
+      haudio->ctrl_buf[0] = alt;
+      USBD_CtlSendData(pdev, haudio->ctrl_buf, 1);
+      break;
+
+    case USB_REQ_SET_INTERFACE :
+      if (itf < AUDIO_STREAM_NUM_ITF && (uint8_t)(req->wValue) <= 1)
+      {
+        USBD_AUDIO_STREAM_SetInterface(pdev, itf, (uint8_t)(req->wValue));
+      }
+      else
+      {
+        USBD_CtlError(pdev, req);
+        return USBD_FAIL;
+      }
+      break;
+
+    default:
+      USBD_CtlError(pdev, req);
+      return USBD_FAIL;
+    }
+    break;
+
+  default:
+    break;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_EP0_RxReady
+  *         Data of class request received, nothing to do
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_DataIn
+  *         Microphone or feedback packet sent
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_DataIn (USBD_HandleTypeDef *pdev,
+                                          uint8_t epnum)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+
+  if (epnum == (AUDIO_STREAM_MIC_EP & 0x7F))
+  {
+    haudio->mic_busy = 0;
+  }
+  else if (epnum == (AUDIO_STREAM_FB_EP & 0x7F))
+  {
+    haudio->fb_busy = 0;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_DataOut
+  *         Speaker packet received
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_DataOut (USBD_HandleTypeDef *pdev,
+                                           uint8_t epnum)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+
+  if (epnum == AUDIO_STREAM_SPK_EP && haudio->spk_alt)
+  {
+    ((USBD_AUDIO_STREAM_ItfTypeDef *)pdev->pUserData)->SpkPacket(haudio->spk_buf, USBD_LL_GetRxDataSize(pdev, epnum));
+
+    /* Prepare OUT endpoint to receive next packet */
+    USBD_LL_PrepareReceive(pdev, AUDIO_STREAM_SPK_EP, haudio->spk_buf, AUDIO_STREAM_SPK_PACKET);
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_SOF
+  *         Schedule microphone and feedback packets for next frame
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_SOF (USBD_HandleTypeDef *pdev)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+  USBD_AUDIO_STREAM_ItfTypeDef *fops = (USBD_AUDIO_STREAM_ItfTypeDef *)pdev->pUserData;
+  uint32_t fb;
+
+  if (haudio == NULL)
+  {
+    return USBD_OK;
+  }
+
+  /* Samples collected since last frame */
+  if (haudio->mic_alt && !haudio->mic_busy)
+  {
+    haudio->mic_busy = 1;
+    USBD_LL_Transmit(pdev, AUDIO_STREAM_MIC_EP, haudio->mic_buf, fops->MicPacket(haudio->mic_buf, AUDIO_STREAM_MIC_PACKET));
+  }
+
+  /* Feedback value every 2^bRefresh frames */
+  if (haudio->spk_alt && ++haudio->fb_count >= (1 << USBD_AUDIO_STREAM_FB_REFRESH) && !haudio->fb_busy)
+  {
+    haudio->fb_count = 0;
+    fb = fops->SpkFeedback();
+    haudio->fb_buf[0] = (uint8_t)(fb);
+    haudio->fb_buf[1] = (uint8_t)(fb >> 8);
+    haudio->fb_buf[2] = (uint8_t)(fb >> 16);
+    haudio->fb_busy = 1;
+    USBD_LL_Transmit(pdev, AUDIO_STREAM_FB_EP, haudio->fb_buf, AUDIO_STREAM_FB_PACKET);
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_IsoINIncomplete
+  *         Packet was not read by host in its frame, drop it
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_IsoINIncomplete (USBD_HandleTypeDef *pdev,
+                                                   uint8_t epnum)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+
+  /* Endpoint number is not reliable, flush all busy IN endpoints */
+  if (haudio->mic_busy)
+  {
+    USBD_LL_FlushEP(pdev, AUDIO_STREAM_MIC_EP);
+    haudio->mic_busy = 0;
+  }
+  if (haudio->fb_busy)
+  {
+    USBD_LL_FlushEP(pdev, AUDIO_STREAM_FB_EP);
+    haudio->fb_busy = 0;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_IsoOUTIncomplete
+  *         Packet from host was lost, prepare endpoint again
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_AUDIO_STREAM_IsoOUTIncomplete (USBD_HandleTypeDef *pdev,
+                                                    uint8_t epnum)
+{
+  USBD_AUDIO_STREAM_HandleTypeDef *haudio = (USBD_AUDIO_STREAM_HandleTypeDef *)pdev->pClassData;
+
+  if (haudio->spk_alt)
+  {
+    USBD_LL_PrepareReceive(pdev, AUDIO_STREAM_SPK_EP, haudio->spk_buf, AUDIO_STREAM_SPK_PACKET);
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_GetCfgDesc
+  *         Return configuration descriptor, same for all speeds
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_AUDIO_STREAM_GetCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_AUDIO_STREAM_CfgDesc);
+  return USBD_AUDIO_STREAM_CfgDesc;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_GetDeviceQualifierDescriptor
+  *         return Device Qualifier descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_AUDIO_STREAM_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+  *length = sizeof (USBD_AUDIO_STREAM_DeviceQualifierDesc);
+  return USBD_AUDIO_STREAM_DeviceQualifierDesc;
+}
+
+/**
+  * @brief  USBD_AUDIO_STREAM_RegisterInterface
+  *         Register interface callbacks
+  * @param  pdev: device instance
+  * @param  fops: interface callbacks
+  * @retval status
+  */
+uint8_t  USBD_AUDIO_STREAM_RegisterInterface (USBD_HandleTypeDef   *pdev,
+                                              USBD_AUDIO_STREAM_ItfTypeDef *fops)
+{
+  if (fops != NULL)
+  {
+    pdev->pUserData = fops;
+  }
+  return USBD_OK;
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -71,12 +71,14 @@ static int8_t VCP_InitFS(void);
 static int8_t VCP_DeInitFS(void);
 static int8_t VCP_ControlFS(uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t VCP_ReceiveFS(uint8_t* pbuf, uint32_t *Len);
+static int8_t VCP_TransmitCpltFS(uint8_t* pbuf, uint32_t *Len, uint8_t epnum);
 #endif
 #ifdef USB_USE_HS
 static int8_t VCP_InitHS(void);
 static int8_t VCP_DeInitHS(void);
 static int8_t VCP_ControlHS(uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t VCP_ReceiveHS(uint8_t* pbuf, uint32_t *Len);
+static int8_t VCP_TransmitCpltHS(uint8_t* pbuf, uint32_t *Len, uint8_t epnum);
 #endif
 
 /* Internal functions */
@@ -84,6 +86,7 @@ static int8_t VCP_Init(USBD_HandleTypeDef* pdev);
 static int8_t VCP_DeInit(USBD_HandleTypeDef* pdev);
 static int8_t VCP_Control(USBD_HandleTypeDef* pdev, uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t VCP_Receive(USBD_HandleTypeDef* pdev, uint8_t* pbuf, uint32_t *Len);
+static int8_t VCP_TransmitCplt(USBD_HandleTypeDef* pdev, uint8_t* pbuf, uint32_t *Len, uint8_t epnum);
 
 USBD_CDC_ItfTypeDef USBD_CDC_fops[] = {
 	{
@@ -91,9 +94,10 @@ USBD_CDC_ItfTypeDef USBD_CDC_fops[] = {
 		VCP_InitFS,
 		VCP_DeInitFS,
 		VCP_ControlFS,
-		VCP_ReceiveFS
+		VCP_ReceiveFS,
+		VCP_TransmitCpltFS
 #else
-		0, 0, 0, 0
+		0, 0, 0, 0, 0
 #endif
 	},
 	{
@@ -101,9 +105,10 @@ USBD_CDC_ItfTypeDef USBD_CDC_fops[] = {
 		VCP_InitHS,
 		VCP_DeInitHS,
 		VCP_ControlHS,
-		VCP_ReceiveHS
+		VCP_ReceiveHS,
+		VCP_TransmitCpltHS
 #else
-		0, 0, 0, 0
+		0, 0, 0, 0, 0
 #endif
 	}
 };
@@ -123,13 +128,6 @@ USBD_CDC_LineCodingTypeDef linecoding[] = {
 	}
 };
 
-/* Receive buffers for HS and FS modes */
-#ifdef USB_USE_FS
-static uint8_t FS_TMP_RX_Buff[USBD_CDC_TMP_RECEIVE_BUFFER_SIZE];
-#endif
-#ifdef USB_USE_HS
-static uint8_t HS_TMP_RX_Buff[USBD_CDC_TMP_RECEIVE_BUFFER_SIZE];
-#endif
 /* Private functions ---------------------------------------------------------*/
 
 /**
@@ -212,23 +210,33 @@ static int8_t VCP_ReceiveHS(uint8_t* Buf, uint32_t *Len) {
 }
 #endif
 
+/**
+  * @brief  TEMPLATE_TransmitCplt
+  *         Data transmitted over USB IN endpoint, next transfer can be started
+  *         through this function.
+  * @param  Buf: Buffer of data which was sent
+  * @param  Len: Number of data sent (in bytes)
+  * @param  epnum: Endpoint number
+  * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+  */
+#ifdef USB_USE_FS
+static int8_t VCP_TransmitCpltFS(uint8_t* Buf, uint32_t *Len, uint8_t epnum) {
+	return VCP_TransmitCplt(&hUSBDevice_FS, Buf, Len, epnum);
+}
+#endif
+#ifdef USB_USE_HS
+static int8_t VCP_TransmitCpltHS(uint8_t* Buf, uint32_t *Len, uint8_t epnum) {
+	return VCP_TransmitCplt(&hUSBDevice_HS, Buf, Len, epnum);
+}
+#endif
+
 /********************************************************/
 /*          Single functions for both USB modes         */
 /********************************************************/
 
 static int8_t VCP_Init(USBD_HandleTypeDef* pdev) {
-#ifdef USB_USE_FS
-	/* Set RX buffer */
-	if (pdev->id == USB_ID_FS) {
-		USBD_CDC_SetRxBuffer(pdev, FS_TMP_RX_Buff);
-	}
-#endif
-#ifdef USB_USE_HS
-	/* Set RX buffer */
-	if (pdev->id == USB_ID_HS) {
-		USBD_CDC_SetRxBuffer(pdev, HS_TMP_RX_Buff);
-	}
-#endif
+	/* Reset transfers and set RX buffer */
+	TM_USBD_CDC_INT_Init(pdev);
 	
 	/* Return OK */
 	return USBD_OK;
@@ -240,11 +248,16 @@ static int8_t VCP_DeInit(USBD_HandleTypeDef* pdev) {
 }
 
 static int8_t VCP_Receive(USBD_HandleTypeDef* pdev, uint8_t* pbuf, uint32_t *Len) {
-	/* Add to RX buffer */
-	TM_USBD_CDC_INT_AddToBuffer(pdev, pbuf, *Len);
+	/* Add to RX buffer and prepare for next */
+	TM_USBD_CDC_INT_Receive(pdev, pbuf, *Len);
 	
-	/* Prepare for next  */
-	USBD_CDC_ReceivePacket(pdev);
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t VCP_TransmitCplt(USBD_HandleTypeDef* pdev, uint8_t* pbuf, uint32_t *Len, uint8_t epnum) {
+	/* Release sent data and start next transfer */
+	TM_USBD_CDC_INT_TransmitCplt(pdev);
 	
 	/* Return OK */
 	return USBD_OK;
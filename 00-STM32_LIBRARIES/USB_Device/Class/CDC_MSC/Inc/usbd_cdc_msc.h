@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_msc.h
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   header file for the usbd_cdc_msc.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_CDC_MSC_H
+#define __USB_CDC_MSC_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+#include  "usbd_cdc.h"
+#include  "usbd_msc.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_cdc_msc
+  * @brief This file is the Header file for usbd_cdc_msc.c
+  * @{
+  */
+
+
+/** @defgroup usbd_cdc_msc_Exported_Defines
+  * @{
+  */
+/* Interface numbers, CDC uses 2 interfaces grouped with IAD */
+#define USBD_CDC_MSC_CDC_CMD_ITF      0x00
+#define USBD_CDC_MSC_CDC_DATA_ITF     0x01
+#define USBD_CDC_MSC_MSC_ITF          0x02
+
+/* Configuration = 9 + IAD 8 + CDC 58 + MSC 23 */
+#define USB_CDC_MSC_CONFIG_DESC_SIZ   98
+
+#if ((MSC_EPIN_ADDR & 0x7F) == (CDC_IN_EP & 0x7F)) || ((MSC_EPIN_ADDR & 0x7F) == (CDC_CMD_EP & 0x7F)) || ((MSC_EPOUT_ADDR & 0x7F) == (CDC_OUT_EP & 0x7F))
+#error "MSC endpoints must not be the same as CDC endpoints in composite device!"
+#endif
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/* Class data for one USB device, CDC data is active in device handle and MSC data is switched in for MSC events */
+typedef struct {
+  void *cdc_data;                    /* CDC class data, allocated by CDC class */
+  void *msc_data;                    /* MSC class data, allocated by MSC class */
+  void *cdc_itf;                     /* CDC interface callbacks */
+  void *msc_storage;                 /* MSC storage callbacks */
+} USBD_CDC_MSC_HandleTypeDef;
+
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_CDC_MSC;
+#define USBD_CDC_MSC_CLASS    &USBD_CDC_MSC
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_CDC_MSC_RegisterStorage (USBD_HandleTypeDef   *pdev,
+                                       USBD_StorageTypeDef *fops);
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_CDC_MSC_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,542 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_msc.c
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   This file provides composite device with CDC and MSC class:
+  *           - Configuration descriptor with IAD for CDC interfaces
+  *           - Routing of control requests and endpoint events to CDC or MSC class
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                             CDC + MSC Composite Driver Description
+  *          ===================================================================
+  *           Interface 0 and 1 are CDC interfaces (EP 0x82 command, EP 0x01/0x81 data),
+  *           grouped with Interface Association Descriptor.
+  *           Interface 2 is MSC interface (EP MSC_EPOUT_ADDR/MSC_EPIN_ADDR).
+  *
+  *           CDC and MSC class drivers are used unchanged. Both use class data and
+  *           user data pointers in device handle, so CDC pointers are kept in device
+  *           handle by default and MSC pointers are switched in only while
+  *           MSC class driver is called from USB interrupt.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_cdc_msc.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_CDC_MSC
+  * @brief usbd core module
+  * @{
+  */
+
+/** @defgroup USBD_CDC_MSC_Private_TypesDefinitions
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CDC_MSC_Private_Defines
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CDC_MSC_Private_Macros
+  * @{
+  */
+
+/* Get composite handle for device */
+#define USBD_CDC_MSC_HANDLE(pdev)      (&USBD_CDC_MSC_Handle[(pdev)->id == 0 ? 0 : 1])
+
+/* Check if endpoint number belongs to MSC */
+#define USBD_CDC_MSC_IS_MSC_EP(ep)     ((((ep) & 0x7F) == (MSC_EPIN_ADDR & 0x7F)) || (((ep) & 0x7F) == (MSC_EPOUT_ADDR & 0x7F)))
+
+/* Switch device handle to MSC class data and back to CDC */
+#define USBD_CDC_MSC_SELECT_MSC(pdev, h)    do {                         \
+  (h)->cdc_data = (pdev)->pClassData; (h)->cdc_itf = (pdev)->pUserData;  \
+  (pdev)->pClassData = (h)->msc_data; (pdev)->pUserData = (h)->msc_storage; \
+} while (0)
+#define USBD_CDC_MSC_SELECT_CDC(pdev, h)    do {                         \
+  (h)->msc_data = (pdev)->pClassData;                                    \
+  (pdev)->pClassData = (h)->cdc_data; (pdev)->pUserData = (h)->cdc_itf;  \
+} while (0)
+
+/* Configuration descriptor, same layout for all speeds */
+#define USBD_CDC_MSC_CFG_DESC(type, cdc_packet, msc_packet)                  \
+  /*Configuration Descriptor*/                                             \
+  0x09,   /* bLength: Configuration Descriptor size */                     \
+  type,   /* bDescriptorType: Configuration */                             \
+  LOBYTE(USB_CDC_MSC_CONFIG_DESC_SIZ),  /* wTotalLength */                 \
+  HIBYTE(USB_CDC_MSC_CONFIG_DESC_SIZ),                                     \
+  0x03,   /* bNumInterfaces: 3 interfaces */                               \
+  0x01,   /* bConfigurationValue: Configuration value */                   \
+  0x00,   /* iConfiguration */                                             \
+  0xC0,   /* bmAttributes: self powered */                                 \
+  0x32,   /* MaxPower 100 mA */                                            \
+                                                                           \
+  /*Interface Association Descriptor*/                                     \
+  0x08,   /* bLength */                                                    \
+  0x0B,   /* bDescriptorType: IAD */                                       \
+  USBD_CDC_MSC_CDC_CMD_ITF,  /* bFirstInterface */                         \
+  0x02,   /* bInterfaceCount */                                            \
+  0x02,   /* bFunctionClass: Communication Interface Class */              \
+  0x02,   /* bFunctionSubClass: Abstract Control Model */                  \
+  0x01,   /* bFunctionProtocol: Common AT commands */                      \
+  0x00,   /* iFunction */                                                  \
+                                                                           \
+  /*CDC Interface Descriptor */                                            \
+  0x09,   /* bLength: Interface Descriptor size */                         \
+  USB_DESC_TYPE_INTERFACE,  /* bDescriptorType: Interface */               \
+  USBD_CDC_MSC_CDC_CMD_ITF, /* bInterfaceNumber */                         \
+  0x00,   /* bAlternateSetting: Alternate setting */                       \
+  0x01,   /* bNumEndpoints: One endpoints used */                          \
+  0x02,   /* bInterfaceClass: Communication Interface Class */             \
+  0x02,   /* bInterfaceSubClass: Abstract Control Model */                 \
+  0x01,   /* bInterfaceProtocol: Common AT commands */                     \
+  0x00,   /* iInterface */                                                 \
+                                                                           \
+  /*Header Functional Descriptor*/                                         \
+  0x05,   /* bLength */                                                    \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x00,   /* bDescriptorSubtype: Header Func Desc */                       \
+  0x10,   /* bcdCDC: spec release number */                                \
+  0x01,                                                                    \
+                                                                           \
+  /*Call Management Functional Descriptor*/                                \
+  0x05,   /* bFunctionLength */                                            \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x01,   /* bDescriptorSubtype: Call Management Func Desc */              \
+  0x00,   /* bmCapabilities: D0+D1 */                                      \
+  USBD_CDC_MSC_CDC_DATA_ITF,  /* bDataInterface */                         \
+                                                                           \
+  /*ACM Functional Descriptor*/                                            \
+  0x04,   /* bFunctionLength */                                            \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x02,   /* bDescriptorSubtype: Abstract Control Management desc */       \
+  0x02,   /* bmCapabilities */                                             \
+                                                                           \
+  /*Union Functional Descriptor*/                                          \
+  0x05,   /* bFunctionLength */                                            \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x06,   /* bDescriptorSubtype: Union func desc */                        \
+  USBD_CDC_MSC_CDC_CMD_ITF,  /* bMasterInterface */                        \
+  USBD_CDC_MSC_CDC_DATA_ITF, /* bSlaveInterface0 */                        \
+                                                                           \
+  /*CDC Command Endpoint Descriptor*/                                      \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  CDC_CMD_EP,              /* bEndpointAddress */                          \
+  0x03,   /* bmAttributes: Interrupt */                                    \
+  LOBYTE(CDC_CMD_PACKET_SIZE),  /* wMaxPacketSize */                       \
+  HIBYTE(CDC_CMD_PACKET_SIZE),                                             \
+  0x10,   /* bInterval */                                                  \
+                                                                           \
+  /*CDC Data class interface descriptor*/                                  \
+  0x09,   /* bLength: Interface Descriptor size */                         \
+  USB_DESC_TYPE_INTERFACE,  /* bDescriptorType */                          \
+  USBD_CDC_MSC_CDC_DATA_ITF,/* bInterfaceNumber */                         \
+  0x00,   /* bAlternateSetting: Alternate setting */                       \
+  0x02,   /* bNumEndpoints: Two endpoints used */                          \
+  0x0A,   /* bInterfaceClass: CDC */                                       \
+  0x00,   /* bInterfaceSubClass */                                         \
+  0x00,   /* bInterfaceProtocol */                                         \
+  0x00,   /* iInterface */                                                 \
+                                                                           \
+  /*CDC Endpoint OUT Descriptor*/                                          \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  CDC_OUT_EP,              /* bEndpointAddress */                          \
+  0x02,   /* bmAttributes: Bulk */                                         \
+  LOBYTE(cdc_packet),      /* wMaxPacketSize */                            \
+  HIBYTE(cdc_packet),                                                      \
+  0x00,   /* bInterval: ignore for Bulk transfer */                        \
+                                                                           \
+  /*CDC Endpoint IN Descriptor*/                                           \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  CDC_IN_EP,               /* bEndpointAddress */                          \
+  0x02,   /* bmAttributes: Bulk */                                         \
+  LOBYTE(cdc_packet),      /* wMaxPacketSize */                            \
+  HIBYTE(cdc_packet),                                                      \
+  0x00,   /* bInterval: ignore for Bulk transfer */                        \
+                                                                           \
+  /*Mass Storage interface*/                                               \
+  0x09,   /* bLength: Interface Descriptor size */                         \
+  USB_DESC_TYPE_INTERFACE,  /* bDescriptorType */                          \
+  USBD_CDC_MSC_MSC_ITF,     /* bInterfaceNumber */                         \
+  0x00,   /* bAlternateSetting: Alternate setting */                       \
+  0x02,   /* bNumEndpoints */                                              \
+  0x08,   /* bInterfaceClass: MSC Class */                                 \
+  0x06,   /* bInterfaceSubClass: SCSI transparent */                       \
+  0x50,   /* nInterfaceProtocol: Bulk only */                              \
+  0x00,   /* iInterface */                                                 \
+                                                                           \
+  /*MSC Endpoint IN Descriptor*/                                           \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  MSC_EPIN_ADDR,           /* bEndpointAddress */                          \
+  0x02,   /* bmAttributes: Bulk */                                         \
+  LOBYTE(msc_packet),      /* wMaxPacketSize */                            \
+  HIBYTE(msc_packet),                                                      \
+  0x00,   /* bInterval */                                                  \
+                                                                           \
+  /*MSC Endpoint OUT Descriptor*/                                          \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  MSC_EPOUT_ADDR,          /* bEndpointAddress */                          \
+  0x02,   /* bmAttributes: Bulk */                                         \
+  LOBYTE(msc_packet),      /* wMaxPacketSize */                            \
+  HIBYTE(msc_packet),                                                      \
+  0x00    /* bInterval */
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CDC_MSC_Private_FunctionPrototypes
+  * @{
+  */
+
+
+static uint8_t  USBD_CDC_MSC_Init (USBD_HandleTypeDef *pdev,
+                                   uint8_t cfgidx);
+
+static uint8_t  USBD_CDC_MSC_DeInit (USBD_HandleTypeDef *pdev,
+                                     uint8_t cfgidx);
+
+static uint8_t  USBD_CDC_MSC_Setup (USBD_HandleTypeDef *pdev,
+                                    USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_CDC_MSC_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_CDC_MSC_DataIn (USBD_HandleTypeDef *pdev,
+                                     uint8_t epnum);
+
+static uint8_t  USBD_CDC_MSC_DataOut (USBD_HandleTypeDef *pdev,
+                                      uint8_t epnum);
+
+static uint8_t  *USBD_CDC_MSC_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_MSC_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_MSC_GetOtherSpeedCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_MSC_GetDeviceQualifierDescriptor (uint16_t *length);
+
+/* USB Standard Device Qualifier Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_CDC_MSC_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+  USB_LEN_DEV_QUALIFIER_DESC,
+  USB_DESC_TYPE_DEVICE_QUALIFIER,
+  0x00,
+  0x02,
+  0xEF,
+  0x02,
+  0x01,
+  0x40,
+  0x01,
+  0x00,
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CDC_MSC_Private_Variables
+  * @{
+  */
+
+/* Composite class data for FS and HS device */
+static USBD_CDC_MSC_HandleTypeDef USBD_CDC_MSC_Handle[2];
+
+/* CDC + MSC interface class callbacks structure */
+USBD_ClassTypeDef  USBD_CDC_MSC =
+{
+  USBD_CDC_MSC_Init,
+  USBD_CDC_MSC_DeInit,
+  USBD_CDC_MSC_Setup,
+  NULL,                 /* EP0_TxSent, */
+  USBD_CDC_MSC_EP0_RxReady,
+  USBD_CDC_MSC_DataIn,
+  USBD_CDC_MSC_DataOut,
+  NULL,
+  NULL,
+  NULL,
+  USBD_CDC_MSC_GetHSCfgDesc,
+  USBD_CDC_MSC_GetFSCfgDesc,
+  USBD_CDC_MSC_GetOtherSpeedCfgDesc,
+  USBD_CDC_MSC_GetDeviceQualifierDescriptor,
+};
+
+/* USB CDC + MSC device Configuration Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_CDC_MSC_CfgHSDesc[USB_CDC_MSC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_CDC_MSC_CFG_DESC(USB_DESC_TYPE_CONFIGURATION, CDC_DATA_HS_MAX_PACKET_SIZE, MSC_MAX_HS_PACKET)
+};
+
+__ALIGN_BEGIN static uint8_t USBD_CDC_MSC_CfgFSDesc[USB_CDC_MSC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_CDC_MSC_CFG_DESC(USB_DESC_TYPE_CONFIGURATION, CDC_DATA_FS_MAX_PACKET_SIZE, MSC_MAX_FS_PACKET)
+};
+
+__ALIGN_BEGIN static uint8_t USBD_CDC_MSC_OtherSpeedCfgDesc[USB_CDC_MSC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_CDC_MSC_CFG_DESC(USB_DESC_TYPE_OTHER_SPEED_CONFIGURATION, CDC_DATA_FS_MAX_PACKET_SIZE, MSC_MAX_FS_PACKET)
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CDC_MSC_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_CDC_MSC_Init
+  *         Initialize the CDC and MSC interfaces
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MSC_Init (USBD_HandleTypeDef *pdev,
+                                   uint8_t cfgidx)
+{
+  USBD_CDC_MSC_HandleTypeDef *h = USBD_CDC_MSC_HANDLE(pdev);
+  uint8_t ret;
+
+  /* CDC first, it stays active in device handle */
+  ret = USBD_CDC.Init(pdev, cfgidx);
+  if (ret != USBD_OK)
+  {
+    return ret;
+  }
+
+  /* MSC allocates its own class data */
+  h->msc_data = NULL;
+  USBD_CDC_MSC_SELECT_MSC(pdev, h);
+  ret = USBD_MSC.Init(pdev, cfgidx);
+  USBD_CDC_MSC_SELECT_CDC(pdev, h);
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_DeInit
+  *         DeInitialize the CDC and MSC layers
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MSC_DeInit (USBD_HandleTypeDef *pdev,
+                                     uint8_t cfgidx)
+{
+  USBD_CDC_MSC_HandleTypeDef *h = USBD_CDC_MSC_HANDLE(pdev);
+
+  /* Free MSC data */
+  if (h->msc_data != NULL)
+  {
+    USBD_CDC_MSC_SELECT_MSC(pdev, h);
+    USBD_MSC.DeInit(pdev, cfgidx);
+    USBD_CDC_MSC_SELECT_CDC(pdev, h);
+  }
+
+  /* Free CDC data */
+  return USBD_CDC.DeInit(pdev, cfgidx);
+}
+
+/**
+  * @brief  USBD_CDC_MSC_Setup
+  *         Route request to class which owns interface or endpoint
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MSC_Setup (USBD_HandleTypeDef *pdev,
+                                    USBD_SetupReqTypedef *req)
+{
+  USBD_CDC_MSC_HandleTypeDef *h = USBD_CDC_MSC_HANDLE(pdev);
+  uint8_t msc = 0;
+  uint8_t ret;
+
+  switch (req->bmRequest & USB_REQ_RECIPIENT_MASK)
+  {
+  case USB_REQ_RECIPIENT_INTERFACE:
+    msc = LOBYTE(req->wIndex) == USBD_CDC_MSC_MSC_ITF;
+    break;
+
+  case USB_REQ_RECIPIENT_ENDPOINT:
+    msc = USBD_CDC_MSC_IS_MSC_EP(LOBYTE(req->wIndex));
+    break;
+
+  default:
+    break;
+  }
+
+  if (!msc)
+  {
+    return USBD_CDC.Setup(pdev, req);
+  }
+
+  USBD_CDC_MSC_SELECT_MSC(pdev, h);
+  ret = USBD_MSC.Setup(pdev, req);
+  USBD_CDC_MSC_SELECT_CDC(pdev, h);
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_EP0_RxReady
+  *         Data received on control endpoint, only CDC uses it
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MSC_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+  return USBD_CDC.EP0_RxReady(pdev);
+}
+
+/**
+  * @brief  USBD_CDC_MSC_DataIn
+  *         Data sent on non-control IN endpoint
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MSC_DataIn (USBD_HandleTypeDef *pdev,
+                                     uint8_t epnum)
+{
+  USBD_CDC_MSC_HandleTypeDef *h = USBD_CDC_MSC_HANDLE(pdev);
+  uint8_t ret;
+
+  if (!USBD_CDC_MSC_IS_MSC_EP(epnum))
+  {
+    return USBD_CDC.DataIn(pdev, epnum);
+  }
+
+  USBD_CDC_MSC_SELECT_MSC(pdev, h);
+  ret = USBD_MSC.DataIn(pdev, epnum);
+  USBD_CDC_MSC_SELECT_CDC(pdev, h);
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_DataOut
+  *         Data received on non-control Out endpoint
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MSC_DataOut (USBD_HandleTypeDef *pdev,
+                                      uint8_t epnum)
+{
+  USBD_CDC_MSC_HandleTypeDef *h = USBD_CDC_MSC_HANDLE(pdev);
+  uint8_t ret;
+
+  if (!USBD_CDC_MSC_IS_MSC_EP(epnum))
+  {
+    return USBD_CDC.DataOut(pdev, epnum);
+  }
+
+  USBD_CDC_MSC_SELECT_MSC(pdev, h);
+  ret = USBD_MSC.DataOut(pdev, epnum);
+  USBD_CDC_MSC_SELECT_CDC(pdev, h);
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_GetFSCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MSC_GetFSCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MSC_CfgFSDesc);
+  return USBD_CDC_MSC_CfgFSDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_GetHSCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MSC_GetHSCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MSC_CfgHSDesc);
+  return USBD_CDC_MSC_CfgHSDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_GetOtherSpeedCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MSC_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MSC_OtherSpeedCfgDesc);
+  return USBD_CDC_MSC_OtherSpeedCfgDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_GetDeviceQualifierDescriptor
+  *         return Device Qualifier descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MSC_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MSC_DeviceQualifierDesc);
+  return USBD_CDC_MSC_DeviceQualifierDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MSC_RegisterStorage
+  *         Register MSC storage callbacks, CDC interface is registered with USBD_CDC_RegisterInterface
+  * @param  pdev: device instance
+  * @param  fops: storage callback
+  * @retval status
+  */
+uint8_t  USBD_CDC_MSC_RegisterStorage (USBD_HandleTypeDef   *pdev,
+                                       USBD_StorageTypeDef *fops)
+{
+  if (fops != NULL)
+  {
+    USBD_CDC_MSC_HANDLE(pdev)->msc_storage = fops;
+  }
+  return USBD_OK;
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,171 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_multi.h
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   header file for the usbd_cdc_multi.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_CDC_MULTI_H
+#define __USB_CDC_MULTI_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+#include  "usbd_cdc.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_cdc_multi
+  * @brief This file is the Header file for usbd_cdc_multi.c
+  * @{
+  */
+
+
+/** @defgroup usbd_cdc_multi_Exported_Defines
+  * @{
+  */
+/* Number of CDC ports, each port uses 2 IN and 1 OUT endpoint */
+#ifndef USBD_CDC_MULTI_PORTS
+#define USBD_CDC_MULTI_PORTS                2
+#endif
+
+/* Endpoints for port 0, data OUT, data IN and command IN */
+#ifndef USBD_CDC_MULTI_OUT_EP0
+#define USBD_CDC_MULTI_OUT_EP0              0x01
+#define USBD_CDC_MULTI_IN_EP0               0x81
+#define USBD_CDC_MULTI_CMD_EP0              0x82
+#endif
+
+/* Endpoints for port 1, data OUT, data IN and command IN */
+#ifndef USBD_CDC_MULTI_OUT_EP1
+#define USBD_CDC_MULTI_OUT_EP1              0x03
+#define USBD_CDC_MULTI_IN_EP1               0x83
+#define USBD_CDC_MULTI_CMD_EP1              0x84
+#endif
+
+/* Interface numbers, each port uses command and data interface grouped with IAD */
+#define USBD_CDC_MULTI_CMD_ITF(port)        (2 * (port))
+#define USBD_CDC_MULTI_DATA_ITF(port)       (2 * (port) + 1)
+#define USBD_CDC_MULTI_NUM_ITF              (2 * USBD_CDC_MULTI_PORTS)
+
+/* Configuration = 9 + ports * (IAD 8 + CDC 58) */
+#define USB_CDC_MULTI_CONFIG_DESC_SIZ       (9 + 66 * USBD_CDC_MULTI_PORTS)
+
+/* Check settings */
+#if USBD_CDC_MULTI_PORTS < 1 || USBD_CDC_MULTI_PORTS > 2
+#error "USBD_CDC_MULTI_PORTS must be 1 or 2, USB OTG cores have 5 IN endpoints besides control endpoint!"
+#endif
+#if USBD_CDC_MULTI_NUM_ITF > USBD_MAX_NUM_INTERFACES
+#error "USBD_MAX_NUM_INTERFACES is too small for CDC multi interfaces!"
+#endif
+#if USBD_CDC_MULTI_PORTS > 1 && defined(USB_USE_FS) && !defined(STM32F446xx) && !defined(STM32F469xx) && !defined(STM32F479xx) && !defined(STM32F7xx)
+#error "FS core on this device has 4 endpoints, use one CDC multi port on FS or use HS core only!"
+#endif
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/* Interface callbacks, called from USB interrupt with port number */
+typedef struct {
+  int8_t (*Init)         (USBD_HandleTypeDef *pdev, uint8_t port);
+  int8_t (*DeInit)       (USBD_HandleTypeDef *pdev, uint8_t port);
+  int8_t (*Control)      (USBD_HandleTypeDef *pdev, uint8_t port, uint8_t cmd, uint8_t *pbuf, uint16_t length);  /* Optional, line coding is handled by class */
+  int8_t (*Receive)      (USBD_HandleTypeDef *pdev, uint8_t port, uint8_t *pbuf, uint32_t len);
+  int8_t (*TransmitCplt) (USBD_HandleTypeDef *pdev, uint8_t port);
+} USBD_CDC_MULTI_ItfTypeDef;
+
+/* Data for one port */
+typedef struct {
+  uint8_t  *RxBuffer;                        /* Memory for next OUT transfer */
+  uint8_t  *TxBuffer;                        /* Memory for next IN transfer */
+  uint32_t RxLength;                         /* Received bytes in last OUT transfer */
+  uint32_t TxLength;                         /* Bytes in next IN transfer */
+  __IO uint32_t TxState;                     /* IN transfer is in progress */
+  USBD_CDC_LineCodingTypeDef LineCoding;     /* Line coding set by host */
+  uint16_t ControlLineState;                 /* Bit 0 is DTR, bit 1 is RTS, set by host */
+} USBD_CDC_MULTI_PortTypeDef;
+
+/* Class data for one USB device */
+typedef struct {
+  uint32_t data[CDC_CMD_PACKET_SIZE / 4];    /* Class requests data, force 32bits alignment */
+  uint8_t  CmdOpCode;                        /* Pending class request with data stage */
+  uint8_t  CmdLength;
+  uint8_t  CmdPort;                          /* Port of pending class request */
+  USBD_CDC_MULTI_PortTypeDef Port[USBD_CDC_MULTI_PORTS];
+} USBD_CDC_MULTI_HandleTypeDef;
+
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_CDC_MULTI;
+#define USBD_CDC_MULTI_CLASS    &USBD_CDC_MULTI
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_CDC_MULTI_RegisterInterface (USBD_HandleTypeDef   *pdev,
+                                           USBD_CDC_MULTI_ItfTypeDef *fops);
+
+uint8_t  USBD_CDC_MULTI_SetTxBuffer       (USBD_HandleTypeDef   *pdev,
+                                           uint8_t  port,
+                                           uint8_t  *pbuff,
+                                           uint32_t length);
+
+uint8_t  USBD_CDC_MULTI_SetRxBuffer       (USBD_HandleTypeDef   *pdev,
+                                           uint8_t  port,
+                                           uint8_t  *pbuff);
+
+uint8_t  USBD_CDC_MULTI_ReceivePacket     (USBD_HandleTypeDef *pdev,
+                                           uint8_t  port);
+
+uint8_t  USBD_CDC_MULTI_TransmitPacket    (USBD_HandleTypeDef *pdev,
+                                           uint8_t  port);
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_CDC_MULTI_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
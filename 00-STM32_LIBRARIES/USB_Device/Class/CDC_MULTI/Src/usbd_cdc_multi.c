@@ -0,0 +1,759 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_multi.c
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   This file provides composite device with multiple CDC ports:
+  *           - Configuration descriptor with IAD for each port
+  *           - Routing of control requests and endpoint events to port
+  *           - Line coding and control line state for each port
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                             CDC Multi Port Driver Description
+  *          ===================================================================
+  *           Port n uses interface 2n (command, EP USBD_CDC_MULTI_CMD_EPn) and
+  *           interface 2n+1 (data, EP USBD_CDC_MULTI_OUT_EPn/USBD_CDC_MULTI_IN_EPn),
+  *           grouped with Interface Association Descriptor. Host creates one
+  *           virtual COM port for each port.
+  *
+  *           Class data is static for FS and HS device, no memory is allocated.
+  *           Interface callbacks get port number, line coding is stored by class
+  *           so the interface does not need to handle class requests.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_cdc_multi.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_CDC_MULTI
+  * @brief usbd core module
+  * @{
+  */
+
+/** @defgroup USBD_CDC_MULTI_Private_TypesDefinitions
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CDC_MULTI_Private_Defines
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CDC_MULTI_Private_Macros
+  * @{
+  */
+
+/* Get class handle for device */
+#define USBD_CDC_MULTI_HANDLE(pdev)        (&USBD_CDC_MULTI_Handle[(pdev)->id == 0 ? 0 : 1])
+
+/* Interface callbacks */
+#define USBD_CDC_MULTI_ITF(pdev)           ((USBD_CDC_MULTI_ItfTypeDef *)(pdev)->pUserData)
+
+/* Configuration descriptor header, same for all speeds */
+#define USBD_CDC_MULTI_CFG_HEADER(type)                                    \
+  /*Configuration Descriptor*/                                             \
+  0x09,   /* bLength: Configuration Descriptor size */                     \
+  type,   /* bDescriptorType: Configuration */                             \
+  LOBYTE(USB_CDC_MULTI_CONFIG_DESC_SIZ),  /* wTotalLength */               \
+  HIBYTE(USB_CDC_MULTI_CONFIG_DESC_SIZ),                                   \
+  USBD_CDC_MULTI_NUM_ITF,  /* bNumInterfaces */                            \
+  0x01,   /* bConfigurationValue: Configuration value */                   \
+  0x00,   /* iConfiguration */                                             \
+  0xC0,   /* bmAttributes: self powered */                                 \
+  0x32    /* MaxPower 100 mA */
+
+/* Descriptors for one port */
+#define USBD_CDC_MULTI_PORT_DESC(port, out_ep, in_ep, cmd_ep, packet)      \
+  /*Interface Association Descriptor*/                                     \
+  0x08,   /* bLength */                                                    \
+  0x0B,   /* bDescriptorType: IAD */                                       \
+  USBD_CDC_MULTI_CMD_ITF(port),  /* bFirstInterface */                     \
+  0x02,   /* bInterfaceCount */                                            \
+  0x02,   /* bFunctionClass: Communication Interface Class */              \
+  0x02,   /* bFunctionSubClass: Abstract Control Model */                  \
+  0x01,   /* bFunctionProtocol: Common AT commands */                      \
+  0x00,   /* iFunction */                                                  \
+                                                                           \
+  /*CDC Interface Descriptor */                                            \
+  0x09,   /* bLength: Interface Descriptor size */                         \
+  USB_DESC_TYPE_INTERFACE,  /* bDescriptorType: Interface */               \
+  USBD_CDC_MULTI_CMD_ITF(port),  /* bInterfaceNumber */                    \
+  0x00,   /* bAlternateSetting: Alternate setting */                       \
+  0x01,   /* bNumEndpoints: One endpoints used */                          \
+  0x02,   /* bInterfaceClass: Communication Interface Class */             \
+  0x02,   /* bInterfaceSubClass: Abstract Control Model */                 \
+  0x01,   /* bInterfaceProtocol: Common AT commands */                     \
+  0x00,   /* iInterface */                                                 \
+                                                                           \
+  /*Header Functional Descriptor*/                                         \
+  0x05,   /* bLength */                                                    \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x00,   /* bDescriptorSubtype: Header Func Desc */                       \
+  0x10,   /* bcdCDC: spec release number */                                \
+  0x01,                                                                    \
+                                                                           \
+  /*Call Management Functional Descriptor*/                                \
+  0x05,   /* bFunctionLength */                                            \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x01,   /* bDescriptorSubtype: Call Management Func Desc */              \
+  0x00,   /* bmCapabilities: D0+D1 */                                      \
+  USBD_CDC_MULTI_DATA_ITF(port),  /* bDataInterface */                     \
+                                                                           \
+  /*ACM Functional Descriptor*/                                            \
+  0x04,   /* bFunctionLength */                                            \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x02,   /* bDescriptorSubtype: Abstract Control Management desc */       \
+  0x02,   /* bmCapabilities */                                             \
+                                                                           \
+  /*Union Functional Descriptor*/                                          \
+  0x05,   /* bFunctionLength */                                            \
+  0x24,   /* bDescriptorType: CS_INTERFACE */                              \
+  0x06,   /* bDescriptorSubtype: Union func desc */                        \
+  USBD_CDC_MULTI_CMD_ITF(port),   /* bMasterInterface */                   \
+  USBD_CDC_MULTI_DATA_ITF(port),  /* bSlaveInterface0 */                   \
+                                                                           \
+  /*CDC Command Endpoint Descriptor*/                                      \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  cmd_ep,                  /* bEndpointAddress */                          \
+  0x03,   /* bmAttributes: Interrupt */                                    \
+  LOBYTE(CDC_CMD_PACKET_SIZE),  /* wMaxPacketSize */                       \
+  HIBYTE(CDC_CMD_PACKET_SIZE),                                             \
+  0x10,   /* bInterval */                                                  \
+                                                                           \
+  /*CDC Data class interface descriptor*/                                  \
+  0x09,   /* bLength: Interface Descriptor size */                         \
+  USB_DESC_TYPE_INTERFACE,  /* bDescriptorType */                          \
+  USBD_CDC_MULTI_DATA_ITF(port),  /* bInterfaceNumber */                   \
+  0x00,   /* bAlternateSetting: Alternate setting */                       \
+  0x02,   /* bNumEndpoints: Two endpoints used */                          \
+  0x0A,   /* bInterfaceClass: CDC */                                       \
+  0x00,   /* bInterfaceSubClass */                                         \
+  0x00,   /* bInterfaceProtocol */                                         \
+  0x00,   /* iInterface */                                                 \
+                                                                           \
+  /*CDC Endpoint OUT Descriptor*/                                          \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  out_ep,                  /* bEndpointAddress */                          \
+  0x02,   /* bmAttributes: Bulk */                                         \
+  LOBYTE(packet),          /* wMaxPacketSize */                            \
+  HIBYTE(packet),                                                          \
+  0x00,   /* bInterval: ignore for Bulk transfer */                        \
+                                                                           \
+  /*CDC Endpoint IN Descriptor*/                                           \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  in_ep,                   /* bEndpointAddress */                          \
+  0x02,   /* bmAttributes: Bulk */                                         \
+  LOBYTE(packet),          /* wMaxPacketSize */                            \
+  HIBYTE(packet),                                                          \
+  0x00    /* bInterval: ignore for Bulk transfer */
+
+/* Configuration descriptor for all ports */
+#if USBD_CDC_MULTI_PORTS > 1
+#define USBD_CDC_MULTI_CFG_DESC(type, packet)                              \
+  USBD_CDC_MULTI_CFG_HEADER(type),                                         \
+  USBD_CDC_MULTI_PORT_DESC(0, USBD_CDC_MULTI_OUT_EP0, USBD_CDC_MULTI_IN_EP0, USBD_CDC_MULTI_CMD_EP0, packet), \
+  USBD_CDC_MULTI_PORT_DESC(1, USBD_CDC_MULTI_OUT_EP1, USBD_CDC_MULTI_IN_EP1, USBD_CDC_MULTI_CMD_EP1, packet)
+#else
+#define USBD_CDC_MULTI_CFG_DESC(type, packet)                              \
+  USBD_CDC_MULTI_CFG_HEADER(type),                                         \
+  USBD_CDC_MULTI_PORT_DESC(0, USBD_CDC_MULTI_OUT_EP0, USBD_CDC_MULTI_IN_EP0, USBD_CDC_MULTI_CMD_EP0, packet)
+#endif
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CDC_MULTI_Private_FunctionPrototypes
+  * @{
+  */
+
+
+static uint8_t  USBD_CDC_MULTI_Init (USBD_HandleTypeDef *pdev,
+                                     uint8_t cfgidx);
+
+static uint8_t  USBD_CDC_MULTI_DeInit (USBD_HandleTypeDef *pdev,
+                                       uint8_t cfgidx);
+
+static uint8_t  USBD_CDC_MULTI_Setup (USBD_HandleTypeDef *pdev,
+                                      USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_CDC_MULTI_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_CDC_MULTI_DataIn (USBD_HandleTypeDef *pdev,
+                                       uint8_t epnum);
+
+static uint8_t  USBD_CDC_MULTI_DataOut (USBD_HandleTypeDef *pdev,
+                                        uint8_t epnum);
+
+static uint8_t  *USBD_CDC_MULTI_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_MULTI_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_MULTI_GetOtherSpeedCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_CDC_MULTI_GetDeviceQualifierDescriptor (uint16_t *length);
+
+/* USB Standard Device Qualifier Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_CDC_MULTI_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+  USB_LEN_DEV_QUALIFIER_DESC,
+  USB_DESC_TYPE_DEVICE_QUALIFIER,
+  0x00,
+  0x02,
+  0xEF,
+  0x02,
+  0x01,
+  0x40,
+  0x01,
+  0x00,
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CDC_MULTI_Private_Variables
+  * @{
+  */
+
+/* Class data for FS and HS device */
+static USBD_CDC_MULTI_HandleTypeDef USBD_CDC_MULTI_Handle[2];
+
+/* Endpoints of each port, data OUT, data IN and command IN */
+static const uint8_t USBD_CDC_MULTI_EP[USBD_CDC_MULTI_PORTS][3] =
+{
+  {USBD_CDC_MULTI_OUT_EP0, USBD_CDC_MULTI_IN_EP0, USBD_CDC_MULTI_CMD_EP0},
+#if USBD_CDC_MULTI_PORTS > 1
+  {USBD_CDC_MULTI_OUT_EP1, USBD_CDC_MULTI_IN_EP1, USBD_CDC_MULTI_CMD_EP1},
+#endif
+};
+
+/* CDC multi interface class callbacks structure */
+USBD_ClassTypeDef  USBD_CDC_MULTI =
+{
+  USBD_CDC_MULTI_Init,
+  USBD_CDC_MULTI_DeInit,
+  USBD_CDC_MULTI_Setup,
+  NULL,                 /* EP0_TxSent, */
+  USBD_CDC_MULTI_EP0_RxReady,
+  USBD_CDC_MULTI_DataIn,
+  USBD_CDC_MULTI_DataOut,
+  NULL,
+  NULL,
+  NULL,
+  USBD_CDC_MULTI_GetHSCfgDesc,
+  USBD_CDC_MULTI_GetFSCfgDesc,
+  USBD_CDC_MULTI_GetOtherSpeedCfgDesc,
+  USBD_CDC_MULTI_GetDeviceQualifierDescriptor,
+};
+
+/* USB CDC multi device Configuration Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_CDC_MULTI_CfgHSDesc[USB_CDC_MULTI_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_CDC_MULTI_CFG_DESC(USB_DESC_TYPE_CONFIGURATION, CDC_DATA_HS_MAX_PACKET_SIZE)
+};
+
+__ALIGN_BEGIN static uint8_t USBD_CDC_MULTI_CfgFSDesc[USB_CDC_MULTI_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_CDC_MULTI_CFG_DESC(USB_DESC_TYPE_CONFIGURATION, CDC_DATA_FS_MAX_PACKET_SIZE)
+};
+
+__ALIGN_BEGIN static uint8_t USBD_CDC_MULTI_OtherSpeedCfgDesc[USB_CDC_MULTI_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_CDC_MULTI_CFG_DESC(USB_DESC_TYPE_OTHER_SPEED_CONFIGURATION, CDC_DATA_FS_MAX_PACKET_SIZE)
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CDC_MULTI_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_CDC_MULTI_GetPort
+  *         Find port which owns endpoint
+  * @param  epnum: endpoint number, direction bit is ignored
+  * @param  index: 0 for data OUT, 1 for data IN endpoint
+  * @retval port number or USBD_CDC_MULTI_PORTS if not found
+  */
+static uint8_t  USBD_CDC_MULTI_GetPort (uint8_t epnum, uint8_t index)
+{
+  uint8_t port;
+
+  for (port = 0; port < USBD_CDC_MULTI_PORTS; port++)
+  {
+    if ((USBD_CDC_MULTI_EP[port][index] & 0x7F) == (epnum & 0x7F))
+    {
+      break;
+    }
+  }
+  return port;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_Init
+  *         Initialize all CDC ports
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MULTI_Init (USBD_HandleTypeDef *pdev,
+                                     uint8_t cfgidx)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = USBD_CDC_MULTI_HANDLE(pdev);
+  USBD_CDC_MULTI_PortTypeDef *p;
+  uint16_t size = pdev->dev_speed == USBD_SPEED_HIGH ? CDC_DATA_HS_MAX_PACKET_SIZE : CDC_DATA_FS_MAX_PACKET_SIZE;
+  uint8_t port;
+
+  h->CmdOpCode = 0xFF;
+  pdev->pClassData = h;
+
+  for (port = 0; port < USBD_CDC_MULTI_PORTS; port++)
+  {
+    p = &h->Port[port];
+
+    /* Open data and command endpoints */
+    USBD_LL_OpenEP(pdev, USBD_CDC_MULTI_EP[port][0], USBD_EP_TYPE_BULK, size);
+    USBD_LL_OpenEP(pdev, USBD_CDC_MULTI_EP[port][1], USBD_EP_TYPE_BULK, size);
+    USBD_LL_OpenEP(pdev, USBD_CDC_MULTI_EP[port][2], USBD_EP_TYPE_INTR, CDC_CMD_PACKET_SIZE);
+
+    /* Default line coding, 115200 8N1 */
+    p->LineCoding.bitrate = 115200;
+    p->LineCoding.format = 0;
+    p->LineCoding.paritytype = 0;
+    p->LineCoding.datatype = 8;
+    p->ControlLineState = 0;
+    p->TxState = 0;
+    p->RxBuffer = NULL;
+
+    /* Interface sets memory for first OUT transfer */
+    USBD_CDC_MULTI_ITF(pdev)->Init(pdev, port);
+
+    /* Prepare Out endpoint to receive first packet */
+    if (p->RxBuffer != NULL)
+    {
+      USBD_LL_PrepareReceive(pdev, USBD_CDC_MULTI_EP[port][0], p->RxBuffer, size);
+    }
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_DeInit
+  *         DeInitialize all CDC ports
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MULTI_DeInit (USBD_HandleTypeDef *pdev,
+                                       uint8_t cfgidx)
+{
+  uint8_t port;
+
+  for (port = 0; port < USBD_CDC_MULTI_PORTS; port++)
+  {
+    /* Close endpoints */
+    USBD_LL_CloseEP(pdev, USBD_CDC_MULTI_EP[port][0]);
+    USBD_LL_CloseEP(pdev, USBD_CDC_MULTI_EP[port][1]);
+    USBD_LL_CloseEP(pdev, USBD_CDC_MULTI_EP[port][2]);
+
+    /* DeInit physical Interface components */
+    if (pdev->pClassData != NULL)
+    {
+      USBD_CDC_MULTI_ITF(pdev)->DeInit(pdev, port);
+    }
+  }
+
+  pdev->pClassData = NULL;
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_Setup
+  *         Handle the CDC specific requests for port which owns interface
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MULTI_Setup (USBD_HandleTypeDef *pdev,
+                                      USBD_SetupReqTypedef *req)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+  USBD_CDC_MULTI_PortTypeDef *p;
+  static uint8_t ifalt = 0;
+  uint8_t port;
+
+  switch (req->bmRequest & USB_REQ_TYPE_MASK)
+  {
+  case USB_REQ_TYPE_CLASS :
+    /* Class requests are sent to command interface of port */
+    port = LOBYTE(req->wIndex) / 2;
+    if ((req->bmRequest & USB_REQ_RECIPIENT_MASK) != USB_REQ_RECIPIENT_INTERFACE || port >= USBD_CDC_MULTI_PORTS)
+    {
+      USBD_CtlError(pdev, req);
+      return USBD_FAIL;
+    }
+    p = &h->Port[port];
+
+    if (req->wLength)
+    {
+      if (req->bmRequest & 0x80)
+      {
+        /* Line coding is kept by class */
+        if (req->bRequest == CDC_GET_LINE_CODING)
+        {
+          ((uint8_t *)h->data)[0] = (uint8_t)(p->LineCoding.bitrate);
+          ((uint8_t *)h->data)[1] = (uint8_t)(p->LineCoding.bitrate >> 8);
+          ((uint8_t *)h->data)[2] = (uint8_t)(p->LineCoding.bitrate >> 16);
+          ((uint8_t *)h->data)[3] = (uint8_t)(p->LineCoding.bitrate >> 24);
+          ((uint8_t *)h->data)[4] = p->LineCoding.format;
+          ((uint8_t *)h->data)[5] = p->LineCoding.paritytype;
+          ((uint8_t *)h->data)[6] = p->LineCoding.datatype;
+        }
+        else if (USBD_CDC_MULTI_ITF(pdev)->Control != NULL)
+        {
+          USBD_CDC_MULTI_ITF(pdev)->Control(pdev, port, req->bRequest, (uint8_t *)h->data, req->wLength);
+        }
+        USBD_CtlSendData (pdev,
+                          (uint8_t *)h->data,
+                          MIN(req->wLength, CDC_CMD_PACKET_SIZE));
+      }
+      else
+      {
+        h->CmdOpCode = req->bRequest;
+        h->CmdLength = MIN(req->wLength, CDC_CMD_PACKET_SIZE);
+        h->CmdPort = port;
+
+        USBD_CtlPrepareRx (pdev,
+                           (uint8_t *)h->data,
+                           h->CmdLength);
+      }
+    }
+    else
+    {
+      /* DTR and RTS, terminal opened or closed */
+      if (req->bRequest == CDC_SET_CONTROL_LINE_STATE)
+      {
+        p->ControlLineState = req->wValue;
+      }
+      if (USBD_CDC_MULTI_ITF(pdev)->Control != NULL)
+      {
+        USBD_CDC_MULTI_ITF(pdev)->Control(pdev, port, req->bRequest, (uint8_t *)req, 0);
+      }
+    }
+    break;
+
+  case USB_REQ_TYPE_STANDARD:
+    switch (req->bRequest)
+    {
+    case USB_REQ_GET_INTERFACE :
+      USBD_CtlSendData (pdev,
+                        &ifalt,
+                        1);
+      break;
+
+    case USB_REQ_SET_INTERFACE :
+      break;
+    }
+    break;
+
+  default:
+    break;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_EP0_RxReady
+  *         Data stage of class request received on control endpoint
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MULTI_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+  USBD_CDC_MULTI_PortTypeDef *p;
+  uint8_t *data;
+
+  if (h == NULL || h->CmdOpCode == 0xFF)
+  {
+    return USBD_OK;
+  }
+  p = &h->Port[h->CmdPort];
+  data = (uint8_t *)h->data;
+
+  /* Store line coding for port */
+  if (h->CmdOpCode == CDC_SET_LINE_CODING && h->CmdLength >= 7)
+  {
+    p->LineCoding.bitrate = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    p->LineCoding.format = data[4];
+    p->LineCoding.paritytype = data[5];
+    p->LineCoding.datatype = data[6];
+  }
+
+  if (USBD_CDC_MULTI_ITF(pdev)->Control != NULL)
+  {
+    USBD_CDC_MULTI_ITF(pdev)->Control(pdev, h->CmdPort, h->CmdOpCode, data, h->CmdLength);
+  }
+  h->CmdOpCode = 0xFF;
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_DataIn
+  *         Data sent on non-control IN endpoint
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MULTI_DataIn (USBD_HandleTypeDef *pdev,
+                                       uint8_t epnum)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+  uint8_t port = USBD_CDC_MULTI_GetPort(epnum, 1);
+
+  if (h == NULL)
+  {
+    return USBD_FAIL;
+  }
+
+  /* Command endpoints are not used for transfers */
+  if (port < USBD_CDC_MULTI_PORTS)
+  {
+    h->Port[port].TxState = 0;
+
+    /* Notify interface, next packet can be started from here */
+    if (USBD_CDC_MULTI_ITF(pdev)->TransmitCplt != NULL)
+    {
+      USBD_CDC_MULTI_ITF(pdev)->TransmitCplt(pdev, port);
+    }
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_DataOut
+  *         Data received on non-control Out endpoint
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_CDC_MULTI_DataOut (USBD_HandleTypeDef *pdev,
+                                        uint8_t epnum)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+  uint8_t port = USBD_CDC_MULTI_GetPort(epnum, 0);
+  USBD_CDC_MULTI_PortTypeDef *p;
+
+  if (h == NULL || port >= USBD_CDC_MULTI_PORTS)
+  {
+    return USBD_FAIL;
+  }
+  p = &h->Port[port];
+
+  /* Get the received data length */
+  p->RxLength = USBD_LL_GetRxDataSize (pdev, epnum);
+
+  /* Endpoint NAKs host until interface prepares next transfer */
+  USBD_CDC_MULTI_ITF(pdev)->Receive(pdev, port, p->RxBuffer, p->RxLength);
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_GetFSCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MULTI_GetFSCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MULTI_CfgFSDesc);
+  return USBD_CDC_MULTI_CfgFSDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_GetHSCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MULTI_GetHSCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MULTI_CfgHSDesc);
+  return USBD_CDC_MULTI_CfgHSDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_GetOtherSpeedCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MULTI_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MULTI_OtherSpeedCfgDesc);
+  return USBD_CDC_MULTI_OtherSpeedCfgDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_GetDeviceQualifierDescriptor
+  *         return Device Qualifier descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_CDC_MULTI_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+  *length = sizeof (USBD_CDC_MULTI_DeviceQualifierDesc);
+  return USBD_CDC_MULTI_DeviceQualifierDesc;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_RegisterInterface
+  * @param  pdev: device instance
+  * @param  fops: CDC multi interface callbacks
+  * @retval status
+  */
+uint8_t  USBD_CDC_MULTI_RegisterInterface (USBD_HandleTypeDef   *pdev,
+                                           USBD_CDC_MULTI_ItfTypeDef *fops)
+{
+  if (fops == NULL)
+  {
+    return USBD_FAIL;
+  }
+  pdev->pUserData = fops;
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_SetTxBuffer
+  * @param  pdev: device instance
+  * @param  port: port number
+  * @param  pbuff: Tx Buffer
+  * @param  length: number of bytes to send
+  * @retval status
+  */
+uint8_t  USBD_CDC_MULTI_SetTxBuffer (USBD_HandleTypeDef   *pdev,
+                                     uint8_t  port,
+                                     uint8_t  *pbuff,
+                                     uint32_t length)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = USBD_CDC_MULTI_HANDLE(pdev);
+
+  h->Port[port].TxBuffer = pbuff;
+  h->Port[port].TxLength = length;
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_SetRxBuffer
+  * @param  pdev: device instance
+  * @param  port: port number
+  * @param  pbuff: Rx Buffer, at least one packet long
+  * @retval status
+  */
+uint8_t  USBD_CDC_MULTI_SetRxBuffer (USBD_HandleTypeDef   *pdev,
+                                     uint8_t  port,
+                                     uint8_t  *pbuff)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = USBD_CDC_MULTI_HANDLE(pdev);
+
+  h->Port[port].RxBuffer = pbuff;
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_TransmitPacket
+  *         Start IN transfer on port data endpoint
+  * @param  pdev: device instance
+  * @param  port: port number
+  * @retval status
+  */
+uint8_t  USBD_CDC_MULTI_TransmitPacket (USBD_HandleTypeDef *pdev,
+                                        uint8_t  port)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+
+  if (h == NULL)
+  {
+    return USBD_FAIL;
+  }
+  if (h->Port[port].TxState)
+  {
+    return USBD_BUSY;
+  }
+
+  /* Tx Transfer in progress */
+  h->Port[port].TxState = 1;
+
+  /* Transmit next packet */
+  USBD_LL_Transmit(pdev,
+                   USBD_CDC_MULTI_EP[port][1],
+                   h->Port[port].TxBuffer,
+                   h->Port[port].TxLength);
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_CDC_MULTI_ReceivePacket
+  *         prepare OUT Endpoint of port for reception
+  * @param  pdev: device instance
+  * @param  port: port number
+  * @retval status
+  */
+uint8_t  USBD_CDC_MULTI_ReceivePacket (USBD_HandleTypeDef *pdev,
+                                       uint8_t  port)
+{
+  USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+
+  if (h == NULL)
+  {
+    return USBD_FAIL;
+  }
+
+  /* Prepare Out endpoint to receive next packet */
+  USBD_LL_PrepareReceive(pdev,
+                         USBD_CDC_MULTI_EP[port][0],
+                         h->Port[port].RxBuffer,
+                         pdev->dev_speed == USBD_SPEED_HIGH ? CDC_DATA_HS_OUT_PACKET_SIZE : CDC_DATA_FS_OUT_PACKET_SIZE);
+  return USBD_OK;
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
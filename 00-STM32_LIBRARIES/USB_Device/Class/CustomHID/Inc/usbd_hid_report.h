@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @file    usbd_hid_report.h
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   header file for the usbd_hid_report.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_HID_REPORT_H
+#define __USB_HID_REPORT_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup usbd_hid_report
+  * @brief This file is the Header file for usbd_hid_report.c
+  * @{
+  */
+
+
+/** @defgroup usbd_hid_report_Exported_Defines
+  * @{
+  */
+/* Maximal IN report size in bytes, including report ID, endpoint packet size */
+#ifndef USBD_HID_REPORT_IN_SIZE
+#define USBD_HID_REPORT_IN_SIZE             64
+#endif
+
+/* Maximal OUT report size in bytes, including report ID, endpoint packet size */
+#ifndef USBD_HID_REPORT_OUT_SIZE
+#define USBD_HID_REPORT_OUT_SIZE            64
+#endif
+
+/* Polling interval in full speed, in frames of 1 ms */
+#ifndef USBD_HID_REPORT_FS_INTERVAL
+#define USBD_HID_REPORT_FS_INTERVAL         1
+#endif
+
+/* Polling interval in high speed, 2^(n - 1) microframes of 125 us, 4 = 1 ms, 1 = 125 us */
+#ifndef USBD_HID_REPORT_HS_INTERVAL
+#define USBD_HID_REPORT_HS_INTERVAL         4
+#endif
+
+/* Endpoints */
+#define HID_REPORT_EPIN_ADDR                0x81
+#define HID_REPORT_EPOUT_ADDR               0x01
+
+/* Descriptor types and sizes */
+#define HID_REPORT_DESCRIPTOR_TYPE          0x21
+#define HID_REPORT_REPORT_DESC              0x22
+#define USB_HID_REPORT_DESC_SIZ             9
+#define USB_HID_REPORT_CONFIG_DESC_SIZ      41
+
+/* Class requests */
+#define HID_REPORT_REQ_GET_REPORT           0x01
+#define HID_REPORT_REQ_GET_IDLE             0x02
+#define HID_REPORT_REQ_GET_PROTOCOL         0x03
+#define HID_REPORT_REQ_SET_REPORT           0x09
+#define HID_REPORT_REQ_SET_IDLE             0x0A
+#define HID_REPORT_REQ_SET_PROTOCOL         0x0B
+
+/* Check settings */
+#if USBD_HID_REPORT_IN_SIZE < 1 || USBD_HID_REPORT_OUT_SIZE < 1
+#error "HID report sizes must be at least 1 byte!"
+#endif
+#if defined(USB_USE_FS) && (USBD_HID_REPORT_IN_SIZE > 64 || USBD_HID_REPORT_OUT_SIZE > 64)
+#error "Full speed interrupt endpoints carry at most 64 bytes!"
+#endif
+#if USBD_HID_REPORT_IN_SIZE > 1024 || USBD_HID_REPORT_OUT_SIZE > 1024
+#error "High speed interrupt endpoints carry at most 1024 bytes!"
+#endif
+#if USBD_HID_REPORT_FS_INTERVAL < 1 || USBD_HID_REPORT_FS_INTERVAL > 255 || USBD_HID_REPORT_HS_INTERVAL < 1 || USBD_HID_REPORT_HS_INTERVAL > 16
+#error "Invalid HID polling interval!"
+#endif
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+  * @{
+  */
+
+/* Interface callbacks, called from USB interrupt */
+typedef struct {
+  const uint8_t *pReport;                                       /* Report descriptor */
+  uint16_t ReportSize;                                          /* Report descriptor size in bytes */
+  int8_t   (*Init)      (USBD_HandleTypeDef *pdev);
+  int8_t   (*DeInit)    (USBD_HandleTypeDef *pdev);
+  int8_t   (*OutReport) (USBD_HandleTypeDef *pdev, uint8_t *pbuf, uint16_t len);  /* Report from OUT endpoint or SET_REPORT */
+  int8_t   (*InCplt)    (USBD_HandleTypeDef *pdev);             /* IN report was read by host, next one can be sent */
+} USBD_HID_REPORT_ItfTypeDef;
+
+/* Class data for one USB device */
+typedef struct {
+  uint8_t  OutBuf[USBD_HID_REPORT_OUT_SIZE];                    /* OUT report memory */
+  uint8_t  Protocol;                                            /* Boot or report protocol */
+  uint8_t  IdleState;                                           /* Idle rate set by host */
+  uint8_t  AltSetting;
+  uint8_t  ReportAvailable;                                     /* SET_REPORT data stage is pending */
+  uint16_t ReportLength;                                        /* SET_REPORT data length */
+  __IO uint8_t InBusy;                                          /* IN report is in transfer */
+} USBD_HID_REPORT_HandleTypeDef;
+
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_CORE_Exported_Macros
+  * @{
+  */
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_CORE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_HID_REPORT;
+#define USBD_HID_REPORT_CLASS    &USBD_HID_REPORT
+/**
+  * @}
+  */
+
+/** @defgroup USB_CORE_Exported_Functions
+  * @{
+  */
+uint8_t  USBD_HID_REPORT_RegisterInterface (USBD_HandleTypeDef   *pdev,
+                                            USBD_HID_REPORT_ItfTypeDef *fops);
+
+uint8_t  USBD_HID_REPORT_SendReport        (USBD_HandleTypeDef   *pdev,
+                                            uint8_t  *report,
+                                            uint16_t len);
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_HID_REPORT_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,565 @@
+/**
+  ******************************************************************************
+  * @file    usbd_hid_report.c
+  * @author  Tilen Majerle
+  * @version V1.0
+  * @date    14-October-2026
+  * @brief   This file provides HID device with custom report descriptor:
+  *           - Interrupt IN and OUT endpoints with configurable size and interval
+  *           - Report descriptor given by interface at runtime
+  *           - Transfer complete notification for report queues
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                             HID Report Driver Description
+  *          ===================================================================
+  *           Interface 0 is HID interface with EP 0x81 (IN reports) and
+  *           EP 0x01 (OUT reports). Host polls IN endpoint each
+  *           USBD_HID_REPORT_FS_INTERVAL frames in full speed or each
+  *           2^(USBD_HID_REPORT_HS_INTERVAL - 1) microframes in high speed.
+  *
+  *           Report descriptor and its size are taken from interface callbacks
+  *           structure, so one class serves any report layout. Class data is
+  *           static for FS and HS device, no memory is allocated.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_hid_report.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_HID_REPORT
+  * @brief usbd core module
+  * @{
+  */
+
+/** @defgroup USBD_HID_REPORT_Private_TypesDefinitions
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_HID_REPORT_Private_Defines
+  * @{
+  */
+
+/* Offset of report descriptor length in HID descriptor and in configuration descriptor */
+#define HID_REPORT_DESC_LEN_OFFSET          7
+#define HID_REPORT_CFG_LEN_OFFSET           (18 + HID_REPORT_DESC_LEN_OFFSET)
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_HID_REPORT_Private_Macros
+  * @{
+  */
+
+/* Get class handle for device */
+#define USBD_HID_REPORT_HANDLE(pdev)       (&USBD_HID_REPORT_Handle[(pdev)->id == 0 ? 0 : 1])
+
+/* Interface callbacks */
+#define USBD_HID_REPORT_ITF(pdev)          ((USBD_HID_REPORT_ItfTypeDef *)(pdev)->pUserData)
+
+/* HID descriptor, report descriptor length is set when interface is registered */
+#define USBD_HID_REPORT_HID_DESC                                           \
+  0x09,   /* bLength: HID Descriptor size */                               \
+  HID_REPORT_DESCRIPTOR_TYPE,  /* bDescriptorType: HID */                  \
+  0x11,   /* bcdHID: HID Class Spec release number 1.11 */                 \
+  0x01,                                                                    \
+  0x00,   /* bCountryCode: Hardware target country */                      \
+  0x01,   /* bNumDescriptors: Number of HID class descriptors to follow */ \
+  HID_REPORT_REPORT_DESC,  /* bDescriptorType: Report */                   \
+  0x00,   /* wItemLength: Total length of Report descriptor */             \
+  0x00
+
+/* Configuration descriptor, same layout for all speeds */
+#define USBD_HID_REPORT_CFG_DESC(type, interval)                           \
+  /*Configuration Descriptor*/                                             \
+  0x09,   /* bLength: Configuration Descriptor size */                     \
+  type,   /* bDescriptorType: Configuration */                             \
+  LOBYTE(USB_HID_REPORT_CONFIG_DESC_SIZ),  /* wTotalLength */              \
+  HIBYTE(USB_HID_REPORT_CONFIG_DESC_SIZ),                                  \
+  0x01,   /* bNumInterfaces: 1 interface */                                \
+  0x01,   /* bConfigurationValue: Configuration value */                   \
+  0x00,   /* iConfiguration */                                             \
+  0xC0,   /* bmAttributes: self powered */                                 \
+  0x32,   /* MaxPower 100 mA */                                            \
+                                                                           \
+  /*HID Interface Descriptor*/                                             \
+  0x09,   /* bLength: Interface Descriptor size */                         \
+  USB_DESC_TYPE_INTERFACE,  /* bDescriptorType: Interface */               \
+  0x00,   /* bInterfaceNumber */                                           \
+  0x00,   /* bAlternateSetting */                                          \
+  0x02,   /* bNumEndpoints */                                              \
+  0x03,   /* bInterfaceClass: HID */                                       \
+  0x00,   /* bInterfaceSubClass: no boot */                                \
+  0x00,   /* nInterfaceProtocol: none */                                   \
+  0x00,   /* iInterface */                                                 \
+                                                                           \
+  USBD_HID_REPORT_HID_DESC,                                                \
+                                                                           \
+  /*HID Endpoint IN Descriptor*/                                           \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  HID_REPORT_EPIN_ADDR,    /* bEndpointAddress */                          \
+  0x03,   /* bmAttributes: Interrupt */                                    \
+  LOBYTE(USBD_HID_REPORT_IN_SIZE),  /* wMaxPacketSize */                   \
+  HIBYTE(USBD_HID_REPORT_IN_SIZE),                                         \
+  interval,  /* bInterval */                                               \
+                                                                           \
+  /*HID Endpoint OUT Descriptor*/                                          \
+  0x07,   /* bLength: Endpoint Descriptor size */                          \
+  USB_DESC_TYPE_ENDPOINT,  /* bDescriptorType: Endpoint */                 \
+  HID_REPORT_EPOUT_ADDR,   /* bEndpointAddress */                          \
+  0x03,   /* bmAttributes: Interrupt */                                    \
+  LOBYTE(USBD_HID_REPORT_OUT_SIZE),  /* wMaxPacketSize */                  \
+  HIBYTE(USBD_HID_REPORT_OUT_SIZE),                                        \
+  interval   /* bInterval */
+
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_HID_REPORT_Private_FunctionPrototypes
+  * @{
+  */
+
+
+static uint8_t  USBD_HID_REPORT_Init (USBD_HandleTypeDef *pdev,
+                                      uint8_t cfgidx);
+
+static uint8_t  USBD_HID_REPORT_DeInit (USBD_HandleTypeDef *pdev,
+                                        uint8_t cfgidx);
+
+static uint8_t  USBD_HID_REPORT_Setup (USBD_HandleTypeDef *pdev,
+                                       USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_HID_REPORT_EP0_RxReady (USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_HID_REPORT_DataIn (USBD_HandleTypeDef *pdev,
+                                        uint8_t epnum);
+
+static uint8_t  USBD_HID_REPORT_DataOut (USBD_HandleTypeDef *pdev,
+                                         uint8_t epnum);
+
+static uint8_t  *USBD_HID_REPORT_GetFSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_HID_REPORT_GetHSCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_HID_REPORT_GetOtherSpeedCfgDesc (uint16_t *length);
+
+static uint8_t  *USBD_HID_REPORT_GetDeviceQualifierDescriptor (uint16_t *length);
+
+/* USB Standard Device Qualifier Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_HID_REPORT_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+  USB_LEN_DEV_QUALIFIER_DESC,
+  USB_DESC_TYPE_DEVICE_QUALIFIER,
+  0x00,
+  0x02,
+  0x00,
+  0x00,
+  0x00,
+  0x40,
+  0x01,
+  0x00,
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_HID_REPORT_Private_Variables
+  * @{
+  */
+
+/* Class data for FS and HS device */
+static USBD_HID_REPORT_HandleTypeDef USBD_HID_REPORT_Handle[2];
+
+/* HID report interface class callbacks structure */
+USBD_ClassTypeDef  USBD_HID_REPORT =
+{
+  USBD_HID_REPORT_Init,
+  USBD_HID_REPORT_DeInit,
+  USBD_HID_REPORT_Setup,
+  NULL,                 /* EP0_TxSent, */
+  USBD_HID_REPORT_EP0_RxReady,
+  USBD_HID_REPORT_DataIn,
+  USBD_HID_REPORT_DataOut,
+  NULL,
+  NULL,
+  NULL,
+  USBD_HID_REPORT_GetHSCfgDesc,
+  USBD_HID_REPORT_GetFSCfgDesc,
+  USBD_HID_REPORT_GetOtherSpeedCfgDesc,
+  USBD_HID_REPORT_GetDeviceQualifierDescriptor,
+};
+
+/* USB HID report device Configuration Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_HID_REPORT_CfgHSDesc[USB_HID_REPORT_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_HID_REPORT_CFG_DESC(USB_DESC_TYPE_CONFIGURATION, USBD_HID_REPORT_HS_INTERVAL)
+};
+
+__ALIGN_BEGIN static uint8_t USBD_HID_REPORT_CfgFSDesc[USB_HID_REPORT_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_HID_REPORT_CFG_DESC(USB_DESC_TYPE_CONFIGURATION, USBD_HID_REPORT_FS_INTERVAL)
+};
+
+__ALIGN_BEGIN static uint8_t USBD_HID_REPORT_OtherSpeedCfgDesc[USB_HID_REPORT_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  USBD_HID_REPORT_CFG_DESC(USB_DESC_TYPE_OTHER_SPEED_CONFIGURATION, USBD_HID_REPORT_FS_INTERVAL)
+};
+
+/* USB HID Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_HID_REPORT_Desc[USB_HID_REPORT_DESC_SIZ] __ALIGN_END =
+{
+  USBD_HID_REPORT_HID_DESC
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_HID_REPORT_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_HID_REPORT_Init
+  *         Initialize the HID interface
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_HID_REPORT_Init (USBD_HandleTypeDef *pdev,
+                                      uint8_t cfgidx)
+{
+  USBD_HID_REPORT_HandleTypeDef *h = USBD_HID_REPORT_HANDLE(pdev);
+
+  /* Open endpoints */
+  USBD_LL_OpenEP(pdev, HID_REPORT_EPIN_ADDR, USBD_EP_TYPE_INTR, USBD_HID_REPORT_IN_SIZE);
+  USBD_LL_OpenEP(pdev, HID_REPORT_EPOUT_ADDR, USBD_EP_TYPE_INTR, USBD_HID_REPORT_OUT_SIZE);
+
+  /* Report protocol, no idle reports */
+  h->Protocol = 1;
+  h->IdleState = 0;
+  h->AltSetting = 0;
+  h->ReportAvailable = 0;
+  h->InBusy = 0;
+  pdev->pClassData = h;
+
+  /* Init physical Interface components */
+  USBD_HID_REPORT_ITF(pdev)->Init(pdev);
+
+  /* Prepare Out endpoint to receive first report */
+  USBD_LL_PrepareReceive(pdev, HID_REPORT_EPOUT_ADDR, h->OutBuf, USBD_HID_REPORT_OUT_SIZE);
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_DeInit
+  *         DeInitialize the HID layer
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_HID_REPORT_DeInit (USBD_HandleTypeDef *pdev,
+                                        uint8_t cfgidx)
+{
+  /* Close endpoints */
+  USBD_LL_CloseEP(pdev, HID_REPORT_EPIN_ADDR);
+  USBD_LL_CloseEP(pdev, HID_REPORT_EPOUT_ADDR);
+
+  /* DeInit physical Interface components */
+  if (pdev->pClassData != NULL)
+  {
+    USBD_HID_REPORT_ITF(pdev)->DeInit(pdev);
+    pdev->pClassData = NULL;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_Setup
+  *         Handle the HID specific requests
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_HID_REPORT_Setup (USBD_HandleTypeDef *pdev,
+                                       USBD_SetupReqTypedef *req)
+{
+  USBD_HID_REPORT_HandleTypeDef *h = (USBD_HID_REPORT_HandleTypeDef *) pdev->pClassData;
+  uint8_t *pbuf = NULL;
+  uint16_t len = 0;
+
+  switch (req->bmRequest & USB_REQ_TYPE_MASK)
+  {
+  case USB_REQ_TYPE_CLASS :
+    switch (req->bRequest)
+    {
+    case HID_REPORT_REQ_SET_PROTOCOL:
+      h->Protocol = (uint8_t)(req->wValue);
+      break;
+
+    case HID_REPORT_REQ_GET_PROTOCOL:
+      USBD_CtlSendData (pdev, &h->Protocol, 1);
+      break;
+
+    case HID_REPORT_REQ_SET_IDLE:
+      h->IdleState = (uint8_t)(req->wValue >> 8);
+      break;
+
+    case HID_REPORT_REQ_GET_IDLE:
+      USBD_CtlSendData (pdev, &h->IdleState, 1);
+      break;
+
+    case HID_REPORT_REQ_SET_REPORT:
+      /* Report is passed to interface when data stage is received */
+      h->ReportAvailable = 1;
+      h->ReportLength = MIN(req->wLength, USBD_HID_REPORT_OUT_SIZE);
+      USBD_CtlPrepareRx (pdev, h->OutBuf, h->ReportLength);
+      break;
+
+    default:
+      USBD_CtlError (pdev, req);
+      return USBD_FAIL;
+    }
+    break;
+
+  case USB_REQ_TYPE_STANDARD:
+    switch (req->bRequest)
+    {
+    case USB_REQ_GET_DESCRIPTOR:
+      if (req->wValue >> 8 == HID_REPORT_REPORT_DESC)
+      {
+        pbuf = (uint8_t *)USBD_HID_REPORT_ITF(pdev)->pReport;
+        len = MIN(USBD_HID_REPORT_ITF(pdev)->ReportSize, req->wLength);
+      }
+      else if (req->wValue >> 8 == HID_REPORT_DESCRIPTOR_TYPE)
+      {
+        pbuf = USBD_HID_REPORT_Desc;
+        len = MIN(USB_HID_REPORT_DESC_SIZ, req->wLength);
+      }
+      USBD_CtlSendData (pdev, pbuf, len);
+      break;
+
+    case USB_REQ_GET_INTERFACE :
+      USBD_CtlSendData (pdev, &h->AltSetting, 1);
+      break;
+
+    case USB_REQ_SET_INTERFACE :
+      h->AltSetting = (uint8_t)(req->wValue);
+      break;
+    }
+    break;
+
+  default:
+    break;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_EP0_RxReady
+  *         SET_REPORT data received on control endpoint
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_HID_REPORT_EP0_RxReady (USBD_HandleTypeDef *pdev)
+{
+  USBD_HID_REPORT_HandleTypeDef *h = (USBD_HID_REPORT_HandleTypeDef *) pdev->pClassData;
+
+  if (h != NULL && h->ReportAvailable)
+  {
+    h->ReportAvailable = 0;
+    USBD_HID_REPORT_ITF(pdev)->OutReport(pdev, h->OutBuf, h->ReportLength);
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_DataIn
+  *         IN report was read by host
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_HID_REPORT_DataIn (USBD_HandleTypeDef *pdev,
+                                        uint8_t epnum)
+{
+  USBD_HID_REPORT_HandleTypeDef *h = (USBD_HID_REPORT_HandleTypeDef *) pdev->pClassData;
+
+  if (h == NULL)
+  {
+    return USBD_FAIL;
+  }
+  h->InBusy = 0;
+
+  /* Notify interface, next report can be sent from here */
+  if (USBD_HID_REPORT_ITF(pdev)->InCplt != NULL)
+  {
+    USBD_HID_REPORT_ITF(pdev)->InCplt(pdev);
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_DataOut
+  *         OUT report received on interrupt endpoint
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t  USBD_HID_REPORT_DataOut (USBD_HandleTypeDef *pdev,
+                                         uint8_t epnum)
+{
+  USBD_HID_REPORT_HandleTypeDef *h = (USBD_HID_REPORT_HandleTypeDef *) pdev->pClassData;
+
+  if (h == NULL)
+  {
+    return USBD_FAIL;
+  }
+
+  /* Pass report to interface and receive next one */
+  USBD_HID_REPORT_ITF(pdev)->OutReport(pdev, h->OutBuf, USBD_LL_GetRxDataSize(pdev, epnum));
+  USBD_LL_PrepareReceive(pdev, HID_REPORT_EPOUT_ADDR, h->OutBuf, USBD_HID_REPORT_OUT_SIZE);
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_GetFSCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_HID_REPORT_GetFSCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_HID_REPORT_CfgFSDesc);
+  return USBD_HID_REPORT_CfgFSDesc;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_GetHSCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_HID_REPORT_GetHSCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_HID_REPORT_CfgHSDesc);
+  return USBD_HID_REPORT_CfgHSDesc;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_GetOtherSpeedCfgDesc
+  *         Return configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_HID_REPORT_GetOtherSpeedCfgDesc (uint16_t *length)
+{
+  *length = sizeof (USBD_HID_REPORT_OtherSpeedCfgDesc);
+  return USBD_HID_REPORT_OtherSpeedCfgDesc;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_GetDeviceQualifierDescriptor
+  *         return Device Qualifier descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_HID_REPORT_GetDeviceQualifierDescriptor (uint16_t *length)
+{
+  *length = sizeof (USBD_HID_REPORT_DeviceQualifierDesc);
+  return USBD_HID_REPORT_DeviceQualifierDesc;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_RegisterInterface
+  *         Register interface callbacks, report descriptor length is written to descriptors
+  * @param  pdev: device instance
+  * @param  fops: HID report interface callbacks
+  * @retval status
+  */
+uint8_t  USBD_HID_REPORT_RegisterInterface (USBD_HandleTypeDef   *pdev,
+                                            USBD_HID_REPORT_ItfTypeDef *fops)
+{
+  if (fops == NULL || fops->pReport == NULL)
+  {
+    return USBD_FAIL;
+  }
+  pdev->pUserData = fops;
+
+  /* Descriptors are shared by FS and HS device, both use the same report descriptor size */
+  USBD_HID_REPORT_Desc[HID_REPORT_DESC_LEN_OFFSET] = LOBYTE(fops->ReportSize);
+  USBD_HID_REPORT_Desc[HID_REPORT_DESC_LEN_OFFSET + 1] = HIBYTE(fops->ReportSize);
+  USBD_HID_REPORT_CfgFSDesc[HID_REPORT_CFG_LEN_OFFSET] = LOBYTE(fops->ReportSize);
+  USBD_HID_REPORT_CfgFSDesc[HID_REPORT_CFG_LEN_OFFSET + 1] = HIBYTE(fops->ReportSize);
+  USBD_HID_REPORT_CfgHSDesc[HID_REPORT_CFG_LEN_OFFSET] = LOBYTE(fops->ReportSize);
+  USBD_HID_REPORT_CfgHSDesc[HID_REPORT_CFG_LEN_OFFSET + 1] = HIBYTE(fops->ReportSize);
+  USBD_HID_REPORT_OtherSpeedCfgDesc[HID_REPORT_CFG_LEN_OFFSET] = LOBYTE(fops->ReportSize);
+  USBD_HID_REPORT_OtherSpeedCfgDesc[HID_REPORT_CFG_LEN_OFFSET + 1] = HIBYTE(fops->ReportSize);
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_HID_REPORT_SendReport
+  *         Start IN report transfer, memory must stay valid until InCplt callback
+  * @param  pdev: device instance
+  * @param  report: pointer to report
+  * @param  len: report length in bytes
+  * @retval status
+  */
+uint8_t  USBD_HID_REPORT_SendReport (USBD_HandleTypeDef   *pdev,
+                                     uint8_t  *report,
+                                     uint16_t len)
+{
+  USBD_HID_REPORT_HandleTypeDef *h = (USBD_HID_REPORT_HandleTypeDef *) pdev->pClassData;
+
+  if (h == NULL || pdev->dev_state != USBD_STATE_CONFIGURED)
+  {
+    return USBD_FAIL;
+  }
+  if (h->InBusy)
+  {
+    return USBD_BUSY;
+  }
+
+  /* Report is sent on next poll from host */
+  h->InBusy = 1;
+  USBD_LL_Transmit(pdev, HID_REPORT_EPIN_ADDR, report, MIN(len, USBD_HID_REPORT_IN_SIZE));
+
+  return USBD_OK;
+}
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
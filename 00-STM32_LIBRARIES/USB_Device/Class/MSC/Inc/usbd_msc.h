@@ -59,8 +59,13 @@
 #define USB_MSC_CONFIG_DESC_SIZ      32
  
 
-#define MSC_EPIN_ADDR                0x81 
-#define MSC_EPOUT_ADDR               0x01 
+/* EP3 is used by default, so MSC does not collide with CDC endpoints in composite device */
+#ifndef MSC_EPIN_ADDR
+#define MSC_EPIN_ADDR                0x83 
+#endif
+#ifndef MSC_EPOUT_ADDR
+#define MSC_EPOUT_ADDR               0x03 
+#endif
 
 /**
   * @}
@@ -79,6 +84,10 @@ typedef struct _USBD_STORAGE
   int8_t (* Write)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
   int8_t (* GetMaxLun)(void);
   int8_t *pInquiry;
+  /* Optional, media transfers in background while USB transfers previous packet */
+  int8_t (* ReadStart) (uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+  int8_t (* WriteStart)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+  int8_t (* Wait)(uint8_t lun);
   
 }USBD_StorageTypeDef;
 
@@ -103,6 +112,9 @@ typedef struct
   
   uint32_t                 scsi_blk_addr;
   uint32_t                 scsi_blk_len;
+  
+  uint8_t                  scsi_buf;      /* Half of bot_data used by USB in pipelined mode */
+  uint32_t                 scsi_pending;  /* Bytes in media transfer started in background */
 }
 USBD_MSC_BOT_HandleTypeDef; 
 
@@ -112,6 +112,9 @@ void MSC_BOT_Init (USBD_HandleTypeDef  *pdev)
   hmsc->scsi_sense_tail = 0;
   hmsc->scsi_sense_head = 0;
   
+  hmsc->scsi_buf = 0;
+  hmsc->scsi_pending = 0;
+  
   ((USBD_StorageTypeDef *)pdev->pUserData)->Init(0);
   
   USBD_LL_FlushEP(pdev, MSC_EPOUT_ADDR);
@@ -100,6 +100,13 @@ static int8_t SCSI_ProcessRead (USBD_HandleTypeDef  *pdev,
 
 static int8_t SCSI_ProcessWrite (USBD_HandleTypeDef  *pdev,
                                  uint8_t lun);
+
+static void SCSI_FinishMedia (USBD_HandleTypeDef  *pdev,
+                              uint8_t lun);
+
+/* Storage can transfer media in background, bot_data is used as 2 halves */
+#define SCSI_PIPELINE(pdev)          (((USBD_StorageTypeDef *)(pdev)->pUserData)->Wait != NULL)
+#define SCSI_MEDIA_CHUNK(pdev)       (SCSI_PIPELINE(pdev) ? (MSC_MEDIA_PACKET / 2) : MSC_MEDIA_PACKET)
 /**
   * @}
   */ 
@@ -494,6 +501,9 @@ static int8_t SCSI_Read10(USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *para
       return -1; /* error */
     }
     
+    /* Finish unfinished background transfer from aborted command */
+    SCSI_FinishMedia(pdev, lun);
+    
     hmsc->bot_state = USBD_BOT_DATA_IN;
     hmsc->scsi_blk_addr *= hmsc->scsi_blk_size;
     hmsc->scsi_blk_len  *= hmsc->scsi_blk_size;
@@ -589,12 +599,15 @@ static int8_t SCSI_Write10 (USBD_HandleTypeDef  *pdev, uint8_t lun , uint8_t *pa
       return -1;
     }
     
+    /* Finish unfinished background transfer from aborted command */
+    SCSI_FinishMedia(pdev, lun);
+    
     /* Prepare EP to receive first data packet */
     hmsc->bot_state = USBD_BOT_DATA_OUT;  
     USBD_LL_PrepareReceive (pdev,
                       MSC_EPOUT_ADDR,
                       hmsc->bot_data, 
-                      MIN (hmsc->scsi_blk_len, MSC_MEDIA_PACKET));  
+                      MIN (hmsc->scsi_blk_len, SCSI_MEDIA_CHUNK(pdev)));  
   }
   else /* Write Process ongoing */
   {
@@ -648,6 +661,19 @@ static int8_t SCSI_CheckAddressRange (USBD_HandleTypeDef  *pdev, uint8_t lun , u
 {
   USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData; 
   
+  /* Capacity is shared by all LUNs, get capacity of addressed LUN */
+  if (hmsc->max_lun > 0)
+  {
+    if(((USBD_StorageTypeDef *)pdev->pUserData)->GetCapacity(lun, &hmsc->scsi_blk_nbr, &hmsc->scsi_blk_size) != 0)
+    {
+      SCSI_SenseCode(pdev,
+                     lun,
+                     NOT_READY, 
+                     MEDIUM_NOT_PRESENT);
+      return -1;
+    }
+  }
+  
   if ((blk_offset + blk_nbr) > hmsc->scsi_blk_nbr )
   {
     SCSI_SenseCode(pdev,
@@ -659,23 +685,77 @@ static int8_t SCSI_CheckAddressRange (USBD_HandleTypeDef  *pdev, uint8_t lun , u
   return 0;
 }
 
+/**
+* @brief  SCSI_FinishMedia
+*         Wait for media transfer started in background and reset pipeline
+* @param  lun: Logical unit number
+* @retval None
+*/
+static void SCSI_FinishMedia (USBD_HandleTypeDef  *pdev, uint8_t lun)
+{
+  USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;   
+  
+  if (hmsc->scsi_pending != 0)
+  {
+    hmsc->scsi_pending = 0;
+    ((USBD_StorageTypeDef *)pdev->pUserData)->Wait(lun);
+  }
+  hmsc->scsi_buf = 0;
+}
+
 /**
 * @brief  SCSI_ProcessRead
 *         Handle Read Process
+*         In pipelined mode next packet is read from media while current one is sent
 * @param  lun: Logical unit number
 * @retval status
 */
 static int8_t SCSI_ProcessRead (USBD_HandleTypeDef  *pdev, uint8_t lun)
 {
   USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*)pdev->pClassData;   
+  USBD_StorageTypeDef *storage = (USBD_StorageTypeDef *)pdev->pUserData;
+  uint8_t *buf;
   uint32_t len;
+  int8_t ret;
   
-  len = MIN(hmsc->scsi_blk_len , MSC_MEDIA_PACKET); 
+  if (SCSI_PIPELINE(pdev))
+  {
+    buf = &hmsc->bot_data[hmsc->scsi_buf * (MSC_MEDIA_PACKET / 2)];
+    
+    if (hmsc->scsi_pending == 0)
+    {
+      /* First packet, nothing was read in background yet */
+      len = MIN(hmsc->scsi_blk_len , MSC_MEDIA_PACKET / 2);
+      ret = storage->ReadStart(lun,
+                               buf,
+                               hmsc->scsi_blk_addr / hmsc->scsi_blk_size,
+                               len / hmsc->scsi_blk_size);
+    }
+    else
+    {
+      /* Packet was read in background while previous one was sent */
+      len = hmsc->scsi_pending;
+      ret = 0;
+    }
+    
+    /* Wait for data in memory */
+    hmsc->scsi_pending = 0;
+    if (storage->Wait(lun) < 0)
+    {
+      ret = -1;
+    }
+  }
+  else
+  {
+    buf = hmsc->bot_data;
+    len = MIN(hmsc->scsi_blk_len , MSC_MEDIA_PACKET); 
+    ret = storage->Read(lun ,
+                        buf, 
+                        hmsc->scsi_blk_addr / hmsc->scsi_blk_size, 
+                        len / hmsc->scsi_blk_size);
+  }
   
-  if( ((USBD_StorageTypeDef *)pdev->pUserData)->Read(lun ,
-                              hmsc->bot_data, 
-                              hmsc->scsi_blk_addr / hmsc->scsi_blk_size, 
-                              len / hmsc->scsi_blk_size) < 0)
+  if (ret < 0)
   {
     
     SCSI_SenseCode(pdev,
@@ -688,7 +768,7 @@ static int8_t SCSI_ProcessRead (USBD_HandleTypeDef  *pdev, uint8_t lun)
   
   USBD_LL_Transmit (pdev, 
              MSC_EPIN_ADDR,
-             hmsc->bot_data,
+             buf,
              len);
   
   
@@ -702,28 +782,71 @@ static int8_t SCSI_ProcessRead (USBD_HandleTypeDef  *pdev, uint8_t lun)
   {
     hmsc->bot_state = USBD_BOT_LAST_DATA_IN;
   }
+  else if (SCSI_PIPELINE(pdev))
+  {
+    /* Read next packet to other half while this one is sent, errors are reported by Wait */
+    hmsc->scsi_buf ^= 1;
+    hmsc->scsi_pending = MIN(hmsc->scsi_blk_len , MSC_MEDIA_PACKET / 2);
+    storage->ReadStart(lun,
+                       &hmsc->bot_data[hmsc->scsi_buf * (MSC_MEDIA_PACKET / 2)],
+                       hmsc->scsi_blk_addr / hmsc->scsi_blk_size,
+                       hmsc->scsi_pending / hmsc->scsi_blk_size);
+  }
   return 0;
 }
 
 /**
 * @brief  SCSI_ProcessWrite
 *         Handle Write Process
+*         In pipelined mode next packet is received while current one is written to media
 * @param  lun: Logical unit number
 * @retval status
 */
 
 static int8_t SCSI_ProcessWrite (USBD_HandleTypeDef  *pdev, uint8_t lun)
 {
-  uint32_t len;
   USBD_MSC_BOT_HandleTypeDef  *hmsc = (USBD_MSC_BOT_HandleTypeDef*) pdev->pClassData; 
+  USBD_StorageTypeDef *storage = (USBD_StorageTypeDef *)pdev->pUserData;
+  uint8_t *buf;
+  uint32_t len;
+  int8_t ret;
   
-  len = MIN(hmsc->scsi_blk_len , MSC_MEDIA_PACKET); 
+  len = MIN(hmsc->scsi_blk_len , SCSI_MEDIA_CHUNK(pdev)); 
   
-  if(((USBD_StorageTypeDef *)pdev->pUserData)->Write(lun ,
-                              hmsc->bot_data, 
-                              hmsc->scsi_blk_addr / hmsc->scsi_blk_size, 
-                              len / hmsc->scsi_blk_size) < 0)
+  if (SCSI_PIPELINE(pdev))
   {
+    buf = &hmsc->bot_data[hmsc->scsi_buf * (MSC_MEDIA_PACKET / 2)];
+    ret = 0;
+    
+    /* Previous packet must be on media before next media transfer */
+    if (hmsc->scsi_pending != 0)
+    {
+      hmsc->scsi_pending = 0;
+      ret = storage->Wait(lun);
+    }
+    
+    /* Start write in background */
+    if (ret >= 0)
+    {
+      ret = storage->WriteStart(lun,
+                                buf,
+                                hmsc->scsi_blk_addr / hmsc->scsi_blk_size,
+                                len / hmsc->scsi_blk_size);
+      hmsc->scsi_pending = len;
+    }
+  }
+  else
+  {
+    buf = hmsc->bot_data;
+    ret = storage->Write(lun ,
+                         buf, 
+                         hmsc->scsi_blk_addr / hmsc->scsi_blk_size, 
+                         len / hmsc->scsi_blk_size);
+  }
+  
+  if (ret < 0)
+  {
+    SCSI_FinishMedia(pdev, lun);
     SCSI_SenseCode(pdev,
                    lun, 
                    HARDWARE_ERROR, 
@@ -740,15 +863,34 @@ static int8_t SCSI_ProcessWrite (USBD_HandleTypeDef  *pdev, uint8_t lun)
   
   if (hmsc->scsi_blk_len == 0)
   {
+    /* Status is sent when all data are on media */
+    if (hmsc->scsi_pending != 0)
+    {
+      hmsc->scsi_pending = 0;
+      if (storage->Wait(lun) < 0)
+      {
+        SCSI_SenseCode(pdev,
+                       lun, 
+                       HARDWARE_ERROR, 
+                       WRITE_FAULT);     
+        return -1; 
+      }
+    }
     MSC_BOT_SendCSW (pdev, USBD_CSW_CMD_PASSED);
   }
   else
   {
+    /* Receive next packet to other half while this one is written */
+    if (SCSI_PIPELINE(pdev))
+    {
+      hmsc->scsi_buf ^= 1;
+    }
+    
     /* Prepare EP to Receive next packet */
     USBD_LL_PrepareReceive (pdev,
                             MSC_EPOUT_ADDR,
-                            hmsc->bot_data, 
-                            MIN (hmsc->scsi_blk_len, MSC_MEDIA_PACKET)); 
+                            &hmsc->bot_data[hmsc->scsi_buf * (MSC_MEDIA_PACKET / 2)], 
+                            MIN (hmsc->scsi_blk_len, SCSI_MEDIA_CHUNK(pdev))); 
   }
   
   return 0;
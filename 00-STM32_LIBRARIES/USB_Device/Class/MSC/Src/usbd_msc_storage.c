@@ -28,7 +28,6 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "usbd_msc_storage.h"
-#include "fatfs_sd_sdio.h"
 #include "tm_stm32_usb_device_msc.h"
 
 /* Private typedef -----------------------------------------------------------*/
@@ -51,6 +50,9 @@ int8_t STORAGE_FS_IsWriteProtected(uint8_t lun);
 int8_t STORAGE_FS_Read(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
 int8_t STORAGE_FS_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
 int8_t STORAGE_FS_GetMaxLun(void);
+int8_t STORAGE_FS_ReadStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+int8_t STORAGE_FS_WriteStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+int8_t STORAGE_FS_Wait(uint8_t lun);
 int8_t STORAGE_HS_Init(uint8_t lun);
 int8_t STORAGE_HS_GetCapacity(uint8_t lun, uint32_t *block_num, uint16_t *block_size);
 int8_t STORAGE_HS_IsReady(uint8_t lun);
@@ -58,9 +60,12 @@ int8_t STORAGE_HS_IsWriteProtected(uint8_t lun);
 int8_t STORAGE_HS_Read(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
 int8_t STORAGE_HS_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
 int8_t STORAGE_HS_GetMaxLun(void);
+int8_t STORAGE_HS_ReadStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+int8_t STORAGE_HS_WriteStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+int8_t STORAGE_HS_Wait(uint8_t lun);
 
-/* USB Mass storage Standard Inquiry Data */
-int8_t STORAGE_Inquirydata[] = {//36
+/* USB Mass storage Standard Inquiry Data, other LUNs are filled from LUN 0 on init */
+int8_t STORAGE_Inquirydata[STANDARD_INQUIRY_DATA_LEN * USBD_MSC_LUNS] = {//36
   /* LUN 0 */
   0x00,		
   0x80,		
@@ -85,7 +90,12 @@ USBD_StorageTypeDef USBD_MSC_fops[] = {{
 	STORAGE_FS_Read,
 	STORAGE_FS_Write,
 	STORAGE_FS_GetMaxLun,
-	STORAGE_Inquirydata
+	STORAGE_Inquirydata,
+#if USBD_MSC_PIPELINE
+	STORAGE_FS_ReadStart,
+	STORAGE_FS_WriteStart,
+	STORAGE_FS_Wait
+#endif
 #else
 	0,0,0,0,0,0,0,0
 #endif
@@ -98,7 +108,12 @@ USBD_StorageTypeDef USBD_MSC_fops[] = {{
 	STORAGE_HS_Read,
 	STORAGE_HS_Write,
 	STORAGE_HS_GetMaxLun,
-	STORAGE_Inquirydata
+	STORAGE_Inquirydata,
+#if USBD_MSC_PIPELINE
+	STORAGE_HS_ReadStart,
+	STORAGE_HS_WriteStart,
+	STORAGE_HS_Wait
+#endif
 #else
 	0,0,0,0,0,0,0,0
 #endif
@@ -166,12 +181,48 @@ int8_t STORAGE_HS_Read(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t bl
 
 #if defined(USB_USE_FS)
 int8_t STORAGE_FS_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
-	return TM_USBD_MSC_ReadCallback(&hUSBDevice_FS, lun, buf, blk_addr, blk_len);
+	return TM_USBD_MSC_WriteCallback(&hUSBDevice_FS, lun, buf, blk_addr, blk_len);
 }
 #endif
 #if defined(USB_USE_HS)
 int8_t STORAGE_HS_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
-	return TM_USBD_MSC_ReadCallback(&hUSBDevice_HS, lun, buf, blk_addr, blk_len);
+	return TM_USBD_MSC_WriteCallback(&hUSBDevice_HS, lun, buf, blk_addr, blk_len);
+}
+#endif
+
+
+#if defined(USB_USE_FS)
+int8_t STORAGE_FS_ReadStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
+	return TM_USBD_MSC_ReadStartCallback(&hUSBDevice_FS, lun, buf, blk_addr, blk_len);
+}
+#endif
+#if defined(USB_USE_HS)
+int8_t STORAGE_HS_ReadStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
+	return TM_USBD_MSC_ReadStartCallback(&hUSBDevice_HS, lun, buf, blk_addr, blk_len);
+}
+#endif
+
+
+#if defined(USB_USE_FS)
+int8_t STORAGE_FS_WriteStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
+	return TM_USBD_MSC_WriteStartCallback(&hUSBDevice_FS, lun, buf, blk_addr, blk_len);
+}
+#endif
+#if defined(USB_USE_HS)
+int8_t STORAGE_HS_WriteStart(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
+	return TM_USBD_MSC_WriteStartCallback(&hUSBDevice_HS, lun, buf, blk_addr, blk_len);
+}
+#endif
+
+
+#if defined(USB_USE_FS)
+int8_t STORAGE_FS_Wait(uint8_t lun) {
+	return TM_USBD_MSC_WaitCallback(&hUSBDevice_FS, lun);
+}
+#endif
+#if defined(USB_USE_HS)
+int8_t STORAGE_HS_Wait(uint8_t lun) {
+	return TM_USBD_MSC_WaitCallback(&hUSBDevice_HS, lun);
 }
 #endif
 
@@ -53,15 +53,20 @@
   * @{
   */ 
 
-#define USBD_MAX_NUM_INTERFACES               1
+/* Composite CDC + MSC device uses 3 interfaces, CDC multi device uses 2 interfaces per port */
+#ifndef USBD_MAX_NUM_INTERFACES
+#define USBD_MAX_NUM_INTERFACES               4
+#endif
 #define USBD_MAX_NUM_CONFIGURATION            1
 #define USBD_MAX_STR_DESC_SIZ                 0x100
 #define USBD_SUPPORT_USER_STRING              0 
 #define USBD_SELF_POWERED                     1
 #define USBD_DEBUG_LEVEL                      2
 
-/* MSC Class Config */
+/* MSC Class Config, buffer for media transfers, split to 2 halves when storage supports background transfers */
+#ifndef MSC_MEDIA_PACKET
 #define MSC_MEDIA_PACKET                       8192   
+#endif
 
 /* CDC Class Config */
 #define USBD_CDC_INTERVAL                      2000  
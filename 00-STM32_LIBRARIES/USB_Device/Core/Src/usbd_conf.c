@@ -36,6 +36,13 @@
 PCD_HandleTypeDef hpcd_FS;
 PCD_HandleTypeDef hpcd_HS;
 
+/* FS core on STM32F446/F469/F479 and STM32F7xx has 6 endpoints, second CDC multi port uses EP3 and EP4 */
+#if defined(STM32F446xx) || defined(STM32F469xx) || defined(STM32F479xx) || defined(STM32F7xx)
+#define USBD_FS_ENDPOINTS          6
+#else
+#define USBD_FS_ENDPOINTS          4
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
   
@@ -228,7 +235,7 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev) {
 	if (pdev->id == USB_ID_FS) {
 		/* Set LL Driver parameters */
 		hpcd_FS.Instance = USB_OTG_FS;
-		hpcd_FS.Init.dev_endpoints = 4;
+		hpcd_FS.Init.dev_endpoints = USBD_FS_ENDPOINTS;
 		hpcd_FS.Init.use_dedicated_ep1 = 0;
 		hpcd_FS.Init.ep0_mps = 0x40;
 		hpcd_FS.Init.dma_enable = 0;
@@ -246,9 +253,18 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev) {
 		/* Initialize LL Driver */
 		HAL_PCD_Init(&hpcd_FS);
 
+		/* 320 words total, TX FIFOs for EP1 (CDC data), EP2 (CDC command) and EP3 (MSC or second CDC data) */
 		HAL_PCDEx_SetRxFiFo(&hpcd_FS, 0x80);
-		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 0, 0x40);
-		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 1, 0x80);
+		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 0, 0x20);
+		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 1, 0x40);
+		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 2, 0x10);
+#if USBD_FS_ENDPOINTS > 4
+		/* EP4 for second CDC command */
+		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 3, 0x40);
+		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 4, 0x10);
+#else
+		HAL_PCDEx_SetTxFiFo(&hpcd_FS, 3, 0x50);
+#endif
 	}
 #endif
 
@@ -279,9 +295,13 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev) {
 		/* Initialize LL Driver */
 		HAL_PCD_Init(&hpcd_HS);
 
-		HAL_PCDEx_SetRxFiFo(&hpcd_HS, 0x200);
-		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 0, 0x80);
-		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 1, 0x174);
+		/* 1024 words total, TX FIFOs for EP1 (CDC data), EP2 (CDC command), EP3 (MSC or second CDC data) and EP4 (second CDC command) */
+		HAL_PCDEx_SetRxFiFo(&hpcd_HS, 0x180);
+		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 0, 0x40);
+		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 1, 0x100);
+		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 2, 0x10);
+		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 3, 0x120);
+		HAL_PCDEx_SetTxFiFo(&hpcd_HS, 4, 0x10);
 	}
 #endif
 	
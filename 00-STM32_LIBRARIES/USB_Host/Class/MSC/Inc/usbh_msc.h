@@ -131,6 +131,8 @@ typedef struct _MSC_Process
   uint16_t             current_lun; 
   uint16_t             rw_lun;   
   uint32_t             timer;
+  uint32_t             rw_timer;
+  uint32_t             rw_length;
 }
 MSC_HandleTypeDef; 
 
@@ -201,6 +203,21 @@ USBH_StatusTypeDef USBH_MSC_Write(USBH_HandleTypeDef *phost,
                                      uint32_t address,
                                      uint8_t *pbuf,
                                      uint32_t length);
+
+/* Non-blocking APIs, operation is completed with USBH_MSC_RdWrPoll */
+USBH_StatusTypeDef USBH_MSC_ReadStart(USBH_HandleTypeDef *phost,
+                                     uint8_t lun,
+                                     uint32_t address,
+                                     uint8_t *pbuf,
+                                     uint32_t length);
+
+USBH_StatusTypeDef USBH_MSC_WriteStart(USBH_HandleTypeDef *phost,
+                                     uint8_t lun,
+                                     uint32_t address,
+                                     uint8_t *pbuf,
+                                     uint32_t length);
+
+USBH_StatusTypeDef USBH_MSC_RdWrPoll(USBH_HandleTypeDef *phost);
 /**
   * @}
   */ 
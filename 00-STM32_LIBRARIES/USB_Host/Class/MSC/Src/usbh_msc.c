@@ -782,6 +782,109 @@ USBH_StatusTypeDef USBH_MSC_Write(USBH_HandleTypeDef *phost,
   return USBH_OK;
 }
 
+/**
+  * @brief  USBH_MSC_ReadStart 
+  *         The function starts a Read operation and returns immediately,
+  *         USBH_MSC_RdWrPoll must be called until operation is completed
+  * @param  phost: Host handle
+  * @param  lun: logical Unit Number
+  * @param  address: sector address
+  * @param  pbuf: pointer to data, must be valid until operation is completed
+  * @param  length: number of sector to read
+  * @retval USBH Status
+  */
+USBH_StatusTypeDef USBH_MSC_ReadStart(USBH_HandleTypeDef *phost,
+                                     uint8_t lun,
+                                     uint32_t address,
+                                     uint8_t *pbuf,
+                                     uint32_t length)
+{
+  MSC_HandleTypeDef *MSC_Handle =  (MSC_HandleTypeDef *) phost->pActiveClass->pData;   
+  
+  if ((phost->device.is_connected == 0) || 
+      (phost->gState != HOST_CLASS) || 
+      (MSC_Handle->unit[lun].state != MSC_IDLE))
+  {
+    return  USBH_FAIL;
+  }
+  MSC_Handle->state = MSC_READ;
+  MSC_Handle->unit[lun].state = MSC_READ;
+  MSC_Handle->rw_lun = lun;
+  MSC_Handle->rw_timer = phost->Timer;
+  MSC_Handle->rw_length = length;
+  USBH_MSC_SCSI_Read(phost,
+                     lun,
+                     address,
+                     pbuf,
+                     length);
+  return USBH_OK;
+}
+
+/**
+  * @brief  USBH_MSC_WriteStart 
+  *         The function starts a Write operation and returns immediately,
+  *         USBH_MSC_RdWrPoll must be called until operation is completed
+  * @param  phost: Host handle
+  * @param  lun: logical Unit Number
+  * @param  address: sector address
+  * @param  pbuf: pointer to data, must be valid until operation is completed
+  * @param  length: number of sector to write
+  * @retval USBH Status
+  */
+USBH_StatusTypeDef USBH_MSC_WriteStart(USBH_HandleTypeDef *phost,
+                                     uint8_t lun,
+                                     uint32_t address,
+                                     uint8_t *pbuf,
+                                     uint32_t length)
+{
+  MSC_HandleTypeDef *MSC_Handle =  (MSC_HandleTypeDef *) phost->pActiveClass->pData;   
+  
+  if ((phost->device.is_connected == 0) || 
+      (phost->gState != HOST_CLASS) || 
+      (MSC_Handle->unit[lun].state != MSC_IDLE))
+  {
+    return  USBH_FAIL;
+  }
+  MSC_Handle->state = MSC_WRITE;
+  MSC_Handle->unit[lun].state = MSC_WRITE;
+  MSC_Handle->rw_lun = lun;
+  MSC_Handle->rw_timer = phost->Timer;
+  MSC_Handle->rw_length = length;
+  USBH_MSC_SCSI_Write(phost,
+                     lun,
+                     address,
+                     pbuf,
+                     length);
+  return USBH_OK;
+}
+
+/**
+  * @brief  USBH_MSC_RdWrPoll 
+  *         The function processes operation started with USBH_MSC_ReadStart
+  *         or USBH_MSC_WriteStart
+  * @param  phost: Host handle
+  * @retval USBH_BUSY while operation is in progress, USBH_OK when completed
+  *         or USBH_FAIL on error or timeout
+  */
+USBH_StatusTypeDef USBH_MSC_RdWrPoll(USBH_HandleTypeDef *phost)
+{
+  MSC_HandleTypeDef *MSC_Handle =  (MSC_HandleTypeDef *) phost->pActiveClass->pData;   
+  USBH_StatusTypeDef status;
+  
+  status = USBH_MSC_RdWrProcess(phost, MSC_Handle->rw_lun);
+  if (status == USBH_BUSY)
+  {
+    if(((phost->Timer - MSC_Handle->rw_timer) > (10000 * MSC_Handle->rw_length)) || (phost->device.is_connected == 0))
+    {
+      MSC_Handle->state = MSC_IDLE;
+      return USBH_FAIL;
+    }
+    return USBH_BUSY;
+  }
+  MSC_Handle->state = MSC_IDLE;
+  return status;
+}
+
 /**
   * @}
   */ 
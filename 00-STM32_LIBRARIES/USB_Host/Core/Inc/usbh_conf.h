@@ -48,15 +48,20 @@
 #define USBH_MAX_SIZE_CONFIGURATION           0x200
 #define USBH_MAX_DATA_BUFFER                  0x200
 #define USBH_DEBUG_LEVEL                      2
+/* Set to 1 in defines.h to process USB host in own CMSIS-RTOS thread, only when there are events */
+#ifndef USBH_USE_OS
 #define USBH_USE_OS                           0
+#endif
 
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* CMSIS OS macros */   
 #if (USBH_USE_OS == 1)
   #include "cmsis_os.h"
+#ifndef USBH_PROCESS_PRIO
   #define   USBH_PROCESS_PRIO    osPriorityNormal
 #endif
+#endif
 
 /* Memory management macros */   
 #define USBH_malloc               malloc
@@ -124,7 +124,10 @@ void HAL_HCD_Disconnect_Callback(HCD_HandleTypeDef *hhcd) {
   * @retval None
   */
 void HAL_HCD_HC_NotifyURBChange_Callback(HCD_HandleTypeDef *hhcd, uint8_t chnum, HCD_URBStateTypeDef urb_state) {
-	/* To be used with OS to sync URB state with the global state machine */
+#if (USBH_USE_OS == 1)
+	/* Wake up USB host thread, transfer on pipe is done */
+	USBH_LL_NotifyURBChange(hhcd->pData);
+#endif
 }
 
 /*******************************************************************************
@@ -471,6 +474,13 @@ uint8_t USBH_LL_GetToggle(USBH_HandleTypeDef *phost, uint8_t pipe) {
   * @retval None
   */
 void USBH_Delay(uint32_t Delay) {
+#if (USBH_USE_OS == 1)
+	/* Other threads can run while USB host thread waits */
+	if (osKernelRunning()) {
+		osDelay(Delay);
+		return;
+	}
+#endif
 	HAL_Delay(Delay);  
 }
 
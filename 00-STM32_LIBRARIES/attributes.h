@@ -41,4 +41,52 @@
 	#endif	/* Packed attribute */
 #endif
 
+/* Place variable to external SDRAM, .sdram section must exist in linker script or scatter file, see TM SDRAM library */
+#ifndef __sdram
+	#if defined (__CC_ARM)
+		#define __sdram		__attribute__((section(".sdram"), zero_init))
+	#else
+		#define __sdram		__attribute__((section(".sdram")))
+	#endif
+#endif	/* SDRAM section attribute */
+
+/* Place variable to CCM RAM, .ccmram section must exist in linker script or scatter file. CCM RAM can not be accessed by DMA */
+#ifndef __ccm
+	#if defined (__CC_ARM)
+		#define __ccm		__attribute__((section(".ccmram"), zero_init))
+	#else
+		#define __ccm		__attribute__((section(".ccmram")))
+	#endif
+#endif	/* CCM RAM section attribute */
+
+/* Place variable to fast RAM without wait states and bus contention, .fastdata section must exist in linker script or scatter file. */
+/* Use CCM RAM on STM32F4xx and DTCM RAM on STM32F7xx. Section is copied from flash at startup, memory can not be used by DMA on STM32F4xx */
+#ifndef __fastdata
+	#define __fastdata	__attribute__((section(".fastdata")))
+#endif	/* Fast data section attribute */
+
+/* Execute function from RAM without flash wait states, .ramfunc section must be copied from flash at startup. */
+/* Use SRAM on STM32F4xx (CCM RAM can not execute code) and ITCM RAM on STM32F7xx. */
+/* Without .ramfunc in linker script, GCC places section after .text and function executes from flash as usual. */
+/* IAR has own __ramfunc keyword */
+#if !defined(__ramfunc) && !defined(__ICCARM__)
+	#define __ramfunc	__attribute__((section(".ramfunc"), noinline))
+#endif	/* RAM function section attribute */
+
+/* Execute function from QSPI flash in memory mapped mode on STM32F7xx, .qspi section must exist in linker script or scatter file. */
+/* BSP_QSPI_EnableXIP must be called before function is used, see TM QSPI FLASH library. Use for code which is not time critical */
+#ifndef __qspi
+	#define __qspi		__attribute__((section(".qspi"), noinline))
+#endif	/* QSPI function section attribute */
+
+/* Place constant data (fonts, images) to QSPI flash, .qspi_rodata section must exist in linker script or scatter file */
+#ifndef __qspi_const
+	#define __qspi_const	__attribute__((section(".qspi_rodata")))
+#endif	/* QSPI constant section attribute */
+
+/* Align variable to data cache line for DMA buffers, see TM DMA library */
+#ifndef __dma_aligned
+	#define __dma_aligned	__attribute__((aligned(32)))
+#endif	/* DMA buffer alignment attribute */
+
 #endif
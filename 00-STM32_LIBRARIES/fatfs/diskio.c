@@ -9,6 +9,7 @@
 
 #include "diskio.h"		/* FatFs lower layer API */
 #include "ff.h"
+#include "tm_stm32_stats.h"
 
 /* Not USB in use */
 /* Define it in defines.h project file if you want to use USB */
@@ -28,6 +29,12 @@
 	#define FATFS_USE_SPI_FLASH			0
 #endif
 
+/* Not SPI RAM in use */
+/* Define it in defines.h project file if you want to use SPI PSRAM or FRAM */
+#ifndef FATFS_USE_SPIRAM
+	#define FATFS_USE_SPIRAM			0
+#endif
+
 /* Set in defines.h file if you want it */
 #ifndef TM_FATFS_CUSTOM_FATTIME
 	#define TM_FATFS_CUSTOM_FATTIME		0
@@ -35,7 +42,7 @@
 
 /* Defined in defines.h */
 /* We are using FATFS with USB */
-#if FATFS_USE_USB == 1 || FATFS_USE_SDRAM == 1 || FATFS_USE_SPI_FLASH == 1
+#if FATFS_USE_USB == 1 || FATFS_USE_SDRAM == 1 || FATFS_USE_SPI_FLASH == 1 || FATFS_USE_SPIRAM == 1
 	/* If SDIO is not defined, set to 2, to disable SD card */
 	/* You can set FATFS_USE_SDIO in defines.h file */
 	/* This is for error fixes */
@@ -62,6 +69,10 @@
 #if FATFS_USE_SPI_FLASH == 1
 	#include "fatfs_spi_flash.h"
 #endif /* FATFS_USE_SPI_FLASH */
+/* SPI RAM with FATFS */
+#if FATFS_USE_SPIRAM == 1
+	#include "fatfs_spiram.h"
+#endif /* FATFS_USE_SPIRAM */
 
 /* Include SD card files if is enabled */
 #if FATFS_USE_SDIO == 1
@@ -95,6 +106,7 @@
 #define USBHS	   1
 #define SDRAM      3
 #define SPI_FLASH  4
+#define SPIRAM     5
 
 /* Make driver structure */
 DISKIO_LowLevelDriver_t FATFS_LowLevelDrivers[_VOLUMES] = {
@@ -140,9 +152,41 @@ DISKIO_LowLevelDriver_t FATFS_LowLevelDrivers[_VOLUMES] = {
 		TM_FATFS_SPI_FLASH_disk_ioctl,
 		TM_FATFS_SPI_FLASH_disk_write,
 		TM_FATFS_SPI_FLASH_disk_read
+	},
+	{
+		TM_FATFS_SPIRAM_disk_initialize,
+		TM_FATFS_SPIRAM_disk_status,
+		TM_FATFS_SPIRAM_disk_ioctl,
+		TM_FATFS_SPIRAM_disk_write,
+		TM_FATFS_SPIRAM_disk_read
 	}
 };
 
+#if STATS_ENABLED
+/* Statistics for each physical drive, named DISK0 to DISKx */
+static TM_STATS_t DISKIO_Stats[_VOLUMES];
+static char DISKIO_Names[_VOLUMES][6];
+
+/* Counts one transfer with its latency */
+static DRESULT DISKIO_INT_Count(BYTE pdrv, DRESULT res, uint32_t start, UINT count, uint8_t write) {
+	TM_STATS_t* s = &DISKIO_Stats[pdrv];
+	
+	/* Count transfer */
+	TM_STATS_INC(s, Transfers);
+	if (res != RES_OK) {
+		TM_STATS_INC(s, Errors);
+	} else if (write) {
+		TM_STATS_ADD(s, TxBytes, count * _MIN_SS);
+	} else {
+		TM_STATS_ADD(s, RxBytes, count * _MIN_SS);
+	}
+	TM_STATS_MAX(s, MaxLatency, TM_STATS_TIME() - start);
+	
+	/* Return result */
+	return res;
+}
+#endif
+
 void TM_FATFS_AddDriver(DISKIO_LowLevelDriver_t* Driver, TM_FATFS_Driver_t DriverName) {
 	if (
 		DriverName != TM_FATFS_Driver_USER1 &&
@@ -167,6 +211,19 @@ DSTATUS disk_initialize (
 	BYTE pdrv				/* Physical drive nmuber (0..) */
 )
 {
+#if STATS_ENABLED
+	/* Register statistics for drive */
+	if (pdrv < _VOLUMES) {
+		DISKIO_Names[pdrv][0] = 'D';
+		DISKIO_Names[pdrv][1] = 'I';
+		DISKIO_Names[pdrv][2] = 'S';
+		DISKIO_Names[pdrv][3] = 'K';
+		DISKIO_Names[pdrv][4] = '0' + pdrv;
+		DISKIO_Names[pdrv][5] = 0;
+		TM_STATS_REGISTER(&DISKIO_Stats[pdrv], DISKIO_Names[pdrv]);
+	}
+#endif
+	
 	/* Return low level status */
 	if (FATFS_LowLevelDrivers[pdrv].disk_initialize) {
 		return FATFS_LowLevelDrivers[pdrv].disk_initialize();
@@ -209,7 +266,12 @@ DRESULT disk_read (
 	
 	/* Return low level status */
 	if (FATFS_LowLevelDrivers[pdrv].disk_read) {
+#if STATS_ENABLED
+		uint32_t start = TM_STATS_TIME();
+		return DISKIO_INT_Count(pdrv, FATFS_LowLevelDrivers[pdrv].disk_read(buff, sector, count), start, count, 0);
+#else
 		return FATFS_LowLevelDrivers[pdrv].disk_read(buff, sector, count);
+#endif
 	}
 	
 	/* Return parameter error */
@@ -236,7 +298,12 @@ DRESULT disk_write (
 	
 	/* Return low level status */
 	if (FATFS_LowLevelDrivers[pdrv].disk_write) {
+#if STATS_ENABLED
+		uint32_t start = TM_STATS_TIME();
+		return DISKIO_INT_Count(pdrv, FATFS_LowLevelDrivers[pdrv].disk_write(buff, sector, count), start, count, 1);
+#else
 		return FATFS_LowLevelDrivers[pdrv].disk_write(buff, sector, count);
+#endif
 	}
 	
 	/* Return parameter error */
@@ -285,6 +352,7 @@ __weak DSTATUS TM_FATFS_USBFS_disk_initialize(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_USBHS_disk_initialize(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_SDRAM_disk_initialize(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_SPI_FLASH_disk_initialize(void) {return RES_ERROR;}
+__weak DSTATUS TM_FATFS_SPIRAM_disk_initialize(void) {return RES_ERROR;}
 
 __weak DSTATUS TM_FATFS_SD_SDIO_disk_status(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_SD_disk_status(void) {return RES_ERROR;}
@@ -292,6 +360,7 @@ __weak DSTATUS TM_FATFS_USBFS_disk_status(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_USBHS_disk_status(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_SDRAM_disk_status(void) {return RES_ERROR;}
 __weak DSTATUS TM_FATFS_SPI_FLASH_disk_status(void) {return RES_ERROR;}
+__weak DSTATUS TM_FATFS_SPIRAM_disk_status(void) {return RES_ERROR;}
 
 __weak DRESULT TM_FATFS_SD_SDIO_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SD_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)STA_NOINIT;}
@@ -299,6 +368,7 @@ __weak DRESULT TM_FATFS_USBFS_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)
 __weak DRESULT TM_FATFS_USBHS_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SDRAM_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SPI_FLASH_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)STA_NOINIT;}
+__weak DRESULT TM_FATFS_SPIRAM_disk_ioctl(BYTE cmd, void *buff) {return (DRESULT)STA_NOINIT;}
 
 __weak DRESULT TM_FATFS_SD_SDIO_disk_read(BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SD_disk_read(BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
@@ -306,6 +376,7 @@ __weak DRESULT TM_FATFS_USBFS_disk_read(BYTE *buff, DWORD sector, UINT count) {r
 __weak DRESULT TM_FATFS_USBHS_disk_read(BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SDRAM_disk_read(BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SPI_FLASH_disk_read(BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
+__weak DRESULT TM_FATFS_SPIRAM_disk_read(BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 
 __weak DRESULT TM_FATFS_SD_SDIO_disk_write(const BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SD_disk_write(const BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
@@ -313,4 +384,5 @@ __weak DRESULT TM_FATFS_USBFS_disk_write(const BYTE *buff, DWORD sector, UINT co
 __weak DRESULT TM_FATFS_USBHS_disk_write(const BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SDRAM_disk_write(const BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 __weak DRESULT TM_FATFS_SPI_FLASH_disk_write(const BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
+__weak DRESULT TM_FATFS_SPIRAM_disk_write(const BYTE *buff, DWORD sector, UINT count) {return (DRESULT)STA_NOINIT;}
 
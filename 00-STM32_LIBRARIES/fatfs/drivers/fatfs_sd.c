@@ -31,6 +31,16 @@ static volatile DSTATUS TM_FATFS_SD_Stat = STA_NOINIT;	/* Physical drive status
 
 static BYTE TM_FATFS_SD_CardType;			/* Card type flags */
 
+#if FATFS_SD_STREAM
+/* Multi-block transfer kept open between disk_read/disk_write calls */
+#define SD_STREAM_NONE		0
+#define SD_STREAM_READ		1			/* CMD18 active */
+#define SD_STREAM_WRITE		2			/* CMD25 active */
+
+static BYTE TM_FATFS_SD_Stream = SD_STREAM_NONE;	/* Active multi-block transfer */
+static DWORD TM_FATFS_SD_StreamSector;		/* Next sector (LBA) of active transfer */
+#endif
+
 /**************************************************************/
 /*                  SDCARD WP AND DETECT                      */
 /**************************************************************/
@@ -82,8 +92,10 @@ static void rcvr_spi_multi (
 {
 	/* Read multiple bytes, send 0xFF as dummy */
 #if FATFS_DMA
+	/* Card needs 0xFF on MOSI, DMA sends buffer content before it is overwritten with received byte */
+	memset(buff, 0xFF, btr);
 	do {
-		TM_SPI_DMA_Receive(FATFS_SPI, buff, btr > 0xFFFF ? 0xFFFF : btr);
+		TM_SPI_DMA_Transmit(FATFS_SPI, buff, buff, btr > 0xFFFF ? 0xFFFF : btr);
 		while (TM_SPI_DMA_Transmitting(FATFS_SPI));
 		
 		if (btr > 0xFFFF) {
@@ -220,6 +232,35 @@ static int xmit_datablock (	/* 1:OK, 0:Failed */
 }
 #endif
 
+/*-----------------------------------------------------------------------*/
+/* Finish multi-block transfer left open by disk_read/disk_write         */
+/*-----------------------------------------------------------------------*/
+#if FATFS_SD_STREAM
+static BYTE send_cmd(BYTE cmd, DWORD arg);
+
+static int stop_stream (void)	/* 1:OK, 0:Failed */
+{
+	int res = 1;
+
+	if (TM_FATFS_SD_Stream == SD_STREAM_READ) {
+		send_cmd(CMD12, 0);						/* STOP_TRANSMISSION */
+	}
+#if _USE_WRITE
+	if (TM_FATFS_SD_Stream == SD_STREAM_WRITE) {
+		if (!xmit_datablock(0, 0xFD)) {			/* STOP_TRAN token */
+			res = 0;
+		}
+	}
+#endif
+	if (TM_FATFS_SD_Stream != SD_STREAM_NONE) {
+		deselect();
+	}
+	TM_FATFS_SD_Stream = SD_STREAM_NONE;
+
+	return res;
+}
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* Send a command packet to the MMC                                      */
 /*-----------------------------------------------------------------------*/
@@ -283,6 +324,11 @@ void TM_FATFS_InitPins(void) {
 DSTATUS TM_FATFS_SD_disk_initialize (void) {
 	BYTE n, cmd, ty, ocr[4];
 	
+#if FATFS_SD_STREAM
+	/* Card is reset, any open transfer is lost */
+	TM_FATFS_SD_Stream = SD_STREAM_NONE;
+#endif
+	
 	//Initialize CS pin
 	TM_FATFS_InitPins();
 	init_spi();
@@ -368,20 +414,46 @@ DRESULT TM_FATFS_SD_disk_read (
 	UINT count		/* Number of sectors to read (1..128) */
 )
 {
+	DWORD addr = sector;
+	
 	if (!SDCARD_IsDetected() || (TM_FATFS_SD_Stat & STA_NOINIT)) {
 		return RES_NOTRDY;
 	}
 
 	if (!(TM_FATFS_SD_CardType & CT_BLOCK)) {
-		sector *= SD_BLOCK_SIZE;	/* LBA ot BA conversion (byte addressing cards) */
+		addr *= SD_BLOCK_SIZE;	/* LBA ot BA conversion (byte addressing cards) */
 	}
 
+#if FATFS_SD_STREAM
+	/* Continue open CMD18 if this is next sector, otherwise start new one */
+	if (TM_FATFS_SD_Stream != SD_STREAM_READ || TM_FATFS_SD_StreamSector != sector) {
+		stop_stream();
+		if (send_cmd(CMD18, addr) != 0) {	/* READ_MULTIPLE_BLOCK */
+			deselect();
+			return RES_ERROR;
+		}
+		TM_FATFS_SD_Stream = SD_STREAM_READ;
+	}
+	do {
+		if (!rcvr_datablock(buff, SD_BLOCK_SIZE)) {
+			break;
+		}
+		buff += SD_BLOCK_SIZE;
+		sector++;
+	} while (--count);
+	TM_FATFS_SD_StreamSector = sector;
+	
+	/* Close transfer on error */
+	if (count) {
+		stop_stream();
+	}
+#else
 	if (count == 1) {	/* Single sector read */
-		if ((send_cmd(CMD17, sector) == 0)	/* READ_SINGLE_BLOCK */
+		if ((send_cmd(CMD17, addr) == 0)	/* READ_SINGLE_BLOCK */
 			&& rcvr_datablock(buff, SD_BLOCK_SIZE))
 			count = 0;
 	} else {				/* Multiple sector read */
-		if (send_cmd(CMD18, sector) == 0) {	/* READ_MULTIPLE_BLOCK */
+		if (send_cmd(CMD18, addr) == 0) {	/* READ_MULTIPLE_BLOCK */
 			do {
 				if (!rcvr_datablock(buff, SD_BLOCK_SIZE)) {
 					break;
@@ -392,6 +464,7 @@ DRESULT TM_FATFS_SD_disk_read (
 		}
 	}
 	deselect();
+#endif
 
 	return count ? RES_ERROR : RES_OK;	/* Return result */
 }
@@ -405,6 +478,8 @@ DRESULT TM_FATFS_SD_disk_write (
 	DWORD sector,		/* Sector address (LBA) */
 	UINT count			/* Number of sectors to write (1..128) */
 ) {
+	DWORD addr = sector;
+	
 	if (!SDCARD_IsDetected()) {
 		return RES_ERROR;
 	}
@@ -419,16 +494,41 @@ DRESULT TM_FATFS_SD_disk_write (
 	}
 
 	if (!(TM_FATFS_SD_CardType & CT_BLOCK)) {
-		sector *= SD_BLOCK_SIZE;	/* LBA ==> BA conversion (byte addressing cards) */
+		addr *= SD_BLOCK_SIZE;	/* LBA ==> BA conversion (byte addressing cards) */
 	}
 
+#if FATFS_SD_STREAM
+	/* Continue open CMD25 if this is next sector, otherwise start new one */
+	if (TM_FATFS_SD_Stream != SD_STREAM_WRITE || TM_FATFS_SD_StreamSector != sector) {
+		stop_stream();
+		if (TM_FATFS_SD_CardType & CT_SDC) send_cmd(ACMD23, count);	/* Pre-erase sectors of this call */
+		if (send_cmd(CMD25, addr) != 0) {	/* WRITE_MULTIPLE_BLOCK */
+			deselect();
+			return RES_ERROR;
+		}
+		TM_FATFS_SD_Stream = SD_STREAM_WRITE;
+	}
+	do {
+		if (!xmit_datablock(buff, 0xFC)) {
+			break;
+		}
+		buff += SD_BLOCK_SIZE;
+		sector++;
+	} while (--count);
+	TM_FATFS_SD_StreamSector = sector;
+	
+	/* Close transfer on error */
+	if (count) {
+		stop_stream();
+	}
+#else
 	if (count == 1) {	/* Single sector write */
-		if ((send_cmd(CMD24, sector) == 0)	/* WRITE_BLOCK */
+		if ((send_cmd(CMD24, addr) == 0)	/* WRITE_BLOCK */
 			&& xmit_datablock(buff, 0xFE))
 			count = 0;
 	} else {				/* Multiple sector write */
 		if (TM_FATFS_SD_CardType & CT_SDC) send_cmd(ACMD23, count);	/* Predefine number of sectors */
-		if (send_cmd(CMD25, sector) == 0) {	/* WRITE_MULTIPLE_BLOCK */
+		if (send_cmd(CMD25, addr) == 0) {	/* WRITE_MULTIPLE_BLOCK */
 			do {
 				if (!xmit_datablock(buff, 0xFC)) {
 					break;
@@ -441,6 +541,7 @@ DRESULT TM_FATFS_SD_disk_write (
 		}
 	}
 	deselect();
+#endif
 
 	return count ? RES_ERROR : RES_OK;	/* Return result */
 }
@@ -466,6 +567,13 @@ DRESULT TM_FATFS_SD_disk_ioctl (
 		return RES_NOTRDY;
 	}
 
+#if FATFS_SD_STREAM
+	/* Finish open transfer before other commands, all written data are sent to card */
+	if (!stop_stream()) {
+		return RES_ERROR;
+	}
+#endif
+
 	res = RES_ERROR;
 
 	switch (cmd) {
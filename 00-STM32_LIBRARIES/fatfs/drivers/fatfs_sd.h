@@ -25,6 +25,12 @@
 #define FATFS_DMA           0
 #endif
 
+/* Keep CMD18/CMD25 multi-block transfer open across sequential disk_read/disk_write calls */
+/* Card stays selected until non-sequential access or disk_ioctl, including CTRL_SYNC from f_sync */
+#ifndef FATFS_SD_STREAM
+#define FATFS_SD_STREAM						1
+#endif
+
 /* SPI settings */
 #ifndef FATFS_SPI
 #define FATFS_SPI							SPI1
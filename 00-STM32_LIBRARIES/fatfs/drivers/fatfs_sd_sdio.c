@@ -46,9 +46,63 @@ void    BSP_SD_MspDeInit(SD_HandleTypeDef *hsd, void *Params);
 #define SD_DMAx_Tx_IRQHandler             DMA2_Stream6_IRQHandler   
 #define SD_DMAx_Rx_IRQHandler             DMA2_Stream3_IRQHandler
 
+/* Memory alignment needed for DMA transfers */
+#if defined(STM32F7xx)
+#define SD_DMA_ALIGN                      32 /* Data cache line size */
+#else
+#define SD_DMA_ALIGN                      4
+#endif
+
 /* Status of SDCARD */
 static volatile DSTATUS Stat = STA_NOINIT;
 
+#if FATFS_SDIO_USE_DMA
+/* Aligned memory for single sector when FatFs buffer is not aligned */
+static uint32_t SD_ScratchMemory[(SD_BLOCK_SIZE + SD_DMA_ALIGN) / 4];
+#define SD_Scratch                        ((uint32_t *)(((uint32_t)SD_ScratchMemory + SD_DMA_ALIGN - 1) & ~(SD_DMA_ALIGN - 1)))
+#endif
+
+#if FATFS_SDIO_USE_RTOS
+/* Semaphore released from interrupt when DMA transfer ends */
+osSemaphoreDef(SD_Semaphore);
+static osSemaphoreId SD_SemaphoreId;
+#endif
+
+/* Clock register bits */
+#if defined(SDIO)
+#define SD_CLKCR_CLKDIV                   SDIO_CLKCR_CLKDIV
+#define SD_CLKCR_BYPASS                   SDIO_CLKCR_BYPASS
+#else
+#define SD_CLKCR_CLKDIV                   SDMMC_CLKCR_CLKDIV
+#define SD_CLKCR_BYPASS                   SDMMC_CLKCR_BYPASS
+#endif
+
+/* Clock levels from fastest to slowest, bus clock is kernel clock / (divider + 2) when not bypassed */
+static const struct {
+	uint8_t Bypass;
+	uint8_t Div;
+} SD_Levels[] = {
+	{1, 0},                               /* 48MHz, high speed mode only */
+	{0, 0},                               /* 24MHz, default after init */
+	{0, 1},                               /* 16MHz */
+	{0, 4}                                /* 8MHz */
+};
+#define SD_LEVELS                         (sizeof(SD_Levels) / sizeof(SD_Levels[0]))
+
+/* Current clock level, speed info and error of last HAL data operation */
+static uint8_t SD_Level = 1;
+static TM_FATFS_SDIO_Speed_t SD_Speed;
+static HAL_SD_ErrorTypedef SD_Error;
+
+/* Private functions */
+static DRESULT SD_DiskRead(BYTE *buff, DWORD sector, UINT count);
+static DRESULT SD_DiskWrite(const BYTE *buff, DWORD sector, UINT count);
+static void SD_SetLevel(uint8_t level);
+static uint8_t SD_StepDown(void);
+#if FATFS_SDIO_USE_DMA && FATFS_SDIO_PROBE
+static void SD_Probe(void);
+#endif
+
 /**************************************************************/
 /*                  SDCARD WP AND DETECT                      */
 /**************************************************************/
@@ -151,17 +205,87 @@ DRESULT TM_FATFS_SD_SDIO_disk_ioctl(BYTE cmd, void *buff) {
 }
 
 DRESULT TM_FATFS_SD_SDIO_disk_read(BYTE *buff, DWORD sector, UINT count) {
+	DRESULT res;
+	
+	/* Repeat with slower clock on data errors */
+	do {
+		res = SD_DiskRead(buff, sector, count);
+	} while (res != RES_OK && SD_StepDown());
+	
+	return res;
+}
+
+DRESULT TM_FATFS_SD_SDIO_disk_write(const BYTE *buff, DWORD sector, UINT count) {
+	DRESULT res;
+	
+	/* Repeat with slower clock on data errors */
+	do {
+		res = SD_DiskWrite(buff, sector, count);
+	} while (res != RES_OK && SD_StepDown());
+	
+	return res;
+}
+
+static DRESULT SD_DiskRead(BYTE *buff, DWORD sector, UINT count) {
+#if FATFS_SDIO_USE_DMA
+	/* Check if buffer is aligned for DMA */
+	if ((uint32_t)buff & (SD_DMA_ALIGN - 1)) {
+		/* Read sector by sector to aligned memory */
+		while (count--) {
+			if (BSP_SD_ReadBlocks_DMA(SD_Scratch, (uint64_t) (sector * SD_BLOCK_SIZE), SD_BLOCK_SIZE, 1) != MSD_OK) {
+				return RES_ERROR;
+			}
+			
+			/* Copy to user buffer */
+			memcpy(buff, SD_Scratch, SD_BLOCK_SIZE);
+			buff += SD_BLOCK_SIZE;
+			sector++;
+		}
+		
+		return RES_OK;
+	}
+	
+	/* Read directly to user buffer */
+	if (BSP_SD_ReadBlocks_DMA((uint32_t *)buff, (uint64_t) (sector * SD_BLOCK_SIZE), SD_BLOCK_SIZE, count) != MSD_OK) {
+		return RES_ERROR;
+	}
+#else
 	if (BSP_SD_ReadBlocks((uint32_t *)buff, (uint64_t) (sector * SD_BLOCK_SIZE), SD_BLOCK_SIZE, count) != MSD_OK) {
 		return RES_ERROR;
 	}
+#endif
 	
 	return RES_OK;
 }
 
-DRESULT TM_FATFS_SD_SDIO_disk_write(const BYTE *buff, DWORD sector, UINT count) {
+static DRESULT SD_DiskWrite(const BYTE *buff, DWORD sector, UINT count) {
+#if FATFS_SDIO_USE_DMA
+	/* Check if buffer is aligned for DMA */
+	if ((uint32_t)buff & (SD_DMA_ALIGN - 1)) {
+		/* Write sector by sector from aligned memory */
+		while (count--) {
+			/* Copy from user buffer */
+			memcpy(SD_Scratch, buff, SD_BLOCK_SIZE);
+			
+			if (BSP_SD_WriteBlocks_DMA(SD_Scratch, (uint64_t) (sector * SD_BLOCK_SIZE), SD_BLOCK_SIZE, 1) != MSD_OK) {
+				return RES_ERROR;
+			}
+			buff += SD_BLOCK_SIZE;
+			sector++;
+		}
+		
+		return RES_OK;
+	}
+	
+	/* Write directly from user buffer */
+	if (BSP_SD_WriteBlocks_DMA((uint32_t *)buff, (uint64_t) (sector * SD_BLOCK_SIZE), SD_BLOCK_SIZE, count) != MSD_OK) {
+		return RES_ERROR;
+	}
+#else
 	if (BSP_SD_WriteBlocks((uint32_t *)buff, (uint64_t) (sector * SD_BLOCK_SIZE), SD_BLOCK_SIZE, count) != MSD_OK) {
 		return RES_ERROR;
 	}
+#endif
 	
 	return RES_OK;
 }
@@ -175,6 +299,14 @@ DRESULT TM_FATFS_SD_SDIO_disk_write(const BYTE *buff, DWORD sector, UINT count)
   */
 static SD_HandleTypeDef uSdHandle;
 static SD_CardInfo uSdCardInfo;
+
+/* DMA transfer started with BSP_SD_ReadBlocks_DMA_Start or BSP_SD_WriteBlocks_DMA_Start */
+static struct {
+	uint8_t Active;      /* 0 = none, 1 = read, 2 = write */
+	uint8_t Status;      /* Status of transfer start */
+	uint32_t* Data;      /* Memory used in transfer */
+	uint32_t Size;       /* Number of bytes in transfer */
+} SD_Transfer;
 /**
   * @}
   */ 
@@ -183,6 +315,8 @@ static SD_CardInfo uSdCardInfo;
   * @{
   */
 static void SD_MspInit(void);
+static void SD_StartDMA(void);
+static void SD_WaitDMA(void);
 /**
   * @}
   */ 
@@ -224,6 +358,13 @@ uint8_t BSP_SD_Init(void) {
 
 	/* Init GPIO, DMA and NVIC */
 	SD_MspInit();
+	
+#if FATFS_SDIO_USE_RTOS
+	/* Create semaphore for DMA transfers */
+	if (SD_SemaphoreId == NULL) {
+		SD_SemaphoreId = osSemaphoreCreate(osSemaphore(SD_Semaphore), 1);
+	}
+#endif
 
 	/* Check if the SD card is plugged in the slot */
 	if (BSP_SD_IsDetected() != SD_PRESENT) {
@@ -256,10 +397,41 @@ uint8_t BSP_SD_Init(void) {
 			SD_state = MSD_OK;
 		}
 	}
+	
+	/* Select bus clock */
+	if (SD_state == MSD_OK) {
+		memset(&SD_Speed, 0, sizeof(SD_Speed));
+		
+#if FATFS_SDIO_HIGH_SPEED
+		/* Switch card to high speed mode with CMD6 */
+		SD_Speed.HighSpeed = HAL_SD_HighSpeed(&uSdHandle) == SD_OK;
+#endif
+		
+		/* Divider is bypassed only in high speed mode, polling mode can not follow 48MHz bus */
+#if FATFS_SDIO_CLOCK_BYPASS && FATFS_SDIO_USE_DMA
+		SD_SetLevel(SD_Speed.HighSpeed ? 0 : 1);
+#else
+		SD_SetLevel(1);
+#endif
+		
+#if FATFS_SDIO_USE_DMA && FATFS_SDIO_PROBE
+		/* Check selected clock and lower it if needed */
+		SD_Probe();
+#endif
+	}
 
 	return  SD_state;
 }
 
+/**
+  * @brief  Gets bus speed information
+  * @param  Speed: Pointer to TM_FATFS_SDIO_Speed_t structure
+  * @retval None
+  */
+void BSP_SD_GetSpeed(TM_FATFS_SDIO_Speed_t *Speed) {
+	*Speed = SD_Speed;
+}
+
 /**
  * @brief  Detects if SD card is correctly plugged in the memory slot or not.
  * @param  None
@@ -287,7 +459,8 @@ uint8_t BSP_SD_IsWriteProtected(void) {
   * @retval SD status
   */
 uint8_t BSP_SD_ReadBlocks(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
-	if (HAL_SD_ReadBlocks(&uSdHandle, pData, ReadAddr, BlockSize, NumOfBlocks) != SD_OK) {
+	SD_Error = HAL_SD_ReadBlocks(&uSdHandle, pData, ReadAddr, BlockSize, NumOfBlocks);
+	if (SD_Error != SD_OK) {
 		return MSD_ERROR;
 	}
 	
@@ -303,7 +476,8 @@ uint8_t BSP_SD_ReadBlocks(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize
   * @retval SD status
   */
 uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
-	if (HAL_SD_WriteBlocks(&uSdHandle, pData, WriteAddr, BlockSize, NumOfBlocks) != SD_OK) {
+	SD_Error = HAL_SD_WriteBlocks(&uSdHandle, pData, WriteAddr, BlockSize, NumOfBlocks);
+	if (SD_Error != SD_OK) {
 		return MSD_ERROR;
 	}
 	
@@ -319,51 +493,137 @@ uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSi
   * @retval SD status
   */
 uint8_t BSP_SD_ReadBlocks_DMA(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
-	uint8_t SD_state = MSD_OK;
+	/* Start and wait until transfer is complete */
+	BSP_SD_ReadBlocks_DMA_Start(pData, ReadAddr, BlockSize, NumOfBlocks);
+	return BSP_SD_WaitTransfer();
+}
 
-	/* Read block(s) in DMA transfer mode */
-	if (HAL_SD_ReadBlocks_DMA(&uSdHandle, pData, ReadAddr, BlockSize, NumOfBlocks) != SD_OK) {
-		SD_state = MSD_ERROR;
-	}
+/**
+  * @brief  Writes block(s) to a specified address in an SD card, in DMA mode.
+  * @param  pData: Pointer to the buffer that will contain the data to transmit
+  * @param  WriteAddr: Address from where data is to be written  
+  * @param  BlockSize: SD card data block size, that should be 512
+  * @param  NumOfBlocks: Number of SD blocks to write 
+  * @retval SD status
+  */
+uint8_t BSP_SD_WriteBlocks_DMA(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
+	/* Start and wait until transfer is complete */
+	BSP_SD_WriteBlocks_DMA_Start(pData, WriteAddr, BlockSize, NumOfBlocks);
+	return BSP_SD_WaitTransfer();
+}
 
-	/* Wait until transfer is complete */
-	if (SD_state == MSD_OK) {
-		if (HAL_SD_CheckReadOperation(&uSdHandle, (uint32_t)SD_DATATIMEOUT) != SD_OK) {
-			SD_state = MSD_ERROR;
-		} else {
-			SD_state = MSD_OK;
-		}
+/**
+  * @brief  Starts reading block(s) from a specified address in an SD card, in DMA mode.
+  * @note   Transfer runs in background, finish it with BSP_SD_WaitTransfer before next transfer
+  * @param  pData: Pointer to the buffer that will contain the data to transmit
+  * @param  ReadAddr: Address from where data is to be read  
+  * @param  BlockSize: SD card data block size, that should be 512
+  * @param  NumOfBlocks: Number of SD blocks to read 
+  * @retval SD status
+  */
+uint8_t BSP_SD_ReadBlocks_DMA_Start(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
+	/* Finish previous transfer if not done */
+	if (SD_Transfer.Active) {
+		BSP_SD_WaitTransfer();
 	}
+	
+	/* Save transfer */
+	SD_Transfer.Active = 1;
+	SD_Transfer.Status = MSD_OK;
+	SD_Transfer.Data = pData;
+	SD_Transfer.Size = BlockSize * NumOfBlocks;
+
+#if defined(STM32F7xx)
+	/* Write back cache lines, DMA writes to memory directly */
+	SCB_CleanInvalidateDCache_by_Addr(pData, BlockSize * NumOfBlocks);
+#endif
+
+	/* Prepare for DMA transfer end */
+	SD_StartDMA();
 
-	return SD_state; 
+	/* Read block(s) in DMA transfer mode */
+	SD_Error = HAL_SD_ReadBlocks_DMA(&uSdHandle, pData, ReadAddr, BlockSize, NumOfBlocks);
+	if (SD_Error != SD_OK) {
+		SD_Transfer.Status = MSD_ERROR;
+	}
+	
+	return SD_Transfer.Status;
 }
 
 /**
-  * @brief  Writes block(s) to a specified address in an SD card, in DMA mode.
+  * @brief  Starts writing block(s) to a specified address in an SD card, in DMA mode.
+  * @note   Transfer runs in background, finish it with BSP_SD_WaitTransfer before next transfer
   * @param  pData: Pointer to the buffer that will contain the data to transmit
   * @param  WriteAddr: Address from where data is to be written  
   * @param  BlockSize: SD card data block size, that should be 512
   * @param  NumOfBlocks: Number of SD blocks to write 
   * @retval SD status
   */
-uint8_t BSP_SD_WriteBlocks_DMA(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
-	uint8_t SD_state = MSD_OK;
+uint8_t BSP_SD_WriteBlocks_DMA_Start(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks) {
+	/* Finish previous transfer if not done */
+	if (SD_Transfer.Active) {
+		BSP_SD_WaitTransfer();
+	}
+	
+	/* Save transfer */
+	SD_Transfer.Active = 2;
+	SD_Transfer.Status = MSD_OK;
+	SD_Transfer.Data = pData;
+	SD_Transfer.Size = BlockSize * NumOfBlocks;
+
+#if defined(STM32F7xx)
+	/* Write data from cache to memory before DMA reads it */
+	SCB_CleanDCache_by_Addr(pData, BlockSize * NumOfBlocks);
+#endif
+
+	/* Prepare for DMA transfer end */
+	SD_StartDMA();
 
 	/* Write block(s) in DMA transfer mode */
-	if (HAL_SD_WriteBlocks_DMA(&uSdHandle, pData, WriteAddr, BlockSize, NumOfBlocks) != SD_OK) {
-		SD_state = MSD_ERROR;
+	SD_Error = HAL_SD_WriteBlocks_DMA(&uSdHandle, pData, WriteAddr, BlockSize, NumOfBlocks);
+	if (SD_Error != SD_OK) {
+		SD_Transfer.Status = MSD_ERROR;
+	}
+	
+	return SD_Transfer.Status;
+}
+
+/**
+  * @brief  Waits for DMA transfer started with BSP_SD_ReadBlocks_DMA_Start or BSP_SD_WriteBlocks_DMA_Start to finish
+  * @param  None
+  * @retval SD status of transfer, MSD_OK if no transfer is active
+  */
+uint8_t BSP_SD_WaitTransfer(void) {
+	uint8_t SD_state = SD_Transfer.Status;
+	
+	/* Check if anything to wait */
+	if (!SD_Transfer.Active) {
+		return MSD_OK;
 	}
 
 	/* Wait until transfer is complete */
 	if (SD_state == MSD_OK) {
-		if(HAL_SD_CheckWriteOperation(&uSdHandle, (uint32_t)SD_DATATIMEOUT) != SD_OK) {
-			SD_state = MSD_ERROR;
+		SD_WaitDMA();
+		
+		if (SD_Transfer.Active == 1) {
+			SD_Error = HAL_SD_CheckReadOperation(&uSdHandle, (uint32_t)SD_DATATIMEOUT);
 		} else {
-			SD_state = MSD_OK;
+			SD_Error = HAL_SD_CheckWriteOperation(&uSdHandle, (uint32_t)SD_DATATIMEOUT);
 		}
+		SD_state = SD_Error != SD_OK ? MSD_ERROR : MSD_OK;
 	}
 
-	return SD_state;  
+#if defined(STM32F7xx)
+	/* Discard cache lines read during transfer */
+	if (SD_Transfer.Active == 1) {
+		SCB_InvalidateDCache_by_Addr(SD_Transfer.Data, SD_Transfer.Size);
+	}
+#endif
+
+	/* Transfer done */
+	SD_Transfer.Active = 0;
+
+	return SD_state;
 }
 
 /**
@@ -422,7 +682,7 @@ static void SD_MspInit(void) {
 	TM_GPIO_InitAlternate(GPIOD, GPIO_PIN_2, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Fast, gpio_af);
 
 	/* NVIC configuration for SDIO interrupts */
-	HAL_NVIC_SetPriority(SDIO_IRQn, 5, 0);
+	HAL_NVIC_SetPriority(SDIO_IRQn, FATFS_SDIO_NVIC_PRIORITY, 0);
 	HAL_NVIC_EnableIRQ(SDIO_IRQn);
 
 	/* Configure DMA Rx parameters */
@@ -476,11 +736,11 @@ static void SD_MspInit(void) {
 	HAL_DMA_Init(&dmaTxHandle); 
 
 	/* NVIC configuration for DMA transfer complete interrupt */
-	HAL_NVIC_SetPriority(SD_DMAx_Rx_IRQn, 6, 0);
+	HAL_NVIC_SetPriority(SD_DMAx_Rx_IRQn, FATFS_SDIO_DMA_NVIC_PRIORITY, 0);
 	HAL_NVIC_EnableIRQ(SD_DMAx_Rx_IRQn);
 
 	/* NVIC configuration for DMA transfer complete interrupt */
-	HAL_NVIC_SetPriority(SD_DMAx_Tx_IRQn, 6, 0);
+	HAL_NVIC_SetPriority(SD_DMAx_Tx_IRQn, FATFS_SDIO_DMA_NVIC_PRIORITY, 0);
 	HAL_NVIC_EnableIRQ(SD_DMAx_Tx_IRQn);
 }
 
@@ -499,6 +759,64 @@ HAL_SD_TransferStateTypedef BSP_SD_GetStatus(void) {
 	return HAL_SD_GetStatus(&uSdHandle);
 }
 
+/**
+  * @brief  Clears semaphore from previous transfer before new DMA transfer is started.
+  * @param  None
+  * @retval None
+  */
+static void SD_StartDMA(void) {
+#if FATFS_SDIO_USE_RTOS
+	if (SD_SemaphoreId != NULL) {
+		osSemaphoreWait(SD_SemaphoreId, 0);
+	}
+#endif
+}
+
+/**
+  * @brief  Waits for DMA transfer to finish on semaphore when RTOS is running.
+  * @note   Without RTOS or when called from interrupt, transfer end is polled in HAL_SD_CheckReadOperation or HAL_SD_CheckWriteOperation
+  * @param  None
+  * @retval None
+  */
+static void SD_WaitDMA(void) {
+#if FATFS_SDIO_USE_RTOS
+	if (SD_SemaphoreId != NULL && osKernelRunning() && !__get_IPSR()) {
+		/* Wait for transfer end or error from interrupt */
+		osSemaphoreWait(SD_SemaphoreId, FATFS_SDIO_DMA_TIMEOUT);
+	}
+#endif
+}
+
+#if FATFS_SDIO_USE_RTOS
+/* Release waiting task on transfer end */
+static void SD_ReleaseDMA(void) {
+	if (SD_SemaphoreId != NULL) {
+		osSemaphoreRelease(SD_SemaphoreId);
+	}
+}
+
+/* HAL callbacks for DMA and SDIO transfer end */
+void HAL_SD_DMA_RxCpltCallback(DMA_HandleTypeDef *hdma) {
+	SD_ReleaseDMA();
+}
+
+void HAL_SD_DMA_RxErrorCallback(DMA_HandleTypeDef *hdma) {
+	SD_ReleaseDMA();
+}
+
+void HAL_SD_DMA_TxCpltCallback(DMA_HandleTypeDef *hdma) {
+	SD_ReleaseDMA();
+}
+
+void HAL_SD_DMA_TxErrorCallback(DMA_HandleTypeDef *hdma) {
+	SD_ReleaseDMA();
+}
+
+void HAL_SD_XferErrorCallback(SD_HandleTypeDef *hsd) {
+	SD_ReleaseDMA();
+}
+#endif
+
 /**
   * @brief  This function handles DMA2 Stream 3 interrupt request.
   * @param  None
@@ -530,3 +848,129 @@ void SDMMC1_IRQHandler(void)
 {
 	HAL_SD_IRQHandler(&uSdHandle);
 }
+
+/**
+  * @brief  Sets bus clock level
+  * @param  level: Index in clock levels table
+  * @retval None
+  */
+static void SD_SetLevel(uint8_t level) {
+	uint32_t clkcr = uSdHandle.Instance->CLKCR & ~(SD_CLKCR_CLKDIV | SD_CLKCR_BYPASS);
+	
+	/* Set divider and bypass */
+	clkcr |= SD_Levels[level].Div;
+	if (SD_Levels[level].Bypass) {
+		clkcr |= SD_CLKCR_BYPASS;
+	}
+	uSdHandle.Instance->CLKCR = clkcr;
+	SD_Level = level;
+	
+	/* Save info */
+	SD_Speed.Bypass = SD_Levels[level].Bypass;
+	SD_Speed.ClockDiv = SD_Levels[level].Div;
+	SD_Speed.Clock = SD_Levels[level].Bypass ? FATFS_SDIO_CLOCK : FATFS_SDIO_CLOCK / (SD_Levels[level].Div + 2);
+}
+
+/**
+  * @brief  Lowers bus clock after data error
+  * @param  None
+  * @retval 1 if clock was lowered and operation can be repeated, 0 otherwise
+  */
+static uint8_t SD_StepDown(void) {
+	/* Only errors on data lines mean bus is too fast */
+	if (SD_Error != SD_DATA_CRC_FAIL && SD_Error != SD_RX_OVERRUN && SD_Error != SD_TX_UNDERRUN && SD_Error != SD_START_BIT_ERR) {
+		return 0;
+	}
+	
+	/* Check if slower clock is available */
+	if (SD_Level >= SD_LEVELS - 1) {
+		return 0;
+	}
+	
+	/* Stop transfer on card and lower clock */
+	HAL_SD_StopTransfer(&uSdHandle);
+	SD_Speed.Errors++;
+	SD_SetLevel(SD_Level + 1);
+	
+	return 1;
+}
+
+#if FATFS_SDIO_USE_DMA && FATFS_SDIO_PROBE
+/**
+  * @brief  Checksum of one sector
+  * @param  data: Pointer to sector data
+  * @retval Checksum
+  */
+static uint32_t SD_Checksum(const uint32_t *data) {
+	uint32_t sum = 0, i;
+	
+	for (i = 0; i < SD_BLOCK_SIZE / 4; i++) {
+		sum = ((sum << 1) | (sum >> 31)) + data[i];
+	}
+	return sum;
+}
+
+/**
+  * @brief  Measures bandwidth on current clock level and lowers clock until reads have no errors
+  * @param  None
+  * @retval None
+  */
+static void SD_Probe(void) {
+	uint64_t address = uSdCardInfo.CardCapacity - SD_BLOCK_SIZE;
+	uint32_t reference, time, i;
+	uint8_t level = SD_Level, ok = 0;
+	
+	/* Reference data with slowest clock */
+	SD_SetLevel(SD_LEVELS - 1);
+	if (BSP_SD_ReadBlocks_DMA(SD_Scratch, address, SD_BLOCK_SIZE, 1) != MSD_OK) {
+		/* Card does not work even at slowest clock, keep default */
+		SD_SetLevel(1);
+		return;
+	}
+	reference = SD_Checksum(SD_Scratch);
+	
+	/* From selected level to slowest */
+	for (; level < SD_LEVELS && !ok; level++) {
+		SD_SetLevel(level);
+		ok = 1;
+		
+		/* Reads */
+		time = HAL_GetTick();
+		for (i = 0; i < FATFS_SDIO_PROBE_BLOCKS && ok; i++) {
+			if (BSP_SD_ReadBlocks_DMA(SD_Scratch, address, SD_BLOCK_SIZE, 1) != MSD_OK || SD_Checksum(SD_Scratch) != reference) {
+				ok = 0;
+			}
+		}
+		time = HAL_GetTick() - time;
+		SD_Speed.ReadSpeed = ok ? (FATFS_SDIO_PROBE_BLOCKS * SD_BLOCK_SIZE) / (time ? time : 1) : 0;
+		
+#if FATFS_SDIO_PROBE_WRITE
+		/* Write the same data back and read it again */
+		if (ok) {
+			time = HAL_GetTick();
+			for (i = 0; i < FATFS_SDIO_PROBE_BLOCKS && ok; i++) {
+				if (BSP_SD_WriteBlocks_DMA(SD_Scratch, address, SD_BLOCK_SIZE, 1) != MSD_OK) {
+					ok = 0;
+				}
+			}
+			time = HAL_GetTick() - time;
+			if (ok && (BSP_SD_ReadBlocks_DMA(SD_Scratch, address, SD_BLOCK_SIZE, 1) != MSD_OK || SD_Checksum(SD_Scratch) != reference)) {
+				ok = 0;
+			}
+			SD_Speed.WriteSpeed = ok ? (FATFS_SDIO_PROBE_BLOCKS * SD_BLOCK_SIZE) / (time ? time : 1) : 0;
+		}
+#endif
+		
+		/* Stop card transfer before slower level is tried */
+		if (!ok) {
+			HAL_SD_StopTransfer(&uSdHandle);
+			SD_Speed.Errors++;
+		}
+	}
+	
+	/* Slowest level is used when all failed */
+	if (!ok) {
+		SD_SetLevel(SD_LEVELS - 1);
+	}
+}
+#endif
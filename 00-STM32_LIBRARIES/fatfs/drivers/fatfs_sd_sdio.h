@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.4
  * @ide     Keil uVision
  * @license GNU GPL v3
  * @brief   SDIO driver for reading SD cards
@@ -28,7 +28,7 @@
 \endverbatim
  */
 #ifndef TM_FATFS_SDIO_H
-#define TM_FATFS_SDIO_H 100
+#define TM_FATFS_SDIO_H 140
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -44,12 +44,78 @@ extern C {
  * @defgroup TM_FATFS_SDIO
  * @brief    SDIO driver for reading SD cards
  * @{
+ *
+ * \par DMA transfers
+ *
+ * Sectors are transferred with DMA by default. Set FATFS_SDIO_USE_DMA to 0 in defines.h file for polling mode.
+ *
+ * DMA needs word aligned memory (32-bytes aligned on STM32F7xx because of data cache).
+ * When FatFs passes unaligned buffer, sectors are transferred one by one through internal aligned buffer.
+ *
+ * When used with CMSIS-RTOS (FreeRTOS), set FATFS_SDIO_USE_RTOS to 1 in defines.h file.
+ * Calling task then waits on semaphore for DMA transfer to finish and other tasks can run.
+ * Until kernel is started, transfer end is polled as without RTOS.
+ *
+\code
+//Use RTOS semaphore while waiting for DMA
+#define FATFS_SDIO_USE_RTOS      1
+
+//DMA transfer timeout in units of milliseconds
+#define FATFS_SDIO_DMA_TIMEOUT   1000
+\endcode
+ *
+ * \par High speed mode and clock tuning
+ *
+ * After 4-bit bus is configured, card is switched to high speed mode (50MHz) with CMD6. When card supports it and DMA is used,
+ * SDIO clock divider is bypassed, so bus clock is equal to SDIO kernel clock (48MHz). Otherwise bus runs at 24MHz as before.
+ *
+ * On startup, bandwidth probe reads last sector of card FATFS_SDIO_PROBE_BLOCKS times at each clock level, from fastest to slowest,
+ * and compares data with read at the slowest clock. First level without CRC errors is used. During operation, read or write with
+ * data error (CRC, FIFO overrun or underrun) lowers clock by one level and is repeated.
+ *
+ * Probe can also write sector back with the same data and read it again, set FATFS_SDIO_PROBE_WRITE to 1 for this.
+ * Get selected clock and measured bandwidth with @ref BSP_SD_GetSpeed.
+ *
+\code
+//Switch card to high speed mode
+#define FATFS_SDIO_HIGH_SPEED      1
+
+//Bypass clock divider in high speed mode
+#define FATFS_SDIO_CLOCK_BYPASS    1
+
+//Bandwidth probe on startup
+#define FATFS_SDIO_PROBE           1
+
+//Write sector back during probe
+#define FATFS_SDIO_PROBE_WRITE     0
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Disk read and write use DMA by default
+  - Added CMSIS-RTOS semaphore wait for DMA transfers
+  - Unaligned buffers are transferred through aligned internal buffer
+
+ Version 1.2
+  - October 14, 2026
+  - Added BSP_SD_ReadBlocks_DMA_Start, BSP_SD_WriteBlocks_DMA_Start and BSP_SD_WaitTransfer for transfers in background
+  - RTOS semaphore is not used when waiting from interrupt
+
+ Version 1.3
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
+
+ Version 1.4
+  - October 14, 2026
+  - Added high speed mode switch with CMD6 and SDIO clock divider bypass
+  - Added startup bandwidth probe and clock fallback on data errors
+  - Added BSP_SD_GetSpeed function
 \endverbatim
  *
  * \par Dependencies
@@ -58,11 +124,16 @@ extern C {
  - STM32Fxxx HAL
  - defines.h
  - diskio.h
+ - cmsis_os.h       (only when FATFS_SDIO_USE_RTOS is 1)
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "diskio.h"
+#include "string.h"
+#if FATFS_SDIO_USE_RTOS
+#include "cmsis_os.h"
+#endif
 
 /**
  * @defgroup TM_LIB_Macros
@@ -75,6 +146,59 @@ extern C {
 #define FATFS_SDIO_4BIT     1
 #endif
 
+/* Use DMA for disk read and write operations */
+#ifndef FATFS_SDIO_USE_DMA
+#define FATFS_SDIO_USE_DMA     1
+#endif
+
+/* Wait for DMA transfer on CMSIS-RTOS semaphore */
+#ifndef FATFS_SDIO_USE_RTOS
+#define FATFS_SDIO_USE_RTOS    0
+#endif
+
+/* DMA transfer timeout in units of milliseconds when RTOS is used */
+#ifndef FATFS_SDIO_DMA_TIMEOUT
+#define FATFS_SDIO_DMA_TIMEOUT 1000
+#endif
+
+/* NVIC preemption priority for SDIO, DMA streams are one level lower */
+#ifndef FATFS_SDIO_NVIC_PRIORITY
+#define FATFS_SDIO_NVIC_PRIORITY NVIC_PRIORITY_NORMAL
+#endif
+#ifndef FATFS_SDIO_DMA_NVIC_PRIORITY
+#define FATFS_SDIO_DMA_NVIC_PRIORITY (FATFS_SDIO_NVIC_PRIORITY + 1)
+#endif
+
+/* Switch card to high speed mode after bus width is set */
+#ifndef FATFS_SDIO_HIGH_SPEED
+#define FATFS_SDIO_HIGH_SPEED  1
+#endif
+
+/* Bypass clock divider in high speed mode, used only with DMA */
+#ifndef FATFS_SDIO_CLOCK_BYPASS
+#define FATFS_SDIO_CLOCK_BYPASS 1
+#endif
+
+/* SDIO kernel clock in Hz, from PLL Q output */
+#ifndef FATFS_SDIO_CLOCK
+#define FATFS_SDIO_CLOCK       48000000
+#endif
+
+/* Bandwidth probe on startup, used only with DMA */
+#ifndef FATFS_SDIO_PROBE
+#define FATFS_SDIO_PROBE       1
+#endif
+
+/* Number of sector reads on each clock level in probe */
+#ifndef FATFS_SDIO_PROBE_BLOCKS
+#define FATFS_SDIO_PROBE_BLOCKS 32
+#endif
+
+/* Write sector back with the same data during probe */
+#ifndef FATFS_SDIO_PROBE_WRITE
+#define FATFS_SDIO_PROBE_WRITE 0
+#endif
+
 /**
  * @}
  */
@@ -84,7 +208,18 @@ extern C {
  * @brief    Library Typedefs
  * @{
  */
-/* Typedefs here */
+/**
+ * @brief  Bus speed information
+ */
+typedef struct {
+	uint8_t HighSpeed;   /*!< Card is in high speed mode */
+	uint8_t Bypass;      /*!< SDIO clock divider is bypassed */
+	uint8_t ClockDiv;    /*!< SDIO clock divider when not bypassed */
+	uint32_t Clock;      /*!< Bus clock in Hz */
+	uint32_t ReadSpeed;  /*!< Read speed measured in probe in kB/s, 0 if not measured */
+	uint32_t WriteSpeed; /*!< Write speed measured in probe in kB/s, 0 if not measured */
+	uint32_t Errors;     /*!< Number of data errors in probe and during operation which lowered clock */
+} TM_FATFS_SDIO_Speed_t;
 /**
  * @}
  */
@@ -103,11 +238,15 @@ uint8_t BSP_SD_ReadBlocks(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize
 uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks);
 uint8_t BSP_SD_ReadBlocks_DMA(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks);
 uint8_t BSP_SD_WriteBlocks_DMA(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks);
+uint8_t BSP_SD_ReadBlocks_DMA_Start(uint32_t *pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks);
+uint8_t BSP_SD_WriteBlocks_DMA_Start(uint32_t *pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks);
+uint8_t BSP_SD_WaitTransfer(void);
 uint8_t BSP_SD_Erase(uint64_t StartAddr, uint64_t EndAddr);
 HAL_SD_TransferStateTypedef BSP_SD_GetStatus(void);
 void    BSP_SD_GetCardInfo(HAL_SD_CardInfoTypedef *CardInfo);
 uint8_t BSP_SD_IsDetected(void);
 uint8_t BSP_SD_IsWriteProtected(void);
+void    BSP_SD_GetSpeed(TM_FATFS_SDIO_Speed_t *Speed);
 
 /**
  * @}
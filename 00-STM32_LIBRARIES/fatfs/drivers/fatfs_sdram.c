@@ -21,6 +21,20 @@
 /* Status for SDRAM */
 static volatile DSTATUS SDRAM_Status = STA_NOINIT;
 
+#if FATFS_SDRAM_USE_DMA
+/* DMA handle and transfer state */
+static DMA_HandleTypeDef SDRAM_DMA_Handle;
+static volatile uint8_t SDRAM_DMA_Done, SDRAM_DMA_Error;
+#if FATFS_SDRAM_USE_RTOS
+osSemaphoreDef(SDRAM_Semaphore);
+static osSemaphoreId SDRAM_SemaphoreId;
+#endif
+
+static void TM_FATFS_SDRAM_INT_DMAInit(void);
+static uint8_t TM_FATFS_SDRAM_INT_Copy(void* dst, const void* src, uint32_t size);
+static void TM_FATFS_SDRAM_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+#endif
+
 DSTATUS TM_FATFS_SDRAM_disk_initialize(void) {
 	/* Init SDRAM */
 	if (!TM_SDRAM_Init()) {
@@ -31,6 +45,11 @@ DSTATUS TM_FATFS_SDRAM_disk_initialize(void) {
 		return STA_NODISK;
 	}
 	
+#if FATFS_SDRAM_USE_DMA
+	/* Init DMA for copy */
+	TM_FATFS_SDRAM_INT_DMAInit();
+#endif
+	
 	/* Clear NOINIT flag */
 	SDRAM_Status &= ~STA_NOINIT;
 	
@@ -47,13 +66,12 @@ DRESULT TM_FATFS_SDRAM_disk_ioctl(BYTE cmd, void* buff) {
 	/* Get command */
 	switch (cmd) {
 		case GET_SECTOR_COUNT:	/* Get drive capacity in unit of sector (DWORD) */
-			*(WORD *)buff = SDRAM_MEMORY_SIZE / FATFS_SDRAM_SECTOR_SIZE;
+			*(DWORD *)buff = SDRAM_MEMORY_SIZE / FATFS_SDRAM_SECTOR_SIZE;
 			break;
 
 		/* Size in bytes for single sector */
 		case GET_SECTOR_SIZE:
 			*(WORD *)buff = FATFS_SDRAM_SECTOR_SIZE;
-			res = RES_OK;
 			break;
 			
 		case GET_BLOCK_SIZE:	/* Get erase block size in unit of sector (DWORD) */
@@ -84,6 +102,13 @@ DRESULT TM_FATFS_SDRAM_disk_read(BYTE *buff, DWORD sector, UINT count) {
 	/* Get number of elements to read */
 	cnt = count * FATFS_SDRAM_SECTOR_SIZE;
 	
+#if FATFS_SDRAM_USE_DMA
+	/* Large aligned requests are copied with DMA */
+	if (count >= FATFS_SDRAM_DMA_MIN_SECTORS && !((uint32_t)buff & 0x03)) {
+		return TM_FATFS_SDRAM_INT_Copy(buff, (uint8_t *)(SDRAM_START_ADR + start), cnt) ? RES_ERROR : RES_OK;
+	}
+#endif
+	
 	/* Read data from external ram */
 	memcpy((uint8_t *)buff, (uint8_t *)(SDRAM_START_ADR + start), cnt);
 	
@@ -105,9 +130,121 @@ DRESULT TM_FATFS_SDRAM_disk_write(const BYTE *buff, DWORD sector, UINT count) {
 	/* Get number of elements to read */
 	cnt = count * FATFS_SDRAM_SECTOR_SIZE;
 	
-	/* Read data from external ram */
+#if FATFS_SDRAM_USE_DMA
+	/* Large aligned requests are copied with DMA */
+	if (count >= FATFS_SDRAM_DMA_MIN_SECTORS && !((uint32_t)buff & 0x03)) {
+		return TM_FATFS_SDRAM_INT_Copy((uint8_t *)(SDRAM_START_ADR + start), buff, cnt) ? RES_ERROR : RES_OK;
+	}
+#endif
+	
+	/* Write data to external ram */
 	memcpy((uint8_t *)(SDRAM_START_ADR + start), (uint8_t *)buff, cnt);
 
 	/* Return OK */
 	return RES_OK;
 }
+
+#if FATFS_SDRAM_USE_DMA
+static void TM_FATFS_SDRAM_INT_DMAInit(void) {
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(FATFS_SDRAM_DMA_STREAM, NULL);
+	FATFS_SDRAM_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(FATFS_SDRAM_DMA_STREAM);
+	
+	/* Memory to memory, 32-bit words, both addresses increment */
+	SDRAM_DMA_Handle.Instance = FATFS_SDRAM_DMA_STREAM;
+	SDRAM_DMA_Handle.Init.Channel = FATFS_SDRAM_DMA_CHANNEL;
+	SDRAM_DMA_Handle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+	SDRAM_DMA_Handle.Init.PeriphInc = DMA_PINC_ENABLE;
+	SDRAM_DMA_Handle.Init.MemInc = DMA_MINC_ENABLE;
+	SDRAM_DMA_Handle.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	SDRAM_DMA_Handle.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	SDRAM_DMA_Handle.Init.Mode = DMA_NORMAL;
+	SDRAM_DMA_Handle.Init.Priority = DMA_PRIORITY_MEDIUM;
+	SDRAM_DMA_Handle.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+	SDRAM_DMA_Handle.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	SDRAM_DMA_Handle.Init.MemBurst = DMA_MBURST_SINGLE;
+	SDRAM_DMA_Handle.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(FATFS_SDRAM_DMA_STREAM, &SDRAM_DMA_Handle);
+	
+	/* Set library callback for stream and enable interrupts */
+	TM_DMA_SetStreamCallback(FATFS_SDRAM_DMA_STREAM, TM_FATFS_SDRAM_INT_DMACallback, NULL);
+	TM_DMA_EnableInterrupts(FATFS_SDRAM_DMA_STREAM);
+	
+#if FATFS_SDRAM_USE_RTOS
+	/* Create semaphore for waiting task */
+	if (SDRAM_SemaphoreId == NULL) {
+		SDRAM_SemaphoreId = osSemaphoreCreate(osSemaphore(SDRAM_Semaphore), 1);
+		osSemaphoreWait(SDRAM_SemaphoreId, 0);
+	}
+#endif
+}
+
+static uint8_t TM_FATFS_SDRAM_INT_Copy(void* dst, const void* src, uint32_t size) {
+	uint8_t* d = (uint8_t *)dst;
+	const uint8_t* s = (const uint8_t *)src;
+	uint32_t count, remaining = size;
+	
+#if defined(STM32F7xx)
+	/* Source must be in memory, destination is invalidated after copy */
+	SCB_CleanDCache_by_Addr((uint32_t *)src, size);
+	SCB_CleanInvalidateDCache_by_Addr((uint32_t *)dst, size);
+#endif
+	
+	SDRAM_DMA_Error = 0;
+	while (remaining && !SDRAM_DMA_Error) {
+		/* Max 0xFFFF words in one transfer */
+		count = remaining >> 2;
+		if (count > 0xFFFF) {
+			count = 0xFFFF;
+		}
+		
+		/* Start copy */
+		SDRAM_DMA_Done = 0;
+		TM_DMA_Start(&SDRAM_DMA_Handle, (uint32_t)s, (uint32_t)d, count);
+		
+#if FATFS_SDRAM_USE_RTOS
+		/* Let other tasks run until copy is done */
+		if (SDRAM_SemaphoreId != NULL && osKernelRunning() && !__get_IPSR()) {
+			osSemaphoreWait(SDRAM_SemaphoreId, FATFS_SDRAM_DMA_TIMEOUT);
+		}
+#endif
+		
+		/* Wait for transfer end */
+		while (!SDRAM_DMA_Done);
+		
+		s += count << 2;
+		d += count << 2;
+		remaining -= count << 2;
+	}
+	
+#if defined(STM32F7xx)
+	/* Remove stale lines read during copy */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)dst, size);
+#endif
+	
+	/* Return status */
+	return SDRAM_DMA_Error;
+}
+
+static void TM_FATFS_SDRAM_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	/* Check for errors, stream is disabled by hardware */
+	if (flags & (DMA_FLAG_TEIF | DMA_FLAG_DMEIF)) {
+		SDRAM_DMA_Error = 1;
+	} else if (!(flags & DMA_FLAG_TCIF)) {
+		return;
+	}
+	
+	/* Transfer done */
+	SDRAM_DMA_Done = 1;
+	
+#if FATFS_SDRAM_USE_RTOS
+	/* Release waiting task */
+	if (SDRAM_SemaphoreId != NULL) {
+		osSemaphoreRelease(SDRAM_SemaphoreId);
+	}
+#endif
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license GNU GPL v3
  * @brief   Library template 
@@ -28,7 +28,7 @@
 \endverbatim
  */
 #ifndef TM_FATFS_SDRAM_H
-#define TM_FATFS_SDRAM_H 100
+#define TM_FATFS_SDRAM_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -42,14 +42,44 @@ extern "C" {
 
 /**
  * @defgroup TM_FATFS_SDRAM
- * @brief    Library description here
+ * @brief    SDRAM RAM disk driver for FATFS
  * @{
+ *
+ * \par DMA transfers
+ *
+ * On STM32F4xx and STM32F7xx, sectors are copied between SDRAM and FATFS buffer with DMA2 memory to memory transfer,
+ * so CPU does not stall on FMC wait states. Requests with less than FATFS_SDRAM_DMA_MIN_SECTORS sectors
+ * or with not word aligned buffer are copied with CPU.
+ *
+ * When used with CMSIS-RTOS (FreeRTOS), set FATFS_SDRAM_USE_RTOS to 1 and calling task waits on semaphore,
+ * so other tasks can run during copy.
+ *
+\code
+//Disable DMA copy
+#define FATFS_SDRAM_USE_DMA          0
+
+//DMA stream for copy, must be DMA2 for memory to memory transfers
+#define FATFS_SDRAM_DMA_STREAM       DMA2_Stream0
+#define FATFS_SDRAM_DMA_CHANNEL      DMA_CHANNEL_0
+
+//Minimal number of sectors in one request to use DMA
+#define FATFS_SDRAM_DMA_MIN_SECTORS  2
+
+//Use RTOS semaphore while waiting for DMA
+#define FATFS_SDRAM_USE_RTOS         1
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Multi-sector reads and writes are copied with DMA2 memory to memory transfer on STM32F4xx and STM32F7xx
+  - Added CMSIS-RTOS semaphore wait for DMA copy
+  - Fixed GET_SECTOR_COUNT returning 16-bit value
 \endverbatim
  *
  * \par Dependencies
@@ -58,6 +88,8 @@ extern "C" {
  - STM32Fxxx HAL
  - defines.h
  - TM SDRAM
+ - TM DMA           (only when FATFS_SDRAM_USE_DMA is 1)
+ - cmsis_os.h       (only when FATFS_SDRAM_USE_RTOS is 1)
 \endverbatim
  */
 
@@ -79,9 +111,46 @@ extern "C" {
 #define FATFS_SDRAM_SECTOR_SIZE    512
 #endif
 
+/* Copy sectors with memory to memory DMA, not available on STM32F0xx */
+#ifndef FATFS_SDRAM_USE_DMA
+#if defined(STM32F4xx) || defined(STM32F7xx)
+#define FATFS_SDRAM_USE_DMA        1
+#else
+#define FATFS_SDRAM_USE_DMA        0
+#endif
+#endif
+
+/* DMA stream for memory to memory copy, must be DMA2 */
+#ifndef FATFS_SDRAM_DMA_STREAM
+#define FATFS_SDRAM_DMA_STREAM     DMA2_Stream0
+#define FATFS_SDRAM_DMA_CHANNEL    DMA_CHANNEL_0
+#endif
+
+/* Smaller requests are copied with CPU, DMA setup takes longer than copy itself */
+#ifndef FATFS_SDRAM_DMA_MIN_SECTORS
+#define FATFS_SDRAM_DMA_MIN_SECTORS  2
+#endif
+
+/* Wait for DMA copy on CMSIS-RTOS semaphore */
+#ifndef FATFS_SDRAM_USE_RTOS
+#define FATFS_SDRAM_USE_RTOS       0
+#endif
+
+/* DMA copy timeout in units of milliseconds when RTOS is used */
+#ifndef FATFS_SDRAM_DMA_TIMEOUT
+#define FATFS_SDRAM_DMA_TIMEOUT    100
+#endif
+
 /**
  * @}
  */
+
+#if FATFS_SDRAM_USE_DMA
+#include "tm_stm32_dma.h"
+#endif
+#if FATFS_SDRAM_USE_RTOS
+#include "cmsis_os.h"
+#endif
  
 /**
  * @defgroup TM_FATFS_SDRAM_Typedefs
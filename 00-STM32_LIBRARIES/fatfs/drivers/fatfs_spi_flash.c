@@ -18,12 +18,368 @@
  */
 #include "fatfs_spi_flash.h"
 
+/* SPI NOR flash commands */
+#define FLASH_CMD_WRITE_ENABLE     0x06
+#define FLASH_CMD_READ_STATUS      0x05
+#define FLASH_CMD_READ             0x03
+#define FLASH_CMD_PAGE_PROGRAM     0x02
+#define FLASH_CMD_SECTOR_ERASE     0x20
+#define FLASH_CMD_READ_ID          0x9F
+#define FLASH_STATUS_BUSY          0x01
+
+/* Number of physical erase blocks */
+#define WL_BLOCKS                  (FATFS_SPI_FLASH_MEMORY_SIZE / FATFS_SPI_FLASH_ERASE_SIZE)
+
+/* Number of blocks available to FatFs */
+#define WL_LOGICAL_BLOCKS          (WL_BLOCKS - FATFS_SPI_FLASH_SPARE_BLOCKS)
+
+/* Data sectors in block, first sector is used for header */
+#define WL_SECTORS                 ((FATFS_SPI_FLASH_ERASE_SIZE / FATFS_SPI_FLASH_SECTOR_SIZE) - 1)
+
+/* Size of data in block in units of bytes */
+#define WL_DATA_SIZE               (WL_SECTORS * FATFS_SPI_FLASH_SECTOR_SIZE)
+
+/* Block address in flash */
+#define WL_BLOCK_ADDR(block)       ((uint32_t)(block) * FATFS_SPI_FLASH_ERASE_SIZE)
+
+/* Not mapped block */
+#define WL_NONE                    0xFFFF
+
+/* Header identifier, "TMWL" */
+#define WL_MAGIC                   0x4C574D54
+
+#if WL_SECTORS < 1
+#error "FATFS_SPI_FLASH_ERASE_SIZE must be at least 2 sectors"
+#endif
+#if FATFS_SPI_FLASH_SPARE_BLOCKS < 1 || WL_BLOCKS <= FATFS_SPI_FLASH_SPARE_BLOCKS
+#error "FATFS_SPI_FLASH_SPARE_BLOCKS must be at least 1 and less than number of blocks"
+#endif
+#if FATFS_SPI_FLASH_MEMORY_SIZE > 0x1000000
+#error "Only 24-bit address is supported, maximal memory size is 16 MB"
+#endif
+
+/* Block header, stored at the beginning of each used block */
+typedef struct {
+	uint32_t Magic;       /* Header identifier */
+	uint16_t Logical;     /* Logical block number stored in this block */
+	uint16_t EraseCount;  /* Number of erase cycles of this block */
+	uint32_t Sequence;    /* Write sequence number, higher is newer */
+	uint32_t Check;       /* Check value for header fields */
+} WL_Header_t;
+
+/* Check value for header */
+#define WL_HEADER_CHECK(h)         (~((h)->Magic ^ (h)->Sequence ^ ((uint32_t)(h)->Logical << 16) ^ (h)->EraseCount))
+
 /* Status for SPIFLASH */
 static volatile DSTATUS SPI_FLASH_Status = STA_NOINIT;
 
+/* Physical block for each logical block */
+static uint16_t WL_Map[WL_LOGICAL_BLOCKS];
+
+/* Erase count for each physical block */
+static uint16_t WL_EraseCount[WL_BLOCKS];
+
+/* Physical blocks holding current data */
+static uint8_t WL_Used[(WL_BLOCKS + 7) / 8];
+
+/* Last sequence number used */
+static uint32_t WL_Sequence;
+
+/* RAM copy of one logical block */
+static uint32_t WL_CacheMemory[WL_DATA_SIZE / 4];
+#define WL_Cache                   ((uint8_t *)WL_CacheMemory)
+static uint16_t WL_CacheBlock = WL_NONE;
+static uint8_t WL_CacheDirty;
+
+#define WL_IS_USED(block)          (WL_Used[(block) >> 3] & (1 << ((block) & 0x07)))
+#define WL_SET_USED(block)         (WL_Used[(block) >> 3] |= (1 << ((block) & 0x07)))
+#define WL_CLEAR_USED(block)       (WL_Used[(block) >> 3] &= ~(1 << ((block) & 0x07)))
+
+/**************************************************************/
+/*                    FLASH LOW LEVEL                         */
+/**************************************************************/
+/* Send command with 24-bit address, CS stays low */
+static void FLASH_INT_Command(uint8_t cmd, uint32_t addr) {
+	FATFS_SPI_FLASH_CS_LOW;
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, cmd);
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, (uint8_t)(addr >> 16));
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, (uint8_t)(addr >> 8));
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, (uint8_t)(addr));
+}
+
+/* Wait for erase or program operation to finish, 1:OK, 0:Timeout */
+static uint8_t FLASH_INT_WaitReady(void) {
+	uint8_t status;
+	
+	/* Set timeout */
+	TM_DELAY_SetTime2(FATFS_SPI_FLASH_TIMEOUT);
+	
+	FATFS_SPI_FLASH_CS_LOW;
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, FLASH_CMD_READ_STATUS);
+	do {
+		status = TM_SPI_Send(FATFS_SPI_FLASH_SPI, 0xFF);
+	} while ((status & FLASH_STATUS_BUSY) && TM_DELAY_Time2());
+	FATFS_SPI_FLASH_CS_HIGH;
+	
+	return !(status & FLASH_STATUS_BUSY);
+}
+
+/* Enable write for next erase or program operation */
+static void FLASH_INT_WriteEnable(void) {
+	FATFS_SPI_FLASH_CS_LOW;
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, FLASH_CMD_WRITE_ENABLE);
+	FATFS_SPI_FLASH_CS_HIGH;
+}
+
+/* Read data from flash */
+static void FLASH_INT_Read(uint32_t addr, uint8_t* buff, uint32_t count) {
+	FLASH_INT_Command(FLASH_CMD_READ, addr);
+#if FATFS_SPI_FLASH_DMA
+	do {
+		TM_SPI_DMA_Receive(FATFS_SPI_FLASH_SPI, buff, count > 0xFFFF ? 0xFFFF : count);
+		while (TM_SPI_DMA_Transmitting(FATFS_SPI_FLASH_SPI));
+		
+		if (count > 0xFFFF) {
+			count -= 0xFFFF;
+			buff += 0xFFFF;
+		} else {
+			count = 0;
+		}
+	} while (count > 0);
+#else
+	TM_SPI_ReadMulti(FATFS_SPI_FLASH_SPI, buff, 0xFF, count);
+#endif
+	FATFS_SPI_FLASH_CS_HIGH;
+}
+
+/* Program data to erased flash, 1:OK, 0:Failed */
+static uint8_t FLASH_INT_Program(uint32_t addr, const uint8_t* buff, uint32_t count) {
+	uint32_t len;
+	
+	while (count > 0) {
+		/* Program can not cross page boundary */
+		len = FATFS_SPI_FLASH_PAGE_SIZE - (addr % FATFS_SPI_FLASH_PAGE_SIZE);
+		if (len > count) {
+			len = count;
+		}
+		
+		FLASH_INT_WriteEnable();
+		FLASH_INT_Command(FLASH_CMD_PAGE_PROGRAM, addr);
+#if FATFS_SPI_FLASH_DMA
+		TM_SPI_DMA_Send(FATFS_SPI_FLASH_SPI, (uint8_t *)buff, len);
+		while (TM_SPI_DMA_Transmitting(FATFS_SPI_FLASH_SPI));
+#else
+		TM_SPI_WriteMulti(FATFS_SPI_FLASH_SPI, (uint8_t *)buff, len);
+#endif
+		FATFS_SPI_FLASH_CS_HIGH;
+		
+		/* Wait for page to be programmed */
+		if (!FLASH_INT_WaitReady()) {
+			return 0;
+		}
+		
+		addr += len;
+		buff += len;
+		count -= len;
+	}
+	
+	return 1;
+}
+
+/* Erase one block, 1:OK, 0:Failed */
+static uint8_t FLASH_INT_Erase(uint32_t addr) {
+	FLASH_INT_WriteEnable();
+	FLASH_INT_Command(FLASH_CMD_SECTOR_ERASE, addr);
+	FATFS_SPI_FLASH_CS_HIGH;
+	
+	return FLASH_INT_WaitReady();
+}
+
+/**************************************************************/
+/*                    WEAR LEVELLING                          */
+/**************************************************************/
+/* Check if memory is erased */
+static uint8_t WL_INT_IsErased(const uint8_t* buff, uint32_t count) {
+	while (count--) {
+		if (*buff++ != 0xFF) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Read headers of all blocks and build block map */
+static void WL_INT_Mount(void) {
+	WL_Header_t header;
+	uint16_t block, old;
+	
+	/* Reset tables */
+	memset(WL_Map, 0xFF, sizeof(WL_Map));
+	memset(WL_Used, 0x00, sizeof(WL_Used));
+	memset(WL_EraseCount, 0x00, sizeof(WL_EraseCount));
+	WL_Sequence = 0;
+	WL_CacheBlock = WL_NONE;
+	WL_CacheDirty = 0;
+	
+	for (block = 0; block < WL_BLOCKS; block++) {
+		/* Read header */
+		FLASH_INT_Read(WL_BLOCK_ADDR(block), (uint8_t *)&header, sizeof(header));
+		
+		/* Check for valid header, erased or broken block is free */
+		if (
+			header.Magic != WL_MAGIC ||
+			header.Check != WL_HEADER_CHECK(&header)
+		) {
+			continue;
+		}
+		
+		/* Save erase count, also for old copies which are free */
+		WL_EraseCount[block] = header.EraseCount;
+		
+		/* Save newest sequence number */
+		if (header.Sequence > WL_Sequence) {
+			WL_Sequence = header.Sequence;
+		}
+		
+		/* Logical block outside disk */
+		if (header.Logical >= WL_LOGICAL_BLOCKS) {
+			continue;
+		}
+		
+		/* Check for another copy of the same logical block */
+		old = WL_Map[header.Logical];
+		if (old != WL_NONE) {
+			WL_Header_t oldheader;
+			
+			/* Keep newer copy */
+			FLASH_INT_Read(WL_BLOCK_ADDR(old), (uint8_t *)&oldheader, sizeof(oldheader));
+			if (oldheader.Sequence > header.Sequence) {
+				continue;
+			}
+			WL_CLEAR_USED(old);
+		}
+		
+		/* Map block */
+		WL_Map[header.Logical] = block;
+		WL_SET_USED(block);
+	}
+}
+
+/* Write logical block from cache to new physical block, 1:OK, 0:Failed */
+static uint8_t WL_INT_WriteBlock(uint16_t logical) {
+	WL_Header_t header;
+	uint16_t block, i, old;
+	
+	/* Find free block with the lowest erase count */
+	block = WL_NONE;
+	for (i = 0; i < WL_BLOCKS; i++) {
+		if (!WL_IS_USED(i) && (block == WL_NONE || WL_EraseCount[i] < WL_EraseCount[block])) {
+			block = i;
+		}
+	}
+	if (block == WL_NONE) {
+		return 0;
+	}
+	
+	/* Erase block */
+	if (WL_EraseCount[block] < 0xFFFF) {
+		WL_EraseCount[block]++;
+	}
+	if (!FLASH_INT_Erase(WL_BLOCK_ADDR(block))) {
+		return 0;
+	}
+	
+	/* Write data first, block is valid only when header is written */
+	if (!FLASH_INT_Program(WL_BLOCK_ADDR(block) + FATFS_SPI_FLASH_SECTOR_SIZE, WL_Cache, WL_DATA_SIZE)) {
+		return 0;
+	}
+	
+	/* Write header */
+	header.Magic = WL_MAGIC;
+	header.Logical = logical;
+	header.EraseCount = WL_EraseCount[block];
+	header.Sequence = ++WL_Sequence;
+	header.Check = WL_HEADER_CHECK(&header);
+	if (!FLASH_INT_Program(WL_BLOCK_ADDR(block), (uint8_t *)&header, sizeof(header))) {
+		return 0;
+	}
+	
+	/* Old block is free now, it has older sequence number and is ignored on next mount */
+	old = WL_Map[logical];
+	if (old != WL_NONE) {
+		WL_CLEAR_USED(old);
+	}
+	WL_Map[logical] = block;
+	WL_SET_USED(block);
+	
+	return 1;
+}
+
+/* Write cached block to flash if modified, 1:OK, 0:Failed */
+static uint8_t WL_INT_Flush(void) {
+	if (WL_CacheBlock == WL_NONE || !WL_CacheDirty) {
+		return 1;
+	}
+	
+	if (!WL_INT_WriteBlock(WL_CacheBlock)) {
+		return 0;
+	}
+	WL_CacheDirty = 0;
+	
+	return 1;
+}
+
+/* Load logical block to cache */
+static void WL_INT_Load(uint16_t logical) {
+	if (WL_Map[logical] == WL_NONE) {
+		/* Never written, erased */
+		memset(WL_Cache, 0xFF, WL_DATA_SIZE);
+	} else {
+		FLASH_INT_Read(WL_BLOCK_ADDR(WL_Map[logical]) + FATFS_SPI_FLASH_SECTOR_SIZE, WL_Cache, WL_DATA_SIZE);
+	}
+	WL_CacheBlock = logical;
+	WL_CacheDirty = 0;
+}
+
+/**************************************************************/
+/*                    LOW LEVEL FUNCTIONS                     */
+/**************************************************************/
 DSTATUS TM_FATFS_SPI_FLASH_disk_initialize(void) {
+	uint8_t id[3];
+	
+	/* Init delay functions */
+	TM_DELAY_Init();
+	
+	/* Init CS pin and SPI */
+	TM_GPIO_Init(FATFS_SPI_FLASH_CS_PORT, FATFS_SPI_FLASH_CS_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium);
+	FATFS_SPI_FLASH_CS_HIGH;
+	TM_SPI_Init(FATFS_SPI_FLASH_SPI, FATFS_SPI_FLASH_SPI_PINSPACK);
+#if FATFS_SPI_FLASH_DMA
+	TM_SPI_DMA_Init(FATFS_SPI_FLASH_SPI);
+#endif
+	
+	/* Read JEDEC ID */
+	FATFS_SPI_FLASH_CS_LOW;
+	TM_SPI_Send(FATFS_SPI_FLASH_SPI, FLASH_CMD_READ_ID);
+	id[0] = TM_SPI_Send(FATFS_SPI_FLASH_SPI, 0xFF);
+	id[1] = TM_SPI_Send(FATFS_SPI_FLASH_SPI, 0xFF);
+	id[2] = TM_SPI_Send(FATFS_SPI_FLASH_SPI, 0xFF);
+	FATFS_SPI_FLASH_CS_HIGH;
+	
+	/* Check if memory responds */
+	if ((id[0] == 0x00 && id[1] == 0x00) || (id[0] == 0xFF && id[1] == 0xFF)) {
+		/* Set NOINIT flag */
+		SPI_FLASH_Status |= STA_NOINIT;
+		
+		/* Return error */
+		return STA_NODISK;
+	}
+	
+	/* Build block map */
+	WL_INT_Mount();
+	
 	/* Clear NOINIT flag */
-	//SPI_FLASH_Status &= ~STA_NOINIT;
+	SPI_FLASH_Status &= ~STA_NOINIT;
 	
 	/* Return status */
 	return SPI_FLASH_Status;
@@ -35,31 +391,126 @@ DSTATUS TM_FATFS_SPI_FLASH_disk_status(void) {
 }
 
 DRESULT TM_FATFS_SPI_FLASH_disk_ioctl(BYTE cmd, void *buff) {
+	DRESULT res = RES_OK;
+	
+	/* If not initialized */
+	if (SPI_FLASH_Status & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+	
 	/* Get command */
 	switch (cmd) {
 		case GET_SECTOR_COUNT:	/* Get drive capacity in unit of sector (DWORD) */
-			//*(WORD *)buff = SPI_FLASH_MEMORY_SIZE / FATFS_SPI_FLASH_SECTOR_SIZE;
+			*(DWORD *)buff = (DWORD)WL_LOGICAL_BLOCKS * WL_SECTORS;
 			break;
+			
+		/* Size in bytes for single sector */
+		case GET_SECTOR_SIZE:
+			*(WORD *)buff = FATFS_SPI_FLASH_SECTOR_SIZE;
+			break;
+			
 		case GET_BLOCK_SIZE:	/* Get erase block size in unit of sector (DWORD) */
-			//*(DWORD *)buff = 32;
+			/* Blocks are remapped, FatFs does not need to align data */
+			*(DWORD *)buff = 1;
+			break;
+			
+		case CTRL_SYNC:			/* Write cached block to flash */
+			if (!WL_INT_Flush()) {
+				res = RES_ERROR;
+			}
 			break;
-		case CTRL_SYNC:
+			
 		case CTRL_ERASE_SECTOR:
 			break;
+			
 		default:
+			res = RES_PARERR;
 			break;
 	}
 	
-	/* Return ERROR */
-	return RES_ERROR;
+	/* Return status */
+	return res;
 }
 
 DRESULT TM_FATFS_SPI_FLASH_disk_read(BYTE *buff, DWORD sector, UINT count) {
-	/* Future use */
-	return RES_ERROR;
+	uint16_t logical, offset;
+	
+	/* If not initialized */
+	if (SPI_FLASH_Status & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+	
+	while (count--) {
+		/* Get block and sector in block */
+		logical = sector / WL_SECTORS;
+		offset = sector % WL_SECTORS;
+		if (logical >= WL_LOGICAL_BLOCKS) {
+			return RES_PARERR;
+		}
+		
+		if (logical == WL_CacheBlock) {
+			/* Block is in RAM */
+			memcpy(buff, &WL_Cache[offset * FATFS_SPI_FLASH_SECTOR_SIZE], FATFS_SPI_FLASH_SECTOR_SIZE);
+		} else if (WL_Map[logical] == WL_NONE) {
+			/* Never written */
+			memset(buff, 0xFF, FATFS_SPI_FLASH_SECTOR_SIZE);
+		} else {
+			/* Read from flash */
+			FLASH_INT_Read(WL_BLOCK_ADDR(WL_Map[logical]) + (offset + 1) * FATFS_SPI_FLASH_SECTOR_SIZE, buff, FATFS_SPI_FLASH_SECTOR_SIZE);
+		}
+		
+		buff += FATFS_SPI_FLASH_SECTOR_SIZE;
+		sector++;
+	}
+	
+	/* Return OK */
+	return RES_OK;
 }
 
 DRESULT TM_FATFS_SPI_FLASH_disk_write(const BYTE *buff, DWORD sector, UINT count) {
-	/* Future use */
-	return RES_ERROR;
+	uint16_t logical, offset;
+	uint8_t* ptr;
+	
+	/* If not initialized */
+	if (SPI_FLASH_Status & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+	
+	while (count--) {
+		/* Get block and sector in block */
+		logical = sector / WL_SECTORS;
+		offset = sector % WL_SECTORS;
+		if (logical >= WL_LOGICAL_BLOCKS) {
+			return RES_PARERR;
+		}
+		
+		/* Write previous block and load new one to RAM */
+		if (logical != WL_CacheBlock) {
+			if (!WL_INT_Flush()) {
+				return RES_ERROR;
+			}
+			WL_INT_Load(logical);
+		}
+		ptr = &WL_Cache[offset * FATFS_SPI_FLASH_SECTOR_SIZE];
+		
+		/* Check if there is anything to change */
+		if (memcmp(ptr, buff, FATFS_SPI_FLASH_SECTOR_SIZE) != 0) {
+			if (!WL_CacheDirty && WL_Map[logical] != WL_NONE && WL_INT_IsErased(ptr, FATFS_SPI_FLASH_SECTOR_SIZE)) {
+				/* Sector is still erased in flash, program it in place */
+				if (!FLASH_INT_Program(WL_BLOCK_ADDR(WL_Map[logical]) + (offset + 1) * FATFS_SPI_FLASH_SECTOR_SIZE, buff, FATFS_SPI_FLASH_SECTOR_SIZE)) {
+					return RES_ERROR;
+				}
+			} else {
+				/* Block will be written to new location on flush */
+				WL_CacheDirty = 1;
+			}
+			memcpy(ptr, buff, FATFS_SPI_FLASH_SECTOR_SIZE);
+		}
+		
+		buff += FATFS_SPI_FLASH_SECTOR_SIZE;
+		sector++;
+	}
+	
+	/* Return OK */
+	return RES_OK;
 }
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license GNU GPL v3
  * @brief   SPI based flash low level implementation for FATFS
@@ -28,7 +28,7 @@
 \endverbatim
  */
 #ifndef TM_FATFS_SPI_FLASH_H
-#define TM_FATFS_SPI_FLASH_H 100
+#define TM_FATFS_SPI_FLASH_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -42,28 +42,92 @@ extern C {
 
 /**
  * @defgroup TM_FATFS_SPI_FLASH
- * @brief    Library description here
+ * @brief    SPI NOR flash low level implementation for FATFS
  * @{
+ *
+ * Driver works with standard SPI NOR flash memories (W25Qxx, MX25Lxx, ...) with 4 kB sector erase command (0x20),
+ * 256 bytes page program (0x02) and 24-bit address, so up to 16 MB memory is supported.
+ *
+ * \par Erase block cache
+ *
+ * Flash memory is organized in blocks of erase size (4 kB). First FatFs sector in each block is used for block header,
+ * other sectors (7 with default settings) are used for data.
+ *
+ * Block which is written to is kept in RAM. Sectors written to the same block are collected in RAM
+ * and block is written to flash only once, when other block is written or when @ref f_sync is called.
+ * If sector in flash was still erased, it is programmed directly without erase.
+ *
+ * \par Wear levelling
+ *
+ * When block is written, it is never erased and written in the same place.
+ * New data are written to free block with the lowest erase count and old block becomes free.
+ * Each block header holds logical block number, erase count and sequence number, so newest copy of logical block
+ * is found when disk is initialized, even if power was lost during write.
+ *
+ * FATFS_SPI_FLASH_SPARE_BLOCKS blocks are always free and are not available to FatFs.
+ *
+ * RAM usage is 4 bytes per flash block + one erase block for cache.
+ *
+ * \par Default pinout
+ *
+\verbatim
+FLASH       STM32Fxxx       DESCRIPTION
+
+CS          PB8             Chip select, set with FATFS_SPI_FLASH_CS_PORT and FATFS_SPI_FLASH_CS_PIN
+SCK, MISO,  SPI1            Set with FATFS_SPI_FLASH_SPI and FATFS_SPI_FLASH_SPI_PINSPACK
+MOSI
+\endverbatim
+ *
+\code
+//Select SPI and CS pin
+#define FATFS_SPI_FLASH_SPI             SPI2
+#define FATFS_SPI_FLASH_SPI_PINSPACK    TM_SPI_PinsPack_1
+#define FATFS_SPI_FLASH_CS_PORT         GPIOB
+#define FATFS_SPI_FLASH_CS_PIN          GPIO_PIN_12
+
+//Set memory size, 8 MB
+#define FATFS_SPI_FLASH_MEMORY_SIZE     0x800000
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Implemented SPI NOR flash driver with erase block cache and wear levelling
 \endverbatim
  *
  * \par Dependencies
  *
 \verbatim
- - STM32F4xx
+ - STM32Fxxx HAL
  - defines.h
- - TM SDRAM
+ - diskio.h
+ - TM SPI
+ - TM SPI DMA       (only on STM32F4xx and STM32F7xx)
+ - TM DELAY
+ - TM GPIO
 \endverbatim
  */
 
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "diskio.h"
+#include "string.h"
+#include "tm_stm32_spi.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_delay.h"
+
+/* DMA for STM32F4xx and STM32F7xx */
+#if defined(STM32F4xx) || defined(STM32F7xx)
+#include "tm_stm32_spi_dma.h"
+#define FATFS_SPI_FLASH_DMA            1
+#else
+#define FATFS_SPI_FLASH_DMA            0
+#endif
 
 /**
  * @defgroup TM_FATFS_SPI_FLASH_Macros
@@ -76,10 +140,46 @@ extern C {
 #define FATFS_SPI_FLASH_SECTOR_SIZE    512
 #endif
 
-/* Memory size on flash */
+/* Memory size on flash in units of bytes, 2 MB by default */
 #ifndef FATFS_SPI_FLASH_MEMORY_SIZE
-#define FATFS_SPI_FLASH_MEMORY_SIZE    512
+#define FATFS_SPI_FLASH_MEMORY_SIZE    0x200000
+#endif
+
+/* Erase block size on flash in units of bytes */
+#ifndef FATFS_SPI_FLASH_ERASE_SIZE
+#define FATFS_SPI_FLASH_ERASE_SIZE     4096
+#endif
+
+/* Page size for program command in units of bytes */
+#ifndef FATFS_SPI_FLASH_PAGE_SIZE
+#define FATFS_SPI_FLASH_PAGE_SIZE      256
+#endif
+
+/* Number of erase blocks kept free for wear levelling */
+#ifndef FATFS_SPI_FLASH_SPARE_BLOCKS
+#define FATFS_SPI_FLASH_SPARE_BLOCKS   8
 #endif
+
+/* Timeout for erase or program operation in units of milliseconds */
+#ifndef FATFS_SPI_FLASH_TIMEOUT
+#define FATFS_SPI_FLASH_TIMEOUT        1000
+#endif
+
+/* SPI settings */
+#ifndef FATFS_SPI_FLASH_SPI
+#define FATFS_SPI_FLASH_SPI            SPI1
+#define FATFS_SPI_FLASH_SPI_PINSPACK   TM_SPI_PinsPack_1
+#endif
+
+/* CS pin settings */
+#ifndef FATFS_SPI_FLASH_CS_PIN
+#define FATFS_SPI_FLASH_CS_PORT        GPIOB
+#define FATFS_SPI_FLASH_CS_PIN         GPIO_PIN_8
+#endif
+
+/* CS pin */
+#define FATFS_SPI_FLASH_CS_LOW         TM_GPIO_SetPinLow(FATFS_SPI_FLASH_CS_PORT, FATFS_SPI_FLASH_CS_PIN)
+#define FATFS_SPI_FLASH_CS_HIGH        TM_GPIO_SetPinHigh(FATFS_SPI_FLASH_CS_PORT, FATFS_SPI_FLASH_CS_PIN)
 /**
  * @}
  */
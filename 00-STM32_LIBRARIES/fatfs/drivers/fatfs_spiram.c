@@ -0,0 +1,124 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (C) Tilen Majerle, 2016
+ * | 
+ * | This program is free software: you can redistribute it and/or modify
+ * | it under the terms of the GNU General Public License as published by
+ * | the Free Software Foundation, either version 3 of the License, or
+ * | any later version.
+ * |  
+ * | This program is distributed in the hope that it will be useful,
+ * | but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * | MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * | GNU General Public License for more details.
+ * | 
+ * | You should have received a copy of the GNU General Public License
+ * | along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * |----------------------------------------------------------------------
+ */
+#include "fatfs_spiram.h"
+
+/* Status for SPI RAM */
+static volatile DSTATUS SPIRAM_Status = STA_NOINIT;
+
+DSTATUS TM_FATFS_SPIRAM_disk_initialize(void) {
+	/* Init memory */
+	if (TM_SPIRAM_Init() != TM_SPIRAM_Result_Ok) {
+		/* Set NOINIT flag */
+		SPIRAM_Status |= STA_NOINIT;
+		
+		/* Return error */
+		return STA_NODISK;
+	}
+	
+	/* Clear NOINIT flag */
+	SPIRAM_Status &= ~STA_NOINIT;
+	
+	/* Return status */
+	return SPIRAM_Status;
+}
+
+DSTATUS TM_FATFS_SPIRAM_disk_status(void) {
+	/* Return disk status */
+	return SPIRAM_Status;
+}
+
+DRESULT TM_FATFS_SPIRAM_disk_ioctl(BYTE cmd, void* buff) {
+	DRESULT res = RES_OK;
+	
+	/* If not initialized */
+	if (SPIRAM_Status & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+	
+	/* Get command */
+	switch (cmd) {
+		case GET_SECTOR_COUNT:	/* Get drive capacity in unit of sector (DWORD) */
+			*(DWORD *)buff = FATFS_SPIRAM_SIZE / FATFS_SPIRAM_SECTOR_SIZE;
+			break;
+
+		/* Size in bytes for single sector */
+		case GET_SECTOR_SIZE:
+			*(WORD *)buff = FATFS_SPIRAM_SECTOR_SIZE;
+			break;
+			
+		case GET_BLOCK_SIZE:	/* Get erase block size in unit of sector (DWORD) */
+			/* Memory has no erase blocks */
+			*(DWORD *)buff = 1;
+			break;
+			
+		case CTRL_SYNC:			/* Write cached data to memory */
+			if (TM_SPIRAM_Flush() != TM_SPIRAM_Result_Ok) {
+				res = RES_ERROR;
+			}
+			break;
+		case CTRL_ERASE_SECTOR:
+			break;
+		default:
+			res = RES_PARERR;
+			break;
+	}
+	
+	/* Return result */
+	return res;
+}
+
+DRESULT TM_FATFS_SPIRAM_disk_read(BYTE *buff, DWORD sector, UINT count) {
+	/* If not initialized */
+	if (SPIRAM_Status & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+	
+	/* Check range */
+	if (sector >= FATFS_SPIRAM_SIZE / FATFS_SPIRAM_SECTOR_SIZE || count > FATFS_SPIRAM_SIZE / FATFS_SPIRAM_SECTOR_SIZE - sector) {
+		return RES_PARERR;
+	}
+	
+	/* Read data from memory, long transfer is done with DMA */
+	if (TM_SPIRAM_Read(FATFS_SPIRAM_START + sector * FATFS_SPIRAM_SECTOR_SIZE, buff, count * FATFS_SPIRAM_SECTOR_SIZE) != TM_SPIRAM_Result_Ok) {
+		return RES_ERROR;
+	}
+	
+	/* Return OK */
+	return RES_OK;
+}
+
+DRESULT TM_FATFS_SPIRAM_disk_write(const BYTE *buff, DWORD sector, UINT count) {
+	/* If not initialized */
+	if (SPIRAM_Status & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+	
+	/* Check range */
+	if (sector >= FATFS_SPIRAM_SIZE / FATFS_SPIRAM_SECTOR_SIZE || count > FATFS_SPIRAM_SIZE / FATFS_SPIRAM_SECTOR_SIZE - sector) {
+		return RES_PARERR;
+	}
+	
+	/* Write data to memory */
+	if (TM_SPIRAM_Write(FATFS_SPIRAM_START + sector * FATFS_SPIRAM_SECTOR_SIZE, buff, count * FATFS_SPIRAM_SECTOR_SIZE) != TM_SPIRAM_Result_Ok) {
+		return RES_ERROR;
+	}
+
+	/* Return OK */
+	return RES_OK;
+}
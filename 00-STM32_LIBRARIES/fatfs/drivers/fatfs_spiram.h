@@ -0,0 +1,157 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license GNU GPL v3
+ * @brief   SPI PSRAM and FRAM low level implementation for FATFS
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Tilen Majerle, 2016
+    
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+     
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_FATFS_SPIRAM_H
+#define TM_FATFS_SPIRAM_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern C {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_FATFS_SPIRAM
+ * @brief    SPI PSRAM and FRAM low level implementation for FATFS
+ * @{
+ *
+ * Driver uses @ref TM_SPIRAM library for disk in external SPI memory, SPIRAM: drive name is used for mounting.
+ * PSRAM disk is lost on power down like SDRAM disk, FRAM disk keeps data.
+ *
+ * Disk can use only part of memory, set with FATFS_SPIRAM_START and FATFS_SPIRAM_SIZE,
+ * other part is free for buffers with @ref TM_SPIRAM_Read and @ref TM_SPIRAM_Write.
+ * Memory settings (SPI, CS pin, memory type and size) are in @ref TM_SPIRAM library.
+ *
+\code
+//Enable SPI RAM disk
+#define FATFS_USE_SPIRAM             1
+
+//Use first 4 MB of 8 MB PSRAM for disk
+#define FATFS_SPIRAM_START           0
+#define FATFS_SPIRAM_SIZE            0x400000
+\endcode
+ *
+ * Example usage:
+ *
+\code
+FATFS fs;
+
+//Create file system first time, with PSRAM always after power up
+if (f_mount(&fs, "SPIRAM:", 1) == FR_NO_FILESYSTEM) {
+	f_mkfs("SPIRAM:", 1, 0);
+	f_mount(&fs, "SPIRAM:", 1);
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - diskio.h
+ - TM SPIRAM
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "diskio.h"
+#include "tm_stm32_spiram.h"
+
+/**
+ * @defgroup TM_FATFS_SPIRAM_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Sector size on memory */
+#ifndef FATFS_SPIRAM_SECTOR_SIZE
+#define FATFS_SPIRAM_SECTOR_SIZE     512
+#endif
+
+/* Start of disk in memory in units of bytes */
+#ifndef FATFS_SPIRAM_START
+#define FATFS_SPIRAM_START           0
+#endif
+
+/* Disk size in units of bytes, rest of memory by default */
+#ifndef FATFS_SPIRAM_SIZE
+#define FATFS_SPIRAM_SIZE            (SPIRAM_MEMORY_SIZE - FATFS_SPIRAM_START)
+#endif
+
+#if FATFS_SPIRAM_START + FATFS_SPIRAM_SIZE > SPIRAM_MEMORY_SIZE
+#error "FATFS_SPIRAM_START and FATFS_SPIRAM_SIZE are outside SPIRAM_MEMORY_SIZE!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_FATFS_SPIRAM_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+DSTATUS TM_FATFS_SPIRAM_disk_initialize(void);
+DSTATUS TM_FATFS_SPIRAM_disk_status(void);
+DRESULT TM_FATFS_SPIRAM_disk_ioctl(BYTE cmd, void *buff);
+DRESULT TM_FATFS_SPIRAM_disk_read(BYTE *buff, DWORD sector, UINT count);
+DRESULT TM_FATFS_SPIRAM_disk_write(const BYTE *buff, DWORD sector, UINT count);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -30,6 +30,82 @@ static DSTATUS TM_FATFS_USB_disk_status_lowlevel(USBH_HandleTypeDef* USBHandle);
 static DRESULT TM_FATFS_USB_disk_read_lowlevel( BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle);
 static DRESULT TM_FATFS_USB_disk_write_lowlevel(const BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle);
 static DRESULT TM_FATFS_USB_disk_ioctl_lowlevel (BYTE cmd, void *buff, USBH_HandleTypeDef* USBHandle);
+static DRESULT TM_FATFS_USB_disk_read_transfer(BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle);
+static DRESULT TM_FATFS_USB_disk_write_transfer(const BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle);
+static USBH_StatusTypeDef TM_FATFS_USB_Transfer(BYTE *buff, DWORD sector, UINT count, uint8_t write, USBH_HandleTypeDef* USBHandle);
+static DRESULT TM_FATFS_USB_GetWriteError(USBH_HandleTypeDef* USBHandle);
+#endif
+
+#if (defined(USB_USE_FS) || defined(USB_USE_HS)) && FATFS_USB_CACHE_SECTORS > 0
+/* Sector cache for one USB port */
+typedef struct {
+	uint8_t* Buffer;   /*!< Cache memory for FATFS_USB_CACHE_SECTORS sectors */
+	DWORD Start;       /*!< First sector number in cache */
+	UINT Count;        /*!< Number of valid sectors from start */
+	UINT DirtyStart;   /*!< First modified sector, relative to start */
+	UINT DirtyCount;   /*!< Number of modified sectors, they are always contiguous */
+} FATFS_USB_Cache_t;
+
+#ifdef USB_USE_FS
+#ifdef FATFS_USB_CACHE_FS_ADDR
+static FATFS_USB_Cache_t FATFS_USB_Cache_FS = {(uint8_t *)(FATFS_USB_CACHE_FS_ADDR)};
+#else
+static uint32_t FATFS_USB_CacheData_FS[FATFS_USB_CACHE_SECTORS * _MAX_SS / 4];
+static FATFS_USB_Cache_t FATFS_USB_Cache_FS = {(uint8_t *)FATFS_USB_CacheData_FS};
+#endif
+#endif
+#ifdef USB_USE_HS
+#ifdef FATFS_USB_CACHE_HS_ADDR
+static FATFS_USB_Cache_t FATFS_USB_Cache_HS = {(uint8_t *)(FATFS_USB_CACHE_HS_ADDR)};
+#else
+static uint32_t FATFS_USB_CacheData_HS[FATFS_USB_CACHE_SECTORS * _MAX_SS / 4];
+static FATFS_USB_Cache_t FATFS_USB_Cache_HS = {(uint8_t *)FATFS_USB_CacheData_HS};
+#endif
+#endif
+
+static FATFS_USB_Cache_t* TM_FATFS_USB_GetCache(USBH_HandleTypeDef* USBHandle);
+static void TM_FATFS_USB_CacheInvalidate(USBH_HandleTypeDef* USBHandle);
+static DRESULT TM_FATFS_USB_CacheFlush(USBH_HandleTypeDef* USBHandle);
+static uint8_t TM_FATFS_USB_CacheOverlaps(FATFS_USB_Cache_t* Cache, DWORD sector, UINT count);
+#endif
+
+#if (defined(USB_USE_FS) || defined(USB_USE_HS)) && FATFS_USB_QUEUE_LENGTH > 0 && _USE_WRITE
+#define FATFS_USB_QUEUE                  1
+
+/* Queued write request */
+typedef struct {
+	const BYTE* Buffer; /*!< Data to write, must be valid until request is done */
+	DWORD Sector;       /*!< First sector */
+	UINT Count;         /*!< Number of sectors */
+} FATFS_USB_Request_t;
+
+/* Write queue for one USB port */
+typedef struct {
+	FATFS_USB_Request_t Request[FATFS_USB_QUEUE_LENGTH];
+	uint8_t Head;       /*!< Oldest request, it is in transfer when Active is set */
+	uint8_t Count;      /*!< Number of requests in queue */
+	uint8_t Active;     /*!< Head request is in transfer */
+	DRESULT Result;     /*!< First error of queued writes, returned on next access */
+} FATFS_USB_Queue_t;
+
+#ifdef USB_USE_FS
+static FATFS_USB_Queue_t FATFS_USB_Queue_FS;
+#endif
+#ifdef USB_USE_HS
+static FATFS_USB_Queue_t FATFS_USB_Queue_HS;
+#endif
+
+/* Memory which is written in background */
+static const BYTE* FATFS_USB_AsyncBuffer;
+static uint32_t FATFS_USB_AsyncSize;
+
+static FATFS_USB_Queue_t* TM_FATFS_USB_GetQueue(USBH_HandleTypeDef* USBHandle);
+static void TM_FATFS_USB_QueueProcess(USBH_HandleTypeDef* USBHandle);
+static void TM_FATFS_USB_QueueProcessOthers(USBH_HandleTypeDef* USBHandle);
+static DRESULT TM_FATFS_USB_QueueWait(USBH_HandleTypeDef* USBHandle);
+static DRESULT TM_FATFS_USB_QueueAdd(const BYTE* buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle);
+#else
+#define FATFS_USB_QUEUE                  0
 #endif
 
 /*-----------------------------------------------------------------------*/
@@ -112,29 +188,199 @@ DRESULT TM_FATFS_USBHS_disk_ioctl (BYTE cmd, void *buff) {
 /********************************************************************/
 #if defined(USB_USE_FS) || defined(USB_USE_HS)
 static DSTATUS TM_FATFS_USB_disk_initialize_lowlevel(USBH_HandleTypeDef* USBHandle) {
+#if FATFS_USB_CACHE_SECTORS > 0
+	/* New device, cached data are not valid */
+	TM_FATFS_USB_CacheInvalidate(USBHandle);
+#endif
+#if FATFS_USB_QUEUE
+	/* Queued writes belong to old device */
+	memset(TM_FATFS_USB_GetQueue(USBHandle), 0, sizeof(FATFS_USB_Queue_t));
+#endif
 	return RES_OK;
 }
 
 static DSTATUS TM_FATFS_USB_disk_status_lowlevel(USBH_HandleTypeDef* USBHandle) {
 	MSC_HandleTypeDef *MSC_Handle;
 	
+	/* Check active class */
+	if (USBHandle->pActiveClass == USBH_MSC_CLASS) {
+		/* Create MSC handle */
+		MSC_Handle = (MSC_HandleTypeDef *) USBHandle->pActiveClass->pData;
+		
+		/* Check if MSC is ready */
+		if (USBH_MSC_UnitIsReady(USBHandle, MSC_Handle->current_lun)) {
+			return RES_OK;
+		}
+	}
+	
+#if FATFS_USB_CACHE_SECTORS > 0
+	/* Device was removed, drop cached data */
+	TM_FATFS_USB_CacheInvalidate(USBHandle);
+#endif
+
+	return RES_ERROR;
+}
+
+static DRESULT TM_FATFS_USB_disk_read_lowlevel(BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
+#if FATFS_USB_CACHE_SECTORS > 0
+	FATFS_USB_Cache_t* Cache = TM_FATFS_USB_GetCache(USBHandle);
+	MSC_LUNTypeDef info;
+	DRESULT res;
+	UINT num;
+	
 	/* Check active class */
 	if (USBHandle->pActiveClass != USBH_MSC_CLASS) {
 		return RES_ERROR;
 	}
 	
-	/* Create MSC handle */
-	MSC_Handle = (MSC_HandleTypeDef *) USBHandle->pActiveClass->pData;
+	/* Large requests are already efficient, transfer directly */
+	if (count >= FATFS_USB_CACHE_SECTORS) {
+		/* Device must have modified data first */
+		if (TM_FATFS_USB_CacheOverlaps(Cache, sector, count) && (res = TM_FATFS_USB_CacheFlush(USBHandle)) != RES_OK) {
+			return res;
+		}
+		return TM_FATFS_USB_disk_read_transfer(buff, sector, count, USBHandle);
+	}
 	
-	/* Check if MSC is ready */
-	if (USBH_MSC_UnitIsReady(USBHandle, MSC_Handle->current_lun)) {
-		return RES_OK;
+	while (count) {
+		/* Sector is not in cache, read ahead full cache */
+		if (sector < Cache->Start || sector >= Cache->Start + Cache->Count) {
+			/* Write modified data before cache is reused */
+			if ((res = TM_FATFS_USB_CacheFlush(USBHandle)) != RES_OK) {
+				return res;
+			}
+			
+			/* Do not read after last sector on device */
+			num = FATFS_USB_CACHE_SECTORS;
+			if (
+				USBH_MSC_GetLUNInfo(USBHandle, ((MSC_HandleTypeDef *) USBHandle->pActiveClass->pData)->current_lun, &info) == USBH_OK &&
+				sector < info.capacity.block_nbr && (sector + num) > info.capacity.block_nbr
+			) {
+				num = info.capacity.block_nbr - sector;
+			}
+			
+			/* Read to cache */
+			Cache->Count = 0;
+			if ((res = TM_FATFS_USB_disk_read_transfer(Cache->Buffer, sector, num, USBHandle)) != RES_OK) {
+				return res;
+			}
+			Cache->Start = sector;
+			Cache->Count = num;
+		}
+		
+		/* Copy all requested sectors available in cache */
+		num = Cache->Start + Cache->Count - sector;
+		if (num > count) {
+			num = count;
+		}
+		memcpy(buff, &Cache->Buffer[(sector - Cache->Start) * _MAX_SS], num * _MAX_SS);
+		
+		buff += num * _MAX_SS;
+		sector += num;
+		count -= num;
 	}
+	
+	return RES_OK;
+#else
+	return TM_FATFS_USB_disk_read_transfer(buff, sector, count, USBHandle);
+#endif
+}
 
-	return RES_ERROR;
+#if _USE_WRITE
+static DRESULT TM_FATFS_USB_disk_write_lowlevel(const BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
+#if FATFS_USB_CACHE_SECTORS > 0
+	FATFS_USB_Cache_t* Cache = TM_FATFS_USB_GetCache(USBHandle);
+	DRESULT res;
+	UINT idx, num, end;
+#endif
+	
+#if FATFS_USB_QUEUE
+	/* Data from asynchronous buffer are written in background */
+	if (
+		FATFS_USB_AsyncSize && ((DWORD)buff & 3) == 0 &&
+		buff >= FATFS_USB_AsyncBuffer && (buff + count * _MAX_SS) <= (FATFS_USB_AsyncBuffer + FATFS_USB_AsyncSize)
+	) {
+		return TM_FATFS_USB_QueueAdd(buff, sector, count, USBHandle);
+	}
+#endif
+	
+#if FATFS_USB_CACHE_SECTORS > 0
+	/* Check active class */
+	if (USBHandle->pActiveClass != USBH_MSC_CLASS) {
+		return RES_ERROR;
+	}
+	
+	/* Large requests are already efficient, transfer directly */
+	if (count >= FATFS_USB_CACHE_SECTORS) {
+		/* Cached data for these sectors are not valid anymore */
+		if (TM_FATFS_USB_CacheOverlaps(Cache, sector, count)) {
+			res = TM_FATFS_USB_CacheFlush(USBHandle);
+			Cache->Count = 0;
+			if (res != RES_OK) {
+				return res;
+			}
+		}
+		return TM_FATFS_USB_disk_write_transfer(buff, sector, count, USBHandle);
+	}
+	
+	while (count) {
+		/* Sector must be inside cache or right after valid sectors */
+		if (sector < Cache->Start || sector > Cache->Start + Cache->Count || (sector - Cache->Start) >= FATFS_USB_CACHE_SECTORS) {
+			if ((res = TM_FATFS_USB_CacheFlush(USBHandle)) != RES_OK) {
+				return res;
+			}
+			Cache->Start = sector;
+			Cache->Count = 0;
+		}
+		
+		/* Number of sectors to cache */
+		idx = sector - Cache->Start;
+		num = FATFS_USB_CACHE_SECTORS - idx;
+		if (num > count) {
+			num = count;
+		}
+		
+		/* Modified range must stay contiguous for one transfer */
+		if (Cache->DirtyCount && (idx > Cache->DirtyStart + Cache->DirtyCount || idx + num < Cache->DirtyStart)) {
+			if ((res = TM_FATFS_USB_CacheFlush(USBHandle)) != RES_OK) {
+				return res;
+			}
+		}
+		
+		/* Copy to cache */
+		memcpy(&Cache->Buffer[idx * _MAX_SS], buff, num * _MAX_SS);
+		
+		/* Update valid and modified ranges */
+		if (idx + num > Cache->Count) {
+			Cache->Count = idx + num;
+		}
+		if (Cache->DirtyCount) {
+			end = Cache->DirtyStart + Cache->DirtyCount;
+			if (idx + num > end) {
+				end = idx + num;
+			}
+			if (idx < Cache->DirtyStart) {
+				Cache->DirtyStart = idx;
+			}
+			Cache->DirtyCount = end - Cache->DirtyStart;
+		} else {
+			Cache->DirtyStart = idx;
+			Cache->DirtyCount = num;
+		}
+		
+		buff += num * _MAX_SS;
+		sector += num;
+		count -= num;
+	}
+	
+	return RES_OK;
+#else
+	return TM_FATFS_USB_disk_write_transfer(buff, sector, count, USBHandle);
+#endif
 }
+#endif
 
-static DRESULT TM_FATFS_USB_disk_read_lowlevel(BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
+static DRESULT TM_FATFS_USB_disk_read_transfer(BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
 	DRESULT res = RES_ERROR;
 	MSC_LUNTypeDef info;
 	USBH_StatusTypeDef  status = USBH_OK;
@@ -148,11 +394,18 @@ static DRESULT TM_FATFS_USB_disk_read_lowlevel(BYTE *buff, DWORD sector, UINT co
 
 	/* Create MSC handle */
 	MSC_Handle = (MSC_HandleTypeDef *) USBHandle->pActiveClass->pData;
+	
+#if FATFS_USB_QUEUE
+	/* Queued writes must be done first */
+	if ((res = TM_FATFS_USB_QueueWait(USBHandle)) != RES_OK) {
+		return res;
+	}
+#endif
 
 	/* DMA Alignment issue, do single up to aligned buffer */
 	if ((DWORD)buff & 3) { 
 		while ((count--) && (status == USBH_OK)) {
-			status = USBH_MSC_Read(USBHandle, MSC_Handle->current_lun, sector + count, (uint8_t *)scratch, 1);
+			status = TM_FATFS_USB_Transfer((BYTE *)scratch, sector + count, 1, 0, USBHandle);
 			if (status == USBH_OK) {
 				memcpy(&buff[count * _MAX_SS], scratch, _MAX_SS);
 			} else {
@@ -160,7 +413,7 @@ static DRESULT TM_FATFS_USB_disk_read_lowlevel(BYTE *buff, DWORD sector, UINT co
 			}
 		}
 	} else {
-		status = USBH_MSC_Read(USBHandle, MSC_Handle->current_lun, sector, buff, count);
+		status = TM_FATFS_USB_Transfer(buff, sector, count, 0, USBHandle);
 	}
 
 	if (status == USBH_OK) {
@@ -186,63 +439,111 @@ static DRESULT TM_FATFS_USB_disk_read_lowlevel(BYTE *buff, DWORD sector, UINT co
 }
 
 #if _USE_WRITE
-static DRESULT TM_FATFS_USB_disk_write_lowlevel(const BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
-	DRESULT res = RES_ERROR; 
-	MSC_LUNTypeDef info;
+static DRESULT TM_FATFS_USB_disk_write_transfer(const BYTE *buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
 	USBH_StatusTypeDef  status = USBH_OK;  
 	DWORD scratch [_MAX_SS / 4];
-	MSC_HandleTypeDef *MSC_Handle;
+#if FATFS_USB_QUEUE
+	DRESULT res;
+#endif
 	
 	/* Check active class */
 	if (USBHandle->pActiveClass != USBH_MSC_CLASS) {
 		return RES_ERROR;
 	}
-
-	/* Create MSC handle */
-	MSC_Handle = (MSC_HandleTypeDef *) USBHandle->pActiveClass->pData;
+	
+#if FATFS_USB_QUEUE
+	/* Queued writes must be done first */
+	if ((res = TM_FATFS_USB_QueueWait(USBHandle)) != RES_OK) {
+		return res;
+	}
+#endif
 
 	/* DMA Alignment issue, do single up to aligned buffer */
 	if ((DWORD)buff & 3) {
 		while (count--) {
 			memcpy(scratch, &buff[count * _MAX_SS], _MAX_SS);
 
-			status = USBH_MSC_Write(USBHandle, MSC_Handle->current_lun, sector + count, (BYTE *)scratch, 1);
+			status = TM_FATFS_USB_Transfer((BYTE *)scratch, sector + count, 1, 1, USBHandle);
 			if (status == USBH_FAIL) {
 				break;
 			}
 		}
 	} else {
-		status = USBH_MSC_Write(USBHandle, MSC_Handle->current_lun, sector, (BYTE *)buff, count);
+		status = TM_FATFS_USB_Transfer((BYTE *)buff, sector, count, 1, USBHandle);
 	}
 
 	if (status == USBH_OK) {
-		res = RES_OK;
-	} else {
-		USBH_MSC_GetLUNInfo(USBHandle, MSC_Handle->current_lun, &info); 
+		return RES_OK;
+	}
+	return TM_FATFS_USB_GetWriteError(USBHandle);
+}
 
-		switch (info.sense.asc) {
-			case SCSI_ASC_WRITE_PROTECTED:
-				USBH_ErrLog("USB Disk is Write protected!");
-				res = RES_WRPRT;
-				break;
+static DRESULT TM_FATFS_USB_GetWriteError(USBH_HandleTypeDef* USBHandle) {
+	DRESULT res;
+	MSC_LUNTypeDef info;
+	MSC_HandleTypeDef *MSC_Handle;
+	
+	/* Device was removed */
+	if (USBHandle->pActiveClass != USBH_MSC_CLASS) {
+		return RES_NOTRDY;
+	}
 
-			case SCSI_ASC_LOGICAL_UNIT_NOT_READY:
-			case SCSI_ASC_MEDIUM_NOT_PRESENT:
-			case SCSI_ASC_NOT_READY_TO_READY_CHANGE:
-				USBH_ErrLog("USB Disk is not ready!");      
-				res = RES_NOTRDY;
-				break; 
+	/* Create MSC handle */
+	MSC_Handle = (MSC_HandleTypeDef *) USBHandle->pActiveClass->pData;
+	
+	USBH_MSC_GetLUNInfo(USBHandle, MSC_Handle->current_lun, &info); 
 
-			default:
-				res = RES_ERROR;
-				break;
-		}
+	switch (info.sense.asc) {
+		case SCSI_ASC_WRITE_PROTECTED:
+			USBH_ErrLog("USB Disk is Write protected!");
+			res = RES_WRPRT;
+			break;
+
+		case SCSI_ASC_LOGICAL_UNIT_NOT_READY:
+		case SCSI_ASC_MEDIUM_NOT_PRESENT:
+		case SCSI_ASC_NOT_READY_TO_READY_CHANGE:
+			USBH_ErrLog("USB Disk is not ready!");      
+			res = RES_NOTRDY;
+			break; 
+
+		default:
+			res = RES_ERROR;
+			break;
 	}
 
 	return res;   
 }
 #endif
 
+static USBH_StatusTypeDef TM_FATFS_USB_Transfer(BYTE *buff, DWORD sector, UINT count, uint8_t write, USBH_HandleTypeDef* USBHandle) {
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) USBHandle->pActiveClass->pData;
+#if FATFS_USB_QUEUE
+	USBH_StatusTypeDef status;
+	
+	/* Start transfer */
+	if (write) {
+		status = USBH_MSC_WriteStart(USBHandle, MSC_Handle->current_lun, sector, buff, count);
+	} else {
+		status = USBH_MSC_ReadStart(USBHandle, MSC_Handle->current_lun, sector, buff, count);
+	}
+	if (status != USBH_OK) {
+		return status;
+	}
+	
+	/* Queued writes on other port run at the same time */
+	while ((status = USBH_MSC_RdWrPoll(USBHandle)) == USBH_BUSY) {
+		TM_FATFS_USB_QueueProcessOthers(USBHandle);
+	}
+	return status;
+#else
+	/* Blocking transfer */
+	if (write) {
+		return USBH_MSC_Write(USBHandle, MSC_Handle->current_lun, sector, buff, count);
+	}
+	return USBH_MSC_Read(USBHandle, MSC_Handle->current_lun, sector, buff, count);
+#endif
+}
+
 static DRESULT TM_FATFS_USB_disk_ioctl_lowlevel (BYTE cmd, void *buff, USBH_HandleTypeDef* USBHandle) {
 	DRESULT res = RES_OK;
 	MSC_LUNTypeDef info;
@@ -259,7 +560,17 @@ static DRESULT TM_FATFS_USB_disk_ioctl_lowlevel (BYTE cmd, void *buff, USBH_Hand
 	switch (cmd) {
 		/* Make sure that no pending write process */  
 		case CTRL_SYNC:		
+#if FATFS_USB_QUEUE
+			res = TM_FATFS_USB_QueueWait(USBHandle);
+			if (res != RES_OK) {
+				break;
+			}
+#endif
+#if FATFS_USB_CACHE_SECTORS > 0
+			res = TM_FATFS_USB_CacheFlush(USBHandle);
+#else
 			res = RES_OK;
+#endif
 			break;
 
 		/* Get number of sectors on the disk (DWORD) */ 
@@ -299,3 +610,280 @@ static DRESULT TM_FATFS_USB_disk_ioctl_lowlevel (BYTE cmd, void *buff, USBH_Hand
 	return res;
 }
 #endif
+
+#if (defined(USB_USE_FS) || defined(USB_USE_HS)) && FATFS_USB_CACHE_SECTORS > 0
+static FATFS_USB_Cache_t* TM_FATFS_USB_GetCache(USBH_HandleTypeDef* USBHandle) {
+#ifdef USB_USE_HS
+	if (USBHandle == &hUSBHost_HS) {
+		return &FATFS_USB_Cache_HS;
+	}
+#endif
+#ifdef USB_USE_FS
+	return &FATFS_USB_Cache_FS;
+#else
+	return &FATFS_USB_Cache_HS;
+#endif
+}
+
+static void TM_FATFS_USB_CacheInvalidate(USBH_HandleTypeDef* USBHandle) {
+	FATFS_USB_Cache_t* Cache = TM_FATFS_USB_GetCache(USBHandle);
+	
+	Cache->Count = 0;
+	Cache->DirtyCount = 0;
+}
+
+static DRESULT TM_FATFS_USB_CacheFlush(USBH_HandleTypeDef* USBHandle) {
+#if _USE_WRITE
+	FATFS_USB_Cache_t* Cache = TM_FATFS_USB_GetCache(USBHandle);
+	DRESULT res;
+	
+	/* Write all modified sectors with one transfer */
+	if (Cache->DirtyCount) {
+		res = TM_FATFS_USB_disk_write_transfer(&Cache->Buffer[Cache->DirtyStart * _MAX_SS], Cache->Start + Cache->DirtyStart, Cache->DirtyCount, USBHandle);
+		Cache->DirtyCount = 0;
+		
+		/* Drop cache on error, device state is unknown */
+		if (res != RES_OK) {
+			Cache->Count = 0;
+		}
+		return res;
+	}
+#endif
+	return RES_OK;
+}
+
+static uint8_t TM_FATFS_USB_CacheOverlaps(FATFS_USB_Cache_t* Cache, DWORD sector, UINT count) {
+	return Cache->Count && sector < Cache->Start + Cache->Count && sector + count > Cache->Start;
+}
+#endif
+
+#if FATFS_USB_QUEUE
+void TM_FATFS_USB_SetAsyncBuffer(const void* Buffer, uint32_t Size) {
+	/* Set memory which is written in background */
+	FATFS_USB_AsyncBuffer = (const BYTE *)Buffer;
+	FATFS_USB_AsyncSize = Buffer != NULL ? Size : 0;
+}
+
+uint8_t TM_FATFS_USB_Process(void) {
+	uint8_t count = 0;
+	
+	/* Process queues on all ports */
+#ifdef USB_USE_FS
+	TM_FATFS_USB_QueueProcess(&hUSBHost_FS);
+	count += FATFS_USB_Queue_FS.Count;
+#endif
+#ifdef USB_USE_HS
+	TM_FATFS_USB_QueueProcess(&hUSBHost_HS);
+	count += FATFS_USB_Queue_HS.Count;
+#endif
+	
+	/* Return number of pending requests */
+	return count;
+}
+
+uint8_t TM_FATFS_USB_IsPending(const void* Buffer, uint32_t Size) {
+	FATFS_USB_Queue_t* Queue;
+	FATFS_USB_Request_t* Request;
+	const BYTE* start = (const BYTE *)Buffer;
+	uint8_t port, i;
+	
+	/* Check requests on all ports */
+	for (port = 0; port < 2; port++) {
+		Queue = NULL;
+#ifdef USB_USE_FS
+		if (port == 0) {
+			Queue = &FATFS_USB_Queue_FS;
+		}
+#endif
+#ifdef USB_USE_HS
+		if (port == 1) {
+			Queue = &FATFS_USB_Queue_HS;
+		}
+#endif
+		if (Queue == NULL) {
+			continue;
+		}
+		
+		for (i = 0; i < Queue->Count; i++) {
+			Request = &Queue->Request[(Queue->Head + i) % FATFS_USB_QUEUE_LENGTH];
+			if (Request->Buffer < (start + Size) && (Request->Buffer + Request->Count * _MAX_SS) > start) {
+				return 1;
+			}
+		}
+	}
+	
+	/* Memory is not used */
+	return 0;
+}
+
+static FATFS_USB_Queue_t* TM_FATFS_USB_GetQueue(USBH_HandleTypeDef* USBHandle) {
+#ifdef USB_USE_HS
+	if (USBHandle == &hUSBHost_HS) {
+		return &FATFS_USB_Queue_HS;
+	}
+#endif
+#ifdef USB_USE_FS
+	return &FATFS_USB_Queue_FS;
+#else
+	return &FATFS_USB_Queue_HS;
+#endif
+}
+
+static void TM_FATFS_USB_QueueProcess(USBH_HandleTypeDef* USBHandle) {
+	FATFS_USB_Queue_t* Queue = TM_FATFS_USB_GetQueue(USBHandle);
+	FATFS_USB_Request_t* Request;
+	USBH_StatusTypeDef status = USBH_OK;
+	
+	/* Nothing to do */
+	if (!Queue->Count) {
+		return;
+	}
+	
+	/* Device was removed, drop all requests */
+	if (USBHandle->pActiveClass != USBH_MSC_CLASS || !USBHandle->device.is_connected) {
+		Queue->Count = 0;
+		Queue->Active = 0;
+		if (Queue->Result == RES_OK) {
+			Queue->Result = RES_NOTRDY;
+		}
+		return;
+	}
+	
+	/* Start oldest request */
+	if (!Queue->Active) {
+		Request = &Queue->Request[Queue->Head];
+		status = USBH_MSC_WriteStart(USBHandle, ((MSC_HandleTypeDef *) USBHandle->pActiveClass->pData)->current_lun, Request->Sector, (uint8_t *)Request->Buffer, Request->Count);
+		if (status == USBH_OK) {
+			Queue->Active = 1;
+		}
+	}
+	
+	/* Check transfer */
+	if (Queue->Active) {
+		status = USBH_MSC_RdWrPoll(USBHandle);
+		if (status == USBH_BUSY) {
+			return;
+		}
+		Queue->Active = 0;
+	}
+	
+	if (status == USBH_OK) {
+		/* Request is done */
+		Queue->Head = (Queue->Head + 1) % FATFS_USB_QUEUE_LENGTH;
+		Queue->Count--;
+	} else {
+		/* Device state is unknown, drop all requests */
+		Queue->Count = 0;
+		if (Queue->Result == RES_OK) {
+			Queue->Result = TM_FATFS_USB_GetWriteError(USBHandle);
+		}
+	}
+}
+
+static void TM_FATFS_USB_QueueProcessOthers(USBH_HandleTypeDef* USBHandle) {
+#ifdef USB_USE_FS
+	if (USBHandle != &hUSBHost_FS) {
+		TM_FATFS_USB_QueueProcess(&hUSBHost_FS);
+	}
+#endif
+#ifdef USB_USE_HS
+	if (USBHandle != &hUSBHost_HS) {
+		TM_FATFS_USB_QueueProcess(&hUSBHost_HS);
+	}
+#endif
+}
+
+static DRESULT TM_FATFS_USB_QueueWait(USBH_HandleTypeDef* USBHandle) {
+	FATFS_USB_Queue_t* Queue = TM_FATFS_USB_GetQueue(USBHandle);
+	DRESULT res;
+	
+	/* Wait for all requests, other ports keep working */
+	while (Queue->Count) {
+		TM_FATFS_USB_QueueProcess(USBHandle);
+		TM_FATFS_USB_QueueProcessOthers(USBHandle);
+	}
+	
+	/* Return and clear error of queued writes */
+	res = Queue->Result;
+	Queue->Result = RES_OK;
+	return res;
+}
+
+static DRESULT TM_FATFS_USB_QueueAdd(const BYTE* buff, DWORD sector, UINT count, USBH_HandleTypeDef* USBHandle) {
+	FATFS_USB_Queue_t* Queue = TM_FATFS_USB_GetQueue(USBHandle);
+	FATFS_USB_Request_t* Request;
+	DRESULT res;
+#if FATFS_USB_CACHE_SECTORS > 0
+	FATFS_USB_Cache_t* Cache = TM_FATFS_USB_GetCache(USBHandle);
+#endif
+	
+	/* Check active class */
+	if (USBHandle->pActiveClass != USBH_MSC_CLASS) {
+		return RES_ERROR;
+	}
+	
+#if FATFS_USB_CACHE_SECTORS > 0
+	/* Cached data for these sectors are not valid anymore */
+	if (TM_FATFS_USB_CacheOverlaps(Cache, sector, count)) {
+		res = TM_FATFS_USB_CacheFlush(USBHandle);
+		Cache->Count = 0;
+		if (res != RES_OK) {
+			return res;
+		}
+	}
+#endif
+	
+	/* Last request is not started yet, extend it when data follow */
+	if (Queue->Count > Queue->Active) {
+		Request = &Queue->Request[(Queue->Head + Queue->Count - 1) % FATFS_USB_QUEUE_LENGTH];
+		if (
+			(Request->Sector + Request->Count) == sector &&
+			(Request->Buffer + Request->Count * _MAX_SS) == buff &&
+			(Request->Count + count) <= 0xFFFF
+		) {
+			Request->Count += count;
+			return RES_OK;
+		}
+	}
+	
+	/* Wait for free request */
+	while (Queue->Count >= FATFS_USB_QUEUE_LENGTH) {
+		TM_FATFS_USB_QueueProcess(USBHandle);
+		TM_FATFS_USB_QueueProcessOthers(USBHandle);
+	}
+	
+	/* Report error of previous writes */
+	if (Queue->Result != RES_OK) {
+		res = Queue->Result;
+		Queue->Result = RES_OK;
+		return res;
+	}
+	
+	/* Add request */
+	Request = &Queue->Request[(Queue->Head + Queue->Count) % FATFS_USB_QUEUE_LENGTH];
+	Request->Buffer = buff;
+	Request->Sector = sector;
+	Request->Count = count;
+	Queue->Count++;
+	
+	/* Start it when port is free */
+	TM_FATFS_USB_QueueProcess(USBHandle);
+	
+	/* Return OK */
+	return RES_OK;
+}
+#else
+void TM_FATFS_USB_SetAsyncBuffer(const void* Buffer, uint32_t Size) {
+	/* Writes are always blocking */
+}
+
+uint8_t TM_FATFS_USB_Process(void) {
+	/* No pending requests */
+	return 0;
+}
+
+uint8_t TM_FATFS_USB_IsPending(const void* Buffer, uint32_t Size) {
+	/* Memory is not used */
+	return 0;
+}
+#endif
@@ -20,6 +20,22 @@
 #define FATFS_USB_TIMEOUT	50000
 #endif
 
+/* Number of sectors in read-ahead and write-behind cache for each USB port, 0 disables cache */
+#ifndef FATFS_USB_CACHE_SECTORS
+#define FATFS_USB_CACHE_SECTORS	16
+#endif
+
+/* Cache memory can be placed to external memory, eg. SDRAM, by defining start address for each port */
+/* #define FATFS_USB_CACHE_FS_ADDR	0xD0100000 */
+/* #define FATFS_USB_CACHE_HS_ADDR	0xD0110000 */
+
+/* Number of queued background writes for each USB port, 0 disables queue.
+   Only writes from memory set with TM_FATFS_USB_SetAsyncBuffer are queued,
+   other port keeps working while one port waits for its transfer */
+#ifndef FATFS_USB_QUEUE_LENGTH
+#define FATFS_USB_QUEUE_LENGTH	8
+#endif
+
 /*---------------------------------------*/
 /* Prototypes for disk control functions */
 extern DSTATUS TM_FATFS_USBFS_disk_initialize(void);
@@ -33,5 +49,15 @@ extern DRESULT TM_FATFS_USBHS_disk_read(BYTE* buff, DWORD sector, UINT count);
 extern DRESULT TM_FATFS_USBHS_disk_write(const BYTE* buff, DWORD sector, UINT count);
 extern DRESULT TM_FATFS_USBHS_disk_ioctl(BYTE cmd, void* buff);
 
+/*---------------------------------------*/
+/* Background writes                     */
+
+/* Sets memory which is written in background, data must not be changed until TM_FATFS_USB_IsPending returns 0. Use NULL to disable */
+extern void TM_FATFS_USB_SetAsyncBuffer(const void* Buffer, uint32_t Size);
+/* Processes queued writes on all ports, returns number of pending requests */
+extern uint8_t TM_FATFS_USB_Process(void);
+/* Returns 1 when queued write uses memory in range */
+extern uint8_t TM_FATFS_USB_IsPending(const void* Buffer, uint32_t Size);
+
 #endif
 
@@ -3897,14 +3897,14 @@ FRESULT f_lseek (
 		if (ofs == CREATE_LINKMAP) {	/* Create CLMT */
 			tbl = fp->cltbl;
 			tlen = *tbl++; ulen = 2;	/* Given table size and required table size */
-			cl = fp->sclust;			/* Top of the chain */
+			cl = fp->obj.sclust;		/* Top of the chain */
 			if (cl) {
 				do {
 					/* Get a fragment */
 					tcl = cl; ncl = 0; ulen += 2;	/* Top, length and used items */
 					do {
 						pcl = cl; ncl++;
-						cl = get_fat(fs, cl);
+						cl = get_fat(&fp->obj, cl);
 						if (cl <= 1) ABORT(fs, FR_INT_ERR);
 						if (cl == 0xFFFFFFFF) ABORT(fs, FR_DISK_ERR);
 					} while (cl == pcl + 1);
@@ -3920,8 +3920,8 @@ FRESULT f_lseek (
 				res = FR_NOT_ENOUGH_CORE;	/* Given table size is smaller than required */
 			}
 		} else {						/* Fast seek */
-			if (ofs > fp->fsize) {		/* Clip offset at the file size */
-				ofs = fp->fsize;
+			if (ofs > fp->obj.objsize) {	/* Clip offset at the file size */
+				ofs = fp->obj.objsize;
 			}
 			fp->fptr = ofs;				/* Set file pointer */
 			if (ofs) {
@@ -3934,7 +3934,7 @@ FRESULT f_lseek (
 #if !_FS_READONLY
 					if (fp->flag & _FA_DIRTY) {		/* Write-back dirty sector cache */
 						if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) {
-							ABORT(fp, FR_DISK_ERR);
+							ABORT(fs, FR_DISK_ERR);
 						}
 						fp->flag &= ~_FA_DIRTY;
 					}
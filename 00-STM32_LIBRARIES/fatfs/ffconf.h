@@ -4,6 +4,9 @@
 
 #define _FFCONF 88100	/* Revision ID */
 
+/* Some options can be overwritten in defines.h file */
+#include "defines.h"
+
 /*---------------------------------------------------------------------------/
 / Function Configurations
 /---------------------------------------------------------------------------*/
@@ -43,8 +46,11 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
+#ifndef _USE_FASTSEEK
 #define	_USE_FASTSEEK	0
-/* This option switches fast seek function. (0:Disable or 1:Enable) */
+#endif
+/* This option switches fast seek function. (0:Disable or 1:Enable)
+/  It can be enabled in defines.h file, see TM_FATFS_FastSeekEnable() */
 
 
 #define	_USE_EXPAND		1
@@ -153,7 +159,7 @@
 
 
 #define _STR_VOLUME_ID	1
-#define _VOLUME_STRS	"SD","USBFS","USBHS","SDRAM","SPIFLASH","RFU1","RFU2","USER1","USER2"
+#define _VOLUME_STRS	"SD","USBFS","USBHS","SDRAM","SPIFLASH","SPIRAM","RFU2","USER1","USER2"
 /* _STR_VOLUME_ID switches string support of volume ID.
 /  When _STR_VOLUME_ID is set to 1, also pre-defined strings can be used as drive
 /  number in the path name. _VOLUME_STRS defines the drive ID strings for each
@@ -242,9 +248,19 @@
 /      lock control is independent of re-entrancy. */
 
 
+/* Re-entrancy can be enabled in defines.h file, CMSIS-RTOS mutex is then used per volume */
+#ifndef _FS_REENTRANT
 #define _FS_REENTRANT	0
+#endif
+#ifndef _FS_TIMEOUT
 #define _FS_TIMEOUT		1000
+#endif
+#if _FS_REENTRANT
+#include "cmsis_os.h"
+#define	_SYNC_t			osMutexId
+#else
 #define	_SYNC_t			HANDLE
+#endif
 /* The option _FS_REENTRANT switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
@@ -23,10 +23,13 @@ int ff_cre_syncobj (	/* !=0:Function succeeded, ==0:Could not create due to any
 )
 {
 	int ret;
+	osMutexDef(FATFS_Mutex);
 
+	*sobj = osMutexCreate(osMutex(FATFS_Mutex));	/* CMSIS-RTOS */
+	ret = (int)(*sobj != NULL);
 
-	*sobj = CreateMutex(NULL, FALSE, NULL);		/* Win32 */
-	ret = (int)(*sobj != INVALID_HANDLE_VALUE);
+//	*sobj = CreateMutex(NULL, FALSE, NULL);		/* Win32 */
+//	ret = (int)(*sobj != INVALID_HANDLE_VALUE);
 
 //	*sobj = SyncObjects[vol];			/* uITRON (give a static created sync object) */
 //	ret = 1;							/* The initial value of the semaphore must be 1. */
@@ -57,7 +60,9 @@ int ff_del_syncobj (	/* !=0:Function succeeded, ==0:Could not delete due to any
 	int ret;
 
 
-	ret = CloseHandle(sobj);	/* Win32 */
+	ret = (int)(osMutexDelete(sobj) == osOK);	/* CMSIS-RTOS */
+
+//	ret = CloseHandle(sobj);	/* Win32 */
 
 //	ret = 1;					/* uITRON (nothing to do) */
 
@@ -85,7 +90,9 @@ int ff_req_grant (	/* 1:Got a grant to access the volume, 0:Could not get a gran
 {
 	int ret;
 
-	ret = (int)(WaitForSingleObject(sobj, _FS_TIMEOUT) == WAIT_OBJECT_0);	/* Win32 */
+	ret = (int)(osMutexWait(sobj, _FS_TIMEOUT) == osOK);	/* CMSIS-RTOS */
+
+//	ret = (int)(WaitForSingleObject(sobj, _FS_TIMEOUT) == WAIT_OBJECT_0);	/* Win32 */
 
 //	ret = (int)(wai_sem(sobj) == E_OK);			/* uITRON */
 
@@ -109,7 +116,9 @@ void ff_rel_grant (
 	_SYNC_t sobj	/* Sync object to be signaled */
 )
 {
-	ReleaseMutex(sobj);		/* Win32 */
+	osMutexRelease(sobj);	/* CMSIS-RTOS */
+
+//	ReleaseMutex(sobj);		/* Win32 */
 
 //	sig_sem(sobj);			/* uITRON */
 
@@ -31,7 +31,7 @@
 #define __LWIPOPTS_H__
 
 /* Include defines.h */
-#include "stm32f4xx.h"
+#include "stm32fxxx_hal.h"
 #include "defines.h"
 
 /**
@@ -39,13 +39,20 @@
  * critical regions during buffer allocation, deallocation and memory
  * allocation and deallocation.
  */
-#define SYS_LIGHTWEIGHT_PROT    0
-
 /**
  * NO_SYS==1: Provides VERY minimal functionality. Otherwise,
  * use lwIP facilities.
+ * Define NO_SYS to 0 in defines.h to use lwIP with FreeRTOS, see port/sys_arch.c
  */
+#ifndef NO_SYS
 #define NO_SYS                  1
+#endif
+
+#if NO_SYS
+#define SYS_LIGHTWEIGHT_PROT    0
+#else
+#define SYS_LIGHTWEIGHT_PROT    1
+#endif
 
 /**
  * NO_SYS_NO_TIMERS==1: Drop support for sys_timeout when NO_SYS==1
@@ -53,6 +60,24 @@
  */
 #define NO_SYS_NO_TIMERS        1
 
+#if !NO_SYS
+/* ---------- tcpip thread options ---------- */
+#define TCPIP_THREAD_NAME               "tcpip"
+#define TCPIP_THREAD_STACKSIZE          1000
+#define TCPIP_THREAD_PRIO               (configMAX_PRIORITIES - 2)
+#define TCPIP_MBOX_SIZE                 16
+#define DEFAULT_THREAD_STACKSIZE        500
+#define DEFAULT_UDP_RECVMBOX_SIZE       8
+#define DEFAULT_TCP_RECVMBOX_SIZE       8
+#define DEFAULT_ACCEPTMBOX_SIZE         8
+#endif
+
+/* ---------- Zero copy Ethernet options ---------- */
+/* Received frames are custom pbufs referencing Ethernet DMA buffers directly.
+   Custom pbufs need IP_FRAG with IP_FRAG_USES_STATIC_BUF disabled */
+#define IP_FRAG_USES_STATIC_BUF         0
+#define LWIP_NETIF_TX_SINGLE_PBUF       0
+
 /* ---------- Memory options ---------- */
 /* MEM_ALIGNMENT: should be set to the alignment of the CPU for which
    lwIP is compiled. 4 byte alignment -> define MEM_ALIGNMENT to 4, 2
@@ -147,7 +172,7 @@ a lot of data that needs to be copied, this should be set high. */
 */
 
 /* 
-The STM32F4x7 allows computing and verifying the IP, UDP, TCP and ICMP checksums by hardware:
+The STM32F4x7, STM32F42x/43x and STM32F7xx allow computing and verifying the IP, UDP, TCP and ICMP checksums by hardware:
  - To use this feature let the following define uncommented.
  - To disable it and process by CPU comment the  the checksum.
 */
@@ -1,7 +1,7 @@
 /**
  * @file
- * Ethernet Interface for standalone applications (without RTOS) - works only for 
- * ethernet polling mode (polling for ethernet frame reception)
+ * Zero copy Ethernet Interface for STM32Fxxx HAL, for standalone applications (NO_SYS = 1)
+ * with polling for frame reception or FreeRTOS with interrupt driven input thread
  *
  */
 
@@ -39,31 +39,153 @@
 
 #include "lwip/opt.h"
 #include "lwip/mem.h"
+#include "lwip/pbuf.h"
+#include "lwip/sys.h"
 #include "netif/etharp.h"
 #include "ethernetif.h"
-#include "stm32f4x7_eth.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_id.h"
 #include <string.h>
+#if !NO_SYS
+#include "lwip/tcpip.h"
+#endif
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "Custom pbufs are required, check IP_FRAG, IP_FRAG_USES_STATIC_BUF and LWIP_NETIF_TX_SINGLE_PBUF in lwipopts.h"
+#endif
+
+#if ETHERNETIF_RX_BUFFERS <= ETHERNETIF_RX_DESC
+#error "ETHERNETIF_RX_BUFFERS must be bigger than ETHERNETIF_RX_DESC"
+#endif
 
 /* Network interface name */
 #define IFNAME0 's'
 #define IFNAME1 't'
 
+/* Data cache maintenance on STM32F7xx, descriptors and RX buffers are 32 bytes aligned */
+#if defined(STM32F7xx)
+#define ETHERNETIF_CACHE_CLEAN(addr, len)       do { if (SCB->CCR & SCB_CCR_DC_Msk) { SCB_CleanDCache_by_Addr((uint32_t *)((uint32_t)(addr) & ~0x1F), (len) + ((uint32_t)(addr) & 0x1F)); } } while (0)
+#define ETHERNETIF_CACHE_INVALIDATE(addr, len)  do { if (SCB->CCR & SCB_CCR_DC_Msk) { SCB_InvalidateDCache_by_Addr((uint32_t *)((uint32_t)(addr) & ~0x1F), (len) + ((uint32_t)(addr) & 0x1F)); } } while (0)
+#else
+#define ETHERNETIF_CACHE_CLEAN(addr, len)
+#define ETHERNETIF_CACHE_INVALIDATE(addr, len)
+#endif
+
+/* Ethernet DMA can access SRAM and external memories, but not flash and CCM RAM */
+#define ETHERNETIF_DMA_ACCESSIBLE(addr) ((uint32_t)(addr) >= 0x20000000)
+
+/* RX buffer with custom pbuf, pbuf must be first */
+typedef struct ethernetif_rx_buffer {
+  struct pbuf_custom pbuf;
+  struct ethernetif_rx_buffer *next;
+  uint8_t *buffer;
+} ethernetif_rx_buffer_t;
+
+/* Ethernet handle */
+ETH_HandleTypeDef heth;
+
+/* DMA descriptors and RX buffers */
+static ETH_DMADescTypeDef RxDesc[ETHERNETIF_RX_DESC] ETHERNETIF_MEMORY_SECTION __dma_aligned;
+static ETH_DMADescTypeDef TxDesc[ETHERNETIF_TX_DESC] ETHERNETIF_MEMORY_SECTION __dma_aligned;
+static uint8_t RxBuff[ETHERNETIF_RX_BUFFERS][ETHERNETIF_RX_BUFFER_SIZE] ETHERNETIF_MEMORY_SECTION __dma_aligned;
+
+/* RX buffers pool and buffer owned by each descriptor */
+static ethernetif_rx_buffer_t RxBuffers[ETHERNETIF_RX_BUFFERS];
+static ethernetif_rx_buffer_t *RxFree;
+static ethernetif_rx_buffer_t *RxDescBuffer[ETHERNETIF_RX_DESC];
+static uint32_t RxIndex;
+
+/* Pbuf to free when last descriptor of frame is completed */
+static struct pbuf *TxDescPbuf[ETHERNETIF_TX_DESC];
+static uint32_t TxHead, TxTail, TxUsed;
+
+/* Statistics */
+static ethernetif_stats_t Stats;
+
+#if !NO_SYS
+/* Semaphore given from interrupt on received frame */
+static sys_sem_t RxSem;
+static void ethernetif_thread(void *arg);
+#endif
 
-/* Ethernet Rx & Tx DMA Descriptors */
-extern ETH_DMADESCTypeDef  DMARxDscrTab[ETH_RXBUFNB], DMATxDscrTab[ETH_TXBUFNB];
+/**
+ * Custom pbuf free function, called by lwIP when received frame is not needed anymore.
+ * Buffer is returned to pool.
+ */
+static void ethernetif_rx_free(struct pbuf *p)
+{
+  ethernetif_rx_buffer_t *rx = (ethernetif_rx_buffer_t *)p;
+  SYS_ARCH_DECL_PROTECT(lev);
 
-/* Ethernet Driver Receive buffers  */
-extern uint8_t Rx_Buff[ETH_RXBUFNB][ETH_RX_BUF_SIZE]; 
+  SYS_ARCH_PROTECT(lev);
+  rx->next = RxFree;
+  RxFree = rx;
+  SYS_ARCH_UNPROTECT(lev);
+}
 
-/* Ethernet Driver Transmit buffers */
-extern uint8_t Tx_Buff[ETH_TXBUFNB][ETH_TX_BUF_SIZE]; 
+/**
+ * Gets free RX buffer from pool
+ *
+ * @return RX buffer or NULL when pool is empty
+ */
+static ethernetif_rx_buffer_t * ethernetif_rx_alloc(void)
+{
+  ethernetif_rx_buffer_t *rx;
+  SYS_ARCH_DECL_PROTECT(lev);
 
-/* Global pointers to track current transmit and receive descriptors */
-extern ETH_DMADESCTypeDef  *DMATxDescToSet;
-extern ETH_DMADESCTypeDef  *DMARxDescToGet;
+  SYS_ARCH_PROTECT(lev);
+  rx = RxFree;
+  if (rx != NULL) {
+    RxFree = rx->next;
+  }
+  SYS_ARCH_UNPROTECT(lev);
 
-/* Global pointer for last received frame infos */
-extern ETH_DMA_Rx_Frame_infos *DMA_RX_FRAME_infos;
+  return rx;
+}
+
+/**
+ * Gives RX descriptor with its buffer to DMA
+ */
+static void ethernetif_rx_give(uint32_t i)
+{
+  RxDesc[i].Buffer1Addr = (uint32_t)RxDescBuffer[i]->buffer;
+  RxDesc[i].ControlBufferSize = ETH_DMARXDESC_RCH | (ETHERNETIF_RX_BUFFER_SIZE & ETH_DMARXDESC_RBS1);
+
+  /* Buffer may have dirty cache lines from previous use */
+  ETHERNETIF_CACHE_INVALIDATE(RxDescBuffer[i]->buffer, ETHERNETIF_RX_BUFFER_SIZE);
+
+  __DMB();
+  RxDesc[i].Status = ETH_DMARXDESC_OWN;
+  ETHERNETIF_CACHE_CLEAN(&RxDesc[i], sizeof(RxDesc[i]));
+}
+
+/**
+ * Frees pbufs of completed TX descriptors
+ */
+static void ethernetif_tx_reclaim(void)
+{
+  struct pbuf *p;
+  SYS_ARCH_DECL_PROTECT(lev);
+
+  for (;;) {
+    SYS_ARCH_PROTECT(lev);
+    ETHERNETIF_CACHE_INVALIDATE(&TxDesc[TxTail], sizeof(TxDesc[TxTail]));
+    if (TxUsed == 0 || (TxDesc[TxTail].Status & ETH_DMATXDESC_OWN)) {
+      SYS_ARCH_UNPROTECT(lev);
+      break;
+    }
+    p = TxDescPbuf[TxTail];
+    TxDescPbuf[TxTail] = NULL;
+    TxTail = (TxTail + 1) % ETHERNETIF_TX_DESC;
+    TxUsed--;
+    SYS_ARCH_UNPROTECT(lev);
+
+    /* Free outside of protection, lwIP heap uses mutex */
+    if (p != NULL) {
+      pbuf_free(p);
+    }
+  }
+}
 
 /**
  * In this function, the hardware should be initialized.
@@ -74,22 +196,22 @@ extern ETH_DMA_Rx_Frame_infos *DMA_RX_FRAME_infos;
  */
 static void low_level_init(struct netif *netif)
 {
-#ifdef CHECKSUM_BY_HARDWARE
-  int i; 
-#endif
+  uint32_t i;
+
   /* set MAC hardware address length */
   netif->hwaddr_len = ETHARP_HWADDR_LEN;
 
   /* set MAC hardware address */
+#if defined(MAC_ADDR0)
   netif->hwaddr[0] =  MAC_ADDR0;
   netif->hwaddr[1] =  MAC_ADDR1;
   netif->hwaddr[2] =  MAC_ADDR2;
   netif->hwaddr[3] =  MAC_ADDR3;
   netif->hwaddr[4] =  MAC_ADDR4;
   netif->hwaddr[5] =  MAC_ADDR5;
-  
-  /* initialize MAC address in ethernet MAC */ 
-  ETH_MACAddressConfig(ETH_MAC_Address0, netif->hwaddr); 
+#else
+  memcpy(netif->hwaddr, TM_ID_Get()->MAC, ETHARP_HWADDR_LEN);
+#endif
 
   /* maximum transfer unit */
   netif->mtu = 1500;
@@ -98,24 +220,66 @@ static void low_level_init(struct netif *netif)
   /* don't set NETIF_FLAG_ETHARP if this device is not an ethernet one */
   netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
 
-  /* Initialize Tx Descriptors list: Chain Mode */
-  ETH_DMATxDescChainInit(DMATxDscrTab, &Tx_Buff[0][0], ETH_TXBUFNB);
-  /* Initialize Rx Descriptors list: Chain Mode  */
-  ETH_DMARxDescChainInit(DMARxDscrTab, &Rx_Buff[0][0], ETH_RXBUFNB);
-
+  /* Init MAC, DMA and PHY with auto negotiation, interrupt on received frame */
+  heth.Instance = ETH;
+  heth.Init.MACAddr = netif->hwaddr;
+  heth.Init.AutoNegotiation = ETH_AUTONEGOTIATION_ENABLE;
+  heth.Init.Speed = ETH_SPEED_100M;
+  heth.Init.DuplexMode = ETH_MODE_FULLDUPLEX;
+  heth.Init.MediaInterface = ETHERNETIF_MEDIA_INTERFACE;
+  heth.Init.RxMode = ETH_RXINTERRUPT_MODE;
 #ifdef CHECKSUM_BY_HARDWARE
-  /* Enable the TCP, UDP and ICMP checksum insertion for the Tx frames */
-  for(i=0; i<ETH_TXBUFNB; i++)
-    {
-      ETH_DMATxDescChecksumInsertionConfig(&DMATxDscrTab[i], ETH_DMATxDesc_ChecksumTCPUDPICMPFull);
-    }
+  heth.Init.ChecksumMode = ETH_CHECKSUM_BY_HARDWARE;
+#else
+  heth.Init.ChecksumMode = ETH_CHECKSUM_BY_SOFTWARE;
 #endif
+  heth.Init.PhyAddress = ETHERNETIF_PHY_ADDRESS;
 
-   /* Note: TCP, UDP, ICMP checksum checking for received frame are enabled in DMA config */
+  /* Link is up when auto negotiation completed */
+  if (HAL_ETH_Init(&heth) == HAL_OK) {
+    netif->flags |= NETIF_FLAG_LINK_UP;
+  }
 
-  /* Enable MAC and DMA transmission and reception */
-  ETH_Start();
+  /* RX buffers pool */
+  RxFree = NULL;
+  for (i = 0; i < ETHERNETIF_RX_BUFFERS; i++) {
+    RxBuffers[i].buffer = RxBuff[i];
+    RxBuffers[i].pbuf.custom_free_function = ethernetif_rx_free;
+    RxBuffers[i].next = RxFree;
+    RxFree = &RxBuffers[i];
+  }
+
+  /* RX descriptors in chain mode, each owns one buffer from pool */
+  for (i = 0; i < ETHERNETIF_RX_DESC; i++) {
+    RxDescBuffer[i] = ethernetif_rx_alloc();
+    RxDesc[i].Buffer2NextDescAddr = (uint32_t)&RxDesc[(i + 1) % ETHERNETIF_RX_DESC];
+    ethernetif_rx_give(i);
+  }
+  RxIndex = 0;
+
+  /* TX descriptors in chain mode, owned by CPU */
+  for (i = 0; i < ETHERNETIF_TX_DESC; i++) {
+    TxDesc[i].Status = ETH_DMATXDESC_TCH;
+    TxDesc[i].Buffer2NextDescAddr = (uint32_t)&TxDesc[(i + 1) % ETHERNETIF_TX_DESC];
+    TxDescPbuf[i] = NULL;
+    ETHERNETIF_CACHE_CLEAN(&TxDesc[i], sizeof(TxDesc[i]));
+  }
+  TxHead = TxTail = TxUsed = 0;
+
+  /* Set descriptor lists to DMA */
+  ETH->DMATDLAR = (uint32_t)TxDesc;
+  ETH->DMARDLAR = (uint32_t)RxDesc;
 
+  /* Note: TCP, UDP, ICMP checksum checking for received frame are enabled in MAC config */
+
+#if !NO_SYS
+  /* Create input thread */
+  sys_sem_new(&RxSem, 0);
+  sys_thread_new("ethernetif", ethernetif_thread, netif, ETHERNETIF_THREAD_STACKSIZE, ETHERNETIF_THREAD_PRIO);
+#endif
+
+  /* Enable MAC and DMA transmission and reception */
+  HAL_ETH_Start(&heth);
 }
 
 /**
@@ -123,171 +287,167 @@ static void low_level_init(struct netif *netif)
  * contained in the pbuf that is passed to the function. This pbuf
  * might be chained.
  *
+ * Pbufs are not copied, each pbuf in chain is given to one DMA descriptor
+ * and freed after DMA completes.
+ *
  * @param netif the lwip network interface structure for this ethernetif
  * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
  * @return ERR_OK if the packet could be sent
  *         an err_t value if the packet couldn't be sent
- *
- * @note Returning ERR_MEM here if a DMA queue of your MAC is full can lead to
- *       strange results. You might consider waiting for space in the DMA queue
- *       to become availale since the stack doesn't retry to send a packet
- *       dropped because of memory failure (except for the TCP timers).
  */
-
 static err_t low_level_output(struct netif *netif, struct pbuf *p)
 {
-  err_t errval;
-  struct pbuf *q;
-  u8 *buffer =  (u8 *)(DMATxDescToSet->Buffer1Addr);
-  __IO ETH_DMADESCTypeDef *DmaTxDesc;
-  uint16_t framelength = 0;
-  uint32_t bufferoffset = 0;
-  uint32_t byteslefttocopy = 0;
-  uint32_t payloadoffset = 0;
-
-  DmaTxDesc = DMATxDescToSet;
-  bufferoffset = 0;
-
-  /* copy frame from pbufs to driver buffers */
-  for(q = p; q != NULL; q = q->next)
-    {
-      /* Is this buffer available? If not, goto error */
-      if((DmaTxDesc->Status & ETH_DMATxDesc_OWN) != (u32)RESET)
-      {
-        errval = ERR_BUF;
-        goto error;
+  struct pbuf *q, *frame = p;
+  uint32_t count = 0, i, first, status, tickstart;
+  u8_t copy = 0;
+  SYS_ARCH_DECL_PROTECT(lev);
+
+  /* Count descriptors and check if DMA can access memory */
+  for (q = p; q != NULL; q = q->next) {
+    if (q->len) {
+      count++;
+      if (!ETHERNETIF_DMA_ACCESSIBLE(q->payload)) {
+        copy = 1;
       }
+    }
+  }
 
-      /* Get bytes in current lwIP buffer */
-      byteslefttocopy = q->len;
-      payloadoffset = 0;
+  /* Copy frame to single RAM pbuf when needed */
+  if (copy || count > ETHERNETIF_TX_DESC) {
+    frame = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_RAM);
+    if (frame == NULL) {
+      Stats.TxDropped++;
+      return ERR_MEM;
+    }
+    pbuf_copy(frame, p);
+    count = 1;
+    Stats.TxCopied++;
+  } else {
+    /* Keep pbuf until DMA completes */
+    pbuf_ref(frame);
+  }
 
-      /* Check if the length of data to copy is bigger than Tx buffer size*/
-      while( (byteslefttocopy + bufferoffset) > ETH_TX_BUF_SIZE )
-      {
-        /* Copy data to Tx buffer*/
-        memcpy( (u8_t*)((u8_t*)buffer + bufferoffset), (u8_t*)((u8_t*)q->payload + payloadoffset), (ETH_TX_BUF_SIZE - bufferoffset) );
+  /* Wait for free descriptors */
+  tickstart = HAL_GetTick();
+  ethernetif_tx_reclaim();
+  while (ETHERNETIF_TX_DESC - TxUsed < count) {
+    if ((HAL_GetTick() - tickstart) > ETHERNETIF_TX_TIMEOUT) {
+      pbuf_free(frame);
+      Stats.TxDropped++;
+      return ERR_MEM;
+    }
+#if !NO_SYS
+    sys_msleep(1);
+#endif
+    ethernetif_tx_reclaim();
+  }
 
-        /* Point to next descriptor */
-        DmaTxDesc = (ETH_DMADESCTypeDef *)(DmaTxDesc->Buffer2NextDescAddr);
+  SYS_ARCH_PROTECT(lev);
 
-        /* Check if the buffer is available */
-        if((DmaTxDesc->Status & ETH_DMATxDesc_OWN) != (u32)RESET)
-        {
-          errval = ERR_USE;
-          goto error;
-        }
+  /* Fill descriptors, first one is given to DMA last */
+  first = TxHead;
+  i = TxHead;
+  for (q = frame; q != NULL; q = q->next) {
+    if (!q->len) {
+      continue;
+    }
+    ETHERNETIF_CACHE_CLEAN(q->payload, q->len);
 
-        buffer = (u8 *)(DmaTxDesc->Buffer1Addr);
+    status = ETH_DMATXDESC_TCH;
+#ifdef CHECKSUM_BY_HARDWARE
+    status |= ETH_DMATXDESC_CIC_TCPUDPICMP_FULL;
+#endif
+    if (i == first) {
+      status |= ETH_DMATXDESC_FS;
+    } else {
+      status |= ETH_DMATXDESC_OWN;
+    }
+    if (--count == 0) {
+      /* Last segment, frame is freed when this descriptor completes */
+      status |= ETH_DMATXDESC_LS | ETH_DMATXDESC_IC;
+      TxDescPbuf[i] = frame;
+    }
 
-        byteslefttocopy = byteslefttocopy - (ETH_TX_BUF_SIZE - bufferoffset);
-        payloadoffset = payloadoffset + (ETH_TX_BUF_SIZE - bufferoffset);
-        framelength = framelength + (ETH_TX_BUF_SIZE - bufferoffset);
-        bufferoffset = 0;
-      }
+    TxDesc[i].Buffer1Addr = (uint32_t)q->payload;
+    TxDesc[i].ControlBufferSize = q->len & ETH_DMATXDESC_TBS1;
+    TxDesc[i].Status = status;
+    ETHERNETIF_CACHE_CLEAN(&TxDesc[i], sizeof(TxDesc[i]));
 
-      /* Copy the remaining bytes */
-      memcpy( (u8_t*)((u8_t*)buffer + bufferoffset), (u8_t*)((u8_t*)q->payload + payloadoffset), byteslefttocopy );
-      bufferoffset = bufferoffset + byteslefttocopy;
-      framelength = framelength + byteslefttocopy;
-    }
-  
-  /* Note: padding and CRC for transmitted frame 
-     are automatically inserted by DMA */
+    i = (i + 1) % ETHERNETIF_TX_DESC;
+    TxUsed++;
+  }
+  TxHead = i;
 
-  /* Prepare transmit descriptors to give to DMA*/ 
-  ETH_Prepare_Transmit_Descriptors(framelength);
+  /* Start frame */
+  __DMB();
+  TxDesc[first].Status |= ETH_DMATXDESC_OWN;
+  ETHERNETIF_CACHE_CLEAN(&TxDesc[first], sizeof(TxDesc[first]));
+  __DSB();
 
-  errval = ERR_OK;
+  SYS_ARCH_UNPROTECT(lev);
 
-error:
-  
-  /* When Transmit Underflow flag is set, clear it and issue a Transmit Poll Demand to resume transmission */
-  if ((ETH->DMASR & ETH_DMASR_TUS) != (uint32_t)RESET)
+  /* When Transmit buffer unavailable or underflow flag is set, clear it and issue a Transmit Poll Demand to resume transmission */
+  if ((ETH->DMASR & (ETH_DMASR_TBUS | ETH_DMASR_TUS)) != (uint32_t)RESET)
   {
-    /* Clear TUS ETHERNET DMA flag */
-    ETH->DMASR = ETH_DMASR_TUS;
-
-    /* Resume DMA transmission*/
-    ETH->DMATPDR = 0;
+    ETH->DMASR = ETH_DMASR_TBUS | ETH_DMASR_TUS;
   }
-  return errval;
+  ETH->DMATPDR = 0;
+
+  Stats.TxFrames++;
+  return ERR_OK;
 }
 
 /**
- * Should allocate a pbuf and transfer the bytes of the incoming
- * packet from the interface into the pbuf.
+ * Passes received frame in DMA buffer to lwIP as custom pbuf.
+ * Descriptor gets new buffer from pool and is given back to DMA.
  *
  * @param netif the lwip network interface structure for this ethernetif
  * @return a pbuf filled with the received packet (including MAC header)
- *         NULL on memory error
-   */
+ *         NULL when no frame is received
+ */
 static struct pbuf * low_level_input(struct netif *netif)
 {
-  struct pbuf *p, *q;
-  uint32_t len;
-  FrameTypeDef frame;
-  u8 *buffer;
-  __IO ETH_DMADESCTypeDef *DMARxDesc;
-  uint32_t bufferoffset = 0;
-  uint32_t payloadoffset = 0;
-  uint32_t byteslefttocopy = 0;
-  uint32_t i=0;  
-  
-  /* get received frame */
-  frame = ETH_Get_Received_Frame();
-  
-  /* Obtain the size of the packet and put it into the "len" variable. */
-  len = frame.length;
-  buffer = (u8 *)frame.buffer;
-  
-  /* We allocate a pbuf chain of pbufs from the Lwip buffer pool */
-  p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
-  
-  if (p != NULL)
-  {
-    DMARxDesc = frame.descriptor;
-    bufferoffset = 0;
-    for(q = p; q != NULL; q = q->next)
-    {
-      byteslefttocopy = q->len;
-      payloadoffset = 0;
-      
-      /* Check if the length of bytes to copy in current pbuf is bigger than Rx buffer size*/
-      while( (byteslefttocopy + bufferoffset) > ETH_RX_BUF_SIZE )
-      {
-        /* Copy data to pbuf*/
-        memcpy( (u8_t*)((u8_t*)q->payload + payloadoffset), (u8_t*)((u8_t*)buffer + bufferoffset), (ETH_RX_BUF_SIZE - bufferoffset));
-        
-        /* Point to next descriptor */
-        DMARxDesc = (ETH_DMADESCTypeDef *)(DMARxDesc->Buffer2NextDescAddr);
-        buffer = (unsigned char *)(DMARxDesc->Buffer1Addr);
-        
-        byteslefttocopy = byteslefttocopy - (ETH_RX_BUF_SIZE - bufferoffset);
-        payloadoffset = payloadoffset + (ETH_RX_BUF_SIZE - bufferoffset);
-        bufferoffset = 0;
-      }
-      /* Copy remaining data in pbuf */
-      memcpy( (u8_t*)((u8_t*)q->payload + payloadoffset), (u8_t*)((u8_t*)buffer + bufferoffset), byteslefttocopy);
-      bufferoffset = bufferoffset + byteslefttocopy;
+  ethernetif_rx_buffer_t *rx, *fresh;
+  struct pbuf *p = NULL;
+  uint32_t status, len;
+
+  while (p == NULL) {
+    /* Check if descriptor is owned by CPU */
+    ETHERNETIF_CACHE_INVALIDATE(&RxDesc[RxIndex], sizeof(RxDesc[RxIndex]));
+    status = RxDesc[RxIndex].Status;
+    if (status & ETH_DMARXDESC_OWN) {
+      break;
     }
+
+    /* Frame must fit into one buffer and have no errors */
+    fresh = NULL;
+    if ((status & (ETH_DMARXDESC_FS | ETH_DMARXDESC_LS | ETH_DMARXDESC_ES)) == (ETH_DMARXDESC_FS | ETH_DMARXDESC_LS)) {
+      fresh = ethernetif_rx_alloc();
+    }
+
+    if (fresh != NULL) {
+      /* Frame length without CRC */
+      len = ((status & ETH_DMARXDESC_FL) >> ETH_DMARXDESC_FRAMELENGTHSHIFT) - 4;
+      rx = RxDescBuffer[RxIndex];
+      ETHERNETIF_CACHE_INVALIDATE(rx->buffer, len);
+
+      /* Reference DMA buffer directly */
+      p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &rx->pbuf, rx->buffer, ETHERNETIF_RX_BUFFER_SIZE);
+
+      /* Descriptor continues with new buffer */
+      RxDescBuffer[RxIndex] = fresh;
+      Stats.RxFrames++;
+    } else {
+      /* Drop frame, descriptor keeps its buffer */
+      Stats.RxDropped++;
+    }
+
+    ethernetif_rx_give(RxIndex);
+    RxIndex = (RxIndex + 1) % ETHERNETIF_RX_DESC;
   }
-  
-  /* Release descriptors to DMA */
-  DMARxDesc =frame.descriptor;
-
-  /* Set Own bit in Rx descriptors: gives the buffers back to DMA */
-  for (i=0; i<DMA_RX_FRAME_infos->Seg_Count; i++)
-  {  
-    DMARxDesc->Status = ETH_DMARxDesc_OWN;
-    DMARxDesc = (ETH_DMADESCTypeDef *)(DMARxDesc->Buffer2NextDescAddr);
-  }
-  
-  /* Clear Segment_Count */
-  DMA_RX_FRAME_infos->Seg_Count =0;
-  
+
   /* When Rx Buffer unavailable flag is set: clear it and resume reception */
-  if ((ETH->DMASR & ETH_DMASR_RBUS) != (u32)RESET)  
+  if ((ETH->DMASR & ETH_DMASR_RBUS) != (uint32_t)RESET)
   {
     /* Clear RBUS ETHERNET DMA flag */
     ETH->DMASR = ETH_DMASR_RBUS;
@@ -304,30 +464,70 @@ static struct pbuf * low_level_input(struct netif *netif)
  * interface. Then the type of the received packet is determined and
  * the appropriate input function is called.
  *
+ * All received frames are processed. With FreeRTOS, this function is called from input thread.
+ *
  * @param netif the lwip network interface structure for this ethernetif
+ * @return ERR_OK if at least one frame was received, ERR_MEM otherwise
  */
 err_t ethernetif_input(struct netif *netif)
 {
-  err_t err;
+  err_t err = ERR_MEM;
   struct pbuf *p;
 
-  /* move received packet into a new pbuf */
-  p = low_level_input(netif);
+  /* Free completed TX pbufs */
+  ethernetif_tx_reclaim();
 
-  /* no packet could be read, silently ignore this */
-  if (p == NULL) return ERR_MEM;
+  /* move received packets to lwIP */
+  while ((p = low_level_input(netif)) != NULL) {
+    err = ERR_OK;
 
-  /* entry point to the LwIP stack */
-  err = netif->input(p, netif);
-  
-  if (err != ERR_OK)
-  {
-    LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
-    pbuf_free(p);
+    /* entry point to the LwIP stack */
+    if (netif->input(p, netif) != ERR_OK)
+    {
+      LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
+      pbuf_free(p);
+    }
   }
   return err;
 }
 
+/**
+ * Checks PHY link status and notifies lwIP about changes.
+ * Should be called periodically, for example every 500ms.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ */
+void ethernetif_check_link(struct netif *netif)
+{
+  uint32_t reg = 0;
+
+  if (HAL_ETH_ReadPHYRegister(&heth, PHY_BSR, &reg) != HAL_OK) {
+    return;
+  }
+
+  if ((reg & PHY_LINKED_STATUS) && !netif_is_link_up(netif)) {
+    /* Link up, set MAC to speed and duplex from auto negotiation */
+    if (HAL_ETH_ReadPHYRegister(&heth, PHY_SR, &reg) == HAL_OK) {
+      heth.Init.Speed = (reg & PHY_SPEED_STATUS) ? ETH_SPEED_10M : ETH_SPEED_100M;
+      heth.Init.DuplexMode = (reg & PHY_DUPLEX_STATUS) ? ETH_MODE_FULLDUPLEX : ETH_MODE_HALFDUPLEX;
+      HAL_ETH_ConfigMAC(&heth, NULL);
+    }
+    netif_set_link_up(netif);
+  } else if (!(reg & PHY_LINKED_STATUS) && netif_is_link_up(netif)) {
+    netif_set_link_down(netif);
+  }
+}
+
+/**
+ * Gets interface statistics
+ *
+ * @param stats pointer to structure to copy statistics to
+ */
+void ethernetif_get_stats(ethernetif_stats_t *stats)
+{
+  *stats = Stats;
+}
+
 /**
  * Should be called at the beginning of the program to set up the
  * network interface. It calls the function low_level_init() to do the
@@ -364,3 +564,61 @@ err_t ethernetif_init(struct netif *netif)
   return ERR_OK;
 }
 
+#if !NO_SYS
+/**
+ * Input thread, waits for received frame interrupt
+ */
+static void ethernetif_thread(void *arg)
+{
+  struct netif *netif = (struct netif *)arg;
+
+  for (;;) {
+    if (sys_arch_sem_wait(&RxSem, 100) != SYS_ARCH_TIMEOUT) {
+      ethernetif_input(netif);
+    } else {
+      /* Free completed TX pbufs even without traffic */
+      ethernetif_tx_reclaim();
+    }
+  }
+}
+#endif
+
+/**
+ * Ethernet MSP init, RMII pins, clock and interrupt
+ * Ethernet pins and PHY settings can be changed in defines.h file, see ethernetif.h
+ */
+void HAL_ETH_MspInit(ETH_HandleTypeDef *heth)
+{
+  /* RMII pins: REF_CLK PA1, MDIO PA2, CRS_DV PA7, MDC PC1, RXD0 PC4, RXD1 PC5, TX_EN PG11, TXD0 PG13, TXD1 configurable */
+  TM_GPIO_InitAlternate(GPIOA, GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_7, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, GPIO_AF11_ETH);
+  TM_GPIO_InitAlternate(GPIOC, GPIO_PIN_1 | GPIO_PIN_4 | GPIO_PIN_5, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, GPIO_AF11_ETH);
+  TM_GPIO_InitAlternate(GPIOG, GPIO_PIN_11 | GPIO_PIN_13, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, GPIO_AF11_ETH);
+  TM_GPIO_InitAlternate(ETHERNETIF_TXD1_PORT, ETHERNETIF_TXD1_PIN, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, GPIO_AF11_ETH);
+
+  /* Enable interrupt */
+  HAL_NVIC_SetPriority(ETH_IRQn, ETHERNETIF_NVIC_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(ETH_IRQn);
+
+  /* Enable Ethernet clocks */
+  __HAL_RCC_ETH_CLK_ENABLE();
+}
+
+/**
+ * Ethernet interrupt, frame received
+ */
+void ETH_IRQHandler(void)
+{
+  /* Clear receive and normal interrupt summary flags */
+  if (ETH->DMASR & ETH_DMASR_RS) {
+    ETH->DMASR = ETH_DMASR_RS | ETH_DMASR_NIS;
+#if !NO_SYS
+    {
+      portBASE_TYPE woken = pdFALSE;
+
+      /* Wake up input thread */
+      xSemaphoreGiveFromISR(RxSem, &woken);
+      portEND_SWITCHING_ISR(woken);
+    }
+#endif
+  }
+}
@@ -4,8 +4,103 @@
 
 #include "lwip/err.h"
 #include "lwip/netif.h"
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+
+/*
+ * Zero copy Ethernet interface for STM32F4x7, STM32F42x/43x and STM32F7xx HAL
+ *
+ * Received frames are passed to lwIP as custom pbufs pointing directly to DMA buffers.
+ * Descriptor gets new buffer from pool immediately, buffer returns to pool when pbuf is freed.
+ * Transmitted pbuf chains are given to DMA descriptors directly, one descriptor per pbuf,
+ * and freed when DMA completes. Pbufs in memory which Ethernet DMA can not access (flash, CCM RAM) are copied.
+ *
+ * All settings can be overwritten in defines.h or lwipopts.h file
+ */
+
+/* Number of RX descriptors */
+#ifndef ETHERNETIF_RX_DESC
+#define ETHERNETIF_RX_DESC              8
+#endif
+
+/* Number of RX buffers, must be bigger than number of RX descriptors.
+   Buffers above descriptors count can be held by lwIP stack at the same time */
+#ifndef ETHERNETIF_RX_BUFFERS
+#define ETHERNETIF_RX_BUFFERS           16
+#endif
+
+/* Size of one RX buffer, whole frame must fit into one buffer, multiple of 32 bytes */
+#ifndef ETHERNETIF_RX_BUFFER_SIZE
+#define ETHERNETIF_RX_BUFFER_SIZE       1536
+#endif
+
+/* Number of TX descriptors, one pbuf in chain uses one descriptor */
+#ifndef ETHERNETIF_TX_DESC
+#define ETHERNETIF_TX_DESC              16
+#endif
+
+/* Section attribute for descriptors and RX buffers, for example __sdram to place them in SDRAM.
+   Memory must be accessible by Ethernet DMA, CCM RAM can not be used */
+#ifndef ETHERNETIF_MEMORY_SECTION
+#define ETHERNETIF_MEMORY_SECTION
+#endif
+
+/* Time in milliseconds to wait for free TX descriptors */
+#ifndef ETHERNETIF_TX_TIMEOUT
+#define ETHERNETIF_TX_TIMEOUT           10
+#endif
+
+/* PHY settings, LAN8742A on Nucleo-144 and STM32F7-Discovery boards */
+#ifndef ETHERNETIF_PHY_ADDRESS
+#define ETHERNETIF_PHY_ADDRESS          0x00
+#endif
+#ifndef ETHERNETIF_MEDIA_INTERFACE
+#define ETHERNETIF_MEDIA_INTERFACE      ETH_MEDIA_INTERFACE_RMII
+#endif
+
+/* MAC address. When MAC_ADDR0 to MAC_ADDR5 are not defined,
+   locally administered address from TM ID identity block is used, unique for each device */
+
+/* RMII pins, TXD1 is on PG14 on STM32F7-Discovery board and on PB13 on Nucleo-144 boards */
+#ifndef ETHERNETIF_TXD1_PORT
+#if defined(STM32F7_DISCOVERY)
+#define ETHERNETIF_TXD1_PORT            GPIOG
+#define ETHERNETIF_TXD1_PIN             GPIO_PIN_14
+#else
+#define ETHERNETIF_TXD1_PORT            GPIOB
+#define ETHERNETIF_TXD1_PIN             GPIO_PIN_13
+#endif
+#endif
+
+/* NVIC priority for Ethernet interrupt, must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY with FreeRTOS */
+#ifndef ETHERNETIF_NVIC_PRIORITY
+#define ETHERNETIF_NVIC_PRIORITY        NVIC_PRIORITY_NORMAL
+#endif
+
+/* Input thread settings when used with FreeRTOS */
+#ifndef ETHERNETIF_THREAD_STACKSIZE
+#define ETHERNETIF_THREAD_STACKSIZE     350
+#endif
+#ifndef ETHERNETIF_THREAD_PRIO
+#define ETHERNETIF_THREAD_PRIO          (configMAX_PRIORITIES - 1)
+#endif
+
+/* Interface statistics */
+typedef struct {
+	u32_t RxFrames;      /* Received frames passed to stack */
+	u32_t RxDropped;     /* Received frames dropped, no free buffer or error */
+	u32_t TxFrames;      /* Transmitted frames */
+	u32_t TxCopied;      /* Transmitted frames which had to be copied */
+	u32_t TxDropped;     /* Transmitted frames dropped, no free descriptors */
+} ethernetif_stats_t;
+
+/* Ethernet handle */
+extern ETH_HandleTypeDef heth;
 
 err_t ethernetif_init(struct netif *netif);
 err_t ethernetif_input(struct netif *netif);
+void ethernetif_check_link(struct netif *netif);
+void ethernetif_get_stats(ethernetif_stats_t *stats);
 
 #endif
@@ -0,0 +1,235 @@
+/**
+ * @file
+ * lwIP operating system abstraction layer for FreeRTOS
+ * With NO_SYS = 1 only sys_now is provided, from HAL tick
+ *
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ * This file is part of the lwIP TCP/IP stack.
+ *
+ */
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/err.h"
+#include "stm32fxxx_hal.h"
+
+#if NO_SYS
+
+/**
+ * Returns current time in milliseconds, used for lwIP timers
+ */
+u32_t sys_now(void)
+{
+  return HAL_GetTick();
+}
+
+#else
+
+/* Initialize sys arch layer, nothing to do with FreeRTOS */
+void sys_init(void)
+{
+}
+
+/* Returns current time in milliseconds */
+u32_t sys_now(void)
+{
+  return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+/* Semaphores */
+err_t sys_sem_new(sys_sem_t *sem, u8_t count)
+{
+  vSemaphoreCreateBinary(*sem);
+  if (*sem == NULL) {
+    return ERR_MEM;
+  }
+
+  /* Binary semaphore is created given */
+  if (count == 0) {
+    xSemaphoreTake(*sem, 0);
+  }
+  return ERR_OK;
+}
+
+void sys_sem_free(sys_sem_t *sem)
+{
+  vSemaphoreDelete(*sem);
+}
+
+void sys_sem_signal(sys_sem_t *sem)
+{
+  xSemaphoreGive(*sem);
+}
+
+u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
+{
+  portTickType start = xTaskGetTickCount();
+
+  if (timeout) {
+    if (xSemaphoreTake(*sem, timeout / portTICK_PERIOD_MS) != pdTRUE) {
+      return SYS_ARCH_TIMEOUT;
+    }
+  } else {
+    while (xSemaphoreTake(*sem, portMAX_DELAY) != pdTRUE);
+  }
+
+  /* Return time waited */
+  return (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+}
+
+int sys_sem_valid(sys_sem_t *sem)
+{
+  return *sem != SYS_SEM_NULL;
+}
+
+void sys_sem_set_invalid(sys_sem_t *sem)
+{
+  *sem = SYS_SEM_NULL;
+}
+
+/* Mutexes */
+err_t sys_mutex_new(sys_mutex_t *mutex)
+{
+  *mutex = xSemaphoreCreateMutex();
+  return *mutex != NULL ? ERR_OK : ERR_MEM;
+}
+
+void sys_mutex_free(sys_mutex_t *mutex)
+{
+  vSemaphoreDelete(*mutex);
+}
+
+void sys_mutex_lock(sys_mutex_t *mutex)
+{
+  while (xSemaphoreTake(*mutex, portMAX_DELAY) != pdTRUE);
+}
+
+void sys_mutex_unlock(sys_mutex_t *mutex)
+{
+  xSemaphoreGive(*mutex);
+}
+
+int sys_mutex_valid(sys_mutex_t *mutex)
+{
+  return *mutex != SYS_SEM_NULL;
+}
+
+void sys_mutex_set_invalid(sys_mutex_t *mutex)
+{
+  *mutex = SYS_SEM_NULL;
+}
+
+/* Mailboxes */
+err_t sys_mbox_new(sys_mbox_t *mbox, int size)
+{
+  *mbox = xQueueCreate(size > 0 ? size : archMESG_QUEUE_LENGTH, sizeof(void *));
+  return *mbox != NULL ? ERR_OK : ERR_MEM;
+}
+
+void sys_mbox_free(sys_mbox_t *mbox)
+{
+  vQueueDelete(*mbox);
+}
+
+void sys_mbox_post(sys_mbox_t *mbox, void *msg)
+{
+  while (xQueueSendToBack(*mbox, &msg, portMAX_DELAY) != pdTRUE);
+}
+
+err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
+{
+  return xQueueSendToBack(*mbox, &msg, 0) == pdTRUE ? ERR_OK : ERR_MEM;
+}
+
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
+{
+  void *dummy;
+  portTickType start = xTaskGetTickCount();
+
+  if (msg == NULL) {
+    msg = &dummy;
+  }
+
+  if (timeout) {
+    if (xQueueReceive(*mbox, msg, timeout / portTICK_PERIOD_MS) != pdTRUE) {
+      *msg = NULL;
+      return SYS_ARCH_TIMEOUT;
+    }
+  } else {
+    while (xQueueReceive(*mbox, msg, portMAX_DELAY) != pdTRUE);
+  }
+
+  /* Return time waited */
+  return (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+}
+
+u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
+{
+  void *dummy;
+
+  if (msg == NULL) {
+    msg = &dummy;
+  }
+  return xQueueReceive(*mbox, msg, 0) == pdTRUE ? 0 : SYS_MBOX_EMPTY;
+}
+
+int sys_mbox_valid(sys_mbox_t *mbox)
+{
+  return *mbox != SYS_MBOX_NULL;
+}
+
+void sys_mbox_set_invalid(sys_mbox_t *mbox)
+{
+  *mbox = SYS_MBOX_NULL;
+}
+
+/* Threads */
+sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize, int prio)
+{
+  xTaskHandle handle = NULL;
+
+  xTaskCreate(thread, name, stacksize > 0 ? stacksize : SYS_DEFAULT_THREAD_STACK_DEPTH, arg, prio, &handle);
+  return handle;
+}
+
+/* Lightweight protection, critical sections can be nested */
+sys_prot_t sys_arch_protect(void)
+{
+  taskENTER_CRITICAL();
+  return 1;
+}
+
+void sys_arch_unprotect(sys_prot_t pval)
+{
+  (void)pval;
+  taskEXIT_CRITICAL();
+}
+
+#endif /* NO_SYS */
@@ -110,8 +110,8 @@ extern "C" {
 #ifndef DEFINES_FILE
 #define DEFINES_FILE
 
-//Let's set EXTI NVIC preemption priority to highest, so we will do:
-#define EXTI_NVIC_PRIORITY    0x00
+//Let's set EXTI NVIC preemption priority to lowest, so we will do:
+#define EXTI_NVIC_PRIORITY    0x0F
 
 #endif
 \endcode
@@ -129,6 +129,11 @@ extern "C" {
  *
  * Please check above about this.
  *
+ * \par NVIC priorities
+ *
+ * Interrupt priorities of all libraries are set in one place, @ref TM_NVIC, and can be changed in defines.h file.
+ * Plan is checked on compile time, so low value interrupt, like EXTI button, can not preempt DMA by mistake.
+ *
  */
 
 /**
@@ -199,6 +204,7 @@ extern "C" {
 
 /* Init main libraries used everywhere */
 #include "defines.h"
+#include "tm_stm32_nvic.h"
 #include "tm_stm32_rcc.h"
 #include "tm_stm32_gpio.h"
 
@@ -36,45 +36,51 @@ static void TM_ADC_INT_Channel_13_Init(ADC_TypeDef* ADCx);
 static void TM_ADC_INT_Channel_14_Init(ADC_TypeDef* ADCx);
 static void TM_ADC_INT_Channel_15_Init(ADC_TypeDef* ADCx);
 static void TM_ADC_INT_InitPin(GPIO_TypeDef* GPIOx, uint16_t PinX);
+static void TM_ADC_INT_InitChannel(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel);
 
 /* Private variables */
 ADC_HandleTypeDef AdcHandle;
 
+#if !defined(STM32F0xx)
+/* Scan mode settings */
+typedef struct {
+	DMA_Stream_TypeDef* Stream;
+	uint32_t Channel;
+	uint16_t* Buffer;
+	uint16_t Sequences;
+	uint8_t Count;
+	uint8_t Monitor;
+	uint8_t MonitorChannel;
+} TM_ADC_INT_Scan_t;
+
+#if defined(ADC1)
+static TM_ADC_INT_Scan_t ADC1_Scan = {ADC1_DMA_STREAM, ADC1_DMA_CHANNEL};
+#endif
+#if defined(ADC2)
+static TM_ADC_INT_Scan_t ADC2_Scan = {ADC2_DMA_STREAM, ADC2_DMA_CHANNEL};
+#endif
+#if defined(ADC3)
+static TM_ADC_INT_Scan_t ADC3_Scan = {ADC3_DMA_STREAM, ADC3_DMA_CHANNEL};
+#endif
+
+static TM_ADC_INT_Scan_t* TM_ADC_INT_GetScan(ADC_TypeDef* ADCx);
+static void TM_ADC_INT_ScanStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+static void TM_ADC_INT_WatchdogIRQ(ADC_TypeDef* ADCx);
+#endif
+
+#if !defined(STM32F0xx) && defined(ADC2)
+/* Interleaved mode settings */
+static ADC_HandleTypeDef AdcInterleavedHandle[3];
+static uint32_t* AdcInterleavedBuffer;
+static uint16_t AdcInterleavedWords;
+static uint8_t AdcInterleavedCount;
+
+static void TM_ADC_INT_InterleavedStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+#endif
+
 void TM_ADC_Init(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel) {
-	TM_ADC_Channel_t ch = (TM_ADC_Channel_t) channel;
-	if (ch == TM_ADC_Channel_0) {
-		TM_ADC_INT_Channel_0_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_1) {
-		TM_ADC_INT_Channel_1_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_2) {
-		TM_ADC_INT_Channel_2_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_3) {
-		TM_ADC_INT_Channel_3_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_4) {
-		TM_ADC_INT_Channel_4_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_5) {
-		TM_ADC_INT_Channel_5_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_6) {
-		TM_ADC_INT_Channel_6_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_7) {
-		TM_ADC_INT_Channel_7_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_8) {
-		TM_ADC_INT_Channel_8_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_9) {
-		TM_ADC_INT_Channel_9_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_10) {
-		TM_ADC_INT_Channel_10_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_11) {
-		TM_ADC_INT_Channel_11_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_12) {
-		TM_ADC_INT_Channel_12_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_13) {
-		TM_ADC_INT_Channel_13_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_14) {
-		TM_ADC_INT_Channel_14_Init(ADCx);
-	} else if (ch == TM_ADC_Channel_15) {
-		TM_ADC_INT_Channel_15_Init(ADCx);
-	}
+	/* Init pin for channel */
+	TM_ADC_INT_InitChannel(ADCx, channel);
 	
 	/* Init ADC */
 	TM_ADC_InitADC(ADCx);
@@ -202,7 +208,548 @@ uint16_t TM_ADC_ReadVbat(ADC_TypeDef* ADCx) {
 }
 #endif
 
+#if !defined(STM32F0xx)
+uint8_t TM_ADC_StartScan(ADC_TypeDef* ADCx, const TM_ADC_Channel_t* Channels, const uint32_t* SamplingTimes, uint8_t count, uint16_t* Buffer, uint16_t Sequences, uint32_t Trigger) {
+	TM_ADC_INT_Scan_t* Scan = TM_ADC_INT_GetScan(ADCx);
+	ADC_ChannelConfTypeDef sConfig;
+	DMA_HandleTypeDef DMA_InitStruct;
+	uint8_t i;
+	
+	/* Check parameters */
+	if (Scan == NULL || count == 0 || count > 16 || Sequences == 0 || (uint32_t)2 * Sequences * count > 0xFFFF) {
+		return 1;
+	}
+	
+	/* Stop previous scan if running */
+	TM_ADC_StopScan(ADCx);
+	
+	/* Init pins */
+	for (i = 0; i < count; i++) {
+		TM_ADC_INT_InitChannel(ADCx, Channels[i]);
+	}
+	
+	/* Init ADC with default settings first */
+	TM_ADC_InitADC(ADCx);
+	
+	/* Scan all channels with DMA requests on each conversion */
+	AdcHandle.Init.ScanConvMode = ENABLE;
+	AdcHandle.Init.NbrOfConversion = count;
+	AdcHandle.Init.DMAContinuousRequests = ENABLE;
+	AdcHandle.Init.EOCSelection = DISABLE;
+	if (Trigger == ADC_SOFTWARE_START) {
+		/* Convert continuously */
+		AdcHandle.Init.ContinuousConvMode = ENABLE;
+		AdcHandle.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
+	} else {
+		/* One sequence on each trigger */
+		AdcHandle.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+	}
+	AdcHandle.Init.ExternalTrigConv = Trigger;
+	if (HAL_ADC_Init(&AdcHandle) != HAL_OK) {
+		return 2;
+	}
+	
+	/* Configure channels only once */
+	for (i = 0; i < count; i++) {
+		sConfig.Channel = (uint8_t) Channels[i];
+		sConfig.Rank = i + 1;
+		sConfig.SamplingTime = SamplingTimes ? SamplingTimes[i] : ADC_SAMPLETIME_15CYCLES;
+		sConfig.Offset = 0;
+		if (HAL_ADC_ConfigChannel(&AdcHandle, &sConfig) != HAL_OK) {
+			return 2;
+		}
+	}
+	
+	/* Save settings, conversions are not owned by watchdog anymore */
+	Scan->Buffer = Buffer;
+	Scan->Sequences = Sequences;
+	Scan->Count = count;
+	Scan->Monitor = 0;
+	
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(Scan->Stream, NULL);
+	Scan->Stream->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(Scan->Stream);
+	
+	/* Set DMA options */
+	DMA_InitStruct.Instance = Scan->Stream;
+	DMA_InitStruct.Init.Channel = Scan->Channel;
+	DMA_InitStruct.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	DMA_InitStruct.Init.PeriphInc = DMA_PINC_DISABLE;
+	DMA_InitStruct.Init.MemInc = DMA_MINC_ENABLE;
+	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	DMA_InitStruct.Init.Mode = DMA_CIRCULAR;
+	DMA_InitStruct.Init.Priority = DMA_PRIORITY_HIGH;
+	DMA_InitStruct.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	DMA_InitStruct.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DMA_InitStruct.Init.MemBurst = DMA_MBURST_SINGLE;
+	DMA_InitStruct.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(Scan->Stream, &DMA_InitStruct);
+	
+	/* Set library callback for stream and enable interrupts */
+	TM_DMA_SetStreamCallback(Scan->Stream, TM_ADC_INT_ScanStreamCallback, ADCx);
+	TM_DMA_EnableInterrupts(Scan->Stream);
+	
+	/* Start circular transfer to both halves of buffer */
+	TM_DMA_Start(&DMA_InitStruct, (uint32_t) &ADCx->DR, (uint32_t) Buffer, 2 * Sequences * count);
+	
+	/* Enable ADC DMA requests and start ADC */
+	ADCx->CR2 |= ADC_CR2_DMA | ADC_CR2_DDS;
+	if (HAL_ADC_Start(&AdcHandle) != HAL_OK) {
+		TM_ADC_StopScan(ADCx);
+		return 2;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_ADC_StopScan(ADC_TypeDef* ADCx) {
+	TM_ADC_INT_Scan_t* Scan = TM_ADC_INT_GetScan(ADCx);
+	
+	/* Check if scan is running */
+	if (Scan == NULL || Scan->Buffer == NULL) {
+		return;
+	}
+	
+	/* Stop ADC and DMA requests */
+	AdcHandle.Instance = ADCx;
+	HAL_ADC_Stop(&AdcHandle);
+	ADCx->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_DDS);
+	
+	/* Remove callback and deinit DMA stream */
+	TM_DMA_DisableInterrupts(Scan->Stream);
+	TM_DMA_SetStreamCallback(Scan->Stream, NULL, NULL);
+	TM_DMA_DeInit(Scan->Stream);
+	
+	/* Scan not active */
+	Scan->Buffer = NULL;
+}
+
+__weak void TM_ADC_ScanCallback(ADC_TypeDef* ADCx, uint16_t* Data, uint16_t Sequences) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_ADC_ScanCallback could be implemented in the user file
+	*/
+}
+#endif
+
+uint16_t TM_ADC_ReadAverage(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel, uint16_t count, uint8_t shift) {
+	ADC_ChannelConfTypeDef sConfig;
+	uint32_t sum = 0;
+	uint16_t i;
+	
+	/* Check parameters, result must fit to 16 bits */
+	if (count == 0) {
+		return 0;
+	}
+	if (shift > 4) {
+		shift = 4;
+	}
+	
+	/* Configure ADC regular channel only once */
+	sConfig.Channel = (uint8_t) channel;
+	sConfig.Rank = 1;
+#if defined(STM32F0xx)
+	sConfig.SamplingTime = ADC_SAMPLETIME_13CYCLES_5;
+#else
+	sConfig.SamplingTime = ADC_SAMPLETIME_15CYCLES;
+	sConfig.Offset = 0;
+#endif
+
+	/* Set handle */
+	AdcHandle.Instance = ADCx;
+	
+	/* Return zero */
+	if (HAL_ADC_ConfigChannel(&AdcHandle, &sConfig) != HAL_OK) {
+		return 0;
+	}
+	
+	/* Convert continuously */
+#if defined(STM32F0xx)
+	ADCx->CFGR1 |= ADC_CFGR1_CONT;
+#else
+	ADCx->CR2 |= ADC_CR2_CONT;
+#endif
+	
+	/* Start conversions */
+	if (HAL_ADC_Start(&AdcHandle) == HAL_OK) {
+		/* Sum samples, reading data clears end of conversion flag */
+		for (i = 0; i < count; i++) {
+			if (HAL_ADC_PollForConversion(&AdcHandle, 10) != HAL_OK) {
+				break;
+			}
+			sum += HAL_ADC_GetValue(&AdcHandle);
+		}
+		
+		/* Stop conversions */
+		HAL_ADC_Stop(&AdcHandle);
+	} else {
+		i = 0;
+	}
+	
+	/* Back to single conversion */
+#if defined(STM32F0xx)
+	ADCx->CFGR1 &= ~ADC_CFGR1_CONT;
+#else
+	ADCx->CR2 &= ~ADC_CR2_CONT;
+#endif
+	
+	/* Check if all samples were read */
+	if (i != count) {
+		return 0;
+	}
+	
+	/* Return rounded average with extra bits */
+	return (uint16_t)(((sum << shift) + count / 2) / count);
+}
+
+void TM_ADC_AverageBlock(const uint16_t* Data, uint16_t Sequences, uint8_t count, uint16_t* Result) {
+	uint32_t sum[16] = {0};
+	uint16_t s;
+	uint8_t i;
+	
+	/* Check parameters */
+	if (Sequences == 0 || count == 0 || count > 16) {
+		return;
+	}
+	
+	/* Sum samples in memory order, sequence after sequence */
+	for (s = 0; s < Sequences; s++) {
+		for (i = 0; i < count; i++) {
+			sum[i] += *Data++;
+		}
+	}
+	
+	/* Save rounded averages */
+	for (i = 0; i < count; i++) {
+		Result[i] = (uint16_t)((sum[i] + Sequences / 2) / Sequences);
+	}
+}
+
+#if !defined(STM32F0xx)
+uint8_t TM_ADC_StartWatchdog(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel, uint16_t Low, uint16_t High) {
+	TM_ADC_INT_Scan_t* Scan = TM_ADC_INT_GetScan(ADCx);
+	ADC_ChannelConfTypeDef sConfig;
+	
+	/* Check parameters */
+	if (Scan == NULL || (uint8_t)channel > 18 || Low > High || High > 0xFFF) {
+		return 1;
+	}
+	
+	/* Disable watchdog interrupt while settings are changed */
+	ADCx->CR1 &= ~ADC_CR1_AWDIE;
+	
+	/* Restart monitoring when other channel is selected */
+	if (Scan->Monitor && Scan->MonitorChannel != (uint8_t)channel) {
+		TM_ADC_StopWatchdog(ADCx);
+	}
+	
+	/* Start continuous conversion of channel when ADC is not already running */
+	if (Scan->Buffer == NULL && !Scan->Monitor) {
+		/* Init pin and ADC */
+		TM_ADC_INT_InitChannel(ADCx, channel);
+		TM_ADC_InitADC(ADCx);
+		AdcHandle.Init.ContinuousConvMode = ENABLE;
+		if (HAL_ADC_Init(&AdcHandle) != HAL_OK) {
+			return 2;
+		}
+		
+		/* Configure channel */
+		sConfig.Channel = (uint8_t) channel;
+		sConfig.Rank = 1;
+		sConfig.SamplingTime = ADC_SAMPLETIME_15CYCLES;
+		sConfig.Offset = 0;
+		if (HAL_ADC_ConfigChannel(&AdcHandle, &sConfig) != HAL_OK) {
+			return 2;
+		}
+		
+		/* Start conversions, no DMA is used */
+		if (HAL_ADC_Start(&AdcHandle) != HAL_OK) {
+			return 2;
+		}
+		
+		/* Conversions are owned by watchdog */
+		Scan->Monitor = 1;
+		Scan->MonitorChannel = (uint8_t)channel;
+	}
+	
+	/* Set thresholds */
+	ADCx->HTR = High;
+	ADCx->LTR = Low;
+	
+	/* Enable watchdog on single regular channel */
+	ADCx->CR1 = (ADCx->CR1 & ~ADC_CR1_AWDCH) | ADC_CR1_AWDEN | ADC_CR1_AWDSGL | ((uint8_t)channel & ADC_CR1_AWDCH);
+	
+	/* Enable ADC interrupt, shared between all ADCs */
+	HAL_NVIC_SetPriority(ADC_IRQn, ADC_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(ADC_IRQn);
+	
+	/* Clear old flag and enable watchdog interrupt */
+	ADCx->SR = ~ADC_SR_AWD;
+	ADCx->CR1 |= ADC_CR1_AWDIE;
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_ADC_StopWatchdog(ADC_TypeDef* ADCx) {
+	TM_ADC_INT_Scan_t* Scan = TM_ADC_INT_GetScan(ADCx);
+	
+	/* Check ADC */
+	if (Scan == NULL) {
+		return;
+	}
+	
+	/* Disable watchdog and clear flag */
+	ADCx->CR1 &= ~(ADC_CR1_AWDIE | ADC_CR1_AWDEN | ADC_CR1_AWDSGL | ADC_CR1_AWDCH);
+	ADCx->SR = ~ADC_SR_AWD;
+	
+	/* Stop conversions started by watchdog */
+	if (Scan->Monitor) {
+		AdcHandle.Instance = ADCx;
+		HAL_ADC_Stop(&AdcHandle);
+		ADCx->CR2 &= ~ADC_CR2_CONT;
+		Scan->Monitor = 0;
+	}
+}
+
+__weak void TM_ADC_WatchdogCallback(ADC_TypeDef* ADCx, uint16_t Value) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_ADC_WatchdogCallback could be implemented in the user file
+	*/
+}
+
+void ADC_IRQHandler(void) {
+	/* Check all ADCs */
+#if defined(ADC1)
+	TM_ADC_INT_WatchdogIRQ(ADC1);
+#endif
+#if defined(ADC2)
+	TM_ADC_INT_WatchdogIRQ(ADC2);
+#endif
+#if defined(ADC3)
+	TM_ADC_INT_WatchdogIRQ(ADC3);
+#endif
+}
+#endif
+
+#if !defined(STM32F0xx) && defined(ADC2)
+uint8_t TM_ADC_StartInterleaved(TM_ADC_Channel_t channel, uint8_t adcs, uint32_t SamplingTime, uint32_t Delay, uint32_t* Buffer, uint16_t Words) {
+	ADC_TypeDef* const Instances[3] = {
+		ADC1, ADC2,
+#if defined(ADC3)
+		ADC3
+#else
+		NULL
+#endif
+	};
+	ADC_ChannelConfTypeDef sConfig;
+	ADC_MultiModeTypeDef MultiMode;
+	DMA_HandleTypeDef DMA_InitStruct;
+	DMA_Stream_TypeDef* Stream = ADC1_Scan.Stream;
+	uint8_t i;
+	
+	/* Check parameters */
+	if (adcs < 2 || adcs > 3 || Instances[adcs - 1] == NULL || Words == 0 || Words > 0x7FFF) {
+		return 1;
+	}
+	
+	/* Stop previous sampling */
+	TM_ADC_StopInterleaved();
+	TM_ADC_StopScan(ADC1);
+	
+	/* Init pin */
+	TM_ADC_INT_InitChannel(ADC1, channel);
+	
+	/* Init each ADC with the same channel, continuous mode */
+	for (i = 0; i < adcs; i++) {
+		TM_ADC_InitADC(Instances[i]);
+		AdcInterleavedHandle[i] = AdcHandle;
+		AdcInterleavedHandle[i].Init.ContinuousConvMode = ENABLE;
+		if (HAL_ADC_Init(&AdcInterleavedHandle[i]) != HAL_OK) {
+			return 2;
+		}
+		
+		/* Configure channel */
+		sConfig.Channel = (uint8_t) channel;
+		sConfig.Rank = 1;
+		sConfig.SamplingTime = SamplingTime;
+		sConfig.Offset = 0;
+		if (HAL_ADC_ConfigChannel(&AdcInterleavedHandle[i], &sConfig) != HAL_OK) {
+			return 2;
+		}
+	}
+	
+	/* Configure multi mode, DMA mode 2 packs 2 samples to one word */
+	MultiMode.Mode = adcs == 2 ? ADC_DUALMODE_INTERL : ADC_TRIPLEMODE_INTERL;
+	MultiMode.DMAAccessMode = ADC_DMAACCESSMODE_2;
+	MultiMode.TwoSamplingDelay = Delay;
+	if (HAL_ADCEx_MultiModeConfigChannel(&AdcInterleavedHandle[0], &MultiMode) != HAL_OK) {
+		return 2;
+	}
+	
+	/* Save settings */
+	AdcInterleavedBuffer = Buffer;
+	AdcInterleavedWords = Words;
+	AdcInterleavedCount = adcs;
+	
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(Stream, NULL);
+	Stream->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(Stream);
+	
+	/* Set DMA options, word transfers from common data register */
+	DMA_InitStruct.Instance = Stream;
+	DMA_InitStruct.Init.Channel = ADC1_Scan.Channel;
+	DMA_InitStruct.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	DMA_InitStruct.Init.PeriphInc = DMA_PINC_DISABLE;
+	DMA_InitStruct.Init.MemInc = DMA_MINC_ENABLE;
+	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	DMA_InitStruct.Init.Mode = DMA_CIRCULAR;
+	DMA_InitStruct.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	DMA_InitStruct.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	DMA_InitStruct.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DMA_InitStruct.Init.MemBurst = DMA_MBURST_SINGLE;
+	DMA_InitStruct.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(Stream, &DMA_InitStruct);
+	
+	/* Set library callback for stream and enable interrupts */
+	TM_DMA_SetStreamCallback(Stream, TM_ADC_INT_InterleavedStreamCallback, NULL);
+	TM_DMA_EnableInterrupts(Stream);
+	
+	/* Start circular transfer to both halves of buffer */
+	TM_DMA_Start(&DMA_InitStruct, (uint32_t) &ADC->CDR, (uint32_t) Buffer, 2 * Words);
+	
+	/* Continuous DMA requests in multi mode */
+	ADC->CCR |= ADC_CCR_DDS;
+	
+	/* Enable slaves first, master starts conversions */
+	for (i = adcs; i > 0; i--) {
+		if (HAL_ADC_Start(&AdcInterleavedHandle[i - 1]) != HAL_OK) {
+			TM_ADC_StopInterleaved();
+			return 2;
+		}
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_ADC_StopInterleaved(void) {
+	uint8_t i;
+	
+	/* Check if running */
+	if (AdcInterleavedBuffer == NULL) {
+		return;
+	}
+	
+	/* Stop all ADCs */
+	for (i = 0; i < AdcInterleavedCount; i++) {
+		HAL_ADC_Stop(&AdcInterleavedHandle[i]);
+	}
+	
+	/* Back to independent mode */
+	ADC->CCR &= ~(ADC_CCR_MULTI | ADC_CCR_DMA | ADC_CCR_DDS);
+	
+	/* Remove callback and deinit DMA stream */
+	TM_DMA_DisableInterrupts(ADC1_Scan.Stream);
+	TM_DMA_SetStreamCallback(ADC1_Scan.Stream, NULL, NULL);
+	TM_DMA_DeInit(ADC1_Scan.Stream);
+	
+	/* Not active */
+	AdcInterleavedBuffer = NULL;
+}
+
+__weak void TM_ADC_InterleavedCallback(uint32_t* Data, uint16_t Words) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_ADC_InterleavedCallback could be implemented in the user file
+	*/
+}
+#endif
+
 /* Private functions */
+#if !defined(STM32F0xx)
+static TM_ADC_INT_Scan_t* TM_ADC_INT_GetScan(ADC_TypeDef* ADCx) {
+#if defined(ADC1)
+	if (ADCx == ADC1) {
+		return &ADC1_Scan;
+	}
+#endif
+#if defined(ADC2)
+	if (ADCx == ADC2) {
+		return &ADC2_Scan;
+	}
+#endif
+#if defined(ADC3)
+	if (ADCx == ADC3) {
+		return &ADC3_Scan;
+	}
+#endif
+	
+	/* Return invalid */
+	return NULL;
+}
+
+static void TM_ADC_INT_ScanStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	ADC_TypeDef* ADCx = (ADC_TypeDef *)Param;
+	TM_ADC_INT_Scan_t* Scan = TM_ADC_INT_GetScan(ADCx);
+	
+	/* Check if scan is active */
+	if (Scan == NULL || Scan->Buffer == NULL) {
+		return;
+	}
+	
+	/* First half is ready */
+	if (flags & DMA_FLAG_HTIF) {
+		TM_ADC_ScanCallback(ADCx, Scan->Buffer, Scan->Sequences);
+	}
+	
+	/* Second half is ready */
+	if (flags & DMA_FLAG_TCIF) {
+		TM_ADC_ScanCallback(ADCx, &Scan->Buffer[Scan->Sequences * Scan->Count], Scan->Sequences);
+	}
+}
+
+static void TM_ADC_INT_WatchdogIRQ(ADC_TypeDef* ADCx) {
+	/* Check if watchdog is armed and triggered */
+	if (!(ADCx->CR1 & ADC_CR1_AWDIE) || !(ADCx->SR & ADC_SR_AWD)) {
+		return;
+	}
+	
+	/* Disable interrupt until armed again, it would trigger on each conversion outside of window */
+	ADCx->CR1 &= ~ADC_CR1_AWDIE;
+	ADCx->SR = ~ADC_SR_AWD;
+	
+	/* Call user function */
+	TM_ADC_WatchdogCallback(ADCx, (uint16_t)ADCx->DR);
+}
+#endif
+
+#if !defined(STM32F0xx) && defined(ADC2)
+static void TM_ADC_INT_InterleavedStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	/* Check if active */
+	if (AdcInterleavedBuffer == NULL) {
+		return;
+	}
+	
+	/* First half is ready */
+	if (flags & DMA_FLAG_HTIF) {
+		TM_ADC_InterleavedCallback(AdcInterleavedBuffer, AdcInterleavedWords);
+	}
+	
+	/* Second half is ready */
+	if (flags & DMA_FLAG_TCIF) {
+		TM_ADC_InterleavedCallback(&AdcInterleavedBuffer[AdcInterleavedWords], AdcInterleavedWords);
+	}
+}
+#endif
+
 static void TM_ADC_INT_Channel_0_Init(ADC_TypeDef* ADCx) {
 	TM_ADC_INT_InitPin(GPIOA, GPIO_PIN_0);
 }
@@ -340,6 +887,43 @@ static void TM_ADC_INT_Channel_15_Init(ADC_TypeDef* ADCx) {
 #endif
 }
 
+static void TM_ADC_INT_InitChannel(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel) {
+	TM_ADC_Channel_t ch = (TM_ADC_Channel_t) channel;
+	if (ch == TM_ADC_Channel_0) {
+		TM_ADC_INT_Channel_0_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_1) {
+		TM_ADC_INT_Channel_1_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_2) {
+		TM_ADC_INT_Channel_2_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_3) {
+		TM_ADC_INT_Channel_3_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_4) {
+		TM_ADC_INT_Channel_4_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_5) {
+		TM_ADC_INT_Channel_5_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_6) {
+		TM_ADC_INT_Channel_6_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_7) {
+		TM_ADC_INT_Channel_7_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_8) {
+		TM_ADC_INT_Channel_8_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_9) {
+		TM_ADC_INT_Channel_9_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_10) {
+		TM_ADC_INT_Channel_10_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_11) {
+		TM_ADC_INT_Channel_11_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_12) {
+		TM_ADC_INT_Channel_12_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_13) {
+		TM_ADC_INT_Channel_13_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_14) {
+		TM_ADC_INT_Channel_14_Init(ADCx);
+	} else if (ch == TM_ADC_Channel_15) {
+		TM_ADC_INT_Channel_15_Init(ADCx);
+	}
+}
+
 static void TM_ADC_INT_InitPin(GPIO_TypeDef* GPIOx, uint16_t PinX) {
 	/* Enable GPIO pin */
 	TM_GPIO_Init(GPIOx, PinX, TM_GPIO_Mode_AN, TM_GPIO_OType_PP, TM_GPIO_PuPd_DOWN, TM_GPIO_Speed_Medium);
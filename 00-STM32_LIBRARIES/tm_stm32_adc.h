@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/10/hal-library-29-analog-to-digital-converter-for-stm32fxxx/
- * @version v1.0
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   ADC library for STM32Fxxx
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_ADC_H
-#define TM_ADC_H 100
+#define TM_ADC_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -84,11 +84,105 @@ CHANNEL   ADC1   ADC2   ADC3
  * Circuit for battery is integrated inside STM32 device.
  * It can measure a battery, connected to VBAT pin, meant for RTC and backup purpose only.
  *
+ * \par Scan mode with DMA
+ *
+ * For continuous sampling of more channels, use @ref TM_ADC_StartScan function. It is available on STM32F4xx and STM32F7xx devices.
+ * Channels are configured only once, then ADC converts whole sequence of channels on each trigger
+ * and DMA stores results to user buffer in circular mode. No CPU is needed per sample.
+ *
+ * Buffer is split in 2 halves. When one half is filled, @ref TM_ADC_ScanCallback is called with pointer to that half,
+ * while DMA writes to the other one. Samples in buffer are interleaved, sequence after sequence:
+ *
+\verbatim
+ ch0, ch1, ..., chN, ch0, ch1, ..., chN, ...
+\endverbatim
+ *
+ * For fixed sample rate, use timer trigger, for example ADC_EXTERNALTRIGCONV_T2_TRGO.
+ * Timer must be configured by user to output TRGO on update event at desired sample rate.
+ * With ADC_SOFTWARE_START, ADC converts continuously as fast as sampling times allow.
+ *
+ * Default DMA streams and channels are below. You can change them in defines.h file:
+ *
+\code
+//ADC1 DMA settings
+#define ADC1_DMA_STREAM        DMA2_Stream0
+#define ADC1_DMA_CHANNEL       DMA_CHANNEL_0
+//ADC2 DMA settings
+#define ADC2_DMA_STREAM        DMA2_Stream2
+#define ADC2_DMA_CHANNEL       DMA_CHANNEL_1
+//ADC3 DMA settings
+#define ADC3_DMA_STREAM        DMA2_Stream1
+#define ADC3_DMA_CHANNEL       DMA_CHANNEL_2
+\endcode
+ *
+ * \note  Scan mode uses TM DMA library to handle stream interrupts
+ *
+ * \par Interleaved mode
+ *
+ * On devices with more ADCs, 2 or 3 ADCs can sample the same channel one after another with @ref TM_ADC_StartInterleaved.
+ * ADC1 is master and ADC2 (and ADC3) are slaves, conversions are shifted for selected delay,
+ * so sample rate is 2 or 3 times higher than with one ADC.
+ *
+ * Common ADC data register is read by ADC1 DMA stream, each 32-bit word holds 2 samples.
+ * Lower half-word is older sample, so buffer can be also used as array of 16-bit samples in time order,
+ * for example with @ref TM_FFT_StreamAddADC_F32 function.
+ *
+ * @ref TM_ADC_InterleavedCallback is called for each filled half of buffer.
+ *
+ * \note  ADC1 DMA stream and channel settings are used for interleaved mode
+ *
+ * \par Averaging and decimation
+ *
+ * STM32F0xx, STM32F4xx and STM32F7xx ADCs don't have hardware oversampling unit.
+ * @ref TM_ADC_ReadAverage configures channel once and averages samples of continuous conversion,
+ * which is much faster than calling @ref TM_ADC_Read in a loop. Averaging of 4^n samples adds n bits of resolution,
+ * use shift parameter to get result with more than 12 bits.
+ *
+ * In scan mode, @ref TM_ADC_AverageBlock decimates filled half of buffer to one averaged value per channel.
+ * Call it from @ref TM_ADC_ScanCallback, so processing is done once per half buffer instead of once per sample.
+ *
+ * \par Analog watchdog
+ *
+ * Analog watchdog compares each conversion of selected channel with low and high threshold in hardware.
+ * When value is outside of window, @ref TM_ADC_WatchdogCallback is called from ADC interrupt.
+ * While signal stays inside thresholds, no interrupt and no DMA transfer is needed.
+ *
+ * When scan is running on ADCx, @ref TM_ADC_StartWatchdog only arms watchdog on channel of sequence.
+ * Otherwise it starts continuous conversion of channel without DMA.
+ *
+ * After callback is called, watchdog interrupt is disabled to prevent interrupt on each conversion.
+ * Call @ref TM_ADC_StartWatchdog again, for example with hysteresis thresholds, to arm it again.
+ *
+\code
+//Start monitoring of battery voltage on channel 0
+TM_ADC_StartWatchdog(ADC1, TM_ADC_Channel_0, 2000, 4095);
+
+//Called when value drops below 2000
+void TM_ADC_WatchdogCallback(ADC_TypeDef* ADCx, uint16_t Value) {
+	//Arm again with hysteresis, to get notification when voltage is back
+	TM_ADC_StartWatchdog(ADC1, TM_ADC_Channel_0, 0, 2200);
+}
+\endcode
+ *
+ * \note  Analog watchdog is available on STM32F4xx and STM32F7xx devices
+ *
  * \par Changelog
  *
 @verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added scan mode for multiple channels with circular DMA double buffering
+  
+ Version 1.2
+  - October 14, 2026
+  - Added dual and triple interleaved mode with packed 32-bit samples
+  
+ Version 1.3
+  - October 14, 2026
+  - Added averaged read, scan block decimation and analog watchdog with interrupt
 @endverbatim
  *
  * \par Dependencies
@@ -97,11 +191,15 @@ CHANNEL   ADC1   ADC2   ADC3
  - STM32Fxxx HAL
  - defines.h
  - TM GPIO
+ - TM DMA, STM32F4xx and STM32F7xx only
 @endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_gpio.h"
+#if !defined(STM32F0xx)
+#include "tm_stm32_dma.h"
+#endif
 
 /**
  * @defgroup TM_ADC_Macros
@@ -125,6 +223,27 @@ CHANNEL   ADC1   ADC2   ADC3
 #define ADC_VBAT_MULTI			4
 #endif
 
+/* DMA settings for scan mode */
+#ifndef ADC1_DMA_STREAM
+#define ADC1_DMA_STREAM         DMA2_Stream0
+#define ADC1_DMA_CHANNEL        DMA_CHANNEL_0
+#endif
+#ifndef ADC2_DMA_STREAM
+#define ADC2_DMA_STREAM         DMA2_Stream2
+#define ADC2_DMA_CHANNEL        DMA_CHANNEL_1
+#endif
+#ifndef ADC3_DMA_STREAM
+#define ADC3_DMA_STREAM         DMA2_Stream1
+#define ADC3_DMA_CHANNEL        DMA_CHANNEL_2
+#endif
+
+/**
+ * @brief  NVIC priority for ADC analog watchdog interrupt
+ */
+#ifndef ADC_NVIC_PRIORITY
+#define ADC_NVIC_PRIORITY       NVIC_PRIORITY_NORMAL
+#endif
+
 /**
  * @}
  */
@@ -214,6 +333,126 @@ void TM_ADC_DisableVbat(void);
  */
 uint16_t TM_ADC_ReadVbat(ADC_TypeDef* ADCx);
 
+/**
+ * @brief  Starts scan of multiple channels with circular DMA to double buffer
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  *ADCx: ADCx peripheral to operate with
+ * @param  *Channels: Pointer to array of channels in scan order. Array members are values of @ref TM_ADC_Channel_t enumeration
+ * @param  *SamplingTimes: Pointer to array of sampling times for each channel, ADC_SAMPLETIME_xCYCLES values. Set to NULL for default 15 cycles
+ * @param  count: Number of channels in sequence, up to 16
+ * @param  *Buffer: Pointer to buffer for results. Its length must be 2 * Sequences * count
+ * @param  Sequences: Number of channel sequences in one half of buffer
+ * @param  Trigger: ADC_EXTERNALTRIGCONV_xxx trigger for each sequence or ADC_SOFTWARE_START for continuous conversion
+ * @retval Start status:
+ *            - 0: Scan started
+ *            - > 0: Invalid parameters or HAL error
+ */
+uint8_t TM_ADC_StartScan(ADC_TypeDef* ADCx, const TM_ADC_Channel_t* Channels, const uint32_t* SamplingTimes, uint8_t count, uint16_t* Buffer, uint16_t Sequences, uint32_t Trigger);
+
+/**
+ * @brief  Stops scan started with @ref TM_ADC_StartScan
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  *ADCx: ADCx peripheral to operate with
+ * @retval None
+ */
+void TM_ADC_StopScan(ADC_TypeDef* ADCx);
+
+/**
+ * @brief  Called when one half of scan buffer is filled
+ * @note   Called from DMA interrupt, DMA is filling other half of buffer meanwhile
+ * @param  *ADCx: ADCx peripheral where scan is running
+ * @param  *Data: Pointer to filled half of buffer
+ * @param  Sequences: Number of channel sequences in filled half
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_ADC_ScanCallback(ADC_TypeDef* ADCx, uint16_t* Data, uint16_t Sequences);
+
+/**
+ * @brief  Starts interleaved sampling of one channel with 2 or 3 ADCs and circular DMA to double buffer
+ * @note   Available on STM32F4xx and STM32F7xx devices with more ADCs
+ * @param  channel: Channel to sample. This parameter can be a value of @ref TM_ADC_Channel_t enumeration
+ * @param  adcs: Number of ADCs used, 2 for dual or 3 for triple interleaved mode
+ * @param  SamplingTime: Sampling time for channel, ADC_SAMPLETIME_xCYCLES value
+ * @param  Delay: Delay between sampling of consecutive ADCs, ADC_TWOSAMPLINGDELAY_xCYCLES value
+ * @param  *Buffer: Pointer to buffer for packed samples, 2 samples in each word. Its length must be 2 * Words
+ * @param  Words: Number of 32-bit words in one half of buffer
+ * @retval Start status:
+ *            - 0: Sampling started
+ *            - > 0: Invalid parameters or HAL error
+ */
+uint8_t TM_ADC_StartInterleaved(TM_ADC_Channel_t channel, uint8_t adcs, uint32_t SamplingTime, uint32_t Delay, uint32_t* Buffer, uint16_t Words);
+
+/**
+ * @brief  Stops interleaved sampling started with @ref TM_ADC_StartInterleaved
+ * @param  None
+ * @retval None
+ */
+void TM_ADC_StopInterleaved(void);
+
+/**
+ * @brief  Called when one half of interleaved buffer is filled
+ * @note   Called from DMA interrupt, DMA is filling other half of buffer meanwhile
+ * @param  *Data: Pointer to filled half of buffer
+ * @param  Words: Number of 32-bit words in filled half, each word holds 2 samples
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_ADC_InterleavedCallback(uint32_t* Data, uint16_t Words);
+
+/**
+ * @brief  Reads average of more samples from ADCx channel
+ * @note   Channel is configured once, then samples of continuous conversion are summed
+ * @param  *ADCx: ADCx peripheral to operate with
+ * @param  channel: channel for ADCx to read from. This parameter can be a value of @ref TM_ADC_Channel_t enumeration
+ * @param  count: Number of samples to average, 1 to 65535
+ * @param  shift: Number of extra result bits. Use 0 for 12-bit result, n for 12 + n bit result when 4^n samples are averaged
+ * @retval Averaged ADC value
+ */
+uint16_t TM_ADC_ReadAverage(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel, uint16_t count, uint8_t shift);
+
+/**
+ * @brief  Averages block of scan samples to one value per channel
+ * @note   Use it in @ref TM_ADC_ScanCallback with parameters got from callback
+ * @param  *Data: Pointer to interleaved samples, sequence after sequence
+ * @param  Sequences: Number of sequences in block
+ * @param  count: Number of channels in one sequence
+ * @param  *Result: Pointer to array with count elements to save averages to
+ * @retval None
+ */
+void TM_ADC_AverageBlock(const uint16_t* Data, uint16_t Sequences, uint8_t count, uint16_t* Result);
+
+/**
+ * @brief  Starts or arms analog watchdog on ADCx channel
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  *ADCx: ADCx peripheral to operate with
+ * @param  channel: channel for ADCx to monitor. This parameter can be a value of @ref TM_ADC_Channel_t enumeration
+ * @param  Low: Low threshold, 12-bit value
+ * @param  High: High threshold, 12-bit value
+ * @retval Start status:
+ *            - 0: Watchdog armed
+ *            - > 0: Invalid parameters or HAL error
+ */
+uint8_t TM_ADC_StartWatchdog(ADC_TypeDef* ADCx, TM_ADC_Channel_t channel, uint16_t Low, uint16_t High);
+
+/**
+ * @brief  Stops analog watchdog started with @ref TM_ADC_StartWatchdog
+ * @note   Conversions are stopped too, when they were started by watchdog
+ * @param  *ADCx: ADCx peripheral to operate with
+ * @retval None
+ */
+void TM_ADC_StopWatchdog(ADC_TypeDef* ADCx);
+
+/**
+ * @brief  Called when converted value is outside of watchdog thresholds
+ * @note   Called from ADC interrupt, watchdog interrupt is disabled before call
+ * @param  *ADCx: ADCx peripheral where watchdog triggered
+ * @param  Value: Last converted value. When scan is running, it may already belong to next channel of sequence
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_ADC_WatchdogCallback(ADC_TypeDef* ADCx, uint16_t Value);
+
 /**
  * @}
  */
@@ -20,6 +20,21 @@
 
 /* Private functions */
 static TM_AM2301_Result_t TM_AM2301_INT_Read(TM_AM2301_t* data);
+static TM_AM2301_Result_t TM_AM2301_INT_Decode(TM_AM2301_t* data, uint8_t* d);
+#if !defined(STM32F0xx)
+static void TM_AM2301_INT_TimerCallback(TM_DELAY_Timer_t* Timer, void* UserParameters);
+static void TM_AM2301_INT_StartCapture(TM_AM2301_t* data);
+static TM_AM2301_Result_t TM_AM2301_INT_StopCapture(TM_AM2301_t* data);
+
+/* Asynchronous read states */
+#define AM2301_STATE_IDLE       0
+#define AM2301_STATE_START      1
+#define AM2301_STATE_CAPTURE    2
+
+/* Start pulse and frame timeout in milliseconds, software timer has 1ms resolution */
+#define AM2301_START_TIME       2
+#define AM2301_CAPTURE_TIME     8
+#endif
 
 /* Private defines */
 #define AM2301_PIN_LOW(str)     TM_GPIO_SetPinLow((str)->GPIOx, (str)->GPIO_Pin)
@@ -38,16 +53,146 @@ TM_AM2301_Result_t TM_AM2301_Init(TM_AM2301_t* AMStruct, GPIO_TypeDef* GPIOx, ui
 	/* Save settings */
 	AMStruct->GPIOx = GPIOx;
 	AMStruct->GPIO_Pin = GPIO_Pin;
+#if !defined(STM32F0xx)
+	AMStruct->TIMx = NULL;
+#endif
 	
 	/* Return OK */
 	return TM_AM2301_Result_Ok;
 }
 
+#if !defined(STM32F0xx)
+TM_AM2301_Result_t TM_AM2301_InitCapture(TM_AM2301_t* AMStruct, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint8_t AF, TIM_TypeDef* TIMx, uint8_t Channel, DMA_Stream_TypeDef* DMA_Stream, uint32_t DMA_Channel) {
+	uint32_t clock;
+	
+	/* Check channel */
+	if (Channel < 1 || Channel > 4) {
+		return TM_AM2301_Result_Error;
+	}
+	
+	/* Enable timer clock */
+	if (TIMx == TIM2) {
+		__HAL_RCC_TIM2_CLK_ENABLE();
+	} else if (TIMx == TIM3) {
+		__HAL_RCC_TIM3_CLK_ENABLE();
+	} else if (TIMx == TIM4) {
+		__HAL_RCC_TIM4_CLK_ENABLE();
+	} else if (TIMx == TIM5) {
+		__HAL_RCC_TIM5_CLK_ENABLE();
+	} else {
+		return TM_AM2301_Result_Error;
+	}
+	
+	/* Allocate stopped software timer */
+	AMStruct->Timer = TM_DELAY_TimerCreate(AM2301_START_TIME, 0, 0, TM_AM2301_INT_TimerCallback, AMStruct);
+	if (AMStruct->Timer == NULL) {
+		return TM_AM2301_Result_Error;
+	}
+	
+	/* Initialize as in polling mode */
+	TM_AM2301_Init(AMStruct, GPIOx, GPIO_Pin);
+	
+	/* Save settings */
+	AMStruct->TIMx = TIMx;
+	AMStruct->Channel = Channel;
+	AMStruct->AF = AF;
+	AMStruct->DMA_Stream = DMA_Stream;
+	AMStruct->DMA_Channel = DMA_Channel;
+	AMStruct->State = AM2301_STATE_IDLE;
+	
+	/* APB1 timer clock is twice PCLK1 when APB1 prescaler is not 1 */
+	clock = HAL_RCC_GetPCLK1Freq();
+	if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+		clock *= 2;
+	}
+	
+	/* Free running timer at 1MHz */
+	TIMx->CR1 = 0;
+	TIMx->PSC = clock / 1000000 - 1;
+	TIMx->ARR = 0xFFFF;
+	TIMx->EGR = TIM_EGR_UG;
+	
+	/* Channel as input on TIx with filter, capture on both edges */
+	if (Channel <= 2) {
+		TIMx->CCMR1 = (TIMx->CCMR1 & ~(0xFF << (8 * (Channel - 1)))) | ((TIM_CCMR1_CC1S_0 | TIM_CCMR1_IC1F_1) << (8 * (Channel - 1)));
+	} else {
+		TIMx->CCMR2 = (TIMx->CCMR2 & ~(0xFF << (8 * (Channel - 3)))) | ((TIM_CCMR2_CC3S_0 | TIM_CCMR2_IC3F_1) << (8 * (Channel - 3)));
+	}
+	TIMx->CCER |= (TIM_CCER_CC1P | TIM_CCER_CC1NP) << (4 * (Channel - 1));
+	
+	/* Enable DMA clock */
+	TM_DMA_Init(DMA_Stream, NULL);
+	
+	/* Return OK */
+	return TM_AM2301_Result_Ok;
+}
+
+TM_AM2301_Result_t TM_AM2301_StartRead(TM_AM2301_t* AMStruct) {
+	/* Check mode */
+	if (AMStruct->TIMx == NULL) {
+		return TM_AM2301_Result_Error;
+	}
+	
+	/* Check if busy */
+	if (AMStruct->State != AM2301_STATE_IDLE) {
+		return TM_AM2301_Result_BUSY;
+	}
+	
+	/* Start pulse, set pin low for ~1-2 ms */
+	AMStruct->State = AM2301_STATE_START;
+	TM_GPIO_Init(AMStruct->GPIOx, AMStruct->GPIO_Pin, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium);
+	AM2301_PIN_LOW(AMStruct);
+	
+	/* Release line in software timer */
+	TM_DELAY_TimerAutoReloadValue(AMStruct->Timer, AM2301_START_TIME);
+	TM_DELAY_TimerReset(AMStruct->Timer);
+	TM_DELAY_TimerStart(AMStruct->Timer);
+	
+	/* Return OK */
+	return TM_AM2301_Result_Ok;
+}
+
+uint8_t TM_AM2301_Busy(TM_AM2301_t* AMStruct) {
+	/* Return status */
+	return AMStruct->State != AM2301_STATE_IDLE;
+}
+
+__weak void TM_AM2301_ReadCallback(TM_AM2301_t* AMStruct, TM_AM2301_Result_t result) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_AM2301_ReadCallback could be implemented in the user file
+	*/
+}
+#endif
+
 TM_AM2301_Result_t TM_AM2301_Read(TM_AM2301_t* AMStruct) {
 	/* Read data */
 	return TM_AM2301_INT_Read(AMStruct);
 }
 
+#if AM2301_USE_SERIES
+TM_AM2301_Result_t TM_AM2301_ReadSeries(TM_AM2301_t* AMStruct, TM_SERIES_t* Series, uint16_t Row, uint8_t Channel) {
+	TM_AM2301_Result_t result;
+	
+	/* Check channels */
+	if ((uint16_t)Channel + 2 > Series->ChannelCount) {
+		return TM_AM2301_Result_Error;
+	}
+	
+	/* Read data */
+	result = TM_AM2301_INT_Read(AMStruct);
+	if (result != TM_AM2301_Result_Ok) {
+		return result;
+	}
+	
+	/* Save as tenths */
+	TM_SERIES_SET(Series, Row, Channel, AMStruct->Temp);
+	TM_SERIES_SET(Series, Row, Channel + 1, (int16_t)AMStruct->Hum);
+	
+	/* Return OK */
+	return TM_AM2301_Result_Ok;
+}
+#endif
+
 /* Internal function */
 TM_AM2301_Result_t TM_AM2301_INT_Read(TM_AM2301_t* data) {
 	volatile uint32_t time;
@@ -139,6 +284,11 @@ TM_AM2301_Result_t TM_AM2301_INT_Read(TM_AM2301_t* data) {
 		}
 	}
 	
+	/* Decode data */
+	return TM_AM2301_INT_Decode(data, d);
+}
+
+static TM_AM2301_Result_t TM_AM2301_INT_Decode(TM_AM2301_t* data, uint8_t* d) {
 	/* Check for parity */
 	if (((d[0] + d[1] + d[2] + d[3]) & 0xFF) != d[4]) {
 		/* Parity error, data not valid */
@@ -158,3 +308,101 @@ TM_AM2301_Result_t TM_AM2301_INT_Read(TM_AM2301_t* data) {
 	return TM_AM2301_Result_Ok;
 }
 
+#if !defined(STM32F0xx)
+static void TM_AM2301_INT_StartCapture(TM_AM2301_t* data) {
+	DMA_HandleTypeDef DMA_InitStruct;
+	TIM_TypeDef* TIMx = data->TIMx;
+	
+	/* Disable stream and clear flags */
+	data->DMA_Stream->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(data->DMA_Stream);
+	
+	/* Capture register to edges buffer */
+	DMA_InitStruct.Instance = data->DMA_Stream;
+	DMA_InitStruct.Init.Channel = data->DMA_Channel;
+	DMA_InitStruct.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	DMA_InitStruct.Init.PeriphInc = DMA_PINC_DISABLE;
+	DMA_InitStruct.Init.MemInc = DMA_MINC_ENABLE;
+	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	DMA_InitStruct.Init.Mode = DMA_NORMAL;
+	DMA_InitStruct.Init.Priority = DMA_PRIORITY_HIGH;
+	DMA_InitStruct.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	DMA_InitStruct.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DMA_InitStruct.Init.MemBurst = DMA_MBURST_SINGLE;
+	DMA_InitStruct.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init and start DMA without interrupts */
+	TM_DMA_Init(data->DMA_Stream, &DMA_InitStruct);
+	TM_DMA_Start(&DMA_InitStruct, (uint32_t)(&TIMx->CCR1 + (data->Channel - 1)), (uint32_t)data->Edges, AM2301_CAPTURE_EDGES);
+	
+	/* Enable capture with DMA request */
+	TIMx->SR = 0;
+	TIMx->DIER |= TIM_DIER_CC1DE << (data->Channel - 1);
+	TIMx->CCER |= TIM_CCER_CC1E << (4 * (data->Channel - 1));
+	TIMx->CR1 |= TIM_CR1_CEN;
+	
+	/* Release line, pin is now timer input */
+	TM_GPIO_InitAlternate(data->GPIOx, data->GPIO_Pin, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, data->AF);
+}
+
+static TM_AM2301_Result_t TM_AM2301_INT_StopCapture(TM_AM2301_t* data) {
+	TIM_TypeDef* TIMx = data->TIMx;
+	uint16_t count, last, i;
+	uint8_t d[5] = {0, 0, 0, 0, 0};
+	uint8_t bit;
+	
+	/* Stop capture and DMA */
+	TIMx->CCER &= ~(TIM_CCER_CC1E << (4 * (data->Channel - 1)));
+	TIMx->DIER &= ~(TIM_DIER_CC1DE << (data->Channel - 1));
+	TIMx->CR1 &= ~TIM_CR1_CEN;
+	data->DMA_Stream->CR &= ~DMA_SxCR_EN;
+	while (data->DMA_Stream->CR & DMA_SxCR_EN);
+	
+	/* Back to input in polling mode */
+	TM_GPIO_Init(data->GPIOx, data->GPIO_Pin, TM_GPIO_Mode_IN, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium);
+	
+	/* Get number of captured edges */
+	count = AM2301_CAPTURE_EDGES - data->DMA_Stream->NDTR;
+	
+	/* Check for response and 40 bits with 2 edges each */
+	if (count < 2) {
+		return TM_AM2301_Result_CONNECTION_ERROR;
+	}
+	if (count < 83) {
+		return TM_AM2301_Result_WAITLOW_LOOP_ERROR;
+	}
+	
+	/* Last edge is release after last bit, bits are decoded backwards from it */
+	/* High pulse is 26us for 0 and 70us for 1 */
+	last = count - 1;
+	for (i = 0; i < 40; i++) {
+		bit = 39 - i;
+		if ((uint16_t)(data->Edges[last - 1 - 2 * i] - data->Edges[last - 2 - 2 * i]) > 48) {
+			d[bit / 8] |= 1 << (7 - (bit % 8));
+		}
+	}
+	
+	/* Decode data */
+	return TM_AM2301_INT_Decode(data, d);
+}
+
+static void TM_AM2301_INT_TimerCallback(TM_DELAY_Timer_t* Timer, void* UserParameters) {
+	TM_AM2301_t* data = (TM_AM2301_t *)UserParameters;
+	
+	if (data->State == AM2301_STATE_START) {
+		/* Start pulse done, capture whole frame */
+		data->State = AM2301_STATE_CAPTURE;
+		TM_AM2301_INT_StartCapture(data);
+		
+		/* Frame is max ~5ms long */
+		TM_DELAY_TimerAutoReloadValue(Timer, AM2301_CAPTURE_TIME);
+		TM_DELAY_TimerReset(Timer);
+		TM_DELAY_TimerStart(Timer);
+	} else if (data->State == AM2301_STATE_CAPTURE) {
+		/* Frame done */
+		data->State = AM2301_STATE_IDLE;
+		TM_AM2301_ReadCallback(data, TM_AM2301_INT_StopCapture(data));
+	}
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   Basic library for AM2301 (DHT21) temperature and humidity sensor
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_AM2301_H
-#define TM_AM2301_H 100
+#define TM_AM2301_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -71,11 +71,41 @@ DATA    User selected  Data line
  *
  * @note This values are also returned from my library, you have to manually convert them (divide by 10) if needed.
  *
+ * \par Input capture mode
+ *
+ * On STM32F4xx and STM32F7xx, sensor can be read asynchronously. Data pin must be connected to channel 1 to 4
+ * of TIM2, TIM3, TIM4 or TIM5. Timer captures both edges of data signal at 1MHz and DMA saves all edges into buffer,
+ * which is decoded after frame ends. CPU is not used during read and interrupts are not blocked.
+ *
+ * Start pulse and frame timeout are generated with @ref TM_DELAY software timer. Use @ref TM_AM2301_InitCapture
+ * instead of @ref TM_AM2301_Init, start read with @ref TM_AM2301_StartRead and wait for @ref TM_AM2301_ReadCallback.
+ *
+\code
+//Data pin PB4 = TIM3_CH1, DMA1 Stream 4 Channel 5
+TM_AM2301_InitCapture(&AM2301, GPIOB, GPIO_PIN_4, GPIO_AF2_TIM3, TIM3, 1, DMA1_Stream4, DMA_CHANNEL_5);
+TM_AM2301_StartRead(&AM2301);
+\endcode
+ *
+ * \note  Each sensor needs own timer channel and DMA stream. Callback is called from SysTick interrupt
+ *
+ * \par Series store
+ *
+ * With AM2301_USE_SERIES set to 1 in defines.h file, @ref TM_AM2301_ReadSeries writes temperature and humidity
+ * to 2 consecutive channels of @ref TM_SERIES store. Use scale 10 for both channels.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added asynchronous read with timer input capture and DMA for STM32F4xx and STM32F7xx
+  
+ Version 1.2
+  - October 14, 2026
+  - Added TM_AM2301_ReadSeries function for TM SERIES store
 \endverbatim
  *
  * \par Dependencies
@@ -85,12 +115,26 @@ DATA    User selected  Data line
  - defines.h
  - TM DELAY
  - TM GPIO
+ - TM DMA, STM32F4xx and STM32F7xx only
+ - TM SERIES, when AM2301_USE_SERIES is enabled
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_delay.h"
 #include "tm_stm32_gpio.h"
+#if !defined(STM32F0xx)
+#include "tm_stm32_dma.h"
+#endif
+
+/* Series store support */
+#ifndef AM2301_USE_SERIES
+#define AM2301_USE_SERIES		0
+#endif
+
+#if AM2301_USE_SERIES
+#include "tm_stm32_series.h"
+#endif
 
 /**
  * @defgroup TM_AM2301_Macros
@@ -106,6 +150,14 @@ DATA    User selected  Data line
 #define AM2301_PIN				GPIO_PIN_1
 #endif
 
+/**
+ * @brief  Number of edges saved in input capture mode
+ * @note   Frame has 83 edges after start pulse, including release edge at the end
+ */
+#ifndef AM2301_CAPTURE_EDGES
+#define AM2301_CAPTURE_EDGES	90
+#endif
+
 /**
  * @}
  */
@@ -130,7 +182,8 @@ typedef enum {
 	TM_AM2301_Result_WAITLOW_ERROR,       /*!< Wait low pulse timeout */
 	TM_AM2301_Result_WAITHIGH_LOOP_ERROR, /*!< Loop error for high pulse */
  	TM_AM2301_Result_WAITLOW_LOOP_ERROR,  /*!< Loop error for low pulse */
-	TM_AM2301_Result_PARITY_ERROR         /*!< Data read fail */
+	TM_AM2301_Result_PARITY_ERROR,        /*!< Data read fail */
+	TM_AM2301_Result_BUSY                 /*!< Asynchronous read is already in progress */
 } TM_AM2301_Result_t;
 
 /**
@@ -143,6 +196,16 @@ typedef struct {
 	                          If real humidity is 55.5%, this variable's value is 555 */
 	GPIO_TypeDef* GPIOx; /*!< Pointer to GPIOx PORT where pin for sensor is located */
 	uint16_t GPIO_Pin;   /*!< GPIO pin used for sensor */
+#if !defined(STM32F0xx)
+	TIM_TypeDef* TIMx;              /*!< Timer for input capture mode, NULL when not used */
+	DMA_Stream_TypeDef* DMA_Stream; /*!< DMA stream for timer channel */
+	uint32_t DMA_Channel;           /*!< DMA channel for timer channel */
+	TM_DELAY_Timer_t* Timer;        /*!< Software timer for start pulse and timeout */
+	uint8_t Channel;                /*!< Timer channel, 1 to 4 */
+	uint8_t AF;                     /*!< GPIO alternate function for timer */
+	volatile uint8_t State;         /*!< Asynchronous read state. This is private member */
+	uint16_t Edges[AM2301_CAPTURE_EDGES]; /*!< Captured edges in microseconds. This is private member */
+#endif
 } TM_AM2301_t;
 
 /**
@@ -173,6 +236,70 @@ TM_AM2301_Result_t TM_AM2301_Init(TM_AM2301_t* AMStruct, GPIO_TypeDef* GPIOx, ui
  */
 TM_AM2301_Result_t TM_AM2301_Read(TM_AM2301_t* AMStruct);
 
+#if AM2301_USE_SERIES || defined(DOXYGEN)
+/**
+ * @brief  Reads data from sensor directly to row of series store
+ * @note   Temperature goes to Channel and humidity to Channel + 1, both in tenths.
+ *         Samples stay @ref SERIES_INVALID when read fails
+ * @note   Available when AM2301_USE_SERIES is enabled
+ * @param  *AMStruct: Pointer to @ref TM_AM2301_t data structure
+ * @param  *Series: Pointer to @ref TM_SERIES_t store
+ * @param  Row: Row index from @ref TM_SERIES_AddRow
+ * @param  Channel: Channel index for temperature
+ * @retval Data valid:
+ *            - TM_AM2301_OK: Data valid and saved to store
+ *            - Else: Data not valid
+ */
+TM_AM2301_Result_t TM_AM2301_ReadSeries(TM_AM2301_t* AMStruct, TM_SERIES_t* Series, uint16_t Row, uint8_t Channel);
+#endif
+
+/**
+ * @brief  Initializes AM2301 sensor for asynchronous read with timer input capture and DMA
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  *AMStruct: Pointer to empty @ref TM_AM2301_t data structure
+ * @param  *GPIOx: Pointer to GPIOx port you will use for your sensor
+ * @param  GPIO_Pin: GPIO pin used in your port for sensor pin, must be timer channel pin
+ * @param  AF: GPIO alternate function for timer channel on pin
+ * @param  *TIMx: Pointer to TIM2, TIM3, TIM4 or TIM5
+ * @param  Channel: Timer channel, 1 to 4
+ * @param  *DMA_Stream: DMA stream for timer channel capture request
+ * @param  DMA_Channel: DMA channel for timer channel capture request
+ * @retval Initialization status:
+ *            - TM_AM2301_Result_Ok: Initialized
+ *            - TM_AM2301_Result_Error: Invalid timer or channel or software timer not available
+ */
+#if !defined(STM32F0xx)
+TM_AM2301_Result_t TM_AM2301_InitCapture(TM_AM2301_t* AMStruct, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint8_t AF, TIM_TypeDef* TIMx, uint8_t Channel, DMA_Stream_TypeDef* DMA_Stream, uint32_t DMA_Channel);
+
+/**
+ * @brief  Starts asynchronous read from sensor
+ * @note   Sensor must be initialized with @ref TM_AM2301_InitCapture
+ * @param  *AMStruct: Pointer to @ref TM_AM2301_t data structure
+ * @retval Start status:
+ *            - TM_AM2301_Result_Ok: Read started, @ref TM_AM2301_ReadCallback will be called
+ *            - TM_AM2301_Result_BUSY: Read is already in progress
+ *            - TM_AM2301_Result_Error: Sensor is not in input capture mode
+ */
+TM_AM2301_Result_t TM_AM2301_StartRead(TM_AM2301_t* AMStruct);
+
+/**
+ * @brief  Checks if asynchronous read is in progress
+ * @param  *AMStruct: Pointer to @ref TM_AM2301_t data structure
+ * @retval 1 when read is in progress, 0 otherwise
+ */
+uint8_t TM_AM2301_Busy(TM_AM2301_t* AMStruct);
+
+/**
+ * @brief  Called when asynchronous read is finished
+ * @note   Called from SysTick interrupt
+ * @param  *AMStruct: Pointer to @ref TM_AM2301_t data structure, Temp and Hum are updated when result is OK
+ * @param  result: Read result, @ref TM_AM2301_Result_t
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_AM2301_ReadCallback(TM_AM2301_t* AMStruct, TM_AM2301_Result_t result);
+#endif
+
 /**
  * @}
  */
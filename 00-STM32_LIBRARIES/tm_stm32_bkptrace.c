@@ -0,0 +1,141 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_bkptrace.h"
+
+/* Magic value for valid ring */
+#define BKPTRACE_MAGIC            0x54524143
+
+/* Ring in backup SRAM */
+typedef struct {
+	uint32_t Magic;               /* Ring is valid */
+	uint32_t Size;                /* Ring size when it was created */
+	uint32_t Head;                /* Number of written events, never wraps to index */
+	uint32_t Boots;               /* Boot number */
+	TM_BKPTRACE_Event_t Events[BKPTRACE_SIZE];
+} TM_BKPTRACE_Ring_t;
+
+#define BKPTRACE_RING             ((volatile TM_BKPTRACE_Ring_t *)(BKPSRAM_BASE + BKPTRACE_BKPSRAM_OFFSET))
+
+uint8_t TM_BKPTRACE_Init(void) {
+	uint8_t valid;
+	
+	/* Enable access to backup domain and backup SRAM */
+	__HAL_RCC_PWR_CLK_ENABLE();
+	HAL_PWR_EnableBkUpAccess();
+	__HAL_RCC_BKPSRAM_CLK_ENABLE();
+	
+	/* Keep backup SRAM content on VBAT */
+	HAL_PWREx_EnableBkUpReg();
+	
+	/* Enable DWT cycle counter for timestamps */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	
+	/* Check ring */
+	valid = BKPTRACE_RING->Magic == BKPTRACE_MAGIC && BKPTRACE_RING->Size == BKPTRACE_SIZE;
+	
+	/* Create new ring */
+	if (!valid) {
+		BKPTRACE_RING->Head = 0;
+		BKPTRACE_RING->Boots = 0;
+		BKPTRACE_RING->Size = BKPTRACE_SIZE;
+		BKPTRACE_RING->Magic = BKPTRACE_MAGIC;
+	}
+	
+	/* Mark boot */
+	BKPTRACE_RING->Boots++;
+	TM_BKPTRACE_Write(BKPTRACE_EVENT_BOOT, (uint16_t)BKPTRACE_RING->Boots);
+	
+	/* Return status */
+	return valid;
+}
+
+void TM_BKPTRACE_Write(uint16_t Event, uint16_t Data) {
+	volatile TM_BKPTRACE_Event_t* e;
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Get slot and write event */
+	e = &BKPTRACE_RING->Events[BKPTRACE_RING->Head++ & (BKPTRACE_SIZE - 1)];
+	e->Time = DWT->CYCCNT;
+	e->Event = Event;
+	e->Data = Data;
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+uint16_t TM_BKPTRACE_GetCount(void) {
+	uint32_t head = BKPTRACE_RING->Head;
+	
+	/* Ring is full */
+	if (head > BKPTRACE_SIZE) {
+		return BKPTRACE_SIZE;
+	}
+	
+	/* Return count */
+	return head;
+}
+
+uint8_t TM_BKPTRACE_Read(uint16_t index, TM_BKPTRACE_Event_t* Event) {
+	uint32_t head, count;
+	uint32_t irq;
+	
+	/* Disable interrupts, event could be overwritten while read */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Get count */
+	head = BKPTRACE_RING->Head;
+	count = head > BKPTRACE_SIZE ? BKPTRACE_SIZE : head;
+	
+	/* Copy event, oldest is at head - count */
+	if (index < count) {
+		*Event = *(TM_BKPTRACE_Event_t *)&BKPTRACE_RING->Events[(head - count + index) & (BKPTRACE_SIZE - 1)];
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Return status */
+	return index < count;
+}
+
+uint32_t TM_BKPTRACE_GetBoots(void) {
+	return BKPTRACE_RING->Boots;
+}
+
+void TM_BKPTRACE_Clear(void) {
+	/* Remove all events */
+	BKPTRACE_RING->Head = 0;
+}
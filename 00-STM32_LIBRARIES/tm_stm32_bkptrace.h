@@ -0,0 +1,243 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Persistent trace ring buffer in backup SRAM for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_BKPTRACE_H
+#define TM_BKPTRACE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_BKPTRACE
+ * @brief    Persistent trace ring buffer in backup SRAM for STM32Fxxx
+ * @{
+ *
+ * Library records small binary events to ring buffer in 4kB backup SRAM.
+ * Backup SRAM is not cleared on reset, so events recorded before crash or watchdog reset can be read after next boot.
+ * With VBAT connected, content is kept also when main power is off.
+ *
+ * Each event has 32-bit timestamp from DWT cycle counter, 16-bit event ID and 16-bit data.
+ * Writing event is a few instructions with interrupts disabled, much faster than text over UART, so it can be used in hot paths and interrupts.
+ *
+ * Ring works like @ref TM_BUFFER with power of 2 size, except that oldest events are overwritten when ring is full.
+ * On each @ref TM_BKPTRACE_Init, @ref BKPTRACE_EVENT_BOOT event is added with boot number as data, so events from different boots can be separated.
+ *
+\code
+#define EVENT_ADC_DONE    1
+#define EVENT_TX_START    2
+
+uint16_t i;
+TM_BKPTRACE_Event_t e;
+
+//Init, previous events are kept
+TM_BKPTRACE_Init();
+
+//Dump events from before reset
+for (i = 0; i < TM_BKPTRACE_GetCount(); i++) {
+	TM_BKPTRACE_Read(i, &e);
+	printf("%lu: %u %u\n", e.Time, e.Event, e.Data);
+}
+
+//Record events
+TM_BKPTRACE_Write(EVENT_ADC_DONE, value);
+\endcode
+ *
+ * @note  Library is available on STM32F4xx and STM32F7xx devices with backup SRAM
+ *
+ * To change settings, open defines.h file and add lines:
+ *
+\code
+//Number of events in ring, power of 2, 8 bytes each
+#define BKPTRACE_SIZE             256
+
+//Offset of ring in backup SRAM
+#define BKPTRACE_BKPSRAM_OFFSET   0
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+
+/**
+ * @defgroup TM_BKPTRACE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of events in ring */
+#ifndef BKPTRACE_SIZE
+#define BKPTRACE_SIZE             256
+#endif
+
+/* Offset in backup SRAM */
+#ifndef BKPTRACE_BKPSRAM_OFFSET
+#define BKPTRACE_BKPSRAM_OFFSET   0
+#endif
+
+/* Check values */
+#if !defined(BKPSRAM_BASE)
+#error "TM BKPTRACE needs backup SRAM, it is not available on this device"
+#endif
+#if (BKPTRACE_SIZE & (BKPTRACE_SIZE - 1)) || BKPTRACE_SIZE == 0
+#error "BKPTRACE_SIZE must be power of 2"
+#endif
+#if (BKPTRACE_BKPSRAM_OFFSET + 16 + BKPTRACE_SIZE * 8) > 0x1000
+#error "BKPTRACE ring does not fit into 4kB backup SRAM"
+#endif
+
+/**
+ * @brief  Event ID added on each boot, data is boot number
+ */
+#define BKPTRACE_EVENT_BOOT       0xFFFF
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_BKPTRACE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Trace event
+ */
+typedef struct {
+	uint32_t Time;   /*!< DWT cycle counter value when event was written */
+	uint16_t Event;  /*!< Event ID */
+	uint16_t Data;   /*!< Event data */
+} TM_BKPTRACE_Event_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_BKPTRACE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes backup SRAM and trace ring
+ * @note   Events from before reset are kept when ring in backup SRAM is valid
+ * @param  None
+ * @retval Ring status:
+ *            - 0: Ring was not valid and was cleared, first power up or VBAT was not connected
+ *            - 1: Events from before reset are available
+ */
+uint8_t TM_BKPTRACE_Init(void);
+
+/**
+ * @brief  Writes event to ring, oldest event is overwritten when ring is full
+ * @note   Can be called from any context
+ * @param  Event: Event ID
+ * @param  Data: Event data
+ * @retval None
+ */
+void TM_BKPTRACE_Write(uint16_t Event, uint16_t Data);
+
+/**
+ * @brief  Gets number of events in ring
+ * @param  None
+ * @retval Number of events
+ */
+uint16_t TM_BKPTRACE_GetCount(void);
+
+/**
+ * @brief  Reads event from ring
+ * @param  index: Event index, 0 is oldest event
+ * @param  *Event: Pointer to @ref TM_BKPTRACE_Event_t structure to save event to
+ * @retval Read status:
+ *            - 0: Index is not valid
+ *            - > 0: Event read
+ */
+uint8_t TM_BKPTRACE_Read(uint16_t index, TM_BKPTRACE_Event_t* Event);
+
+/**
+ * @brief  Gets boot number, increased on each @ref TM_BKPTRACE_Init
+ * @param  None
+ * @retval Boot number
+ */
+uint32_t TM_BKPTRACE_GetBoots(void);
+
+/**
+ * @brief  Clears all events
+ * @param  None
+ * @retval None
+ */
+void TM_BKPTRACE_Clear(void);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_boot.h"
+
+/* Boot trace */
+static TM_BOOT_Trace_t Boot_Trace[BOOT_TRACE_SIZE];
+static uint16_t Boot_TraceCount;
+
+/* Time of last mark */
+static uint32_t Boot_Time;          /* Microseconds since init */
+static uint32_t Boot_LastCounter;   /* Counter value on last mark */
+
+/* Pending tasks */
+static TM_BOOT_Task_t* Boot_Tasks;
+
+/* Private functions */
+static uint32_t TM_BOOT_INT_Update(void);
+static void TM_BOOT_INT_Remove(TM_BOOT_Task_t* Task);
+
+void TM_BOOT_Init(void) {
+#if !defined(STM32F0xx)
+	/* Enable DWT cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	
+	/* Start from zero */
+	DWT->CYCCNT = 0;
+	Boot_LastCounter = 0;
+#else
+	/* Start from current tick */
+	Boot_LastCounter = HAL_GetTick();
+#endif
+	
+	/* Reset trace */
+	Boot_Time = 0;
+	Boot_TraceCount = 0;
+	Boot_Tasks = NULL;
+}
+
+uint32_t TM_BOOT_Mark(const char* Name) {
+	uint32_t time, duration;
+	
+	/* Get time since previous mark */
+	duration = Boot_Time;
+	time = TM_BOOT_INT_Update();
+	duration = time - duration;
+	
+	/* Save entry if there is memory */
+	if (Boot_TraceCount < BOOT_TRACE_SIZE) {
+		Boot_Trace[Boot_TraceCount].Name = Name;
+		Boot_Trace[Boot_TraceCount].Time = time;
+		Boot_Trace[Boot_TraceCount].Duration = duration;
+		Boot_TraceCount++;
+	}
+	
+	/* Return time */
+	return time;
+}
+
+uint16_t TM_BOOT_GetTraceCount(void) {
+	return Boot_TraceCount;
+}
+
+const TM_BOOT_Trace_t* TM_BOOT_GetTrace(uint16_t index) {
+	/* Check index */
+	if (index >= Boot_TraceCount) {
+		return NULL;
+	}
+	
+	/* Return entry */
+	return &Boot_Trace[index];
+}
+
+void TM_BOOT_Add(TM_BOOT_Task_t* Task, const char* Name, uint8_t (*Init)(void*), void* Param) {
+	TM_BOOT_Task_t** tmp;
+	
+	/* Fill task */
+	Task->Name = Name;
+	Task->Init = Init;
+	Task->Param = Param;
+	Task->Done = 0;
+	Task->Next = NULL;
+	
+	/* Add to end of list, tasks are initialized in order */
+	for (tmp = &Boot_Tasks; *tmp; tmp = &(*tmp)->Next);
+	*tmp = Task;
+}
+
+uint16_t TM_BOOT_Process(void) {
+	TM_BOOT_Task_t* Task = Boot_Tasks;
+	uint16_t count = 0;
+	
+	/* Nothing to do */
+	if (Task == NULL) {
+		return 0;
+	}
+	
+	/* Make one step of first task */
+	if (Task->Init(Task->Param)) {
+		/* Task is done */
+		Task->Done = 1;
+		TM_BOOT_INT_Remove(Task);
+		TM_BOOT_Mark(Task->Name);
+	}
+	
+	/* Count pending tasks */
+	for (Task = Boot_Tasks; Task; Task = Task->Next) {
+		count++;
+	}
+	
+	/* Return number of pending tasks */
+	return count;
+}
+
+void TM_BOOT_Require(TM_BOOT_Task_t* Task) {
+	/* Already done */
+	if (Task->Done) {
+		return;
+	}
+	
+	/* Make all steps now */
+	while (!Task->Init(Task->Param));
+	
+	/* Task is done */
+	Task->Done = 1;
+	TM_BOOT_INT_Remove(Task);
+	TM_BOOT_Mark(Task->Name);
+}
+
+/* Private functions */
+static uint32_t TM_BOOT_INT_Update(void) {
+	uint32_t counter, delta;
+	
+#if !defined(STM32F0xx)
+	/* Get cycles since last mark */
+	counter = DWT->CYCCNT;
+	delta = counter - Boot_LastCounter;
+	
+	/* Counter was reset by other library, for example TM DELAY */
+	if (delta & 0x80000000) {
+		delta = counter;
+	}
+	
+	/* Add time with current core clock */
+	Boot_Time += delta / (SystemCoreClock / 1000000);
+	
+	/* Remaining cycles are counted on next mark */
+	Boot_LastCounter = counter - delta % (SystemCoreClock / 1000000);
+#else
+	/* Milliseconds since last mark */
+	counter = HAL_GetTick();
+	delta = counter - Boot_LastCounter;
+	Boot_LastCounter = counter;
+	
+	/* Add time */
+	Boot_Time += delta * 1000;
+#endif
+	
+	/* Return time */
+	return Boot_Time;
+}
+
+static void TM_BOOT_INT_Remove(TM_BOOT_Task_t* Task) {
+	TM_BOOT_Task_t** tmp;
+	
+	/* Find and remove from list */
+	for (tmp = &Boot_Tasks; *tmp; tmp = &(*tmp)->Next) {
+		if (*tmp == Task) {
+			*tmp = Task->Next;
+			break;
+		}
+	}
+	Task->Next = NULL;
+}
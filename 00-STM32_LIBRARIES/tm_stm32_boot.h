@@ -0,0 +1,268 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Boot time tracing and deferred initialization for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_BOOT_H
+#define TM_BOOT_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_BOOT
+ * @brief    Boot time tracing and deferred initialization for STM32Fxxx
+ * @{
+ *
+ * \par Boot trace
+ *
+ * Call @ref TM_BOOT_Init as first function in main and @ref TM_BOOT_Mark after each initialization step.
+ * Each mark saves time since reset and duration of step since previous mark, measured with DWT cycle counter.
+ * On STM32F0xx, HAL tick with 1ms resolution is used instead.
+ *
+\code
+TM_BOOT_Init();
+TM_RCC_InitSystem();
+TM_BOOT_Mark("RCC");
+HAL_Init();
+TM_DELAY_Init();
+TM_BOOT_Mark("HAL");
+\endcode
+ *
+ * Time is calculated on each mark with current core clock, so clock changes during boot are handled.
+ *
+ * \par Deferred initialization
+ *
+ * Slow subsystems, like LCD, SDRAM test, USB or FatFs mount, can be initialized after critical code is already running.
+ * Each subsystem is a task with init function, which is called in steps. Function returns 0 when it needs to be called again
+ * and 1 when initialization is done, so long sequences can be split into short steps without blocking.
+ *
+ * Tasks are initialized in order they were added, one step on each @ref TM_BOOT_Process call from main loop.
+ * When subsystem is needed before it is done in background, @ref TM_BOOT_Require finishes it immediately (init on first use).
+ *
+\code
+TM_BOOT_Task_t LCD_Task, FATFS_Task;
+
+uint8_t LCD_InitTask(void* Param) {
+	TM_LCD_Init();
+	return 1;
+}
+
+uint8_t FATFS_InitTask(void* Param) {
+	return f_mount(&FS, "SD:", 1) == FR_OK;
+}
+
+TM_BOOT_Add(&LCD_Task, "LCD", LCD_InitTask, NULL);
+TM_BOOT_Add(&FATFS_Task, "FatFs", FATFS_InitTask, NULL);
+
+//Start sampling here
+
+while (1) {
+	TM_BOOT_Process();
+	
+	if (button_pressed) {
+		TM_BOOT_Require(&FATFS_Task);
+		//Write to SD card
+	}
+}
+\endcode
+ *
+ * Finished tasks are added to boot trace with their names.
+ *
+ * @note  Functions are not reentrant and must be called from main context only
+ *
+ * To change number of trace entries, open defines.h file and add line:
+ *
+\code
+//Number of boot trace entries
+#define BOOT_TRACE_SIZE     16
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+
+/**
+ * @defgroup TM_BOOT_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of boot trace entries */
+#ifndef BOOT_TRACE_SIZE
+#define BOOT_TRACE_SIZE     16
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_BOOT_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Boot trace entry
+ */
+typedef struct {
+	const char* Name;  /*!< Name of initialization step */
+	uint32_t Time;     /*!< Time in microseconds since @ref TM_BOOT_Init when step has finished */
+	uint32_t Duration; /*!< Duration of step in microseconds, time since previous mark */
+} TM_BOOT_Trace_t;
+
+/**
+ * @brief  Deferred initialization task
+ * @note   Structure is filled by @ref TM_BOOT_Add function and must stay valid, do not use local variables
+ */
+typedef struct _TM_BOOT_Task_t {
+	const char* Name;                /*!< Task name for boot trace */
+	uint8_t (*Init)(void* Param);    /*!< Init function, returns 1 when done and 0 when it must be called again */
+	void* Param;                     /*!< User parameter for init function */
+	uint8_t Done;                    /*!< Set to 1 when initialization is finished */
+	struct _TM_BOOT_Task_t* Next;    /*!< Next pending task. Private use */
+} TM_BOOT_Task_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_BOOT_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Starts boot time measurement
+ * @note   Should be the first function in main. DWT cycle counter is enabled
+ * @param  None
+ * @retval None
+ */
+void TM_BOOT_Init(void);
+
+/**
+ * @brief  Adds entry to boot trace for step which has just finished
+ * @param  *Name: Step name, must stay valid, use string literals
+ * @retval Time in microseconds since @ref TM_BOOT_Init
+ */
+uint32_t TM_BOOT_Mark(const char* Name);
+
+/**
+ * @brief  Gets number of entries in boot trace
+ * @param  None
+ * @retval Number of entries
+ */
+uint16_t TM_BOOT_GetTraceCount(void);
+
+/**
+ * @brief  Gets boot trace entry
+ * @param  index: Entry index, from 0 to number of entries - 1
+ * @retval Pointer to @ref TM_BOOT_Trace_t structure or NULL if index is not valid
+ */
+const TM_BOOT_Trace_t* TM_BOOT_GetTrace(uint16_t index);
+
+/**
+ * @brief  Adds task for deferred initialization
+ * @param  *Task: Pointer to empty @ref TM_BOOT_Task_t structure
+ * @param  *Name: Task name for boot trace
+ * @param  *Init: Init function, returns 1 when done and 0 when it must be called again
+ * @param  *Param: User parameter for init function
+ * @retval None
+ */
+void TM_BOOT_Add(TM_BOOT_Task_t* Task, const char* Name, uint8_t (*Init)(void*), void* Param);
+
+/**
+ * @brief  Makes one initialization step of first pending task
+ * @note   Call it periodically in main loop
+ * @param  None
+ * @retval Number of tasks which are not finished yet
+ */
+uint16_t TM_BOOT_Process(void);
+
+/**
+ * @brief  Finishes initialization of task immediately if not done yet
+ * @note   Use this before subsystem is used first time
+ * @param  *Task: Pointer to @ref TM_BOOT_Task_t structure
+ * @retval None
+ */
+void TM_BOOT_Require(TM_BOOT_Task_t* Task);
+
+/**
+ * @brief  Checks if task has finished initialization
+ * @param  *Task: Pointer to @ref TM_BOOT_Task_t structure
+ * @retval 1 when done, 0 otherwise
+ */
+#define TM_BOOT_IsDone(Task)      ((Task)->Done)
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
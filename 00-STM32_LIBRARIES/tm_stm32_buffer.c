@@ -25,6 +25,9 @@
  */
 #include "tm_stm32_buffer.h"
 
+/* Index in buffer memory for position relative to output pointer */
+#define BUFFER_INDEX(Buffer, Out, pos)    (((Out) + (pos)) < (Buffer)->Size ? ((Out) + (pos)) : ((Out) + (pos) - (Buffer)->Size))
+
 uint8_t TM_BUFFER_Init(TM_BUFFER_t* Buffer, uint32_t Size, uint8_t* BufferPtr) {
 	/* Set buffer values to all zeros */
 	memset(Buffer, 0, sizeof(TM_BUFFER_t));
@@ -34,6 +37,11 @@ uint8_t TM_BUFFER_Init(TM_BUFFER_t* Buffer, uint32_t Size, uint8_t* BufferPtr) {
 	Buffer->Buffer = BufferPtr;
 	Buffer->StringDelimiter = '\n';
 	
+	/* Check for power of 2 size */
+	if (Size && (Size & (Size - 1)) == 0) {
+		Buffer->Flags |= BUFFER_SPSC;
+	}
+	
 	/* Check if malloc should be used */
 	if (!Buffer->Buffer) {
 		/* Try to allocate */
@@ -77,21 +85,31 @@ void TM_BUFFER_Free(TM_BUFFER_t* Buffer) {
 }
 
 uint32_t TM_BUFFER_Write(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count) {
-	uint32_t i = 0;
+	uint32_t in;
 	uint32_t free;
 #if BUFFER_FAST
 	uint32_t tocopy;
+#else
+	uint32_t i;
 #endif
 
 	/* Check buffer structure */
 	if (Buffer == NULL || count == 0) {
 		return 0;
 	}
+	
+	/* Single element, no copy loop */
+	if (count == 1) {
+		return TM_BUFFER_WriteByte(Buffer, *Data);
+	}
 
 	/* Check input pointer */
 	if (Buffer->In >= Buffer->Size) {
 		Buffer->In = 0;
 	}
+	
+	/* Save input pointer, only writer modifies it */
+	in = Buffer->In;
 
 	/* Get free memory */
 	free = TM_BUFFER_GetFree(Buffer);
@@ -111,7 +129,7 @@ uint32_t TM_BUFFER_Write(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count) {
 
 #if BUFFER_FAST
 	/* Calculate number of elements we can put at the end of buffer */
-	tocopy = Buffer->Size - Buffer->In;
+	tocopy = Buffer->Size - in;
 
 	/* Check for copy count */
 	if (tocopy > count) {
@@ -119,70 +137,73 @@ uint32_t TM_BUFFER_Write(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count) {
 	}
 
 	/* Copy content to buffer */
-	memcpy(&Buffer->Buffer[Buffer->In], Data, tocopy);
-
-	/* Increase number of bytes we copied already */
-	i += tocopy;
-	Buffer->In += tocopy;
-	count -= tocopy;
-
-	/* Check if anything to write */
-	if (count > 0) {
-		/* Start from the beginning of buffer */
-		Buffer->In = 0;
+	memcpy(&Buffer->Buffer[in], Data, tocopy);
 
-		/* Copy content */
-		memcpy(&Buffer->Buffer[Buffer->In], &Data[i], count);
-
-		/* Set input pointer */
-		Buffer->In = count;
+	/* Check if anything to write at the beginning of buffer */
+	if (count > tocopy) {
+		memcpy(&Buffer->Buffer[0], &Data[tocopy], count - tocopy);
 	}
-
-	/* Check input overflow */
-	if (Buffer->In >= Buffer->Size) {
-		Buffer->In = 0;
-	}
-
-	/* Return number of elements stored in memory */
-	return (i + count);
+	
+	/* Calculate new input pointer */
+	in += count;
 #else
 	/* Go through all elements */
-	while (count--) {
+	for (i = 0; i < count; i++) {
 		/* Add to buffer */
-		Buffer->Buffer[Buffer->In++] = *Data++;
-
-		/* Increase pointers */
-		i++;
+		Buffer->Buffer[in++] = *Data++;
 
 		/* Check input overflow */
-		if (Buffer->In >= Buffer->Size) {
-			Buffer->In = 0;
+		if (in >= Buffer->Size) {
+			in = 0;
 		}
 	}
-
-	/* Return number of elements written */
-	return i;
 #endif
+
+	/* Check input overflow */
+	if (Buffer->Flags & BUFFER_SPSC) {
+		in &= Buffer->Size - 1;
+	} else if (in >= Buffer->Size) {
+		in -= Buffer->Size;
+	}
+	
+	/* Make sure data are in memory before pointer is published */
+	__DMB();
+	
+	/* Publish new input pointer */
+	Buffer->In = in;
+
+	/* Return number of elements stored in memory */
+	return count;
 }
 
 uint32_t TM_BUFFER_Read(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count) {
-	uint32_t i = 0;
+	uint32_t out;
 	uint32_t full;
 #if BUFFER_FAST
 	uint32_t tocopy;
+#else
+	uint32_t i;
 #endif
 
 	/* Check buffer structure */
 	if (Buffer == NULL || count == 0) {
 		return 0;
 	}
+	
+	/* Single element, no copy loop */
+	if (count == 1) {
+		return TM_BUFFER_ReadByte(Buffer, Data);
+	}
 
 	/* Check output pointer */
 	if (Buffer->Out >= Buffer->Size) {
 		Buffer->Out = 0;
 	}
+	
+	/* Save output pointer, only reader modifies it */
+	out = Buffer->Out;
 
-	/* Get free memory */
+	/* Get number of elements in buffer */
 	full = TM_BUFFER_GetFull(Buffer);
 
 	/* Check available memory */
@@ -192,15 +213,18 @@ uint32_t TM_BUFFER_Read(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count) {
 			return 0;
 		}
 
-		/* Set values for write */
+		/* Set values for read */
 		count = full;
 	}
+	
+	/* Input pointer was read, read data after that */
+	__DMB();
 
-	/* We have calculated memory for write */
+	/* We have calculated memory for read */
 
 #if BUFFER_FAST
-	/* Calculate number of elements we can put at the end of buffer */
-	tocopy = Buffer->Size - Buffer->Out;
+	/* Calculate number of elements we can read from the end of buffer */
+	tocopy = Buffer->Size - out;
 
 	/* Check for copy count */
 	if (tocopy > count) {
@@ -208,50 +232,254 @@ uint32_t TM_BUFFER_Read(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count) {
 	}
 
 	/* Copy content from buffer */
-	memcpy(Data, &Buffer->Buffer[Buffer->Out], tocopy);
+	memcpy(Data, &Buffer->Buffer[out], tocopy);
 
-	/* Increase number of bytes we copied already */
-	i += tocopy;
-	Buffer->Out += tocopy;
-	count -= tocopy;
+	/* Check if anything to read from the beginning of buffer */
+	if (count > tocopy) {
+		memcpy(&Data[tocopy], &Buffer->Buffer[0], count - tocopy);
+	}
+	
+	/* Calculate new output pointer */
+	out += count;
+#else
+	/* Go through all elements */
+	for (i = 0; i < count; i++) {
+		/* Read from buffer */
+		*Data++ = Buffer->Buffer[out++];
 
-	/* Check if anything to read */
-	if (count > 0) {
-		/* Start from the beginning of buffer */
-		Buffer->Out = 0;
+		/* Check output overflow */
+		if (out >= Buffer->Size) {
+			out = 0;
+		}
+	}
+#endif
+
+	/* Check output overflow */
+	if (Buffer->Flags & BUFFER_SPSC) {
+		out &= Buffer->Size - 1;
+	} else if (out >= Buffer->Size) {
+		out -= Buffer->Size;
+	}
+	
+	/* Make sure data are read before memory is released to writer */
+	__DMB();
+	
+	/* Publish new output pointer */
+	Buffer->Out = out;
 
-		/* Copy content */
-		memcpy(&Data[i], &Buffer->Buffer[Buffer->Out], count);
+	/* Return number of elements read from memory */
+	return count;
+}
 
-		/* Set input pointer */
-		Buffer->Out = count;
+uint8_t TM_BUFFER_WriteByte(TM_BUFFER_t* Buffer, uint8_t Data) {
+	uint32_t in, next, out;
+	
+	/* Check buffer structure */
+	if (Buffer == NULL) {
+		return 0;
 	}
+	
+	/* Save pointers, only writer modifies input pointer */
+	in = Buffer->In;
+	if (in >= Buffer->Size) {
+		in = 0;
+	}
+	out = Buffer->Out;
+	if (out >= Buffer->Size) {
+		out = 0;
+	}
+	
+	/* Calculate next input pointer */
+	next = in + 1;
+	if (Buffer->Flags & BUFFER_SPSC) {
+		next &= Buffer->Size - 1;
+	} else if (next >= Buffer->Size) {
+		next = 0;
+	}
+	
+	/* Buffer is full when input would reach output */
+	if (next == out) {
+		return 0;
+	}
+	
+	/* Add to buffer */
+	Buffer->Buffer[in] = Data;
+	
+	/* Make sure data are in memory before pointer is published */
+	__DMB();
+	
+	/* Publish new input pointer */
+	Buffer->In = next;
+	
+	/* Element written */
+	return 1;
+}
 
-	/* Check output overflow */
+uint8_t TM_BUFFER_ReadByte(TM_BUFFER_t* Buffer, uint8_t* Data) {
+	uint32_t out;
+	
+	/* Check buffer structure */
+	if (Buffer == NULL) {
+		return 0;
+	}
+	
+	/* Save output pointer, only reader modifies it */
+	out = Buffer->Out;
+	if (out >= Buffer->Size) {
+		out = 0;
+	}
+	
+	/* Buffer is empty when pointers are the same */
+	if (out == Buffer->In) {
+		return 0;
+	}
+	
+	/* Input pointer was read, read data after that */
+	__DMB();
+	
+	/* Read from buffer */
+	*Data = Buffer->Buffer[out++];
+	
+	/* Calculate new output pointer */
+	if (Buffer->Flags & BUFFER_SPSC) {
+		out &= Buffer->Size - 1;
+	} else if (out >= Buffer->Size) {
+		out = 0;
+	}
+	
+	/* Make sure data are read before memory is released to writer */
+	__DMB();
+	
+	/* Publish new output pointer */
+	Buffer->Out = out;
+	
+	/* Element read */
+	return 1;
+}
+
+uint32_t TM_BUFFER_GetReadSpan(TM_BUFFER_t* Buffer, uint8_t** Data) {
+	uint32_t full, out;
+	
+	/* Check buffer structure */
+	if (Buffer == NULL || Data == NULL) {
+		return 0;
+	}
+	
+	/* Check output pointer */
 	if (Buffer->Out >= Buffer->Size) {
 		Buffer->Out = 0;
 	}
+	
+	/* Get values */
+	out = Buffer->Out;
+	full = TM_BUFFER_GetFull(Buffer);
+	
+	/* Input pointer was read, read data after that */
+	__DMB();
+	
+	/* Limit to the end of buffer memory */
+	if (full > (Buffer->Size - out)) {
+		full = Buffer->Size - out;
+	}
+	
+	/* Save pointer */
+	*Data = &Buffer->Buffer[out];
+	
+	/* Return number of elements */
+	return full;
+}
 
-	/* Return number of elements stored in memory */
-	return (i + count);
-#else
-	/* Go through all elements */
-	while (count--) {
-		/* Read from buffer */
-		*Data++ = Buffer->Buffer[Buffer->Out++];
-
-		/* Increase pointers */
-		i++;
+uint32_t TM_BUFFER_CommitRead(TM_BUFFER_t* Buffer, uint32_t count) {
+	uint32_t full, out;
+	
+	/* Check buffer structure */
+	if (Buffer == NULL || count == 0) {
+		return 0;
+	}
+	
+	/* Check maximal value */
+	full = TM_BUFFER_GetFull(Buffer);
+	if (count > full) {
+		count = full;
+	}
+	
+	/* Calculate new output pointer */
+	out = Buffer->Out + count;
+	if (Buffer->Flags & BUFFER_SPSC) {
+		out &= Buffer->Size - 1;
+	} else if (out >= Buffer->Size) {
+		out -= Buffer->Size;
+	}
+	
+	/* Make sure data are read before memory is released to writer */
+	__DMB();
+	
+	/* Publish new output pointer */
+	Buffer->Out = out;
+	
+	/* Return number of elements removed */
+	return count;
+}
 
-		/* Check output overflow */
-		if (Buffer->Out >= Buffer->Size) {
-			Buffer->Out = 0;
-		}
+uint32_t TM_BUFFER_GetWriteSpan(TM_BUFFER_t* Buffer, uint8_t** Data) {
+	uint32_t free, in;
+	
+	/* Check buffer structure */
+	if (Buffer == NULL || Data == NULL) {
+		return 0;
 	}
+	
+	/* Check input pointer */
+	if (Buffer->In >= Buffer->Size) {
+		Buffer->In = 0;
+	}
+	
+	/* Get values */
+	in = Buffer->In;
+	free = TM_BUFFER_GetFree(Buffer);
+	
+	/* Limit to the end of buffer memory */
+	if (free > (Buffer->Size - in)) {
+		free = Buffer->Size - in;
+	}
+	
+	/* Save pointer */
+	*Data = &Buffer->Buffer[in];
+	
+	/* Return number of elements */
+	return free;
+}
 
-	/* Return number of elements stored in memory */
-	return i;
-#endif
+uint32_t TM_BUFFER_CommitWrite(TM_BUFFER_t* Buffer, uint32_t count) {
+	uint32_t free, in;
+	
+	/* Check buffer structure */
+	if (Buffer == NULL || count == 0) {
+		return 0;
+	}
+	
+	/* Check maximal value */
+	free = TM_BUFFER_GetFree(Buffer);
+	if (count > free) {
+		count = free;
+	}
+	
+	/* Calculate new input pointer */
+	in = Buffer->In + count;
+	if (Buffer->Flags & BUFFER_SPSC) {
+		in &= Buffer->Size - 1;
+	} else if (in >= Buffer->Size) {
+		in -= Buffer->Size;
+	}
+	
+	/* Make sure data are in memory before pointer is published */
+	__DMB();
+	
+	/* Publish new input pointer */
+	Buffer->In = in;
+	
+	/* Return number of elements added */
+	return count;
 }
 
 uint32_t TM_BUFFER_GetFree(TM_BUFFER_t* Buffer) {
@@ -266,6 +494,11 @@ uint32_t TM_BUFFER_GetFree(TM_BUFFER_t* Buffer) {
 	in = Buffer->In;
 	out = Buffer->Out;
 	
+	/* Power of 2 size, use mask */
+	if (Buffer->Flags & BUFFER_SPSC) {
+		return Buffer->Size - 1 - ((in - out) & (Buffer->Size - 1));
+	}
+	
 	/* Check if the same */
 	if (in == out) {
 		size = Buffer->Size;
@@ -297,6 +530,11 @@ uint32_t TM_BUFFER_GetFull(TM_BUFFER_t* Buffer) {
 	in = Buffer->In;
 	out = Buffer->Out;
 	
+	/* Power of 2 size, use mask */
+	if (Buffer->Flags & BUFFER_SPSC) {
+		return (in - out) & (Buffer->Size - 1);
+	}
+	
 	/* Pointer are same? */
 	if (in == out) {
 		size = 0;
@@ -329,7 +567,8 @@ void TM_BUFFER_Reset(TM_BUFFER_t* Buffer) {
 }
 
 int32_t TM_BUFFER_FindElement(TM_BUFFER_t* Buffer, uint8_t Element) {
-	uint32_t Num, Out, retval = 0;
+	uint32_t Num, Out, len;
+	uint8_t* ptr;
 	
 	/* Check buffer structure */
 	if (Buffer == NULL) {
@@ -339,24 +578,33 @@ int32_t TM_BUFFER_FindElement(TM_BUFFER_t* Buffer, uint8_t Element) {
 	/* Create temporary variables */
 	Num = TM_BUFFER_GetFull(Buffer);
 	Out = Buffer->Out;
+	if (Out >= Buffer->Size) {
+		Out = 0;
+	}
 	
-	/* Go through input elements */
-	while (Num > 0) {
-		/* Check output overflow */
-		if (Out >= Buffer->Size) {
-			Out = 0;
-		}
-		
-		/* Check for element */
-		if ((uint8_t)Buffer->Buffer[Out] == (uint8_t)Element) {
+	/* Input pointer was read, read data after that */
+	__DMB();
+	
+	/* Check first part, from output pointer to the end of buffer memory */
+	len = Buffer->Size - Out;
+	if (len > Num) {
+		len = Num;
+	}
+	
+	/* memchr compares word at a time */
+	ptr = memchr(&Buffer->Buffer[Out], Element, len);
+	if (ptr != NULL) {
+		/* Element found, return position in buffer */
+		return ptr - &Buffer->Buffer[Out];
+	}
+	
+	/* Check second part, from the beginning of buffer memory */
+	if (Num > len) {
+		ptr = memchr(Buffer->Buffer, Element, Num - len);
+		if (ptr != NULL) {
 			/* Element found, return position in buffer */
-			return retval;
+			return len + (ptr - Buffer->Buffer);
 		}
-		
-		/* Set new variables */
-		Out++;
-		Num--;
-		retval++;
 	}
 	
 	/* Element is not in buffer */
@@ -364,64 +612,134 @@ int32_t TM_BUFFER_FindElement(TM_BUFFER_t* Buffer, uint8_t Element) {
 }
 
 int32_t TM_BUFFER_Find(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t Size) {
-	uint32_t Num, Out, i, retval = 0;
-	uint8_t found = 0;
+	uint32_t Num, Out, pos, len, i, idx;
+	uint8_t* ptr;
 
 	/* Check buffer structure and number of elements in buffer */
-	if (Buffer == NULL || (Num = TM_BUFFER_GetFull(Buffer)) < Size) {
+	if (Buffer == NULL || Data == NULL || Size == 0 || (Num = TM_BUFFER_GetFull(Buffer)) < Size) {
 		return -1;
 	}
 
 	/* Create temporary variables */
 	Out = Buffer->Out;
-
-	/* Go through input elements in buffer */
-	while (Num > 0) {
-		/* Check output overflow */
-		if (Out >= Buffer->Size) {
-			Out = 0;
+	if (Out >= Buffer->Size) {
+		Out = 0;
+	}
+	
+	/* Input pointer was read, read data after that */
+	__DMB();
+	
+	/* Go through all possible start positions */
+	pos = 0;
+	while (pos <= (Num - Size)) {
+		/* Get index in buffer memory and length until the end of memory or last start position */
+		idx = BUFFER_INDEX(Buffer, Out, pos);
+		len = Buffer->Size - idx;
+		if (len > (Num - Size - pos + 1)) {
+			len = Num - Size - pos + 1;
 		}
-
-		/* Check if current element in buffer matches first element in data array */
-		if ((uint8_t)Buffer->Buffer[Out] == (uint8_t)Data[0]) {
-			found = 1;
+		
+		/* Find first element of sequence, word at a time */
+		ptr = memchr(&Buffer->Buffer[idx], Data[0], len);
+		if (ptr == NULL) {
+			/* Not in this part, continue at the beginning of buffer memory */
+			pos += len;
+			continue;
 		}
-
-		/* Set new variables */
-		Out++;
-		Num--;
-		retval++;
-
-		/* We have found first element */
-		if (found) {
-			/* First character found */
-			/* Check others */
-			i = 1;
-			while (i < Size) {
-				/* Check output overflow */
-				if (Out >= Buffer->Size) {
-					Out = 0;
-				}
-
-				/* Check if current character in buffer matches character in string */
-				if ((uint8_t)Buffer->Buffer[Out] != (uint8_t)Data[i]) {
-					retval += i - 1;
-					break;
-				}
-
-				/* Set new variables */
-				Out++;
-				Num--;
-				i++;
+		pos += ptr - &Buffer->Buffer[idx];
+		
+		/* Check others */
+		for (i = 1; i < Size; i++) {
+			if (Buffer->Buffer[BUFFER_INDEX(Buffer, Out, pos + i)] != Data[i]) {
+				break;
 			}
+		}
+		
+		/* We have found data sequence in buffer */
+		if (i == Size) {
+			return pos;
+		}
+		
+		/* Go to next start position */
+		pos++;
+	}
+
+	/* Data sequence is not in buffer */
+	return -1;
+}
+
+void TM_BUFFER_SearchInit(TM_BUFFER_Search_t* Search, uint8_t* Data, uint32_t Size) {
+	uint32_t i, skip;
+	
+	/* Save sequence */
+	Search->Data = Data;
+	Search->Size = Size;
+	
+	/* Nothing scanned yet */
+	Search->Scanned = 0;
+	Search->Out = 0;
+	
+	/* Default skip is whole sequence for all elements which are not in sequence */
+	skip = Size > 0xFF ? 0xFF : Size;
+	memset(Search->Skip, skip, sizeof(Search->Skip));
+	
+	/* Skip value for each element in sequence, except the last one, is its distance to the end */
+	for (i = 0; (i + 1) < Size; i++) {
+		skip = Size - 1 - i;
+		Search->Skip[Data[i]] = skip > 0xFF ? 0xFF : skip;
+	}
+}
 
+int32_t TM_BUFFER_Search(TM_BUFFER_t* Buffer, TM_BUFFER_Search_t* Search) {
+	uint32_t Num, Out, pos, last, i, read;
+	uint8_t c;
+	
+	/* Check structures */
+	if (Buffer == NULL || Search == NULL || Search->Size == 0) {
+		return -1;
+	}
+	
+	/* Create temporary variables */
+	Num = TM_BUFFER_GetFull(Buffer);
+	Out = Buffer->Out;
+	if (Out >= Buffer->Size) {
+		Out = 0;
+	}
+	
+	/* Input pointer was read, read data after that */
+	__DMB();
+	
+	/* Elements read since last call were scanned too, scanned positions are relative to output pointer */
+	read = Out >= Search->Out ? (Out - Search->Out) : (Buffer->Size - Search->Out + Out);
+	Search->Out = Out;
+	pos = Search->Scanned > read ? (Search->Scanned - read) : 0;
+	
+	/* Horspool search, only from first position which was not checked yet */
+	last = Search->Size - 1;
+	while ((pos + Search->Size) <= Num) {
+		/* Compare last element of sequence first */
+		c = Buffer->Buffer[BUFFER_INDEX(Buffer, Out, pos + last)];
+		if (c == Search->Data[last]) {
+			/* Check others, from the end */
+			i = last;
+			while (i > 0 && Buffer->Buffer[BUFFER_INDEX(Buffer, Out, pos + i - 1)] == Search->Data[i - 1]) {
+				i--;
+			}
+			
 			/* We have found data sequence in buffer */
-			if (i == Size) {
-				return retval;
+			if (i == 0) {
+				Search->Scanned = pos;
+				return pos;
 			}
 		}
+		
+		/* Skip positions which can not match for this element */
+		pos += Search->Skip[c];
 	}
-
+	
+	/* Save first position which was not checked yet */
+	Search->Scanned = pos;
+	
 	/* Data sequence is not in buffer */
 	return -1;
 }
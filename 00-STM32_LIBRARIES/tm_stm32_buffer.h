@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.8
  * @ide     Keil uVision
  * @license MIT
  * @brief   Generic cyclic buffer library 
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_BUFFER_H
-#define TM_BUFFER_H 130
+#define TM_BUFFER_H 180
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -70,6 +70,64 @@ extern "C" {
     string is also filled in user buffer
 - In all other cases, if there is no string delimiter in buffer, buffer will not return anything and will check for it first.
 \endverbatim
+ *
+ * \par Single producer, single consumer
+ *
+ * Buffer is safe to use without critical sections when one context only writes to buffer (for example interrupt)
+ * and one context only reads from it (for example main loop or RTOS task).
+ *
+ * Writer only modifies @ref TM_BUFFER_t.In pointer and reader only modifies @ref TM_BUFFER_t.Out pointer.
+ * Data are copied first, then new pointer value is published with one store after memory barrier.
+ *
+ * When buffer size is power of 2 (16, 32, 64, ...), @ref TM_BUFFER_Init() sets @ref BUFFER_SPSC flag and
+ * pointers are wrapped with mask instead of compare operations.
+ *
+ * @note  @ref TM_BUFFER_Reset() and string functions which read and write from the same context are not safe in this mode
+ *
+ * \par Zero-copy access
+ *
+ * Instead of copying data with @ref TM_BUFFER_Read() or @ref TM_BUFFER_Write(), you can get pointer directly
+ * to buffer memory and let DMA or USB work with it.
+ *
+ * Because buffer is cyclic, free or full memory can be split in 2 parts, at the end and at the beginning of buffer memory.
+ * Span functions always return first contiguous part only. When it is processed and committed, call span function again for the second part.
+ *
+\code
+uint8_t* ptr;
+uint32_t len;
+
+//Get pointer to data ready to read
+len = TM_BUFFER_GetReadSpan(&Buffer, &ptr);
+if (len) {
+	//Process data directly from buffer memory
+	SendData(ptr, len);
+	
+	//Release memory when data are not needed anymore
+	TM_BUFFER_CommitRead(&Buffer, len);
+}
+\endcode
+ *
+ * \par Incremental search
+ *
+ * @ref TM_BUFFER_Find() checks all data in buffer on each call. When you wait for sequence in a loop,
+ * use @ref TM_BUFFER_Search_t structure with @ref TM_BUFFER_Search() instead.
+ * It remembers how much of buffer was already checked, so only new data are checked on next call.
+ * Skip table is calculated once in @ref TM_BUFFER_SearchInit() and sequences longer than 1 element
+ * do not need to compare every element in buffer.
+ *
+\code
+TM_BUFFER_Search_t Search;
+
+//Prepare search for "OK"
+TM_BUFFER_SearchInit(&Search, (uint8_t *)"OK", 2);
+
+while (1) {
+	//Check only new data
+	if (TM_BUFFER_Search(&Buffer, &Search) >= 0) {
+		//Sequence found
+	}
+}
+\endcode
  *
  * \par Changelog
  *
@@ -93,6 +151,25 @@ extern "C" {
  Version 1.4
   - February 18, 2016
   - Added memory copy on buffer read/write operations for fastest speed
+
+ Version 1.5
+  - October 14, 2026
+  - Read/write is now lock-free for single producer and single consumer
+  - Masked pointers for buffers with power of 2 size
+
+ Version 1.6
+  - October 14, 2026
+  - Added zero-copy span functions for direct access to buffer memory
+
+ Version 1.7
+  - October 14, 2026
+  - TM_BUFFER_FindElement and TM_BUFFER_Find use memchr on contiguous parts of buffer memory
+  - TM_BUFFER_Find returns start position of sequence and finds overlapping sequences
+  - Added incremental search with skip table, TM_BUFFER_SearchInit and TM_BUFFER_Search
+
+ Version 1.8
+  - October 14, 2026
+  - Added TM_BUFFER_WriteByte and TM_BUFFER_ReadByte for single elements, used by TM_BUFFER_Write and TM_BUFFER_Read when 1 element is copied
 \endverbatim
  *
  * \par Dependencies
@@ -115,6 +192,19 @@ extern "C" {
 
 #define BUFFER_INITIALIZED     0x01 /*!< Buffer initialized flag */
 #define BUFFER_MALLOC          0x02 /*!< Buffer uses malloc for memory */
+#define BUFFER_SPSC            0x04 /*!< Buffer size is power of 2, masked pointers are used */
+
+/**
+ * @brief  Gets flags value for statically initialized buffer of desired size
+ * @param  Size: Buffer size in units of bytes
+ * @retval @ref BUFFER_SPSC if size is power of 2, 0 otherwise
+ */
+#define BUFFER_SIZE_FLAGS(Size)    ((((Size) & ((Size) - 1)) == 0) ? BUFFER_SPSC : 0)
+
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
 
 /* Custom allocation and free functions if needed */
 #ifndef LIB_ALLOC_FUNC
@@ -143,14 +233,25 @@ extern "C" {
  */
 typedef struct _TM_BUFFER_t {
 	uint32_t Size;           /*!< Size of buffer in units of bytes, DO NOT MOVE OFFSET, 0 */
-	uint32_t In;             /*!< Input pointer to save next value, DO NOT MOVE OFFSET, 1 */
-	uint32_t Out;            /*!< Output pointer to read next value, DO NOT MOVE OFFSET, 2 */
+	volatile uint32_t In;    /*!< Input pointer to save next value, modified by writer only, DO NOT MOVE OFFSET, 1 */
+	volatile uint32_t Out;   /*!< Output pointer to read next value, modified by reader only, DO NOT MOVE OFFSET, 2 */
 	uint8_t* Buffer;         /*!< Pointer to buffer data array, DO NOT MOVE OFFSET, 3 */
 	uint8_t Flags;           /*!< Flags for buffer, DO NOT MOVE OFFSET, 4 */
 	uint8_t StringDelimiter; /*!< Character for string delimiter when reading from buffer as string, DO NOT MOVE OFFSET, 5 */
 	void* UserParameters;    /*!< Pointer to user value if needed */
 } TM_BUFFER_t;
 
+/**
+ * @brief  Incremental search structure
+ */
+typedef struct _TM_BUFFER_Search_t {
+	uint8_t* Data;           /*!< Pointer to data sequence to search for */
+	uint32_t Size;           /*!< Data sequence size in units of bytes */
+	uint32_t Scanned;        /*!< Number of start positions from output pointer already checked */
+	uint32_t Out;            /*!< Buffer output pointer value on last search */
+	uint8_t Skip[256];       /*!< Number of positions to skip for each element value */
+} TM_BUFFER_Search_t;
+
 /**
  * @}
  */
@@ -167,6 +268,7 @@ typedef struct _TM_BUFFER_t {
  * @param  Size: Size of buffer in units of bytes
  * @param  *BufferPtr: Pointer to array for buffer storage. Its length should be equal to @param Size parameter.
  *           If NULL is passed as parameter, @ref malloc will be used to allocate memory on heap.
+ * @note   Use power of 2 size for fastest pointer calculations
  * @retval Buffer initialization status:
  *            - 0: Buffer initialized OK
  *            - > 0: Buffer initialization error. Malloc has failed with allocation
@@ -199,6 +301,58 @@ uint32_t TM_BUFFER_Write(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count);
  */
 uint32_t TM_BUFFER_Read(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t count);
 
+/**
+ * @brief  Writes one element to buffer
+ * @note   Faster than @ref TM_BUFFER_Write() for one element, used from interrupts for received bytes
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  Data: Element to write
+ * @retval Number of elements written, 0 when buffer is full
+ */
+uint8_t TM_BUFFER_WriteByte(TM_BUFFER_t* Buffer, uint8_t Data);
+
+/**
+ * @brief  Reads one element from buffer
+ * @note   Faster than @ref TM_BUFFER_Read() for one element
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  *Data: Pointer to store element to
+ * @retval Number of elements read, 0 when buffer is empty
+ */
+uint8_t TM_BUFFER_ReadByte(TM_BUFFER_t* Buffer, uint8_t* Data);
+
+/**
+ * @brief  Gets pointer to first contiguous part of data ready to read in buffer memory
+ * @note   Data stay in buffer until @ref TM_BUFFER_CommitRead() is called
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  **Data: Pointer to pointer where address of data in buffer memory will be saved
+ * @retval Number of elements which can be read from returned address
+ */
+uint32_t TM_BUFFER_GetReadSpan(TM_BUFFER_t* Buffer, uint8_t** Data);
+
+/**
+ * @brief  Removes elements from buffer after they were processed directly in buffer memory
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  count: Number of elements to remove, usually value returned from @ref TM_BUFFER_GetReadSpan()
+ * @retval Number of elements removed from buffer
+ */
+uint32_t TM_BUFFER_CommitRead(TM_BUFFER_t* Buffer, uint32_t count);
+
+/**
+ * @brief  Gets pointer to first contiguous part of free memory in buffer
+ * @note   Data written to memory are not in buffer until @ref TM_BUFFER_CommitWrite() is called
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  **Data: Pointer to pointer where address of free memory will be saved
+ * @retval Number of elements which can be written to returned address
+ */
+uint32_t TM_BUFFER_GetWriteSpan(TM_BUFFER_t* Buffer, uint8_t** Data);
+
+/**
+ * @brief  Adds elements to buffer after they were written directly to buffer memory
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  count: Number of elements written, maximal value returned from @ref TM_BUFFER_GetWriteSpan()
+ * @retval Number of elements added to buffer
+ */
+uint32_t TM_BUFFER_CommitWrite(TM_BUFFER_t* Buffer, uint32_t count);
+
 /**
  * @brief  Gets number of free elements in buffer 
  * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
@@ -242,6 +396,34 @@ int32_t TM_BUFFER_FindElement(TM_BUFFER_t* Buffer, uint8_t Element);
  */
 int32_t TM_BUFFER_Find(TM_BUFFER_t* Buffer, uint8_t* Data, uint32_t Size);
 
+/**
+ * @brief  Prepares incremental search structure for data sequence
+ * @note   Data sequence is not copied and must stay valid and unchanged while structure is used
+ * @param  *Search: Pointer to @ref TM_BUFFER_Search_t structure
+ * @param  *Data: Array with data sequence
+ * @param  Size: Data size in units of bytes
+ * @retval None
+ */
+void TM_BUFFER_SearchInit(TM_BUFFER_Search_t* Search, uint8_t* Data, uint32_t Size);
+
+/**
+ * @brief  Checks if data sequence is stored in buffer, checking only data not checked on previous calls
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  *Search: Pointer to @ref TM_BUFFER_Search_t structure prepared with @ref TM_BUFFER_SearchInit()
+ * @retval Status of sequence:
+ *            -  < 0: Sequence was not found
+ *            - >= 0: Sequence found, start sequence location in buffer is returned
+ */
+int32_t TM_BUFFER_Search(TM_BUFFER_t* Buffer, TM_BUFFER_Search_t* Search);
+
+/**
+ * @brief  Resets incremental search, next search will check all data in buffer
+ * @note   Call it after @ref TM_BUFFER_Reset() on buffer used in search
+ * @param  *Search: Pointer to @ref TM_BUFFER_Search_t structure
+ * @retval None
+ */
+#define TM_BUFFER_SearchReset(Search)    ((Search)->Scanned = 0)
+
 /**
  * @brief  Sets string delimiter character when reading from buffer as string
  * @param  Buffer: Pointer to @ref TM_BUFFER_t structure
@@ -38,8 +38,22 @@ typedef struct {
 } TM_BUTTON_INT_t;
 static TM_BUTTON_INT_t Buttons;
 
+/* Scanned ports and event queue */
+typedef struct {
+	TM_BUTTON_Port_t* Ports[BUTTON_MAX_PORTS];
+	uint8_t PortsCount;
+	TM_DELAY_Timer_t* Timer;
+	TM_BUTTON_Event_t Events[BUTTON_EVENT_QUEUE_SIZE];
+	volatile uint16_t In, Out;
+	volatile uint32_t Lost;
+} TM_BUTTON_INT_Scan_t;
+static TM_BUTTON_INT_Scan_t Scan;
+
 /* Internal functions */
 static void TM_BUTTON_INT_CheckButton(TM_BUTTON_t* ButtonStruct);
+static void TM_BUTTON_INT_ScanCallback(TM_DELAY_Timer_t* Timer, void* UserParameters);
+static void TM_BUTTON_INT_ScanPort(TM_BUTTON_Port_t* Port, uint32_t now);
+static void TM_BUTTON_INT_AddEvent(TM_BUTTON_Port_t* Port, uint8_t pin, TM_BUTTON_PressType_t Type, uint32_t now);
 
 TM_BUTTON_t* TM_BUTTON_Init(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint8_t ButtonState, void (*ButtonHandler)(TM_BUTTON_t*, TM_BUTTON_PressType_t)) {
 	TM_BUTTON_t* ButtonStruct;
@@ -54,7 +68,7 @@ TM_BUTTON_t* TM_BUTTON_Init(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint8_t Butt
 	}
 	
 	/* Allocate memory for button */
-	ButtonStruct = (TM_BUTTON_t *) malloc(sizeof(TM_BUTTON_t));
+	ButtonStruct = (TM_BUTTON_t *) LIB_ALLOC_FUNC(sizeof(TM_BUTTON_t));
 	
 	/* Check if allocated */
 	if (ButtonStruct == NULL) {
@@ -111,7 +125,154 @@ void TM_BUTTON_Update(void) {
 	}
 }
 
+TM_BUTTON_Port_t* TM_BUTTON_InitPort(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pins, uint16_t PressedHigh) {
+	TM_BUTTON_Port_t* Port;
+	
+	/* Init delay function */
+	TM_DELAY_Init();
+	
+	/* Check if available */
+	if (Scan.PortsCount >= BUTTON_MAX_PORTS) {
+		return NULL;
+	}
+	
+	/* Create scan timer for first port */
+	if (Scan.Timer == NULL) {
+		Scan.Timer = TM_DELAY_TimerCreate(BUTTON_SCAN_PERIOD, 1, 0, TM_BUTTON_INT_ScanCallback, NULL);
+		if (Scan.Timer == NULL) {
+			return NULL;
+		}
+	}
+	
+	/* Allocate memory for port */
+	Port = (TM_BUTTON_Port_t *) LIB_ALLOC_FUNC(sizeof(TM_BUTTON_Port_t));
+	
+	/* Check if allocated */
+	if (Port == NULL) {
+		return NULL;
+	}
+	
+	/* Save settings, all buttons released */
+	Port->GPIOx = GPIOx;
+	Port->GPIO_Pins = GPIO_Pins;
+	Port->PressedLow = GPIO_Pins & ~PressedHigh;
+	Port->Pressed = 0;
+	Port->Long = 0;
+	Port->Count0 = 0xFFFF;
+	Port->Count1 = 0xFFFF;
+	
+	/* Init pins with proper pull resistors */
+	if (GPIO_Pins & PressedHigh) {
+		TM_GPIO_Init(GPIOx, GPIO_Pins & PressedHigh, TM_GPIO_Mode_IN, TM_GPIO_OType_PP, TM_GPIO_PuPd_DOWN, TM_GPIO_Speed_Low);
+	}
+	if (Port->PressedLow) {
+		TM_GPIO_Init(GPIOx, Port->PressedLow, TM_GPIO_Mode_IN, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Low);
+	}
+	
+	/* Save port and start scanning */
+	Scan.Ports[Scan.PortsCount++] = Port;
+	TM_DELAY_TimerStart(Scan.Timer);
+	
+	/* Return port pointer */
+	return Port;
+}
+
+uint8_t TM_BUTTON_GetEvent(TM_BUTTON_Event_t* Event) {
+	/* Check if any event */
+	if (Scan.Out == Scan.In) {
+		return 0;
+	}
+	
+	/* Copy event and free it */
+	*Event = Scan.Events[Scan.Out];
+	Scan.Out = (Scan.Out + 1) & (BUTTON_EVENT_QUEUE_SIZE - 1);
+	
+	/* Return OK */
+	return 1;
+}
+
+uint32_t TM_BUTTON_EventsLost(void) {
+	/* Return lost events */
+	return Scan.Lost;
+}
+
 /* Internal functions */
+static void TM_BUTTON_INT_ScanCallback(TM_DELAY_Timer_t* Timer, void* UserParameters) {
+	uint32_t now = TM_DELAY_Time();
+	uint32_t period = BUTTON_IDLE_SCAN_PERIOD;
+	uint8_t i;
+	
+	/* Scan all ports */
+	for (i = 0; i < Scan.PortsCount; i++) {
+		TM_BUTTON_INT_ScanPort(Scan.Ports[i], now);
+		
+		/* Scan fast while any button is pressed or counting */
+		if (Scan.Ports[i]->Pressed || (Scan.Ports[i]->Count0 & Scan.Ports[i]->Count1) != 0xFFFF) {
+			period = BUTTON_SCAN_PERIOD;
+		}
+	}
+	
+	/* Change scan period */
+	if (Timer->ARR != period) {
+		TM_DELAY_TimerAutoReloadValue(Timer, period);
+		TM_DELAY_TimerReset(Timer);
+	}
+}
+
+static void TM_BUTTON_INT_ScanPort(TM_BUTTON_Port_t* Port, uint32_t now) {
+	uint16_t sample, changed, pressed;
+	uint8_t i;
+	
+	/* Read all buttons at once, 1 means pressed */
+	sample = ((uint16_t)Port->GPIOx->IDR ^ Port->PressedLow) & Port->GPIO_Pins;
+	
+	/* 2-bit vertical counters, pin changes state after 4 equal samples */
+	changed = Port->Pressed ^ sample;
+	Port->Count0 = ~(Port->Count0 & changed);
+	Port->Count1 = Port->Count0 ^ (Port->Count1 & changed);
+	changed &= Port->Count0 & Port->Count1;
+	Port->Pressed ^= changed;
+	
+	/* Pins with long press which are not reported yet */
+	pressed = Port->Pressed & ~Port->Long & ~changed;
+	
+	/* Check for events */
+	for (i = 0; (changed | pressed) >> i; i++) {
+		if (changed & (1 << i)) {
+			if (Port->Pressed & (1 << i)) {
+				/* New press */
+				Port->StartTime[i] = now;
+				TM_BUTTON_INT_AddEvent(Port, i, TM_BUTTON_PressType_OnPressed, now);
+			} else {
+				/* Release */
+				Port->Long &= ~(1 << i);
+				TM_BUTTON_INT_AddEvent(Port, i, TM_BUTTON_PressType_Release, now);
+			}
+		} else if ((pressed & (1 << i)) && (now - Port->StartTime[i]) > BUTTON_LONG_PRESS_TIME) {
+			/* Long press */
+			Port->Long |= 1 << i;
+			TM_BUTTON_INT_AddEvent(Port, i, TM_BUTTON_PressType_Long, now);
+		}
+	}
+}
+
+static void TM_BUTTON_INT_AddEvent(TM_BUTTON_Port_t* Port, uint8_t pin, TM_BUTTON_PressType_t Type, uint32_t now) {
+	uint16_t next = (Scan.In + 1) & (BUTTON_EVENT_QUEUE_SIZE - 1);
+	
+	/* Check for free space */
+	if (next == Scan.Out) {
+		Scan.Lost++;
+		return;
+	}
+	
+	/* Save event */
+	Scan.Events[Scan.In].Port = Port;
+	Scan.Events[Scan.In].GPIO_Pin = 1 << pin;
+	Scan.Events[Scan.In].Type = Type;
+	Scan.Events[Scan.In].Time = now;
+	Scan.In = next;
+}
+
 static void TM_BUTTON_INT_CheckButton(TM_BUTTON_t* ButtonStruct) {
 	uint32_t now, status;
 	
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-13-buttons-for-stm32fxxx/
- * @version v1.0
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   Buttons library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_BUTTON_H
-#define TM_BUTTON_H 100
+#define TM_BUTTON_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -54,12 +54,50 @@ extern "C" {
  *
  * This library works with external buttons.
  * It can detect button on pressed, normal button press and long button press
+ *
+ * \par Port scanning
+ *
+ * For many buttons, use @ref TM_BUTTON_InitPort instead of @ref TM_BUTTON_Init. All buttons on one GPIO port
+ * are sampled with one IDR read from @ref TM_DELAY software timer every @ref BUTTON_SCAN_PERIOD milliseconds
+ * and debounced together with vertical counters, button state must be stable for 4 samples.
+ *
+ * Press, long press and release events are saved to event queue and read with @ref TM_BUTTON_GetEvent from main loop.
+ * @ref TM_BUTTON_Update is not needed for port buttons.
+ *
+\code
+//Number of ports for scanning
+#define BUTTON_MAX_PORTS          4
+//Scan period in milliseconds
+#define BUTTON_SCAN_PERIOD        5
+//Number of events in queue, must be power of 2
+#define BUTTON_EVENT_QUEUE_SIZE   16
+\endcode
+ *
+ * When all port buttons are released and stable, scan timer period is changed to @ref BUTTON_IDLE_SCAN_PERIOD.
+ * With @ref TM_DELAY tickless mode this lets core sleep longer, new press is detected with longer delay.
+ *
+\code
+//Scan period in milliseconds when no button is pressed
+#define BUTTON_IDLE_SCAN_PERIOD   50
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Button structure is allocated with LIB_ALLOC_FUNC, TM POOL can be used with LIB_USE_POOL
+  
+ Version 1.2
+  - October 14, 2026
+  - Added timer driven port scanning with vertical counter debounce and event queue
+  
+ Version 1.3
+  - October 14, 2026
+  - Added longer scan period when all port buttons are released for tickless idle
 \endverbatim
  *
  * \par Dependencies
@@ -105,6 +143,35 @@ extern "C" {
 #define BUTTON_LONG_PRESS_TIME    1500
 #endif
 
+/* Number of ports for scanning */
+#ifndef BUTTON_MAX_PORTS
+#define BUTTON_MAX_PORTS          4
+#endif
+
+/* Scan period in milliseconds */
+#ifndef BUTTON_SCAN_PERIOD
+#define BUTTON_SCAN_PERIOD        5
+#endif
+
+/* Scan period in milliseconds when all port buttons are released */
+#ifndef BUTTON_IDLE_SCAN_PERIOD
+#define BUTTON_IDLE_SCAN_PERIOD   BUTTON_SCAN_PERIOD
+#endif
+
+/* Number of events in queue, must be power of 2 */
+#ifndef BUTTON_EVENT_QUEUE_SIZE
+#define BUTTON_EVENT_QUEUE_SIZE   16
+#endif
+
+#if BUTTON_EVENT_QUEUE_SIZE & (BUTTON_EVENT_QUEUE_SIZE - 1)
+#error "BUTTON_EVENT_QUEUE_SIZE must be power of 2!"
+#endif
+
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
 /* Library allocation function */
 #ifndef LIB_ALLOC_FUNC
 #define LIB_ALLOC_FUNC            malloc
@@ -132,7 +199,8 @@ typedef enum {
   TM_BUTTON_PressType_OnPressed = 0x00, /*!< Button pressed */
   TM_BUTTON_PressType_Debounce,         /*!< Button debounce */
 	TM_BUTTON_PressType_Normal,           /*!< Normal press type, released */
-	TM_BUTTON_PressType_Long              /*!< Long press type */
+	TM_BUTTON_PressType_Long,             /*!< Long press type */
+	TM_BUTTON_PressType_Release           /*!< Button released, port scanning only */
 } TM_BUTTON_PressType_t;
 
 /** 
@@ -151,6 +219,30 @@ typedef struct _TM_BUTTON_t {
 	uint16_t PressLongTime;                                             /*!< Time in ms for long press for button */
 } TM_BUTTON_t;
 
+/**
+ * @brief  Scanned port structure
+ */
+typedef struct {
+	GPIO_TypeDef* GPIOx;   /*!< GPIOx PORT for buttons */
+	uint16_t GPIO_Pins;    /*!< GPIO pins with buttons */
+	uint16_t PressedLow;   /*!< Pins which are low when pressed */
+	uint16_t Pressed;      /*!< Debounced pressed pins */
+	uint16_t Long;         /*!< Pressed pins with long press event already sent */
+	uint16_t Count0;       /*!< Vertical counter bit 0. This is private member */
+	uint16_t Count1;       /*!< Vertical counter bit 1. This is private member */
+	uint32_t StartTime[16]; /*!< Press time for each pin */
+} TM_BUTTON_Port_t;
+
+/**
+ * @brief  Button event from port scanning
+ */
+typedef struct {
+	TM_BUTTON_Port_t* Port;     /*!< Port where event occurred */
+	uint16_t GPIO_Pin;          /*!< GPIO pin where event occurred */
+	TM_BUTTON_PressType_t Type; /*!< Event type: OnPressed, Long or Release */
+	uint32_t Time;              /*!< Event time in milliseconds */
+} TM_BUTTON_Event_t;
+
 /**
  * @}
  */
@@ -163,7 +255,7 @@ typedef struct _TM_BUTTON_t {
 
 /**
  * @brief  Initializes a new button to library
- * @note   This library uses @ref malloc() to allocate memory, so make sure you have enough heap memory
+ * @note   This library uses @ref LIB_ALLOC_FUNC (malloc by default) to allocate memory, so make sure you have enough heap or pool memory
  * @param  *GPIOx: Pointer to GPIOx where button is located
  * @param  GPIO_Pin: GPIO pin where button is located
  * @param  ButtonState: Button state when it is pressed.
@@ -193,6 +285,32 @@ TM_BUTTON_t* TM_BUTTON_SetPressTime(TM_BUTTON_t* ButtonStruct, uint16_t Normal,
  */
 void TM_BUTTON_Update(void);
 
+/**
+ * @brief  Initializes port with more buttons for timer driven scanning
+ * @note   This library uses @ref LIB_ALLOC_FUNC (malloc by default) to allocate memory
+ * @param  *GPIOx: Pointer to GPIOx where buttons are located
+ * @param  GPIO_Pins: GPIO pins with buttons. Use OR (|) operator for more pins
+ * @param  PressedHigh: Pins which are high when pressed, other pins are low when pressed
+ * @retval Pointer to port structure or NULL when port could not be created
+ */
+TM_BUTTON_Port_t* TM_BUTTON_InitPort(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pins, uint16_t PressedHigh);
+
+/**
+ * @brief  Gets next event from port scanning event queue
+ * @param  *Event: Pointer to @ref TM_BUTTON_Event_t structure to save event
+ * @retval Event status:
+ *            - 0: No event available
+ *            - > 0: Event saved to structure
+ */
+uint8_t TM_BUTTON_GetEvent(TM_BUTTON_Event_t* Event);
+
+/**
+ * @brief  Gets number of events lost because queue was full
+ * @param  None
+ * @retval Number of lost events
+ */
+uint32_t TM_BUTTON_EventsLost(void);
+
 /**
  * @}
  */
@@ -0,0 +1,555 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+
+ */
+#include "tm_stm32_can.h"
+
+/* Private structure for each CAN */
+typedef struct {
+	TM_CAN_Frame_t Rx[CAN_RX_BUFFER_SIZE];   /* RX ring, written in interrupt only */
+	volatile uint16_t RxIn;
+	volatile uint16_t RxOut;
+	TM_CAN_Frame_t Tx[CAN_TX_QUEUE_SIZE];    /* TX queue, sorted with highest priority frame at the end */
+	volatile uint16_t TxCount;
+	uint8_t NextBank;                        /* Next free filter bank, relative to first bank of CAN */
+	volatile uint32_t Received;
+	volatile uint32_t Dropped;
+	volatile uint32_t Sent;
+} TM_CAN_INT_t;
+
+/* Private variables */
+static TM_CAN_INT_t CAN1_Data;
+#ifdef CAN2
+static TM_CAN_INT_t CAN2_Data;
+#endif
+
+/* Timeout for init mode changes in milliseconds */
+#define CAN_INIT_TIMEOUT         10
+
+/* Private functions */
+static TM_CAN_INT_t* TM_CAN_INT_GetData(CAN_TypeDef* CANx);
+static uint8_t TM_CAN_INT_FirstBank(CAN_TypeDef* CANx);
+static TM_CAN_Result_t TM_CAN_INT_SetMode(CAN_TypeDef* CANx, uint8_t init);
+static TM_CAN_Result_t TM_CAN_INT_AddFilter(CAN_TypeDef* CANx, uint8_t list, uint32_t FR1, uint32_t FR2, uint8_t Fifo);
+static uint32_t TM_CAN_INT_FilterID(uint32_t ID);
+static uint32_t TM_CAN_INT_Priority(const TM_CAN_Frame_t* Frame);
+static void TM_CAN_INT_WriteMailbox(CAN_TypeDef* CANx, const TM_CAN_Frame_t* Frame);
+static void TM_CAN_INT_ReadFifo(CAN_TypeDef* CANx, uint8_t fifo);
+static void TM_CAN_INT_TxIRQ(CAN_TypeDef* CANx);
+static void TM_CAN_INT_InitPins(CAN_TypeDef* CANx, TM_CAN_PinsPack_t pinspack);
+
+TM_CAN_Result_t TM_CAN_Init(CAN_TypeDef* CANx, TM_CAN_PinsPack_t pinspack, uint32_t bitrate) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint32_t pclk, prescaler = 0, tq, bs1 = 0, bs2 = 0;
+	
+	/* Check valid CAN */
+	if (Data == NULL || bitrate == 0) {
+		return TM_CAN_Result_Error;
+	}
+	
+	/* Find time quanta per bit for exact bitrate, more quanta is better */
+	pclk = HAL_RCC_GetPCLK1Freq();
+	for (tq = 25; tq >= 8; tq--) {
+		if ((pclk % (bitrate * tq)) == 0 && (pclk / (bitrate * tq)) <= 1024) {
+			/* Sample point at about 87.5% */
+			prescaler = pclk / (bitrate * tq);
+			bs1 = tq * 7 / 8 - 1;
+			bs2 = tq - 1 - bs1;
+			if (bs1 <= 16 && bs2 <= 8) {
+				break;
+			}
+		}
+		prescaler = 0;
+	}
+	
+	/* Bitrate can not be made */
+	if (prescaler == 0) {
+		return TM_CAN_Result_Error;
+	}
+	
+	/* Enable clock, CAN2 needs CAN1 clock for filters */
+	RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
+#ifdef CAN2
+	if (CANx == CAN2) {
+		RCC->APB1ENR |= RCC_APB1ENR_CAN2EN;
+	}
+#endif
+	(void)RCC->APB1ENR;
+	
+	/* Init pins */
+	TM_CAN_INT_InitPins(CANx, pinspack);
+	
+	/* Exit sleep and enter init mode */
+	if (TM_CAN_INT_SetMode(CANx, 1) != TM_CAN_Result_Ok) {
+		return TM_CAN_Result_Error;
+	}
+	
+	/* Automatic bus-off recovery and wakeup, mailboxes sent by identifier priority */
+	CANx->MCR = CAN_MCR_INRQ | CAN_MCR_ABOM | CAN_MCR_AWUM;
+	
+	/* Bit timing, SJW is 1 quantum */
+	CANx->BTR = ((bs2 - 1) << 20) | ((bs1 - 1) << 16) | (prescaler - 1);
+	
+	/* Clear state */
+	memset(Data, 0, sizeof(TM_CAN_INT_t));
+	
+	/* Split filter banks between CAN1 and CAN2 and clear filters of this CAN */
+#ifdef CAN2
+	CAN1->FMR |= CAN_FMR_FINIT;
+	CAN1->FMR = (CAN1->FMR & ~CAN_FMR_CAN2SB) | (TM_CAN_FILTER_BANKS << 8);
+	CAN1->FMR &= ~CAN_FMR_FINIT;
+#endif
+	TM_CAN_ClearFilters(CANx);
+	
+	/* Enable interrupts for both FIFOs and TX mailboxes */
+	CANx->IER = CAN_IER_FMPIE0 | CAN_IER_FOVIE0 | CAN_IER_FMPIE1 | CAN_IER_FOVIE1 | CAN_IER_TMEIE;
+	if (CANx == CAN1) {
+		HAL_NVIC_SetPriority(CAN1_TX_IRQn, CAN_NVIC_PRIORITY, 0);
+		HAL_NVIC_SetPriority(CAN1_RX0_IRQn, CAN_NVIC_PRIORITY, 0);
+		HAL_NVIC_SetPriority(CAN1_RX1_IRQn, CAN_NVIC_PRIORITY, 0);
+		HAL_NVIC_EnableIRQ(CAN1_TX_IRQn);
+		HAL_NVIC_EnableIRQ(CAN1_RX0_IRQn);
+		HAL_NVIC_EnableIRQ(CAN1_RX1_IRQn);
+	}
+#ifdef CAN2
+	if (CANx == CAN2) {
+		HAL_NVIC_SetPriority(CAN2_TX_IRQn, CAN_NVIC_PRIORITY, 0);
+		HAL_NVIC_SetPriority(CAN2_RX0_IRQn, CAN_NVIC_PRIORITY, 0);
+		HAL_NVIC_SetPriority(CAN2_RX1_IRQn, CAN_NVIC_PRIORITY, 0);
+		HAL_NVIC_EnableIRQ(CAN2_TX_IRQn);
+		HAL_NVIC_EnableIRQ(CAN2_RX0_IRQn);
+		HAL_NVIC_EnableIRQ(CAN2_RX1_IRQn);
+	}
+#endif
+	
+	/* Leave init mode, peripheral waits for 11 recessive bits on bus */
+	return TM_CAN_INT_SetMode(CANx, 0);
+}
+
+TM_CAN_Result_t TM_CAN_AddFilterList(CAN_TypeDef* CANx, uint32_t ID1, uint32_t ID2, uint8_t Fifo) {
+	/* Both registers hold identifier */
+	return TM_CAN_INT_AddFilter(CANx, 1, TM_CAN_INT_FilterID(ID1), TM_CAN_INT_FilterID(ID2), Fifo);
+}
+
+TM_CAN_Result_t TM_CAN_AddFilterMask(CAN_TypeDef* CANx, uint32_t ID, uint32_t Mask, uint8_t Fifo) {
+	/* IDE bit is always compared, so standard and extended identifiers do not match each other */
+	return TM_CAN_INT_AddFilter(CANx, 0, TM_CAN_INT_FilterID(ID), TM_CAN_INT_FilterID(Mask | (ID & TM_CAN_ID_EXT)), Fifo);
+}
+
+TM_CAN_Result_t TM_CAN_AcceptAll(CAN_TypeDef* CANx, uint8_t Fifo) {
+	/* Mask with no bits compared */
+	return TM_CAN_INT_AddFilter(CANx, 0, 0, 0, Fifo);
+}
+
+void TM_CAN_ClearFilters(CAN_TypeDef* CANx) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint32_t banks = ((1UL << TM_CAN_FILTER_BANKS) - 1) << TM_CAN_INT_FirstBank(CANx);
+	
+	/* Check valid CAN */
+	if (Data == NULL) {
+		return;
+	}
+	
+	/* Deactivate all banks of CAN, filter registers are in CAN1 only */
+	CAN1->FMR |= CAN_FMR_FINIT;
+	CAN1->FA1R &= ~banks;
+	CAN1->FMR &= ~CAN_FMR_FINIT;
+	
+	/* All banks are free */
+	Data->NextBank = 0;
+}
+
+TM_CAN_Result_t TM_CAN_Send(CAN_TypeDef* CANx, const TM_CAN_Frame_t* Frame) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint32_t primask, priority;
+	uint16_t i;
+	
+	/* Check parameters */
+	if (Data == NULL || Frame->DLC > 8) {
+		return TM_CAN_Result_Error;
+	}
+	
+	/* TX interrupt changes queue too */
+	primask = TM_NVIC_Lock();
+	
+	/* Use free mailbox directly when nothing waits, otherwise queue keeps priority order */
+	if (Data->TxCount == 0 && (CANx->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2))) {
+		TM_CAN_INT_WriteMailbox(CANx, Frame);
+		Data->Sent++;
+	} else if (Data->TxCount >= CAN_TX_QUEUE_SIZE) {
+		/* Queue is full */
+		TM_NVIC_Unlock(primask);
+		return TM_CAN_Result_Full;
+	} else {
+		/* Find place, frames with higher or the same priority stay after new frame */
+		priority = TM_CAN_INT_Priority(Frame);
+		for (i = 0; i < Data->TxCount && TM_CAN_INT_Priority(&Data->Tx[i]) > priority; i++);
+		
+		/* Insert frame */
+		memmove(&Data->Tx[i + 1], &Data->Tx[i], (Data->TxCount - i) * sizeof(TM_CAN_Frame_t));
+		Data->Tx[i] = *Frame;
+		Data->TxCount++;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(primask);
+	
+	/* Return OK */
+	return TM_CAN_Result_Ok;
+}
+
+uint16_t TM_CAN_TxPending(CAN_TypeDef* CANx) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint16_t count;
+	
+	/* Check valid CAN */
+	if (Data == NULL) {
+		return 0;
+	}
+	
+	/* Queued frames and busy mailboxes */
+	count = Data->TxCount;
+	count += (CANx->TSR & CAN_TSR_TME0) ? 0 : 1;
+	count += (CANx->TSR & CAN_TSR_TME1) ? 0 : 1;
+	count += (CANx->TSR & CAN_TSR_TME2) ? 0 : 1;
+	
+	/* Return count */
+	return count;
+}
+
+uint8_t TM_CAN_Read(CAN_TypeDef* CANx, TM_CAN_Frame_t* Frame) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint16_t out;
+	
+	/* Check for frame */
+	if (Data == NULL || Data->RxIn == Data->RxOut) {
+		return 0;
+	}
+	
+	/* Copy frame before entry is given back to interrupt */
+	out = Data->RxOut;
+	*Frame = Data->Rx[out & (CAN_RX_BUFFER_SIZE - 1)];
+	Data->RxOut = out + 1;
+	
+	/* Frame was read */
+	return 1;
+}
+
+uint16_t TM_CAN_Available(CAN_TypeDef* CANx) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	
+	/* Check valid CAN */
+	if (Data == NULL) {
+		return 0;
+	}
+	
+	/* Indexes are free running */
+	return (uint16_t)(Data->RxIn - Data->RxOut);
+}
+
+void TM_CAN_GetStats(CAN_TypeDef* CANx, TM_CAN_Stats_t* Stats) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint32_t esr;
+	
+	/* Clear structure */
+	memset(Stats, 0, sizeof(TM_CAN_Stats_t));
+	
+	/* Check valid CAN */
+	if (Data == NULL) {
+		return;
+	}
+	
+	/* Software counters */
+	Stats->Received = Data->Received;
+	Stats->Dropped = Data->Dropped;
+	Stats->Sent = Data->Sent;
+	
+	/* Hardware error counters */
+	esr = CANx->ESR;
+	Stats->TxErrors = (esr >> 16) & 0xFF;
+	Stats->RxErrors = (esr >> 24) & 0xFF;
+	Stats->BusOff = (esr & CAN_ESR_BOFF) ? 1 : 0;
+}
+
+__weak void TM_CAN_RxCallback(CAN_TypeDef* CANx) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_CAN_RxCallback could be implemented in the user file
+	*/
+}
+
+__weak void TM_CAN_InitCustomPinsCallback(CAN_TypeDef* CANx, uint16_t AlternateFunction) {
+	/* Custom user function. */
+	/* In case user needs functionality for custom pins, this function should be declared outside this library */
+}
+
+/* Interrupt handlers */
+void CAN1_TX_IRQHandler(void) {
+	TM_CAN_INT_TxIRQ(CAN1);
+}
+
+void CAN1_RX0_IRQHandler(void) {
+	TM_CAN_INT_ReadFifo(CAN1, 0);
+}
+
+void CAN1_RX1_IRQHandler(void) {
+	TM_CAN_INT_ReadFifo(CAN1, 1);
+}
+
+#ifdef CAN2
+void CAN2_TX_IRQHandler(void) {
+	TM_CAN_INT_TxIRQ(CAN2);
+}
+
+void CAN2_RX0_IRQHandler(void) {
+	TM_CAN_INT_ReadFifo(CAN2, 0);
+}
+
+void CAN2_RX1_IRQHandler(void) {
+	TM_CAN_INT_ReadFifo(CAN2, 1);
+}
+#endif
+
+/* Private functions */
+static TM_CAN_INT_t* TM_CAN_INT_GetData(CAN_TypeDef* CANx) {
+	/* Get data for CAN */
+	if (CANx == CAN1) {
+		return &CAN1_Data;
+	}
+#ifdef CAN2
+	if (CANx == CAN2) {
+		return &CAN2_Data;
+	}
+#endif
+	
+	/* Invalid CAN */
+	return NULL;
+}
+
+static uint8_t TM_CAN_INT_FirstBank(CAN_TypeDef* CANx) {
+	/* CAN2 banks start after CAN1 banks */
+	return CANx == CAN1 ? 0 : TM_CAN_FILTER_BANKS;
+}
+
+static TM_CAN_Result_t TM_CAN_INT_SetMode(CAN_TypeDef* CANx, uint8_t init) {
+	uint32_t tickstart = HAL_GetTick();
+	
+	/* Request mode */
+	if (init) {
+		CANx->MCR &= ~CAN_MCR_SLEEP;
+		CANx->MCR |= CAN_MCR_INRQ;
+	} else {
+		CANx->MCR &= ~CAN_MCR_INRQ;
+	}
+	
+	/* Wait for acknowledge */
+	while (((CANx->MSR & CAN_MSR_INAK) ? 1 : 0) != init) {
+		if ((HAL_GetTick() - tickstart) > CAN_INIT_TIMEOUT) {
+			return TM_CAN_Result_Error;
+		}
+	}
+	
+	/* Return OK */
+	return TM_CAN_Result_Ok;
+}
+
+static TM_CAN_Result_t TM_CAN_INT_AddFilter(CAN_TypeDef* CANx, uint8_t list, uint32_t FR1, uint32_t FR2, uint8_t Fifo) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	uint32_t bank, bit;
+	
+	/* Check parameters */
+	if (Data == NULL || Fifo > 1) {
+		return TM_CAN_Result_Error;
+	}
+	
+	/* Check for free bank */
+	if (Data->NextBank >= TM_CAN_FILTER_BANKS) {
+		return TM_CAN_Result_Full;
+	}
+	bank = TM_CAN_INT_FirstBank(CANx) + Data->NextBank++;
+	bit = 1UL << bank;
+	
+	/* Filters can be changed in filter init mode only, registers are in CAN1 */
+	CAN1->FMR |= CAN_FMR_FINIT;
+	CAN1->FA1R &= ~bit;
+	
+	/* List or mask mode, 32-bit scale */
+	if (list) {
+		CAN1->FM1R |= bit;
+	} else {
+		CAN1->FM1R &= ~bit;
+	}
+	CAN1->FS1R |= bit;
+	
+	/* Select FIFO */
+	if (Fifo) {
+		CAN1->FFA1R |= bit;
+	} else {
+		CAN1->FFA1R &= ~bit;
+	}
+	
+	/* Set identifiers and activate bank */
+	CAN1->sFilterRegister[bank].FR1 = FR1;
+	CAN1->sFilterRegister[bank].FR2 = FR2;
+	CAN1->FA1R |= bit;
+	CAN1->FMR &= ~CAN_FMR_FINIT;
+	
+	/* Return OK */
+	return TM_CAN_Result_Ok;
+}
+
+static uint32_t TM_CAN_INT_FilterID(uint32_t ID) {
+	/* Format of filter and mailbox identifier registers, STID[31:21], EXID[20:3], IDE[2] */
+	if (ID & TM_CAN_ID_EXT) {
+		return ((ID & 0x1FFFFFFF) << 3) | CAN_TI0R_IDE;
+	}
+	return (ID & 0x7FF) << 21;
+}
+
+static uint32_t TM_CAN_INT_Priority(const TM_CAN_Frame_t* Frame) {
+	uint32_t rtr = Frame->RTR ? 1 : 0;
+	
+	/* Arbitration field as on bus, lower value wins. */
+	/* Base identifier[31:21], RTR or SRR[20], IDE[19], extended identifier[18:1], extended RTR[0] */
+	if (Frame->ID & TM_CAN_ID_EXT) {
+		return ((Frame->ID & 0x1FFFFFFF) >> 18) << 21 | (1UL << 20) | (1UL << 19) | ((Frame->ID & 0x3FFFF) << 1) | rtr;
+	}
+	return ((Frame->ID & 0x7FF) << 21) | (rtr << 20);
+}
+
+static void TM_CAN_INT_WriteMailbox(CAN_TypeDef* CANx, const TM_CAN_Frame_t* Frame) {
+	/* Get empty mailbox from hardware */
+	CAN_TxMailBox_TypeDef* Mailbox = &CANx->sTxMailBox[(CANx->TSR & CAN_TSR_CODE) >> 24];
+	
+	/* Fill mailbox */
+	Mailbox->TDTR = Frame->DLC;
+	Mailbox->TDLR = (uint32_t)Frame->Data[0] | ((uint32_t)Frame->Data[1] << 8) | ((uint32_t)Frame->Data[2] << 16) | ((uint32_t)Frame->Data[3] << 24);
+	Mailbox->TDHR = (uint32_t)Frame->Data[4] | ((uint32_t)Frame->Data[5] << 8) | ((uint32_t)Frame->Data[6] << 16) | ((uint32_t)Frame->Data[7] << 24);
+	
+	/* Set identifier and request transmission */
+	Mailbox->TIR = TM_CAN_INT_FilterID(Frame->ID) | (Frame->RTR ? CAN_TI0R_RTR : 0) | CAN_TI0R_TXRQ;
+}
+
+static void TM_CAN_INT_ReadFifo(CAN_TypeDef* CANx, uint8_t fifo) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	CAN_FIFOMailBox_TypeDef* Mailbox = &CANx->sFIFOMailBox[fifo];
+	__IO uint32_t* RFR = fifo ? &CANx->RF1R : &CANx->RF0R;
+	TM_CAN_Frame_t* Frame;
+	uint32_t rir, rdtr, rdlr, rdhr;
+	
+	/* Empty hardware FIFO, up to 3 frames */
+	while (*RFR & CAN_RF0R_FMP0) {
+		/* Read mailbox */
+		rir = Mailbox->RIR;
+		rdtr = Mailbox->RDTR;
+		rdlr = Mailbox->RDLR;
+		rdhr = Mailbox->RDHR;
+		
+		/* Release mailbox */
+		*RFR = CAN_RF0R_RFOM0;
+		
+		/* Check for space in ring */
+		if ((uint16_t)(Data->RxIn - Data->RxOut) >= CAN_RX_BUFFER_SIZE) {
+			Data->Dropped++;
+			continue;
+		}
+		
+		/* Save frame */
+		Frame = &Data->Rx[Data->RxIn & (CAN_RX_BUFFER_SIZE - 1)];
+		if (rir & CAN_RI0R_IDE) {
+			Frame->ID = (rir >> 3) | TM_CAN_ID_EXT;
+		} else {
+			Frame->ID = rir >> 21;
+		}
+		Frame->RTR = (rir & CAN_RI0R_RTR) ? 1 : 0;
+		Frame->DLC = rdtr & 0x0F;
+		Frame->Filter = (rdtr >> 8) & 0xFF;
+		Frame->Data[0] = rdlr;
+		Frame->Data[1] = rdlr >> 8;
+		Frame->Data[2] = rdlr >> 16;
+		Frame->Data[3] = rdlr >> 24;
+		Frame->Data[4] = rdhr;
+		Frame->Data[5] = rdhr >> 8;
+		Frame->Data[6] = rdhr >> 16;
+		Frame->Data[7] = rdhr >> 24;
+		
+		/* Give frame to reader */
+		Data->RxIn++;
+		Data->Received++;
+	}
+	
+	/* Frame was lost in hardware FIFO */
+	if (*RFR & CAN_RF0R_FOVR0) {
+		*RFR = CAN_RF0R_FOVR0;
+		Data->Dropped++;
+	}
+	
+	/* Call user function */
+	TM_CAN_RxCallback(CANx);
+}
+
+static void TM_CAN_INT_TxIRQ(CAN_TypeDef* CANx) {
+	TM_CAN_INT_t* Data = TM_CAN_INT_GetData(CANx);
+	
+	/* Clear request completed flags, they trigger interrupt */
+	CANx->TSR = CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2;
+	
+	/* Refill free mailboxes with highest priority frames */
+	while (Data->TxCount && (CANx->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2))) {
+		TM_CAN_INT_WriteMailbox(CANx, &Data->Tx[--Data->TxCount]);
+		Data->Sent++;
+	}
+}
+
+static void TM_CAN_INT_InitPins(CAN_TypeDef* CANx, TM_CAN_PinsPack_t pinspack) {
+	/* Custom pins */
+	if (pinspack == TM_CAN_PinsPack_Custom) {
+		TM_CAN_InitCustomPinsCallback(CANx, GPIO_AF9_CAN1);
+		return;
+	}
+	
+	/* CAN1 pins */
+	if (CANx == CAN1) {
+		if (pinspack == TM_CAN_PinsPack_1) {
+			TM_GPIO_InitAlternate(GPIOA, GPIO_PIN_11 | GPIO_PIN_12, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF9_CAN1);
+		}
+		if (pinspack == TM_CAN_PinsPack_2) {
+			TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_8 | GPIO_PIN_9, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF9_CAN1);
+		}
+		if (pinspack == TM_CAN_PinsPack_3) {
+			TM_GPIO_InitAlternate(GPIOD, GPIO_PIN_0 | GPIO_PIN_1, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF9_CAN1);
+		}
+	}
+#ifdef CAN2
+	/* CAN2 pins */
+	if (CANx == CAN2) {
+		if (pinspack == TM_CAN_PinsPack_1) {
+			TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_12 | GPIO_PIN_13, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF9_CAN2);
+		}
+		if (pinspack == TM_CAN_PinsPack_2) {
+			TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_5 | GPIO_PIN_6, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF9_CAN2);
+		}
+	}
+#endif
+}
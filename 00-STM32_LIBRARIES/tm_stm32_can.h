@@ -0,0 +1,382 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.1
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   CAN bus library with filters, RX ring and TX queue for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_CAN_H
+#define TM_CAN_H 110
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_CAN
+ * @brief    CAN bus library with filters, RX ring and TX queue for STM32Fxxx
+ * @{
+ *
+ * Library works with bxCAN peripheral directly on registers, HAL CAN driver is not used.
+ *
+ * \par Pinout
+ *
+\verbatim
+       |PINSPACK 1   |PINSPACK 2   |PINSPACK 3
+CANX   |RX    TX     |RX    TX     |RX    TX
+       |             |             |
+CAN1   |PA11  PA12   |PB8   PB9    |PD0   PD1
+CAN2   |PB12  PB13   |PB5   PB6    |-     -
+\endverbatim
+ *
+ * CAN2 uses filter banks and clock of CAN1, CAN1 clock is enabled too when CAN2 is initialized.
+ *
+ * \par Filters
+ *
+ * Peripheral receives only frames which pass at least one hardware filter, other frames cost no CPU time at all.
+ * There are 28 filter banks, 14 for CAN1 and 14 for CAN2. One bank holds:
+ *  - 2 identifiers in list mode with @ref TM_CAN_AddFilterList
+ *  - Identifier and mask in mask mode with @ref TM_CAN_AddFilterMask
+ *
+ * Each filter sends matched frames to FIFO 0 or FIFO 1. Extended identifiers are ORed with @ref TM_CAN_ID_EXT.
+ *
+ * \par Receive
+ *
+ * Both hardware FIFOs are emptied in interrupts to RX ring of @ref CAN_RX_BUFFER_SIZE frames.
+ * Interrupt is the only writer and @ref TM_CAN_Read the only reader, so ring needs no locking.
+ * When ring is full, new frames are dropped and counted.
+ *
+ * \par Transmit
+ *
+ * Frames go directly to free TX mailbox. When all 3 mailboxes are busy, frames wait in TX queue ordered by priority,
+ * the same as on CAN bus: lower identifier first and standard before extended with the same base identifier.
+ * Frames with the same identifier are sent in order of @ref TM_CAN_Send calls.
+ * Mailboxes are refilled from queue in TX interrupt. Hardware sends mailbox with highest priority first.
+ *
+\code
+TM_CAN_Frame_t frame;
+
+//Init CAN1 at 500kbit/s, receive standard 0x100 to 0x10F to FIFO 0 and extended 0x18FF0001 to FIFO 1
+TM_CAN_Init(CAN1, TM_CAN_PinsPack_1, 500000);
+TM_CAN_AddFilterMask(CAN1, 0x100, 0x7F0, 0);
+TM_CAN_AddFilterList(CAN1, 0x18FF0001 | TM_CAN_ID_EXT, 0x18FF0001 | TM_CAN_ID_EXT, 1);
+
+//Send frame
+frame.ID = 0x200;
+frame.DLC = 2;
+frame.RTR = 0;
+frame.Data[0] = 0x12;
+frame.Data[1] = 0x34;
+TM_CAN_Send(CAN1, &frame);
+
+//Process received frames
+while (TM_CAN_Read(CAN1, &frame)) {
+	//Frame is in frame structure
+}
+\endcode
+ *
+ * \par Settings
+ *
+\code
+//Number of frames in RX ring for each CAN, power of 2
+#define CAN_RX_BUFFER_SIZE       32
+
+//Number of frames in TX queue for each CAN
+#define CAN_TX_QUEUE_SIZE        16
+
+//NVIC preemption priority for CAN interrupts
+#define CAN_NVIC_PRIORITY        0x05
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+  - Default NVIC priority is taken from TM NVIC priority plan
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - attributes.h
+ - TM GPIO
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+#include "tm_stm32_gpio.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_CAN_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Check device */
+#if !defined(CAN1)
+#error "TM CAN library needs MCU with bxCAN peripheral!"
+#endif
+
+/* Number of frames in RX ring */
+#ifndef CAN_RX_BUFFER_SIZE
+#define CAN_RX_BUFFER_SIZE       32
+#endif
+
+/* Number of frames in TX queue */
+#ifndef CAN_TX_QUEUE_SIZE
+#define CAN_TX_QUEUE_SIZE        16
+#endif
+
+/* NVIC preemption priority */
+#ifndef CAN_NVIC_PRIORITY
+#define CAN_NVIC_PRIORITY        NVIC_PRIORITY_HIGH
+#endif
+
+/* Ring index wraps with mask */
+#if (CAN_RX_BUFFER_SIZE & (CAN_RX_BUFFER_SIZE - 1)) != 0
+#error "CAN_RX_BUFFER_SIZE must be power of 2!"
+#endif
+
+/**
+ * @brief  Flag for extended 29-bit identifier, OR it with identifier
+ */
+#define TM_CAN_ID_EXT            ((uint32_t)0x80000000)
+
+/**
+ * @brief  Number of filter banks for each CAN
+ */
+#define TM_CAN_FILTER_BANKS      14
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_CAN_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  CAN pinspack enumeration
+ */
+typedef enum {
+	TM_CAN_PinsPack_1 = 0x00, /*!< Use Pinspack1 from Pinout table for CANx */
+	TM_CAN_PinsPack_2,        /*!< Use Pinspack2 from Pinout table for CANx */
+	TM_CAN_PinsPack_3,        /*!< Use Pinspack3 from Pinout table for CANx */
+	TM_CAN_PinsPack_Custom    /*!< Use custom pins for CANx, callback will be called, look @ref TM_CAN_InitCustomPinsCallback */
+} TM_CAN_PinsPack_t;
+
+/**
+ * @brief  CAN result enumeration
+ */
+typedef enum {
+	TM_CAN_Result_Ok = 0x00,  /*!< Everything OK */
+	TM_CAN_Result_Error,      /*!< An error occurred, invalid parameter or peripheral did not respond */
+	TM_CAN_Result_Full        /*!< No free TX mailbox and TX queue is full, or no free filter bank */
+} TM_CAN_Result_t;
+
+/**
+ * @brief  CAN frame
+ */
+typedef struct {
+	uint32_t ID;              /*!< Identifier, ORed with @ref TM_CAN_ID_EXT for extended identifier */
+	uint8_t DLC;              /*!< Number of data bytes, 0 to 8 */
+	uint8_t RTR;              /*!< Set to 1 for remote frame */
+	uint8_t Filter;           /*!< Filter match index of received frame, from hardware */
+	uint8_t Data[8];          /*!< Data bytes */
+} TM_CAN_Frame_t;
+
+/**
+ * @brief  CAN statistics
+ */
+typedef struct {
+	uint32_t Received;        /*!< Frames saved to RX ring */
+	uint32_t Dropped;         /*!< Frames lost because RX ring was full or hardware FIFO overrun */
+	uint32_t Sent;            /*!< Frames given to TX mailboxes */
+	uint8_t TxErrors;         /*!< Transmit error counter from hardware */
+	uint8_t RxErrors;         /*!< Receive error counter from hardware */
+	uint8_t BusOff;           /*!< Set to 1 when peripheral is in bus-off state */
+} TM_CAN_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CAN_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes CAN peripheral, all filters of CAN are cleared
+ * @note   Bit timing is calculated from APB1 clock with sample point at about 87.5%
+ * @param  *CANx: Pointer to CANx peripheral, CAN1 or CAN2
+ * @param  pinspack: Pinspack used for GPIO initialization. This parameter can be a value of @ref TM_CAN_PinsPack_t enumeration
+ * @param  bitrate: Bitrate in units of bit/s, for example 500000
+ * @retval Member of @ref TM_CAN_Result_t enumeration:
+ *            - @ref TM_CAN_Result_Ok: CAN is initialized
+ *            - @ref TM_CAN_Result_Error: Bitrate can not be made from APB1 clock or peripheral did not respond
+ */
+TM_CAN_Result_t TM_CAN_Init(CAN_TypeDef* CANx, TM_CAN_PinsPack_t pinspack, uint32_t bitrate);
+
+/**
+ * @brief  Adds filter bank in list mode, frames with one of 2 identifiers are received
+ * @note   Use the same identifier twice for one identifier only
+ * @param  *CANx: Pointer to CANx peripheral
+ * @param  ID1: First identifier, ORed with @ref TM_CAN_ID_EXT for extended identifier
+ * @param  ID2: Second identifier, ORed with @ref TM_CAN_ID_EXT for extended identifier
+ * @param  Fifo: Hardware FIFO for matched frames, 0 or 1
+ * @retval Member of @ref TM_CAN_Result_t enumeration
+ */
+TM_CAN_Result_t TM_CAN_AddFilterList(CAN_TypeDef* CANx, uint32_t ID1, uint32_t ID2, uint8_t Fifo);
+
+/**
+ * @brief  Adds filter bank in mask mode, frames with identifier bits equal to ID in all bits set in mask are received
+ * @note   Standard and extended identifiers never match each other. Use @ref TM_CAN_AcceptAll to receive all frames
+ * @param  *CANx: Pointer to CANx peripheral
+ * @param  ID: Identifier, ORed with @ref TM_CAN_ID_EXT for extended identifier
+ * @param  Mask: Identifier bits to compare, 11 or 29 bits
+ * @param  Fifo: Hardware FIFO for matched frames, 0 or 1
+ * @retval Member of @ref TM_CAN_Result_t enumeration
+ */
+TM_CAN_Result_t TM_CAN_AddFilterMask(CAN_TypeDef* CANx, uint32_t ID, uint32_t Mask, uint8_t Fifo);
+
+/**
+ * @brief  Adds filter bank which receives all frames
+ * @param  *CANx: Pointer to CANx peripheral
+ * @param  Fifo: Hardware FIFO for frames, 0 or 1
+ * @retval Member of @ref TM_CAN_Result_t enumeration
+ */
+TM_CAN_Result_t TM_CAN_AcceptAll(CAN_TypeDef* CANx, uint8_t Fifo);
+
+/**
+ * @brief  Removes all filters of CAN, nothing is received after that
+ * @param  *CANx: Pointer to CANx peripheral
+ * @retval None
+ */
+void TM_CAN_ClearFilters(CAN_TypeDef* CANx);
+
+/**
+ * @brief  Sends frame or puts it to TX queue when all mailboxes are busy
+ * @note   Frame is copied, structure can be reused immediately
+ * @param  *CANx: Pointer to CANx peripheral
+ * @param  *Frame: Pointer to @ref TM_CAN_Frame_t structure with frame to send
+ * @retval Member of @ref TM_CAN_Result_t enumeration
+ */
+TM_CAN_Result_t TM_CAN_Send(CAN_TypeDef* CANx, const TM_CAN_Frame_t* Frame);
+
+/**
+ * @brief  Gets number of frames waiting to be sent, in mailboxes and in TX queue
+ * @param  *CANx: Pointer to CANx peripheral
+ * @retval Number of pending frames
+ */
+uint16_t TM_CAN_TxPending(CAN_TypeDef* CANx);
+
+/**
+ * @brief  Reads received frame from RX ring
+ * @param  *CANx: Pointer to CANx peripheral
+ * @param  *Frame: Pointer to @ref TM_CAN_Frame_t structure to save frame to
+ * @retval Read status:
+ *            - 0: There is no received frame
+ *            - > 0: Frame was read
+ */
+uint8_t TM_CAN_Read(CAN_TypeDef* CANx, TM_CAN_Frame_t* Frame);
+
+/**
+ * @brief  Gets number of frames in RX ring
+ * @param  *CANx: Pointer to CANx peripheral
+ * @retval Number of received frames
+ */
+uint16_t TM_CAN_Available(CAN_TypeDef* CANx);
+
+/**
+ * @brief  Gets CAN statistics and error counters
+ * @param  *CANx: Pointer to CANx peripheral
+ * @param  *Stats: Pointer to @ref TM_CAN_Stats_t structure to fill
+ * @retval None
+ */
+void TM_CAN_GetStats(CAN_TypeDef* CANx, TM_CAN_Stats_t* Stats);
+
+/**
+ * @brief  Frames received callback, called from RX interrupt after hardware FIFO was emptied to RX ring
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *CANx: Pointer to CANx peripheral
+ * @retval None
+ */
+void TM_CAN_RxCallback(CAN_TypeDef* CANx);
+
+/**
+ * @brief  Callback for custom pins initialization
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *CANx: Pointer to CANx peripheral which needs custom pins
+ * @param  AlternateFunction: Alternate function number which should be used for GPIO pins
+ * @retval None
+ */
+void TM_CAN_InitCustomPinsCallback(CAN_TypeDef* CANx, uint16_t AlternateFunction);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,461 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+
+ */
+#include "tm_stm32_capture.h"
+
+/* Private structure for pin table */
+typedef struct {
+	TIM_TypeDef* TIM;         /* Timer */
+	uint8_t Channel;          /* Channel index */
+	uint8_t PinsPack;         /* Pinspack */
+	GPIO_TypeDef* GPIOx;      /* GPIO port */
+	uint16_t Pin;             /* GPIO pin */
+} TM_CAPTURE_INT_Pin_t;
+
+/* Pins for channels, see pinout table in header */
+static const TM_CAPTURE_INT_Pin_t CAPTURE_Pins[] = {
+	{TIM1, 0, 0, GPIOA, GPIO_PIN_8},  {TIM1, 1, 0, GPIOA, GPIO_PIN_9},  {TIM1, 2, 0, GPIOA, GPIO_PIN_10}, {TIM1, 3, 0, GPIOA, GPIO_PIN_11},
+	{TIM1, 0, 1, GPIOE, GPIO_PIN_9},  {TIM1, 1, 1, GPIOE, GPIO_PIN_11}, {TIM1, 2, 1, GPIOE, GPIO_PIN_13}, {TIM1, 3, 1, GPIOE, GPIO_PIN_14},
+	{TIM2, 0, 0, GPIOA, GPIO_PIN_0},  {TIM2, 1, 0, GPIOA, GPIO_PIN_1},  {TIM2, 2, 0, GPIOA, GPIO_PIN_2},  {TIM2, 3, 0, GPIOA, GPIO_PIN_3},
+	{TIM2, 0, 1, GPIOA, GPIO_PIN_5},  {TIM2, 1, 1, GPIOB, GPIO_PIN_3},  {TIM2, 2, 1, GPIOB, GPIO_PIN_10}, {TIM2, 3, 1, GPIOB, GPIO_PIN_11},
+	{TIM2, 0, 2, GPIOA, GPIO_PIN_15},
+	{TIM3, 0, 0, GPIOA, GPIO_PIN_6},  {TIM3, 1, 0, GPIOA, GPIO_PIN_7},  {TIM3, 2, 0, GPIOB, GPIO_PIN_0},  {TIM3, 3, 0, GPIOB, GPIO_PIN_1},
+	{TIM3, 0, 1, GPIOB, GPIO_PIN_4},  {TIM3, 1, 1, GPIOB, GPIO_PIN_5},  {TIM3, 2, 1, GPIOC, GPIO_PIN_8},  {TIM3, 3, 1, GPIOC, GPIO_PIN_9},
+	{TIM3, 0, 2, GPIOC, GPIO_PIN_6},  {TIM3, 1, 2, GPIOC, GPIO_PIN_7},
+	{TIM4, 0, 0, GPIOB, GPIO_PIN_6},  {TIM4, 1, 0, GPIOB, GPIO_PIN_7},  {TIM4, 2, 0, GPIOB, GPIO_PIN_8},
+	{TIM4, 0, 1, GPIOD, GPIO_PIN_12}, {TIM4, 1, 1, GPIOD, GPIO_PIN_13}, {TIM4, 2, 1, GPIOD, GPIO_PIN_14},
+	{TIM5, 0, 0, GPIOA, GPIO_PIN_0},  {TIM5, 1, 0, GPIOA, GPIO_PIN_1},  {TIM5, 2, 0, GPIOA, GPIO_PIN_2},  {TIM5, 3, 0, GPIOA, GPIO_PIN_3},
+#if defined(GPIOI)
+	{TIM5, 0, 1, GPIOH, GPIO_PIN_10}, {TIM5, 1, 1, GPIOH, GPIO_PIN_11}, {TIM5, 2, 1, GPIOH, GPIO_PIN_12}, {TIM5, 3, 1, GPIOI, GPIO_PIN_0},
+#endif
+#if defined(TIM8)
+	{TIM8, 0, 0, GPIOC, GPIO_PIN_6},  {TIM8, 1, 0, GPIOC, GPIO_PIN_7},  {TIM8, 2, 0, GPIOC, GPIO_PIN_8},  {TIM8, 3, 0, GPIOC, GPIO_PIN_9},
+#if defined(GPIOI)
+	{TIM8, 0, 1, GPIOI, GPIO_PIN_5},  {TIM8, 1, 1, GPIOI, GPIO_PIN_6},  {TIM8, 2, 1, GPIOI, GPIO_PIN_7},  {TIM8, 3, 1, GPIOI, GPIO_PIN_2},
+#endif
+#endif
+};
+
+/* DMA burst address of CCR1 register, in words from timer base */
+#define CAPTURE_DBA_CCR1         13
+
+/* Input modes */
+#define CAPTURE_MODE_NONE        0
+#define CAPTURE_MODE_TIMESTAMP   1
+#define CAPTURE_MODE_PWMINPUT    2
+
+/* Private functions */
+static uint8_t TM_CAPTURE_INT_GetInfo(TIM_TypeDef* TIMx, uint32_t* Clock, uint8_t* AF, TM_DMA_Request_t* Request, uint8_t* Channels);
+static uint8_t TM_CAPTURE_INT_InitPin(TIM_TypeDef* TIMx, TM_CAPTURE_Channel_t Channel, TM_CAPTURE_PinsPack_t PinsPack);
+static uint8_t TM_CAPTURE_INT_StartDMA(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel, uint32_t Source);
+
+TM_CAPTURE_Result_t TM_CAPTURE_Init(TM_CAPTURE_t* Capture, TIM_TypeDef* TIMx, uint32_t TickFrequency) {
+	uint32_t clock, prescaler;
+	uint8_t af, channels;
+	TM_DMA_Request_t request;
+	
+	/* Get timer clock */
+	if (!TM_CAPTURE_INT_GetInfo(TIMx, &clock, &af, &request, &channels)) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Prescaler is 16-bit */
+	prescaler = TickFrequency ? clock / TickFrequency : 1;
+	if (prescaler == 0 || prescaler > 0x10000) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Clear structure */
+	memset(Capture, 0, sizeof(TM_CAPTURE_t));
+	Capture->TIM = TIMx;
+	Capture->TickFrequency = clock / prescaler;
+	Capture->Mask = (TIMx == TIM2 || TIMx == TIM5) ? 0xFFFFFFFF : 0xFFFF;
+	
+	/* Counter runs over full range */
+	TIMx->CR1 = 0;
+	TIMx->SMCR = 0;
+	TIMx->DIER = 0;
+	TIMx->PSC = prescaler - 1;
+	TIMx->ARR = Capture->Mask;
+	
+	/* Load settings and start counter */
+	TIMx->EGR = TIM_EGR_UG;
+	TIMx->CR1 = TIM_CR1_CEN;
+	
+	/* Return OK */
+	return TM_CAPTURE_Result_Ok;
+}
+
+TM_CAPTURE_Result_t TM_CAPTURE_InitChannel(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel, TM_CAPTURE_PinsPack_t PinsPack, TM_CAPTURE_Edge_t Edge, uint32_t* Buffer, uint16_t Size) {
+	TIM_TypeDef* TIMx = Capture->TIM;
+	TM_CAPTURE_Input_t* Input = &Capture->Inputs[Channel & 0x03];
+	volatile uint32_t* CCMR;
+	uint32_t clock, shift;
+	uint8_t af, channels;
+	TM_DMA_Request_t request;
+	
+	/* Check parameters, PWM input mode uses channels 1 and 2 */
+	if (
+		!TM_CAPTURE_INT_GetInfo(TIMx, &clock, &af, &request, &channels) ||
+		Channel >= channels || Size < 2 || Input->Mode != CAPTURE_MODE_NONE ||
+		(Channel <= TM_CAPTURE_Channel_2 && Capture->Inputs[0].Mode == CAPTURE_MODE_PWMINPUT)
+	) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Init pin */
+	if (!TM_CAPTURE_INT_InitPin(TIMx, Channel, PinsPack)) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Disable channel for configuration */
+	TIMx->CCER &= ~((TIM_CCER_CC1E | TIM_CCER_CC1P | TIM_CCER_CC1NP) << (Channel * 4));
+	
+	/* Input capture from own pin, every edge */
+	CCMR = Channel < TM_CAPTURE_Channel_3 ? &TIMx->CCMR1 : &TIMx->CCMR2;
+	shift = (Channel & 0x01) * 8;
+	*CCMR = (*CCMR & ~(0xFFUL << shift)) | ((TIM_CCMR1_CC1S_0 | ((CAPTURE_INPUT_FILTER & 0x0F) << 4)) << shift);
+	
+	/* Enable channel with selected edge */
+	TIMx->CCER |= (TIM_CCER_CC1E | (Edge == TM_CAPTURE_Edge_Falling ? TIM_CCER_CC1P : 0)) << (Channel * 4);
+	
+	/* Save input */
+	Input->Buffer = Buffer;
+	Input->Size = Size;
+	Input->Read = 0;
+	Input->HasLast = 0;
+	
+	/* Each capture is saved from CCR register to buffer */
+	if (!TM_CAPTURE_INT_StartDMA(Capture, Channel, (uint32_t)(&TIMx->CCR1 + Channel))) {
+		TIMx->CCER &= ~(TIM_CCER_CC1E << (Channel * 4));
+		return TM_CAPTURE_Result_Error;
+	}
+	Input->Mode = CAPTURE_MODE_TIMESTAMP;
+	
+	/* Request DMA on capture */
+	TIMx->DIER |= TIM_DIER_CC1DE << Channel;
+	
+	/* Return OK */
+	return TM_CAPTURE_Result_Ok;
+}
+
+TM_CAPTURE_Result_t TM_CAPTURE_InitPWMInput(TM_CAPTURE_t* Capture, TM_CAPTURE_PinsPack_t PinsPack, uint32_t* Buffer, uint16_t Pairs) {
+	TIM_TypeDef* TIMx = Capture->TIM;
+	TM_CAPTURE_Input_t* Input = &Capture->Inputs[0];
+	
+	/* Check parameters, channels 1 and 2 must be free */
+	if (Pairs < 2 || Pairs > 0x7FFF || Input->Mode != CAPTURE_MODE_NONE || Capture->Inputs[1].Mode != CAPTURE_MODE_NONE) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Init channel 1 pin */
+	if (!TM_CAPTURE_INT_InitPin(TIMx, TM_CAPTURE_Channel_1, PinsPack)) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Disable channels 1 and 2 for configuration */
+	TIMx->CCER &= ~(0xFFUL);
+	
+	/* Both channels capture TI1, channel 1 on rising and channel 2 on falling edge */
+	TIMx->CCMR1 = TIM_CCMR1_CC1S_0 | ((CAPTURE_INPUT_FILTER & 0x0F) << 4) | TIM_CCMR1_CC2S_1 | ((CAPTURE_INPUT_FILTER & 0x0F) << 12);
+	TIMx->CCER |= TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC2P;
+	
+	/* Reset counter on rising edge, so CCR1 is period and CCR2 is high time */
+	TIMx->SMCR = TIM_SMCR_TS_2 | TIM_SMCR_TS_0 | TIM_SMCR_SMS_2;
+	
+	/* Burst of 2 reads from CCR1 and CCR2 on channel 1 request */
+	TIMx->DCR = (1UL << 8) | CAPTURE_DBA_CCR1;
+	
+	/* Save input */
+	Input->Buffer = Buffer;
+	Input->Size = Pairs * 2;
+	Input->Read = 0;
+	Input->HasLast = 0;
+	
+	/* Start DMA from burst register */
+	if (!TM_CAPTURE_INT_StartDMA(Capture, TM_CAPTURE_Channel_1, (uint32_t)&TIMx->DMAR)) {
+		TIMx->SMCR = 0;
+		TIMx->CCER &= ~(0xFFUL);
+		return TM_CAPTURE_Result_Error;
+	}
+	Input->Mode = CAPTURE_MODE_PWMINPUT;
+	
+	/* Request DMA on rising edge */
+	TIMx->DIER |= TIM_DIER_CC1DE;
+	
+	/* Return OK */
+	return TM_CAPTURE_Result_Ok;
+}
+
+TM_CAPTURE_Result_t TM_CAPTURE_Measure(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel, TM_CAPTURE_Measurement_t* Result) {
+	TM_CAPTURE_Input_t* Input = &Capture->Inputs[Channel & 0x03];
+	uint64_t sum = 0, high = 0;
+	uint32_t period, pulse;
+	uint16_t write;
+	
+	/* Clear result */
+	memset(Result, 0, sizeof(TM_CAPTURE_Measurement_t));
+	Result->MinTicks = 0xFFFFFFFF;
+	
+	/* Check input */
+	if (Channel > TM_CAPTURE_Channel_4 || Input->Mode == CAPTURE_MODE_NONE) {
+		return TM_CAPTURE_Result_Error;
+	}
+	
+	/* Get position where DMA writes next */
+	write = Input->Size - Input->hdma.Instance->NDTR;
+	if (write >= Input->Size) {
+		write = 0;
+	}
+	
+	/* Only complete period and high time pairs */
+	if (Input->Mode == CAPTURE_MODE_PWMINPUT) {
+		write &= ~0x01;
+	}
+	
+	/* CPU must see data from DMA, not from cache */
+	TM_DMA_InvalidateCache(Input->Buffer, Input->Size * sizeof(uint32_t));
+	
+	/* Process new entries */
+	while (Input->Read != write) {
+		if (Input->Mode == CAPTURE_MODE_PWMINPUT) {
+			/* Period and high time of one period */
+			period = Input->Buffer[Input->Read];
+			pulse = Input->Buffer[Input->Read + 1];
+			Input->Read += 2;
+			
+			/* First pair was measured from random counter value */
+			if (!Input->HasLast) {
+				Input->HasLast = 1;
+				period = 0;
+			}
+			if (pulse > period) {
+				pulse = period;
+			}
+		} else {
+			/* Period is difference between timestamps */
+			pulse = Input->Buffer[Input->Read];
+			period = (pulse - Input->Last) & Capture->Mask;
+			if (!Input->HasLast) {
+				period = 0;
+			}
+			Input->Last = pulse;
+			Input->HasLast = 1;
+			Input->Read++;
+			pulse = 0;
+		}
+		
+		/* Wrap read position */
+		if (Input->Read >= Input->Size) {
+			Input->Read = 0;
+		}
+		
+		/* Add period to batch */
+		if (period) {
+			sum += period;
+			high += pulse;
+			Result->Count++;
+			if (period < Result->MinTicks) {
+				Result->MinTicks = period;
+			}
+			if (period > Result->MaxTicks) {
+				Result->MaxTicks = period;
+			}
+		}
+	}
+	
+	/* Check for new periods */
+	if (Result->Count == 0) {
+		Result->MinTicks = 0;
+		return TM_CAPTURE_Result_Empty;
+	}
+	
+	/* Calculate averages */
+	Result->Frequency = (float)Capture->TickFrequency * (float)Result->Count / (float)sum;
+	Result->Period = (float)sum / (float)Result->Count * 1000000.0f / (float)Capture->TickFrequency;
+	if (Input->Mode == CAPTURE_MODE_PWMINPUT) {
+		Result->Duty = (float)high * 100.0f / (float)sum;
+	}
+	
+	/* Return OK */
+	return TM_CAPTURE_Result_Ok;
+}
+
+void TM_CAPTURE_Stop(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel) {
+	TIM_TypeDef* TIMx = Capture->TIM;
+	TM_CAPTURE_Input_t* Input = &Capture->Inputs[Channel & 0x03];
+	uint32_t clock;
+	uint8_t af, channels;
+	TM_DMA_Request_t request;
+	
+	/* Check input */
+	if (Channel > TM_CAPTURE_Channel_4 || Input->Mode == CAPTURE_MODE_NONE) {
+		return;
+	}
+	
+	/* Stop DMA requests and channel */
+	TIMx->DIER &= ~(TIM_DIER_CC1DE << Channel);
+	TIMx->CCER &= ~(TIM_CCER_CC1E << (Channel * 4));
+	
+	/* PWM input uses channel 2 and slave mode too */
+	if (Input->Mode == CAPTURE_MODE_PWMINPUT) {
+		TIMx->CCER &= ~TIM_CCER_CC2E;
+		TIMx->SMCR = 0;
+	}
+	
+	/* Stop stream */
+	Input->hdma.Instance->CR &= ~DMA_SxCR_EN;
+	while (Input->hdma.Instance->CR & DMA_SxCR_EN);
+	TM_DMA_ClearFlags(Input->hdma.Instance);
+	
+	/* Release stream */
+	TM_CAPTURE_INT_GetInfo(TIMx, &clock, &af, &request, &channels);
+	TM_DMA_Release(Input->hdma.Instance, (TM_DMA_Request_t)(request + Channel));
+	Input->hdma.Instance = NULL;
+	Input->Mode = CAPTURE_MODE_NONE;
+}
+
+__weak void TM_CAPTURE_InitCustomPinsCallback(TIM_TypeDef* TIMx, TM_CAPTURE_Channel_t Channel, uint16_t AlternateFunction) {
+	/* Custom user function. */
+	/* In case user needs functionality for custom pins, this function should be declared outside this library */
+}
+
+/* Private functions */
+static uint8_t TM_CAPTURE_INT_GetInfo(TIM_TypeDef* TIMx, uint32_t* Clock, uint8_t* AF, TM_DMA_Request_t* Request, uint8_t* Channels) {
+	uint8_t apb2 = 0;
+	
+	/* Enable clock and get alternate function and DMA request for channel 1 */
+	*Channels = 4;
+	if (TIMx == TIM1) {
+		__HAL_RCC_TIM1_CLK_ENABLE();
+		*AF = GPIO_AF1_TIM1;
+		*Request = TM_DMA_Request_TIM1_CH1;
+		apb2 = 1;
+	} else if (TIMx == TIM2) {
+		__HAL_RCC_TIM2_CLK_ENABLE();
+		*AF = GPIO_AF1_TIM2;
+		*Request = TM_DMA_Request_TIM2_CH1;
+	} else if (TIMx == TIM3) {
+		__HAL_RCC_TIM3_CLK_ENABLE();
+		*AF = GPIO_AF2_TIM3;
+		*Request = TM_DMA_Request_TIM3_CH1;
+	} else if (TIMx == TIM4) {
+		__HAL_RCC_TIM4_CLK_ENABLE();
+		*AF = GPIO_AF2_TIM4;
+		*Request = TM_DMA_Request_TIM4_CH1;
+		*Channels = 3;
+	} else if (TIMx == TIM5) {
+		__HAL_RCC_TIM5_CLK_ENABLE();
+		*AF = GPIO_AF2_TIM5;
+		*Request = TM_DMA_Request_TIM5_CH1;
+#if defined(TIM8)
+	} else if (TIMx == TIM8) {
+		__HAL_RCC_TIM8_CLK_ENABLE();
+		*AF = GPIO_AF3_TIM8;
+		*Request = TM_DMA_Request_TIM8_CH1;
+		apb2 = 1;
+#endif
+	} else {
+		/* Timer not supported */
+		return 0;
+	}
+	
+	/* Timer clock is twice the APB clock when APB prescaler is not 1 */
+	if (apb2) {
+		*Clock = HAL_RCC_GetPCLK2Freq();
+		if (RCC->CFGR & RCC_CFGR_PPRE2_2) {
+			*Clock *= 2;
+		}
+	} else {
+		*Clock = HAL_RCC_GetPCLK1Freq();
+		if (RCC->CFGR & RCC_CFGR_PPRE1_2) {
+			*Clock *= 2;
+		}
+	}
+	
+	/* Timer is supported */
+	return 1;
+}
+
+static uint8_t TM_CAPTURE_INT_InitPin(TIM_TypeDef* TIMx, TM_CAPTURE_Channel_t Channel, TM_CAPTURE_PinsPack_t PinsPack) {
+	uint32_t clock;
+	uint8_t af, channels, i;
+	TM_DMA_Request_t request;
+	
+	/* Get alternate function */
+	TM_CAPTURE_INT_GetInfo(TIMx, &clock, &af, &request, &channels);
+	
+	/* Custom pin */
+	if (PinsPack == TM_CAPTURE_PinsPack_Custom) {
+		TM_CAPTURE_InitCustomPinsCallback(TIMx, Channel, af);
+		return 1;
+	}
+	
+	/* Find pin in table */
+	for (i = 0; i < sizeof(CAPTURE_Pins) / sizeof(CAPTURE_Pins[0]); i++) {
+		if (CAPTURE_Pins[i].TIM == TIMx && CAPTURE_Pins[i].Channel == Channel && CAPTURE_Pins[i].PinsPack == PinsPack) {
+			TM_GPIO_InitAlternate(CAPTURE_Pins[i].GPIOx, CAPTURE_Pins[i].Pin, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, af);
+			return 1;
+		}
+	}
+	
+	/* Pin does not exist */
+	return 0;
+}
+
+static uint8_t TM_CAPTURE_INT_StartDMA(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel, uint32_t Source) {
+	TM_CAPTURE_Input_t* Input = &Capture->Inputs[Channel];
+	DMA_Stream_TypeDef* Stream;
+	uint32_t clock;
+	uint8_t af, channels;
+	TM_DMA_Request_t request;
+	
+	/* Allocate stream for channel request */
+	TM_CAPTURE_INT_GetInfo(Capture->TIM, &clock, &af, &request, &channels);
+	if ((Stream = TM_DMA_Allocate((TM_DMA_Request_t)(request + Channel), TM_DMA_Priority_Default, NULL, &Input->hdma.Init.Channel)) == NULL) {
+		return 0;
+	}
+	
+	/* Set DMA settings, 32-bit reads to circular buffer */
+	Input->hdma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	Input->hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+	Input->hdma.Init.MemInc = DMA_MINC_ENABLE;
+	Input->hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	Input->hdma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	Input->hdma.Init.Mode = DMA_CIRCULAR;
+	Input->hdma.Init.Priority = DMA_PRIORITY_HIGH;
+	Input->hdma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	Input->hdma.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	Input->hdma.Init.MemBurst = DMA_MBURST_SINGLE;
+	Input->hdma.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init and start stream, no interrupts are used */
+	TM_DMA_Init(Stream, &Input->hdma);
+	TM_DMA_Start(&Input->hdma, Source, (uint32_t)Input->Buffer, Input->Size);
+	
+	/* Stream started */
+	return 1;
+}
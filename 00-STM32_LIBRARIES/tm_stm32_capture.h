@@ -0,0 +1,339 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Input capture frequency and duty cycle measurement with DMA for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_CAPTURE_H
+#define TM_CAPTURE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_CAPTURE
+ * @brief    Input capture frequency and duty cycle measurement with DMA for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Timer captures counter value on each input edge and DMA saves it to circular buffer, so there is no interrupt for edges at all.
+ * Captured timestamps are processed in batches with @ref TM_CAPTURE_Measure function, which calculates average frequency,
+ * period and minimal and maximal period from all edges since previous call.
+ *
+ * Resolution is one timer tick, 11ns with 90MHz timer clock. 1MHz signal makes 1 million DMA transfers per second,
+ * so buffer with 1000 entries should be processed at least each millisecond. Older timestamps are overwritten when it is not.
+ *
+ * \par Pinout
+ *
+\verbatim
+       |PINSPACK 1           |PINSPACK 2           |PINSPACK 3
+TIMX   |CH1  CH2  CH3  CH4   |CH1  CH2  CH3  CH4   |CH1  CH2  CH3  CH4
+       |                     |                     |
+TIM1   |PA8  PA9  PA10 PA11  |PE9  PE11 PE13 PE14  |-    -    -    -
+TIM2   |PA0  PA1  PA2  PA3   |PA5  PB3  PB10 PB11  |PA15 -    -    -
+TIM3   |PA6  PA7  PB0  PB1   |PB4  PB5  PC8  PC9   |PC6  PC7  -    -
+TIM4   |PB6  PB7  PB8  -     |PD12 PD13 PD14 -     |-    -    -    -
+TIM5   |PA0  PA1  PA2  PA3   |PH10 PH11 PH12 PI0   |-    -    -    -
+TIM8   |PC6  PC7  PC8  PC9   |PI5  PI6  PI7  PI2   |-    -    -    -
+\endverbatim
+ *
+ * TIM4 channel 4 has no DMA request and can not be used.
+ *
+ * \par Timestamp mode
+ *
+ * Counter runs free and up to 4 channels of the same timer capture timestamps of rising or falling edges to separate buffers.
+ * Period is difference between timestamps. On 16-bit timers period must be shorter than 65536 ticks,
+ * TIM2 and TIM5 are 32-bit timers and can measure periods up to 2^32 ticks.
+ *
+\code
+TM_CAPTURE_t Capture;
+TM_CAPTURE_Measurement_t M;
+uint32_t Buffer[256];
+
+//TIM2 with timer clock, rising edges on PA0
+TM_CAPTURE_Init(&Capture, TIM2, 0);
+TM_CAPTURE_InitChannel(&Capture, TM_CAPTURE_Channel_1, TM_CAPTURE_PinsPack_1, TM_CAPTURE_Edge_Rising, Buffer, 256);
+
+//Periodically
+if (TM_CAPTURE_Measure(&Capture, TM_CAPTURE_Channel_1, &M) == TM_CAPTURE_Result_Ok) {
+	//M.Frequency is average frequency of M.Count periods
+}
+\endcode
+ *
+ * \par PWM input mode
+ *
+ * Signal on channel 1 pin is captured with both channel 1 (rising edge) and channel 2 (falling edge) and counter is reset on each rising edge.
+ * On each rising edge, DMA burst saves period and high time of previous period, so duty cycle is measured too.
+ * Other channels of timer can not be used in this mode.
+ *
+\code
+uint32_t Pairs[2 * 128];
+
+//TIM5 PWM input on PA0
+TM_CAPTURE_Init(&Capture, TIM5, 0);
+TM_CAPTURE_InitPWMInput(&Capture, TM_CAPTURE_PinsPack_1, Pairs, 128);
+
+//M.Duty has average duty cycle
+TM_CAPTURE_Measure(&Capture, TM_CAPTURE_Channel_1, &M);
+\endcode
+ *
+ * \par Settings
+ *
+\code
+//Input filter value for ICxF bits, 0 to 15
+#define CAPTURE_INPUT_FILTER    0
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - attributes.h
+ - TM GPIO
+ - TM DMA
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_dma.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_CAPTURE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Input filter for all capture channels, ICxF bits value */
+#ifndef CAPTURE_INPUT_FILTER
+#define CAPTURE_INPUT_FILTER    0
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_CAPTURE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Capture result enumeration
+ */
+typedef enum {
+	TM_CAPTURE_Result_Ok = 0x00,  /*!< Everything OK */
+	TM_CAPTURE_Result_Error,      /*!< Invalid timer, channel or parameter, or no free DMA stream */
+	TM_CAPTURE_Result_Empty       /*!< No new period since previous measurement */
+} TM_CAPTURE_Result_t;
+
+/**
+ * @brief  Timer channel enumeration
+ */
+typedef enum {
+	TM_CAPTURE_Channel_1 = 0x00,  /*!< Channel 1 */
+	TM_CAPTURE_Channel_2,         /*!< Channel 2 */
+	TM_CAPTURE_Channel_3,         /*!< Channel 3 */
+	TM_CAPTURE_Channel_4          /*!< Channel 4 */
+} TM_CAPTURE_Channel_t;
+
+/**
+ * @brief  Capture edge enumeration
+ */
+typedef enum {
+	TM_CAPTURE_Edge_Rising = 0x00, /*!< Capture on rising edges */
+	TM_CAPTURE_Edge_Falling        /*!< Capture on falling edges */
+} TM_CAPTURE_Edge_t;
+
+/**
+ * @brief  Capture pinspack enumeration
+ */
+typedef enum {
+	TM_CAPTURE_PinsPack_1 = 0x00, /*!< Use Pinspack1 from Pinout table for channel */
+	TM_CAPTURE_PinsPack_2,        /*!< Use Pinspack2 from Pinout table for channel */
+	TM_CAPTURE_PinsPack_3,        /*!< Use Pinspack3 from Pinout table for channel */
+	TM_CAPTURE_PinsPack_Custom    /*!< Use custom pin for channel, callback will be called, look @ref TM_CAPTURE_InitCustomPinsCallback */
+} TM_CAPTURE_PinsPack_t;
+
+/**
+ * @brief  Capture input structure, one for each channel
+ * @note   Structure is used by library and should not be changed by user
+ */
+typedef struct {
+	uint32_t* Buffer;         /*!< Pointer to DMA buffer */
+	uint16_t Size;            /*!< Number of words in buffer */
+	uint16_t Read;            /*!< Next word to process */
+	uint32_t Last;            /*!< Last processed timestamp */
+	uint8_t Mode;             /*!< 0 when not used, 1 for timestamps, 2 for PWM input */
+	uint8_t HasLast;          /*!< Set to 1 when Last member is valid */
+	DMA_HandleTypeDef hdma;   /*!< DMA handle */
+} TM_CAPTURE_Input_t;
+
+/**
+ * @brief  Capture timer structure
+ */
+typedef struct {
+	TIM_TypeDef* TIM;              /*!< Pointer to timer */
+	uint32_t TickFrequency;        /*!< Timer tick frequency in units of Hz */
+	uint32_t Mask;                 /*!< Counter mask, 0xFFFF for 16-bit timers and 0xFFFFFFFF for 32-bit timers */
+	TM_CAPTURE_Input_t Inputs[4];  /*!< Inputs for channels */
+} TM_CAPTURE_t;
+
+/**
+ * @brief  Measurement result for one batch of periods
+ */
+typedef struct {
+	uint32_t Count;           /*!< Number of periods in batch */
+	float Frequency;          /*!< Average frequency in units of Hz */
+	float Period;             /*!< Average period in units of microseconds */
+	float Duty;               /*!< Average duty cycle in percents, PWM input mode only */
+	uint32_t MinTicks;        /*!< Shortest period in timer ticks */
+	uint32_t MaxTicks;        /*!< Longest period in timer ticks */
+} TM_CAPTURE_Measurement_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CAPTURE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes timer for input capture, counter runs over full range
+ * @param  *Capture: Pointer to empty @ref TM_CAPTURE_t structure
+ * @param  *TIMx: Pointer to timer, TIM1 to TIM5 or TIM8
+ * @param  TickFrequency: Timer tick frequency in units of Hz. Set to 0 to use timer clock for best resolution.
+ *            Real frequency is saved to TickFrequency member of structure
+ * @retval Member of @ref TM_CAPTURE_Result_t enumeration:
+ *            - @ref TM_CAPTURE_Result_Ok: Timer is initialized
+ *            - @ref TM_CAPTURE_Result_Error: Invalid timer or tick frequency
+ */
+TM_CAPTURE_Result_t TM_CAPTURE_Init(TM_CAPTURE_t* Capture, TIM_TypeDef* TIMx, uint32_t TickFrequency);
+
+/**
+ * @brief  Initializes channel for timestamps to circular DMA buffer
+ * @param  *Capture: Pointer to @ref TM_CAPTURE_t structure of initialized timer
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_CAPTURE_Channel_t enumeration
+ * @param  PinsPack: Pinspack for channel pin. This parameter can be a value of @ref TM_CAPTURE_PinsPack_t enumeration
+ * @param  Edge: Edge to capture. This parameter can be a value of @ref TM_CAPTURE_Edge_t enumeration
+ * @param  *Buffer: Pointer to buffer for timestamps, must stay valid while channel is used
+ * @param  Size: Number of words in buffer, at least 2
+ * @retval Member of @ref TM_CAPTURE_Result_t enumeration:
+ *            - @ref TM_CAPTURE_Result_Ok: Capture is started
+ *            - @ref TM_CAPTURE_Result_Error: Invalid parameter, pin does not exist or no free DMA stream
+ */
+TM_CAPTURE_Result_t TM_CAPTURE_InitChannel(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel, TM_CAPTURE_PinsPack_t PinsPack, TM_CAPTURE_Edge_t Edge, uint32_t* Buffer, uint16_t Size);
+
+/**
+ * @brief  Initializes PWM input mode on channel 1 pin, period and high time are saved to circular DMA buffer
+ * @note   Channel 1 and channel 2 are used, results are read with @ref TM_CAPTURE_Measure for channel 1
+ * @param  *Capture: Pointer to @ref TM_CAPTURE_t structure of initialized timer
+ * @param  PinsPack: Pinspack for channel 1 pin. This parameter can be a value of @ref TM_CAPTURE_PinsPack_t enumeration
+ * @param  *Buffer: Pointer to buffer with 2 words for each period, must stay valid while channel is used
+ * @param  Pairs: Number of periods in buffer, at least 2
+ * @retval Member of @ref TM_CAPTURE_Result_t enumeration:
+ *            - @ref TM_CAPTURE_Result_Ok: Capture is started
+ *            - @ref TM_CAPTURE_Result_Error: Invalid parameter, pin does not exist or no free DMA stream
+ */
+TM_CAPTURE_Result_t TM_CAPTURE_InitPWMInput(TM_CAPTURE_t* Capture, TM_CAPTURE_PinsPack_t PinsPack, uint32_t* Buffer, uint16_t Pairs);
+
+/**
+ * @brief  Processes all periods captured since previous call
+ * @param  *Capture: Pointer to @ref TM_CAPTURE_t structure
+ * @param  Channel: Initialized channel or channel 1 in PWM input mode. This parameter can be a value of @ref TM_CAPTURE_Channel_t enumeration
+ * @param  *Result: Pointer to @ref TM_CAPTURE_Measurement_t structure to fill
+ * @retval Member of @ref TM_CAPTURE_Result_t enumeration:
+ *            - @ref TM_CAPTURE_Result_Ok: At least one new period was measured
+ *            - @ref TM_CAPTURE_Result_Empty: No new period, result count is 0
+ *            - @ref TM_CAPTURE_Result_Error: Channel is not initialized
+ */
+TM_CAPTURE_Result_t TM_CAPTURE_Measure(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel, TM_CAPTURE_Measurement_t* Result);
+
+/**
+ * @brief  Stops capture on channel and releases its DMA stream
+ * @param  *Capture: Pointer to @ref TM_CAPTURE_t structure
+ * @param  Channel: Channel to stop, channel 1 stops PWM input mode. This parameter can be a value of @ref TM_CAPTURE_Channel_t enumeration
+ * @retval None
+ */
+void TM_CAPTURE_Stop(TM_CAPTURE_t* Capture, TM_CAPTURE_Channel_t Channel);
+
+/**
+ * @brief  Callback for custom pins initialization
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *TIMx: Pointer to timer which needs custom pin
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_CAPTURE_Channel_t enumeration
+ * @param  AlternateFunction: Alternate function number which should be used for GPIO pin
+ * @retval None
+ */
+void TM_CAPTURE_InitCustomPinsCallback(TIM_TypeDef* TIMx, TM_CAPTURE_Channel_t Channel, uint16_t AlternateFunction);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,323 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_compositor.h"
+
+/* Private structure */
+typedef struct {
+	uint16_t Width;
+	uint16_t Height;
+	uint8_t TilesX;
+	uint8_t TilesY;
+	uint32_t Background;
+	uint32_t Frame;
+	TM_COMPOSITOR_Widget_t* First;
+} TM_COMPOSITOR_INT_t;
+
+/* Private variables */
+static TM_COMPOSITOR_INT_t COMP;
+
+/* Dirty tiles, one bit per tile in each row */
+static uint32_t COMP_Dirty[COMPOSITOR_MAX_TILES];
+#if COMPOSITOR_DOUBLE_BUFFER
+/* Tiles changed in previous frame, not yet in back buffer */
+static uint32_t COMP_Previous[COMPOSITOR_MAX_TILES];
+#endif
+
+/* Private functions */
+static void TM_COMPOSITOR_INT_Mark(uint32_t* mask, uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height);
+static uint8_t TM_COMPOSITOR_INT_Touches(const uint32_t* mask, TM_COMPOSITOR_Widget_t* Widget);
+static void TM_COMPOSITOR_INT_Extend(uint32_t* mask);
+static void TM_COMPOSITOR_INT_Fill(uint32_t* mask);
+
+void TM_COMPOSITOR_Init(uint32_t BackgroundColor) {
+	/* Get LCD size in current orientation */
+	COMP.Width = TM_LCD_GetWidth();
+	COMP.Height = TM_LCD_GetHeight();
+	COMP.TilesX = (COMP.Width + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE;
+	COMP.TilesY = (COMP.Height + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE;
+	
+	/* No widgets */
+	COMP.First = NULL;
+	COMP.Frame = 0;
+	
+	/* Clear tiles from previous orientation */
+	memset(COMP_Dirty, 0, sizeof(COMP_Dirty));
+#if COMPOSITOR_DOUBLE_BUFFER
+	/* Both buffers must be drawn completely */
+	memset(COMP_Previous, 0, sizeof(COMP_Previous));
+	TM_COMPOSITOR_INT_Mark(COMP_Previous, 0, 0, COMP.Width, COMP.Height);
+#endif
+	
+	/* Set background, whole screen is invalid */
+	TM_COMPOSITOR_SetBackground(BackgroundColor);
+}
+
+void TM_COMPOSITOR_SetBackground(uint32_t BackgroundColor) {
+	/* Set color */
+	COMP.Background = BackgroundColor;
+	
+	/* Redraw everything */
+	TM_COMPOSITOR_InvalidateAll();
+}
+
+void TM_COMPOSITOR_AddWidget(TM_COMPOSITOR_Widget_t* Widget) {
+	TM_COMPOSITOR_Widget_t** w = &COMP.First;
+	
+	/* Add to end of list, on top */
+	while (*w) {
+		w = &(*w)->Next;
+	}
+	*w = Widget;
+	Widget->Next = NULL;
+	
+	/* Draw widget */
+	TM_COMPOSITOR_InvalidateWidget(Widget);
+}
+
+void TM_COMPOSITOR_RemoveWidget(TM_COMPOSITOR_Widget_t* Widget) {
+	TM_COMPOSITOR_Widget_t** w = &COMP.First;
+	
+	/* Find widget in list */
+	while (*w && *w != Widget) {
+		w = &(*w)->Next;
+	}
+	if (*w == NULL) {
+		return;
+	}
+	
+	/* Remove from list */
+	*w = Widget->Next;
+	Widget->Next = NULL;
+	
+	/* Redraw area under widget */
+	TM_COMPOSITOR_Invalidate(Widget->X, Widget->Y, Widget->Width, Widget->Height);
+}
+
+void TM_COMPOSITOR_MoveWidget(TM_COMPOSITOR_Widget_t* Widget, uint16_t X, uint16_t Y) {
+	/* Redraw old area */
+	TM_COMPOSITOR_Invalidate(Widget->X, Widget->Y, Widget->Width, Widget->Height);
+	
+	/* Set new position */
+	Widget->X = X;
+	Widget->Y = Y;
+	
+	/* Redraw new area */
+	TM_COMPOSITOR_Invalidate(Widget->X, Widget->Y, Widget->Width, Widget->Height);
+}
+
+void TM_COMPOSITOR_SetVisible(TM_COMPOSITOR_Widget_t* Widget, uint8_t Visible) {
+	/* Nothing changed */
+	if (!Widget->Visible == !Visible) {
+		return;
+	}
+	
+	/* Set visibility and redraw area */
+	Widget->Visible = Visible;
+	TM_COMPOSITOR_Invalidate(Widget->X, Widget->Y, Widget->Width, Widget->Height);
+}
+
+void TM_COMPOSITOR_InvalidateWidget(TM_COMPOSITOR_Widget_t* Widget) {
+	/* Mark widget area */
+	TM_COMPOSITOR_Invalidate(Widget->X, Widget->Y, Widget->Width, Widget->Height);
+}
+
+void TM_COMPOSITOR_Invalidate(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height) {
+	/* Mark tiles */
+	TM_COMPOSITOR_INT_Mark(COMP_Dirty, X, Y, Width, Height);
+}
+
+void TM_COMPOSITOR_InvalidateAll(void) {
+	/* Mark all tiles */
+	TM_COMPOSITOR_INT_Mark(COMP_Dirty, 0, 0, COMP.Width, COMP.Height);
+}
+
+uint32_t TM_COMPOSITOR_Render(void) {
+	uint32_t mask[COMPOSITOR_MAX_TILES];
+	TM_COMPOSITOR_Widget_t* w;
+	uint32_t any = 0;
+	uint8_t i;
+	
+	/* Complete areas of touched widgets are changed */
+	TM_COMPOSITOR_INT_Extend(COMP_Dirty);
+	
+	/* Tiles to draw in this frame */
+	for (i = 0; i < COMP.TilesY; i++) {
+#if COMPOSITOR_DOUBLE_BUFFER
+		/* Back buffer does not have changes from previous frame */
+		mask[i] = COMP_Dirty[i] | COMP_Previous[i];
+		COMP_Previous[i] = COMP_Dirty[i];
+#else
+		mask[i] = COMP_Dirty[i];
+#endif
+		COMP_Dirty[i] = 0;
+		any |= mask[i];
+	}
+	
+	/* Nothing to draw, last frame is still valid */
+	if (!any) {
+		return COMP.Frame;
+	}
+	
+#if COMPOSITOR_DOUBLE_BUFFER
+	/* Previous frame may touch other widgets */
+	TM_COMPOSITOR_INT_Extend(mask);
+	
+	/* Select back buffer */
+	TM_LCD_BeginFrame();
+#endif
+	
+	/* Fill background, mask is copied as it is cleared while merging */
+	memcpy(COMP_Dirty, mask, sizeof(mask));
+	TM_COMPOSITOR_INT_Fill(COMP_Dirty);
+	
+	/* Draw widgets from bottom to top */
+	for (w = COMP.First; w; w = w->Next) {
+		if (w->Visible && w->Draw && TM_COMPOSITOR_INT_Touches(mask, w)) {
+			w->Draw(w);
+		}
+	}
+	
+	/* New frame */
+	COMP.Frame++;
+	
+#if COMPOSITOR_DOUBLE_BUFFER
+	/* Show at vertical blanking */
+	TM_LCD_Present();
+#else
+	/* Wait for DMA2D */
+	TM_DMA2DGRAPHIC_WaitIdle();
+#endif
+	
+	/* Return fence */
+	return COMP.Frame;
+}
+
+uint8_t TM_COMPOSITOR_IsFrameDone(uint32_t fence) {
+	/* Older frames are always displayed, only last one may wait for reload */
+#if COMPOSITOR_DOUBLE_BUFFER
+	return (int32_t)(COMP.Frame - fence) > 0 || !TM_LCD_IsPresenting();
+#else
+	(void)fence;
+	return 1;
+#endif
+}
+
+void TM_COMPOSITOR_WaitFrame(uint32_t fence) {
+	/* Wait for frame */
+	while (!TM_COMPOSITOR_IsFrameDone(fence));
+}
+
+/* Private functions */
+static void TM_COMPOSITOR_INT_Mark(uint32_t* mask, uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height) {
+	uint32_t x0, x1, y0, y1, bits;
+	
+	/* Check area */
+	if (Width == 0 || Height == 0 || X >= COMP.Width || Y >= COMP.Height) {
+		return;
+	}
+	
+	/* Get tiles, clipped to LCD */
+	x0 = X / COMPOSITOR_TILE_SIZE;
+	y0 = Y / COMPOSITOR_TILE_SIZE;
+	x1 = ((uint32_t)X + Width - 1) / COMPOSITOR_TILE_SIZE;
+	y1 = ((uint32_t)Y + Height - 1) / COMPOSITOR_TILE_SIZE;
+	if (x1 >= COMP.TilesX) {
+		x1 = COMP.TilesX - 1;
+	}
+	if (y1 >= COMP.TilesY) {
+		y1 = COMP.TilesY - 1;
+	}
+	
+	/* Bits from x0 to x1 */
+	bits = (0xFFFFFFFF >> (31 - x1)) & (0xFFFFFFFF << x0);
+	
+	/* Mark rows */
+	for (; y0 <= y1; y0++) {
+		mask[y0] |= bits;
+	}
+}
+
+static uint8_t TM_COMPOSITOR_INT_Touches(const uint32_t* mask, TM_COMPOSITOR_Widget_t* Widget) {
+	uint32_t tmp[COMPOSITOR_MAX_TILES];
+	uint8_t i;
+	
+	/* Clear widget tiles */
+	memset(tmp, 0, sizeof(tmp));
+	TM_COMPOSITOR_INT_Mark(tmp, Widget->X, Widget->Y, Widget->Width, Widget->Height);
+	
+	/* Check for common tiles */
+	for (i = 0; i < COMP.TilesY; i++) {
+		if (tmp[i] & mask[i]) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void TM_COMPOSITOR_INT_Extend(uint32_t* mask) {
+	uint32_t old[COMPOSITOR_MAX_TILES];
+	TM_COMPOSITOR_Widget_t* w;
+	
+	/* Add touched widgets until nothing changes, widgets above them may be touched too */
+	do {
+		memcpy(old, mask, sizeof(old));
+		for (w = COMP.First; w; w = w->Next) {
+			if (w->Visible && TM_COMPOSITOR_INT_Touches(mask, w)) {
+				TM_COMPOSITOR_INT_Mark(mask, w->X, w->Y, w->Width, w->Height);
+			}
+		}
+	} while (memcmp(old, mask, sizeof(old)));
+}
+
+static void TM_COMPOSITOR_INT_Fill(uint32_t* mask) {
+	uint32_t bits, run;
+	uint8_t row, end, x0, x1;
+	
+	for (row = 0; row < COMP.TilesY; row++) {
+		while (mask[row]) {
+			/* First run of tiles in row */
+			bits = mask[row];
+			x0 = __CLZ(__RBIT(bits));
+			x1 = x0;
+			while (x1 < 31 && (bits & (1UL << (x1 + 1)))) {
+				x1++;
+			}
+			run = (0xFFFFFFFF >> (31 - x1)) & (0xFFFFFFFF << x0);
+			
+			/* Merge rows below with the same tiles */
+			for (end = row; end < COMP.TilesY && (mask[end] & run) == run; end++) {
+				mask[end] &= ~run;
+			}
+			
+			/* Fill rectangle with DMA2D, it is clipped to LCD */
+			TM_LCD_DrawFilledRectangle(
+				x0 * COMPOSITOR_TILE_SIZE, row * COMPOSITOR_TILE_SIZE,
+				(x1 - x0 + 1) * COMPOSITOR_TILE_SIZE, (end - row) * COMPOSITOR_TILE_SIZE,
+				COMP.Background
+			);
+		}
+	}
+}
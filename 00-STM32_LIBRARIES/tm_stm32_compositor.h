@@ -0,0 +1,306 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Dirty region compositor for LCD user interfaces for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_COMPOSITOR_H
+#define TM_COMPOSITOR_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_COMPOSITOR
+ * @brief    Dirty region compositor for LCD user interfaces for STM32Fxxx
+ * @{
+ *
+ * Library redraws only changed parts of screen, instead of complete frame on every change.
+ *
+ * User interface is made of widgets. Each widget is a rectangle with draw function, which draws content with @ref TM_LCD functions.
+ * Widgets are drawn in order as they were added, last added widget is on top.
+ *
+ * \par Invalidation
+ *
+ * When widget content changes, widget is invalidated with @ref TM_COMPOSITOR_InvalidateWidget.
+ * Screen is divided to tiles of @ref COMPOSITOR_TILE_SIZE pixels and invalidated areas mark tiles as dirty.
+ *
+ * On @ref TM_COMPOSITOR_Render, dirty tiles are:
+ *  - Extended with complete area of each widget they touch, so overlapping widgets are redrawn correctly
+ *  - Merged to rectangles, each filled with background color with single DMA2D transfer
+ *  - Redrawn by draw functions of widgets which touch them, other widgets are not drawn at all
+ *
+ * \par Double buffering
+ *
+ * By default, frames are drawn with @ref TM_LCD_BeginFrame and @ref TM_LCD_Present without tearing.
+ * Back buffer has content from 2 frames ago, so tiles changed in previous frame are redrawn as well.
+ *
+ * @ref TM_COMPOSITOR_Render returns frame fence, use @ref TM_COMPOSITOR_IsFrameDone to check when frame is on LCD.
+ *
+\code
+//Widget draw function, draws with absolute coordinates
+void DrawValue(TM_COMPOSITOR_Widget_t* Widget) {
+	TM_LCD_DrawFilledRectangle(Widget->X, Widget->Y, Widget->Width, Widget->Height, LCD_COLOR_BLUE);
+	TM_LCD_SetXY(Widget->X + 2, Widget->Y + 2);
+	TM_LCD_Puts((char *)Widget->Param);
+}
+
+TM_COMPOSITOR_Widget_t Value = {10, 10, 100, 22, DrawValue, "0", 1};
+
+//Init LCD and compositor
+TM_LCD_Init();
+TM_COMPOSITOR_Init(LCD_COLOR_WHITE);
+TM_COMPOSITOR_AddWidget(&Value);
+
+while (1) {
+	//Change widget content
+	Value.Param = NewText;
+	TM_COMPOSITOR_InvalidateWidget(&Value);
+	
+	//Draw changes only
+	fence = TM_COMPOSITOR_Render();
+}
+\endcode
+ *
+ * \note  Draw function must draw widget area only and must give the same result each time for the same content
+ * \note  After orientation change, call @ref TM_COMPOSITOR_Init again
+ *
+ * \par Settings
+ *
+\code
+//Tile size in pixels, smaller tiles give more exact regions with more DMA2D transfers
+#define COMPOSITOR_TILE_SIZE          32
+
+//Use TM LCD double buffering, set to 0 to draw directly to visible layer
+#define COMPOSITOR_DOUBLE_BUFFER      1
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM LCD
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_lcd.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_COMPOSITOR_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Tile size in pixels */
+#ifndef COMPOSITOR_TILE_SIZE
+#define COMPOSITOR_TILE_SIZE          32
+#endif
+
+/* Use double buffering */
+#ifndef COMPOSITOR_DOUBLE_BUFFER
+#define COMPOSITOR_DOUBLE_BUFFER      1
+#endif
+
+/* Max number of tiles in each direction, for any orientation */
+#define COMPOSITOR_MAX_TILES          ((((LCD_PIXEL_WIDTH > LCD_PIXEL_HEIGHT) ? LCD_PIXEL_WIDTH : LCD_PIXEL_HEIGHT) + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE)
+
+/* One row of tiles is 32-bit mask */
+#if COMPOSITOR_MAX_TILES > 32
+#error "COMPOSITOR_TILE_SIZE is too small, max 32 tiles are allowed in one row!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_COMPOSITOR_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Widget structure
+ */
+typedef struct _TM_COMPOSITOR_Widget_t {
+	uint16_t X;                                             /*!< X position of top left corner */
+	uint16_t Y;                                             /*!< Y position of top left corner */
+	uint16_t Width;                                         /*!< Widget width */
+	uint16_t Height;                                        /*!< Widget height */
+	void (*Draw)(struct _TM_COMPOSITOR_Widget_t* Widget);  /*!< Draw function */
+	void* Param;                                            /*!< User parameter */
+	uint8_t Visible;                                        /*!< Widget is visible, change it with @ref TM_COMPOSITOR_SetVisible */
+	struct _TM_COMPOSITOR_Widget_t* Next;                   /*!< Next widget, used internally */
+} TM_COMPOSITOR_Widget_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_COMPOSITOR_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes compositor for current LCD orientation, all widgets are removed
+ * @note   LCD must be initialized first
+ * @param  BackgroundColor: Color of areas without widgets
+ * @retval None
+ */
+void TM_COMPOSITOR_Init(uint32_t BackgroundColor);
+
+/**
+ * @brief  Sets background color and invalidates entire screen
+ * @param  BackgroundColor: Color of areas without widgets
+ * @retval None
+ */
+void TM_COMPOSITOR_SetBackground(uint32_t BackgroundColor);
+
+/**
+ * @brief  Adds widget on top of other widgets
+ * @param  *Widget: Pointer to @ref TM_COMPOSITOR_Widget_t structure, it must stay valid until removed
+ * @retval None
+ */
+void TM_COMPOSITOR_AddWidget(TM_COMPOSITOR_Widget_t* Widget);
+
+/**
+ * @brief  Removes widget, its area is invalidated
+ * @param  *Widget: Pointer to @ref TM_COMPOSITOR_Widget_t structure
+ * @retval None
+ */
+void TM_COMPOSITOR_RemoveWidget(TM_COMPOSITOR_Widget_t* Widget);
+
+/**
+ * @brief  Moves widget to new position, old and new areas are invalidated
+ * @param  *Widget: Pointer to @ref TM_COMPOSITOR_Widget_t structure
+ * @param  X: New X position
+ * @param  Y: New Y position
+ * @retval None
+ */
+void TM_COMPOSITOR_MoveWidget(TM_COMPOSITOR_Widget_t* Widget, uint16_t X, uint16_t Y);
+
+/**
+ * @brief  Shows or hides widget
+ * @param  *Widget: Pointer to @ref TM_COMPOSITOR_Widget_t structure
+ * @param  Visible: Set to 1 to show widget or 0 to hide it
+ * @retval None
+ */
+void TM_COMPOSITOR_SetVisible(TM_COMPOSITOR_Widget_t* Widget, uint8_t Visible);
+
+/**
+ * @brief  Invalidates widget, it is redrawn on next render
+ * @param  *Widget: Pointer to @ref TM_COMPOSITOR_Widget_t structure
+ * @retval None
+ */
+void TM_COMPOSITOR_InvalidateWidget(TM_COMPOSITOR_Widget_t* Widget);
+
+/**
+ * @brief  Invalidates rectangle on screen
+ * @param  X: X position of top left corner
+ * @param  Y: Y position of top left corner
+ * @param  Width: Rectangle width
+ * @param  Height: Rectangle height
+ * @retval None
+ */
+void TM_COMPOSITOR_Invalidate(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height);
+
+/**
+ * @brief  Invalidates entire screen
+ * @param  None
+ * @retval None
+ */
+void TM_COMPOSITOR_InvalidateAll(void);
+
+/**
+ * @brief  Redraws invalidated areas
+ * @note   With double buffering, function waits till previous frame is on LCD and does not wait for new frame
+ * @param  None
+ * @retval Frame fence to be used with @ref TM_COMPOSITOR_IsFrameDone and @ref TM_COMPOSITOR_WaitFrame
+ */
+uint32_t TM_COMPOSITOR_Render(void);
+
+/**
+ * @brief  Checks if frame is on LCD
+ * @param  fence: Frame fence returned from @ref TM_COMPOSITOR_Render
+ * @retval Frame status:
+ *            - 0: Frame waits for vertical blanking
+ *            - > 0: Frame or newer frame is on LCD
+ */
+uint8_t TM_COMPOSITOR_IsFrameDone(uint32_t fence);
+
+/**
+ * @brief  Waits till frame is on LCD
+ * @param  fence: Frame fence returned from @ref TM_COMPOSITOR_Render
+ * @retval None
+ */
+void TM_COMPOSITOR_WaitFrame(uint32_t fence);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_coro.h"
+
+/* List of running coroutines */
+static TM_CORO_t* CORO_First;
+
+void TM_CORO_Start(TM_CORO_t* Coro, TM_CORO_Func_t Func, void* Param) {
+	/* Start from beginning */
+	Coro->Line = 0;
+	Coro->Pending = 0;
+	Coro->Done = 0;
+	Coro->Status = 0;
+	Coro->Func = Func;
+	Coro->Param = Param;
+	
+	/* Add to end of list if not there yet */
+	if (!TM_CORO_IsRunning(Coro)) {
+		TM_CORO_t** tmp = &CORO_First;
+		while (*tmp) {
+			tmp = &(*tmp)->Next;
+		}
+		Coro->Next = NULL;
+		*tmp = Coro;
+	}
+}
+
+void TM_CORO_Stop(TM_CORO_t* Coro) {
+	TM_CORO_t** tmp;
+	
+	/* Find and remove from list */
+	for (tmp = &CORO_First; *tmp; tmp = &(*tmp)->Next) {
+		if (*tmp == Coro) {
+			*tmp = Coro->Next;
+			break;
+		}
+	}
+}
+
+uint32_t TM_CORO_Run(void) {
+	TM_CORO_t* c;
+	TM_CORO_t* next;
+	uint32_t count = 0;
+	
+	/* Call each coroutine once */
+	for (c = CORO_First; c; c = next) {
+		/* Coroutine can stop itself */
+		next = c->Next;
+		
+		/* Remove finished coroutine */
+		if (c->Func(c, c->Param) == TM_CORO_Result_Exited) {
+			TM_CORO_Stop(c);
+		} else {
+			count++;
+		}
+	}
+	
+	/* Return number of running coroutines */
+	return count;
+}
+
+uint8_t TM_CORO_IsRunning(TM_CORO_t* Coro) {
+	TM_CORO_t* c;
+	
+	/* Check list */
+	for (c = CORO_First; c; c = c->Next) {
+		if (c == Coro) {
+			return 1;
+		}
+	}
+	
+	/* Not in list */
+	return 0;
+}
+
+#if CORO_USE_I2C
+void TM_CORO_I2CCallback(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	/* Wake up coroutine */
+	TM_CORO_Complete((TM_CORO_t *)Param, (uint8_t)result);
+}
+#endif
+
+#if CORO_USE_SPI_DMA
+/* SPI DMA job callback */
+static void TM_CORO_INT_SPICallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param) {
+	/* Wake up coroutine */
+	TM_CORO_Complete((TM_CORO_t *)Param, status);
+}
+
+uint8_t TM_CORO_SPIEnqueue(TM_CORO_t* Coro, SPI_TypeDef* SPIx, const TM_SPI_DMA_Job_t* Job) {
+	TM_SPI_DMA_Job_t job = *Job;
+	
+	/* Job finishes coroutine wait */
+	job.Callback = TM_CORO_INT_SPICallback;
+	job.Param = Coro;
+	
+	/* Add to queue, job is copied */
+	return TM_SPI_DMA_Enqueue(SPIx, &job);
+}
+#endif
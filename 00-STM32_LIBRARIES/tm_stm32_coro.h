@@ -0,0 +1,400 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Cooperative stackless coroutines for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_CORO_H
+#define TM_CORO_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_CORO
+ * @brief    Cooperative stackless coroutines for STM32Fxxx
+ * @{
+ *
+ * Coroutines are normal functions which can return in the middle and continue from the same place on next call.
+ * Resume point is saved in @ref TM_CORO_t structure, so there is no stack per coroutine like with RTOS threads.
+ * All coroutines are called by @ref TM_CORO_Run from main loop, while one waits for hardware others can run.
+ *
+\code
+//State of coroutine, local variables are NOT preserved between waits
+typedef struct {
+	uint8_t Data[6];
+	uint8_t i;
+} Sensor_t;
+
+TM_CORO_Result_t SensorTask(TM_CORO_t* Coro, void* Param) {
+	Sensor_t* s = (Sensor_t *)Param;
+	
+	TM_CORO_BEGIN(Coro);
+	while (1) {
+		//Read 6 bytes from register 0x3B, other coroutines run during transfer
+		TM_CORO_AWAIT_I2C_READ(Coro, I2C1, 0xD0, 0x3B, s->Data, 6);
+		if (TM_CORO_STATUS(Coro) != TM_I2C_Result_Ok) {
+			TM_CORO_EXIT(Coro);
+		}
+		
+		//Process and wait 10ms
+		Process(s->Data);
+		TM_CORO_AWAIT_DELAY(Coro, 10);
+	}
+	TM_CORO_END(Coro);
+}
+
+//In main
+TM_CORO_Start(&SensorCoro, SensorTask, &Sensor);
+TM_CORO_Start(&ShellCoro, ShellTask, NULL);
+while (1) {
+	TM_CORO_Run();
+}
+\endcode
+ *
+ * \par Await primitives
+ *
+ *  - @ref TM_CORO_AWAIT_DELAY: Waits milliseconds from HAL tick, provided by TM DELAY
+ *  - @ref TM_CORO_AWAIT_BUFFER_DATA / @ref TM_CORO_AWAIT_BUFFER_ELEMENT: Waits for data in TM BUFFER, for example USART RX buffer
+ *  - @ref TM_CORO_AWAIT_I2C_READ / @ref TM_CORO_AWAIT_I2C_WRITE: Queued I2C transaction, enable with CORO_USE_I2C in defines.h
+ *  - @ref TM_CORO_AWAIT_SPI_DMA: Queued SPI DMA job, enable with CORO_USE_SPI_DMA in defines.h
+ *
+ * Driver awaits first wait for free place in driver queue, then for completion callback from interrupt.
+ * Result of completion is available with @ref TM_CORO_STATUS.
+ *
+ * @note  Await macros use switch statement internally, they can not be used inside another switch statement in coroutine
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - TM I2C     (only when CORO_USE_I2C)
+ - TM SPI DMA (only when CORO_USE_SPI_DMA)
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_buffer.h"
+
+/**
+ * @defgroup TM_CORO_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Await for queued I2C transactions */
+#ifndef CORO_USE_I2C
+#define CORO_USE_I2C           0
+#endif
+
+/* Await for queued SPI DMA jobs */
+#ifndef CORO_USE_SPI_DMA
+#define CORO_USE_SPI_DMA       0
+#endif
+
+#if CORO_USE_I2C
+#include "tm_stm32_i2c.h"
+#if I2C_QUEUE_SIZE == 0
+#error "CORO_USE_I2C needs I2C_QUEUE_SIZE greater than 0!"
+#endif
+#endif
+#if CORO_USE_SPI_DMA
+#include "tm_stm32_spi_dma.h"
+#if SPI_DMA_QUEUE_SIZE == 0
+#error "CORO_USE_SPI_DMA needs SPI_DMA_QUEUE_SIZE greater than 0!"
+#endif
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CORO_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Coroutine return value, returned by TM_CORO_xxx macros
+ */
+typedef enum {
+	TM_CORO_Result_Waiting = 0x00, /*!< Coroutine waits, call it again */
+	TM_CORO_Result_Exited          /*!< Coroutine finished */
+} TM_CORO_Result_t;
+
+struct _TM_CORO_t;
+
+/**
+ * @brief  Coroutine function
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure of coroutine
+ * @param  *Param: User parameter given on @ref TM_CORO_Start
+ * @retval Member of @ref TM_CORO_Result_t enumeration
+ */
+typedef TM_CORO_Result_t (*TM_CORO_Func_t)(struct _TM_CORO_t* Coro, void* Param);
+
+/**
+ * @brief  Coroutine structure
+ */
+typedef struct _TM_CORO_t {
+	uint16_t Line;                /*!< Resume point, 0 on start */
+	uint8_t Pending;              /*!< Driver operation was accepted */
+	__IO uint8_t Done;            /*!< Set by driver completion callback */
+	__IO uint8_t Status;          /*!< Driver completion status */
+	uint32_t Start;               /*!< Start time of delay */
+	TM_CORO_Func_t Func;          /*!< Coroutine function */
+	void* Param;                  /*!< User parameter */
+	struct _TM_CORO_t* Next;      /*!< Next coroutine in list */
+} TM_CORO_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CORO_Body
+ * @brief    Coroutine body macros
+ * @{
+ */
+
+/**
+ * @brief  Starts coroutine body, must be first statement in coroutine function
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ */
+#define TM_CORO_BEGIN(Coro)                 switch ((Coro)->Line) { case 0:
+
+/**
+ * @brief  Ends coroutine body, must be last statement in coroutine function
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ */
+#define TM_CORO_END(Coro)                   } (Coro)->Line = 0; return TM_CORO_Result_Exited
+
+/**
+ * @brief  Exits coroutine, it is removed from @ref TM_CORO_Run
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ */
+#define TM_CORO_EXIT(Coro)                  do { (Coro)->Line = 0; return TM_CORO_Result_Exited; } while (0)
+
+/**
+ * @brief  Waits until condition is true, condition is checked on each call of coroutine
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  cond: Condition to wait for
+ */
+#define TM_CORO_WAIT_UNTIL(Coro, cond)      do { (Coro)->Line = __LINE__; case __LINE__: if (!(cond)) { return TM_CORO_Result_Waiting; } } while (0)
+
+/**
+ * @brief  Gives other coroutines chance to run once
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ */
+#define TM_CORO_YIELD(Coro)                 do { (Coro)->Line = __LINE__; return TM_CORO_Result_Waiting; case __LINE__: ; } while (0)
+
+/**
+ * @brief  Gets status of last driver await
+ * @note   TM_I2C_Result_t for I2C, 1 for successful SPI DMA job and 0 on error
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ */
+#define TM_CORO_STATUS(Coro)                ((Coro)->Status)
+
+/**
+ * @brief  Waits milliseconds
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  ms: Number of milliseconds to wait
+ */
+#define TM_CORO_AWAIT_DELAY(Coro, ms)       do { (Coro)->Start = HAL_GetTick(); TM_CORO_WAIT_UNTIL(Coro, (HAL_GetTick() - (Coro)->Start) >= (ms)); } while (0)
+
+/**
+ * @brief  Waits until buffer has at least count elements
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  count: Number of elements to wait for
+ */
+#define TM_CORO_AWAIT_BUFFER_DATA(Coro, Buffer, count)        TM_CORO_WAIT_UNTIL(Coro, TM_BUFFER_GetFull(Buffer) >= (count))
+
+/**
+ * @brief  Waits until element is in buffer, for example new line character
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  Element: Element to wait for
+ */
+#define TM_CORO_AWAIT_BUFFER_ELEMENT(Coro, Buffer, Element)   TM_CORO_WAIT_UNTIL(Coro, TM_BUFFER_FindElement(Buffer, Element) >= 0)
+
+/**
+ * @brief  Waits for driver operation which calls @ref TM_CORO_Complete when finished
+ * @note   Operation is started again until it is accepted, when driver queue is full
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  start: Expression which starts operation and returns non-zero when accepted
+ */
+#define TM_CORO_AWAIT(Coro, start)          do { (Coro)->Done = 0; (Coro)->Pending = 0; \
+	TM_CORO_WAIT_UNTIL(Coro, ((Coro)->Pending || ((Coro)->Pending = ((start) != 0))) && (Coro)->Done); } while (0)
+
+#if CORO_USE_I2C || defined(DOXYGEN)
+/**
+ * @brief  Reads multiple bytes from device register with queued I2C transaction
+ * @note   Parameters are the same as in @ref TM_I2C_ReadMultiQueued, data must stay valid until finished
+ */
+#define TM_CORO_AWAIT_I2C_READ(Coro, I2Cx, device_address, register_address, data, count) \
+	TM_CORO_AWAIT(Coro, TM_I2C_ReadMultiQueued(I2Cx, device_address, register_address, data, count, TM_CORO_I2CCallback, Coro))
+
+/**
+ * @brief  Writes multiple bytes to device register with queued I2C transaction
+ * @note   Parameters are the same as in @ref TM_I2C_WriteMultiQueued, data must stay valid until finished
+ */
+#define TM_CORO_AWAIT_I2C_WRITE(Coro, I2Cx, device_address, register_address, data, count) \
+	TM_CORO_AWAIT(Coro, TM_I2C_WriteMultiQueued(I2Cx, device_address, register_address, data, count, TM_CORO_I2CCallback, Coro))
+#endif
+
+#if CORO_USE_SPI_DMA || defined(DOXYGEN)
+/**
+ * @brief  Exchanges data with queued SPI DMA job
+ * @note   Callback and parameter of job are replaced, buffers must stay valid until finished
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  *SPIx: Pointer to SPIx peripheral
+ * @param  *Job: Pointer to @ref TM_SPI_DMA_Job_t structure, can be local, it is copied to queue
+ */
+#define TM_CORO_AWAIT_SPI_DMA(Coro, SPIx, Job)    TM_CORO_AWAIT(Coro, TM_CORO_SPIEnqueue(Coro, SPIx, Job))
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CORO_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Adds coroutine to list of coroutines called by @ref TM_CORO_Run
+ * @note   Coroutine starts from beginning, also when it is already running
+ * @param  *Coro: Pointer to empty @ref TM_CORO_t structure
+ * @param  Func: Coroutine function
+ * @param  *Param: User parameter passed to function
+ * @retval None
+ */
+void TM_CORO_Start(TM_CORO_t* Coro, TM_CORO_Func_t Func, void* Param);
+
+/**
+ * @brief  Removes coroutine from list without calling it again
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @retval None
+ */
+void TM_CORO_Stop(TM_CORO_t* Coro);
+
+/**
+ * @brief  Calls all coroutines once, finished coroutines are removed
+ * @note   Call it from main loop
+ * @param  None
+ * @retval Number of coroutines still running
+ */
+uint32_t TM_CORO_Run(void);
+
+/**
+ * @brief  Checks if coroutine is in list of running coroutines
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @retval Running status:
+ *            - 0: Not running
+ *            - > 0: Running
+ */
+uint8_t TM_CORO_IsRunning(TM_CORO_t* Coro);
+
+/**
+ * @brief  Marks driver operation of coroutine as finished
+ * @note   Can be called from interrupt, use it for custom awaits with @ref TM_CORO_AWAIT
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  Status: Status returned by @ref TM_CORO_STATUS
+ * @retval None
+ */
+static __INLINE void TM_CORO_Complete(TM_CORO_t* Coro, uint8_t Status) {
+	Coro->Status = Status;
+	Coro->Done = 1;
+}
+
+#if CORO_USE_I2C || defined(DOXYGEN)
+/**
+ * @brief  I2C queued transaction callback for coroutines
+ * @note   Used by TM_CORO_AWAIT_I2C_xxx macros, Param is coroutine
+ */
+void TM_CORO_I2CCallback(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+#endif
+
+#if CORO_USE_SPI_DMA || defined(DOXYGEN)
+/**
+ * @brief  Adds SPI DMA job for coroutine to queue
+ * @note   Used by @ref TM_CORO_AWAIT_SPI_DMA macro
+ * @param  *Coro: Pointer to @ref TM_CORO_t structure
+ * @param  *SPIx: Pointer to SPIx peripheral
+ * @param  *Job: Pointer to @ref TM_SPI_DMA_Job_t structure
+ * @retval Queue status:
+ *            - 0: Queue is full
+ *            - > 0: Job added to queue
+ */
+uint8_t TM_CORO_SPIEnqueue(TM_CORO_t* Coro, SPI_TypeDef* SPIx, const TM_SPI_DMA_Job_t* Job);
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,26 +25,292 @@
  */
 #include "tm_stm32_cpu_load.h"
 
+/* Sleep and work counters */
+static uint32_t CPULOAD_LastWake = 0;
+static uint32_t CPULOAD_WorkingTime = 0;
+static uint32_t CPULOAD_SleepingTime = 0;
+
+/* Private functions */
+static uint8_t TM_CPULOAD_INT_Sleep(TM_CPULOAD_t* CPU_Load, uint32_t Millis);
+
+#if CPULOAD_CONTEXTS > 0
+/* Contexts table, first is main loop and second collects contexts not fitting to table */
+static TM_CPULOAD_Context_t CPULOAD_Contexts[CPULOAD_CONTEXTS < 2 ? 2 : CPULOAD_CONTEXTS];
+static uint16_t CPULOAD_ContextsCount = 2;
+#define CPULOAD_CONTEXTS_SIZE   (sizeof(CPULOAD_Contexts) / sizeof(CPULOAD_Contexts[0]))
+
+/* Exception number to context index + 1 */
+static uint8_t CPULOAD_VectorMap[CPULOAD_VECTORS];
+
+/* Stack of interrupted contexts */
+static TM_CPULOAD_Context_t* CPULOAD_Stack[CPULOAD_ISR_DEPTH];
+static uint8_t CPULOAD_Depth = 0;
+
+/* Currently running context */
+static TM_CPULOAD_Context_t* CPULOAD_Current = &CPULOAD_Contexts[0];
+static TM_CPULOAD_Context_t* CPULOAD_Task = &CPULOAD_Contexts[0];
+
+/* Cycles of last context change and period */
+static uint32_t CPULOAD_Last = 0;
+static uint32_t CPULOAD_PeriodStart = 0;
+static uint32_t CPULOAD_Periods[CPULOAD_WINDOW];
+static uint8_t CPULOAD_Slot = 0;
+
+/* Private functions */
+static void TM_CPULOAD_INT_Switch(TM_CPULOAD_Context_t* Next);
+static TM_CPULOAD_Context_t* TM_CPULOAD_INT_Find(uint32_t Id, const char* Name);
+#endif
+
 uint8_t TM_CPULOAD_Init(TM_CPULOAD_t* CPU_Load) {
+#if CPULOAD_CONTEXTS > 0
+	uint8_t status;
+#endif
+	
 	/* Set values to 0 */
 	CPU_Load->Load = 0;
 	CPU_Load->SCNT = 0;
 	CPU_Load->WCNT = 0;
 	CPU_Load->Updated = 0;
 	
+#if CPULOAD_CONTEXTS > 0
+	/* Name fixed contexts */
+	CPULOAD_Contexts[0].Name = "Main";
+	CPULOAD_Contexts[1].Name = "Other";
+	
+	/* Start counting to main context */
+	status = TM_GENERAL_DWTCounterEnable();
+	CPULOAD_Last = CPULOAD_PeriodStart = DWT->CYCCNT;
+	
+	/* Return DWT counter enabled status */
+	return status;
+#else
 	/* Return DWT counter enabled status */
 	return TM_GENERAL_DWTCounterEnable();
+#endif
 }
 
 uint8_t TM_CPULOAD_GoToSleepMode(TM_CPULOAD_t* CPU_Load) {
+	/* Sleep till any interrupt */
+	return TM_CPULOAD_INT_Sleep(CPU_Load, 0);
+}
+
+#if CPULOAD_TICKLESS
+uint8_t TM_CPULOAD_GoToSleepModeTickless(TM_CPULOAD_t* CPU_Load, uint32_t Millis) {
+	/* Sleep without SysTick interrupts */
+	return TM_CPULOAD_INT_Sleep(CPU_Load, Millis);
+}
+#endif
+
+#if CPULOAD_CONTEXTS > 0
+void TM_CPULOAD_ISREnter(uint32_t vector) {
+	uint32_t irq;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Save interrupted context */
+	if (CPULOAD_Depth < CPULOAD_ISR_DEPTH) {
+		CPULOAD_Stack[CPULOAD_Depth] = CPULOAD_Current;
+	}
+	CPULOAD_Depth++;
+	
+	/* Switch to vector context */
+	if (vector < CPULOAD_VECTORS && CPULOAD_VectorMap[vector]) {
+		TM_CPULOAD_INT_Switch(&CPULOAD_Contexts[CPULOAD_VectorMap[vector] - 1]);
+	} else {
+		TM_CPULOAD_INT_Switch(TM_CPULOAD_INT_Find(vector, NULL));
+		if (vector < CPULOAD_VECTORS && CPULOAD_Current != &CPULOAD_Contexts[1]) {
+			CPULOAD_VectorMap[vector] = CPULOAD_Current - CPULOAD_Contexts + 1;
+		}
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_CPULOAD_ISRExit(void) {
+	uint32_t irq;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Switch back to interrupted context */
+	if (CPULOAD_Depth) {
+		CPULOAD_Depth--;
+		if (CPULOAD_Depth < CPULOAD_ISR_DEPTH) {
+			TM_CPULOAD_INT_Switch(CPULOAD_Stack[CPULOAD_Depth]);
+		}
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_CPULOAD_TaskSwitchedIn(void* Task, const char* Name) {
+	/* Find task context, called from PendSV */
+	if (CPULOAD_Task->Id != (uint32_t)Task) {
+		CPULOAD_Task = TM_CPULOAD_INT_Find((uint32_t)Task, Name);
+	}
+	
+	/* Start counting for task */
+	TM_CPULOAD_INT_Switch(CPULOAD_Task);
+}
+
+void TM_CPULOAD_TaskSwitchedOut(void) {
+	/* Count cycles to task which is switched out */
+	TM_CPULOAD_INT_Switch(CPULOAD_Current);
+}
+
+void TM_CPULOAD_UpdateContexts(void) {
+	uint32_t irq, now, total;
+	uint16_t i, j;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Count cycles till now to current context */
+	TM_CPULOAD_INT_Switch(CPULOAD_Current);
+	
+	/* Close period */
+	now = DWT->CYCCNT;
+	CPULOAD_Periods[CPULOAD_Slot] = now - CPULOAD_PeriodStart;
+	CPULOAD_PeriodStart = now;
+	for (i = 0; i < CPULOAD_ContextsCount; i++) {
+		CPULOAD_Contexts[i].History[CPULOAD_Slot] = CPULOAD_Contexts[i].CNT;
+		CPULOAD_Contexts[i].CNT = 0;
+	}
+	if (++CPULOAD_Slot >= CPULOAD_WINDOW) {
+		CPULOAD_Slot = 0;
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Total cycles in window */
+	total = 0;
+	for (j = 0; j < CPULOAD_WINDOW; j++) {
+		total += CPULOAD_Periods[j];
+	}
+	
+	/* Calculate load over window */
+	for (i = 0; i < CPULOAD_ContextsCount; i++) {
+		uint32_t cycles = 0;
+		for (j = 0; j < CPULOAD_WINDOW; j++) {
+			cycles += CPULOAD_Contexts[i].History[j];
+		}
+		CPULOAD_Contexts[i].Load = total ? ((float)cycles / (float)total * 100) : 0;
+	}
+}
+
+uint16_t TM_CPULOAD_GetRanked(TM_CPULOAD_Context_t** Contexts, uint16_t count) {
+	uint16_t i, j, n = 0;
+	TM_CPULOAD_Context_t* ctx;
+	
+	/* Insert sorted by load */
+	for (i = 0; i < CPULOAD_ContextsCount; i++) {
+		ctx = &CPULOAD_Contexts[i];
+		
+		/* Find position */
+		for (j = n; j > 0 && Contexts[j - 1]->Load < ctx->Load; j--) {
+			if (j < count) {
+				Contexts[j] = Contexts[j - 1];
+			}
+		}
+		
+		/* Save if in range */
+		if (j < count) {
+			Contexts[j] = ctx;
+			if (n < count) {
+				n++;
+			}
+		}
+	}
+	
+	/* Return number of contexts */
+	return n;
+}
+
+void TM_CPULOAD_Dump(void (*OutputFunc)(char *)) {
+	TM_CPULOAD_Context_t* ranked[CPULOAD_CONTEXTS_SIZE];
+	uint16_t i, n;
+	uint32_t load;
+	char str[48];
+	
+	/* Get sorted contexts */
+	n = TM_CPULOAD_GetRanked(ranked, CPULOAD_CONTEXTS_SIZE);
+	
+	/* Print table */
+	OutputFunc("Context                  Load\n");
+	for (i = 0; i < n; i++) {
+		/* Load in 0.01% units, no float printf needed */
+		load = (uint32_t)(ranked[i]->Load * 100);
+		if (ranked[i]->Name) {
+			sprintf(str, "%-20.20s %4lu.%02lu%%\n", ranked[i]->Name, (unsigned long)(load / 100), (unsigned long)(load % 100));
+		} else {
+			sprintf(str, "IRQ %-16d %4lu.%02lu%%\n", (int)ranked[i]->Id - 16, (unsigned long)(load / 100), (unsigned long)(load % 100));
+		}
+		OutputFunc(str);
+	}
+}
+
+/* Called with disabled interrupts */
+static void TM_CPULOAD_INT_Switch(TM_CPULOAD_Context_t* Next) {
+	uint32_t now = DWT->CYCCNT;
+	
+	/* Count cycles to running context */
+	CPULOAD_Current->CNT += now - CPULOAD_Last;
+	CPULOAD_Last = now;
+	
+	/* Set new context */
+	CPULOAD_Current = Next;
+}
+
+/* Called with disabled interrupts */
+static TM_CPULOAD_Context_t* TM_CPULOAD_INT_Find(uint32_t Id, const char* Name) {
+	uint16_t i;
+	
+	/* Search table, first 2 contexts are fixed */
+	for (i = 2; i < CPULOAD_ContextsCount; i++) {
+		if (CPULOAD_Contexts[i].Id == Id && (CPULOAD_Contexts[i].Name == NULL) == (Name == NULL)) {
+			return &CPULOAD_Contexts[i];
+		}
+	}
+	
+	/* Table is full */
+	if (CPULOAD_ContextsCount >= CPULOAD_CONTEXTS_SIZE) {
+		return &CPULOAD_Contexts[1];
+	}
+	
+	/* Add new context */
+	CPULOAD_Contexts[i].Id = Id;
+	CPULOAD_Contexts[i].Name = Name;
+	CPULOAD_ContextsCount++;
+	
+	return &CPULOAD_Contexts[i];
+}
+#endif
+
+static uint8_t TM_CPULOAD_INT_Sleep(TM_CPULOAD_t* CPU_Load, uint32_t Millis) {
 	uint32_t t;
-	static uint32_t l = 0;
-	static uint32_t WorkingTime = 0;
-	static uint32_t SleepingTime = 0;
 	uint8_t irq_status;
 	
 	/* Add to working time */
-	WorkingTime += DWT->CYCCNT - l;
+	CPULOAD_WorkingTime += DWT->CYCCNT - CPULOAD_LastWake;
 	
 	/* Save count cycle time */
 	t = DWT->CYCCNT;
@@ -55,15 +321,35 @@ uint8_t TM_CPULOAD_GoToSleepMode(TM_CPULOAD_t* CPU_Load) {
 	/* Disable interrupts */
 	__disable_irq();
 	
+#if CPULOAD_TICKLESS
+	/* Stretch SysTick period, do not sleep if SysTick interrupt is pending */
+	if (Millis == 0 || TM_DELAY_SuppressTicks(Millis)) {
+		/* Go to sleep mode */
+		/* Wait for wake up interrupt, systick can do it too */
+		__WFI();
+	}
+	
+	/* Process slept time in SysTick if woken by other interrupt */
+	if (Millis) {
+		TM_DELAY_ResumeTicks();
+	}
+#else
 	/* Go to sleep mode */
 	/* Wait for wake up interrupt, systick can do it too */
 	__WFI();
+#endif
 	
 	/* Increase number of sleeping time in CPU cycles */
-	SleepingTime += DWT->CYCCNT - t;
+	CPULOAD_SleepingTime += DWT->CYCCNT - t;
+	
+#if CPULOAD_CONTEXTS > 0
+	/* Sleeping time is not counted to any context */
+	CPULOAD_Current->CNT += t - CPULOAD_Last;
+	CPULOAD_Last = DWT->CYCCNT;
+#endif
 	
 	/* Save current time to get number of working CPU cycles */
-	l = DWT->CYCCNT;
+	CPULOAD_LastWake = DWT->CYCCNT;
 	
 	/* Enable interrupts, process/execute an interrupt routine which wake up CPU */
 	if (!irq_status) {
@@ -74,16 +360,21 @@ uint8_t TM_CPULOAD_GoToSleepMode(TM_CPULOAD_t* CPU_Load) {
 	CPU_Load->Updated = 0;
 	
 	/* Every 1000ms print CPU load via USART */
-	if ((SleepingTime + WorkingTime) >= HAL_RCC_GetHCLKFreq()) {
+	if ((CPULOAD_SleepingTime + CPULOAD_WorkingTime) >= HAL_RCC_GetHCLKFreq()) {
 		/* Save values */
-		CPU_Load->SCNT = SleepingTime;
-		CPU_Load->WCNT = WorkingTime;
-		CPU_Load->Load = ((float)WorkingTime / (float)(SleepingTime + WorkingTime) * 100);
+		CPU_Load->SCNT = CPULOAD_SleepingTime;
+		CPU_Load->WCNT = CPULOAD_WorkingTime;
+		CPU_Load->Load = ((float)CPULOAD_WorkingTime / (float)(CPULOAD_SleepingTime + CPULOAD_WorkingTime) * 100);
 		CPU_Load->Updated = 1;
 		
+#if CPULOAD_CONTEXTS > 0
+		/* Update per context load */
+		TM_CPULOAD_UpdateContexts();
+#endif
+		
 		/* Reset time */
-		SleepingTime = 0;
-		WorkingTime = 0;
+		CPULOAD_SleepingTime = 0;
+		CPULOAD_WorkingTime = 0;
 	}
 	
 	/* Return updated status */
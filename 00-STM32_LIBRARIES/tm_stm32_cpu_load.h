@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-19-cpu-load-monitor-for-stm32fxxx/
- * @version v1.0
+ * @version v1.2
  * @ide     Keil uVision
  * @license MIT
  * @brief   CPU load monitoring for STM32F4/7xx
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_CPU_LOAD_H
-#define TM_CPU_LOAD_H 100
+#define TM_CPU_LOAD_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -51,12 +51,62 @@ extern "C" {
  * @defgroup TM_CPULOAD
  * @brief    CPU load monitoring for STM32F4/7xx - http://stm32f4-discovery.com/2015/08/hal-library-19-cpu-load-monitor-for-stm32fxxx/
  * @{
+ *
+ * \par Load per context
+ *
+ * When @ref CPULOAD_CONTEXTS is greater than 0, library also counts DWT cycles for each context separately.
+ * Context is main loop, every interrupt vector wrapped with @ref TM_CPULOAD_ISR_ENTER and @ref TM_CPULOAD_ISR_EXIT macros
+ * and every FreeRTOS task when trace hooks are set.
+ * Load is calculated over sliding window of last @ref CPULOAD_WINDOW periods, which are closed when total load is updated.
+ *
+\code
+//Number of contexts, including main context
+#define CPULOAD_CONTEXTS      16
+//Number of periods in sliding window
+#define CPULOAD_WINDOW        4
+
+//Interrupt handler
+void USART1_IRQHandler(void) {
+	TM_CPULOAD_ISR_ENTER();
+	
+	//Your code here
+	
+	TM_CPULOAD_ISR_EXIT();
+}
+
+//FreeRTOSConfig.h
+#define traceTASK_SWITCHED_IN()     TM_CPULOAD_TaskSwitchedIn(pxCurrentTCB, pxCurrentTCB->pcTaskName)
+#define traceTASK_SWITCHED_OUT()    TM_CPULOAD_TaskSwitchedOut()
+\endcode
+ *
+ * When FreeRTOS is used, @ref TM_CPULOAD_GoToSleepMode can be called from idle hook, or @ref TM_CPULOAD_UpdateContexts
+ * can be called periodically to close period. Results are printed sorted by load with @ref TM_CPULOAD_Dump function.
+ *
+ * \par Tickless sleep
+ *
+ * When @ref CPULOAD_TICKLESS is enabled, @ref TM_CPULOAD_GoToSleepModeTickless stretches SysTick period with
+ * @ref TM_DELAY tickless functions before sleep, so core is not woken up each millisecond.
+ * Sleeping cycles are counted the same way as with @ref TM_CPULOAD_GoToSleepMode.
+ *
+\code
+//Enable tickless sleep, TM DELAY must be in tickless mode
+#define CPULOAD_TICKLESS      1
+#define DELAY_TICKLESS        1
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added optional CPU load for each interrupt vector and FreeRTOS task over sliding window
+  
+ Version 1.2
+  - October 14, 2026
+  - Added tickless sleep mode with TM DELAY library
 \endverbatim
  *
  * \par Dependencies
@@ -65,19 +115,86 @@ extern "C" {
  - STM32Fxxx HAL
  - defines.h
  - TM GENERAL
+ - TM DELAY (only when CPULOAD_TICKLESS)
+ - stdio.h
 \endverbatim
  */
 
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_general.h"
+#include "stdio.h"
 
 /**
  * @defgroup TM_CPULOAD_Macros
  * @brief    Library defines
  * @{
  */
-/* Macros here */
+
+/**
+ * @brief  Number of contexts for per context load, set to 0 to disable
+ * @note   First context is always main loop, second collects contexts which do not fit to table
+ */
+#ifndef CPULOAD_CONTEXTS
+#define CPULOAD_CONTEXTS        0
+#endif
+
+/**
+ * @brief  Number of periods in sliding window for per context load
+ */
+#ifndef CPULOAD_WINDOW
+#define CPULOAD_WINDOW          4
+#endif
+
+/**
+ * @brief  Maximal number of nested interrupts
+ */
+#ifndef CPULOAD_ISR_DEPTH
+#define CPULOAD_ISR_DEPTH       8
+#endif
+
+/**
+ * @brief  Number of exception vectors for fast vector to context mapping
+ */
+#ifndef CPULOAD_VECTORS
+#define CPULOAD_VECTORS         128
+#endif
+
+/**
+ * @brief  Tickless sleep with TM DELAY library, disabled by default
+ */
+#ifndef CPULOAD_TICKLESS
+#define CPULOAD_TICKLESS        0
+#endif
+
+#if CPULOAD_TICKLESS
+#include "tm_stm32_delay.h"
+
+/* Check tickless mode */
+#if !DELAY_TICKLESS
+#error "TM CPULOAD needs DELAY_TICKLESS set to 1 for tickless sleep!"
+#endif
+#endif
+
+#if CPULOAD_CONTEXTS > 0 || defined(DOXYGEN)
+/**
+ * @brief  Marks interrupt handler entry, must be first in handler
+ * @param  None
+ * @retval None
+ */
+#define TM_CPULOAD_ISR_ENTER()  TM_CPULOAD_ISREnter(__get_IPSR())
+
+/**
+ * @brief  Marks interrupt handler exit, must be last in handler
+ * @param  None
+ * @retval None
+ */
+#define TM_CPULOAD_ISR_EXIT()   TM_CPULOAD_ISRExit()
+#else
+#define TM_CPULOAD_ISR_ENTER()
+#define TM_CPULOAD_ISR_EXIT()
+#endif
+
 /**
  * @}
  */
@@ -98,6 +215,17 @@ typedef struct {
 	uint32_t SCNT;   /*!< Number of sleeping cycles in one period. Meant for private use */
 } TM_CPULOAD_t;
 
+/**
+ * @brief  CPU load of one context
+ */
+typedef struct {
+	const char* Name;                   /*!< Context name, NULL for interrupt vectors */
+	uint32_t Id;                        /*!< Exception number for interrupts or task handle for tasks */
+	float Load;                         /*!< Load percentage over sliding window */
+	uint32_t CNT;                       /*!< Number of cycles in current period. Meant for private use */
+	uint32_t History[CPULOAD_WINDOW];   /*!< Number of cycles in last periods. Meant for private use */
+} TM_CPULOAD_Context_t;
+
 /**
  * @}
  */
@@ -128,6 +256,74 @@ uint8_t TM_CPULOAD_Init(TM_CPULOAD_t* CPU_Load);
  */
 uint8_t TM_CPULOAD_GoToSleepMode(TM_CPULOAD_t* CPU_Load);
 
+#if CPULOAD_TICKLESS || defined(DOXYGEN)
+/** 
+ * @brief  Goes to low power mode without SysTick interrupts for up to given time and measures sleeping time
+ * @note   Core wakes up on first software timer expiry, after Millis or on any other interrupt
+ * @note   Available when @ref CPULOAD_TICKLESS is enabled
+ * @param  *CPU_Load: Pointer to @ref TM_CPULOAD_t structure 
+ * @param  Millis: Maximal sleep time in milliseconds
+ * @retval CPU load value updated status.
+ *           - 0: CPU load value is not updated, still old results
+ *           - > 0: CPU load value is updated
+ */
+uint8_t TM_CPULOAD_GoToSleepModeTickless(TM_CPULOAD_t* CPU_Load, uint32_t Millis);
+#endif
+
+/**
+ * @brief  Counts cycles to interrupt context
+ * @note   Used by @ref TM_CPULOAD_ISR_ENTER macro
+ * @param  vector: Exception number of interrupt
+ * @retval None
+ */
+void TM_CPULOAD_ISREnter(uint32_t vector);
+
+/**
+ * @brief  Counts cycles back to interrupted context
+ * @note   Used by @ref TM_CPULOAD_ISR_EXIT macro
+ * @param  None
+ * @retval None
+ */
+void TM_CPULOAD_ISRExit(void);
+
+/**
+ * @brief  Counts cycles to FreeRTOS task, called from traceTASK_SWITCHED_IN hook
+ * @param  *Task: Task handle
+ * @param  *Name: Task name
+ * @retval None
+ */
+void TM_CPULOAD_TaskSwitchedIn(void* Task, const char* Name);
+
+/**
+ * @brief  Counts cycles of stopped FreeRTOS task, called from traceTASK_SWITCHED_OUT hook
+ * @param  None
+ * @retval None
+ */
+void TM_CPULOAD_TaskSwitchedOut(void);
+
+/**
+ * @brief  Closes current period and calculates load of all contexts over sliding window
+ * @note   Called by @ref TM_CPULOAD_GoToSleepMode when total CPU load is updated
+ * @param  None
+ * @retval None
+ */
+void TM_CPULOAD_UpdateContexts(void);
+
+/**
+ * @brief  Gets contexts sorted by load, highest load first
+ * @param  **Contexts: Pointer to array of pointers to be filled
+ * @param  count: Size of array
+ * @retval Number of contexts saved to array
+ */
+uint16_t TM_CPULOAD_GetRanked(TM_CPULOAD_Context_t** Contexts, uint16_t count);
+
+/**
+ * @brief  Prints table of contexts sorted by load
+ * @param  *OutputFunc: Pointer to function which outputs string
+ * @retval None
+ */
+void TM_CPULOAD_Dump(void (*OutputFunc)(char *));
+
 /**
  * @}
  */
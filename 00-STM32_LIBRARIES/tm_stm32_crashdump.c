@@ -0,0 +1,366 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_crashdump.h"
+
+/* Magic value for valid dump */
+#define CRASHDUMP_MAGIC           0x44554D50
+
+/* Dump in flash */
+#define CRASHDUMP                 ((const TM_CRASHDUMP_t *)CRASHDUMP_ADDRESS)
+
+/* RAM regions */
+static TM_CRASHDUMP_Block_t Regions[CRASHDUMP_REGIONS];
+
+/* Dump header is prepared in RAM, not on stack which might be broken */
+static TM_CRASHDUMP_t Dump;
+static uint32_t Dump_Address;
+
+/* Private functions */
+void TM_CRASHDUMP_INT_Fault(uint32_t* frame, uint32_t exc_return, uint32_t* regs);
+static void TM_CRASHDUMP_INT_Program(uint32_t address, uint32_t data);
+static void TM_CRASHDUMP_INT_Write(const void* data, uint32_t size);
+static void TM_CRASHDUMP_INT_WriteBlock(uint32_t address, uint32_t size);
+static uint8_t TM_CRASHDUMP_INT_IsValid(void);
+
+uint8_t TM_CRASHDUMP_Init(void) {
+	uint32_t* ptr;
+	
+	/* Valid dump, keep it */
+	if (TM_CRASHDUMP_INT_IsValid()) {
+		return 1;
+	}
+	
+	/* Check if sector is ready */
+	for (ptr = (uint32_t *)CRASHDUMP_ADDRESS; ptr < (uint32_t *)(CRASHDUMP_ADDRESS + CRASHDUMP_MAX_SIZE); ptr++) {
+		if (*ptr != 0xFFFFFFFF) {
+			/* Erase sector */
+			TM_CRASHDUMP_Clear();
+			break;
+		}
+	}
+	
+	/* No dump */
+	return 0;
+}
+
+uint8_t TM_CRASHDUMP_AddRegion(const void* Address, uint32_t Size) {
+	uint8_t i;
+	
+	/* Find free slot */
+	for (i = 0; i < CRASHDUMP_REGIONS; i++) {
+		if (Regions[i].Size == 0) {
+			Regions[i].Address = (uint32_t)Address;
+			Regions[i].Size = Size;
+			
+			/* Return OK */
+			return 1;
+		}
+	}
+	
+	/* No free slot */
+	return 0;
+}
+
+const TM_CRASHDUMP_t* TM_CRASHDUMP_Get(void) {
+	/* Check dump */
+	if (!TM_CRASHDUMP_INT_IsValid()) {
+		return NULL;
+	}
+	
+	/* Return header */
+	return CRASHDUMP;
+}
+
+const TM_CRASHDUMP_Block_t* TM_CRASHDUMP_GetBlock(uint32_t index) {
+	const TM_CRASHDUMP_Block_t* Block;
+	
+	/* Check dump and index */
+	if (!TM_CRASHDUMP_INT_IsValid() || index >= CRASHDUMP->Blocks) {
+		return NULL;
+	}
+	
+	/* Go through blocks */
+	Block = (const TM_CRASHDUMP_Block_t *)(CRASHDUMP + 1);
+	while (index--) {
+		Block = (const TM_CRASHDUMP_Block_t *)((uint32_t)(Block + 1) + ((Block->Size + 3) & ~3));
+	}
+	
+	/* Return block */
+	return Block;
+}
+
+void TM_CRASHDUMP_Clear(void) {
+	FLASH_EraseInitTypeDef Erase;
+	uint32_t error;
+	
+	/* Erase sector */
+	Erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	Erase.Sector = CRASHDUMP_SECTOR;
+	Erase.NbSectors = 1;
+	Erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+	
+	HAL_FLASH_Unlock();
+	HAL_FLASHEx_Erase(&Erase, &error);
+	HAL_FLASH_Lock();
+	
+#if defined(STM32F7xx)
+	/* Flash content has changed */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)CRASHDUMP_ADDRESS, CRASHDUMP_MAX_SIZE);
+#endif
+}
+
+#if CRASHDUMP_USE_FATFS
+FRESULT TM_CRASHDUMP_SaveToFile(const char* path) {
+	FIL fil;
+	FRESULT fres;
+	UINT bw;
+	
+	/* Check dump */
+	if (!TM_CRASHDUMP_INT_IsValid()) {
+		return FR_NO_FILE;
+	}
+	
+	/* Open file */
+	fres = f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (fres != FR_OK) {
+		return fres;
+	}
+	
+	/* Write dump directly from flash */
+	fres = f_write(&fil, CRASHDUMP, CRASHDUMP->Size, &bw);
+	if (fres == FR_OK && bw != CRASHDUMP->Size) {
+		fres = FR_DENIED;
+	}
+	
+	/* Close file */
+	if (f_close(&fil) != FR_OK && fres == FR_OK) {
+		fres = FR_DISK_ERR;
+	}
+	
+	/* Return result */
+	return fres;
+}
+#endif
+
+/* Callbacks */
+__weak void TM_CRASHDUMP_Callback(const TM_CRASHDUMP_t* Dump) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_CRASHDUMP_Callback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+void TM_CRASHDUMP_INT_Fault(uint32_t* frame, uint32_t exc_return, uint32_t* regs) {
+	uint32_t stack, size;
+	uint8_t i;
+	
+	/* Registers R0 - R3 and R12 are in stacked frame, R4 - R11 were pushed by handler */
+	for (i = 0; i < 4; i++) {
+		Dump.R[i] = frame[i];
+	}
+	for (i = 0; i < 8; i++) {
+		Dump.R[4 + i] = regs[i];
+	}
+	Dump.R[12] = frame[4];
+	Dump.LR = frame[5];
+	Dump.PC = frame[6];
+	Dump.xPSR = frame[7];
+	Dump.EXC_RETURN = exc_return;
+	
+	/* Stack before exception, 8 words frame, 26 words with FPU state and 4 bytes alignment */
+	stack = (uint32_t)frame + ((exc_return & 0x10) ? 0x20 : 0x68);
+	if (frame[7] & (1UL << 9)) {
+		stack += 4;
+	}
+	Dump.SP = stack;
+	
+	/* Fault status */
+	Dump.Exception = __get_IPSR() & 0x1FF;
+	Dump.CFSR = SCB->CFSR;
+	Dump.HFSR = SCB->HFSR;
+	Dump.MMFAR = SCB->MMFAR;
+	Dump.BFAR = SCB->BFAR;
+	Dump.Tick = HAL_GetTick();
+	Dump.Blocks = 0;
+	
+	/* Unlock flash */
+	if (FLASH->CR & FLASH_CR_LOCK) {
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+	}
+	
+	/* Wait for operation in progress and clear errors */
+	while (FLASH->SR & FLASH_SR_BSY);
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR;
+	
+	/* Word programming */
+	FLASH->CR &= ~(FLASH_CR_PSIZE | FLASH_CR_SER | FLASH_CR_MER);
+	FLASH->CR |= FLASH_PSIZE_WORD | FLASH_CR_PG;
+	
+	/* Blocks start after header */
+	Dump_Address = CRASHDUMP_ADDRESS + sizeof(TM_CRASHDUMP_t);
+	
+	/* Stack from exception frame up, only when it is in RAM */
+	stack = (uint32_t)frame;
+	if (stack >= CRASHDUMP_RAM_START && stack < CRASHDUMP_RAM_END) {
+		size = CRASHDUMP_RAM_END - stack;
+		if (size > CRASHDUMP_STACK_SIZE) {
+			size = CRASHDUMP_STACK_SIZE;
+		}
+		TM_CRASHDUMP_INT_WriteBlock(stack, size);
+	}
+	
+	/* User regions */
+	for (i = 0; i < CRASHDUMP_REGIONS; i++) {
+		if (Regions[i].Size) {
+			TM_CRASHDUMP_INT_WriteBlock(Regions[i].Address, Regions[i].Size);
+		}
+	}
+	
+#if CRASHDUMP_USE_BKPTRACE
+	/* Trace ring with its header */
+	TM_CRASHDUMP_INT_WriteBlock(BKPSRAM_BASE + BKPTRACE_BKPSRAM_OFFSET, 16 + BKPTRACE_SIZE * sizeof(TM_BKPTRACE_Event_t));
+#endif
+	
+	/* Write header, magic word is last, so dump is valid only when everything is written */
+	Dump.Size = Dump_Address - CRASHDUMP_ADDRESS;
+	Dump_Address = CRASHDUMP_ADDRESS + 4;
+	TM_CRASHDUMP_INT_Write((uint32_t *)&Dump + 1, sizeof(TM_CRASHDUMP_t) - 4);
+	TM_CRASHDUMP_INT_Program(CRASHDUMP_ADDRESS, CRASHDUMP_MAGIC);
+	
+	/* Lock flash */
+	FLASH->CR &= ~FLASH_CR_PG;
+	FLASH->CR |= FLASH_CR_LOCK;
+	
+	/* Call user function */
+	TM_CRASHDUMP_Callback(CRASHDUMP);
+	
+	/* Reset system */
+	NVIC_SystemReset();
+}
+
+static void TM_CRASHDUMP_INT_Program(uint32_t address, uint32_t data) {
+	/* Program one word and wait */
+	*(__IO uint32_t *)address = data;
+	__DSB();
+	while (FLASH->SR & FLASH_SR_BSY);
+}
+
+static void TM_CRASHDUMP_INT_Write(const void* data, uint32_t size) {
+	const uint8_t* ptr = (const uint8_t *)data;
+	uint32_t word;
+	
+	/* Write words, last one is padded */
+	while (size) {
+		word = 0xFFFFFFFF;
+		memcpy(&word, ptr, size > 4 ? 4 : size);
+		TM_CRASHDUMP_INT_Program(Dump_Address, word);
+		
+		/* Go to next word */
+		Dump_Address += 4;
+		ptr += 4;
+		size = size > 4 ? size - 4 : 0;
+	}
+}
+
+static void TM_CRASHDUMP_INT_WriteBlock(uint32_t address, uint32_t size) {
+	TM_CRASHDUMP_Block_t Block;
+	
+	/* Limit size to free space */
+	if ((Dump_Address + sizeof(TM_CRASHDUMP_Block_t) + size) > (CRASHDUMP_ADDRESS + CRASHDUMP_MAX_SIZE)) {
+		if ((Dump_Address + sizeof(TM_CRASHDUMP_Block_t)) >= (CRASHDUMP_ADDRESS + CRASHDUMP_MAX_SIZE)) {
+			return;
+		}
+		size = (CRASHDUMP_ADDRESS + CRASHDUMP_MAX_SIZE - Dump_Address - sizeof(TM_CRASHDUMP_Block_t)) & ~3;
+	}
+	
+	/* Write block header and data */
+	Block.Address = address;
+	Block.Size = size;
+	TM_CRASHDUMP_INT_Write(&Block, sizeof(Block));
+	TM_CRASHDUMP_INT_Write((const void *)address, size);
+	
+	/* Block is written */
+	Dump.Blocks++;
+}
+
+static uint8_t TM_CRASHDUMP_INT_IsValid(void) {
+	/* Check magic and size */
+	return CRASHDUMP->Magic == CRASHDUMP_MAGIC && CRASHDUMP->Size <= CRASHDUMP_MAX_SIZE;
+}
+
+/* Fault handlers, save stack pointer, EXC_RETURN and R4 - R11 and go to C function */
+#if defined(__CC_ARM)
+__asm void TM_CRASHDUMP_INT_Entry(void) {
+	IMPORT TM_CRASHDUMP_INT_Fault
+	
+	TST LR, #4
+	ITE EQ
+	MRSEQ R0, MSP
+	MRSNE R0, PSP
+	MOV R1, LR
+	PUSH {R4-R11}
+	MOV R2, SP
+	B TM_CRASHDUMP_INT_Fault
+}
+
+__asm void HardFault_Handler(void) {
+	IMPORT TM_CRASHDUMP_INT_Entry
+	B TM_CRASHDUMP_INT_Entry
+}
+
+__asm void MemManage_Handler(void) {
+	IMPORT TM_CRASHDUMP_INT_Entry
+	B TM_CRASHDUMP_INT_Entry
+}
+
+__asm void BusFault_Handler(void) {
+	IMPORT TM_CRASHDUMP_INT_Entry
+	B TM_CRASHDUMP_INT_Entry
+}
+
+__asm void UsageFault_Handler(void) {
+	IMPORT TM_CRASHDUMP_INT_Entry
+	B TM_CRASHDUMP_INT_Entry
+}
+#else
+__attribute__((naked)) void HardFault_Handler(void) {
+	__ASM volatile (
+		"tst lr, #4         \n"
+		"ite eq             \n"
+		"mrseq r0, msp      \n"
+		"mrsne r0, psp      \n"
+		"mov r1, lr         \n"
+		"push {r4-r11}      \n"
+		"mov r2, sp         \n"
+		"b TM_CRASHDUMP_INT_Fault \n"
+	);
+}
+
+void MemManage_Handler(void) __attribute__((naked, alias("HardFault_Handler")));
+void BusFault_Handler(void) __attribute__((naked, alias("HardFault_Handler")));
+void UsageFault_Handler(void) __attribute__((naked, alias("HardFault_Handler")));
+#endif
@@ -0,0 +1,338 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Fault capture with crash dump to internal flash for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_CRASHDUMP_H
+#define TM_CRASHDUMP_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_CRASHDUMP
+ * @brief    Fault capture with crash dump to internal flash for STM32Fxxx
+ * @{
+ *
+ * Library implements HardFault, MemManage, BusFault and UsageFault handlers.
+ * When fault happens, core registers, stacked exception frame, fault status registers, part of stack and
+ * user selected RAM regions are written to reserved internal flash sector and system is reset.
+ *
+ * Sector is erased on boot, so fault handler only programs words and capture finishes in few milliseconds.
+ * Dump header is written last, so dump is valid only if capture has finished.
+ *
+ * After reset, @ref TM_GENERAL_GetResetSource returns software reset and @ref TM_CRASHDUMP_Init returns 1 when it was caused by fault.
+ * Dump can be read directly from flash with @ref TM_CRASHDUMP_Get or saved to file on SD card with @ref TM_CRASHDUMP_SaveToFile.
+ *
+\code
+uint8_t buffer[256];
+
+//Add RAM region to dump
+TM_CRASHDUMP_AddRegion(buffer, sizeof(buffer));
+
+//Check for crash dump from previous run
+if (TM_CRASHDUMP_Init()) {
+	const TM_CRASHDUMP_t* dump = TM_CRASHDUMP_Get();
+	printf("Fault at PC = 0x%08X, CFSR = 0x%08X\n", dump->PC, dump->CFSR);
+	
+	//Save to SD card and prepare sector for next fault
+	if (TM_CRASHDUMP_SaveToFile("SD:/crash.bin") == FR_OK) {
+		TM_CRASHDUMP_Clear();
+	}
+}
+\endcode
+ *
+ * \par Dump format
+ *
+\verbatim
+ - TM_CRASHDUMP_t header
+ - Blocks, each with TM_CRASHDUMP_Block_t header and data:
+   - Stack, from stacked exception frame up, CRASHDUMP_STACK_SIZE bytes or less
+   - RAM regions added with TM_CRASHDUMP_AddRegion
+   - Backup SRAM trace ring from TM BKPTRACE, when CRASHDUMP_USE_BKPTRACE is enabled
+\endverbatim
+ *
+ * @note  Remove HardFault_Handler, MemManage_Handler, BusFault_Handler and UsageFault_Handler from stm32fxxx_it.c file
+ * @note  Reserve flash sector in linker script or scatter file, so it is not used for code
+ * @note  Erase of sector on boot can take more than 1 second, for 128kB sector
+ * @note  Library is available on STM32F4xx and STM32F7xx devices
+ *
+ * To change settings, open defines.h file and add lines:
+ *
+\code
+//Flash sector and its address for dump, defaults are last 128kB sector of 1MB STM32F4xx and last 256kB sector of 1MB STM32F7xx
+#define CRASHDUMP_SECTOR          FLASH_SECTOR_11
+#define CRASHDUMP_ADDRESS         0x080E0000
+
+//Maximal dump size, must not be bigger than sector
+#define CRASHDUMP_MAX_SIZE        0x4000
+
+//Number of stack bytes in dump
+#define CRASHDUMP_STACK_SIZE      1024
+
+//Maximal number of RAM regions
+#define CRASHDUMP_REGIONS         4
+
+//RAM range where stack can be, for safe stack reading
+#define CRASHDUMP_RAM_START       0x20000000
+#define CRASHDUMP_RAM_END         0x20020000
+
+//Add TM BKPTRACE ring to dump
+#define CRASHDUMP_USE_BKPTRACE    1
+
+//Enable TM_CRASHDUMP_SaveToFile function, TM FATFS is used
+#define CRASHDUMP_USE_FATFS       1
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BKPTRACE, when CRASHDUMP_USE_BKPTRACE is enabled
+ - TM FATFS, when CRASHDUMP_USE_FATFS is enabled
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_CRASHDUMP_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Check device */
+#if defined(STM32F0xx)
+#error "TM CRASHDUMP is not available on STM32F0xx devices"
+#endif
+
+/* Flash sector for dump */
+#ifndef CRASHDUMP_SECTOR
+#if defined(STM32F7xx)
+#define CRASHDUMP_SECTOR          FLASH_SECTOR_7
+#define CRASHDUMP_ADDRESS         0x080C0000
+#else
+#define CRASHDUMP_SECTOR          FLASH_SECTOR_11
+#define CRASHDUMP_ADDRESS         0x080E0000
+#endif
+#endif
+
+/* Maximal dump size */
+#ifndef CRASHDUMP_MAX_SIZE
+#define CRASHDUMP_MAX_SIZE        0x4000
+#endif
+
+/* Number of stack bytes */
+#ifndef CRASHDUMP_STACK_SIZE
+#define CRASHDUMP_STACK_SIZE      1024
+#endif
+
+/* Maximal number of RAM regions */
+#ifndef CRASHDUMP_REGIONS
+#define CRASHDUMP_REGIONS         4
+#endif
+
+/* RAM range for stack */
+#ifndef CRASHDUMP_RAM_START
+#define CRASHDUMP_RAM_START       0x20000000
+#endif
+#ifndef CRASHDUMP_RAM_END
+#if defined(STM32F7xx)
+#define CRASHDUMP_RAM_END         0x20050000
+#else
+#define CRASHDUMP_RAM_END         0x20020000
+#endif
+#endif
+
+/* Add backup trace ring */
+#ifndef CRASHDUMP_USE_BKPTRACE
+#define CRASHDUMP_USE_BKPTRACE    0
+#endif
+
+/* Save to file support */
+#ifndef CRASHDUMP_USE_FATFS
+#define CRASHDUMP_USE_FATFS       0
+#endif
+
+#if CRASHDUMP_USE_BKPTRACE
+#include "tm_stm32_bkptrace.h"
+#endif
+#if CRASHDUMP_USE_FATFS
+#include "tm_stm32_fatfs.h"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_CRASHDUMP_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Crash dump header
+ */
+typedef struct {
+	uint32_t Magic;      /*!< Valid dump magic value */
+	uint32_t Size;       /*!< Dump size in bytes, with header and all blocks */
+	uint32_t Blocks;     /*!< Number of blocks after header */
+	uint32_t Exception;  /*!< Exception number, 3 = HardFault, 4 = MemManage, 5 = BusFault, 6 = UsageFault */
+	uint32_t R[13];      /*!< Registers R0 to R12 at fault */
+	uint32_t SP;         /*!< Stack pointer before exception */
+	uint32_t LR;         /*!< Link register at fault */
+	uint32_t PC;         /*!< Address of faulting instruction */
+	uint32_t xPSR;       /*!< Program status register at fault */
+	uint32_t EXC_RETURN; /*!< Exception return value, tells which stack was used */
+	uint32_t CFSR;       /*!< Configurable fault status register */
+	uint32_t HFSR;       /*!< Hard fault status register */
+	uint32_t MMFAR;      /*!< Memory manage fault address register */
+	uint32_t BFAR;       /*!< Bus fault address register */
+	uint32_t Tick;       /*!< HAL tick at fault */
+} TM_CRASHDUMP_t;
+
+/**
+ * @brief  Memory block header in dump, data follow header
+ */
+typedef struct {
+	uint32_t Address;    /*!< Address of data in memory */
+	uint32_t Size;       /*!< Data size in bytes, data are padded to 4 bytes */
+} TM_CRASHDUMP_Block_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CRASHDUMP_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Checks for dump from previous run and prepares flash sector for next fault
+ * @note   Sector is erased when it does not contain valid dump and is not erased
+ * @param  None
+ * @retval Dump status:
+ *            - 0: No dump, sector is ready
+ *            - 1: Valid dump is in flash, use @ref TM_CRASHDUMP_Clear when it is processed
+ */
+uint8_t TM_CRASHDUMP_Init(void);
+
+/**
+ * @brief  Adds RAM region which is saved on fault
+ * @param  *Address: Region start address
+ * @param  Size: Region size in bytes
+ * @retval Add status:
+ *            - 0: No free slot, increase CRASHDUMP_REGIONS
+ *            - > 0: Region added
+ */
+uint8_t TM_CRASHDUMP_AddRegion(const void* Address, uint32_t Size);
+
+/**
+ * @brief  Gets dump from flash
+ * @param  None
+ * @retval Pointer to @ref TM_CRASHDUMP_t header in flash or NULL if there is no valid dump
+ */
+const TM_CRASHDUMP_t* TM_CRASHDUMP_Get(void);
+
+/**
+ * @brief  Gets memory block from dump
+ * @param  index: Block index, 0 is stack
+ * @retval Pointer to @ref TM_CRASHDUMP_Block_t header in flash, data follow header, or NULL if block does not exist
+ */
+const TM_CRASHDUMP_Block_t* TM_CRASHDUMP_GetBlock(uint32_t index);
+
+/**
+ * @brief  Erases dump, sector is ready for next fault
+ * @param  None
+ * @retval None
+ */
+void TM_CRASHDUMP_Clear(void);
+
+#if CRASHDUMP_USE_FATFS || defined(DOXYGEN)
+/**
+ * @brief  Saves raw dump to file
+ * @note   File system must be mounted
+ * @param  *path: File path, file is overwritten if exists
+ * @retval Member of @ref FRESULT enumeration, FR_NO_FILE if there is no valid dump
+ */
+FRESULT TM_CRASHDUMP_SaveToFile(const char* path);
+#endif
+
+/**
+ * @brief  Called before reset, after dump is written to flash
+ * @note   Called from fault handler with interrupts disabled, keep it short
+ * @param  *Dump: Pointer to dump header in flash
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_CRASHDUMP_Callback(const TM_CRASHDUMP_t* Dump);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,41 @@
  */
 #include "tm_stm32_crc.h"
 
+/* Default polynomial */
+#define CRC_DEFAULT_POLYNOMIAL    0x04C11DB7
+
+/* Configurable CRC unit */
+#if defined(CRC_CR_POLYSIZE)
+#define CRC_CONFIGURABLE          1
+#else
+#define CRC_CONFIGURABLE          0
+#endif
+
+/* Private functions */
+static uint32_t TM_CRC_INT_Reflect(uint32_t value, uint8_t bits);
+#if !CRC_CONFIGURABLE
+static uint32_t TM_CRC_INT_UpdateSoftware(uint32_t crc, const uint8_t* data, uint32_t count);
+#endif
+
+#if !defined(STM32F0xx)
+/* DMA state */
+static TM_CRC_Context_t* CRC_DMA_Context;
+static const uint32_t* CRC_DMA_Data;
+static uint32_t CRC_DMA_Remaining;
+static volatile uint8_t CRC_DMA_Active;
+static DMA_HandleTypeDef CRC_DMA_Handle;
+
+static void TM_CRC_INT_DMAStart(void);
+static void TM_CRC_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+#endif
+
+/* Image verification state */
+static TM_CRC_Context_t CRC_Image_Context;
+static const TM_CRC_Image_t* CRC_Image;
+static volatile TM_CRC_ImageStatus_t CRC_Image_Status = TM_CRC_ImageStatus_Idle;
+
+static void TM_CRC_INT_ImageDone(uint32_t crc, uint8_t error);
+
 void TM_CRC_Init(void) {
 	/* Enable CRC clock */
 	__HAL_RCC_CRC_CLK_ENABLE();
@@ -90,13 +125,13 @@ uint32_t TM_CRC_Calculate16(uint16_t* arr, uint32_t count, uint8_t reset) {
 		arr += 2;
 	}
 	
-	/* Calculate remaining data as 8-bit */
-	cnt = count % 4;
+	/* Calculate remaining data as 16-bit */
+	cnt = count % 2;
 	
 	/* Calculate */
 	while (cnt--) {
 		/* Set new value */
-		*((uint8_t *)&CRC->DR) = *arr++;
+		*((__IO uint16_t *)&CRC->DR) = *arr++;
 	}
 	
 	/* Return data */
@@ -119,3 +154,336 @@ uint32_t TM_CRC_Calculate32(uint32_t* arr, uint32_t count, uint8_t reset) {
 	/* Return data */
 	return CRC->DR;
 }
+
+void TM_CRC_ContextInit(TM_CRC_Context_t* Context, uint32_t Polynomial, uint8_t Size, uint32_t Init, uint8_t Reverse) {
+	/* Save settings */
+	Context->Polynomial = Polynomial;
+	Context->Size = Size;
+	Context->Init = Init;
+	Context->Reverse = Reverse;
+	
+	/* Start with initial value */
+	Context->Value = Init;
+}
+
+void TM_CRC_ContextRestore(TM_CRC_Context_t* Context) {
+#if CRC_CONFIGURABLE
+	uint32_t cr = 0;
+	
+	/* Polynomial size */
+	if (Context->Size == 16) {
+		cr |= CRC_CR_POLYSIZE_0;
+	} else if (Context->Size == 8) {
+		cr |= CRC_CR_POLYSIZE_1;
+	} else if (Context->Size == 7) {
+		cr |= CRC_CR_POLYSIZE;
+	}
+	
+	/* Bit reversal by byte for input and reversed output */
+	if (Context->Reverse) {
+		cr |= CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;
+	}
+	
+#if defined(CRC_POL_POL)
+	/* Set polynomial */
+	CRC->POL = Context->Polynomial;
+#endif
+	
+	/* Load value as initial value and reset */
+	CRC->CR = cr;
+	CRC->INIT = Context->Value;
+	CRC->CR = cr | CRC_CR_RESET;
+#else
+	uint32_t value = Context->Value;
+	uint8_t i;
+	
+	/* No initial value register, calculate word which gives context value after reset */
+	/* Run CRC backwards for 32 bits, polynomial is odd so each step can be reversed */
+	for (i = 0; i < 32; i++) {
+		if (value & 0x01) {
+			value = ((value ^ CRC_DEFAULT_POLYNOMIAL) >> 1) | 0x80000000;
+		} else {
+			value >>= 1;
+		}
+	}
+	
+	/* Reset to 0xFFFFFFFF and feed word */
+	CRC->CR = CRC_CR_RESET;
+	CRC->DR = value ^ 0xFFFFFFFF;
+#endif
+}
+
+uint32_t TM_CRC_ContextSave(TM_CRC_Context_t* Context) {
+	uint32_t value = CRC->DR;
+	
+#if CRC_CONFIGURABLE
+	/* Undo output reversal, initial value is not reversed */
+	if (Context->Reverse) {
+		value = TM_CRC_INT_Reflect(value, Context->Size);
+	}
+	
+	/* Save value */
+	Context->Value = value;
+	
+	/* Set default settings for other functions */
+#if defined(CRC_POL_POL)
+	CRC->POL = CRC_DEFAULT_POLYNOMIAL;
+#endif
+	CRC->CR = 0;
+	CRC->INIT = 0xFFFFFFFF;
+	
+	/* Return value as read from CRC unit */
+	return Context->Reverse ? TM_CRC_INT_Reflect(value, Context->Size) : value;
+#else
+	/* Save value */
+	Context->Value = value;
+	
+	/* Return value */
+	return value;
+#endif
+}
+
+uint32_t TM_CRC_ContextUpdate(TM_CRC_Context_t* Context, const uint8_t* data, uint32_t count) {
+	uint32_t cnt;
+	
+	/* Load context */
+	TM_CRC_ContextRestore(Context);
+	
+#if CRC_CONFIGURABLE
+	/* Feed bytes, unaligned words are not supported by peripheral access */
+	for (cnt = count; cnt; cnt--) {
+		*(__IO uint8_t *)&CRC->DR = *data++;
+	}
+	
+	/* Save context */
+	return TM_CRC_ContextSave(Context);
+#else
+	/* Feed words */
+	for (cnt = count >> 2; cnt; cnt--) {
+		CRC->DR = (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+		data += 4;
+	}
+	
+	/* Save context */
+	TM_CRC_ContextSave(Context);
+	
+	/* Remaining bytes in software */
+	if (count & 0x03) {
+		Context->Value = TM_CRC_INT_UpdateSoftware(Context->Value, data, count & 0x03);
+	}
+	
+	/* Return value */
+	return Context->Value;
+#endif
+}
+
+#if !defined(STM32F0xx)
+uint8_t TM_CRC_CalculateDMA(TM_CRC_Context_t* Context, const uint32_t* arr, uint32_t count) {
+	/* Check if busy */
+	if (CRC_DMA_Active || count == 0) {
+		return 1;
+	}
+	
+	/* Save state */
+	CRC_DMA_Active = 1;
+	CRC_DMA_Context = Context;
+	CRC_DMA_Data = arr;
+	CRC_DMA_Remaining = count;
+	
+	/* Load context */
+	if (Context) {
+		TM_CRC_ContextRestore(Context);
+	}
+	
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(CRC_DMA_STREAM, NULL);
+	CRC_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(CRC_DMA_STREAM);
+	
+	/* Memory to memory, source is peripheral port and increments, CRC data register is fixed */
+	CRC_DMA_Handle.Instance = CRC_DMA_STREAM;
+	CRC_DMA_Handle.Init.Channel = CRC_DMA_CHANNEL;
+	CRC_DMA_Handle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+	CRC_DMA_Handle.Init.PeriphInc = DMA_PINC_ENABLE;
+	CRC_DMA_Handle.Init.MemInc = DMA_MINC_DISABLE;
+	CRC_DMA_Handle.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	CRC_DMA_Handle.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	CRC_DMA_Handle.Init.Mode = DMA_NORMAL;
+	CRC_DMA_Handle.Init.Priority = DMA_PRIORITY_LOW;
+	CRC_DMA_Handle.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+	CRC_DMA_Handle.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	CRC_DMA_Handle.Init.MemBurst = DMA_MBURST_SINGLE;
+	CRC_DMA_Handle.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(CRC_DMA_STREAM, &CRC_DMA_Handle);
+	
+	/* Set library callback for stream and enable interrupts */
+	TM_DMA_SetStreamCallback(CRC_DMA_STREAM, TM_CRC_INT_DMACallback, NULL);
+	TM_DMA_EnableInterrupts(CRC_DMA_STREAM);
+	
+	/* Start first block */
+	TM_CRC_INT_DMAStart();
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_CRC_DMABusy(void) {
+	/* Return status */
+	return CRC_DMA_Active;
+}
+
+__weak void TM_CRC_DMACompleteCallback(TM_CRC_Context_t* Context, uint32_t crc) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_CRC_DMACompleteCallback could be implemented in the user file
+	*/
+}
+#endif
+
+uint8_t TM_CRC_ImageVerifyStart(const TM_CRC_Image_t* Trailer) {
+#if !defined(STM32F0xx)
+	/* Check if busy */
+	if (CRC_DMA_Active) {
+		return 1;
+	}
+#endif
+	
+	/* Check trailer, image must end before trailer */
+	if (
+		Trailer->Magic != TM_CRC_IMAGE_MAGIC ||
+		Trailer->Size == 0 || (Trailer->Size & 0x03) || (Trailer->Start & 0x03) ||
+		Trailer->Size > ((uint32_t)Trailer - Trailer->Start)
+	) {
+		CRC_Image_Status = TM_CRC_ImageStatus_Invalid;
+		TM_CRC_ImageCallback(TM_CRC_ImageStatus_Invalid);
+		return 0;
+	}
+	
+	/* Save trailer */
+	CRC_Image = Trailer;
+	CRC_Image_Status = TM_CRC_ImageStatus_Busy;
+	
+	/* CRC-32/MPEG-2, the same as CRC unit after reset */
+	TM_CRC_ContextInit(&CRC_Image_Context, TM_CRC_CRC32_MPEG2);
+	
+#if !defined(STM32F0xx)
+	/* Feed image with DMA */
+	return TM_CRC_CalculateDMA(&CRC_Image_Context, (const uint32_t *)Trailer->Start, Trailer->Size >> 2);
+#else
+	/* Calculate with CPU */
+	TM_CRC_INT_ImageDone(TM_CRC_Calculate32((uint32_t *)Trailer->Start, Trailer->Size >> 2, 1), 0);
+	
+	/* Return OK */
+	return 0;
+#endif
+}
+
+TM_CRC_ImageStatus_t TM_CRC_ImageGetStatus(void) {
+	/* Return status */
+	return CRC_Image_Status;
+}
+
+__weak void TM_CRC_ImageCallback(TM_CRC_ImageStatus_t status) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_CRC_ImageCallback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static uint32_t TM_CRC_INT_Reflect(uint32_t value, uint8_t bits) {
+	uint32_t result = 0;
+	uint8_t i;
+	
+	/* Reverse lower bits */
+	for (i = 0; i < bits; i++) {
+		result = (result << 1) | (value & 0x01);
+		value >>= 1;
+	}
+	
+	return result;
+}
+
+#if !CRC_CONFIGURABLE
+static uint32_t TM_CRC_INT_UpdateSoftware(uint32_t crc, const uint8_t* data, uint32_t count) {
+	uint8_t i;
+	
+	/* Process each byte MSB first, the same as CRC unit */
+	while (count--) {
+		crc ^= (uint32_t)*data++ << 24;
+		for (i = 0; i < 8; i++) {
+			crc = (crc & 0x80000000) ? (crc << 1) ^ CRC_DEFAULT_POLYNOMIAL : crc << 1;
+		}
+	}
+	
+	return crc;
+}
+#endif
+
+#if !defined(STM32F0xx)
+static void TM_CRC_INT_DMAStart(void) {
+	uint32_t count = CRC_DMA_Remaining;
+	
+	/* Max 0xFFFF words in one transfer */
+	if (count > 0xFFFF) {
+		count = 0xFFFF;
+	}
+	
+	/* Start DMA */
+	TM_DMA_Start(&CRC_DMA_Handle, (uint32_t) CRC_DMA_Data, (uint32_t) &CRC->DR, count);
+	
+	/* Prepare next block */
+	CRC_DMA_Data += count;
+	CRC_DMA_Remaining -= count;
+}
+
+static void TM_CRC_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	uint32_t crc;
+	
+	/* Check for transfer end */
+	if (!(flags & (DMA_FLAG_TCIF | DMA_FLAG_TEIF)) || !CRC_DMA_Active) {
+		return;
+	}
+	
+	/* Continue with next block */
+	if (CRC_DMA_Remaining && !(flags & DMA_FLAG_TEIF)) {
+		TM_CRC_INT_DMAStart();
+		return;
+	}
+	
+	/* Save result */
+	if (CRC_DMA_Context) {
+		crc = TM_CRC_ContextSave(CRC_DMA_Context);
+	} else {
+		crc = CRC->DR;
+	}
+	
+	/* Disable interrupts and remove callback */
+	TM_DMA_DisableInterrupts(CRC_DMA_STREAM);
+	TM_DMA_SetStreamCallback(CRC_DMA_STREAM, NULL, NULL);
+	
+	/* Finished */
+	CRC_DMA_Active = 0;
+	
+	/* Image verification has its own callback */
+	if (CRC_DMA_Context == &CRC_Image_Context) {
+		TM_CRC_INT_ImageDone(crc, (flags & DMA_FLAG_TEIF) ? 1 : 0);
+		return;
+	}
+	TM_CRC_DMACompleteCallback(CRC_DMA_Context, crc);
+}
+#endif
+
+static void TM_CRC_INT_ImageDone(uint32_t crc, uint8_t error) {
+	/* Check result */
+	if (error) {
+		CRC_Image_Status = TM_CRC_ImageStatus_Error;
+	} else if (crc == CRC_Image->Crc) {
+		CRC_Image_Status = TM_CRC_ImageStatus_Ok;
+	} else {
+		CRC_Image_Status = TM_CRC_ImageStatus_Mismatch;
+	}
+	
+	/* Call user function */
+	TM_CRC_ImageCallback(CRC_Image_Status);
+}
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-10-crc-for-stm32fxxx/
- * @version v1.0
+ * @version v1.2
  * @ide     Keil uVision
  * @license MIT
  * @brief   CRC for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_CRC_H
-#define TM_CRC_H 100
+#define TM_CRC_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -54,11 +54,72 @@ extern "C" {
  *
  * Library uses hardware CRC unit in STM32Fxxx device
  *
+ * \par CRC contexts
+ *
+ * CRC unit has only one state. To calculate more CRCs incrementally at the same time (for example frames from 2 interfaces),
+ * use @ref TM_CRC_Context_t for each flow. Context keeps settings and current value
+ * and loads them to CRC unit on each @ref TM_CRC_ContextUpdate call.
+ *
+ * On STM32F0xx and STM32F7xx, polynomial (only on devices with programmable polynomial), size, initial value and bit reversal are configurable,
+ * so CRC-16/CCITT or Modbus CRC can be calculated in hardware. Final XOR, if needed, must be done by user.
+ *
+ * On STM32F4xx, polynomial is fixed to 0x04C11DB7, 32-bit, without reversal. Initial value is still loaded for each context.
+ * Data are fed to CRC unit as 32-bit words, remaining bytes are calculated in software (bytes are processed in word order).
+ *
+ * \par DMA feeding
+ *
+ * On STM32F4xx and STM32F7xx, large blocks of 32-bit words can be fed to CRC unit with memory to memory DMA using @ref TM_CRC_CalculateDMA.
+ * Function returns immediately and @ref TM_CRC_DMACompleteCallback is called when done.
+ * Default DMA stream is DMA2_Stream4, you can change it in defines.h file:
+ *
+\code
+//DMA stream for CRC, must be DMA2 for memory to memory transfers
+#define CRC_DMA_STREAM         DMA2_Stream4
+#define CRC_DMA_CHANNEL        DMA_CHANNEL_0
+\endcode
+ *
+ * \note  Do not use CRC unit while DMA calculation is in progress
+ *
+ * \par Firmware image verification
+ *
+ * Application image can be checked at boot against @ref TM_CRC_Image_t trailer, placed at the end of image.
+ * Trailer is added to firmware as constant, placed last in flash with linker script or scatter file,
+ * and filled after build with tm_stm32_crc_image.py script, which calculates CRC-32/MPEG-2 of binary file up to trailer.
+ *
+\code
+//Trailer in section placed after all other code and constants
+const TM_CRC_Image_t Image_Trailer __attribute__((section(".image_trailer"), used)) = TM_CRC_IMAGE_TRAILER;
+
+//After build (Keil: fromelf --bin --output app.bin app.axf)
+//python tm_stm32_crc_image.py app.bin --base 0x08000000
+
+//Start verification at boot, CPU is free meanwhile
+TM_CRC_ImageVerifyStart(&Image_Trailer);
+
+//Other initialization
+
+//Wait for result
+while (TM_CRC_ImageGetStatus() == TM_CRC_ImageStatus_Busy);
+\endcode
+ *
+ * On STM32F4xx and STM32F7xx, image is fed to CRC unit with DMA, so verification takes about flash read time.
+ * On STM32F0xx, @ref TM_CRC_ImageVerifyStart calculates CRC with CPU before it returns.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added contexts for more incremental CRC flows
+  - Added configurable polynomial, size, initial value and reversal for STM32F0xx and STM32F7xx
+  - Added memory to memory DMA feeding for STM32F4xx and STM32F7xx
+  
+ Version 1.2
+  - October 14, 2026
+  - Added firmware image verification against linker embedded trailer, with DMA on STM32F4xx and STM32F7xx
 \endverbatim
  *
  * \par Dependencies
@@ -66,10 +127,96 @@ extern "C" {
 \verbatim
  - STM32Fxxx HAL
  - defines.h
+ - TM DMA, STM32F4xx and STM32F7xx only
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
+#if !defined(STM32F0xx)
+#include "tm_stm32_dma.h"
+#endif
+
+/**
+ * @defgroup TM_CRC_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* DMA settings for memory to memory feeding */
+#ifndef CRC_DMA_STREAM
+#define CRC_DMA_STREAM         DMA2_Stream4
+#define CRC_DMA_CHANNEL        DMA_CHANNEL_0
+#endif
+
+/**
+ * @brief  Common CRC settings for @ref TM_CRC_ContextInit
+ * @note   Polynomial, size, initial value and reversal
+ * @{
+ */
+#define TM_CRC_CRC32           0x04C11DB7, 32, 0xFFFFFFFF, 1 /*!< CRC-32 (Ethernet, ZIP), XOR result with 0xFFFFFFFF */
+#define TM_CRC_CRC32_MPEG2     0x04C11DB7, 32, 0xFFFFFFFF, 0 /*!< CRC-32/MPEG-2, the same as STM32F4xx CRC unit */
+#define TM_CRC_CRC16_CCITT     0x1021, 16, 0xFFFF, 0         /*!< CRC-16/CCITT-FALSE */
+#define TM_CRC_CRC16_MODBUS    0x8005, 16, 0xFFFF, 1         /*!< CRC-16/MODBUS */
+/**
+ * @}
+ */
+
+/**
+ * @brief  Magic value of image trailer
+ */
+#define TM_CRC_IMAGE_MAGIC     0x494D4743
+
+/**
+ * @brief  Initializer for @ref TM_CRC_Image_t trailer, other fields are set by tm_stm32_crc_image.py script
+ */
+#define TM_CRC_IMAGE_TRAILER   {TM_CRC_IMAGE_MAGIC, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_CRC_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  CRC context for incremental calculation
+ */
+typedef struct {
+	uint32_t Polynomial; /*!< CRC polynomial, ignored on devices without programmable polynomial */
+	uint32_t Init;       /*!< Initial CRC value */
+	uint32_t Value;      /*!< Current CRC value, set to Init on @ref TM_CRC_ContextReset */
+	uint8_t Size;        /*!< Polynomial size in bits: 7, 8, 16 or 32 */
+	uint8_t Reverse;     /*!< Set to 1 for reflected input bytes and output, STM32F0xx and STM32F7xx only */
+} TM_CRC_Context_t;
+
+/**
+ * @brief  Firmware image trailer
+ */
+typedef struct {
+	uint32_t Magic;      /*!< Must be @ref TM_CRC_IMAGE_MAGIC */
+	uint32_t Start;      /*!< Image start address */
+	uint32_t Size;       /*!< Image size in bytes, up to trailer, multiple of 4 */
+	uint32_t Crc;        /*!< CRC-32/MPEG-2 of image */
+} TM_CRC_Image_t;
+
+/**
+ * @brief  Image verification status
+ */
+typedef enum {
+	TM_CRC_ImageStatus_Idle = 0x00, /*!< Verification was not started */
+	TM_CRC_ImageStatus_Busy,        /*!< Verification is in progress */
+	TM_CRC_ImageStatus_Ok,          /*!< Image is valid */
+	TM_CRC_ImageStatus_Mismatch,    /*!< CRC does not match, image is damaged */
+	TM_CRC_ImageStatus_Invalid,     /*!< Trailer is not valid, script was not run after build */
+	TM_CRC_ImageStatus_Error        /*!< DMA transfer error */
+} TM_CRC_ImageStatus_t;
+
+/**
+ * @}
+ */
 
 /**
  * @defgroup TM_CRC_Functions
@@ -124,6 +271,104 @@ uint32_t TM_CRC_Calculate16(uint16_t* arr, uint32_t count, uint8_t reset);
  */
 uint32_t TM_CRC_Calculate32(uint32_t* arr, uint32_t count, uint8_t reset);
 
+/**
+ * @brief  Initializes CRC context
+ * @note   Predefined settings can be used, for example TM_CRC_ContextInit(&ctx, TM_CRC_CRC16_MODBUS)
+ * @param  *Context: Pointer to @ref TM_CRC_Context_t structure
+ * @param  Polynomial: CRC polynomial, without highest bit
+ * @param  Size: Polynomial size in bits: 7, 8, 16 or 32
+ * @param  Init: Initial CRC value
+ * @param  Reverse: Set to 1 for reflected input bytes and output
+ * @retval None
+ */
+void TM_CRC_ContextInit(TM_CRC_Context_t* Context, uint32_t Polynomial, uint8_t Size, uint32_t Init, uint8_t Reverse);
+
+/**
+ * @brief  Resets CRC context value to initial value for new calculation
+ * @param  *Context: Pointer to @ref TM_CRC_Context_t structure
+ * @retval None
+ */
+#define TM_CRC_ContextReset(Context)      ((Context)->Value = (Context)->Init)
+
+/**
+ * @brief  Continues CRC calculation for context with new data
+ * @param  *Context: Pointer to @ref TM_CRC_Context_t structure
+ * @param  *data: Pointer to data
+ * @param  count: Number of bytes
+ * @retval Current CRC value of context
+ */
+uint32_t TM_CRC_ContextUpdate(TM_CRC_Context_t* Context, const uint8_t* data, uint32_t count);
+
+/**
+ * @brief  Loads context settings and value to CRC unit
+ * @note   Useful when CRC unit is fed directly, for example with DMA
+ * @param  *Context: Pointer to @ref TM_CRC_Context_t structure
+ * @retval None
+ */
+void TM_CRC_ContextRestore(TM_CRC_Context_t* Context);
+
+/**
+ * @brief  Saves current CRC unit value to context and sets default CRC unit settings
+ * @param  *Context: Pointer to @ref TM_CRC_Context_t structure
+ * @retval Current CRC value of context
+ */
+uint32_t TM_CRC_ContextSave(TM_CRC_Context_t* Context);
+
+/**
+ * @brief  Starts CRC calculation of 32-bit words with memory to memory DMA
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  *Context: Pointer to @ref TM_CRC_Context_t structure to continue. Set to NULL to continue with current CRC unit value
+ * @param  *arr: Pointer to 32-bit data array. Must stay valid until callback is called
+ * @param  count: Number of words in array
+ * @retval Start status:
+ *            - 0: DMA started
+ *            - > 0: DMA is already in progress or invalid parameters
+ */
+uint8_t TM_CRC_CalculateDMA(TM_CRC_Context_t* Context, const uint32_t* arr, uint32_t count);
+
+/**
+ * @brief  Checks if DMA calculation is in progress
+ * @param  None
+ * @retval 1 when in progress, 0 otherwise
+ */
+uint8_t TM_CRC_DMABusy(void);
+
+/**
+ * @brief  Called when DMA calculation is finished
+ * @note   Called from DMA interrupt
+ * @param  *Context: Pointer to context passed to @ref TM_CRC_CalculateDMA, value is already saved
+ * @param  crc: Calculated CRC value
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_CRC_DMACompleteCallback(TM_CRC_Context_t* Context, uint32_t crc);
+
+/**
+ * @brief  Starts firmware image verification
+ * @note   DMA is used on STM32F4xx and STM32F7xx, @ref TM_CRC_DMACompleteCallback is not called for image verification
+ * @param  *Trailer: Pointer to image trailer in flash
+ * @retval Start status:
+ *            - 0: Verification started or finished, check @ref TM_CRC_ImageGetStatus
+ *            - > 0: DMA is already in progress
+ */
+uint8_t TM_CRC_ImageVerifyStart(const TM_CRC_Image_t* Trailer);
+
+/**
+ * @brief  Gets image verification status
+ * @param  None
+ * @retval Member of @ref TM_CRC_ImageStatus_t enumeration
+ */
+TM_CRC_ImageStatus_t TM_CRC_ImageGetStatus(void);
+
+/**
+ * @brief  Called when image verification is finished
+ * @note   Called from DMA interrupt on STM32F4xx and STM32F7xx
+ * @param  status: Verification result, member of @ref TM_CRC_ImageStatus_t enumeration
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_CRC_ImageCallback(TM_CRC_ImageStatus_t status);
+
 /**
  * @}
  */
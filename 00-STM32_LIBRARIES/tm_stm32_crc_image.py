@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+#
+# Firmware image trailer generator for TM CRC library
+#
+# Copyright (c) 2016 Tilen Majerle
+# License: MIT, see tm_stm32_crc.h
+#
+# Finds TM_CRC_Image_t trailer in binary file and fills image start address, size and CRC-32/MPEG-2,
+# calculated the same way as STM32 CRC unit, with 32-bit little endian words.
+# Image covers everything from start of binary file up to trailer.
+#
+# Usage:
+#   python tm_stm32_crc_image.py app.bin --base 0x08000000
+#
+# When trailer is already filled, it is updated, so script can be run more times on the same file.
+#
+
+import argparse
+import struct
+import sys
+
+# Trailer magic, TM_CRC_IMAGE_MAGIC
+MAGIC = 0x494D4743
+POLYNOMIAL = 0x04C11DB7
+
+def crc32_mpeg2(data):
+    """CRC-32/MPEG-2 of 32-bit words, the same as STM32 CRC unit"""
+    crc = 0xFFFFFFFF
+    for (word,) in struct.iter_unpack("<I", data):
+        crc ^= word
+        for _ in range(32):
+            if crc & 0x80000000:
+                crc = ((crc << 1) ^ POLYNOMIAL) & 0xFFFFFFFF
+            else:
+                crc = (crc << 1) & 0xFFFFFFFF
+    return crc
+
+def find_trailer(image):
+    """Returns offset of last word aligned trailer magic"""
+    magic = struct.pack("<I", MAGIC)
+    pos = len(image)
+    while True:
+        pos = image.rfind(magic, 0, pos)
+        if pos < 0:
+            sys.exit("Trailer not found, add TM_CRC_Image_t trailer to firmware")
+        if pos % 4 == 0 and pos + 16 <= len(image):
+            return pos
+
+def main():
+    parser = argparse.ArgumentParser(description="Firmware image trailer generator for TM CRC library")
+    parser.add_argument("file", help="Binary image file, updated in place")
+    parser.add_argument("--base", default="0x08000000", help="Address of first byte of image in flash")
+    args = parser.parse_args()
+
+    base = int(args.base, 0)
+    with open(args.file, "rb") as f:
+        image = bytearray(f.read())
+
+    # Image is everything before trailer
+    offset = find_trailer(image)
+    crc = crc32_mpeg2(bytes(image[:offset]))
+    image[offset:offset + 16] = struct.pack("<IIII", MAGIC, base, offset, crc)
+
+    with open(args.file, "wb") as f:
+        f.write(image)
+    sys.stdout.write("Image 0x%08X, %d bytes, CRC 0x%08X\n" % (base, offset, crc))
+
+if __name__ == "__main__":
+    main()
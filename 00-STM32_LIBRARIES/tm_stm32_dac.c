@@ -24,11 +24,31 @@
  * |----------------------------------------------------------------------
  */
 #include "tm_stm32_dac.h"
+#include "math.h"
 
 /* DAC HANDLE */
 static DAC_HandleTypeDef DAC_Handle[2];
 static DAC_ChannelConfTypeDef DAC_ChannelConf;
 
+#if !defined(STM32F0xx)
+/* Waveform settings */
+typedef struct {
+	DMA_Stream_TypeDef* Stream;
+	uint32_t Channel;
+	uint16_t* Buffer;
+	uint16_t Count;
+} TM_DAC_INT_Wave_t;
+
+static TM_DAC_INT_Wave_t DAC_Wave[2] = {
+	{DAC1_DMA_STREAM, DAC1_DMA_CHANNEL},
+	{DAC2_DMA_STREAM, DAC2_DMA_CHANNEL}
+};
+
+/* Private functions */
+static uint8_t TM_DAC_INT_Start(TM_DAC_Channel_t DACx, uint16_t* Buffer, uint16_t count, uint32_t Trigger, uint8_t stream);
+static void TM_DAC_INT_StreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+#endif
+
 void TM_DAC_Init(TM_DAC_Channel_t DACx) {
 	uint16_t GPIO_Pin;
 	
@@ -97,3 +117,182 @@ void TM_DAC_SetValue(TM_DAC_Channel_t DACx, uint16_t value) {
 	}
 	
 }
+
+void TM_DAC_GenerateSine(uint16_t* Table, uint16_t count, uint16_t amplitude, uint16_t offset) {
+	uint16_t i;
+	float value;
+	
+	/* Calculate one period */
+	for (i = 0; i < count; i++) {
+		value = (float)offset + (float)amplitude * sinf(2.0f * 3.14159265f * (float)i / (float)count);
+		
+		/* Limit to 12-bit range */
+		if (value < 0) {
+			value = 0;
+		} else if (value > 4095.0f) {
+			value = 4095.0f;
+		}
+		Table[i] = (uint16_t)(value + 0.5f);
+	}
+}
+
+void TM_DAC_GenerateTriangle(uint16_t* Table, uint16_t count, uint16_t min, uint16_t max) {
+	uint16_t i, half = count / 2;
+	uint32_t range = max - min;
+	
+	/* Check parameters */
+	if (half == 0 || max < min) {
+		return;
+	}
+	
+	/* Rising and falling edge */
+	for (i = 0; i < count; i++) {
+		if (i < half) {
+			Table[i] = min + (uint16_t)(range * i / half);
+		} else {
+			Table[i] = max - (uint16_t)(range * (i - half) / (count - half));
+		}
+	}
+}
+
+#if !defined(STM32F0xx)
+uint8_t TM_DAC_StartWaveform(TM_DAC_Channel_t DACx, const uint16_t* Table, uint16_t count, uint32_t Trigger) {
+	/* Start without interrupts */
+	return TM_DAC_INT_Start(DACx, (uint16_t *)Table, count, Trigger, 0);
+}
+
+uint8_t TM_DAC_StartStream(TM_DAC_Channel_t DACx, uint16_t* Buffer, uint16_t count, uint32_t Trigger) {
+	/* Check size */
+	if (count > 0x7FFF) {
+		return 1;
+	}
+	
+	/* Start with half and full transfer interrupts */
+	return TM_DAC_INT_Start(DACx, Buffer, count, Trigger, 1);
+}
+
+void TM_DAC_StopWaveform(TM_DAC_Channel_t DACx) {
+	TM_DAC_INT_Wave_t* Wave = &DAC_Wave[(uint8_t)DACx];
+	
+	/* Check if running */
+	if (Wave->Buffer == NULL) {
+		return;
+	}
+	
+	/* Disable DAC DMA requests */
+	if (DACx == TM_DAC_Channel_1) {
+		DAC->CR &= ~DAC_CR_DMAEN1;
+	} else {
+		DAC->CR &= ~DAC_CR_DMAEN2;
+	}
+	
+	/* Remove callback and deinit DMA stream */
+	TM_DMA_DisableInterrupts(Wave->Stream);
+	TM_DMA_SetStreamCallback(Wave->Stream, NULL, NULL);
+	TM_DMA_DeInit(Wave->Stream);
+	
+	/* Not active */
+	Wave->Buffer = NULL;
+}
+
+__weak void TM_DAC_StreamCallback(TM_DAC_Channel_t DACx, uint16_t* Data, uint16_t count) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_DAC_StreamCallback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static uint8_t TM_DAC_INT_Start(TM_DAC_Channel_t DACx, uint16_t* Buffer, uint16_t count, uint32_t Trigger, uint8_t stream) {
+	TM_DAC_INT_Wave_t* Wave = &DAC_Wave[(uint8_t)DACx];
+	DMA_HandleTypeDef DMA_InitStruct;
+	
+	/* Check parameters */
+	if (Buffer == NULL || count == 0) {
+		return 1;
+	}
+	
+	/* Stop previous waveform */
+	TM_DAC_StopWaveform(DACx);
+	
+	/* Init pin and channel */
+	TM_DAC_Init(DACx);
+	
+	/* Trigger can only be changed when channel is disabled */
+	DAC->CR &= DACx == TM_DAC_Channel_1 ? ~DAC_CR_EN1 : ~DAC_CR_EN2;
+	
+	/* Output new sample on each trigger */
+	DAC_ChannelConf.DAC_Trigger = Trigger;
+	DAC_ChannelConf.DAC_OutputBuffer = DAC_OUTPUTBUFFER_ENABLE;
+	if (HAL_DAC_ConfigChannel(&DAC_Handle[(uint8_t)DACx], &DAC_ChannelConf, DACx == TM_DAC_Channel_1 ? DAC_CHANNEL_1 : DAC_CHANNEL_2) != HAL_OK) {
+		return 2;
+	}
+	
+	/* Enable channel again */
+	DAC->CR |= DACx == TM_DAC_Channel_1 ? DAC_CR_EN1 : DAC_CR_EN2;
+	
+	/* Save settings */
+	Wave->Buffer = Buffer;
+	Wave->Count = count;
+	
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(Wave->Stream, NULL);
+	Wave->Stream->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(Wave->Stream);
+	
+	/* Set DMA options */
+	DMA_InitStruct.Instance = Wave->Stream;
+	DMA_InitStruct.Init.Channel = Wave->Channel;
+	DMA_InitStruct.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	DMA_InitStruct.Init.PeriphInc = DMA_PINC_DISABLE;
+	DMA_InitStruct.Init.MemInc = DMA_MINC_ENABLE;
+	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	DMA_InitStruct.Init.Mode = DMA_CIRCULAR;
+	DMA_InitStruct.Init.Priority = DMA_PRIORITY_HIGH;
+	DMA_InitStruct.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	DMA_InitStruct.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DMA_InitStruct.Init.MemBurst = DMA_MBURST_SINGLE;
+	DMA_InitStruct.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(Wave->Stream, &DMA_InitStruct);
+	
+	/* Interrupts are only needed for refill */
+	if (stream) {
+		TM_DMA_SetStreamCallback(Wave->Stream, TM_DAC_INT_StreamCallback, (void *)Wave);
+		TM_DMA_EnableInterrupts(Wave->Stream);
+	}
+	
+	/* Start circular transfer, both halves for stream */
+	if (DACx == TM_DAC_Channel_1) {
+		TM_DMA_Start(&DMA_InitStruct, (uint32_t) Buffer, (uint32_t) &DAC->DHR12R1, stream ? 2 * count : count);
+		DAC->CR |= DAC_CR_DMAEN1;
+	} else {
+		TM_DMA_Start(&DMA_InitStruct, (uint32_t) Buffer, (uint32_t) &DAC->DHR12R2, stream ? 2 * count : count);
+		DAC->CR |= DAC_CR_DMAEN2;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+static void TM_DAC_INT_StreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	TM_DAC_INT_Wave_t* Wave = (TM_DAC_INT_Wave_t *)Param;
+	TM_DAC_Channel_t DACx = Wave == &DAC_Wave[0] ? TM_DAC_Channel_1 : TM_DAC_Channel_2;
+	
+	/* Check if active */
+	if (Wave->Buffer == NULL) {
+		return;
+	}
+	
+	/* First half was sent */
+	if (flags & DMA_FLAG_HTIF) {
+		TM_DAC_StreamCallback(DACx, Wave->Buffer, Wave->Count);
+	}
+	
+	/* Second half was sent */
+	if (flags & DMA_FLAG_TCIF) {
+		TM_DAC_StreamCallback(DACx, &Wave->Buffer[Wave->Count], Wave->Count);
+	}
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com/2015/10/hal-library-28-digital-to-analog-converter-for-stm32fxxx/
  * @link    DAC library for ST32F0xx, STM32F4xx and STM32F7xx
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   DAC library for STM32F4xx and STM32F7xx
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_DAC_H
-#define TM_DAC_H 100
+#define TM_DAC_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -47,7 +47,7 @@ extern C {
  *
  * This library provides 12-bit digital to analog output, values from 0 to 4095.
  *
- * It is designed without DMA signal generator, only data user pass to @ref TM_DAC_SetValue are set to output.
+ * Values can be set one by one with @ref TM_DAC_SetValue or streamed with DMA signal generator.
  *
  * @note For STM32F4xx and STM32F7xx optimization calls are used to make fast set of channel data.
  *	
@@ -59,12 +59,40 @@ DAC	channel    STM32Fxxx    DESCRIPTION
 DAC1           PA4          Pin for DAC channel 1
 DAC2           PA5          Pin for DAC channel 2
 @endverbatim
+ *
+ * \par DMA waveform generator
+ *
+ * On STM32F4xx and STM32F7xx devices, DAC can output samples from memory table with circular DMA.
+ * Each trigger (for example DAC_TRIGGER_T6_TRGO) outputs next sample, table is repeated until stopped.
+ * Timer must be configured by user to output TRGO on update event at desired sample rate.
+ *
+ * Use @ref TM_DAC_StartWaveform for fixed table, it needs no CPU after start.
+ * Table can be filled with @ref TM_DAC_GenerateSine or @ref TM_DAC_GenerateTriangle functions or with arbitrary data.
+ *
+ * For streamed signals (audio playback for example) use @ref TM_DAC_StartStream.
+ * Buffer is split in 2 halves and @ref TM_DAC_StreamCallback is called when DMA finishes one half,
+ * so user can refill it while DMA outputs the other one.
+ *
+ * Default DMA streams and channels are below. You can change them in defines.h file:
+ *
+\code
+//DAC channel 1 DMA settings
+#define DAC1_DMA_STREAM        DMA1_Stream5
+#define DAC1_DMA_CHANNEL       DMA_CHANNEL_7
+//DAC channel 2 DMA settings
+#define DAC2_DMA_STREAM        DMA1_Stream6
+#define DAC2_DMA_CHANNEL       DMA_CHANNEL_7
+\endcode
  *
  * \par Changelog
  *
 @verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added DMA waveform generator and double buffered streaming
 @endverbatim
  *
  * \par Dependencies
@@ -73,6 +101,7 @@ DAC2           PA5          Pin for DAC channel 2
  - STM32Fxxx HAL
  - defines.h
  - TM GPIO
+ - TM DMA, STM32F4xx and STM32F7xx only
 @endverbatim
  */
 
@@ -82,12 +111,35 @@ DAC2           PA5          Pin for DAC channel 2
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_gpio.h"
+#if !defined(STM32F0xx)
+#include "tm_stm32_dma.h"
+#endif
 
 /* Check if peripheral supported */
 #if !defined(DAC)
 #error "Target device does not support Digital-To-Analog converter!"
 #endif
 
+/**
+ * @defgroup TM_DAC_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* DMA settings for waveform generator */
+#ifndef DAC1_DMA_STREAM
+#define DAC1_DMA_STREAM         DMA1_Stream5
+#define DAC1_DMA_CHANNEL        DMA_CHANNEL_7
+#endif
+#ifndef DAC2_DMA_STREAM
+#define DAC2_DMA_STREAM         DMA1_Stream6
+#define DAC2_DMA_CHANNEL        DMA_CHANNEL_7
+#endif
+
+/**
+ * @}
+ */
+
 /**
  * @defgroup TM_DAC_Typedefs
  * @brief    Library Typedefs
@@ -127,6 +179,70 @@ void TM_DAC_Init(TM_DAC_Channel_t DACx);
  */
 void TM_DAC_SetValue(TM_DAC_Channel_t DACx, uint16_t value);
 
+/**
+ * @brief  Starts repeated output of sample table with circular DMA
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  DACx: DAC Channel you will use. This parameter can be a value of @ref TM_DAC_Channel_t enumeration
+ * @param  *Table: Pointer to table with 12-bit right aligned samples. Must stay valid until waveform is stopped
+ * @param  count: Number of samples in table
+ * @param  Trigger: DAC_TRIGGER_xxx trigger which outputs next sample, for example DAC_TRIGGER_T6_TRGO
+ * @retval Start status:
+ *            - 0: Waveform started
+ *            - > 0: Invalid parameters or HAL error
+ */
+uint8_t TM_DAC_StartWaveform(TM_DAC_Channel_t DACx, const uint16_t* Table, uint16_t count, uint32_t Trigger);
+
+/**
+ * @brief  Starts double buffered streaming with circular DMA
+ * @note   Available on STM32F4xx and STM32F7xx devices
+ * @param  DACx: DAC Channel you will use. This parameter can be a value of @ref TM_DAC_Channel_t enumeration
+ * @param  *Buffer: Pointer to buffer with 12-bit right aligned samples. Its length must be 2 * count
+ * @param  count: Number of samples in one half of buffer
+ * @param  Trigger: DAC_TRIGGER_xxx trigger which outputs next sample, for example DAC_TRIGGER_T6_TRGO
+ * @retval Start status:
+ *            - 0: Streaming started
+ *            - > 0: Invalid parameters or HAL error
+ */
+uint8_t TM_DAC_StartStream(TM_DAC_Channel_t DACx, uint16_t* Buffer, uint16_t count, uint32_t Trigger);
+
+/**
+ * @brief  Stops waveform or streaming output
+ * @param  DACx: DAC Channel you will use. This parameter can be a value of @ref TM_DAC_Channel_t enumeration
+ * @retval None
+ */
+void TM_DAC_StopWaveform(TM_DAC_Channel_t DACx);
+
+/**
+ * @brief  Called when DMA finished output of one half of stream buffer
+ * @note   Called from DMA interrupt, DMA is sending other half of buffer meanwhile
+ * @param  DACx: DAC Channel where stream is running
+ * @param  *Data: Pointer to half of buffer to be refilled
+ * @param  count: Number of samples to refill
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_DAC_StreamCallback(TM_DAC_Channel_t DACx, uint16_t* Data, uint16_t count);
+
+/**
+ * @brief  Fills table with one period of sine wave
+ * @param  *Table: Pointer to table to fill
+ * @param  count: Number of samples in one period
+ * @param  amplitude: Amplitude of sine wave, peak value
+ * @param  offset: Middle value of sine wave, 2048 for middle of 12-bit range
+ * @retval None
+ */
+void TM_DAC_GenerateSine(uint16_t* Table, uint16_t count, uint16_t amplitude, uint16_t offset);
+
+/**
+ * @brief  Fills table with one period of triangle wave
+ * @param  *Table: Pointer to table to fill
+ * @param  count: Number of samples in one period
+ * @param  min: Minimal value of triangle
+ * @param  max: Maximal value of triangle
+ * @retval None
+ */
+void TM_DAC_GenerateTriangle(uint16_t* Table, uint16_t count, uint16_t min, uint16_t max);
+
 /**
  * @}
  */
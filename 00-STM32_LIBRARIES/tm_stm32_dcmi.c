@@ -0,0 +1,428 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_dcmi.h"
+
+/* Sensor SCCB addresses and ID registers */
+#define DCMI_OV7670_ADDRESS        0x42
+#define DCMI_OV2640_ADDRESS        0x60
+#define DCMI_OV_REG_PID            0x0A
+#define DCMI_OV_REG_COM7           0x12
+#define DCMI_OV2640_REG_BANK       0xFF
+
+/* Buffer states */
+#define DCMI_BUFFER_FREE           0x00
+#define DCMI_BUFFER_READY          0x01
+#define DCMI_BUFFER_USER           0x02
+
+/* OV7670 QVGA RGB565 */
+static const TM_DCMI_Reg_t DCMI_OV7670_QVGA[] = {
+	{0x11, 0x01}, /* CLKRC, internal clock is input clock / 2 */
+	{0x12, 0x14}, /* COM7, QVGA, RGB */
+	{0x40, 0xD0}, /* COM15, RGB565, full output range */
+	{0x8C, 0x00}, /* RGB444 disabled */
+	{0x3A, 0x04}, /* TSLB, UYVY order for RGB565 */
+	{0x3D, 0xC0}, /* COM13, gamma and UV saturation auto adjust */
+	{0x0C, 0x00}, /* COM3 */
+	{0x3E, 0x19}, /* COM14, scaled PCLK and DCW enabled, PCLK / 2 */
+	{0x72, 0x11}, /* Down sample by 2 */
+	{0x73, 0xF1}, /* DSP clock / 2 */
+	{0x70, 0x3A}, /* Horizontal scaling */
+	{0x71, 0x35}, /* Vertical scaling */
+	{0xA2, 0x02}, /* Pixel clock delay */
+	{0x17, 0x16}, /* HSTART */
+	{0x18, 0x04}, /* HSTOP */
+	{0x32, 0x24}, /* HREF */
+	{0x19, 0x02}, /* VSTART */
+	{0x1A, 0x7A}, /* VSTOP */
+	{0x03, 0x0A}, /* VREF */
+	{0x4F, 0xB3}, /* Color matrix for RGB */
+	{0x50, 0xB3},
+	{0x51, 0x00},
+	{0x52, 0x3D},
+	{0x53, 0xA7},
+	{0x54, 0xE4},
+	{0x58, 0x9E},
+	{0x13, 0xE7}, /* COM8, AGC, AWB and AEC enabled */
+	{0x15, 0x00}  /* COM10, PCLK runs during blanking, HREF and VSYNC positive */
+};
+
+/* OV2640 QVGA RGB565 */
+static const TM_DCMI_Reg_t DCMI_OV2640_QVGA[] = {
+	/* Sensor bank, SVGA mode */
+	{0xFF, 0x01}, {0x12, 0x40}, {0x03, 0x0A}, {0x32, 0x09}, {0x17, 0x11}, {0x18, 0x43},
+	{0x19, 0x00}, {0x1A, 0x4B}, {0x37, 0xC0}, {0x4F, 0xCA}, {0x50, 0xA8}, {0x5A, 0x23},
+	{0x6D, 0x00}, {0x3D, 0x38}, {0x39, 0x92}, {0x35, 0xDA}, {0x22, 0x1A}, {0x37, 0xC3},
+	{0x23, 0x00}, {0x34, 0xC0}, {0x36, 0x1A}, {0x06, 0x88}, {0x07, 0xC0}, {0x0D, 0x87},
+	{0x0E, 0x41}, {0x4C, 0x00}, {0x11, 0x01}, {0x13, 0xE5}, {0x14, 0x48}, {0x09, 0x02},
+	/* DSP bank, SVGA input size */
+	{0xFF, 0x00}, {0xE0, 0x04}, {0xC0, 0x64}, {0xC1, 0x4B}, {0x8C, 0x00}, {0x86, 0x3D},
+	{0x50, 0x89}, {0x51, 0xC8}, {0x52, 0x96}, {0x53, 0x00}, {0x54, 0x00}, {0x55, 0x00},
+	{0x57, 0x00},
+	/* Output 320x240 */
+	{0x5A, 0x50}, {0x5B, 0x3C}, {0x5C, 0x00}, {0xD3, 0x04}, {0xE0, 0x00},
+	/* RGB565 output */
+	{0xDA, 0x08}, {0xD7, 0x03}, {0xE0, 0x00}, {0x05, 0x00}
+};
+
+/* Private structure */
+typedef struct {
+	uint16_t* Frames[DCMI_FRAME_BUFFERS];  /* Frame buffers */
+	volatile uint8_t State[DCMI_FRAME_BUFFERS]; /* Buffer states */
+	volatile uint8_t Memory[2];            /* Buffer index on DMA memory 0 and 1 */
+	volatile int8_t Ready;                 /* Newest ready buffer or -1 */
+	volatile uint8_t Running;              /* Capture is running */
+	TM_DCMI_Mode_t Mode;                   /* Capture mode */
+	uint8_t Address;                       /* Sensor SCCB address */
+	uint32_t Polarity;                     /* DCMI polarity bits for sensor */
+	TM_DCMI_Stats_t Stats;                 /* Statistics */
+	DMA_HandleTypeDef hdma;                /* DMA handle */
+	uint8_t Initialized;                   /* Library is initialized */
+} TM_DCMI_INT_t;
+
+static TM_DCMI_INT_t DCMI_Camera;
+
+/* Private functions */
+static void TM_DCMI_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint8_t Memory, void* Param);
+static int8_t TM_DCMI_INT_GetFree(void);
+
+TM_DCMI_Result_t TM_DCMI_Init(TM_DCMI_Sensor_t Sensor, void* Frames) {
+	DMA_Stream_TypeDef* Stream;
+	uint8_t pid = 0, i;
+	
+	/* Check memory */
+	if ((uint32_t)Frames & 0x03) {
+		return TM_DCMI_Result_Error;
+	}
+	
+	/* Frame buffers */
+	memset(&DCMI_Camera, 0, sizeof(DCMI_Camera));
+	for (i = 0; i < DCMI_FRAME_BUFFERS; i++) {
+		DCMI_Camera.Frames[i] = (uint16_t *)((uint8_t *)Frames + i * DCMI_FRAME_SIZE);
+	}
+	DCMI_Camera.Ready = -1;
+	
+	/* Init pins */
+	TM_DCMI_InitPinsCallback();
+	
+#if DCMI_USE_MCO
+	/* Sensor clock from HSE on PA8 */
+	HAL_RCC_MCOConfig(RCC_MCO1, RCC_MCO1SOURCE_HSE, RCC_MCODIV_1);
+#endif
+	
+	/* Init SCCB bus */
+	TM_I2C_Init(DCMI_I2C, DCMI_I2C_PINSPACK, DCMI_I2C_CLOCK);
+	
+	/* Sensor settings, DCMI polarity bits are set for blanking level */
+	if (Sensor == TM_DCMI_Sensor_OV7670) {
+		DCMI_Camera.Address = DCMI_OV7670_ADDRESS;
+		DCMI_Camera.Polarity = DCMI_CR_PCKPOL | DCMI_CR_VSPOL;
+	} else {
+		DCMI_Camera.Address = DCMI_OV2640_ADDRESS;
+		DCMI_Camera.Polarity = DCMI_CR_PCKPOL;
+		
+		/* ID register is in sensor bank */
+		if (TM_DCMI_WriteReg(DCMI_OV2640_REG_BANK, 0x01) != TM_DCMI_Result_Ok) {
+			return TM_DCMI_Result_SensorError;
+		}
+	}
+	
+	/* Check sensor ID, 0x76 for OV7670 and 0x26 for OV2640 */
+	if (
+		TM_DCMI_ReadReg(DCMI_OV_REG_PID, &pid) != TM_DCMI_Result_Ok ||
+		pid != (Sensor == TM_DCMI_Sensor_OV7670 ? 0x76 : 0x26)
+	) {
+		return TM_DCMI_Result_SensorError;
+	}
+	
+	/* Reset sensor, registers are ready after 1ms */
+	TM_DCMI_WriteReg(DCMI_OV_REG_COM7, 0x80);
+	HAL_Delay(10);
+	
+	/* Write settings */
+	if (Sensor == TM_DCMI_Sensor_OV7670) {
+		i = TM_DCMI_WriteTable(DCMI_OV7670_QVGA, sizeof(DCMI_OV7670_QVGA) / sizeof(DCMI_OV7670_QVGA[0]));
+	} else {
+		i = TM_DCMI_WriteTable(DCMI_OV2640_QVGA, sizeof(DCMI_OV2640_QVGA) / sizeof(DCMI_OV2640_QVGA[0]));
+	}
+	if (i != TM_DCMI_Result_Ok) {
+		return TM_DCMI_Result_SensorError;
+	}
+	
+	/* Enable DCMI clock, 8-bit data, all frames captured */
+	__HAL_RCC_DCMI_CLK_ENABLE();
+	DCMI->CR = DCMI_Camera.Polarity;
+	
+	/* Allocate DMA stream */
+	DCMI_Camera.hdma.Init.Channel = DCMI_DMA_CHANNEL;
+	if ((Stream = TM_DMA_Allocate(TM_DMA_Request_DCMI, TM_DMA_Priority_High, DCMI_DMA_STREAM, &DCMI_Camera.hdma.Init.Channel)) == NULL) {
+		return TM_DCMI_Result_DMAError;
+	}
+	
+	/* Set DMA settings, 32-bit reads from DCMI, FIFO packs data for memory */
+	DCMI_Camera.hdma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	DCMI_Camera.hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+	DCMI_Camera.hdma.Init.MemInc = DMA_MINC_ENABLE;
+	DCMI_Camera.hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	DCMI_Camera.hdma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	DCMI_Camera.hdma.Init.Mode = DMA_CIRCULAR;
+	DCMI_Camera.hdma.Init.Priority = DMA_PRIORITY_HIGH;
+	DCMI_Camera.hdma.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+	DCMI_Camera.hdma.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DCMI_Camera.hdma.Init.MemBurst = DMA_MBURST_SINGLE;
+	DCMI_Camera.hdma.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	TM_DMA_Init(Stream, &DCMI_Camera.hdma);
+	
+	/* Initialized */
+	DCMI_Camera.Initialized = 1;
+	
+	/* Return OK */
+	return TM_DCMI_Result_Ok;
+}
+
+TM_DCMI_Result_t TM_DCMI_WriteReg(uint8_t Reg, uint8_t Value) {
+	/* SCCB write is normal I2C register write */
+	return TM_I2C_Write(DCMI_I2C, DCMI_Camera.Address, Reg, Value) == TM_I2C_Result_Ok ? TM_DCMI_Result_Ok : TM_DCMI_Result_SensorError;
+}
+
+TM_DCMI_Result_t TM_DCMI_ReadReg(uint8_t Reg, uint8_t* Value) {
+	/* SCCB does not support repeated start, write address and read in separate transactions */
+	if (
+		TM_I2C_WriteNoRegister(DCMI_I2C, DCMI_Camera.Address, Reg) != TM_I2C_Result_Ok ||
+		TM_I2C_ReadNoRegister(DCMI_I2C, DCMI_Camera.Address, Value) != TM_I2C_Result_Ok
+	) {
+		return TM_DCMI_Result_SensorError;
+	}
+	
+	/* Return OK */
+	return TM_DCMI_Result_Ok;
+}
+
+TM_DCMI_Result_t TM_DCMI_WriteTable(const TM_DCMI_Reg_t* Table, uint16_t Count) {
+	/* Write all registers */
+	while (Count--) {
+		if (TM_DCMI_WriteReg(Table->Reg, Table->Value) != TM_DCMI_Result_Ok) {
+			return TM_DCMI_Result_SensorError;
+		}
+		Table++;
+	}
+	
+	/* Return OK */
+	return TM_DCMI_Result_Ok;
+}
+
+TM_DCMI_Result_t TM_DCMI_Start(TM_DCMI_Mode_t Mode) {
+	int8_t m0, m1;
+	uint32_t irq;
+	
+	/* Check state */
+	if (!DCMI_Camera.Initialized || DCMI_Camera.Running) {
+		return TM_DCMI_Result_Error;
+	}
+	
+	/* Get buffers for DMA, snapshot needs only one */
+	irq = TM_NVIC_Lock();
+	DCMI_Camera.Memory[0] = DCMI_Camera.Memory[1] = 0xFF;
+	m0 = TM_DCMI_INT_GetFree();
+	if (m0 >= 0) {
+		DCMI_Camera.Memory[0] = m0;
+	}
+	m1 = Mode == TM_DCMI_Mode_Snapshot ? m0 : TM_DCMI_INT_GetFree();
+	if (m1 >= 0) {
+		DCMI_Camera.Memory[1] = m1;
+	}
+	TM_NVIC_Unlock(irq);
+	
+	/* All buffers are taken by user */
+	if (m0 < 0 || m1 < 0) {
+		return TM_DCMI_Result_Error;
+	}
+	
+	/* Enable DCMI */
+	DCMI_Camera.Mode = Mode;
+	DCMI->ICR = DCMI_ICR_FRAME_ISC | DCMI_ICR_OVF_ISC | DCMI_ICR_ERR_ISC | DCMI_ICR_VSYNC_ISC | DCMI_ICR_LINE_ISC;
+	DCMI->CR = DCMI_Camera.Polarity | (Mode == TM_DCMI_Mode_Snapshot ? DCMI_CR_CM : 0) | DCMI_CR_ENABLE;
+	
+	/* Start DMA, one frame in each memory */
+	if (!TM_DMA_StartDoubleBuffer(&DCMI_Camera.hdma, (uint32_t)&DCMI->DR, (uint32_t)DCMI_Camera.Frames[m0], (uint32_t)DCMI_Camera.Frames[m1], DCMI_FRAME_SIZE / 4, TM_DCMI_INT_DMACallback, NULL)) {
+		DCMI->CR = DCMI_Camera.Polarity;
+		return TM_DCMI_Result_DMAError;
+	}
+	
+	/* Start capture, DCMI waits for next VSYNC */
+	DCMI_Camera.Running = 1;
+	DCMI->CR |= DCMI_CR_CAPTURE;
+	
+	/* Return OK */
+	return TM_DCMI_Result_Ok;
+}
+
+void TM_DCMI_Stop(void) {
+	/* Stop DCMI capture and DMA */
+	DCMI->CR = DCMI_Camera.Polarity;
+	HAL_DMA_Abort(&DCMI_Camera.hdma);
+	DCMI_Camera.Running = 0;
+}
+
+uint8_t TM_DCMI_IsRunning(void) {
+	return DCMI_Camera.Running;
+}
+
+uint16_t* TM_DCMI_GetFrame(void) {
+	uint16_t* frame = NULL;
+	uint32_t irq;
+	
+	/* Take newest ready frame */
+	irq = TM_NVIC_Lock();
+	if (DCMI_Camera.Ready >= 0) {
+		DCMI_Camera.State[DCMI_Camera.Ready] = DCMI_BUFFER_USER;
+		frame = DCMI_Camera.Frames[DCMI_Camera.Ready];
+		DCMI_Camera.Ready = -1;
+	}
+	TM_NVIC_Unlock(irq);
+	
+	/* Return frame */
+	return frame;
+}
+
+void TM_DCMI_ReleaseFrame(uint16_t* Frame) {
+	uint8_t i;
+	
+	/* Find buffer and make it free */
+	for (i = 0; i < DCMI_FRAME_BUFFERS; i++) {
+		if (DCMI_Camera.Frames[i] == Frame) {
+			DCMI_Camera.State[i] = DCMI_BUFFER_FREE;
+			break;
+		}
+	}
+}
+
+void TM_DCMI_GetStats(TM_DCMI_Stats_t* Stats) {
+	uint32_t irq;
+	
+	/* Copy statistics */
+	irq = TM_NVIC_Lock();
+	*Stats = DCMI_Camera.Stats;
+	TM_NVIC_Unlock(irq);
+}
+
+#if DCMI_USE_DMA2D
+uint8_t TM_DCMI_Preview(uint16_t x, uint16_t y) {
+	uint16_t* frame;
+	uint8_t ret;
+	
+	/* Get newest frame */
+	if ((frame = TM_DCMI_GetFrame()) == NULL) {
+		return 0;
+	}
+	
+	/* DMA2D converts RGB565 frame to layer format */
+	ret = TM_DMA2DGRAPHIC_BlendBitmap(x, y, DCMI_WIDTH, DCMI_HEIGHT, frame, CM_RGB565, 255);
+	
+	/* Return frame to DMA */
+	TM_DCMI_ReleaseFrame(frame);
+	
+	/* Return status */
+	return ret;
+}
+#endif
+
+__weak void TM_DCMI_FrameCallback(uint16_t* Frame) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+	         the TM_DCMI_FrameCallback could be implemented in the user file
+	*/
+}
+
+__weak void TM_DCMI_InitPinsCallback(void) {
+	/* Default pins, change them with own function */
+#if defined(STM32F7_DISCOVERY)
+	TM_GPIO_InitAlternate(GPIOA, GPIO_PIN_4 | GPIO_PIN_6, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOD, GPIO_PIN_3, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOE, GPIO_PIN_5 | GPIO_PIN_6, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOG, GPIO_PIN_9, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOH, GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11 | GPIO_PIN_12 | GPIO_PIN_14, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+#else
+	TM_GPIO_InitAlternate(GPIOA, GPIO_PIN_4 | GPIO_PIN_6, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_6 | GPIO_PIN_7, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOC, GPIO_PIN_6 | GPIO_PIN_7 | GPIO_PIN_8 | GPIO_PIN_9, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+	TM_GPIO_InitAlternate(GPIOE, GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High, GPIO_AF13_DCMI);
+#endif
+	
+#if DCMI_USE_MCO
+	/* Sensor clock output */
+	TM_GPIO_InitAlternate(GPIOA, GPIO_PIN_8, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, GPIO_AF0_MCO);
+#endif
+}
+
+/* Private functions */
+static void TM_DCMI_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint8_t Memory, void* Param) {
+	uint8_t b = DCMI_Camera.Memory[Memory];
+	int8_t f;
+	
+	/* Count DCMI errors, frame is still delivered */
+	if (DCMI->RISR & (DCMI_RISR_OVF_RIS | DCMI_RISR_ERR_RIS)) {
+		DCMI->ICR = DCMI_ICR_OVF_ISC | DCMI_ICR_ERR_ISC;
+		DCMI_Camera.Stats.Errors++;
+	}
+	
+	/* Older ready frame was not taken by user */
+	if (DCMI_Camera.Ready >= 0 && DCMI_Camera.Ready != b) {
+		DCMI_Camera.State[DCMI_Camera.Ready] = DCMI_BUFFER_FREE;
+		DCMI_Camera.Stats.Dropped++;
+	}
+	
+	/* Frame is ready */
+	DCMI_Camera.State[b] = DCMI_BUFFER_READY;
+	DCMI_Camera.Ready = b;
+	DCMI_Camera.Stats.Frames++;
+	
+	if (DCMI_Camera.Mode == TM_DCMI_Mode_Snapshot) {
+		/* DCMI stops itself after one frame, stop DMA too */
+		__HAL_DMA_DISABLE(&DCMI_Camera.hdma);
+		DCMI_Camera.Running = 0;
+	} else {
+		/* Next frame on this memory goes to free buffer, when available */
+		if ((f = TM_DCMI_INT_GetFree()) >= 0 && TM_DMA_SetMemoryAddress(DMA_Stream, Memory, (uint32_t)DCMI_Camera.Frames[f])) {
+			DCMI_Camera.Memory[Memory] = f;
+		}
+	}
+	
+	/* Call user function */
+	TM_DCMI_FrameCallback(DCMI_Camera.Frames[b]);
+}
+
+static int8_t TM_DCMI_INT_GetFree(void) {
+	uint8_t i;
+	
+	/* Free buffer not used by DMA */
+	for (i = 0; i < DCMI_FRAME_BUFFERS; i++) {
+		if (DCMI_Camera.State[i] == DCMI_BUFFER_FREE && DCMI_Camera.Memory[0] != i && DCMI_Camera.Memory[1] != i) {
+			return i;
+		}
+	}
+	
+	/* No free buffer */
+	return -1;
+}
@@ -0,0 +1,420 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   DCMI camera capture with DMA double buffering for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_DCMI_H
+#define TM_DCMI_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_DCMI
+ * @brief    DCMI camera capture with DMA double buffering for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Library captures RGB565 frames from OV7670 or OV2640 camera sensor to frame buffers in SDRAM or internal RAM.
+ * Sensor is configured over SCCB bus with @ref TM_I2C library, DCMI data are moved to memory with DMA in double buffer mode,
+ * one DMA memory is one complete frame. CPU is not used during capture at all.
+ *
+ * Frame memory holds DCMI_FRAME_BUFFERS frames one after another, each DCMI_WIDTH * DCMI_HEIGHT * 2 bytes.
+ * DMA writes to 2 of them, finished frame is marked as ready and free buffer is given to DMA for next frame.
+ * User takes ready frame with @ref TM_DCMI_GetFrame and returns it with @ref TM_DCMI_ReleaseFrame.
+ *
+ *  - With 2 buffers, frame is overwritten again after one frame time, process it before that
+ *  - With 3 or more buffers, frame taken by user is never overwritten. When user does not take frames fast enough,
+ *    older ready frame is dropped instead
+ *
+ * \par Capture modes
+ *
+ *  - Snapshot: one frame is captured, then DCMI and DMA stop
+ *  - Continuous: frames are captured until @ref TM_DCMI_Stop is called
+ *
+ * \par Camera preview
+ *
+ * With DCMI_USE_DMA2D enabled, @ref TM_DCMI_Preview draws latest frame to LCD layer with @ref TM_DMA2DGRAPHIC library.
+ * DMA2D converts RGB565 frame to layer pixel format, so preview does not use CPU.
+ *
+ * \par Pinout
+ *
+\verbatim
+DCMI     Default       STM32F7-Discovery
+HSYNC    PA4           PA4
+PIXCLK   PA6           PA6
+VSYNC    PB7           PG9
+D0       PC6           PH9
+D1       PC7           PH10
+D2       PC8           PH11
+D3       PC9           PH12
+D4       PE4           PH14
+D5       PB6           PD3
+D6       PE5           PE5
+D7       PE6           PE6
+XCLK     PA8 (MCO1, only when DCMI_USE_MCO is enabled)
+\endverbatim
+ *
+ * Other pins can be used with @ref TM_DCMI_InitPinsCallback function.
+ * Sensor power down and reset pins are not controlled by library, set them before @ref TM_DCMI_Init is called.
+ *
+ * \par Settings
+ *
+\code
+//Frame size, must match sensor register table
+#define DCMI_WIDTH                 320
+#define DCMI_HEIGHT                240
+
+//Number of frame buffers in frame memory
+#define DCMI_FRAME_BUFFERS         3
+
+//I2C settings for sensor SCCB bus
+#define DCMI_I2C                   I2C1
+#define DCMI_I2C_PINSPACK          TM_I2C_PinsPack_1
+#define DCMI_I2C_CLOCK             100000
+
+//Output sensor clock on PA8 from HSE, for modules without own oscillator
+#define DCMI_USE_MCO               1
+
+//Enable preview function with DMA2D
+#define DCMI_USE_DMA2D             1
+\endcode
+ *
+ * Example:
+ *
+\code
+//Start camera with frame buffers in SDRAM after LCD layers
+TM_DCMI_Init(TM_DCMI_Sensor_OV7670, (void *)0xD0100000);
+TM_DCMI_Start(TM_DCMI_Mode_Continuous);
+
+while (1) {
+	uint16_t* frame;
+	
+	//Process new frame if available
+	if ((frame = TM_DCMI_GetFrame()) != NULL) {
+		Inspect(frame);
+		TM_DCMI_ReleaseFrame(frame);
+	}
+}
+
+//Called from DMA interrupt when frame is captured
+void TM_DCMI_FrameCallback(uint16_t* Frame) {
+	//Signal processing task
+}
+\endcode
+ *
+ * \note  Sensor register tables are for QVGA RGB565 output. Other modes can be set with @ref TM_DCMI_WriteTable
+ *        after @ref TM_DCMI_Init, together with DCMI_WIDTH and DCMI_HEIGHT settings
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM I2C
+ - TM DMA
+ - TM GPIO
+ - TM NVIC
+ - string.h
+ - TM DMA2D GRAPHIC (only when DCMI_USE_DMA2D)
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_i2c.h"
+#include "tm_stm32_dma.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_nvic.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_DCMI_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Frame width in units of pixels */
+#ifndef DCMI_WIDTH
+#define DCMI_WIDTH                 320
+#endif
+
+/* Frame height in units of pixels */
+#ifndef DCMI_HEIGHT
+#define DCMI_HEIGHT                240
+#endif
+
+/* Number of frame buffers in frame memory */
+#ifndef DCMI_FRAME_BUFFERS
+#define DCMI_FRAME_BUFFERS         3
+#endif
+
+/* I2C peripheral for sensor SCCB bus */
+#ifndef DCMI_I2C
+#define DCMI_I2C                   I2C1
+#define DCMI_I2C_PINSPACK          TM_I2C_PinsPack_1
+#endif
+
+/* SCCB clock speed */
+#ifndef DCMI_I2C_CLOCK
+#define DCMI_I2C_CLOCK             100000
+#endif
+
+/* Output sensor clock on MCO1 pin */
+#ifndef DCMI_USE_MCO
+#define DCMI_USE_MCO               0
+#endif
+
+/* Enable preview with DMA2D */
+#ifndef DCMI_USE_DMA2D
+#define DCMI_USE_DMA2D             0
+#endif
+
+/* Preferred DMA stream and channel, other stream is allocated when this one is used */
+#ifndef DCMI_DMA_STREAM
+#define DCMI_DMA_STREAM            DMA2_Stream1
+#define DCMI_DMA_CHANNEL           DMA_CHANNEL_1
+#endif
+
+/* Frame size in units of bytes */
+#define DCMI_FRAME_SIZE            ((uint32_t)DCMI_WIDTH * DCMI_HEIGHT * 2)
+
+/* Check settings */
+#if DCMI_FRAME_BUFFERS < 2
+#error "DCMI_FRAME_BUFFERS must be at least 2!"
+#endif
+#if DCMI_WIDTH * DCMI_HEIGHT / 2 > 0xFFFF
+#error "DCMI frame is too big for one DMA transfer!"
+#endif
+
+#if DCMI_USE_DMA2D
+#include "tm_stm32_dma2d_graphic.h"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_DCMI_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_DCMI_Result_Ok = 0x00,    /*!< Everything OK */
+	TM_DCMI_Result_Error,        /*!< Library is not initialized or capture is running */
+	TM_DCMI_Result_SensorError,  /*!< Sensor does not respond or has wrong ID */
+	TM_DCMI_Result_DMAError      /*!< DMA stream could not be allocated or started */
+} TM_DCMI_Result_t;
+
+/**
+ * @brief  Supported sensors
+ */
+typedef enum {
+	TM_DCMI_Sensor_OV7670 = 0x00, /*!< OmniVision OV7670, SCCB address 0x42 */
+	TM_DCMI_Sensor_OV2640         /*!< OmniVision OV2640, SCCB address 0x60 */
+} TM_DCMI_Sensor_t;
+
+/**
+ * @brief  Capture modes
+ */
+typedef enum {
+	TM_DCMI_Mode_Snapshot = 0x00, /*!< Capture one frame */
+	TM_DCMI_Mode_Continuous       /*!< Capture frames until stopped */
+} TM_DCMI_Mode_t;
+
+/**
+ * @brief  Sensor register value for register tables
+ */
+typedef struct {
+	uint8_t Reg;   /*!< Register address */
+	uint8_t Value; /*!< Register value */
+} TM_DCMI_Reg_t;
+
+/**
+ * @brief  Capture statistics
+ */
+typedef struct {
+	uint32_t Frames;  /*!< Number of captured frames */
+	uint32_t Dropped; /*!< Number of ready frames replaced by newer frame before user took them */
+	uint32_t Errors;  /*!< Number of DCMI overrun and synchronization errors */
+} TM_DCMI_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_DCMI_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes pins, sensor, DCMI and DMA
+ * @param  Sensor: Sensor type. This parameter can be a value of @ref TM_DCMI_Sensor_t enumeration
+ * @param  *Frames: Pointer to frame memory for DCMI_FRAME_BUFFERS frames, 4-byte aligned
+ * @retval Member of @ref TM_DCMI_Result_t
+ */
+TM_DCMI_Result_t TM_DCMI_Init(TM_DCMI_Sensor_t Sensor, void* Frames);
+
+/**
+ * @brief  Writes sensor register
+ * @param  Reg: Register address
+ * @param  Value: Register value
+ * @retval Member of @ref TM_DCMI_Result_t
+ */
+TM_DCMI_Result_t TM_DCMI_WriteReg(uint8_t Reg, uint8_t Value);
+
+/**
+ * @brief  Reads sensor register
+ * @param  Reg: Register address
+ * @param  *Value: Pointer to variable to store register value
+ * @retval Member of @ref TM_DCMI_Result_t
+ */
+TM_DCMI_Result_t TM_DCMI_ReadReg(uint8_t Reg, uint8_t* Value);
+
+/**
+ * @brief  Writes table of registers to sensor
+ * @param  *Table: Pointer to register table
+ * @param  Count: Number of entries in table
+ * @retval Member of @ref TM_DCMI_Result_t
+ */
+TM_DCMI_Result_t TM_DCMI_WriteTable(const TM_DCMI_Reg_t* Table, uint16_t Count);
+
+/**
+ * @brief  Starts capture
+ * @param  Mode: Capture mode. This parameter can be a value of @ref TM_DCMI_Mode_t enumeration
+ * @retval Member of @ref TM_DCMI_Result_t
+ */
+TM_DCMI_Result_t TM_DCMI_Start(TM_DCMI_Mode_t Mode);
+
+/**
+ * @brief  Stops capture, frame in progress is lost
+ * @param  None
+ * @retval None
+ */
+void TM_DCMI_Stop(void);
+
+/**
+ * @brief  Checks if capture is running
+ * @param  None
+ * @retval 1 if capture is running, 0 otherwise
+ */
+uint8_t TM_DCMI_IsRunning(void);
+
+/**
+ * @brief  Takes newest ready frame
+ * @note   Frame must be returned with @ref TM_DCMI_ReleaseFrame when processed
+ * @param  None
+ * @retval Pointer to frame or NULL if there is no new frame since last call
+ */
+uint16_t* TM_DCMI_GetFrame(void);
+
+/**
+ * @brief  Returns frame taken with @ref TM_DCMI_GetFrame, so DMA can use it again
+ * @param  *Frame: Pointer to frame
+ * @retval None
+ */
+void TM_DCMI_ReleaseFrame(uint16_t* Frame);
+
+/**
+ * @brief  Gets capture statistics
+ * @param  *Stats: Pointer to @ref TM_DCMI_Stats_t structure to fill
+ * @retval None
+ */
+void TM_DCMI_GetStats(TM_DCMI_Stats_t* Stats);
+
+#if DCMI_USE_DMA2D || defined(DOXYGEN)
+/**
+ * @brief  Draws newest captured frame to current LCD layer with DMA2D
+ * @note   Frame is drawn only in normal LCD orientation and only when it fits to LCD
+ * @param  x: Left position on LCD
+ * @param  y: Top position on LCD
+ * @retval 1 if frame was drawn, 0 otherwise
+ */
+uint8_t TM_DCMI_Preview(uint16_t x, uint16_t y);
+#endif
+
+/**
+ * @brief  Frame complete callback, called from DMA interrupt
+ * @param  *Frame: Pointer to captured frame, ready for @ref TM_DCMI_GetFrame
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_DCMI_FrameCallback(uint16_t* Frame);
+
+/**
+ * @brief  Initializes DCMI pins when other pins than default are used
+ * @param  None
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_DCMI_InitPinsCallback(void);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,135 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_defer.h"
+
+/* Queued call */
+typedef struct {
+	TM_DEFER_Func_t Func;
+	void* Context;
+	uint32_t Param;
+} TM_DEFER_INT_Call_t;
+
+/* Queue */
+static TM_QUEUE_t DEFER_Queue;
+static uint32_t DEFER_Memory[TM_QUEUE_MEMORY_WORDS(sizeof(TM_DEFER_INT_Call_t), DEFER_QUEUE_SIZE)];
+static volatile uint32_t DEFER_Dropped;
+
+#if DEFER_USE_FREERTOS
+/* Deferred work task */
+static TaskHandle_t DEFER_Task;
+static void TM_DEFER_INT_Task(void* Parameters);
+#endif
+
+uint8_t TM_DEFER_Init(void) {
+	/* Init queue */
+	if (TM_QUEUE_Init(&DEFER_Queue, DEFER_Memory, sizeof(TM_DEFER_INT_Call_t), DEFER_QUEUE_SIZE)) {
+		return 1;
+	}
+	
+#if DEFER_USE_FREERTOS
+	/* Create task */
+	if (xTaskCreate(TM_DEFER_INT_Task, "defer", DEFER_TASK_STACK, NULL, DEFER_TASK_PRIORITY, &DEFER_Task) != pdPASS) {
+		return 1;
+	}
+#else
+	/* PendSV with lowest priority, every other interrupt preempts deferred work */
+	HAL_NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1, 0);
+#endif
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_DEFER_Call(TM_DEFER_Func_t Func, void* Context, uint32_t Param) {
+	TM_DEFER_INT_Call_t call;
+#if DEFER_USE_FREERTOS
+	BaseType_t woken = pdFALSE;
+#endif
+	
+	/* Fill call */
+	call.Func = Func;
+	call.Context = Context;
+	call.Param = Param;
+	
+	/* Put to queue */
+	if (!TM_QUEUE_Put(&DEFER_Queue, &call)) {
+		DEFER_Dropped++;
+		return 0;
+	}
+	
+#if DEFER_USE_FREERTOS
+	/* Wake up task, scheduler may not be started yet */
+	if (DEFER_Task != NULL) {
+		if (__get_IPSR()) {
+			vTaskNotifyGiveFromISR(DEFER_Task, &woken);
+			portYIELD_FROM_ISR(woken);
+		} else {
+			xTaskNotifyGive(DEFER_Task);
+		}
+	}
+#else
+	/* Request PendSV, it runs when all other interrupts are done */
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+#endif
+	
+	/* Call queued */
+	return 1;
+}
+
+uint32_t TM_DEFER_Process(void) {
+	TM_DEFER_INT_Call_t call;
+	uint32_t count = 0;
+	
+	/* Call all functions, also these queued meanwhile */
+	while (TM_QUEUE_Get(&DEFER_Queue, &call)) {
+		call.Func(call.Context, call.Param);
+		count++;
+	}
+	
+	/* Return number of calls */
+	return count;
+}
+
+uint32_t TM_DEFER_GetDropped(void) {
+	return DEFER_Dropped;
+}
+
+#if DEFER_USE_FREERTOS
+static void TM_DEFER_INT_Task(void* Parameters) {
+	while (1) {
+		/* Wait for work */
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		
+		/* Call queued functions */
+		TM_DEFER_Process();
+	}
+}
+#else
+void PendSV_Handler(void) {
+	/* Call queued functions */
+	TM_DEFER_Process();
+}
+#endif
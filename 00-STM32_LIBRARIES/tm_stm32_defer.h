@@ -0,0 +1,228 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Deferred interrupt work for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_DEFER_H
+#define TM_DEFER_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_DEFER
+ * @brief    Deferred interrupt work for STM32Fxxx
+ * @{
+ *
+ * Interrupt handler puts function with context to lock-free @ref TM_QUEUE and returns immediately.
+ * Functions are called later, in order, outside of interrupt which requested them:
+ *
+ *  - Bare metal: from PendSV interrupt with lowest priority, so all other interrupts can preempt deferred work
+ *  - FreeRTOS: from task with priority @ref DEFER_TASK_PRIORITY, enable it with DEFER_USE_FREERTOS in defines.h.
+ *    PendSV is used by FreeRTOS scheduler in this case
+ *
+ * Work can be deferred from any interrupt or from main code, also from deferred function itself.
+ *
+\code
+//Called later, not in interrupt
+static void Packet(void* Context, uint32_t Param) {
+	Parse((uint8_t *)Context, Param);
+}
+
+//Init once
+TM_DEFER_Init();
+
+//In interrupt
+TM_DEFER_Call(Packet, rx_buffer, rx_length);
+\endcode
+ *
+ * \par Deferred driver callbacks
+ *
+ * TM EXTI and TM DMA can defer user callbacks automatically. Interrupt only clears flags and queues callback:
+ *
+\code
+//EXTI line callbacks and TM_EXTI_Handler are called from deferred context
+#define EXTI_DEFER           1
+
+//TM_DMA_TransferCompleteHandler and other user DMA handlers are called from deferred context
+#define DMA_DEFER            1
+\endcode
+ *
+ * @note  Deferred function must not expect hardware state from the moment of interrupt, only data given with context and parameter
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM QUEUE
+ - FreeRTOS (only when DEFER_USE_FREERTOS)
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_queue.h"
+
+/**
+ * @defgroup TM_DEFER_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of queued calls, power of 2 */
+#ifndef DEFER_QUEUE_SIZE
+#define DEFER_QUEUE_SIZE       32
+#endif
+
+#if (DEFER_QUEUE_SIZE & (DEFER_QUEUE_SIZE - 1)) != 0 || DEFER_QUEUE_SIZE < 2
+#error "DEFER_QUEUE_SIZE must be power of 2!"
+#endif
+
+/* Use FreeRTOS task instead of PendSV */
+#ifndef DEFER_USE_FREERTOS
+#define DEFER_USE_FREERTOS     0
+#endif
+
+/* Deferred work task settings */
+#ifndef DEFER_TASK_PRIORITY
+#define DEFER_TASK_PRIORITY    (configMAX_PRIORITIES - 1)
+#endif
+#ifndef DEFER_TASK_STACK
+#define DEFER_TASK_STACK       256
+#endif
+
+#if DEFER_USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_DEFER_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Deferred function
+ * @param  *Context: Context pointer given on @ref TM_DEFER_Call
+ * @param  Param: Parameter given on @ref TM_DEFER_Call
+ * @retval None
+ */
+typedef void (*TM_DEFER_Func_t)(void* Context, uint32_t Param);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_DEFER_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes deferred work queue
+ * @note   PendSV priority is set to lowest or deferred work task is created
+ * @param  None
+ * @retval Status:
+ *            - 0: Initialized
+ *            - > 0: Task could not be created
+ */
+uint8_t TM_DEFER_Init(void);
+
+/**
+ * @brief  Queues function to be called from deferred context
+ * @note   Can be called from any interrupt or task
+ * @param  Func: Function to call
+ * @param  *Context: Context pointer passed to function
+ * @param  Param: Parameter passed to function
+ * @retval Status:
+ *            - 0: Queue is full, call is dropped
+ *            - > 0: Call queued
+ */
+uint8_t TM_DEFER_Call(TM_DEFER_Func_t Func, void* Context, uint32_t Param);
+
+/**
+ * @brief  Calls all queued functions
+ * @note   Called from PendSV or deferred work task, can also be called from main loop
+ * @param  None
+ * @retval Number of functions called
+ */
+uint32_t TM_DEFER_Process(void);
+
+/**
+ * @brief  Gets number of calls dropped because queue was full
+ * @param  None
+ * @retval Number of dropped calls
+ */
+uint32_t TM_DEFER_GetDropped(void);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -17,6 +17,9 @@
  * |----------------------------------------------------------------------
  */
 #include "tm_stm32_delay.h"
+#if DELAY_RTOS
+#include "cmsis_os.h"
+#endif
 
 /* Functions for delay */
 __IO uint32_t TM_Time2 = 0;
@@ -24,16 +27,88 @@ __IO uint32_t TM_Time = 0;
 
 /* Private structure */
 typedef struct {
-	uint8_t Count;
-	TM_DELAY_Timer_t* Timers[DELAY_MAX_CUSTOM_TIMERS];
+	TM_DELAY_Timer_t* Free;                             /* List of free timers in pool */
+	TM_DELAY_Timer_t* Next;                             /* Next timer to be checked in current slot */
+	TM_DELAY_Timer_t* Wheel[DELAY_TIMER_WHEEL_SIZE];    /* Running timers, hashed by expiry time */
+	uint8_t Initialized;
 } TM_DELAY_Timers_t;
 
 /* Custom timers structure */
 static TM_DELAY_Timers_t CustomTimers = {0};
 
+/* Statically allocated timers */
+static TM_DELAY_Timer_t TimersPool[DELAY_MAX_CUSTOM_TIMERS];
+
+#if DELAY_TICKLESS
+/* Tickless mode variables */
+static uint32_t Delay_TicksPerMs = 0;                       /* SysTick clocks for 1ms, 0 when tickless is not running */
+static uint32_t Delay_Period = 1;                           /* Current SysTick period in milliseconds */
+static uint32_t Delay_Offset = 0;                           /* SysTick clocks of current period already elapsed before reload */
+static uint8_t Delay_InTick = 0;                            /* Set when processing timers in SysTick interrupt */
+static uint32_t Delay_Stopped = 0;                          /* Milliseconds of period elapsed before Stop mode */
+
+/* Private functions */
+static void TM_DELAY_INT_Advance(uint32_t millis);
+static uint32_t TM_DELAY_INT_GetNextExpiry(void);
+static uint32_t TM_DELAY_INT_FindSlot(uint32_t max);
+static void TM_DELAY_INT_SetPeriod(uint32_t millis, uint32_t offset);
+static void TM_DELAY_INT_DelayMs(uint32_t millis);
+#endif
+static void TM_DELAY_INT_ProcessSlot(void);
+static void TM_DELAY_INT_Link(TM_DELAY_Timer_t* Timer, uint32_t Millis);
+static void TM_DELAY_INT_Unlink(TM_DELAY_Timer_t* Timer);
+
+#if DELAY_ASYNC
+/* Check interrupt priority for FreeRTOS API */
+#if DELAY_RTOS && DELAY_ASYNC_NVIC_PRIORITY < configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#error "DELAY_ASYNC_NVIC_PRIORITY must be greater or equal to configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY when DELAY_RTOS is used!"
+#endif
+
+/* Pending asynchronous delays, sorted by deadline */
+static TM_DELAY_Async_t* AsyncList = NULL;
+
+/* Private functions */
+static void TM_DELAY_INT_AsyncRemove(TM_DELAY_Async_t* Async);
+static void TM_DELAY_INT_AsyncProgram(void);
+#if DELAY_RTOS
+static void TM_DELAY_INT_AsyncWake(TM_DELAY_Async_t* Async, void* UserParameters);
+#endif
+#endif
+
+#if defined(STM32F0xx)
+/* Software loop calibration, 0 when not calibrated yet */
+static uint32_t Delay_CyclesPerUs = 0;                      /* Core clocks in 1us */
+static uint32_t Delay_LoopsPerCycle = 0;                    /* Loop iterations per core clock, 16.16 fixed point */
+static uint32_t Delay_LoopOverhead = 0;                     /* Core clocks of call, not spent in loop */
+static uint32_t Delay_LoopsPerMs = 0;                       /* Loop iterations in 1ms */
+
+/* Private functions */
+static void TM_DELAY_INT_Loops(__IO uint32_t count);
+static void TM_DELAY_INT_Calibrate(void);
+#if DELAY_US_TIMER
+/* Upper part of microseconds timestamp, incremented on timer overflow */
+static __IO uint32_t Delay_MicrosHigh = 0;
+
+/* Private functions */
+static void TM_DELAY_INT_UsTimerInit(void);
+#endif
+#endif
+
+#if DELAY_ASYNC || (defined(STM32F0xx) && DELAY_US_TIMER)
+static uint32_t TM_DELAY_INT_TimerPrescaler(void);
+#endif
+
 uint32_t TM_DELAY_Init(void) {
 #if !defined(STM32F0xx)
 	uint32_t c;
+#endif
+	
+#if DELAY_TICKLESS
+	/* SysTick is configured by HAL for 1ms */
+	Delay_TicksPerMs = SysTick->LOAD + 1;
+#endif
+	
+#if !defined(STM32F0xx)
 	
     /* Enable TRC */
     CoreDebug->DEMCR &= ~0x01000000;
@@ -56,23 +131,92 @@ uint32_t TM_DELAY_Init(void) {
 	/* Return difference, if result is zero, DWT has not started */
 	return (DWT->CYCCNT - c);
 #else
+	/* Calibrate software loop for current clock */
+	TM_DELAY_INT_Calibrate();
+	
+#if DELAY_US_TIMER
+	/* Start microseconds timer */
+	if (!(DELAY_US_TIM->CR1 & TIM_CR1_CEN)) {
+		TM_DELAY_INT_UsTimerInit();
+	}
+#endif
+	
 	/* Return OK */
 	return 1;
 #endif
 }
 
+void TM_DELAY_UpdateClock(void) {
+#if DELAY_ASYNC || (defined(STM32F0xx) && DELAY_US_TIMER)
+	uint32_t cnt;
+#endif
+	
+#if DELAY_TICKLESS
+	/* SysTick is configured again by HAL for 1ms */
+	if (Delay_TicksPerMs) {
+		Delay_TicksPerMs = SysTick->LOAD + 1;
+	}
+#endif
+	
+#if DELAY_ASYNC
+	/* Timer is running */
+	if (DELAY_ASYNC_TIM->CR1 & TIM_CR1_CEN) {
+		/* New prescaler is loaded on update event, which also clears counter */
+		cnt = DELAY_ASYNC_TIM->CNT;
+		DELAY_ASYNC_TIM->PSC = TM_DELAY_INT_TimerPrescaler();
+		DELAY_ASYNC_TIM->EGR = TIM_EGR_UG;
+		DELAY_ASYNC_TIM->CNT = cnt;
+	}
+#endif
+	
+#if defined(STM32F0xx)
+	/* Calibrate software loop again when it was used */
+	if (Delay_LoopsPerCycle) {
+		TM_DELAY_INT_Calibrate();
+	}
+	
+#if DELAY_US_TIMER
+	/* Timer is running */
+	if (DELAY_US_TIM->CR1 & TIM_CR1_CEN) {
+		/* Update event from prescaler load must not count as overflow */
+		cnt = DELAY_US_TIM->CNT;
+		DELAY_US_TIM->DIER &= ~TIM_DIER_UIE;
+		DELAY_US_TIM->PSC = TM_DELAY_INT_TimerPrescaler();
+		DELAY_US_TIM->EGR = TIM_EGR_UG;
+		DELAY_US_TIM->CNT = cnt;
+		DELAY_US_TIM->SR = ~TIM_SR_UIF;
+		DELAY_US_TIM->DIER |= TIM_DIER_UIE;
+	}
+#endif
+#endif
+}
+
 TM_DELAY_Timer_t* TM_DELAY_TimerCreate(uint32_t ReloadValue, uint8_t AutoReloadCmd, uint8_t StartTimer, void (*TM_DELAY_CustomTimerCallback)(struct _TM_DELAY_Timer_t*, void *), void* UserParameters) {
 	TM_DELAY_Timer_t* tmp;
+	uint32_t irq, i;
 	
-	/* Check if available */
-	if (CustomTimers.Count >= DELAY_MAX_CUSTOM_TIMERS) {
-		return NULL;
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Put all timers to free list on first call */
+	if (!CustomTimers.Initialized) {
+		for (i = 0; i < DELAY_MAX_CUSTOM_TIMERS; i++) {
+			TimersPool[i].Next = CustomTimers.Free;
+			CustomTimers.Free = &TimersPool[i];
+		}
+		CustomTimers.Initialized = 1;
+	}
+	
+	/* Take timer from pool */
+	tmp = CustomTimers.Free;
+	if (tmp != NULL) {
+		CustomTimers.Free = tmp->Next;
 	}
 	
-	/* Try to allocate memory for timer structure */
-	tmp = (TM_DELAY_Timer_t *) LIB_ALLOC_FUNC(sizeof(TM_DELAY_Timer_t));
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
 	
-	/* Check if allocated */
+	/* Check if available */
 	if (tmp == NULL) {
 		return NULL;
 	}
@@ -80,82 +224,108 @@ TM_DELAY_Timer_t* TM_DELAY_TimerCreate(uint32_t ReloadValue, uint8_t AutoReloadC
 	/* Fill settings */
 	tmp->ARR = ReloadValue;
 	tmp->CNT = tmp->ARR;
+	tmp->Flags.FlagsVal = 0;
 	tmp->Flags.F.AREN = AutoReloadCmd;
-	tmp->Flags.F.CNTEN = StartTimer;
+	tmp->Flags.F.USED = 1;
 	tmp->Callback = TM_DELAY_CustomTimerCallback;
 	tmp->UserParameters = UserParameters;
+	tmp->Next = NULL;
+	tmp->Prev = NULL;
 	
-	/* Increase number of timers in memory */
-	CustomTimers.Timers[CustomTimers.Count++] = tmp;
+	/* Start timer */
+	if (StartTimer) {
+		TM_DELAY_TimerStart(tmp);
+	}
 	
 	/* Return pointer to user */
 	return tmp;
 }
 
 void TM_DELAY_TimerDelete(TM_DELAY_Timer_t* Timer) {
-	uint8_t i;
 	uint32_t irq;
-	TM_DELAY_Timer_t* tmp;
-	
-	/* Get location in array of pointers */
-	for (i = 0; i < CustomTimers.Count; i++) {
-		if (Timer == CustomTimers.Timers[i]) {
-			break;
-		}
-	}
 	
 	/* Check for valid input */
-	if (i == CustomTimers.Count) {
+	if (Timer < TimersPool || Timer >= &TimersPool[DELAY_MAX_CUSTOM_TIMERS] || !Timer->Flags.F.USED) {
 		return;
 	}
 	
-	/* Save pointer to timer */
-	tmp = CustomTimers.Timers[i];
-	
-	/* Get interrupt status */
-	irq = __get_PRIMASK();
-
 	/* Disable interrupts */
-	__disable_irq();
+	irq = TM_NVIC_Lock();
 	
-	/* Shift array up */
-	for (; i < (CustomTimers.Count - 1); i++) {
-		/* Shift data to the left */
-		CustomTimers.Timers[i] = CustomTimers.Timers[i + 1];
+	/* Remove from wheel */
+	if (Timer->Flags.F.CNTEN) {
+		TM_DELAY_INT_Unlink(Timer);
 	}
 	
-	/* Decrease count */
-	CustomTimers.Count--;
-	
-	/* Free timer */
-	LIB_FREE_FUNC(tmp);
+	/* Return timer to pool */
+	Timer->Flags.FlagsVal = 0;
+	Timer->Next = CustomTimers.Free;
+	CustomTimers.Free = Timer;
 	
-	/* Enable IRQ if necessary */
-	if (!irq) {
-		__enable_irq();
-	}
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
 }
 
 TM_DELAY_Timer_t* TM_DELAY_TimerStop(TM_DELAY_Timer_t* Timer) {
-	/* Disable timer */
-	Timer->Flags.F.CNTEN = 0;
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	if (Timer->Flags.F.CNTEN) {
+		/* Save remaining time */
+		Timer->CNT = Timer->Expire - HAL_GetTick();
+		if ((int32_t)Timer->CNT < 0) {
+			Timer->CNT = 0;
+		}
+		
+		/* Disable timer */
+		TM_DELAY_INT_Unlink(Timer);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
 	
 	/* Return pointer */
 	return Timer;
 }
 
 TM_DELAY_Timer_t* TM_DELAY_TimerStart(TM_DELAY_Timer_t* Timer) {
-	/* Enable timer */
-	Timer->Flags.F.CNTEN = 1;
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Enable timer with remaining time */
+	if (!Timer->Flags.F.CNTEN) {
+		TM_DELAY_INT_Link(Timer, Timer->CNT);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
 	
 	/* Return pointer */
 	return Timer;
 }
 
 TM_DELAY_Timer_t* TM_DELAY_TimerReset(TM_DELAY_Timer_t* Timer) {
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
 	/* Reset timer */
 	Timer->CNT = Timer->ARR;
 	
+	/* Reschedule running timer */
+	if (Timer->Flags.F.CNTEN) {
+		TM_DELAY_INT_Unlink(Timer);
+		TM_DELAY_INT_Link(Timer, Timer->CNT);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
 	/* Return pointer */
 	return Timer;
 }
@@ -189,7 +359,27 @@ __weak void TM_DELAY_1msHandler(void) {
 
 /* Called from Systick handler */
 void HAL_IncTick(void) {
-	uint8_t i;
+#if DELAY_TICKLESS
+	/* Check if tickless mode is running */
+	if (Delay_TicksPerMs) {
+		/* Process all milliseconds of elapsed period */
+		Delay_InTick = 1;
+		TM_DELAY_INT_Advance(Delay_Period);
+		Delay_InTick = 0;
+		
+#if DELAY_RTOS
+		/* FreeRTOS needs 1ms ticks, period is stretched only in idle */
+		TM_DELAY_INT_SetPeriod(1, SysTick->LOAD - SysTick->VAL);
+#else
+		/* Sleep till next timer expires, count time since this interrupt */
+		TM_DELAY_INT_SetPeriod(TM_DELAY_INT_GetNextExpiry(), SysTick->LOAD - SysTick->VAL);
+#endif
+		
+		/* Call interrupt handler function */
+		TM_DELAY_1msHandler();
+		return;
+	}
+#endif
 	
 	/* Increase system time */
 	TM_Time++;
@@ -199,35 +389,13 @@ void HAL_IncTick(void) {
 		TM_Time2--;
 	}
 	
-	/* Check for timers */
-	/* Check custom timers */
-	for (i = 0; i < CustomTimers.Count; i++) {
-		/* Check if timer is enabled */
-		if (
-			CustomTimers.Timers[i] &&             /*!< Pointer exists */
-			CustomTimers.Timers[i]->Flags.F.CNTEN /*!< Timer is enabled */
-		) {
-			/* Decrease counter if needed */
-			if (CustomTimers.Timers[i]->CNT) {
-				CustomTimers.Timers[i]->CNT--;
-			}
-
-			/* Check if count is zero */
-			if (CustomTimers.Timers[i]->CNT == 0) {
-				/* Call user callback function */
-				CustomTimers.Timers[i]->Callback(CustomTimers.Timers[i], CustomTimers.Timers[i]->UserParameters);
-
-				/* Set new counter value */
-				CustomTimers.Timers[i]->CNT = CustomTimers.Timers[i]->ARR;
-
-				/* Disable timer if auto reload feature is not used */
-				if (!CustomTimers.Timers[i]->Flags.F.AREN) {
-					/* Disable counter */
-					CustomTimers.Timers[i]->Flags.F.CNTEN = 0;
-				}
-			}
-		}
-	}
+	/* Check custom timers expiring now */
+	TM_DELAY_INT_ProcessSlot();
+	
+#if DELAY_RTOS
+	/* Call FreeRTOS tick */
+	osSystickHandler();
+#endif
 	
 	/* Call 1ms interrupt handler function */
 	TM_DELAY_1msHandler();
@@ -242,23 +410,667 @@ void HAL_Delay(uint32_t Delay) {
 		
 		/* Count interrupts */
 		while ((HAL_GetTick() - tickstart) < Delay) {
-#ifdef DELAY_SLEEP
+#if defined(DELAY_SLEEP) && !DELAY_TICKLESS
 			/* Go sleep, wait systick interrupt */
 			__WFI();
 #endif
 		}
 	} else {
 		/* Called from interrupt mode */
+#if DELAY_TICKLESS
+		/* SysTick period is not 1ms */
+		TM_DELAY_INT_DelayMs(Delay);
+#else
 		while (Delay) {
 			/* Check if timer reached zero after we last checked COUNTFLAG bit */
 			if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) {
 				Delay--;
 			}
 		}
+#endif
 	}
 }
 
 uint32_t HAL_GetTick(void) {
+#if DELAY_TICKLESS
+	uint32_t irq, time, elapsed;
+	
+	/* Time is updated only when SysTick interrupt happens */
+	if (Delay_TicksPerMs && !Delay_InTick) {
+		/* Disable interrupts */
+		irq = TM_NVIC_Lock();
+		
+		/* Add part of current period */
+		if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+			elapsed = Delay_Period;
+		} else {
+			elapsed = (SysTick->LOAD - SysTick->VAL + Delay_Offset) / Delay_TicksPerMs;
+		}
+		time = TM_Time + elapsed;
+		
+		/* Enable interrupts back */
+		TM_NVIC_Unlock(irq);
+		
+		return time;
+	}
+#endif
+	
 	/* Return current time in milliseconds */
 	return TM_Time;
 }
+
+#if DELAY_TICKLESS
+/***************************************************/
+/*               Tickless idle functions           */
+/***************************************************/
+
+uint32_t TM_DELAY_GetIdleTime(void) {
+	uint32_t irq, now, next;
+	
+	/* Check if tickless mode is running */
+	if (!Delay_TicksPerMs) {
+		return 0;
+	}
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Time to first timer, counted from last interrupt */
+	next = TM_DELAY_INT_GetNextExpiry();
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		now = next;
+	} else {
+		now = (SysTick->LOAD - SysTick->VAL + Delay_Offset) / Delay_TicksPerMs;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return time from now */
+	return next > now ? (next - now) : 0;
+}
+
+/* Called with disabled interrupts */
+uint32_t TM_DELAY_SuppressTicks(uint32_t Millis) {
+	uint32_t elapsed, now, next;
+	
+	/* Do not sleep when SysTick interrupt is pending */
+	if (!Delay_TicksPerMs || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+		return 0;
+	}
+	
+	/* Time since last interrupt */
+	elapsed = SysTick->LOAD - SysTick->VAL + Delay_Offset;
+	now = elapsed / Delay_TicksPerMs;
+	
+	/* Limit sleep with first software timer */
+	next = TM_DELAY_INT_GetNextExpiry();
+	if (Millis > next) {
+		Millis = next;
+	}
+	if ((now + Millis) > next) {
+		Millis = next - now;
+	}
+	
+	/* Stretch current period, period is never shortened here */
+	if ((now + Millis) > Delay_Period) {
+		TM_DELAY_INT_SetPeriod(now + Millis, elapsed);
+	}
+	
+	/* Return time till next interrupt */
+	return Delay_Period - now;
+}
+
+/* Called with disabled interrupts */
+void TM_DELAY_ResumeTicks(void) {
+#if DELAY_RTOS
+	uint32_t elapsed, now;
+	
+	/* Slept time is processed in pending SysTick interrupt */
+	if (!Delay_TicksPerMs || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+		return;
+	}
+	
+	/* Time since last interrupt */
+	elapsed = SysTick->LOAD - SysTick->VAL + Delay_Offset;
+	now = elapsed / Delay_TicksPerMs;
+	
+	/* Make interrupt at end of current millisecond to give FreeRTOS all slept ticks */
+	if ((now + 1) < Delay_Period) {
+		TM_DELAY_INT_SetPeriod(now + 1, elapsed);
+	}
+#else
+	/* Period is already set to first timer, HAL_GetTick counts part of period */
+#endif
+}
+
+/* Called with disabled interrupts */
+uint32_t TM_DELAY_StopTicks(uint32_t Min) {
+	uint32_t now, next;
+	
+	/* Do not stop when SysTick interrupt is pending */
+	if (!Delay_TicksPerMs || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+		return 0;
+	}
+	
+#if DELAY_ASYNC
+	/* Timer for asynchronous delays does not count in Stop mode */
+	if (AsyncList) {
+		return 0;
+	}
+#endif
+	
+	/* Time since last interrupt */
+	now = (SysTick->LOAD - SysTick->VAL + Delay_Offset) / Delay_TicksPerMs;
+	
+	/* First software timer, not limited with SysTick counter size */
+	next = TM_DELAY_INT_FindSlot(DELAY_TICKLESS_MAX_PERIOD);
+	if (next <= now || (next - now) < Min) {
+		return 0;
+	}
+	
+	/* Stop SysTick, elapsed part of period is processed after wakeup */
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	Delay_Stopped = now;
+	
+	/* Return time from now */
+	return next - now;
+}
+
+/* Called with disabled interrupts */
+void TM_DELAY_StartTicks(uint32_t Millis) {
+	/* SysTick may be set to 1ms by HAL when clock was restored, start new period */
+	Delay_Period = Delay_Stopped + Millis;
+	Delay_Offset = 0;
+	SysTick->LOAD = Delay_TicksPerMs - 1;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	
+	/* Process elapsed period in SysTick interrupt */
+	SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+}
+#endif
+
+#if DELAY_ASYNC
+/***************************************************/
+/*           Asynchronous delay functions          */
+/***************************************************/
+
+void TM_DELAY_AsyncInit(void) {
+	/* Enable timer clock */
+	DELAY_ASYNC_TIM_CLK_ENABLE();
+	
+	/* Free running 32-bit timer at 1MHz, compare channel 1 is used for first deadline */
+	DELAY_ASYNC_TIM->CR1 = 0;
+	DELAY_ASYNC_TIM->DIER = 0;
+	DELAY_ASYNC_TIM->PSC = TM_DELAY_INT_TimerPrescaler();
+	DELAY_ASYNC_TIM->ARR = 0xFFFFFFFF;
+	DELAY_ASYNC_TIM->CCMR1 &= ~0xFF;
+	DELAY_ASYNC_TIM->EGR = TIM_EGR_UG;
+	DELAY_ASYNC_TIM->SR = 0;
+	DELAY_ASYNC_TIM->CR1 = TIM_CR1_CEN;
+	
+	/* Enable interrupt */
+	HAL_NVIC_SetPriority(DELAY_ASYNC_TIM_IRQ, DELAY_ASYNC_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(DELAY_ASYNC_TIM_IRQ);
+}
+
+void TM_DELAY_AsyncStart(TM_DELAY_Async_t* Async, uint32_t Micros, void (*Callback)(struct _TM_DELAY_Async_t*, void *), void* UserParameters) {
+	/* Deadline from now */
+	TM_DELAY_AsyncStartAt(Async, DELAY_ASYNC_TIM->CNT + Micros, Callback, UserParameters);
+}
+
+void TM_DELAY_AsyncStartAt(TM_DELAY_Async_t* Async, uint32_t Deadline, void (*Callback)(struct _TM_DELAY_Async_t*, void *), void* UserParameters) {
+	TM_DELAY_Async_t** tmp;
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Remove if already running */
+	if (Async->Active) {
+		TM_DELAY_INT_AsyncRemove(Async);
+	}
+	
+	/* Fill settings */
+	Async->Deadline = Deadline;
+	Async->Callback = Callback;
+	Async->UserParameters = UserParameters;
+	Async->Active = 1;
+	
+	/* Insert after delays with earlier or equal deadline */
+	tmp = &AsyncList;
+	while (*tmp && (int32_t)((*tmp)->Deadline - Deadline) <= 0) {
+		tmp = &(*tmp)->Next;
+	}
+	Async->Next = *tmp;
+	*tmp = Async;
+	
+	/* New first deadline */
+	if (AsyncList == Async) {
+		TM_DELAY_INT_AsyncProgram();
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+void TM_DELAY_AsyncCancel(TM_DELAY_Async_t* Async) {
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Remove from list, compare channel is updated in next interrupt */
+	if (Async->Active) {
+		TM_DELAY_INT_AsyncRemove(Async);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+#if DELAY_RTOS
+void TM_DELAY_AsyncWait(uint32_t Micros) {
+	TM_DELAY_Async_t async;
+	
+	/* Start delay which wakes this task */
+	async.Active = 0;
+	TM_DELAY_AsyncStart(&async, Micros, TM_DELAY_INT_AsyncWake, xTaskGetCurrentTaskHandle());
+	
+	/* Wait for notification, ignore notifications from other sources */
+	while (async.Active) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+#endif
+
+/* Timer interrupt */
+void DELAY_ASYNC_TIM_IRQ_HANDLER(void) {
+	TM_DELAY_Async_t* tmp;
+	
+	/* Clear compare flag */
+	DELAY_ASYNC_TIM->SR = ~TIM_SR_CC1IF;
+	
+	/* Call all delays which expired, callback may start delay again */
+	while (AsyncList && (int32_t)(AsyncList->Deadline - DELAY_ASYNC_TIM->CNT) <= 0) {
+		tmp = AsyncList;
+		AsyncList = tmp->Next;
+		tmp->Next = NULL;
+		tmp->Active = 0;
+		
+		/* Call user callback function */
+		tmp->Callback(tmp, tmp->UserParameters);
+	}
+	
+	/* Set next deadline */
+	TM_DELAY_INT_AsyncProgram();
+}
+
+/* Called with disabled interrupts */
+static void TM_DELAY_INT_AsyncRemove(TM_DELAY_Async_t* Async) {
+	TM_DELAY_Async_t** tmp;
+	
+	/* Find and remove from list */
+	for (tmp = &AsyncList; *tmp; tmp = &(*tmp)->Next) {
+		if (*tmp == Async) {
+			*tmp = Async->Next;
+			break;
+		}
+	}
+	Async->Next = NULL;
+	Async->Active = 0;
+}
+
+/* Called with disabled interrupts or from timer interrupt */
+static void TM_DELAY_INT_AsyncProgram(void) {
+	/* Disable compare interrupt when nothing is pending */
+	if (AsyncList == NULL) {
+		DELAY_ASYNC_TIM->DIER &= ~TIM_DIER_CC1IE;
+		return;
+	}
+	
+	/* Compare with first deadline */
+	DELAY_ASYNC_TIM->CCR1 = AsyncList->Deadline;
+	DELAY_ASYNC_TIM->DIER |= TIM_DIER_CC1IE;
+	
+	/* Deadline may pass before compare was set, generate event by software */
+	if ((int32_t)(AsyncList->Deadline - DELAY_ASYNC_TIM->CNT) <= 0) {
+		DELAY_ASYNC_TIM->EGR = TIM_EGR_CC1G;
+	}
+}
+
+#if DELAY_RTOS
+static void TM_DELAY_INT_AsyncWake(TM_DELAY_Async_t* Async, void* UserParameters) {
+	BaseType_t woken = pdFALSE;
+	
+	/* Wake waiting task */
+	vTaskNotifyGiveFromISR((TaskHandle_t)UserParameters, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+#endif
+#endif
+
+#if DELAY_ASYNC || (defined(STM32F0xx) && DELAY_US_TIMER)
+/* Gets timer prescaler for 1MHz from current clocks */
+static uint32_t TM_DELAY_INT_TimerPrescaler(void) {
+	uint32_t clock;
+	
+	/* APB1 timer clock is twice PCLK1 when APB1 prescaler is not 1 */
+	clock = HAL_RCC_GetPCLK1Freq();
+#if defined(STM32F0xx)
+	if ((RCC->CFGR & RCC_CFGR_PPRE) != RCC_CFGR_PPRE_DIV1) {
+#else
+	if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+#endif
+		clock *= 2;
+	}
+	
+	/* Prescaler for 1MHz */
+	return clock / 1000000 - 1;
+}
+#endif
+
+#if defined(STM32F0xx)
+/***************************************************/
+/*         STM32F0xx microseconds functions        */
+/***************************************************/
+
+void TM_DELAY_SoftDelay(uint32_t micros) {
+	uint32_t cycles;
+	
+	/* Calibrate on first use, also before TM_DELAY_Init */
+	if (!Delay_LoopsPerCycle) {
+		TM_DELAY_INT_Calibrate();
+	}
+	
+	/* Long delays in parts of 1ms to keep calculation in 32 bits */
+	while (micros > 1000) {
+		TM_DELAY_INT_Loops(Delay_LoopsPerMs);
+		micros -= 1000;
+	}
+	
+	/* Remove time of call and calculation */
+	cycles = micros * Delay_CyclesPerUs;
+	if (cycles > Delay_LoopOverhead) {
+		TM_DELAY_INT_Loops(((cycles - Delay_LoopOverhead) * Delay_LoopsPerCycle) >> 16);
+	}
+}
+
+/* Loop for software delay, volatile counter keeps the same timing with all optimizations */
+static void TM_DELAY_INT_Loops(__IO uint32_t count) {
+	while (count--);
+}
+
+/* Measures software loop with SysTick */
+static void TM_DELAY_INT_Calibrate(void) {
+	uint32_t irq, reload, div, t1, t2, start;
+	
+	/* Core clocks in 1us */
+	Delay_CyclesPerUs = SystemCoreClock / 1000000;
+	if (!Delay_CyclesPerUs) {
+		Delay_CyclesPerUs = 1;
+	}
+	
+	/* Estimate 4 clocks per loop when SysTick is not running */
+	if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) || SysTick->LOAD < 0xFFF) {
+		Delay_LoopsPerCycle = 0x10000 / 4;
+		Delay_LoopOverhead = 0;
+	} else {
+		/* SysTick runs from core clock or core clock / 8 */
+		reload = SysTick->LOAD + 1;
+		div = (SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) ? 1 : 8;
+		
+		/* Disable interrupts */
+		irq = TM_NVIC_Lock();
+		
+		/* Time of call with 16 and with 272 loops, SysTick counts down */
+		start = SysTick->VAL;
+		TM_DELAY_INT_Loops(16);
+		t1 = SysTick->VAL;
+		TM_DELAY_INT_Loops(272);
+		t2 = SysTick->VAL;
+		
+		/* Enable interrupts back */
+		TM_NVIC_Unlock(irq);
+		
+		/* Elapsed clocks, both calls are shorter than SysTick period */
+		t2 = ((t1 + reload - t2) % reload) * div;
+		t1 = ((start + reload - t1) % reload) * div;
+		
+		/* 256 loops difference, overhead is rest of first call */
+		if (t2 <= t1) {
+			t2 = t1 + 1;
+		}
+		Delay_LoopsPerCycle = (256 * 0x10000) / (t2 - t1);
+		Delay_LoopOverhead = t1 - (((t2 - t1) * 16) >> 8);
+		if ((int32_t)Delay_LoopOverhead < 0) {
+			Delay_LoopOverhead = 0;
+		}
+	}
+	
+	/* Iterations for 1ms */
+	Delay_LoopsPerMs = (Delay_CyclesPerUs * 1000 * Delay_LoopsPerCycle) >> 16;
+}
+
+#if DELAY_US_TIMER
+uint32_t TM_DELAY_Micros(void) {
+	uint32_t irq, high, cnt;
+	
+	/* Disable interrupts, overflow can happen while reading */
+	irq = TM_NVIC_Lock();
+	
+	/* Read both parts, count overflow not handled by interrupt yet */
+	high = Delay_MicrosHigh;
+	cnt = DELAY_US_TIM->CNT;
+	if (DELAY_US_TIM->SR & TIM_SR_UIF) {
+		cnt = DELAY_US_TIM->CNT;
+		high += 0x10000;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return time */
+	return high | cnt;
+}
+
+static void TM_DELAY_INT_UsTimerInit(void) {
+	/* Enable timer clock */
+	DELAY_US_TIM_CLK_ENABLE();
+	
+	/* Free running 16-bit timer at 1MHz */
+	DELAY_US_TIM->CR1 = 0;
+	DELAY_US_TIM->PSC = TM_DELAY_INT_TimerPrescaler();
+	DELAY_US_TIM->ARR = 0xFFFF;
+	DELAY_US_TIM->EGR = TIM_EGR_UG;
+	DELAY_US_TIM->SR = 0;
+	DELAY_US_TIM->DIER = TIM_DIER_UIE;
+	Delay_MicrosHigh = 0;
+	DELAY_US_TIM->CR1 = TIM_CR1_CEN;
+	
+	/* Enable overflow interrupt */
+	HAL_NVIC_SetPriority(DELAY_US_TIM_IRQ, DELAY_US_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(DELAY_US_TIM_IRQ);
+}
+
+void DELAY_US_TIM_IRQ_HANDLER(void) {
+	/* Count overflow */
+	if (DELAY_US_TIM->SR & TIM_SR_UIF) {
+		DELAY_US_TIM->SR = ~TIM_SR_UIF;
+		Delay_MicrosHigh += 0x10000;
+	}
+}
+#endif
+#endif
+
+/***************************************************/
+/*               Timer wheel functions             */
+/***************************************************/
+
+/* Called with disabled interrupts or from SysTick */
+static void TM_DELAY_INT_ProcessSlot(void) {
+	TM_DELAY_Timer_t* tmp;
+	
+	/* Only timers in this slot can expire now */
+	tmp = CustomTimers.Wheel[TM_Time & (DELAY_TIMER_WHEEL_SIZE - 1)];
+	while (tmp) {
+		/* Save next timer, updated if removed in callback */
+		CustomTimers.Next = tmp->Next;
+		
+		/* Check if timer expires in this round of wheel */
+		if (tmp->Expire == TM_Time) {
+			/* Remove from wheel */
+			TM_DELAY_INT_Unlink(tmp);
+			
+			/* Set new counter value */
+			tmp->CNT = tmp->ARR;
+			
+			/* Start again if auto reload feature is used */
+			if (tmp->Flags.F.AREN) {
+				TM_DELAY_INT_Link(tmp, tmp->ARR);
+			}
+			
+			/* Call user callback function */
+			tmp->Callback(tmp, tmp->UserParameters);
+		}
+		
+		/* Go to next timer */
+		tmp = CustomTimers.Next;
+	}
+	CustomTimers.Next = NULL;
+}
+
+/* Called with disabled interrupts */
+static void TM_DELAY_INT_Link(TM_DELAY_Timer_t* Timer, uint32_t Millis) {
+	TM_DELAY_Timer_t** slot;
+	uint32_t now = TM_Time;
+	
+	/* Timer expires in next tick at least */
+	if (Millis == 0) {
+		Millis = 1;
+	}
+	
+#if DELAY_TICKLESS
+	/* Shorten current period if timer expires before, period is set again in SysTick interrupt */
+	if (Delay_TicksPerMs && !Delay_InTick && !(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+		uint32_t elapsed = SysTick->LOAD - SysTick->VAL + Delay_Offset;
+		
+		/* Time since last interrupt */
+		now = TM_Time + elapsed / Delay_TicksPerMs;
+		if ((now - TM_Time + Millis) < Delay_Period) {
+			TM_DELAY_INT_SetPeriod(now - TM_Time + Millis, elapsed);
+		}
+	}
+#endif
+	
+	/* Calculate expiry time */
+	Timer->Expire = now + Millis;
+	Timer->Flags.F.CNTEN = 1;
+	
+	/* Add to beginning of slot list */
+	slot = &CustomTimers.Wheel[Timer->Expire & (DELAY_TIMER_WHEEL_SIZE - 1)];
+	Timer->Prev = NULL;
+	Timer->Next = *slot;
+	if (*slot) {
+		(*slot)->Prev = Timer;
+	}
+	*slot = Timer;
+}
+
+/* Called with disabled interrupts */
+static void TM_DELAY_INT_Unlink(TM_DELAY_Timer_t* Timer) {
+	/* Keep slot processing valid */
+	if (CustomTimers.Next == Timer) {
+		CustomTimers.Next = Timer->Next;
+	}
+	
+	/* Remove from slot list */
+	if (Timer->Prev) {
+		Timer->Prev->Next = Timer->Next;
+	} else {
+		CustomTimers.Wheel[Timer->Expire & (DELAY_TIMER_WHEEL_SIZE - 1)] = Timer->Next;
+	}
+	if (Timer->Next) {
+		Timer->Next->Prev = Timer->Prev;
+	}
+	Timer->Next = NULL;
+	Timer->Prev = NULL;
+	
+	/* Disable timer */
+	Timer->Flags.F.CNTEN = 0;
+}
+
+#if DELAY_TICKLESS
+/* Called from SysTick */
+static void TM_DELAY_INT_Advance(uint32_t millis) {
+	/* Decrease other system time */
+	if (TM_Time2 > millis) {
+		TM_Time2 -= millis;
+	} else {
+		TM_Time2 = 0;
+	}
+	
+	/* Process each millisecond */
+	while (millis--) {
+		TM_Time++;
+		TM_DELAY_INT_ProcessSlot();
+#if DELAY_RTOS
+		osSystickHandler();
+#endif
+	}
+}
+
+/* Gets number of milliseconds to first non-empty slot */
+static uint32_t TM_DELAY_INT_GetNextExpiry(void) {
+	uint32_t max;
+	
+	/* Maximal period SysTick can count */
+	max = (SysTick_LOAD_RELOAD_Msk + 1) / Delay_TicksPerMs;
+	if (max > DELAY_TICKLESS_MAX_PERIOD) {
+		max = DELAY_TICKLESS_MAX_PERIOD;
+	}
+	
+	/* Find first slot with timers */
+	return TM_DELAY_INT_FindSlot(max);
+}
+
+/* Gets number of milliseconds to first non-empty slot, limited to max */
+static uint32_t TM_DELAY_INT_FindSlot(uint32_t max) {
+	uint32_t i;
+	
+	/* Find first slot with timers, timers there may expire in later round */
+	for (i = 1; i < max && i <= DELAY_TIMER_WHEEL_SIZE; i++) {
+		if (CustomTimers.Wheel[(TM_Time + i) & (DELAY_TIMER_WHEEL_SIZE - 1)]) {
+			return i;
+		}
+	}
+	
+	return max;
+}
+
+/* Sets SysTick period since last interrupt, offset is number of SysTick clocks already elapsed in period */
+static void TM_DELAY_INT_SetPeriod(uint32_t millis, uint32_t offset) {
+	uint32_t reload = millis * Delay_TicksPerMs - 1;
+	
+	/* Remove elapsed part */
+	if (reload > offset) {
+		reload -= offset;
+	} else {
+		reload = 1;
+	}
+	
+	/* Restart SysTick with new period */
+	Delay_Period = millis;
+	Delay_Offset = offset;
+	SysTick->LOAD = reload;
+	SysTick->VAL = 0;
+}
+
+/* Delay in interrupt mode when SysTick period is not 1ms */
+static void TM_DELAY_INT_DelayMs(uint32_t millis) {
+	while (millis--) {
+		Delay(1000);
+	}
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-3-delay-for-stm32fxxx/
- * @version v1.0
+ * @version v1.7
  * @ide     Keil uVision
  * @license MIT
  * @brief   Library template 
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_DELAY_H
-#define TM_DELAY_H 100
+#define TM_DELAY_H 170
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -62,7 +62,10 @@ extern "C" {
  * \par Microseconds delay
  * 
  * Microseconds delay range is done using DWT cycle counter to get maximum possible accuracy in 1us delay range.
- * This delay is not supported on STM32F0xx series, because Cortex-M0 does not have DWT section built-in.
+ *
+ * Cortex-M0 on STM32F0xx does not have DWT. There, free running 1MHz timer, TIM14 by default, is used after @ref TM_DELAY_Init.
+ * Timer also gives 32-bit microseconds timestamp with @ref TM_DELAY_Micros.
+ * Before init or with DELAY_US_TIMER set to 0, software loop is used, calibrated against SysTick on first use.
  *
  * \par Software timers
  *
@@ -74,11 +77,116 @@ extern "C" {
  * user can do its work which should be done periodically, or only once if needed. 
  * Check @ref TM_DELAY_Timer_Functions group with all functions which can be used for timers.
  *
+ * Timers are taken from static pool of @ref DELAY_MAX_CUSTOM_TIMERS timers, no dynamic memory is used.
+ * Running timers are stored in timing wheel with @ref DELAY_TIMER_WHEEL_SIZE slots, hashed by expiry time.
+ * Each millisecond only timers in one slot are checked, so start, stop and interrupt time do not grow with number of timers
+ * as long as number of running timers is not much bigger than number of slots.
+ *
+\code
+//Number of timers in pool
+#define DELAY_MAX_CUSTOM_TIMERS     200
+//Number of wheel slots, must be power of 2
+#define DELAY_TIMER_WHEEL_SIZE      256
+\endcode
+ *
+ * \par Tickless mode
+ *
+ * In tickless mode, SysTick interrupt is not made each 1ms, but only when next timer in wheel expires.
+ * This allows core to sleep longer in low power applications. Time is still counted in milliseconds.
+ *
+ * @note   In tickless mode, @ref TM_DELAY_1msHandler is called on each SysTick interrupt and not every 1ms
+ * @note   @ref TM_DELAY_Init must be called after system clock is set when tickless mode is used
+ *
+\code
+//Enable tickless mode
+#define DELAY_TICKLESS              1
+//Maximal time between 2 SysTick interrupts in milliseconds
+#define DELAY_TICKLESS_MAX_PERIOD   1000
+\endcode
+ *
+ * \par Stop mode
+ *
+ * SysTick does not count in Stop mode, so other wakeup timer must be used, like @ref TM_POWER library does with RTC.
+ * @ref TM_DELAY_StopTicks returns time till first software timer and stops SysTick,
+ * @ref TM_DELAY_StartTicks adds time spent in Stop mode after system clock is restored.
+ * Asynchronous delays timer does not count in Stop mode too, so Stop mode is not allowed while any delay is pending.
+ *
+ * \par Tickless idle with FreeRTOS
+ *
+ * When @ref DELAY_RTOS is enabled, FreeRTOS tick handler is called from SysTick for each elapsed millisecond,
+ * so SysTick_Handler only calls HAL_IncTick() and FreeRTOS uses the same time base as software timers.
+ * In tickless mode SysTick then runs with 1ms period and is stretched only when idle code calls
+ * @ref TM_DELAY_SuppressTicks before it goes to sleep and @ref TM_DELAY_ResumeTicks after wakeup.
+ * Sleep is limited with first running software timer, @ref TM_BUTTON port scanning timer included.
+ * Core stays in sleep mode, where SysTick is clocked, so SysTick itself is used as wakeup timer.
+ *
+ * @note   FreeRTOS tick rate must be 1000Hz when @ref DELAY_RTOS is used
+ *
+\code
+//Enable tickless mode and call FreeRTOS tick from TM DELAY library
+#define DELAY_TICKLESS              1
+#define DELAY_RTOS                  1
+\endcode
+ *
+ * \par Asynchronous microseconds delays
+ *
+ * @ref Delay waits for microseconds in loop. With @ref DELAY_ASYNC enabled, 32-bit timer counts free running in microseconds
+ * and user callback is called from timer interrupt when deadline is reached, so protocol drivers can be written as state machines.
+ * All pending deadlines are kept in list sorted by deadline and first one is set to compare channel 1.
+ * Delay structures are owned by user, no memory is allocated.
+ *
+ * With @ref DELAY_RTOS, @ref TM_DELAY_AsyncWait blocks calling task until deadline instead of callback.
+ *
+\code
+//Enable async delays on TIM5
+#define DELAY_ASYNC                 1
+#define DELAY_ASYNC_TIM             TIM5
+#define DELAY_ASYNC_TIM_CLK_ENABLE  __HAL_RCC_TIM5_CLK_ENABLE
+#define DELAY_ASYNC_TIM_IRQ         TIM5_IRQn
+#define DELAY_ASYNC_TIM_IRQ_HANDLER TIM5_IRQHandler
+
+//Start conversion and read sensor after 750us
+TM_DELAY_AsyncStart(&Sensor.Delay, 750, ReadSensor, &Sensor);
+\endcode
+ *
+ * @note   Deadlines must be less than 2^31 microseconds in the future
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Software timers are statically allocated and stored in hashed timing wheel
+  - Added tickless mode, SysTick interrupt is made only when next timer expires
+  
+ Version 1.2
+  - October 14, 2026
+  - Added FreeRTOS tick from SysTick and tickless idle functions to suppress and resume ticks around sleep
+  
+ Version 1.3
+  - October 14, 2026
+  - Added asynchronous microseconds delays with callback or task wakeup on 32-bit timer
+  
+ Version 1.4
+  - October 14, 2026
+  - Added @ref TM_DELAY_UpdateClock() function for runtime clock changes
+  
+ Version 1.5
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+  - Default NVIC priority is taken from TM NVIC priority plan
+  
+ Version 1.6
+  - October 14, 2026
+  - STM32F0xx microseconds delay runs from free running timer, added TM_DELAY_Micros timestamp
+  - Software loop for microseconds delay is calibrated against SysTick
+  
+ Version 1.7
+  - October 14, 2026
+  - Added @ref TM_DELAY_StopTicks() and @ref TM_DELAY_StartTicks() functions for Stop mode
 \endverbatim
  *
  * \par Dependencies
@@ -107,6 +215,99 @@ extern "C" {
 #define DELAY_MAX_CUSTOM_TIMERS   5
 #endif
 
+/**
+ * @brief  Number of slots in timers wheel
+ * @note   Must be power of 2
+ */
+#ifndef DELAY_TIMER_WHEEL_SIZE
+#define DELAY_TIMER_WHEEL_SIZE    16
+#endif
+
+#if (DELAY_TIMER_WHEEL_SIZE & (DELAY_TIMER_WHEEL_SIZE - 1)) != 0
+#error "DELAY_TIMER_WHEEL_SIZE must be power of 2!"
+#endif
+
+/**
+ * @brief  Tickless mode, disabled by default
+ */
+#ifndef DELAY_TICKLESS
+#define DELAY_TICKLESS            0
+#endif
+
+/**
+ * @brief  Maximal time between 2 SysTick interrupts in tickless mode in milliseconds
+ */
+#ifndef DELAY_TICKLESS_MAX_PERIOD
+#define DELAY_TICKLESS_MAX_PERIOD 1000
+#endif
+
+/**
+ * @brief  Call FreeRTOS tick handler from SysTick interrupt, disabled by default
+ */
+#ifndef DELAY_RTOS
+#define DELAY_RTOS                0
+#endif
+
+/**
+ * @brief  Asynchronous microseconds delays on 32-bit timer, disabled by default
+ */
+#ifndef DELAY_ASYNC
+#define DELAY_ASYNC               0
+#endif
+
+#if DELAY_ASYNC || defined(DOXYGEN)
+/**
+ * @brief  32-bit timer for asynchronous delays, TIM2 or TIM5 on STM32F4/7xx, TIM2 on STM32F0xx
+ */
+#ifndef DELAY_ASYNC_TIM
+#define DELAY_ASYNC_TIM               TIM2
+#define DELAY_ASYNC_TIM_CLK_ENABLE    __HAL_RCC_TIM2_CLK_ENABLE
+#define DELAY_ASYNC_TIM_IRQ           TIM2_IRQn
+#define DELAY_ASYNC_TIM_IRQ_HANDLER   TIM2_IRQHandler
+#endif
+
+/**
+ * @brief  Timer interrupt preemption priority
+ * @note   With @ref DELAY_RTOS it must not be lower than configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+ */
+#ifndef DELAY_ASYNC_NVIC_PRIORITY
+#define DELAY_ASYNC_NVIC_PRIORITY     NVIC_PRIORITY_NORMAL
+#endif
+#endif
+
+#if defined(STM32F0xx) || defined(DOXYGEN)
+/**
+ * @brief  Free running 1MHz timer for microseconds delay on STM32F0xx, enabled by default
+ */
+#ifndef DELAY_US_TIMER
+#define DELAY_US_TIMER                1
+#endif
+
+#if DELAY_US_TIMER || defined(DOXYGEN)
+/**
+ * @brief  16-bit timer for microseconds delay, TIM14 is available on all STM32F0xx devices
+ */
+#ifndef DELAY_US_TIM
+#define DELAY_US_TIM                  TIM14
+#define DELAY_US_TIM_CLK_ENABLE       __HAL_RCC_TIM14_CLK_ENABLE
+#define DELAY_US_TIM_IRQ              TIM14_IRQn
+#define DELAY_US_TIM_IRQ_HANDLER      TIM14_IRQHandler
+#endif
+
+/**
+ * @brief  Timer overflow interrupt preemption priority, overflow extends timestamp to 32 bits
+ */
+#ifndef DELAY_US_NVIC_PRIORITY
+#define DELAY_US_NVIC_PRIORITY        NVIC_PRIORITY_LOW
+#endif
+#endif
+#endif
+
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
 /* Memory allocation function */
 #ifndef LIB_ALLOC_FUNC
 #define LIB_ALLOC_FUNC    malloc
@@ -135,15 +336,30 @@ typedef struct _TM_DELAY_Timer_t {
 		struct {			
 			uint8_t AREN:1;  /*!< Auto-reload enabled */
 			uint8_t CNTEN:1; /*!< Count enabled */
+			uint8_t USED:1;  /*!< Timer is allocated from pool */
 		} F;
 		uint8_t FlagsVal;
 	} Flags;
 	uint32_t ARR;                                        /*!< Auto reload value */
-	uint32_t CNT;                                        /*!< Counter value, counter counts down */
+	uint32_t CNT;                                        /*!< Remaining time when timer is stopped */
 	void (*Callback)(struct _TM_DELAY_Timer_t*, void *); /*!< Callback which will be called when timer reaches zero */
 	void* UserParameters;                                /*!< Pointer to user parameters used for callback function */
+	uint32_t Expire;                                     /*!< Time when running timer expires. This is private member */
+	struct _TM_DELAY_Timer_t* Next;                      /*!< Next timer in wheel slot or pool. This is private member */
+	struct _TM_DELAY_Timer_t* Prev;                      /*!< Previous timer in wheel slot. This is private member */
 } TM_DELAY_Timer_t;
 
+/**
+ * @brief  Asynchronous delay structure
+ */
+typedef struct _TM_DELAY_Async_t {
+	uint32_t Deadline;                                   /*!< Timer value in microseconds when callback is called */
+	void (*Callback)(struct _TM_DELAY_Async_t*, void *); /*!< Callback called from timer interrupt at deadline */
+	void* UserParameters;                                /*!< Pointer to user parameters used for callback function */
+	struct _TM_DELAY_Async_t* Next;                      /*!< Next delay in list. This is private member */
+	volatile uint8_t Active;                             /*!< Set when delay is waiting for deadline */
+} TM_DELAY_Async_t;
+
 /**
  * @}
  */
@@ -169,6 +385,7 @@ extern __IO uint32_t TM_Time2;
 
 /**
  * @brief  Initializes delay functions 
+ * @note   Starts DWT counter on STM32F4xx and STM32F7xx and microseconds timer on STM32F0xx
  * @param  None
  * @retval DWT counter start status
  *           - 0: DWT counter did not start, delay for microseconds won't work
@@ -176,6 +393,36 @@ extern __IO uint32_t TM_Time2;
  */
 uint32_t TM_DELAY_Init(void);
 
+#if defined(STM32F0xx) || defined(DOXYGEN)
+/**
+ * @brief  Delays for amount of microseconds with calibrated software loop
+ * @note   Used by @ref Delay on STM32F0xx when timer is not running, not meant for public use
+ * @param  micros: Number of microseconds for delay
+ * @retval None
+ */
+void TM_DELAY_SoftDelay(uint32_t micros);
+#endif
+
+#if (defined(STM32F0xx) && DELAY_US_TIMER) || defined(DOXYGEN)
+/**
+ * @brief  Gets microseconds timestamp from free running timer
+ * @note   Available on STM32F0xx with @ref DELAY_US_TIMER, time wraps around after 2^32 microseconds
+ * @param  None
+ * @retval Time in microseconds since @ref TM_DELAY_Init
+ */
+uint32_t TM_DELAY_Micros(void);
+#endif
+
+/**
+ * @brief  Updates delay settings after system clock change
+ * @note   Tickless SysTick calibration and asynchronous delays timer prescaler are set for new clocks.
+ *         Timer counter value is kept, pending asynchronous delays stay valid
+ * @note   Can be added to @ref TM_RCC library with @ref TM_RCC_AddClockCallback
+ * @param  None
+ * @retval None
+ */
+void TM_DELAY_UpdateClock(void);
+
 /**
  * @brief  Delays for amount of micro seconds
  * @param  micros: Number of microseconds for delay
@@ -191,11 +438,29 @@ __STATIC_INLINE void Delay(__IO uint32_t micros) {
 	/* Delay till end */
 	while ((DWT->CYCCNT - start) < micros);
 #else
-	/* Go to clock cycles */
-	micros *= (SystemCoreClock / 1000000) / 5;
+#if DELAY_US_TIMER
+	uint32_t last, now, elapsed;
 	
-	/* Wait till done */
-	while (micros--);
+	/* Use timer when running */
+	if (DELAY_US_TIM->CR1 & TIM_CR1_CEN) {
+		last = DELAY_US_TIM->CNT;
+		
+		/* Count elapsed ticks of 16-bit timer till end */
+		while (micros) {
+			now = DELAY_US_TIM->CNT;
+			elapsed = (now - last) & 0xFFFF;
+			if (elapsed >= micros) {
+				break;
+			}
+			micros -= elapsed;
+			last = now;
+		}
+		return;
+	}
+#endif
+	
+	/* Calibrated software loop */
+	TM_DELAY_SoftDelay(micros);
 #endif
 }
 
@@ -247,13 +512,13 @@ __STATIC_INLINE void Delayms(uint32_t millis) {
 
 /**
  * @brief  Creates a new custom timer which has 1ms resolution
- * @note   It uses @ref malloc for memory allocation for timer structure
+ * @note   Timer is taken from static pool with @ref DELAY_MAX_CUSTOM_TIMERS timers
  * @param  ReloadValue: Number of milliseconds when timer reaches zero and callback function is called
  * @param  AutoReloadCmd: If set to 1, timer will start again when it reaches zero and callback is called
  * @param  StartTimer: If set to 1, timer will start immediately
  * @param  *TM_DELAY_CustomTimerCallback: Pointer to callback function which will be called when timer reaches zero
  * @param  *UserParameters: Pointer to void pointer to user parameters used as first parameter in callback function
- * @retval Pointer to allocated timer structure
+ * @retval Pointer to allocated timer structure or NULL when pool is empty
  */
 TM_DELAY_Timer_t* TM_DELAY_TimerCreate(uint32_t ReloadValue, uint8_t AutoReloadCmd, uint8_t StartTimer, void (*TM_DELAY_CustomTimerCallback)(struct _TM_DELAY_Timer_t*, void *), void* UserParameters);
 
@@ -316,6 +581,124 @@ TM_DELAY_Timer_t* TM_DELAY_TimerAutoReloadValue(TM_DELAY_Timer_t* Timer, uint32_
  */
 void TM_DELAY_1msHandler(void);
 
+#if DELAY_TICKLESS || defined(DOXYGEN)
+/**
+ * @brief  Gets number of milliseconds till first software timer may expire
+ * @note   Available in tickless mode only
+ * @param  None
+ * @retval Number of milliseconds, limited to @ref DELAY_TICKLESS_MAX_PERIOD
+ */
+uint32_t TM_DELAY_GetIdleTime(void);
+
+/**
+ * @brief  Stretches current SysTick period before core goes to sleep
+ * @note   Must be called with disabled interrupts and followed by @ref TM_DELAY_ResumeTicks after wakeup
+ * @note   Available in tickless mode only
+ * @param  Millis: Maximal sleep time in milliseconds from now
+ * @retval Number of milliseconds till next SysTick interrupt, limited with first software timer.
+ *            0 is returned when SysTick interrupt is already pending and core should not sleep
+ */
+uint32_t TM_DELAY_SuppressTicks(uint32_t Millis);
+
+/**
+ * @brief  Ends stretched SysTick period after wakeup
+ * @note   When woken up by other interrupt, SysTick interrupt is made at end of current millisecond
+ *            where all slept milliseconds are processed, including calls to FreeRTOS tick handler
+ * @note   Must be called with disabled interrupts
+ * @note   Available in tickless mode only
+ * @param  None
+ * @retval None
+ */
+void TM_DELAY_ResumeTicks(void);
+
+/**
+ * @brief  Stops SysTick before core enters Stop mode
+ * @note   Must be called with disabled interrupts and followed by @ref TM_DELAY_StartTicks after wakeup
+ * @note   Available in tickless mode only
+ * @param  Min: Minimal stop time in milliseconds, SysTick is not stopped when first software timer expires earlier
+ * @retval Number of milliseconds till first software timer may expire, limited to @ref DELAY_TICKLESS_MAX_PERIOD.
+ *            0 is returned and SysTick is not stopped when SysTick interrupt or asynchronous delay is pending
+ */
+uint32_t TM_DELAY_StopTicks(uint32_t Min);
+
+/**
+ * @brief  Starts SysTick after Stop mode and adds time spent in Stop mode
+ * @note   Must be called with disabled interrupts after system clock is restored.
+ *            Expired software timers are processed in SysTick interrupt when interrupts are enabled again
+ * @note   Available in tickless mode only
+ * @param  Millis: Time spent in Stop mode in milliseconds
+ * @retval None
+ */
+void TM_DELAY_StartTicks(uint32_t Millis);
+#endif
+
+#if DELAY_ASYNC || defined(DOXYGEN)
+/**
+ * @defgroup TM_DELAY_Async_Functions
+ * @brief    Asynchronous delay functions, available when @ref DELAY_ASYNC is enabled
+ * @{
+ */
+ 
+/**
+ * @brief  Starts free running timer in microseconds for asynchronous delays
+ * @note   Must be called after system clock is set
+ * @param  None
+ * @retval None
+ */
+void TM_DELAY_AsyncInit(void);
+
+/**
+ * @brief  Gets current time of asynchronous delays timer
+ * @param  None
+ * @retval Time in microseconds
+ */
+#define TM_DELAY_AsyncTime()        (DELAY_ASYNC_TIM->CNT)
+
+/**
+ * @brief  Starts asynchronous delay from now, running delay is restarted
+ * @note   Can be called from callback to start next step of state machine
+ * @param  *Async: Pointer to @ref TM_DELAY_Async_t structure, must stay valid till callback is called
+ * @param  Micros: Delay in microseconds
+ * @param  *Callback: Function called from timer interrupt at deadline
+ * @param  *UserParameters: Pointer to user parameters for callback
+ * @retval None
+ */
+void TM_DELAY_AsyncStart(TM_DELAY_Async_t* Async, uint32_t Micros, void (*Callback)(struct _TM_DELAY_Async_t*, void *), void* UserParameters);
+
+/**
+ * @brief  Starts asynchronous delay to absolute deadline, running delay is restarted
+ * @note   Use Async->Deadline + period from callback for periodic events without drift
+ * @param  *Async: Pointer to @ref TM_DELAY_Async_t structure, must stay valid till callback is called
+ * @param  Deadline: Timer value in microseconds, callback is called immediately if deadline already passed
+ * @param  *Callback: Function called from timer interrupt at deadline
+ * @param  *UserParameters: Pointer to user parameters for callback
+ * @retval None
+ */
+void TM_DELAY_AsyncStartAt(TM_DELAY_Async_t* Async, uint32_t Deadline, void (*Callback)(struct _TM_DELAY_Async_t*, void *), void* UserParameters);
+
+/**
+ * @brief  Cancels pending asynchronous delay, callback is not called
+ * @param  *Async: Pointer to @ref TM_DELAY_Async_t structure
+ * @retval None
+ */
+void TM_DELAY_AsyncCancel(TM_DELAY_Async_t* Async);
+
+#if DELAY_RTOS || defined(DOXYGEN)
+/**
+ * @brief  Blocks calling FreeRTOS task for amount of microseconds, other tasks run in the meantime
+ * @note   Task notification value of calling task is used
+ * @note   Available when @ref DELAY_RTOS is enabled
+ * @param  Micros: Delay in microseconds
+ * @retval None
+ */
+void TM_DELAY_AsyncWait(uint32_t Micros);
+#endif
+
+/**
+ * @}
+ */
+#endif
+
 /**
  * @}
  */
@@ -21,6 +21,11 @@
 /* Private defines for stream numbers */
 #define GET_STREAM_NUMBER_DMA1(stream)    (((uint32_t)(stream) - (uint32_t)DMA1_Stream0) / (0x18))
 #define GET_STREAM_NUMBER_DMA2(stream)    (((uint32_t)(stream) - (uint32_t)DMA2_Stream0) / (0x18))
+#define GET_DMA_INDEX(stream)             ((stream) < DMA2_Stream0 ? 0 : 1)
+#define GET_STREAM_NUMBER(stream)         ((stream) < DMA2_Stream0 ? GET_STREAM_NUMBER_DMA1(stream) : GET_STREAM_NUMBER_DMA2(stream))
+
+/* Max items in one part of chained transfer, multiple of 4 for FIFO packing */
+#define DMA_CHAIN_MAX_LENGTH              0xFFFC
 
 /* Offsets for bits */
 const static uint8_t DMA_Flags_Bit_Pos[4] = {
@@ -37,12 +42,169 @@ const static IRQn_Type DMA_IRQs[2][8] = {
 	}
 };
 
+/* Private structure for stream table */
+typedef struct {
+	TM_DMA_Request_t Request;   /*!< Peripheral request */
+	DMA_Stream_TypeDef* Stream; /*!< Stream which can serve request */
+	uint32_t Channel;           /*!< Channel for request on stream */
+} TM_DMA_INT_StreamTable_t;
+
+/* Streams and channels for peripheral requests, default streams used by TM libraries are first */
+static const TM_DMA_INT_StreamTable_t DMA_StreamTable[] = {
+	{TM_DMA_Request_USART1_TX, DMA2_Stream7, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART1_RX, DMA2_Stream5, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART1_RX, DMA2_Stream2, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART2_TX, DMA1_Stream6, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART2_RX, DMA1_Stream5, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART3_TX, DMA1_Stream3, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART3_TX, DMA1_Stream4, DMA_CHANNEL_7},
+	{TM_DMA_Request_USART3_RX, DMA1_Stream1, DMA_CHANNEL_4},
+	{TM_DMA_Request_UART4_TX, DMA1_Stream4, DMA_CHANNEL_4},
+	{TM_DMA_Request_UART4_RX, DMA1_Stream2, DMA_CHANNEL_4},
+	{TM_DMA_Request_UART5_TX, DMA1_Stream7, DMA_CHANNEL_4},
+	{TM_DMA_Request_UART5_RX, DMA1_Stream0, DMA_CHANNEL_4},
+	{TM_DMA_Request_USART6_TX, DMA2_Stream6, DMA_CHANNEL_5},
+	{TM_DMA_Request_USART6_TX, DMA2_Stream7, DMA_CHANNEL_5},
+	{TM_DMA_Request_USART6_RX, DMA2_Stream1, DMA_CHANNEL_5},
+	{TM_DMA_Request_USART6_RX, DMA2_Stream2, DMA_CHANNEL_5},
+	{TM_DMA_Request_UART7_TX, DMA1_Stream1, DMA_CHANNEL_5},
+	{TM_DMA_Request_UART7_RX, DMA1_Stream3, DMA_CHANNEL_5},
+	{TM_DMA_Request_UART8_TX, DMA1_Stream0, DMA_CHANNEL_5},
+	{TM_DMA_Request_UART8_RX, DMA1_Stream6, DMA_CHANNEL_5},
+	{TM_DMA_Request_SPI1_TX, DMA2_Stream3, DMA_CHANNEL_3},
+	{TM_DMA_Request_SPI1_TX, DMA2_Stream5, DMA_CHANNEL_3},
+	{TM_DMA_Request_SPI1_RX, DMA2_Stream2, DMA_CHANNEL_3},
+	{TM_DMA_Request_SPI1_RX, DMA2_Stream0, DMA_CHANNEL_3},
+	{TM_DMA_Request_SPI2_TX, DMA1_Stream4, DMA_CHANNEL_0},
+	{TM_DMA_Request_SPI2_RX, DMA1_Stream3, DMA_CHANNEL_0},
+	{TM_DMA_Request_SPI3_TX, DMA1_Stream5, DMA_CHANNEL_0},
+	{TM_DMA_Request_SPI3_TX, DMA1_Stream7, DMA_CHANNEL_0},
+	{TM_DMA_Request_SPI3_RX, DMA1_Stream0, DMA_CHANNEL_0},
+	{TM_DMA_Request_SPI3_RX, DMA1_Stream2, DMA_CHANNEL_0},
+	{TM_DMA_Request_SPI4_TX, DMA2_Stream1, DMA_CHANNEL_4},
+	{TM_DMA_Request_SPI4_TX, DMA2_Stream4, DMA_CHANNEL_5},
+	{TM_DMA_Request_SPI4_RX, DMA2_Stream0, DMA_CHANNEL_4},
+	{TM_DMA_Request_SPI4_RX, DMA2_Stream3, DMA_CHANNEL_5},
+	{TM_DMA_Request_SPI5_TX, DMA2_Stream6, DMA_CHANNEL_7},
+	{TM_DMA_Request_SPI5_TX, DMA2_Stream4, DMA_CHANNEL_2},
+	{TM_DMA_Request_SPI5_RX, DMA2_Stream5, DMA_CHANNEL_7},
+	{TM_DMA_Request_SPI5_RX, DMA2_Stream3, DMA_CHANNEL_2},
+	{TM_DMA_Request_SPI6_TX, DMA2_Stream5, DMA_CHANNEL_1},
+	{TM_DMA_Request_SPI6_RX, DMA2_Stream6, DMA_CHANNEL_1},
+	{TM_DMA_Request_I2C1_TX, DMA1_Stream6, DMA_CHANNEL_1},
+	{TM_DMA_Request_I2C1_TX, DMA1_Stream7, DMA_CHANNEL_1},
+	{TM_DMA_Request_I2C1_RX, DMA1_Stream0, DMA_CHANNEL_1},
+	{TM_DMA_Request_I2C1_RX, DMA1_Stream5, DMA_CHANNEL_1},
+	{TM_DMA_Request_I2C2_TX, DMA1_Stream7, DMA_CHANNEL_7},
+	{TM_DMA_Request_I2C2_RX, DMA1_Stream3, DMA_CHANNEL_7},
+	{TM_DMA_Request_I2C2_RX, DMA1_Stream2, DMA_CHANNEL_7},
+	{TM_DMA_Request_I2C3_TX, DMA1_Stream4, DMA_CHANNEL_3},
+	{TM_DMA_Request_I2C3_RX, DMA1_Stream2, DMA_CHANNEL_3},
+	{TM_DMA_Request_ADC1, DMA2_Stream0, DMA_CHANNEL_0},
+	{TM_DMA_Request_ADC1, DMA2_Stream4, DMA_CHANNEL_0},
+	{TM_DMA_Request_ADC2, DMA2_Stream2, DMA_CHANNEL_1},
+	{TM_DMA_Request_ADC2, DMA2_Stream3, DMA_CHANNEL_1},
+	{TM_DMA_Request_ADC3, DMA2_Stream1, DMA_CHANNEL_2},
+	{TM_DMA_Request_ADC3, DMA2_Stream0, DMA_CHANNEL_2},
+	{TM_DMA_Request_DAC1, DMA1_Stream5, DMA_CHANNEL_7},
+	{TM_DMA_Request_DAC2, DMA1_Stream6, DMA_CHANNEL_7},
+	{TM_DMA_Request_SDIO, DMA2_Stream3, DMA_CHANNEL_4},
+	{TM_DMA_Request_SDIO, DMA2_Stream6, DMA_CHANNEL_4},
+	{TM_DMA_Request_TIM1_UP, DMA2_Stream5, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM3_UP, DMA1_Stream2, DMA_CHANNEL_5},
+	{TM_DMA_Request_TIM4_UP, DMA1_Stream6, DMA_CHANNEL_2},
+	{TM_DMA_Request_TIM8_UP, DMA2_Stream1, DMA_CHANNEL_7},
+	{TM_DMA_Request_TIM1_CH1, DMA2_Stream1, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM1_CH1, DMA2_Stream3, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM1_CH1, DMA2_Stream6, DMA_CHANNEL_0},
+	{TM_DMA_Request_TIM1_CH2, DMA2_Stream2, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM1_CH2, DMA2_Stream6, DMA_CHANNEL_0},
+	{TM_DMA_Request_TIM1_CH3, DMA2_Stream6, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM1_CH3, DMA2_Stream6, DMA_CHANNEL_0},
+	{TM_DMA_Request_TIM1_CH4, DMA2_Stream4, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM2_CH1, DMA1_Stream5, DMA_CHANNEL_3},
+	{TM_DMA_Request_TIM2_CH2, DMA1_Stream6, DMA_CHANNEL_3},
+	{TM_DMA_Request_TIM2_CH3, DMA1_Stream1, DMA_CHANNEL_3},
+	{TM_DMA_Request_TIM2_CH4, DMA1_Stream7, DMA_CHANNEL_3},
+	{TM_DMA_Request_TIM2_CH4, DMA1_Stream6, DMA_CHANNEL_3},
+	{TM_DMA_Request_TIM3_CH1, DMA1_Stream4, DMA_CHANNEL_5},
+	{TM_DMA_Request_TIM3_CH2, DMA1_Stream5, DMA_CHANNEL_5},
+	{TM_DMA_Request_TIM3_CH3, DMA1_Stream7, DMA_CHANNEL_5},
+	{TM_DMA_Request_TIM3_CH4, DMA1_Stream2, DMA_CHANNEL_5},
+	{TM_DMA_Request_TIM4_CH1, DMA1_Stream0, DMA_CHANNEL_2},
+	{TM_DMA_Request_TIM4_CH2, DMA1_Stream3, DMA_CHANNEL_2},
+	{TM_DMA_Request_TIM4_CH3, DMA1_Stream7, DMA_CHANNEL_2},
+	{TM_DMA_Request_TIM5_CH1, DMA1_Stream2, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM5_CH2, DMA1_Stream4, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM5_CH3, DMA1_Stream0, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM5_CH4, DMA1_Stream1, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM5_CH4, DMA1_Stream3, DMA_CHANNEL_6},
+	{TM_DMA_Request_TIM8_CH1, DMA2_Stream2, DMA_CHANNEL_7},
+	{TM_DMA_Request_TIM8_CH1, DMA2_Stream2, DMA_CHANNEL_0},
+	{TM_DMA_Request_TIM8_CH2, DMA2_Stream3, DMA_CHANNEL_7},
+	{TM_DMA_Request_TIM8_CH2, DMA2_Stream2, DMA_CHANNEL_0},
+	{TM_DMA_Request_TIM8_CH3, DMA2_Stream4, DMA_CHANNEL_7},
+	{TM_DMA_Request_TIM8_CH3, DMA2_Stream2, DMA_CHANNEL_0},
+	{TM_DMA_Request_TIM8_CH4, DMA2_Stream7, DMA_CHANNEL_7},
+	{TM_DMA_Request_DCMI, DMA2_Stream1, DMA_CHANNEL_1},
+	{TM_DMA_Request_DCMI, DMA2_Stream7, DMA_CHANNEL_1}
+};
+
+/* Stream registry */
+static TM_DMA_Request_t DMA_Owners[2][8];
+static TM_DMA_Priority_t DMA_Priorities[2][8];
+
+/* DMA priority register values for priority levels */
+const static uint32_t DMA_PriorityValues[] = {
+	DMA_PRIORITY_LOW, DMA_PRIORITY_LOW, DMA_PRIORITY_MEDIUM, DMA_PRIORITY_HIGH, DMA_PRIORITY_VERY_HIGH
+};
+
+/* Private structure for chained transfers */
+typedef struct {
+	const TM_DMA_Descriptor_t* List; /*!< Descriptors list, NULL when chain is not active */
+	uint16_t Count;                  /*!< Number of descriptors */
+	uint16_t Index;                  /*!< Next descriptor to load */
+	uint32_t Source;                 /*!< Source address for next part */
+	uint32_t Destination;            /*!< Destination address for next part */
+	uint32_t Remaining;              /*!< Items remaining in current descriptor */
+	TM_DMA_Descriptor_t Single;      /*!< Descriptor for long transfers */
+} TM_DMA_INT_Chain_t;
+
+/* Library stream callbacks */
+static TM_DMA_StreamCallback_t DMA_Callbacks[2][8];
+static void* DMA_CallbackParams[2][8];
+
+/* Double buffer callbacks */
+static TM_DMA_DoubleBufferCallback_t DMA_DoubleBufferCallbacks[2][8];
+static void* DMA_DoubleBufferParams[2][8];
+static uint32_t DMA_DoubleBufferSize[2][8];
+
+/* Chained transfers */
+static TM_DMA_INT_Chain_t DMA_Chains[2][8];
+
+/* Private functions */
+static uint8_t TM_DMA_INT_Claim(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request, TM_DMA_Priority_t Priority);
+static uint8_t TM_DMA_INT_ChainNext(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_INT_Chain_t* Chain);
+static void TM_DMA_INT_CallHandlers(void* Context, uint32_t flags);
+
+#if DMA_CACHE_MAINTENANCE
+/* Memory written by DMA for each stream, invalidated on transfer complete */
+static uint32_t DMA_CacheAddress[2][8];
+static uint32_t DMA_CacheSize[2][8];
+
+/* Non-cacheable region set with MPU */
+static uint32_t DMA_NonCacheableAddress, DMA_NonCacheableSize;
+
+/* Private functions */
+static uint8_t TM_DMA_INT_IsCacheable(uint32_t Address, uint32_t Size);
+#endif
+
 void TM_DMA_ClearFlags(DMA_Stream_TypeDef* DMA_Stream) {
 	/* Clear all flags */
 	TM_DMA_ClearFlag(DMA_Stream, DMA_FLAG_ALL);
 }
 
-void TM_DMA_ClearFlag(DMA_Stream_TypeDef* DMA_Stream, uint32_t flag) {
+__ramfunc void TM_DMA_ClearFlag(DMA_Stream_TypeDef* DMA_Stream, uint32_t flag) {
 	uint32_t location;
 	uint32_t stream_number;
 
@@ -68,7 +230,7 @@ void TM_DMA_ClearFlag(DMA_Stream_TypeDef* DMA_Stream, uint32_t flag) {
 	*(__IO uint32_t *)location = (flag & DMA_FLAG_ALL) << DMA_Flags_Bit_Pos[stream_number];
 }
 
-uint32_t TM_DMA_GetFlags(DMA_Stream_TypeDef* DMA_Stream, uint32_t flag) {
+__ramfunc uint32_t TM_DMA_GetFlags(DMA_Stream_TypeDef* DMA_Stream, uint32_t flag) {
 	uint32_t stream_number = 0;
 	uint32_t location = 0;
 	uint32_t flags = 0;
@@ -143,7 +305,7 @@ void TM_DMA_DisableInterrupts(DMA_Stream_TypeDef* DMA_Stream) {
 	if (DMA_Stream < DMA2_Stream0) {
 		IRQValue = DMA_IRQs[0][GET_STREAM_NUMBER_DMA1(DMA_Stream)];
 	} else {
-		IRQValue = DMA_IRQs[0][GET_STREAM_NUMBER_DMA2(DMA_Stream)];
+		IRQValue = DMA_IRQs[1][GET_STREAM_NUMBER_DMA2(DMA_Stream)];
 	}
 	
 	/* Disable NVIC */
@@ -151,15 +313,27 @@ void TM_DMA_DisableInterrupts(DMA_Stream_TypeDef* DMA_Stream) {
 	
 	/* Disable DMA stream interrupts */
 	DMA_Stream->CR &= ~(DMA_SxCR_TCIE  | DMA_SxCR_HTIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
-	DMA_Stream->FCR &= DMA_SxFCR_FEIE;
+	DMA_Stream->FCR &= ~DMA_SxFCR_FEIE;
 }
 
 void TM_DMA_Init(DMA_Stream_TypeDef* Stream, DMA_HandleTypeDef* HDMA) {	
+	TM_DMA_Priority_t priority;
+	
 	/* Init DMA stream */
 	if (HDMA) {
 		/* Unlock DMA */
 		__HAL_UNLOCK(HDMA);
 		
+		/* Use priority from stream registry if set */
+		if (Stream < DMA2_Stream0) {
+			priority = DMA_Priorities[0][GET_STREAM_NUMBER_DMA1(Stream)];
+		} else {
+			priority = DMA_Priorities[1][GET_STREAM_NUMBER_DMA2(Stream)];
+		}
+		if (priority != TM_DMA_Priority_Default) {
+			HDMA->Init.Priority = DMA_PriorityValues[priority];
+		}
+		
 		/* Init DMA */
 		HDMA->Instance = Stream;
 		HAL_DMA_Init(HDMA);
@@ -184,6 +358,47 @@ void TM_DMA_DeInit(DMA_Stream_TypeDef* Stream) {
 }
 
 void TM_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t Source, uint32_t Destination, uint16_t Length) {
+#if DMA_CACHE_MAINTENANCE
+	uint32_t dma, stream_number, size;
+	
+	/* Get number of bytes on memory side, single element when memory is not incremented */
+	size = (hdma->Init.MemInc == DMA_MINC_ENABLE) ? Length : 1;
+	size <<= hdma->Init.MemDataAlignment >> 13;
+	
+	/* Get stream position */
+	if (hdma->Instance < DMA2_Stream0) {
+		dma = 0;
+		stream_number = GET_STREAM_NUMBER_DMA1(hdma->Instance);
+	} else {
+		dma = 1;
+		stream_number = GET_STREAM_NUMBER_DMA2(hdma->Instance);
+	}
+	DMA_CacheSize[dma][stream_number] = 0;
+	
+	if (hdma->Init.Direction == DMA_MEMORY_TO_PERIPH) {
+		/* Write CPU data to memory before DMA reads it */
+		TM_DMA_CleanCache((void *)Source, size);
+	} else {
+		/* Memory to memory reads from peripheral port address */
+		if (hdma->Init.Direction == DMA_MEMORY_TO_MEMORY) {
+			TM_DMA_CleanCache((void *)Source, size);
+		}
+		
+		/* Dummy receive to single element does not need maintenance */
+		if (hdma->Init.MemInc == DMA_MINC_ENABLE) {
+			/* Remove dirty lines, so they are not written over DMA data */
+			TM_DMA_InvalidateCache((void *)Destination, size);
+			
+			/* Save memory for invalidation on transfer complete */
+			DMA_CacheAddress[dma][stream_number] = Destination;
+			DMA_CacheSize[dma][stream_number] = size;
+		}
+	}
+#endif
+	
+	/* Stop chained transfer if any */
+	DMA_Chains[GET_DMA_INDEX(hdma->Instance)][GET_STREAM_NUMBER(hdma->Instance)].List = NULL;
+	
 	/* Unlock DMA */
 	__HAL_UNLOCK(hdma);
 	
@@ -191,9 +406,324 @@ void TM_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t Source, uint32_t Destination
 	HAL_DMA_Start(hdma, Source, Destination, Length);
 }
 
+uint8_t TM_DMA_StartDoubleBuffer(DMA_HandleTypeDef* hdma, uint32_t Source, uint32_t Destination, uint32_t SecondMemory, uint16_t Length, TM_DMA_DoubleBufferCallback_t Callback, void* Param) {
+	uint32_t dma = GET_DMA_INDEX(hdma->Instance);
+	uint32_t stream_number = GET_STREAM_NUMBER(hdma->Instance);
+	
+	/* Memory to memory does not support double buffer */
+	if (hdma->Init.Direction == DMA_MEMORY_TO_MEMORY || !Length) {
+		return 0;
+	}
+	
+	/* Save callback, stop chained transfer if any */
+	DMA_DoubleBufferParams[dma][stream_number] = Param;
+	DMA_DoubleBufferCallbacks[dma][stream_number] = Callback;
+	DMA_Chains[dma][stream_number].List = NULL;
+	
+	/* Save buffer size in units of bytes */
+	DMA_DoubleBufferSize[dma][stream_number] = (uint32_t)Length << (hdma->Init.MemDataAlignment >> 13);
+	
+#if DMA_CACHE_MAINTENANCE
+	/* Both buffers are handled here and on each buffer complete */
+	DMA_CacheSize[dma][stream_number] = 0;
+	if (hdma->Init.Direction == DMA_MEMORY_TO_PERIPH) {
+		TM_DMA_CleanCache((void *)Source, DMA_DoubleBufferSize[dma][stream_number]);
+		TM_DMA_CleanCache((void *)SecondMemory, DMA_DoubleBufferSize[dma][stream_number]);
+	} else {
+		TM_DMA_InvalidateCache((void *)Destination, DMA_DoubleBufferSize[dma][stream_number]);
+		TM_DMA_InvalidateCache((void *)SecondMemory, DMA_DoubleBufferSize[dma][stream_number]);
+	}
+#endif
+	
+	/* Enable interrupts for callback */
+	if (Callback) {
+		TM_DMA_EnableInterrupts(hdma->Instance);
+	}
+	
+	/* Unlock DMA */
+	__HAL_UNLOCK(hdma);
+	
+	/* Start DMA transfer */
+	return HAL_DMAEx_MultiBufferStart(hdma, Source, Destination, SecondMemory, Length) == HAL_OK;
+}
+
+uint8_t TM_DMA_SetMemoryAddress(DMA_Stream_TypeDef* DMA_Stream, uint8_t Memory, uint32_t Address) {
+	/* Check if memory is used by DMA now */
+	if (((DMA_Stream->CR & DMA_SxCR_CT) ? 1 : 0) == Memory) {
+		return 0;
+	}
+	
+	/* Set new address */
+	if (Memory) {
+		DMA_Stream->M1AR = Address;
+	} else {
+		DMA_Stream->M0AR = Address;
+	}
+	
+	/* Return OK */
+	return 1;
+}
+
+uint8_t TM_DMA_StartChain(DMA_HandleTypeDef* hdma, const TM_DMA_Descriptor_t* Descriptors, uint16_t Count) {
+	TM_DMA_INT_Chain_t* Chain = &DMA_Chains[GET_DMA_INDEX(hdma->Instance)][GET_STREAM_NUMBER(hdma->Instance)];
+	
+	/* Check parameters and if stream is free */
+	if (Descriptors == NULL || !Count || (hdma->Instance->CR & DMA_SxCR_EN)) {
+		return 0;
+	}
+	
+	/* Clear double buffer mode, set by HAL on init only */
+	hdma->Instance->CR &= ~(DMA_SxCR_DBM | DMA_SxCR_CT);
+	
+#if DMA_CACHE_MAINTENANCE
+	/* Each part saves its own memory for invalidation */
+	DMA_CacheSize[GET_DMA_INDEX(hdma->Instance)][GET_STREAM_NUMBER(hdma->Instance)] = 0;
+#endif
+	
+	/* Set chain */
+	Chain->Count = Count;
+	Chain->Index = 0;
+	Chain->Remaining = 0;
+	Chain->List = Descriptors;
+	
+	/* Next parts are started from transfer complete interrupt */
+	TM_DMA_EnableInterrupts(hdma->Instance);
+	
+	/* Start first part */
+	return TM_DMA_INT_ChainNext(hdma->Instance, Chain);
+}
+
+uint8_t TM_DMA_StartLong(DMA_HandleTypeDef* hdma, uint32_t Source, uint32_t Destination, uint32_t Length) {
+	TM_DMA_INT_Chain_t* Chain = &DMA_Chains[GET_DMA_INDEX(hdma->Instance)][GET_STREAM_NUMBER(hdma->Instance)];
+	
+	/* Check if stream is free before descriptor is changed */
+	if (hdma->Instance->CR & DMA_SxCR_EN) {
+		return 0;
+	}
+	
+	/* Use internal descriptor */
+	Chain->Single.Source = Source;
+	Chain->Single.Destination = Destination;
+	Chain->Single.Length = Length;
+	
+	/* Start as chain with one descriptor */
+	return TM_DMA_StartChain(hdma, &Chain->Single, 1);
+}
+
+uint8_t TM_DMA_ChainActive(DMA_Stream_TypeDef* DMA_Stream) {
+	/* Check if chain is set */
+	return DMA_Chains[GET_DMA_INDEX(DMA_Stream)][GET_STREAM_NUMBER(DMA_Stream)].List != NULL;
+}
+
+void TM_DMA_SetStreamCallback(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_StreamCallback_t Callback, void* Param) {
+	uint32_t dma, stream_number;
+	
+	/* Check stream value */
+	if (DMA_Stream < DMA2_Stream0) {
+		dma = 0;
+		stream_number = GET_STREAM_NUMBER_DMA1(DMA_Stream);
+	} else {
+		dma = 1;
+		stream_number = GET_STREAM_NUMBER_DMA2(DMA_Stream);
+	}
+	
+	/* Save parameter first, then callback */
+	DMA_CallbackParams[dma][stream_number] = Param;
+	DMA_Callbacks[dma][stream_number] = Callback;
+}
+
+uint8_t TM_DMA_Claim(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request, TM_DMA_Priority_t Priority) {
+	/* Try to claim stream */
+	if (TM_DMA_INT_Claim(DMA_Stream, Request, Priority)) {
+		return 1;
+	}
+	
+	/* Call user conflict callback */
+	TM_DMA_ConflictCallback(DMA_Stream, Request, TM_DMA_GetOwner(DMA_Stream));
+	
+	/* Stream is not available */
+	return 0;
+}
+
+void TM_DMA_Release(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request) {
+	uint32_t dma, stream_number;
+	
+	/* Check stream value */
+	if (DMA_Stream < DMA2_Stream0) {
+		dma = 0;
+		stream_number = GET_STREAM_NUMBER_DMA1(DMA_Stream);
+	} else {
+		dma = 1;
+		stream_number = GET_STREAM_NUMBER_DMA2(DMA_Stream);
+	}
+	
+	/* Release only own stream */
+	if (DMA_Owners[dma][stream_number] == Request) {
+		DMA_Owners[dma][stream_number] = TM_DMA_Request_None;
+		DMA_Priorities[dma][stream_number] = TM_DMA_Priority_Default;
+	}
+}
+
+TM_DMA_Request_t TM_DMA_GetOwner(DMA_Stream_TypeDef* DMA_Stream) {
+	/* Return owner from registry */
+	if (DMA_Stream < DMA2_Stream0) {
+		return DMA_Owners[0][GET_STREAM_NUMBER_DMA1(DMA_Stream)];
+	}
+	return DMA_Owners[1][GET_STREAM_NUMBER_DMA2(DMA_Stream)];
+}
+
+DMA_Stream_TypeDef* TM_DMA_Allocate(TM_DMA_Request_t Request, TM_DMA_Priority_t Priority, DMA_Stream_TypeDef* DMA_Stream, uint32_t* Channel) {
+	uint16_t i;
+	
+	/* Try preferred stream first */
+	if (DMA_Stream != NULL && TM_DMA_INT_Claim(DMA_Stream, Request, Priority)) {
+		return DMA_Stream;
+	}
+	
+	/* Find first free stream from table */
+	for (i = 0; i < sizeof(DMA_StreamTable) / sizeof(DMA_StreamTable[0]); i++) {
+		if (DMA_StreamTable[i].Request == Request && TM_DMA_INT_Claim(DMA_StreamTable[i].Stream, Request, Priority)) {
+			/* Save channel for selected stream */
+			*Channel = DMA_StreamTable[i].Channel;
+			return DMA_StreamTable[i].Stream;
+		}
+	}
+	
+	/* Call user conflict callback */
+	TM_DMA_ConflictCallback(DMA_Stream, Request, DMA_Stream != NULL ? TM_DMA_GetOwner(DMA_Stream) : TM_DMA_Request_None);
+	
+	/* No stream available */
+	return NULL;
+}
+
+void TM_DMA_CleanCache(const void* Address, uint32_t Size) {
+#if DMA_CACHE_MAINTENANCE
+	uint32_t start, end;
+	
+	/* Check if maintenance is needed */
+	if (!TM_DMA_INT_IsCacheable((uint32_t)Address, Size)) {
+		return;
+	}
+	
+	/* Round to full cache lines */
+	start = (uint32_t)Address & ~(DMA_CACHE_LINE_SIZE - 1);
+	end = DMA_CACHE_ALIGN_SIZE((uint32_t)Address + Size);
+	
+	/* Clean data cache */
+	SCB_CleanDCache_by_Addr((uint32_t *)start, end - start);
+#endif
+}
+
+void TM_DMA_InvalidateCache(const void* Address, uint32_t Size) {
+#if DMA_CACHE_MAINTENANCE
+	uint32_t start, end;
+	
+	/* Check if maintenance is needed */
+	if (!TM_DMA_INT_IsCacheable((uint32_t)Address, Size)) {
+		return;
+	}
+	
+	/* Round to full cache lines */
+	start = (uint32_t)Address & ~(DMA_CACHE_LINE_SIZE - 1);
+	end = DMA_CACHE_ALIGN_SIZE((uint32_t)Address + Size);
+	
+	/* Clean partial lines first to keep other variables in the same line */
+	if (((uint32_t)Address | Size) & (DMA_CACHE_LINE_SIZE - 1)) {
+		SCB_CleanInvalidateDCache_by_Addr((uint32_t *)start, end - start);
+	} else {
+		SCB_InvalidateDCache_by_Addr((uint32_t *)start, end - start);
+	}
+#endif
+}
+
+void TM_DMA_InvalidateStreamCache(DMA_Stream_TypeDef* DMA_Stream) {
+#if DMA_CACHE_MAINTENANCE
+	uint32_t dma, stream_number;
+	
+	/* Get stream position */
+	if (DMA_Stream < DMA2_Stream0) {
+		dma = 0;
+		stream_number = GET_STREAM_NUMBER_DMA1(DMA_Stream);
+	} else {
+		dma = 1;
+		stream_number = GET_STREAM_NUMBER_DMA2(DMA_Stream);
+	}
+	
+	/* Invalidate memory written by DMA */
+	if (DMA_CacheSize[dma][stream_number]) {
+		TM_DMA_InvalidateCache((void *)DMA_CacheAddress[dma][stream_number], DMA_CacheSize[dma][stream_number]);
+		
+		/* Forget memory when normal transfer is finished, circular mode writes memory again */
+		if (!(DMA_Stream->CR & DMA_SxCR_CIRC) && !DMA_Stream->NDTR) {
+			DMA_CacheSize[dma][stream_number] = 0;
+		}
+	}
+#endif
+}
+
+uint8_t TM_DMA_ConfigNonCacheableRegion(uint32_t Address, uint32_t Size) {
+#if defined(STM32F7xx)
+	MPU_Region_InitTypeDef MPU_InitStruct;
+	uint8_t region_size = 0;
+	
+	/* Check size, must be power of 2 and address aligned to size */
+	if (Size < 32 || (Size & (Size - 1)) || (Address & (Size - 1))) {
+		return 0;
+	}
+	
+	/* Region size value is log2(size) - 1 */
+	while ((2UL << region_size) < Size) {
+		region_size++;
+	}
+	
+	/* Write cached data to memory before it becomes non-cacheable */
+	if (SCB->CCR & SCB_CCR_DC_Msk) {
+		SCB_CleanInvalidateDCache();
+	}
+	
+	/* Disable MPU during configuration */
+	HAL_MPU_Disable();
+	
+	/* Normal memory, not cacheable, not bufferable */
+	MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+	MPU_InitStruct.Number = DMA_MPU_REGION_NUMBER;
+	MPU_InitStruct.BaseAddress = Address;
+	MPU_InitStruct.Size = region_size;
+	MPU_InitStruct.SubRegionDisable = 0x00;
+	MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
+	MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
+	MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+	MPU_InitStruct.IsShareable = MPU_ACCESS_SHAREABLE;
+	MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+	MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+	HAL_MPU_ConfigRegion(&MPU_InitStruct);
+	
+	/* Enable MPU, default memory map for other memory */
+	HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+	
+#if DMA_CACHE_MAINTENANCE
+	/* Save region, maintenance is not needed there */
+	DMA_NonCacheableAddress = Address;
+	DMA_NonCacheableSize = Size;
+#endif
+	
+	/* Return OK */
+	return 1;
+#else
+	/* No data cache */
+	return 0;
+#endif
+}
+
 /*****************************************************************/
 /*                 DMA INTERRUPT USER CALLBACKS                  */
 /*****************************************************************/
+__weak void TM_DMA_ConflictCallback(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request, TM_DMA_Request_t Owner) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_DMA_ConflictCallback should be implemented in the user file
+	*/
+}
+
 __weak void TM_DMA_TransferCompleteHandler(DMA_Stream_TypeDef* DMA_Stream) {
 	/* NOTE: This function should not be modified, when the callback is needed,
             the TM_DMA_TransferCompleteHandler should be implemented in the user file
@@ -227,130 +757,355 @@ __weak void TM_DMA_FIFOErrorHandler(DMA_Stream_TypeDef* DMA_Stream) {
 /*****************************************************************/
 /*                    DMA INTERNAL FUNCTIONS                     */
 /*****************************************************************/
-static void TM_DMA_INT_ProcessInterrupt(DMA_Stream_TypeDef* DMA_Stream) {
+static uint8_t TM_DMA_INT_ChainNext(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_INT_Chain_t* Chain) {
+	uint32_t cr = DMA_Stream->CR;
+	uint32_t psize = (cr & DMA_SxCR_PSIZE) >> 11;
+	uint32_t length, periph, memory;
+	
+	/* Load next descriptor when current is finished */
+	while (!Chain->Remaining) {
+		if (Chain->List == NULL || Chain->Index >= Chain->Count) {
+			/* Chain finished */
+			Chain->List = NULL;
+			return 0;
+		}
+		Chain->Source = Chain->List[Chain->Index].Source;
+		Chain->Destination = Chain->List[Chain->Index].Destination;
+		Chain->Remaining = Chain->List[Chain->Index].Length;
+		Chain->Index++;
+	}
+	
+	/* Get length of this part */
+	length = Chain->Remaining > DMA_CHAIN_MAX_LENGTH ? DMA_CHAIN_MAX_LENGTH : Chain->Remaining;
+	
+	/* Peripheral port is destination only for memory to peripheral */
+	if ((cr & DMA_SxCR_DIR) == DMA_MEMORY_TO_PERIPH) {
+		periph = Chain->Destination;
+		memory = Chain->Source;
+	} else {
+		periph = Chain->Source;
+		memory = Chain->Destination;
+	}
+	
+#if DMA_CACHE_MAINTENANCE
+	/* Same maintenance as in TM_DMA_Start, for this part only */
+	if ((cr & DMA_SxCR_DIR) == DMA_MEMORY_TO_PERIPH) {
+		TM_DMA_CleanCache((void *)memory, (cr & DMA_SxCR_MINC) ? (length << psize) : (1 << psize));
+	} else {
+		if ((cr & DMA_SxCR_DIR) == DMA_MEMORY_TO_MEMORY) {
+			TM_DMA_CleanCache((void *)periph, length << psize);
+		}
+		if (cr & DMA_SxCR_MINC) {
+			TM_DMA_InvalidateCache((void *)memory, length << psize);
+			DMA_CacheAddress[GET_DMA_INDEX(DMA_Stream)][GET_STREAM_NUMBER(DMA_Stream)] = memory;
+			DMA_CacheSize[GET_DMA_INDEX(DMA_Stream)][GET_STREAM_NUMBER(DMA_Stream)] = length << psize;
+		}
+	}
+#endif
+	
+	/* Configure stream, it is disabled after transfer complete */
+	while (DMA_Stream->CR & DMA_SxCR_EN);
+	TM_DMA_ClearFlag(DMA_Stream, DMA_FLAG_ALL);
+	DMA_Stream->PAR = periph;
+	DMA_Stream->M0AR = memory;
+	DMA_Stream->NDTR = length;
+	
+	/* Move addresses for next part, NDTR counts items of peripheral size */
+	if (cr & DMA_SxCR_PINC) {
+		periph += length << psize;
+	}
+	if (cr & DMA_SxCR_MINC) {
+		memory += length << psize;
+	}
+	if ((cr & DMA_SxCR_DIR) == DMA_MEMORY_TO_PERIPH) {
+		Chain->Destination = periph;
+		Chain->Source = memory;
+	} else {
+		Chain->Source = periph;
+		Chain->Destination = memory;
+	}
+	Chain->Remaining -= length;
+	
+	/* Start stream */
+	DMA_Stream->CR |= DMA_SxCR_EN;
+	
+	/* Part started */
+	return 1;
+}
+
+static uint8_t TM_DMA_INT_Claim(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request, TM_DMA_Priority_t Priority) {
+	uint32_t dma, stream_number, irq;
+	uint8_t status = 0;
+	
+	/* Check stream value */
+	if (DMA_Stream < DMA2_Stream0) {
+		dma = 0;
+		stream_number = GET_STREAM_NUMBER_DMA1(DMA_Stream);
+	} else {
+		dma = 1;
+		stream_number = GET_STREAM_NUMBER_DMA2(DMA_Stream);
+	}
+	
+	/* Disable interrupts, claim can be done from interrupt too */
+	irq = TM_NVIC_Lock();
+	
+	/* Check if stream is free or already ours */
+	if (DMA_Owners[dma][stream_number] == TM_DMA_Request_None || DMA_Owners[dma][stream_number] == Request) {
+		DMA_Owners[dma][stream_number] = Request;
+		
+		/* Keep previous priority when default is used */
+		if (Priority != TM_DMA_Priority_Default) {
+			DMA_Priorities[dma][stream_number] = Priority;
+		}
+		status = 1;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return status */
+	return status;
+}
+
+#if DMA_CACHE_MAINTENANCE
+static uint8_t TM_DMA_INT_IsCacheable(uint32_t Address, uint32_t Size) {
+	/* Check if data cache is enabled */
+	if (!Size || !(SCB->CCR & SCB_CCR_DC_Msk)) {
+		return 0;
+	}
+	
+	/* Peripheral and system memory are not cached */
+	if ((Address >= 0x40000000 && Address < 0x60000000) || Address >= 0xE0000000) {
+		return 0;
+	}
+	
+#if defined(RAMDTCM_BASE) && defined(SRAM1_BASE)
+	/* DTCM RAM is not cached */
+	if (Address >= RAMDTCM_BASE && Address < SRAM1_BASE) {
+		return 0;
+	}
+#endif
+	
+	/* Check non-cacheable region */
+	if (DMA_NonCacheableSize && Address >= DMA_NonCacheableAddress && (Address - DMA_NonCacheableAddress + Size) <= DMA_NonCacheableSize) {
+		return 0;
+	}
+	
+	/* Memory is cacheable */
+	return 1;
+}
+#endif
+
+__ramfunc static void TM_DMA_INT_ProcessInterrupt(DMA_Stream_TypeDef* DMA_Stream) {
+	uint32_t dma, stream_number;
+	uint8_t memory;
+	
 	/* Get DMA interrupt status flags */
 	uint16_t flags = TM_DMA_GetFlags(DMA_Stream, DMA_FLAG_ALL);
 	
 	/* Clear flags */
 	TM_DMA_ClearFlag(DMA_Stream, DMA_FLAG_ALL);
 	
-	/* Call user callback function */
+	/* Get stream position */
+	if (DMA_Stream < DMA2_Stream0) {
+		dma = 0;
+		stream_number = GET_STREAM_NUMBER_DMA1(DMA_Stream);
+	} else {
+		dma = 1;
+		stream_number = GET_STREAM_NUMBER_DMA2(DMA_Stream);
+	}
+	
+#if DMA_CACHE_MAINTENANCE
+	/* Invalidate received memory before anyone reads it */
+	if (flags & (DMA_FLAG_TCIF | DMA_FLAG_HTIF)) {
+		TM_DMA_InvalidateStreamCache(DMA_Stream);
+	}
+#endif
+	
+	/* Double buffer mode, one buffer is finished */
+	if ((flags & DMA_FLAG_TCIF) && (DMA_Stream->CR & DMA_SxCR_DBM)) {
+		/* Finished buffer is the one not used by DMA now */
+		memory = (DMA_Stream->CR & DMA_SxCR_CT) ? 0 : 1;
+		
+#if DMA_CACHE_MAINTENANCE
+		/* Invalidate received buffer */
+		if ((DMA_Stream->CR & DMA_SxCR_DIR) == DMA_PERIPH_TO_MEMORY) {
+			TM_DMA_InvalidateCache((void *)(memory ? DMA_Stream->M1AR : DMA_Stream->M0AR), DMA_DoubleBufferSize[dma][stream_number]);
+		}
+#endif
+		
+		/* Call double buffer callback */
+		if (DMA_DoubleBufferCallbacks[dma][stream_number]) {
+			DMA_DoubleBufferCallbacks[dma][stream_number](DMA_Stream, memory, DMA_DoubleBufferParams[dma][stream_number]);
+		}
+	}
+	
+	/* Chained transfer */
+	if (DMA_Chains[dma][stream_number].List != NULL) {
+		if (flags & DMA_FLAG_TEIF) {
+			/* Stop chain on error */
+			DMA_Chains[dma][stream_number].List = NULL;
+		} else {
+			/* Half transfer of one part is not reported */
+			flags &= ~DMA_FLAG_HTIF;
+			
+			/* Start next part, transfer is complete only after last part */
+			if ((flags & DMA_FLAG_TCIF) && TM_DMA_INT_ChainNext(DMA_Stream, &DMA_Chains[dma][stream_number])) {
+				flags &= ~DMA_FLAG_TCIF;
+			}
+		}
+	}
+	
+	/* Call library callback first */
+	if (DMA_Callbacks[dma][stream_number]) {
+		DMA_Callbacks[dma][stream_number](DMA_Stream, flags, DMA_CallbackParams[dma][stream_number]);
+	}
+	
+	/* Keep only flags with enabled interrupts for user callback functions */
+	if (!(DMA_Stream->CR & DMA_SxCR_TCIE)) {
+		flags &= ~DMA_FLAG_TCIF;
+	}
+	if (!(DMA_Stream->CR & DMA_SxCR_HTIE)) {
+		flags &= ~DMA_FLAG_HTIF;
+	}
+	if (!(DMA_Stream->CR & DMA_SxCR_TEIE)) {
+		flags &= ~DMA_FLAG_TEIF;
+	}
+	if (!(DMA_Stream->CR & DMA_SxCR_DMEIE)) {
+		flags &= ~DMA_FLAG_DMEIF;
+	}
+	if (!(DMA_Stream->FCR & DMA_SxFCR_FEIE)) {
+		flags &= ~DMA_FLAG_FEIF;
+	}
+	
+	/* Call user callback functions */
+	if (flags) {
+#if DMA_DEFER
+		TM_DEFER_Call(TM_DMA_INT_CallHandlers, DMA_Stream, flags);
+#else
+		TM_DMA_INT_CallHandlers(DMA_Stream, flags);
+#endif
+	}
+}
+
+static void TM_DMA_INT_CallHandlers(void* Context, uint32_t flags) {
+	DMA_Stream_TypeDef* DMA_Stream = (DMA_Stream_TypeDef *)Context;
 	
 	/* Check transfer complete flag */
-	if ((flags & DMA_FLAG_TCIF) && (DMA_Stream->CR & DMA_SxCR_TCIE)) {
+	if (flags & DMA_FLAG_TCIF) {
 		TM_DMA_TransferCompleteHandler(DMA_Stream);
 	}
 	/* Check half-transfer complete flag */
-	if ((flags & DMA_FLAG_HTIF) && (DMA_Stream->CR & DMA_SxCR_HTIE)) {
+	if (flags & DMA_FLAG_HTIF) {
 		TM_DMA_HalfTransferCompleteHandler(DMA_Stream);
 	}
 	/* Check transfer error flag */
-	if ((flags & DMA_FLAG_TEIF) && (DMA_Stream->CR & DMA_SxCR_TEIE)) {
+	if (flags & DMA_FLAG_TEIF) {
 		TM_DMA_TransferErrorHandler(DMA_Stream);
 	}
 	/* Check direct error flag */
-	if ((flags & DMA_FLAG_DMEIF) && (DMA_Stream->CR & DMA_SxCR_DMEIE)) {
+	if (flags & DMA_FLAG_DMEIF) {
 		TM_DMA_DirectModeErrorHandler(DMA_Stream);
 	}
 	/* Check FIFO error flag */
-	if ((flags & DMA_FLAG_FEIF) && (DMA_Stream->FCR & DMA_SxFCR_FEIE)) {
+	if (flags & DMA_FLAG_FEIF) {
 		TM_DMA_FIFOErrorHandler(DMA_Stream);
 	}
 }
 
 /* Handle all DMA interrupt handlers possible */
 #ifndef DMA1_STREAM0_DISABLE_IRQHANDLER
-void DMA1_Stream0_IRQHandler(void) {
+__ramfunc void DMA1_Stream0_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream0);
 }
 #endif
 #ifndef DMA1_STREAM1_DISABLE_IRQHANDLER
-void DMA1_Stream1_IRQHandler(void) {
+__ramfunc void DMA1_Stream1_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream1);
 }
 #endif
 #ifndef DMA1_STREAM2_DISABLE_IRQHANDLER
-void DMA1_Stream2_IRQHandler(void) {
+__ramfunc void DMA1_Stream2_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream2);
 }
 #endif
 #ifndef DMA1_STREAM3_DISABLE_IRQHANDLER
-void DMA1_Stream3_IRQHandler(void) {
+__ramfunc void DMA1_Stream3_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream3);
 }
 #endif
 #ifndef DMA1_STREAM4_DISABLE_IRQHANDLER
-void DMA1_Stream4_IRQHandler(void) {
+__ramfunc void DMA1_Stream4_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream4);
 }
 #endif
 #ifndef DMA1_STREAM5_DISABLE_IRQHANDLER
-void DMA1_Stream5_IRQHandler(void) {
+__ramfunc void DMA1_Stream5_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream5);
 }
 #endif
 #ifndef DMA1_STREAM6_DISABLE_IRQHANDLER
-void DMA1_Stream6_IRQHandler(void) {
+__ramfunc void DMA1_Stream6_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream6);
 }
 #endif
 #ifndef DMA1_STREAM7_DISABLE_IRQHANDLER
-void DMA1_Stream7_IRQHandler(void) {
+__ramfunc void DMA1_Stream7_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA1_Stream7);
 }
 #endif
 #ifndef DMA2_STREAM0_DISABLE_IRQHANDLER
-void DMA2_Stream0_IRQHandler(void) {
+__ramfunc void DMA2_Stream0_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream0);
 }
 #endif
 #ifndef DMA2_STREAM1_DISABLE_IRQHANDLER
-void DMA2_Stream1_IRQHandler(void) {
+__ramfunc void DMA2_Stream1_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream1);
 }
 #endif
 #ifndef DMA2_STREAM2_DISABLE_IRQHANDLER
-void DMA2_Stream2_IRQHandler(void) {
+__ramfunc void DMA2_Stream2_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream2);
 }
 #endif
 #ifndef DMA2_STREAM3_DISABLE_IRQHANDLER
-void DMA2_Stream3_IRQHandler(void) {
+__ramfunc void DMA2_Stream3_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream3);
 }
 #endif
 #ifndef DMA2_STREAM4_DISABLE_IRQHANDLER
-void DMA2_Stream4_IRQHandler(void) {
+__ramfunc void DMA2_Stream4_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream4);
 }
 #endif
 #ifndef DMA2_STREAM5_DISABLE_IRQHANDLER
-void DMA2_Stream5_IRQHandler(void) {
+__ramfunc void DMA2_Stream5_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream5);
 }
 #endif
 #ifndef DMA2_STREAM6_DISABLE_IRQHANDLER
-void DMA2_Stream6_IRQHandler(void) {
+__ramfunc void DMA2_Stream6_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream6);
 }
 #endif
 #ifndef DMA2_STREAM7_DISABLE_IRQHANDLER
-void DMA2_Stream7_IRQHandler(void) {
+__ramfunc void DMA2_Stream7_IRQHandler(void) {
 	/* Call user function */
 	TM_DMA_INT_ProcessInterrupt(DMA2_Stream7);
 }
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2016/04/hal-library-31-dma-stm32fxxx-devices
- * @version v1.1
+ * @version v2.0
  * @ide     Keil uVision
  * @license MIT
  * @brief   DMA library for STM32F4xx and STM32F7xx devices for several purposes
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_DMA_H
-#define TM_DMA_H 100
+#define TM_DMA_H 200
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -73,10 +73,139 @@ extern "C" {
  * 
  * Every stream on DMA can make 5 interrupts. My library is designed in a way that specific callback is called for each interrupt type.
  * Check functions section for more informations.
+ *
+ * \par Double buffer and chained transfers
+ *
+ * For continuous streaming, @ref TM_DMA_StartDoubleBuffer() starts stream in double buffer mode.
+ * DMA switches between 2 memory buffers without stopping and callback is called each time one buffer is finished.
+ * While DMA works on one buffer, CPU can process other one or set new address for it with @ref TM_DMA_SetMemoryAddress().
+ *
+@code
+//Called when one buffer is full, other buffer is now used by DMA
+void ADC_BufferCallback(DMA_Stream_TypeDef* DMA_Stream, uint8_t Memory, void* Param) {
+    //Process buffer Memory (0 or 1), before DMA finishes other buffer
+}
+
+//Start ADC to 2 buffers
+TM_DMA_StartDoubleBuffer(&hdma, (uint32_t)&ADC1->DR, (uint32_t)Buffer0, (uint32_t)Buffer1, 1024, ADC_BufferCallback, NULL);
+@endcode
+ *
+ * For transfers longer than 65535 items or for scatter-gather transfers, use @ref TM_DMA_StartLong() or @ref TM_DMA_StartChain() functions.
+ * Transfer is split to parts which are started one after another from transfer complete interrupt.
+ * User transfer complete callbacks are called only once, when last part is finished.
+ *
+@code
+//Send 3 separate memory blocks to USART TX register
+const TM_DMA_Descriptor_t Chain[] = {
+    {(uint32_t)Header, (uint32_t)&USART1->DR, sizeof(Header)},
+    {(uint32_t)Data,   (uint32_t)&USART1->DR, DataLength},
+    {(uint32_t)Footer, (uint32_t)&USART1->DR, sizeof(Footer)}
+};
+TM_DMA_StartChain(&hdma, Chain, 3);
+@endcode
+ *
+ * \par Stream allocation
+ *
+ * DMA streams are shared between many peripherals and two peripherals on the same stream do not work.
+ * Library keeps registry of streams with owner for each stream. TM USART DMA, TM SPI DMA and TM I2C DMA libraries
+ * use @ref TM_DMA_Allocate() function on init: when default (or user selected) stream is already used by other peripheral,
+ * another free stream/channel which is allowed for peripheral request is selected from internal table.
+ *
+ * When no stream is available, @ref TM_DMA_ConflictCallback() is called.
+ * Your own code can claim streams it uses with @ref TM_DMA_Claim() function, so other libraries will not take them.
+ *
+ * You can also set priority for stream when you claim it before library init. Priority is then used each time stream is initialized with @ref TM_DMA_Init():
+ *
+@code
+//Use very high priority for USART1 RX stream
+TM_DMA_Claim(DMA2_Stream5, TM_DMA_Request_USART1_RX, TM_DMA_Priority_VeryHigh);
+TM_USART_DMA_InitRX(USART1);
+@endcode
+ *
+ * \par Data cache on STM32F7xx
+ *
+ * STM32F7xx has data cache and DMA does not see data which are only in cache or updates memory behind cache.
+ * Library does cache maintenance in @ref TM_DMA_Start() function for memory side of transfer:
+ *
+ *  - Memory to peripheral: Source memory is cleaned (written from cache to memory) before transfer starts
+ *  - Peripheral to memory: Destination memory is cleaned and invalidated before transfer starts,
+ *      and invalidated again on transfer complete (and half-transfer) interrupt before any callback is called
+ *  - Memory to memory: Source is cleaned and destination is handled as for peripheral to memory
+ *
+ * When stream is polled without interrupts, call @ref TM_DMA_InvalidateStreamCache() when transfer is done before reading received data.
+ *
+ * Cache maintenance works on 32-bytes cache lines. Receive buffers should start on cache line and should be multiple of cache lines long,
+ * otherwise variables which share cache line with buffer may be affected. Use @ref __dma_aligned attribute and @ref DMA_CACHE_ALIGN_SIZE macro:
+ *
+@code
+//Buffer for DMA receive, aligned to cache line and rounded to full cache lines
+__dma_aligned uint8_t RX_Buffer[DMA_CACHE_ALIGN_SIZE(100)];
+@endcode
+ *
+ * Another option is to put all DMA buffers to one memory region and set it as non-cacheable with @ref TM_DMA_ConfigNonCacheableRegion().
+ * No maintenance is done for addresses in this region, in DTCM RAM or in peripheral memory.
+ *
+@verbatim
+//Disable cache maintenance in library, defines.h file
+#define DMA_CACHE_MAINTENANCE    0
+
+//MPU region number used for non-cacheable region
+#define DMA_MPU_REGION_NUMBER    7
+@endverbatim
+ *
+ * \par Deferred handlers
+ *
+ * With DMA_DEFER enabled, user handlers (@ref TM_DMA_TransferCompleteHandler and others) are queued to @ref TM_DEFER library
+ * with flags of interrupt and called later from PendSV or deferred work task. Library callbacks set with
+ * @ref TM_DMA_SetStreamCallback() are always called from interrupt, because other TM libraries restart transfers there.
+ *
+@verbatim
+//Call user DMA handlers outside of DMA interrupt, defines.h file
+#define DMA_DEFER                1
+@endverbatim
  *
  * \par Changelog
  *
 @verbatim
+ Version 2.0
+  - October 14, 2026
+  - Added DCMI request to stream table, used by TM DCMI library
+
+ Version 1.9
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+  - Default NVIC priority is taken from TM NVIC priority plan
+
+ Version 1.3
+  - October 14, 2026
+  - Added data cache maintenance for DMA transfers on STM32F7xx devices
+  - Added @ref TM_DMA_ConfigNonCacheableRegion() function for MPU non-cacheable DMA memory
+
+ Version 1.4
+  - October 14, 2026
+  - Added stream registry with conflict detection, stream allocation and priority levels
+
+ Version 1.5
+  - October 14, 2026
+  - Added double buffer mode with @ref TM_DMA_StartDoubleBuffer() function
+  - Added chained transfers with @ref TM_DMA_StartChain() and @ref TM_DMA_StartLong() functions
+
+ Version 1.6
+  - October 14, 2026
+  - Added timer update requests to stream table, used by TM PWM library
+
+ Version 1.7
+  - October 14, 2026
+  - Added timer capture/compare requests to stream table, used by TM CAPTURE library
+
+ Version 1.8
+  - October 14, 2026
+  - Added DMA_DEFER option to call user interrupt handlers outside of interrupt with TM DEFER library
+
+ Version 1.2
+  - October 14, 2026
+  - Added library stream callbacks with @ref TM_DMA_SetStreamCallback() for other TM libraries
+
  Version 1.1
   - June 13, 2015
   - Added support for clearing DMA interrupt flags 
@@ -93,6 +222,7 @@ extern "C" {
  - MISC
  - defines.h
  - attributes.h
+ - TM DEFER (only when DMA_DEFER)
 @endverbatim
  */
 
@@ -118,14 +248,49 @@ extern "C" {
 
 /* DMA1 preemption priority */
 #ifndef DMA1_NVIC_PREEMPTION_PRIORITY
-#define DMA1_NVIC_PREEMPTION_PRIORITY   0x01
+#define DMA1_NVIC_PREEMPTION_PRIORITY   NVIC_PRIORITY_CRITICAL
 #endif
 
 /* DMA2 preemption priority */
 #ifndef DMA2_NVIC_PREEMPTION_PRIORITY
-#define DMA2_NVIC_PREEMPTION_PRIORITY   0x01
+#define DMA2_NVIC_PREEMPTION_PRIORITY   NVIC_PRIORITY_CRITICAL
+#endif
+
+/* Data cache maintenance for DMA memory, enabled by default on STM32F7xx devices */
+#ifndef DMA_CACHE_MAINTENANCE
+#if defined(STM32F7xx)
+#define DMA_CACHE_MAINTENANCE           1
+#else
+#define DMA_CACHE_MAINTENANCE           0
+#endif
+#endif
+
+/* MPU region number for non-cacheable DMA memory */
+#ifndef DMA_MPU_REGION_NUMBER
+#define DMA_MPU_REGION_NUMBER           7
+#endif
+
+/* Call user interrupt handlers from deferred context with TM DEFER library */
+#ifndef DMA_DEFER
+#define DMA_DEFER                       0
+#endif
+
+#if DMA_DEFER
+#include "tm_stm32_defer.h"
 #endif
 
+/**
+ * @brief  Data cache line size in units of bytes
+ */
+#define DMA_CACHE_LINE_SIZE             32
+
+/**
+ * @brief  Rounds buffer size up to multiple of cache lines
+ * @param  size: Buffer size in units of bytes
+ * @retval Size rounded up to @ref DMA_CACHE_LINE_SIZE
+ */
+#define DMA_CACHE_ALIGN_SIZE(size)      (((size) + DMA_CACHE_LINE_SIZE - 1) & ~(DMA_CACHE_LINE_SIZE - 1))
+
 /**
  * @}
  */
@@ -135,7 +300,121 @@ extern "C" {
  * @brief    Library Typedefs
  * @{
  */
-/* Typedefs here */
+
+/**
+ * @brief  Stream callback function type, used by other TM libraries
+ * @param  *DMA_Stream: Pointer to DMA stream where interrupt happens
+ * @param  flags: Interrupt flags set for stream, combination of DMA_FLAG_xxx values
+ * @param  *Param: Pointer to parameter passed on @ref TM_DMA_SetStreamCallback() call
+ * @retval None
+ */
+typedef void (*TM_DMA_StreamCallback_t)(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+
+/**
+ * @brief  Double buffer callback function type
+ * @param  *DMA_Stream: Pointer to DMA stream where interrupt happens
+ * @param  Memory: Memory buffer which was finished and is not used by DMA now, 0 for M0AR or 1 for M1AR
+ * @param  *Param: Pointer to parameter passed on @ref TM_DMA_StartDoubleBuffer() call
+ * @retval None
+ */
+typedef void (*TM_DMA_DoubleBufferCallback_t)(DMA_Stream_TypeDef* DMA_Stream, uint8_t Memory, void* Param);
+
+/**
+ * @brief  Chained transfer descriptor
+ */
+typedef struct {
+	uint32_t Source;      /*!< Source address */
+	uint32_t Destination; /*!< Destination address */
+	uint32_t Length;      /*!< Number of items to transfer, can be more than 65535 */
+} TM_DMA_Descriptor_t;
+
+/**
+ * @brief  Peripheral DMA requests, used as stream owner in stream registry
+ */
+typedef enum {
+	TM_DMA_Request_None = 0x00, /*!< Stream is free */
+	TM_DMA_Request_USART1_TX,   /*!< USART1 TX */
+	TM_DMA_Request_USART1_RX,   /*!< USART1 RX */
+	TM_DMA_Request_USART2_TX,   /*!< USART2 TX */
+	TM_DMA_Request_USART2_RX,   /*!< USART2 RX */
+	TM_DMA_Request_USART3_TX,   /*!< USART3 TX */
+	TM_DMA_Request_USART3_RX,   /*!< USART3 RX */
+	TM_DMA_Request_UART4_TX,    /*!< UART4 TX */
+	TM_DMA_Request_UART4_RX,    /*!< UART4 RX */
+	TM_DMA_Request_UART5_TX,    /*!< UART5 TX */
+	TM_DMA_Request_UART5_RX,    /*!< UART5 RX */
+	TM_DMA_Request_USART6_TX,   /*!< USART6 TX */
+	TM_DMA_Request_USART6_RX,   /*!< USART6 RX */
+	TM_DMA_Request_UART7_TX,    /*!< UART7 TX */
+	TM_DMA_Request_UART7_RX,    /*!< UART7 RX */
+	TM_DMA_Request_UART8_TX,    /*!< UART8 TX */
+	TM_DMA_Request_UART8_RX,    /*!< UART8 RX */
+	TM_DMA_Request_SPI1_TX,     /*!< SPI1 TX */
+	TM_DMA_Request_SPI1_RX,     /*!< SPI1 RX */
+	TM_DMA_Request_SPI2_TX,     /*!< SPI2 TX */
+	TM_DMA_Request_SPI2_RX,     /*!< SPI2 RX */
+	TM_DMA_Request_SPI3_TX,     /*!< SPI3 TX */
+	TM_DMA_Request_SPI3_RX,     /*!< SPI3 RX */
+	TM_DMA_Request_SPI4_TX,     /*!< SPI4 TX */
+	TM_DMA_Request_SPI4_RX,     /*!< SPI4 RX */
+	TM_DMA_Request_SPI5_TX,     /*!< SPI5 TX */
+	TM_DMA_Request_SPI5_RX,     /*!< SPI5 RX */
+	TM_DMA_Request_SPI6_TX,     /*!< SPI6 TX */
+	TM_DMA_Request_SPI6_RX,     /*!< SPI6 RX */
+	TM_DMA_Request_I2C1_TX,     /*!< I2C1 TX */
+	TM_DMA_Request_I2C1_RX,     /*!< I2C1 RX */
+	TM_DMA_Request_I2C2_TX,     /*!< I2C2 TX */
+	TM_DMA_Request_I2C2_RX,     /*!< I2C2 RX */
+	TM_DMA_Request_I2C3_TX,     /*!< I2C3 TX */
+	TM_DMA_Request_I2C3_RX,     /*!< I2C3 RX */
+	TM_DMA_Request_ADC1,        /*!< ADC1 */
+	TM_DMA_Request_ADC2,        /*!< ADC2 */
+	TM_DMA_Request_ADC3,        /*!< ADC3 */
+	TM_DMA_Request_DAC1,        /*!< DAC channel 1 */
+	TM_DMA_Request_DAC2,        /*!< DAC channel 2 */
+	TM_DMA_Request_SDIO,        /*!< SDIO */
+	TM_DMA_Request_TIM1_UP,     /*!< TIM1 update */
+	TM_DMA_Request_TIM3_UP,     /*!< TIM3 update */
+	TM_DMA_Request_TIM4_UP,     /*!< TIM4 update */
+	TM_DMA_Request_TIM8_UP,     /*!< TIM8 update */
+	TM_DMA_Request_TIM1_CH1,    /*!< TIM1 channel 1 */
+	TM_DMA_Request_TIM1_CH2,    /*!< TIM1 channel 2 */
+	TM_DMA_Request_TIM1_CH3,    /*!< TIM1 channel 3 */
+	TM_DMA_Request_TIM1_CH4,    /*!< TIM1 channel 4 */
+	TM_DMA_Request_TIM2_CH1,    /*!< TIM2 channel 1 */
+	TM_DMA_Request_TIM2_CH2,    /*!< TIM2 channel 2 */
+	TM_DMA_Request_TIM2_CH3,    /*!< TIM2 channel 3 */
+	TM_DMA_Request_TIM2_CH4,    /*!< TIM2 channel 4 */
+	TM_DMA_Request_TIM3_CH1,    /*!< TIM3 channel 1 */
+	TM_DMA_Request_TIM3_CH2,    /*!< TIM3 channel 2 */
+	TM_DMA_Request_TIM3_CH3,    /*!< TIM3 channel 3 */
+	TM_DMA_Request_TIM3_CH4,    /*!< TIM3 channel 4 */
+	TM_DMA_Request_TIM4_CH1,    /*!< TIM4 channel 1 */
+	TM_DMA_Request_TIM4_CH2,    /*!< TIM4 channel 2 */
+	TM_DMA_Request_TIM4_CH3,    /*!< TIM4 channel 3 */
+	TM_DMA_Request_TIM5_CH1,    /*!< TIM5 channel 1 */
+	TM_DMA_Request_TIM5_CH2,    /*!< TIM5 channel 2 */
+	TM_DMA_Request_TIM5_CH3,    /*!< TIM5 channel 3 */
+	TM_DMA_Request_TIM5_CH4,    /*!< TIM5 channel 4 */
+	TM_DMA_Request_TIM8_CH1,    /*!< TIM8 channel 1 */
+	TM_DMA_Request_TIM8_CH2,    /*!< TIM8 channel 2 */
+	TM_DMA_Request_TIM8_CH3,    /*!< TIM8 channel 3 */
+	TM_DMA_Request_TIM8_CH4,    /*!< TIM8 channel 4 */
+	TM_DMA_Request_DCMI,        /*!< DCMI */
+	TM_DMA_Request_User         /*!< User owned stream, for streams claimed by user code. Can be used as User + x for more owners */
+} TM_DMA_Request_t;
+
+/**
+ * @brief  Stream priority levels for stream registry
+ */
+typedef enum {
+	TM_DMA_Priority_Default = 0x00, /*!< Use priority set by library which initializes stream */
+	TM_DMA_Priority_Low,            /*!< Low priority */
+	TM_DMA_Priority_Medium,         /*!< Medium priority */
+	TM_DMA_Priority_High,           /*!< High priority */
+	TM_DMA_Priority_VeryHigh        /*!< Very high priority */
+} TM_DMA_Priority_t;
+
 /**
  * @}
  */
@@ -172,6 +451,71 @@ void TM_DMA_DeInit(DMA_Stream_TypeDef* Stream);
  */
 void TM_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t Source, uint32_t Destination, uint16_t Length);
 
+/**
+ * @brief  Starts DMA transmission in double buffer mode
+ * @note   Stream must be initialized with @ref TM_DMA_Init() before. Memory to memory mode is not supported
+ * @param  *HDMA: Pointer to @ref DMA_HandleTypeDef structure with settings
+ * @param  Source: Source address from where data will be sent
+ * @param  Destination: Destination address where data will be sent
+ * @param  SecondMemory: Second memory buffer address, used as second source for memory to peripheral or second destination for peripheral to memory
+ * @param  Length: Number of items in each buffer
+ * @param  Callback: Callback function called when one buffer is finished. Set to NULL if not used.
+ *            When set, stream interrupts are enabled with @ref TM_DMA_EnableInterrupts()
+ * @param  *Param: Pointer to parameter passed to callback function
+ * @retval Start status:
+ *            - 0: Transfer not started
+ *            - > 0: Transfer started
+ */
+uint8_t TM_DMA_StartDoubleBuffer(DMA_HandleTypeDef* hdma, uint32_t Source, uint32_t Destination, uint32_t SecondMemory, uint16_t Length, TM_DMA_DoubleBufferCallback_t Callback, void* Param);
+
+/**
+ * @brief  Sets memory address for double buffer mode
+ * @note   Only memory buffer which is not currently used by DMA can be changed
+ * @param  *DMA_Stream: Pointer to DMA stream
+ * @param  Memory: Memory buffer to change, 0 for M0AR or 1 for M1AR
+ * @param  Address: New memory address
+ * @retval Status:
+ *            - 0: Memory is used by DMA, address was not changed
+ *            - > 0: Address changed
+ */
+uint8_t TM_DMA_SetMemoryAddress(DMA_Stream_TypeDef* DMA_Stream, uint8_t Memory, uint32_t Address);
+
+/**
+ * @brief  Starts chained DMA transfer from list of descriptors
+ * @note   Stream must be initialized with @ref TM_DMA_Init() in normal mode before. Stream interrupts are enabled
+ *         with @ref TM_DMA_EnableInterrupts() as next part is started from transfer complete interrupt.
+ *         Descriptors must stay valid until transfer is finished
+ * @param  *HDMA: Pointer to @ref DMA_HandleTypeDef structure with settings
+ * @param  *Descriptors: Pointer to array of @ref TM_DMA_Descriptor_t descriptors
+ * @param  Count: Number of descriptors in array
+ * @retval Start status:
+ *            - 0: Transfer not started
+ *            - > 0: Transfer started
+ */
+uint8_t TM_DMA_StartChain(DMA_HandleTypeDef* hdma, const TM_DMA_Descriptor_t* Descriptors, uint16_t Count);
+
+/**
+ * @brief  Starts DMA transfer longer than 65535 items
+ * @note   Transfer is split to parts of max 65535 items, see @ref TM_DMA_StartChain()
+ * @param  *HDMA: Pointer to @ref DMA_HandleTypeDef structure with settings
+ * @param  Source: Source address from where data will be sent
+ * @param  Destination: Destination address where data will be sent
+ * @param  Length: Number of items to transfer
+ * @retval Start status:
+ *            - 0: Transfer not started
+ *            - > 0: Transfer started
+ */
+uint8_t TM_DMA_StartLong(DMA_HandleTypeDef* hdma, uint32_t Source, uint32_t Destination, uint32_t Length);
+
+/**
+ * @brief  Checks if chained transfer is in progress on stream
+ * @param  *DMA_Stream: Pointer to DMA stream
+ * @retval Chain status:
+ *            - 0: No chained transfer in progress
+ *            - > 0: Chained transfer in progress
+ */
+uint8_t TM_DMA_ChainActive(DMA_Stream_TypeDef* DMA_Stream);
+
 /**
  * @brief  Clears all flags for selected DMA stream
  * @param  *DMA_Stream: Pointer to @ref DMA_Stream_TypeDef DMA stream where you want to clear flags 
@@ -209,6 +553,110 @@ void TM_DMA_EnableInterrupts(DMA_Stream_TypeDef* DMA_Stream);
  */
 void TM_DMA_DisableInterrupts(DMA_Stream_TypeDef* DMA_Stream);
 
+/**
+ * @brief  Sets library callback for DMA stream
+ * @note   Callback is called from stream interrupt before user callbacks, so other TM libraries
+ *         (for example USART RX DMA) can handle their streams without taking user callback functions.
+ *         Interrupts for stream must be enabled with @ref TM_DMA_EnableInterrupts() function.
+ * @param  *DMA_Stream: Pointer to DMA stream to set callback for
+ * @param  Callback: Callback function. Set to NULL to remove callback from stream
+ * @param  *Param: Pointer to parameter passed to callback function
+ * @retval None
+ */
+void TM_DMA_SetStreamCallback(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_StreamCallback_t Callback, void* Param);
+
+/**
+ * @brief  Claims DMA stream for peripheral request
+ * @note   When stream is already claimed by other request, @ref TM_DMA_ConflictCallback() is called
+ * @param  *DMA_Stream: Pointer to DMA stream to claim
+ * @param  Request: Request which will own stream. This parameter can be a value of @ref TM_DMA_Request_t enumeration
+ * @param  Priority: Stream priority. When @ref TM_DMA_Priority_Default is used, priority set on previous claim is kept.
+ *            This parameter can be a value of @ref TM_DMA_Priority_t enumeration
+ * @retval Claim status:
+ *            - 0: Stream is owned by other request
+ *            - > 0: Stream claimed or already owned by this request
+ */
+uint8_t TM_DMA_Claim(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request, TM_DMA_Priority_t Priority);
+
+/**
+ * @brief  Releases claimed DMA stream
+ * @param  *DMA_Stream: Pointer to DMA stream to release
+ * @param  Request: Request which owns stream. Stream is released only if it is owned by this request
+ * @retval None
+ */
+void TM_DMA_Release(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request);
+
+/**
+ * @brief  Gets current owner of DMA stream
+ * @param  *DMA_Stream: Pointer to DMA stream
+ * @retval Request which owns stream or @ref TM_DMA_Request_None when stream is free
+ */
+TM_DMA_Request_t TM_DMA_GetOwner(DMA_Stream_TypeDef* DMA_Stream);
+
+/**
+ * @brief  Allocates DMA stream and channel for peripheral request
+ * @note   Preferred stream is claimed first. When it is used by other request,
+ *         first free stream which can serve request is selected from library table
+ * @param  Request: Peripheral request. This parameter can be a value of @ref TM_DMA_Request_t enumeration
+ * @param  Priority: Stream priority. This parameter can be a value of @ref TM_DMA_Priority_t enumeration
+ * @param  *DMA_Stream: Preferred DMA stream. Set to NULL to select stream from table only
+ * @param  *Channel: Pointer to preferred channel for preferred stream. Selected channel is written here
+ * @retval Pointer to allocated DMA stream or NULL when no stream is available for request
+ */
+DMA_Stream_TypeDef* TM_DMA_Allocate(TM_DMA_Request_t Request, TM_DMA_Priority_t Priority, DMA_Stream_TypeDef* DMA_Stream, uint32_t* Channel);
+
+/**
+ * @brief  Cleans data cache for memory, so DMA can read data written by CPU
+ * @note   Function does nothing on devices without data cache, when cache is disabled
+ *         or when memory is not cacheable
+ * @param  *Address: Pointer to memory start
+ * @param  Size: Number of bytes to clean
+ * @retval None
+ */
+void TM_DMA_CleanCache(const void* Address, uint32_t Size);
+
+/**
+ * @brief  Invalidates data cache for memory, so CPU can read data written by DMA
+ * @note   Cache lines which are only partially covered by memory are cleaned before invalidation
+ *         to protect other variables in the same cache line
+ * @param  *Address: Pointer to memory start
+ * @param  Size: Number of bytes to invalidate
+ * @retval None
+ */
+void TM_DMA_InvalidateCache(const void* Address, uint32_t Size);
+
+/**
+ * @brief  Invalidates data cache for memory written by last transfer on stream
+ * @note   Use this function when DMA stream is polled without interrupts, after transfer is finished.
+ *         When stream interrupts are enabled, library does this automatically
+ * @param  *DMA_Stream: Pointer to DMA stream
+ * @retval None
+ */
+void TM_DMA_InvalidateStreamCache(DMA_Stream_TypeDef* DMA_Stream);
+
+/**
+ * @brief  Configures memory region as non-cacheable with MPU, for DMA buffers on STM32F7xx devices
+ * @note   Region uses @ref DMA_MPU_REGION_NUMBER. Library does not do cache maintenance for memory inside this region
+ * @param  Address: Region start address. Must be aligned to region size
+ * @param  Size: Region size in units of bytes. Must be power of 2 and at least 32 bytes
+ * @retval Configuration status:
+ *            - 0: Region was not configured, wrong parameters or device without MPU and data cache
+ *            - > 0: Region configured
+ */
+uint8_t TM_DMA_ConfigNonCacheableRegion(uint32_t Address, uint32_t Size);
+
+/**
+ * @brief  Stream conflict callback
+ * @note   This function is called when stream can not be claimed because it is owned by other request,
+ *         or when no stream is available for request on @ref TM_DMA_Allocate() call
+ * @param  *DMA_Stream: Pointer to DMA stream which was requested, can be NULL
+ * @param  Request: Request which wanted stream
+ * @param  Owner: Current owner of requested stream
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_DMA_ConflictCallback(DMA_Stream_TypeDef* DMA_Stream, TM_DMA_Request_t Request, TM_DMA_Request_t Owner);
+
 /**
  * @brief  Transfer complete callback
  * @note   This function is called when interrupt for specific stream happens for transfer complete
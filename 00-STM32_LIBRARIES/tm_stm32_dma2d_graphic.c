@@ -30,14 +30,28 @@
 
 /* Color used for transfer in ARGB8888 format */
 uint32_t DMA2D_Color = 0x00FF0000;
+/* Color used for transfer in RGB565 format */
+uint32_t DMA2D_Color565;
 uint32_t DMA2D_Width;
 uint32_t DMA2D_Height;
 uint32_t DMA2D_StartAddress;
 
+/* Foreground PFC control settings */
+#define DMA2D_GRAPHIC_FGPFCCR_ALPHA(a)     ((a) == 0xFF ? 0 : (((uint32_t)(a) << 24) | (2UL << 16))) /* Multiply pixel alpha with global alpha */
+#define DMA2D_GRAPHIC_FGPFCCR_CLUT(size)   ((((uint32_t)(size) - 1) << 8) | DMA2D_FGPFCCR_START)     /* ARGB8888 CLUT, loaded before transfer */
+
+/* Bits per pixel for input color mode */
+#define DMA2D_GRAPHIC_BITS_PER_PIXEL(mode) (                                   \
+	(mode) == CM_ARGB8888 ? 32 : (mode) == CM_RGB888 ? 24 :                    \
+	((mode) == CM_L8 || (mode) == CM_AL44 || (mode) == CM_A8) ? 8 :            \
+	((mode) == CM_L4 || (mode) == CM_A4) ? 4 : 16                              \
+)
+
 /* Convert function */
 static void DMA2D_Convert565ToARGB8888(uint16_t color) {
 	/* Input color: RRRRR GGGGGG BBBBB */
 	/* Output color: RRRRR000 GGGGGG00 BBBBB000 */
+	DMA2D_Color565 = color;
 	DMA2D_Color = 0;
 	
 	DMA2D_Color |= (color & 0xF800) << 8;
@@ -59,22 +73,90 @@ typedef struct {
 	uint8_t Initialized;
 	uint8_t Orientation;
 	uint8_t PixelSize;
+	int32_t Origin;      /* Pixel index of logical pixel 0, 0 in memory */
+	int32_t StepX;       /* Pixel index step for one logical pixel in X direction */
+	int32_t StepY;       /* Pixel index step for one logical pixel in Y direction */
+	uint8_t FlipX;       /* Logical X axis goes to lower addresses */
+	uint8_t FlipY;       /* Logical Y axis goes to lower addresses */
+	uint8_t Swap;        /* Logical X axis is memory column */
 } TM_INT_DMA2D_t;
 
+/* Axis mapping for each orientation */
+static const struct {
+	uint8_t FlipX;
+	uint8_t FlipY;
+	uint8_t Swap;
+} DMA2D_Orientations[4] = {
+	{1, 1, 0},           /* 0: 180 */
+	{0, 0, 0},           /* 1: Normal */
+	{1, 0, 1},           /* 2: 270 */
+	{0, 1, 1}            /* 3: 90 */
+};
+
+/* Pixel index in layer memory and memory address of logical pixel */
+#define DMA2D_GRAPHIC_INDEX(x, y)          (DIS.Origin + (int32_t)(x) * DIS.StepX + (int32_t)(y) * DIS.StepY)
+#define DMA2D_GRAPHIC_ADDRESS(x, y)        (DIS.StartAddress + DIS.Offset + DIS.PixelSize * DMA2D_GRAPHIC_INDEX(x, y))
+
+/* DMA2D command, register values for one transfer */
+typedef struct {
+	uint32_t CR;
+	uint32_t FGMAR;
+	uint32_t FGOR;
+	uint32_t FGPFCCR;
+	uint32_t FGCOLR;
+	uint32_t FGCMAR;
+	uint32_t BGMAR;
+	uint32_t BGOR;
+	uint32_t BGPFCCR;
+	uint32_t OCOLR;
+	uint32_t OMAR;
+	uint32_t OOR;
+	uint32_t OPFCCR;
+	uint32_t NLR;
+} TM_INT_DMA2D_Command_t;
+
 /* Private structures */
-static DMA2D_HandleTypeDef DMA2DHandle;
 //static DMA2D_FG_InitTypeDef GRAPHIC_DMA2D_FG_InitStruct;
 volatile TM_INT_DMA2D_t DIS;
 
-__STATIC_INLINE void DrawPixel(uint16_t x, uint16_t y, uint32_t color) {
-	TM_DMA2DGRAPHIC_DrawHorizontalLine(x, y, 1, color);
-}
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+/* Command queue, started from DMA2D interrupt */
+static TM_INT_DMA2D_Command_t DMA2D_Queue[DMA2D_GRAPHIC_QUEUE_SIZE];
+static volatile uint16_t DMA2D_QueueIn, DMA2D_QueueOut, DMA2D_QueueCount;
+static volatile uint8_t DMA2D_Running;
+static volatile uint32_t DMA2D_Submitted, DMA2D_Completed;
+#endif
 
 /* Private functions */
+static void TM_INT_DMA2DGRAPHIC_Start(const TM_INT_DMA2D_Command_t* Cmd);
+static void TM_INT_DMA2DGRAPHIC_Submit(const TM_INT_DMA2D_Command_t* Cmd, uint8_t wait);
+static uint8_t TM_INT_DMA2DGRAPHIC_Blend(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void* pSrc, uint32_t ColorMode, uint32_t FGPFCCR, uint32_t FGCOLR, const uint32_t* pCLUT);
 void TM_INT_DMA2DGRAPHIC_InitAndTransfer(void);
 void TM_INT_DMA2DGRAPHIC_SetMemory(uint32_t MemoryAddress, uint32_t Offset, uint32_t NumberOfLine, uint32_t PixelPerLine);
 void TM_INT_DMA2DGRAPHIC_DrawCircleCorner(int16_t x0, int16_t y0, int16_t r, uint8_t corner, uint32_t color);
-void TM_INT_DMA2DGRAPHIC_DrawFilledCircleCorner(int16_t x0, int16_t y0, int16_t r, uint8_t corner, uint32_t color);
+static void TM_INT_DMA2DGRAPHIC_Span(int32_t x, int32_t y, int32_t length, uint32_t color);
+static void TM_INT_DMA2DGRAPHIC_SpanFP(int32_t y, int32_t x1, int32_t x2, uint32_t color);
+#if DMA2D_GRAPHIC_ANTIALIAS
+static void TM_INT_DMA2DGRAPHIC_BlendPixel(int32_t x, int32_t y, uint32_t color, uint8_t alpha);
+#endif
+static int32_t TM_INT_DMA2DGRAPHIC_CircleHalfWidth(int32_t r, int32_t dy);
+static volatile TM_DMA2DGRAPHIC_Pixel_t* TM_INT_DMA2DGRAPHIC_PixelAddress(int32_t* stepx, int32_t* stepy);
+static uint8_t TM_INT_DMA2DGRAPHIC_ClipCode(int32_t x, int32_t y);
+static uint8_t TM_INT_DMA2DGRAPHIC_ClipLine(int32_t* x1, int32_t* y1, int32_t* x2, int32_t* y2);
+static void TM_INT_DMA2DGRAPHIC_FillRect(int32_t x, int32_t y, int32_t width, int32_t height);
+
+/* Writes pixel directly to frame buffer if it is inside LCD */
+#define DMA2D_GRAPHIC_PLOT(ptr, x, y, stepx, stepy, w, h, color)    do {   \
+	if ((uint32_t)(x) < (uint32_t)(w) && (uint32_t)(y) < (uint32_t)(h)) {    \
+		(ptr)[(x) * (stepx) + (y) * (stepy)] = (color);                      \
+	}                                                                        \
+} while (0)
+
+/* Clipping region codes */
+#define DMA2D_GRAPHIC_CLIP_LEFT     0x01
+#define DMA2D_GRAPHIC_CLIP_RIGHT    0x02
+#define DMA2D_GRAPHIC_CLIP_TOP      0x04
+#define DMA2D_GRAPHIC_CLIP_BOTTOM   0x08
 
 void TM_DMA2DGRAPHIC_Init(void) {
 	/* Internal settings */
@@ -86,16 +168,27 @@ void TM_DMA2DGRAPHIC_Init(void) {
 	DIS.CurrentHeight = DMA2D_GRAPHIC_LCD_WIDTH;
 	DIS.CurrentWidth = DMA2D_GRAPHIC_LCD_HEIGHT;
 	DIS.Orientation = 0;
-	DIS.PixelSize = 2;
+	DIS.PixelSize = DMA2D_GRAPHIC_PIXEL_SIZE;
 	DIS.LayerOffset = DMA2D_GRAPHIC_LCD_WIDTH * DMA2D_GRAPHIC_LCD_HEIGHT * DIS.PixelSize;
 	DIS.LayerNumber = 0;
 	
-	/* Set DMA2D instance value */
-	DMA2DHandle.Instance = DMA2D;
+	/* Address tables for orientation */
+	TM_DMA2DGRAPHIC_SetOrientation(DIS.Orientation);
 	
 	/* Enable DMA2D clock */
 	__HAL_RCC_DMA2D_CLK_ENABLE();
 	
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Empty queue */
+	DMA2D_QueueIn = DMA2D_QueueOut = DMA2D_QueueCount = 0;
+	DMA2D_Running = 0;
+	DMA2D_Submitted = DMA2D_Completed = 0;
+	
+	/* Enable DMA2D interrupt for queue processing */
+	HAL_NVIC_SetPriority(DMA2D_IRQn, DMA2D_GRAPHIC_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(DMA2D_IRQn);
+#endif
+	
 	/* Initialized */
 	DIS.Initialized = 1;
 }
@@ -107,28 +200,23 @@ void TM_DMA2DGRAPHIC_SetLayer(uint8_t layer_number) {
 }
 
 void TM_DMA2DGRAPHIC_DrawPixel(uint16_t x, uint16_t y, uint32_t color) {
-	if (DIS.Orientation == 1) { /* Normal */
-		*(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * (y * DIS.Width + x)) = color;
-	} else if (DIS.Orientation == 0) { /* 180 */
-		*(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * ((DIS.Height - y - 1) * DIS.Width + (DIS.Width - x - 1))) = color;
-	} else if (DIS.Orientation == 3) { /* 90 */ /* x + width * y */
-		*(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * ((x) * DIS.Width + DIS.Width - y - 1)) = color;
-	} else if (DIS.Orientation == 2) { /* 270 */
-		*(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * ((DIS.Height - x - 1) * DIS.Width + y)) = color;
-	}
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Queued transfers must write memory before CPU does */
+	TM_DMA2DGRAPHIC_WaitIdle();
+#endif
+	
+	/* Address from orientation table */
+	*(__IO TM_DMA2DGRAPHIC_Pixel_t *) DMA2D_GRAPHIC_ADDRESS(x, y) = color;
 }
 
 uint32_t TM_DMA2DGRAPHIC_GetPixel(uint16_t x, uint16_t y) {
-	if (DIS.Orientation == 1) { /* Normal */
-		return *(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * (y * DIS.Width + x));
-	} else if (DIS.Orientation == 0) { /* 180 */
-		return *(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * ((DIS.Height - y - 1) * DIS.Width + (DIS.Width - x - 1)));
-	} else if (DIS.Orientation == 3) { /* 90 */ /* x + width * y */
-		return *(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * ((x) * DIS.Width + DIS.Width - y - 1));
-	} else if (DIS.Orientation == 2) { /* 270 */
-		return *(__IO uint16_t *) (DIS.StartAddress + DIS.Offset + DIS.PixelSize * ((DIS.Height - x - 1) * DIS.Width + y));
-	}
-	return 0;
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Queued transfers must write memory before CPU reads it */
+	TM_DMA2DGRAPHIC_WaitIdle();
+#endif
+	
+	/* Address from orientation table */
+	return *(__IO TM_DMA2DGRAPHIC_Pixel_t *) DMA2D_GRAPHIC_ADDRESS(x, y);
 }
 
 void TM_DMA2DGRAPHIC_SetOrientation(uint8_t orientation) {
@@ -150,25 +238,43 @@ void TM_DMA2DGRAPHIC_SetOrientation(uint8_t orientation) {
 		DIS.CurrentHeight = DIS.Width;
 		DIS.CurrentWidth = DIS.Height;
 	}
+	
+	/* Axis mapping */
+	DIS.FlipX = DMA2D_Orientations[orientation].FlipX;
+	DIS.FlipY = DMA2D_Orientations[orientation].FlipY;
+	DIS.Swap = DMA2D_Orientations[orientation].Swap;
+	
+	/* Steps in memory, row of LCD memory has DIS.Width pixels */
+	DIS.StepX = DIS.Swap ? DIS.Width : 1;
+	DIS.StepY = DIS.Swap ? 1 : DIS.Width;
+	if (DIS.FlipX) {
+		DIS.StepX = -DIS.StepX;
+	}
+	if (DIS.FlipY) {
+		DIS.StepY = -DIS.StepY;
+	}
+	
+	/* Logical pixel 0, 0 is at the end of flipped axis */
+	DIS.Origin = 0;
+	if (DIS.FlipX) {
+		DIS.Origin -= (DIS.CurrentWidth - 1) * DIS.StepX;
+	}
+	if (DIS.FlipY) {
+		DIS.Origin -= (DIS.CurrentHeight - 1) * DIS.StepY;
+	}
 }
 
 void TM_DMA2DGRAPHIC_Fill(uint32_t color) {
-	/* Set parameters */
-	DMA2DHandle.Init.Mode = DMA2D_R2M;
-	DMA2DHandle.Init.ColorMode = DMA2D_RGB565;
-	DMA2DHandle.Init.OutputOffset = 0;
-
 	/* Convert color */
 	DMA2D_Convert565ToARGB8888(color);
-
-	/* Init DMA2D and start transfer */
-	if (HAL_DMA2D_Init(&DMA2DHandle) == HAL_OK) {
-		if (HAL_DMA2D_ConfigLayer(&DMA2DHandle, DIS.LayerNumber) == HAL_OK) {
-			if (HAL_DMA2D_Start(&DMA2DHandle, DMA2D_Color, (uint32_t)(DIS.StartAddress + DIS.Offset), DIS.Width, DIS.Height) == HAL_OK) {        
-				HAL_DMA2D_PollForTransfer(&DMA2DHandle, 20);
-			}
-		}
-	}
+	
+	/* Set memory settings, entire layer */
+	DMA2D_StartAddress = DIS.StartAddress + DIS.Offset;
+	DMA2D_Width = DIS.Width;
+	DMA2D_Height = DIS.Height;
+	
+	/* Start transfer */
+	TM_INT_DMA2DGRAPHIC_InitAndTransfer();
 }
 
 void TM_DMA2DGRAPHIC_DrawFilledRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color) {
@@ -198,22 +304,8 @@ void TM_DMA2DGRAPHIC_DrawFilledRectangle(uint16_t x, uint16_t y, uint16_t width,
 	/* Convert color */
 	DMA2D_Convert565ToARGB8888(color);
 	
-	/* Set memory settings */
-	if (DIS.Orientation == 1) { /* Normal */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (y * DIS.Width + x), DIS.Width - width, height, width);
-	} 
-	if (DIS.Orientation == 0) { /* 180 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * ((DIS.Height - height - y) * DIS.Width + DIS.Width - x - width), DIS.Width - width, height, width);
-	} 
-	if (DIS.Orientation == 3) { /* 90 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (DIS.Width - y - height + DIS.Width * x), DIS.Width - height, width, height);
-	} 
-	if (DIS.Orientation == 2) { /* 270 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (x + DIS.Width * (DIS.Height - width - x)), DIS.Width - height, width, height);
-	}
-	
-	/* Start transfer and wait till done */
-	TM_INT_DMA2DGRAPHIC_InitAndTransfer();
+	/* Fill rectangle in memory */
+	TM_INT_DMA2DGRAPHIC_FillRect(x, y, width, height);
 }
 
 void TM_DMA2DGRAPHIC_DrawRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color) {
@@ -270,8 +362,10 @@ void TM_DMA2DGRAPHIC_DrawRoundedRectangle(uint16_t x, uint16_t y, uint16_t width
 }
 
 void TM_DMA2DGRAPHIC_DrawFilledRoundedRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t r, uint32_t color) {
+	int32_t dy, hw;
+	
 	/* Check input parameters */
-	if (width == 0 || width == 0) {
+	if (width == 0 || height == 0) {
 		return;
 	}
 	
@@ -295,16 +389,15 @@ void TM_DMA2DGRAPHIC_DrawFilledRoundedRectangle(uint16_t x, uint16_t y, uint16_t
 		return;
 	}
 	
-	/* Draw rectangles */
-	TM_DMA2DGRAPHIC_DrawFilledRectangle(x + r, y, width - 2 * r, height, color);
-	TM_DMA2DGRAPHIC_DrawFilledRectangle(x, y + r, r, height - 2 * r, color);
-	TM_DMA2DGRAPHIC_DrawFilledRectangle(x + width - r, y + r, r, height - 2 * r, color);
+	/* Draw middle part with one transfer */
+	TM_DMA2DGRAPHIC_DrawFilledRectangle(x, y + r, width, height - 2 * r, color);
 	
-	/* Draw corners */
-	TM_INT_DMA2DGRAPHIC_DrawFilledCircleCorner(x + r, y + r, r, 0x01, color); /* Top left */
-	TM_INT_DMA2DGRAPHIC_DrawFilledCircleCorner(x + width - r - 1, y + r, r, 0x02, color); /* Top right */
-	TM_INT_DMA2DGRAPHIC_DrawFilledCircleCorner(x + width - r - 1, y + height - r - 1, r, 0x04, color); /* Bottom right */
-	TM_INT_DMA2DGRAPHIC_DrawFilledCircleCorner(x + r, y + height - r - 1, r, 0x08, color); /* Bottom left */
+	/* Draw top and bottom rows with rounded corners */
+	for (dy = 1; dy <= r; dy++) {
+		hw = TM_INT_DMA2DGRAPHIC_CircleHalfWidth(r, dy);
+		TM_INT_DMA2DGRAPHIC_SpanFP(y + r - dy, (x + r) * 65536 - hw, (x + width - r - 1) * 65536 + hw, color);
+		TM_INT_DMA2DGRAPHIC_SpanFP(y + height - r - 1 + dy, (x + r) * 65536 - hw, (x + width - r - 1) * 65536 + hw, color);
+	}
 }
 
 void TM_DMA2DGRAPHIC_DrawVerticalLine(int16_t x, int16_t y, uint16_t length, uint32_t color) {
@@ -338,22 +431,8 @@ void TM_DMA2DGRAPHIC_DrawVerticalLine(int16_t x, int16_t y, uint16_t length, uin
 	/* Set color */
 	DMA2D_Convert565ToARGB8888(color);
 	
-	/* Set memory settings */
-	if (DIS.Orientation == 1) { /* Normal */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (y * DIS.Width + x), DIS.Width - 1, length, 1);
-	} 
-	if (DIS.Orientation == 0) { /* 180 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * ((DIS.Height - length - y) * DIS.Width + DIS.Width - x - 1), DIS.Width - 1, length, 1);
-	} 
-	if (DIS.Orientation == 3) { /* 90 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (DIS.Width - y - length + DIS.Width * x), DIS.Width - length, 1, length);
-	} 
-	if (DIS.Orientation == 2) { /* 270 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (y + DIS.Width * (DIS.Height - 1 - x)), DIS.Width - length, 1, length);
-	}
-	
-	/* Start transfer and wait till done */
-	TM_INT_DMA2DGRAPHIC_InitAndTransfer();
+	/* Fill 1 pixel wide rectangle */
+	TM_INT_DMA2DGRAPHIC_FillRect(x, y, 1, length);
 }
 
 void TM_DMA2DGRAPHIC_DrawHorizontalLine(int16_t x, int16_t y, uint16_t length, uint32_t color) {
@@ -388,76 +467,79 @@ void TM_DMA2DGRAPHIC_DrawHorizontalLine(int16_t x, int16_t y, uint16_t length, u
 	/* Set color */
 	DMA2D_Convert565ToARGB8888(color);
 	
-	/* Set memory settings */
-	if (DIS.Orientation == 1) { /* Normal */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (y * DIS.Width + x), DIS.Width - length, 1, length);
-	} 
-	if (DIS.Orientation == 0) { /* 180 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * ((DIS.Height - 1 - y) * DIS.Width + DIS.Width - x - length), DIS.Width - length, 1, length);
-	} 
-	if (DIS.Orientation == 3) { /* 90 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (DIS.Width - y - 1 + DIS.Width * x), DIS.Width - 1, length, 1);
-	} 
-	if (DIS.Orientation == 2) { /* 270 */
-		TM_INT_DMA2DGRAPHIC_SetMemory(DIS.PixelSize * (y + DIS.Width * (DIS.Height - length - x)), DIS.Width - 1, length, 1);
-	}
-	
-	/* Start transfer and wait till done */
-	TM_INT_DMA2DGRAPHIC_InitAndTransfer();
+	/* Fill 1 pixel high rectangle */
+	TM_INT_DMA2DGRAPHIC_FillRect(x, y, length, 1);
 }
 
 void TM_DMA2DGRAPHIC_DrawLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint32_t color) {
-	int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0, 
-	yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0, 
-	curpixel = 0;
-
-	deltax = ABS(x2 - x1);
-	deltay = ABS(y2 - y1);
-	x = x1;
-	y = y1;
-	
-	if (x2 >= x1) {
-		xinc1 = 1;
-		xinc2 = 1;
-	} else {
-		xinc1 = -1;
-		xinc2 = -1;
+	int32_t X1 = x1, Y1 = y1, X2 = x2, Y2 = y2;
+	int32_t dx, dy, stepx, stepy, major, minor, n, d, err, i;
+	volatile TM_DMA2DGRAPHIC_Pixel_t* ptr;
+	
+	/* Check if initialized */
+	if (DIS.Initialized != 1) {
+		return;
 	}
-
-	if (y2 >= y1) {
-		yinc1 = 1;
-		yinc2 = 1;
-	} else {
-		yinc1 = -1;
-		yinc2 = -1;
+	
+	/* Clip once, nothing to draw if line is outside LCD */
+	if (!TM_INT_DMA2DGRAPHIC_ClipLine(&X1, &Y1, &X2, &Y2)) {
+		return;
 	}
-
-	if (deltax >= deltay) {
-		xinc1 = 0;
-		yinc2 = 0;
-		den = deltax;
-		num = deltax / 2;
-		numadd = deltay;
-		numpixels = deltax;
+	
+	/* Horizontal and vertical lines with DMA2D */
+	if (Y1 == Y2) {
+		TM_DMA2DGRAPHIC_DrawHorizontalLine(X1 < X2 ? X1 : X2, Y1, ABS(X2 - X1) + 1, color);
+		return;
+	}
+	if (X1 == X2) {
+		TM_DMA2DGRAPHIC_DrawVerticalLine(X1, Y1 < Y2 ? Y1 : Y2, ABS(Y2 - Y1) + 1, color);
+		return;
+	}
+	
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Queued transfers must write memory before CPU does */
+	TM_DMA2DGRAPHIC_WaitIdle();
+#endif
+	
+	/* Address of first pixel and address steps for orientation */
+	ptr = TM_INT_DMA2DGRAPHIC_PixelAddress(&stepx, &stepy);
+	ptr += X1 * stepx + Y1 * stepy;
+	
+	/* Direction */
+	dx = X2 - X1;
+	dy = Y2 - Y1;
+	if (dx < 0) {
+		dx = -dx;
+		stepx = -stepx;
+	}
+	if (dy < 0) {
+		dy = -dy;
+		stepy = -stepy;
+	}
+	
+	/* Step along major axis every pixel, along minor axis when error overflows */
+	if (dx >= dy) {
+		major = stepx;
+		minor = stepy;
+		n = dx;
+		d = dy;
 	} else {
-		xinc2 = 0;
-		yinc1 = 0;
-		den = deltay;
-		num = deltay / 2;
-		numadd = deltax;
-		numpixels = deltay;
-	}
-
-	for (curpixel = 0; curpixel <= numpixels; curpixel++) {
-		DrawPixel(x, y, color);
-		num += numadd;
-		if (num >= den) {
-			num -= den;
-			x += xinc1;
-			y += yinc1;
+		major = stepy;
+		minor = stepx;
+		n = dy;
+		d = dx;
+	}
+	
+	/* Draw pixels */
+	err = n / 2;
+	for (i = 0; i <= n; i++) {
+		*ptr = color;
+		ptr += major;
+		err -= d;
+		if (err < 0) {
+			err += n;
+			ptr += minor;
 		}
-		x += xinc2;
-		y += yinc2;
 	}
 }
 
@@ -473,68 +555,80 @@ void TM_DMA2DGRAPHIC_DrawPolyLine(TM_DMA2DRAPHIC_Poly_t* Coordinates, uint16_t c
 }
 
 void TM_DMA2DGRAPHIC_DrawCircle(uint16_t x0, uint16_t y0, uint16_t r, uint32_t color) {
-	int16_t f = 1 - r;
-	int16_t ddF_x = 1;
-	int16_t ddF_y = -2 * r;
-	int16_t x = 0;
-	int16_t y = r;
-
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0, y0 + r, 1, color);
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0, y0 - r, 1, color);
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0 + r, y0, 1, color);
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0 - r, y0, 1, color);
-
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
-        }
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
-
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 + x, y0 + y, 1, color);
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 - x, y0 + y, 1, color);
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 + x, y0 - y, 1, color);
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 - x, y0 - y, 1, color);
-
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 + y, y0 + x, 1, color);
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 - y, y0 + x, 1, color);
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 + y, y0 - x, 1, color);
-        TM_DMA2DGRAPHIC_DrawVerticalLine(x0 - y, y0 - x, 1, color);
-    }
+	int32_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+	int32_t stepx, stepy, W, H;
+	volatile TM_DMA2DGRAPHIC_Pixel_t* ptr;
+	uint8_t inside;
+	
+	/* Check if initialized */
+	if (DIS.Initialized != 1) {
+		return;
+	}
+	
+	/* Clip once, check if circle is completely inside or completely outside */
+	W = DIS.CurrentWidth;
+	H = DIS.CurrentHeight;
+	if ((x0 - r) >= W || (y0 - r) >= H) {
+		return;
+	}
+	inside = (x0 - r) >= 0 && (y0 - r) >= 0 && (x0 + r) < W && (y0 + r) < H;
+	
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Queued transfers must write memory before CPU does */
+	TM_DMA2DGRAPHIC_WaitIdle();
+#endif
+	
+	/* Address of pixel 0, 0 and address steps for orientation */
+	ptr = TM_INT_DMA2DGRAPHIC_PixelAddress(&stepx, &stepy);
+	
+	/* Plot 8 symmetric points, with check only when circle crosses LCD edge */
+	while (1) {
+		if (inside) {
+			volatile TM_DMA2DGRAPHIC_Pixel_t* c = ptr + x0 * stepx + y0 * stepy;
+			int32_t xs = x * stepx, ys = y * stepy, xt = x * stepy, yt = y * stepx;
+			
+			c[ xs + ys] = color;
+			c[-xs + ys] = color;
+			c[ xs - ys] = color;
+			c[-xs - ys] = color;
+			c[ yt + xt] = color;
+			c[-yt + xt] = color;
+			c[ yt - xt] = color;
+			c[-yt - xt] = color;
+		} else {
+			DMA2D_GRAPHIC_PLOT(ptr, x0 + x, y0 + y, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 - x, y0 + y, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 + x, y0 - y, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 - x, y0 - y, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 + y, y0 + x, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 - y, y0 + x, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 + y, y0 - x, stepx, stepy, W, H, color);
+			DMA2D_GRAPHIC_PLOT(ptr, x0 - y, y0 - x, stepx, stepy, W, H, color);
+		}
+		
+		/* Next point */
+		if (x >= y) {
+			break;
+		}
+		if (f >= 0) {
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f += ddF_x;
+	}
 }
 
 void TM_DMA2DGRAPHIC_DrawFilledCircle(uint16_t x0, uint16_t y0, uint16_t r, uint32_t color) {
-	int16_t f = 1 - r;
-	int16_t ddF_x = 1;
-	int16_t ddF_y = -2 * r;
-	int16_t x = 0;
-	int16_t y = r;
-
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0, y0 + r, 1, color);
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0, y0 - r, 1, color);
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0 + r, y0, 1, color);
-    TM_DMA2DGRAPHIC_DrawVerticalLine(x0 - r, y0, 1, color);
-    TM_DMA2DGRAPHIC_DrawHorizontalLine(x0 - r, y0, 2 * r, color);
-
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
-        }
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
-
-        TM_DMA2DGRAPHIC_DrawHorizontalLine(x0 - x, y0 + y, 2 * x, color);
-		TM_DMA2DGRAPHIC_DrawHorizontalLine(x0 - x, y0 - y, 2 * x, color);
-
-        TM_DMA2DGRAPHIC_DrawHorizontalLine(x0 - y, y0 + x, 2 * y, color);
-        TM_DMA2DGRAPHIC_DrawHorizontalLine(x0 - y, y0 - x, 2 * y, color);
-    }
+	int32_t dy, hw;
+	
+	/* Draw one span for each row */
+	for (dy = -r; dy <= r; dy++) {
+		hw = TM_INT_DMA2DGRAPHIC_CircleHalfWidth(r, dy);
+		TM_INT_DMA2DGRAPHIC_SpanFP(y0 + dy, x0 * 65536 - hw, x0 * 65536 + hw, color);
+	}
 }
 
 void TM_DMA2DGRAPHIC_DrawTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint32_t color) {
@@ -546,95 +640,247 @@ void TM_DMA2DGRAPHIC_DrawTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_
 
 
 void TM_DMA2DGRAPHIC_DrawFilledTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint32_t color) {
-	int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0, 
-	yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0, 
-	curpixel = 0;
-
-	deltax = ABS(x2 - x1);
-	deltay = ABS(y2 - y1);
-	x = x1;
-	y = y1;
-
-	if (x2 >= x1) {
-		xinc1 = 1;
-		xinc2 = 1;
-	} else {
-		xinc1 = -1;
-		xinc2 = -1;
+	int32_t ax = x1, ay = y1, bx = x2, by = y2, cx = x3, cy = y3, tmp;
+	int32_t xa, xb, da, db, y;
+	
+	/* Sort points by Y coordinate, A is top, C is bottom */
+	if (ay > by) {
+		tmp = ax; ax = bx; bx = tmp;
+		tmp = ay; ay = by; by = tmp;
 	}
-
-	if (y2 >= y1) {
-		yinc1 = 1;
-		yinc2 = 1;
-	} else {
-		yinc1 = -1;
-		yinc2 = -1;
+	if (by > cy) {
+		tmp = bx; bx = cx; cx = tmp;
+		tmp = by; by = cy; cy = tmp;
+	}
+	if (ay > by) {
+		tmp = ax; ax = bx; bx = tmp;
+		tmp = ay; ay = by; by = tmp;
 	}
+	
+	/* All points in one row */
+	if (ay == cy) {
+		xa = ax < bx ? (ax < cx ? ax : cx) : (bx < cx ? bx : cx);
+		xb = ax > bx ? (ax > cx ? ax : cx) : (bx > cx ? bx : cx);
+		TM_INT_DMA2DGRAPHIC_Span(xa, ay, xb - xa + 1, color);
+		return;
+	}
+	
+	/* Walk long edge A-C, X coordinates in 16.16 fixed point */
+	xa = ax * 65536;
+	da = (cx - ax) * 65536 / (cy - ay);
+	
+	/* Upper part, short edge A-B */
+	if (by > ay) {
+		xb = ax * 65536;
+		db = (bx - ax) * 65536 / (by - ay);
+		for (y = ay; y < by; y++) {
+			TM_INT_DMA2DGRAPHIC_SpanFP(y, xa, xb, color);
+			xa += da;
+			xb += db;
+		}
+	}
+	
+	/* Lower part, short edge B-C */
+	xb = bx * 65536;
+	db = (cy > by) ? (cx - bx) * 65536 / (cy - by) : 0;
+	for (y = by; y <= cy; y++) {
+		TM_INT_DMA2DGRAPHIC_SpanFP(y, xa, xb, color);
+		xa += da;
+		xb += db;
+	}
+}
 
-	if (deltax >= deltay){
-		xinc1 = 0;
-		yinc2 = 0;
-		den = deltax;
-		num = deltax / 2;
-		numadd = deltay;
-		numpixels = deltax;
-	} else {
-		xinc2 = 0;
-		yinc1 = 0;
-		den = deltay;
-		num = deltay / 2;
-		numadd = deltax;
-		numpixels = deltay;
-	}
-
-	for (curpixel = 0; curpixel <= numpixels; curpixel++) {
-		TM_DMA2DGRAPHIC_DrawLine(x, y, x3, y3, color);
-
-		num += numadd;
-		if (num >= den) {
-			num -= den;
-			x += xinc1;
-			y += yinc1;
+void TM_DMA2DGRAPHIC_DrawFilledPolygon(TM_DMA2DRAPHIC_Poly_t* Coordinates, uint16_t count, uint32_t color) {
+	int32_t nodes[DMA2D_GRAPHIC_POLYGON_NODES];
+	int32_t y, ymin, ymax, y1, y2, x, tmp;
+	uint16_t i, j, n;
+	
+	/* Check input */
+	if (count < 3) {
+		return;
+	}
+	
+	/* Find rows of polygon */
+	ymin = ymax = Coordinates[0].Y;
+	for (i = 1; i < count; i++) {
+		if (Coordinates[i].Y < ymin) {
+			ymin = Coordinates[i].Y;
+		}
+		if (Coordinates[i].Y > ymax) {
+			ymax = Coordinates[i].Y;
+		}
+	}
+	
+	/* Clip to LCD */
+	if (ymax >= DIS.CurrentHeight) {
+		ymax = DIS.CurrentHeight - 1;
+	}
+	
+	/* Go through rows */
+	for (y = ymin; y <= ymax; y++) {
+		/* Find edges crossing this row, upper end included and lower end excluded */
+		n = 0;
+		for (i = 0, j = count - 1; i < count; j = i++) {
+			y1 = Coordinates[i].Y;
+			y2 = Coordinates[j].Y;
+			if ((y1 <= y && y2 > y) || (y2 <= y && y1 > y)) {
+				/* X coordinate of crossing in 16.16 fixed point */
+				x = Coordinates[i].X * 65536 + (Coordinates[j].X - Coordinates[i].X) * 65536 / (y2 - y1) * (y - y1);
+				
+				/* Insert sorted */
+				if (n < DMA2D_GRAPHIC_POLYGON_NODES) {
+					for (tmp = n++; tmp > 0 && nodes[tmp - 1] > x; tmp--) {
+						nodes[tmp] = nodes[tmp - 1];
+					}
+					nodes[tmp] = x;
+				}
+			}
+		}
+		
+		/* Fill between pairs of crossings, even-odd rule */
+		for (i = 0; (i + 1) < n; i += 2) {
+			TM_INT_DMA2DGRAPHIC_SpanFP(y, nodes[i], nodes[i + 1], color);
 		}
-		x += xinc2;
-		y += yinc2;
 	}
 }
 
 void TM_DMA2DGRAPHIC_CopyBuffer(void* pSrc, void* pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLineSrc, uint32_t OffLineDst) {
-	/* Copy buffer using interrupt */
-	TM_DMA2DGRAPHIC_CopyBufferIT(pSrc, pDst, xSize, ySize, OffLineSrc, OffLineDst);
+	TM_INT_DMA2D_Command_t Cmd = {0};
+	
+	/* Memory to memory, pixel size is taken from foreground format */
+	Cmd.CR = DMA2D_M2M;
+	Cmd.FGMAR = (uint32_t)pSrc;
+	Cmd.FGOR = OffLineSrc;
+	Cmd.FGPFCCR = DMA2D_GRAPHIC_PIXEL_CM;
+	Cmd.OMAR = (uint32_t)pDst;
+	Cmd.OOR = OffLineDst;
+	Cmd.OPFCCR = CM_RGB565;
+	Cmd.NLR = (uint32_t)(xSize << 16) | (uint16_t)ySize;
+
+	/* Start transfer and wait until transfer is done */
+	TM_INT_DMA2DGRAPHIC_Submit(&Cmd, 1);
+}
 
-	/* Wait until transfer is done */
-	DMA2D_WAIT;
+void TM_DMA2DGRAPHIC_CopyBufferIT(void* pSrc, void* pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLineSrc, uint32_t OffLineDst) {
+	TM_INT_DMA2D_Command_t Cmd = {0};
+	
+	/* Memory to memory, pixel size is taken from foreground format */
+	Cmd.CR = DMA2D_M2M;
+	Cmd.FGMAR = (uint32_t)pSrc;
+	Cmd.FGOR = OffLineSrc;
+	Cmd.FGPFCCR = DMA2D_GRAPHIC_PIXEL_CM;
+	Cmd.OMAR = (uint32_t)pDst;
+	Cmd.OOR = OffLineDst;
+	Cmd.OPFCCR = CM_RGB565;
+	Cmd.NLR = (uint32_t)(xSize << 16) | (uint16_t)ySize;
+
+	/* Start transfer, do not wait */
+	TM_INT_DMA2DGRAPHIC_Submit(&Cmd, 0);
 }
 
+uint8_t TM_DMA2DGRAPHIC_DrawAlphaBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* pAlpha, uint32_t color) {
+	/* Convert color */
+	DMA2D_Convert565ToARGB8888(color);
+	
+	/* Foreground is alpha bitmap with fixed color */
+	return TM_INT_DMA2DGRAPHIC_Blend(x, y, width, height, pAlpha, CM_A8, CM_A8, DMA2D_Color & 0x00FFFFFF, NULL);
+}
 
-void TM_DMA2DGRAPHIC_CopyBufferIT(void* pSrc, void* pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLineSrc, uint32_t OffLineDst) {
-	/* Wait for previous operation to be done */
-	DMA2D_WAIT;
+uint8_t TM_DMA2DGRAPHIC_BlendBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void* pSrc, uint32_t ColorMode, uint8_t Alpha) {
+	/* Check color mode, indexed modes need CLUT */
+	if (ColorMode == CM_L8 || ColorMode == CM_AL44 || ColorMode == CM_AL88 || ColorMode == CM_L4 || ColorMode > CM_A4) {
+		return 0;
+	}
 	
-	/* DeInit DMA2D */
-	RCC->AHB1RSTR |= RCC_AHB1RSTR_DMA2DRST;
-	RCC->AHB1RSTR &= ~RCC_AHB1RSTR_DMA2DRST;
+	/* Pixel alpha is multiplied with global alpha */
+	return TM_INT_DMA2DGRAPHIC_Blend(x, y, width, height, pSrc, ColorMode, ColorMode | DMA2D_GRAPHIC_FGPFCCR_ALPHA(Alpha), 0, NULL);
+}
+
+uint8_t TM_DMA2DGRAPHIC_BlendBitmapCLUT(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void* pSrc, uint32_t ColorMode, const uint32_t* pCLUT, uint16_t CLUTSize, uint8_t Alpha) {
+	uint32_t fgpfccr;
+	
+	/* Check color mode and CLUT size */
+	if (
+		(ColorMode != CM_L8 && ColorMode != CM_AL44 && ColorMode != CM_AL88 && ColorMode != CM_L4) ||
+		CLUTSize == 0 || CLUTSize > 256
+	) {
+		return 0;
+	}
 	
-	DMA2D->CR = 0x00000000UL | (1 << 9);
+	/* Color mode, ARGB8888 CLUT with size, automatic CLUT load before transfer */
+	fgpfccr = ColorMode | DMA2D_GRAPHIC_FGPFCCR_CLUT(CLUTSize) | DMA2D_GRAPHIC_FGPFCCR_ALPHA(Alpha);
 	
-	/* Set up pointers */
-	DMA2D->FGMAR = (uint32_t)pSrc;                       
-	DMA2D->OMAR = (uint32_t)pDst;                       
-	DMA2D->FGOR = OffLineSrc;                      
-	DMA2D->OOR = OffLineDst; 
+	/* Blend */
+	return TM_INT_DMA2DGRAPHIC_Blend(x, y, width, height, pSrc, ColorMode, fgpfccr, 0, pCLUT);
+}
 
-	/* Set up pixel format */  
-	DMA2D->FGPFCCR = LTDC_PIXEL_FORMAT_RGB565;
+uint32_t TM_DMA2DGRAPHIC_InsertFence(void) {
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Fence is number of last submitted command */
+	return DMA2D_Submitted;
+#else
+	/* Transfers are done when functions return */
+	return 0;
+#endif
+}
 
-	/* Set up size */
-	DMA2D->NLR = (uint32_t)(xSize << 16) | (uint16_t)ySize; 
+uint8_t TM_DMA2DGRAPHIC_IsFenceDone(uint32_t fence) {
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Check if all commands up to fence are completed, overflow safe */
+	return (int32_t)(DMA2D_Completed - fence) >= 0;
+#else
+	/* Only transfer started with TM_DMA2DGRAPHIC_CopyBufferIT may be active */
+	return !DMA2D_WORKING;
+#endif
+}
 
-	/* Start DMA2D */
-	DMA2D->CR |= DMA2D_CR_START; 
+void TM_DMA2DGRAPHIC_WaitFence(uint32_t fence) {
+	/* Wait till fence is reached */
+	while (!TM_DMA2DGRAPHIC_IsFenceDone(fence));
+}
+
+void TM_DMA2DGRAPHIC_WaitIdle(void) {
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	/* Wait till queue is empty and last transfer is done */
+	while (DMA2D_Running);
+#else
+	/* Wait till transfer is done */
+	DMA2D_WAIT;
+#endif
+}
+
+volatile TM_DMA2DGRAPHIC_Pixel_t* TM_DMA2DGRAPHIC_GetPixelAddress(int32_t* stepx, int32_t* stepy) {
+	/* Transfers must write memory before CPU does */
+	TM_DMA2DGRAPHIC_WaitIdle();
+	
+	/* Get address and steps */
+	return TM_INT_DMA2DGRAPHIC_PixelAddress(stepx, stepy);
+}
+
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+void DMA2D_IRQHandler(void) {
+	uint32_t isr = DMA2D->ISR;
+	
+	/* Clear flags */
+	DMA2D->IFCR = isr & (DMA2D_IFSR_CTCIF | DMA2D_IFSR_CTEIF | DMA2D_IFSR_CCEIF);
+	
+	/* Transfer finished, OK or with error */
+	if (isr & (DMA2D_ISR_TCIF | DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) {
+		DMA2D_Completed++;
+		
+		/* Start next command */
+		if (DMA2D_QueueCount) {
+			TM_INT_DMA2DGRAPHIC_Start(&DMA2D_Queue[DMA2D_QueueOut]);
+			if (++DMA2D_QueueOut >= DMA2D_GRAPHIC_QUEUE_SIZE) {
+				DMA2D_QueueOut = 0;
+			}
+			DMA2D_QueueCount--;
+		} else {
+			DMA2D_Running = 0;
+		}
+	}
 }
+#endif
 
 /* Private functions */
 void TM_INT_DMA2DGRAPHIC_SetConf(TM_DMA2DGRAPHIC_INT_Conf_t* Conf) {
@@ -653,31 +899,393 @@ void TM_INT_DMA2DGRAPHIC_SetConf(TM_DMA2DGRAPHIC_INT_Conf_t* Conf) {
 	TM_DMA2DGRAPHIC_SetOrientation(DIS.Orientation);
 }
 
-void TM_INT_DMA2DGRAPHIC_InitAndTransfer(void) {
-	/* Wait until transfer is done first from other calls */
-	DMA2D_WAIT;
+static uint8_t TM_INT_DMA2DGRAPHIC_Blend(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void* pSrc, uint32_t ColorMode, uint32_t FGPFCCR, uint32_t FGCOLR, const uint32_t* pCLUT) {
+	TM_INT_DMA2D_Command_t Cmd = {0};
+	uint32_t address;
+	
+	/* Check if initialized, DMA2D can not rotate bitmaps and can not write L8 pixels */
+	if (DIS.Initialized != 1 || DIS.Orientation != 1 || DMA2D_GRAPHIC_L8) {
+		return 0;
+	}
+	
+	/* Bitmap must be entirely on LCD */
+	if (
+		(x + width) > DIS.CurrentWidth ||
+		(y + height) > DIS.CurrentHeight
+	) {
+		return 0;
+	}
+	
+	/* Destination address */
+	address = DIS.StartAddress + DIS.Offset + DIS.PixelSize * (y * DIS.Width + x);
+	
+#if defined(STM32F7xx)
+	/* Data written by CPU must be in memory before DMA2D reads it */
+	SCB_CleanDCache_by_Addr((uint32_t *)((uint32_t)pSrc & ~0x1FUL), (width * height * DMA2D_GRAPHIC_BITS_PER_PIXEL(ColorMode) + 7) / 8 + 32);
+	if (pCLUT) {
+		SCB_CleanDCache_by_Addr((uint32_t *)((uint32_t)pCLUT & ~0x1FUL), 256 * 4 + 32);
+	}
+#endif
+	
+	/* Memory to memory with pixel format conversion and blending */
+	Cmd.CR = DMA2D_M2M_BLEND;
+	
+	/* Foreground is bitmap */
+	Cmd.FGMAR = (uint32_t)pSrc;
+	Cmd.FGOR = 0;
+	Cmd.FGPFCCR = FGPFCCR;
+	Cmd.FGCOLR = FGCOLR;
+	Cmd.FGCMAR = (uint32_t)pCLUT;
+	
+	/* Background and output are LCD memory */
+	Cmd.BGMAR = address;
+	Cmd.BGOR = DIS.Width - width;
+	Cmd.BGPFCCR = CM_RGB565;
+	Cmd.OMAR = address;
+	Cmd.OOR = DIS.Width - width;
+	Cmd.OPFCCR = CM_RGB565;
+	
+	/* Set up size */
+	Cmd.NLR = (uint32_t)(width << 16) | (uint16_t)height;
 	
-	/* Format DMA2D settings */
-	DMA2DHandle.Init.Mode = DMA2D_R2M;
-	DMA2DHandle.Init.ColorMode = DMA2D_RGB565;
-	DMA2DHandle.Init.OutputOffset = DIS.Width - DMA2D_Width;
+	/* Start DMA2D and wait till done */
+	TM_INT_DMA2DGRAPHIC_Submit(&Cmd, 1);
+	
+	/* Bitmap drawn */
+	return 1;
+}
 
-	/* DMA2D Initialization */
-	if (HAL_DMA2D_Init(&DMA2DHandle) == HAL_OK) {
-		if (HAL_DMA2D_ConfigLayer(&DMA2DHandle, 0) == HAL_OK) {
-			if (HAL_DMA2D_Start(&DMA2DHandle, DMA2D_Color, (uint32_t)DMA2D_StartAddress, DMA2D_Width, DMA2D_Height) == HAL_OK) {        
-				HAL_DMA2D_PollForTransfer(&DMA2DHandle, 100);
+static void TM_INT_DMA2DGRAPHIC_Span(int32_t x, int32_t y, int32_t length, uint32_t color) {
+#if DMA2D_GRAPHIC_QUEUE_SIZE == 0 && DMA2D_GRAPHIC_CPU_SPAN_MAX > 0
+	TM_DMA2DGRAPHIC_Pixel_t* ptr;
+	int32_t step;
+#if !DMA2D_GRAPHIC_L8
+	uint32_t color2;
+#endif
+#endif
+	
+	/* Clip to LCD */
+	if (y < 0 || y >= DIS.CurrentHeight) {
+		return;
+	}
+	if (x < 0) {
+		length += x;
+		x = 0;
+	}
+	if ((x + length) > DIS.CurrentWidth) {
+		length = DIS.CurrentWidth - x;
+	}
+	if (length <= 0) {
+		return;
+	}
+	
+#if DMA2D_GRAPHIC_QUEUE_SIZE == 0 && DMA2D_GRAPHIC_CPU_SPAN_MAX > 0
+	/* Short span is faster with CPU than DMA2D setup */
+	if (length <= DMA2D_GRAPHIC_CPU_SPAN_MAX) {
+		/* Lowest address of span */
+		ptr = (TM_DMA2DGRAPHIC_Pixel_t *)DMA2D_GRAPHIC_ADDRESS(x + DIS.FlipX * (length - 1), y);
+		
+		/* Span is memory column in rotated orientations */
+		if (DIS.Swap) {
+			step = DIS.Width;
+			while (length--) {
+				*ptr = color;
+				ptr += step;
 			}
+			return;
+		}
+		
+#if DMA2D_GRAPHIC_L8
+		/* One byte per pixel */
+		while (length--) {
+			*ptr++ = color;
+		}
+#else
+		/* Align to word */
+		if ((uint32_t)ptr & 0x02) {
+			*ptr++ = color;
+			length--;
+		}
+		
+		/* 2 pixels with each store */
+		color2 = (color & 0xFFFF) | (color << 16);
+		while (length >= 2) {
+			*(uint32_t *)ptr = color2;
+			ptr += 2;
+			length -= 2;
+		}
+		
+		/* Last pixel */
+		if (length) {
+			*ptr = color;
 		}
+#endif
+		return;
 	}
+#endif
+	
+	/* Long span with DMA2D */
+	TM_DMA2DGRAPHIC_DrawHorizontalLine(x, y, length, color);
+}
+
+static void TM_INT_DMA2DGRAPHIC_SpanFP(int32_t y, int32_t x1, int32_t x2, uint32_t color) {
+	int32_t tmp;
 	
-	/* Wait till transfer ends */
+	/* Left point first */
+	if (x1 > x2) {
+		tmp = x1;
+		x1 = x2;
+		x2 = tmp;
+	}
+	
+#if DMA2D_GRAPHIC_ANTIALIAS
+	/* Partially covered edge pixels are blended, pixels between are filled */
+	TM_INT_DMA2DGRAPHIC_BlendPixel(x1 >> 16, y, color, 255 - ((x1 & 0xFFFF) >> 8));
+	TM_INT_DMA2DGRAPHIC_Span((x1 >> 16) + 1, y, (x2 >> 16) - (x1 >> 16), color);
+	TM_INT_DMA2DGRAPHIC_BlendPixel((x2 >> 16) + 1, y, color, (x2 & 0xFFFF) >> 8);
+#else
+	/* Round to nearest pixels */
+	x1 = (x1 + 0x8000) >> 16;
+	x2 = (x2 + 0x8000) >> 16;
+	TM_INT_DMA2DGRAPHIC_Span(x1, y, x2 - x1 + 1, color);
+#endif
+}
+
+#if DMA2D_GRAPHIC_ANTIALIAS
+static void TM_INT_DMA2DGRAPHIC_BlendPixel(int32_t x, int32_t y, uint32_t color, uint8_t alpha) {
+	uint32_t fg, bg;
+	
+	/* Check pixel */
+	if (x < 0 || y < 0 || x >= DIS.CurrentWidth || y >= DIS.CurrentHeight || alpha == 0) {
+		return;
+	}
+	
+	/* Fully covered */
+	if (alpha == 255) {
+		TM_DMA2DGRAPHIC_DrawPixel(x, y, color);
+		return;
+	}
+	
+	/* Spread RGB565 components to -GGGGGG-----RRRRR------BBBBB and blend with 5-bit alpha */
+	bg = TM_DMA2DGRAPHIC_GetPixel(x, y);
+	bg = (bg | (bg << 16)) & 0x07E0F81F;
+	fg = ((color & 0xFFFF) | (color << 16)) & 0x07E0F81F;
+	bg = ((((fg - bg) * ((alpha + 4) >> 3)) >> 5) + bg) & 0x07E0F81F;
+	
+	/* Save pixel */
+	TM_DMA2DGRAPHIC_DrawPixel(x, y, (bg | (bg >> 16)) & 0xFFFF);
+}
+#endif
+
+static int32_t TM_INT_DMA2DGRAPHIC_CircleHalfWidth(int32_t r, int32_t dy) {
+	/* Half of circle row width in 16.16 fixed point */
+	return (int32_t)(sqrtf((float)(r * r - dy * dy)) * 65536.0f);
+}
+
+static volatile TM_DMA2DGRAPHIC_Pixel_t* TM_INT_DMA2DGRAPHIC_PixelAddress(int32_t* stepx, int32_t* stepy) {
+	/* Steps in pixels for one pixel in X and Y direction */
+	*stepx = DIS.StepX;
+	*stepy = DIS.StepY;
+	
+	/* Return address of pixel 0, 0 */
+	return (volatile TM_DMA2DGRAPHIC_Pixel_t *)DMA2D_GRAPHIC_ADDRESS(0, 0);
+}
+
+static void TM_INT_DMA2DGRAPHIC_FillRect(int32_t x, int32_t y, int32_t width, int32_t height) {
+	int32_t pixels, lines;
+	
+	/* Logical width is memory column height in rotated orientations */
+	pixels = DIS.Swap ? height : width;
+	lines = DIS.Swap ? width : height;
+	
+	/* Start from corner with lowest address */
+	TM_INT_DMA2DGRAPHIC_SetMemory(
+		DIS.PixelSize * DMA2D_GRAPHIC_INDEX(x + DIS.FlipX * (width - 1), y + DIS.FlipY * (height - 1)),
+		DIS.Width - pixels, lines, pixels
+	);
+	
+	/* Start transfer and wait till done */
+	TM_INT_DMA2DGRAPHIC_InitAndTransfer();
+}
+
+static uint8_t TM_INT_DMA2DGRAPHIC_ClipCode(int32_t x, int32_t y) {
+	uint8_t code = 0;
+	
+	/* Get region of point */
+	if (x < 0) {
+		code |= DMA2D_GRAPHIC_CLIP_LEFT;
+	} else if (x >= DIS.CurrentWidth) {
+		code |= DMA2D_GRAPHIC_CLIP_RIGHT;
+	}
+	if (y < 0) {
+		code |= DMA2D_GRAPHIC_CLIP_TOP;
+	} else if (y >= DIS.CurrentHeight) {
+		code |= DMA2D_GRAPHIC_CLIP_BOTTOM;
+	}
+	return code;
+}
+
+static uint8_t TM_INT_DMA2DGRAPHIC_ClipLine(int32_t* x1, int32_t* y1, int32_t* x2, int32_t* y2) {
+	int32_t x, y, xmax = DIS.CurrentWidth - 1, ymax = DIS.CurrentHeight - 1;
+	uint8_t code1, code2, code;
+	
+	/* Cohen-Sutherland clipping */
+	code1 = TM_INT_DMA2DGRAPHIC_ClipCode(*x1, *y1);
+	code2 = TM_INT_DMA2DGRAPHIC_ClipCode(*x2, *y2);
+	while (code1 | code2) {
+		/* Both points on the same outer side */
+		if (code1 & code2) {
+			return 0;
+		}
+		
+		/* Move outer point to edge */
+		code = code1 ? code1 : code2;
+		if (code & DMA2D_GRAPHIC_CLIP_TOP) {
+			x = *x1 + (int32_t)((int64_t)(*x2 - *x1) * (0 - *y1) / (*y2 - *y1));
+			y = 0;
+		} else if (code & DMA2D_GRAPHIC_CLIP_BOTTOM) {
+			x = *x1 + (int32_t)((int64_t)(*x2 - *x1) * (ymax - *y1) / (*y2 - *y1));
+			y = ymax;
+		} else if (code & DMA2D_GRAPHIC_CLIP_LEFT) {
+			y = *y1 + (int32_t)((int64_t)(*y2 - *y1) * (0 - *x1) / (*x2 - *x1));
+			x = 0;
+		} else {
+			y = *y1 + (int32_t)((int64_t)(*y2 - *y1) * (xmax - *x1) / (*x2 - *x1));
+			x = xmax;
+		}
+		if (code == code1) {
+			*x1 = x;
+			*y1 = y;
+			code1 = TM_INT_DMA2DGRAPHIC_ClipCode(x, y);
+		} else {
+			*x2 = x;
+			*y2 = y;
+			code2 = TM_INT_DMA2DGRAPHIC_ClipCode(x, y);
+		}
+	}
+	
+	/* Line is inside */
+	return 1;
+}
+
+void TM_INT_DMA2DGRAPHIC_InitAndTransfer(void) {
+	TM_INT_DMA2D_Command_t Cmd = {0};
+#if DMA2D_GRAPHIC_L8
+	uint32_t address = DMA2D_StartAddress, width = DMA2D_Width, i;
+	uint8_t index = DMA2D_Color565;
+	
+	/* DMA2D writes 2 pixels as one 16-bit value, odd columns on edges are written by CPU */
+	if ((address & 0x01) || (width & 0x01)) {
+		TM_DMA2DGRAPHIC_WaitIdle();
+		if (address & 0x01) {
+			for (i = 0; i < DMA2D_Height; i++) {
+				*(__IO uint8_t *)(address + i * DIS.Width) = index;
+			}
+			address++;
+			width--;
+		}
+		if (width & 0x01) {
+			width--;
+			for (i = 0; i < DMA2D_Height; i++) {
+				*(__IO uint8_t *)(address + width + i * DIS.Width) = index;
+			}
+		}
+	}
+	
+	/* Nothing left for DMA2D */
+	if (width == 0) {
+		return;
+	}
+	
+	/* Register to memory, pairs of L8 pixels */
+	Cmd.CR = DMA2D_R2M;
+	Cmd.OCOLR = index | (index << 8);
+	Cmd.OMAR = address;
+	Cmd.OOR = (DIS.Width - width) / 2;
+	Cmd.OPFCCR = CM_RGB565;
+	Cmd.NLR = (uint32_t)((width / 2) << 16) | (uint16_t)DMA2D_Height;
+#else
+	/* Register to memory, RGB565 */
+	Cmd.CR = DMA2D_R2M;
+	Cmd.OCOLR = DMA2D_Color565;
+	Cmd.OMAR = DMA2D_StartAddress;
+	Cmd.OOR = DIS.Width - DMA2D_Width;
+	Cmd.OPFCCR = CM_RGB565;
+	Cmd.NLR = (uint32_t)(DMA2D_Width << 16) | (uint16_t)DMA2D_Height;
+#endif
+	
+	/* Start transfer and wait till transfer ends */
+	TM_INT_DMA2DGRAPHIC_Submit(&Cmd, 1);
+}
+
+static void TM_INT_DMA2DGRAPHIC_Start(const TM_INT_DMA2D_Command_t* Cmd) {
+	/* Set up registers */
+	DMA2D->FGMAR = Cmd->FGMAR;
+	DMA2D->FGOR = Cmd->FGOR;
+	DMA2D->FGPFCCR = Cmd->FGPFCCR;
+	DMA2D->FGCOLR = Cmd->FGCOLR;
+	DMA2D->FGCMAR = Cmd->FGCMAR;
+	DMA2D->BGMAR = Cmd->BGMAR;
+	DMA2D->BGOR = Cmd->BGOR;
+	DMA2D->BGPFCCR = Cmd->BGPFCCR;
+	DMA2D->OCOLR = Cmd->OCOLR;
+	DMA2D->OMAR = Cmd->OMAR;
+	DMA2D->OOR = Cmd->OOR;
+	DMA2D->OPFCCR = Cmd->OPFCCR;
+	DMA2D->NLR = Cmd->NLR;
+	
+	/* Start DMA2D */
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	DMA2D->CR = Cmd->CR | DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE | DMA2D_CR_START;
+#else
+	DMA2D->CR = Cmd->CR | DMA2D_CR_START;
+#endif
+}
+
+static void TM_INT_DMA2DGRAPHIC_Submit(const TM_INT_DMA2D_Command_t* Cmd, uint8_t wait) {
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+	uint32_t irq;
+	
+	/* Wait for free space in queue */
+	while (DMA2D_QueueCount >= DMA2D_GRAPHIC_QUEUE_SIZE);
+	
+	/* Disable interrupts */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Start now or add to queue */
+	DMA2D_Submitted++;
+	if (!DMA2D_Running) {
+		DMA2D_Running = 1;
+		TM_INT_DMA2DGRAPHIC_Start(Cmd);
+	} else {
+		DMA2D_Queue[DMA2D_QueueIn] = *Cmd;
+		if (++DMA2D_QueueIn >= DMA2D_GRAPHIC_QUEUE_SIZE) {
+			DMA2D_QueueIn = 0;
+		}
+		DMA2D_QueueCount++;
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+#else
+	/* Wait for previous operation to be done */
 	DMA2D_WAIT;
+	
+	/* Start transfer */
+	TM_INT_DMA2DGRAPHIC_Start(Cmd);
+	
+	/* Wait till done */
+	if (wait) {
+		DMA2D_WAIT;
+	}
+#endif
 }
 
 void TM_INT_DMA2DGRAPHIC_SetMemory(uint32_t MemoryAddress, uint32_t Offset, uint32_t NumberOfLine, uint32_t PixelPerLine) {	
 	/* Set memory settings */
-	DMA2DHandle.Init.OutputOffset = 0;
 	DMA2D_StartAddress = DIS.StartAddress + DIS.Offset + MemoryAddress;
 	DMA2D_Width = PixelPerLine;
 	DMA2D_Height = NumberOfLine;
@@ -722,41 +1330,3 @@ void TM_INT_DMA2DGRAPHIC_DrawCircleCorner(int16_t x0, int16_t y0, int16_t r, uin
     }
 }
 
-void TM_INT_DMA2DGRAPHIC_DrawFilledCircleCorner(int16_t x0, int16_t y0, int16_t r, uint8_t corner, uint32_t color) {
-	int16_t f = 1 - r;
-	int16_t ddF_x = 1;
-	int16_t ddF_y = -2 * r;
-	int16_t x = 0;
-	int16_t y = r;
-
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
-        }
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
-
-        if (corner & 0x01) {/* Top left */
-			TM_DMA2DGRAPHIC_DrawLine(x0, y0 - y, x0 - x, y0 - y, color);
-			TM_DMA2DGRAPHIC_DrawLine(x0, y0 - x, x0 - y, y0 - x, color);
-		}
-		
-        if (corner & 0x02) {/* Top right */
-			TM_DMA2DGRAPHIC_DrawLine(x0 + x, y0 - y, x0, y0 - y, color);
-			TM_DMA2DGRAPHIC_DrawLine(x0 + y, y0 - x, x0, y0 - x, color);
-		}
-		
-		if (corner & 0x04) {/* Bottom right */
-			TM_DMA2DGRAPHIC_DrawLine(x0, y0 + y, x0 + x, y0 + y, color);
-			TM_DMA2DGRAPHIC_DrawLine(x0 + y, y0 + x, x0, y0 + x, color);
-		}
-		
-        if (corner & 0x08) {/* Bottom left */
-			TM_DMA2DGRAPHIC_DrawLine(x0 - x, y0 + y, x0, y0 + y, color);
-			TM_DMA2DGRAPHIC_DrawLine(x0, y0 + x, x0 - y, y0 + x, color);
-		}
-    }
-}
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.9
  * @ide     Keil uVision
  * @license MIT
  * @brief   Graphic library for LCD using DMA2D for transferring graphic data to memory for LCD display
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_DMA2DGRAPHIC_H
-#define TM_DMA2DGRAPHIC_H 100
+#define TM_DMA2DGRAPHIC_H 190
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -71,11 +71,129 @@ extern "C" {
  * Transmissions between memory is very fast which allows you to make smooth transmissions.
  *
  *
+ * \par Bitmaps with alpha channel
+ *
+ * Bitmaps in ARGB8888, RGB888, ARGB1555, ARGB4444 or RGB565 format can be blended over RGB565 LCD memory with @ref TM_DMA2DGRAPHIC_BlendBitmap.
+ * Bitmaps with indexed colors (L8, L4, AL44, AL88) need color table and are drawn with @ref TM_DMA2DGRAPHIC_BlendBitmapCLUT.
+ * DMA2D converts pixel format and blends with per-pixel alpha in one transfer.
+ *
+ * Color mode parameter is one of CM_xxx defines from HAL DMA2D driver, for example CM_ARGB4444 or CM_L8.
+ *
+\code
+//Draw 32x32 ARGB4444 icon at half opacity
+TM_DMA2DGRAPHIC_BlendBitmap(10, 10, 32, 32, icon, CM_ARGB4444, 128);
+
+//Draw 64x64 L8 image with 16 colors table in ARGB8888 format
+TM_DMA2DGRAPHIC_BlendBitmapCLUT(50, 10, 64, 64, image, CM_L8, palette, 16, 255);
+\endcode
+ *
+ * \par Filled shapes
+ *
+ * Filled triangles, circles, rounded rectangles and polygons are drawn row by row with horizontal spans.
+ * Spans up to DMA2D_GRAPHIC_CPU_SPAN_MAX pixels are written directly by CPU, longer spans are filled by DMA2D,
+ * because DMA2D setup takes longer than writing a few pixels. With command queue enabled, DMA2D is used for all spans.
+ *
+ * Left and right edges of filled shapes can be smoothed with anti-aliasing, edge pixels are then blended with background.
+ *
+\code
+//Max span length written by CPU, set to 0 to always use DMA2D
+#define DMA2D_GRAPHIC_CPU_SPAN_MAX  32
+//Enable anti-aliasing for filled shapes
+#define DMA2D_GRAPHIC_ANTIALIAS     1
+//Max number of edges crossing one row for TM_DMA2DGRAPHIC_DrawFilledPolygon
+#define DMA2D_GRAPHIC_POLYGON_NODES 16
+\endcode
+ *
+ * \par Command queue
+ *
+ * By default, each function starts DMA2D transfer and waits for it to finish.
+ * If you add line below to defines.h file, transfers are added to queue and started one after another from DMA2D interrupt,
+ * so functions return immediately and CPU can prepare next drawing in the meantime:
+ *
+\code
+//Enable queue with 16 commands
+#define DMA2D_GRAPHIC_QUEUE_SIZE    16
+\endcode
+ *
+ * With queue enabled, source memory for copy and blend functions must stay valid until transfer is done.
+ * Use fence functions to check progress:
+ *
+\code
+uint32_t fence;
+
+//Queue drawing
+TM_DMA2DGRAPHIC_Fill(GRAPHIC_COLOR_WHITE);
+TM_DMA2DGRAPHIC_CopyBuffer(image, (void *)DMA2D_GRAPHIC_RAM_ADDR, 100, 100, 0, DMA2D_GRAPHIC_LCD_WIDTH - 100);
+fence = TM_DMA2DGRAPHIC_InsertFence();
+
+//Do other work here
+
+//Wait till transfers above are done, image memory can be reused after that
+TM_DMA2DGRAPHIC_WaitFence(fence);
+\endcode
+ *
+ * Pixel functions wait for queue to be empty before CPU accesses memory.
+ *
+ * \par 8-bit indexed frame buffer
+ *
+ * Frame buffer can have 1 byte per pixel with color lookup table (L8 format), which halves memory and LTDC bandwidth.
+ * Colors are then indexes to color table. Enable it in defines.h file, TM LCD sets it with LCD_USE_L8:
+ *
+\code
+//Use L8 frame buffer
+#define DMA2D_GRAPHIC_L8            1
+\endcode
+ *
+ * DMA2D can not write L8 pixels, so fills are done with 16-bit writes of 2 pixels, odd edge columns are written by CPU.
+ * Blend functions are not available and return 0, anti-aliasing is disabled.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added TM_DMA2DGRAPHIC_DrawAlphaBitmap function for fast font rendering
+  
+ Version 1.2
+  - October 14, 2026
+  - All transfers are programmed directly to registers, HAL DMA2D driver is not used anymore
+  - Added optional command queue processed from DMA2D interrupt, with fence functions
+  
+ Version 1.3
+  - October 14, 2026
+  - Added TM_DMA2DGRAPHIC_BlendBitmap and TM_DMA2DGRAPHIC_BlendBitmapCLUT functions for bitmaps in other pixel formats
+  
+ Version 1.4
+  - October 14, 2026
+  - Filled triangles, circles and rounded rectangles are drawn with one horizontal span per row
+  - Short spans are written by CPU, long spans by DMA2D
+  - Added TM_DMA2DGRAPHIC_DrawFilledPolygon function
+  - Added optional anti-aliasing for edges of filled shapes
+  
+ Version 1.5
+  - October 14, 2026
+  - Lines and circles are written directly to frame buffer with address stepping, clipped once per primitive
+  - Horizontal and vertical lines are still drawn with DMA2D
+  
+ Version 1.6
+  - October 14, 2026
+  - Added TM_DMA2DGRAPHIC_GetPixelAddress function for decoders writing directly to frame buffer
+  
+ Version 1.7
+  - October 14, 2026
+  - Added 8-bit indexed (L8) frame buffer support
+  
+ Version 1.8
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
+  
+ Version 1.9
+  - October 14, 2026
+  - Pixel addresses are calculated from per-orientation origin and step table, without orientation branches
+  - Rectangles, lines and spans use the same DMA2D fill in all orientations, short spans in rotated orientations are written by CPU
 \endverbatim
  *
  * \par Dependencies
@@ -83,11 +201,13 @@ extern "C" {
 \verbatim
  - STM32Fxxx HAL
  - defines.h
+ - math.h
 \endverbatim
  */
  
 #include "stm32fxxx_hal.h"
 #include "defines.h"
+#include "math.h"
 
 /**
  * @defgroup TM_DMA2D_GRAPHIC_Macros
@@ -161,9 +281,71 @@ extern "C" {
 #define GRAPHIC_COLOR_GRAY			0x7BEF
 #define GRAPHIC_COLOR_BROWN			0xBBCA
 
+/**
+ * @brief  Number of DMA2D commands in queue, set to 0 to wait for each transfer
+ */
+#ifndef DMA2D_GRAPHIC_QUEUE_SIZE
+#define DMA2D_GRAPHIC_QUEUE_SIZE    0
+#endif
+
+/**
+ * @brief  Maximal span length in pixels written by CPU instead of DMA2D for filled shapes
+ */
+#ifndef DMA2D_GRAPHIC_CPU_SPAN_MAX
+#define DMA2D_GRAPHIC_CPU_SPAN_MAX  32
+#endif
+
+/**
+ * @brief  Anti-aliasing for left and right edges of filled shapes
+ */
+#ifndef DMA2D_GRAPHIC_ANTIALIAS
+#define DMA2D_GRAPHIC_ANTIALIAS     0
+#endif
+
+/**
+ * @brief  Maximal number of polygon edges crossing one row
+ */
+#ifndef DMA2D_GRAPHIC_POLYGON_NODES
+#define DMA2D_GRAPHIC_POLYGON_NODES 16
+#endif
+
+/**
+ * @brief  DMA2D NVIC preemption priority, used when queue is enabled
+ */
+#ifndef DMA2D_GRAPHIC_NVIC_PRIORITY
+#define DMA2D_GRAPHIC_NVIC_PRIORITY NVIC_PRIORITY_NORMAL
+#endif
+
+/**
+ * @brief  8-bit indexed frame buffer, TM LCD sets it with LCD_USE_L8
+ */
+#ifndef DMA2D_GRAPHIC_L8
+#if defined(LCD_USE_L8)
+#define DMA2D_GRAPHIC_L8            LCD_USE_L8
+#else
+#define DMA2D_GRAPHIC_L8            0
+#endif
+#endif
+
+/* Pixel settings */
+#if DMA2D_GRAPHIC_L8
+#define DMA2D_GRAPHIC_PIXEL_SIZE    1
+#define DMA2D_GRAPHIC_PIXEL_CM      CM_L8
+/* Colors are indexes, they can not be blended */
+#undef DMA2D_GRAPHIC_ANTIALIAS
+#define DMA2D_GRAPHIC_ANTIALIAS     0
+#else
+#define DMA2D_GRAPHIC_PIXEL_SIZE    2
+#define DMA2D_GRAPHIC_PIXEL_CM      CM_RGB565
+#endif
+
 /* Waiting flags */
 #define DMA2D_WORKING               ((DMA2D->CR & DMA2D_CR_START))
+#if DMA2D_GRAPHIC_QUEUE_SIZE > 0
+#define DMA2D_WAIT                  TM_DMA2DGRAPHIC_WaitIdle()
+#else
 #define DMA2D_WAIT                  do { while (DMA2D_WORKING); DMA2D->IFCR = DMA2D_IFSR_CTCIF;} while (0)
+#endif
 
 /**
  * @}
@@ -179,6 +361,15 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief  Frame buffer pixel type
+ */
+#if DMA2D_GRAPHIC_L8
+typedef uint8_t TM_DMA2DGRAPHIC_Pixel_t;
+#else
+typedef uint16_t TM_DMA2DGRAPHIC_Pixel_t;
+#endif
+
 /**
  * @brief  Structure for polygon line
  * @note   If you have big poly line, you can use array of this structure for more coordinates
@@ -400,9 +591,109 @@ void TM_DMA2DGRAPHIC_DrawTriangle(uint16_t x1, uint16_t y1,  uint16_t x2, uint16
  */
 void TM_DMA2DGRAPHIC_DrawFilledTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint32_t color);
 
+/**
+ * @brief  Draws filled polygon on currently active layer
+ * @note   Even-odd rule is used, max @ref DMA2D_GRAPHIC_POLYGON_NODES edges may cross one row
+ * @param  *Coordinates: Pointer to @ref TM_DMA2DRAPHIC_Poly_t array of polygon points
+ * @param  count: Number of points, polygon is closed automatically
+ * @param  color: Color in RGB565 format
+ * @retval None
+ */
+void TM_DMA2DGRAPHIC_DrawFilledPolygon(TM_DMA2DRAPHIC_Poly_t* Coordinates, uint16_t count, uint32_t color);
+
+/**
+ * @brief  Draws 8-bit alpha bitmap (A8 format) with single color, blended over current LCD content
+ * @note   Used for font glyphs, one byte per pixel, 0x00 is transparent and 0xFF is fully colored
+ * @note   Only normal orientation (1) is supported and bitmap must be entirely on LCD
+ * @param  x: X coordinate of top left corner
+ * @param  y: Y coordinate of top left corner
+ * @param  width: Bitmap width in pixels
+ * @param  height: Bitmap height in pixels
+ * @param  *pAlpha: Pointer to bitmap with width * height bytes, row by row
+ * @param  color: Color in RGB565 format
+ * @retval Drawing status:
+ *            - 0: Bitmap was not drawn, use pixel functions instead
+ *            - > 0: Bitmap drawn OK
+ */
+uint8_t TM_DMA2DGRAPHIC_DrawAlphaBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* pAlpha, uint32_t color);
+
 void TM_DMA2DGRAPHIC_CopyBuffer(void* pSrc, void* pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLineSrc, uint32_t OffLineDst);
 void TM_DMA2DGRAPHIC_CopyBufferIT(void* pSrc, void* pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLineSrc, uint32_t OffLineDst);
 
+/**
+ * @brief  Blends bitmap with alpha channel over current LCD content with pixel format conversion
+ * @note   Only normal orientation (1) is supported and bitmap must be entirely on LCD
+ * @param  x: X coordinate of top left corner
+ * @param  y: Y coordinate of top left corner
+ * @param  width: Bitmap width in pixels
+ * @param  height: Bitmap height in pixels
+ * @param  *pSrc: Pointer to bitmap data, row by row without gaps
+ * @param  ColorMode: Bitmap pixel format, CM_ARGB8888, CM_RGB888, CM_RGB565, CM_ARGB1555, CM_ARGB4444, CM_A8 or CM_A4
+ * @param  Alpha: Global opacity, multiplied with alpha of each pixel. Use 255 for bitmap alpha only
+ * @retval Drawing status:
+ *            - 0: Bitmap was not drawn, invalid parameters
+ *            - > 0: Bitmap drawn OK
+ */
+uint8_t TM_DMA2DGRAPHIC_BlendBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void* pSrc, uint32_t ColorMode, uint8_t Alpha);
+
+/**
+ * @brief  Blends bitmap with indexed colors over current LCD content, color table is loaded before transfer
+ * @note   Only normal orientation (1) is supported and bitmap must be entirely on LCD
+ * @param  x: X coordinate of top left corner
+ * @param  y: Y coordinate of top left corner
+ * @param  width: Bitmap width in pixels
+ * @param  height: Bitmap height in pixels
+ * @param  *pSrc: Pointer to bitmap data, row by row without gaps
+ * @param  ColorMode: Bitmap pixel format, CM_L8, CM_L4, CM_AL44 or CM_AL88
+ * @param  *pCLUT: Pointer to color table with colors in ARGB8888 format
+ * @param  CLUTSize: Number of colors in table, between 1 and 256
+ * @param  Alpha: Global opacity, multiplied with alpha of each pixel. Use 255 for bitmap alpha only
+ * @retval Drawing status:
+ *            - 0: Bitmap was not drawn, invalid parameters
+ *            - > 0: Bitmap drawn OK
+ */
+uint8_t TM_DMA2DGRAPHIC_BlendBitmapCLUT(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void* pSrc, uint32_t ColorMode, const uint32_t* pCLUT, uint16_t CLUTSize, uint8_t Alpha);
+
+/**
+ * @brief  Gets fence for all transfers submitted so far
+ * @param  None
+ * @retval Fence value to be used with @ref TM_DMA2DGRAPHIC_IsFenceDone and @ref TM_DMA2DGRAPHIC_WaitFence
+ */
+uint32_t TM_DMA2DGRAPHIC_InsertFence(void);
+
+/**
+ * @brief  Checks if all transfers before fence are done
+ * @param  fence: Fence value returned from @ref TM_DMA2DGRAPHIC_InsertFence
+ * @retval Fence status:
+ *            - 0: Transfers are still in progress
+ *            - > 0: Transfers are done
+ */
+uint8_t TM_DMA2DGRAPHIC_IsFenceDone(uint32_t fence);
+
+/**
+ * @brief  Waits till all transfers before fence are done
+ * @param  fence: Fence value returned from @ref TM_DMA2DGRAPHIC_InsertFence
+ * @retval None
+ */
+void TM_DMA2DGRAPHIC_WaitFence(uint32_t fence);
+
+/**
+ * @brief  Waits till all queued transfers are done
+ * @param  None
+ * @retval None
+ */
+void TM_DMA2DGRAPHIC_WaitIdle(void);
+
+/**
+ * @brief  Gets frame buffer address of pixel 0, 0 in current layer and orientation
+ * @note   Pixel x, y is at address + x * stepx + y * stepy, in units of pixels
+ * @note   Function waits for queued transfers, so CPU can write frame buffer after it
+ * @param  *stepx: Pointer to store step for one pixel in X direction
+ * @param  *stepy: Pointer to store step for one pixel in Y direction
+ * @retval Address of pixel 0, 0
+ */
+volatile TM_DMA2DGRAPHIC_Pixel_t* TM_DMA2DGRAPHIC_GetPixelAddress(int32_t* stepx, int32_t* stepy);
+
 /* Private functions */
 void TM_INT_DMA2DGRAPHIC_SetConf(TM_DMA2DGRAPHIC_INT_Conf_t* Conf);
 
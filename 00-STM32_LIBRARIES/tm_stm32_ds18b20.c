@@ -18,6 +18,10 @@
  */
 #include "tm_stm32_ds18b20.h"
 
+/* Private functions */
+static void TM_DS18B20_INT_TimerCallback(TM_DELAY_Timer_t* Timer, void* UserParameters);
+static uint8_t TM_DS18B20_INT_ReadRaw(TM_OneWire_t* OneWire, uint8_t* ROM, uint8_t Skip, uint8_t Resolution, int16_t* destination);
+
 uint8_t TM_DS18B20_Start(TM_OneWire_t* OneWire, uint8_t *ROM) {
 	/* Check if device is DS18B20 */
 	if (!TM_DS18B20_Is(ROM)) {
@@ -44,105 +48,36 @@ void TM_DS18B20_StartAll(TM_OneWire_t* OneWire) {
 }
 
 uint8_t TM_DS18B20_Read(TM_OneWire_t* OneWire, uint8_t *ROM, float *destination) {
-	uint16_t temperature;
-	uint8_t resolution;
-	int8_t digit, minus = 0;
-	float decimal;
-	uint8_t i = 0;
-	uint8_t data[9];
-	uint8_t crc;
+	int16_t temperature;
 	
-	/* Check if device is DS18B20 */
-	if (!TM_DS18B20_Is(ROM)) {
+	/* Read fixed point temperature */
+	if (!TM_DS18B20_INT_ReadRaw(OneWire, ROM, 0, 0, &temperature)) {
 		return 0;
 	}
 	
-	/* Check if line is released, if it is, then conversion is complete */
-	if (!TM_OneWire_ReadBit(OneWire)) {
-		/* Conversion is not finished yet */
-		return 0; 
-	}
-
-	/* Reset line */
-	TM_OneWire_Reset(OneWire);
-	/* Select ROM number */
-	TM_OneWire_SelectWithPointer(OneWire, ROM);
-	/* Read scratchpad command by onewire protocol */
-	TM_OneWire_WriteByte(OneWire, ONEWIRE_CMD_RSCRATCHPAD);
+	/* Convert 1/16 degrees to float */
+	*destination = (float)temperature * (float)DS18B20_DECIMAL_STEPS_12BIT;
 	
-	/* Get data */
-	for (i = 0; i < 9; i++) {
-		/* Read byte by byte */
-		data[i] = TM_OneWire_ReadByte(OneWire);
-	}
-	
-	/* Calculate CRC */
-	crc = TM_OneWire_CRC8(data, 8);
-	
-	/* Check if CRC is ok */
-	if (crc != data[8]) {
-		/* CRC invalid */
-		return 0;
-	}
-	
-	/* First two bytes of scratchpad are temperature values */
-	temperature = data[0] | (data[1] << 8);
-
-	/* Reset line */
-	TM_OneWire_Reset(OneWire);
-	
-	/* Check if temperature is negative */
-	if (temperature & 0x8000) {
-		/* Two's complement, temperature is negative */
-		temperature = ~temperature + 1;
-		minus = 1;
-	}
+	/* Return 1, temperature valid */
+	return 1;
+}
 
-	
-	/* Get sensor resolution */
-	resolution = ((data[4] & 0x60) >> 5) + 9;
+uint8_t TM_DS18B20_ReadRaw(TM_OneWire_t* OneWire, uint8_t *ROM, int16_t *destination) {
+	/* Read with ROM select, resolution from configuration register */
+	return TM_DS18B20_INT_ReadRaw(OneWire, ROM, 0, 0, destination);
+}
 
-	
-	/* Store temperature integer digits and decimal digits */
-	digit = temperature >> 4;
-	digit |= ((temperature >> 8) & 0x7) << 4;
-	
-	/* Store decimal digits */
-	switch (resolution) {
-		case 9: {
-			decimal = (temperature >> 3) & 0x01;
-			decimal *= (float)DS18B20_DECIMAL_STEPS_9BIT;
-		} break;
-		case 10: {
-			decimal = (temperature >> 2) & 0x03;
-			decimal *= (float)DS18B20_DECIMAL_STEPS_10BIT;
-		} break;
-		case 11: {
-			decimal = (temperature >> 1) & 0x07;
-			decimal *= (float)DS18B20_DECIMAL_STEPS_11BIT;
-		} break;
-		case 12: {
-			decimal = temperature & 0x0F;
-			decimal *= (float)DS18B20_DECIMAL_STEPS_12BIT;
-		} break;
-		default: {
-			decimal = 0xFF;
-			digit = 0;
-		}
-	}
-	
-	/* Check for negative part */
-	decimal = digit + decimal;
-	if (minus) {
-		decimal = 0 - decimal;
+#if DS18B20_USE_SERIES
+uint8_t TM_DS18B20_ReadSeries(TM_OneWire_t* OneWire, uint8_t *ROM, TM_SERIES_t* Series, uint16_t Row, uint8_t Channel) {
+	/* Check channel */
+	if (Channel >= Series->ChannelCount) {
+		return 0;
 	}
 	
-	/* Set to pointer */
-	*destination = decimal;
-	
-	/* Return 1, temperature valid */
-	return 1;
+	/* Raw value goes directly to sample, channel scale is 16 */
+	return TM_DS18B20_ReadRaw(OneWire, ROM, TM_SERIES_CELL(Series, Row, Channel));
 }
+#endif
 
 uint8_t TM_DS18B20_GetResolution(TM_OneWire_t* OneWire, uint8_t *ROM) {
 	uint8_t conf;
@@ -391,4 +326,234 @@ uint8_t TM_DS18B20_AllDone(TM_OneWire_t* OneWire) {
 	return TM_OneWire_ReadBit(OneWire);
 }
 
+uint8_t TM_DS18B20_PollerInit(TM_DS18B20_Poller_t* Poller, TM_DS18B20_Bus_t* Buses, uint8_t BusCount, TM_DS18B20_Sensor_t* Sensors, uint16_t SensorCount) {
+	TM_DS18B20_Sensor_t* Sensor;
+	uint16_t j;
+	uint8_t i;
+	
+	/* Save settings */
+	Poller->Buses = Buses;
+	Poller->BusCount = BusCount;
+	Poller->Sensors = Sensors;
+	Poller->SensorCount = SensorCount;
+	Poller->Pending = 0;
+	
+	/* Allocate stopped one-shot timer for each bus */
+	for (i = 0; i < BusCount; i++) {
+		Buses[i].Ready = 0;
+		Buses[i].Busy = 0;
+		Buses[i].Next = 0;
+		Buses[i].Count = 0;
+		
+		/* Configure sensors on this bus */
+		for (j = 0; j < SensorCount; j++) {
+			Sensor = &Sensors[j];
+			if (Sensor->OneWire != Buses[i].OneWire) {
+				continue;
+			}
+			Buses[i].Count++;
+			
+			/* Set resolution, EEPROM is written only when it is different */
+			if (Sensor->Resolution) {
+				if (TM_DS18B20_GetResolution(Sensor->OneWire, Sensor->ROM) != Sensor->Resolution) {
+					TM_DS18B20_SetResolution(Sensor->OneWire, Sensor->ROM, (TM_DS18B20_Resolution_t)Sensor->Resolution);
+				}
+				
+				/* Bus deadline is for highest resolution */
+				if (Sensor->Resolution > Buses[i].Resolution) {
+					Buses[i].Resolution = (TM_DS18B20_Resolution_t)Sensor->Resolution;
+				}
+			}
+		}
+		
+		/* Create timer */
+		Buses[i].Timer = TM_DELAY_TimerCreate(TM_DS18B20_ConversionTime(Buses[i].Resolution), 0, 0, TM_DS18B20_INT_TimerCallback, &Buses[i]);
+		
+		/* Check timer */
+		if (Buses[i].Timer == NULL) {
+			/* Release already allocated timers */
+			Poller->BusCount = i;
+			TM_DS18B20_PollerDeInit(Poller);
+			return 1;
+		}
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_DS18B20_PollerDeInit(TM_DS18B20_Poller_t* Poller) {
+	uint8_t i;
+	
+	/* Delete timers */
+	for (i = 0; i < Poller->BusCount; i++) {
+		if (Poller->Buses[i].Timer) {
+			TM_DELAY_TimerDelete(Poller->Buses[i].Timer);
+			Poller->Buses[i].Timer = NULL;
+		}
+	}
+	
+	/* Nothing pending */
+	Poller->Pending = 0;
+}
+
+uint8_t TM_DS18B20_PollerStart(TM_DS18B20_Poller_t* Poller) {
+	TM_DS18B20_Bus_t* Bus;
+	uint8_t i;
+	
+	/* Check if previous sweep is done */
+	if (Poller->Pending) {
+		return 1;
+	}
+	
+	/* Start conversion on all buses */
+	for (i = 0; i < Poller->BusCount; i++) {
+		Bus = &Poller->Buses[i];
+		
+		/* Start all sensors on bus */
+		TM_DS18B20_StartAll(Bus->OneWire);
+		
+		/* Set bus state */
+		Bus->Ready = 0;
+		Bus->Busy = 1;
+		Bus->Next = 0;
+		
+		/* Start deadline timer for bus resolution */
+		TM_DELAY_TimerStop(Bus->Timer);
+		TM_DELAY_TimerAutoReloadValue(Bus->Timer, TM_DS18B20_ConversionTime(Bus->Resolution));
+		TM_DELAY_TimerReset(Bus->Timer);
+		TM_DELAY_TimerStart(Bus->Timer);
+	}
+	
+	/* All buses are pending */
+	Poller->Pending = Poller->BusCount;
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_DS18B20_PollerProcess(TM_DS18B20_Poller_t* Poller) {
+	TM_DS18B20_Bus_t* Bus;
+	TM_DS18B20_Sensor_t* Sensor;
+	uint8_t i;
+	
+	/* Check if anything to do */
+	if (!Poller->Pending) {
+		return 0;
+	}
+	
+	/* Go through all buses */
+	for (i = 0; i < Poller->BusCount; i++) {
+		Bus = &Poller->Buses[i];
+		
+		/* Check if conversion deadline is reached */
+		if (!Bus->Busy || !Bus->Ready) {
+			continue;
+		}
+		
+		/* Find next sensor on this bus */
+		while (Bus->Next < Poller->SensorCount && Poller->Sensors[Bus->Next].OneWire != Bus->OneWire) {
+			Bus->Next++;
+		}
+		
+		/* Read sensor */
+		if (Bus->Next < Poller->SensorCount) {
+			Sensor = &Poller->Sensors[Bus->Next++];
+			
+			/* Publish result, only sensor on bus is read without ROM select */
+			if (TM_DS18B20_INT_ReadRaw(Bus->OneWire, Sensor->ROM, Bus->Count == 1, Sensor->Resolution, &Sensor->Raw)) {
+#if DS18B20_POLLER_FLOAT
+				Sensor->Temperature = (float)Sensor->Raw * (float)DS18B20_DECIMAL_STEPS_12BIT;
+#endif
+				Sensor->Timestamp = TM_DELAY_Time();
+				Sensor->Valid = 1;
+			} else {
+				Sensor->Valid = 0;
+				Sensor->Errors++;
+			}
+			continue;
+		}
+		
+		/* All sensors on bus are read */
+		Bus->Busy = 0;
+		Poller->Pending--;
+		
+		/* Check if sweep is done */
+		if (!Poller->Pending) {
+			TM_DS18B20_PollerCallback(Poller);
+		}
+	}
+	
+	/* Return number of pending buses */
+	return Poller->Pending;
+}
+
+__weak void TM_DS18B20_PollerCallback(TM_DS18B20_Poller_t* Poller) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_DS18B20_PollerCallback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static void TM_DS18B20_INT_TimerCallback(TM_DELAY_Timer_t* Timer, void* UserParameters) {
+	/* Conversion deadline reached, read in main loop */
+	((TM_DS18B20_Bus_t *)UserParameters)->Ready = 1;
+}
+
+static uint8_t TM_DS18B20_INT_ReadRaw(TM_OneWire_t* OneWire, uint8_t* ROM, uint8_t Skip, uint8_t Resolution, int16_t* destination) {
+	uint8_t data[DS18B20_DATA_LEN];
+	int16_t temperature;
+	
+	/* Check if device is DS18B20 */
+	if (!TM_DS18B20_Is(ROM)) {
+		return 0;
+	}
+	
+	/* Check if line is released, if it is, then conversion is complete */
+	if (!TM_OneWire_ReadBit(OneWire)) {
+		/* Conversion is not finished yet */
+		return 0; 
+	}
 
+	/* Reset line */
+	TM_OneWire_Reset(OneWire);
+	/* Select ROM number or all devices when only one is on bus */
+	if (Skip) {
+		TM_OneWire_WriteByte(OneWire, ONEWIRE_CMD_SKIPROM);
+	} else {
+		TM_OneWire_SelectWithPointer(OneWire, ROM);
+	}
+	/* Read scratchpad command by onewire protocol */
+	TM_OneWire_WriteByte(OneWire, ONEWIRE_CMD_RSCRATCHPAD);
+	
+	/* Get data, only temperature bytes without CRC */
+	TM_OneWire_ReadBytes(OneWire, data, DS18B20_DATA_LEN);
+	
+	/* Reset line, it also stops reading rest of scratchpad */
+	TM_OneWire_Reset(OneWire);
+	
+#if DS18B20_USE_CRC
+	/* Check if CRC is ok */
+	if (TM_OneWire_CRC8(data, 8) != data[8]) {
+		/* CRC invalid */
+		return 0;
+	}
+	
+	/* Resolution from configuration register */
+	Resolution = ((data[4] & 0x60) >> 5) + 9;
+#endif
+	
+	/* First two bytes of scratchpad are temperature values */
+	temperature = (int16_t)(data[0] | (data[1] << 8));
+	
+	/* Clear undefined bits for lower resolutions, 9 bits resolution has 3 undefined bits */
+	if (Resolution >= 9 && Resolution < 12) {
+		temperature &= ~((1 << (12 - Resolution)) - 1);
+	}
+	
+	/* Set to pointer */
+	*destination = temperature;
+	
+	/* Return 1, temperature valid */
+	return 1;
+}
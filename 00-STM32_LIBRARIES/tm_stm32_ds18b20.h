@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-06-ds18b20-for-stm32fxxx/
- * @version v1.0
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   Library for interfacing DS18B20 temperature sensor from Dallas semiconductors.
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_DS18B20_H
-#define TM_DS18B20_H 100
+#define TM_DS18B20_H 130
 
 /**
  * @addtogroup TM_STM32Fxxx_HAL_Libraries
@@ -51,11 +51,77 @@
  * 
  * Pin for STM32Fxxx is the same as set with @ref TM_ONEWIRE library.
  *
+ * \par Non-blocking poller
+ *
+ * Poller manages many sensors on many OneWire buses without waiting for conversion.
+ * @ref TM_DS18B20_PollerStart starts conversion on all buses and starts one @ref TM_DELAY timer for each bus
+ * with conversion time for bus resolution. @ref TM_DS18B20_PollerProcess must be called periodically from main loop,
+ * reads one sensor per ready bus on each call and saves temperature with timestamp to sensors table.
+ * When all sensors are read, @ref TM_DS18B20_PollerCallback is called.
+ *
+\code
+TM_DS18B20_Bus_t Buses[2] = {
+	{&OneWire1, TM_DS18B20_Resolution_12bits},
+	{&OneWire2, TM_DS18B20_Resolution_9bits},
+};
+TM_DS18B20_Sensor_t Sensors[40]; //Fill OneWire, ROM and optional Resolution members for each sensor
+TM_DS18B20_Poller_t Poller;
+
+TM_DS18B20_PollerInit(&Poller, Buses, 2, Sensors, 40);
+TM_DS18B20_PollerStart(&Poller);
+while (1) {
+	TM_DS18B20_PollerProcess(&Poller);
+	//Do other work
+}
+\endcode
+ *
+ * \par Sweep time
+ *
+ * Reading one sensor takes reset, 64-bit ROM select, command and 9 bytes of scratchpad with CRC, about 11ms of bus time.
+ * Sweep over many sensors is made shorter with:
+ *
+\verbatim
+ - DS18B20_USE_CRC set to 0: only 2 temperature bytes are read, reading is stopped with reset pulse
+ - Single sensor on bus: poller uses Skip ROM command instead of 64-bit ROM select
+ - Resolution member of sensor: poller sets resolution at init, only when different from sensor EEPROM.
+   Lower resolution has shorter conversion and bus deadline is set for highest resolution on bus
+ - DS18B20_POLLER_FLOAT set to 0: poller saves only fixed point temperature, no float conversion
+\endverbatim
+ *
+\code
+//Do not check CRC, read only temperature
+#define DS18B20_USE_CRC        0
+//Poller saves only Raw member in 1/16 degrees
+#define DS18B20_POLLER_FLOAT   0
+\endcode
+ *
+ * \par Fixed point temperature
+ *
+ * @ref TM_DS18B20_ReadRaw gets temperature as 16-bit number in 1/16 degrees, the same as sensor has it, without float conversion.
+ * With DS18B20_USE_SERIES set to 1 in defines.h file, @ref TM_DS18B20_ReadSeries writes it directly to @ref TM_SERIES store,
+ * use scale 16 for channel.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added non-blocking poller for more OneWire buses
+  - Scratchpad is read with TM_OneWire_ReadBytes function
+  
+ Version 1.2
+  - October 14, 2026
+  - Added TM_DS18B20_ReadRaw function with temperature in 1/16 degrees
+  - Added TM_DS18B20_ReadSeries function to write temperature to TM SERIES store
+  
+ Version 1.3
+  - October 14, 2026
+  - Added DS18B20_USE_CRC option, only 2 temperature bytes are read without CRC check
+  - Poller sets resolution for each sensor and uses Skip ROM read for buses with one sensor
+  - Poller saves temperature in 1/16 degrees, float is optional with DS18B20_POLLER_FLOAT
 \endverbatim
  *
  * \par Dependencies
@@ -64,6 +130,8 @@
  - STM32Fxxx HAL
  - TM ONEWIRE
  - TM GPIO
+ - TM DELAY
+ - TM SERIES, when DS18B20_USE_SERIES is enabled
  - defines.h
 \endverbatim
  */
@@ -72,9 +140,18 @@
 #include "tm_stm32_onewire.h"
 #include "defines.h"
 
+/* Series store support */
+#ifndef DS18B20_USE_SERIES
+#define DS18B20_USE_SERIES				0
+#endif
+
+#if DS18B20_USE_SERIES
+#include "tm_stm32_series.h"
+#endif
+
 /* OneWire version check */
-#if TM_ONEWIRE_H < 100
-#error "Please update TM ONEWIRE LIB, minimum required version is 2.0.0. Download available on stm32f4-discovery.com website"
+#if TM_ONEWIRE_H < 120
+#error "Please update TM ONEWIRE LIB, minimum required version is 1.2. Download available on stm32f4-discovery.com website"
 #endif
 
 /**
@@ -99,13 +176,30 @@
 #define DS18B20_RESOLUTION_R1			6
 #define DS18B20_RESOLUTION_R0			5
 
-/* CRC enabled */
-#ifdef DS18B20_USE_CRC	
+/* Scratchpad CRC check, set to 0 to read only temperature bytes */
+#ifndef DS18B20_USE_CRC
+#define DS18B20_USE_CRC					1
+#endif
+
+/* Poller converts temperature to float */
+#ifndef DS18B20_POLLER_FLOAT
+#define DS18B20_POLLER_FLOAT			1
+#endif
+
+/* Number of scratchpad bytes read for temperature */
+#if DS18B20_USE_CRC
 #define DS18B20_DATA_LEN				9
 #else
 #define DS18B20_DATA_LEN				2
 #endif
 
+/**
+ * @brief  Gets maximal conversion time in milliseconds for resolution
+ * @param  resolution: Resolution, @ref TM_DS18B20_Resolution_t
+ * @retval Conversion time in milliseconds
+ */
+#define TM_DS18B20_ConversionTime(resolution)	((750 >> (12 - (resolution))) + 1)
+
 /**
  * @}
  */
@@ -126,6 +220,49 @@ typedef enum {
 	TM_DS18B20_Resolution_12bits = 12  /*!< DS18B20 12 bits resolution */
 } TM_DS18B20_Resolution_t;
 
+/**
+ * @brief  Sensor entry for poller
+ * @note   OneWire and ROM members must be set by user, Resolution is optional, others are updated by poller
+ */
+typedef struct {
+	TM_OneWire_t* OneWire;       /*!< OneWire bus where sensor is connected */
+	uint8_t ROM[8];              /*!< Sensor ROM address */
+	uint8_t Resolution;          /*!< Resolution set by poller, member of @ref TM_DS18B20_Resolution_t or 0 to keep sensor setting */
+	int16_t Raw;                 /*!< Last valid temperature in 1/16 degrees */
+#if DS18B20_POLLER_FLOAT || defined(DOXYGEN)
+	float Temperature;           /*!< Last valid temperature. Available when DS18B20_POLLER_FLOAT is enabled */
+#endif
+	uint32_t Timestamp;          /*!< Time in milliseconds of last valid temperature, @ref TM_DELAY_Time */
+	uint8_t Valid;               /*!< Set to 1 when last read was successful */
+	uint16_t Errors;             /*!< Number of failed reads */
+} TM_DS18B20_Sensor_t;
+
+/**
+ * @brief  OneWire bus entry for poller
+ * @note   OneWire and Resolution members must be set by user, Resolution must be the highest resolution of sensors on bus.
+ *         Poller increases it when sensor with higher Resolution member is on bus
+ */
+typedef struct {
+	TM_OneWire_t* OneWire;              /*!< OneWire bus */
+	TM_DS18B20_Resolution_t Resolution; /*!< Resolution used for conversion deadline */
+	TM_DELAY_Timer_t* Timer;            /*!< Conversion timer. This is private member */
+	volatile uint8_t Ready;             /*!< Conversion deadline reached. This is private member */
+	uint8_t Busy;                       /*!< Conversion is in progress or sensors are not read yet. This is private member */
+	uint16_t Next;                      /*!< Next sensor index to read. This is private member */
+	uint16_t Count;                     /*!< Number of sensors on bus, 1 for Skip ROM read. This is private member */
+} TM_DS18B20_Bus_t;
+
+/**
+ * @brief  Poller working structure
+ */
+typedef struct {
+	TM_DS18B20_Bus_t* Buses;      /*!< Pointer to table of buses */
+	TM_DS18B20_Sensor_t* Sensors; /*!< Pointer to table of sensors */
+	uint16_t SensorCount;         /*!< Number of sensors in table */
+	uint8_t BusCount;             /*!< Number of buses in table */
+	uint8_t Pending;              /*!< Number of buses not done yet */
+} TM_DS18B20_Poller_t;
+
 /**
  * @}
  */
@@ -165,6 +302,37 @@ void TM_DS18B20_StartAll(TM_OneWire_t* OneWireStruct);
  */
 uint8_t TM_DS18B20_Read(TM_OneWire_t* OneWireStruct, uint8_t* ROM, float* destination);
 
+/**
+ * @brief  Reads temperature from DS18B20 in fixed point format
+ * @note   Undefined low bits are cleared for lower resolutions. When DS18B20_USE_CRC is 0,
+ *         configuration register is not read and undefined low bits are not cleared
+ * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working structure (OneWire channel)
+ * @param  *ROM: Pointer to first byte of ROM address for desired DS12B80 device.
+ *         Entire ROM address is 8-bytes long
+ * @param  *destination: Pointer to variable to store temperature in 1/16 degrees
+ * @retval Temperature status:
+ *            - 0: Device is not DS18B20 or conversion is not done yet or CRC failed
+ *            - > 0: Temperature is read OK
+ */
+uint8_t TM_DS18B20_ReadRaw(TM_OneWire_t* OneWireStruct, uint8_t* ROM, int16_t* destination);
+
+#if DS18B20_USE_SERIES || defined(DOXYGEN)
+/**
+ * @brief  Reads temperature from DS18B20 directly to row of series store
+ * @note   Sample is in 1/16 degrees, it stays @ref SERIES_INVALID when read fails
+ * @note   Available when DS18B20_USE_SERIES is enabled
+ * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working structure (OneWire channel)
+ * @param  *ROM: Pointer to first byte of ROM address for desired DS12B80 device
+ * @param  *Series: Pointer to @ref TM_SERIES_t store
+ * @param  Row: Row index from @ref TM_SERIES_AddRow
+ * @param  Channel: Channel index for temperature
+ * @retval Temperature status:
+ *            - 0: Device is not DS18B20 or conversion is not done yet or CRC failed
+ *            - > 0: Temperature is saved to store
+ */
+uint8_t TM_DS18B20_ReadSeries(TM_OneWire_t* OneWireStruct, uint8_t* ROM, TM_SERIES_t* Series, uint16_t Row, uint8_t Channel);
+#endif
+
 /**
  * @brief  Gets resolution for temperature conversion from DS18B20 device
  * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working structure (OneWire channel)
@@ -259,6 +427,52 @@ uint8_t TM_DS18B20_AlarmSearch(TM_OneWire_t* OneWireStruct);
  */
 uint8_t TM_DS18B20_AllDone(TM_OneWire_t* OneWireStruct);
 
+/**
+ * @brief  Initializes poller and allocates conversion timer for each bus
+ * @note   Sensors with Resolution member set are configured here, EEPROM is written only when resolution is different
+ * @param  *Poller: Pointer to empty @ref TM_DS18B20_Poller_t structure
+ * @param  *Buses: Pointer to table of @ref TM_DS18B20_Bus_t buses
+ * @param  BusCount: Number of buses
+ * @param  *Sensors: Pointer to table of @ref TM_DS18B20_Sensor_t sensors
+ * @param  SensorCount: Number of sensors
+ * @retval Initialization status:
+ *            - 0: Poller is ready
+ *            - > 0: Timer could not be allocated
+ */
+uint8_t TM_DS18B20_PollerInit(TM_DS18B20_Poller_t* Poller, TM_DS18B20_Bus_t* Buses, uint8_t BusCount, TM_DS18B20_Sensor_t* Sensors, uint16_t SensorCount);
+
+/**
+ * @brief  Deinitializes poller and releases timers
+ * @param  *Poller: Pointer to @ref TM_DS18B20_Poller_t structure
+ * @retval None
+ */
+void TM_DS18B20_PollerDeInit(TM_DS18B20_Poller_t* Poller);
+
+/**
+ * @brief  Starts conversion on all buses
+ * @param  *Poller: Pointer to @ref TM_DS18B20_Poller_t structure
+ * @retval Start status:
+ *            - 0: Conversion started
+ *            - > 0: Previous sweep is not finished yet
+ */
+uint8_t TM_DS18B20_PollerStart(TM_DS18B20_Poller_t* Poller);
+
+/**
+ * @brief  Processes poller, reads at most one sensor on each bus with finished conversion
+ * @note   Call this function periodically from main loop
+ * @param  *Poller: Pointer to @ref TM_DS18B20_Poller_t structure
+ * @retval Number of buses which are not finished yet, 0 when sweep is done
+ */
+uint8_t TM_DS18B20_PollerProcess(TM_DS18B20_Poller_t* Poller);
+
+/**
+ * @brief  Called when all sensors on all buses are read
+ * @param  *Poller: Pointer to @ref TM_DS18B20_Poller_t structure
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_DS18B20_PollerCallback(TM_DS18B20_Poller_t* Poller);
+
 /**
  * @}
  */
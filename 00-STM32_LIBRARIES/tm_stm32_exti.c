@@ -18,6 +18,43 @@
  */
 #include "tm_stm32_exti.h"
 
+/* Per line callbacks */
+typedef struct {
+	TM_EXTI_Callback_t Callback;
+	void* Param;
+	GPIO_TypeDef* GPIOx;
+} TM_EXTI_INT_Line_t;
+
+static TM_EXTI_INT_Line_t EXTI_Lines[16];
+
+#if EXTI_EVENT_QUEUE_SIZE > 0
+/* Event queue, written only from EXTI interrupts with the same preemption priority */
+static TM_EXTI_Event_t EXTI_Events[EXTI_EVENT_QUEUE_SIZE];
+static volatile uint16_t EXTI_EventsIn, EXTI_EventsOut;
+static volatile uint32_t EXTI_EventsLostCount;
+static volatile uint16_t EXTI_EventLines;
+
+/* Event timestamp */
+#if defined(STM32F0xx)
+#define EXTI_INT_TIME()         HAL_GetTick()
+#else
+#define EXTI_INT_TIME()         DWT->CYCCNT
+#endif
+#endif
+
+/* Private functions */
+static void TM_EXTI_INT_Dispatch(uint32_t lines);
+static void TM_EXTI_INT_RemoveCallbacks(uint16_t GPIO_Line);
+static void TM_EXTI_INT_Call(void* Context, uint32_t line);
+
+/* Get highest set bit, Cortex-M0 has no CLZ instruction */
+#if defined(STM32F0xx)
+static uint8_t TM_EXTI_INT_Highest(uint32_t value);
+#define EXTI_INT_HIGHEST(x)     TM_EXTI_INT_Highest(x)
+#else
+#define EXTI_INT_HIGHEST(x)     (31 - __CLZ(x))
+#endif
+
 TM_EXTI_Result_t TM_EXTI_Attach(GPIO_TypeDef* GPIOx, uint16_t GPIO_Line, TM_EXTI_Trigger_t trigger) {
 	TM_GPIO_PuPd_t PuPd;
 	uint8_t pinsource, portsource;
@@ -128,6 +165,9 @@ TM_EXTI_Result_t TM_EXTI_Attach(GPIO_TypeDef* GPIOx, uint16_t GPIO_Line, TM_EXTI
 	/* Init GPIO pin */
 	TM_GPIO_Init(GPIOx, GPIO_Line, TM_GPIO_Mode_IN, TM_GPIO_OType_PP, PuPd, TM_GPIO_Speed_Low);
 	
+	/* Save port for line */
+	EXTI_Lines[TM_GPIO_GetPinSource(GPIO_Line)].GPIOx = GPIOx;
+	
 	/* Calculate pinsource */
 	pinsource = TM_GPIO_GetPinSource(GPIO_Line);
 	
@@ -174,6 +214,21 @@ TM_EXTI_Result_t TM_EXTI_Attach(GPIO_TypeDef* GPIOx, uint16_t GPIO_Line, TM_EXTI
 	return TM_EXTI_Result_Ok;
 }
 
+TM_EXTI_Result_t TM_EXTI_AttachCallback(GPIO_TypeDef* GPIOx, uint16_t GPIO_Line, TM_EXTI_Trigger_t trigger, TM_EXTI_Callback_t Callback, void* Param) {
+	uint8_t i;
+	
+	/* Save callbacks first, lines can trigger immediately */
+	for (i = 0; i < 0x10; i++) {
+		if ((GPIO_Line & (1 << i)) && !(EXTI->IMR & (1 << i)) && !(EXTI->EMR & (1 << i))) {
+			EXTI_Lines[i].Callback = Callback;
+			EXTI_Lines[i].Param = Param;
+		}
+	}
+	
+	/* Attach lines */
+	return TM_EXTI_Attach(GPIOx, GPIO_Line, trigger);
+}
+
 TM_EXTI_Result_t TM_EXTI_Detach(uint16_t GPIO_Line) {
 	/* Disable EXTI for specific GPIO line */
 	EXTI->IMR &= ~GPIO_Line;
@@ -183,6 +238,9 @@ TM_EXTI_Result_t TM_EXTI_Detach(uint16_t GPIO_Line) {
 	EXTI->FTSR &= ~GPIO_Line;
 	EXTI->RTSR &= ~GPIO_Line;
 	
+	/* Remove callbacks */
+	TM_EXTI_INT_RemoveCallbacks(GPIO_Line);
+	
 	/* Return OK */
 	return TM_EXTI_Result_Ok;
 }
@@ -194,6 +252,9 @@ void TM_EXTI_DeInit(void) {
 	EXTI->FTSR &= 0xFFFF0000;
 	EXTI->RTSR &= 0xFFFF0000;
 	EXTI->PR &= 0xFFFF0000;
+	
+	/* Remove callbacks */
+	TM_EXTI_INT_RemoveCallbacks(0xFFFF);
 }
 
 __weak void TM_EXTI_Handler(uint16_t GPIO_Pin) {
@@ -202,6 +263,152 @@ __weak void TM_EXTI_Handler(uint16_t GPIO_Pin) {
    */ 
 }
 
+#if EXTI_EVENT_QUEUE_SIZE > 0
+void TM_EXTI_EnableEvents(uint16_t GPIO_Line) {
+#if !defined(STM32F0xx)
+	/* Enable DWT cycle counter for timestamps */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	
+	/* Set lines */
+	EXTI_EventLines |= GPIO_Line;
+}
+
+void TM_EXTI_DisableEvents(uint16_t GPIO_Line) {
+	/* Clear lines */
+	EXTI_EventLines &= ~GPIO_Line;
+}
+
+uint16_t TM_EXTI_GetEvents(TM_EXTI_Event_t* Events, uint16_t count) {
+	uint16_t out = EXTI_EventsOut, read = 0;
+	
+	/* Copy events until queue is empty */
+	while (read < count && out != EXTI_EventsIn) {
+		Events[read++] = EXTI_Events[out];
+		out = (out + 1) & (EXTI_EVENT_QUEUE_SIZE - 1);
+	}
+	
+	/* Free read events */
+	EXTI_EventsOut = out;
+	
+	/* Return number of read events */
+	return read;
+}
+
+uint32_t TM_EXTI_EventsLost(void) {
+	/* Return lost events */
+	return EXTI_EventsLostCount;
+}
+#endif
+
+/* Private functions */
+static void TM_EXTI_INT_RemoveCallbacks(uint16_t GPIO_Line) {
+	uint8_t i;
+	
+	/* Clear callbacks for lines */
+	for (i = 0; i < 0x10; i++) {
+		if (GPIO_Line & (1 << i)) {
+			EXTI_Lines[i].Callback = NULL;
+			EXTI_Lines[i].Param = NULL;
+		}
+	}
+}
+
+#if defined(STM32F0xx)
+static uint8_t TM_EXTI_INT_Highest(uint32_t value) {
+	uint8_t line = 0;
+	
+	/* Binary search for highest set bit, only 16 GPIO lines */
+	if (value & 0xFF00) {
+		line += 8;
+		value >>= 8;
+	}
+	if (value & 0xF0) {
+		line += 4;
+		value >>= 4;
+	}
+	if (value & 0x0C) {
+		line += 2;
+		value >>= 2;
+	}
+	if (value & 0x02) {
+		line += 1;
+	}
+	
+	return line;
+}
+#endif
+
+static void TM_EXTI_INT_Dispatch(uint32_t lines) {
+	uint32_t pending;
+	uint8_t line;
+#if EXTI_EVENT_QUEUE_SIZE > 0
+	uint32_t time;
+	uint16_t in, next;
+	uint32_t events;
+#endif
+	
+	/* Get all pending lines for this handler and clear them at once */
+	pending = EXTI->PR & lines;
+	EXTI->PR = pending;
+	
+#if EXTI_EVENT_QUEUE_SIZE > 0
+	/* Save events for lines in event mode */
+	events = pending & EXTI_EventLines;
+	if (events) {
+		time = EXTI_INT_TIME();
+		pending &= ~events;
+		in = EXTI_EventsIn;
+		
+		while (events) {
+			line = EXTI_INT_HIGHEST(events);
+			events &= ~(1UL << line);
+			
+			/* Check for free space */
+			next = (in + 1) & (EXTI_EVENT_QUEUE_SIZE - 1);
+			if (next == EXTI_EventsOut) {
+				EXTI_EventsLostCount++;
+				continue;
+			}
+			
+			/* Save event */
+			EXTI_Events[in].Time = time;
+			EXTI_Events[in].Line = line;
+			EXTI_Events[in].Level = (EXTI_Lines[line].GPIOx->IDR >> line) & 0x01;
+			in = next;
+		}
+		
+		/* Publish events */
+		EXTI_EventsIn = in;
+	}
+#endif
+	
+	/* Process all lines in one pass */
+	while (pending) {
+		/* Get highest pending line */
+		line = EXTI_INT_HIGHEST(pending);
+		pending &= ~(1UL << line);
+		
+#if EXTI_DEFER
+		/* Call line or global function later */
+		TM_DEFER_Call(TM_EXTI_INT_Call, NULL, line);
+#else
+		/* Call line or global function */
+		TM_EXTI_INT_Call(NULL, line);
+#endif
+	}
+}
+
+static void TM_EXTI_INT_Call(void* Context, uint32_t line) {
+	/* Call line or global function */
+	if (EXTI_Lines[line].Callback) {
+		EXTI_Lines[line].Callback(1 << line, EXTI_Lines[line].Param);
+	} else {
+		TM_EXTI_Handler(1 << line);
+	}
+}
+
 /******************************************************************/
 /*              STM32F4xx and STM32F7xx IRQ handlers              */
 /******************************************************************/
@@ -210,148 +417,50 @@ __weak void TM_EXTI_Handler(uint16_t GPIO_Pin) {
 
 #ifndef TM_EXTI_DISABLE_DEFAULT_HANDLER_0
 void EXTI0_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR0)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR0;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_0);
-	}
+	/* Dispatch line */
+	TM_EXTI_INT_Dispatch(EXTI_PR_PR0);
 }
 #endif
 
 #ifndef EXTI_DISABLE_DEFAULT_HANDLER_1
 void EXTI1_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR1)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR1;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_1);
-	}
+	/* Dispatch line */
+	TM_EXTI_INT_Dispatch(EXTI_PR_PR1);
 }
 #endif
 
 #ifndef EXTI_DISABLE_DEFAULT_HANDLER_2
 void EXTI2_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR2)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR2;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_2);
-	}
+	/* Dispatch line */
+	TM_EXTI_INT_Dispatch(EXTI_PR_PR2);
 }
 #endif
 
 #ifndef EXTI_DISABLE_DEFAULT_HANDLER_3
 void EXTI3_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR3)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR3;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_3);
-	}
+	/* Dispatch line */
+	TM_EXTI_INT_Dispatch(EXTI_PR_PR3);
 }
 #endif
 
 #ifndef EXTI_DISABLE_DEFAULT_HANDLER_4
 void EXTI4_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR4)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR4;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_4);
-	}
+	/* Dispatch line */
+	TM_EXTI_INT_Dispatch(EXTI_PR_PR4);
 }
 #endif
 
 #ifndef EXTI_DISABLE_DEFAULT_HANDLER_9_5
 void EXTI9_5_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR5)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR5;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_5);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR6)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR6;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_6);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR7)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR7;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_7);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR8)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR8;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_8);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR9)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR9;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_9);
-	}
+	/* Dispatch all pending lines 5 to 9 */
+	TM_EXTI_INT_Dispatch(0x03E0);
 }
 #endif
 
 #ifndef EXTI_DISABLE_DEFAULT_HANDLER_15_10
 void EXTI15_10_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR10)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR10;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_10);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR11)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR11;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_11);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR12)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR12;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_12);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR13)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR13;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_13);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR14)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR14;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_14);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR15)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR15;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_15);
-	}
+	/* Dispatch all pending lines 10 to 15 */
+	TM_EXTI_INT_Dispatch(0xFC00);
 }
 #endif
 
@@ -365,128 +474,22 @@ void EXTI15_10_IRQHandler(void) {
 
 #ifndef TM_EXTI_DISABLE_DEFAULT_HANDLER_0_1
 void EXTI0_1_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR0)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR0;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_0);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR1)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR1;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_1);
-	}
+	/* Dispatch all pending lines 0 and 1 */
+	TM_EXTI_INT_Dispatch(0x0003);
 }
 #endif
 
 #ifndef TM_EXTI_DISABLE_DEFAULT_HANDLER_2_3
 void EXTI2_3_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR2)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR2;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_2);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR3)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR3;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_3);
-	}
+	/* Dispatch all pending lines 2 and 3 */
+	TM_EXTI_INT_Dispatch(0x000C);
 }
 #endif
 
 #ifndef TM_EXTI_DISABLE_DEFAULT_HANDLER_4_15
 void EXTI4_15_IRQHandler(void) {
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR4)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR4;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_4);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR5)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR5;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_5);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR6)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR6;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_6);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR7)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR7;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_7);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR8)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR8;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_8);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR9)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR9;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_9);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR10)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR10;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_10);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR11)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR11;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_11);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR12)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR12;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_12);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR13)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR13;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_13);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR14)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR14;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_14);
-	}
-	/* Check status */
-	if (EXTI->PR & (EXTI_PR_PR15)) {
-		/* Clear bit */
-		EXTI->PR = EXTI_PR_PR15;
-		/* Call global function */
-		TM_EXTI_Handler(GPIO_PIN_15);
-	}
+	/* Dispatch all pending lines 4 to 15 */
+	TM_EXTI_INT_Dispatch(0xFFF0);
 }
 #endif
 
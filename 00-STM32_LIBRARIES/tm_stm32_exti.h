@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-4-exti-for-stm32fxxx/
- * @version v1.0
+ * @version v1.4
  * @ide     Keil uVision
  * @license MIT
  * @brief   External interrupts library for STM32Fxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_EXTI_H
-#define TM_EXTI_H 100
+#define TM_EXTI_H 140
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -109,6 +109,38 @@ extern "C" {
 \code
 //Set custom NVIC priority
 #define EXTI_NVIC_PRIORITY      0x04
+\endcode
+ *
+ * \par Per line callbacks
+ *
+ * Instead of one global @ref TM_EXTI_Handler function, each line can have own callback function with user parameter.
+ * Use @ref TM_EXTI_AttachCallback function for that. Lines attached with @ref TM_EXTI_Attach still call @ref TM_EXTI_Handler.
+ *
+ * Each IRQ handler clears all pending lines at once and dispatches them in one pass, highest line first.
+ *
+ * \par Event queue
+ *
+ * For pulse counting and period measurement, lines can be switched to event mode with @ref TM_EXTI_EnableEvents.
+ * Interrupt then only saves line number, timestamp and pin level into ring buffer and returns.
+ * Events are read later from main loop in bulk with @ref TM_EXTI_GetEvents.
+ *
+ * Timestamp is DWT cycle counter on STM32F4xx and STM32F7xx and milliseconds tick on STM32F0xx.
+ * Event queue is disabled by default, enable it in defines.h file:
+ *
+\code
+//Number of events in queue, must be power of 2
+#define EXTI_EVENT_QUEUE_SIZE    64
+\endcode
+ *
+ * \par Deferred callbacks
+ *
+ * With EXTI_DEFER enabled in defines.h file, interrupt only clears pending lines and queues them to @ref TM_DEFER library.
+ * Line callbacks and @ref TM_EXTI_Handler are then called from PendSV or deferred work task, so long user code
+ * does not block other interrupts. Call @ref TM_DEFER_Init before lines are attached.
+ *
+\code
+//Call EXTI callbacks outside of EXTI interrupt
+#define EXTI_DEFER               1
 \endcode
  *
  * \par Changelog
@@ -116,6 +148,23 @@ extern "C" {
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added per line callbacks with user parameter, TM_EXTI_AttachCallback function
+  - IRQ handlers dispatch all pending lines in one pass
+  
+ Version 1.2
+  - October 14, 2026
+  - Added time-stamped event queue
+  
+ Version 1.3
+  - October 14, 2026
+  - Added EXTI_DEFER option to call line callbacks and TM_EXTI_Handler outside of interrupt with TM DEFER library
+  
+ Version 1.4
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
 \endverbatim
  *
  * \par Dependencies
@@ -125,6 +174,7 @@ extern "C" {
  - defines.h
  - attributes.h
  - TM GPIO
+ - TM DEFER (only when EXTI_DEFER)
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
@@ -142,7 +192,29 @@ extern "C" {
  * @brief  Default EXTI preemption priority for EXTI lines used in NVIC
  */
 #ifndef EXTI_NVIC_PRIORITY
-#define EXTI_NVIC_PRIORITY     0x03
+#define EXTI_NVIC_PRIORITY     NVIC_PRIORITY_LOW
+#endif
+
+/**
+ * @brief  Number of events in event queue, 0 to disable, must be power of 2
+ */
+#ifndef EXTI_EVENT_QUEUE_SIZE
+#define EXTI_EVENT_QUEUE_SIZE  0
+#endif
+
+#if EXTI_EVENT_QUEUE_SIZE & (EXTI_EVENT_QUEUE_SIZE - 1)
+#error "EXTI_EVENT_QUEUE_SIZE must be power of 2!"
+#endif
+
+/**
+ * @brief  Call callbacks from deferred context with TM DEFER library
+ */
+#ifndef EXTI_DEFER
+#define EXTI_DEFER             0
+#endif
+
+#if EXTI_DEFER
+#include "tm_stm32_defer.h"
 #endif
 
  /**
@@ -172,6 +244,22 @@ typedef enum {
 	TM_EXTI_Trigger_Rising_Falling /*!< Trigger interrupt on any edge on line, no pull resistor active */
 } TM_EXTI_Trigger_t;
 
+/**
+ * @brief  Per line callback function
+ * @param  GPIO_Pin: GPIO Line where interrupt occurred
+ * @param  *Param: User parameter set on attach
+ */
+typedef void (*TM_EXTI_Callback_t)(uint16_t GPIO_Pin, void* Param);
+
+/**
+ * @brief  Event in event queue
+ */
+typedef struct {
+	uint32_t Time; /*!< DWT cycle counter on STM32F4xx and STM32F7xx, milliseconds on STM32F0xx */
+	uint8_t Line;  /*!< EXTI line number, 0 to 15 */
+	uint8_t Level; /*!< Pin level in interrupt, 0 or 1 */
+} TM_EXTI_Event_t;
+
 /**
  * @}
  */
@@ -206,6 +294,20 @@ typedef enum {
  */
 TM_EXTI_Result_t TM_EXTI_Attach(GPIO_TypeDef* GPIOx, uint16_t GPIO_Line, TM_EXTI_Trigger_t trigger);
 
+/**
+ * @brief  Attach external interrupt on specific GPIO pin with own callback function
+ * @note   Works the same as @ref TM_EXTI_Attach, but interrupt calls Callback instead of @ref TM_EXTI_Handler
+ * @param  *GPIOx: GPIO port where you want EXTI interrupt line
+ * @param  GPIO_Line: GPIO pin where you want EXTI interrupt line. Use OR (|) operator for more pins with the same callback
+ * @param  trigger: Pin trigger source. This parameter can be a value of @ref TM_EXTI_Trigger_t enumeration
+ * @param  Callback: Callback function called from interrupt. Set to NULL to use @ref TM_EXTI_Handler
+ * @param  *Param: User parameter passed to callback function
+ * @retval Attach result:
+ *            - @arg TM_EXTI_Result_Ok: Everything ok, interrupt attached
+ *            - @arg TM_EXTI_Result_Error: An error occurred, interrupt was not attached
+ */
+TM_EXTI_Result_t TM_EXTI_AttachCallback(GPIO_TypeDef* GPIOx, uint16_t GPIO_Line, TM_EXTI_Trigger_t trigger, TM_EXTI_Callback_t Callback, void* Param);
+
 /**
  * @brief  Detach GPIO pin from interrupt lines
  * @param  GPIO_Line: GPIO line you want to disable. Valid GPIO is GPIO_Pin_0 to GPIO_Pin_15. 
@@ -225,6 +327,36 @@ TM_EXTI_Result_t TM_EXTI_Detach(uint16_t GPIO_Line);
  */
 void TM_EXTI_DeInit(void);
 
+/**
+ * @brief  Switches lines to event mode, interrupt saves events for these lines to queue
+ * @note   Available when EXTI_EVENT_QUEUE_SIZE is greater than 0. Lines must also be attached
+ * @param  GPIO_Line: GPIO lines for event mode. Use OR (|) operator for more lines
+ * @retval None
+ */
+void TM_EXTI_EnableEvents(uint16_t GPIO_Line);
+
+/**
+ * @brief  Switches lines back to callback mode
+ * @param  GPIO_Line: GPIO lines. Use OR (|) operator for more lines
+ * @retval None
+ */
+void TM_EXTI_DisableEvents(uint16_t GPIO_Line);
+
+/**
+ * @brief  Reads events from event queue
+ * @param  *Events: Pointer to array to save events
+ * @param  count: Maximal number of events to read
+ * @retval Number of read events
+ */
+uint16_t TM_EXTI_GetEvents(TM_EXTI_Event_t* Events, uint16_t count);
+
+/**
+ * @brief  Gets number of events lost because queue was full
+ * @param  None
+ * @retval Number of lost events
+ */
+uint32_t TM_EXTI_EventsLost(void);
+
 /**
  * @brief  Creates software interrupt for specific external GPIO line
  * @note   This also works for others EXTI lines from 16 to 23
@@ -27,6 +27,29 @@
 
 /* Private functions */
 static FRESULT scan_files(char* path, uint16_t tmp_buffer_size, TM_FATFS_Search_t* FindStructure);
+static FRESULT index_scan(TM_FATFS_Index_t* Index, char* path, uint16_t parent, FILINFO* fno);
+static uint32_t index_hash(const char* path, int32_t len);
+static void index_fill(TM_FATFS_IndexEntry_t* Entry, FILINFO* fno, uint32_t hash, uint16_t parent);
+static int32_t index_compare(TM_FATFS_Index_t* Index, uint16_t a, uint16_t b);
+static uint8_t index_match(const char* str, const char* match, uint8_t full);
+static FRESULT TM_FATFS_INT_AppendWrite(TM_FATFS_Append_t* Append, const void* Data, uint32_t Size);
+
+#if FATFS_USE_WORKER
+/* Worker request */
+typedef struct {
+	TM_FATFS_Worker_Type_t Type; /* Request type */
+	FIL* fp;                     /* File object */
+	uint32_t Size;               /* Number of data bytes for write */
+	uint8_t Data[FATFS_WORKER_DATA_SIZE]; /* Copy of data for write */
+} TM_FATFS_INT_Request_t;
+
+/* Queue and thread definitions, each worker gets own instance on create */
+osMailQDef(FATFS_Worker_Queue, FATFS_WORKER_QUEUE_LEN, TM_FATFS_INT_Request_t);
+static void TM_FATFS_INT_WorkerThread(void const* argument);
+osThreadDef(FATFS_Worker, TM_FATFS_INT_WorkerThread, FATFS_WORKER_PRIORITY, 0, FATFS_WORKER_STACK_SIZE);
+
+static FRESULT TM_FATFS_INT_WorkerPost(TM_FATFS_Worker_t* Worker, TM_FATFS_Worker_Type_t Type, FIL* fp, const void* Data, uint32_t Size);
+#endif
 
 FRESULT TM_FATFS_GetDriveSize(char* str, TM_FATFS_Size_t* SizeStruct) {
 	FATFS *fs;
@@ -250,3 +273,816 @@ static FRESULT scan_files(char* path, uint16_t tmp_buffer_size, TM_FATFS_Search_
 	/* Return result */
 	return res;
 }
+
+FRESULT TM_FATFS_IndexCreate(TM_FATFS_Index_t* Index, const char* Folder, void* Memory, uint32_t MemorySize) {
+	char path[FATFS_INDEX_PATH_LEN];
+	static FILINFO fno;
+	
+	/* Split memory to entries and order table */
+	Index->Size = MemorySize / (sizeof(TM_FATFS_IndexEntry_t) + sizeof(uint16_t));
+	if (Index->Size > FATFS_INDEX_ROOT) {
+		Index->Size = FATFS_INDEX_ROOT;
+	}
+	Index->Entries = (TM_FATFS_IndexEntry_t *)Memory;
+	Index->Order = (uint16_t *)&Index->Entries[Index->Size];
+	Index->Count = 0;
+	Index->Sort = TM_FATFS_IndexSort_None;
+	Index->RootHash = index_hash(Folder, -1);
+	
+	/* Check path */
+	if (strlen(Folder) >= sizeof(path)) {
+		return FR_NOT_ENOUGH_CORE;
+	}
+	strcpy(path, Folder);
+	
+	/* Read tree */
+	return index_scan(Index, path, FATFS_INDEX_ROOT, &fno);
+}
+
+FRESULT TM_FATFS_IndexUpdate(TM_FATFS_Index_t* Index, const char* path) {
+	TM_FATFS_IndexEntry_t* Entry;
+	char parent_path[FATFS_INDEX_PATH_LEN];
+	static FILINFO fno;
+	FRESULT res;
+	uint32_t hash, i, changed;
+	int32_t len, sep;
+	uint16_t parent;
+	
+	/* Find existing entry */
+	hash = index_hash(path, -1);
+	Entry = TM_FATFS_IndexFind(Index, path);
+	
+	/* Read file information */
+	res = f_stat(path, &fno);
+	if (res == FR_NO_FILE || res == FR_NO_PATH) {
+		/* File was deleted, remove entry and all entries inside it */
+		if (Entry != NULL) {
+			Entry->Attr |= FATFS_INDEX_REMOVED;
+			do {
+				changed = 0;
+				for (i = 0; i < Index->Count; i++) {
+					if (
+						!(Index->Entries[i].Attr & FATFS_INDEX_REMOVED) &&
+						Index->Entries[i].Parent != FATFS_INDEX_ROOT &&
+						(Index->Entries[Index->Entries[i].Parent].Attr & FATFS_INDEX_REMOVED)
+					) {
+						Index->Entries[i].Attr |= FATFS_INDEX_REMOVED;
+						changed = 1;
+					}
+				}
+			} while (changed);
+		}
+		return FR_OK;
+	} else if (res != FR_OK) {
+		return res;
+	}
+	
+	/* Update existing entry */
+	if (Entry != NULL) {
+		index_fill(Entry, &fno, hash, Entry->Parent);
+		return FR_OK;
+	}
+	
+	/* Find last separator, ignore trailing separators */
+	len = strlen(path);
+	while (len > 0 && (path[len - 1] == '/' || path[len - 1] == '\\')) {
+		len--;
+	}
+	sep = len - 1;
+	while (sep >= 0 && path[sep] != '/' && path[sep] != '\\' && path[sep] != ':') {
+		sep--;
+	}
+	if (sep < 0 || sep >= (int32_t)sizeof(parent_path)) {
+		return FR_INVALID_NAME;
+	}
+	
+	/* Get parent entry */
+	if (index_hash(path, path[sep] == ':' ? sep + 1 : sep) == Index->RootHash) {
+		parent = FATFS_INDEX_ROOT;
+	} else {
+		/* Parent path outside index */
+		if (path[sep] == ':') {
+			return FR_INVALID_NAME;
+		}
+		
+		/* Find or add parent folder */
+		memcpy(parent_path, path, sep);
+		parent_path[sep] = 0;
+		if ((Entry = TM_FATFS_IndexFind(Index, parent_path)) == NULL) {
+			if ((res = TM_FATFS_IndexUpdate(Index, parent_path)) != FR_OK) {
+				return res;
+			}
+			if ((Entry = TM_FATFS_IndexFind(Index, parent_path)) == NULL) {
+				return FR_NO_PATH;
+			}
+		}
+		parent = Entry - Index->Entries;
+		
+		/* Parent was read from card again, refresh file info */
+		if ((res = f_stat(path, &fno)) != FR_OK) {
+			return res;
+		}
+	}
+	
+	/* Check memory */
+	if (Index->Count >= Index->Size) {
+		return FR_NOT_ENOUGH_CORE;
+	}
+	
+	/* Add new entry to the end of order */
+	index_fill(&Index->Entries[Index->Count], &fno, hash, parent);
+	Index->Order[Index->Count] = Index->Count;
+	Index->Count++;
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+TM_FATFS_IndexEntry_t* TM_FATFS_IndexFind(TM_FATFS_Index_t* Index, const char* path) {
+	uint32_t hash, i;
+	int32_t len, start;
+	
+	/* Get hash and name of last path part */
+	hash = index_hash(path, -1);
+	len = strlen(path);
+	while (len > 0 && (path[len - 1] == '/' || path[len - 1] == '\\')) {
+		len--;
+	}
+	start = len;
+	while (start > 0 && path[start - 1] != '/' && path[start - 1] != '\\' && path[start - 1] != ':') {
+		start--;
+	}
+	
+	/* Compare hash and name */
+	for (i = 0; i < Index->Count; i++) {
+		if (
+			Index->Entries[i].Hash == hash &&
+			!(Index->Entries[i].Attr & FATFS_INDEX_REMOVED) &&
+			index_match(&path[start], Index->Entries[i].Name, 0)
+		) {
+			return &Index->Entries[i];
+		}
+	}
+	
+	/* Not found */
+	return NULL;
+}
+
+void TM_FATFS_IndexSort(TM_FATFS_Index_t* Index, TM_FATFS_IndexSort_t Sort) {
+	uint32_t gap, i, j;
+	uint16_t tmp;
+	
+	/* Reset order */
+	Index->Sort = Sort;
+	for (i = 0; i < Index->Count; i++) {
+		Index->Order[i] = i;
+	}
+	if (Sort == TM_FATFS_IndexSort_None) {
+		return;
+	}
+	
+	/* Shell sort, does not need any additional memory */
+	for (gap = Index->Count / 2; gap > 0; gap /= 2) {
+		for (i = gap; i < Index->Count; i++) {
+			tmp = Index->Order[i];
+			for (j = i; j >= gap && index_compare(Index, Index->Order[j - gap], tmp) > 0; j -= gap) {
+				Index->Order[j] = Index->Order[j - gap];
+			}
+			Index->Order[j] = tmp;
+		}
+	}
+}
+
+int32_t TM_FATFS_IndexSearch(TM_FATFS_Index_t* Index, int32_t start, const char* Prefix, const char* Ext) {
+	TM_FATFS_IndexEntry_t* Entry;
+	
+	/* Check all entries from start */
+	for (; start >= 0 && start < (int32_t)Index->Count; start++) {
+		Entry = &Index->Entries[Index->Order[start]];
+		
+		/* Check entry */
+		if (
+			!(Entry->Attr & FATFS_INDEX_REMOVED) &&
+			(Prefix == NULL || index_match(Entry->Name, Prefix, 0)) &&
+			(Ext == NULL || index_match(Entry->Ext, Ext, 1))
+		) {
+			return start;
+		}
+	}
+	
+	/* Not found */
+	return -1;
+}
+
+TM_FATFS_IndexEntry_t* TM_FATFS_IndexGet(TM_FATFS_Index_t* Index, uint32_t pos) {
+	/* Check position */
+	if (pos >= Index->Count) {
+		return NULL;
+	}
+	
+	/* Return entry */
+	return &Index->Entries[Index->Order[pos]];
+}
+
+uint16_t TM_FATFS_IndexGetPath(TM_FATFS_Index_t* Index, TM_FATFS_IndexEntry_t* Entry, char* str, uint16_t size) {
+	TM_FATFS_IndexEntry_t* e;
+	uint16_t len = 0, n;
+	
+	/* Get path length first */
+	for (e = Entry; e != NULL; e = e->Parent != FATFS_INDEX_ROOT ? &Index->Entries[e->Parent] : NULL) {
+		len += strlen(e->Name) + 1;
+	}
+	if (len >= size) {
+		return 0;
+	}
+	
+	/* Fill string from the end */
+	str[len] = 0;
+	n = len;
+	for (e = Entry; e != NULL; e = e->Parent != FATFS_INDEX_ROOT ? &Index->Entries[e->Parent] : NULL) {
+		n -= strlen(e->Name);
+		memcpy(&str[n], e->Name, strlen(e->Name));
+		str[--n] = '/';
+	}
+	
+	/* Return length */
+	return len;
+}
+
+FRESULT TM_FATFS_Preallocate(FIL* fil, FSIZE_t size) {
+#if _USE_EXPAND
+	FRESULT res;
+	
+	/* Allocate contiguous clusters */
+	if ((res = f_expand(fil, size, 1)) != FR_OK) {
+		return res;
+	}
+	
+	/* Write directory entry so allocation is not lost */
+	return f_sync(fil);
+#else
+	return FR_DENIED;
+#endif
+}
+
+FRESULT TM_FATFS_AppendOpen(TM_FATFS_Append_t* Append, FIL* fil, void* Buffer, uint32_t Size, uint32_t Timeout) {
+	FRESULT res;
+	
+	/* Default size */
+	if (Size == 0) {
+		Size = FATFS_APPEND_BUFFER_SIZE;
+	}
+	
+	/* Check parameters, DMA needs aligned buffer */
+	if (Size % 512 || ((uint32_t)Buffer & 0x03)) {
+		return FR_INVALID_PARAMETER;
+	}
+	
+	/* Allocate buffer */
+	Append->Allocated = 0;
+	if (Buffer == NULL) {
+		Buffer = LIB_ALLOC_FUNC(Size);
+		if (Buffer == NULL) {
+			return FR_NOT_ENOUGH_CORE;
+		}
+		Append->Allocated = 1;
+	}
+	
+	/* Fill structure */
+	Append->fp = fil;
+	Append->Buffer = (uint8_t *)Buffer;
+	Append->Size = Size;
+	Append->Count = 0;
+	Append->Timeout = Timeout;
+	Append->Time = 0;
+	
+	/* Go to end of file */
+	if ((res = f_lseek(fil, f_size(fil))) != FR_OK) {
+		if (Append->Allocated) {
+			LIB_FREE_FUNC(Append->Buffer);
+		}
+		Append->Buffer = NULL;
+		return res;
+	}
+	
+	/* First write fills file up to next boundary */
+	Append->Limit = Size - (uint32_t)(f_tell(fil) % Size);
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+FRESULT TM_FATFS_AppendWrite(TM_FATFS_Append_t* Append, const void* Data, uint32_t Size) {
+	const uint8_t* ptr = (const uint8_t *)Data;
+	uint32_t len;
+	FRESULT res;
+	
+	while (Size) {
+		/* Write whole blocks directly from aligned user memory when file is on boundary */
+		if (Append->Count == 0 && Append->Limit == Append->Size && Size >= Append->Size && !((uint32_t)ptr & 0x03)) {
+			len = Size - Size % Append->Size;
+			if ((res = TM_FATFS_INT_AppendWrite(Append, ptr, len)) != FR_OK) {
+				return res;
+			}
+			ptr += len;
+			Size -= len;
+			continue;
+		}
+		
+		/* Save time of oldest data */
+		if (Append->Count == 0) {
+			Append->Time = HAL_GetTick();
+		}
+		
+		/* Copy to buffer up to next boundary */
+		len = Append->Limit - Append->Count;
+		if (len > Size) {
+			len = Size;
+		}
+		memcpy(&Append->Buffer[Append->Count], ptr, len);
+		Append->Count += len;
+		ptr += len;
+		Size -= len;
+		
+		/* Write when boundary is reached */
+		if (Append->Count == Append->Limit) {
+			if ((res = TM_FATFS_INT_AppendWrite(Append, Append->Buffer, Append->Count)) != FR_OK) {
+				return res;
+			}
+		}
+	}
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+FRESULT TM_FATFS_AppendUpdate(TM_FATFS_Append_t* Append) {
+	/* Check age of buffered data */
+	if (Append->Timeout && Append->Count && (HAL_GetTick() - Append->Time) >= Append->Timeout) {
+		return TM_FATFS_AppendFlush(Append);
+	}
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+FRESULT TM_FATFS_AppendFlush(TM_FATFS_Append_t* Append) {
+	FRESULT res;
+	
+	/* Write partial buffer */
+	if (Append->Count) {
+		if ((res = TM_FATFS_INT_AppendWrite(Append, Append->Buffer, Append->Count)) != FR_OK) {
+			return res;
+		}
+	}
+	
+	/* Write FIL buffer and directory entry */
+	return f_sync(Append->fp);
+}
+
+FRESULT TM_FATFS_AppendClose(TM_FATFS_Append_t* Append) {
+	FRESULT res = FR_OK;
+	
+	/* Write remaining data */
+	if (Append->Count) {
+		res = TM_FATFS_INT_AppendWrite(Append, Append->Buffer, Append->Count);
+	}
+	
+	/* Release buffer */
+	if (Append->Allocated && Append->Buffer != NULL) {
+		LIB_FREE_FUNC(Append->Buffer);
+	}
+	Append->Buffer = NULL;
+	Append->Count = 0;
+	
+	/* Close file, report first error */
+	if (res == FR_OK) {
+		res = f_close(Append->fp);
+	} else {
+		f_close(Append->fp);
+	}
+	
+	/* Return result */
+	return res;
+}
+
+#if _USE_FASTSEEK
+FRESULT TM_FATFS_FastSeekEnable(FIL* fil, TM_FATFS_FastSeek_t* FastSeek) {
+	FRESULT res;
+	uint32_t size;
+	
+	/* Use initial size on first call */
+	size = FastSeek->Size ? FastSeek->Size : FATFS_FASTSEEK_TABLE_SIZE;
+	
+	while (1) {
+		/* Allocate table if needed */
+		if (FastSeek->Table == NULL || FastSeek->Size < size) {
+			if (FastSeek->Table != NULL) {
+				LIB_FREE_FUNC(FastSeek->Table);
+			}
+			FastSeek->Table = (DWORD *) LIB_ALLOC_FUNC(size * sizeof(DWORD));
+			FastSeek->Size = FastSeek->Table != NULL ? size : 0;
+			if (FastSeek->Table == NULL) {
+				fil->cltbl = NULL;
+				return FR_NOT_ENOUGH_CORE;
+			}
+		}
+		
+		/* Create link map, first entry is table size */
+		FastSeek->Table[0] = FastSeek->Size;
+		fil->cltbl = FastSeek->Table;
+		res = f_lseek(fil, CREATE_LINKMAP);
+		if (res != FR_NOT_ENOUGH_CORE) {
+			break;
+		}
+		
+		/* First entry holds required size, increase it to have space for new fragments */
+		size = FastSeek->Table[0] + FATFS_FASTSEEK_TABLE_SIZE;
+	}
+	
+	/* Go back to normal mode on error */
+	if (res != FR_OK) {
+		fil->cltbl = NULL;
+	}
+	
+	/* Return result */
+	return res;
+}
+
+void TM_FATFS_FastSeekDisable(FIL* fil, TM_FATFS_FastSeek_t* FastSeek) {
+	/* Normal seek mode */
+	fil->cltbl = NULL;
+	
+	/* Free table */
+	if (FastSeek->Table != NULL) {
+		LIB_FREE_FUNC(FastSeek->Table);
+	}
+	FastSeek->Table = NULL;
+	FastSeek->Size = 0;
+}
+#endif
+
+#if FATFS_USE_WORKER
+FRESULT TM_FATFS_WorkerStart(TM_FATFS_Worker_t* Worker, TM_FATFS_Worker_Callback_t Callback, void* Param) {
+	/* Fill structure */
+	Worker->Pending = 0;
+	Worker->Result = FR_OK;
+	Worker->Callback = Callback;
+	Worker->Param = Param;
+	
+	/* Create queue, thread is created after queue so it never sees invalid queue */
+	Worker->Queue = osMailCreate(osMailQ(FATFS_Worker_Queue), NULL);
+	if (Worker->Queue == NULL) {
+		return FR_NOT_ENOUGH_CORE;
+	}
+	
+	/* Create worker thread */
+	Worker->Thread = osThreadCreate(osThread(FATFS_Worker), Worker);
+	if (Worker->Thread == NULL) {
+		return FR_NOT_ENOUGH_CORE;
+	}
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+FRESULT TM_FATFS_WorkerWrite(TM_FATFS_Worker_t* Worker, FIL* fp, const void* Data, uint32_t Size) {
+	const uint8_t* ptr = (const uint8_t *)Data;
+	uint32_t len;
+	FRESULT res = FR_OK;
+	
+	/* Split data to requests */
+	while (Size && res == FR_OK) {
+		len = Size > FATFS_WORKER_DATA_SIZE ? FATFS_WORKER_DATA_SIZE : Size;
+		
+		/* Post part of data */
+		res = TM_FATFS_INT_WorkerPost(Worker, TM_FATFS_Worker_Write, fp, ptr, len);
+		
+		ptr += len;
+		Size -= len;
+	}
+	
+	/* Return result */
+	return res;
+}
+
+FRESULT TM_FATFS_WorkerSync(TM_FATFS_Worker_t* Worker, FIL* fp) {
+	return TM_FATFS_INT_WorkerPost(Worker, TM_FATFS_Worker_Sync, fp, NULL, 0);
+}
+
+FRESULT TM_FATFS_WorkerClose(TM_FATFS_Worker_t* Worker, FIL* fp) {
+	return TM_FATFS_INT_WorkerPost(Worker, TM_FATFS_Worker_Close, fp, NULL, 0);
+}
+
+FRESULT TM_FATFS_WorkerWait(TM_FATFS_Worker_t* Worker, uint32_t timeout) {
+	FRESULT res;
+	
+	/* Wait for queue to become empty */
+	while (Worker->Pending) {
+		if (timeout == 0) {
+			return FR_TIMEOUT;
+		}
+		if (timeout != osWaitForever) {
+			timeout--;
+		}
+		osDelay(1);
+	}
+	
+	/* Get and reset result */
+	res = Worker->Result;
+	Worker->Result = FR_OK;
+	
+	/* Return result */
+	return res;
+}
+
+static FRESULT TM_FATFS_INT_WorkerPost(TM_FATFS_Worker_t* Worker, TM_FATFS_Worker_Type_t Type, FIL* fp, const void* Data, uint32_t Size) {
+	TM_FATFS_INT_Request_t* req;
+	uint32_t primask;
+	
+	/* Check worker */
+	if (Worker->Queue == NULL) {
+		return FR_INVALID_PARAMETER;
+	}
+	
+	/* Get free request, does not wait */
+	req = (TM_FATFS_INT_Request_t *)osMailAlloc(Worker->Queue, 0);
+	if (req == NULL) {
+		return FR_NOT_ENOUGH_CORE;
+	}
+	
+	/* Fill request */
+	req->Type = Type;
+	req->fp = fp;
+	req->Size = Size;
+	if (Size) {
+		memcpy(req->Data, Data, Size);
+	}
+	
+	/* Increase pending count before worker can process request */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	Worker->Pending++;
+	__set_PRIMASK(primask);
+	
+	/* Post request */
+	if (osMailPut(Worker->Queue, req) != osOK) {
+		primask = __get_PRIMASK();
+		__disable_irq();
+		Worker->Pending--;
+		__set_PRIMASK(primask);
+		osMailFree(Worker->Queue, req);
+		return FR_NOT_ENOUGH_CORE;
+	}
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+static void TM_FATFS_INT_WorkerThread(void const* argument) {
+	TM_FATFS_Worker_t* Worker = (TM_FATFS_Worker_t *)argument;
+	TM_FATFS_INT_Request_t* req;
+	osEvent evt;
+	FRESULT res;
+	UINT bw;
+	uint32_t primask;
+	
+	while (1) {
+		/* Wait for request */
+		evt = osMailGet(Worker->Queue, osWaitForever);
+		if (evt.status != osEventMail) {
+			continue;
+		}
+		req = (TM_FATFS_INT_Request_t *)evt.value.p;
+		
+		/* Process request */
+		switch (req->Type) {
+			case TM_FATFS_Worker_Write:
+				res = f_write(req->fp, req->Data, req->Size, &bw);
+				if (res == FR_OK && bw != req->Size) {
+					/* Disk is full */
+					res = FR_DENIED;
+				}
+				break;
+			case TM_FATFS_Worker_Sync:
+				res = f_sync(req->fp);
+				break;
+			case TM_FATFS_Worker_Close:
+				res = f_close(req->fp);
+				break;
+			default:
+				res = FR_INVALID_PARAMETER;
+				break;
+		}
+		
+		/* Save first error */
+		if (res != FR_OK && Worker->Result == FR_OK) {
+			Worker->Result = res;
+		}
+		
+		/* Notify user */
+		if (Worker->Callback) {
+			Worker->Callback(req->fp, req->Type, res, Worker->Param);
+		}
+		
+		/* Release request and decrease pending count */
+		osMailFree(Worker->Queue, req);
+		primask = __get_PRIMASK();
+		__disable_irq();
+		Worker->Pending--;
+		__set_PRIMASK(primask);
+	}
+}
+#endif
+
+/*******************************************************************/
+/*                   FATFS INDEX PRIVATE FUNCTIONS                 */
+/*******************************************************************/
+static FRESULT index_scan(TM_FATFS_Index_t* Index, char* path, uint16_t parent, FILINFO* fno) {
+	FRESULT res;
+	DIR dir;
+	int i;
+	uint16_t entry;
+
+	/* Try to open folder */
+	if ((res = f_opendir(&dir, path)) == FR_OK) {
+		/* Get length of current path */
+		i = strlen(path);
+
+		/* Read item from card */
+		while ((res = f_readdir(&dir, fno)) == FR_OK && fno->fname[0] != 0) {
+			/* Ignore dot entries */
+			if (fno->fname[0] == '.') {
+				continue;
+			}
+
+			/* Check memory for path and entry */
+			if ((i + strlen(fno->fname) + 1) >= FATFS_INDEX_PATH_LEN || Index->Count >= Index->Size) { 
+				res = FR_NOT_ENOUGH_CORE;
+				break;
+			}
+
+			/* Format path and add entry */
+			sprintf(&path[i], "/%s", fno->fname);
+			entry = Index->Count++;
+			index_fill(&Index->Entries[entry], fno, index_hash(path, -1), parent);
+			Index->Order[entry] = entry;
+
+			/* Scan folder, fno is overwritten */
+			if (fno->fattrib & AM_DIR) {
+				res = index_scan(Index, path, entry, fno);
+			}
+			
+			/* Set path back */
+			path[i] = 0;
+
+			/* Stop on error */
+			if (res != FR_OK) {
+				break;
+			}
+		}
+
+		/* Close directory */
+		f_closedir(&dir);
+	}
+
+	/* Return result */
+	return res;
+}
+
+static uint32_t index_hash(const char* path, int32_t len) {
+	uint32_t hash = 2166136261UL;
+	const char* p = path;
+	const char* end;
+	uint8_t sep = 0;
+	char c;
+	
+	/* Get end of string */
+	end = len < 0 ? path + strlen(path) : path + len;
+	
+	/* Skip drive name */
+	for (p = path; p < end && *p != ':'; p++);
+	p = (p < end) ? p + 1 : path;
+	
+	/* FNV-1a hash, case insensitive and with single separators */
+	for (; p < end; p++) {
+		c = *p;
+		if (c == '/' || c == '\\') {
+			sep = 1;
+			continue;
+		}
+		if (sep && hash != 2166136261UL) {
+			hash = (hash ^ '/') * 16777619UL;
+		}
+		sep = 0;
+		if (c >= 'a' && c <= 'z') {
+			c -= 'a' - 'A';
+		}
+		hash = (hash ^ (uint8_t)c) * 16777619UL;
+	}
+	
+	/* Return hash */
+	return hash;
+}
+
+static void index_fill(TM_FATFS_IndexEntry_t* Entry, FILINFO* fno, uint32_t hash, uint16_t parent) {
+	char* ext;
+	
+	/* Fill entry */
+	Entry->Hash = hash;
+	Entry->Size = fno->fsize;
+	Entry->Date = fno->fdate;
+	Entry->Time = fno->ftime;
+	Entry->Parent = parent;
+	Entry->Attr = fno->fattrib & ~FATFS_INDEX_REMOVED;
+	
+	/* Copy name */
+	strncpy(Entry->Name, fno->fname, FATFS_INDEX_NAME_LEN);
+	Entry->Name[FATFS_INDEX_NAME_LEN] = 0;
+	
+	/* Copy extension */
+	ext = strrchr(fno->fname, '.');
+	if (ext != NULL && !(fno->fattrib & AM_DIR)) {
+		strncpy(Entry->Ext, ext + 1, sizeof(Entry->Ext) - 1);
+		Entry->Ext[sizeof(Entry->Ext) - 1] = 0;
+	} else {
+		Entry->Ext[0] = 0;
+	}
+}
+
+static int32_t index_compare(TM_FATFS_Index_t* Index, uint16_t a, uint16_t b) {
+	TM_FATFS_IndexEntry_t* ea = &Index->Entries[a];
+	TM_FATFS_IndexEntry_t* eb = &Index->Entries[b];
+	const char *pa, *pb;
+	char ca, cb;
+	
+	switch (Index->Sort) {
+		case TM_FATFS_IndexSort_Name:
+			/* Folders first */
+			if ((ea->Attr & AM_DIR) != (eb->Attr & AM_DIR)) {
+				return (ea->Attr & AM_DIR) ? -1 : 1;
+			}
+			
+			/* Compare names, case insensitive */
+			for (pa = ea->Name, pb = eb->Name; *pa || *pb; pa++, pb++) {
+				ca = (*pa >= 'a' && *pa <= 'z') ? *pa - ('a' - 'A') : *pa;
+				cb = (*pb >= 'a' && *pb <= 'z') ? *pb - ('a' - 'A') : *pb;
+				if (ca != cb) {
+					return (int32_t)(uint8_t)ca - (int32_t)(uint8_t)cb;
+				}
+			}
+			break;
+		case TM_FATFS_IndexSort_Size:
+			if (ea->Size != eb->Size) {
+				return ea->Size > eb->Size ? 1 : -1;
+			}
+			break;
+		case TM_FATFS_IndexSort_Date:
+			if (ea->Date != eb->Date) {
+				return ea->Date > eb->Date ? 1 : -1;
+			}
+			if (ea->Time != eb->Time) {
+				return ea->Time > eb->Time ? 1 : -1;
+			}
+			break;
+		default:
+			break;
+	}
+	
+	/* Keep order as added */
+	return (int32_t)a - (int32_t)b;
+}
+
+static uint8_t index_match(const char* str, const char* match, uint8_t full) {
+	char cs, cm;
+	
+	/* Compare characters, case insensitive, str must start with match */
+	for (; *match; str++, match++) {
+		cs = (*str >= 'a' && *str <= 'z') ? *str - ('a' - 'A') : *str;
+		cm = (*match >= 'a' && *match <= 'z') ? *match - ('a' - 'A') : *match;
+		if (cs != cm) {
+			return 0;
+		}
+	}
+	
+	/* Match, for full compare both strings must end */
+	return !full || *str == 0;
+}
+
+static FRESULT TM_FATFS_INT_AppendWrite(TM_FATFS_Append_t* Append, const void* Data, uint32_t Size) {
+	FRESULT res;
+	UINT bw;
+	
+	/* Write to file, whole sectors on sector boundary go directly to disk_write */
+	res = f_write(Append->fp, Data, Size, &bw);
+	if (res == FR_OK && bw != Size) {
+		res = FR_DENIED;
+	}
+	
+	/* Buffer is empty, next write goes up to next boundary */
+	Append->Count = 0;
+	Append->Limit = Append->Size - (uint32_t)(f_tell(Append->fp) % Append->Size);
+	
+	/* Return result */
+	return res;
+}
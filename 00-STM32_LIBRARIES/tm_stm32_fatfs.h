@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-20-fatfs-for-stm32fxxx/
- * @version v1.1
+ * @version v1.9
  * @ide     Keil uVision
  * @license MIT
  * @brief   Fatfs implementation for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_FATFS_H
-#define TM_FATFS_H 110
+#define TM_FATFS_H 190
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -152,6 +152,15 @@ extern "C" {
 //Set your CS pin for SPI			
 #define FATFS_CS_PORT           GPIOB
 #define FATFS_CS_PIN            GPIO_PIN_5
+\endcode
+ *
+ * In SPI mode, sequential sectors are read and written in one CMD18/CMD25 multi-block transfer, even across
+ * several disk read/write calls. Card stays selected until other sector is accessed or @ref f_sync is called.
+ * If other devices share the same SPI, disable this in defines.h file:
+ *
+\code
+//Stop multi-block transfer after each disk read/write call
+#define FATFS_SD_STREAM         0
 \endcode
  *
  * \par Write protect and Card detect pins
@@ -257,6 +266,21 @@ f_mount(&fatfs_HS, "USBHS:", 1);
  * Like SDCARD has "SD:" name, here are 2 different names, which allows you flexibility in your code.
  * This also means, that you can use SDCARD and 2 USB flash drives at the same time without any problems, just specifying drive name
  * when performing read and write operations.
+ *
+ * \par USB sector cache
+ *
+ * Each USB port has read-ahead and write-behind sector cache, so small sequential FATFS requests are joined to large MSC transfers.
+ * Modified sectors are written to device on non-sequential access or when f_sync/f_close is called,
+ * so always close files before USB flash key is removed.
+ *
+\code
+//Number of 512-bytes sectors in cache for each USB port, set to 0 to disable cache
+#define FATFS_USB_CACHE_SECTORS    32
+
+//Place cache to SDRAM, SDRAM must be initialized before first FATFS call
+#define FATFS_USB_CACHE_FS_ADDR    0xD0100000
+#define FATFS_USB_CACHE_HS_ADDR    0xD0110000
+\endcode
  *
  * \par Search for files
  *
@@ -300,10 +324,206 @@ uint8_t TM_FATFS_SearchCallback(char* path, uint8_t is_file, TM_FATFS_Search_t*
 \endcode
  *
  * Check documentation for these 2 functions for more info.
+ *
+ * \par Directory index
+ *
+ * When many files must be listed and sorted, search over card is slow. Directory index reads folder tree once
+ * and keeps compact entry for each file and folder in RAM or SDRAM: path hash, name, extension, size, date, attributes and parent folder.
+ * Queries and sorted iteration then do not access card anymore.
+ *
+ * Index must be updated by user after file is created, written, renamed or deleted with @ref TM_FATFS_IndexUpdate function.
+ *
+\code
+//Maximal number of name characters stored in index, longer names are truncated
+#define FATFS_INDEX_NAME_LEN       24
+
+//Maximal length of path used when index is created
+#define FATFS_INDEX_PATH_LEN       256
+\endcode
+ *
+ * Example:
+ *
+\code
+TM_FATFS_Index_t Index;
+int32_t pos;
+char path[100];
+
+//Create index of all files on SD card, index is stored in SDRAM
+TM_FATFS_IndexCreate(&Index, "SD:", (void *)0xD0200000, 0x100000);
+
+//Sort by date
+TM_FATFS_IndexSort(&Index, TM_FATFS_IndexSort_Date);
+
+//List all log files, starting with "sensor" name
+pos = -1;
+while ((pos = TM_FATFS_IndexSearch(&Index, pos + 1, "sensor", "log")) >= 0) {
+	TM_FATFS_IndexGetPath(&Index, TM_FATFS_IndexGet(&Index, pos), path, sizeof(path));
+	printf("%s\n", path);
+}
+
+//After new file is written and closed
+TM_FATFS_IndexUpdate(&Index, "SD:/logs/sensor12.log");
+\endcode
+ *
+ * \par Fast seek for large files
+ *
+ * By default, FATFS follows cluster chain from beginning of file on every seek, which is slow on very large files.
+ * With fast seek enabled, cluster link map table (CLMT) is created for file in memory and seek is done without FAT access.
+ * Table memory is allocated with @ref LIB_ALLOC_FUNC, so memory pools are used when LIB_USE_POOL is enabled.
+ *
+\code
+//Enable fast seek feature in defines.h file
+#define _USE_FASTSEEK              1
+
+//Initial table size in DWORD units, table grows when file is more fragmented
+#define FATFS_FASTSEEK_TABLE_SIZE  32
+\endcode
+ *
+ * File size can not be increased while fast seek is active, so new log files should be preallocated first.
+ * Contiguous file needs only 4 table entries:
+ *
+\code
+TM_FATFS_FastSeek_t fs_table = {0};
+
+//Create new file with 64MB of contiguous space
+f_open(&fil, "SD:log.bin", FA_CREATE_ALWAYS | FA_READ | FA_WRITE);
+TM_FATFS_Preallocate(&fil, 64 * 1024 * 1024);
+
+//Enable fast seek, f_lseek is now not dependant on file size
+TM_FATFS_FastSeekEnable(&fil, &fs_table);
+f_lseek(&fil, 50 * 1024 * 1024);
+
+//Disable fast seek and release table before file is closed
+TM_FATFS_FastSeekDisable(&fil, &fs_table);
+f_close(&fil);
+\endcode
+ *
+ * \par Use FATFS with RTOS
+ *
+ * FATFS can be used from multiple threads when re-entrancy is enabled. Each volume is then protected with CMSIS-RTOS mutex,
+ * implemented in fatfs/option/syscall.c file. Add lines below to defines.h file:
+ *
+\code
+//Enable thread safe FATFS, cmsis_os.c must be in project
+#define _FS_REENTRANT              1
+
+//Timeout in units of RTOS ticks to wait for volume access
+#define _FS_TIMEOUT                1000
+\endcode
+ *
+ * \par Asynchronous worker
+ *
+ * With RTOS enabled, you can start worker thread for each volume. Other threads (for example logging) then post
+ * write requests to worker queue and continue immediately without waiting for memory card latency.
+ * Data are copied to request, so buffer can be reused immediately after @ref TM_FATFS_WorkerWrite returns.
+ *
+ * Worker has exclusive access to file after request is posted, until @ref TM_FATFS_WorkerWait returns
+ * or close request is done, so do not use file object from other threads in meantime.
+ *
+\code
+//Enable worker, _FS_REENTRANT must be enabled too
+#define FATFS_USE_WORKER           1
+
+//Number of pending requests per worker
+#define FATFS_WORKER_QUEUE_LEN     16
+
+//Maximal number of bytes in one request, larger writes are split to multiple requests
+#define FATFS_WORKER_DATA_SIZE     512
+
+//Worker thread stack size and priority
+#define FATFS_WORKER_STACK_SIZE    512
+#define FATFS_WORKER_PRIORITY      osPriorityBelowNormal
+\endcode
+ *
+ * Example usage:
+ *
+\code
+TM_FATFS_Worker_t SD_Worker;
+FIL fil;
+
+//Mount and open file first, then start worker
+TM_FATFS_WorkerStart(&SD_Worker, NULL, NULL);
+
+//Post write from logging thread, returns immediately
+if (TM_FATFS_WorkerWrite(&SD_Worker, &fil, "Log line\n", 9) == FR_NOT_ENOUGH_CORE) {
+	//Queue is full, data are not written
+}
+
+//Close file in worker thread
+TM_FATFS_WorkerClose(&SD_Worker, &fil);
+\endcode
+ *
+ * \par Coalesced append writes
+ *
+ * Small f_write calls of odd sizes go through FIL sector buffer and reach disk layer as single sector,
+ * read-modify-write transfers. Append buffer collects data in 4-byte aligned staging buffer and writes it
+ * to file when buffer is full. Each write then starts and ends on buffer size boundary in file,
+ * so FATFS passes buffer directly to disk_write as one multi-sector transfer, DMA can use it without copy.
+ *
+ * Buffer size must be multiple of 512 bytes. Power of 2 not larger than cluster size is best,
+ * then writes never cross cluster boundary.
+ *
+\code
+//Default staging buffer size when allocated by library
+#define FATFS_APPEND_BUFFER_SIZE   4096
+\endcode
+ *
+ * Flush policy is set on open. With timeout 0, data are written only when buffer is full and on flush or close.
+ * With timeout set, @ref TM_FATFS_AppendUpdate writes partial buffer and syncs file
+ * when oldest buffered data are older than timeout.
+ *
+\code
+TM_FATFS_Append_t Log;
+
+//Open file for writing and start append buffer, allocated internally, partial data are written after 2 seconds
+f_open(&fil, "SD:log.txt", FA_OPEN_ALWAYS | FA_WRITE);
+TM_FATFS_AppendOpen(&Log, &fil, NULL, 0, 2000);
+
+//Write small chunks, card is accessed only with whole 4kB writes
+TM_FATFS_AppendWrite(&Log, "Temperature: 23.5\n", 18);
+
+//Call periodically from main loop
+TM_FATFS_AppendUpdate(&Log);
+
+//Write remaining data, release buffer and close file
+TM_FATFS_AppendClose(&Log);
+\endcode
  * 
  * \par Changelog
  *
 \verbatim
+ Version 1.9
+  - October 14, 2026
+  - Added append buffer with aligned staging buffer which writes to disk in whole buffer blocks
+
+ Version 1.8
+  - October 14, 2026
+  - Added SPIRAM: drive for SPI PSRAM and FRAM with TM SPIRAM library, enabled with FATFS_USE_SPIRAM
+
+ Version 1.7
+  - October 14, 2026
+  - diskio counts bytes, transfers, errors and maximal latency for each drive in TM STATS, enabled with STATS_ENABLED
+
+ Version 1.6
+  - October 14, 2026
+  - Added RAM directory index with prefix and extension queries and sorted iteration
+
+ Version 1.5
+  - October 14, 2026
+  - Added fast seek table management and contiguous preallocation functions
+
+ Version 1.4
+  - October 14, 2026
+  - Added optional re-entrancy with CMSIS-RTOS mutex (_FS_REENTRANT) and asynchronous per-volume worker thread
+
+ Version 1.3
+  - October 14, 2026
+  - USB MSC host driver has read-ahead and write-behind sector cache, see FATFS_USB_CACHE_SECTORS
+
+ Version 1.2
+  - October 14, 2026
+  - SPI mode keeps multi-block transfer open across sequential sector reads and writes
+
  Version 1.1
   - April 24, 2016
   - Added support for FATFS R0.12
@@ -325,6 +545,9 @@ uint8_t TM_FATFS_SearchCallback(char* path, uint8_t is_file, TM_FATFS_Search_t*
  - TM DELAY         (only when SPI)
  - TM GPIO
  - FatFS by Chan    (R0.11a)
+ - CMSIS-RTOS       (only when _FS_REENTRANT)
+ - TM STATS         (only when STATS_ENABLED)
+ - TM SPIRAM        (only when FATFS_USE_SPIRAM)
 \endverbatim
  */
 
@@ -354,6 +577,11 @@ uint8_t TM_FATFS_SearchCallback(char* path, uint8_t is_file, TM_FATFS_Search_t*
 #define FATFS_TRUNCATE_BUFFER_SIZE	256
 #endif
 
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
 /* Memory allocation function */
 #ifndef LIB_ALLOC_FUNC
 #define LIB_ALLOC_FUNC    malloc
@@ -364,6 +592,81 @@ uint8_t TM_FATFS_SearchCallback(char* path, uint8_t is_file, TM_FATFS_Search_t*
 #define LIB_FREE_FUNC     free
 #endif
 
+/**
+ * @brief  Number of name characters stored for each entry in directory index
+ * @note   Longer names are truncated, but hash is calculated from full path
+ */
+#ifndef FATFS_INDEX_NAME_LEN
+#define FATFS_INDEX_NAME_LEN      24
+#endif
+
+/**
+ * @brief  Maximal path length used during index creation
+ */
+#ifndef FATFS_INDEX_PATH_LEN
+#define FATFS_INDEX_PATH_LEN      256
+#endif
+
+/* Parent value for entries in index root folder */
+#define FATFS_INDEX_ROOT          0xFFFF
+
+/* Attribute flag for removed entries in index */
+#define FATFS_INDEX_REMOVED       0x80
+
+/**
+ * @brief  Initial fast seek table size in units of DWORD
+ * @note   Table is increased automatically when file has more fragments
+ */
+#ifndef FATFS_FASTSEEK_TABLE_SIZE
+#define FATFS_FASTSEEK_TABLE_SIZE 32
+#endif
+
+/**
+ * @brief  Enables asynchronous worker thread functions
+ * @note   Requires _FS_REENTRANT to be enabled
+ */
+#ifndef FATFS_USE_WORKER
+#define FATFS_USE_WORKER          0
+#endif
+
+/**
+ * @brief  Default append buffer size in units of bytes, used when buffer is allocated by library
+ * @note   Must be multiple of 512 bytes
+ */
+#ifndef FATFS_APPEND_BUFFER_SIZE
+#define FATFS_APPEND_BUFFER_SIZE  4096
+#endif
+
+#if FATFS_APPEND_BUFFER_SIZE % 512
+#error "FATFS_APPEND_BUFFER_SIZE must be multiple of 512 bytes!"
+#endif
+
+#if FATFS_USE_WORKER
+#if !_FS_REENTRANT
+#error "FATFS worker requires _FS_REENTRANT to be enabled in defines.h file!"
+#endif
+
+/* Number of pending requests in each worker queue */
+#ifndef FATFS_WORKER_QUEUE_LEN
+#define FATFS_WORKER_QUEUE_LEN    16
+#endif
+
+/* Maximal number of data bytes in one write request */
+#ifndef FATFS_WORKER_DATA_SIZE
+#define FATFS_WORKER_DATA_SIZE    512
+#endif
+
+/* Worker thread stack size in words */
+#ifndef FATFS_WORKER_STACK_SIZE
+#define FATFS_WORKER_STACK_SIZE   512
+#endif
+
+/* Worker thread priority */
+#ifndef FATFS_WORKER_PRIORITY
+#define FATFS_WORKER_PRIORITY     osPriorityBelowNormal
+#endif
+#endif /* FATFS_USE_WORKER */
+
 /**
  * @}
  */
@@ -390,6 +693,100 @@ typedef struct {
 	uint32_t FilesCount;   /*!< Number of files in last search operation */
 } TM_FATFS_Search_t;
 
+/**
+ * @brief  Directory index entry
+ */
+typedef struct {
+	uint32_t Hash;                        /*!< Hash of full path, case insensitive */
+	uint32_t Size;                        /*!< File size in units of bytes */
+	uint16_t Date;                        /*!< Last modified date in FATFS format */
+	uint16_t Time;                        /*!< Last modified time in FATFS format */
+	uint16_t Parent;                      /*!< Index of parent folder entry or FATFS_INDEX_ROOT */
+	uint8_t Attr;                         /*!< FATFS attributes, AM_DIR for folders. FATFS_INDEX_REMOVED is set for deleted entry */
+	char Ext[8];                          /*!< File extension without dot, truncated and NULL terminated */
+	char Name[FATFS_INDEX_NAME_LEN + 1];  /*!< File name, truncated and NULL terminated */
+} TM_FATFS_IndexEntry_t;
+
+/**
+ * @brief  Directory index sort type
+ */
+typedef enum {
+	TM_FATFS_IndexSort_None = 0x00, /*!< Order as entries were added */
+	TM_FATFS_IndexSort_Name,        /*!< Sort by name, case insensitive, folders first */
+	TM_FATFS_IndexSort_Size,        /*!< Sort by size, smallest first */
+	TM_FATFS_IndexSort_Date         /*!< Sort by date and time, oldest first */
+} TM_FATFS_IndexSort_t;
+
+/**
+ * @brief  Directory index structure
+ * @note   Members are private and should not be modified by user
+ */
+typedef struct {
+	TM_FATFS_IndexEntry_t* Entries; /*!< Pointer to entries array */
+	uint16_t* Order;                /*!< Pointer to sorted order of entries */
+	uint32_t Count;                 /*!< Number of entries used */
+	uint32_t Size;                  /*!< Maximal number of entries in memory */
+	uint32_t RootHash;              /*!< Hash of root folder path */
+	TM_FATFS_IndexSort_t Sort;      /*!< Sort type used on last sort */
+} TM_FATFS_Index_t;
+
+/**
+ * @brief  Fast seek table structure, one per file in fast seek mode
+ * @note   Initialize structure to zero before first use
+ */
+typedef struct {
+	DWORD* Table;  /*!< Pointer to cluster link map table */
+	uint32_t Size; /*!< Size of table in units of DWORD */
+} TM_FATFS_FastSeek_t;
+
+/**
+ * @brief  Append buffer structure, one per file
+ * @note   Members are private and should not be modified by user
+ */
+typedef struct {
+	FIL* fp;           /*!< Pointer to file object */
+	uint8_t* Buffer;   /*!< Pointer to staging buffer, 4-byte aligned */
+	uint32_t Size;     /*!< Size of staging buffer in units of bytes */
+	uint32_t Count;    /*!< Number of bytes in buffer */
+	uint32_t Limit;    /*!< Number of bytes until next buffer size boundary in file */
+	uint32_t Timeout;  /*!< Maximal age of buffered data in units of milliseconds, 0 when only full buffer is written */
+	uint32_t Time;     /*!< Time when first byte was written to empty buffer */
+	uint8_t Allocated; /*!< Buffer was allocated by library */
+} TM_FATFS_Append_t;
+
+#if FATFS_USE_WORKER || defined(DOXYGEN)
+/**
+ * @brief  Worker request types
+ */
+typedef enum {
+	TM_FATFS_Worker_Write = 0x00, /*!< Write data to file */
+	TM_FATFS_Worker_Sync,         /*!< Flush cached data of file to device */
+	TM_FATFS_Worker_Close         /*!< Close file */
+} TM_FATFS_Worker_Type_t;
+
+/**
+ * @brief  Worker completion callback, called from worker thread after each request
+ * @param  *fp: Pointer to file object of request
+ * @param  Type: Request type, member of @ref TM_FATFS_Worker_Type_t
+ * @param  res: Result of operation, FR_DENIED is returned when disk is full on write
+ * @param  *Param: User parameter passed to @ref TM_FATFS_WorkerStart
+ */
+typedef void (*TM_FATFS_Worker_Callback_t)(FIL* fp, TM_FATFS_Worker_Type_t Type, FRESULT res, void* Param);
+
+/**
+ * @brief  Worker structure, one per volume
+ * @note   Members are private and should not be modified by user
+ */
+typedef struct {
+	osThreadId Thread;                   /*!< Worker thread ID */
+	osMailQId Queue;                     /*!< Request queue ID */
+	volatile uint32_t Pending;           /*!< Number of requests in queue or in progress */
+	volatile FRESULT Result;             /*!< First error result since last @ref TM_FATFS_WorkerWait call */
+	TM_FATFS_Worker_Callback_t Callback; /*!< Completion callback */
+	void* Param;                         /*!< User parameter for callback */
+} TM_FATFS_Worker_t;
+#endif
+
 /**
  * @}
  */
@@ -462,6 +859,213 @@ FRESULT TM_FATFS_Search(char* Folder, char* tmp_buffer, uint16_t tmp_buffer_size
  */
 uint8_t TM_FATFS_SearchCallback(char* path, uint8_t is_file, TM_FATFS_Search_t* FindStructure);
 
+/**
+ * @brief  Reads folder tree and creates directory index in memory
+ * @param  *Index: Pointer to empty @ref TM_FATFS_Index_t structure
+ * @param  *Folder: Root folder for index, for example "SD:" or "SD:/logs"
+ * @param  *Memory: Pointer to 4-bytes aligned memory for index, RAM or SDRAM
+ * @param  MemorySize: Size of memory in units of bytes
+ * @retval Member of FRESULT:
+ *            - FR_OK: Index created
+ *            - FR_NOT_ENOUGH_CORE: Memory is full or path is too long, index contains entries read until error
+ */
+FRESULT TM_FATFS_IndexCreate(TM_FATFS_Index_t* Index, const char* Folder, void* Memory, uint32_t MemorySize);
+
+/**
+ * @brief  Updates index entry for file or folder after it was changed on card
+ * @note   Entry is added when it does not exist yet and removed when file does not exist anymore on card.
+ *         Parent folders are added when needed. After entry is added, sort order is not valid until @ref TM_FATFS_IndexSort is called
+ * @param  *Index: Pointer to created @ref TM_FATFS_Index_t structure
+ * @param  *path: Full path to file or folder, including root folder used on index creation
+ * @retval Member of FRESULT:
+ *            - FR_OK: Entry updated, added or removed
+ *            - FR_NOT_ENOUGH_CORE: Index memory is full
+ *            - FR_INVALID_NAME: Path is not inside index root folder
+ */
+FRESULT TM_FATFS_IndexUpdate(TM_FATFS_Index_t* Index, const char* path);
+
+/**
+ * @brief  Finds entry by full path
+ * @param  *Index: Pointer to created @ref TM_FATFS_Index_t structure
+ * @param  *path: Full path to file or folder
+ * @retval Pointer to entry or NULL if not found
+ */
+TM_FATFS_IndexEntry_t* TM_FATFS_IndexFind(TM_FATFS_Index_t* Index, const char* path);
+
+/**
+ * @brief  Sorts index entries for iteration
+ * @note   Entries itself are not moved, only order table is sorted
+ * @param  *Index: Pointer to created @ref TM_FATFS_Index_t structure
+ * @param  Sort: Sort type, member of @ref TM_FATFS_IndexSort_t
+ * @retval None
+ */
+void TM_FATFS_IndexSort(TM_FATFS_Index_t* Index, TM_FATFS_IndexSort_t Sort);
+
+/**
+ * @brief  Searches for next entry in sorted order which matches name prefix and extension
+ * @param  *Index: Pointer to created @ref TM_FATFS_Index_t structure
+ * @param  start: Sorted position to start search from
+ * @param  *Prefix: Name prefix, case insensitive. Set to NULL for any name
+ * @param  *Ext: Extension without dot, case insensitive. Set to NULL for any extension
+ * @retval Sorted position of entry or -1 if there is no more matching entries
+ */
+int32_t TM_FATFS_IndexSearch(TM_FATFS_Index_t* Index, int32_t start, const char* Prefix, const char* Ext);
+
+/**
+ * @brief  Gets entry on sorted position
+ * @param  *Index: Pointer to created @ref TM_FATFS_Index_t structure
+ * @param  pos: Sorted position, 0 to number of entries - 1
+ * @retval Pointer to entry or NULL if position is not valid
+ */
+TM_FATFS_IndexEntry_t* TM_FATFS_IndexGet(TM_FATFS_Index_t* Index, uint32_t pos);
+
+/**
+ * @brief  Formats full path of entry, relative to index root folder
+ * @note   Names longer than FATFS_INDEX_NAME_LEN are truncated in path too
+ * @param  *Index: Pointer to created @ref TM_FATFS_Index_t structure
+ * @param  *Entry: Pointer to index entry
+ * @param  *str: Pointer to output string
+ * @param  size: Size of output string in units of bytes
+ * @retval Number of characters in path or 0 if string is too small
+ */
+uint16_t TM_FATFS_IndexGetPath(TM_FATFS_Index_t* Index, TM_FATFS_IndexEntry_t* Entry, char* str, uint16_t size);
+
+/**
+ * @brief  Allocates contiguous clusters for empty file opened for writing
+ * @note   File size is set to preallocated size, use f_truncate on actual position when done
+ * @param  *fil: Pointer to opened empty file
+ * @param  size: Number of bytes to allocate
+ * @retval Member of FRESULT:
+ *            - FR_OK: Space allocated
+ *            - FR_DENIED: File is not empty or there is no contiguous free space
+ */
+FRESULT TM_FATFS_Preallocate(FIL* fil, FSIZE_t size);
+
+/**
+ * @brief  Starts append buffer on opened file and moves file pointer to end of file
+ * @param  *Append: Pointer to empty @ref TM_FATFS_Append_t structure
+ * @param  *fil: Pointer to file opened for writing
+ * @param  *Buffer: Pointer to 4-byte aligned staging buffer or NULL to allocate it with @ref LIB_ALLOC_FUNC
+ * @param  Size: Size of staging buffer, multiple of 512 bytes. Set to 0 to use FATFS_APPEND_BUFFER_SIZE
+ * @param  Timeout: Maximal age of buffered data in units of milliseconds, checked in @ref TM_FATFS_AppendUpdate.
+ *            Set to 0 to write data only when buffer is full
+ * @retval Member of FRESULT:
+ *            - FR_OK: Append buffer is ready
+ *            - FR_INVALID_PARAMETER: Buffer is not aligned or size is not multiple of 512 bytes
+ *            - FR_NOT_ENOUGH_CORE: Buffer could not be allocated
+ */
+FRESULT TM_FATFS_AppendOpen(TM_FATFS_Append_t* Append, FIL* fil, void* Buffer, uint32_t Size, uint32_t Timeout);
+
+/**
+ * @brief  Appends data to file through staging buffer
+ * @note   Large writes from 4-byte aligned memory go directly to file when buffer is empty
+ * @param  *Append: Pointer to opened @ref TM_FATFS_Append_t structure
+ * @param  *Data: Pointer to data to write
+ * @param  Size: Number of bytes to write
+ * @retval Member of FRESULT, FR_DENIED when disk is full
+ */
+FRESULT TM_FATFS_AppendWrite(TM_FATFS_Append_t* Append, const void* Data, uint32_t Size);
+
+/**
+ * @brief  Writes buffered data and syncs file when they are older than timeout
+ * @note   Call it periodically when timeout is used
+ * @param  *Append: Pointer to opened @ref TM_FATFS_Append_t structure
+ * @retval Member of FRESULT
+ */
+FRESULT TM_FATFS_AppendUpdate(TM_FATFS_Append_t* Append);
+
+/**
+ * @brief  Writes all buffered data and syncs file
+ * @note   Next writes are aligned again after buffer is filled up to next boundary
+ * @param  *Append: Pointer to opened @ref TM_FATFS_Append_t structure
+ * @retval Member of FRESULT
+ */
+FRESULT TM_FATFS_AppendFlush(TM_FATFS_Append_t* Append);
+
+/**
+ * @brief  Writes all buffered data, releases buffer and closes file
+ * @param  *Append: Pointer to opened @ref TM_FATFS_Append_t structure
+ * @retval Member of FRESULT
+ */
+FRESULT TM_FATFS_AppendClose(TM_FATFS_Append_t* Append);
+
+#if _USE_FASTSEEK || defined(DOXYGEN)
+
+/**
+ * @brief  Creates cluster link map table and enables fast seek mode on file
+ * @note   Call it again after file is changed with fast seek disabled to update table
+ * @param  *fil: Pointer to opened file
+ * @param  *FastSeek: Pointer to @ref TM_FATFS_FastSeek_t structure to use for table
+ * @retval Member of FRESULT:
+ *            - FR_OK: Fast seek is enabled
+ *            - FR_NOT_ENOUGH_CORE: Table could not be allocated, fast seek is disabled
+ */
+FRESULT TM_FATFS_FastSeekEnable(FIL* fil, TM_FATFS_FastSeek_t* FastSeek);
+
+/**
+ * @brief  Disables fast seek mode on file and releases table memory
+ * @note   Must be called before file is closed, otherwise table memory is lost
+ * @param  *fil: Pointer to opened file
+ * @param  *FastSeek: Pointer to @ref TM_FATFS_FastSeek_t structure used on enable
+ * @retval None
+ */
+void TM_FATFS_FastSeekDisable(FIL* fil, TM_FATFS_FastSeek_t* FastSeek);
+
+#endif
+
+#if FATFS_USE_WORKER || defined(DOXYGEN)
+
+/**
+ * @brief  Creates worker thread and request queue
+ * @note   Start one worker per volume, files on the same volume are then processed in order of requests
+ * @param  *Worker: Pointer to empty @ref TM_FATFS_Worker_t structure
+ * @param  Callback: Completion callback function, set to NULL if not used
+ * @param  *Param: User parameter passed to callback function
+ * @retval FR_OK on success, FR_NOT_ENOUGH_CORE if thread or queue could not be created
+ */
+FRESULT TM_FATFS_WorkerStart(TM_FATFS_Worker_t* Worker, TM_FATFS_Worker_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Posts write request to worker queue and returns without waiting
+ * @note   Data are copied to request, writes larger than FATFS_WORKER_DATA_SIZE are split to multiple requests
+ * @param  *Worker: Pointer to started @ref TM_FATFS_Worker_t structure
+ * @param  *fp: Pointer to opened file object
+ * @param  *Data: Pointer to data to write
+ * @param  Size: Number of bytes to write
+ * @retval Member of FRESULT:
+ *            - FR_OK: All data posted to queue
+ *            - FR_NOT_ENOUGH_CORE: Queue is full, data after last full request are not posted
+ *            - FR_INVALID_PARAMETER: Worker is not started
+ */
+FRESULT TM_FATFS_WorkerWrite(TM_FATFS_Worker_t* Worker, FIL* fp, const void* Data, uint32_t Size);
+
+/**
+ * @brief  Posts sync request to worker queue and returns without waiting
+ * @param  *Worker: Pointer to started @ref TM_FATFS_Worker_t structure
+ * @param  *fp: Pointer to opened file object
+ * @retval FR_OK on success, FR_NOT_ENOUGH_CORE if queue is full
+ */
+FRESULT TM_FATFS_WorkerSync(TM_FATFS_Worker_t* Worker, FIL* fp);
+
+/**
+ * @brief  Posts close request to worker queue and returns without waiting
+ * @param  *Worker: Pointer to started @ref TM_FATFS_Worker_t structure
+ * @param  *fp: Pointer to opened file object
+ * @retval FR_OK on success, FR_NOT_ENOUGH_CORE if queue is full
+ */
+FRESULT TM_FATFS_WorkerClose(TM_FATFS_Worker_t* Worker, FIL* fp);
+
+/**
+ * @brief  Waits until all posted requests are processed
+ * @param  *Worker: Pointer to started @ref TM_FATFS_Worker_t structure
+ * @param  timeout: Timeout in units of milliseconds, use osWaitForever to wait without timeout
+ * @retval First error result of requests since last call, FR_OK when all requests succeeded
+ *            or FR_TIMEOUT if requests are still pending after timeout
+ */
+FRESULT TM_FATFS_WorkerWait(TM_FATFS_Worker_t* Worker, uint32_t timeout);
+
+#endif
+
 /**
  * @}
  */
@@ -25,6 +25,15 @@
  */
 #include "tm_stm32_fft.h"
 #include "stdlib.h"
+#include "string.h"
+#include "math.h"
+
+/* Private functions */
+static uint8_t TM_FFT_INT_Alloc(void** Input, uint32_t InputSize, void** Output, uint32_t OutputSize);
+static uint8_t TM_FFT_INT_CheckRealSize(uint16_t FFT_Size);
+static void TM_FFT_INT_StreamSample(TM_FFT_Stream_F32_t* Stream, float32_t sample, uint16_t* ready);
+static uint8_t TM_FFT_INT_StreamTransform(TM_FFT_Stream_F32_t* Stream);
+static float32_t TM_FFT_INT_Interpolate(const float32_t* Magnitudes, uint16_t index, float32_t* magnitude);
 
 /* Array with constants for CFFT module */
 /* Requires ARM CONST STRUCTURES files */
@@ -167,3 +176,544 @@ void TM_FFT_Free_F32(TM_FFT_F32_t* FFT) {
 		LIB_FREE_FUNC(FFT->Output);
 	}
 }
+
+uint8_t TM_FFT_Init_R32(TM_FFT_R32_t* FFT, uint16_t FFT_Size, uint8_t use_malloc) {
+	uint8_t status;
+	
+	/* Set to zero */
+	FFT->FFT_Size = 0;
+	FFT->Count = 0;
+	FFT->UseMalloc = 0;
+	
+	/* Check and init RFFT instance */
+	if (!TM_FFT_INT_CheckRealSize(FFT_Size) || arm_rfft_fast_init_f32(&FFT->S, FFT_Size) != ARM_MATH_SUCCESS) {
+		return 1;
+	}
+	FFT->FFT_Size = FFT_Size;
+	
+	/* If malloc selected for allocation, use it */
+	if (use_malloc) {
+		if ((status = TM_FFT_INT_Alloc((void **)&FFT->Input, FFT_Size * sizeof(float32_t), (void **)&FFT->Output, FFT_Size * sizeof(float32_t))) != 0) {
+			return status;
+		}
+		
+		/* Malloc used, set flag */
+		FFT->UseMalloc = 1;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_FFT_SetBuffers_R32(TM_FFT_R32_t* FFT, float32_t* InputBuffer, float32_t* OutputBuffer) {
+	/* If malloc is used, ignore */
+	if (FFT->UseMalloc) {
+		return;
+	}
+	
+	/* Set pointers */
+	FFT->Input = InputBuffer;
+	FFT->Output = OutputBuffer;
+}
+
+uint8_t TM_FFT_AddToBuffer_R32(TM_FFT_R32_t* FFT, float32_t sampleValue) {
+	/* Check if memory available */
+	if (FFT->Count < FFT->FFT_Size) {
+		FFT->Input[FFT->Count++] = sampleValue;
+	}
+	
+	/* Check if buffer full */
+	return FFT->Count >= FFT->FFT_Size;
+}
+
+void TM_FFT_Process_R32(TM_FFT_R32_t* FFT) {
+	float32_t dc;
+	
+	/* Process FFT, output is DC, Nyquist and FFT_Size / 2 - 1 complex values */
+	arm_rfft_fast_f32(&FFT->S, FFT->Input, FFT->Output, 0);
+	
+	/* Calculate magnitude in place, DC has no imaginary part, it is packed with Nyquist */
+	dc = FFT->Output[0];
+	arm_cmplx_mag_f32(FFT->Output, FFT->Output, FFT->FFT_Size / 2);
+	FFT->Output[0] = dc < 0 ? -dc : dc;
+	
+	/* Calculates maxValue and returns corresponding value and index */
+	arm_max_f32(FFT->Output, FFT->FFT_Size / 2, &FFT->MaxValue, &FFT->MaxIndex);
+	
+	/* Reset count */
+	FFT->Count = 0;
+}
+
+void TM_FFT_Free_R32(TM_FFT_R32_t* FFT) {
+	/* Check if malloc was used for allocation */
+	if (!FFT->UseMalloc) {
+		return;
+	}
+	
+	/* Free buffers */
+	LIB_FREE_FUNC(FFT->Input);
+	LIB_FREE_FUNC(FFT->Output);
+	FFT->UseMalloc = 0;
+}
+
+uint8_t TM_FFT_Init_Q15(TM_FFT_Q15_t* FFT, uint16_t FFT_Size, uint8_t use_malloc) {
+	uint8_t status;
+	
+	/* Set to zero */
+	FFT->FFT_Size = 0;
+	FFT->Count = 0;
+	FFT->UseMalloc = 0;
+	
+	/* Check and init RFFT instance, forward transform with bit reversal */
+	if (!TM_FFT_INT_CheckRealSize(FFT_Size) || arm_rfft_init_q15(&FFT->S, FFT_Size, 0, 1) != ARM_MATH_SUCCESS) {
+		return 1;
+	}
+	FFT->FFT_Size = FFT_Size;
+	
+	/* If malloc selected for allocation, use it */
+	if (use_malloc) {
+		if ((status = TM_FFT_INT_Alloc((void **)&FFT->Input, FFT_Size * sizeof(q15_t), (void **)&FFT->Output, 2 * FFT_Size * sizeof(q15_t))) != 0) {
+			return status;
+		}
+		
+		/* Malloc used, set flag */
+		FFT->UseMalloc = 1;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_FFT_SetBuffers_Q15(TM_FFT_Q15_t* FFT, q15_t* InputBuffer, q15_t* OutputBuffer) {
+	/* If malloc is used, ignore */
+	if (FFT->UseMalloc) {
+		return;
+	}
+	
+	/* Set pointers */
+	FFT->Input = InputBuffer;
+	FFT->Output = OutputBuffer;
+}
+
+uint8_t TM_FFT_AddToBuffer_Q15(TM_FFT_Q15_t* FFT, q15_t sampleValue) {
+	/* Check if memory available */
+	if (FFT->Count < FFT->FFT_Size) {
+		FFT->Input[FFT->Count++] = sampleValue;
+	}
+	
+	/* Check if buffer full */
+	return FFT->Count >= FFT->FFT_Size;
+}
+
+void TM_FFT_Process_Q15(TM_FFT_Q15_t* FFT) {
+	/* Process FFT, output is full complex spectrum */
+	arm_rfft_q15(&FFT->S, FFT->Input, FFT->Output);
+	
+	/* Calculate magnitude in place for first half of spectrum */
+	arm_cmplx_mag_q15(FFT->Output, FFT->Output, FFT->FFT_Size / 2);
+	
+	/* Calculates maxValue and returns corresponding value and index */
+	arm_max_q15(FFT->Output, FFT->FFT_Size / 2, &FFT->MaxValue, &FFT->MaxIndex);
+	
+	/* Reset count */
+	FFT->Count = 0;
+}
+
+void TM_FFT_Free_Q15(TM_FFT_Q15_t* FFT) {
+	/* Check if malloc was used for allocation */
+	if (!FFT->UseMalloc) {
+		return;
+	}
+	
+	/* Free buffers */
+	LIB_FREE_FUNC(FFT->Input);
+	LIB_FREE_FUNC(FFT->Output);
+	FFT->UseMalloc = 0;
+}
+
+uint8_t TM_FFT_Init_Q31(TM_FFT_Q31_t* FFT, uint16_t FFT_Size, uint8_t use_malloc) {
+	uint8_t status;
+	
+	/* Set to zero */
+	FFT->FFT_Size = 0;
+	FFT->Count = 0;
+	FFT->UseMalloc = 0;
+	
+	/* Check and init RFFT instance, forward transform with bit reversal */
+	if (!TM_FFT_INT_CheckRealSize(FFT_Size) || arm_rfft_init_q31(&FFT->S, FFT_Size, 0, 1) != ARM_MATH_SUCCESS) {
+		return 1;
+	}
+	FFT->FFT_Size = FFT_Size;
+	
+	/* If malloc selected for allocation, use it */
+	if (use_malloc) {
+		if ((status = TM_FFT_INT_Alloc((void **)&FFT->Input, FFT_Size * sizeof(q31_t), (void **)&FFT->Output, 2 * FFT_Size * sizeof(q31_t))) != 0) {
+			return status;
+		}
+		
+		/* Malloc used, set flag */
+		FFT->UseMalloc = 1;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_FFT_SetBuffers_Q31(TM_FFT_Q31_t* FFT, q31_t* InputBuffer, q31_t* OutputBuffer) {
+	/* If malloc is used, ignore */
+	if (FFT->UseMalloc) {
+		return;
+	}
+	
+	/* Set pointers */
+	FFT->Input = InputBuffer;
+	FFT->Output = OutputBuffer;
+}
+
+uint8_t TM_FFT_AddToBuffer_Q31(TM_FFT_Q31_t* FFT, q31_t sampleValue) {
+	/* Check if memory available */
+	if (FFT->Count < FFT->FFT_Size) {
+		FFT->Input[FFT->Count++] = sampleValue;
+	}
+	
+	/* Check if buffer full */
+	return FFT->Count >= FFT->FFT_Size;
+}
+
+void TM_FFT_Process_Q31(TM_FFT_Q31_t* FFT) {
+	/* Process FFT, output is full complex spectrum */
+	arm_rfft_q31(&FFT->S, FFT->Input, FFT->Output);
+	
+	/* Calculate magnitude in place for first half of spectrum */
+	arm_cmplx_mag_q31(FFT->Output, FFT->Output, FFT->FFT_Size / 2);
+	
+	/* Calculates maxValue and returns corresponding value and index */
+	arm_max_q31(FFT->Output, FFT->FFT_Size / 2, &FFT->MaxValue, &FFT->MaxIndex);
+	
+	/* Reset count */
+	FFT->Count = 0;
+}
+
+void TM_FFT_Free_Q31(TM_FFT_Q31_t* FFT) {
+	/* Check if malloc was used for allocation */
+	if (!FFT->UseMalloc) {
+		return;
+	}
+	
+	/* Free buffers */
+	LIB_FREE_FUNC(FFT->Input);
+	LIB_FREE_FUNC(FFT->Output);
+	FFT->UseMalloc = 0;
+}
+
+uint8_t TM_FFT_StreamInit_F32(TM_FFT_Stream_F32_t* Stream, TM_FFT_F32_t* FFT, uint16_t Overlap, TM_FFT_Window_t Window, uint16_t Averages) {
+	uint16_t i, N;
+	float32_t x;
+	
+	/* Check parameters */
+	if (FFT->FFT_Size == 0 || Overlap >= FFT->FFT_Size) {
+		return 1;
+	}
+	N = FFT->FFT_Size;
+	
+	/* Fill structure */
+	memset(Stream, 0, sizeof(TM_FFT_Stream_F32_t));
+	Stream->FFT = FFT;
+	Stream->Hop = N - Overlap;
+	Stream->Averages = Averages > 1 ? Averages : 1;
+	
+	/* Allocate history buffer */
+	Stream->History = (float32_t *) LIB_ALLOC_FUNC(N * sizeof(float32_t));
+	if (Stream->History == NULL) {
+		return 2;
+	}
+	
+	/* Allocate sum buffer for averaging */
+	if (Stream->Averages > 1) {
+		Stream->Sum = (float32_t *) LIB_ALLOC_FUNC(N * sizeof(float32_t));
+		if (Stream->Sum == NULL) {
+			TM_FFT_StreamFree_F32(Stream);
+			return 2;
+		}
+		memset(Stream->Sum, 0, N * sizeof(float32_t));
+	}
+	
+	/* Rectangular window does not need table */
+	if (Window == TM_FFT_Window_Rectangular) {
+		return 0;
+	}
+	
+	/* Allocate window table */
+	Stream->Window = (float32_t *) LIB_ALLOC_FUNC(N * sizeof(float32_t));
+	if (Stream->Window == NULL) {
+		TM_FFT_StreamFree_F32(Stream);
+		return 2;
+	}
+	
+	/* Calculate window table once */
+	for (i = 0; i < N; i++) {
+		x = 2.0f * PI * (float32_t)i / (float32_t)(N - 1);
+		switch (Window) {
+			case TM_FFT_Window_Hann:
+				Stream->Window[i] = 0.5f - 0.5f * cosf(x);
+				break;
+			case TM_FFT_Window_Hamming:
+				Stream->Window[i] = 0.54f - 0.46f * cosf(x);
+				break;
+			case TM_FFT_Window_Blackman:
+				Stream->Window[i] = 0.42f - 0.5f * cosf(x) + 0.08f * cosf(2.0f * x);
+				break;
+			default:
+				Stream->Window[i] = 1.0f;
+				break;
+		}
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+uint16_t TM_FFT_StreamAdd_F32(TM_FFT_Stream_F32_t* Stream, const float32_t* Samples, uint16_t count) {
+	uint16_t ready = 0;
+	
+	/* Add all samples */
+	while (count--) {
+		TM_FFT_INT_StreamSample(Stream, *Samples++, &ready);
+	}
+	
+	/* Return number of spectra */
+	return ready;
+}
+
+uint16_t TM_FFT_StreamAddADC_F32(TM_FFT_Stream_F32_t* Stream, const uint16_t* Samples, uint16_t count, float32_t offset) {
+	uint16_t ready = 0;
+	
+	/* Add all samples */
+	while (count--) {
+		TM_FFT_INT_StreamSample(Stream, (float32_t)*Samples++ - offset, &ready);
+	}
+	
+	/* Return number of spectra */
+	return ready;
+}
+
+void TM_FFT_StreamFree_F32(TM_FFT_Stream_F32_t* Stream) {
+	/* Free all buffers */
+	if (Stream->History) {
+		LIB_FREE_FUNC(Stream->History);
+		Stream->History = NULL;
+	}
+	if (Stream->Window) {
+		LIB_FREE_FUNC(Stream->Window);
+		Stream->Window = NULL;
+	}
+	if (Stream->Sum) {
+		LIB_FREE_FUNC(Stream->Sum);
+		Stream->Sum = NULL;
+	}
+}
+
+__weak void TM_FFT_StreamCallback_F32(TM_FFT_Stream_F32_t* Stream) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_FFT_StreamCallback_F32 could be implemented in the user file
+	*/
+}
+
+uint8_t TM_FFT_Features_F32(const float32_t* Magnitudes, const TM_FFT_FeaturesConfig_t* Config, TM_FFT_Features_t* Features) {
+	uint16_t i, start, end, bins = Config->Bins;
+	uint8_t j, count = 0;
+	float32_t value, offset, magnitude, f0, sum;
+	
+	/* Clear features */
+	memset(Features, 0, sizeof(TM_FFT_Features_t));
+	
+	/* Check parameters */
+	if (bins < 3 || Config->BinWidth <= 0) {
+		return 0;
+	}
+	
+	/* Find top local maximums in one pass, DC and last bin are skipped */
+	for (i = 1; i < bins - 1; i++) {
+		value = Magnitudes[i];
+		
+		/* Check for peak */
+		if (value < Config->Threshold || value < Magnitudes[i - 1] || value <= Magnitudes[i + 1]) {
+			continue;
+		}
+		
+		/* Ignore if smaller than all saved peaks */
+		if (count == FFT_FEATURES_PEAKS && value <= Features->Peaks[FFT_FEATURES_PEAKS - 1].Magnitude) {
+			continue;
+		}
+		
+		/* Interpolate peak between neighbour bins */
+		offset = TM_FFT_INT_Interpolate(Magnitudes, i, &magnitude);
+		
+		/* Insert sorted, smallest peak drops out */
+		if (count < FFT_FEATURES_PEAKS) {
+			count++;
+		}
+		for (j = count - 1; j > 0 && Features->Peaks[j - 1].Magnitude < magnitude; j--) {
+			Features->Peaks[j] = Features->Peaks[j - 1];
+		}
+		Features->Peaks[j].Frequency = ((float32_t)i + offset) * Config->BinWidth;
+		Features->Peaks[j].Magnitude = magnitude;
+	}
+	
+	/* Total energy without DC */
+	arm_power_f32((float32_t *)&Magnitudes[1], bins - 1, &Features->Energy);
+	
+	/* Energy in bands */
+	for (j = 0; Config->Bands && j < Config->BandsCount && j < FFT_FEATURES_BANDS; j++) {
+		/* Convert frequencies to bins */
+		start = (uint16_t)ceilf(Config->Bands[j].Start / Config->BinWidth);
+		end = (uint16_t)floorf(Config->Bands[j].End / Config->BinWidth);
+		if (end >= bins) {
+			end = bins - 1;
+		}
+		
+		/* Calculate energy */
+		if (start <= end) {
+			arm_power_f32((float32_t *)&Magnitudes[start], end - start + 1, &Features->Bands[j]);
+		}
+	}
+	
+	/* THD of biggest peak */
+	if (count && Config->Harmonics > 1) {
+		f0 = Features->Peaks[0].Frequency / Config->BinWidth;
+		sum = 0;
+		
+		/* Add power of each harmonic */
+		for (j = 2; j <= Config->Harmonics; j++) {
+			i = (uint16_t)(f0 * j + 0.5f);
+			if (i >= bins - 1) {
+				break;
+			}
+			
+			/* Move to bigger neighbour, harmonic is not exactly on bin */
+			if (Magnitudes[i - 1] > Magnitudes[i] && Magnitudes[i - 1] >= Magnitudes[i + 1]) {
+				i--;
+			} else if (Magnitudes[i + 1] > Magnitudes[i]) {
+				i++;
+			}
+			if (i < 1 || i >= bins - 1) {
+				break;
+			}
+			
+			/* Interpolate harmonic magnitude */
+			TM_FFT_INT_Interpolate(Magnitudes, i, &magnitude);
+			sum += magnitude * magnitude;
+		}
+		
+		/* Calculate ratio */
+		arm_sqrt_f32(sum, &value);
+		Features->THD = value / Features->Peaks[0].Magnitude;
+	}
+	
+	/* Return number of peaks */
+	return count;
+}
+
+/* Private functions */
+static uint8_t TM_FFT_INT_Alloc(void** Input, uint32_t InputSize, void** Output, uint32_t OutputSize) {
+	/* Allocate input buffer */
+	*Input = LIB_ALLOC_FUNC(InputSize);
+	if (*Input == NULL) {
+		return 2;
+	}
+	
+	/* Allocate output buffer */
+	*Output = LIB_ALLOC_FUNC(OutputSize);
+	if (*Output == NULL) {
+		/* Deallocate input buffer */
+		LIB_FREE_FUNC(*Input);
+		
+		/* Return error */
+		return 3;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+static uint8_t TM_FFT_INT_CheckRealSize(uint16_t FFT_Size) {
+	/* Power of 2 between 32 and 4096 */
+	return FFT_Size >= 32 && FFT_Size <= 4096 && (FFT_Size & (FFT_Size - 1)) == 0;
+}
+
+static void TM_FFT_INT_StreamSample(TM_FFT_Stream_F32_t* Stream, float32_t sample, uint16_t* ready) {
+	/* Save sample */
+	Stream->History[Stream->Fill++] = sample;
+	
+	/* Check if transform is ready */
+	if (Stream->Fill < Stream->FFT->FFT_Size) {
+		return;
+	}
+	
+	/* Calculate transform */
+	if (TM_FFT_INT_StreamTransform(Stream)) {
+		(*ready)++;
+	}
+	
+	/* Keep overlapped samples for next transform */
+	Stream->Fill = Stream->FFT->FFT_Size - Stream->Hop;
+	if (Stream->Fill) {
+		memmove(Stream->History, &Stream->History[Stream->Hop], Stream->Fill * sizeof(float32_t));
+	}
+}
+
+static uint8_t TM_FFT_INT_StreamTransform(TM_FFT_Stream_F32_t* Stream) {
+	TM_FFT_F32_t* FFT = Stream->FFT;
+	uint16_t i, N = FFT->FFT_Size;
+	
+	/* Copy windowed samples to complex input buffer */
+	for (i = 0; i < N; i++) {
+		FFT->Input[2 * i] = Stream->Window ? Stream->History[i] * Stream->Window[i] : Stream->History[i];
+		FFT->Input[2 * i + 1] = 0;
+	}
+	
+	/* Process FFT input data, instance is reused */
+	arm_cfft_f32(FFT->S, FFT->Input, 0, 1);
+	
+	/* Calculate magnitude at each bin */
+	arm_cmplx_mag_f32(FFT->Input, FFT->Output, N);
+	
+	/* Average magnitudes */
+	if (Stream->Sum) {
+		arm_add_f32(Stream->Sum, FFT->Output, Stream->Sum, N);
+		if (++Stream->Frames < Stream->Averages) {
+			return 0;
+		}
+		
+		/* Calculate average and reset sum */
+		arm_scale_f32(Stream->Sum, 1.0f / (float32_t)Stream->Averages, FFT->Output, N);
+		memset(Stream->Sum, 0, N * sizeof(float32_t));
+		Stream->Frames = 0;
+	}
+	
+	/* Calculates maxValue and returns corresponding value and index */
+	arm_max_f32(FFT->Output, N, &FFT->MaxValue, &FFT->MaxIndex);
+	
+	/* Spectrum ready */
+	Stream->Spectra++;
+	TM_FFT_StreamCallback_F32(Stream);
+	
+	return 1;
+}
+
+static float32_t TM_FFT_INT_Interpolate(const float32_t* Magnitudes, uint16_t index, float32_t* magnitude) {
+	float32_t a = Magnitudes[index - 1], b = Magnitudes[index], c = Magnitudes[index + 1];
+	float32_t d = a - 2.0f * b + c, p;
+	
+	/* Flat top, no correction */
+	if (d == 0) {
+		*magnitude = b;
+		return 0;
+	}
+	
+	/* Vertex of parabola through 3 points, offset is between -0.5 and 0.5 bin */
+	p = 0.5f * (a - c) / d;
+	*magnitude = b - 0.25f * (a - c) * p;
+	
+	return p;
+}
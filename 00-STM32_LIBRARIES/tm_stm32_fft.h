@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-14-fast-fourier-transform-for-stm32fxxx/
- * @version v1.0
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   FFT library for float 32 and Cortex-M4/7 little endian MCUs
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_FFT_H
-#define TM_FFT_H 100
+#define TM_FFT_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -105,12 +105,99 @@ extern "C" {
  * For example, if you have <b>512</b> length FFT size, then input buffer must be <b>2 * 512 = 1024</b> samples of float 32 and output buffer is 512 samples of float 32.
  * In common, this is <b>1536</b> samples of float32 which is 4-bytes long in memory.
  * Together this would be 6144 Bytes of HEAP memory.
+ *
+ * \par Real input and fixed point FFT
+ *
+ * When input signal is real (ADC samples for example), half of complex FFT work is not needed.
+ * Library has 3 more FFT structures with the same Init, SetBuffers, AddToBuffer, Process and Free functions:
+ *
+ *  - @ref TM_FFT_R32_t: Real input float FFT using arm_rfft_fast_f32
+ *  - @ref TM_FFT_Q15_t: Real input Q15 FFT using arm_rfft_q15, for cores without FPU (STM32F0xx)
+ *  - @ref TM_FFT_Q31_t: Real input Q31 FFT using arm_rfft_q31, for cores without FPU (STM32F0xx)
+ *
+ * Input buffer is FFT_Size samples long, separate output buffer contains FFT_Size / 2 magnitudes after processing.
+ * For R32 output buffer is FFT_Size long, for Q15 and Q31 it is 2 * FFT_Size long, because it is also used for spectrum calculation.
+ *
+ * \note  Q15 and Q31 transforms scale down result to prevent overflow, see ARM DSP documentation for arm_rfft_q15 and arm_rfft_q31 output format.
+ * \note  Q15 and Q31 FFT sizes are between 32 and 4096 samples.
+ *
+ * \par Streaming spectrum
+ *
+ * For continuous signals, @ref TM_FFT_Stream_F32_t can be attached to initialized FFT structure.
+ * Samples are added in blocks, for example from ADC DMA half and full transfer complete callbacks,
+ * and every time FFT_Size samples are collected, transform is calculated.
+ *
+ * Stream supports:
+ *  - Overlap between consecutive transforms, for example FFT_Size / 2 for 50% overlap
+ *  - Hann, Hamming and Blackman windows, table is calculated once on initialization
+ *  - Magnitude averaging over selected number of transforms
+ *
+ * The same CFFT instance from @ref TM_FFT_Init_F32 is used for all transforms.
+ * When averaged spectrum is ready, it is in FFT output buffer and @ref TM_FFT_StreamCallback_F32 is called.
+ *
+ * \note  Transform is calculated inside add function. When called from DMA interrupt, processing must finish before next half of DMA buffer is filled.
+ *
+ * \par Spectral features
+ *
+ * Instead of sending whole spectrum, @ref TM_FFT_Features_F32 reduces float magnitudes to small @ref TM_FFT_Features_t structure:
+ *
+ *  - Top peaks, sorted by magnitude, with frequency and magnitude corrected by parabolic interpolation between bins
+ *  - Energy in user defined frequency bands and total energy, calculated with arm_power_f32
+ *  - Total harmonic distortion of the biggest peak, used as fundamental frequency
+ *
+ * Peaks are found in one pass over magnitudes, band energies are calculated over band parts of the same array.
+ * Structure contains only float values, so it can be sent as is as feature vector of @ref FFT_FEATURES_SIZE values.
+ * Function works with output of @ref TM_FFT_F32_t, @ref TM_FFT_R32_t and averaged stream spectrum.
+ *
+\code
+//Bands in Hz
+const TM_FFT_Band_t Bands[] = {{10, 100}, {100, 1000}, {1000, 5000}};
+TM_FFT_FeaturesConfig_t Config = {
+	45000.0f / 1024.0f,     //Bin width, sample rate / FFT size
+	512,                    //Number of bins to check, FFT_Size / 2 for real signal
+	Bands, 3,               //Bands
+	5,                      //Harmonics for THD, including fundamental
+	0.01f                   //Minimal peak magnitude
+};
+TM_FFT_Features_t Features;
+
+void TM_FFT_StreamCallback_F32(TM_FFT_Stream_F32_t* Stream) {
+	//Get features from averaged spectrum
+	TM_FFT_Features_F32(Stream->FFT->Output, &Config, &Features);
+	
+	//Send FFT_FEATURES_SIZE float values of Features
+}
+\endcode
+ *
+ * \par Select features sizes
+ *
+ * Sizes are fixed to keep feature vector constant length. Add lines to defines.h to change them:
+ *
+\code
+//Number of peaks in feature vector
+#define FFT_FEATURES_PEAKS     4
+
+//Max number of bands in feature vector
+#define FFT_FEATURES_BANDS     8
+\endcode
  * 
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added streaming spectrum with overlap, window functions and magnitude averaging
+  
+ Version 1.2
+  - October 14, 2026
+  - Added real input FFT for float, Q15 and Q31 samples
+  
+ Version 1.3
+  - October 14, 2026
+  - Added spectral feature extraction with interpolated peaks, band energies and THD
 \endverbatim
  *
  * \par Dependencies
@@ -135,6 +222,11 @@ extern "C" {
  * @{
  */
  
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
 /* Memory allocation function */
 #ifndef LIB_ALLOC_FUNC
 #define LIB_ALLOC_FUNC    malloc
@@ -145,6 +237,19 @@ extern "C" {
 #define LIB_FREE_FUNC     free
 #endif
 
+/* Number of peaks in feature vector */
+#ifndef FFT_FEATURES_PEAKS
+#define FFT_FEATURES_PEAKS    4
+#endif
+
+/* Max number of frequency bands in feature vector */
+#ifndef FFT_FEATURES_BANDS
+#define FFT_FEATURES_BANDS    8
+#endif
+
+/* Feature vector size in float values */
+#define FFT_FEATURES_SIZE     (sizeof(TM_FFT_Features_t) / sizeof(float32_t))
+
 /**
  * @}
  */
@@ -169,6 +274,111 @@ typedef struct {
 	uint32_t MaxIndex;              /*!< Index in output array where max value happened */
 } TM_FFT_F32_t;
 
+/**
+ * @brief  FFT structure for real input 32-bit float
+ */
+typedef struct {
+	float32_t* Input;               /*!< Pointer to data input buffer. Its length must be FFT_Size */
+	float32_t* Output;              /*!< Pointer to data output buffer. Its length must be FFT_Size, FFT_Size / 2 magnitudes are stored after process */
+	uint16_t FFT_Size;              /*!< FFT size in units of samples. This parameter can be a value of 2^n where n is between 5 and 12 */
+	uint8_t UseMalloc;              /*!< Set to 1 when malloc is used for memory allocation for buffers. Meant for private use */
+	uint16_t Count;                 /*!< Number of samples in buffer when using @ref TM_FFT_AddToBuffer_R32 function. Meant for private use */
+	arm_rfft_fast_instance_f32 S;   /*!< RFFT instance. Meant for private use */
+	float32_t MaxValue;             /*!< Max value in FTT result after calculation */
+	uint32_t MaxIndex;              /*!< Index in output array where max value happened */
+} TM_FFT_R32_t;
+
+/**
+ * @brief  FFT structure for real input Q15 samples
+ */
+typedef struct {
+	q15_t* Input;                   /*!< Pointer to data input buffer. Its length must be FFT_Size */
+	q15_t* Output;                  /*!< Pointer to data output buffer. Its length must be 2 * FFT_Size, FFT_Size / 2 magnitudes are stored after process */
+	uint16_t FFT_Size;              /*!< FFT size in units of samples. This parameter can be a value of 2^n where n is between 5 and 12 */
+	uint8_t UseMalloc;              /*!< Set to 1 when malloc is used for memory allocation for buffers. Meant for private use */
+	uint16_t Count;                 /*!< Number of samples in buffer when using @ref TM_FFT_AddToBuffer_Q15 function. Meant for private use */
+	arm_rfft_instance_q15 S;        /*!< RFFT instance. Meant for private use */
+	q15_t MaxValue;                 /*!< Max value in FTT result after calculation */
+	uint32_t MaxIndex;              /*!< Index in output array where max value happened */
+} TM_FFT_Q15_t;
+
+/**
+ * @brief  FFT structure for real input Q31 samples
+ */
+typedef struct {
+	q31_t* Input;                   /*!< Pointer to data input buffer. Its length must be FFT_Size */
+	q31_t* Output;                  /*!< Pointer to data output buffer. Its length must be 2 * FFT_Size, FFT_Size / 2 magnitudes are stored after process */
+	uint16_t FFT_Size;              /*!< FFT size in units of samples. This parameter can be a value of 2^n where n is between 5 and 12 */
+	uint8_t UseMalloc;              /*!< Set to 1 when malloc is used for memory allocation for buffers. Meant for private use */
+	uint16_t Count;                 /*!< Number of samples in buffer when using @ref TM_FFT_AddToBuffer_Q31 function. Meant for private use */
+	arm_rfft_instance_q31 S;        /*!< RFFT instance. Meant for private use */
+	q31_t MaxValue;                 /*!< Max value in FTT result after calculation */
+	uint32_t MaxIndex;              /*!< Index in output array where max value happened */
+} TM_FFT_Q31_t;
+
+/**
+ * @brief  Window functions for streaming spectrum
+ */
+typedef enum {
+	TM_FFT_Window_Rectangular = 0x00, /*!< No window */
+	TM_FFT_Window_Hann,               /*!< Hann window */
+	TM_FFT_Window_Hamming,            /*!< Hamming window */
+	TM_FFT_Window_Blackman            /*!< Blackman window */
+} TM_FFT_Window_t;
+
+/**
+ * @brief  Streaming spectrum structure for 32-bit float
+ */
+typedef struct {
+	TM_FFT_F32_t* FFT;              /*!< Pointer to initialized FFT structure. Meant for private use */
+	float32_t* History;             /*!< Time samples for next transform, FFT_Size length. Meant for private use */
+	float32_t* Window;              /*!< Window table, FFT_Size length, NULL for rectangular window. Meant for private use */
+	float32_t* Sum;                 /*!< Magnitude sum for averaging, FFT_Size length, NULL when not averaging. Meant for private use */
+	uint16_t Fill;                  /*!< Number of samples in history buffer. Meant for private use */
+	uint16_t Hop;                   /*!< Number of new samples between transforms. Meant for private use */
+	uint16_t Averages;              /*!< Number of transforms to average. Meant for private use */
+	uint16_t Frames;                /*!< Number of transforms in current average. Meant for private use */
+	uint32_t Spectra;               /*!< Number of averaged spectra calculated */
+} TM_FFT_Stream_F32_t;
+
+/**
+ * @brief  Frequency band for feature extraction
+ */
+typedef struct {
+	float32_t Start;                /*!< Band start frequency in Hz, included */
+	float32_t End;                  /*!< Band end frequency in Hz, included */
+} TM_FFT_Band_t;
+
+/**
+ * @brief  Feature extraction settings
+ */
+typedef struct {
+	float32_t BinWidth;             /*!< Frequency of one bin in Hz, sample rate / FFT_Size */
+	uint16_t Bins;                  /*!< Number of magnitudes to check, FFT_Size / 2 for real signal */
+	const TM_FFT_Band_t* Bands;     /*!< Pointer to frequency bands, can be NULL */
+	uint8_t BandsCount;             /*!< Number of bands, up to FFT_FEATURES_BANDS */
+	uint8_t Harmonics;              /*!< Number of harmonics for THD, including fundamental. Set to 0 to skip THD */
+	float32_t Threshold;            /*!< Minimal magnitude of peak */
+} TM_FFT_FeaturesConfig_t;
+
+/**
+ * @brief  Spectral peak
+ */
+typedef struct {
+	float32_t Frequency;            /*!< Interpolated peak frequency in Hz */
+	float32_t Magnitude;            /*!< Interpolated peak magnitude, 0 when peak is not found */
+} TM_FFT_Peak_t;
+
+/**
+ * @brief  Feature vector, contains only float values
+ */
+typedef struct {
+	TM_FFT_Peak_t Peaks[FFT_FEATURES_PEAKS]; /*!< Top peaks, biggest first */
+	float32_t Bands[FFT_FEATURES_BANDS];     /*!< Energy in each band, sum of squared magnitudes */
+	float32_t Energy;                        /*!< Total energy without DC bin */
+	float32_t THD;                           /*!< Total harmonic distortion of biggest peak, as ratio */
+} TM_FFT_Features_t;
+
 /**
  * @}
  */
@@ -241,8 +451,216 @@ void TM_FFT_Process_F32(TM_FFT_F32_t* FFT);
  */
 void TM_FFT_Free_F32(TM_FFT_F32_t* FFT);
 
+/**
+ * @brief  Initializes and prepares real input float FFT structure
+ * @param  *FFT: Pointer to empty @ref TM_FFT_R32_t structure for FFT
+ * @param  FFT_Size: Number of samples to be used for FFT calculation, any power of 2 between 32 and 4096
+ * @param  use_malloc: Set parameter to 1, if you want to use HEAP memory to allocate input and output buffers
+ * @retval Initialization status:
+ *            - 0: Initialized OK, ready to use
+ *            - 1: Input FFT SIZE is not valid
+ *            - 2: Malloc failed with allocating input data buffer
+ *            - 3: Malloc failed with allocating output data buffer
+ */
+uint8_t TM_FFT_Init_R32(TM_FFT_R32_t* FFT, uint16_t FFT_Size, uint8_t use_malloc);
+
+/**
+ * @brief  Sets input and output buffers for real input float FFT
+ * @note   Use this function only if you set @arg use_malloc parameter to zero in @ref TM_FFT_Init_R32 function
+ * @param  *FFT: Pointer to @ref TM_FFT_R32_t structure where buffers will be set
+ * @param  *InputBuffer: Pointer to buffer of type float32_t with FFT_Size length
+ * @param  *OutputBuffer: Pointer to buffer of type float32_t with FFT_Size length
+ * @retval None
+ */
+void TM_FFT_SetBuffers_R32(TM_FFT_R32_t* FFT, float32_t* InputBuffer, float32_t* OutputBuffer);
+
+/**
+ * @brief  Adds new sample to input buffer of real input float FFT
+ * @param  *FFT: Pointer to @ref TM_FFT_R32_t structure where new sample will be added
+ * @param  sampleValue: A new sample to be added to buffer
+ * @retval FFT calculation status:
+ *            - 0: Input buffer is not full yet
+ *            - > 0: Input buffer is full and samples are ready to be calculated
+ */
+uint8_t TM_FFT_AddToBuffer_R32(TM_FFT_R32_t* FFT, float32_t sampleValue);
+
+/**
+ * @brief  Processes real input float FFT and saves FFT_Size / 2 magnitudes to output buffer
+ * @note   This function also calculates max value and max index in array where max value happens
+ * @note   Input buffer content is modified
+ * @param  *FFT: Pointer to @ref TM_FFT_R32_t where FFT calculation will happen
+ * @retval None
+ */
+void TM_FFT_Process_R32(TM_FFT_R32_t* FFT);
+
+/**
+ * @brief  Free input and output buffers of real input float FFT
+ * @param  *FFT: Pointer to @ref TM_FFT_R32_t structure where buffers will be free
+ * @retval None
+ */
+void TM_FFT_Free_R32(TM_FFT_R32_t* FFT);
+
+/**
+ * @brief  Initializes and prepares real input Q15 FFT structure
+ * @param  *FFT: Pointer to empty @ref TM_FFT_Q15_t structure for FFT
+ * @param  FFT_Size: Number of samples to be used for FFT calculation, any power of 2 between 32 and 4096
+ * @param  use_malloc: Set parameter to 1, if you want to use HEAP memory to allocate input and output buffers
+ * @retval Initialization status:
+ *            - 0: Initialized OK, ready to use
+ *            - 1: Input FFT SIZE is not valid
+ *            - 2: Malloc failed with allocating input data buffer
+ *            - 3: Malloc failed with allocating output data buffer
+ */
+uint8_t TM_FFT_Init_Q15(TM_FFT_Q15_t* FFT, uint16_t FFT_Size, uint8_t use_malloc);
+
+/**
+ * @brief  Sets input and output buffers for real input Q15 FFT
+ * @note   Use this function only if you set @arg use_malloc parameter to zero in @ref TM_FFT_Init_Q15 function
+ * @param  *FFT: Pointer to @ref TM_FFT_Q15_t structure where buffers will be set
+ * @param  *InputBuffer: Pointer to buffer of type q15_t with FFT_Size length
+ * @param  *OutputBuffer: Pointer to buffer of type q15_t with 2 * FFT_Size length
+ * @retval None
+ */
+void TM_FFT_SetBuffers_Q15(TM_FFT_Q15_t* FFT, q15_t* InputBuffer, q15_t* OutputBuffer);
+
+/**
+ * @brief  Adds new sample to input buffer of real input Q15 FFT
+ * @param  *FFT: Pointer to @ref TM_FFT_Q15_t structure where new sample will be added
+ * @param  sampleValue: A new sample to be added to buffer
+ * @retval FFT calculation status:
+ *            - 0: Input buffer is not full yet
+ *            - > 0: Input buffer is full and samples are ready to be calculated
+ */
+uint8_t TM_FFT_AddToBuffer_Q15(TM_FFT_Q15_t* FFT, q15_t sampleValue);
+
+/**
+ * @brief  Processes real input Q15 FFT and saves FFT_Size / 2 magnitudes to output buffer
+ * @note   This function also calculates max value and max index in array where max value happens
+ * @note   Input buffer content is modified
+ * @param  *FFT: Pointer to @ref TM_FFT_Q15_t where FFT calculation will happen
+ * @retval None
+ */
+void TM_FFT_Process_Q15(TM_FFT_Q15_t* FFT);
+
+/**
+ * @brief  Free input and output buffers of real input Q15 FFT
+ * @param  *FFT: Pointer to @ref TM_FFT_Q15_t structure where buffers will be free
+ * @retval None
+ */
+void TM_FFT_Free_Q15(TM_FFT_Q15_t* FFT);
+
+/**
+ * @brief  Initializes and prepares real input Q31 FFT structure
+ * @param  *FFT: Pointer to empty @ref TM_FFT_Q31_t structure for FFT
+ * @param  FFT_Size: Number of samples to be used for FFT calculation, any power of 2 between 32 and 4096
+ * @param  use_malloc: Set parameter to 1, if you want to use HEAP memory to allocate input and output buffers
+ * @retval Initialization status:
+ *            - 0: Initialized OK, ready to use
+ *            - 1: Input FFT SIZE is not valid
+ *            - 2: Malloc failed with allocating input data buffer
+ *            - 3: Malloc failed with allocating output data buffer
+ */
+uint8_t TM_FFT_Init_Q31(TM_FFT_Q31_t* FFT, uint16_t FFT_Size, uint8_t use_malloc);
+
+/**
+ * @brief  Sets input and output buffers for real input Q31 FFT
+ * @note   Use this function only if you set @arg use_malloc parameter to zero in @ref TM_FFT_Init_Q31 function
+ * @param  *FFT: Pointer to @ref TM_FFT_Q31_t structure where buffers will be set
+ * @param  *InputBuffer: Pointer to buffer of type q31_t with FFT_Size length
+ * @param  *OutputBuffer: Pointer to buffer of type q31_t with 2 * FFT_Size length
+ * @retval None
+ */
+void TM_FFT_SetBuffers_Q31(TM_FFT_Q31_t* FFT, q31_t* InputBuffer, q31_t* OutputBuffer);
+
+/**
+ * @brief  Adds new sample to input buffer of real input Q31 FFT
+ * @param  *FFT: Pointer to @ref TM_FFT_Q31_t structure where new sample will be added
+ * @param  sampleValue: A new sample to be added to buffer
+ * @retval FFT calculation status:
+ *            - 0: Input buffer is not full yet
+ *            - > 0: Input buffer is full and samples are ready to be calculated
+ */
+uint8_t TM_FFT_AddToBuffer_Q31(TM_FFT_Q31_t* FFT, q31_t sampleValue);
+
+/**
+ * @brief  Processes real input Q31 FFT and saves FFT_Size / 2 magnitudes to output buffer
+ * @note   This function also calculates max value and max index in array where max value happens
+ * @note   Input buffer content is modified
+ * @param  *FFT: Pointer to @ref TM_FFT_Q31_t where FFT calculation will happen
+ * @retval None
+ */
+void TM_FFT_Process_Q31(TM_FFT_Q31_t* FFT);
+
+/**
+ * @brief  Free input and output buffers of real input Q31 FFT
+ * @param  *FFT: Pointer to @ref TM_FFT_Q31_t structure where buffers will be free
+ * @retval None
+ */
+void TM_FFT_Free_Q31(TM_FFT_Q31_t* FFT);
+
+/**
+ * @brief  Initializes streaming spectrum on already initialized FFT structure
+ * @note   FFT structure must have input and output buffers set
+ * @param  *Stream: Pointer to empty @ref TM_FFT_Stream_F32_t structure
+ * @param  *FFT: Pointer to initialized @ref TM_FFT_F32_t structure
+ * @param  Overlap: Number of samples shared between consecutive transforms. Must be less than FFT_Size
+ * @param  Window: Window function. This parameter can be a value of @ref TM_FFT_Window_t enumeration
+ * @param  Averages: Number of transforms averaged for one result. Set to 1 or 0 for no averaging
+ * @retval Initialization status:
+ *            - 0: Initialized OK, ready to use
+ *            - 1: Input parameters are not valid
+ *            - 2: Memory allocation failed
+ */
+uint8_t TM_FFT_StreamInit_F32(TM_FFT_Stream_F32_t* Stream, TM_FFT_F32_t* FFT, uint16_t Overlap, TM_FFT_Window_t Window, uint16_t Averages);
+
+/**
+ * @brief  Adds block of samples to stream and calculates all transforms which are ready
+ * @param  *Stream: Pointer to @ref TM_FFT_Stream_F32_t structure
+ * @param  *Samples: Pointer to samples
+ * @param  count: Number of samples
+ * @retval Number of averaged spectra finished during this call
+ */
+uint16_t TM_FFT_StreamAdd_F32(TM_FFT_Stream_F32_t* Stream, const float32_t* Samples, uint16_t count);
+
+/**
+ * @brief  Adds block of raw ADC samples to stream and calculates all transforms which are ready
+ * @note   Use it directly with half of ADC DMA buffer
+ * @param  *Stream: Pointer to @ref TM_FFT_Stream_F32_t structure
+ * @param  *Samples: Pointer to raw ADC samples
+ * @param  count: Number of samples
+ * @param  offset: Value subtracted from each sample, for example 2048 for 12-bit ADC, so window does not spread DC component
+ * @retval Number of averaged spectra finished during this call
+ */
+uint16_t TM_FFT_StreamAddADC_F32(TM_FFT_Stream_F32_t* Stream, const uint16_t* Samples, uint16_t count, float32_t offset);
+
+/**
+ * @brief  Frees memory allocated for streaming spectrum
+ * @param  *Stream: Pointer to @ref TM_FFT_Stream_F32_t structure
+ * @retval None
+ */
+void TM_FFT_StreamFree_F32(TM_FFT_Stream_F32_t* Stream);
+
+/**
+ * @brief  Called when new averaged spectrum is ready in FFT output buffer
+ * @param  *Stream: Pointer to @ref TM_FFT_Stream_F32_t structure
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_FFT_StreamCallback_F32(TM_FFT_Stream_F32_t* Stream);
+
+/**
+ * @brief  Extracts spectral features from float magnitudes
+ * @note   DC bin is not used for peaks and total energy
+ * @param  *Magnitudes: Pointer to magnitudes, FFT output buffer after process
+ * @param  *Config: Pointer to @ref TM_FFT_FeaturesConfig_t settings
+ * @param  *Features: Pointer to @ref TM_FFT_Features_t structure to store features to
+ * @retval Number of peaks found, up to FFT_FEATURES_PEAKS
+ */
+uint8_t TM_FFT_Features_F32(const float32_t* Magnitudes, const TM_FFT_FeaturesConfig_t* Config, TM_FFT_Features_t* Features);
+
 /**
  * @brief  Gets max value from already calculated FFT result
+ * @note   Works with all FFT structures in library
  * @param  FFT: Pointer to @ref TM_FFT_F32_t structure where max value should be checked
  * @retval None
  * @note   Defined as macro for faster execution
@@ -268,7 +686,8 @@ void TM_FFT_Free_F32(TM_FFT_F32_t* FFT);
 /**
  * @brief  Gets FFT result value from output buffer at given index
  * @param  FFT: Pointer to @ref TM_FFT_F32_t structure where FFT output sample will be returned
- * @param  index: Index in buffer where result will be returned. Valid input is between 0 and FFT_Size - 1
+ * @param  index: Index in buffer where result will be returned. Valid input is between 0 and FFT_Size - 1,
+ *            or between 0 and FFT_Size / 2 - 1 for real input FFT structures
  * @retval Value at given index
  * @note   Defined as macro for faster execution
  */
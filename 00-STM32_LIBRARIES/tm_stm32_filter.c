@@ -0,0 +1,241 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_filter.h"
+
+uint8_t TM_FILTER_InitFIR_F32(TM_FILTER_F32_t* Filter, const float32_t* Coeffs, uint16_t Taps, float32_t* State, uint16_t BlockSize) {
+	/* Check parameters */
+	if (Taps == 0 || BlockSize == 0) {
+		return 1;
+	}
+	
+	/* Save settings */
+	Filter->Type = TM_FILTER_Type_FIR;
+	Filter->BlockSize = BlockSize;
+	Filter->OutputSize = BlockSize;
+	Filter->Work = NULL;
+	
+	/* Init ARM DSP instance */
+	arm_fir_init_f32(&Filter->Instance.FIR, Taps, (float32_t *)Coeffs, State, BlockSize);
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_FILTER_InitIIR_F32(TM_FILTER_F32_t* Filter, const float32_t* Coeffs, uint8_t Stages, float32_t* State, uint16_t BlockSize) {
+	/* Check parameters */
+	if (Stages == 0 || BlockSize == 0) {
+		return 1;
+	}
+	
+	/* Save settings */
+	Filter->Type = TM_FILTER_Type_IIR;
+	Filter->BlockSize = BlockSize;
+	Filter->OutputSize = BlockSize;
+	Filter->Work = NULL;
+	
+	/* Init ARM DSP instance, state is not cleared by init */
+	memset(State, 0, FILTER_IIR_STATE_SIZE(Stages) * sizeof(float32_t));
+	arm_biquad_cascade_df2T_init_f32(&Filter->Instance.IIR, Stages, (float32_t *)Coeffs, State);
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_FILTER_InitDecimate_F32(TM_FILTER_F32_t* Filter, const float32_t* Coeffs, uint16_t Taps, uint8_t Factor, float32_t* State, uint16_t BlockSize) {
+	/* Check parameters */
+	if (Taps == 0 || Factor == 0 || BlockSize == 0) {
+		return 1;
+	}
+	
+	/* Init ARM DSP instance, block size must be multiple of factor */
+	if (arm_fir_decimate_init_f32(&Filter->Instance.Decimate, Taps, Factor, (float32_t *)Coeffs, State, BlockSize) != ARM_MATH_SUCCESS) {
+		return 1;
+	}
+	
+	/* Save settings */
+	Filter->Type = TM_FILTER_Type_Decimate;
+	Filter->BlockSize = BlockSize;
+	Filter->OutputSize = BlockSize / Factor;
+	Filter->Work = NULL;
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_FILTER_SetADC_F32(TM_FILTER_F32_t* Filter, float32_t* Work, float32_t Offset, float32_t Scale) {
+	/* Save settings */
+	Filter->Work = Work;
+	Filter->Offset = Offset;
+	Filter->Scale = Scale;
+}
+
+uint16_t TM_FILTER_Process_F32(TM_FILTER_F32_t* Filter, const float32_t* Input, float32_t* Output) {
+	/* Process block */
+	switch (Filter->Type) {
+		case TM_FILTER_Type_FIR:
+			arm_fir_f32(&Filter->Instance.FIR, (float32_t *)Input, Output, Filter->BlockSize);
+			break;
+		case TM_FILTER_Type_IIR:
+			arm_biquad_cascade_df2T_f32(&Filter->Instance.IIR, (float32_t *)Input, Output, Filter->BlockSize);
+			break;
+		case TM_FILTER_Type_Decimate:
+			arm_fir_decimate_f32(&Filter->Instance.Decimate, (float32_t *)Input, Output, Filter->BlockSize);
+			break;
+		default:
+			return 0;
+	}
+	
+	/* Return number of output samples */
+	return Filter->OutputSize;
+}
+
+uint16_t TM_FILTER_ProcessADC_F32(TM_FILTER_F32_t* Filter, const uint16_t* Data, uint8_t Channel, uint8_t Channels, float32_t* Output) {
+	float32_t* work = Filter->Work;
+	uint16_t count = Filter->BlockSize;
+	
+	/* Check work buffer */
+	if (work == NULL) {
+		return 0;
+	}
+	
+	/* Take channel samples from interleaved data */
+	Data += Channel;
+	while (count--) {
+		*work++ = ((float32_t)*Data - Filter->Offset) * Filter->Scale;
+		Data += Channels;
+	}
+	
+	/* Filter block */
+	return TM_FILTER_Process_F32(Filter, Filter->Work, Output);
+}
+
+uint8_t TM_FILTER_InitFIR_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Coeffs, uint16_t Taps, q15_t* State, uint16_t BlockSize) {
+	/* Check parameters */
+	if (BlockSize == 0) {
+		return 1;
+	}
+	
+	/* Init ARM DSP instance, taps must be even and at least 4 */
+	if (arm_fir_init_q15(&Filter->Instance.FIR, Taps, (q15_t *)Coeffs, State, BlockSize) != ARM_MATH_SUCCESS) {
+		return 1;
+	}
+	
+	/* Save settings */
+	Filter->Type = TM_FILTER_Type_FIR;
+	Filter->BlockSize = BlockSize;
+	Filter->OutputSize = BlockSize;
+	Filter->Work = NULL;
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_FILTER_InitIIR_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Coeffs, uint8_t Stages, q15_t* State, int8_t PostShift, uint16_t BlockSize) {
+	/* Check parameters */
+	if (Stages == 0 || BlockSize == 0) {
+		return 1;
+	}
+	
+	/* Save settings */
+	Filter->Type = TM_FILTER_Type_IIR;
+	Filter->BlockSize = BlockSize;
+	Filter->OutputSize = BlockSize;
+	Filter->Work = NULL;
+	
+	/* Init ARM DSP instance */
+	arm_biquad_cascade_df1_init_q15(&Filter->Instance.IIR, Stages, (q15_t *)Coeffs, State, PostShift);
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_FILTER_InitDecimate_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Coeffs, uint16_t Taps, uint8_t Factor, q15_t* State, uint16_t BlockSize) {
+	/* Check parameters */
+	if (Factor == 0 || BlockSize == 0) {
+		return 1;
+	}
+	
+	/* Init ARM DSP instance */
+	if (arm_fir_decimate_init_q15(&Filter->Instance.Decimate, Taps, Factor, (q15_t *)Coeffs, State, BlockSize) != ARM_MATH_SUCCESS) {
+		return 1;
+	}
+	
+	/* Save settings */
+	Filter->Type = TM_FILTER_Type_Decimate;
+	Filter->BlockSize = BlockSize;
+	Filter->OutputSize = BlockSize / Factor;
+	Filter->Work = NULL;
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_FILTER_SetADC_Q15(TM_FILTER_Q15_t* Filter, q15_t* Work, uint16_t Offset, uint8_t Shift) {
+	/* Save settings */
+	Filter->Work = Work;
+	Filter->Offset = Offset;
+	Filter->Shift = Shift;
+}
+
+uint16_t TM_FILTER_Process_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Input, q15_t* Output) {
+	/* Process block */
+	switch (Filter->Type) {
+		case TM_FILTER_Type_FIR:
+			arm_fir_q15(&Filter->Instance.FIR, (q15_t *)Input, Output, Filter->BlockSize);
+			break;
+		case TM_FILTER_Type_IIR:
+			arm_biquad_cascade_df1_q15(&Filter->Instance.IIR, (q15_t *)Input, Output, Filter->BlockSize);
+			break;
+		case TM_FILTER_Type_Decimate:
+			arm_fir_decimate_q15(&Filter->Instance.Decimate, (q15_t *)Input, Output, Filter->BlockSize);
+			break;
+		default:
+			return 0;
+	}
+	
+	/* Return number of output samples */
+	return Filter->OutputSize;
+}
+
+uint16_t TM_FILTER_ProcessADC_Q15(TM_FILTER_Q15_t* Filter, const uint16_t* Data, uint8_t Channel, uint8_t Channels, q15_t* Output) {
+	q15_t* work = Filter->Work;
+	uint16_t count = Filter->BlockSize;
+	
+	/* Check work buffer */
+	if (work == NULL) {
+		return 0;
+	}
+	
+	/* Take channel samples from interleaved data */
+	Data += Channel;
+	while (count--) {
+		*work++ = (q15_t)(((int32_t)*Data - Filter->Offset) << Filter->Shift);
+		Data += Channels;
+	}
+	
+	/* Filter block */
+	return TM_FILTER_Process_Q15(Filter, Filter->Work, Output);
+}
@@ -0,0 +1,386 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   FIR, IIR and decimation filters on ADC DMA blocks with ARM CMSIS DSP for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_FILTER_H
+#define TM_FILTER_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_FILTER
+ * @brief    FIR, IIR and decimation filters on ADC DMA blocks with ARM CMSIS DSP for STM32Fxxx
+ * @{
+ *
+ * Library wraps ARM CMSIS DSP filter functions for block processing:
+ *
+ *  - FIR filter, arm_fir_f32 and arm_fir_q15
+ *  - IIR filter as cascade of biquads, arm_biquad_cascade_df2T_f32 and arm_biquad_cascade_df1_q15
+ *  - FIR filter with decimation, arm_fir_decimate_f32 and arm_fir_decimate_q15
+ *
+ * Float functions are for cores with FPU (STM32F4xx and STM32F7xx), Q15 functions are for STM32F0xx or when memory is limited.
+ *
+ * \par Block processing
+ *
+ * Filter is initialized with fixed block size, which is number of samples of one channel in half of ADC DMA buffer.
+ * Raw ADC samples from half of buffer are passed directly to @ref TM_FILTER_ProcessADC_F32, which takes samples of one channel
+ * from interleaved scan data, removes offset, scales them and filters whole block with one DSP call.
+ *
+ * \par Memory
+ *
+ * Library does not allocate memory. Coefficients, state and work buffers are provided by user, so they can be placed to fast memory,
+ * for example CCM RAM with __ccm attribute. Use macros for state and work buffer sizes.
+ * Output can go directly to FFT input, for example with @ref TM_FFT_StreamAdd_F32.
+ *
+\code
+#define BLOCK      256        //Sequences in half of ADC buffer
+#define TAPS       32
+#define CHANNELS   2
+
+uint16_t ADC_Buffer[2 * BLOCK * CHANNELS];
+const float32_t Coeffs[TAPS] = {...};
+
+__ccm float32_t State[FILTER_FIR_STATE_SIZE(TAPS, BLOCK)];
+__ccm float32_t Work[BLOCK];
+__ccm float32_t Output[BLOCK];
+
+TM_FILTER_F32_t Filter;
+
+//Low-pass FIR, 12-bit samples to -1.0 .. 1.0 range
+TM_FILTER_InitFIR_F32(&Filter, Coeffs, TAPS, State, BLOCK);
+TM_FILTER_SetADC_F32(&Filter, Work, 2048.0f, 1.0f / 2048.0f);
+
+TM_ADC_StartScan(ADC1, Channels, SamplingTimes, CHANNELS, ADC_Buffer, 2 * BLOCK, ADC_EXTERNALTRIGCONV_T2_TRGO);
+
+void TM_ADC_ScanCallback(ADC_TypeDef* ADCx, uint16_t* Data, uint16_t Sequences) {
+	//Filter channel 0 from half of buffer
+	uint16_t count = TM_FILTER_ProcessADC_F32(&Filter, Data, 0, CHANNELS, Output);
+	
+	//Send filtered block to FFT
+	TM_FFT_StreamAdd_F32(&Stream, Output, count);
+}
+\endcode
+ *
+ * \note  Filter processes exactly one block per call, so number of sequences in half of DMA buffer must be the same as block size
+ * \note  For decimation, block size must be multiple of decimation factor. Output has block size / factor samples
+ * \note  Q15 FIR and decimation filters need even number of taps, at least 4
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - attributes.h
+ - ARM MATH
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+
+#include "arm_math.h"
+
+/**
+ * @defgroup TM_FILTER_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  State sizes in samples
+ * @{
+ */
+#define FILTER_FIR_STATE_SIZE(taps, block)          ((taps) + (block) - 1) /*!< Float FIR filter, taps and block size */
+#define FILTER_IIR_STATE_SIZE(stages)               (2 * (stages))         /*!< Float IIR filter, number of biquad stages */
+#define FILTER_DECIMATE_STATE_SIZE(taps, block)     ((taps) + (block) - 1) /*!< Float and Q15 decimation filter */
+#define FILTER_FIR_STATE_SIZE_Q15(taps, block)      ((taps) + (block))     /*!< Q15 FIR filter */
+#define FILTER_IIR_STATE_SIZE_Q15(stages)           (4 * (stages))         /*!< Q15 IIR filter */
+/**
+ * @}
+ */
+
+/**
+ * @brief  Coefficients sizes in values
+ * @{
+ */
+#define FILTER_IIR_COEFFS_SIZE(stages)              (5 * (stages))         /*!< Float IIR filter, {b0, b1, b2, a1, a2} for each stage */
+#define FILTER_IIR_COEFFS_SIZE_Q15(stages)          (6 * (stages))         /*!< Q15 IIR filter, {b0, 0, b1, b2, a1, a2} for each stage */
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_FILTER_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Filter type
+ */
+typedef enum {
+	TM_FILTER_Type_FIR = 0x00, /*!< FIR filter */
+	TM_FILTER_Type_IIR,        /*!< IIR filter, cascade of biquads */
+	TM_FILTER_Type_Decimate    /*!< FIR filter with decimation */
+} TM_FILTER_Type_t;
+
+/**
+ * @brief  Float filter structure
+ * @note   Members are private and should not be modified by user
+ */
+typedef struct {
+	TM_FILTER_Type_t Type;                            /*!< Filter type */
+	uint16_t BlockSize;                               /*!< Input samples per block */
+	uint16_t OutputSize;                              /*!< Output samples per block */
+	float32_t* Work;                                  /*!< Work buffer for ADC samples, BlockSize long */
+	float32_t Offset;                                 /*!< Value subtracted from ADC samples */
+	float32_t Scale;                                  /*!< ADC samples multiplier, after offset */
+	union {
+		arm_fir_instance_f32 FIR;
+		arm_biquad_cascade_df2T_instance_f32 IIR;
+		arm_fir_decimate_instance_f32 Decimate;
+	} Instance;                                       /*!< ARM DSP instance */
+} TM_FILTER_F32_t;
+
+/**
+ * @brief  Q15 filter structure
+ * @note   Members are private and should not be modified by user
+ */
+typedef struct {
+	TM_FILTER_Type_t Type;                            /*!< Filter type */
+	uint16_t BlockSize;                               /*!< Input samples per block */
+	uint16_t OutputSize;                              /*!< Output samples per block */
+	q15_t* Work;                                      /*!< Work buffer for ADC samples, BlockSize long */
+	uint16_t Offset;                                  /*!< Value subtracted from ADC samples */
+	uint8_t Shift;                                    /*!< ADC samples left shift, after offset */
+	union {
+		arm_fir_instance_q15 FIR;
+		arm_biquad_casd_df1_inst_q15 IIR;
+		arm_fir_decimate_instance_q15 Decimate;
+	} Instance;                                       /*!< ARM DSP instance */
+} TM_FILTER_Q15_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_FILTER_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes float FIR filter
+ * @param  *Filter: Pointer to empty @ref TM_FILTER_F32_t structure
+ * @param  *Coeffs: Pointer to coefficients, in time reversed order as ARM DSP expects. Must stay valid
+ * @param  Taps: Number of coefficients
+ * @param  *State: Pointer to state buffer, @ref FILTER_FIR_STATE_SIZE samples long
+ * @param  BlockSize: Number of samples processed in one call
+ * @retval Init status:
+ *            - 0: OK
+ *            - > 0: Invalid parameters
+ */
+uint8_t TM_FILTER_InitFIR_F32(TM_FILTER_F32_t* Filter, const float32_t* Coeffs, uint16_t Taps, float32_t* State, uint16_t BlockSize);
+
+/**
+ * @brief  Initializes float IIR filter as cascade of biquad stages
+ * @param  *Filter: Pointer to empty @ref TM_FILTER_F32_t structure
+ * @param  *Coeffs: Pointer to coefficients, {b0, b1, b2, a1, a2} for each stage, a1 and a2 with ARM DSP sign. Must stay valid
+ * @param  Stages: Number of biquad stages
+ * @param  *State: Pointer to state buffer, @ref FILTER_IIR_STATE_SIZE samples long
+ * @param  BlockSize: Number of samples processed in one call
+ * @retval Init status:
+ *            - 0: OK
+ *            - > 0: Invalid parameters
+ */
+uint8_t TM_FILTER_InitIIR_F32(TM_FILTER_F32_t* Filter, const float32_t* Coeffs, uint8_t Stages, float32_t* State, uint16_t BlockSize);
+
+/**
+ * @brief  Initializes float FIR filter with decimation
+ * @param  *Filter: Pointer to empty @ref TM_FILTER_F32_t structure
+ * @param  *Coeffs: Pointer to anti-alias filter coefficients, in time reversed order. Must stay valid
+ * @param  Taps: Number of coefficients
+ * @param  Factor: Decimation factor
+ * @param  *State: Pointer to state buffer, @ref FILTER_DECIMATE_STATE_SIZE samples long
+ * @param  BlockSize: Number of input samples processed in one call, multiple of factor
+ * @retval Init status:
+ *            - 0: OK
+ *            - > 0: Invalid parameters
+ */
+uint8_t TM_FILTER_InitDecimate_F32(TM_FILTER_F32_t* Filter, const float32_t* Coeffs, uint16_t Taps, uint8_t Factor, float32_t* State, uint16_t BlockSize);
+
+/**
+ * @brief  Sets conversion of raw ADC samples for @ref TM_FILTER_ProcessADC_F32
+ * @note   Sample is converted as (ADC - Offset) * Scale
+ * @param  *Filter: Pointer to initialized @ref TM_FILTER_F32_t structure
+ * @param  *Work: Pointer to work buffer, block size samples long
+ * @param  Offset: Value subtracted from each sample, for example 2048 for 12-bit ADC
+ * @param  Scale: Multiplier after offset is subtracted
+ * @retval None
+ */
+void TM_FILTER_SetADC_F32(TM_FILTER_F32_t* Filter, float32_t* Work, float32_t Offset, float32_t Scale);
+
+/**
+ * @brief  Filters one block of samples
+ * @param  *Filter: Pointer to initialized @ref TM_FILTER_F32_t structure
+ * @param  *Input: Pointer to block size input samples
+ * @param  *Output: Pointer to output buffer, block size samples long or block size / factor for decimation
+ * @retval Number of output samples
+ */
+uint16_t TM_FILTER_Process_F32(TM_FILTER_F32_t* Filter, const float32_t* Input, float32_t* Output);
+
+/**
+ * @brief  Filters one block of raw ADC samples of one channel
+ * @note   Use it directly with half of ADC DMA buffer, in @ref TM_ADC_ScanCallback for example
+ * @param  *Filter: Pointer to initialized @ref TM_FILTER_F32_t structure with ADC conversion set
+ * @param  *Data: Pointer to raw ADC samples, block size sequences of interleaved channels
+ * @param  Channel: Channel index in sequence
+ * @param  Channels: Number of channels in sequence, 1 for single channel or interleaved mode
+ * @param  *Output: Pointer to output buffer
+ * @retval Number of output samples
+ */
+uint16_t TM_FILTER_ProcessADC_F32(TM_FILTER_F32_t* Filter, const uint16_t* Data, uint8_t Channel, uint8_t Channels, float32_t* Output);
+
+/**
+ * @brief  Initializes Q15 FIR filter
+ * @param  *Filter: Pointer to empty @ref TM_FILTER_Q15_t structure
+ * @param  *Coeffs: Pointer to coefficients, in time reversed order. Must stay valid
+ * @param  Taps: Number of coefficients, even number, at least 4
+ * @param  *State: Pointer to state buffer, @ref FILTER_FIR_STATE_SIZE_Q15 samples long
+ * @param  BlockSize: Number of samples processed in one call
+ * @retval Init status:
+ *            - 0: OK
+ *            - > 0: Invalid parameters
+ */
+uint8_t TM_FILTER_InitFIR_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Coeffs, uint16_t Taps, q15_t* State, uint16_t BlockSize);
+
+/**
+ * @brief  Initializes Q15 IIR filter as cascade of biquad stages
+ * @param  *Filter: Pointer to empty @ref TM_FILTER_Q15_t structure
+ * @param  *Coeffs: Pointer to coefficients, {b0, 0, b1, b2, a1, a2} for each stage. Must stay valid
+ * @param  Stages: Number of biquad stages
+ * @param  *State: Pointer to state buffer, @ref FILTER_IIR_STATE_SIZE_Q15 samples long
+ * @param  PostShift: Shift of accumulator result, coefficients are scaled by 2^-PostShift
+ * @param  BlockSize: Number of samples processed in one call
+ * @retval Init status:
+ *            - 0: OK
+ *            - > 0: Invalid parameters
+ */
+uint8_t TM_FILTER_InitIIR_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Coeffs, uint8_t Stages, q15_t* State, int8_t PostShift, uint16_t BlockSize);
+
+/**
+ * @brief  Initializes Q15 FIR filter with decimation
+ * @param  *Filter: Pointer to empty @ref TM_FILTER_Q15_t structure
+ * @param  *Coeffs: Pointer to anti-alias filter coefficients, in time reversed order. Must stay valid
+ * @param  Taps: Number of coefficients, even number, at least 4
+ * @param  Factor: Decimation factor
+ * @param  *State: Pointer to state buffer, @ref FILTER_DECIMATE_STATE_SIZE samples long
+ * @param  BlockSize: Number of input samples processed in one call, multiple of factor
+ * @retval Init status:
+ *            - 0: OK
+ *            - > 0: Invalid parameters
+ */
+uint8_t TM_FILTER_InitDecimate_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Coeffs, uint16_t Taps, uint8_t Factor, q15_t* State, uint16_t BlockSize);
+
+/**
+ * @brief  Sets conversion of raw ADC samples for @ref TM_FILTER_ProcessADC_Q15
+ * @note   Sample is converted as (ADC - Offset) << Shift, for example offset 2048 and shift 4 for 12-bit ADC
+ * @param  *Filter: Pointer to initialized @ref TM_FILTER_Q15_t structure
+ * @param  *Work: Pointer to work buffer, block size samples long
+ * @param  Offset: Value subtracted from each sample
+ * @param  Shift: Left shift after offset is subtracted
+ * @retval None
+ */
+void TM_FILTER_SetADC_Q15(TM_FILTER_Q15_t* Filter, q15_t* Work, uint16_t Offset, uint8_t Shift);
+
+/**
+ * @brief  Filters one block of Q15 samples
+ * @param  *Filter: Pointer to initialized @ref TM_FILTER_Q15_t structure
+ * @param  *Input: Pointer to block size input samples
+ * @param  *Output: Pointer to output buffer, block size samples long or block size / factor for decimation
+ * @retval Number of output samples
+ */
+uint16_t TM_FILTER_Process_Q15(TM_FILTER_Q15_t* Filter, const q15_t* Input, q15_t* Output);
+
+/**
+ * @brief  Filters one block of raw ADC samples of one channel
+ * @param  *Filter: Pointer to initialized @ref TM_FILTER_Q15_t structure with ADC conversion set
+ * @param  *Data: Pointer to raw ADC samples, block size sequences of interleaved channels
+ * @param  Channel: Channel index in sequence
+ * @param  Channels: Number of channels in sequence
+ * @param  *Output: Pointer to output buffer
+ * @retval Number of output samples
+ */
+uint16_t TM_FILTER_ProcessADC_Q15(TM_FILTER_Q15_t* Filter, const uint16_t* Data, uint8_t Channel, uint8_t Channels, q15_t* Output);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
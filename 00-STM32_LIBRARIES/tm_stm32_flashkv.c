@@ -0,0 +1,498 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_flashkv.h"
+
+/* Sector header */
+#define FLASHKV_MAGIC            0x4B56534D
+#define FLASHKV_HEADER_SIZE      8
+
+/* Record header, key and length in first word, CRC in second word */
+#define FLASHKV_RECORD_SIZE      8
+#define FLASHKV_EMPTY            0xFFFFFFFF
+#define FLASHKV_KEY_EMPTY        0xFFFF
+
+/* Record size with padding */
+#define FLASHKV_SIZE(len)        (FLASHKV_RECORD_SIZE + (((len) + 3) & ~3))
+
+/* Words in flash */
+#define FLASHKV_WORD(addr)       (*(__IO uint32_t *)(addr))
+
+/* Index entry */
+typedef struct {
+	uint16_t Key;                /* Key or FLASHKV_KEY_EMPTY */
+	uint16_t Length;             /* Value length, 0 for deleted key */
+	uint32_t Address;            /* Address of last record */
+} TM_FLASHKV_Index_t;
+
+/* Private variables */
+static TM_FLASHKV_Index_t Index[FLASHKV_INDEX_SIZE];
+static uint32_t Active;          /* Active sector address */
+static uint32_t Sequence;        /* Active sector sequence number */
+static uint32_t Next;            /* Address of next record */
+
+/* Private functions */
+static TM_FLASHKV_Index_t* TM_FLASHKV_INT_Find(uint16_t Key, uint8_t add);
+static uint32_t TM_FLASHKV_INT_Crc(uint32_t header, const void* Data, uint16_t Length);
+static uint8_t TM_FLASHKV_INT_Check(uint32_t address, uint32_t end);
+static uint32_t TM_FLASHKV_INT_Scan(uint32_t sector);
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Append(uint32_t address, uint16_t Key, const void* Data, uint16_t Length);
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Program(uint32_t address, uint32_t data);
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Erase(uint32_t sector);
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Format(uint32_t sector, uint32_t sequence);
+static uint32_t TM_FLASHKV_INT_Other(uint32_t sector);
+
+TM_FLASHKV_Result_t TM_FLASHKV_Init(void) {
+	uint8_t validA, validB;
+	
+	/* Enable CRC */
+	TM_CRC_Init();
+	
+	/* Check sector headers */
+	validA = FLASHKV_WORD(FLASHKV_ADDRESS_A) == FLASHKV_MAGIC;
+	validB = FLASHKV_WORD(FLASHKV_ADDRESS_B) == FLASHKV_MAGIC;
+	
+	/* Select active sector, both are valid when compaction was interrupted before old sector was erased */
+	if (validA && validB) {
+		if ((int32_t)(FLASHKV_WORD(FLASHKV_ADDRESS_B + 4) - FLASHKV_WORD(FLASHKV_ADDRESS_A + 4)) > 0) {
+			Active = FLASHKV_ADDRESS_B;
+		} else {
+			Active = FLASHKV_ADDRESS_A;
+		}
+	} else if (validA) {
+		Active = FLASHKV_ADDRESS_A;
+	} else if (validB) {
+		Active = FLASHKV_ADDRESS_B;
+	} else {
+		/* First use, format sector A */
+		if (TM_FLASHKV_INT_Format(FLASHKV_ADDRESS_A, 0) != TM_FLASHKV_Result_Ok) {
+			return TM_FLASHKV_Result_Error;
+		}
+		Active = FLASHKV_ADDRESS_A;
+	}
+	Sequence = FLASHKV_WORD(Active + 4);
+	
+	/* Build index */
+	Next = TM_FLASHKV_INT_Scan(Active);
+	if (Next == 0) {
+		return TM_FLASHKV_Result_Full;
+	}
+	
+	/* Other sector must be erased for next compaction */
+	if (!TM_FLASHKV_INT_Check(TM_FLASHKV_INT_Other(Active), TM_FLASHKV_INT_Other(Active) + FLASHKV_SECTOR_SIZE)) {
+		return TM_FLASHKV_INT_Erase(TM_FLASHKV_INT_Other(Active));
+	}
+	
+	/* Return OK */
+	return TM_FLASHKV_Result_Ok;
+}
+
+TM_FLASHKV_Result_t TM_FLASHKV_Write(uint16_t Key, const void* Data, uint16_t Length) {
+	TM_FLASHKV_Index_t* Entry;
+	TM_FLASHKV_Result_t res;
+	
+	/* Check parameters */
+	if (Key == FLASHKV_KEY_EMPTY) {
+		return TM_FLASHKV_Result_Error;
+	}
+	if (Length == 0 || Length > FLASHKV_MAX_LENGTH) {
+		return TM_FLASHKV_Result_InvalidSize;
+	}
+	
+	/* Get index entry */
+	Entry = TM_FLASHKV_INT_Find(Key, 1);
+	if (Entry == NULL) {
+		return TM_FLASHKV_Result_Full;
+	}
+	
+	/* Same value is already stored */
+	if (Entry->Length == Length && memcmp((const void *)(Entry->Address + FLASHKV_RECORD_SIZE), Data, Length) == 0) {
+		return TM_FLASHKV_Result_Ok;
+	}
+	
+	/* Make space */
+	if ((Next + FLASHKV_SIZE(Length)) > (Active + FLASHKV_SECTOR_SIZE)) {
+		if ((res = TM_FLASHKV_Compact()) != TM_FLASHKV_Result_Ok) {
+			return res;
+		}
+		if ((Next + FLASHKV_SIZE(Length)) > (Active + FLASHKV_SECTOR_SIZE)) {
+			return TM_FLASHKV_Result_Full;
+		}
+		
+		/* Index was rebuilt */
+		if ((Entry = TM_FLASHKV_INT_Find(Key, 1)) == NULL) {
+			return TM_FLASHKV_Result_Full;
+		}
+	}
+	
+	/* Write record */
+	if ((res = TM_FLASHKV_INT_Append(Next, Key, Data, Length)) != TM_FLASHKV_Result_Ok) {
+		/* Skip damaged space */
+		Next += FLASHKV_SIZE(Length);
+		return res;
+	}
+	
+	/* Update index */
+	Entry->Key = Key;
+	Entry->Length = Length;
+	Entry->Address = Next;
+	Next += FLASHKV_SIZE(Length);
+	
+	/* Return OK */
+	return TM_FLASHKV_Result_Ok;
+}
+
+TM_FLASHKV_Result_t TM_FLASHKV_Read(uint16_t Key, void* Data, uint16_t Size, uint16_t* Length) {
+	const void* value;
+	uint16_t len;
+	
+	/* Find value */
+	if ((value = TM_FLASHKV_Get(Key, &len)) == NULL) {
+		return TM_FLASHKV_Result_NotFound;
+	}
+	
+	/* Save length */
+	if (Length != NULL) {
+		*Length = len;
+	}
+	
+	/* Check buffer */
+	if (len > Size) {
+		return TM_FLASHKV_Result_InvalidSize;
+	}
+	
+	/* Copy value */
+	memcpy(Data, value, len);
+	
+	/* Return OK */
+	return TM_FLASHKV_Result_Ok;
+}
+
+const void* TM_FLASHKV_Get(uint16_t Key, uint16_t* Length) {
+	TM_FLASHKV_Index_t* Entry;
+	
+	/* Find key */
+	Entry = TM_FLASHKV_INT_Find(Key, 0);
+	if (Entry == NULL || Entry->Length == 0) {
+		return NULL;
+	}
+	
+	/* Save length */
+	if (Length != NULL) {
+		*Length = Entry->Length;
+	}
+	
+	/* Return pointer to data in flash */
+	return (const void *)(Entry->Address + FLASHKV_RECORD_SIZE);
+}
+
+TM_FLASHKV_Result_t TM_FLASHKV_Delete(uint16_t Key) {
+	TM_FLASHKV_Index_t* Entry;
+	TM_FLASHKV_Result_t res;
+	
+	/* Find key */
+	Entry = TM_FLASHKV_INT_Find(Key, 0);
+	if (Entry == NULL || Entry->Length == 0) {
+		return TM_FLASHKV_Result_NotFound;
+	}
+	
+	/* Make space for empty record */
+	if ((Next + FLASHKV_RECORD_SIZE) > (Active + FLASHKV_SECTOR_SIZE)) {
+		/* Deleted key is not copied */
+		Entry->Length = 0;
+		return TM_FLASHKV_Compact();
+	}
+	
+	/* Write record with zero length */
+	if ((res = TM_FLASHKV_INT_Append(Next, Key, NULL, 0)) != TM_FLASHKV_Result_Ok) {
+		Next += FLASHKV_RECORD_SIZE;
+		return res;
+	}
+	
+	/* Key is deleted */
+	Entry->Length = 0;
+	Entry->Address = Next;
+	Next += FLASHKV_RECORD_SIZE;
+	
+	/* Return OK */
+	return TM_FLASHKV_Result_Ok;
+}
+
+TM_FLASHKV_Result_t TM_FLASHKV_Compact(void) {
+	uint32_t sector, address;
+	TM_FLASHKV_Result_t res;
+	uint16_t i;
+	
+	/* New sector */
+	sector = TM_FLASHKV_INT_Other(Active);
+	address = sector + FLASHKV_HEADER_SIZE;
+	
+	/* Copy last values */
+	for (i = 0; i < FLASHKV_INDEX_SIZE; i++) {
+		if (Index[i].Key != FLASHKV_KEY_EMPTY && Index[i].Length) {
+			res = TM_FLASHKV_INT_Append(address, Index[i].Key, (const void *)(Index[i].Address + FLASHKV_RECORD_SIZE), Index[i].Length);
+			if (res != TM_FLASHKV_Result_Ok) {
+				/* Old sector is still active, prepare new one again */
+				TM_FLASHKV_INT_Erase(sector);
+				return res;
+			}
+			
+			/* Value is in new sector now */
+			Index[i].Address = address;
+			address += FLASHKV_SIZE(Index[i].Length);
+		} else if (Index[i].Key != FLASHKV_KEY_EMPTY) {
+			/* Deleted key is not needed anymore */
+			Index[i].Key = FLASHKV_KEY_EMPTY;
+		}
+	}
+	
+	/* Write header, new sector is active only after this */
+	if ((res = TM_FLASHKV_INT_Format(sector, Sequence + 1)) != TM_FLASHKV_Result_Ok) {
+		return res;
+	}
+	
+	/* Erase old sector */
+	res = TM_FLASHKV_INT_Erase(Active);
+	
+	/* Switch to new sector */
+	Active = sector;
+	Sequence++;
+	
+	/* Rebuild index, hash chains changed when deleted keys were removed */
+	if ((Next = TM_FLASHKV_INT_Scan(Active)) == 0) {
+		return TM_FLASHKV_Result_Full;
+	}
+	
+	/* Return erase result */
+	return res;
+}
+
+uint32_t TM_FLASHKV_GetFree(void) {
+	return Active + FLASHKV_SECTOR_SIZE - Next;
+}
+
+/* Private functions */
+static TM_FLASHKV_Index_t* TM_FLASHKV_INT_Find(uint16_t Key, uint8_t add) {
+	uint16_t i, pos;
+	
+	/* Open addressing, start at hash of key */
+	pos = (Key * 0x9E37) >> 4;
+	for (i = 0; i < FLASHKV_INDEX_SIZE; i++, pos++) {
+		pos &= FLASHKV_INDEX_SIZE - 1;
+		
+		/* Key found */
+		if (Index[pos].Key == Key) {
+			return &Index[pos];
+		}
+		
+		/* Empty slot, key does not exist */
+		if (Index[pos].Key == FLASHKV_KEY_EMPTY) {
+			if (add) {
+				Index[pos].Key = Key;
+				Index[pos].Length = 0;
+				return &Index[pos];
+			}
+			return NULL;
+		}
+	}
+	
+	/* Index is full */
+	return NULL;
+}
+
+static uint32_t TM_FLASHKV_INT_Crc(uint32_t header, const void* Data, uint16_t Length) {
+	const uint8_t* ptr = (const uint8_t *)Data;
+	uint32_t word, crc;
+	
+	/* Header word */
+	crc = TM_CRC_Calculate32(&header, 1, 1);
+	
+	/* Data words, last one padded with 0xFF as in flash */
+	while (Length) {
+		word = FLASHKV_EMPTY;
+		memcpy(&word, ptr, Length > 4 ? 4 : Length);
+		crc = TM_CRC_Calculate32(&word, 1, 0);
+		ptr += 4;
+		Length = Length > 4 ? Length - 4 : 0;
+	}
+	
+	/* Return CRC */
+	return crc;
+}
+
+static uint8_t TM_FLASHKV_INT_Check(uint32_t address, uint32_t end) {
+	/* Check if memory is erased */
+	for (; address < end; address += 4) {
+		if (FLASHKV_WORD(address) != FLASHKV_EMPTY) {
+			return 0;
+		}
+	}
+	
+	/* Memory is erased */
+	return 1;
+}
+
+static uint32_t TM_FLASHKV_INT_Scan(uint32_t sector) {
+	TM_FLASHKV_Index_t* Entry;
+	uint32_t address, header;
+	uint16_t i, key, len;
+	
+	/* Clear index */
+	for (i = 0; i < FLASHKV_INDEX_SIZE; i++) {
+		Index[i].Key = FLASHKV_KEY_EMPTY;
+	}
+	
+	/* Go through records */
+	address = sector + FLASHKV_HEADER_SIZE;
+	while ((address + FLASHKV_RECORD_SIZE) <= (sector + FLASHKV_SECTOR_SIZE)) {
+		/* End of records */
+		header = FLASHKV_WORD(address);
+		if (header == FLASHKV_EMPTY) {
+			break;
+		}
+		key = header & 0xFFFF;
+		len = header >> 16;
+		
+		/* Damaged header, length is not known, records after it can not be found */
+		if (len > FLASHKV_MAX_LENGTH || (address + FLASHKV_SIZE(len)) > (sector + FLASHKV_SECTOR_SIZE)) {
+			address = sector + FLASHKV_SECTOR_SIZE;
+			break;
+		}
+		
+		/* Valid record, update index */
+		if (FLASHKV_WORD(address + 4) == TM_FLASHKV_INT_Crc(header, (const void *)(address + FLASHKV_RECORD_SIZE), len)) {
+			if ((Entry = TM_FLASHKV_INT_Find(key, 1)) == NULL) {
+				return 0;
+			}
+			Entry->Length = len;
+			Entry->Address = address;
+		}
+		
+		/* Next record */
+		address += FLASHKV_SIZE(len);
+	}
+	
+	/* Return address for next record */
+	return address;
+}
+
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Append(uint32_t address, uint16_t Key, const void* Data, uint16_t Length) {
+	const uint8_t* ptr = (const uint8_t *)Data;
+	uint32_t header, crc, word, addr;
+	uint16_t len = Length;
+	
+	/* Header and CRC */
+	header = ((uint32_t)Length << 16) | Key;
+	crc = TM_FLASHKV_INT_Crc(header, Data, Length);
+	
+	/* Header first, length is known after power loss */
+	if (TM_FLASHKV_INT_Program(address, header) != TM_FLASHKV_Result_Ok) {
+		return TM_FLASHKV_Result_Error;
+	}
+	
+	/* Data */
+	for (addr = address + FLASHKV_RECORD_SIZE; len; addr += 4) {
+		word = FLASHKV_EMPTY;
+		memcpy(&word, ptr, len > 4 ? 4 : len);
+		if (TM_FLASHKV_INT_Program(addr, word) != TM_FLASHKV_Result_Ok) {
+			return TM_FLASHKV_Result_Error;
+		}
+		ptr += 4;
+		len = len > 4 ? len - 4 : 0;
+	}
+	
+	/* CRC last, record is valid only when everything is written */
+	if (TM_FLASHKV_INT_Program(address + 4, crc) != TM_FLASHKV_Result_Ok) {
+		return TM_FLASHKV_Result_Error;
+	}
+	
+	/* Verify */
+	if (FLASHKV_WORD(address + 4) != TM_FLASHKV_INT_Crc(header, (const void *)(address + FLASHKV_RECORD_SIZE), Length)) {
+		return TM_FLASHKV_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_FLASHKV_Result_Ok;
+}
+
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Program(uint32_t address, uint32_t data) {
+	HAL_StatusTypeDef status;
+	
+	/* Program word */
+	HAL_FLASH_Unlock();
+	status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, data);
+	HAL_FLASH_Lock();
+	
+#if defined(STM32F7xx)
+	/* Flash content has changed */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)(address & ~0x1F), 32);
+#endif
+	
+	/* Return status */
+	return status == HAL_OK ? TM_FLASHKV_Result_Ok : TM_FLASHKV_Result_Error;
+}
+
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Erase(uint32_t sector) {
+	FLASH_EraseInitTypeDef Erase;
+	HAL_StatusTypeDef status;
+	uint32_t error;
+	
+	/* Erase sector */
+	Erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	Erase.Sector = sector == FLASHKV_ADDRESS_A ? FLASHKV_SECTOR_A : FLASHKV_SECTOR_B;
+	Erase.NbSectors = 1;
+	Erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+	
+	HAL_FLASH_Unlock();
+	status = HAL_FLASHEx_Erase(&Erase, &error);
+	HAL_FLASH_Lock();
+	
+#if defined(STM32F7xx)
+	/* Flash content has changed */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)sector, FLASHKV_SECTOR_SIZE);
+#endif
+	
+	/* Return status */
+	return status == HAL_OK ? TM_FLASHKV_Result_Ok : TM_FLASHKV_Result_Error;
+}
+
+static TM_FLASHKV_Result_t TM_FLASHKV_INT_Format(uint32_t sector, uint32_t sequence) {
+	/* Erase when not done yet, sector has records when called from compaction */
+	if (FLASHKV_WORD(sector) != FLASHKV_EMPTY || FLASHKV_WORD(sector + 4) != FLASHKV_EMPTY) {
+		if (TM_FLASHKV_INT_Erase(sector) != TM_FLASHKV_Result_Ok) {
+			return TM_FLASHKV_Result_Error;
+		}
+	}
+	
+	/* Sequence first, magic last */
+	if (TM_FLASHKV_INT_Program(sector + 4, sequence) != TM_FLASHKV_Result_Ok) {
+		return TM_FLASHKV_Result_Error;
+	}
+	return TM_FLASHKV_INT_Program(sector, FLASHKV_MAGIC);
+}
+
+static uint32_t TM_FLASHKV_INT_Other(uint32_t sector) {
+	return sector == FLASHKV_ADDRESS_A ? FLASHKV_ADDRESS_B : FLASHKV_ADDRESS_A;
+}
@@ -0,0 +1,291 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Key-value store with wear levelling in internal flash for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_FLASHKV_H
+#define TM_FLASHKV_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_FLASHKV
+ * @brief    Key-value store with wear levelling in internal flash for STM32Fxxx
+ * @{
+ *
+ * Library stores settings and calibration data as key-value records in two internal flash sectors.
+ *
+ * \par How it works
+ *
+ * Records are only appended to active sector, new value of key is new record and old one stays in flash until compaction.
+ * Each record has 16-bit key, length, CRC and data, padded to 4 bytes. CRC is calculated with @ref TM_CRC_Calculate32.
+ *
+ * On @ref TM_FLASHKV_Init, active sector is scanned once and RAM hash index with address of last record for each key is built.
+ * Reading is then O(1) lookup in index, @ref TM_FLASHKV_Get returns pointer to data directly in flash.
+ *
+ * When active sector is full, last values of all keys are copied to second sector, which becomes active, and old sector is erased.
+ * Sectors are used alternately, so both wear equally. Sector header with sequence number is written last,
+ * so power loss during write or compaction never loses data, records with invalid CRC are ignored.
+ *
+ * Writing the same value as already stored does not use flash.
+ *
+\code
+typedef struct {
+	float Offset;
+	float Gain;
+} Calibration_t;
+
+#define KEY_CALIBRATION    1
+#define KEY_DEVICE_NAME    2
+
+Calibration_t cal;
+const Calibration_t* pcal;
+
+TM_FLASHKV_Init();
+
+//Write value
+TM_FLASHKV_Write(KEY_CALIBRATION, &cal, sizeof(cal));
+
+//Read directly from flash
+pcal = TM_FLASHKV_Get(KEY_CALIBRATION, NULL);
+
+//Or copy to RAM
+TM_FLASHKV_Read(KEY_CALIBRATION, &cal, sizeof(cal), NULL);
+\endcode
+ *
+ * @note  Reserve both sectors in linker script or scatter file, so they are not used for code
+ * @note  CPU is stalled during flash erase and write when code is executed from the same flash bank.
+ *        Compaction erases one sector, which takes up to few hundred milliseconds for 16kB sector
+ * @note  Functions are not reentrant, use them from one context only
+ * @note  Library is available on STM32F4xx and STM32F7xx devices
+ *
+ * To change settings, open defines.h file and add lines:
+ *
+\code
+//Flash sectors, their addresses and size. Defaults are 16kB sectors 2 and 3 on STM32F4xx and 32kB sectors 1 and 2 on STM32F7xx
+#define FLASHKV_SECTOR_A         FLASH_SECTOR_2
+#define FLASHKV_ADDRESS_A        0x08008000
+#define FLASHKV_SECTOR_B         FLASH_SECTOR_3
+#define FLASHKV_ADDRESS_B        0x0800C000
+#define FLASHKV_SECTOR_SIZE      0x4000
+
+//Size of RAM index, power of 2, must be bigger than number of keys
+#define FLASHKV_INDEX_SIZE       64
+
+//Maximal value length in bytes
+#define FLASHKV_MAX_LENGTH       256
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM CRC
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_crc.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_FLASHKV_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Check device */
+#if defined(STM32F0xx)
+#error "TM FLASHKV is not available on STM32F0xx devices"
+#endif
+
+/* Flash sectors */
+#ifndef FLASHKV_SECTOR_A
+#if defined(STM32F7xx)
+#define FLASHKV_SECTOR_A         FLASH_SECTOR_1
+#define FLASHKV_ADDRESS_A        0x08008000
+#define FLASHKV_SECTOR_B         FLASH_SECTOR_2
+#define FLASHKV_ADDRESS_B        0x08010000
+#define FLASHKV_SECTOR_SIZE      0x8000
+#else
+#define FLASHKV_SECTOR_A         FLASH_SECTOR_2
+#define FLASHKV_ADDRESS_A        0x08008000
+#define FLASHKV_SECTOR_B         FLASH_SECTOR_3
+#define FLASHKV_ADDRESS_B        0x0800C000
+#define FLASHKV_SECTOR_SIZE      0x4000
+#endif
+#endif
+
+/* Size of RAM index */
+#ifndef FLASHKV_INDEX_SIZE
+#define FLASHKV_INDEX_SIZE       64
+#endif
+
+/* Maximal value length */
+#ifndef FLASHKV_MAX_LENGTH
+#define FLASHKV_MAX_LENGTH       256
+#endif
+
+/* Check values */
+#if (FLASHKV_INDEX_SIZE & (FLASHKV_INDEX_SIZE - 1)) || FLASHKV_INDEX_SIZE == 0
+#error "FLASHKV_INDEX_SIZE must be power of 2"
+#endif
+#if FLASHKV_MAX_LENGTH > 0xFFF0
+#error "FLASHKV_MAX_LENGTH is too big"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_FLASHKV_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_FLASHKV_Result_Ok = 0x00,   /*!< Everything OK */
+	TM_FLASHKV_Result_Error,       /*!< Flash error */
+	TM_FLASHKV_Result_NotFound,    /*!< Key does not exist */
+	TM_FLASHKV_Result_Full,        /*!< No space for value or index is full */
+	TM_FLASHKV_Result_InvalidSize  /*!< Value is too long or buffer is too small */
+} TM_FLASHKV_Result_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_FLASHKV_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes store, finds active sector and builds RAM index
+ * @note   Sectors are formatted on first use
+ * @param  None
+ * @retval Member of @ref TM_FLASHKV_Result_t enumeration
+ */
+TM_FLASHKV_Result_t TM_FLASHKV_Init(void);
+
+/**
+ * @brief  Writes value of key
+ * @param  Key: Key, from 0x0000 to 0xFFFE
+ * @param  *Data: Pointer to value
+ * @param  Length: Value length in bytes, from 1 to FLASHKV_MAX_LENGTH
+ * @retval Member of @ref TM_FLASHKV_Result_t enumeration
+ */
+TM_FLASHKV_Result_t TM_FLASHKV_Write(uint16_t Key, const void* Data, uint16_t Length);
+
+/**
+ * @brief  Reads value of key to RAM
+ * @param  Key: Key to read
+ * @param  *Data: Pointer to buffer for value
+ * @param  Size: Buffer size in bytes
+ * @param  *Length: Pointer to save value length to. Set to NULL if not used
+ * @retval Member of @ref TM_FLASHKV_Result_t enumeration
+ */
+TM_FLASHKV_Result_t TM_FLASHKV_Read(uint16_t Key, void* Data, uint16_t Size, uint16_t* Length);
+
+/**
+ * @brief  Gets pointer to value of key in flash
+ * @note   Pointer is valid until next write or compaction
+ * @param  Key: Key to read
+ * @param  *Length: Pointer to save value length to. Set to NULL if not used
+ * @retval Pointer to value, aligned to 4 bytes, or NULL if key does not exist
+ */
+const void* TM_FLASHKV_Get(uint16_t Key, uint16_t* Length);
+
+/**
+ * @brief  Deletes key
+ * @param  Key: Key to delete
+ * @retval Member of @ref TM_FLASHKV_Result_t enumeration
+ */
+TM_FLASHKV_Result_t TM_FLASHKV_Delete(uint16_t Key);
+
+/**
+ * @brief  Copies last values to second sector and erases active sector
+ * @note   Called automatically when active sector is full
+ * @param  None
+ * @retval Member of @ref TM_FLASHKV_Result_t enumeration
+ */
+TM_FLASHKV_Result_t TM_FLASHKV_Compact(void);
+
+/**
+ * @brief  Gets free space in active sector
+ * @param  None
+ * @retval Free space in bytes
+ */
+uint32_t TM_FLASHKV_GetFree(void);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
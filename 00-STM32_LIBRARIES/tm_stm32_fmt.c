@@ -0,0 +1,382 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_fmt.h"
+
+/* Digit pairs 00 to 99 */
+static const char FMT_Digits[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* Hexadecimal digits */
+static const char FMT_Hex[] = "0123456789ABCDEF";
+
+/* Powers of 10 */
+static const uint32_t FMT_Pow10[10] = {
+	1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/* Private functions */
+static uint8_t TM_FMT_INT_Digits(uint32_t value);
+static void TM_FMT_INT_Write(char* end, uint32_t value, uint8_t width);
+
+uint8_t TM_FMT_U32(char* str, uint32_t value) {
+	uint8_t len = TM_FMT_INT_Digits(value);
+	
+	/* Write from last digit */
+	str[len] = 0;
+	TM_FMT_INT_Write(&str[len], value, 0);
+	
+	/* Return length */
+	return len;
+}
+
+uint8_t TM_FMT_I32(char* str, int32_t value) {
+	/* Add sign */
+	if (value < 0) {
+		*str = '-';
+		return TM_FMT_U32(str + 1, 0UL - (uint32_t)value) + 1;
+	}
+	return TM_FMT_U32(str, value);
+}
+
+uint8_t TM_FMT_U64(char* str, uint64_t value) {
+	uint32_t high, mid, low;
+	uint8_t len;
+	
+	/* Fast path */
+	if ((value >> 32) == 0) {
+		return TM_FMT_U32(str, (uint32_t)value);
+	}
+	
+	/* Split to parts of 9 digits, max 20 digits in total */
+	low = (uint32_t)(value % 1000000000UL);
+	value /= 1000000000UL;
+	mid = (uint32_t)(value % 1000000000UL);
+	high = (uint32_t)(value / 1000000000UL);
+	
+	/* Highest part without leading zeros */
+	if (high) {
+		len = TM_FMT_U32(str, high);
+		TM_FMT_INT_Write(&str[len + 9], mid, 9);
+		len += 9;
+	} else {
+		len = TM_FMT_U32(str, mid);
+	}
+	
+	/* Lowest part with leading zeros */
+	TM_FMT_INT_Write(&str[len + 9], low, 9);
+	len += 9;
+	str[len] = 0;
+	
+	/* Return length */
+	return len;
+}
+
+uint8_t TM_FMT_I64(char* str, int64_t value) {
+	/* Add sign */
+	if (value < 0) {
+		*str = '-';
+		return TM_FMT_U64(str + 1, 0ULL - (uint64_t)value) + 1;
+	}
+	return TM_FMT_U64(str, value);
+}
+
+uint8_t TM_FMT_Fixed(char* str, int32_t value, uint8_t decimals) {
+	uint32_t abs, integer;
+	uint8_t len = 0;
+	
+	/* Check decimals */
+	if (decimals > 9) {
+		decimals = 9;
+	}
+	
+	/* Add sign */
+	abs = value < 0 ? 0UL - (uint32_t)value : (uint32_t)value;
+	if (value < 0) {
+		str[len++] = '-';
+	}
+	
+	/* Integer part */
+	integer = abs / FMT_Pow10[decimals];
+	len += TM_FMT_U32(&str[len], integer);
+	
+	/* Decimal part with leading zeros */
+	if (decimals) {
+		str[len++] = '.';
+		len += decimals;
+		str[len] = 0;
+		TM_FMT_INT_Write(&str[len], abs - integer * FMT_Pow10[decimals], decimals);
+	}
+	
+	/* Return length */
+	return len;
+}
+
+uint8_t TM_FMT_Float(char* str, float value, uint8_t decimals) {
+	uint32_t integer, decimal;
+	uint8_t len = 0;
+	
+	/* Check decimals */
+	if (decimals > 9) {
+		decimals = 9;
+	}
+	
+	/* Not a number */
+	if (value != value) {
+		return TM_FMT_String(str, "nan");
+	}
+	
+	/* Add sign */
+	if (value < 0) {
+		str[len++] = '-';
+		value = -value;
+	}
+	
+	/* Integer part must fit to 32-bit */
+	if (value >= 4294967296.0f) {
+		return len + TM_FMT_String(&str[len], "ovf");
+	}
+	
+	/* Split and round decimal part */
+	integer = (uint32_t)value;
+	decimal = (uint32_t)((value - (float)integer) * (float)FMT_Pow10[decimals] + 0.5f);
+	if (decimal >= FMT_Pow10[decimals]) {
+		decimal -= FMT_Pow10[decimals];
+		integer++;
+	}
+	
+	/* Write parts */
+	len += TM_FMT_U32(&str[len], integer);
+	if (decimals) {
+		str[len++] = '.';
+		len += decimals;
+		str[len] = 0;
+		TM_FMT_INT_Write(&str[len], decimal, decimals);
+	}
+	
+	/* Return length */
+	return len;
+}
+
+uint8_t TM_FMT_Hex(char* str, uint32_t value, uint8_t digits) {
+	uint8_t len, i;
+	
+	/* Get number of digits from highest set bit */
+#if __CORTEX_M >= 0x03
+	len = (35 - __CLZ(value | 1)) >> 2;
+#else
+	for (len = 1; len < 8 && (value >> (len * 4)); len++);
+#endif
+	if (digits > 8) {
+		digits = 8;
+	}
+	if (len < digits) {
+		len = digits;
+	}
+	
+	/* Write from last digit */
+	str[len] = 0;
+	for (i = len; i > 0; i--) {
+		str[i - 1] = FMT_Hex[value & 0x0F];
+		value >>= 4;
+	}
+	
+	/* Return length */
+	return len;
+}
+
+uint32_t TM_FMT_HexDump(char* str, const void* data, uint32_t count, char separator) {
+	const uint8_t* ptr = (const uint8_t *)data;
+	char* start = str;
+	
+	/* Check count */
+	if (count == 0) {
+		*str = 0;
+		return 0;
+	}
+	
+	/* Write bytes */
+	while (count--) {
+		*str++ = FMT_Hex[*ptr >> 4];
+		*str++ = FMT_Hex[*ptr++ & 0x0F];
+		if (separator && count) {
+			*str++ = separator;
+		}
+	}
+	*str = 0;
+	
+	/* Return length */
+	return str - start;
+}
+
+uint8_t TM_FMT_Pad(char* str, uint8_t len, uint8_t width, char c) {
+	/* Check length */
+	if (len >= width) {
+		return len;
+	}
+	
+	/* Move string with terminating zero to the right and fill */
+	memmove(&str[width - len], str, len + 1);
+	memset(str, c, width - len);
+	
+	/* Return new length */
+	return width;
+}
+
+uint32_t TM_FMT_String(char* str, const char* src) {
+	const char* start = src;
+	
+	/* Copy with terminating zero */
+	while ((*str++ = *src++));
+	
+	/* Return length */
+	return src - start - 1;
+}
+
+/* Formats to free memory in buffer if there is enough space, otherwise to stack */
+#define FMT_BUFFER(Buffer, call)                                                  \
+	char tmp[TM_FMT_MAX_LENGTH];                                                  \
+	char* str = tmp;                                                              \
+	uint8_t* span;                                                                \
+	uint8_t len;                                                                  \
+	if (TM_BUFFER_GetWriteSpan((Buffer), &span) >= TM_FMT_MAX_LENGTH) {           \
+		str = (char *)span;                                                       \
+	}                                                                             \
+	len = (call);                                                                 \
+	if (str != tmp) {                                                             \
+		return TM_BUFFER_CommitWrite((Buffer), len);                              \
+	}                                                                             \
+	return TM_BUFFER_Write((Buffer), (uint8_t *)tmp, len)
+
+uint32_t TM_FMT_BufferU32(TM_BUFFER_t* Buffer, uint32_t value) {
+	FMT_BUFFER(Buffer, TM_FMT_U32(str, value));
+}
+
+uint32_t TM_FMT_BufferI32(TM_BUFFER_t* Buffer, int32_t value) {
+	FMT_BUFFER(Buffer, TM_FMT_I32(str, value));
+}
+
+uint32_t TM_FMT_BufferFixed(TM_BUFFER_t* Buffer, int32_t value, uint8_t decimals) {
+	FMT_BUFFER(Buffer, TM_FMT_Fixed(str, value, decimals));
+}
+
+uint32_t TM_FMT_BufferFloat(TM_BUFFER_t* Buffer, float value, uint8_t decimals) {
+	FMT_BUFFER(Buffer, TM_FMT_Float(str, value, decimals));
+}
+
+uint32_t TM_FMT_BufferHex(TM_BUFFER_t* Buffer, uint32_t value, uint8_t digits) {
+	FMT_BUFFER(Buffer, TM_FMT_Hex(str, value, digits));
+}
+
+uint32_t TM_FMT_BufferHexDump(TM_BUFFER_t* Buffer, const void* data, uint32_t count, char separator) {
+	const uint8_t* ptr = (const uint8_t *)data;
+	uint32_t written = 0, n, i;
+	uint8_t* span;
+	char tmp[3];
+	
+	/* Write bytes */
+	for (i = 0; i < count; i++) {
+		/* Byte with separator */
+		tmp[0] = FMT_Hex[ptr[i] >> 4];
+		tmp[1] = FMT_Hex[ptr[i] & 0x0F];
+		tmp[2] = separator;
+		n = (separator && i < (count - 1)) ? 3 : 2;
+		
+		/* Write directly to buffer memory if possible */
+		if (TM_BUFFER_GetWriteSpan(Buffer, &span) >= n) {
+			memcpy(span, tmp, n);
+			n = TM_BUFFER_CommitWrite(Buffer, n);
+		} else {
+			n = TM_BUFFER_Write(Buffer, (uint8_t *)tmp, n);
+		}
+		
+		/* Stop when buffer is full */
+		if (n == 0) {
+			break;
+		}
+		written += n;
+	}
+	
+	/* Return number of written characters */
+	return written;
+}
+
+/* Private functions */
+static uint8_t TM_FMT_INT_Digits(uint32_t value) {
+#if __CORTEX_M >= 0x03
+	uint32_t t;
+	
+	/* Zero has 1 digit, setting bit 0 does not change digits count of other numbers */
+	value |= 1;
+	
+	/* Approximate log10 from highest set bit, 1233 / 4096 = log10(2) */
+	t = ((32 - __CLZ(value)) * 1233) >> 12;
+	return t + 1 - (value < FMT_Pow10[t]);
+#else
+	uint8_t len = 1;
+	
+	/* No CLZ instruction on Cortex-M0 */
+	while (len < 10 && value >= FMT_Pow10[len]) {
+		len++;
+	}
+	return len;
+#endif
+}
+
+static void TM_FMT_INT_Write(char* end, uint32_t value, uint8_t width) {
+	char* start = end - width;
+	uint32_t i;
+	
+	/* Write 2 digits at a time, backwards from end */
+	while (value >= 100) {
+		i = (value % 100) * 2;
+		value /= 100;
+		*--end = FMT_Digits[i + 1];
+		*--end = FMT_Digits[i];
+	}
+	
+	/* Last 1 or 2 digits */
+	if (value >= 10) {
+		i = value * 2;
+		*--end = FMT_Digits[i + 1];
+		*--end = FMT_Digits[i];
+	} else {
+		*--end = '0' + value;
+	}
+	
+	/* Leading zeros up to width */
+	while (end > start) {
+		*--end = '0';
+	}
+}
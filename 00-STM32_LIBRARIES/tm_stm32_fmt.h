@@ -0,0 +1,298 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Fast number to string formatting for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_FMT_H
+#define TM_FMT_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_FMT
+ * @brief    Fast number to string formatting for STM32Fxxx
+ * @{
+ *
+ * Library converts numbers to strings without sprintf. It is much smaller than printf family from C library,
+ * uses few bytes of stack and needs only one division per 2 digits.
+ *
+ * - Number of digits is known before conversion, so digits are written directly to destination
+ * - Two digits are converted at once with lookup table
+ * - Floats are printed as fixed point numbers with 0 to 9 decimals, without double precision math
+ * - Fixed point integers (for example millivolts as volts) are printed without any float operation
+ *
+ * All functions write terminating zero and return string length, so they can be chained:
+ *
+\code
+char str[64], *ptr = str;
+
+ptr += TM_FMT_String(ptr, "T=");
+ptr += TM_FMT_Float(ptr, temperature, 2);
+ptr += TM_FMT_String(ptr, " V=");
+ptr += TM_FMT_Fixed(ptr, millivolts, 3);
+TM_USART_Puts(USART1, str);
+\endcode
+ *
+ * \par Output to buffer
+ *
+ * TM_FMT_BufferXXX functions format number directly to free memory of @ref TM_BUFFER_t.
+ * When contiguous free memory is too small, number is formatted to stack first and then copied to buffer.
+ *
+\code
+TM_FMT_BufferU32(&Buffer, counter);
+TM_FMT_BufferHexDump(&Buffer, data, 16, ' ');
+\endcode
+ *
+ * \par Output to LCD
+ *
+ * LCD and HD44780 libraries print strings, use local array of @ref TM_FMT_MAX_LENGTH bytes:
+ *
+\code
+char str[TM_FMT_MAX_LENGTH];
+
+TM_FMT_Float(str, voltage, 3);
+TM_LCD_Puts(str);
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_buffer.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_FMT_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Max length of one formatted number including terminating zero, 64-bit signed number with sign
+ */
+#define TM_FMT_MAX_LENGTH    24
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_FMT_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Formats unsigned 32-bit number
+ * @param  *str: Pointer to output string, at least 11 bytes
+ * @param  value: Number to format
+ * @retval String length
+ */
+uint8_t TM_FMT_U32(char* str, uint32_t value);
+
+/**
+ * @brief  Formats signed 32-bit number
+ * @param  *str: Pointer to output string, at least 12 bytes
+ * @param  value: Number to format
+ * @retval String length
+ */
+uint8_t TM_FMT_I32(char* str, int32_t value);
+
+/**
+ * @brief  Formats unsigned 64-bit number
+ * @param  *str: Pointer to output string, at least 21 bytes
+ * @param  value: Number to format
+ * @retval String length
+ */
+uint8_t TM_FMT_U64(char* str, uint64_t value);
+
+/**
+ * @brief  Formats signed 64-bit number
+ * @param  *str: Pointer to output string, at least 21 bytes
+ * @param  value: Number to format
+ * @retval String length
+ */
+uint8_t TM_FMT_I64(char* str, int64_t value);
+
+/**
+ * @brief  Formats fixed point number, for example 12345 with 3 decimals is formatted as 12.345
+ * @param  *str: Pointer to output string, at least 13 bytes
+ * @param  value: Number in units of 10^-decimals
+ * @param  decimals: Number of decimals, 0 to 9
+ * @retval String length
+ */
+uint8_t TM_FMT_Fixed(char* str, int32_t value, uint8_t decimals);
+
+/**
+ * @brief  Formats float number rounded to desired number of decimals
+ * @note   Numbers with absolute integer part above 4294967295 are formatted as "ovf"
+ * @param  *str: Pointer to output string, at least 22 bytes
+ * @param  value: Number to format
+ * @param  decimals: Number of decimals, 0 to 9
+ * @retval String length
+ */
+uint8_t TM_FMT_Float(char* str, float value, uint8_t decimals);
+
+/**
+ * @brief  Formats number as hexadecimal with upper case letters
+ * @param  *str: Pointer to output string, at least 9 bytes
+ * @param  value: Number to format
+ * @param  digits: Min number of digits, leading zeros are added. Set to 0 for no leading zeros
+ * @retval String length
+ */
+uint8_t TM_FMT_Hex(char* str, uint32_t value, uint8_t digits);
+
+/**
+ * @brief  Formats bytes as hexadecimal dump, for example 01 AB FF
+ * @param  *str: Pointer to output string, at least count * 3 bytes
+ * @param  *data: Pointer to data
+ * @param  count: Number of bytes
+ * @param  separator: Character between bytes, set to 0 for none
+ * @retval String length
+ */
+uint32_t TM_FMT_HexDump(char* str, const void* data, uint32_t count, char separator);
+
+/**
+ * @brief  Aligns formatted string to the right
+ * @param  *str: Pointer to formatted string, at least width + 1 bytes
+ * @param  len: Current string length
+ * @param  width: Min string length
+ * @param  c: Character to fill on the left, usually space or zero
+ * @retval New string length
+ */
+uint8_t TM_FMT_Pad(char* str, uint8_t len, uint8_t width, char c);
+
+/**
+ * @brief  Copies string and returns its length, for chaining with other functions
+ * @param  *str: Pointer to output string
+ * @param  *src: Pointer to string to copy
+ * @retval String length
+ */
+uint32_t TM_FMT_String(char* str, const char* src);
+
+/**
+ * @brief  Formats unsigned 32-bit number to buffer
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  value: Number to format
+ * @retval Number of characters written to buffer
+ */
+uint32_t TM_FMT_BufferU32(TM_BUFFER_t* Buffer, uint32_t value);
+
+/**
+ * @brief  Formats signed 32-bit number to buffer
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  value: Number to format
+ * @retval Number of characters written to buffer
+ */
+uint32_t TM_FMT_BufferI32(TM_BUFFER_t* Buffer, int32_t value);
+
+/**
+ * @brief  Formats fixed point number to buffer
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  value: Number in units of 10^-decimals
+ * @param  decimals: Number of decimals, 0 to 9
+ * @retval Number of characters written to buffer
+ */
+uint32_t TM_FMT_BufferFixed(TM_BUFFER_t* Buffer, int32_t value, uint8_t decimals);
+
+/**
+ * @brief  Formats float number to buffer
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  value: Number to format
+ * @param  decimals: Number of decimals, 0 to 9
+ * @retval Number of characters written to buffer
+ */
+uint32_t TM_FMT_BufferFloat(TM_BUFFER_t* Buffer, float value, uint8_t decimals);
+
+/**
+ * @brief  Formats hexadecimal number to buffer
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  value: Number to format
+ * @param  digits: Min number of digits
+ * @retval Number of characters written to buffer
+ */
+uint32_t TM_FMT_BufferHex(TM_BUFFER_t* Buffer, uint32_t value, uint8_t digits);
+
+/**
+ * @brief  Formats bytes as hexadecimal dump to buffer
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure
+ * @param  *data: Pointer to data
+ * @param  count: Number of bytes
+ * @param  separator: Character between bytes, set to 0 for none
+ * @retval Number of characters written to buffer
+ */
+uint32_t TM_FMT_BufferHexDump(TM_BUFFER_t* Buffer, const void* data, uint32_t count, char separator);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,6 +18,7 @@
  */
 #include "tm_stm32_fonts.h"
 
+#if FONT_USE_7x10
 const uint16_t TM_Font7x10 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // sp
 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x0000, 0x1000, 0x0000, 0x0000,  // !
@@ -116,6 +117,15 @@ const uint16_t TM_Font7x10 [] = {
 0x0000, 0x0000, 0x0000, 0x7400, 0x4C00, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // ~
 };
 
+TM_FONT_t TM_Font_7x10 = {
+	7,
+	10,
+	TM_Font7x10,
+	NULL
+};
+#endif
+
+#if FONT_USE_11x18
 const uint16_t TM_Font11x18 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // sp
 0x0000, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0C00, 0x0000, 0x0C00, 0x0C00, 0x0000, 0x0000, 0x0000,   // !
@@ -214,6 +224,15 @@ const uint16_t TM_Font11x18 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3880, 0x7F80, 0x4700, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // ~
 };
 
+TM_FONT_t TM_Font_11x18 = {
+	11,
+	18,
+	TM_Font11x18,
+	NULL
+};
+#endif
+
+#if FONT_USE_16x26
 const uint16_t TM_Font16x26 [] = {
 0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = [ ]
 0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03E0,0x03C0,0x03C0,0x01C0,0x01C0,0x01C0,0x01C0,0x01C0,0x0000,0x0000,0x0000,0x03E0,0x03E0,0x03E0,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = [!]
@@ -312,30 +331,77 @@ const uint16_t TM_Font16x26 [] = {
 0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x3F07,0x7FC7,0x73E7,0xF1FF,0xF07E,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = [~]
 };
 
-
-TM_FONT_t TM_Font_7x10 = {
-	7,
-	10,
-	TM_Font7x10
-};
-
-TM_FONT_t TM_Font_11x18 = {
-	11,
-	18,
-	TM_Font11x18
-};
-
 TM_FONT_t TM_Font_16x26 = {
 	16,
 	26,
-	TM_Font16x26
+	TM_Font16x26,
+	NULL
 };
+#endif
 
 char* TM_FONT_GetStringSize(char* str, TM_FONT_SIZE_t* SizeStruct, TM_FONT_t* Font) {
+	char* ptr = str;
+	
 	/* Fill settings */
 	SizeStruct->Height = Font->FontHeight;
-	SizeStruct->Width = Font->FontWidth * strlen(str);
+	
+	/* Built-in fonts are monospaced */
+	if (Font->Packed == NULL) {
+		SizeStruct->Width = Font->FontWidth * strlen(str);
+		return str;
+	}
+	
+	/* Sum widths from table */
+	SizeStruct->Width = 0;
+	while (*ptr) {
+		SizeStruct->Width += TM_FONT_GetCharWidth(Font, *ptr++);
+	}
 	
 	/* Return pointer */
 	return str;
 }
+
+uint8_t TM_FONT_GetGlyph(TM_FONT_t* Font, char c, TM_FONT_GLYPH_t* Glyph) {
+	const TM_FONT_PACKED_t* Packed = Font->Packed;
+	uint8_t index;
+	
+	/* Built-in font from space to ~ */
+	if (Packed == NULL) {
+		Glyph->Width = Font->FontWidth;
+		Glyph->Packed = 0;
+		if ((uint8_t)c < 32 || (uint8_t)c > 126) {
+			Glyph->Data = NULL;
+			return 0;
+		}
+		Glyph->Data = &Font->data[((uint8_t)c - 32) * Font->FontHeight];
+		return 1;
+	}
+	
+	/* Find glyph in map */
+	Glyph->Packed = 1;
+	index = ((uint8_t)c - Packed->First) < Packed->Count ? Packed->Map[(uint8_t)c - Packed->First] : 0xFF;
+	if (index == 0xFF) {
+		Glyph->Width = Font->FontWidth;
+		Glyph->Data = NULL;
+		return 0;
+	}
+	
+	/* Fill glyph */
+	Glyph->Width = Packed->Widths[index];
+	Glyph->Data = &Packed->Bits[Packed->Offsets[index]];
+	return 1;
+}
+
+uint8_t TM_FONT_GetCharWidth(TM_FONT_t* Font, char c) {
+	const TM_FONT_PACKED_t* Packed = Font->Packed;
+	uint8_t index;
+	
+	/* Built-in fonts are monospaced */
+	if (Packed == NULL) {
+		return Font->FontWidth;
+	}
+	
+	/* Get width from table */
+	index = ((uint8_t)c - Packed->First) < Packed->Count ? Packed->Map[(uint8_t)c - Packed->First] : 0xFF;
+	return index == 0xFF ? Font->FontWidth : Packed->Widths[index];
+}
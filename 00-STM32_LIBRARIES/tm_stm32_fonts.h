@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   Fonts library for LCD libraries
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_FONTS_H
-#define TM_FONTS_H 100
+#define TM_FONTS_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -61,11 +61,40 @@ extern "C" {
  *  - 11 x 18 pixels
  *  - 16 x 26 pixels
  *
+ * Each font can be removed from flash when it is not used, for example with <code>#define FONT_USE_16x26 0</code> in defines.h.
+ * LCD library uses 11 x 18 font by default.
+ *
+ * \par Packed fonts
+ *
+ * Built-in fonts use 16-bit word for each row of each of 95 characters.
+ * Packed fonts keep only glyphs which are used, each glyph in one bit per pixel without padding in rows,
+ * and can be proportional, with own width for each glyph.
+ *
+ * Packed font is generated with <code>tm_stm32_fonts_pack.py</code> script from built-in font,
+ * for characters given in command line or found in string literals of project source files:
+ *
+\verbatim
+python tm_stm32_fonts_pack.py --font 11x18 --name Menu --proportional --scan User/main.c User/menu.c > User/font_menu.c
+\endverbatim
+ *
+ * Generated file defines <code>TM_FONT_t TM_Font_Menu</code> which is used the same way as built-in fonts.
+ * Glyph for character is found with one table lookup and glyph widths are stored in table.
+ * Characters which are not in font are drawn as empty.
+ *
+ * Libraries draw characters with @ref TM_FONT_GetGlyph and @ref TM_FONT_GetRow, which work for both formats.
+ * LCD library draws packed proportional font in fixed cells of max glyph width, SSD1306 library draws it proportionally.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added packed 1 bit per pixel proportional fonts with generator script
+  - Added FONT_USE_7x10, FONT_USE_11x18 and FONT_USE_16x26 settings to remove unused fonts
+  - Added glyph functions for drawing both font formats
 \endverbatim
  *
  * \par Dependencies
@@ -80,21 +109,64 @@ extern "C" {
 #include "defines.h"
 #include "string.h"
 
+/**
+ * @defgroup TM_FONTS_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Built-in fonts included in flash */
+#ifndef FONT_USE_7x10
+#define FONT_USE_7x10     1
+#endif
+#ifndef FONT_USE_11x18
+#define FONT_USE_11x18    1
+#endif
+#ifndef FONT_USE_16x26
+#define FONT_USE_16x26    1
+#endif
+
+/**
+ * @}
+ */
+
 /**
  * @defgroup TM_FONTS_Typedefs
  * @brief    Library Typedefs
  * @{
  */
 
+/**
+ * @brief  Packed font data, generated with tm_stm32_fonts_pack.py script
+ */
+typedef struct {
+	uint8_t First;            /*!< First character in map */
+	uint8_t Count;            /*!< Number of characters in map */
+	const uint8_t* Map;       /*!< Glyph index for each character from first, 0xFF when glyph is not in font */
+	const uint8_t* Widths;    /*!< Width of each glyph in units of pixels, max 16 */
+	const uint16_t* Offsets;  /*!< Offset of each glyph in bits array in units of bytes */
+	const uint8_t* Bits;      /*!< Glyph rows one after another, MSB first, with 2 bytes of padding at the end */
+} TM_FONT_PACKED_t;
+
 /**
  * @brief  Font structure used on my LCD libraries
  */
 typedef struct {
-	uint8_t FontWidth;    /*!< Font width in pixels */
+	uint8_t FontWidth;    /*!< Font width in pixels, max glyph width for packed fonts */
 	uint8_t FontHeight;   /*!< Font height in pixels */
-	const uint16_t *data; /*!< Pointer to data font data array */
+	const uint16_t *data; /*!< Pointer to data font data array, NULL for packed fonts */
+	const TM_FONT_PACKED_t* Packed; /*!< Pointer to packed font data, NULL for built-in fonts */
 } TM_FONT_t;
 
+/**
+ * @brief  Glyph of one character, used for drawing
+ */
+typedef struct {
+	const void* Data;     /*!< Pointer to glyph rows, NULL when character is not in font */
+	uint8_t Width;        /*!< Glyph width in units of pixels, also horizontal advance */
+	uint8_t Packed;       /*!< Set when glyph is in packed format */
+} TM_FONT_GLYPH_t;
+
 /** 
  * @brief  String width and height in unit of pixels 
  */
@@ -113,20 +185,26 @@ typedef struct {
  * @{
  */
 
+#if FONT_USE_7x10
 /**
  * @brief  7 x 10 pixels font size structure 
  */
 extern TM_FONT_t TM_Font_7x10;
+#endif
 
+#if FONT_USE_11x18
 /**
  * @brief  11 x 18 pixels font size structure 
  */
 extern TM_FONT_t TM_Font_11x18;
+#endif
 
+#if FONT_USE_16x26
 /**
  * @brief  16 x 26 pixels font size structure 
  */
 extern TM_FONT_t TM_Font_16x26;
+#endif
 
 /**
  * @}
@@ -147,6 +225,54 @@ extern TM_FONT_t TM_Font_16x26;
  */
 char* TM_FONT_GetStringSize(char* str, TM_FONT_SIZE_t* SizeStruct, TM_FONT_t* Font);
 
+/**
+ * @brief  Gets glyph for character
+ * @param  *Font: Pointer to @ref TM_FONT_t font
+ * @param  c: Character to get glyph for
+ * @param  *Glyph: Pointer to @ref TM_FONT_GLYPH_t structure to fill
+ * @retval Status:
+ *            - 0: Character is not in font, glyph is empty with width of font
+ *            - > 0: Glyph found
+ */
+uint8_t TM_FONT_GetGlyph(TM_FONT_t* Font, char c, TM_FONT_GLYPH_t* Glyph);
+
+/**
+ * @brief  Gets width of character in units of pixels
+ * @param  *Font: Pointer to @ref TM_FONT_t font
+ * @param  c: Character to get width for
+ * @retval Character width
+ */
+uint8_t TM_FONT_GetCharWidth(TM_FONT_t* Font, char c);
+
+/**
+ * @brief  Gets one row of glyph
+ * @param  *Glyph: Pointer to @ref TM_FONT_GLYPH_t glyph from @ref TM_FONT_GetGlyph
+ * @param  row: Row number, between 0 and font height - 1
+ * @retval Row pixels, MSB is leftmost pixel, bits after glyph width are 0
+ */
+static __INLINE uint16_t TM_FONT_GetRow(const TM_FONT_GLYPH_t* Glyph, uint8_t row) {
+	const uint8_t* ptr;
+	uint32_t bit, v;
+	
+	/* Empty glyph */
+	if (Glyph->Data == NULL) {
+		return 0;
+	}
+	
+	/* Built-in font has 16-bit word for each row */
+	if (!Glyph->Packed) {
+		return ((const uint16_t *)Glyph->Data)[row];
+	}
+	
+	/* Row may start anywhere in byte and spans up to 3 bytes */
+	bit = (uint32_t)row * Glyph->Width;
+	ptr = (const uint8_t *)Glyph->Data + (bit >> 3);
+	v = ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) | ((uint32_t)ptr[2] << 8);
+	
+	/* Align to MSB and clear pixels after glyph */
+	return (uint16_t)(((v << (bit & 0x07)) >> 16) & (0xFFFF0000UL >> Glyph->Width));
+}
+
 /**
  * @}
  */
@@ -0,0 +1,160 @@
+#!/usr/bin/env python
+#
+# Packed font generator for TM FONTS library
+#
+# Copyright (c) 2016 Tilen Majerle
+# License: MIT, see tm_stm32_fonts.h
+#
+# Takes built-in font from tm_stm32_fonts.c and emits C file with packed font,
+# which contains only glyphs for selected characters, 1 bit per pixel without row padding.
+#
+# Usage:
+#   python tm_stm32_fonts_pack.py --font 7x10 --name Small --chars "0123456789.-V" > font_small.c
+#   python tm_stm32_fonts_pack.py --font 11x18 --name Menu --proportional --scan User/main.c User/menu.c > font_menu.c
+#
+# Characters from --chars and from all string and character literals in --scan files are included.
+#
+
+import argparse
+import os
+import re
+import sys
+
+# Built-in fonts start with space and end with ~
+FIRST_CHAR = 32
+LAST_CHAR = 126
+
+def load_font(path, name):
+    """Reads rows of built-in font from C source"""
+    width, height = [int(x) for x in name.split("x")]
+    with open(path) as f:
+        src = f.read()
+    m = re.search(r"TM_Font" + name + r"\s*\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    if m is None:
+        sys.exit("Font " + name + " not found in " + path)
+    body = re.sub(r"//[^\n]*", "", m.group(1))
+    rows = [int(x, 16) for x in re.findall(r"0x[0-9A-Fa-f]+", body)]
+    if len(rows) != (LAST_CHAR - FIRST_CHAR + 1) * height:
+        sys.exit("Font " + name + " has wrong number of rows")
+    glyphs = {}
+    for c in range(FIRST_CHAR, LAST_CHAR + 1):
+        i = (c - FIRST_CHAR) * height
+        glyphs[c] = rows[i:i + height]
+    return width, height, glyphs
+
+def scan_chars(files):
+    """Gets all characters used in string and character literals"""
+    chars = set()
+    for path in files:
+        with open(path, errors="ignore") as f:
+            src = f.read()
+        # Remove comments first
+        src = re.sub(r"/\*.*?\*/", "", src, flags=re.S)
+        src = re.sub(r"//[^\n]*", "", src)
+        for lit in re.findall(r"\"((?:[^\"\\\n]|\\.)*)\"|'((?:[^'\\\n]|\\.)+)'", src):
+            text = lit[0] or lit[1]
+            text = re.sub(r"\\.", "", text)
+            chars.update(ord(c) for c in text)
+    return chars
+
+def trim(rows, width):
+    """Removes empty columns on the left and right, returns rows aligned to MSB and width"""
+    bits = 0
+    for r in rows:
+        bits |= r
+    if bits == 0:
+        return None, 0
+    left = 0
+    while not (bits << left) & 0x8000:
+        left += 1
+    right = width - 1
+    while not (bits << right) & 0x8000:
+        right -= 1
+    return [(r << left) & 0xFFFF for r in rows], right - left + 1
+
+def pack(rows, width):
+    """Packs rows of glyph to bytes, width bits per row, MSB first"""
+    value, count, out = 0, 0, []
+    for r in rows:
+        value = (value << width) | (r >> (16 - width))
+        count += width
+        while count >= 8:
+            count -= 8
+            out.append((value >> count) & 0xFF)
+    if count:
+        out.append((value << (8 - count)) & 0xFF)
+    return out
+
+def main():
+    parser = argparse.ArgumentParser(description="Packed font generator for TM FONTS library")
+    parser.add_argument("--font", required=True, help="Built-in font, 7x10, 11x18 or 16x26")
+    parser.add_argument("--name", required=True, help="Name of generated font, TM_Font_<name>")
+    parser.add_argument("--chars", default="", help="Characters to include")
+    parser.add_argument("--scan", nargs="*", default=[], help="Source files to scan for used characters")
+    parser.add_argument("--proportional", action="store_true", help="Trim empty columns of each glyph")
+    parser.add_argument("--spacing", type=int, default=1, help="Space after each glyph in proportional font")
+    parser.add_argument("--source", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "tm_stm32_fonts.c"))
+    args = parser.parse_args()
+
+    width, height, glyphs = load_font(args.source, args.font)
+
+    # Selected characters, only those which font has
+    chars = set(ord(c) for c in args.chars) | scan_chars(args.scan)
+    chars = sorted(c for c in chars if FIRST_CHAR <= c <= LAST_CHAR)
+    if not chars:
+        sys.exit("No characters selected")
+    if len(chars) > 255:
+        sys.exit("Too many characters")
+
+    # Pack glyphs
+    widths, offsets, bits = [], [], []
+    for c in chars:
+        rows, w = glyphs[c], width
+        if args.proportional:
+            rows, w = trim(rows, width)
+            if rows is None:
+                # Empty glyph, for example space, is half of font width
+                rows, w = [0] * height, (width + 1) // 2
+            else:
+                w = min(w + args.spacing, 16)
+        offsets.append(len(bits))
+        widths.append(w)
+        bits += pack(rows, w)
+    bits += [0, 0]
+    if len(bits) > 0xFFFF:
+        sys.exit("Font is too big")
+
+    # Map from first to last selected character
+    first, last = chars[0], chars[-1]
+    index = dict((c, i) for i, c in enumerate(chars))
+    cmap = [index.get(c, 0xFF) for c in range(first, last + 1)]
+
+    name = args.name
+    out = sys.stdout
+    out.write("/* Packed font generated with tm_stm32_fonts_pack.py from %s font, %d glyphs, %d bytes */\n" % (args.font, len(chars), len(bits) + len(cmap) + 3 * len(chars)))
+    out.write("/* Characters: %s */\n" % "".join(chr(c) for c in chars).replace("*/", "* /"))
+    out.write("#include \"tm_stm32_fonts.h\"\n\n")
+    out.write("static const uint8_t TM_Font%s_Map[] = {\n" % name)
+    for i in range(0, len(cmap), 16):
+        out.write("\t" + ", ".join("0x%02X" % x for x in cmap[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+    out.write("static const uint8_t TM_Font%s_Widths[] = {\n" % name)
+    for i in range(0, len(widths), 16):
+        out.write("\t" + ", ".join("%d" % x for x in widths[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+    out.write("static const uint16_t TM_Font%s_Offsets[] = {\n" % name)
+    for i in range(0, len(offsets), 16):
+        out.write("\t" + ", ".join("%d" % x for x in offsets[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+    out.write("static const uint8_t TM_Font%s_Bits[] = {\n" % name)
+    for i in range(0, len(bits), 16):
+        out.write("\t" + ", ".join("0x%02X" % x for x in bits[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+    out.write("static const TM_FONT_PACKED_t TM_Font%s_Packed = {\n" % name)
+    out.write("\t%d,\n\t%d,\n" % (first, last - first + 1))
+    out.write("\tTM_Font%s_Map,\n\tTM_Font%s_Widths,\n\tTM_Font%s_Offsets,\n\tTM_Font%s_Bits\n};\n\n" % (name, name, name, name))
+    out.write("TM_FONT_t TM_Font_%s = {\n" % name)
+    out.write("\t%d,\n\t%d,\n\tNULL,\n\t&TM_Font%s_Packed\n};\n" % (max(widths), height, name))
+
+if __name__ == "__main__":
+    main()
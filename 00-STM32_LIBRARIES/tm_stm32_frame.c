@@ -0,0 +1,216 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_frame.h"
+
+#if defined(CRC_POL_POL)
+/* CRC-16/CCITT-FALSE settings for CRC unit */
+static TM_CRC_Context_t FRAME_CRC;
+static uint8_t FRAME_CRCInitialized;
+#endif
+
+/* Frame delimiter */
+static uint8_t FRAME_Delimiter = 0x00;
+
+void TM_FRAME_Init(TM_FRAME_t* Frame, TM_BUFFER_t* Buffer) {
+	/* Set decoder */
+	Frame->Buffer = Buffer;
+	Frame->Pending = 0;
+	Frame->Frames = 0;
+	Frame->CRCErrors = 0;
+	Frame->Overflows = 0;
+	
+	/* Prepare delimiter search */
+	TM_BUFFER_SearchInit(&Frame->Search, &FRAME_Delimiter, 1);
+	
+#if defined(CRC_POL_POL)
+	/* Init CRC unit once */
+	if (!FRAME_CRCInitialized) {
+		TM_CRC_Init();
+		TM_CRC_ContextInit(&FRAME_CRC, TM_CRC_CRC16_CCITT);
+		FRAME_CRCInitialized = 1;
+	}
+#endif
+}
+
+uint16_t TM_FRAME_Encode(uint8_t* Frame, uint16_t count) {
+	uint16_t crc, code, i;
+	
+	/* Check payload size */
+	if (count > TM_FRAME_MAX_PAYLOAD) {
+		return 0;
+	}
+	
+	/* Add CRC after payload, high byte first */
+	crc = TM_FRAME_CRC(&Frame[1], count);
+	Frame[count + 1] = crc >> 8;
+	Frame[count + 2] = crc & 0xFF;
+	count += 2;
+	
+	/* Each zero byte is replaced with distance to next zero byte, first byte points to first zero */
+	code = 0;
+	for (i = 1; i <= count; i++) {
+		if (Frame[i] == 0) {
+			Frame[code] = i - code;
+			code = i;
+		}
+	}
+	Frame[code] = i - code;
+	
+	/* Add delimiter */
+	Frame[i] = 0;
+	
+	/* Return frame size */
+	return i + 1;
+}
+
+int32_t TM_FRAME_Decode(uint8_t* Frame, uint16_t count) {
+	uint16_t in = 0, out = 0;
+	uint8_t code, i;
+	
+	/* Decode blocks, output is always behind input */
+	while (in < count) {
+		code = Frame[in++];
+		if (code == 0 || (in + code - 1) > count) {
+			return -1;
+		}
+		
+		/* Copy block */
+		for (i = 1; i < code; i++) {
+			Frame[out++] = Frame[in++];
+		}
+		
+		/* Block ends with zero, except full block and last block */
+		if (code != 0xFF && in < count) {
+			Frame[out++] = 0;
+		}
+	}
+	
+	/* Check CRC, CRC over payload and CRC is 0 */
+	if (out < 2 || TM_FRAME_CRC(Frame, out) != 0) {
+		return -1;
+	}
+	
+	/* Return payload size */
+	return out - 2;
+}
+
+uint8_t* TM_FRAME_Get(TM_FRAME_t* Frame, uint16_t* count) {
+	uint8_t* ptr;
+	uint32_t span;
+	int32_t pos, len;
+	
+	/* Release previous frame */
+	TM_FRAME_Release(Frame);
+	
+	/* Check all complete frames in buffer */
+	while ((pos = TM_BUFFER_Search(Frame->Buffer, &Frame->Search)) >= 0) {
+		/* Empty frame, only delimiter */
+		if (pos == 0) {
+			TM_BUFFER_CommitRead(Frame->Buffer, 1);
+			continue;
+		}
+		
+		/* Frame too long */
+		if (pos >= TM_FRAME_SIZE) {
+			TM_BUFFER_CommitRead(Frame->Buffer, pos + 1);
+			Frame->Overflows++;
+			continue;
+		}
+		
+		/* Decode in buffer memory when frame does not wrap */
+		span = TM_BUFFER_GetReadSpan(Frame->Buffer, &ptr);
+		if (span >= (uint32_t)pos) {
+			Frame->Pending = pos + 1;
+		} else {
+			/* Copy frame with delimiter to work memory */
+			TM_BUFFER_Read(Frame->Buffer, Frame->Work, pos + 1);
+			ptr = Frame->Work;
+		}
+		
+		/* Decode frame */
+		len = TM_FRAME_Decode(ptr, pos);
+		if (len >= 0) {
+			Frame->Frames++;
+			*count = len;
+			return ptr;
+		}
+		
+		/* Wrong frame, skip it */
+		Frame->CRCErrors++;
+		TM_FRAME_Release(Frame);
+	}
+	
+	/* No delimiter, drop data which can not be a frame to make space */
+	span = TM_BUFFER_GetFull(Frame->Buffer);
+	if (span >= TM_FRAME_SIZE || (span && TM_BUFFER_GetFree(Frame->Buffer) == 0)) {
+		TM_BUFFER_CommitRead(Frame->Buffer, span);
+		Frame->Overflows++;
+	}
+	
+	/* No frame */
+	return NULL;
+}
+
+void TM_FRAME_Release(TM_FRAME_t* Frame) {
+	/* Remove frame from buffer */
+	if (Frame->Pending) {
+		TM_BUFFER_CommitRead(Frame->Buffer, Frame->Pending);
+		Frame->Pending = 0;
+	}
+}
+
+uint16_t TM_FRAME_CRC(const uint8_t* data, uint16_t count) {
+#if defined(CRC_POL_POL)
+	uint32_t irq, crc;
+	
+	/* CRC unit is shared with interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Calculate in hardware */
+	TM_CRC_ContextReset(&FRAME_CRC);
+	crc = TM_CRC_ContextUpdate(&FRAME_CRC, data, count);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return CRC */
+	return (uint16_t)crc;
+#else
+	uint16_t crc = 0xFFFF;
+	uint8_t i;
+	
+	/* Calculate in software */
+	while (count--) {
+		crc ^= (uint16_t)*data++ << 8;
+		for (i = 0; i < 8; i++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		}
+	}
+	
+	/* Return CRC */
+	return crc;
+#endif
+}
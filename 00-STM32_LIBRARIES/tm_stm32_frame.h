@@ -0,0 +1,277 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.1
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   COBS framing with CRC for STM32Fxxx over any TM BUFFER
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_FRAME_H
+#define TM_FRAME_H 110
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_FRAME
+ * @brief    COBS framing with CRC for STM32Fxxx over any TM BUFFER
+ * @{
+ *
+ * Library packs binary payloads into frames for byte streams like USART, USB CDC or NRF24L01 packets.
+ *
+ * \par Frame format
+ *
+\verbatim
+ | COBS encoded (payload + CRC-16/CCITT-FALSE, high byte first) | 0x00 |
+\endverbatim
+ *
+ * Consistent overhead byte stuffing (COBS) removes all zero bytes from frame, so 0x00 is used only as frame delimiter
+ * and receiver synchronizes on first delimiter after reset or error. Overhead is 1 byte plus CRC and delimiter.
+ * Payload is limited to @ref TM_FRAME_MAX_PAYLOAD bytes, so COBS never needs more than 1 extra byte
+ * and frame can be encoded and decoded in place, without copying.
+ *
+ * CRC is calculated with @ref TM_CRC unit on devices with programmable polynomial (STM32F07x, STM32F09x and STM32F7xx),
+ * otherwise in software.
+ *
+ * \par Transmit
+ *
+ * Payload is written after first byte of frame memory, @ref TM_FRAME_Encode encodes it in place
+ * and encoded frame is sent with any function:
+ *
+\code
+uint8_t Frame[TM_FRAME_SIZE];
+uint16_t len;
+
+//Write payload
+TM_FRAME_PAYLOAD(Frame)[0] = CMD_READ;
+TM_FRAME_PAYLOAD(Frame)[1] = 0x10;
+
+//Encode and send frame
+len = TM_FRAME_Encode(Frame, 2);
+TM_USART_Send(USART1, Frame, len);
+//or: TM_USBD_CDC_PutArray(TM_USB_FS, Frame, len);
+\endcode
+ *
+ * \par Receive
+ *
+ * Decoder works on any @ref TM_BUFFER_t which is filled by driver, for example @ref TM_USART_GetBuffer or @ref TM_USBD_CDC_GetRXBuffer.
+ * For NRF24L01, write received packets to own @ref TM_BUFFER_t.
+ *
+ * When whole frame is in one contiguous part of buffer memory, it is decoded in place and payload pointer points to buffer memory.
+ * Only frames which wrap at the end of buffer memory are copied to decoder work memory.
+ * Delimiter search is incremental, already checked bytes are not checked again on next call.
+ *
+\code
+TM_FRAME_t Decoder;
+uint8_t* payload;
+uint16_t count;
+
+//Decode frames from USART1 buffer
+TM_FRAME_Init(&Decoder, TM_USART_GetBuffer(USART1));
+
+while (1) {
+	//Get next valid frame
+	while ((payload = TM_FRAME_Get(&Decoder, &count)) != NULL) {
+		//Process payload, valid until next call or release
+		Process(payload, count);
+	}
+}
+\endcode
+ *
+ * @note  Decoder is a reader of buffer, do not read from the same buffer in other places
+ *
+ * Frames can be made on host with tm_stm32_frame.py script in library folder.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - TM CRC
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_buffer.h"
+#include "tm_stm32_crc.h"
+
+/**
+ * @defgroup TM_FRAME_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Maximal payload size in one frame
+ * @note   Payload and CRC fit in one COBS block of 254 bytes
+ */
+#define TM_FRAME_MAX_PAYLOAD     252
+
+/**
+ * @brief  Frame overhead, COBS overhead byte, CRC and delimiter
+ */
+#define TM_FRAME_OVERHEAD        4
+
+/**
+ * @brief  Maximal encoded frame size with delimiter, use it for frame memory size
+ */
+#define TM_FRAME_SIZE            (TM_FRAME_MAX_PAYLOAD + TM_FRAME_OVERHEAD)
+
+/**
+ * @brief  Gets pointer to payload in frame memory before encode
+ * @param  Frame: Pointer to frame memory
+ * @retval Pointer to payload
+ */
+#define TM_FRAME_PAYLOAD(Frame)  ((Frame) + 1)
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_FRAME_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Frame decoder structure
+ */
+typedef struct {
+	TM_BUFFER_t* Buffer;            /*!< Pointer to buffer with received data */
+	TM_BUFFER_Search_t Search;      /*!< Incremental delimiter search */
+	uint16_t Pending;               /*!< Number of bytes of last frame still in buffer */
+	uint32_t Frames;                /*!< Number of received valid frames */
+	uint32_t CRCErrors;             /*!< Number of frames with wrong CRC or wrong encoding */
+	uint32_t Overflows;             /*!< Number of frames longer than @ref TM_FRAME_SIZE, dropped */
+	uint8_t Work[TM_FRAME_SIZE];    /*!< Work memory for frames which wrap in buffer */
+} TM_FRAME_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_FRAME_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes frame decoder
+ * @param  *Frame: Pointer to empty @ref TM_FRAME_t structure
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure with received data
+ * @retval None
+ */
+void TM_FRAME_Init(TM_FRAME_t* Frame, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Encodes frame in place
+ * @note   Payload must be at @ref TM_FRAME_PAYLOAD address and frame memory must have count + @ref TM_FRAME_OVERHEAD bytes
+ * @param  *Frame: Pointer to frame memory
+ * @param  count: Number of bytes in payload, max @ref TM_FRAME_MAX_PAYLOAD
+ * @retval Number of bytes to send from start of frame memory, including delimiter, or 0 if payload is too big
+ */
+uint16_t TM_FRAME_Encode(uint8_t* Frame, uint16_t count);
+
+/**
+ * @brief  Decodes frame in place and checks CRC
+ * @note   Payload starts at the beginning of frame memory after decode
+ * @param  *Frame: Pointer to encoded frame
+ * @param  count: Number of bytes in encoded frame, without delimiter
+ * @retval Number of bytes in payload or -1 on wrong encoding or CRC
+ */
+int32_t TM_FRAME_Decode(uint8_t* Frame, uint16_t count);
+
+/**
+ * @brief  Gets next valid frame from buffer
+ * @note   Frame from previous call is released first. Wrong frames are counted and skipped
+ * @param  *Frame: Pointer to @ref TM_FRAME_t structure
+ * @param  *count: Pointer to variable where number of bytes in payload is saved
+ * @retval Pointer to payload, valid until next call or @ref TM_FRAME_Release, or NULL when no complete frame is in buffer
+ */
+uint8_t* TM_FRAME_Get(TM_FRAME_t* Frame, uint16_t* count);
+
+/**
+ * @brief  Releases frame memory in buffer of last frame returned from @ref TM_FRAME_Get
+ * @note   Call it when payload is processed later, so driver can receive new data to this memory
+ * @param  *Frame: Pointer to @ref TM_FRAME_t structure
+ * @retval None
+ */
+void TM_FRAME_Release(TM_FRAME_t* Frame);
+
+/**
+ * @brief  Calculates CRC-16/CCITT-FALSE as used in frames
+ * @param  *data: Pointer to data
+ * @param  count: Number of bytes
+ * @retval CRC value
+ */
+uint16_t TM_FRAME_CRC(const uint8_t* data, uint16_t count);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,120 @@
+#!/usr/bin/env python
+#
+# Host side encoder and decoder for TM FRAME library
+#
+# Copyright (c) 2016 Tilen Majerle
+# License: MIT, see tm_stm32_frame.h
+#
+# Frames are COBS encoded payload with CRC-16/CCITT-FALSE, high byte first, followed by 0x00 delimiter.
+# Module can be imported in host tools, or used from command line to send payload and print received frames.
+#
+# Usage:
+#   python tm_stm32_frame.py --port /dev/ttyACM0 --baud 115200 01 10
+#   python tm_stm32_frame.py --port COM3 --listen
+#
+# Serial port needs pyserial package.
+#
+
+import argparse
+import sys
+
+# Maximal payload, TM_FRAME_MAX_PAYLOAD
+MAX_PAYLOAD = 252
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE"""
+    crc = 0xFFFF
+    for b in bytearray(data):
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+def encode(payload):
+    """Encodes payload to frame with delimiter"""
+    payload = bytearray(payload)
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError("Payload is too big")
+    crc = crc16(payload)
+    data = payload + bytearray([crc >> 8, crc & 0xFF])
+    out = bytearray([0])
+    code = 0
+    for b in data:
+        if b == 0:
+            out[code] = len(out) - code
+            code = len(out)
+        out.append(b)
+    out[code] = len(out) - code
+    return bytes(out + bytearray([0]))
+
+def decode(frame):
+    """Decodes frame without delimiter, returns payload or None on error"""
+    frame = bytearray(frame)
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(frame):
+            out.append(0)
+    if len(out) < 2 or crc16(out) != 0:
+        return None
+    return bytes(out[:-2])
+
+class Decoder(object):
+    """Splits received bytes to frames"""
+    def __init__(self):
+        self.data = bytearray()
+        self.errors = 0
+
+    def feed(self, data):
+        """Adds received bytes, returns list of valid payloads"""
+        self.data += bytearray(data)
+        frames = []
+        while True:
+            pos = self.data.find(0)
+            if pos < 0:
+                break
+            frame, self.data = self.data[:pos], self.data[pos + 1:]
+            if not frame:
+                continue
+            payload = decode(frame)
+            if payload is None:
+                self.errors += 1
+            else:
+                frames.append(payload)
+        return frames
+
+def main():
+    parser = argparse.ArgumentParser(description="Host side encoder and decoder for TM FRAME library")
+    parser.add_argument("payload", nargs="*", help="Payload bytes in hex to send")
+    parser.add_argument("--port", required=True, help="Serial port")
+    parser.add_argument("--baud", type=int, default=115200, help="Baudrate")
+    parser.add_argument("--listen", action="store_true", help="Print received frames until interrupted")
+    args = parser.parse_args()
+
+    try:
+        import serial
+    except ImportError:
+        sys.exit("pyserial package is needed")
+
+    port = serial.Serial(args.port, args.baud, timeout=0.1)
+    if args.payload:
+        port.write(encode(bytearray(int(x, 16) for x in args.payload)))
+
+    decoder = Decoder()
+    try:
+        while args.listen or args.payload:
+            for payload in decoder.feed(port.read(256)):
+                sys.stdout.write(" ".join("%02X" % b for b in bytearray(payload)) + "\n")
+                if not args.listen:
+                    return
+    except KeyboardInterrupt:
+        pass
+
+if __name__ == "__main__":
+    main()
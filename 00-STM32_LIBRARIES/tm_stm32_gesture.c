@@ -0,0 +1,283 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_gesture.h"
+
+/* Private functions */
+static void TM_GESTURE_INT_Press(TM_GESTURE_t* Gesture, TM_TOUCH_Event_t* Touch);
+static void TM_GESTURE_INT_Move(TM_GESTURE_t* Gesture, TM_TOUCH_Event_t* Touch);
+static void TM_GESTURE_INT_Release(TM_GESTURE_t* Gesture, TM_TOUCH_Event_t* Touch);
+static int8_t TM_GESTURE_INT_Find(TM_GESTURE_t* Gesture, uint8_t id);
+static uint32_t TM_GESTURE_INT_Distance(int32_t dx, int32_t dy);
+static TM_GESTURE_Event_t* TM_GESTURE_INT_Add(TM_GESTURE_t* Gesture, TM_GESTURE_Type_t type, uint32_t time, uint16_t x, uint16_t y);
+static void TM_GESTURE_INT_Post(TM_GESTURE_t* Gesture, TM_GESTURE_Event_t* Event);
+
+void TM_GESTURE_Init(TM_GESTURE_t* Gesture) {
+	/* Clear everything */
+	memset((uint8_t *)Gesture, 0, sizeof(TM_GESTURE_t));
+}
+
+uint16_t TM_GESTURE_Update(TM_GESTURE_t* Gesture) {
+	TM_TOUCH_Event_t Touch;
+	TM_GESTURE_Event_t* Event;
+	uint16_t in = Gesture->In;
+	
+	/* Process all touch events */
+	while (TM_TOUCH_GetEvents(&Touch, 1)) {
+		if (Touch.Type == TM_TOUCH_EventType_Press) {
+			TM_GESTURE_INT_Press(Gesture, &Touch);
+		} else if (Touch.Type == TM_TOUCH_EventType_Move) {
+			TM_GESTURE_INT_Move(Gesture, &Touch);
+		} else {
+			TM_GESTURE_INT_Release(Gesture, &Touch);
+		}
+	}
+	
+	/* Long press is reported while touch is still pressed */
+	if (
+		Gesture->Count == 1 && !Gesture->Multi && !Gesture->Moved && !Gesture->LongPress &&
+		(HAL_GetTick() - Gesture->StartTime) >= GESTURE_LONG_PRESS_TIME
+	) {
+		Gesture->LongPress = 1;
+		Event = TM_GESTURE_INT_Add(Gesture, TM_GESTURE_Type_LongPress, HAL_GetTick(), Gesture->StartX, Gesture->StartY);
+		TM_GESTURE_INT_Post(Gesture, Event);
+	}
+	
+	/* Return number of new gestures */
+	return (Gesture->In - in) & (GESTURE_QUEUE_SIZE - 1);
+}
+
+uint8_t TM_GESTURE_GetEvent(TM_GESTURE_t* Gesture, TM_GESTURE_Event_t* Event) {
+	/* Check if empty */
+	if (Gesture->Out == Gesture->In) {
+		return 0;
+	}
+	
+	/* Read gesture */
+	*Event = Gesture->Events[Gesture->Out];
+	Gesture->Out = (Gesture->Out + 1) & (GESTURE_QUEUE_SIZE - 1);
+	
+	/* Gesture read */
+	return 1;
+}
+
+__weak void TM_GESTURE_Callback(TM_GESTURE_t* Gesture, TM_GESTURE_Event_t* Event) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_GESTURE_Callback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static void TM_GESTURE_INT_Press(TM_GESTURE_t* Gesture, TM_TOUCH_Event_t* Touch) {
+	if (Gesture->Count == 0) {
+		/* First touch, start of new gesture */
+		Gesture->Id[0] = Touch->Id;
+		Gesture->X[0] = Gesture->StartX = Touch->X;
+		Gesture->Y[0] = Gesture->StartY = Touch->Y;
+		Gesture->StartTime = Touch->Time;
+		Gesture->Moved = 0;
+		Gesture->LongPress = 0;
+		Gesture->Multi = 0;
+		Gesture->PinchDistance = 0;
+	} else if (Gesture->Count == 1) {
+		/* Second touch, start of pinch */
+		Gesture->Id[1] = Touch->Id;
+		Gesture->X[1] = Touch->X;
+		Gesture->Y[1] = Touch->Y;
+		Gesture->Multi = 1;
+		Gesture->PinchDistance = TM_GESTURE_INT_Distance(Gesture->X[1] - Gesture->X[0], Gesture->Y[1] - Gesture->Y[0]);
+		Gesture->PinchScale = 256;
+	}
+	
+	/* Other touches are only counted */
+	Gesture->Count++;
+}
+
+static void TM_GESTURE_INT_Move(TM_GESTURE_t* Gesture, TM_TOUCH_Event_t* Touch) {
+	TM_GESTURE_Event_t* Event;
+	uint32_t scale;
+	int8_t i;
+	
+	/* Check tracked touches only */
+	i = TM_GESTURE_INT_Find(Gesture, Touch->Id);
+	if (i < 0) {
+		return;
+	}
+	
+	/* Save position */
+	Gesture->X[i] = Touch->X;
+	Gesture->Y[i] = Touch->Y;
+	
+	/* Check if first touch is still tap */
+	if (i == 0 && !Gesture->Moved && TM_GESTURE_INT_Distance(Touch->X - Gesture->StartX, Touch->Y - Gesture->StartY) > GESTURE_TAP_DISTANCE) {
+		Gesture->Moved = 1;
+	}
+	
+	/* Check pinch */
+	if (Gesture->Count < 2 || Gesture->PinchDistance == 0) {
+		return;
+	}
+	
+	/* Scale in 8.8 format relative to start distance */
+	scale = (TM_GESTURE_INT_Distance(Gesture->X[1] - Gesture->X[0], Gesture->Y[1] - Gesture->Y[0]) << 8) / Gesture->PinchDistance;
+	if (scale > 0xFFFF) {
+		scale = 0xFFFF;
+	}
+	
+	/* Report only bigger changes */
+	if ((scale > Gesture->PinchScale ? scale - Gesture->PinchScale : Gesture->PinchScale - scale) >= GESTURE_PINCH_STEP) {
+		Gesture->PinchScale = scale;
+		Event = TM_GESTURE_INT_Add(Gesture, TM_GESTURE_Type_Pinch, Touch->Time, (Gesture->X[0] + Gesture->X[1]) >> 1, (Gesture->Y[0] + Gesture->Y[1]) >> 1);
+		if (Event) {
+			Event->Scale = scale;
+		}
+		TM_GESTURE_INT_Post(Gesture, Event);
+	}
+}
+
+static void TM_GESTURE_INT_Release(TM_GESTURE_t* Gesture, TM_TOUCH_Event_t* Touch) {
+	TM_GESTURE_Event_t* Event = NULL;
+	int32_t dx, dy, dt;
+	int8_t i;
+	
+	/* Find touch */
+	i = TM_GESTURE_INT_Find(Gesture, Touch->Id);
+	
+	/* Only touch released, check tap and swipe */
+	if (Gesture->Count == 1 && i == 0 && !Gesture->Multi) {
+		dx = (int32_t)Touch->X - Gesture->StartX;
+		dy = (int32_t)Touch->Y - Gesture->StartY;
+		dt = Touch->Time - Gesture->StartTime;
+		
+		if (!Gesture->Moved && !Gesture->LongPress && dt <= GESTURE_TAP_TIME) {
+			/* Tap */
+			Event = TM_GESTURE_INT_Add(Gesture, TM_GESTURE_Type_Tap, Touch->Time, Gesture->StartX, Gesture->StartY);
+		} else if (Gesture->Moved && dt <= GESTURE_SWIPE_TIME && TM_GESTURE_INT_Distance(dx, dy) >= GESTURE_SWIPE_DISTANCE) {
+			/* Swipe, direction is bigger axis */
+			Event = TM_GESTURE_INT_Add(Gesture, TM_GESTURE_Type_Swipe, Touch->Time, Gesture->StartX, Gesture->StartY);
+			if (Event) {
+				if (dt == 0) {
+					dt = 1;
+				}
+				Event->DX = dx;
+				Event->DY = dy;
+				Event->VelocityX = dx * 1000 / dt;
+				Event->VelocityY = dy * 1000 / dt;
+				if ((dx < 0 ? -dx : dx) >= (dy < 0 ? -dy : dy)) {
+					Event->Direction = dx < 0 ? TM_GESTURE_Direction_Left : TM_GESTURE_Direction_Right;
+				} else {
+					Event->Direction = dy < 0 ? TM_GESTURE_Direction_Up : TM_GESTURE_Direction_Down;
+				}
+			}
+		}
+		TM_GESTURE_INT_Post(Gesture, Event);
+	}
+	
+	/* Remove tracked touch, pinch ends when one of its touches is released */
+	if (i >= 0) {
+		if (i == 0) {
+			Gesture->Id[0] = Gesture->Id[1];
+			Gesture->X[0] = Gesture->X[1];
+			Gesture->Y[0] = Gesture->Y[1];
+		}
+		Gesture->PinchDistance = 0;
+	}
+	if (Gesture->Count) {
+		Gesture->Count--;
+	}
+}
+
+static int8_t TM_GESTURE_INT_Find(TM_GESTURE_t* Gesture, uint8_t id) {
+	uint8_t i;
+	
+	/* Only first 2 touches are tracked */
+	for (i = 0; i < Gesture->Count && i < 2; i++) {
+		if (Gesture->Id[i] == id) {
+			return i;
+		}
+	}
+	
+	/* Not tracked */
+	return -1;
+}
+
+static uint32_t TM_GESTURE_INT_Distance(int32_t dx, int32_t dy) {
+	uint32_t value, result = 0, bit = 1UL << 30;
+	
+	/* Integer square root of dx^2 + dy^2 */
+	value = (uint32_t)(dx * dx) + (uint32_t)(dy * dy);
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit) {
+		if (value >= result + bit) {
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	
+	/* Return distance */
+	return result;
+}
+
+static TM_GESTURE_Event_t* TM_GESTURE_INT_Add(TM_GESTURE_t* Gesture, TM_GESTURE_Type_t type, uint32_t time, uint16_t x, uint16_t y) {
+	TM_GESTURE_Event_t* Event;
+	uint16_t next;
+	
+	/* Check for free space */
+	next = (Gesture->In + 1) & (GESTURE_QUEUE_SIZE - 1);
+	if (next == Gesture->Out) {
+		Gesture->Lost++;
+		return NULL;
+	}
+	
+	/* Fill common values */
+	Event = &Gesture->Events[Gesture->In];
+	memset((uint8_t *)Event, 0, sizeof(TM_GESTURE_Event_t));
+	Event->Type = type;
+	Event->Time = time;
+	Event->X = x;
+	Event->Y = y;
+	Event->Scale = 256;
+	
+	/* Return event to fill other values */
+	return Event;
+}
+
+static void TM_GESTURE_INT_Post(TM_GESTURE_t* Gesture, TM_GESTURE_Event_t* Event) {
+	/* Check if added */
+	if (Event == NULL) {
+		return;
+	}
+	
+	/* Event is filled, make it visible */
+	Gesture->In = (Gesture->In + 1) & (GESTURE_QUEUE_SIZE - 1);
+	
+	/* Call user function */
+	TM_GESTURE_Callback(Gesture, Event);
+}
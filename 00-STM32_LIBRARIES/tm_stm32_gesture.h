@@ -0,0 +1,294 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Touch gesture recognition for TM TOUCH library
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_GESTURE_H
+#define TM_GESTURE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_GESTURE
+ * @brief    Touch gesture recognition for TM TOUCH library
+ * @{
+ *
+ * Library reads press, move and release events from @ref TM_TOUCH event queue and recognizes gestures:
+ *
+ * - Tap: touch released quickly without moving
+ * - Long press: touch held without moving for @ref GESTURE_LONG_PRESS_TIME, reported while touch is still pressed
+ * - Swipe: touch moved quickly for at least @ref GESTURE_SWIPE_DISTANCE, with direction and velocity in pixels per second
+ * - Pinch: 2 touches, reported each time distance between them changes, with scale relative to start distance
+ *
+ * Only integer math is used. Pinch scale is 8.8 fixed point number, 256 means no change,
+ * 512 means fingers are 2 times more apart than at the beginning.
+ *
+ * Gestures are saved to gesture queue and @ref TM_GESTURE_Callback is called for each one.
+ * Call @ref TM_GESTURE_Update periodically, it also checks time for long press.
+ *
+\code
+TM_GESTURE_t Gesture;
+TM_GESTURE_Event_t Event;
+
+//Init touch in interrupt mode
+TM_TOUCH_Init(NULL, &TS);
+TM_TOUCH_InitInterrupt(&TS, GPIOI, GPIO_PIN_13);
+
+//Init gestures
+TM_GESTURE_Init(&Gesture);
+
+while (1) {
+	//Process touch events
+	TM_GESTURE_Update(&Gesture);
+	
+	//Check gestures
+	while (TM_GESTURE_GetEvent(&Gesture, &Event)) {
+		if (Event.Type == TM_GESTURE_Type_Swipe && Event.Direction == TM_GESTURE_Direction_Left) {
+			//Show next page
+		}
+		if (Event.Type == TM_GESTURE_Type_Pinch) {
+			//Zoom = StartZoom * Event.Scale / 256
+		}
+	}
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM TOUCH
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_touch.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_GESTURE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Maximal distance in pixels touch can move and is still tap or long press */
+#ifndef GESTURE_TAP_DISTANCE
+#define GESTURE_TAP_DISTANCE       10
+#endif
+
+/* Maximal time in milliseconds from press to release for tap */
+#ifndef GESTURE_TAP_TIME
+#define GESTURE_TAP_TIME           300
+#endif
+
+/* Time in milliseconds for long press */
+#ifndef GESTURE_LONG_PRESS_TIME
+#define GESTURE_LONG_PRESS_TIME    800
+#endif
+
+/* Minimal distance in pixels for swipe */
+#ifndef GESTURE_SWIPE_DISTANCE
+#define GESTURE_SWIPE_DISTANCE     50
+#endif
+
+/* Maximal time in milliseconds from press to release for swipe */
+#ifndef GESTURE_SWIPE_TIME
+#define GESTURE_SWIPE_TIME         600
+#endif
+
+/* Minimal change of pinch scale, 8.8 fixed point, for new pinch event */
+#ifndef GESTURE_PINCH_STEP
+#define GESTURE_PINCH_STEP         8
+#endif
+
+/* Number of gestures in queue, must be power of 2 */
+#ifndef GESTURE_QUEUE_SIZE
+#define GESTURE_QUEUE_SIZE         8
+#endif
+
+#if GESTURE_QUEUE_SIZE & (GESTURE_QUEUE_SIZE - 1)
+#error "GESTURE_QUEUE_SIZE must be power of 2!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_GESTURE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Gesture type enumeration
+ */
+typedef enum {
+	TM_GESTURE_Type_Tap = 0x00, /*!< Short touch without movement */
+	TM_GESTURE_Type_LongPress,  /*!< Touch held without movement */
+	TM_GESTURE_Type_Swipe,      /*!< Fast movement of one touch */
+	TM_GESTURE_Type_Pinch       /*!< Distance between 2 touches has changed */
+} TM_GESTURE_Type_t;
+
+/**
+ * @brief  Swipe direction enumeration
+ */
+typedef enum {
+	TM_GESTURE_Direction_None = 0x00, /*!< No direction, gesture is not swipe */
+	TM_GESTURE_Direction_Left,        /*!< Swipe to the left */
+	TM_GESTURE_Direction_Right,       /*!< Swipe to the right */
+	TM_GESTURE_Direction_Up,          /*!< Swipe up */
+	TM_GESTURE_Direction_Down         /*!< Swipe down */
+} TM_GESTURE_Direction_t;
+
+/**
+ * @brief  Gesture event
+ */
+typedef struct {
+	TM_GESTURE_Type_t Type;           /*!< Gesture type */
+	TM_GESTURE_Direction_t Direction; /*!< Swipe direction */
+	uint32_t Time;                    /*!< Time of touch event which completed gesture */
+	uint16_t X;                       /*!< Touch position for tap and long press, start position for swipe, center for pinch */
+	uint16_t Y;                       /*!< Touch position for tap and long press, start position for swipe, center for pinch */
+	int16_t DX;                       /*!< Swipe distance in X direction */
+	int16_t DY;                       /*!< Swipe distance in Y direction */
+	int32_t VelocityX;                /*!< Swipe velocity in X direction, in pixels per second */
+	int32_t VelocityY;                /*!< Swipe velocity in Y direction, in pixels per second */
+	uint16_t Scale;                   /*!< Pinch scale in 8.8 fixed point format, relative to distance at second touch press */
+} TM_GESTURE_Event_t;
+
+/**
+ * @brief  Gesture working structure
+ * @note   Values are handled by library
+ */
+typedef struct {
+	uint8_t Count;                                  /*!< Number of currently pressed touches, only first 2 are tracked */
+	uint8_t Id[2];                                  /*!< Tracked touch IDs */
+	uint16_t X[2];                                  /*!< Current positions of tracked touches */
+	uint16_t Y[2];                                  /*!< Current positions of tracked touches */
+	uint16_t StartX;                                /*!< Position of first touch at press */
+	uint16_t StartY;                                /*!< Position of first touch at press */
+	uint32_t StartTime;                             /*!< Time of first touch press */
+	uint8_t Moved;                                  /*!< Set to 1 when first touch moved more than tap distance */
+	uint8_t LongPress;                              /*!< Set to 1 when long press was reported */
+	uint8_t Multi;                                  /*!< Set to 1 when second touch was pressed, until all are released */
+	uint32_t PinchDistance;                         /*!< Distance between touches at second touch press */
+	uint16_t PinchScale;                            /*!< Last reported pinch scale */
+	TM_GESTURE_Event_t Events[GESTURE_QUEUE_SIZE];  /*!< Gesture queue */
+	uint16_t In;                                    /*!< Gesture queue write position */
+	uint16_t Out;                                   /*!< Gesture queue read position */
+	uint32_t Lost;                                  /*!< Number of lost gestures because queue was full */
+} TM_GESTURE_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_GESTURE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes gesture structure
+ * @param  *Gesture: Pointer to empty @ref TM_GESTURE_t structure
+ * @retval None
+ */
+void TM_GESTURE_Init(TM_GESTURE_t* Gesture);
+
+/**
+ * @brief  Reads all events from touch event queue and recognizes gestures
+ * @note   Call this function periodically from main loop, not from interrupt
+ * @param  *Gesture: Pointer to @ref TM_GESTURE_t structure
+ * @retval Number of new gestures in gesture queue
+ */
+uint16_t TM_GESTURE_Update(TM_GESTURE_t* Gesture);
+
+/**
+ * @brief  Reads one gesture from gesture queue
+ * @param  *Gesture: Pointer to @ref TM_GESTURE_t structure
+ * @param  *Event: Pointer to @ref TM_GESTURE_Event_t structure to save gesture
+ * @retval Read status:
+ *            - 0: Queue is empty
+ *            - > 0: Gesture read
+ */
+uint8_t TM_GESTURE_GetEvent(TM_GESTURE_t* Gesture, TM_GESTURE_Event_t* Event);
+
+/**
+ * @brief  Called for each new gesture
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *Gesture: Pointer to @ref TM_GESTURE_t structure
+ * @param  *Event: Pointer to new gesture
+ * @retval None
+ */
+void TM_GESTURE_Callback(TM_GESTURE_t* Gesture, TM_GESTURE_Event_t* Event);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,355 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_goertzel.h"
+#include "string.h"
+#include "math.h"
+
+/* Private functions */
+static void TM_GOERTZEL_INT_Finish_F32(TM_GOERTZEL_F32_t* G);
+static void TM_GOERTZEL_INT_Finish_Q15(TM_GOERTZEL_Q15_t* G);
+static uint32_t TM_GOERTZEL_INT_Sqrt(uint64_t value);
+
+uint8_t TM_GOERTZEL_Init_F32(TM_GOERTZEL_F32_t* G, const float32_t* Frequencies, uint8_t Bins, float32_t SampleRate, uint16_t N) {
+	uint8_t i;
+	
+	/* Check parameters */
+	if (Bins == 0 || Bins > GOERTZEL_MAX_BINS || N == 0 || SampleRate <= 0) {
+		return 1;
+	}
+	
+	/* Calculate coefficients */
+	for (i = 0; i < Bins; i++) {
+		G->Coeff[i] = 2.0f * cosf(2.0f * PI * Frequencies[i] / SampleRate);
+		G->Magnitude[i] = 0;
+	}
+	
+	/* Save settings */
+	G->Bins = Bins;
+	G->N = N;
+	G->Results = 0;
+	
+	/* Clear state */
+	TM_GOERTZEL_Reset_F32(G);
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_GOERTZEL_AddToBuffer_F32(TM_GOERTZEL_F32_t* G, float32_t sampleValue) {
+	uint8_t i;
+	float32_t s;
+	
+	/* Update state of each frequency */
+	for (i = 0; i < G->Bins; i++) {
+		s = sampleValue + G->Coeff[i] * G->S1[i] - G->S2[i];
+		G->S2[i] = G->S1[i];
+		G->S1[i] = s;
+	}
+	
+	/* Check if result is ready */
+	if (++G->Count >= G->N) {
+		TM_GOERTZEL_INT_Finish_F32(G);
+		return 1;
+	}
+	
+	/* Not ready yet */
+	return 0;
+}
+
+uint16_t TM_GOERTZEL_AddBlock_F32(TM_GOERTZEL_F32_t* G, const float32_t* Samples, uint16_t count) {
+	uint16_t ready = 0, n, k;
+	uint8_t i;
+	const float32_t* x;
+	float32_t c, s1, s2, s;
+	
+	while (count) {
+		/* Samples until end of current result */
+		n = G->N - G->Count;
+		if (n > count) {
+			n = count;
+		}
+		
+		/* Process all samples of one frequency, state stays in registers */
+		for (i = 0; i < G->Bins; i++) {
+			c = G->Coeff[i];
+			s1 = G->S1[i];
+			s2 = G->S2[i];
+			x = Samples;
+			
+			/* Unrolled by 4, states are swapped instead of moved */
+			for (k = n >> 2; k > 0; k--) {
+				s2 = x[0] + c * s1 - s2;
+				s1 = x[1] + c * s2 - s1;
+				s2 = x[2] + c * s1 - s2;
+				s1 = x[3] + c * s2 - s1;
+				x += 4;
+			}
+			for (k = n & 0x03; k > 0; k--) {
+				s = *x++ + c * s1 - s2;
+				s2 = s1;
+				s1 = s;
+			}
+			
+			/* Save state */
+			G->S1[i] = s1;
+			G->S2[i] = s2;
+		}
+		
+		/* Go to next samples */
+		Samples += n;
+		count -= n;
+		G->Count += n;
+		
+		/* Check if result is ready */
+		if (G->Count >= G->N) {
+			TM_GOERTZEL_INT_Finish_F32(G);
+			ready++;
+		}
+	}
+	
+	/* Return number of results */
+	return ready;
+}
+
+void TM_GOERTZEL_Reset_F32(TM_GOERTZEL_F32_t* G) {
+	/* Clear state */
+	memset(G->S1, 0, sizeof(G->S1));
+	memset(G->S2, 0, sizeof(G->S2));
+	G->Count = 0;
+}
+
+uint8_t TM_GOERTZEL_Init_Q15(TM_GOERTZEL_Q15_t* G, const float32_t* Frequencies, uint8_t Bins, float32_t SampleRate, uint16_t N) {
+	uint8_t i;
+	float32_t c, w;
+	
+	/* Check parameters */
+	if (Bins == 0 || Bins > GOERTZEL_MAX_BINS || N == 0 || SampleRate <= 0) {
+		return 1;
+	}
+	
+	/* Calculate coefficients in Q14 format, 2.0 is saturated */
+	for (i = 0; i < Bins; i++) {
+		w = 2.0f * PI * Frequencies[i] / SampleRate;
+		
+		/* State grows up to 32768 * N / (2 * sin(w)), keep it below 2^30 */
+		if ((float32_t)N > 65536.0f * fabsf(sinf(w))) {
+			return 1;
+		}
+		
+		c = 2.0f * cosf(w) * 16384.0f;
+		if (c > 32767.0f) {
+			c = 32767.0f;
+		} else if (c < -32768.0f) {
+			c = -32768.0f;
+		}
+		G->Coeff[i] = (int16_t)(c >= 0 ? c + 0.5f : c - 0.5f);
+		G->Magnitude[i] = 0;
+	}
+	
+	/* Save settings */
+	G->Bins = Bins;
+	G->N = N;
+	G->Results = 0;
+	
+	/* Clear state */
+	TM_GOERTZEL_Reset_Q15(G);
+	
+	/* Return OK */
+	return 0;
+}
+
+uint8_t TM_GOERTZEL_AddToBuffer_Q15(TM_GOERTZEL_Q15_t* G, q15_t sampleValue) {
+	uint8_t i;
+	int32_t s;
+	
+	/* Update state of each frequency */
+	for (i = 0; i < G->Bins; i++) {
+		s = sampleValue + (int32_t)(((int64_t)G->Coeff[i] * G->S1[i]) >> 14) - G->S2[i];
+		G->S2[i] = G->S1[i];
+		G->S1[i] = s;
+	}
+	
+	/* Check if result is ready */
+	if (++G->Count >= G->N) {
+		TM_GOERTZEL_INT_Finish_Q15(G);
+		return 1;
+	}
+	
+	/* Not ready yet */
+	return 0;
+}
+
+uint16_t TM_GOERTZEL_AddBlock_Q15(TM_GOERTZEL_Q15_t* G, const q15_t* Samples, uint16_t count) {
+	uint16_t ready = 0, n, k;
+	uint8_t i;
+	const q15_t* x;
+	int32_t c, s1, s2, s;
+	
+	while (count) {
+		/* Samples until end of current result */
+		n = G->N - G->Count;
+		if (n > count) {
+			n = count;
+		}
+		
+		/* Process all samples of one frequency, state stays in registers */
+		for (i = 0; i < G->Bins; i++) {
+			c = G->Coeff[i];
+			s1 = G->S1[i];
+			s2 = G->S2[i];
+			x = Samples;
+			
+			/* Unrolled by 2, states are swapped instead of moved */
+			for (k = n >> 1; k > 0; k--) {
+				s2 = x[0] + (int32_t)(((int64_t)c * s1) >> 14) - s2;
+				s1 = x[1] + (int32_t)(((int64_t)c * s2) >> 14) - s1;
+				x += 2;
+			}
+			if (n & 0x01) {
+				s = *x + (int32_t)(((int64_t)c * s1) >> 14) - s2;
+				s2 = s1;
+				s1 = s;
+			}
+			
+			/* Save state */
+			G->S1[i] = s1;
+			G->S2[i] = s2;
+		}
+		
+		/* Go to next samples */
+		Samples += n;
+		count -= n;
+		G->Count += n;
+		
+		/* Check if result is ready */
+		if (G->Count >= G->N) {
+			TM_GOERTZEL_INT_Finish_Q15(G);
+			ready++;
+		}
+	}
+	
+	/* Return number of results */
+	return ready;
+}
+
+void TM_GOERTZEL_Reset_Q15(TM_GOERTZEL_Q15_t* G) {
+	/* Clear state */
+	memset(G->S1, 0, sizeof(G->S1));
+	memset(G->S2, 0, sizeof(G->S2));
+	G->Count = 0;
+}
+
+__weak void TM_GOERTZEL_Callback_F32(TM_GOERTZEL_F32_t* G) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_GOERTZEL_Callback_F32 could be implemented in the user file
+	*/
+}
+
+__weak void TM_GOERTZEL_Callback_Q15(TM_GOERTZEL_Q15_t* G) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_GOERTZEL_Callback_Q15 could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static void TM_GOERTZEL_INT_Finish_F32(TM_GOERTZEL_F32_t* G) {
+	uint8_t i;
+	float32_t power, s1, s2;
+	
+	/* Calculate magnitudes */
+	for (i = 0; i < G->Bins; i++) {
+		s1 = G->S1[i];
+		s2 = G->S2[i];
+		
+		/* Power of frequency */
+		power = s1 * s1 + s2 * s2 - G->Coeff[i] * s1 * s2;
+		if (power < 0) {
+			power = 0;
+		}
+		
+		/* Amplitude in units of input samples */
+		arm_sqrt_f32(power, &G->Magnitude[i]);
+		G->Magnitude[i] *= 2.0f / (float32_t)G->N;
+	}
+	
+	/* Start new result */
+	TM_GOERTZEL_Reset_F32(G);
+	G->Results++;
+	
+	/* Call user function */
+	TM_GOERTZEL_Callback_F32(G);
+}
+
+static void TM_GOERTZEL_INT_Finish_Q15(TM_GOERTZEL_Q15_t* G) {
+	uint8_t i;
+	int64_t power, s1, s2;
+	uint32_t magnitude;
+	
+	/* Calculate magnitudes */
+	for (i = 0; i < G->Bins; i++) {
+		s1 = G->S1[i];
+		s2 = G->S2[i];
+		
+		/* Power of frequency */
+		power = s1 * s1 + s2 * s2 - ((G->Coeff[i] * s1) >> 14) * s2;
+		if (power < 0) {
+			power = 0;
+		}
+		
+		/* Amplitude in units of input samples, saturated */
+		magnitude = (2 * TM_GOERTZEL_INT_Sqrt((uint64_t)power)) / G->N;
+		G->Magnitude[i] = magnitude > 0x7FFF ? 0x7FFF : (q15_t)magnitude;
+	}
+	
+	/* Start new result */
+	TM_GOERTZEL_Reset_Q15(G);
+	G->Results++;
+	
+	/* Call user function */
+	TM_GOERTZEL_Callback_Q15(G);
+}
+
+static uint32_t TM_GOERTZEL_INT_Sqrt(uint64_t value) {
+	uint64_t result = 0, bit = (uint64_t)1 << 62;
+	
+	/* Find highest bit */
+	while (bit > value) {
+		bit >>= 2;
+	}
+	
+	/* Bit by bit square root */
+	while (bit) {
+		if (value >= result + bit) {
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	
+	return (uint32_t)result;
+}
@@ -0,0 +1,302 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Multi-bin Goertzel tone detector for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_GOERTZEL_H
+#define TM_GOERTZEL_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_GOERTZEL
+ * @brief    Multi-bin Goertzel tone detector for STM32Fxxx
+ * @{
+ *
+ * When only few known frequencies must be monitored (mains harmonics, fault tones), Goertzel algorithm calculates
+ * magnitude of each frequency with 1 multiplication per sample per frequency and only 2 state values per frequency.
+ * For 3-5 frequencies, this is much cheaper than full FFT and does not need FFT buffers.
+ *
+ * Library has float version for STM32F4xx and STM32F7xx and Q15 version for STM32F0xx.
+ * Frequencies do not need to be at FFT bin centers, coefficient is calculated directly from frequency.
+ *
+ * \par Streaming
+ *
+ * API is similar to @ref TM_FFT, samples are added one by one with @ref TM_GOERTZEL_AddToBuffer_F32
+ * or in blocks with @ref TM_GOERTZEL_AddBlock_F32, for example from ADC DMA callbacks.
+ * Every time N samples are collected, magnitudes of all frequencies are calculated and @ref TM_GOERTZEL_Callback_F32 is called.
+ *
+ * Block functions process all samples of one frequency before next one, so state stays in CPU registers.
+ *
+ * Magnitudes are amplitudes in units of input samples, sine with amplitude A gives magnitude A.
+ *
+\code
+const float32_t Tones[] = {50.0f, 150.0f, 250.0f};
+TM_GOERTZEL_F32_t Goertzel;
+
+//3 frequencies at 8 kHz sample rate, 400 samples per result (50 ms)
+TM_GOERTZEL_Init_F32(&Goertzel, Tones, 3, 8000.0f, 400);
+
+//Add samples from ADC
+TM_GOERTZEL_AddBlock_F32(&Goertzel, Samples, count);
+
+void TM_GOERTZEL_Callback_F32(TM_GOERTZEL_F32_t* G) {
+	float32_t fundamental = TM_GOERTZEL_GetMagnitude(G, 0);
+}
+\endcode
+ *
+ * \note  Frequency resolution is sample rate / N. Bigger N gives narrower detection band but slower response
+ *
+ * \par Select max number of frequencies
+ *
+ * Add line to defines.h to change it:
+ *
+\code
+//Max number of frequencies in one detector
+#define GOERTZEL_MAX_BINS      8
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - ARM MATH
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+
+#include "arm_math.h"
+
+/**
+ * @defgroup TM_GOERTZEL_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Max number of frequencies in one detector */
+#ifndef GOERTZEL_MAX_BINS
+#define GOERTZEL_MAX_BINS    8
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_GOERTZEL_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Goertzel detector for 32-bit float samples
+ * @note   Members are private except Magnitude
+ */
+typedef struct {
+	uint16_t N;                              /*!< Number of samples for one result */
+	uint16_t Count;                          /*!< Number of samples in current result */
+	uint8_t Bins;                            /*!< Number of frequencies */
+	float32_t Coeff[GOERTZEL_MAX_BINS];      /*!< 2 * cos(2 * pi * f / fs) for each frequency */
+	float32_t S1[GOERTZEL_MAX_BINS];         /*!< First state value */
+	float32_t S2[GOERTZEL_MAX_BINS];         /*!< Second state value */
+	float32_t Magnitude[GOERTZEL_MAX_BINS];  /*!< Magnitudes from last result */
+	uint32_t Results;                        /*!< Number of results calculated */
+} TM_GOERTZEL_F32_t;
+
+/**
+ * @brief  Goertzel detector for Q15 samples
+ * @note   Members are private except Magnitude
+ */
+typedef struct {
+	uint16_t N;                              /*!< Number of samples for one result */
+	uint16_t Count;                          /*!< Number of samples in current result */
+	uint8_t Bins;                            /*!< Number of frequencies */
+	int16_t Coeff[GOERTZEL_MAX_BINS];        /*!< 2 * cos(2 * pi * f / fs) in Q14 format */
+	int32_t S1[GOERTZEL_MAX_BINS];           /*!< First state value */
+	int32_t S2[GOERTZEL_MAX_BINS];           /*!< Second state value */
+	q15_t Magnitude[GOERTZEL_MAX_BINS];      /*!< Magnitudes from last result */
+	uint32_t Results;                        /*!< Number of results calculated */
+} TM_GOERTZEL_Q15_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_GOERTZEL_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes float Goertzel detector
+ * @param  *G: Pointer to empty @ref TM_GOERTZEL_F32_t structure
+ * @param  *Frequencies: Pointer to frequencies in Hz, below SampleRate / 2
+ * @param  Bins: Number of frequencies, up to GOERTZEL_MAX_BINS
+ * @param  SampleRate: Sample rate in Hz
+ * @param  N: Number of samples for one result
+ * @retval Initialization status:
+ *            - 0: Initialized OK
+ *            - 1: Input parameters are not valid
+ */
+uint8_t TM_GOERTZEL_Init_F32(TM_GOERTZEL_F32_t* G, const float32_t* Frequencies, uint8_t Bins, float32_t SampleRate, uint16_t N);
+
+/**
+ * @brief  Adds one sample to detector
+ * @param  *G: Pointer to @ref TM_GOERTZEL_F32_t structure
+ * @param  sampleValue: Sample value
+ * @retval Result status:
+ *            - 0: Result not ready yet
+ *            - 1: N samples collected, magnitudes are calculated
+ */
+uint8_t TM_GOERTZEL_AddToBuffer_F32(TM_GOERTZEL_F32_t* G, float32_t sampleValue);
+
+/**
+ * @brief  Adds block of samples to detector
+ * @param  *G: Pointer to @ref TM_GOERTZEL_F32_t structure
+ * @param  *Samples: Pointer to samples
+ * @param  count: Number of samples
+ * @retval Number of results calculated during this call
+ */
+uint16_t TM_GOERTZEL_AddBlock_F32(TM_GOERTZEL_F32_t* G, const float32_t* Samples, uint16_t count);
+
+/**
+ * @brief  Clears state and starts new result
+ * @param  *G: Pointer to @ref TM_GOERTZEL_F32_t structure
+ * @retval None
+ */
+void TM_GOERTZEL_Reset_F32(TM_GOERTZEL_F32_t* G);
+
+/**
+ * @brief  Called when new magnitudes are calculated
+ * @param  *G: Pointer to @ref TM_GOERTZEL_F32_t structure
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_GOERTZEL_Callback_F32(TM_GOERTZEL_F32_t* G);
+
+/**
+ * @brief  Initializes Q15 Goertzel detector
+ * @param  *G: Pointer to empty @ref TM_GOERTZEL_Q15_t structure
+ * @param  *Frequencies: Pointer to frequencies in Hz, below SampleRate / 2
+ * @param  Bins: Number of frequencies, up to GOERTZEL_MAX_BINS
+ * @param  SampleRate: Sample rate in Hz
+ * @param  N: Number of samples for one result, N must be less than 65536 * sin(2 * pi * f / fs) for each frequency to prevent state overflow
+ * @note   Coefficients are calculated with float once, processing is integer only
+ * @retval Initialization status:
+ *            - 0: Initialized OK
+ *            - 1: Input parameters are not valid
+ */
+uint8_t TM_GOERTZEL_Init_Q15(TM_GOERTZEL_Q15_t* G, const float32_t* Frequencies, uint8_t Bins, float32_t SampleRate, uint16_t N);
+
+/**
+ * @brief  Adds one sample to detector
+ * @param  *G: Pointer to @ref TM_GOERTZEL_Q15_t structure
+ * @param  sampleValue: Sample value
+ * @retval Result status:
+ *            - 0: Result not ready yet
+ *            - 1: N samples collected, magnitudes are calculated
+ */
+uint8_t TM_GOERTZEL_AddToBuffer_Q15(TM_GOERTZEL_Q15_t* G, q15_t sampleValue);
+
+/**
+ * @brief  Adds block of samples to detector
+ * @param  *G: Pointer to @ref TM_GOERTZEL_Q15_t structure
+ * @param  *Samples: Pointer to samples
+ * @param  count: Number of samples
+ * @retval Number of results calculated during this call
+ */
+uint16_t TM_GOERTZEL_AddBlock_Q15(TM_GOERTZEL_Q15_t* G, const q15_t* Samples, uint16_t count);
+
+/**
+ * @brief  Clears state and starts new result
+ * @param  *G: Pointer to @ref TM_GOERTZEL_Q15_t structure
+ * @retval None
+ */
+void TM_GOERTZEL_Reset_Q15(TM_GOERTZEL_Q15_t* G);
+
+/**
+ * @brief  Called when new magnitudes are calculated
+ * @param  *G: Pointer to @ref TM_GOERTZEL_Q15_t structure
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_GOERTZEL_Callback_Q15(TM_GOERTZEL_Q15_t* G);
+
+/**
+ * @brief  Gets magnitude of frequency from last result
+ * @note   Works with float and Q15 structures
+ * @param  G: Pointer to detector structure
+ * @param  bin: Frequency index, as in frequencies array on initialization
+ * @retval Magnitude
+ * @note   Defined as macro for faster execution
+ */
+#define TM_GOERTZEL_GetMagnitude(G, bin)    ((G)->Magnitude[(bin)])
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
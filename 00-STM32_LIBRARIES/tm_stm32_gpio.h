@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-1-5-gpio-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   GPIO Library for STM32F4xx and STM32F7xx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_GPIO_H
-#define TM_GPIO_H 100
+#define TM_GPIO_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -63,6 +63,12 @@ extern "C" {
 \verbatim
  Version 1.0
   - Initial release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added TM_GPIO_SetPortMasked for atomic write of multiple pins with single BSRR access
+  - Added TM_GPIO_SetBusValue and TM_GPIO_GetBusValue for parallel buses on consecutive pins
+  - Added bit-band pin accessors on devices with peripheral bit-band region (STM32F4xx)
 \endverbatim
  *
  * \par Dependencies
@@ -353,6 +359,55 @@ void TM_GPIO_SetPullResistor(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, TM_GPIO_PuP
  */
 #define TM_GPIO_GetPortOutputValue(GPIOx)			((GPIOx)->ODR)
 
+/**
+ * @brief  Sets value to selected pins on GPIO PORT in one atomic access
+ * @note   Defined as macro to get maximum speed using register access
+ * @note   All selected pins are changed with single write to BSRR register,
+ *         so no read-modify-write is done and other pins are not affected
+ * @param  GPIOx: GPIOx PORT where you want to set pins
+ * @param  mask: GPIO pins which will be changed. Pins not in mask are not affected
+ * @param  value: Value for pins in mask. Pin is set high when its bit in value is 1, otherwise low
+ * @retval None
+ */
+#define TM_GPIO_SetPortMasked(GPIOx, mask, value)	((GPIOx)->BSRR = (uint32_t)(((uint32_t)(mask) & (uint32_t)(value)) | (((uint32_t)(mask) & ~(uint32_t)(value)) << 16)))
+
+/**
+ * @brief  Writes value to parallel bus on consecutive GPIO pins in one atomic access
+ * @note   Defined as macro to get maximum speed using register access
+ * @note   Useful for 4-bit or 8-bit parallel buses (LCD data lines for example) where all lines are on the same port
+ * @param  GPIOx: GPIOx PORT where bus is connected
+ * @param  FirstPin: GPIO pin number (0 - 15) of bus bit 0
+ * @param  width: Number of bus lines, 1 - 16
+ * @param  value: Value to write to bus. Only lower width bits are used
+ * @retval None
+ */
+#define TM_GPIO_SetBusValue(GPIOx, FirstPin, width, value)	TM_GPIO_SetPortMasked(GPIOx, ((1UL << (width)) - 1) << (FirstPin), (uint32_t)(value) << (FirstPin))
+
+/**
+ * @brief  Reads value from parallel bus on consecutive GPIO pins
+ * @note   Defined as macro to get maximum speed using register access
+ * @param  GPIOx: GPIOx PORT where bus is connected
+ * @param  FirstPin: GPIO pin number (0 - 15) of bus bit 0
+ * @param  width: Number of bus lines, 1 - 16
+ * @retval Bus value
+ */
+#define TM_GPIO_GetBusValue(GPIOx, FirstPin, width)	(((GPIOx)->IDR >> (FirstPin)) & ((1UL << (width)) - 1))
+
+/**
+ * @brief  Bit-band accessors for single GPIO pin
+ * @note   Available only on devices with peripheral bit-band region (STM32F4xx).
+ *         STM32F0xx and STM32F7xx does not support bit-banding
+ * @note   Each pin has its own 32-bit word in alias region, so single store or load is enough
+ *         to change or read pin. Pin is used as pin number (0 - 15), not as GPIO_PIN_x mask
+ */
+#if defined(PERIPH_BB_BASE) || defined(__DOXYGEN__)
+#define TM_GPIO_BB_ADDR(reg, PinNum)                (*(__IO uint32_t *)(PERIPH_BB_BASE + (((uint32_t)&(reg) - PERIPH_BASE) << 5) + ((uint32_t)(PinNum) << 2)))
+#define TM_GPIO_BB_Output(GPIOx, PinNum)            TM_GPIO_BB_ADDR((GPIOx)->ODR, PinNum) /*!< ODR bit alias, read or write */
+#define TM_GPIO_BB_Input(GPIOx, PinNum)             TM_GPIO_BB_ADDR((GPIOx)->IDR, PinNum) /*!< IDR bit alias, read only */
+#define TM_GPIO_BB_SetPinValue(GPIOx, PinNum, val)  (TM_GPIO_BB_Output(GPIOx, PinNum) = (val) ? 1 : 0)
+#define TM_GPIO_BB_GetPinValue(GPIOx, PinNum)       (TM_GPIO_BB_Input(GPIOx, PinNum))
+#endif
+
 /**
  * @brief  Gets port source from desired GPIOx PORT
  * @note   Meant for private use, unless you know what are you doing
@@ -19,40 +19,196 @@
 #include "tm_stm32_gps.h"
 
 /* Internal variables */
-static char GPS_Term[15];
-static uint8_t GPS_Term_Number;
-static uint8_t GPS_Term_Pos;
-static uint8_t TM_GPS_CRC, TM_GPS_CRC_Received;
-static uint8_t TM_GPS_Star;
-static uint8_t TM_GPS_Statement = GPS_ERR;
+static char GPS_Sentence[GPS_SENTENCE_SIZE];
+static uint16_t GPS_Sentence_Len;
+static uint8_t GPS_Sentence_Overflow;
 static uint32_t GPS_Flags = 0, GPS_Flags_OK;
 static TM_GPS_Data_t TM_GPS_INT_Data;
 static uint8_t TM_GPS_FirstTime;
-static char GPS_Statement_Name[7];
 
-#ifndef GPS_DISABLE_GPGSV
-uint8_t GPGSV_StatementsCount = 0;
-uint8_t GPSGV_StatementNumber = 0;
-uint8_t GPGSV_Term_Number = 0;
-uint8_t GPGSV_Term_Mod = 0;
+#if GPS_PPS
+/* PPS status */
+static TM_GPS_PPS_t GPS_PPS_Status;
+static uint32_t GPS_PPS_Clock, GPS_PPS_Ratio, GPS_PPS_Capture;
+static uint32_t GPS_PPS_RTCCount;
+static uint64_t GPS_PPS_RTCStart;
+static volatile uint8_t GPS_PPS_CalPending;
+static volatile int32_t GPS_PPS_CalValue;
+#endif
+
+#if GPS_USE_UBX
+/* UBX protocol */
+#define GPS_UBX_SYNC1            0xB5
+#define GPS_UBX_SYNC2            0x62
+#define GPS_UBX_CLASS_NAV        0x01
+#define GPS_UBX_CLASS_CFG        0x06
+#define GPS_UBX_NAV_DOP          0x04
+#define GPS_UBX_NAV_PVT          0x07
+#define GPS_UBX_NAV_SAT          0x35
+#define GPS_UBX_CFG_PRT          0x00
+#define GPS_UBX_CFG_MSG          0x01
+#define GPS_UBX_CFG_RATE         0x08
+
+/* Little endian values in UBX payload */
+#define GPS_UBX_U2(p, o)         ((uint16_t)(p)[o] | (uint16_t)(p)[(o) + 1] << 8)
+#define GPS_UBX_U4(p, o)         ((uint32_t)GPS_UBX_U2(p, o) | (uint32_t)GPS_UBX_U2(p, (o) + 2) << 16)
+
+/* UBX frame decoder */
+typedef struct {
+	uint8_t State;                 /* Position inside frame */
+	uint8_t Class;                 /* Frame class */
+	uint8_t ID;                    /* Frame ID */
+	uint16_t Length;               /* Payload length */
+	uint16_t Pos;                  /* Number of received payload bytes */
+	uint8_t CK_A, CK_B;            /* Running checksum */
+	uint8_t Payload[GPS_UBX_SIZE]; /* Stored payload */
+} TM_GPS_INT_UBX_t;
+static TM_GPS_INT_UBX_t GPS_UBX;
+#endif
+
+#if GPS_USE_TRACK
+/* Track block reader */
+typedef struct {
+	const uint8_t* Ptr;      /* Next encoded byte */
+	uint16_t Remaining;      /* Fixes left in block */
+	uint8_t First;           /* Next fix is first fix from block header */
+	const uint8_t* Block;    /* Block start */
+	int32_t DeltaLatitude;   /* Latitude difference to previous fix, 0 for first fix */
+	int32_t DeltaLongitude;  /* Longitude difference to previous fix, 0 for first fix */
+	TM_GPS_TrackFix_t Fix;   /* Decoded fix */
+} TM_GPS_INT_TrackReader_t;
 #endif
 
+/* Statement handler, Terms[0] is statement name including $ */
+typedef void (*TM_GPS_INT_Handler_t)(char** Terms, uint8_t Count);
+
+/* Supported statement */
+typedef struct {
+	uint32_t Key;                 /* Statement name packed with TM_GPS_INT_KEY */
+	TM_GPS_INT_Handler_t Handler; /* Function which parses statement */
+} TM_GPS_INT_Statement_t;
+
+/* Speed conversion factor */
+typedef struct {
+	float Factor;                 /* Multiplier for speed in knots, dividend for pace units */
+	uint32_t Fixed;               /* Factor in Q24 format, factor * 1000000 for pace units */
+	uint8_t Pace;                 /* Unit is time per distance, factor is divided by speed */
+} TM_GPS_INT_Speed_t;
+
 /* Private */
-TM_GPS_Result_t TM_GPS_INT_Do(TM_GPS_t* GPS_Data, char c);
-void TM_GPS_INT_CheckTerm(TM_GPS_t* GPS_Data);
+uint32_t TM_GPS_INT_Process(TM_GPS_t* GPS_Data, uint8_t* data, uint32_t count, uint8_t* newdata);
+uint8_t TM_GPS_INT_Sentence(TM_GPS_t* GPS_Data);
+#if GPS_USE_UBX
+uint32_t TM_GPS_INT_UBX_Process(TM_GPS_t* GPS_Data, uint8_t* data, uint32_t count, uint8_t* newdata);
+uint8_t TM_GPS_INT_UBX_Frame(TM_GPS_t* GPS_Data);
+void TM_GPS_INT_UBX_Send(uint8_t Class, uint8_t ID, uint8_t* data, uint16_t count);
+#endif
+uint32_t TM_GPS_INT_Key(const char* name);
+int32_t TM_GPS_INT_ParseFixed(const char* str, uint8_t decimals);
+int32_t TM_GPS_INT_ParseCoordinate(const char* str);
 TM_GPS_Result_t TM_GPS_INT_Return(TM_GPS_t* GPS_Data);
-uint8_t TM_GPS_INT_StringStartsWith(char* string, const char* str);
-uint8_t TM_GPS_INT_Atoi(char* str, uint32_t* val);
-uint32_t TM_GPS_INT_Pow(uint8_t x, uint8_t y);
 uint8_t TM_GPS_INT_Hex2Dec(char c);
 uint8_t TM_GPS_INT_FlagsOk(TM_GPS_t* GPS_Data);
 void TM_GPS_INT_ClearFlags(TM_GPS_t* GPS_Data);
-void TM_GPS_INT_CheckEmpty(TM_GPS_t* GPS_Data);
+static uint32_t TM_GPS_INT_Cosine(int32_t Latitude);
+static uint32_t TM_GPS_INT_Sine(uint32_t x);
+static uint32_t TM_GPS_INT_Asin(uint32_t x);
+static uint32_t TM_GPS_INT_Sqrt(uint64_t x);
+static int32_t TM_GPS_INT_DeltaLongitude(int32_t Longitude1, int32_t Longitude2);
+#if GPS_USE_TRACK
+static void TM_GPS_INT_TrackNextBlock(TM_GPS_Track_t* Track);
+static uint16_t TM_GPS_INT_TrackFixes(TM_GPS_Track_t* Track, uint8_t block);
+static uint8_t TM_GPS_INT_TrackPut(uint8_t* data, int32_t value);
+static int32_t TM_GPS_INT_TrackGet(const uint8_t** data);
+static void TM_GPS_INT_TrackSet32(uint8_t* data, uint32_t value);
+static uint32_t TM_GPS_INT_TrackGet32(const uint8_t* data);
+static void TM_GPS_INT_TrackOpen(TM_GPS_INT_TrackReader_t* Reader, const uint8_t* Block);
+static uint8_t TM_GPS_INT_TrackRead(TM_GPS_INT_TrackReader_t* Reader);
+#ifndef GPS_DISABLE_GPRMC
+static uint32_t TM_GPS_INT_TrackDays(TM_GPS_Date_t* Date);
+#endif
+#endif
+#ifndef GPS_DISABLE_GPGGA
+static void TM_GPS_INT_GPGGA(char** Terms, uint8_t Count);
+#endif
+#ifndef GPS_DISABLE_GPRMC
+static void TM_GPS_INT_GPRMC(char** Terms, uint8_t Count);
+#endif
+#ifndef GPS_DISABLE_GPGSA
+static void TM_GPS_INT_GPGSA(char** Terms, uint8_t Count);
+#endif
+#ifndef GPS_DISABLE_GPGSV
+static void TM_GPS_INT_GPGSV(char** Terms, uint8_t Count);
+#endif
 
-#define TM_GPS_INT_Add2CRC(c)                            (TM_GPS_CRC ^= c)
 #define TM_GPS_INT_ReturnWithStatus(GPS_Data, status)    (GPS_Data)->Status = status; return status;
 #define TM_GPS_INT_SetFlag(flag)                         (GPS_Flags |= (flag))
 
+/* Packs 5 characters of statement name to one number, 5 bits for each character */
+#define TM_GPS_INT_KEY(a, b, c, d, e)                    \
+	((uint32_t)((a) - 'A' + 1) << 20 | (uint32_t)((b) - 'A' + 1) << 15 | (uint32_t)((c) - 'A' + 1) << 10 | (uint32_t)((d) - 'A' + 1) << 5 | (uint32_t)((e) - 'A' + 1))
+
+/* Supported statements */
+static const TM_GPS_INT_Statement_t GPS_Statements[] = {
+#ifndef GPS_DISABLE_GPGGA
+	{TM_GPS_INT_KEY('G', 'P', 'G', 'G', 'A'), TM_GPS_INT_GPGGA},
+#endif
+#ifndef GPS_DISABLE_GPRMC
+	{TM_GPS_INT_KEY('G', 'P', 'R', 'M', 'C'), TM_GPS_INT_GPRMC},
+#endif
+#ifndef GPS_DISABLE_GPGSA
+	{TM_GPS_INT_KEY('G', 'P', 'G', 'S', 'A'), TM_GPS_INT_GPGSA},
+#endif
+#ifndef GPS_DISABLE_GPGSV
+	{TM_GPS_INT_KEY('G', 'P', 'G', 'S', 'V'), TM_GPS_INT_GPGSV},
+#endif
+	{0, NULL}
+};
+
+/* Fixed point formats */
+#define GPS_Q30_ONE              ((uint32_t)1 << 30)
+#define GPS_Q30(x)               ((uint32_t)((x) * 1073741824.0 + 0.5))
+#define GPS_Q30_MUL(a, b)        ((uint32_t)(((uint64_t)(a) * (b)) >> 30))
+
+/* Distance of 1e-7 degree on earth surface in centimeters, Q16 format */
+#define GPS_E7_CM_Q16            ((uint32_t)(GPS_EARTH_RADIUS * 100000.0 * 0.01745329251994 * 0.0000001 * 65536.0 + 0.5))
+
+/* Q30 radians from 0 to 90 degrees in units of 1e-7 degrees, multiplier is in Q31 format */
+#define GPS_E7_RAD(x)            ((uint32_t)(((uint32_t)(x) * 4024455254ULL) >> 31))
+
+/* Speed conversion factors, indexed with TM_GPS_Speed_t */
+#define GPS_SPEED(f)             {(float)(f), (uint32_t)((f) * 16777216.0 + 0.5), 0}
+#define GPS_PACE(f)              {(float)(f), (uint32_t)((f) * 1000000.0 + 0.5), 1}
+static const TM_GPS_INT_Speed_t GPS_SpeedFactors[] = {
+	/* Metric */
+	GPS_SPEED(0.000514), GPS_SPEED(0.5144), GPS_SPEED(1.852), GPS_SPEED(30.87),
+	/* Imperial */
+	GPS_SPEED(0.0003197), GPS_SPEED(1.151), GPS_SPEED(1.688), GPS_SPEED(101.3),
+	/* For Runners and Joggers */
+	GPS_PACE(32.4), GPS_PACE(1944), GPS_PACE(194.4), GPS_PACE(52.14), GPS_PACE(3128), GPS_PACE(177.7),
+	/* Nautical */
+	GPS_SPEED(1)
+};
+
+/* Powers of 10 for decimal parts */
+static const uint32_t GPS_Pow10[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/* Cosine of 0 to 90 degrees in steps of 1 degree, Q15 format */
+static const uint16_t GPS_Cosine[] = {
+	32768, 32763, 32748, 32723, 32688, 32643, 32588, 32524, 32449, 32365,
+	32270, 32166, 32052, 31928, 31795, 31651, 31499, 31336, 31164, 30983,
+	30792, 30592, 30382, 30163, 29935, 29698, 29452, 29197, 28932, 28660,
+	28378, 28088, 27789, 27482, 27166, 26842, 26510, 26170, 25822, 25466,
+	25102, 24730, 24351, 23965, 23571, 23170, 22763, 22348, 21926, 21498,
+	21063, 20622, 20174, 19720, 19261, 18795, 18324, 17847, 17364, 16877,
+	16384, 15886, 15384, 14876, 14365, 13848, 13328, 12803, 12275, 11743,
+	11207, 10668, 10126,  9580,  9032,  8481,  7927,  7371,  6813,  6252,
+	 5690,  5126,  4560,  3993,  3425,  2856,  2286,  1715,  1144,   572,
+	    0
+};
+
 /* Public */
 void TM_GPS_Init(TM_GPS_t* GPS_Data, uint32_t baudrate) {
 	/* Initialize USART */
@@ -97,18 +253,45 @@ void TM_GPS_Init(TM_GPS_t* GPS_Data, uint32_t baudrate) {
 }
 
 TM_GPS_Result_t TM_GPS_Update(TM_GPS_t* GPS_Data) {
-	/* Check for data in USART */
-	if (!GPS_USART_BUFFER_EMPTY) {
-		/* Go through all buffer */
-		while (!GPS_USART_BUFFER_EMPTY) {
-			/* Do character by character */
-			TM_GPS_INT_Do(GPS_Data, (char)GPS_USART_BUFFER_GET_CHAR);
-			/* If new data available, return to user */
-			if (GPS_Data->Status == TM_GPS_Result_NewData) {
-				return GPS_Data->Status;
-			}
+	uint8_t newdata = 0;
+#if GPS_PPS
+	
+	/* Apply RTC calibration measured in PPS interrupt, HAL waits for calibration and can not be called there */
+	if (GPS_PPS_CalPending) {
+		TM_RTC_SetCalibration(GPS_PPS_CalValue);
+		GPS_PPS_CalPending = 0;
+	}
+#endif
+#ifdef GPS_USART_BUFFER
+	TM_BUFFER_t* Buffer = GPS_USART_BUFFER;
+	uint8_t* ptr;
+	uint32_t count;
+	
+	/* Process data directly in USART buffer memory */
+	while ((count = TM_BUFFER_GetReadSpan(Buffer, &ptr)) > 0) {
+		/* Remove processed part from buffer */
+		TM_BUFFER_CommitRead(Buffer, TM_GPS_INT_Process(GPS_Data, ptr, count, &newdata));
+		
+		/* If new data available, return to user */
+		if (newdata) {
+			return GPS_Data->Status;
+		}
+	}
+#else
+	uint8_t c;
+	
+	/* Go through all buffer */
+	while (!GPS_USART_BUFFER_EMPTY) {
+		/* Custom get character function */
+		c = (uint8_t)GPS_USART_BUFFER_GET_CHAR;
+		TM_GPS_INT_Process(GPS_Data, &c, 1, &newdata);
+		
+		/* If new data available, return to user */
+		if (newdata) {
+			return GPS_Data->Status;
 		}
 	}
+#endif
 	
 	if (TM_GPS_FirstTime) {
 		/* No any valid data, return First Data Waiting */
@@ -130,7 +313,7 @@ TM_GPS_Custom_t * TM_GPS_AddCustom(TM_GPS_t* GPS_Data, char* GPG_Statement, uint
 	}
 	
 	/* Allocate memory */
-	temp = (TM_GPS_Custom_t *) malloc(sizeof(TM_GPS_Custom_t));
+	temp = (TM_GPS_Custom_t *) LIB_ALLOC_FUNC(sizeof(TM_GPS_Custom_t));
 	/* Check malloc success */
 	if (temp == NULL) {
 		return NULL;
@@ -151,47 +334,45 @@ TM_GPS_Custom_t * TM_GPS_AddCustom(TM_GPS_t* GPS_Data, char* GPG_Statement, uint
 }
 
 float TM_GPS_ConvertSpeed(float SpeedInKnots, TM_GPS_Speed_t toSpeed) {
-	switch ((uint8_t)toSpeed) {
-		/* Metric */
-		case TM_GPS_Speed_KilometerPerSecond:
-			return SpeedInKnots * (float)0.000514;
-		case TM_GPS_Speed_MeterPerSecond:
-			return SpeedInKnots * (float)0.5144;
-		case TM_GPS_Speed_KilometerPerHour:
-			return SpeedInKnots * (float)1.852;
-		case TM_GPS_Speed_MeterPerMinute:
-			return SpeedInKnots * (float)30.87;
-		
-		/* Imperial */
-		case TM_GPS_Speed_MilePerSecond:
-			return SpeedInKnots * (float)0.0003197;
-		case TM_GPS_Speed_MilePerHour:
-			return SpeedInKnots * (float)1.151;
-		case TM_GPS_Speed_FootPerSecond:
-			return SpeedInKnots * (float)1.688;
-		case TM_GPS_Speed_FootPerMinute:
-			return SpeedInKnots * (float)101.3;
-		
-		/* For Runners and Joggers */
-		case TM_GPS_Speed_MinutePerKilometer:
-			return SpeedInKnots * (float)32.4;
-		case TM_GPS_Speed_SecondPerKilometer:
-			return SpeedInKnots * (float)1944;
-		case TM_GPS_Speed_SecondPer100Meters:
-			return SpeedInKnots * (float)194.4;
-		case TM_GPS_Speed_MinutePerMile:
-			return SpeedInKnots * (float)52.14;
-		case TM_GPS_Speed_SecondPerMile:
-			return SpeedInKnots * (float)3128;
-		case TM_GPS_Speed_SecondPer100Yards:
-			return SpeedInKnots * (float)177.7;
-		
-		/* Nautical */
-		case TM_GPS_Speed_SeaMilePerHour:
-			return SpeedInKnots * (float)1;
-		default:
+	const TM_GPS_INT_Speed_t* Speed;
+	
+	/* Check unit */
+	if ((uint8_t)toSpeed >= sizeof(GPS_SpeedFactors) / sizeof(GPS_SpeedFactors[0])) {
+		return 0;
+	}
+	Speed = &GPS_SpeedFactors[(uint8_t)toSpeed];
+	
+	/* Pace is time per distance, not defined when standing */
+	if (Speed->Pace) {
+		if (SpeedInKnots <= 0) {
+			return 0;
+		}
+		return Speed->Factor / SpeedInKnots;
+	}
+	
+	/* Speed */
+	return SpeedInKnots * Speed->Factor;
+}
+
+uint32_t TM_GPS_ConvertSpeedFixed(uint32_t SpeedE3, TM_GPS_Speed_t toSpeed) {
+	const TM_GPS_INT_Speed_t* Speed;
+	
+	/* Check unit */
+	if ((uint8_t)toSpeed >= sizeof(GPS_SpeedFactors) / sizeof(GPS_SpeedFactors[0])) {
+		return 0;
+	}
+	Speed = &GPS_SpeedFactors[(uint8_t)toSpeed];
+	
+	/* Pace, factor is already scaled to 0.001 units of result for speed in 0.001 knots */
+	if (Speed->Pace) {
+		if (SpeedE3 == 0) {
 			return 0;
+		}
+		return (Speed->Fixed + SpeedE3 / 2) / SpeedE3;
 	}
+	
+	/* Speed, multiply with Q24 factor and round */
+	return (uint32_t)(((uint64_t)SpeedE3 * Speed->Fixed + ((uint32_t)1 << 23)) >> 24);
 }
 
 void TM_GPS_ConvertFloat(float num, TM_GPS_Float_t* Float_Data, uint8_t decimals) {
@@ -204,9 +385,36 @@ void TM_GPS_ConvertFloat(float num, TM_GPS_Float_t* Float_Data, uint8_t decimals
 	
 	/* Get decimal part */
 	if (num < 0) {
-		Float_Data->Decimal = (int32_t)((float)(Float_Data->Integer - num) * TM_GPS_INT_Pow(10, decimals));
+		Float_Data->Decimal = (int32_t)((float)(Float_Data->Integer - num) * (float)GPS_Pow10[decimals]);
+	} else {
+		Float_Data->Decimal = (int32_t)((float)(num - Float_Data->Integer) * (float)GPS_Pow10[decimals]);
+	}
+}
+
+void TM_GPS_ConvertFixed(int32_t num, uint8_t scale, TM_GPS_Float_t* Float_Data, uint8_t decimals) {
+	int32_t rem;
+	
+	if (scale > 9) {
+		scale = 9;
+	}
+	if (decimals > 9) {
+		decimals = 9;
+	}
+	
+	/* Get integer part, truncated toward zero as with float numbers */
+	Float_Data->Integer = num / (int32_t)GPS_Pow10[scale];
+	
+	/* Get decimal part from absolute remainder */
+	rem = num % (int32_t)GPS_Pow10[scale];
+	if (rem < 0) {
+		rem = -rem;
+	}
+	
+	/* Scale to number of decimals */
+	if (decimals < scale) {
+		Float_Data->Decimal = (uint32_t)rem / GPS_Pow10[scale - decimals];
 	} else {
-		Float_Data->Decimal = (int32_t)((float)(num - Float_Data->Integer) * TM_GPS_INT_Pow(10, decimals));
+		Float_Data->Decimal = (uint32_t)rem * GPS_Pow10[decimals - scale];
 	}
 }
 
@@ -236,411 +444,1008 @@ void TM_GPS_DistanceBetween(TM_GPS_Distance_t* Distance_Data) {
 	}
 }
 
-/* Private */
-TM_GPS_Result_t TM_GPS_INT_Do(TM_GPS_t* GPS_Data, char c) {
-	if (TM_GPS_INT_FlagsOk(GPS_Data)) {
-		/* Data were valid before, new data are coming, not new anymore */
-		TM_GPS_INT_ClearFlags(GPS_Data);
-		/* Data were "new" on last call, now are only "Old data", no NEW data */
-		GPS_Data->Status = TM_GPS_Result_OldData;
+uint32_t TM_GPS_DistanceFast(int32_t Latitude1, int32_t Longitude1, int32_t Latitude2, int32_t Longitude2) {
+	int64_t x, y;
+	
+	/* Longitude difference is scaled with cosine of mean latitude, Q15 format */
+	x = ((int64_t)TM_GPS_INT_DeltaLongitude(Longitude1, Longitude2) * TM_GPS_INT_Cosine(Latitude1 / 2 + Latitude2 / 2)) >> 15;
+	y = (int64_t)Latitude2 - Latitude1;
+	
+	/* Distance on plane in 1e-7 degrees, convert to centimeters */
+	return (uint32_t)(((uint64_t)TM_GPS_INT_Sqrt((uint64_t)(x * x) + (uint64_t)(y * y)) * GPS_E7_CM_Q16 + 0x8000) >> 16);
+}
+
+uint32_t TM_GPS_DistanceHaversine(int32_t Latitude1, int32_t Longitude1, int32_t Latitude2, int32_t Longitude2) {
+	int32_t dlon;
+	uint32_t s1, s2, cc;
+	uint64_t a, b;
+	
+	/* Product of cosines, cos(lat) = sin(90 - |lat|), Q30 format */
+	s1 = Latitude1 < 0 ? -Latitude1 : Latitude1;
+	s2 = Latitude2 < 0 ? -Latitude2 : Latitude2;
+	cc = GPS_Q30_MUL(TM_GPS_INT_Sine(GPS_E7_RAD(900000000 - s1)), TM_GPS_INT_Sine(GPS_E7_RAD(900000000 - s2)));
+	
+	/* Sines of absolute half differences, sign is not important as sine is squared */
+	dlon = TM_GPS_INT_DeltaLongitude(Longitude1, Longitude2);
+	if (dlon < 0) {
+		dlon = -dlon;
 	}
-	if (c == '$') {
-		/* Star detection reset */
-		TM_GPS_Star = 0;
-		/* Reset CRC */
-		TM_GPS_CRC = 0;
-		/* First term in new statement */
-		GPS_Term_Number = 0;
-		/* At position 0 of a first term */
-		GPS_Term_Pos = 0;
-		/* Add character to first term */
-		GPS_Term[GPS_Term_Pos++] = c;
-	} else if (c == ',') {
-		/* Add to parity */
-		TM_GPS_INT_Add2CRC(c);
-		/* Add 0 at the end */
-		GPS_Term[GPS_Term_Pos++] = 0;
-		
-		/* Check empty */
-		TM_GPS_INT_CheckEmpty(GPS_Data);
-		
-		/* Check term */
-		TM_GPS_INT_CheckTerm(GPS_Data);
-		
-		/* Increase term number */
-		GPS_Term_Number++;
-		/* At position 0 of a first term */
-		GPS_Term_Pos = 0;
-	} else if (c == '\n') {
-		/* Reset term number */
-		GPS_Term_Number = 0;
+	s1 = TM_GPS_INT_Sine(GPS_E7_RAD((Latitude2 > Latitude1 ? (uint32_t)(Latitude2 - Latitude1) : (uint32_t)(Latitude1 - Latitude2)) / 2));
+	s2 = TM_GPS_INT_Sine(GPS_E7_RAD((uint32_t)dlon / 2));
+	
+	/* a = sin^2(dlat / 2) + cos(lat1) * cos(lat2) * sin^2(dlon / 2), Q60 format to keep precision on short distances */
+	a = (uint64_t)s1 * s1;
+	b = (uint64_t)s2 * s2;
+	a += (b >> 30) * cc + (((b & (GPS_Q30_ONE - 1)) * cc) >> 30);
+	
+	/* Half of central angle is asin(sqrt(a)), square root of Q60 is Q30 */
+	s1 = TM_GPS_INT_Sqrt(a);
+	if (s1 > GPS_Q30_ONE) {
+		s1 = GPS_Q30_ONE;
+	}
+	
+	/* Distance is 2 * R * asin(sqrt(a)) in centimeters */
+	return (uint32_t)(((uint64_t)TM_GPS_INT_Asin(s1) * (2UL * GPS_EARTH_RADIUS * 100000UL) + (GPS_Q30_ONE >> 1)) >> 30);
+}
 
-#ifndef GPS_DISABLE_GPGSV
-		/* Check for GPGSV statement */
-		if (TM_GPS_Statement == GPS_GPGSV && GPGSV_StatementsCount == GPSGV_StatementNumber) {
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_SATSDESC);
-		}
-#endif
-	} else if (c == '\r') {
-		GPS_Term[GPS_Term_Pos++] = 0;
-		
-		/* Between * and \r are 2 characters of Checksum */
-		TM_GPS_CRC_Received = TM_GPS_INT_Hex2Dec(GPS_Term[0]) * 16 + TM_GPS_INT_Hex2Dec(GPS_Term[1]);
-		
-		if (TM_GPS_CRC_Received != TM_GPS_CRC) {
-			/* CRC is not OK, data failed somewhere */
-			/* Clear all flags */
-			TM_GPS_INT_ClearFlags(GPS_Data);
-		}
-		
-		/* Reset term number */
-		GPS_Term_Number = 0;
-	} else if (c == '*') {
-		/* Star detected */
-		TM_GPS_Star = 1;
-		/* Add 0 at the end */
-		GPS_Term[GPS_Term_Pos++] = 0;
-		
-		/* Check empty */
-		TM_GPS_INT_CheckEmpty(GPS_Data);
-		
-		/* Check term */
-		TM_GPS_INT_CheckTerm(GPS_Data);
-		
-		/* Increase term number */
-		GPS_Term_Number++;
-		/* At position 0 of a first term */
-		GPS_Term_Pos = 0;
-	} else {
-		/* Other characters detected */
-		
-		/* If star is not detected yet */
-		if (!TM_GPS_Star) {
-			/* Add to parity */
-			TM_GPS_INT_Add2CRC(c);
-		}
-		
-		/* Add to term */
-		GPS_Term[GPS_Term_Pos++] = c;
+#if GPS_PPS
+void TM_GPS_PPS_Init(void) {
+	/* Init pin */
+	TM_GPIO_InitAlternate(GPS_PPS_PORT, GPS_PPS_PIN, TM_GPIO_OType_PP, TM_GPIO_PuPd_DOWN, TM_GPIO_Speed_High, GPS_PPS_AF);
+	
+	/* Enable timer clock */
+	GPS_PPS_TIM_CLK_ENABLE();
+	
+	/* APB1 timer clock is twice PCLK1 when APB1 prescaler is not 1 */
+	GPS_PPS_Clock = HAL_RCC_GetPCLK1Freq();
+	if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+		GPS_PPS_Clock *= 2;
 	}
 	
-	/* Return */
-	return TM_GPS_INT_Return(GPS_Data);
+	/* CPU cycles per timer tick */
+	GPS_PPS_Ratio = HAL_RCC_GetHCLKFreq() / GPS_PPS_Clock;
+	
+	/* Reset status */
+	memset(&GPS_PPS_Status, 0, sizeof(GPS_PPS_Status));
+	
+	/* Free running 32-bit timer without prescaler, channel 1 captures rising edge of TI1 */
+	GPS_PPS_TIM->CR1 = 0;
+	GPS_PPS_TIM->DIER = 0;
+	GPS_PPS_TIM->PSC = 0;
+	GPS_PPS_TIM->ARR = 0xFFFFFFFF;
+	GPS_PPS_TIM->CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC1P | TIM_CCER_CC1NP);
+	GPS_PPS_TIM->CCMR1 = (GPS_PPS_TIM->CCMR1 & ~0xFF) | TIM_CCMR1_CC1S_0;
+	GPS_PPS_TIM->CCER |= TIM_CCER_CC1E;
+	GPS_PPS_TIM->EGR = TIM_EGR_UG;
+	GPS_PPS_TIM->SR = 0;
+	GPS_PPS_TIM->DIER = TIM_DIER_CC1IE;
+	GPS_PPS_TIM->CR1 = TIM_CR1_CEN;
+	
+	/* Enable interrupt */
+	HAL_NVIC_SetPriority(GPS_PPS_TIM_IRQ, GPS_PPS_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(GPS_PPS_TIM_IRQ);
 }
 
-void TM_GPS_INT_CheckTerm(TM_GPS_t* GPS_Data) {
-	uint32_t temp;
-#ifndef GPS_DISABLE_GPGSA
-	static uint8_t ids_count = 0;
-#endif
-	uint8_t count, i;
-	if (GPS_Term_Number == 0) {
-		/* Statement indicator */
-		if (TM_GPS_INT_StringStartsWith(GPS_Term, "$GPGGA")) {
-			TM_GPS_Statement = GPS_GPGGA;
-		} else if (TM_GPS_INT_StringStartsWith(GPS_Term, "$GPRMC")) {
-			TM_GPS_Statement = GPS_GPRMC;
-		} else if (TM_GPS_INT_StringStartsWith(GPS_Term, "$GPGSA")) {
-			TM_GPS_Statement = GPS_GPGSA;
-		} else if (TM_GPS_INT_StringStartsWith(GPS_Term, "$GPGSV")) {
-			TM_GPS_Statement = GPS_GPGSV;
-		} else {
-			TM_GPS_Statement = GPS_ERR;
-		}
-		
-		/* Copy term to variable */
-		strcpy(GPS_Statement_Name, GPS_Term);
-		
-		/* Do nothing */
+void TM_GPS_PPS_GetStatus(TM_GPS_PPS_t* PPS) {
+	uint32_t irq;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Copy status */
+	*PPS = GPS_PPS_Status;
+	
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+__weak void TM_GPS_PPS_Callback(TM_GPS_PPS_t* PPS) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_GPS_PPS_Callback could be implemented in the user file
+	*/
+}
+
+void GPS_PPS_TIM_IRQ_HANDLER(void) {
+	uint32_t cycles, count, capture, ticks, since;
+	uint64_t edge, rtc;
+	int32_t error;
+	
+	/* Check capture flag */
+	if (!(GPS_PPS_TIM->SR & TIM_SR_CC1IF)) {
 		return;
 	}
 	
-	/* Check custom terms one by one */
-	for (i = 0; i < GPS_Data->CustomStatementsCount; i++) {
-		/* Term is inside current statement */
-		if (TM_GPS_INT_StringStartsWith(GPS_Statement_Name, GPS_Data->CustomStatements[i]->Statement)) {
-			/* Term number is correct */
-			if (GPS_Term_Number == GPS_Data->CustomStatements[i]->TermNumber) {
-				/* Copy string value */
-				strcpy(GPS_Data->CustomStatements[i]->Value, GPS_Term);
-				
-				/* Set updated flag */
-				GPS_Data->CustomStatements[i]->Updated = 1;
-			}
-		}
+	/* Read counters close together, reading capture clears flag */
+	cycles = DWT->CYCCNT;
+	count = GPS_PPS_TIM->CNT;
+	capture = GPS_PPS_TIM->CCR1;
+	
+	/* First pulse after init has no previous capture */
+	ticks = capture - GPS_PPS_Capture;
+	GPS_PPS_Capture = capture;
+	
+	/* Check pulse period, glitch or lost pulse restarts counting */
+	error = (int32_t)(ticks - GPS_PPS_Clock);
+	if (error > (int32_t)(GPS_PPS_Clock / 1000000 * GPS_PPS_TOLERANCE) || error < -(int32_t)(GPS_PPS_Clock / 1000000 * GPS_PPS_TOLERANCE)) {
+		GPS_PPS_Status.Count = 0;
+		GPS_PPS_RTCCount = 0;
+		return;
 	}
 	
-	switch (GPS_CONCAT(TM_GPS_Statement, GPS_Term_Number)) {
-#ifndef GPS_DISABLE_GPGGA
-		case GPS_POS_LATITUDE:	/* GPGGA */
-			/* Convert latitude */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Latitude = temp / 100;
-			TM_GPS_INT_Data.Latitude += (float)(temp % 100) / (float)60;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.Latitude += temp / (TM_GPS_INT_Pow(10, count) * 60.0);
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_LATITUDE);
-			break;
-		case GPS_POS_NS: /* GPGGA */
-			if (GPS_Term[0] == 'S') {
-				/* South has negative coordinate */
-				TM_GPS_INT_Data.Latitude = -TM_GPS_INT_Data.Latitude;
-			}
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_NS);
-			break;
-		case GPS_POS_LONGITUDE: /* GPGGA */
-			/* Convert longitude */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Longitude = temp / 100; /* Degrees */
-			TM_GPS_INT_Data.Longitude += (float)(temp % 100) / (float)60;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.Longitude += temp / (TM_GPS_INT_Pow(10, count) * 60.0);
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_LONGITUDE);
-			break;
-		case GPS_POS_EW: /* GPGGA */
-			if (GPS_Term[0] == 'W') {
-				/* West has negative coordinate */
-				TM_GPS_INT_Data.Longitude = -TM_GPS_INT_Data.Longitude;
-			}
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_EW);
-			break;
-		case GPS_POS_SATS: /* GPGGA */
-			/* Satellites in use */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Satellites = temp;
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_SATS);
-			break;
-		case GPS_POS_FIX: /* GPGGA */
-			/* GPS Fix */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Fix = temp;	
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_FIX);
-			break;
-		case GPS_POS_ALTITUDE: /* GPGGA */
-			/* Convert altitude above sea */
-			if (GPS_Term[0] == '-') {
-				count = TM_GPS_INT_Atoi(&GPS_Term[1], &temp);
-				TM_GPS_INT_Data.Altitude = temp;
-				
-				count++;
-				count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-				TM_GPS_INT_Data.Altitude += temp / (TM_GPS_INT_Pow(10, count) * 1.0);
-				
-				TM_GPS_INT_Data.Altitude = -TM_GPS_INT_Data.Altitude;
-			} else {
-				count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-				TM_GPS_INT_Data.Altitude = temp;
-		
-				count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-				TM_GPS_INT_Data.Altitude += temp / (TM_GPS_INT_Pow(10, count) * 1.0);
-			}
-			
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_ALTITUDE);
-			break;
-		case GPS_POS_TIME: /* GPGGA */
-			/* Set time */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Time.Seconds = temp % 100;
-			TM_GPS_INT_Data.Time.Minutes = (int)(temp * (float) 0.01) % 100;
-			TM_GPS_INT_Data.Time.Hours = (int)(temp * (float)0.0001) % 100;
-			/* Hundredths */
-			TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.Time.Hundredths = temp;
+	/* Clock error from last 2 pulses */
+	GPS_PPS_Status.Count++;
+	GPS_PPS_Status.Ticks = ticks;
+	GPS_PPS_Status.ErrorPPB = (int32_t)((int64_t)error * 1000000000 / GPS_PPS_Clock);
+	
+	/* Cycles and timestamp at pulse edge */
+	since = count - capture;
+	cycles -= since * GPS_PPS_Ratio;
+	edge = TM_RTC_GetTimestamp() - (uint64_t)since * 1000000 / GPS_PPS_Clock;
+	
+	/* Edge is at start of second */
+	edge = (edge + 500000) / 1000000 * 1000000;
+	TM_RTC_TimestampDiscipline(cycles, edge);
+	GPS_PPS_Status.Timestamp = edge;
+	
+#if GPS_PPS_RTC_PERIOD
+	/* Measure RTC error over many pulses, subseconds resolution is about 1ms */
+	rtc = TM_RTC_GetMicros();
+	if (GPS_PPS_RTCCount == 0 || GPS_PPS_CalPending) {
+		/* Start new measurement */
+		GPS_PPS_RTCStart = rtc;
+		GPS_PPS_RTCCount = 1;
+	} else if (GPS_PPS_RTCCount++ == GPS_PPS_RTC_PERIOD) {
+		/* Error in ppb, positive when RTC is fast */
+		GPS_PPS_Status.RTCErrorPPB = (int32_t)(((int64_t)(rtc - GPS_PPS_RTCStart) - (int64_t)GPS_PPS_RTC_PERIOD * 1000000) * 1000 / GPS_PPS_RTC_PERIOD);
 		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_TIME);
-			break;
+		/* Correct calibration in update function */
+		GPS_PPS_CalValue = TM_RTC_GetCalibration() - GPS_PPS_Status.RTCErrorPPB;
+		GPS_PPS_CalPending = 1;
+		GPS_PPS_RTCCount = 0;
+	}
+#else
+	(void)rtc;
 #endif
-#ifndef GPS_DISABLE_GPRMC
-		case GPS_POS_SPEED:	/* GPRMC */	
-			/* Convert speed */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Speed = (float)temp;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.Speed += (float)((float)temp / (TM_GPS_INT_Pow(10, count) * 1.0));
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_SPEED);
-			break;
-		case GPS_POS_DATE: /* GPRMC */	
-			/* Set date */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Date.Year = temp % 100;
-			TM_GPS_INT_Data.Date.Month = (int)(temp * (float)0.01) % 100;
-			TM_GPS_INT_Data.Date.Date = (int)(temp * (float) 0.0001) % 100;
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_DATE);
-			break;
-		case GPS_POS_VALIDITY: /* GPRMC */	
-			/* GPS valid status */
-			TM_GPS_INT_Data.Validity = GPS_Term[0] == 'A';
-			
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_VALIDITY);
-			break;
-		case GPS_POS_DIRECTION: /* GPRMC */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.Direction = (float)temp;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.Direction += (float)((float)temp / (TM_GPS_INT_Pow(10, count) * 1.0));
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_DIRECTION);
-			break;
+	
+	/* Call user function */
+	TM_GPS_PPS_Callback(&GPS_PPS_Status);
+}
 #endif
-#ifndef GPS_DISABLE_GPGSA
-		case GPS_POS_HDOP: /* GPGSA */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.HDOP = (float)temp;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.HDOP += (float)((float)temp / (TM_GPS_INT_Pow(10, count) * 1.0));
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_HDOP);
-			break;
-		case GPS_POS_PDOP: /* GPGSA */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.PDOP = (float)temp;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.PDOP += (float)((float)temp / (TM_GPS_INT_Pow(10, count) * 1.0));
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_PDOP);
-			break;
-		case GPS_POS_VDOP: /* GPGSA */
-			count = TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.VDOP = (float)temp;
-		
-			count = TM_GPS_INT_Atoi(&GPS_Term[++count], &temp);
-			TM_GPS_INT_Data.VDOP += (float)((float)temp / (TM_GPS_INT_Pow(10, count) * 1.0));
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_VDOP);
-			break;
-		case GPS_POS_FIXMODE: /* GPGSA */
-			/* Satellites in view */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.FixMode = temp;
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_FIXMODE);
-			break;
-		case GPS_POS_SAT1:
-		case GPS_POS_SAT2:
-		case GPS_POS_SAT3:
-		case GPS_POS_SAT4:
-		case GPS_POS_SAT5:
-		case GPS_POS_SAT6:
-		case GPS_POS_SAT7:
-		case GPS_POS_SAT8:
-		case GPS_POS_SAT9:
-		case GPS_POS_SAT10:
-		case GPS_POS_SAT11:
-		case GPS_POS_SAT12:
-			/* Satellite numbers */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.SatelliteIDs[GPS_Term_Number - 3] = temp;
-		
-			/* Increase number of satellites found */
-			ids_count++;
-		
-			if (ids_count == TM_GPS_INT_Data.Satellites) {
-				ids_count = 0;
-				
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_SATS1_12);
-			}
-			break;
+
+#if GPS_USE_UBX
+void TM_GPS_UBX_Configure(uint32_t baudrate, uint16_t rate) {
+	uint8_t data[20];
+	
+	/* CFG-RATE: measurement period, 1 navigation solution per measurement, GPS time */
+	data[0] = rate & 0xFF;
+	data[1] = rate >> 8;
+	data[2] = 1;
+	data[3] = 0;
+	data[4] = 1;
+	data[5] = 0;
+	TM_GPS_INT_UBX_Send(GPS_UBX_CLASS_CFG, GPS_UBX_CFG_RATE, data, 6);
+	
+	/* CFG-MSG: enable navigation frames on current port, each solution */
+	data[0] = GPS_UBX_CLASS_NAV;
+	data[2] = 1;
+	data[1] = GPS_UBX_NAV_PVT;
+	TM_GPS_INT_UBX_Send(GPS_UBX_CLASS_CFG, GPS_UBX_CFG_MSG, data, 3);
+	data[1] = GPS_UBX_NAV_DOP;
+	TM_GPS_INT_UBX_Send(GPS_UBX_CLASS_CFG, GPS_UBX_CFG_MSG, data, 3);
+#if !defined(GPS_DISABLE_GPGSA) || !defined(GPS_DISABLE_GPGSV)
+	data[1] = GPS_UBX_NAV_SAT;
+	TM_GPS_INT_UBX_Send(GPS_UBX_CLASS_CFG, GPS_UBX_CFG_MSG, data, 3);
 #endif
-#ifndef GPS_DISABLE_GPGSV
-		case GPS_POS_SATSINVIEW: /* GPGSV */
-			/* Satellites in view */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			TM_GPS_INT_Data.SatellitesInView = temp;
-		
-			/* Set flag */
-			TM_GPS_INT_SetFlag(GPS_FLAG_SATSINVIEW);
-			break;
+	
+	/* CFG-PRT: UART1, 8N1, new baudrate, UBX and NMEA input, UBX output only */
+	memset(data, 0, 20);
+	data[0] = 1;
+	data[4] = 0xD0;
+	data[5] = 0x08;
+	data[8] = baudrate & 0xFF;
+	data[9] = (baudrate >> 8) & 0xFF;
+	data[10] = (baudrate >> 16) & 0xFF;
+	data[11] = (baudrate >> 24) & 0xFF;
+	data[12] = 0x03;
+	data[14] = 0x01;
+	TM_GPS_INT_UBX_Send(GPS_UBX_CLASS_CFG, GPS_UBX_CFG_PRT, data, 20);
+	
+	/* Wait last byte to be sent before baudrate is changed */
+	while (!((GPS_USART)->USART_STATUS_REG & USART_FLAG_TC));
+	
+	/* Initialize USART with new baudrate */
+	GPS_USART_INIT(baudrate);
+}
 #endif
-		default: 
-			break;
+
+#if GPS_USE_TRACK
+void TM_GPS_TrackInit(TM_GPS_Track_t* Track) {
+	/* Reset structure, first fix starts new block */
+	memset(Track, 0, sizeof(TM_GPS_Track_t));
+	Track->Count = 1;
+}
+
+uint8_t TM_GPS_TrackAdd(TM_GPS_Track_t* Track, TM_GPS_t* GPS_Data) {
+	TM_GPS_TrackFix_t Fix;
+	
+	/* Fix must be valid */
+	if (!GPS_Data->Fix) {
+		return 0;
 	}
 	
-#ifndef GPS_DISABLE_GPGSV
-	/* Check for GPGSV statement separatelly */
-	if (TM_GPS_Statement == GPS_GPGSV) {
-		/* Check term number */
+	/* Time since midnight */
+	Fix.Time = (uint32_t)GPS_Data->Time.Hours * 3600 + (uint32_t)GPS_Data->Time.Minutes * 60 + GPS_Data->Time.Seconds;
+	Fix.Hundredths = GPS_Data->Time.Hundredths;
+#ifndef GPS_DISABLE_GPRMC
+	/* Add days since 01.01.2000 */
+	Fix.Time += TM_GPS_INT_TrackDays(&GPS_Data->Date) * 86400;
+#endif
+	
+	/* Convert to 1e-6 degrees and decimeters, round to nearest */
+	Fix.Latitude = (GPS_Data->LatitudeE7 + (GPS_Data->LatitudeE7 < 0 ? -5 : 5)) / 10;
+	Fix.Longitude = (GPS_Data->LongitudeE7 + (GPS_Data->LongitudeE7 < 0 ? -5 : 5)) / 10;
+	Fix.Altitude = (int32_t)floor(GPS_Data->Altitude * 10.0 + 0.5);
+	
+	/* Save fix */
+	TM_GPS_TrackAddFix(Track, &Fix);
+	
+	/* Return OK */
+	return 1;
+}
+
+void TM_GPS_TrackAddFix(TM_GPS_Track_t* Track, const TM_GPS_TrackFix_t* Fix) {
+	uint8_t data[20], *block;
+	uint16_t len = 0, fixes;
+	int32_t dt;
+	
+	/* Difference in hundredths, new block when time goes back or gap is too long */
+	dt = (int32_t)(Fix->Time - Track->Last.Time);
+	if (Track->Used && (dt < 0 || dt > 86400)) {
+		TM_GPS_INT_TrackNextBlock(Track);
+	}
+	
+	/* Encode differences to previous fix */
+	if (Track->Used) {
+		dt = dt * 100 + (int32_t)Fix->Hundredths - (int32_t)Track->Last.Hundredths;
+		len += TM_GPS_INT_TrackPut(&data[len], dt);
+		len += TM_GPS_INT_TrackPut(&data[len], Fix->Latitude - Track->Last.Latitude);
+		len += TM_GPS_INT_TrackPut(&data[len], Fix->Longitude - Track->Last.Longitude);
+		len += TM_GPS_INT_TrackPut(&data[len], Fix->Altitude - Track->Last.Altitude);
 		
-		if (GPS_Term_Number == 1) {
-			/* Save number of GPGSV statements */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			GPGSV_StatementsCount = temp;
+		/* Block is full, start new one */
+		if (Track->Used + len > GPS_TRACK_BLOCK_SIZE) {
+			TM_GPS_INT_TrackNextBlock(Track);
 		}
-		if (GPS_Term_Number == 2) {
-			/* Save current of GPGSV statement number */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			GPSGV_StatementNumber = temp;
+	}
+	block = Track->Blocks[Track->Head];
+	
+	if (!Track->Used) {
+		/* First fix in block is stored as it is */
+		memset(block, 0, GPS_TRACK_BLOCK_SIZE);
+		block[0] = 'T';
+		block[1] = 'K';
+		TM_GPS_INT_TrackSet32(&block[4], Fix->Time);
+		block[8] = Fix->Hundredths;
+		TM_GPS_INT_TrackSet32(&block[9], (uint32_t)Fix->Latitude);
+		TM_GPS_INT_TrackSet32(&block[13], (uint32_t)Fix->Longitude);
+		TM_GPS_INT_TrackSet32(&block[17], (uint32_t)Fix->Altitude);
+		Track->Used = GPS_TRACK_HEADER_SIZE;
+	} else {
+		/* Append differences */
+		memcpy(&block[Track->Used], data, len);
+		Track->Used += len;
+	}
+	
+	/* Update number of fixes in block */
+	fixes = block[2] | block[3] << 8;
+	fixes++;
+	block[2] = fixes & 0xFF;
+	block[3] = fixes >> 8;
+	
+	/* Save last fix */
+	Track->Last = *Fix;
+}
+
+uint16_t TM_GPS_TrackGetLast(TM_GPS_Track_t* Track, TM_GPS_TrackFix_t* Fixes, uint16_t count) {
+	TM_GPS_INT_TrackReader_t Reader;
+	uint32_t total = 0, skip;
+	uint16_t saved = 0;
+	uint8_t i, first, block;
+	
+	/* Find oldest block needed, going back from current one */
+	for (i = 0; i < Track->Count && total < count; i++) {
+		block = (Track->Head + GPS_TRACK_BLOCKS - i) % GPS_TRACK_BLOCKS;
+		total += TM_GPS_INT_TrackFixes(Track, block);
+	}
+	first = i;
+	
+	/* Skip older fixes in first block */
+	skip = total > count ? total - count : 0;
+	
+	/* Decode blocks from oldest to newest */
+	while (first--) {
+		block = (Track->Head + GPS_TRACK_BLOCKS - first) % GPS_TRACK_BLOCKS;
+		TM_GPS_INT_TrackOpen(&Reader, Track->Blocks[block]);
+		while (TM_GPS_INT_TrackRead(&Reader)) {
+			if (skip) {
+				skip--;
+			} else {
+				Fixes[saved++] = Reader.Fix;
+			}
+		}
+	}
+	
+	/* Return number of fixes */
+	return saved;
+}
+
+float TM_GPS_TrackDistanceSince(TM_GPS_Track_t* Track, uint32_t Time) {
+	TM_GPS_INT_TrackReader_t Reader;
+	float distance = 0, scale = 0;
+	int32_t lat = 0;
+	uint8_t i, block, next, prev = 0;
+	
+	/* Go through all blocks from oldest */
+	for (i = Track->Count; i > 0; i--) {
+		block = (Track->Head + GPS_TRACK_BLOCKS - i + 1) % GPS_TRACK_BLOCKS;
+		
+		/* Skip block when next block starts before given time, no segment in block is needed */
+		if (i > 1) {
+			next = (block + 1) % GPS_TRACK_BLOCKS;
+			if (TM_GPS_INT_TrackGet32(&Track->Blocks[next][4]) <= Time) {
+				prev = 0;
+				continue;
+			}
 		}
 		
-		/* Data */
-		if (GPS_Term_Number >= 4) {
-			/* Convert to number */
-			TM_GPS_INT_Atoi(GPS_Term, &temp);
-			
-			/* Get proper value */
-			GPGSV_Term_Number = GPS_Term_Number - 4;
-			GPGSV_Term_Mod = GPGSV_Term_Number % 4;
-			GPGSV_Term_Number = (GPSGV_StatementNumber - 1) * 4 + (GPGSV_Term_Number / 4);
-			
-			/* If still memory available */
-			if (GPGSV_Term_Number < GPS_MAX_SATS_IN_VIEW) {
-				/* Check offset from 4 */
-				if (GPGSV_Term_Mod == 0) {
-					TM_GPS_INT_Data.SatDesc[GPGSV_Term_Number].ID = temp;
-				} else if (GPGSV_Term_Mod == 1) {
-					TM_GPS_INT_Data.SatDesc[GPGSV_Term_Number].Elevation = temp;
-				} else if (GPGSV_Term_Mod == 2) {
-					TM_GPS_INT_Data.SatDesc[GPGSV_Term_Number].Azimuth = temp;
-				} else if (GPGSV_Term_Mod == 3) {
-					TM_GPS_INT_Data.SatDesc[GPGSV_Term_Number].SNR = temp;
+		/* Sum segments, where both fixes are after given time */
+		TM_GPS_INT_TrackOpen(&Reader, Track->Blocks[block]);
+		while (TM_GPS_INT_TrackRead(&Reader)) {
+			if (Reader.Fix.Time < Time) {
+				prev = 0;
+				continue;
+			}
+			if (prev) {
+				/* Longitude scale changes slowly, calculate cosine only when latitude changes for more than about 1km */
+				if (scale == 0 || (Reader.Fix.Latitude - lat) > 10000 || (lat - Reader.Fix.Latitude) > 10000) {
+					lat = Reader.Fix.Latitude;
+					scale = cos(GPS_DEGREES2RADIANS(lat * (float)0.000001));
 				}
+				distance += sqrt((float)Reader.DeltaLatitude * (float)Reader.DeltaLatitude + 
+					(float)Reader.DeltaLongitude * scale * (float)Reader.DeltaLongitude * scale);
 			}
+			prev = 1;
 		}
 	}
-#endif
+	
+	/* Differences are in 1e-6 degrees, 1e-6 degree is 0.111195 meters on earth surface */
+	return distance * (float)0.111195;
 }
 
-TM_GPS_Result_t TM_GPS_INT_Return(TM_GPS_t* GPS_Data) {
-	uint8_t i;
-	if (TM_GPS_INT_FlagsOk(GPS_Data)) {
-		/* Clear first time */
-		TM_GPS_FirstTime = 0;
+uint16_t TM_GPS_TrackDecode(const uint8_t* Block, TM_GPS_TrackFix_t* Fixes, uint16_t count) {
+	TM_GPS_INT_TrackReader_t Reader;
+	uint16_t saved = 0;
+	
+	/* Check block */
+	if (Block[0] != 'T' || Block[1] != 'K') {
+		return 0;
+	}
+	
+	/* Decode all fixes */
+	TM_GPS_INT_TrackOpen(&Reader, Block);
+	while (saved < count && TM_GPS_INT_TrackRead(&Reader)) {
+		Fixes[saved++] = Reader.Fix;
+	}
+	
+	/* Return number of fixes */
+	return saved;
+}
+
+#if GPS_TRACK_USE_FATFS
+uint8_t TM_GPS_TrackFlush(TM_GPS_Track_t* Track, FIL* fil, uint8_t all) {
+	UINT bw;
+	uint8_t block;
+	
+	/* Write completed blocks, oldest first */
+	while (Track->Pending) {
+		block = (Track->Head + GPS_TRACK_BLOCKS - Track->Pending) % GPS_TRACK_BLOCKS;
+		if (f_write(fil, Track->Blocks[block], GPS_TRACK_BLOCK_SIZE, &bw) != FR_OK || bw != GPS_TRACK_BLOCK_SIZE) {
+			return 0;
+		}
+		Track->Pending--;
+	}
+	
+	/* Write current block and go back to its start, it is written again when completed */
+	if (all) {
+		if (Track->Used) {
+			if (f_write(fil, Track->Blocks[Track->Head], GPS_TRACK_BLOCK_SIZE, &bw) != FR_OK || bw != GPS_TRACK_BLOCK_SIZE) {
+				return 0;
+			}
+			if (f_lseek(fil, f_tell(fil) - GPS_TRACK_BLOCK_SIZE) != FR_OK) {
+				return 0;
+			}
+		}
+		if (f_sync(fil) != FR_OK) {
+			return 0;
+		}
+	}
+	
+	/* Return OK */
+	return 1;
+}
+#endif
+#endif
+
+/* Private */
+uint32_t TM_GPS_INT_Process(TM_GPS_t* GPS_Data, uint8_t* data, uint32_t count, uint8_t* newdata) {
+	uint8_t* end;
+	
+#if GPS_USE_UBX
+	/* UBX frame starts between NMEA statements */
+	if (GPS_UBX.State || (GPS_Sentence_Len == 0 && data[0] == GPS_UBX_SYNC1)) {
+		return TM_GPS_INT_UBX_Process(GPS_Data, data, count, newdata);
+	}
+#endif
+	
+	/* Find end of statement */
+	end = memchr(data, '\n', count);
+	if (end) {
+		count = end - data + 1;
+	}
+	
+	/* Copy to statement buffer, too long statements are dropped */
+	if (!GPS_Sentence_Overflow && GPS_Sentence_Len + count < GPS_SENTENCE_SIZE) {
+		memcpy(&GPS_Sentence[GPS_Sentence_Len], data, count);
+		GPS_Sentence_Len += count;
+	} else {
+		GPS_Sentence_Overflow = 1;
+	}
+	
+	/* Statement complete */
+	if (end) {
+		if (!GPS_Sentence_Overflow) {
+			GPS_Sentence[GPS_Sentence_Len] = 0;
+			*newdata = TM_GPS_INT_Sentence(GPS_Data);
+		}
+		
+		/* Start with new statement */
+		GPS_Sentence_Len = 0;
+		GPS_Sentence_Overflow = 0;
+	}
+	
+	/* Return number of processed bytes */
+	return count;
+}
+
+#if GPS_USE_UBX
+uint32_t TM_GPS_INT_UBX_Process(TM_GPS_t* GPS_Data, uint8_t* data, uint32_t count, uint8_t* newdata) {
+	uint32_t i;
+	uint8_t c;
+	
+	for (i = 0; i < count; i++) {
+		c = data[i];
+		
+		/* Add to checksum, from class to end of payload */
+		if (GPS_UBX.State >= 2 && GPS_UBX.State <= 6) {
+			GPS_UBX.CK_A += c;
+			GPS_UBX.CK_B += GPS_UBX.CK_A;
+		}
+		
+		switch (GPS_UBX.State) {
+			case 0: /* Sync char 1 */
+				if (c != GPS_UBX_SYNC1) {
+					/* Not UBX frame, let NMEA parser check it */
+					return i;
+				}
+				GPS_UBX.State = 1;
+				break;
+			case 1: /* Sync char 2 */
+				GPS_UBX.State = c == GPS_UBX_SYNC2 ? 2 : 0;
+				GPS_UBX.CK_A = GPS_UBX.CK_B = 0;
+				break;
+			case 2: /* Class */
+				GPS_UBX.Class = c;
+				GPS_UBX.State = 3;
+				break;
+			case 3: /* ID */
+				GPS_UBX.ID = c;
+				GPS_UBX.State = 4;
+				break;
+			case 4: /* Length LSB */
+				GPS_UBX.Length = c;
+				GPS_UBX.State = 5;
+				break;
+			case 5: /* Length MSB */
+				GPS_UBX.Length |= (uint16_t)c << 8;
+				GPS_UBX.Pos = 0;
+				GPS_UBX.State = GPS_UBX.Length ? 6 : 7;
+				break;
+			case 6: /* Payload, save only what fits to buffer */
+				if (GPS_UBX.Pos < GPS_UBX_SIZE) {
+					GPS_UBX.Payload[GPS_UBX.Pos] = c;
+				}
+				if (++GPS_UBX.Pos >= GPS_UBX.Length) {
+					GPS_UBX.State = 7;
+				}
+				break;
+			case 7: /* Checksum A */
+				GPS_UBX.State = c == GPS_UBX.CK_A ? 8 : 0;
+				break;
+			case 8: /* Checksum B, frame done */
+				GPS_UBX.State = 0;
+				if (c == GPS_UBX.CK_B) {
+					*newdata = TM_GPS_INT_UBX_Frame(GPS_Data);
+					
+					/* Return after each frame */
+					return i + 1;
+				}
+				break;
+			default:
+				GPS_UBX.State = 0;
+				break;
+		}
+	}
+	
+	/* Everything processed */
+	return count;
+}
+
+uint8_t TM_GPS_INT_UBX_Frame(TM_GPS_t* GPS_Data) {
+	uint8_t* p = GPS_UBX.Payload;
+	uint16_t len = GPS_UBX.Length > GPS_UBX_SIZE ? GPS_UBX_SIZE : GPS_UBX.Length;
+#if !defined(GPS_DISABLE_GPGSA) || !defined(GPS_DISABLE_GPGSV)
+	uint8_t i, sats, used = 0;
+#endif
+#if !defined(GPS_DISABLE_GPGGA) || !defined(GPS_DISABLE_GPRMC)
+	int32_t val;
+#endif
+	
+	/* Only navigation frames are used */
+	if (GPS_UBX.Class != GPS_UBX_CLASS_NAV) {
+		return 0;
+	}
+	
+	if (TM_GPS_INT_FlagsOk(GPS_Data)) {
+		/* Data were valid before, new data are coming, not new anymore */
+		TM_GPS_INT_ClearFlags(GPS_Data);
+		GPS_Data->Status = TM_GPS_Result_OldData;
+	}
+	
+	if (GPS_UBX.ID == GPS_UBX_NAV_PVT && len >= 92) {
+#ifndef GPS_DISABLE_GPGGA
+		/* Time, fraction of second can be negative */
+		TM_GPS_INT_Data.Time.Hours = p[8];
+		TM_GPS_INT_Data.Time.Minutes = p[9];
+		TM_GPS_INT_Data.Time.Seconds = p[10];
+		val = (int32_t)GPS_UBX_U4(p, 16);
+		TM_GPS_INT_Data.Time.Hundredths = val > 0 ? val / 10000000 : 0;
+		
+		/* Position in units of 1e-7 degrees, height above sea in mm */
+		TM_GPS_INT_Data.LongitudeE7 = (int32_t)GPS_UBX_U4(p, 24);
+		TM_GPS_INT_Data.LatitudeE7 = (int32_t)GPS_UBX_U4(p, 28);
+		TM_GPS_INT_Data.Longitude = (float)TM_GPS_INT_Data.LongitudeE7 * (float)0.0000001;
+		TM_GPS_INT_Data.Latitude = (float)TM_GPS_INT_Data.LatitudeE7 * (float)0.0000001;
+		TM_GPS_INT_Data.Altitude = (float)(int32_t)GPS_UBX_U4(p, 36) * (float)0.001;
+		
+		/* Fix as in GPGGA, 0 = invalid, 1 = GPS fix, 2 = DGPS fix */
+		TM_GPS_INT_Data.Fix = (p[21] & 0x01) ? ((p[21] & 0x02) ? 2 : 1) : 0;
+		TM_GPS_INT_Data.Satellites = p[23];
+		
+		/* Set flags */
+		TM_GPS_INT_SetFlag(GPS_FLAG_TIME | GPS_FLAG_LATITUDE | GPS_FLAG_NS | GPS_FLAG_LONGITUDE | GPS_FLAG_EW | GPS_FLAG_FIX | GPS_FLAG_SATS | GPS_FLAG_ALTITUDE);
+#endif
+#ifndef GPS_DISABLE_GPRMC
+		/* Date */
+		TM_GPS_INT_Data.Date.Year = GPS_UBX_U2(p, 4) % 100;
+		TM_GPS_INT_Data.Date.Month = p[6];
+		TM_GPS_INT_Data.Date.Date = p[7];
+		
+		/* Ground speed from mm/s to knots, heading in units of 1e-5 degrees */
+		val = (int32_t)GPS_UBX_U4(p, 60);
+		TM_GPS_INT_Data.SpeedE3 = val > 0 ? (uint32_t)(((uint64_t)val * 127392 + 32768) >> 16) : 0;
+		TM_GPS_INT_Data.Speed = (float)val * (float)0.00194384;
+		val = (int32_t)GPS_UBX_U4(p, 64);
+		TM_GPS_INT_Data.Direction = (float)val * (float)0.00001;
+		TM_GPS_INT_Data.Validity = p[21] & 0x01;
+		
+		/* Set flags */
+		TM_GPS_INT_SetFlag(GPS_FLAG_VALIDITY | GPS_FLAG_SPEED | GPS_FLAG_DIRECTION | GPS_FLAG_DATE);
+#endif
+#ifndef GPS_DISABLE_GPGSA
+		/* Fix mode as in GPGSA, 1 = fix not available, 2 = 2D, 3 = 3D */
+		TM_GPS_INT_Data.FixMode = p[20] == 2 ? 2 : ((p[20] == 3 || p[20] == 4) ? 3 : 1);
+		TM_GPS_INT_Data.PDOP = (float)GPS_UBX_U2(p, 76) * (float)0.01;
+		
+		/* Set flags */
+		TM_GPS_INT_SetFlag(GPS_FLAG_FIXMODE | GPS_FLAG_PDOP);
+#endif
+	}
+#ifndef GPS_DISABLE_GPGSA
+	if (GPS_UBX.ID == GPS_UBX_NAV_DOP && len >= 18) {
+		/* Dilution of precision in units of 0.01 */
+		TM_GPS_INT_Data.PDOP = (float)GPS_UBX_U2(p, 6) * (float)0.01;
+		TM_GPS_INT_Data.VDOP = (float)GPS_UBX_U2(p, 10) * (float)0.01;
+		TM_GPS_INT_Data.HDOP = (float)GPS_UBX_U2(p, 12) * (float)0.01;
+		
+		/* Set flags */
+		TM_GPS_INT_SetFlag(GPS_FLAG_PDOP | GPS_FLAG_VDOP | GPS_FLAG_HDOP);
+	}
+#endif
+#if !defined(GPS_DISABLE_GPGSA) || !defined(GPS_DISABLE_GPGSV)
+	if (GPS_UBX.ID == GPS_UBX_NAV_SAT && len >= 8) {
+		/* Number of satellites, only stored part is used */
+		sats = p[5];
+		if (sats > (len - 8) / 12) {
+			sats = (len - 8) / 12;
+		}
+		
+		/* 12 bytes for each satellite after 8 bytes header */
+		for (i = 0, p += 8; i < sats; i++, p += 12) {
+#ifndef GPS_DISABLE_GPGSV
+			if (i < GPS_MAX_SATS_IN_VIEW) {
+				TM_GPS_INT_Data.SatDesc[i].ID = p[1];
+				TM_GPS_INT_Data.SatDesc[i].SNR = p[2];
+				TM_GPS_INT_Data.SatDesc[i].Elevation = (int8_t)p[3] > 0 ? p[3] : 0;
+				TM_GPS_INT_Data.SatDesc[i].Azimuth = GPS_UBX_U2(p, 4);
+			}
+#endif
+#ifndef GPS_DISABLE_GPGSA
+			/* Satellite used in navigation */
+			if ((p[8] & 0x08) && used < 12) {
+				TM_GPS_INT_Data.SatelliteIDs[used++] = p[1];
+			}
+#endif
+		}
+		
+#ifndef GPS_DISABLE_GPGSV
+		TM_GPS_INT_Data.SatellitesInView = GPS_UBX.Payload[5];
+		TM_GPS_INT_SetFlag(GPS_FLAG_SATSINVIEW | GPS_FLAG_SATSDESC);
+#endif
+#ifndef GPS_DISABLE_GPGSA
+		/* Clear unused IDs */
+		while (used < 12) {
+			TM_GPS_INT_Data.SatelliteIDs[used++] = 0;
+		}
+		TM_GPS_INT_SetFlag(GPS_FLAG_SATS1_12);
+#endif
+	}
+#endif
+	
+	/* Check if all data are available */
+	return TM_GPS_INT_Return(GPS_Data) == TM_GPS_Result_NewData;
+}
+
+void TM_GPS_INT_UBX_Send(uint8_t Class, uint8_t ID, uint8_t* data, uint16_t count) {
+	uint8_t header[6], ck[2] = {0, 0};
+	uint16_t i;
+	
+	/* Header */
+	header[0] = GPS_UBX_SYNC1;
+	header[1] = GPS_UBX_SYNC2;
+	header[2] = Class;
+	header[3] = ID;
+	header[4] = count & 0xFF;
+	header[5] = count >> 8;
+	
+	/* Checksum from class to end of payload */
+	for (i = 2; i < 6; i++) {
+		ck[0] += header[i];
+		ck[1] += ck[0];
+	}
+	for (i = 0; i < count; i++) {
+		ck[0] += data[i];
+		ck[1] += ck[0];
+	}
+	
+	/* Send frame */
+	GPS_USART_SEND(header, 6);
+	GPS_USART_SEND(data, count);
+	GPS_USART_SEND(ck, 2);
+}
+#endif
+
+uint8_t TM_GPS_INT_Sentence(TM_GPS_t* GPS_Data) {
+	char* Terms[GPS_MAX_TERMS];
+	char *s, *p;
+	uint8_t crc = 0, count, i;
+	uint32_t key;
+	const TM_GPS_INT_Statement_t* st;
+	TM_GPS_Custom_t* c;
+	
+	/* Statement starts with last $ character in line */
+	s = strrchr(GPS_Sentence, '$');
+	if (s == NULL) {
+		return 0;
+	}
+	
+	/* Calculate checksum between $ and * */
+	for (p = s + 1; *p && *p != '*'; p++) {
+		crc ^= *p;
+	}
+	
+	/* Check checksum first, nothing is parsed from wrong statement */
+	if (*p != '*' || !p[1] || !p[2] || crc != (TM_GPS_INT_Hex2Dec(p[1]) << 4 | TM_GPS_INT_Hex2Dec(p[2]))) {
+		return 0;
+	}
+	*p = 0;
+	
+	/* Split terms in place, term pointers point to statement buffer */
+	count = 0;
+	Terms[count++] = s;
+	for (p = s; *p; p++) {
+		if (*p == ',') {
+			*p = 0;
+			if (count < GPS_MAX_TERMS) {
+				Terms[count++] = p + 1;
+			}
+		}
+	}
+	
+	if (TM_GPS_INT_FlagsOk(GPS_Data)) {
+		/* Data were valid before, new data are coming, not new anymore */
+		TM_GPS_INT_ClearFlags(GPS_Data);
+		/* Data were "new" on last call, now are only "Old data", no NEW data */
+		GPS_Data->Status = TM_GPS_Result_OldData;
+	}
+	
+	/* Find statement in table and parse it */
+	key = TM_GPS_INT_Key(s + 1);
+	for (st = GPS_Statements; st->Handler; st++) {
+		if (st->Key == key) {
+			st->Handler(Terms, count);
+			break;
+		}
+	}
+	
+	/* Check custom terms one by one */
+	for (i = 0; i < GPS_Data->CustomStatementsCount; i++) {
+		c = GPS_Data->CustomStatements[i];
+		
+		/* Term is inside current statement */
+		if (c->TermNumber < count && strcmp(Terms[0], c->Statement) == 0) {
+			/* Copy string value */
+			strncpy(c->Value, Terms[c->TermNumber], sizeof(c->Value) - 1);
+			c->Value[sizeof(c->Value) - 1] = 0;
+			
+			/* Set updated flag */
+			c->Updated = 1;
+		}
+	}
+	
+	/* Check if all data are available */
+	return TM_GPS_INT_Return(GPS_Data) == TM_GPS_Result_NewData;
+}
+
+uint32_t TM_GPS_INT_Key(const char* name) {
+	uint32_t key = 0;
+	uint8_t i;
+	
+	/* Statement name has 5 upper case characters */
+	for (i = 0; i < 5; i++) {
+		if (name[i] < 'A' || name[i] > 'Z') {
+			return 0;
+		}
+		key = key << 5 | (name[i] - 'A' + 1);
+	}
+	
+	/* Name must end here */
+	return name[5] ? 0 : key;
+}
+
+int32_t TM_GPS_INT_ParseFixed(const char* str, uint8_t decimals) {
+	int32_t val = 0;
+	uint8_t neg = 0;
+	
+	/* Check sign */
+	if (*str == '-') {
+		neg = 1;
+		str++;
+	}
+	
+	/* Integer part */
+	while (GPS_IS_DIGIT(*str)) {
+		val = val * 10 + GPS_C2N(*str++);
+	}
+	
+	/* Decimal part, extra decimals are ignored */
+	if (*str == '.') {
+		str++;
+		while (decimals && GPS_IS_DIGIT(*str)) {
+			val = val * 10 + GPS_C2N(*str++);
+			decimals--;
+		}
+	}
+	
+	/* Fill missing decimals */
+	while (decimals--) {
+		val *= 10;
+	}
+	
+	return neg ? -val : val;
+}
+
+int32_t TM_GPS_INT_ParseCoordinate(const char* str) {
+	/* Format is dddmm.mmmmm, get it with 5 decimals */
+	int32_t val = TM_GPS_INT_ParseFixed(str, 5);
+	
+	/* Degrees and minutes in units of 0.00001 minute to 1e-7 degrees, rounded */
+	return (val / 10000000) * 10000000 + ((val % 10000000) * 10 + 3) / 6;
+}
+
+#ifndef GPS_DISABLE_GPGGA
+static void TM_GPS_INT_GPGGA(char** Terms, uint8_t Count) {
+	int32_t val;
+	
+	/* Check for all terms */
+	if (Count < 10) {
+		return;
+	}
+	
+	/* Time, hhmmss.ss */
+	if (*Terms[1]) {
+		val = TM_GPS_INT_ParseFixed(Terms[1], 2);
+		TM_GPS_INT_Data.Time.Hundredths = val % 100;
+		TM_GPS_INT_Data.Time.Seconds = (val / 100) % 100;
+		TM_GPS_INT_Data.Time.Minutes = (val / 10000) % 100;
+		TM_GPS_INT_Data.Time.Hours = (val / 1000000) % 100;
+	}
+	
+	/* Latitude, south has negative coordinate */
+	if (*Terms[2]) {
+		TM_GPS_INT_Data.LatitudeE7 = TM_GPS_INT_ParseCoordinate(Terms[2]);
+		if (Terms[3][0] == 'S') {
+			TM_GPS_INT_Data.LatitudeE7 = -TM_GPS_INT_Data.LatitudeE7;
+		}
+		TM_GPS_INT_Data.Latitude = (float)TM_GPS_INT_Data.LatitudeE7 * (float)0.0000001;
+	}
+	
+	/* Longitude, west has negative coordinate */
+	if (*Terms[4]) {
+		TM_GPS_INT_Data.LongitudeE7 = TM_GPS_INT_ParseCoordinate(Terms[4]);
+		if (Terms[5][0] == 'W') {
+			TM_GPS_INT_Data.LongitudeE7 = -TM_GPS_INT_Data.LongitudeE7;
+		}
+		TM_GPS_INT_Data.Longitude = (float)TM_GPS_INT_Data.LongitudeE7 * (float)0.0000001;
+	}
+	
+	/* GPS fix and satellites in use */
+	if (*Terms[6]) {
+		TM_GPS_INT_Data.Fix = TM_GPS_INT_ParseFixed(Terms[6], 0);
+	}
+	if (*Terms[7]) {
+		TM_GPS_INT_Data.Satellites = TM_GPS_INT_ParseFixed(Terms[7], 0);
+	}
+	
+	/* Altitude above sea */
+	if (*Terms[9]) {
+		TM_GPS_INT_Data.Altitude = (float)TM_GPS_INT_ParseFixed(Terms[9], 3) * (float)0.001;
+	}
+	
+	/* Set flags */
+	TM_GPS_INT_SetFlag(GPS_FLAG_TIME | GPS_FLAG_LATITUDE | GPS_FLAG_NS | GPS_FLAG_LONGITUDE | GPS_FLAG_EW | GPS_FLAG_FIX | GPS_FLAG_SATS | GPS_FLAG_ALTITUDE);
+}
+#endif
+
+#ifndef GPS_DISABLE_GPRMC
+static void TM_GPS_INT_GPRMC(char** Terms, uint8_t Count) {
+	int32_t val;
+	
+	/* Check for all terms */
+	if (Count < 10) {
+		return;
+	}
+	
+	/* GPS valid status */
+	TM_GPS_INT_Data.Validity = Terms[2][0] == 'A';
+	
+	/* Speed in knots */
+	if (*Terms[7]) {
+		TM_GPS_INT_Data.SpeedE3 = TM_GPS_INT_ParseFixed(Terms[7], 3);
+		TM_GPS_INT_Data.Speed = (float)TM_GPS_INT_Data.SpeedE3 * (float)0.001;
+	}
+	
+	/* Course over ground */
+	if (*Terms[8]) {
+		TM_GPS_INT_Data.Direction = (float)TM_GPS_INT_ParseFixed(Terms[8], 3) * (float)0.001;
+	}
+	
+	/* Date, ddmmyy */
+	if (*Terms[9]) {
+		val = TM_GPS_INT_ParseFixed(Terms[9], 0);
+		TM_GPS_INT_Data.Date.Year = val % 100;
+		TM_GPS_INT_Data.Date.Month = (val / 100) % 100;
+		TM_GPS_INT_Data.Date.Date = (val / 10000) % 100;
+	}
+	
+	/* Set flags */
+	TM_GPS_INT_SetFlag(GPS_FLAG_VALIDITY | GPS_FLAG_SPEED | GPS_FLAG_DIRECTION | GPS_FLAG_DATE);
+}
+#endif
+
+#ifndef GPS_DISABLE_GPGSA
+static void TM_GPS_INT_GPGSA(char** Terms, uint8_t Count) {
+	uint8_t i;
+	
+	/* Check for all terms */
+	if (Count < 18) {
+		return;
+	}
+	
+	/* Fix mode */
+	if (*Terms[2]) {
+		TM_GPS_INT_Data.FixMode = TM_GPS_INT_ParseFixed(Terms[2], 0);
+	}
+	
+	/* Satellites in use, empty terms are not used */
+	for (i = 0; i < 12; i++) {
+		TM_GPS_INT_Data.SatelliteIDs[i] = TM_GPS_INT_ParseFixed(Terms[3 + i], 0);
+	}
+	
+	/* Dilution of precision */
+	if (*Terms[15]) {
+		TM_GPS_INT_Data.PDOP = (float)TM_GPS_INT_ParseFixed(Terms[15], 3) * (float)0.001;
+	}
+	if (*Terms[16]) {
+		TM_GPS_INT_Data.HDOP = (float)TM_GPS_INT_ParseFixed(Terms[16], 3) * (float)0.001;
+	}
+	if (*Terms[17]) {
+		TM_GPS_INT_Data.VDOP = (float)TM_GPS_INT_ParseFixed(Terms[17], 3) * (float)0.001;
+	}
+	
+	/* Set flags */
+	TM_GPS_INT_SetFlag(GPS_FLAG_FIXMODE | GPS_FLAG_SATS1_12 | GPS_FLAG_PDOP | GPS_FLAG_HDOP | GPS_FLAG_VDOP);
+}
+#endif
+
+#ifndef GPS_DISABLE_GPGSV
+static void TM_GPS_INT_GPGSV(char** Terms, uint8_t Count) {
+	uint8_t total, number, i, sat;
+	
+	/* Check for header terms */
+	if (Count < 4) {
+		return;
+	}
+	
+	/* Number of statements, current statement and satellites in view */
+	total = TM_GPS_INT_ParseFixed(Terms[1], 0);
+	number = TM_GPS_INT_ParseFixed(Terms[2], 0);
+	TM_GPS_INT_Data.SatellitesInView = TM_GPS_INT_ParseFixed(Terms[3], 0);
+	
+	/* Up to 4 satellites in each statement, 4 terms for each */
+	for (i = 4; number > 0 && i + 3 < Count; i += 4) {
+		sat = (number - 1) * 4 + (i - 4) / 4;
+		
+		/* If still memory available */
+		if (sat < GPS_MAX_SATS_IN_VIEW) {
+			TM_GPS_INT_Data.SatDesc[sat].ID = TM_GPS_INT_ParseFixed(Terms[i], 0);
+			TM_GPS_INT_Data.SatDesc[sat].Elevation = TM_GPS_INT_ParseFixed(Terms[i + 1], 0);
+			TM_GPS_INT_Data.SatDesc[sat].Azimuth = TM_GPS_INT_ParseFixed(Terms[i + 2], 0);
+			TM_GPS_INT_Data.SatDesc[sat].SNR = TM_GPS_INT_ParseFixed(Terms[i + 3], 0);
+		}
+	}
+	
+	/* Set flags */
+	TM_GPS_INT_SetFlag(GPS_FLAG_SATSINVIEW);
+	if (number == total) {
+		/* Last statement, all satellites described */
+		TM_GPS_INT_SetFlag(GPS_FLAG_SATSDESC);
+	}
+}
+#endif
+
+TM_GPS_Result_t TM_GPS_INT_Return(TM_GPS_t* GPS_Data) {
+	uint8_t i;
+	if (TM_GPS_INT_FlagsOk(GPS_Data)) {
+		/* Clear first time */
+		TM_GPS_FirstTime = 0;
 		
 		/* Set data */
 #ifndef GPS_DISABLE_GPGGA
 		GPS_Data->Latitude = TM_GPS_INT_Data.Latitude;
 		GPS_Data->Longitude = TM_GPS_INT_Data.Longitude;
+		GPS_Data->LatitudeE7 = TM_GPS_INT_Data.LatitudeE7;
+		GPS_Data->LongitudeE7 = TM_GPS_INT_Data.LongitudeE7;
 		GPS_Data->Satellites = TM_GPS_INT_Data.Satellites;
 		GPS_Data->Fix = TM_GPS_INT_Data.Fix;
 		GPS_Data->Altitude = TM_GPS_INT_Data.Altitude;
@@ -648,6 +1453,7 @@ TM_GPS_Result_t TM_GPS_INT_Return(TM_GPS_t* GPS_Data) {
 #endif
 #ifndef GPS_DISABLE_GPRMC
 		GPS_Data->Speed = TM_GPS_INT_Data.Speed;
+		GPS_Data->SpeedE3 = TM_GPS_INT_Data.SpeedE3;
 		GPS_Data->Date = TM_GPS_INT_Data.Date;
 		GPS_Data->Validity = TM_GPS_INT_Data.Validity;
 		GPS_Data->Direction = TM_GPS_INT_Data.Direction;
@@ -681,31 +1487,95 @@ TM_GPS_Result_t TM_GPS_INT_Return(TM_GPS_t* GPS_Data) {
 	TM_GPS_INT_ReturnWithStatus(GPS_Data, TM_GPS_Result_OldData);
 }
 
-uint8_t TM_GPS_INT_StringStartsWith(char* string, const char* str) {
-	while (*str) {
-		if (*str++ != *string++) {
-			return 0;
-		}
+static uint32_t TM_GPS_INT_Cosine(int32_t Latitude) {
+	uint32_t deg, frac;
+	
+	/* Cosine is even */
+	if (Latitude < 0) {
+		Latitude = -Latitude;
 	}
-	return 1;
+	
+	/* Table index and fraction in 1e-4 degrees */
+	deg = (uint32_t)Latitude / 10000000;
+	frac = ((uint32_t)Latitude % 10000000) / 1000;
+	if (deg >= 90) {
+		return 0;
+	}
+	
+	/* Linear interpolation between table entries, Q15 format */
+	return GPS_Cosine[deg] - (((uint32_t)(GPS_Cosine[deg] - GPS_Cosine[deg + 1]) * frac + 5000) / 10000);
 }
 
-uint8_t TM_GPS_INT_Atoi(char* str, uint32_t* val) {
-	uint8_t count = 0;
-	*val = 0;
-	while (GPS_IS_DIGIT(*str)) {
-		*val = *val * 10 + GPS_C2N(*str++);
-		count++;
+static uint32_t TM_GPS_INT_Sine(uint32_t x) {
+	uint32_t x2 = GPS_Q30_MUL(x, x), t;
+	
+	/* Taylor series to x^11 in Horner form for 0 <= x <= pi/2 in Q30 format, all partial results are between 0 and 1 */
+	t = GPS_Q30_ONE - x2 / 110;
+	t = GPS_Q30_ONE - GPS_Q30_MUL(x2 / 72, t);
+	t = GPS_Q30_ONE - GPS_Q30_MUL(x2 / 42, t);
+	t = GPS_Q30_ONE - GPS_Q30_MUL(x2 / 20, t);
+	t = GPS_Q30_ONE - GPS_Q30_MUL(x2 / 6, t);
+	
+	return GPS_Q30_MUL(x, t);
+}
+
+static uint32_t TM_GPS_INT_Asin(uint32_t x) {
+	uint32_t x2, t;
+	uint8_t reduced = 0;
+	
+	/* Reduce argument above 0.5 with asin(x) = pi/2 - 2 * asin(sqrt((1 - x) / 2)) */
+	if (x > GPS_Q30_ONE / 2) {
+		x = TM_GPS_INT_Sqrt((uint64_t)(GPS_Q30_ONE - x) << 29);
+		reduced = 1;
 	}
-	return count;
+	
+	/* Taylor series to x^11 in Horner form for 0 <= x <= 0.5 in Q30 format */
+	x2 = GPS_Q30_MUL(x, x);
+	t = GPS_Q30(63.0 / 2816);
+	t = GPS_Q30(35.0 / 1152) + GPS_Q30_MUL(x2, t);
+	t = GPS_Q30(5.0 / 112) + GPS_Q30_MUL(x2, t);
+	t = GPS_Q30(3.0 / 40) + GPS_Q30_MUL(x2, t);
+	t = GPS_Q30(1.0 / 6) + GPS_Q30_MUL(x2, t);
+	t = GPS_Q30_ONE + GPS_Q30_MUL(x2, t);
+	x = GPS_Q30_MUL(x, t);
+	
+	if (reduced) {
+		x = GPS_Q30(1.57079632679490) - 2 * x;
+	}
+	return x;
+}
+
+static uint32_t TM_GPS_INT_Sqrt(uint64_t x) {
+	uint64_t res = 0, bit = (uint64_t)1 << 62;
+	
+	/* Digit by digit method, 2 bits of input per result bit */
+	while (bit > x) {
+		bit >>= 2;
+	}
+	while (bit) {
+		if (x >= res + bit) {
+			x -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	
+	return (uint32_t)res;
 }
 
-uint32_t TM_GPS_INT_Pow(uint8_t x, uint8_t y) {
-	uint32_t ret = 1;
-	while (y--) {
-		ret *= x;
+static int32_t TM_GPS_INT_DeltaLongitude(int32_t Longitude1, int32_t Longitude2) {
+	int64_t d = (int64_t)Longitude2 - Longitude1;
+	
+	/* Shorter way around the earth, difference can not overflow after that */
+	if (d > 1800000000) {
+		d -= 3600000000LL;
+	} else if (d < -1800000000) {
+		d += 3600000000LL;
 	}
-	return ret;
+	
+	return (int32_t)d;
 }
 
 uint8_t TM_GPS_INT_Hex2Dec(char c) {
@@ -753,102 +1623,151 @@ void TM_GPS_INT_ClearFlags(TM_GPS_t* GPS_Data) {
 	}
 }
 
-void TM_GPS_INT_CheckEmpty(TM_GPS_t* GPS_Data) {
-	if (GPS_Term_Pos == 1) {
-		switch (GPS_CONCAT(TM_GPS_Statement, GPS_Term_Number)) {
-#ifndef GPS_DISABLE_GPGGA
-			case GPS_POS_LATITUDE:	/* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_LATITUDE);
-				break;
-			case GPS_POS_NS: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_NS);
-				break;
-			case GPS_POS_LONGITUDE: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_LONGITUDE);
-				break;
-			case GPS_POS_EW: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_EW);
-				break;
-			case GPS_POS_SATS: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_SATS);
-				break;
-			case GPS_POS_FIX: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_FIX);
-				break;
-			case GPS_POS_ALTITUDE: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_ALTITUDE);
-				break;
-			case GPS_POS_TIME: /* GPGGA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_TIME);
-				break;
-#endif
-#ifndef GPS_DISABLE_GPRMC
-			case GPS_POS_SPEED:	/* GPRMC */	
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_SPEED);
-				break;
-			case GPS_POS_DATE: /* GPRMC */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_DATE);
-				break;
-			case GPS_POS_VALIDITY: /* GPRMC */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_VALIDITY);
-				break;
-			case GPS_POS_DIRECTION: /* GPRMC */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_DIRECTION);
-				break;
-#endif
-#ifndef GPS_DISABLE_GPGSA
-			case GPS_POS_HDOP: /* GPGSA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_HDOP);
-				break;
-			case GPS_POS_PDOP: /* GPGSA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_PDOP);
-				break;
-			case GPS_POS_VDOP: /* GPGSA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_VDOP);
-				break;
-			case GPS_POS_FIXMODE: /* GPGSA */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_FIXMODE);
-				break;
-			case GPS_POS_SAT1:
-			case GPS_POS_SAT2:
-			case GPS_POS_SAT3:
-			case GPS_POS_SAT4:
-			case GPS_POS_SAT5:
-			case GPS_POS_SAT6:
-			case GPS_POS_SAT7:
-			case GPS_POS_SAT8:
-			case GPS_POS_SAT9:
-			case GPS_POS_SAT10:
-			case GPS_POS_SAT11:
-			case GPS_POS_SAT12:
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_SATS1_12);
-				break;
-#endif
-#ifndef GPS_DISABLE_GPGSV
-			case GPS_POS_SATSINVIEW: /* GPGSV */
-				/* Set flag */
-				TM_GPS_INT_SetFlag(GPS_FLAG_SATSINVIEW);
-				break;
-#endif
-			default: 
-				break;
+#if GPS_USE_TRACK
+static void TM_GPS_INT_TrackNextBlock(TM_GPS_Track_t* Track) {
+	uint8_t next = (Track->Head + 1) % GPS_TRACK_BLOCKS;
+	
+	/* Oldest block is overwritten, its fixes are lost when not written to file */
+	if (Track->Count == GPS_TRACK_BLOCKS) {
+		if (Track->Pending == GPS_TRACK_BLOCKS - 1) {
+			Track->Lost += TM_GPS_INT_TrackFixes(Track, next);
+			Track->Pending--;
 		}
+	} else {
+		Track->Count++;
 	}
+	
+	/* Current block is completed */
+	Track->Pending++;
+	Track->Head = next;
+	Track->Used = 0;
+}
+
+static uint16_t TM_GPS_INT_TrackFixes(TM_GPS_Track_t* Track, uint8_t block) {
+	/* Current block may be empty */
+	if (block == Track->Head && !Track->Used) {
+		return 0;
+	}
+	return Track->Blocks[block][2] | Track->Blocks[block][3] << 8;
+}
+
+static uint8_t TM_GPS_INT_TrackPut(uint8_t* data, int32_t value) {
+	uint32_t zigzag;
+	uint8_t len = 0;
+	
+	/* Zigzag encoding, small negative numbers become small positive numbers */
+	zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	
+	/* 7 bits in each byte, MSB is set when more bytes follow */
+	while (zigzag >= 0x80) {
+		data[len++] = (zigzag & 0x7F) | 0x80;
+		zigzag >>= 7;
+	}
+	data[len++] = zigzag;
+	
+	/* Return number of bytes */
+	return len;
+}
+
+static int32_t TM_GPS_INT_TrackGet(const uint8_t** data) {
+	uint32_t zigzag = 0;
+	uint8_t shift = 0, c;
+	
+	/* Read 7 bits from each byte */
+	do {
+		c = *(*data)++;
+		zigzag |= (uint32_t)(c & 0x7F) << shift;
+		shift += 7;
+	} while ((c & 0x80) && shift < 35);
+	
+	/* Decode zigzag */
+	return (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
 }
+
+static void TM_GPS_INT_TrackSet32(uint8_t* data, uint32_t value) {
+	/* Little endian */
+	data[0] = value & 0xFF;
+	data[1] = (value >> 8) & 0xFF;
+	data[2] = (value >> 16) & 0xFF;
+	data[3] = (value >> 24) & 0xFF;
+}
+
+static uint32_t TM_GPS_INT_TrackGet32(const uint8_t* data) {
+	/* Little endian */
+	return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+static void TM_GPS_INT_TrackOpen(TM_GPS_INT_TrackReader_t* Reader, const uint8_t* Block) {
+	/* Number of fixes and first fix from header */
+	Reader->Block = Block;
+	Reader->Remaining = Block[2] | Block[3] << 8;
+	Reader->First = 1;
+	Reader->Ptr = &Block[GPS_TRACK_HEADER_SIZE];
+}
+
+static uint8_t TM_GPS_INT_TrackRead(TM_GPS_INT_TrackReader_t* Reader) {
+	int32_t t;
+	
+	/* Check for fixes and end of block */
+	if (!Reader->Remaining || Reader->Ptr >= Reader->Block + GPS_TRACK_BLOCK_SIZE) {
+		return 0;
+	}
+	Reader->Remaining--;
+	
+	if (Reader->First) {
+		/* First fix from header */
+		Reader->First = 0;
+		Reader->Fix.Time = TM_GPS_INT_TrackGet32(&Reader->Block[4]);
+		Reader->Fix.Hundredths = Reader->Block[8];
+		Reader->Fix.Latitude = (int32_t)TM_GPS_INT_TrackGet32(&Reader->Block[9]);
+		Reader->Fix.Longitude = (int32_t)TM_GPS_INT_TrackGet32(&Reader->Block[13]);
+		Reader->Fix.Altitude = (int32_t)TM_GPS_INT_TrackGet32(&Reader->Block[17]);
+		Reader->DeltaLatitude = 0;
+		Reader->DeltaLongitude = 0;
+		return 1;
+	}
+	
+	/* Time difference in hundredths */
+	t = (int32_t)Reader->Fix.Hundredths + TM_GPS_INT_TrackGet(&Reader->Ptr);
+	Reader->Fix.Time += t / 100;
+	t %= 100;
+	if (t < 0) {
+		t += 100;
+		Reader->Fix.Time--;
+	}
+	Reader->Fix.Hundredths = t;
+	
+	/* Position differences */
+	Reader->DeltaLatitude = TM_GPS_INT_TrackGet(&Reader->Ptr);
+	Reader->DeltaLongitude = TM_GPS_INT_TrackGet(&Reader->Ptr);
+	Reader->Fix.Latitude += Reader->DeltaLatitude;
+	Reader->Fix.Longitude += Reader->DeltaLongitude;
+	Reader->Fix.Altitude += TM_GPS_INT_TrackGet(&Reader->Ptr);
+	
+	/* Return OK */
+	return 1;
+}
+
+#ifndef GPS_DISABLE_GPRMC
+static uint32_t TM_GPS_INT_TrackDays(TM_GPS_Date_t* Date) {
+	static const uint16_t days[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+	uint32_t d;
+	
+	/* Check date */
+	if (Date->Month < 1 || Date->Month > 12 || Date->Date < 1) {
+		return 0;
+	}
+	
+	/* Days in previous years, every 4th year is leap year from 2000 to 2099 */
+	d = (uint32_t)Date->Year * 365 + (Date->Year + 3) / 4;
+	
+	/* Days in previous months and in current month */
+	d += days[Date->Month - 1] + Date->Date - 1;
+	if (Date->Month > 2 && (Date->Year % 4) == 0) {
+		d++;
+	}
+	
+	return d;
+}
+#endif
+#endif
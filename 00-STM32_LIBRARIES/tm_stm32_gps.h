@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.7
  * @ide     Keil uVision
  * @license MIT
  * @brief   GPS NMEA standard data parser for STM32Fxxx devices
@@ -34,7 +34,7 @@
 \endverbatim
  */
 #ifndef TM_GPS_H
-#define TM_GPS_H 100
+#define TM_GPS_H 170
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -141,6 +141,154 @@ extern C {
  * in which direction (bearing) he has to move according to the north. 
  * Then, you just have to compare your calculated bearing with actual direction provided from GPS.
  * And you will know, if he needs to go more left, right, etc. You can tune PID then according to values.
+ *
+ * \par Fixed point position
+ *
+ * Latitude and longitude are also available in units of 1e-7 degrees in @ref TM_GPS_t structure,
+ * speed in units of 0.001 knots. They are parsed from statements directly, without float conversion.
+ *
+ * On devices without FPU (STM32F0xx) use fixed point functions, which use only integer math:
+ *  - @ref TM_GPS_DistanceFast: Equirectangular approximation, for distances up to few 10 kilometers
+ *  - @ref TM_GPS_DistanceHaversine: Great circle distance for any 2 points on earth
+ *  - @ref TM_GPS_ConvertSpeedFixed: Converts speed in 0.001 knots to other unit in 0.001 units
+ *  - @ref TM_GPS_ConvertFixed: Splits fixed point number to integer and decimal part for printing
+ *
+\code
+TM_GPS_Float_t Lat;
+uint32_t distance;
+
+//Distance from home in centimeters
+distance = TM_GPS_DistanceFast(HomeLatitude, HomeLongitude, GPS_Data.LatitudeE7, GPS_Data.LongitudeE7);
+
+//Latitude with 6 decimals
+TM_GPS_ConvertFixed(GPS_Data.LatitudeE7, 7, &Lat, 6);
+printf("Lat: %ld.%06lu\n", Lat.Integer, Lat.Decimal);
+\endcode
+ *
+ * \par Parser
+ *
+ * Data are read from USART buffer memory directly, without reading character by character.
+ * Library waits for complete statement, ended with new line character and validates checksum first.
+ * Statements with wrong checksum are dropped and nothing is parsed from them.
+ *
+ * Valid statement is split to terms in place and statement name is looked up in table of supported statements,
+ * so each term is parsed only once, with fixed point number conversion.
+ *
+ * Maximal statement length is 82 characters by NMEA standard. If your module outputs longer statements,
+ * increase buffer size in defines.h file:
+ *
+\code
+//Maximal statement length, including $ and new line characters
+#define GPS_SENTENCE_SIZE       100
+\endcode
+ *
+ * If you use custom GPS_USART_BUFFER_EMPTY and GPS_USART_BUFFER_GET_CHAR macros, characters are read one by one from them.
+ *
+ * \par UBX binary protocol
+ *
+ * u-blox receivers can output binary UBX frames instead of NMEA text. Frames are about 4 times smaller
+ * and numbers are already in binary format, so higher position rates are possible.
+ *
+ * Library decodes UBX frames alongside NMEA statements and fills the same @ref TM_GPS_t fields:
+ *  - NAV-PVT: Time, date, latitude, longitude, altitude, fix, satellites in use, speed, direction, validity, PDOP and fix mode
+ *  - NAV-DOP: HDOP, VDOP and PDOP
+ *  - NAV-SAT: Satellites in view, description of each satellite and id's of satellites in use
+ *
+ * UBX decoder is disabled by default, to enable it, add line below in your defines.h file:
+ *
+\code
+//Enable UBX binary protocol decoder
+#define GPS_USE_UBX             1
+
+//Maximal stored UBX payload, longer NAV-SAT frames describe only first satellites
+#define GPS_UBX_SIZE            296
+\endcode
+ *
+ * Use @ref TM_GPS_UBX_Configure function to switch receiver to UBX output with new baudrate and measurement rate.
+ *
+ * \par PPS input
+ *
+ * NMEA time has jitter of tens of milliseconds. Most receivers output pulse per second (PPS) signal,
+ * which rising edge is aligned to start of GPS second within tens of nanoseconds.
+ *
+ * With PPS input enabled, pulse is captured on 32-bit timer running from APB1 timer clock without prescaler.
+ * On every pulse:
+ *  - MCU clock error is measured from timer ticks between pulses
+ *  - @ref TM_RTC timestamp is disciplined to pulse edge with @ref TM_RTC_TimestampDiscipline,
+ *    edge time is rounded to nearest second of timestamp
+ *  - RTC error is measured over GPS_PPS_RTC_PERIOD pulses and RTC smooth calibration is corrected in @ref TM_GPS_Update
+ *
+ * @note   Timestamp second is taken from RTC, so set RTC from GPS date and time before, error must be below half second
+ * @note   RTC_TIMESTAMP must be enabled in TM RTC library and RTC initialized before @ref TM_GPS_PPS_Init is called
+ *
+\code
+//Enable PPS input, default is TIM5 channel 1 on PA0
+#define GPS_PPS                 1
+
+//Use custom timer and pin, channel 1 of timer is always used
+#define GPS_PPS_TIM             TIM2
+#define GPS_PPS_TIM_CLK_ENABLE  __HAL_RCC_TIM2_CLK_ENABLE
+#define GPS_PPS_TIM_IRQ         TIM2_IRQn
+#define GPS_PPS_TIM_IRQ_HANDLER TIM2_IRQHandler
+#define GPS_PPS_PORT            GPIOA
+#define GPS_PPS_PIN             GPIO_PIN_15
+#define GPS_PPS_AF              GPIO_AF1_TIM2
+\endcode
+ *
+ * \par Track history
+ *
+ * @ref TM_GPS_t holds only latest fix. Track buffer keeps history of fixes in RAM with about 4 bytes per fix,
+ * instead of about 70 bytes when fix is logged as text line.
+ *
+ * Fixes are stored in fixed point format, latitude and longitude in 1e-6 degrees, altitude in decimeters and time in hundredths of second.
+ * Track is split to blocks of GPS_TRACK_BLOCK_SIZE bytes. First fix in block is stored as it is,
+ * next fixes are stored as differences to previous fix, each difference is zigzag and varint encoded,
+ * so small differences take only 1 byte. Each block can be decoded without other blocks.
+ *
+ * Blocks make ring in RAM, oldest block is overwritten when ring is full.
+ * @ref TM_GPS_TrackGetLast and @ref TM_GPS_TrackDistanceSince work on encoded blocks directly,
+ * distance is summed from differences without converting fixes back to float.
+ *
+ * With FatFs, completed blocks are written to file with @ref TM_GPS_TrackFlush.
+ * Block size is the same as sector size, so FatFs writes them to card without copy to its sector buffer.
+ * Read blocks from file again and decode them with @ref TM_GPS_TrackDecode.
+ *
+\code
+//Enable track buffer
+#define GPS_USE_TRACK           1
+
+//Block size and number of blocks in RAM
+#define GPS_TRACK_BLOCK_SIZE    512
+#define GPS_TRACK_BLOCKS        4
+
+//Disable FatFs support
+#define GPS_TRACK_USE_FATFS     0
+\endcode
+ *
+ * Example:
+ *
+\code
+TM_GPS_Track_t Track;
+TM_GPS_TrackFix_t Last[10];
+FIL fil;
+
+TM_GPS_TrackInit(&Track);
+f_open(&fil, "track.bin", FA_OPEN_APPEND | FA_WRITE);
+
+while (1) {
+	if (TM_GPS_Update(&GPS_Data) == TM_GPS_Result_NewData && GPS_Data.Fix) {
+		//Save new fix
+		TM_GPS_TrackAdd(&Track, &GPS_Data);
+		
+		//Write completed blocks to card
+		TM_GPS_TrackFlush(&Track, &fil, 0);
+		
+		//Last 10 fixes and distance in last 5 minutes
+		count = TM_GPS_TrackGetLast(&Track, Last, 10);
+		distance = TM_GPS_TrackDistanceSince(&Track, Last[count - 1].Time - 300);
+	}
+}
+\endcode
  *
  * \par Custom GPS statements
  *
@@ -171,6 +319,41 @@ GPRMB_3_Pointer = TM_GPS_AddCustom(&GPS_Data, "$GPRMB", 3);
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - New parser, statements are read from USART buffer in blocks and checksum is checked before parsing
+  - Statements are found in lookup table and numbers parsed with fixed point conversion
+  - Custom statement value is limited to its buffer size
+  
+ Version 1.2
+  - October 14, 2026
+  - Added UBX binary protocol decoder for NAV-PVT, NAV-DOP and NAV-SAT frames
+  - Added TM_GPS_UBX_Configure function to switch receiver to UBX output
+  
+ Version 1.3
+  - October 14, 2026
+  - Custom statements are allocated with LIB_ALLOC_FUNC, TM POOL can be used with LIB_USE_POOL
+  
+ Version 1.4
+  - October 14, 2026
+  - Added PPS input, captured on 32-bit timer to measure MCU clock error
+  - PPS disciplines TM RTC timestamp and RTC smooth calibration
+  
+ Version 1.5
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
+  
+ Version 1.6
+  - October 14, 2026
+  - Added track buffer with delta and varint encoded fixes in RAM ring
+  - Added last fixes and distance queries on encoded track and flush to FatFs
+  
+ Version 1.7
+  - October 14, 2026
+  - Position is also stored in 1e-7 degrees and speed in 0.001 knots, parsed without float math
+  - Speed conversion factors are in lookup table, pace units are now divided by speed
+  - Added TM_GPS_ConvertSpeedFixed, TM_GPS_ConvertFixed and integer distance functions
 \endverbatim
  *
  * \par Dependencies
@@ -179,7 +362,10 @@ GPRMB_3_Pointer = TM_GPS_AddCustom(&GPS_Data, "$GPRMB", 3);
  - STM32Fxxx HAL
  - defines.h
  - TM USART
+ - TM BUFFER
  - TM GPIO
+ - TM RTC, when GPS_PPS is enabled
+ - FatFs, when GPS_USE_TRACK and GPS_TRACK_USE_FATFS are enabled
  - defines.h
  - math.h
 \endverbatim
@@ -205,6 +391,11 @@ GPRMB_3_Pointer = TM_GPS_AddCustom(&GPS_Data, "$GPRMB", 3);
 #define GPS_USART_PINSPACK          TM_USART_PinsPack_2
 #endif
 
+/* USART buffer for GPS, used directly when custom get character function is not used */
+#if !defined(GPS_USART_BUFFER) && !defined(GPS_USART_BUFFER_GET_CHAR)
+#define GPS_USART_BUFFER            TM_USART_GetBuffer(GPS_USART)
+#endif
+
 /* Checks if USART buffer for GPS is empty */
 #ifndef GPS_USART_BUFFER_EMPTY
 #define GPS_USART_BUFFER_EMPTY      TM_USART_BufferEmpty(GPS_USART)
@@ -225,6 +416,121 @@ GPRMB_3_Pointer = TM_GPS_AddCustom(&GPS_Data, "$GPRMB", 3);
 #define GPS_CUSTOM_NUMBER       10
 #endif
 
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
+/* Memory allocation function */
+#ifndef LIB_ALLOC_FUNC
+#define LIB_ALLOC_FUNC          malloc
+#endif
+
+/* Maximal NMEA statement length */
+#ifndef GPS_SENTENCE_SIZE
+#define GPS_SENTENCE_SIZE       84
+#endif
+
+/* Maximal number of terms in statement, including statement name */
+#ifndef GPS_MAX_TERMS
+#define GPS_MAX_TERMS           32
+#endif
+
+/* UBX binary protocol decoder */
+#ifndef GPS_USE_UBX
+#define GPS_USE_UBX             0
+#endif
+
+/* Maximal stored UBX payload size, NAV-SAT frame with 24 satellites */
+#ifndef GPS_UBX_SIZE
+#define GPS_UBX_SIZE            (8 + 12 * GPS_MAX_SATS_IN_VIEW)
+#endif
+
+/* PPS input */
+#ifndef GPS_PPS
+#define GPS_PPS                 0
+#endif
+
+#if GPS_PPS || defined(__DOXYGEN__)
+#include "tm_stm32_rtc.h"
+
+/* 32-bit timer on APB1 with PPS on channel 1 */
+#ifndef GPS_PPS_TIM
+#define GPS_PPS_TIM             TIM5
+#define GPS_PPS_TIM_CLK_ENABLE  __HAL_RCC_TIM5_CLK_ENABLE
+#define GPS_PPS_TIM_IRQ         TIM5_IRQn
+#define GPS_PPS_TIM_IRQ_HANDLER TIM5_IRQHandler
+#endif
+
+/* PPS pin */
+#ifndef GPS_PPS_PORT
+#define GPS_PPS_PORT            GPIOA
+#define GPS_PPS_PIN             GPIO_PIN_0
+#define GPS_PPS_AF              GPIO_AF2_TIM5
+#endif
+
+/* NVIC priority, critical tier by default for low capture to discipline latency */
+#ifndef GPS_PPS_NVIC_PRIORITY
+#define GPS_PPS_NVIC_PRIORITY   NVIC_PRIORITY_CRITICAL
+#endif
+
+/* Maximal clock error in ppm for pulse to be accepted */
+#ifndef GPS_PPS_TOLERANCE
+#define GPS_PPS_TOLERANCE       1000
+#endif
+
+/* Number of pulses for RTC error measurement, 0 disables RTC calibration */
+#ifndef GPS_PPS_RTC_PERIOD
+#define GPS_PPS_RTC_PERIOD      1024
+#endif
+
+#if !RTC_TIMESTAMP
+#error "GPS_PPS needs RTC_TIMESTAMP enabled in TM RTC library!"
+#endif
+#endif
+
+/* Send data to GPS */
+#ifndef GPS_USART_SEND
+#define GPS_USART_SEND(data, count) TM_USART_Send(GPS_USART, data, count)
+#endif
+
+/* Track buffer */
+#ifndef GPS_USE_TRACK
+#define GPS_USE_TRACK           0
+#endif
+
+#if GPS_USE_TRACK || defined(__DOXYGEN__)
+/* Size of one track block in bytes, the same as sector size for direct write with FatFs */
+#ifndef GPS_TRACK_BLOCK_SIZE
+#define GPS_TRACK_BLOCK_SIZE    512
+#endif
+
+/* Number of track blocks in RAM */
+#ifndef GPS_TRACK_BLOCKS
+#define GPS_TRACK_BLOCKS        4
+#endif
+
+/* Flush track blocks to FatFs file */
+#ifndef GPS_TRACK_USE_FATFS
+#define GPS_TRACK_USE_FATFS     1
+#endif
+
+#if GPS_TRACK_USE_FATFS
+#include "ff.h"
+#endif
+
+/* Block header: magic, number of fixes, time, hundredths, latitude, longitude and altitude of first fix */
+#define GPS_TRACK_HEADER_SIZE   21
+
+/* Check track settings */
+#if defined(GPS_DISABLE_GPGGA)
+#error "GPS_USE_TRACK needs GPGGA statement for position and time!"
+#endif
+#if GPS_TRACK_BLOCK_SIZE < 64 || GPS_TRACK_BLOCK_SIZE > 65535 || GPS_TRACK_BLOCKS < 2 || GPS_TRACK_BLOCKS > 255
+#error "GPS_TRACK_BLOCK_SIZE must be between 64 and 65535 and GPS_TRACK_BLOCKS between 2 and 255!"
+#endif
+#endif
+
 /* Is character a digit */
 #define GPS_IS_DIGIT(x)			((x) >= '0' && (x) <= '9')
 
@@ -336,6 +642,7 @@ typedef enum {
 /**
  * @brief  Speed conversion enumeration
  * @note   Speed from GPS is in knots, use TM_GPS_ConvertSpeed() to convert to useable value
+ * @note   Values are used as index to conversion table, do not change order
  */
 typedef enum {
 	/* Metric */
@@ -420,6 +727,8 @@ typedef struct {
 #ifndef GPS_DISABLE_GPGGA
 	float Latitude;                                       /*!< Latitude position from GPS, -90 to 90 degrees response. */
 	float Longitude;                                      /*!< Longitude position from GPS, -180 to 180 degrees response. */
+	int32_t LatitudeE7;                                   /*!< Latitude position in units of 1e-7 degrees. */
+	int32_t LongitudeE7;                                  /*!< Longitude position in units of 1e-7 degrees. */
 	uint8_t Satellites;                                   /*!< Number of satellites in use for GPS position. */
 	uint8_t Fix;                                          /*!< GPS fix; 0: Invalid; 1: GPS Fix; 2: DGPS Fix. */
 	float Altitude;                                       /*!< Altitude above the sea. */
@@ -428,6 +737,7 @@ typedef struct {
 #ifndef GPS_DISABLE_GPRMC
 	TM_GPS_Date_t Date;                                   /*!< Current data from GPS. @ref TM_GPS_Date_t. */
 	float Speed;                                          /*!< Speed in knots from GPS. */
+	uint32_t SpeedE3;                                     /*!< Speed in units of 0.001 knots from GPS. */
 	uint8_t Validity;                                     /*!< GPS validation; 1: valid; 0: invalid. */
 	float Direction;                                      /*!< Course on the ground in relation to North. */
 #endif
@@ -452,6 +762,44 @@ typedef struct {
 /* Backward compatibility */
 typedef TM_GPS_t TM_GPS_Data_t;
 
+/**
+ * @brief  GPS PPS status
+ */
+typedef struct {
+	uint32_t Count;      /*!< Number of consecutive valid pulses, 0 when no pulse or pulse was lost */
+	uint32_t Ticks;      /*!< Timer ticks between last 2 pulses */
+	int32_t ErrorPPB;    /*!< MCU clock error in ppb from last 2 pulses, positive when MCU clock is faster than nominal */
+	int32_t RTCErrorPPB; /*!< RTC error in ppb from last measurement, positive when RTC is faster than GPS */
+	uint64_t Timestamp;  /*!< Timestamp of last pulse edge in microseconds from 01.01.1970 00:00:00 */
+} TM_GPS_PPS_t;
+
+/**
+ * @brief  Track fix in fixed point format
+ */
+typedef struct {
+	uint32_t Time;      /*!< Time in seconds since 01.01.2000 00:00:00, since midnight when GPRMC statement is disabled */
+	uint8_t Hundredths; /*!< Hundredths of second */
+	int32_t Latitude;   /*!< Latitude in 1e-6 degrees */
+	int32_t Longitude;  /*!< Longitude in 1e-6 degrees */
+	int32_t Altitude;   /*!< Altitude in decimeters */
+} TM_GPS_TrackFix_t;
+
+#if GPS_USE_TRACK || defined(__DOXYGEN__)
+/**
+ * @brief  Track buffer structure, owned by user
+ * @note   Available when GPS_USE_TRACK is enabled
+ */
+typedef struct {
+	uint8_t Blocks[GPS_TRACK_BLOCKS][GPS_TRACK_BLOCK_SIZE]; /*!< Ring of encoded blocks */
+	uint16_t Used;                                          /*!< Bytes used in current block, 0 when block is empty */
+	uint8_t Head;                                           /*!< Current block */
+	uint8_t Count;                                          /*!< Number of blocks with fixes, including current block */
+	uint8_t Pending;                                        /*!< Number of completed blocks not written to file yet */
+	uint32_t Lost;                                          /*!< Number of fixes overwritten before they were written to file */
+	TM_GPS_TrackFix_t Last;                                 /*!< Last fix, differences are calculated from it */
+} TM_GPS_Track_t;
+#endif
+
 /**
  * @brief  GPS Distance and bearing struct
  */
@@ -501,10 +849,20 @@ TM_GPS_Result_t TM_GPS_Update(TM_GPS_t* GPS_Data);
  * @brief  Converts speed in knots (from GPS) to user selectable speed
  * @param  speedInKnots: float value from GPS module
  * @param  toSpeed: Select to which speed you want conversion from knot. This parameter ca be a value of TM_GPS_Speed_t enumeration.
+ * @note   Pace units (time per distance) return 0 when speed is 0
  * @retval Calculated speed from knots to user selectable format
  */
 float TM_GPS_ConvertSpeed(float SpeedInKnots, TM_GPS_Speed_t toSpeed);
 
+/**
+ * @brief  Converts speed in 0.001 knots to user selectable speed with integer math only
+ * @param  SpeedE3: Speed in units of 0.001 knots, @ref TM_GPS_t.SpeedE3 member
+ * @param  toSpeed: Select to which speed you want conversion from knot. This parameter ca be a value of TM_GPS_Speed_t enumeration.
+ * @note   Pace units (time per distance) return 0 when speed is 0
+ * @retval Calculated speed in units of 0.001 of selected unit
+ */
+uint32_t TM_GPS_ConvertSpeedFixed(uint32_t SpeedE3, TM_GPS_Speed_t toSpeed);
+
 /**
  * @brief  Converts float number into integer and decimal part
  * @param  num: Float number to split into 2 parts
@@ -518,6 +876,18 @@ float TM_GPS_ConvertSpeed(float SpeedInKnots, TM_GPS_Speed_t toSpeed);
  */
 void TM_GPS_ConvertFloat(float num, TM_GPS_Float_t* Float_Data, uint8_t decimals);
 
+/**
+ * @brief  Converts fixed point number into integer and decimal part
+ * @param  num: Fixed point number to split into 2 parts
+ * @param  scale: Number of decimal places in num, 7 for coordinates in 1e-7 degrees, 3 for speed in 0.001 knots
+ * @param  *Float_Data: Pointer to TM_GPS_Float_t structure where to save result
+ * @param  decimals: Number of decimal places for conversion, extra decimals are truncated
+ * @note   Example: Call @ref TM_GPS_ConvertFixed(GPS_Data.LatitudeE7, 7, &Float_Struct, 6);
+ *            - With latitude 46.0569465 degrees, result will be: Integer: 46; Decimal: 56946
+ * @retval None
+ */
+void TM_GPS_ConvertFixed(int32_t num, uint8_t scale, TM_GPS_Float_t* Float_Data, uint8_t decimals);
+
 /**
  * @brief  Calculates distance between 2 coordinates on earth and bearing from start to end point in relation to the north
  * @param  *Distance_Data: Pointer to @ref TM_GPS_Distance_t structure with latitude and longitude set values
@@ -526,10 +896,31 @@ void TM_GPS_ConvertFloat(float num, TM_GPS_Float_t* Float_Data, uint8_t decimals
  */
 void TM_GPS_DistanceBetween(TM_GPS_Distance_t* Distance_Data);
 
+/**
+ * @brief  Calculates distance between 2 coordinates with equirectangular approximation and integer math only
+ * @note   Error is below 0.1% for points up to about 50 km apart, use @ref TM_GPS_DistanceHaversine for longer distances
+ * @param  Latitude1: Latitude of starting point in units of 1e-7 degrees
+ * @param  Longitude1: Longitude of starting point in units of 1e-7 degrees
+ * @param  Latitude2: Latitude of ending point in units of 1e-7 degrees
+ * @param  Longitude2: Longitude of ending point in units of 1e-7 degrees
+ * @retval Distance in centimeters
+ */
+uint32_t TM_GPS_DistanceFast(int32_t Latitude1, int32_t Longitude1, int32_t Latitude2, int32_t Longitude2);
+
+/**
+ * @brief  Calculates great circle distance between 2 coordinates with haversine formula and integer math only
+ * @param  Latitude1: Latitude of starting point in units of 1e-7 degrees
+ * @param  Longitude1: Longitude of starting point in units of 1e-7 degrees
+ * @param  Latitude2: Latitude of ending point in units of 1e-7 degrees
+ * @param  Longitude2: Longitude of ending point in units of 1e-7 degrees
+ * @retval Distance in centimeters
+ */
+uint32_t TM_GPS_DistanceHaversine(int32_t Latitude1, int32_t Longitude1, int32_t Latitude2, int32_t Longitude2);
+
 /**
  * @brief  Adds custom GPG statement to array of user selectable statements.
  *            Array is available to user using @ref TM_GPS_t workign structure
- * @note   Functions uses @ref malloc() function to allocate memory, so make sure you have enough heap memory available.
+ * @note   Functions uses @ref LIB_ALLOC_FUNC (malloc by default) to allocate memory, so make sure you have enough heap or pool memory available.
  * @note   Also note, that your GPS receiver HAVE TO send statement type you use in this function, or 
  *            @ref TM_GPS_Update() function will always return that there is not data available to read.
  * @param  *GPS_Data: Pointer to working @ref TM_GPS_t structure
@@ -541,6 +932,131 @@ void TM_GPS_DistanceBetween(TM_GPS_Distance_t* Distance_Data);
  */
 TM_GPS_Custom_t * TM_GPS_AddCustom(TM_GPS_t* GPS_Data, char* GPG_Statement, uint8_t TermNumber);
 
+#if GPS_PPS || defined(__DOXYGEN__)
+
+/**
+ * @brief  Initializes PPS input capture
+ * @note   TM RTC and its timestamp must be initialized first
+ * @note   Available when GPS_PPS is enabled
+ * @param  None
+ * @retval None
+ */
+void TM_GPS_PPS_Init(void);
+
+/**
+ * @brief  Gets PPS status
+ * @note   Available when GPS_PPS is enabled
+ * @param  *PPS: Pointer to @ref TM_GPS_PPS_t structure to save status to
+ * @retval None
+ */
+void TM_GPS_PPS_GetStatus(TM_GPS_PPS_t* PPS);
+
+/**
+ * @brief  Called on every valid PPS pulse from capture interrupt
+ * @note   Available when GPS_PPS is enabled
+ * @param  *PPS: Pointer to @ref TM_GPS_PPS_t structure with updated status
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_GPS_PPS_Callback(TM_GPS_PPS_t* PPS);
+
+#endif
+
+#if GPS_USE_UBX || defined(__DOXYGEN__)
+
+/**
+ * @brief  Switches u-blox receiver to UBX binary output
+ * @note   NAV-PVT, NAV-DOP and NAV-SAT frames are enabled, NMEA output is disabled on receiver UART.
+ *         NAV-SAT is not enabled when GPGSA and GPGSV statements are both disabled.
+ * @note   Receiver new baudrate is set last and then USART is initialized again with new baudrate
+ * @note   Available when GPS_USE_UBX is enabled
+ * @param  baudrate: New baudrate for receiver and USART, for example 115200 or 460800
+ * @param  rate: Measurement period in units of milliseconds, for example 50 for 20Hz position rate
+ * @retval None
+ */
+void TM_GPS_UBX_Configure(uint32_t baudrate, uint16_t rate);
+
+#endif
+
+#if GPS_USE_TRACK || defined(__DOXYGEN__)
+
+/**
+ * @brief  Initializes empty track buffer
+ * @note   Available when GPS_USE_TRACK is enabled
+ * @param  *Track: Pointer to @ref TM_GPS_Track_t structure
+ * @retval None
+ */
+void TM_GPS_TrackInit(TM_GPS_Track_t* Track);
+
+/**
+ * @brief  Adds current fix from GPS data to track
+ * @note   Available when GPS_USE_TRACK is enabled
+ * @param  *Track: Pointer to @ref TM_GPS_Track_t structure
+ * @param  *GPS_Data: Pointer to working @ref TM_GPS_t structure with new data
+ * @retval Status:
+ *            - 0: GPS does not have fix
+ *            - > 0: Fix added
+ */
+uint8_t TM_GPS_TrackAdd(TM_GPS_Track_t* Track, TM_GPS_t* GPS_Data);
+
+/**
+ * @brief  Adds fix in fixed point format to track
+ * @note   New block is started when fix is older than previous one or more than one day newer
+ * @note   Available when GPS_USE_TRACK is enabled
+ * @param  *Track: Pointer to @ref TM_GPS_Track_t structure
+ * @param  *Fix: Pointer to @ref TM_GPS_TrackFix_t structure with fix
+ * @retval None
+ */
+void TM_GPS_TrackAddFix(TM_GPS_Track_t* Track, const TM_GPS_TrackFix_t* Fix);
+
+/**
+ * @brief  Gets last fixes from track
+ * @note   Available when GPS_USE_TRACK is enabled
+ * @param  *Track: Pointer to @ref TM_GPS_Track_t structure
+ * @param  *Fixes: Pointer to array where fixes will be saved, oldest first
+ * @param  count: Maximal number of fixes to get
+ * @retval Number of fixes saved to array
+ */
+uint16_t TM_GPS_TrackGetLast(TM_GPS_Track_t* Track, TM_GPS_TrackFix_t* Fixes, uint16_t count);
+
+/**
+ * @brief  Calculates distance travelled since given time
+ * @note   Only fixes in RAM are used, distance between fixes is calculated on flat earth approximation
+ * @note   Available when GPS_USE_TRACK is enabled
+ * @param  *Track: Pointer to @ref TM_GPS_Track_t structure
+ * @param  Time: Start time in seconds, the same format as Time in @ref TM_GPS_TrackFix_t
+ * @retval Distance in meters
+ */
+float TM_GPS_TrackDistanceSince(TM_GPS_Track_t* Track, uint32_t Time);
+
+/**
+ * @brief  Decodes fixes from one track block, for example read from file
+ * @note   Available when GPS_USE_TRACK is enabled
+ * @param  *Block: Pointer to block, GPS_TRACK_BLOCK_SIZE bytes long
+ * @param  *Fixes: Pointer to array where fixes will be saved
+ * @param  count: Maximal number of fixes to decode
+ * @retval Number of decoded fixes, 0 if block is not valid
+ */
+uint16_t TM_GPS_TrackDecode(const uint8_t* Block, TM_GPS_TrackFix_t* Fixes, uint16_t count);
+
+#if GPS_TRACK_USE_FATFS || defined(__DOXYGEN__)
+/**
+ * @brief  Writes completed track blocks to file
+ * @note   When current block is written too, file pointer stays at its start
+ *         and block is written again on next flush, so file has all fixes after power loss
+ * @note   Available when GPS_USE_TRACK and GPS_TRACK_USE_FATFS are enabled
+ * @param  *Track: Pointer to @ref TM_GPS_Track_t structure
+ * @param  *fil: Pointer to opened file, opened for writing at the end of file
+ * @param  all: Set to 1 to write also current block and sync file
+ * @retval Status:
+ *            - 0: FatFs error
+ *            - > 0: Blocks written
+ */
+uint8_t TM_GPS_TrackFlush(TM_GPS_Track_t* Track, FIL* fil, uint8_t all);
+#endif
+
+#endif
+
 /**
  * @}
  */
@@ -27,6 +27,15 @@ typedef struct {
 	uint8_t Cols;
 	uint8_t currentX;
 	uint8_t currentY;
+#if HD44780_USE_FRAMEBUFFER
+	uint8_t Address;                                          /* DDRAM address of LCD cursor, 0xFF when unknown */
+	uint8_t Frame[HD44780_MAX_ROWS * HD44780_MAX_COLS];       /* Requested LCD content */
+	uint8_t Shadow[HD44780_MAX_ROWS * HD44780_MAX_COLS];      /* Content currently in LCD DDRAM */
+#endif
+	uint8_t CGRAM[8][8];                                      /* Copy of custom characters in LCD CGRAM */
+	uint8_t CGRAMValid;                                       /* Bit for each location with known content */
+	uint16_t GlyphTick;                                       /* Counter of glyph uses */
+	uint16_t GlyphUsed[8];                                    /* Tick of last use of each location */
 } HD44780_Options_t;
 
 /* Private functions */
@@ -35,6 +44,12 @@ static void TM_HD44780_Cmd(uint8_t cmd);
 static void TM_HD44780_Cmd4bit(uint8_t cmd);
 static void TM_HD44780_Data(uint8_t data);
 static void TM_HD44780_CursorSet(uint8_t col, uint8_t row);
+static void TM_HD44780_Putc(uint8_t ch);
+static void TM_HD44780_WriteCGRAM(uint8_t location, const uint8_t* data);
+static uint8_t TM_HD44780_GlyphsOnScreen(void);
+#if HD44780_USE_BUSY_FLAG
+static void TM_HD44780_WaitBusy(void);
+#endif
 
 /* Private variable */
 static HD44780_Options_t HD44780_Opts;
@@ -45,9 +60,24 @@ static HD44780_Options_t HD44780_Opts;
 #define HD44780_E_LOW               TM_GPIO_SetPinLow(HD44780_E_PORT, HD44780_E_PIN)
 #define HD44780_E_HIGH              TM_GPIO_SetPinHigh(HD44780_E_PORT, HD44780_E_PIN)
 
+#if HD44780_USE_BUSY_FLAG
+#define HD44780_RW_LOW              TM_GPIO_SetPinLow(HD44780_RW_PORT, HD44780_RW_PIN)
+#define HD44780_RW_HIGH             TM_GPIO_SetPinHigh(HD44780_RW_PORT, HD44780_RW_PIN)
+
+/* Short enable pulse, LCD is ready when busy flag is cleared */
+#define HD44780_E_BLINK             HD44780_E_HIGH; HD44780_Delay(1); HD44780_E_LOW; HD44780_Delay(1)
+#else
+/* Enable pulse with worst case command time */
 #define HD44780_E_BLINK             HD44780_E_HIGH; HD44780_Delay(20); HD44780_E_LOW; HD44780_Delay(20)
+#endif
 #define HD44780_Delay(x)            Delay(x)
 
+/* Data pins D4-D7 are on the same port and in order, nibble can be written at once */
+#define HD44780_DATA_ONE_PORT       (                                                                             \
+	HD44780_D4_PORT == HD44780_D5_PORT && HD44780_D4_PORT == HD44780_D6_PORT && HD44780_D4_PORT == HD44780_D7_PORT && \
+	HD44780_D5_PIN == (HD44780_D4_PIN << 1) && HD44780_D6_PIN == (HD44780_D4_PIN << 2) && HD44780_D7_PIN == (HD44780_D4_PIN << 3) \
+)
+
 /* Commands*/
 #define HD44780_CLEARDISPLAY        0x01
 #define HD44780_RETURNHOME          0x02
@@ -69,6 +99,9 @@ static HD44780_Options_t HD44780_Opts;
 #define HD44780_CURSORON            0x02
 #define HD44780_BLINKON             0x01
 
+/* Busy flag in status register */
+#define HD44780_BUSYFLAG            0x80
+
 /* Flags for display/cursor shift */
 #define HD44780_DISPLAYMOVE         0x08
 #define HD44780_CURSORMOVE          0x00
@@ -97,6 +130,16 @@ void TM_HD44780_Init(uint8_t cols, uint8_t rows) {
 	HD44780_Opts.Rows = rows;
 	HD44780_Opts.Cols = cols;
 	
+#if HD44780_USE_FRAMEBUFFER
+	/* Limit to framebuffer size */
+	if (HD44780_Opts.Rows > HD44780_MAX_ROWS) {
+		HD44780_Opts.Rows = HD44780_MAX_ROWS;
+	}
+	if (HD44780_Opts.Cols > HD44780_MAX_COLS) {
+		HD44780_Opts.Cols = HD44780_MAX_COLS;
+	}
+#endif
+	
 	/* Set cursor pointer to beginning for LCD */
 	HD44780_Opts.currentX = 0;
 	HD44780_Opts.currentY = 0;
@@ -130,7 +173,18 @@ void TM_HD44780_Init(uint8_t cols, uint8_t rows) {
 	TM_HD44780_DisplayOn();
 
 	/* Clear lcd */
-	TM_HD44780_Clear();
+	TM_HD44780_Cmd(HD44780_CLEARDISPLAY);
+	HD44780_Delay(3000);
+	
+#if HD44780_USE_FRAMEBUFFER
+	/* LCD and frame are both empty now */
+	memset(HD44780_Opts.Frame, ' ', sizeof(HD44780_Opts.Frame));
+	memset(HD44780_Opts.Shadow, ' ', sizeof(HD44780_Opts.Shadow));
+	HD44780_Opts.Address = 0;
+#endif
+
+	/* CGRAM content is random after power up */
+	HD44780_Opts.CGRAMValid = 0;
 
 	/* Default font directions */
 	HD44780_Opts.DisplayMode = HD44780_ENTRYLEFT | HD44780_ENTRYSHIFTDECREMENT;
@@ -141,9 +195,46 @@ void TM_HD44780_Init(uint8_t cols, uint8_t rows) {
 }
 
 void TM_HD44780_Clear(void) {
+#if HD44780_USE_FRAMEBUFFER
+	/* Clear frame only, changed cells are cleared on flush */
+	memset(HD44780_Opts.Frame, ' ', sizeof(HD44780_Opts.Frame));
+#else
 	TM_HD44780_Cmd(HD44780_CLEARDISPLAY);
+#if !HD44780_USE_BUSY_FLAG
 	HD44780_Delay(3000);
+#endif
+#endif
+}
+
+#if HD44780_USE_FRAMEBUFFER
+void TM_HD44780_Flush(void) {
+	uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
+	uint8_t row, col, i, address;
+	
+	/* Go through rows, DDRAM address is not continuous between rows */
+	for (row = 0; row < HD44780_Opts.Rows; row++) {
+		for (col = 0; col < HD44780_Opts.Cols; col++) {
+			i = row * HD44780_Opts.Cols + col;
+			
+			/* Cell not changed */
+			if (HD44780_Opts.Frame[i] == HD44780_Opts.Shadow[i]) {
+				continue;
+			}
+			
+			/* Set address only when cursor is not already there after previous write */
+			address = col + row_offsets[row];
+			if (HD44780_Opts.Address != address) {
+				TM_HD44780_Cmd(HD44780_SETDDRAMADDR | address);
+			}
+			
+			/* Write character, address is incremented by LCD */
+			TM_HD44780_Data(HD44780_Opts.Frame[i]);
+			HD44780_Opts.Shadow[i] = HD44780_Opts.Frame[i];
+			HD44780_Opts.Address = address + 1;
+		}
+	}
 }
+#endif
 
 void TM_HD44780_Puts(uint8_t x, uint8_t y, char* str) {
 	TM_HD44780_CursorSet(x, y);
@@ -159,7 +250,7 @@ void TM_HD44780_Puts(uint8_t x, uint8_t y, char* str) {
 		} else if (*str == '\r') {
 			TM_HD44780_CursorSet(0, HD44780_Opts.currentY);
 		} else {
-			TM_HD44780_Data(*str);
+			TM_HD44780_Putc(*str);
 			HD44780_Opts.currentX++;
 		}
 		str++;
@@ -205,23 +296,144 @@ void TM_HD44780_ScrollRight(void) {
 }
 
 void TM_HD44780_CreateChar(uint8_t location, uint8_t *data) {
-	uint8_t i;
 	/* We have 8 locations available for custom characters */
 	location &= 0x07;
-	TM_HD44780_Cmd(HD44780_SETCGRAMADDR | (location << 3));
 	
-	for (i = 0; i < 8; i++) {
-		TM_HD44780_Data(data[i]);
-	}
+	/* Send changed rows only */
+	TM_HD44780_WriteCGRAM(location, data);
 }
 
 void TM_HD44780_PutCustom(uint8_t x, uint8_t y, uint8_t location) {
 	TM_HD44780_CursorSet(x, y);
-	TM_HD44780_Data(location);
+	TM_HD44780_Putc(location);
+}
+
+uint8_t TM_HD44780_PutGlyph(uint8_t x, uint8_t y, const uint8_t* data) {
+	uint8_t i, location = 0xFF, busy;
+	uint16_t age, oldest = 0;
+	
+	/* Count use */
+	HD44780_Opts.GlyphTick++;
+	
+	/* Search for the same character already in CGRAM */
+	for (i = HD44780_GLYPH_FIRST_SLOT; i < 8; i++) {
+		if ((HD44780_Opts.CGRAMValid & (1 << i)) && memcmp(HD44780_Opts.CGRAM[i], data, 8) == 0) {
+			location = i;
+			break;
+		}
+	}
+	
+	/* Not found, reuse location which is not on screen */
+	if (location == 0xFF) {
+		busy = TM_HD44780_GlyphsOnScreen();
+		
+		/* Unused location first, then least recently used one */
+		for (i = HD44780_GLYPH_FIRST_SLOT; i < 8; i++) {
+			if (busy & (1 << i)) {
+				continue;
+			}
+			if (!(HD44780_Opts.CGRAMValid & (1 << i))) {
+				location = i;
+				break;
+			}
+			age = HD44780_Opts.GlyphTick - HD44780_Opts.GlyphUsed[i];
+			if (location == 0xFF || age > oldest) {
+				location = i;
+				oldest = age;
+			}
+		}
+		
+		/* All locations are on screen */
+		if (location == 0xFF) {
+			return 0xFF;
+		}
+		
+		/* Send character, old one on screen is not affected */
+		TM_HD44780_WriteCGRAM(location, data);
+	}
+	
+	/* Mark use and show character */
+	HD44780_Opts.GlyphUsed[location] = HD44780_Opts.GlyphTick;
+	TM_HD44780_PutCustom(x, y, location);
+	
+	/* Return location */
+	return location;
 }
 
 /* Private functions */
+static void TM_HD44780_WriteCGRAM(uint8_t location, const uint8_t* data) {
+	uint8_t first = 0, last = 7, i;
+	
+	/* Find changed rows when content is known */
+	if (HD44780_Opts.CGRAMValid & (1 << location)) {
+		while (first < 8 && HD44780_Opts.CGRAM[location][first] == data[first]) {
+			first++;
+		}
+		
+		/* Character not changed */
+		if (first == 8) {
+			return;
+		}
+		
+		while (HD44780_Opts.CGRAM[location][last] == data[last]) {
+			last--;
+		}
+	}
+	
+	/* Send changed rows, address is incremented by LCD */
+	TM_HD44780_Cmd(HD44780_SETCGRAMADDR | (location << 3) | first);
+	for (i = first; i <= last; i++) {
+		TM_HD44780_Data(data[i]);
+		HD44780_Opts.CGRAM[location][i] = data[i];
+	}
+	HD44780_Opts.CGRAMValid |= 1 << location;
+	
+#if HD44780_USE_FRAMEBUFFER
+	/* Address now points to CGRAM */
+	HD44780_Opts.Address = 0xFF;
+#else
+	/* Address now points to CGRAM, set it back */
+	TM_HD44780_CursorSet(HD44780_Opts.currentX, HD44780_Opts.currentY);
+#endif
+}
+
+static uint8_t TM_HD44780_GlyphsOnScreen(void) {
+	uint8_t busy = 0;
+#if HD44780_USE_FRAMEBUFFER
+	uint16_t i;
+	
+	/* Codes 0 - 15 are custom characters, in requested frame or still on LCD */
+	for (i = 0; i < HD44780_Opts.Rows * HD44780_Opts.Cols; i++) {
+		if (HD44780_Opts.Frame[i] < 16) {
+			busy |= 1 << (HD44780_Opts.Frame[i] & 0x07);
+		}
+		if (HD44780_Opts.Shadow[i] < 16) {
+			busy |= 1 << (HD44780_Opts.Shadow[i] & 0x07);
+		}
+	}
+#endif
+	
+	/* Return locations on screen */
+	return busy;
+}
+
+static void TM_HD44780_Putc(uint8_t ch) {
+#if HD44780_USE_FRAMEBUFFER
+	/* Save to frame, sent to LCD on flush */
+	if (HD44780_Opts.currentX < HD44780_Opts.Cols && HD44780_Opts.currentY < HD44780_Opts.Rows) {
+		HD44780_Opts.Frame[HD44780_Opts.currentY * HD44780_Opts.Cols + HD44780_Opts.currentX] = ch;
+	}
+#else
+	TM_HD44780_Data(ch);
+#endif
+}
+
 static void TM_HD44780_Cmd(uint8_t cmd) {
+#if HD44780_USE_BUSY_FLAG
+	/* Wait previous command */
+	TM_HD44780_WaitBusy();
+#endif
+	
 	/* Command mode */
 	HD44780_RS_LOW;
 	
@@ -232,6 +444,11 @@ static void TM_HD44780_Cmd(uint8_t cmd) {
 }
 
 static void TM_HD44780_Data(uint8_t data) {
+#if HD44780_USE_BUSY_FLAG
+	/* Wait previous command */
+	TM_HD44780_WaitBusy();
+#endif
+	
 	/* Data mode */
 	HD44780_RS_HIGH;
 	
@@ -242,6 +459,14 @@ static void TM_HD44780_Data(uint8_t data) {
 }
 
 static void TM_HD44780_Cmd4bit(uint8_t cmd) {
+	/* All data pins on the same port and consecutive, resolved at compile time */
+	if (HD44780_DATA_ONE_PORT) {
+		/* Set all 4 data lines with single BSRR write */
+		TM_GPIO_SetPortMasked(HD44780_D4_PORT, HD44780_D4_PIN * 0x0F, HD44780_D4_PIN * (cmd & 0x0F));
+		HD44780_E_BLINK;
+		return;
+	}
+	
 	/* Set output port */
 	TM_GPIO_SetPinValue(HD44780_D7_PORT, HD44780_D7_PIN, (cmd & 0x08));
 	TM_GPIO_SetPinValue(HD44780_D6_PORT, HD44780_D6_PIN, (cmd & 0x04));
@@ -250,8 +475,49 @@ static void TM_HD44780_Cmd4bit(uint8_t cmd) {
 	HD44780_E_BLINK;
 }
 
+#if HD44780_USE_BUSY_FLAG
+static void TM_HD44780_WaitBusy(void) {
+	uint32_t timeout = HD44780_BUSY_TIMEOUT;
+	uint8_t status;
+	
+	/* Data pins as inputs */
+	TM_GPIO_SetPinAsInput(HD44780_D4_PORT, HD44780_D4_PIN);
+	TM_GPIO_SetPinAsInput(HD44780_D5_PORT, HD44780_D5_PIN);
+	TM_GPIO_SetPinAsInput(HD44780_D6_PORT, HD44780_D6_PIN);
+	TM_GPIO_SetPinAsInput(HD44780_D7_PORT, HD44780_D7_PIN);
+	
+	/* Read status register */
+	HD44780_RS_LOW;
+	HD44780_RW_HIGH;
+	
+	do {
+		/* High nibble, includes busy flag */
+		HD44780_E_HIGH;
+		HD44780_Delay(1);
+		status = TM_GPIO_GetInputPinValue(HD44780_D7_PORT, HD44780_D7_PIN) << 7;
+		HD44780_E_LOW;
+		HD44780_Delay(1);
+		
+		/* Low nibble, address counter is ignored */
+		HD44780_E_HIGH;
+		HD44780_Delay(1);
+		HD44780_E_LOW;
+		HD44780_Delay(1);
+	} while ((status & HD44780_BUSYFLAG) && --timeout);
+	
+	/* Back to write mode */
+	HD44780_RW_LOW;
+	TM_GPIO_SetPinAsOutput(HD44780_D4_PORT, HD44780_D4_PIN);
+	TM_GPIO_SetPinAsOutput(HD44780_D5_PORT, HD44780_D5_PIN);
+	TM_GPIO_SetPinAsOutput(HD44780_D6_PORT, HD44780_D6_PIN);
+	TM_GPIO_SetPinAsOutput(HD44780_D7_PORT, HD44780_D7_PIN);
+}
+#endif
+
 static void TM_HD44780_CursorSet(uint8_t col, uint8_t row) {
+#if !HD44780_USE_FRAMEBUFFER
 	uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
+#endif
 	
 	/* Go to beginning */
 	if (row >= HD44780_Opts.Rows) {
@@ -262,8 +528,10 @@ static void TM_HD44780_CursorSet(uint8_t col, uint8_t row) {
 	HD44780_Opts.currentX = col;
 	HD44780_Opts.currentY = row;
 	
-	/* Set location address */
+#if !HD44780_USE_FRAMEBUFFER
+	/* Set location address, with framebuffer it is set on flush */
 	TM_HD44780_Cmd(HD44780_SETDDRAMADDR | (col + row_offsets[row]));
+#endif
 }
 
 static void TM_HD44780_InitPins(void) {
@@ -274,6 +542,10 @@ static void TM_HD44780_InitPins(void) {
 	TM_GPIO_Init(HD44780_D5_PORT, HD44780_D5_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_Low);
 	TM_GPIO_Init(HD44780_D6_PORT, HD44780_D6_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_Low);
 	TM_GPIO_Init(HD44780_D7_PORT, HD44780_D7_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_Low);
+#if HD44780_USE_BUSY_FLAG
+	TM_GPIO_Init(HD44780_RW_PORT, HD44780_RW_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_Low);
+	TM_GPIO_SetPinLow(HD44780_RW_PORT, HD44780_RW_PIN);
+#endif
 	
 	/* Set pins low */
 	TM_GPIO_SetPinLow(HD44780_RS_PORT, HD44780_RS_PIN);
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-15-hd44780-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   HD44780 LCD driver library for STM32Fxxx
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_HD44780_H
-#define TM_HD44780_H 100
+#define TM_HD44780_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -63,7 +63,7 @@ GND   GND               Ground
 VCC   +5V               Power supply for LCD
 V0    Potentiometer	    Contrast voltage. Connect to potentiometer
 RS    PB2               Register select, can be overwritten in your project's defines.h file
-RW    GND               Read/write
+RW    GND               Read/write, connect to PB5 when busy flag is used, can be overwritten in your project's defines.h file
 E     PB7               Enable pin, can be overwritten in your project's defines.h file
 D0    -                 Data 0 - doesn't care
 D1    -                 Data 1 - doesn't care
@@ -98,6 +98,72 @@ K     GND               Ground for back light
 //D7 - Data 7 pin
 #define HD44780_D7_PORT     GPIOB
 #define HD44780_D7_PIN      GPIO_PIN_13
+\endcode
+ *
+ * \par Framebuffer
+ *
+ * When framebuffer is enabled, @ref TM_HD44780_Puts, @ref TM_HD44780_PutCustom and @ref TM_HD44780_Clear
+ * only change RAM copy of display. Call @ref TM_HD44780_Flush to send changed characters to LCD.
+ * Characters which are already on LCD are not sent again and cursor address is set only when changed characters are not next to each other.
+ *
+\code
+//Enable framebuffer
+#define HD44780_USE_FRAMEBUFFER     1
+//Maximal LCD size
+#define HD44780_MAX_COLS            20
+#define HD44780_MAX_ROWS            4
+\endcode
+ *
+ * \par Busy flag
+ *
+ * By default, library waits worst case time after each command. When RW pin is connected,
+ * library can read busy flag from LCD instead and continue as soon as LCD is ready.
+ *
+ * @note   LCD drives data pins with its supply voltage in read mode, use 5V tolerant pins for D4-D7 when LCD is powered with 5V
+ *
+\code
+//Enable busy flag polling
+#define HD44780_USE_BUSY_FLAG       1
+//RW - Read/write pin
+#define HD44780_RW_PORT             GPIOB
+#define HD44780_RW_PIN              GPIO_PIN_5
+//Max number of busy flag reads before continue
+#define HD44780_BUSY_TIMEOUT        1000
+\endcode
+ *
+ * \par Custom characters
+ *
+ * Library keeps copy of CGRAM, so @ref TM_HD44780_CreateChar sends only rows which are changed.
+ * Rewriting all custom characters on each update costs nothing when they are the same.
+ * All cells which show a character are refreshed by LCD itself when its CGRAM is changed.
+ *
+ * For bar graphs, spinners and other animations, use @ref TM_HD44780_PutGlyph with character data instead of location.
+ * Library allocates CGRAM location for it:
+ *  - When the same character is already in CGRAM, its location is used and nothing is sent to LCD
+ *  - Otherwise, least recently used location which is not on screen is reused and character is sent to CGRAM
+ *
+ * New character is written to location which is not visible and cell is switched to it, so old character stays on screen
+ * until new one is complete, like double buffering. Bar graph with 6 different levels over many cells needs only 6 locations
+ * and after first frame, updates do not send anything to CGRAM.
+ *
+ * @note  Framebuffer must be enabled for library to know which locations are on screen.
+ *        Without framebuffer, least recently used location is reused even when it is still displayed
+ *
+\code
+//Locations below this one are reserved for TM_HD44780_CreateChar, allocator uses the rest
+#define HD44780_GLYPH_FIRST_SLOT    0
+\endcode
+ *
+\code
+//Bar graph levels, 0 to 5 columns filled
+uint8_t bars[6][8];
+
+//Draw bar graph with value 0 - 80 on 16 cells
+for (i = 0; i < 16; i++) {
+	level = value > 5 * i ? value - 5 * i : 0;
+	TM_HD44780_PutGlyph(i, 1, bars[level > 5 ? 5 : level]);
+}
+TM_HD44780_Flush();
 \endcode
  *
  * \par Changelog
@@ -105,6 +171,17 @@ K     GND               Ground for back light
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added optional framebuffer with TM_HD44780_Flush function, only changed characters are sent to LCD
+  - Added optional busy flag polling instead of fixed delays
+  - Data nibble is written with single BSRR access when D4-D7 are consecutive pins on the same port
+  
+ Version 1.2
+  - October 14, 2026
+  - Added CGRAM copy, TM_HD44780_CreateChar sends only changed rows
+  - Added TM_HD44780_PutGlyph with CGRAM location allocator and least recently used reuse
 \endverbatim
  *
  * \par Dependencies
@@ -114,12 +191,19 @@ K     GND               Ground for back light
  - defines.h
  - TM DELAY
  - TM GPIO
+ - string.h
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_delay.h"
 #include "tm_stm32_gpio.h"
+#include "string.h"
+
+/* GPIO version check */
+#if TM_GPIO_H < 110
+#error "Please update TM GPIO LIB, minimum required version is 1.1. Download available on stm32f4-discovery.com website"
+#endif
 
 /**
  * @defgroup TM_HD44780_Macros
@@ -160,6 +244,41 @@ K     GND               Ground for back light
 #define HD44780_D7_PORT				GPIOB
 #define HD44780_D7_PIN				GPIO_PIN_13
 #endif
+/* RW - Read/write pin, used with busy flag */
+#ifndef HD44780_RW_PIN
+#define HD44780_RW_PORT				GPIOB
+#define HD44780_RW_PIN				GPIO_PIN_5
+#endif
+
+/* Framebuffer, disabled by default */
+#ifndef HD44780_USE_FRAMEBUFFER
+#define HD44780_USE_FRAMEBUFFER		0
+#endif
+/* Maximal LCD size for framebuffer */
+#ifndef HD44780_MAX_COLS
+#define HD44780_MAX_COLS			20
+#endif
+#ifndef HD44780_MAX_ROWS
+#define HD44780_MAX_ROWS			4
+#endif
+
+/* Busy flag polling, disabled by default as RW pin is usually connected to GND */
+#ifndef HD44780_USE_BUSY_FLAG
+#define HD44780_USE_BUSY_FLAG		0
+#endif
+/* Max number of busy flag reads */
+#ifndef HD44780_BUSY_TIMEOUT
+#define HD44780_BUSY_TIMEOUT		1000
+#endif
+
+/* First CGRAM location used by glyph allocator, lower ones are for TM_HD44780_CreateChar */
+#ifndef HD44780_GLYPH_FIRST_SLOT
+#define HD44780_GLYPH_FIRST_SLOT	0
+#endif
+
+#if HD44780_GLYPH_FIRST_SLOT > 7
+#error "HD44780_GLYPH_FIRST_SLOT must be between 0 and 7!"
+#endif
 
 /**
  * @}
@@ -200,6 +319,14 @@ void TM_HD44780_DisplayOff(void);
  */
 void TM_HD44780_Clear(void);
 
+/**
+ * @brief  Sends changed characters from framebuffer to LCD
+ * @note   Available only when HD44780_USE_FRAMEBUFFER is enabled
+ * @param  None
+ * @retval None
+ */
+void TM_HD44780_Flush(void);
+
 /**
  * @brief  Puts string on lcd
  * @param  x: X location where string will start
@@ -253,6 +380,7 @@ void TM_HD44780_ScrollRight(void);
 
 /**
  * @brief  Creates custom character
+ * @note   Only rows which are different from previous character on this location are sent to LCD
  * @param  location: Location where to save character on LCD. LCD supports up to 8 custom characters, so locations are 0 - 7
  * @param *data: Pointer to 8-bytes of data for one character
  * @retval None
@@ -268,6 +396,16 @@ void TM_HD44780_CreateChar(uint8_t location, uint8_t* data);
  */
 void TM_HD44780_PutCustom(uint8_t x, uint8_t y, uint8_t location);
 
+/**
+ * @brief  Puts custom character on LCD, CGRAM location is allocated by library
+ * @note   Character is sent to CGRAM only when it is not there yet
+ * @param  x: X location where character will be shown
+ * @param  y: Y location where character will be shown
+ * @param  *data: Pointer to 8-bytes of data for one character
+ * @retval CGRAM location used for character, 0 - 7, or 0xFF when all allocator locations are on screen with other characters
+ */
+uint8_t TM_HD44780_PutGlyph(uint8_t x, uint8_t y, const uint8_t* data);
+
 /**
  * @}
  */
@@ -18,66 +18,194 @@
  */
 #include "tm_stm32_i2c.h"
 
+/* Only I2Cs enabled in defines.h are compiled in, all available I2Cs when none is enabled */
+#if defined(TM_I2C1_ENABLED) || defined(TM_I2C2_ENABLED) || defined(TM_I2C3_ENABLED) || defined(TM_I2C4_ENABLED)
+#define I2C_INT_SELECTED            1
+#else
+#define I2C_INT_SELECTED            0
+#endif
+
+#if defined(I2C1) && (!I2C_INT_SELECTED || defined(TM_I2C1_ENABLED))
+#define I2C_INT_USE_I2C1
+#endif
+#if defined(I2C2) && (!I2C_INT_SELECTED || defined(TM_I2C2_ENABLED))
+#define I2C_INT_USE_I2C2
+#endif
+#if defined(I2C3) && (!I2C_INT_SELECTED || defined(TM_I2C3_ENABLED))
+#define I2C_INT_USE_I2C3
+#endif
+#if defined(I2C4) && (!I2C_INT_SELECTED || defined(TM_I2C4_ENABLED))
+#define I2C_INT_USE_I2C4
+#endif
+
 /* I2C2 AF fix for F0xx */
 #if !defined(GPIO_AF4_I2C2) 
 #define GPIO_AF4_I2C2   GPIO_AF1_I2C2
 #endif
 
-/* Timeout value */
-#define I2C_TIMEOUT_VALUE              1000
-
 /* Handle values for I2C */
-#ifdef I2C1
+#ifdef I2C_INT_USE_I2C1
 static I2C_HandleTypeDef I2C1Handle = {I2C1};
 #endif
-#ifdef I2C2
+#ifdef I2C_INT_USE_I2C2
 static I2C_HandleTypeDef I2C2Handle = {I2C2};
 #endif
-#ifdef I2C3
+#ifdef I2C_INT_USE_I2C3
 static I2C_HandleTypeDef I2C3Handle = {I2C3};
 #endif
-#ifdef I2C4
+#ifdef I2C_INT_USE_I2C4
 static I2C_HandleTypeDef I2C4Handle = {I2C4};
 #endif
 
+#if I2C_QUEUE_SIZE > 0
+/* Transaction queue for each I2C */
+typedef struct {
+	TM_I2C_Transaction_t Queue[I2C_QUEUE_SIZE];
+	volatile uint16_t In;
+	volatile uint16_t Out;
+	volatile uint16_t Count;
+} TM_I2C_INT_Queue_t;
+
+#ifdef I2C_INT_USE_I2C1
+static TM_I2C_INT_Queue_t I2C1Queue;
+#endif
+#ifdef I2C_INT_USE_I2C2
+static TM_I2C_INT_Queue_t I2C2Queue;
+#endif
+#ifdef I2C_INT_USE_I2C3
+static TM_I2C_INT_Queue_t I2C3Queue;
+#endif
+#ifdef I2C_INT_USE_I2C4
+static TM_I2C_INT_Queue_t I2C4Queue;
+#endif
+
+static TM_I2C_INT_Queue_t* TM_I2C_INT_GetQueue(I2C_TypeDef* I2Cx);
+static uint8_t TM_I2C_INT_Enqueue(I2C_TypeDef* I2Cx, TM_I2C_Transaction_t* Transaction);
+static void TM_I2C_INT_StartNext(I2C_HandleTypeDef* Handle, TM_I2C_INT_Queue_t* Q);
+static void TM_I2C_INT_Finished(I2C_HandleTypeDef* Handle, TM_I2C_Result_t result);
+static void TM_I2C_INT_EnableInterrupts(I2C_TypeDef* I2Cx);
+static void TM_I2C_INT_GroupCallback(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+static void TM_I2C_INT_GroupDone(TM_I2C_Group_t* Group);
+
+/* Group timestamp */
+#if defined(STM32F0xx)
+#define I2C_INT_TIME()                 HAL_GetTick()
+#else
+#define I2C_INT_TIME()                 DWT->CYCCNT
+#endif
+#endif
+
+/* Runtime state for each I2C */
+typedef struct {
+	GPIO_TypeDef* SCL_Port;                        /* SCL pin for bus recovery, NULL if not known */
+	uint16_t SCL_Pin;
+	GPIO_TypeDef* SDA_Port;                        /* SDA pin for bus recovery */
+	uint16_t SDA_Pin;
+	uint32_t Timeout;                              /* Timeout for blocking transfers in milliseconds */
+	uint32_t Recoveries;                           /* Number of bus recoveries */
+	TM_I2C_Stats_t Stats[I2C_STATS_DEVICES];       /* Error statistics for each device */
+#if STATS_ENABLED
+	TM_STATS_t Counters;                           /* Driver statistics */
+#endif
+} TM_I2C_INT_State_t;
+
+static I2C_HandleTypeDef* TM_I2C_INT_Prepare(I2C_TypeDef* I2Cx, uint16_t rx, uint16_t tx);
+static uint32_t TM_I2C_INT_GetTimeout(I2C_HandleTypeDef* Handle);
+static void TM_I2C_INT_Error(I2C_HandleTypeDef* Handle, uint8_t device_address);
+static TM_I2C_Stats_t* TM_I2C_INT_GetStats(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t add);
+static void TM_I2C_INT_Delay(void);
+
 /* Private functions */
-#ifdef I2C1
+#ifdef I2C_INT_USE_I2C1
 static void TM_I2C1_INT_InitPins(TM_I2C_PinsPack_t pinspack);
 #endif
-#ifdef I2C2
+#ifdef I2C_INT_USE_I2C2
 static void TM_I2C2_INT_InitPins(TM_I2C_PinsPack_t pinspack);
 #endif
-#ifdef I2C3
+#ifdef I2C_INT_USE_I2C3
 static void TM_I2C3_INT_InitPins(TM_I2C_PinsPack_t pinspack);
 #endif
-#ifdef I2C4
+#ifdef I2C_INT_USE_I2C4
 static void TM_I2C4_INT_InitPins(TM_I2C_PinsPack_t pinspack);
 #endif
 
-I2C_HandleTypeDef* TM_I2C_GetHandle(I2C_TypeDef* I2Cx) {
-#ifdef I2C1
-	if (I2Cx == I2C1) {
-		return &I2C1Handle;
-	}
+/* Constant settings for each I2C */
+typedef struct {
+	I2C_HandleTypeDef* Handle;                     /* Pointer to I2C handle */
+#if STATS_ENABLED
+	const char* Name;                              /* Name for statistics */
 #endif
-#ifdef I2C2
-	if (I2Cx == I2C2) {
-		return &I2C2Handle;
-	}
+#if I2C_QUEUE_SIZE > 0
+	TM_I2C_INT_Queue_t* Queue;                     /* Pointer to transaction queue */
 #endif
-#ifdef I2C3
-	if (I2Cx == I2C3) {
-		return &I2C3Handle;
-	}
+	void (*InitPins)(TM_I2C_PinsPack_t pinspack);  /* Function for pins initialization */
+	uint32_t RCC_Mask;                             /* Clock enable bit in APB1ENR register */
+	IRQn_Type EV_IRQ;                              /* Event IRQ channel */
+	IRQn_Type ER_IRQ;                              /* Error IRQ channel, the same as event on STM32F0xx */
+	uint8_t SubPriority;                           /* NVIC subpriority */
+} TM_I2C_INT_Config_t;
+
+#if (defined(I2C_INT_USE_I2C1) + defined(I2C_INT_USE_I2C2) + defined(I2C_INT_USE_I2C3) + defined(I2C_INT_USE_I2C4)) == 1
+/* Only one I2C is enabled, config and state have one entry */
+#define I2C_INT_COUNT                  1
+#define I2C_INT_ID(I2Cx)               0
+#else
+/* Index from I2C base address, bits 11:10 are different for all I2Cs on STM32F0xx, STM32F4xx and STM32F7xx */
+#define I2C_INT_COUNT                  4
+#define I2C_INT_ID(I2Cx)               ((((uint32_t)(I2Cx)) >> 10) & 0x03)
 #endif
-#ifdef I2C4
-	if (I2Cx == I2C4) {
-		return &I2C4Handle;
-	}
+
+#if I2C_QUEUE_SIZE > 0
+#define I2C_INT_QUEUE(x)               &x,
+#else
+#define I2C_INT_QUEUE(x)
+#endif
+
+#if STATS_ENABLED
+#define I2C_INT_NAME(x)                #x,
+#else
+#define I2C_INT_NAME(x)
 #endif
+
+#if defined(STM32F0xx)
+#define I2C_INT_IRQS(x)                x##_IRQn, x##_IRQn
+#else
+#define I2C_INT_IRQS(x)                x##_EV_IRQn, x##_ER_IRQn
+#endif
+
+static const TM_I2C_INT_Config_t I2C_Config[I2C_INT_COUNT] = {
+#ifdef I2C_INT_USE_I2C1
+	[I2C_INT_ID(I2C1_BASE)] = {&I2C1Handle, I2C_INT_NAME(I2C1) I2C_INT_QUEUE(I2C1Queue) TM_I2C1_INT_InitPins, RCC_APB1ENR_I2C1EN, I2C_INT_IRQS(I2C1), 0},
+#endif
+#ifdef I2C_INT_USE_I2C2
+	[I2C_INT_ID(I2C2_BASE)] = {&I2C2Handle, I2C_INT_NAME(I2C2) I2C_INT_QUEUE(I2C2Queue) TM_I2C2_INT_InitPins, RCC_APB1ENR_I2C2EN, I2C_INT_IRQS(I2C2), 1},
+#endif
+#ifdef I2C_INT_USE_I2C3
+	[I2C_INT_ID(I2C3_BASE)] = {&I2C3Handle, I2C_INT_NAME(I2C3) I2C_INT_QUEUE(I2C3Queue) TM_I2C3_INT_InitPins, RCC_APB1ENR_I2C3EN, I2C_INT_IRQS(I2C3), 2},
+#endif
+#ifdef I2C_INT_USE_I2C4
+	[I2C_INT_ID(I2C4_BASE)] = {&I2C4Handle, I2C_INT_NAME(I2C4) I2C_INT_QUEUE(I2C4Queue) TM_I2C4_INT_InitPins, RCC_APB1ENR_I2C4EN, I2C_INT_IRQS(I2C4), 3},
+#endif
+};
+
+/* Runtime state, in the same order as config */
+static TM_I2C_INT_State_t I2C_State[I2C_INT_COUNT];
+
+/* Gets statistics block for I2C */
+#define I2C_INT_STATS(I2Cx)            (&I2C_State[I2C_INT_ID(I2Cx)].Counters)
+
+/* Gets constant config for I2C, NULL if I2C is not valid */
+static const TM_I2C_INT_Config_t* TM_I2C_INT_GetConfig(I2C_TypeDef* I2Cx) {
+	const TM_I2C_INT_Config_t* cfg = &I2C_Config[I2C_INT_ID(I2Cx)];
+	
+	return (cfg->Handle && cfg->Handle->Instance == I2Cx) ? cfg : NULL;
+}
+
+I2C_HandleTypeDef* TM_I2C_GetHandle(I2C_TypeDef* I2Cx) {
+	const TM_I2C_INT_Config_t* cfg = TM_I2C_INT_GetConfig(I2Cx);
 	
-	/* Return invalid */
-	return 0;
+	/* Return handle or invalid */
+	return cfg ? cfg->Handle : 0;
 }
 
 static void TM_I2C_FillSettings(I2C_HandleTypeDef* Handle, uint32_t clockSpeed) {
@@ -120,47 +248,34 @@ static void TM_I2C_FillSettings(I2C_HandleTypeDef* Handle, uint32_t clockSpeed)
 }
 
 TM_I2C_Result_t TM_I2C_Init(I2C_TypeDef* I2Cx, TM_I2C_PinsPack_t pinspack, uint32_t clockSpeed) {	
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	const TM_I2C_INT_Config_t* cfg = TM_I2C_INT_GetConfig(I2Cx);
+	I2C_HandleTypeDef* Handle;
+	
+	/* Check valid I2C */
+	if (cfg == NULL) {
+		return TM_I2C_Result_Error;
+	}
+	Handle = cfg->Handle;
 	
 	/* Fill instance value */
 	Handle->Instance = I2Cx;
 	
-#ifdef I2C1
-	if (I2Cx == I2C1) {
-		/* Enable clock */
-		__HAL_RCC_I2C1_CLK_ENABLE();
-		
-		/* Enable pins */
-		TM_I2C1_INT_InitPins(pinspack);
-	}
-#endif
-#ifdef I2C2	
-	if (I2Cx == I2C2) {
-		/* Enable clock */
-		__HAL_RCC_I2C2_CLK_ENABLE();
-		
-		/* Enable pins */
-		TM_I2C2_INT_InitPins(pinspack);
-	} 
-#endif
-#ifdef I2C3
-	if (I2Cx == I2C3) {
-		/* Enable clock */
-		__HAL_RCC_I2C3_CLK_ENABLE();
-		
-		/* Enable pins */
-		TM_I2C3_INT_InitPins(pinspack);
-	}
-#endif
-#ifdef I2C4
-	if (I2Cx == I2C4) {
-		/* Enable clock */
-		__HAL_RCC_I2C4_CLK_ENABLE();
-		
-		/* Enable pins */
-		TM_I2C4_INT_InitPins(pinspack);
+	/* Register statistics */
+	TM_STATS_REGISTER(I2C_INT_STATS(I2Cx), cfg->Name);
+	
+	/* Recovery pins are set by pins initialization */
+	I2C_State[I2C_INT_ID(I2Cx)].SCL_Port = NULL;
+	I2C_State[I2C_INT_ID(I2Cx)].SDA_Port = NULL;
+	if (I2C_State[I2C_INT_ID(I2Cx)].Timeout == 0) {
+		I2C_State[I2C_INT_ID(I2Cx)].Timeout = I2C_TIMEOUT_VALUE;
 	}
-#endif
+	
+	/* Enable clock */
+	RCC->APB1ENR |= cfg->RCC_Mask;
+	(void)RCC->APB1ENR;
+	
+	/* Enable pins */
+	cfg->InitPins(pinspack);
 	
 	/* Fill settings */
 	TM_I2C_FillSettings(Handle, clockSpeed);
@@ -173,30 +288,31 @@ TM_I2C_Result_t TM_I2C_Init(I2C_TypeDef* I2Cx, TM_I2C_PinsPack_t pinspack, uint3
 	HAL_I2CEx_ConfigAnalogFilter(Handle, I2C_ANALOGFILTER_ENABLE);
 #endif
 	
+#if I2C_QUEUE_SIZE > 0
+	/* Enable interrupts for queue */
+	TM_I2C_INT_EnableInterrupts(I2Cx);
+#endif
+	
 	/* Return OK */
 	return TM_I2C_Result_Ok;
 }
 
 TM_I2C_Result_t TM_I2C_Read(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t* data) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 1, 0);
 	
 	/* Send address */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, &register_address, 1, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, &register_address, 1, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
 	}
 	
 	/* Receive multiple byte */
-	if (HAL_I2C_Master_Receive(Handle, device_address, data, 1, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Receive(Handle, device_address, data, 1, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -207,25 +323,21 @@ TM_I2C_Result_t TM_I2C_Read(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t r
 }
 
 TM_I2C_Result_t TM_I2C_ReadMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t* data, uint16_t count) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, count, 0);
 	
 	/* Send register address */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, &register_address, 1, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, &register_address, 1, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
 	}
 	
 	/* Receive multiple byte */
-	if (HAL_I2C_Master_Receive(Handle, device_address, data, count, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Receive(Handle, device_address, data, count, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -236,14 +348,12 @@ TM_I2C_Result_t TM_I2C_ReadMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint
 }
 
 TM_I2C_Result_t TM_I2C_ReadNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 1, 0);
 
 	/* Receive single byte without specifying  */
-	if (HAL_I2C_Master_Receive(Handle, (uint16_t)device_address, data, 1, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Receive(Handle, (uint16_t)device_address, data, 1, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -254,14 +364,12 @@ TM_I2C_Result_t TM_I2C_ReadNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address,
 }
 
 TM_I2C_Result_t TM_I2C_ReadMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, count, 0);
 
 	/* Receive multi bytes without specifying  */
-	if (HAL_I2C_Master_Receive(Handle, (uint16_t)device_address, data, count, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Receive(Handle, (uint16_t)device_address, data, count, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -273,18 +381,16 @@ TM_I2C_Result_t TM_I2C_ReadMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_add
 
 TM_I2C_Result_t TM_I2C_Write(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t data) {
 	uint8_t d[2];
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 0, 1);
 		
 	/* Format array to send */
 	d[0] = register_address;
 	d[1] = data;
 	
 	/* Try to transmit via I2C */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, (uint8_t *)d, 2, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, (uint8_t *)d, 2, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -295,14 +401,12 @@ TM_I2C_Result_t TM_I2C_Write(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t
 }
 
 TM_I2C_Result_t TM_I2C_WriteMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t* data, uint16_t count) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 0, count);
 
 	/* Try to transmit via I2C */
-	if (HAL_I2C_Mem_Write(Handle, device_address, register_address, register_address > 0xFF ? I2C_MEMADD_SIZE_16BIT : I2C_MEMADD_SIZE_8BIT, data, count, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Mem_Write(Handle, device_address, register_address, register_address > 0xFF ? I2C_MEMADD_SIZE_16BIT : I2C_MEMADD_SIZE_8BIT, data, count, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -313,14 +417,12 @@ TM_I2C_Result_t TM_I2C_WriteMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uin
 }
 
 TM_I2C_Result_t TM_I2C_WriteNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t data) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 0, 1);
 	
 	/* Try to transmit via I2C */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, &data, 1, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, &data, 1, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -331,14 +433,12 @@ TM_I2C_Result_t TM_I2C_WriteNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address
 }
 
 TM_I2C_Result_t TM_I2C_WriteMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 0, count);
 	
 	/* Try to transmit via I2C */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, data, count, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, data, count, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -350,7 +450,7 @@ TM_I2C_Result_t TM_I2C_WriteMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_ad
 
 TM_I2C_Result_t TM_I2C_Write16(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t data) {
 	uint8_t d[3];
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 0, 1);
 		
 	/* Format array to send */
 	d[0] = (register_address >> 8) & 0xFF; /* High byte */
@@ -358,11 +458,9 @@ TM_I2C_Result_t TM_I2C_Write16(I2C_TypeDef* I2Cx, uint8_t device_address, uint16
 	d[2] = data;                           /* Data byte */
 	
 	/* Try to transmit via I2C */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, (uint8_t *)d, 3, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, (uint8_t *)d, 3, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -374,29 +472,25 @@ TM_I2C_Result_t TM_I2C_Write16(I2C_TypeDef* I2Cx, uint8_t device_address, uint16
 
 TM_I2C_Result_t TM_I2C_Read16(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t* data) {
 	uint8_t adr[2];
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 1, 0);
 	
 	/* Format I2C address */
 	adr[0] = (register_address >> 8) & 0xFF; /* High byte */
 	adr[1] = (register_address) & 0xFF;      /* Low byte */
 	
 	/* Send address */
-	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, adr, 2, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Transmit(Handle, (uint16_t)device_address, adr, 2, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
 	}
 	
 	/* Receive multiple byte */
-	if (HAL_I2C_Master_Receive(Handle, device_address, data, 1, 1000) != HAL_OK) {
-		/* Check error */
-		if (HAL_I2C_GetError(Handle) != HAL_I2C_ERROR_AF) {
-			
-		}
+	if (HAL_I2C_Master_Receive(Handle, device_address, data, 1, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
 		
 		/* Return error */
 		return TM_I2C_Result_Error;
@@ -407,7 +501,7 @@ TM_I2C_Result_t TM_I2C_Read16(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_
 }
 
 TM_I2C_Result_t TM_I2C_IsDeviceConnected(I2C_TypeDef* I2Cx, uint8_t device_address) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, 0, 0);
 	
 	/* Check if device is ready for communication */
 	if (HAL_I2C_IsDeviceReady(Handle, device_address, 2, 5) != HAL_OK) {
@@ -429,16 +523,22 @@ TM_I2C_Result_t TM_I2C_WriteReadRepeatedStart(
 	uint8_t* read_data,
 	uint16_t read_count
 ) {
-	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	I2C_HandleTypeDef* Handle = TM_I2C_INT_Prepare(I2Cx, read_count, write_count);
 	
 	/* Write command to device */
-	if (HAL_I2C_Mem_Write(Handle, device_address, write_register_address, I2C_MEMADD_SIZE_8BIT, write_data, write_count, 1000) != HAL_OK) {
+	if (HAL_I2C_Mem_Write(Handle, device_address, write_register_address, I2C_MEMADD_SIZE_8BIT, write_data, write_count, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
+		
 		/* Return error */
 		return TM_I2C_Result_Error;
 	}
 	
 	/* Read data from controller */
-	if (HAL_I2C_Mem_Read(Handle, device_address, read_register_address, I2C_MEMADD_SIZE_8BIT, read_data, read_count, 1000) != HAL_OK) {
+	if (HAL_I2C_Mem_Read(Handle, device_address, read_register_address, I2C_MEMADD_SIZE_8BIT, read_data, read_count, TM_I2C_INT_GetTimeout(Handle)) != HAL_OK) {
+		/* Count error and recover bus */
+		TM_I2C_INT_Error(Handle, device_address);
+		
 		/* Return error */
 		return TM_I2C_Result_Error;
 	}
@@ -447,28 +547,616 @@ TM_I2C_Result_t TM_I2C_WriteReadRepeatedStart(
 	return TM_I2C_Result_Ok;
 }
 
+TM_I2C_Result_t TM_I2C_SetTimeout(I2C_TypeDef* I2Cx, uint32_t Timeout) {
+	/* Check valid I2C */
+	if (TM_I2C_INT_GetConfig(I2Cx) == NULL || Timeout == 0) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Save timeout */
+	I2C_State[I2C_INT_ID(I2Cx)].Timeout = Timeout;
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+void TM_I2C_SetRecoveryPins(I2C_TypeDef* I2Cx, GPIO_TypeDef* SCL_Port, uint16_t SCL_Pin, GPIO_TypeDef* SDA_Port, uint16_t SDA_Pin) {
+	TM_I2C_INT_State_t* State = &I2C_State[I2C_INT_ID(I2Cx)];
+	
+	/* Save pins */
+	State->SCL_Port = SCL_Port;
+	State->SCL_Pin = SCL_Pin;
+	State->SDA_Port = SDA_Port;
+	State->SDA_Pin = SDA_Pin;
+}
+
+TM_I2C_Result_t TM_I2C_Recover(I2C_TypeDef* I2Cx) {
+	const TM_I2C_INT_Config_t* cfg = TM_I2C_INT_GetConfig(I2Cx);
+	TM_I2C_INT_State_t* State = &I2C_State[I2C_INT_ID(I2Cx)];
+	uint32_t timeout;
+	uint8_t i;
+	
+	/* Check valid I2C */
+	if (cfg == NULL) {
+		return TM_I2C_Result_Error;
+	}
+	State->Recoveries++;
+	
+	/* Disable peripheral, pins are released */
+	__HAL_I2C_DISABLE(cfg->Handle);
+	
+	/* Clock out stuck slave with GPIO, when pins are known */
+	if (State->SCL_Port != NULL && State->SDA_Port != NULL) {
+		/* Both lines released, pins are open drain */
+		TM_GPIO_SetPinHigh(State->SCL_Port, State->SCL_Pin);
+		TM_GPIO_SetPinHigh(State->SDA_Port, State->SDA_Pin);
+		TM_GPIO_SetPinAsOutput(State->SCL_Port, State->SCL_Pin);
+		TM_GPIO_SetPinAsOutput(State->SDA_Port, State->SDA_Pin);
+		TM_I2C_INT_Delay();
+		
+		/* Up to 9 clocks, until slave releases SDA */
+		for (i = 0; i < 9 && !TM_GPIO_GetInputPinValue(State->SDA_Port, State->SDA_Pin); i++) {
+			TM_GPIO_SetPinLow(State->SCL_Port, State->SCL_Pin);
+			TM_I2C_INT_Delay();
+			TM_GPIO_SetPinHigh(State->SCL_Port, State->SCL_Pin);
+			
+			/* Slave can stretch clock, wait limited time */
+			for (timeout = 1000; timeout && !TM_GPIO_GetInputPinValue(State->SCL_Port, State->SCL_Pin); timeout--) {
+				TM_I2C_INT_Delay();
+			}
+			TM_I2C_INT_Delay();
+		}
+		
+		/* Generate STOP condition, SDA goes high while SCL is high */
+		TM_GPIO_SetPinLow(State->SCL_Port, State->SCL_Pin);
+		TM_I2C_INT_Delay();
+		TM_GPIO_SetPinLow(State->SDA_Port, State->SDA_Pin);
+		TM_I2C_INT_Delay();
+		TM_GPIO_SetPinHigh(State->SCL_Port, State->SCL_Pin);
+		TM_I2C_INT_Delay();
+		TM_GPIO_SetPinHigh(State->SDA_Port, State->SDA_Pin);
+		TM_I2C_INT_Delay();
+		
+		/* Give pins back to I2C */
+		TM_GPIO_SetPinAsAlternate(State->SCL_Port, State->SCL_Pin);
+		TM_GPIO_SetPinAsAlternate(State->SDA_Port, State->SDA_Pin);
+	}
+	
+	/* Reset peripheral, clears stuck busy flag */
+	RCC->APB1RSTR |= cfg->RCC_Mask;
+	RCC->APB1RSTR &= ~cfg->RCC_Mask;
+	
+	/* Initialize again with the same settings */
+	cfg->Handle->State = HAL_I2C_STATE_RESET;
+	HAL_I2C_Init(cfg->Handle);
+#if defined(I2C_ANALOGFILTER_ENABLE)
+	HAL_I2CEx_ConfigAnalogFilter(cfg->Handle, I2C_ANALOGFILTER_ENABLE);
+#endif
+	
+	/* Check if bus is free now */
+	if (__HAL_I2C_GET_FLAG(cfg->Handle, I2C_FLAG_BUSY) || (State->SDA_Port != NULL && !TM_GPIO_GetInputPinValue(State->SDA_Port, State->SDA_Pin))) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+TM_I2C_Result_t TM_I2C_GetStats(I2C_TypeDef* I2Cx, uint8_t device_address, TM_I2C_Stats_t* Stats) {
+	TM_I2C_Stats_t* s = TM_I2C_INT_GetStats(I2Cx, device_address, 0);
+	
+	/* Check if device has statistics */
+	if (s == NULL) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Copy statistics */
+	*Stats = *s;
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+uint32_t TM_I2C_GetRecoveries(I2C_TypeDef* I2Cx) {
+	/* Check valid I2C */
+	if (TM_I2C_INT_GetConfig(I2Cx) == NULL) {
+		return 0;
+	}
+	
+	/* Return number of recoveries */
+	return I2C_State[I2C_INT_ID(I2Cx)].Recoveries;
+}
+
+void TM_I2C_ResetStats(I2C_TypeDef* I2Cx) {
+	TM_I2C_INT_State_t* State = &I2C_State[I2C_INT_ID(I2Cx)];
+	
+	/* Clear all devices and counters */
+	memset(State->Stats, 0, sizeof(State->Stats));
+	State->Recoveries = 0;
+}
+
+#if I2C_QUEUE_SIZE > 0
+uint8_t TM_I2C_ReadMultiQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param) {
+	TM_I2C_Transaction_t t;
+	
+	/* Fill transaction */
+	t.Address = device_address;
+	t.Read = 1;
+	t.Register = register_address;
+	t.RegisterSize = I2C_MEMADD_SIZE_8BIT;
+	t.Data = data;
+	t.Count = count;
+	t.Callback = Callback;
+	t.Param = Param;
+	
+	/* Add to queue */
+	return TM_I2C_INT_Enqueue(I2Cx, &t);
+}
+
+uint8_t TM_I2C_WriteMultiQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param) {
+	TM_I2C_Transaction_t t;
+	
+	/* Fill transaction */
+	t.Address = device_address;
+	t.Read = 0;
+	t.Register = register_address;
+	t.RegisterSize = register_address > 0xFF ? I2C_MEMADD_SIZE_16BIT : I2C_MEMADD_SIZE_8BIT;
+	t.Data = data;
+	t.Count = count;
+	t.Callback = Callback;
+	t.Param = Param;
+	
+	/* Add to queue */
+	return TM_I2C_INT_Enqueue(I2Cx, &t);
+}
+
+uint8_t TM_I2C_ReadMultiNoRegisterQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param) {
+	TM_I2C_Transaction_t t;
+	
+	/* Fill transaction */
+	t.Address = device_address;
+	t.Read = 1;
+	t.Register = 0;
+	t.RegisterSize = 0;
+	t.Data = data;
+	t.Count = count;
+	t.Callback = Callback;
+	t.Param = Param;
+	
+	/* Add to queue */
+	return TM_I2C_INT_Enqueue(I2Cx, &t);
+}
+
+uint8_t TM_I2C_WriteMultiNoRegisterQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param) {
+	TM_I2C_Transaction_t t;
+	
+	/* Fill transaction */
+	t.Address = device_address;
+	t.Read = 0;
+	t.Register = 0;
+	t.RegisterSize = 0;
+	t.Data = data;
+	t.Count = count;
+	t.Callback = Callback;
+	t.Param = Param;
+	
+	/* Add to queue */
+	return TM_I2C_INT_Enqueue(I2Cx, &t);
+}
+
+uint16_t TM_I2C_QueuePending(I2C_TypeDef* I2Cx) {
+	TM_I2C_INT_Queue_t* Q = TM_I2C_INT_GetQueue(I2Cx);
+	
+	/* Check queue */
+	if (Q == NULL) {
+		return 0;
+	}
+	
+	/* Return number of transactions */
+	return Q->Count;
+}
+
+uint8_t TM_I2C_GroupRead(TM_I2C_Group_t* Group) {
+	TM_I2C_GroupRead_t* r;
+	uint32_t irq;
+	uint8_t i;
+	
+	/* Check group */
+	if (Group->Pending || Group->Count == 0) {
+		return 0;
+	}
+	
+#if !defined(STM32F0xx)
+	/* Enable DWT cycle counter for timestamps */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	
+	/* One more pending, so group can not finish before all reads are queued */
+	Group->Errors = 0;
+	Group->Pending = Group->Count + 1;
+	
+	/* Disable interrupts, all buses start together */
+	irq = TM_NVIC_Lock();
+	
+	/* Take common timestamp */
+	Group->Timestamp = I2C_INT_TIME();
+	
+	/* Queue reads, read which can not be queued finishes with error */
+	for (i = 0; i < Group->Count; i++) {
+		r = &Group->Reads[i];
+		r->Group = Group;
+		r->Result = TM_I2C_Result_Ok;
+		if (!TM_I2C_ReadMultiQueued(r->I2Cx, r->Address, r->Register, r->Data, r->Count, TM_I2C_INT_GroupCallback, r)) {
+			r->Result = TM_I2C_Result_Error;
+			Group->Errors++;
+			Group->Pending--;
+		}
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Remove extra pending */
+	TM_I2C_INT_GroupDone(Group);
+	
+	/* Return OK */
+	return 1;
+}
+
+/* HAL callbacks, called from I2C interrupts */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c) {
+	TM_I2C_INT_Finished(hi2c, TM_I2C_Result_Ok);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c) {
+	TM_I2C_INT_Finished(hi2c, TM_I2C_Result_Ok);
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c) {
+	TM_I2C_INT_Finished(hi2c, TM_I2C_Result_Ok);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c) {
+	TM_I2C_INT_Finished(hi2c, TM_I2C_Result_Ok);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c) {
+	TM_I2C_INT_Queue_t* Q = TM_I2C_INT_GetQueue(hi2c->Instance);
+	
+	/* Count error of current transaction and recover bus before next one */
+	if (Q != NULL && Q->Count) {
+		TM_I2C_INT_Error(hi2c, Q->Queue[Q->Out].Address);
+	}
+	
+	/* Finish with error */
+	TM_I2C_INT_Finished(hi2c, TM_I2C_Result_Error);
+}
+
+/* Interrupt handlers */
+#if defined(STM32F0xx)
+#ifdef I2C_INT_USE_I2C1
+void I2C1_IRQHandler(void) {
+	HAL_I2C_EV_IRQHandler(&I2C1Handle);
+	HAL_I2C_ER_IRQHandler(&I2C1Handle);
+}
+#endif
+#ifdef I2C_INT_USE_I2C2
+void I2C2_IRQHandler(void) {
+	HAL_I2C_EV_IRQHandler(&I2C2Handle);
+	HAL_I2C_ER_IRQHandler(&I2C2Handle);
+}
+#endif
+#else
+#if defined(I2C_INT_USE_I2C1) && !defined(TM_I2C1_SLAVE)
+void I2C1_EV_IRQHandler(void) {
+	HAL_I2C_EV_IRQHandler(&I2C1Handle);
+}
+void I2C1_ER_IRQHandler(void) {
+	HAL_I2C_ER_IRQHandler(&I2C1Handle);
+}
+#endif
+#if defined(I2C_INT_USE_I2C2) && !defined(TM_I2C2_SLAVE)
+void I2C2_EV_IRQHandler(void) {
+	HAL_I2C_EV_IRQHandler(&I2C2Handle);
+}
+void I2C2_ER_IRQHandler(void) {
+	HAL_I2C_ER_IRQHandler(&I2C2Handle);
+}
+#endif
+#if defined(I2C_INT_USE_I2C3) && !defined(TM_I2C3_SLAVE)
+void I2C3_EV_IRQHandler(void) {
+	HAL_I2C_EV_IRQHandler(&I2C3Handle);
+}
+void I2C3_ER_IRQHandler(void) {
+	HAL_I2C_ER_IRQHandler(&I2C3Handle);
+}
+#endif
+#if defined(I2C_INT_USE_I2C4) && !defined(TM_I2C4_SLAVE)
+void I2C4_EV_IRQHandler(void) {
+	HAL_I2C_EV_IRQHandler(&I2C4Handle);
+}
+void I2C4_ER_IRQHandler(void) {
+	HAL_I2C_ER_IRQHandler(&I2C4Handle);
+}
+#endif
+#endif
+#endif
+
 __weak void TM_I2C_InitCustomPinsCallback(I2C_TypeDef* I2Cx, uint16_t AlternateFunction) {
 	/* Custom user function. */
 	/* In case user needs functionality for custom pins, this function should be declared outside this library */
 }
 
 /* Private functions */
-#ifdef I2C1
+static I2C_HandleTypeDef* TM_I2C_INT_Prepare(I2C_TypeDef* I2Cx, uint16_t rx, uint16_t tx) {
+	I2C_HandleTypeDef* Handle = TM_I2C_GetHandle(I2Cx);
+	
+	/* Count transfer */
+	TM_STATS_INC(I2C_INT_STATS(I2Cx), Transfers);
+	TM_STATS_ADD(I2C_INT_STATS(I2Cx), RxBytes, rx);
+	TM_STATS_ADD(I2C_INT_STATS(I2Cx), TxBytes, tx);
+	
+	/* Bus is busy while no transfer is in progress, slave holds line low. */
+	/* Recover now instead of waiting for HAL busy flag timeout */
+	if (Handle && HAL_I2C_GetState(Handle) == HAL_I2C_STATE_READY && __HAL_I2C_GET_FLAG(Handle, I2C_FLAG_BUSY)) {
+		TM_I2C_Recover(I2Cx);
+	}
+	
+	/* Return handle */
+	return Handle;
+}
+
+static uint32_t TM_I2C_INT_GetTimeout(I2C_HandleTypeDef* Handle) {
+	uint32_t timeout = I2C_State[I2C_INT_ID(Handle->Instance)].Timeout;
+	
+	/* Use default when I2C was not initialized by library */
+	return timeout ? timeout : I2C_TIMEOUT_VALUE;
+}
+
+static void TM_I2C_INT_Error(I2C_HandleTypeDef* Handle, uint8_t device_address) {
+	TM_I2C_Stats_t* s = TM_I2C_INT_GetStats(Handle->Instance, device_address, 1);
+	uint32_t error = HAL_I2C_GetError(Handle);
+	
+	/* Count failed transfer */
+	TM_STATS_INC(I2C_INT_STATS(Handle->Instance), Errors);
+	if (error & HAL_I2C_ERROR_TIMEOUT) {
+		TM_STATS_INC(I2C_INT_STATS(Handle->Instance), Timeouts);
+	}
+	
+	/* Device did not acknowledge, bus is OK */
+	if (error == HAL_I2C_ERROR_AF) {
+		if (s) {
+			s->Nacks++;
+		}
+		return;
+	}
+	
+	/* Bus error, arbitration lost or timeout */
+	if (s) {
+		s->Errors++;
+	}
+	
+	/* Peripheral is used by other transfer, do not touch it */
+	if (HAL_I2C_GetState(Handle) != HAL_I2C_STATE_READY) {
+		return;
+	}
+	
+	/* Release bus and reset peripheral */
+	TM_I2C_Recover(Handle->Instance);
+}
+
+static TM_I2C_Stats_t* TM_I2C_INT_GetStats(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t add) {
+	TM_I2C_Stats_t* Stats = I2C_State[I2C_INT_ID(I2Cx)].Stats;
+	uint8_t i;
+	
+	/* Find device */
+	for (i = 0; i < I2C_STATS_DEVICES; i++) {
+		if (Stats[i].Address == device_address) {
+			return &Stats[i];
+		}
+	}
+	
+	/* Add new device to free entry */
+	for (i = 0; add && i < I2C_STATS_DEVICES; i++) {
+		if (Stats[i].Address == 0) {
+			Stats[i].Address = device_address;
+			return &Stats[i];
+		}
+	}
+	
+	/* Table is full */
+	return NULL;
+}
+
+static void TM_I2C_INT_Delay(void) {
+	volatile uint32_t i;
+	
+	/* About 5us, half of 100kHz clock period */
+	for (i = SystemCoreClock / 1000000; i; i--);
+}
+
+#if I2C_QUEUE_SIZE > 0
+static TM_I2C_INT_Queue_t* TM_I2C_INT_GetQueue(I2C_TypeDef* I2Cx) {
+	const TM_I2C_INT_Config_t* cfg = TM_I2C_INT_GetConfig(I2Cx);
+	
+	/* Return queue or invalid */
+	return cfg ? cfg->Queue : NULL;
+}
+
+static uint8_t TM_I2C_INT_Enqueue(I2C_TypeDef* I2Cx, TM_I2C_Transaction_t* Transaction) {
+	TM_I2C_INT_Queue_t* Q = TM_I2C_INT_GetQueue(I2Cx);
+	uint32_t irq;
+	uint8_t start;
+	
+	/* Check queue */
+	if (Q == NULL) {
+		return 0;
+	}
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Check for free entry */
+	if (Q->Count >= I2C_QUEUE_SIZE) {
+		TM_NVIC_Unlock(irq);
+		TM_STATS_INC(I2C_INT_STATS(I2Cx), Dropped);
+		return 0;
+	}
+	
+	/* Save transaction */
+	Q->Queue[Q->In] = *Transaction;
+	if (++Q->In >= I2C_QUEUE_SIZE) {
+		Q->In = 0;
+	}
+	
+	/* Start if queue was empty */
+	start = (Q->Count++ == 0);
+	TM_STATS_MAX(I2C_INT_STATS(I2Cx), HighWater, Q->Count);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Start transaction, I2C interrupts continue with next ones */
+	if (start) {
+		TM_I2C_INT_StartNext(TM_I2C_GetHandle(I2Cx), Q);
+	}
+	
+	/* Return OK */
+	return 1;
+}
+
+static void TM_I2C_INT_StartNext(I2C_HandleTypeDef* Handle, TM_I2C_INT_Queue_t* Q) {
+	TM_I2C_Transaction_t* t;
+	HAL_StatusTypeDef status;
+	
+	/* Check for pending transaction */
+	if (Q->Count == 0) {
+		return;
+	}
+	
+	/* Get first transaction */
+	t = &Q->Queue[Q->Out];
+	
+	/* Count transfer */
+	TM_STATS_INC(I2C_INT_STATS(Handle->Instance), Transfers);
+	if (t->Read) {
+		TM_STATS_ADD(I2C_INT_STATS(Handle->Instance), RxBytes, t->Count);
+	} else {
+		TM_STATS_ADD(I2C_INT_STATS(Handle->Instance), TxBytes, t->Count);
+	}
+	
+	/* Start with DMA if DMA handles are linked, otherwise with interrupts */
+	if (t->RegisterSize) {
+		if (t->Read) {
+			status = Handle->hdmarx ? HAL_I2C_Mem_Read_DMA(Handle, t->Address, t->Register, t->RegisterSize, t->Data, t->Count) :
+				HAL_I2C_Mem_Read_IT(Handle, t->Address, t->Register, t->RegisterSize, t->Data, t->Count);
+		} else {
+			status = Handle->hdmatx ? HAL_I2C_Mem_Write_DMA(Handle, t->Address, t->Register, t->RegisterSize, t->Data, t->Count) :
+				HAL_I2C_Mem_Write_IT(Handle, t->Address, t->Register, t->RegisterSize, t->Data, t->Count);
+		}
+	} else {
+		if (t->Read) {
+			status = Handle->hdmarx ? HAL_I2C_Master_Receive_DMA(Handle, t->Address, t->Data, t->Count) :
+				HAL_I2C_Master_Receive_IT(Handle, t->Address, t->Data, t->Count);
+		} else {
+			status = Handle->hdmatx ? HAL_I2C_Master_Transmit_DMA(Handle, t->Address, t->Data, t->Count) :
+				HAL_I2C_Master_Transmit_IT(Handle, t->Address, t->Data, t->Count);
+		}
+	}
+	
+	/* Could not start, finish with error, next one is started from there */
+	if (status != HAL_OK) {
+		TM_I2C_INT_Finished(Handle, TM_I2C_Result_Error);
+	}
+}
+
+static void TM_I2C_INT_Finished(I2C_HandleTypeDef* Handle, TM_I2C_Result_t result) {
+	TM_I2C_INT_Queue_t* Q = TM_I2C_INT_GetQueue(Handle->Instance);
+	TM_I2C_Transaction_t t;
+	
+	/* Check for transaction in progress */
+	if (Q == NULL || Q->Count == 0) {
+		return;
+	}
+	
+	/* Remove from queue before callback, so callback can add new transaction */
+	t = Q->Queue[Q->Out];
+	if (++Q->Out >= I2C_QUEUE_SIZE) {
+		Q->Out = 0;
+	}
+	Q->Count--;
+	
+	/* Call user callback */
+	if (t.Callback) {
+		t.Callback(Handle->Instance, t.Address, t.Data, t.Count, result, t.Param);
+	}
+	
+	/* Start next transaction */
+	TM_I2C_INT_StartNext(Handle, Q);
+}
+
+static void TM_I2C_INT_GroupCallback(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_I2C_GroupRead_t* r = (TM_I2C_GroupRead_t *)Param;
+	TM_I2C_Group_t* Group = (TM_I2C_Group_t *)r->Group;
+	
+	/* Save result */
+	r->Result = result;
+	if (result != TM_I2C_Result_Ok) {
+		Group->Errors++;
+	}
+	
+	/* Finish read */
+	TM_I2C_INT_GroupDone(Group);
+}
+
+static void TM_I2C_INT_GroupDone(TM_I2C_Group_t* Group) {
+	uint32_t irq;
+	uint8_t done;
+	
+	/* Interrupts of other I2Cs can finish reads at the same time */
+	irq = TM_NVIC_Lock();
+	done = (--Group->Pending == 0);
+	TM_NVIC_Unlock(irq);
+	
+	/* Last read finished */
+	if (done && Group->Callback) {
+		Group->Callback(Group, Group->Param);
+	}
+}
+
+static void TM_I2C_INT_EnableInterrupts(I2C_TypeDef* I2Cx) {
+	const TM_I2C_INT_Config_t* cfg = TM_I2C_INT_GetConfig(I2Cx);
+	IRQn_Type ev = cfg->EV_IRQ, er = cfg->ER_IRQ;
+	uint32_t sub = cfg->SubPriority;
+	
+	/* Set priority and enable interrupts */
+	HAL_NVIC_SetPriority(ev, I2C_NVIC_PRIORITY, sub);
+	HAL_NVIC_SetPriority(er, I2C_NVIC_PRIORITY, sub);
+	HAL_NVIC_EnableIRQ(ev);
+	HAL_NVIC_EnableIRQ(er);
+}
+#endif
+
+#ifdef I2C_INT_USE_I2C1
 static void TM_I2C1_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOB)
 	if (pinspack == TM_I2C_PinsPack_1) {
 		TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_6 | GPIO_PIN_7, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C1);
+		TM_I2C_SetRecoveryPins(I2C1, GPIOB, GPIO_PIN_6, GPIOB, GPIO_PIN_7);
 	}
 #endif
 #if defined(GPIOB)
 	if (pinspack == TM_I2C_PinsPack_2) {
 		TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_8 | GPIO_PIN_9, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C1);
+		TM_I2C_SetRecoveryPins(I2C1, GPIOB, GPIO_PIN_8, GPIOB, GPIO_PIN_9);
 	}
 #endif
 #if defined(GPIOB)
 	if (pinspack == TM_I2C_PinsPack_3) {
 		TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_6 | GPIO_PIN_9, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C1);
+		TM_I2C_SetRecoveryPins(I2C1, GPIOB, GPIO_PIN_6, GPIOB, GPIO_PIN_9);
 	}
 #endif
 	if (pinspack == TM_I2C_PinsPack_Custom) {
@@ -477,22 +1165,25 @@ static void TM_I2C1_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	}
 }
 #endif
-#ifdef I2C2
+#ifdef I2C_INT_USE_I2C2
 static void TM_I2C2_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOB)
 	if (pinspack == TM_I2C_PinsPack_1) {
 		TM_GPIO_InitAlternate(GPIOB, GPIO_PIN_10 | GPIO_PIN_11, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C2);
+		TM_I2C_SetRecoveryPins(I2C2, GPIOB, GPIO_PIN_10, GPIOB, GPIO_PIN_11);
 	}
 #endif
 #if defined(GPIOF)
 	if (pinspack == TM_I2C_PinsPack_2) {
 		TM_GPIO_InitAlternate(GPIOF, GPIO_PIN_0 | GPIO_PIN_1, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C2);
+		TM_I2C_SetRecoveryPins(I2C2, GPIOF, GPIO_PIN_1, GPIOF, GPIO_PIN_0);
 	}
 #endif
 #if defined(GPIOH)
 	if (pinspack == TM_I2C_PinsPack_3) {
 		TM_GPIO_InitAlternate(GPIOH, GPIO_PIN_4 | GPIO_PIN_5, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C2);
+		TM_I2C_SetRecoveryPins(I2C2, GPIOH, GPIO_PIN_4, GPIOH, GPIO_PIN_5);
 	}
 #endif
 	if (pinspack == TM_I2C_PinsPack_Custom) {
@@ -501,18 +1192,20 @@ static void TM_I2C2_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	}
 }
 #endif
-#ifdef I2C3
+#ifdef I2C_INT_USE_I2C3
 static void TM_I2C3_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOA) && defined(GPIOC)
 	if (pinspack == TM_I2C_PinsPack_1) {
 		TM_GPIO_InitAlternate(GPIOA, GPIO_PIN_8, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C3);
 		TM_GPIO_InitAlternate(GPIOC, GPIO_PIN_9, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C3);
+		TM_I2C_SetRecoveryPins(I2C3, GPIOA, GPIO_PIN_8, GPIOC, GPIO_PIN_9);
 	}
 #endif
 #if defined(GPIOH)
 	if (pinspack == TM_I2C_PinsPack_2) {
 		TM_GPIO_InitAlternate(GPIOH, GPIO_PIN_7 | GPIO_PIN_8, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C3);
+		TM_I2C_SetRecoveryPins(I2C3, GPIOH, GPIO_PIN_7, GPIOH, GPIO_PIN_8);
 	}
 #endif
 	if (pinspack == TM_I2C_PinsPack_Custom) {
@@ -521,25 +1214,29 @@ static void TM_I2C3_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	}
 }
 #endif
-#ifdef I2C4
+#ifdef I2C_INT_USE_I2C4
 static void TM_I2C4_INT_InitPins(TM_I2C_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOD)
 	if (pinspack == TM_I2C_PinsPack_1) {
 		TM_GPIO_InitAlternate(GPIOD, GPIO_PIN_12 | GPIO_PIN_13, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C4);
+		TM_I2C_SetRecoveryPins(I2C4, GPIOD, GPIO_PIN_12, GPIOD, GPIO_PIN_13);
 	}
 #endif
 #if defined(GPIOF)
 	if (pinspack == TM_I2C_PinsPack_2) {
 		TM_GPIO_InitAlternate(GPIOF, GPIO_PIN_1 | GPIO_PIN_0, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C4);
+		TM_I2C_SetRecoveryPins(I2C4, GPIOF, GPIO_PIN_1, GPIOF, GPIO_PIN_0);
 	}
 	if (pinspack == TM_I2C_PinsPack_3) {
 		TM_GPIO_InitAlternate(GPIOF, GPIO_PIN_14 | GPIO_PIN_15, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C4);
+		TM_I2C_SetRecoveryPins(I2C4, GPIOF, GPIO_PIN_14, GPIOF, GPIO_PIN_15);
 	}
 #endif
 #if defined(GPIOH)
 	if (pinspack == TM_I2C_PinsPack_4) {
 		TM_GPIO_InitAlternate(GPIOH, GPIO_PIN_11 | GPIO_PIN_12, TM_GPIO_OType_OD, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Medium, GPIO_AF4_I2C4);
+		TM_I2C_SetRecoveryPins(I2C4, GPIOH, GPIO_PIN_11, GPIOH, GPIO_PIN_12);
 	}
 #endif
 	/* Init pins */
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-16-i2c-for-stm32fxxx-devices/
- * @version v1.0
+ * @version v1.8
  * @ide     Keil uVision
  * @license MIT
  * @brief   I2C library for STM32Fxxx
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_I2C_H
-#define TM_I2C_H 100
+#define TM_I2C_H 180
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -71,12 +71,126 @@ I2C4   |PD12  PD13   |PF1   PF0    |PF14  PF15   |PH11  PH12
  * In case these pins are not good for you, you can use
  * @ref TM_I2C_PinsPack_Custom in @ref TM_I2C_Init() function and callback function will be called,
  * where you can initialize your custom pinout for your I2C peripheral
+ *
+ * \par Transaction queue
+ *
+ * All read and write functions block until transfer is finished. When more devices share one bus,
+ * use queued functions instead. They only save transaction (device address, register, pointer to data and callback)
+ * to queue for I2C peripheral and return immediately. Transactions are then done one after another
+ * from I2C event and error interrupts and callback is called for each finished transaction.
+ *
+ * If DMA handles are linked to I2C handle (get it with @ref TM_I2C_GetHandle), DMA is used for data instead of interrupt per byte.
+ *
+ * Queue is disabled by default, because library then implements I2C interrupt handlers and HAL I2C callbacks.
+ * To enable it, open defines.h file and add define:
+ *
+\code
+//Number of transactions in queue for each I2C
+#define I2C_QUEUE_SIZE        8
+//I2C NVIC preemption priority
+#define I2C_NVIC_PRIORITY     0x06
+\endcode
+ *
+ * @note   Data are not copied, memory must stay valid until callback is called
+ * @note   Do not use blocking functions on I2C peripheral while its queue is not empty
+ * @note   Interrupt handlers are not implemented for I2Cs marked with TM_I2Cx_SLAVE define, they are used by @ref TM_I2C_SLAVE library
+ *
+ * \par Group reads
+ *
+ * Sensors on different I2C peripherals can be read at the same time with @ref TM_I2C_GroupRead.
+ * Reads of group are added to queues of their I2Cs in one critical section, so all buses start together
+ * and slow device on one bus does not delay others. Group callback is called once, when last read is finished.
+ * All results have common timestamp, taken when group was started.
+ *
+\code
+uint8_t Accel1[6], Accel2[6], Accel3[6];
+
+TM_I2C_GroupRead_t Reads[] = {
+    {I2C1, 0xD0, 0x3B, Accel1, 6},
+    {I2C2, 0xD0, 0x3B, Accel2, 6},
+    {I2C3, 0xD0, 0x3B, Accel3, 6},
+};
+TM_I2C_Group_t Group = {Reads, 3, GroupFinished, NULL};
+
+//Start reads on all buses, GroupFinished is called when all are done
+TM_I2C_GroupRead(&Group);
+\endcode
+ *
+ * Timestamp is DWT cycle counter on STM32F4xx and STM32F7xx and milliseconds tick on STM32F0xx.
+ *
+ * \par Error handling and bus recovery
+ *
+ * Blocking functions wait at most @ref I2C_TIMEOUT_VALUE milliseconds for each step of transfer,
+ * timeout can be changed for each I2C with @ref TM_I2C_SetTimeout.
+ *
+ * When slave holds SDA low (for example reset in the middle of transfer), bus stays busy and HAL would wait for long time.
+ * Library checks this before each blocking transfer and after each error, except when device did not acknowledge:
+ *  - Up to 9 clocks are generated on SCL with GPIO until slave releases SDA, followed by STOP condition
+ *  - I2C peripheral is reset and initialized again with the same settings
+ *
+ * Pins for recovery are known for all pinspacks. With custom pins, call @ref TM_I2C_SetRecoveryPins
+ * in @ref TM_I2C_InitCustomPinsCallback, otherwise only peripheral is reset.
+ *
+ * Number of NACKs and other errors is counted for each device, read it with @ref TM_I2C_GetStats.
+ *
+\code
+//Timeout for blocking transfers in milliseconds
+#define I2C_TIMEOUT_VALUE     10
+//Number of devices on each I2C with error statistics
+#define I2C_STATS_DEVICES     4
+\endcode
+ *
+ * \par Enabled I2Cs only
+ *
+ * By default, handles, queues, state and interrupt handlers are compiled for all I2Cs on device.
+ * When at least one I2C is enabled in defines.h, only enabled I2Cs are included.
+ * With only one I2C enabled, state has one entry and lookup from I2C pointer is resolved at compile time.
+ *
+\code
+//Change x with 1-4, to match your I2C
+#define TM_I2Cx_ENABLED
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added optional interrupt driven transaction queue for each I2C peripheral
+  
+ Version 1.2
+  - October 14, 2026
+  - I2C handles, clocks, pins and IRQs are taken from constant table instead of if chains
+  
+ Version 1.3
+  - October 14, 2026
+  - Default timeout is 10ms instead of 1000ms, added TM_I2C_SetTimeout function
+  - Added bus recovery with 9 clocks and peripheral reset on errors and stuck bus
+  - Added error statistics for each device
+
+ Version 1.4
+  - October 14, 2026
+  - Added optional TM STATS counters for each I2C, enabled with STATS_ENABLED
+
+ Version 1.5
+  - October 14, 2026
+  - Only I2Cs enabled with TM_I2Cx_ENABLED in defines.h are compiled in when at least one is enabled
+
+ Version 1.6
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+  - Default NVIC priority is taken from TM NVIC priority plan
+
+ Version 1.7
+  - October 14, 2026
+  - Queue interrupt handlers are not implemented for I2Cs used by TM I2C SLAVE library
+
+ Version 1.8
+  - October 14, 2026
+  - Added group reads on more I2C peripherals at the same time with common timestamp
 \endverbatim
  *
  * \par Dependencies
@@ -86,12 +200,16 @@ I2C4   |PD12  PD13   |PF1   PF0    |PF14  PF15   |PH11  PH12
  - defines.h
  - attributes.h
  - TM GPIO
+ - TM STATS
+ - string.h
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "attributes.h"
 #include "tm_stm32_gpio.h"
+#include "tm_stm32_stats.h"
+#include "string.h"
 
 /**
  * @defgroup TM_I2C_Macros
@@ -105,6 +223,26 @@ I2C4   |PD12  PD13   |PF1   PF0    |PF14  PF15   |PH11  PH12
 #define TM_I2C_CLOCK_FAST_MODE_PLUS   1000000 /*!< I2C Fast mode plus speed */
 #define TM_I2C_CLOCK_HIGH_SPEED       3400000 /*!< I2C High speed */
 
+/* Number of transactions in queue for each I2C, 0 disables queue */
+#ifndef I2C_QUEUE_SIZE
+#define I2C_QUEUE_SIZE                0
+#endif
+
+/* NVIC preemption priority for I2C interrupts when queue is used */
+#ifndef I2C_NVIC_PRIORITY
+#define I2C_NVIC_PRIORITY             NVIC_PRIORITY_NORMAL
+#endif
+
+/* Default timeout for blocking transfers in milliseconds */
+#ifndef I2C_TIMEOUT_VALUE
+#define I2C_TIMEOUT_VALUE             10
+#endif
+
+/* Number of devices with error statistics on each I2C */
+#ifndef I2C_STATS_DEVICES
+#define I2C_STATS_DEVICES             4
+#endif
+
  /**
  * @}
  */
@@ -134,6 +272,68 @@ typedef enum {
 	TM_I2C_Result_Error      /*!< An error has occurred */
 } TM_I2C_Result_t;
 
+/**
+ * @brief  Queued transaction finished callback
+ * @note   Called from I2C interrupt
+ * @param  *I2Cx: Pointer to I2Cx peripheral where transaction was done
+ * @param  device_address: Device address of transaction
+ * @param  *data: Pointer to data passed to queued function
+ * @param  count: Number of bytes in transaction
+ * @param  result: Transaction result, member of @ref TM_I2C_Result_t enumeration
+ * @param  *Param: Pointer to user parameter passed to queued function
+ * @retval None
+ */
+typedef void (*TM_I2C_Callback_t)(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+
+/**
+ * @brief  Error statistics for one device
+ */
+typedef struct {
+	uint8_t Address;              /*!< Device address */
+	uint32_t Nacks;               /*!< Number of transfers not acknowledged by device */
+	uint32_t Errors;              /*!< Number of bus errors, lost arbitrations and timeouts */
+} TM_I2C_Stats_t;
+
+/**
+ * @brief  Queued I2C transaction
+ */
+typedef struct {
+	uint8_t Address;              /*!< Device address */
+	uint8_t Read;                 /*!< Set to 1 for read transaction */
+	uint16_t Register;            /*!< Register address */
+	uint16_t RegisterSize;        /*!< Register address size, 0 when not used, I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT */
+	uint8_t* Data;                /*!< Pointer to data */
+	uint16_t Count;               /*!< Number of bytes */
+	TM_I2C_Callback_t Callback;   /*!< Finished callback, can be NULL */
+	void* Param;                  /*!< User parameter for callback */
+} TM_I2C_Transaction_t;
+
+/**
+ * @brief  One read in group of reads
+ */
+typedef struct {
+	I2C_TypeDef* I2Cx;            /*!< Pointer to I2Cx peripheral for read */
+	uint8_t Address;              /*!< Device address */
+	uint8_t Register;             /*!< Register address */
+	uint8_t* Data;                /*!< Pointer to data array for read data */
+	uint16_t Count;               /*!< Number of bytes to read */
+	TM_I2C_Result_t Result;       /*!< Read result, valid when group callback is called */
+	void* Group;                  /*!< Private, pointer to group of read */
+} TM_I2C_GroupRead_t;
+
+/**
+ * @brief  Group of reads on more I2C peripherals
+ */
+typedef struct _TM_I2C_Group_t {
+	TM_I2C_GroupRead_t* Reads;                                   /*!< Pointer to reads of group */
+	uint8_t Count;                                               /*!< Number of reads */
+	void (*Callback)(struct _TM_I2C_Group_t* Group, void* Param); /*!< Callback when all reads are finished, called from I2C interrupt. Can be NULL */
+	void* Param;                                                 /*!< User parameter for callback */
+	uint32_t Timestamp;                                          /*!< Common timestamp of results, taken when reads were started */
+	volatile uint8_t Pending;                                    /*!< Number of reads in progress */
+	uint8_t Errors;                                              /*!< Number of failed reads */
+} TM_I2C_Group_t;
+
 /**
  * @}
  */
@@ -275,6 +475,59 @@ TM_I2C_Result_t TM_I2C_IsDeviceConnected(I2C_TypeDef* I2Cx, uint8_t address);
  */
 void TM_I2C_InitCustomPinsCallback(I2C_TypeDef* I2Cx, uint16_t AlternateFunction);
 
+/**
+ * @brief  Sets timeout for blocking transfers
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  Timeout: Timeout in milliseconds, for each step of transfer
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_SetTimeout(I2C_TypeDef* I2Cx, uint32_t Timeout);
+
+/**
+ * @brief  Sets pins used for bus recovery
+ * @note   Set automatically for all pinspacks, call it in @ref TM_I2C_InitCustomPinsCallback for custom pins
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  *SCL_Port: GPIO port of SCL pin
+ * @param  SCL_Pin: SCL pin
+ * @param  *SDA_Port: GPIO port of SDA pin
+ * @param  SDA_Pin: SDA pin
+ * @retval None
+ */
+void TM_I2C_SetRecoveryPins(I2C_TypeDef* I2Cx, GPIO_TypeDef* SCL_Port, uint16_t SCL_Pin, GPIO_TypeDef* SDA_Port, uint16_t SDA_Pin);
+
+/**
+ * @brief  Releases stuck bus with up to 9 clocks and STOP condition and resets I2C peripheral
+ * @note   Called automatically on errors, takes about 100us
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @retval Member of @ref TM_I2C_Result_t enumeration:
+ *            - @ref TM_I2C_Result_Ok: Bus is free
+ *            - @ref TM_I2C_Result_Error: Bus is still held low
+ */
+TM_I2C_Result_t TM_I2C_Recover(I2C_TypeDef* I2Cx);
+
+/**
+ * @brief  Gets error statistics for device
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  device_address: Device address
+ * @param  *Stats: Pointer to @ref TM_I2C_Stats_t structure to copy statistics to
+ * @retval Member of @ref TM_I2C_Result_t enumeration, error when device had no errors yet
+ */
+TM_I2C_Result_t TM_I2C_GetStats(I2C_TypeDef* I2Cx, uint8_t device_address, TM_I2C_Stats_t* Stats);
+
+/**
+ * @brief  Gets number of bus recoveries
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @retval Number of recoveries since init or @ref TM_I2C_ResetStats
+ */
+uint32_t TM_I2C_GetRecoveries(I2C_TypeDef* I2Cx);
+
+/**
+ * @brief  Clears error statistics of all devices and recovery counter
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @retval None
+ */
+void TM_I2C_ResetStats(I2C_TypeDef* I2Cx);
+
 /**
  * @brief  Gets pointer to I2C handle structure for specific I2C
  * @param  *I2Cx: Pointer to I2Cx used for handle
@@ -305,6 +558,86 @@ TM_I2C_Result_t TM_I2C_WriteReadRepeatedStart(
 	uint16_t read_count
 );
 
+/**
+ * @brief  Adds read of multiple bytes from device register to queue
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  register_address: Register address from where read will be done
+ * @param  *data: Pointer to data array to store data from slave, must stay valid until callback is called
+ * @param  count: Number of elements to read from device
+ * @param  Callback: Callback called when transaction is finished. Set to NULL if not used
+ * @param  *Param: Pointer to user parameter for callback function
+ * @retval Queue status:
+ *            - 0: Queue is full, transaction was not added
+ *            - > 0: Transaction added to queue
+ */
+uint8_t TM_I2C_ReadMultiQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Adds write of multiple bytes to device register to queue
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  register_address: Register address where you want to write data, 16-bit when greater than 0xFF
+ * @param  *data: Pointer to data array to write to slave, must stay valid until callback is called
+ * @param  count: Number of elements to write
+ * @param  Callback: Callback called when transaction is finished. Set to NULL if not used
+ * @param  *Param: Pointer to user parameter for callback function
+ * @retval Queue status:
+ *            - 0: Queue is full, transaction was not added
+ *            - > 0: Transaction added to queue
+ */
+uint8_t TM_I2C_WriteMultiQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Adds read of multiple bytes without register address to queue
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  *data: Pointer to data array to store data from slave, must stay valid until callback is called
+ * @param  count: Number of elements to read from device
+ * @param  Callback: Callback called when transaction is finished. Set to NULL if not used
+ * @param  *Param: Pointer to user parameter for callback function
+ * @retval Queue status:
+ *            - 0: Queue is full, transaction was not added
+ *            - > 0: Transaction added to queue
+ */
+uint8_t TM_I2C_ReadMultiNoRegisterQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Adds write of multiple bytes without register address to queue
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  *data: Pointer to data array to write to slave, must stay valid until callback is called
+ * @param  count: Number of elements to write
+ * @param  Callback: Callback called when transaction is finished. Set to NULL if not used
+ * @param  *Param: Pointer to user parameter for callback function
+ * @retval Queue status:
+ *            - 0: Queue is full, transaction was not added
+ *            - > 0: Transaction added to queue
+ */
+uint8_t TM_I2C_WriteMultiNoRegisterQueued(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Gets number of transactions in I2C queue, including the one in progress
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @retval Number of transactions waiting or in progress
+ */
+uint16_t TM_I2C_QueuePending(I2C_TypeDef* I2Cx);
+
+/**
+ * @brief  Starts all reads of group at the same time
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @note   Reads on the same I2C are done one after another, reads on different I2Cs in parallel
+ * @param  *Group: Pointer to @ref TM_I2C_Group_t group. Group and data must stay valid until callback is called
+ * @retval Start status:
+ *            - 0: Group is still in progress or empty, group was not started
+ *            - > 0: Group started, reads which could not be added to queue finish with error
+ */
+uint8_t TM_I2C_GroupRead(TM_I2C_Group_t* Group);
+
 /**
  * @}
  */
@@ -24,6 +24,8 @@ typedef struct {
 	DMA_Stream_TypeDef* TX_Stream;
 	uint32_t RX_Channel;
 	DMA_Stream_TypeDef* RX_Stream;
+	TM_DMA_Request_t TX_Request;
+	TM_DMA_Request_t RX_Request;
 	uint32_t Dummy32;
 	uint16_t Dummy16;
 	I2C_HandleTypeDef Handle;
@@ -31,25 +33,35 @@ typedef struct {
 
 /* Private variables */
 #ifdef I2C1
-static TM_I2C_DMA_INT_t I2C1_DMA_INT = {I2C1_DMA_TX_CHANNEL, I2C1_DMA_TX_STREAM, I2C1_DMA_RX_CHANNEL, I2C1_DMA_RX_STREAM};
+static TM_I2C_DMA_INT_t I2C1_DMA_INT = {I2C1_DMA_TX_CHANNEL, I2C1_DMA_TX_STREAM, I2C1_DMA_RX_CHANNEL, I2C1_DMA_RX_STREAM, TM_DMA_Request_I2C1_TX, TM_DMA_Request_I2C1_RX};
 #endif
 #ifdef I2C2
-static TM_I2C_DMA_INT_t I2C2_DMA_INT = {I2C2_DMA_TX_CHANNEL, I2C2_DMA_TX_STREAM, I2C2_DMA_RX_CHANNEL, I2C2_DMA_RX_STREAM};
+static TM_I2C_DMA_INT_t I2C2_DMA_INT = {I2C2_DMA_TX_CHANNEL, I2C2_DMA_TX_STREAM, I2C2_DMA_RX_CHANNEL, I2C2_DMA_RX_STREAM, TM_DMA_Request_I2C2_TX, TM_DMA_Request_I2C2_RX};
 #endif
 #ifdef I2C3
-static TM_I2C_DMA_INT_t I2C3_DMA_INT = {I2C3_DMA_TX_CHANNEL, I2C3_DMA_TX_STREAM, I2C3_DMA_RX_CHANNEL, I2C3_DMA_RX_STREAM};
+static TM_I2C_DMA_INT_t I2C3_DMA_INT = {I2C3_DMA_TX_CHANNEL, I2C3_DMA_TX_STREAM, I2C3_DMA_RX_CHANNEL, I2C3_DMA_RX_STREAM, TM_DMA_Request_I2C3_TX, TM_DMA_Request_I2C3_RX};
 #endif
 
 /* Private functions */
 static TM_I2C_DMA_INT_t* TM_I2C_DMA_INT_GetSettings(I2C_TypeDef* I2Cx);
 	
 void TM_I2C_DMA_Init(I2C_TypeDef* I2Cx) {
+	DMA_Stream_TypeDef* Stream;
+	
 	/* Init DMA TX mode */
 	/* Assuming I2C is already initialized and clock is enabled */
 	
 	/* Get USART settings */
 	TM_I2C_DMA_INT_t* Settings = TM_I2C_DMA_INT_GetSettings(I2Cx);
 	
+	/* Allocate streams, other free stream is selected if default is used by other peripheral */
+	if ((Stream = TM_DMA_Allocate(Settings->TX_Request, TM_DMA_Priority_Default, Settings->TX_Stream, &Settings->TX_Channel)) != NULL) {
+		Settings->TX_Stream = Stream;
+	}
+	if ((Stream = TM_DMA_Allocate(Settings->RX_Request, TM_DMA_Priority_Default, Settings->RX_Stream, &Settings->RX_Channel)) != NULL) {
+		Settings->RX_Stream = Stream;
+	}
+	
 	/* Init both streams */
 	TM_DMA_Init(Settings->TX_Stream, NULL);
 	TM_DMA_Init(Settings->RX_Stream, NULL);
@@ -76,6 +88,10 @@ void TM_I2C_DMA_Deinit(I2C_TypeDef* I2Cx) {
 	/* Deinit DMA Streams */
 	TM_DMA_DeInit(Settings->TX_Stream);
 	TM_DMA_DeInit(Settings->RX_Stream);
+	
+	/* Release streams */
+	TM_DMA_Release(Settings->TX_Stream, Settings->TX_Request);
+	TM_DMA_Release(Settings->RX_Stream, Settings->RX_Request);
 }
 
 uint8_t TM_I2C_DMA_Transmit(I2C_TypeDef* I2Cx, uint8_t* TX_Buffer, uint8_t* RX_Buffer, uint16_t count) {
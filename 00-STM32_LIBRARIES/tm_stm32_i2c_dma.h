@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   DMA functionality for TM I2C library for STM32F4xx and STM32F7xx devices
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_I2C_DMA_H
-#define TM_I2C_DMA_H 100
+#define TM_I2C_DMA_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -68,6 +68,10 @@ I2C3     | DMA1 | DMA Stream 4  | DMA Channel 3  | DMA Stream 2  | DMA Channel 3
 @verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Streams are allocated with TM DMA stream registry, other free stream is used when default stream is taken
 @endverbatim
  *
  * \par Dependencies
@@ -86,6 +90,11 @@ I2C3     | DMA1 | DMA Stream 4  | DMA Channel 3  | DMA Stream 2  | DMA Channel 3
 #include "tm_stm32_i2c.h"
 #include "stdlib.h"
 
+/* Check DMA library version */
+#if TM_DMA_H < 140
+#error "TM DMA library version must be greater or equal to 1.4. Please redownload TM DMA library!"
+#endif
+
 /**
  * @defgroup TM_I2C_DMA_Macros
  * @brief    Library defines
@@ -0,0 +1,188 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+
+ */
+#include "tm_stm32_i2c_regmap.h"
+
+/* Bit operations on register masks */
+#define REGMAP_BIT_GET(mask, reg)      ((mask)[(reg) >> 3] & (1 << ((reg) & 0x07)))
+#define REGMAP_BIT_SET(mask, reg)      ((mask)[(reg) >> 3] |= (1 << ((reg) & 0x07)))
+#define REGMAP_BIT_CLEAR(mask, reg)    ((mask)[(reg) >> 3] &= ~(1 << ((reg) & 0x07)))
+
+void TM_I2C_REGMAP_Init(TM_I2C_REGMAP_t* Map, I2C_TypeDef* I2Cx, uint8_t device_address) {
+	/* Clear everything */
+	memset(Map, 0, sizeof(TM_I2C_REGMAP_t));
+	
+	/* Save device */
+	Map->I2Cx = I2Cx;
+	Map->Address = device_address;
+}
+
+TM_I2C_Result_t TM_I2C_REGMAP_Load(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint16_t count) {
+	uint16_t i;
+	
+	/* Check range */
+	if (count == 0 || (register_address + count) > I2C_REGMAP_SIZE) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Read all registers at once */
+	Map->Transactions++;
+	if (TM_I2C_ReadMulti(Map->I2Cx, Map->Address, register_address, &Map->Values[register_address], count) != TM_I2C_Result_Ok) {
+		/* Values in range are not known anymore */
+		TM_I2C_REGMAP_Invalidate(Map, register_address, count);
+		
+		/* Return error */
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Values are the same as in device */
+	for (i = register_address; i < register_address + count; i++) {
+		REGMAP_BIT_SET(Map->Valid, i);
+		REGMAP_BIT_CLEAR(Map->Dirty, i);
+	}
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+TM_I2C_Result_t TM_I2C_REGMAP_Read(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint8_t* data) {
+	/* Check range */
+	if (register_address >= I2C_REGMAP_SIZE) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Read from device if not known yet */
+	if (!REGMAP_BIT_GET(Map->Valid, register_address)) {
+		if (TM_I2C_REGMAP_Load(Map, register_address, 1) != TM_I2C_Result_Ok) {
+			return TM_I2C_Result_Error;
+		}
+	}
+	
+	/* Get from cache */
+	*data = Map->Values[register_address];
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+TM_I2C_Result_t TM_I2C_REGMAP_Write(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint8_t data) {
+	/* Check range */
+	if (register_address >= I2C_REGMAP_SIZE) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Nothing to do when value is the same */
+	if (REGMAP_BIT_GET(Map->Valid, register_address) && Map->Values[register_address] == data) {
+		return TM_I2C_Result_Ok;
+	}
+	
+	/* Save new value, it must be written */
+	Map->Values[register_address] = data;
+	REGMAP_BIT_SET(Map->Valid, register_address);
+	REGMAP_BIT_SET(Map->Dirty, register_address);
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+TM_I2C_Result_t TM_I2C_REGMAP_Update(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint8_t mask, uint8_t data) {
+	uint8_t value;
+	
+	/* Get current value */
+	if (TM_I2C_REGMAP_Read(Map, register_address, &value) != TM_I2C_Result_Ok) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Change bits in mask only */
+	value = (value & ~mask) | (data & mask);
+	
+	/* Write to cache */
+	return TM_I2C_REGMAP_Write(Map, register_address, value);
+}
+
+TM_I2C_Result_t TM_I2C_REGMAP_Flush(TM_I2C_REGMAP_t* Map) {
+	uint16_t start, end, next, i;
+	
+	/* Go through all registers */
+	for (start = 0; start < I2C_REGMAP_SIZE; start++) {
+		/* Find first dirty register */
+		if (!REGMAP_BIT_GET(Map->Dirty, start)) {
+			continue;
+		}
+		
+		/* Extend burst over next dirty registers, valid gaps are rewritten with cached value */
+		end = start + 1;
+		next = end;
+		while (next < I2C_REGMAP_SIZE && (next - end) <= I2C_REGMAP_MAX_GAP && REGMAP_BIT_GET(Map->Valid, next)) {
+			if (REGMAP_BIT_GET(Map->Dirty, next)) {
+				end = next + 1;
+			}
+			next++;
+		}
+		
+		/* Write registers from start to end in one transaction */
+		Map->Transactions++;
+		if (TM_I2C_WriteMulti(Map->I2Cx, Map->Address, start, &Map->Values[start], end - start) != TM_I2C_Result_Ok) {
+			/* Return error, registers stay dirty */
+			return TM_I2C_Result_Error;
+		}
+		
+		/* Registers are written */
+		for (i = start; i < end; i++) {
+			REGMAP_BIT_CLEAR(Map->Dirty, i);
+		}
+		
+		/* Continue after burst */
+		start = end - 1;
+	}
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+void TM_I2C_REGMAP_Invalidate(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint16_t count) {
+	uint16_t i;
+	
+	/* Clear valid and dirty flags in range */
+	for (i = register_address; i < register_address + count && i < I2C_REGMAP_SIZE; i++) {
+		REGMAP_BIT_CLEAR(Map->Valid, i);
+		REGMAP_BIT_CLEAR(Map->Dirty, i);
+	}
+}
+
+uint8_t TM_I2C_REGMAP_IsDirty(TM_I2C_REGMAP_t* Map) {
+	uint16_t i;
+	
+	/* Check all flags */
+	for (i = 0; i < sizeof(Map->Dirty); i++) {
+		if (Map->Dirty[i]) {
+			return 1;
+		}
+	}
+	
+	/* Nothing to write */
+	return 0;
+}
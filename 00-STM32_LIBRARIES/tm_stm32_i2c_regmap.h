@@ -0,0 +1,262 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Cached register map for I2C devices for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_I2C_REGMAP_H
+#define TM_I2C_REGMAP_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_I2C_REGMAP
+ * @brief    Cached register map for I2C devices for STM32Fxxx
+ * @{
+ *
+ * Library keeps copy of device configuration registers in RAM.
+ * Register writes go to cache first and are marked as dirty, @ref TM_I2C_REGMAP_Flush then writes
+ * all dirty registers to device, where adjacent registers are written in one @ref TM_I2C_WriteMulti transaction.
+ *
+ * Read-modify-write with @ref TM_I2C_REGMAP_Update reads register from cache, so there is no bus transaction at all
+ * when register is already known. Writing the same value to register again does not make it dirty.
+ *
+\code
+TM_I2C_REGMAP_t Map;
+
+//Init map for MPU6050 and load configuration registers in one transaction
+TM_I2C_REGMAP_Init(&Map, I2C1, 0xD0);
+TM_I2C_REGMAP_Load(&Map, 0x19, 4);
+
+//Set sample divider, gyro and accelerometer ranges, only cache is changed
+TM_I2C_REGMAP_Write(&Map, 0x19, 0x00);
+TM_I2C_REGMAP_Update(&Map, 0x1B, 0x18, 0x08);
+TM_I2C_REGMAP_Update(&Map, 0x1C, 0x18, 0x10);
+
+//Write registers 0x19 to 0x1C in one transaction
+TM_I2C_REGMAP_Flush(&Map);
+\endcode
+ *
+ * \note  Device must support register address auto increment on multi byte writes
+ * \note  Use cache for configuration registers only. Status and data registers change in device
+ *        and must be read with @ref TM_I2C functions directly or invalidated with @ref TM_I2C_REGMAP_Invalidate before read
+ *
+ * \par Settings
+ *
+\code
+//Number of cached registers, from address 0
+#define I2C_REGMAP_SIZE          128
+
+//Max number of clean registers between dirty registers to be rewritten, so both are written in one transaction
+//Set to 0 if device has registers with side effects on write
+#define I2C_REGMAP_MAX_GAP       0
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM I2C
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_i2c.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_I2C_REGMAP_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of cached registers */
+#ifndef I2C_REGMAP_SIZE
+#define I2C_REGMAP_SIZE          128
+#endif
+
+/* Max gap of clean registers inside one burst */
+#ifndef I2C_REGMAP_MAX_GAP
+#define I2C_REGMAP_MAX_GAP       0
+#endif
+
+/* Register address is 8-bit */
+#if I2C_REGMAP_SIZE > 256
+#error "I2C_REGMAP_SIZE can not be more than 256!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_I2C_REGMAP_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Register map structure
+ */
+typedef struct {
+	I2C_TypeDef* I2Cx;                                /*!< I2C peripheral where device is connected */
+	uint8_t Address;                                  /*!< Device address */
+	uint8_t Values[I2C_REGMAP_SIZE];                  /*!< Cached register values */
+	uint8_t Valid[(I2C_REGMAP_SIZE + 7) / 8];         /*!< Bit is set when register value is known */
+	uint8_t Dirty[(I2C_REGMAP_SIZE + 7) / 8];         /*!< Bit is set when register must be written to device */
+	uint32_t Transactions;                            /*!< Number of bus transactions made by map */
+} TM_I2C_REGMAP_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_I2C_REGMAP_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes register map, all registers are unknown
+ * @note   I2C peripheral must be initialized separately with @ref TM_I2C_Init
+ * @param  *Map: Pointer to empty @ref TM_I2C_REGMAP_t structure
+ * @param  *I2Cx: Pointer to I2Cx peripheral where device is connected
+ * @param  device_address: 7-bit device address, left aligned
+ * @retval None
+ */
+void TM_I2C_REGMAP_Init(TM_I2C_REGMAP_t* Map, I2C_TypeDef* I2Cx, uint8_t device_address);
+
+/**
+ * @brief  Reads registers from device to cache in one transaction
+ * @note   Dirty registers in range are overwritten with device values
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @param  register_address: First register to read
+ * @param  count: Number of registers to read
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_REGMAP_Load(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint16_t count);
+
+/**
+ * @brief  Reads register value, device is read only if value is not cached
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @param  register_address: Register address
+ * @param  *data: Pointer to variable to save value to
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_REGMAP_Read(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint8_t* data);
+
+/**
+ * @brief  Writes register value to cache, it is written to device on @ref TM_I2C_REGMAP_Flush
+ * @note   When register already has the same value, nothing is changed
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @param  register_address: Register address
+ * @param  data: New register value
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_REGMAP_Write(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint8_t data);
+
+/**
+ * @brief  Changes bits in register, it is written to device on @ref TM_I2C_REGMAP_Flush
+ * @note   Device is read only if value is not cached
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @param  register_address: Register address
+ * @param  mask: Bits to change
+ * @param  data: New values for bits in mask
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_REGMAP_Update(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint8_t mask, uint8_t data);
+
+/**
+ * @brief  Writes all dirty registers to device, adjacent registers are written in one transaction
+ * @note   On error, registers which were not written stay dirty and flush can be repeated
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_REGMAP_Flush(TM_I2C_REGMAP_t* Map);
+
+/**
+ * @brief  Marks registers as unknown, for example after device reset
+ * @note   Dirty registers in range are not written to device anymore
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @param  register_address: First register
+ * @param  count: Number of registers
+ * @retval None
+ */
+void TM_I2C_REGMAP_Invalidate(TM_I2C_REGMAP_t* Map, uint8_t register_address, uint16_t count);
+
+/**
+ * @brief  Checks if any register waits to be written to device
+ * @param  *Map: Pointer to @ref TM_I2C_REGMAP_t structure
+ * @retval Dirty status:
+ *            - 0: All registers are written
+ *            - > 0: At least one register is dirty
+ */
+uint8_t TM_I2C_REGMAP_IsDirty(TM_I2C_REGMAP_t* Map);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,708 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_i2c_slave.h"
+
+/* Transfer states */
+#define I2C_SLAVE_INT_IDLE          0
+#define I2C_SLAVE_INT_REGISTER      1
+#define I2C_SLAVE_INT_WRITE         2
+#define I2C_SLAVE_INT_READ          3
+
+/* Data transfer modes */
+#define I2C_SLAVE_INT_DATA_NONE     0
+#define I2C_SLAVE_INT_DATA_RX_IT    1
+#define I2C_SLAVE_INT_DATA_TX_IT    2
+#define I2C_SLAVE_INT_DATA_RX_DMA   3
+#define I2C_SLAVE_INT_DATA_TX_DMA   4
+
+/* Data registers */
+#if defined(STM32F4xx)
+#define I2C_SLAVE_INT_TXDR(I2Cx)    ((uint32_t)&(I2Cx)->DR)
+#define I2C_SLAVE_INT_RXDR(I2Cx)    ((uint32_t)&(I2Cx)->DR)
+#else
+#define I2C_SLAVE_INT_TXDR(I2Cx)    ((uint32_t)&(I2Cx)->TXDR)
+#define I2C_SLAVE_INT_RXDR(I2Cx)    ((uint32_t)&(I2Cx)->RXDR)
+#endif
+
+/* Private structure */
+typedef struct {
+	TM_I2C_SLAVE_t* Slave;          /* Slave settings, NULL when not active */
+	DMA_Stream_TypeDef* TX_Stream;  /* Preferred TX stream, NULL when I2C has no DMA */
+	uint32_t TX_Channel;
+	DMA_Stream_TypeDef* RX_Stream;  /* Preferred RX stream */
+	uint32_t RX_Channel;
+	TM_DMA_Request_t TX_Request;
+	TM_DMA_Request_t RX_Request;
+	IRQn_Type EV_IRQ;
+	IRQn_Type ER_IRQ;
+	DMA_Stream_TypeDef* TX;         /* Allocated TX stream, NULL for byte mode */
+	DMA_Stream_TypeDef* RX;         /* Allocated RX stream, NULL for byte mode */
+	volatile uint8_t State;         /* Transfer state */
+	uint8_t Dma;                    /* Data are moved by DMA */
+	uint16_t Start;                 /* First register of transfer */
+	uint16_t Length;                /* Length of DMA transfer */
+	uint16_t Count;                 /* Number of transferred registers */
+} TM_I2C_SLAVE_INT_t;
+
+/* Private variables */
+#ifdef I2C1
+static TM_I2C_SLAVE_INT_t I2C1_SLAVE_INT = {NULL, I2C1_DMA_TX_STREAM, I2C1_DMA_TX_CHANNEL, I2C1_DMA_RX_STREAM, I2C1_DMA_RX_CHANNEL, TM_DMA_Request_I2C1_TX, TM_DMA_Request_I2C1_RX, I2C1_EV_IRQn, I2C1_ER_IRQn};
+#endif
+#ifdef I2C2
+static TM_I2C_SLAVE_INT_t I2C2_SLAVE_INT = {NULL, I2C2_DMA_TX_STREAM, I2C2_DMA_TX_CHANNEL, I2C2_DMA_RX_STREAM, I2C2_DMA_RX_CHANNEL, TM_DMA_Request_I2C2_TX, TM_DMA_Request_I2C2_RX, I2C2_EV_IRQn, I2C2_ER_IRQn};
+#endif
+#ifdef I2C3
+static TM_I2C_SLAVE_INT_t I2C3_SLAVE_INT = {NULL, I2C3_DMA_TX_STREAM, I2C3_DMA_TX_CHANNEL, I2C3_DMA_RX_STREAM, I2C3_DMA_RX_CHANNEL, TM_DMA_Request_I2C3_TX, TM_DMA_Request_I2C3_RX, I2C3_EV_IRQn, I2C3_ER_IRQn};
+#endif
+#ifdef I2C4
+static TM_I2C_SLAVE_INT_t I2C4_SLAVE_INT = {NULL, NULL, 0, NULL, 0, TM_DMA_Request_I2C1_TX, TM_DMA_Request_I2C1_RX, I2C4_EV_IRQn, I2C4_ER_IRQn};
+#endif
+
+/* Private functions */
+static TM_I2C_SLAVE_INT_t* TM_I2C_SLAVE_INT_GetSettings(I2C_TypeDef* I2Cx);
+static DMA_Stream_TypeDef* TM_I2C_SLAVE_INT_InitStream(I2C_TypeDef* I2Cx, DMA_Stream_TypeDef* Stream, uint32_t Channel, TM_DMA_Request_t Request, uint32_t Direction);
+static void TM_I2C_SLAVE_INT_StartDMA(DMA_Stream_TypeDef* Stream, uint8_t* Memory, uint16_t Length);
+static uint16_t TM_I2C_SLAVE_INT_StopDMA(DMA_Stream_TypeDef* Stream);
+static void TM_I2C_SLAVE_INT_SetData(I2C_TypeDef* I2Cx, uint8_t mode);
+static void TM_I2C_SLAVE_INT_StartRead(I2C_TypeDef* I2Cx, TM_I2C_SLAVE_INT_t* S);
+static void TM_I2C_SLAVE_INT_Receive(I2C_TypeDef* I2Cx, TM_I2C_SLAVE_INT_t* S, uint8_t data);
+static uint8_t TM_I2C_SLAVE_INT_Transmit(TM_I2C_SLAVE_INT_t* S);
+static void TM_I2C_SLAVE_INT_End(I2C_TypeDef* I2Cx, TM_I2C_SLAVE_INT_t* S, uint8_t ok);
+static void TM_I2C_SLAVE_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+static void TM_I2C_SLAVE_INT_IRQHandler(I2C_TypeDef* I2Cx);
+#if defined(STM32F4xx)
+static void TM_I2C_SLAVE_INT_Reset(I2C_TypeDef* I2Cx);
+#endif
+
+TM_I2C_Result_t TM_I2C_SLAVE_Init(I2C_TypeDef* I2Cx, TM_I2C_PinsPack_t pinspack, uint8_t address, TM_I2C_SLAVE_t* Slave) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	
+	/* Check settings */
+	if (S == NULL || S->Slave != NULL || Slave->Map == NULL || Slave->Size == 0 || Slave->Size > 256) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Init pins, clock and peripheral timing */
+	if (TM_I2C_Init(I2Cx, pinspack, I2C_SLAVE_CLOCK) != TM_I2C_Result_Ok) {
+		return TM_I2C_Result_Error;
+	}
+	
+	/* Reset state */
+	S->State = I2C_SLAVE_INT_IDLE;
+	S->Dma = 0;
+	Slave->Pointer = 0;
+	S->Slave = Slave;
+	
+	/* Init DMA streams, bytes are moved in interrupt when stream is not available */
+	S->TX = TM_I2C_SLAVE_INT_InitStream(I2Cx, S->TX_Stream, S->TX_Channel, S->TX_Request, DMA_MEMORY_TO_PERIPH);
+	S->RX = TM_I2C_SLAVE_INT_InitStream(I2Cx, S->RX_Stream, S->RX_Channel, S->RX_Request, DMA_PERIPH_TO_MEMORY);
+	
+	/* Set own address and enable interrupts */
+	I2Cx->CR1 &= ~I2C_CR1_PE;
+#if defined(STM32F4xx)
+	I2Cx->OAR1 = (1 << 14) | (address & 0xFE);
+	I2Cx->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+	I2Cx->CR1 |= I2C_CR1_PE;
+	I2Cx->CR1 |= I2C_CR1_ACK;
+#else
+	I2Cx->OAR1 = 0;
+	I2Cx->OAR1 = I2C_OAR1_OA1EN | (address & 0xFE);
+	I2Cx->CR1 |= I2C_CR1_ADDRIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE;
+	I2Cx->CR1 |= I2C_CR1_PE;
+#endif
+	
+	/* Enable NVIC */
+	HAL_NVIC_SetPriority(S->EV_IRQ, I2C_SLAVE_NVIC_PRIORITY, 0);
+	HAL_NVIC_SetPriority(S->ER_IRQ, I2C_SLAVE_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(S->EV_IRQ);
+	HAL_NVIC_EnableIRQ(S->ER_IRQ);
+	
+	/* Return OK */
+	return TM_I2C_Result_Ok;
+}
+
+void TM_I2C_SLAVE_DeInit(I2C_TypeDef* I2Cx) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	
+	/* Check if active */
+	if (S == NULL || S->Slave == NULL) {
+		return;
+	}
+	
+	/* Disable interrupts */
+	HAL_NVIC_DisableIRQ(S->EV_IRQ);
+	HAL_NVIC_DisableIRQ(S->ER_IRQ);
+	
+	/* Stop responding to own address */
+	TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_NONE);
+#if defined(STM32F4xx)
+	I2Cx->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN);
+	I2Cx->CR1 &= ~I2C_CR1_ACK;
+	I2Cx->OAR1 = (1 << 14);
+#else
+	I2Cx->CR1 &= ~(I2C_CR1_ADDRIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE);
+	I2Cx->OAR1 = 0;
+#endif
+	
+	/* Stop and release streams */
+	if (S->TX != NULL) {
+		TM_I2C_SLAVE_INT_StopDMA(S->TX);
+		TM_DMA_DeInit(S->TX);
+		TM_DMA_Release(S->TX, S->TX_Request);
+		S->TX = NULL;
+	}
+	if (S->RX != NULL) {
+		TM_I2C_SLAVE_INT_StopDMA(S->RX);
+		TM_DMA_DeInit(S->RX);
+		TM_DMA_Release(S->RX, S->RX_Request);
+		S->RX = NULL;
+	}
+	
+	/* Not active anymore */
+	S->State = I2C_SLAVE_INT_IDLE;
+	S->Dma = 0;
+	S->Slave = NULL;
+}
+
+uint8_t TM_I2C_SLAVE_Update(I2C_TypeDef* I2Cx, uint8_t register_address, const void* data, uint16_t count) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	uint32_t irq;
+	
+	/* Check registers */
+	if (S == NULL || S->Slave == NULL || (register_address + count) > S->Slave->Size) {
+		return 0;
+	}
+	
+	/* Disable interrupts, new host transfer waits with clock stretching */
+	irq = TM_NVIC_Lock();
+	
+	/* Check for transfer in progress */
+	if (S->State != I2C_SLAVE_INT_IDLE) {
+		TM_NVIC_Unlock(irq);
+		return 0;
+	}
+	
+	/* Copy data */
+	memcpy(&S->Slave->Map[register_address], data, count);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return OK */
+	return 1;
+}
+
+uint8_t TM_I2C_SLAVE_Get(I2C_TypeDef* I2Cx, uint8_t register_address, void* data, uint16_t count) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	uint32_t irq;
+	
+	/* Check registers */
+	if (S == NULL || S->Slave == NULL || (register_address + count) > S->Slave->Size) {
+		return 0;
+	}
+	
+	/* Disable interrupts, new host transfer waits with clock stretching */
+	irq = TM_NVIC_Lock();
+	
+	/* Check for transfer in progress */
+	if (S->State != I2C_SLAVE_INT_IDLE) {
+		TM_NVIC_Unlock(irq);
+		return 0;
+	}
+	
+	/* Copy data */
+	memcpy(data, &S->Slave->Map[register_address], count);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return OK */
+	return 1;
+}
+
+uint8_t TM_I2C_SLAVE_IsBusy(I2C_TypeDef* I2Cx) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	
+	/* Check state */
+	return S != NULL && S->State != I2C_SLAVE_INT_IDLE;
+}
+
+/* Interrupt handlers, I2Cs used by TM I2C queue are handled there */
+#if defined(I2C1) && (defined(TM_I2C1_SLAVE) || I2C_QUEUE_SIZE == 0)
+void I2C1_EV_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C1);
+}
+void I2C1_ER_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C1);
+}
+#endif
+#if defined(I2C2) && (defined(TM_I2C2_SLAVE) || I2C_QUEUE_SIZE == 0)
+void I2C2_EV_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C2);
+}
+void I2C2_ER_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C2);
+}
+#endif
+#if defined(I2C3) && (defined(TM_I2C3_SLAVE) || I2C_QUEUE_SIZE == 0)
+void I2C3_EV_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C3);
+}
+void I2C3_ER_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C3);
+}
+#endif
+#if defined(I2C4) && (defined(TM_I2C4_SLAVE) || I2C_QUEUE_SIZE == 0)
+void I2C4_EV_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C4);
+}
+void I2C4_ER_IRQHandler(void) {
+	TM_I2C_SLAVE_INT_IRQHandler(I2C4);
+}
+#endif
+
+/* Private functions */
+static DMA_Stream_TypeDef* TM_I2C_SLAVE_INT_InitStream(I2C_TypeDef* I2Cx, DMA_Stream_TypeDef* Stream, uint32_t Channel, TM_DMA_Request_t Request, uint32_t Direction) {
+	DMA_HandleTypeDef DMA_InitStruct;
+	
+	/* I2C has no DMA request */
+	if (Stream == NULL) {
+		return NULL;
+	}
+	
+	/* Allocate stream, other free stream is selected if default is used by other peripheral */
+	if ((Stream = TM_DMA_Allocate(Request, TM_DMA_Priority_Default, Stream, &Channel)) == NULL) {
+		return NULL;
+	}
+	
+	/* Init stream once, only memory address and length are set for each transfer */
+	DMA_InitStruct.Instance = Stream;
+	DMA_InitStruct.Init.Channel = Channel;
+	DMA_InitStruct.Init.Direction = Direction;
+	DMA_InitStruct.Init.PeriphInc = DMA_PINC_DISABLE;
+	DMA_InitStruct.Init.MemInc = DMA_MINC_ENABLE;
+	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	DMA_InitStruct.Init.Mode = DMA_NORMAL;
+	DMA_InitStruct.Init.Priority = DMA_PRIORITY_HIGH;
+	DMA_InitStruct.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	DMA_InitStruct.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DMA_InitStruct.Init.MemBurst = DMA_MBURST_SINGLE;
+	DMA_InitStruct.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	TM_DMA_Init(Stream, &DMA_InitStruct);
+	
+	/* Set peripheral address */
+	Stream->PAR = (Direction == DMA_MEMORY_TO_PERIPH) ? I2C_SLAVE_INT_TXDR(I2Cx) : I2C_SLAVE_INT_RXDR(I2Cx);
+	
+	/* Transfer complete is handled by library, stream interrupts are enabled on each start */
+	TM_DMA_SetStreamCallback(Stream, TM_I2C_SLAVE_INT_DMACallback, I2Cx);
+	TM_DMA_EnableInterrupts(Stream);
+	Stream->CR &= ~(DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
+	Stream->FCR &= ~DMA_SxFCR_FEIE;
+	
+	/* Return stream */
+	return Stream;
+}
+
+static void TM_I2C_SLAVE_INT_StartDMA(DMA_Stream_TypeDef* Stream, uint8_t* Memory, uint16_t Length) {
+	/* Stream is disabled after previous transfer */
+	Stream->CR &= ~DMA_SxCR_EN;
+	while (Stream->CR & DMA_SxCR_EN);
+	TM_DMA_ClearFlag(Stream, DMA_FLAG_ALL);
+	
+	/* Set memory and start */
+	Stream->M0AR = (uint32_t)Memory;
+	Stream->NDTR = Length;
+	Stream->CR |= DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_EN;
+}
+
+static uint16_t TM_I2C_SLAVE_INT_StopDMA(DMA_Stream_TypeDef* Stream) {
+	uint16_t remaining;
+	
+	/* Stop stream */
+	Stream->CR &= ~(DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_EN);
+	while (Stream->CR & DMA_SxCR_EN);
+	TM_DMA_ClearFlag(Stream, DMA_FLAG_ALL);
+	
+	/* Get number of bytes not transferred and mark stream as free */
+	remaining = Stream->NDTR;
+	Stream->NDTR = 0;
+	
+	/* Return remaining bytes */
+	return remaining;
+}
+
+static void TM_I2C_SLAVE_INT_SetData(I2C_TypeDef* I2Cx, uint8_t mode) {
+#if defined(STM32F4xx)
+	/* One buffer interrupt and one DMA request bit for both directions */
+	I2Cx->CR2 &= ~(I2C_CR2_ITBUFEN | I2C_CR2_DMAEN);
+	if (mode == I2C_SLAVE_INT_DATA_RX_IT || mode == I2C_SLAVE_INT_DATA_TX_IT) {
+		I2Cx->CR2 |= I2C_CR2_ITBUFEN;
+	} else if (mode != I2C_SLAVE_INT_DATA_NONE) {
+		I2Cx->CR2 |= I2C_CR2_DMAEN;
+	}
+#else
+	/* Separate bits for each direction */
+	I2Cx->CR1 &= ~(I2C_CR1_RXIE | I2C_CR1_TXIE | I2C_CR1_RXDMAEN | I2C_CR1_TXDMAEN);
+	if (mode == I2C_SLAVE_INT_DATA_RX_IT) {
+		I2Cx->CR1 |= I2C_CR1_RXIE;
+	} else if (mode == I2C_SLAVE_INT_DATA_TX_IT) {
+		I2Cx->CR1 |= I2C_CR1_TXIE;
+	} else if (mode == I2C_SLAVE_INT_DATA_RX_DMA) {
+		I2Cx->CR1 |= I2C_CR1_RXDMAEN;
+	} else if (mode == I2C_SLAVE_INT_DATA_TX_DMA) {
+		I2Cx->CR1 |= I2C_CR1_TXDMAEN;
+	}
+#endif
+}
+
+static void TM_I2C_SLAVE_INT_StartRead(I2C_TypeDef* I2Cx, TM_I2C_SLAVE_INT_t* S) {
+	TM_I2C_SLAVE_t* Slave = S->Slave;
+	
+	/* Read starts at register pointer */
+	S->State = I2C_SLAVE_INT_READ;
+	S->Start = Slave->Pointer;
+	S->Count = 0;
+	
+	/* Send rest of map with DMA */
+	if (S->TX != NULL && Slave->Pointer < Slave->Size) {
+		S->Length = Slave->Size - Slave->Pointer;
+		S->Dma = 1;
+		TM_DMA_CleanCache(&Slave->Map[Slave->Pointer], S->Length);
+		TM_I2C_SLAVE_INT_StartDMA(S->TX, &Slave->Map[Slave->Pointer], S->Length);
+		TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_TX_DMA);
+	} else {
+		S->Dma = 0;
+		TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_TX_IT);
+	}
+}
+
+static void TM_I2C_SLAVE_INT_Receive(I2C_TypeDef* I2Cx, TM_I2C_SLAVE_INT_t* S, uint8_t data) {
+	TM_I2C_SLAVE_t* Slave = S->Slave;
+	
+	/* First byte is register address */
+	if (S->State == I2C_SLAVE_INT_REGISTER) {
+		Slave->Pointer = data;
+		S->Start = data;
+		S->Count = 0;
+		S->State = I2C_SLAVE_INT_WRITE;
+		
+		/* Receive data to map with DMA */
+		if (S->RX != NULL && data < Slave->Size) {
+			S->Length = Slave->Size - data;
+			S->Dma = 1;
+			TM_DMA_InvalidateCache(&Slave->Map[data], S->Length);
+			TM_I2C_SLAVE_INT_StartDMA(S->RX, &Slave->Map[data], S->Length);
+			TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_RX_DMA);
+		}
+		return;
+	}
+	
+	/* Save data, writes after the end of map are ignored */
+	if (S->State == I2C_SLAVE_INT_WRITE && (S->Start + S->Count) < Slave->Size) {
+		Slave->Map[S->Start + S->Count] = data;
+		S->Count++;
+	}
+}
+
+static uint8_t TM_I2C_SLAVE_INT_Transmit(TM_I2C_SLAVE_INT_t* S) {
+	uint16_t reg = S->Start + S->Count;
+	
+	/* Reads after the end of map return 0xFF */
+	if (S->State != I2C_SLAVE_INT_READ || reg >= S->Slave->Size) {
+		return 0xFF;
+	}
+	
+	/* Send next register */
+	S->Count++;
+	return S->Slave->Map[reg];
+}
+
+static void TM_I2C_SLAVE_INT_End(I2C_TypeDef* I2Cx, TM_I2C_SLAVE_INT_t* S, uint8_t ok) {
+	TM_I2C_SLAVE_t* Slave = S->Slave;
+	const TM_I2C_SLAVE_Range_t* r;
+	uint16_t first, last, i;
+	
+	/* Stop DMA and get number of transferred registers */
+	if (S->Dma) {
+		S->Count = S->Length - TM_I2C_SLAVE_INT_StopDMA(S->State == I2C_SLAVE_INT_READ ? S->TX : S->RX);
+		S->Dma = 0;
+		
+		/* CPU must see data written by DMA */
+		if (S->State == I2C_SLAVE_INT_WRITE) {
+			TM_DMA_InvalidateCache(&Slave->Map[S->Start], S->Count);
+		}
+	}
+	TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_NONE);
+	
+	/* Transfer is dropped on error */
+	if (!ok) {
+		Slave->Errors++;
+		S->State = I2C_SLAVE_INT_IDLE;
+		return;
+	}
+	
+	/* Finish write */
+	if (S->State == I2C_SLAVE_INT_WRITE && S->Count) {
+		/* Pointer is after last written register */
+		Slave->Pointer = S->Start + S->Count;
+		Slave->Writes++;
+		
+		/* Call callbacks for written ranges */
+		for (i = 0; i < Slave->RangesCount; i++) {
+			r = &Slave->Ranges[i];
+			first = S->Start > r->First ? S->Start : r->First;
+			last = (S->Start + S->Count - 1) < r->Last ? (S->Start + S->Count - 1) : r->Last;
+			if (first <= last && r->Callback) {
+				r->Callback(I2Cx, first, last - first + 1, r->Param);
+			}
+		}
+	}
+	
+	/* Count read */
+	if (S->State == I2C_SLAVE_INT_READ) {
+		Slave->Reads++;
+	}
+	
+	/* Ready for next transfer */
+	S->State = I2C_SLAVE_INT_IDLE;
+}
+
+static void TM_I2C_SLAVE_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	I2C_TypeDef* I2Cx = (I2C_TypeDef *)Param;
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	
+	/* Process only active transfer on complete or error */
+	if (!S->Dma || !(flags & (DMA_FLAG_TCIF | DMA_FLAG_TEIF))) {
+		return;
+	}
+	
+	/* Drop transfer on DMA error */
+	if (flags & DMA_FLAG_TEIF) {
+		TM_I2C_SLAVE_INT_End(I2Cx, S, 0);
+		return;
+	}
+	
+	/* End of map, host continues, so rest is done in interrupt with dummy data */
+	DMA_Stream->CR &= ~(DMA_SxCR_TCIE | DMA_SxCR_TEIE);
+	S->Dma = 0;
+	S->Count = S->Length;
+	if (S->State == I2C_SLAVE_INT_WRITE) {
+		TM_DMA_InvalidateCache(&S->Slave->Map[S->Start], S->Count);
+		TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_RX_IT);
+	} else {
+		TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_TX_IT);
+	}
+}
+
+#if defined(STM32F4xx)
+static void TM_I2C_SLAVE_INT_IRQHandler(I2C_TypeDef* I2Cx) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	uint32_t sr1, sr2;
+	
+	/* Check slave */
+	if (S == NULL || S->Slave == NULL) {
+		return;
+	}
+	sr1 = I2Cx->SR1;
+	
+	/* Bus error, arbitration lost or overrun, drop transfer */
+	if (sr1 & (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR)) {
+		I2Cx->SR1 = ~(I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR) & 0xFFFF;
+		if (S->State != I2C_SLAVE_INT_IDLE) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 0);
+		}
+	}
+	
+	/* Received byte, before address match of repeated start */
+	if ((sr1 & I2C_SR1_RXNE) && !S->Dma && S->State != I2C_SLAVE_INT_READ) {
+		TM_I2C_SLAVE_INT_Receive(I2Cx, S, I2Cx->DR);
+	}
+	
+	/* Host does not acknowledge, end of read */
+	if (sr1 & I2C_SR1_AF) {
+		I2Cx->SR1 = ~I2C_SR1_AF & 0xFFFF;
+		if (S->State == I2C_SLAVE_INT_READ) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 1);
+		}
+		
+		/* Byte loaded for next read would be sent on next transfer, only reset clears it */
+		if (!(I2Cx->SR1 & I2C_SR1_TXE)) {
+			TM_I2C_SLAVE_INT_Reset(I2Cx);
+		}
+	}
+	
+	/* Address matched, reading SR2 releases clock */
+	if (sr1 & I2C_SR1_ADDR) {
+		sr2 = I2Cx->SR2;
+		
+		/* Repeated start finishes previous transfer */
+		if (S->State != I2C_SLAVE_INT_IDLE) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 1);
+		}
+		
+		/* Start data */
+		if (sr2 & I2C_SR2_TRA) {
+			TM_I2C_SLAVE_INT_StartRead(I2Cx, S);
+		} else {
+			S->State = I2C_SLAVE_INT_REGISTER;
+			TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_RX_IT);
+		}
+		
+		/* Read SR1 again, TXE is set after address */
+		sr1 = I2Cx->SR1;
+	}
+	
+	/* Transmit byte when host reads */
+	if ((sr1 & I2C_SR1_TXE) && !S->Dma && (I2Cx->CR2 & I2C_CR2_ITBUFEN) && (I2Cx->SR2 & I2C_SR2_TRA)) {
+		I2Cx->DR = TM_I2C_SLAVE_INT_Transmit(S);
+	}
+	
+	/* Stop condition, cleared by write to CR1 */
+	if (sr1 & I2C_SR1_STOPF) {
+		I2Cx->CR1 |= I2C_CR1_PE;
+		if (S->State != I2C_SLAVE_INT_IDLE) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 1);
+		}
+	}
+}
+
+static void TM_I2C_SLAVE_INT_Reset(I2C_TypeDef* I2Cx) {
+	uint32_t cr1, cr2, oar1, oar2, ccr, trise;
+	
+	/* Save settings */
+	cr1 = I2Cx->CR1;
+	cr2 = I2Cx->CR2;
+	oar1 = I2Cx->OAR1;
+	oar2 = I2Cx->OAR2;
+	ccr = I2Cx->CCR;
+	trise = I2Cx->TRISE;
+	
+	/* Software reset */
+	I2Cx->CR1 |= I2C_CR1_SWRST;
+	I2Cx->CR1 &= ~I2C_CR1_SWRST;
+	
+	/* Restore settings, enable last */
+	I2Cx->CR2 = cr2;
+	I2Cx->OAR1 = oar1;
+	I2Cx->OAR2 = oar2;
+	I2Cx->CCR = ccr;
+	I2Cx->TRISE = trise;
+	I2Cx->CR1 = cr1;
+}
+#else
+static void TM_I2C_SLAVE_INT_IRQHandler(I2C_TypeDef* I2Cx) {
+	TM_I2C_SLAVE_INT_t* S = TM_I2C_SLAVE_INT_GetSettings(I2Cx);
+	uint32_t isr;
+	
+	/* Check slave */
+	if (S == NULL || S->Slave == NULL) {
+		return;
+	}
+	isr = I2Cx->ISR;
+	
+	/* Bus error, arbitration lost or overrun, drop transfer */
+	if (isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR)) {
+		I2Cx->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF;
+		if (S->State != I2C_SLAVE_INT_IDLE) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 0);
+		}
+	}
+	
+	/* Received byte, before address match of repeated start */
+	if ((isr & I2C_ISR_RXNE) && !S->Dma) {
+		TM_I2C_SLAVE_INT_Receive(I2Cx, S, I2Cx->RXDR);
+	}
+	
+	/* Host does not acknowledge, end of read, flush data loaded for next byte */
+	if (isr & I2C_ISR_NACKF) {
+		I2Cx->ICR = I2C_ICR_NACKCF;
+		if (S->State == I2C_SLAVE_INT_READ) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 1);
+		}
+		I2Cx->ISR |= I2C_ISR_TXE;
+	}
+	
+	/* Address matched, clock is stretched until flag is cleared */
+	if (isr & I2C_ISR_ADDR) {
+		/* Repeated start finishes previous transfer */
+		if (S->State != I2C_SLAVE_INT_IDLE) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 1);
+		}
+		
+		/* Start data */
+		if (isr & I2C_ISR_DIR) {
+			I2Cx->ISR |= I2C_ISR_TXE;
+			TM_I2C_SLAVE_INT_StartRead(I2Cx, S);
+		} else {
+			S->State = I2C_SLAVE_INT_REGISTER;
+			TM_I2C_SLAVE_INT_SetData(I2Cx, I2C_SLAVE_INT_DATA_RX_IT);
+		}
+		I2Cx->ICR = I2C_ICR_ADDRCF;
+	}
+	
+	/* Transmit byte when host reads */
+	if ((I2Cx->ISR & I2C_ISR_TXIS) && !S->Dma && (I2Cx->CR1 & I2C_CR1_TXIE)) {
+		I2Cx->TXDR = TM_I2C_SLAVE_INT_Transmit(S);
+	}
+	
+	/* Stop condition */
+	if (isr & I2C_ISR_STOPF) {
+		I2Cx->ICR = I2C_ICR_STOPCF;
+		if (S->State != I2C_SLAVE_INT_IDLE) {
+			TM_I2C_SLAVE_INT_End(I2Cx, S, 1);
+		}
+		I2Cx->ISR |= I2C_ISR_TXE;
+	}
+}
+#endif
+
+static TM_I2C_SLAVE_INT_t* TM_I2C_SLAVE_INT_GetSettings(I2C_TypeDef* I2Cx) {
+	TM_I2C_SLAVE_INT_t* result = NULL;
+#ifdef I2C1
+	if (I2Cx == I2C1) {
+		result = &I2C1_SLAVE_INT;
+	}
+#endif
+#ifdef I2C2
+	if (I2Cx == I2C2) {
+		result = &I2C2_SLAVE_INT;
+	}
+#endif
+#ifdef I2C3
+	if (I2Cx == I2C3) {
+		result = &I2C3_SLAVE_INT;
+	}
+#endif
+#ifdef I2C4
+	if (I2Cx == I2C4) {
+		result = &I2C4_SLAVE_INT;
+	}
+#endif
+
+	/* Return */
+	return result;
+}
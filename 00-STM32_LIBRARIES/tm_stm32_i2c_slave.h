@@ -0,0 +1,313 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   I2C slave with virtual register map for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_I2C_SLAVE_H
+#define TM_I2C_SLAVE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_I2C_SLAVE
+ * @brief    I2C slave with virtual register map for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Library makes MCU look like I2C device with registers, for example as peripheral of host processor.
+ * Registers are array in RAM, host writes register address first and then data or reads data with repeated start:
+ *
+\verbatim
+Write: START | ADDR+W | REG | DATA0 | DATA1 | ... | STOP
+Read:  START | ADDR+W | REG | RESTART | ADDR+R | DATA0 | DATA1 | ... | STOP
+\endverbatim
+ *
+ * Register address auto increments. After write, register pointer is after last written register,
+ * so host can read without register address too.
+ *
+ * \par DMA
+ *
+ * Only address match, register address byte and stop condition are handled in interrupt.
+ * Data are transferred by DMA directly from and to register map, there is no interrupt for each byte.
+ * Clock is stretched only while DMA stream is started, streams are initialized once in @ref TM_I2C_SLAVE_Init.
+ * Reads after the end of map return 0xFF and writes after the end are ignored.
+ *
+ * DMA streams are allocated with TM DMA library, default streams are the same as in TM I2C DMA library.
+ * When no stream is available (or for I2C4 which has no DMA request in TM DMA), data are moved in interrupt for each byte.
+ *
+ * \par Write callbacks
+ *
+ * Each register range can have own callback, called from I2C interrupt after stop condition
+ * when host wrote at least one register in range. Callback gets first written register and number of written registers in range.
+ *
+\code
+uint8_t Registers[64];
+
+void ConfigWritten(I2C_TypeDef* I2Cx, uint8_t register_address, uint16_t count, void* Param) {
+    //Registers 0x10 to 0x1F were changed by host, apply new configuration
+}
+
+const TM_I2C_SLAVE_Range_t Ranges[] = {
+    {0x10, 0x1F, ConfigWritten, NULL},
+};
+
+TM_I2C_SLAVE_t Slave = {Registers, sizeof(Registers), Ranges, 1};
+
+//Respond on address 0x82 on I2C1
+TM_I2C_SLAVE_Init(I2C1, TM_I2C_PinsPack_1, 0x82, &Slave);
+
+//Update status block, host always reads consistent block
+while (!TM_I2C_SLAVE_Update(I2C1, 0x20, &Status, sizeof(Status)));
+\endcode
+ *
+ * \par Interrupt handlers
+ *
+ * Library implements I2C event and error interrupt handlers for I2C used as slave.
+ * To use the same I2C handlers from TM I2C queue for other I2Cs, open defines.h file and add define for each slave I2C:
+ *
+\code
+//Change x with 1-4, I2Cx is used as slave, TM I2C does not implement its interrupt handlers
+#define TM_I2Cx_SLAVE
+\endcode
+ *
+ * \note  Register map memory must stay valid while slave is active
+ * \note  On STM32F7xx register map should be in non-cacheable memory or aligned to cache lines,
+ *        library does cache maintenance for transferred part of map
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM I2C
+ - TM DMA
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_i2c.h"
+#include "tm_stm32_dma.h"
+#include "string.h"
+
+/* Check supported families, DMA streams are needed */
+#if !defined(STM32F4xx) && !defined(STM32F7xx)
+#error "TM I2C SLAVE library supports STM32F4xx and STM32F7xx only!"
+#endif
+
+/**
+ * @defgroup TM_I2C_SLAVE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* I2C clock speed for peripheral timing, slave follows host clock */
+#ifndef I2C_SLAVE_CLOCK
+#define I2C_SLAVE_CLOCK            TM_I2C_CLOCK_FAST_MODE
+#endif
+
+/* NVIC preemption priority for slave I2C interrupts */
+#ifndef I2C_SLAVE_NVIC_PRIORITY
+#define I2C_SLAVE_NVIC_PRIORITY    NVIC_PRIORITY_HIGH
+#endif
+
+/* I2C1 TX and RX default DMA settings, the same as in TM I2C DMA library */
+#ifndef I2C1_DMA_TX_STREAM
+#define I2C1_DMA_TX_STREAM         DMA1_Stream6
+#define I2C1_DMA_TX_CHANNEL        DMA_CHANNEL_1
+#endif
+#ifndef I2C1_DMA_RX_STREAM
+#define I2C1_DMA_RX_STREAM         DMA1_Stream0
+#define I2C1_DMA_RX_CHANNEL        DMA_CHANNEL_1
+#endif
+
+/* I2C2 TX and RX default DMA settings */
+#ifndef I2C2_DMA_TX_STREAM
+#define I2C2_DMA_TX_STREAM         DMA1_Stream7
+#define I2C2_DMA_TX_CHANNEL        DMA_CHANNEL_7
+#endif
+#ifndef I2C2_DMA_RX_STREAM
+#define I2C2_DMA_RX_STREAM         DMA1_Stream3
+#define I2C2_DMA_RX_CHANNEL        DMA_CHANNEL_7
+#endif
+
+/* I2C3 TX and RX default DMA settings */
+#ifndef I2C3_DMA_TX_STREAM
+#define I2C3_DMA_TX_STREAM         DMA1_Stream4
+#define I2C3_DMA_TX_CHANNEL        DMA_CHANNEL_3
+#endif
+#ifndef I2C3_DMA_RX_STREAM
+#define I2C3_DMA_RX_STREAM         DMA1_Stream2
+#define I2C3_DMA_RX_CHANNEL        DMA_CHANNEL_3
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_I2C_SLAVE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Register range write callback
+ * @note   Called from I2C interrupt after stop condition
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  register_address: First written register in range
+ * @param  count: Number of written registers in range
+ * @param  *Param: User parameter from range
+ * @retval None
+ */
+typedef void (*TM_I2C_SLAVE_Callback_t)(I2C_TypeDef* I2Cx, uint8_t register_address, uint16_t count, void* Param);
+
+/**
+ * @brief  Register range with write callback
+ */
+typedef struct {
+	uint8_t First;                    /*!< First register in range */
+	uint8_t Last;                     /*!< Last register in range, including */
+	TM_I2C_SLAVE_Callback_t Callback; /*!< Callback when host writes to range */
+	void* Param;                      /*!< User parameter for callback */
+} TM_I2C_SLAVE_Range_t;
+
+/**
+ * @brief  I2C slave settings and statistics
+ * @note   Structure is used by library while slave is active and must stay valid
+ */
+typedef struct {
+	uint8_t* Map;                        /*!< Pointer to register map */
+	uint16_t Size;                       /*!< Number of registers in map, up to 256 */
+	const TM_I2C_SLAVE_Range_t* Ranges;  /*!< Pointer to ranges with write callbacks, can be NULL */
+	uint8_t RangesCount;                 /*!< Number of ranges */
+	volatile uint16_t Pointer;           /*!< Register pointer, set by host */
+	uint32_t Writes;                     /*!< Number of host writes with data */
+	uint32_t Reads;                      /*!< Number of host reads */
+	uint32_t Errors;                     /*!< Number of bus errors, transfers were dropped */
+} TM_I2C_SLAVE_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_I2C_SLAVE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes I2C peripheral as slave with register map
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  pinspack: Pinspack used for GPIO initialization. This parameter can be a value of @ref TM_I2C_PinsPack_t enumeration
+ * @param  address: 7-bit, left aligned own address
+ * @param  *Slave: Pointer to @ref TM_I2C_SLAVE_t structure with register map
+ * @retval Member of @ref TM_I2C_Result_t enumeration
+ */
+TM_I2C_Result_t TM_I2C_SLAVE_Init(I2C_TypeDef* I2Cx, TM_I2C_PinsPack_t pinspack, uint8_t address, TM_I2C_SLAVE_t* Slave);
+
+/**
+ * @brief  Stops slave, I2C does not respond to own address anymore
+ * @note   DMA streams are released
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @retval None
+ */
+void TM_I2C_SLAVE_DeInit(I2C_TypeDef* I2Cx);
+
+/**
+ * @brief  Copies data to register map when host does not access it
+ * @note   Host transfer can not start during copy, so host always reads consistent block
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  register_address: First register to update
+ * @param  *data: Pointer to new data
+ * @param  count: Number of registers to update
+ * @retval Update status:
+ *           - 0: Host transfer is in progress or registers are out of map, try again later
+ *           - > 0: Registers updated
+ */
+uint8_t TM_I2C_SLAVE_Update(I2C_TypeDef* I2Cx, uint8_t register_address, const void* data, uint16_t count);
+
+/**
+ * @brief  Copies data from register map when host does not access it
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @param  register_address: First register to read
+ * @param  *data: Pointer to memory for data
+ * @param  count: Number of registers to read
+ * @retval Read status:
+ *           - 0: Host transfer is in progress or registers are out of map, try again later
+ *           - > 0: Registers copied
+ */
+uint8_t TM_I2C_SLAVE_Get(I2C_TypeDef* I2Cx, uint8_t register_address, void* data, uint16_t count);
+
+/**
+ * @brief  Checks if host transfer is in progress
+ * @param  *I2Cx: Pointer to I2Cx peripheral
+ * @retval 1 when host is addressing slave, 0 otherwise
+ */
+uint8_t TM_I2C_SLAVE_IsBusy(I2C_TypeDef* I2Cx);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
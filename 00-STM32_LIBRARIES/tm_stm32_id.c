@@ -18,4 +18,110 @@
  */
 #include "tm_stm32_id.h"
 
-/* Nothing is needed here. Everything is done in header file with macros! */
+/* USB descriptor type for string */
+#define ID_USB_DESC_TYPE_STRING  0x03
+
+/* FNV-1a constants */
+#define ID_FNV_OFFSET            0x811C9DC5
+#define ID_FNV_PRIME             0x01000193
+
+/* Identity block */
+static TM_ID_t ID;
+static uint8_t ID_Initialized = 0;
+
+/* Private functions */
+static uint32_t TM_ID_INT_Mix(uint32_t x);
+static void TM_ID_INT_ToHex(uint32_t value, char* str, uint8_t len);
+
+void TM_ID_Init(void) {
+	uint32_t h, r, m1, m2;
+	uint8_t i;
+	
+	/* Read unique ID */
+	for (i = 0; i < 3; i++) {
+		ID.Unique[i] = TM_ID_GetUnique32(i);
+	}
+	ID.FlashSize = TM_ID_GetFlashSize();
+	ID.Signature = TM_ID_GetSignature();
+	
+	/* FNV-1a hash over all bytes, little endian order */
+	h = ID_FNV_OFFSET;
+	for (i = 0; i < 12; i++) {
+		h ^= (ID.Unique[i >> 2] >> (8 * (i & 0x03))) & 0xFF;
+		h *= ID_FNV_PRIME;
+	}
+	ID.Hash = h;
+	
+	/* Serial number string */
+	TM_ID_INT_ToHex(ID.Unique[0] + ID.Unique[2], &ID.Serial[0], 8);
+	TM_ID_INT_ToHex(ID.Unique[1], &ID.Serial[8], 4);
+	ID.Serial[12] = 0;
+	
+	/* USB string descriptor, UTF-16 */
+	ID.USBSerial[0] = ID_USB_SERIAL_SIZE;
+	ID.USBSerial[1] = ID_USB_DESC_TYPE_STRING;
+	for (i = 0; i < 12; i++) {
+		ID.USBSerial[2 + 2 * i] = ID.Serial[i];
+		ID.USBSerial[3 + 2 * i] = 0;
+	}
+	
+	/* Radio address, 4 bytes from mixed hash and lowest byte of hash */
+	r = TM_ID_INT_Mix(h + 1);
+	for (i = 0; i < 5; i++) {
+		ID.RadioAddress[i] = i < 4 ? (r >> (8 * i)) & 0xFF : h & 0xFF;
+		
+		/* Avoid preamble like and constant bytes */
+		if (
+			ID.RadioAddress[i] == 0x00 || ID.RadioAddress[i] == 0xFF ||
+			ID.RadioAddress[i] == 0x55 || ID.RadioAddress[i] == 0xAA
+		) {
+			ID.RadioAddress[i] ^= 0x5A;
+		}
+	}
+	
+	/* MAC address, locally administered and unicast */
+	m1 = TM_ID_INT_Mix(h + 2);
+	m2 = TM_ID_INT_Mix(h + 3);
+	ID.MAC[0] = ((m1 >> 0) & 0xFC) | 0x02;
+	ID.MAC[1] = (m1 >> 8) & 0xFF;
+	ID.MAC[2] = (m1 >> 16) & 0xFF;
+	ID.MAC[3] = (m1 >> 24) & 0xFF;
+	ID.MAC[4] = (m2 >> 0) & 0xFF;
+	ID.MAC[5] = (m2 >> 8) & 0xFF;
+	
+	/* Identity is ready */
+	ID_Initialized = 1;
+}
+
+const TM_ID_t* TM_ID_Get(void) {
+	/* Initialize on first call */
+	if (!ID_Initialized) {
+		TM_ID_Init();
+	}
+	
+	/* Return pointer to identity */
+	return &ID;
+}
+
+/* Private functions */
+static uint32_t TM_ID_INT_Mix(uint32_t x) {
+	/* Finalizer from MurmurHash3, every input bit affects all output bits */
+	x ^= x >> 16;
+	x *= 0x85EBCA6B;
+	x ^= x >> 13;
+	x *= 0xC2B2AE35;
+	x ^= x >> 16;
+	
+	return x;
+}
+
+static void TM_ID_INT_ToHex(uint32_t value, char* str, uint8_t len) {
+	uint8_t i, nibble;
+	
+	/* Most significant nibbles first */
+	for (i = 0; i < len; i++) {
+		nibble = value >> 28;
+		str[i] = nibble < 10 ? nibble + '0' : nibble + 'A' - 10;
+		value <<= 4;
+	}
+}
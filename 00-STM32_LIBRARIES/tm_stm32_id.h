@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/09/hal-library-27-identification-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   Identification library for STM32F0xx, STM32F4xx and STM32F7xx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_IDENTIFICATION_H
-#define TM_IDENTIFICATION_H 100
+#define TM_IDENTIFICATION_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -89,10 +89,35 @@ extern "C" {
  *
  * \par Flash size:
  *  - Device has stored value of flash size in kB
+ *
+ * \par Cached identity block
+ *
+ * Values derived from unique ID (hash, serial number strings, radio address and MAC address)
+ * are calculated only once, in @ref TM_ID_Init function, and stored in @ref TM_ID_t structure.
+ * Libraries which need device identity (USB device serial number, Ethernet MAC address) read it from this structure.
+ *
+ * @ref TM_ID_Get returns pointer to identity block and initializes it on first call, so calling @ref TM_ID_Init is optional.
+ *
+ * Derived values are:
+ *  - Hash: 32-bit FNV-1a hash over all 12 bytes of unique ID
+ *  - Serial: 12 hex characters, first 8 are sum of first and last 32-bit words of unique ID, last 4 are upper half of middle word.
+ *    This is the same serial number as USB libraries were reporting before
+ *  - USBSerial: Serial as USB string descriptor, ready to be returned from USB stack
+ *  - RadioAddress: 5-bytes address for nRF24L01+, bytes 0x00, 0x55, 0xAA and 0xFF are avoided, because they look like preamble or noise
+ *  - MAC: 6-bytes locally administered unicast MAC address
+ *
+\code
+//Use unique radio address for this node
+TM_NRF24L01_SetMyAddress((uint8_t *)TM_ID_Get()->RadioAddress);
+\endcode
  *
  * \par Changelog
  *
 \verbatim
+ Version 1.1
+  - October 14, 2026
+  - Added cached identity block with hash, serial number, radio and MAC address derived from unique ID
+
  Version 1.0
    - First release
 \endverbatim
@@ -145,10 +170,39 @@ extern "C" {
  */
 #define ID_PACKAGE_ADDRESS       0x1FFF7BF0
 
+/**
+ * @brief  Size of USB serial number string descriptor in units of bytes
+ */
+#define ID_USB_SERIAL_SIZE       (2 + 2 * 12)
+
  /**
  * @}
  */
 
+/**
+ * @defgroup TM_ID_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Device identity block, derived from unique ID once at initialization
+ */
+typedef struct {
+	uint32_t Unique[3];                     /*!< 96-bit unique ID */
+	uint32_t Hash;                          /*!< 32-bit FNV-1a hash of unique ID */
+	uint16_t FlashSize;                     /*!< Flash size in kilo bytes */
+	uint16_t Signature;                     /*!< Device signature */
+	char Serial[13];                        /*!< Serial number as 12 hex characters, NULL terminated */
+	uint8_t RadioAddress[5];                /*!< Default nRF24L01+ address */
+	uint8_t MAC[6];                         /*!< Locally administered Ethernet MAC address */
+	uint8_t USBSerial[ID_USB_SERIAL_SIZE];  /*!< Serial number as USB string descriptor */
+} TM_ID_t;
+
+/**
+ * @}
+ */
+
 /**
  * @defgroup TM_ID_Functions
  * @brief    Library Functions
@@ -218,6 +272,22 @@ extern "C" {
  */
 #define TM_ID_GetUnique32(x)     ((x >= 0 && x < 3) ? (*(__IO uint32_t *) (ID_UNIQUE_ADDRESS + 4 * (x))) : 0)
 
+/**
+ * @brief  Reads unique ID and calculates all values in identity block
+ * @note   It is called automatically on first @ref TM_ID_Get call
+ * @param  None
+ * @retval None
+ */
+void TM_ID_Init(void);
+
+/**
+ * @brief  Gets pointer to cached identity block
+ * @note   Identity block is initialized on first call if @ref TM_ID_Init was not called before
+ * @param  None
+ * @retval Pointer to @ref TM_ID_t structure
+ */
+const TM_ID_t* TM_ID_Get(void);
+
 /**
  * @}
  */
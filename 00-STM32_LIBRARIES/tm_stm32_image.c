@@ -0,0 +1,326 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_image.h"
+
+/* Decoder states */
+#define IMAGE_STATE_HEADER          0
+#define IMAGE_STATE_CONTROL         1
+#define IMAGE_STATE_RUN             2
+#define IMAGE_STATE_LITERAL         3
+#define IMAGE_STATE_DONE            4
+#define IMAGE_STATE_ERROR           5
+
+/* Private functions */
+static TM_IMAGE_Result_t TM_IMAGE_INT_StartImage(TM_IMAGE_RLE_t* Dec);
+static void TM_IMAGE_INT_NextRow(TM_IMAGE_RLE_t* Dec);
+static void TM_IMAGE_INT_Run(TM_IMAGE_RLE_t* Dec, uint16_t color, uint16_t count);
+
+#if IMAGE_USE_FATFS
+/* File read buffer */
+static uint8_t IMAGE_FileBuffer[IMAGE_FILE_BUFFER_SIZE];
+#endif
+
+TM_IMAGE_Result_t TM_IMAGE_GetSizeRLE(const void* Data, uint16_t* Width, uint16_t* Height) {
+	const uint8_t* d = (const uint8_t *)Data;
+	
+	/* Check signature */
+	if (d[0] != 'R' || d[1] != 'L') {
+		return TM_IMAGE_Result_Error;
+	}
+	
+	/* Get size */
+	*Width = d[2] | (d[3] << 8);
+	*Height = d[4] | (d[5] << 8);
+	
+	/* Return OK */
+	return TM_IMAGE_Result_Ok;
+}
+
+TM_IMAGE_Result_t TM_IMAGE_DrawRLE(uint16_t X, uint16_t Y, const void* Data, uint32_t Size) {
+	TM_IMAGE_RLE_t Dec;
+	TM_IMAGE_Result_t res;
+	
+	/* Decode whole image at once */
+	TM_IMAGE_RLE_Begin(&Dec, X, Y);
+	res = TM_IMAGE_RLE_Feed(&Dec, Data, Size);
+	
+	/* Data ended before image */
+	if (res == TM_IMAGE_Result_More) {
+		return TM_IMAGE_Result_Error;
+	}
+	
+	/* Return result */
+	return res;
+}
+
+#if IMAGE_USE_FATFS
+TM_IMAGE_Result_t TM_IMAGE_DrawRLEFile(uint16_t X, uint16_t Y, const char* Path) {
+	TM_IMAGE_RLE_t Dec;
+	TM_IMAGE_Result_t res;
+	FIL fil;
+	UINT br;
+	
+	/* Open file */
+	if (f_open(&fil, Path, FA_READ) != FR_OK) {
+		return TM_IMAGE_Result_FileError;
+	}
+	
+	/* Decode file in chunks */
+	res = TM_IMAGE_RLE_Begin(&Dec, X, Y);
+	do {
+		/* Read next chunk */
+		if (f_read(&fil, IMAGE_FileBuffer, sizeof(IMAGE_FileBuffer), &br) != FR_OK) {
+			res = TM_IMAGE_Result_FileError;
+			break;
+		}
+		
+		/* File ended before image */
+		if (br == 0) {
+			res = TM_IMAGE_Result_Error;
+			break;
+		}
+		
+		/* Decode chunk */
+		res = TM_IMAGE_RLE_Feed(&Dec, IMAGE_FileBuffer, br);
+	} while (res == TM_IMAGE_Result_More);
+	
+	/* Close file */
+	f_close(&fil);
+	
+	/* Return result */
+	return res;
+}
+#endif
+
+TM_IMAGE_Result_t TM_IMAGE_RLE_Begin(TM_IMAGE_RLE_t* Dec, uint16_t X, uint16_t Y) {
+	/* Save position */
+	Dec->X = X;
+	Dec->Y = Y;
+	
+	/* Wait for header */
+	Dec->State = IMAGE_STATE_HEADER;
+	Dec->Bytes = 0;
+	
+	/* Return OK */
+	return TM_IMAGE_Result_More;
+}
+
+TM_IMAGE_Result_t TM_IMAGE_RLE_Feed(TM_IMAGE_RLE_t* Dec, const void* Data, uint32_t Size) {
+	const uint8_t* d = (const uint8_t *)Data;
+	const uint8_t* end = d + Size;
+	volatile uint16_t* ptr;
+	uint16_t color;
+	uint8_t c;
+	
+	while (d < end) {
+		switch (Dec->State) {
+			case IMAGE_STATE_HEADER:
+				/* Collect header, it may be split between calls */
+				Dec->Header[Dec->Bytes++] = *d++;
+				if (Dec->Bytes == IMAGE_RLE_HEADER_SIZE && TM_IMAGE_INT_StartImage(Dec) != TM_IMAGE_Result_More) {
+					return TM_IMAGE_Result_Error;
+				}
+				break;
+			case IMAGE_STATE_CONTROL:
+				/* Get packet type and length */
+				c = *d++;
+				Dec->Count = (c & 0x7F) + 1;
+				Dec->State = (c & 0x80) ? IMAGE_STATE_RUN : IMAGE_STATE_LITERAL;
+				Dec->Bytes = 0;
+				break;
+			case IMAGE_STATE_RUN:
+				/* Get color, it may be split between calls */
+				if (Dec->Bytes == 0) {
+					Dec->Low = *d++;
+					Dec->Bytes = 1;
+					break;
+				}
+				color = Dec->Low | (*d++ << 8);
+				
+				/* Write run of pixels */
+				TM_IMAGE_INT_Run(Dec, color, Dec->Count);
+				break;
+			case IMAGE_STATE_LITERAL:
+				/* Finish color split between calls */
+				if (Dec->Bytes) {
+					TM_IMAGE_INT_Run(Dec, Dec->Low | (*d++ << 8), 1);
+					break;
+				}
+				
+				/* Write whole pixels available in data */
+				ptr = Dec->Line + Dec->Column * Dec->StepX;
+				while (Dec->Count && (end - d) >= 2) {
+					/* Write pixel if inside LCD */
+					if (Dec->RowVisible && Dec->Column < Dec->Visible) {
+						*ptr = d[0] | (d[1] << 8);
+					}
+					d += 2;
+					ptr += Dec->StepX;
+					Dec->Count--;
+					
+					/* Go to next row */
+					if (++Dec->Column == Dec->Width) {
+						TM_IMAGE_INT_NextRow(Dec);
+						if (Dec->State == IMAGE_STATE_DONE) {
+							return TM_IMAGE_Result_Ok;
+						}
+						ptr = Dec->Line;
+					}
+				}
+				
+				/* Packet done */
+				if (Dec->Count == 0) {
+					Dec->State = IMAGE_STATE_CONTROL;
+				} else if (d < end) {
+					/* Save low byte of color split between calls */
+					Dec->Low = *d++;
+					Dec->Bytes = 1;
+				}
+				break;
+			case IMAGE_STATE_DONE:
+				/* Remaining bytes are ignored */
+				return TM_IMAGE_Result_Ok;
+			default:
+				return TM_IMAGE_Result_Error;
+		}
+		
+		/* Image complete */
+		if (Dec->State == IMAGE_STATE_DONE) {
+			return TM_IMAGE_Result_Ok;
+		}
+	}
+	
+	/* Check state */
+	if (Dec->State == IMAGE_STATE_DONE) {
+		return TM_IMAGE_Result_Ok;
+	}
+	if (Dec->State == IMAGE_STATE_ERROR) {
+		return TM_IMAGE_Result_Error;
+	}
+	
+	/* Wait for more data */
+	return TM_IMAGE_Result_More;
+}
+
+/* Private functions */
+static TM_IMAGE_Result_t TM_IMAGE_INT_StartImage(TM_IMAGE_RLE_t* Dec) {
+	uint16_t width = TM_LCD_GetWidth();
+	
+	/* Parse header */
+	if (TM_IMAGE_GetSizeRLE(Dec->Header, &Dec->Width, &Dec->Height) != TM_IMAGE_Result_Ok || Dec->Width == 0 || Dec->Height == 0) {
+		Dec->State = IMAGE_STATE_ERROR;
+		return TM_IMAGE_Result_Error;
+	}
+	
+	/* Columns inside LCD */
+	if (Dec->X >= width) {
+		Dec->Visible = 0;
+	} else if ((Dec->X + Dec->Width) > width) {
+		Dec->Visible = width - Dec->X;
+	} else {
+		Dec->Visible = Dec->Width;
+	}
+	
+	/* Get frame buffer, waits for DMA2D */
+	Dec->Frame = TM_DMA2DGRAPHIC_GetPixelAddress(&Dec->StepX, &Dec->StepY);
+	
+	/* Start at first row */
+	Dec->Row = 0;
+	Dec->Column = 0;
+	Dec->Line = Dec->Frame + Dec->X * Dec->StepX + Dec->Y * Dec->StepY;
+	Dec->RowVisible = Dec->Y < TM_LCD_GetHeight();
+	Dec->State = IMAGE_STATE_CONTROL;
+	
+	/* Wait for pixels */
+	return TM_IMAGE_Result_More;
+}
+
+static void TM_IMAGE_INT_NextRow(TM_IMAGE_RLE_t* Dec) {
+	/* Go to next row */
+	Dec->Column = 0;
+	if (++Dec->Row == Dec->Height) {
+		Dec->State = IMAGE_STATE_DONE;
+		return;
+	}
+	
+	/* Update row pointer */
+	Dec->Line += Dec->StepY;
+	Dec->RowVisible = (Dec->Y + Dec->Row) < TM_LCD_GetHeight();
+}
+
+static void TM_IMAGE_INT_Run(TM_IMAGE_RLE_t* Dec, uint16_t color, uint16_t count) {
+	volatile uint16_t* ptr;
+	int32_t step = Dec->StepX;
+	uint16_t n, m;
+	
+	/* Remove pixels from packet */
+	Dec->Count -= count;
+	Dec->Bytes = 0;
+	
+	while (count) {
+		/* Pixels till end of row */
+		n = Dec->Width - Dec->Column;
+		if (n > count) {
+			n = count;
+		}
+		
+		/* Write visible part */
+		if (Dec->RowVisible && Dec->Column < Dec->Visible) {
+			m = Dec->Visible - Dec->Column;
+			if (m > n) {
+				m = n;
+			}
+			ptr = Dec->Line + Dec->Column * step;
+			while (m >= 4) {
+				ptr[0] = color;
+				ptr[step] = color;
+				ptr[2 * step] = color;
+				ptr[3 * step] = color;
+				ptr += 4 * step;
+				m -= 4;
+			}
+			while (m--) {
+				*ptr = color;
+				ptr += step;
+			}
+		}
+		
+		/* Move position */
+		Dec->Column += n;
+		count -= n;
+		if (Dec->Column == Dec->Width) {
+			TM_IMAGE_INT_NextRow(Dec);
+			if (Dec->State == IMAGE_STATE_DONE) {
+				return;
+			}
+		}
+	}
+	
+	/* Packet done */
+	if (Dec->Count == 0) {
+		Dec->State = IMAGE_STATE_CONTROL;
+	}
+}
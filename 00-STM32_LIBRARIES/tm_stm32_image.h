@@ -0,0 +1,292 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Streaming RLE image decoder to LCD frame buffer for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_IMAGE_H
+#define TM_IMAGE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_IMAGE
+ * @brief    Streaming RLE image decoder to LCD frame buffer for STM32Fxxx
+ * @{
+ *
+ * Library draws run-length compressed RGB565 images to LCD.
+ * Images are decoded in a stream and pixels are written directly to frame buffer, no image buffer is needed.
+ *
+ * Typical UI graphics (icons, buttons, backgrounds) are 5-10 times smaller than raw RGB565 arrays.
+ *
+ * \par Image sources
+ *
+ *  - Memory: internal flash, RAM or memory-mapped QSPI flash, with @ref TM_IMAGE_DrawRLE
+ *  - Files: with FatFs, file is read in chunks of @ref IMAGE_FILE_BUFFER_SIZE bytes with @ref TM_IMAGE_DrawRLEFile
+ *  - Other: feed data as they arrive with @ref TM_IMAGE_RLE_Begin and @ref TM_IMAGE_RLE_Feed
+ *
+ * Image can be at any position, pixels outside LCD are skipped. All LCD orientations are supported.
+ *
+ * \par Image format
+ *
+ * Images are created with <code>tm_stm32_image_rle.py</code> script from PNG, BMP or raw RGB565 files:
+ *
+\verbatim
+python tm_stm32_image_rle.py --name logo logo.png > logo.c
+python tm_stm32_image_rle.py --binary logo.png logo.rle
+\endverbatim
+ *
+ * Format, all values are little endian:
+ *
+\verbatim
+Offset  Size  Description
+0       2     Signature "RL"
+2       2     Image width in pixels
+4       2     Image height in pixels
+6       2     Reserved, 0
+8       ...   Packets, pixels row by row from top left corner
+
+Packet: control byte C
+ - C & 0x80: (C & 0x7F) + 1 pixels with one color, one 16-bit RGB565 color follows
+ - Otherwise: C + 1 different pixels follow, 16-bit RGB565 each
+\endverbatim
+ *
+ * \par Example
+ *
+\code
+//Image in internal flash or memory-mapped QSPI
+extern const uint8_t logo[];
+extern const uint32_t logo_size;
+
+//Draw image
+TM_IMAGE_DrawRLE(10, 10, logo, logo_size);
+
+//Draw image from SD card, with IMAGE_USE_FATFS set to 1
+TM_IMAGE_DrawRLEFile(0, 0, "SD:background.rle");
+\endcode
+ *
+ * \par Settings
+ *
+\code
+//Enable FatFs file functions
+#define IMAGE_USE_FATFS              1
+
+//Buffer size for file reading
+#define IMAGE_FILE_BUFFER_SIZE       512
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM LCD
+ - TM DMA2D GRAPHIC
+ - FatFs, when IMAGE_USE_FATFS is enabled
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_lcd.h"
+#include "tm_stm32_dma2d_graphic.h"
+
+/* Decoded pixels are RGB565 */
+#if DMA2D_GRAPHIC_L8
+#error "TM IMAGE needs RGB565 frame buffer, L8 mode is not supported"
+#endif
+
+/**
+ * @defgroup TM_IMAGE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Enable FatFs file functions */
+#ifndef IMAGE_USE_FATFS
+#define IMAGE_USE_FATFS              0
+#endif
+
+/* Buffer size for file reading */
+#ifndef IMAGE_FILE_BUFFER_SIZE
+#define IMAGE_FILE_BUFFER_SIZE       512
+#endif
+
+#if IMAGE_USE_FATFS
+#include "ff.h"
+#endif
+
+/* Size of image header in bytes */
+#define IMAGE_RLE_HEADER_SIZE        8
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_IMAGE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Image result enumeration
+ */
+typedef enum {
+	TM_IMAGE_Result_Ok = 0x00, /*!< Image decoded completely */
+	TM_IMAGE_Result_More,      /*!< Decoder needs more data */
+	TM_IMAGE_Result_Error,     /*!< Invalid image data or data ended before image */
+	TM_IMAGE_Result_FileError  /*!< File can not be opened or read */
+} TM_IMAGE_Result_t;
+
+/**
+ * @brief  RLE decoder structure
+ * @note   Structure is used internally, do not change its members
+ */
+typedef struct {
+	uint16_t X;                  /*!< Image X position on LCD */
+	uint16_t Y;                  /*!< Image Y position on LCD */
+	uint16_t Width;              /*!< Image width from header */
+	uint16_t Height;             /*!< Image height from header */
+	uint16_t Column;             /*!< Column of next pixel */
+	uint16_t Row;                /*!< Row of next pixel */
+	uint16_t Visible;            /*!< Number of columns inside LCD */
+	uint16_t Count;              /*!< Pixels left in current packet */
+	uint8_t Header[IMAGE_RLE_HEADER_SIZE]; /*!< Header bytes */
+	uint8_t Bytes;               /*!< Received bytes of header or partial color */
+	uint8_t Low;                 /*!< Low byte of partial color */
+	uint8_t State;               /*!< Decoder state */
+	uint8_t RowVisible;          /*!< Current row is inside LCD */
+	volatile uint16_t* Frame;    /*!< Frame buffer address of pixel 0, 0 */
+	volatile uint16_t* Line;     /*!< Frame buffer address of first pixel in current row */
+	int32_t StepX;               /*!< Frame buffer step in X direction */
+	int32_t StepY;               /*!< Frame buffer step in Y direction */
+} TM_IMAGE_RLE_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_IMAGE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Gets size of RLE image
+ * @param  *Data: Pointer to image data, at least @ref IMAGE_RLE_HEADER_SIZE bytes
+ * @param  *Width: Pointer to store image width
+ * @param  *Height: Pointer to store image height
+ * @retval Member of @ref TM_IMAGE_Result_t enumeration
+ */
+TM_IMAGE_Result_t TM_IMAGE_GetSizeRLE(const void* Data, uint16_t* Width, uint16_t* Height);
+
+/**
+ * @brief  Draws RLE image from memory
+ * @param  X: X position of top left corner
+ * @param  Y: Y position of top left corner
+ * @param  *Data: Pointer to image data in flash, RAM or memory-mapped QSPI flash
+ * @param  Size: Size of image data in bytes
+ * @retval Member of @ref TM_IMAGE_Result_t enumeration
+ */
+TM_IMAGE_Result_t TM_IMAGE_DrawRLE(uint16_t X, uint16_t Y, const void* Data, uint32_t Size);
+
+#if IMAGE_USE_FATFS || defined(DOXYGEN)
+/**
+ * @brief  Draws RLE image from file
+ * @note   Available only when @ref IMAGE_USE_FATFS is enabled
+ * @param  X: X position of top left corner
+ * @param  Y: Y position of top left corner
+ * @param  *Path: Path to file, FatFs must be mounted
+ * @retval Member of @ref TM_IMAGE_Result_t enumeration
+ */
+TM_IMAGE_Result_t TM_IMAGE_DrawRLEFile(uint16_t X, uint16_t Y, const char* Path);
+#endif
+
+/**
+ * @brief  Starts streaming RLE decoder
+ * @note   LCD layer and orientation must not change until image is decoded
+ * @param  *Dec: Pointer to empty @ref TM_IMAGE_RLE_t structure
+ * @param  X: X position of top left corner
+ * @param  Y: Y position of top left corner
+ * @retval Member of @ref TM_IMAGE_Result_t enumeration
+ */
+TM_IMAGE_Result_t TM_IMAGE_RLE_Begin(TM_IMAGE_RLE_t* Dec, uint16_t X, uint16_t Y);
+
+/**
+ * @brief  Decodes next part of RLE image
+ * @note   Data can be split at any byte
+ * @param  *Dec: Pointer to @ref TM_IMAGE_RLE_t structure
+ * @param  *Data: Pointer to next image bytes
+ * @param  Size: Number of bytes
+ * @retval Member of @ref TM_IMAGE_Result_t enumeration:
+ *            - @ref TM_IMAGE_Result_More: Image is not complete yet, feed more data
+ *            - @ref TM_IMAGE_Result_Ok: Image is complete, remaining bytes are ignored
+ *            - @ref TM_IMAGE_Result_Error: Invalid image
+ */
+TM_IMAGE_Result_t TM_IMAGE_RLE_Feed(TM_IMAGE_RLE_t* Dec, const void* Data, uint32_t Size);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+#
+# RLE image generator for TM IMAGE library
+#
+# Copyright (c) 2016 Tilen Majerle
+# License: MIT, see tm_stm32_image.h
+#
+# Converts image to RGB565 and compresses it with run-length encoding.
+# Output is C file with const array or binary file for FatFs or QSPI flash.
+#
+# Usage:
+#   python tm_stm32_image_rle.py --name logo logo.png > logo.c
+#   python tm_stm32_image_rle.py --binary logo.png logo.rle
+#   python tm_stm32_image_rle.py --raw 320x240 --name background background.bin > background.c
+#
+# PNG, BMP and other formats need Pillow package, raw files are RGB565 little endian.
+#
+
+import argparse
+import struct
+import sys
+
+# Maximum pixels in one packet
+MAX_PACKET = 128
+
+def load_image(path):
+    """Reads image with Pillow and converts it to RGB565"""
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("Pillow package is needed for " + path + ", or use --raw")
+    img = Image.open(path).convert("RGB")
+    width, height = img.size
+    pixels = [((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3) for r, g, b in img.getdata()]
+    return width, height, pixels
+
+def load_raw(path, size):
+    """Reads raw RGB565 little endian image"""
+    width, height = [int(x) for x in size.split("x")]
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) != width * height * 2:
+        sys.exit("Raw file size does not match " + size)
+    return width, height, list(struct.unpack("<%dH" % (width * height), data))
+
+def encode(pixels):
+    """Encodes pixels to packets, runs of 2 or more equal pixels are packed"""
+    out = bytearray()
+    literal = []
+
+    def flush():
+        while literal:
+            chunk = literal[:MAX_PACKET]
+            del literal[:MAX_PACKET]
+            out.append(len(chunk) - 1)
+            for p in chunk:
+                out.extend(struct.pack("<H", p))
+
+    i, count = 0, len(pixels)
+    while i < count:
+        n = 1
+        while i + n < count and n < MAX_PACKET and pixels[i + n] == pixels[i]:
+            n += 1
+        if n >= 2:
+            flush()
+            out.append(0x80 | (n - 1))
+            out += struct.pack("<H", pixels[i])
+        else:
+            literal.append(pixels[i])
+        i += n
+    flush()
+    return out
+
+def main():
+    parser = argparse.ArgumentParser(description="RLE image generator for TM IMAGE library")
+    parser.add_argument("input", help="Input image")
+    parser.add_argument("output", nargs="?", help="Output file for --binary")
+    parser.add_argument("--name", default="image", help="Name of generated array")
+    parser.add_argument("--raw", metavar="WxH", help="Input is raw RGB565 little endian with given size")
+    parser.add_argument("--binary", action="store_true", help="Write binary file instead of C source")
+    args = parser.parse_args()
+
+    if args.raw:
+        width, height, pixels = load_raw(args.input, args.raw)
+    else:
+        width, height, pixels = load_image(args.input)
+    if width > 0xFFFF or height > 0xFFFF:
+        sys.exit("Image is too big")
+
+    data = bytearray(b"RL") + struct.pack("<HHH", width, height, 0) + encode(pixels)
+    sys.stderr.write("%dx%d, %d bytes, %.1f times smaller than raw\n" % (width, height, len(data), width * height * 2.0 / len(data)))
+
+    if args.binary:
+        if not args.output:
+            sys.exit("Output file is needed for --binary")
+        with open(args.output, "wb") as f:
+            f.write(data)
+        return
+
+    name = args.name
+    out = sys.stdout
+    out.write("/* RLE image generated with tm_stm32_image_rle.py, %dx%d, %d bytes */\n" % (width, height, len(data)))
+    out.write("#include \"stdint.h\"\n\n")
+    out.write("const uint8_t %s[] = {\n" % name)
+    for i in range(0, len(data), 16):
+        out.write("\t" + ", ".join("0x%02X" % x for x in data[i:i + 16]) + ",\n")
+    out.write("};\n")
+    out.write("const uint32_t %s_size = %d;\n" % (name, len(data)))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,189 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_iwdg_supervisor.h"
+
+/* Backup register value is ID with magic, so random value after power up is not valid */
+#define IWDG_SUPERVISOR_MAGIC        0x5AFE0000
+#define IWDG_SUPERVISOR_MAGIC_MASK   0xFFFF0000
+
+/* Supervised task */
+typedef struct {
+	const char* Name;             /* Task name */
+	uint32_t Deadline;            /* Maximal time between heartbeats */
+	volatile uint32_t Last;       /* Time of last heartbeat */
+} TM_IWDG_SUPERVISOR_Task_t;
+
+/* Private variables */
+static TM_IWDG_SUPERVISOR_Task_t Tasks[IWDG_SUPERVISOR_TASKS];
+static volatile uint32_t Used;    /* Bit for each added task */
+static volatile uint32_t Time;    /* Milliseconds since init */
+static uint8_t Check;             /* Next task to check */
+static uint8_t Failed = IWDG_SUPERVISOR_NONE;
+static uint8_t LastFailed = IWDG_SUPERVISOR_NONE;
+
+uint8_t TM_IWDG_SUPERVISOR_Init(TM_IWDG_Timeout_t timeout) {
+	uint32_t reg;
+	uint8_t result;
+	
+	/* Start watchdog */
+	result = TM_IWDG_Init(timeout);
+	
+	/* Read task ID from previous reset */
+	reg = TM_RTC_ReadBackupRegister(IWDG_SUPERVISOR_BACKUP_REG);
+	if (result && (reg & IWDG_SUPERVISOR_MAGIC_MASK) == IWDG_SUPERVISOR_MAGIC) {
+		LastFailed = (uint8_t)reg;
+	}
+	
+	/* Clear register */
+	TM_RTC_WriteBackupRegister(IWDG_SUPERVISOR_BACKUP_REG, 0);
+	
+	/* Return reset status */
+	return result;
+}
+
+uint8_t TM_IWDG_SUPERVISOR_Add(const char* Name, uint32_t Deadline) {
+	uint32_t irq;
+	uint8_t i;
+	
+	/* Disable interrupts */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Find free slot */
+	for (i = 0; i < IWDG_SUPERVISOR_TASKS; i++) {
+		if (!(Used & (1UL << i))) {
+			/* Fill task, healthy from now */
+			Tasks[i].Name = Name;
+			Tasks[i].Deadline = Deadline;
+			Tasks[i].Last = Time;
+			
+			/* Task is used */
+			Used |= 1UL << i;
+			break;
+		}
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* No free slot */
+	if (i == IWDG_SUPERVISOR_TASKS) {
+		return IWDG_SUPERVISOR_NONE;
+	}
+	
+	/* Return ID */
+	return i;
+}
+
+void TM_IWDG_SUPERVISOR_Remove(uint8_t id) {
+	uint32_t irq;
+	
+	/* Check ID */
+	if (id >= IWDG_SUPERVISOR_TASKS) {
+		return;
+	}
+	
+	/* Disable interrupts */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Task is not used anymore */
+	Used &= ~(1UL << id);
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_IWDG_SUPERVISOR_Heartbeat(uint8_t id) {
+	/* Save time, single 32-bit write */
+	if (id < IWDG_SUPERVISOR_TASKS) {
+		Tasks[id].Last = Time;
+	}
+}
+
+void TM_IWDG_SUPERVISOR_Tick(void) {
+	TM_IWDG_SUPERVISOR_Task_t* Task;
+	
+	/* Task has already failed, wait for reset */
+	if (Failed != IWDG_SUPERVISOR_NONE) {
+		return;
+	}
+	
+	/* Increase time */
+	Time++;
+	
+	/* Check one task */
+	if (Used & (1UL << Check)) {
+		Task = &Tasks[Check];
+		
+		/* Deadline missed */
+		if ((Time - Task->Last) > Task->Deadline) {
+			Failed = Check;
+			
+			/* Store ID for triage after reset */
+			TM_RTC_WriteBackupRegister(IWDG_SUPERVISOR_BACKUP_REG, IWDG_SUPERVISOR_MAGIC | Check);
+			
+			/* Call user function */
+			TM_IWDG_SUPERVISOR_FailCallback(Check);
+			
+			/* Do not refresh watchdog anymore */
+			return;
+		}
+	}
+	
+	/* Go to next task */
+	if (++Check >= IWDG_SUPERVISOR_TASKS) {
+		Check = 0;
+	}
+	
+	/* All tasks are healthy, refresh watchdog */
+	TM_IWDG_Reset();
+}
+
+uint8_t TM_IWDG_SUPERVISOR_GetFailed(void) {
+	return LastFailed;
+}
+
+const char* TM_IWDG_SUPERVISOR_GetName(uint8_t id) {
+	/* Check ID */
+	if (id >= IWDG_SUPERVISOR_TASKS || !(Used & (1UL << id))) {
+		return NULL;
+	}
+	
+	/* Return name */
+	return Tasks[id].Name;
+}
+
+/* Callbacks */
+__weak void TM_IWDG_SUPERVISOR_FailCallback(uint8_t id) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_IWDG_SUPERVISOR_FailCallback could be implemented in the user file
+	*/
+}
@@ -0,0 +1,237 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Watchdog supervisor with per task heartbeats for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_IWDG_SUPERVISOR_H
+#define TM_IWDG_SUPERVISOR_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_IWDG_SUPERVISOR
+ * @brief    Watchdog supervisor with per task heartbeats for STM32Fxxx
+ * @{
+ *
+ * Supervisor refreshes independent watchdog only when all registered tasks are healthy.
+ * Each task has name and deadline in milliseconds and must call @ref TM_IWDG_SUPERVISOR_Heartbeat before its deadline expires.
+ *
+ * @ref TM_IWDG_SUPERVISOR_Tick must be called every 1ms, for example from @ref TM_DELAY_1msHandler.
+ * Each tick checks only one task, tasks are checked in round robin, so tick time does not depend on number of tasks.
+ * Missed deadline is detected at most number of tasks milliseconds late.
+ *
+ * When task misses its deadline, its ID is stored to RTC backup register and watchdog is not refreshed anymore,
+ * so IWDG resets the device. After reset, @ref TM_IWDG_SUPERVISOR_GetFailed returns ID of task which caused reset.
+ *
+\code
+uint8_t SensorTask, NetTask;
+
+TM_RTC_Init(TM_RTC_ClockSource_Internal);
+if (TM_IWDG_SUPERVISOR_Init(TM_IWDG_Timeout_250ms)) {
+	printf("Watchdog reset by task %d\n", TM_IWDG_SUPERVISOR_GetFailed());
+}
+
+SensorTask = TM_IWDG_SUPERVISOR_Add("Sensor", 100);
+NetTask = TM_IWDG_SUPERVISOR_Add("Net", 2000);
+
+//In sensor task loop
+TM_IWDG_SUPERVISOR_Heartbeat(SensorTask);
+
+//Every 1ms
+void TM_DELAY_1msHandler(void) {
+	TM_IWDG_SUPERVISOR_Tick();
+}
+\endcode
+ *
+ * @note  RTC must be initialized before @ref TM_IWDG_SUPERVISOR_Init to have access to backup registers
+ *
+ * To change settings, open defines.h file and add lines:
+ *
+\code
+//Maximal number of supervised tasks, up to 32
+#define IWDG_SUPERVISOR_TASKS        8
+
+//RTC backup register for failed task ID
+#define IWDG_SUPERVISOR_BACKUP_REG   18
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM IWDG
+ - TM RTC
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_iwdg.h"
+#include "tm_stm32_rtc.h"
+
+/**
+ * @defgroup TM_IWDG_SUPERVISOR_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Maximal number of supervised tasks */
+#ifndef IWDG_SUPERVISOR_TASKS
+#define IWDG_SUPERVISOR_TASKS        8
+#endif
+
+/* RTC backup register for failed task ID */
+#ifndef IWDG_SUPERVISOR_BACKUP_REG
+#define IWDG_SUPERVISOR_BACKUP_REG   18
+#endif
+
+/* Check value */
+#if IWDG_SUPERVISOR_TASKS > 32
+#error "IWDG_SUPERVISOR_TASKS can not be more than 32"
+#endif
+
+/**
+ * @brief  Invalid task ID, returned when task can not be added or no task failed
+ */
+#define IWDG_SUPERVISOR_NONE         0xFF
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_IWDG_SUPERVISOR_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes supervisor and starts independent watchdog
+ * @note   After you initialize it, you can't disable it unless reset occur.
+ * @param  timeout: Watchdog timeout. This parameter can be a value of @ref TM_IWDG_Timeout_t enumeration
+ * @retval Value if system was reset because of watchdog timer
+ *            - 1: Reset happen because of watchdog
+ *            - 0: Otherwise
+ */
+uint8_t TM_IWDG_SUPERVISOR_Init(TM_IWDG_Timeout_t timeout);
+
+/**
+ * @brief  Adds task to supervisor
+ * @note   Task is healthy when added, first heartbeat is expected before deadline
+ * @param  *Name: Task name, must stay valid, use string literals
+ * @param  Deadline: Maximal time between heartbeats in milliseconds
+ * @retval Task ID or @ref IWDG_SUPERVISOR_NONE if there is no free slot
+ */
+uint8_t TM_IWDG_SUPERVISOR_Add(const char* Name, uint32_t Deadline);
+
+/**
+ * @brief  Removes task from supervisor, for example when task ends
+ * @param  id: Task ID returned by @ref TM_IWDG_SUPERVISOR_Add
+ * @retval None
+ */
+void TM_IWDG_SUPERVISOR_Remove(uint8_t id);
+
+/**
+ * @brief  Reports that task is alive
+ * @note   Can be called from any task or interrupt
+ * @param  id: Task ID returned by @ref TM_IWDG_SUPERVISOR_Add
+ * @retval None
+ */
+void TM_IWDG_SUPERVISOR_Heartbeat(uint8_t id);
+
+/**
+ * @brief  Checks one task and refreshes watchdog when all tasks are healthy
+ * @note   Must be called every 1ms
+ * @param  None
+ * @retval None
+ */
+void TM_IWDG_SUPERVISOR_Tick(void);
+
+/**
+ * @brief  Gets ID of task which missed its deadline and caused last watchdog reset
+ * @param  None
+ * @retval Task ID or @ref IWDG_SUPERVISOR_NONE if reset was not caused by supervised task
+ */
+uint8_t TM_IWDG_SUPERVISOR_GetFailed(void);
+
+/**
+ * @brief  Gets task name
+ * @param  id: Task ID
+ * @retval Pointer to task name or NULL if task does not exist
+ */
+const char* TM_IWDG_SUPERVISOR_GetName(uint8_t id);
+
+/**
+ * @brief  Called when task misses its deadline, before watchdog reset
+ * @note   Called from @ref TM_IWDG_SUPERVISOR_Tick, keep it short
+ * @param  id: ID of task which missed deadline
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_IWDG_SUPERVISOR_FailCallback(uint8_t id);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -89,6 +89,16 @@ static void TM_LCD_INT_InitLTDC(void);
 static void TM_LCD_INT_InitLayers(void);
 static void TM_LCD_INT_InitLCD(void);
 static void TM_LCD_INT_InitPins(void);
+#if LCD_USE_L8
+static void TM_LCD_INT_InitCLUT(void);
+#endif
+static TM_LCD_Result_t TM_LCD_INT_CheckLine(char c);
+static uint8_t TM_LCD_INT_CanDrawGlyphs(uint16_t count);
+static void TM_LCD_INT_DrawCharGlyph(char c);
+static void TM_LCD_INT_DrawCharPixels(char c);
+#if LCD_GLYPH_CACHE_COUNT > 0
+static const uint8_t* TM_LCD_INT_GetGlyph(char c);
+#endif
 
 /* Private variables */
 static LTDC_HandleTypeDef LTDCHandle;
@@ -105,6 +115,10 @@ typedef struct _TM_LCD_INT_t {
 	uint32_t FrameOffset;
 	uint8_t CurrentLayer;
 	
+	/* Double buffering */
+	uint8_t FrontBuffer;
+	uint8_t SwapChain;
+	
 	/* Strings */
 	uint32_t ForegroundColor;
 	uint32_t BackgroundColor;
@@ -115,6 +129,17 @@ typedef struct _TM_LCD_INT_t {
 } TM_LCD_INT_t;
 static TM_LCD_INT_t LCD;
 
+#if LCD_GLYPH_CACHE_COUNT > 0
+/* Glyph cache entry */
+typedef struct _TM_LCD_INT_Glyph_t {
+	TM_FONT_t* Font;
+	char Character;
+	uint8_t Data[(LCD_GLYPH_CACHE_SIZE + 31) & ~31] __attribute__((aligned(32)));
+} TM_LCD_INT_Glyph_t;
+static TM_LCD_INT_Glyph_t LCD_Glyphs[LCD_GLYPH_CACHE_COUNT];
+static uint8_t LCD_GlyphNext;
+#endif
+
 TM_LCD_Result_t TM_LCD_Init(void) {
 	TM_DMA2DGRAPHIC_INT_Conf_t DMA2DConf;
 	
@@ -130,9 +155,9 @@ TM_LCD_Result_t TM_LCD_Init(void) {
 	LCD.CurrentFrameBuffer = LCD_FRAME_BUFFER;
 	LCD.FrameStart = LCD_FRAME_BUFFER;
 	LCD.FrameOffset = LCD_BUFFER_OFFSET;
-	LCD.CurrentFont = &TM_Font_11x18;
-	LCD.ForegroundColor = 0x0000;
-	LCD.BackgroundColor = 0xFFFF;
+	LCD.CurrentFont = &LCD_FONT_DEFAULT;
+	LCD.ForegroundColor = LCD_COLOR_BLACK;
+	LCD.BackgroundColor = LCD_COLOR_WHITE;
 	LCD.Orientation = 1;
 	
 	/* Set orientation */
@@ -302,38 +327,21 @@ TM_LCD_Result_t TM_LCD_SetColors(uint32_t Foreground, uint32_t Background) {
 }
 
 TM_LCD_Result_t TM_LCD_Putc(char c) {
-	uint32_t i, b, j;
-	
-	/* Check current coordinates */
-	if ((LCD.CurrentX + LCD.CurrentFont->FontWidth) >= LCD.CurrentWidth || c == '\n') {
-		/* If at the end of a line of display, go to new line and set x to 0 position */
-		LCD.CurrentY += LCD.CurrentFont->FontHeight;
-		LCD.CurrentX = LCD.StartX;
-		
-		/* Check X */
-		if ((LCD.CurrentX + LCD.CurrentFont->FontWidth) >= LCD.CurrentWidth) {
-			LCD.CurrentX = 0;
-		}
-		
-		/* Check for Y position */
-		if (LCD.CurrentY >= LCD.CurrentHeight) {
-			/* Return error */
-			return TM_LCD_Result_Error;
-		}
+	/* Go to new line if needed */
+	if (TM_LCD_INT_CheckLine(c) != TM_LCD_Result_Ok) {
+		/* Return error */
+		return TM_LCD_Result_Error;
 	}
 	
 	/* Draw character */
 	if (c != '\n') {
-		/* Draw all pixels */
-		for (i = 0; i < LCD.CurrentFont->FontHeight; i++) {
-			b = LCD.CurrentFont->data[(c - 32) * LCD.CurrentFont->FontHeight + i];
-			for (j = 0; j < LCD.CurrentFont->FontWidth; j++) {
-				if ((b << j) & 0x8000) {
-					TM_DMA2DGRAPHIC_DrawPixel(LCD.CurrentX + j, (LCD.CurrentY + i), LCD.ForegroundColor);
-				} else {
-					TM_DMA2DGRAPHIC_DrawPixel(LCD.CurrentX + j, (LCD.CurrentY + i), LCD.BackgroundColor);
-				}
-			}
+		if (TM_LCD_INT_CanDrawGlyphs(1)) {
+			/* Fill background and blend glyph over it */
+			TM_DMA2DGRAPHIC_DrawFilledRectangle(LCD.CurrentX, LCD.CurrentY, LCD.CurrentFont->FontWidth, LCD.CurrentFont->FontHeight, LCD.BackgroundColor);
+			TM_LCD_INT_DrawCharGlyph(c);
+		} else {
+			/* Draw all pixels */
+			TM_LCD_INT_DrawCharPixels(c);
 		}
 	
 		/* Set new current X location */
@@ -358,16 +366,49 @@ uint32_t TM_LCD_GetPixel(uint16_t X, uint16_t Y) {
 }
 
 TM_LCD_Result_t TM_LCD_Puts(char* str) {
+	uint16_t count;
+	
 	/* Send till string ends or error returned */
 	while (*str) {
-		/* Check if string OK */
-		if (TM_LCD_Putc(*str) != TM_LCD_Result_Ok) {
+		/* Go to new line if needed */
+		if (TM_LCD_INT_CheckLine(*str) != TM_LCD_Result_Ok) {
 			/* Return error */
 			return TM_LCD_Result_Error;
 		}
 		
-		/* Increase pointer */
-		str++;
+		/* New line was made */
+		if (*str == '\n') {
+			str++;
+			continue;
+		}
+		
+		/* Count characters which fit to current line */
+		count = 1;
+		while (
+			str[count] && str[count] != '\n' &&
+			(LCD.CurrentX + (count + 1) * LCD.CurrentFont->FontWidth) < LCD.CurrentWidth
+		) {
+			count++;
+		}
+		
+		if (TM_LCD_INT_CanDrawGlyphs(count)) {
+			/* Fill background for all characters at once */
+			TM_DMA2DGRAPHIC_DrawFilledRectangle(LCD.CurrentX, LCD.CurrentY, count * LCD.CurrentFont->FontWidth, LCD.CurrentFont->FontHeight, LCD.BackgroundColor);
+			
+			/* Blend glyphs over background */
+			while (count--) {
+				TM_LCD_INT_DrawCharGlyph(*str++);
+				LCD.CurrentX += LCD.CurrentFont->FontWidth;
+			}
+		} else {
+			/* Draw character by character */
+			while (count--) {
+				if (TM_LCD_Putc(*str++) != TM_LCD_Result_Ok) {
+					/* Return error */
+					return TM_LCD_Result_Error;
+				}
+			}
+		}
 	}
 	
 	/* Return OK */
@@ -461,6 +502,101 @@ TM_LCD_Result_t TM_LCD_Layer1To2(void) {
 	return TM_LCD_Result_Ok;
 }
 
+TM_LCD_Result_t TM_LCD_BeginFrame(void) {
+	/* Make layer 1 only visible layer for first frame */
+	if (!LCD.SwapChain) {
+		LCD.SwapChain = 1;
+		LCD.FrontBuffer = 0;
+		TM_LCD_SetLayer1Opacity(255);
+		TM_LCD_SetLayer2Opacity(0);
+		
+		/* Enable register reload interrupt */
+		HAL_NVIC_SetPriority(LTDC_IRQn, LCD_NVIC_PRIORITY, 0);
+		HAL_NVIC_EnableIRQ(LTDC_IRQn);
+		LTDC->IER |= LTDC_IER_RRIE;
+	}
+	
+	/* Wait till previous frame is loaded by LTDC */
+	while (TM_LCD_IsPresenting());
+	
+	/* Draw to buffer which is not displayed */
+	if (LCD.FrontBuffer == 0) {
+		TM_LCD_SetLayer2();
+	} else {
+		TM_LCD_SetLayer1();
+	}
+	
+	/* Return OK */
+	return TM_LCD_Result_Ok;
+}
+
+TM_LCD_Result_t TM_LCD_Present(void) {
+	/* Check if frame was started */
+	if (!LCD.SwapChain) {
+		return TM_LCD_Result_Error;
+	}
+	
+	/* Queued drawing must be finished before frame is shown */
+	TM_DMA2DGRAPHIC_WaitIdle();
+	
+	/* Set new address for layer 1, active after reload */
+	/* Keep HAL layer settings in sync, HAL rewrites address on each layer change */
+	LTDCHandle.LayerCfg[0].FBStartAdress = LCD.CurrentFrameBuffer;
+	LTDC_Layer1->CFBAR = LCD.CurrentFrameBuffer;
+	LCD.FrontBuffer = LCD.CurrentLayer;
+	
+	/* Reload shadow registers at vertical blanking */
+	LTDC->SRCR = LTDC_SRCR_VBR;
+	
+	/* Return OK */
+	return TM_LCD_Result_Ok;
+}
+
+uint8_t TM_LCD_IsPresenting(void) {
+	/* Reload never happens when LTDC is disabled */
+	if (!(LTDC->GCR & LTDC_GCR_LTDCEN)) {
+		return 0;
+	}
+	
+	/* Bit is cleared by hardware after reload */
+	return (LTDC->SRCR & LTDC_SRCR_VBR) ? 1 : 0;
+}
+
+__weak void TM_LCD_PresentCallback(void) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_LCD_PresentCallback could be implemented in the user file
+	*/
+}
+
+TM_LCD_Result_t TM_LCD_SetCLUT(uint8_t Start, const uint32_t* Colors, uint16_t Count) {
+	/* Check table size */
+	if ((Start + Count) > 256) {
+		return TM_LCD_Result_Error;
+	}
+	
+	/* Write colors to both layers, index is in upper byte */
+	while (Count--) {
+		LTDC_Layer1->CLUTWR = ((uint32_t)Start << 24) | (*Colors & 0x00FFFFFF);
+		LTDC_Layer2->CLUTWR = ((uint32_t)Start << 24) | (*Colors & 0x00FFFFFF);
+		Start++;
+		Colors++;
+	}
+	
+	/* Return OK */
+	return TM_LCD_Result_Ok;
+}
+
+void LTDC_IRQHandler(void) {
+	/* Check register reload flag */
+	if (LTDC->ISR & LTDC_ISR_RRIF) {
+		/* Clear flag */
+		LTDC->ICR = LTDC_ICR_CRRIF;
+		
+		/* Call user function */
+		TM_LCD_PresentCallback();
+	}
+}
+
 TM_LCD_Result_t TM_LCD_DrawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint32_t color) {
 	/* Draw line with DMA2D */
 	TM_DMA2DGRAPHIC_DrawLine(x0, y0, x1, y1, color);
@@ -542,6 +678,115 @@ uint8_t TM_LCD_GetOrientation(void) {
 }
 
 /* Private functions */
+static TM_LCD_Result_t TM_LCD_INT_CheckLine(char c) {
+	/* Check current coordinates */
+	if ((LCD.CurrentX + LCD.CurrentFont->FontWidth) >= LCD.CurrentWidth || c == '\n') {
+		/* If at the end of a line of display, go to new line and set x to 0 position */
+		LCD.CurrentY += LCD.CurrentFont->FontHeight;
+		LCD.CurrentX = LCD.StartX;
+		
+		/* Check X */
+		if ((LCD.CurrentX + LCD.CurrentFont->FontWidth) >= LCD.CurrentWidth) {
+			LCD.CurrentX = 0;
+		}
+		
+		/* Check for Y position */
+		if (LCD.CurrentY >= LCD.CurrentHeight) {
+			/* Return error */
+			return TM_LCD_Result_Error;
+		}
+	}
+	
+	/* Return OK */
+	return TM_LCD_Result_Ok;
+}
+
+static uint8_t TM_LCD_INT_CanDrawGlyphs(uint16_t count) {
+#if LCD_GLYPH_CACHE_COUNT > 0
+	/* DMA2D can draw glyphs in normal orientation only, completely inside LCD */
+	return
+		LCD.Orientation == 1 &&
+		(LCD.CurrentFont->FontWidth * LCD.CurrentFont->FontHeight) <= LCD_GLYPH_CACHE_SIZE &&
+		(LCD.CurrentX + count * LCD.CurrentFont->FontWidth) <= LCD.CurrentWidth &&
+		(LCD.CurrentY + LCD.CurrentFont->FontHeight) <= LCD.CurrentHeight;
+#else
+	/* Cache disabled */
+	return 0;
+#endif
+}
+
+static void TM_LCD_INT_DrawCharGlyph(char c) {
+#if LCD_GLYPH_CACHE_COUNT > 0
+	/* Draw foreground from cache, background is already filled */
+	if (TM_DMA2DGRAPHIC_DrawAlphaBitmap(LCD.CurrentX, LCD.CurrentY, LCD.CurrentFont->FontWidth, LCD.CurrentFont->FontHeight, TM_LCD_INT_GetGlyph(c), LCD.ForegroundColor)) {
+		return;
+	}
+#endif
+	
+	/* Draw all pixels */
+	TM_LCD_INT_DrawCharPixels(c);
+}
+
+static void TM_LCD_INT_DrawCharPixels(char c) {
+	TM_FONT_GLYPH_t FontGlyph;
+	uint32_t i, b, j;
+	
+	/* Get font glyph */
+	TM_FONT_GetGlyph(LCD.CurrentFont, c, &FontGlyph);
+	
+	/* Draw all pixels */
+	for (i = 0; i < LCD.CurrentFont->FontHeight; i++) {
+		b = TM_FONT_GetRow(&FontGlyph, i);
+		for (j = 0; j < LCD.CurrentFont->FontWidth; j++) {
+			if ((b << j) & 0x8000) {
+				TM_DMA2DGRAPHIC_DrawPixel(LCD.CurrentX + j, (LCD.CurrentY + i), LCD.ForegroundColor);
+			} else {
+				TM_DMA2DGRAPHIC_DrawPixel(LCD.CurrentX + j, (LCD.CurrentY + i), LCD.BackgroundColor);
+			}
+		}
+	}
+}
+
+#if LCD_GLYPH_CACHE_COUNT > 0
+static const uint8_t* TM_LCD_INT_GetGlyph(char c) {
+	TM_LCD_INT_Glyph_t* Glyph;
+	TM_FONT_GLYPH_t FontGlyph;
+	uint32_t i, b, j;
+	uint8_t* ptr;
+	
+	/* Search cache */
+	for (i = 0; i < LCD_GLYPH_CACHE_COUNT; i++) {
+		if (LCD_Glyphs[i].Font == LCD.CurrentFont && LCD_Glyphs[i].Character == c) {
+			return LCD_Glyphs[i].Data;
+		}
+	}
+	
+	/* Queued DMA2D transfer may still read entry which will be replaced */
+	TM_DMA2DGRAPHIC_WaitIdle();
+	
+	/* Replace oldest entry */
+	Glyph = &LCD_Glyphs[LCD_GlyphNext];
+	if (++LCD_GlyphNext >= LCD_GLYPH_CACHE_COUNT) {
+		LCD_GlyphNext = 0;
+	}
+	Glyph->Font = LCD.CurrentFont;
+	Glyph->Character = c;
+	
+	/* Expand font bits to alpha bytes */
+	TM_FONT_GetGlyph(LCD.CurrentFont, c, &FontGlyph);
+	ptr = Glyph->Data;
+	for (i = 0; i < LCD.CurrentFont->FontHeight; i++) {
+		b = TM_FONT_GetRow(&FontGlyph, i);
+		for (j = 0; j < LCD.CurrentFont->FontWidth; j++) {
+			*ptr++ = ((b << j) & 0x8000) ? 0xFF : 0x00;
+		}
+	}
+	
+	/* Return expanded glyph */
+	return Glyph->Data;
+}
+#endif
+
 static void TM_LCD_INT_InitLTDC(void) {
 	RCC_PeriphCLKInitTypeDef  periph_clk_init_struct;
 	
@@ -602,7 +847,11 @@ static void TM_LCD_INT_InitLayers(void) {
 	layer_cfg.WindowX1 = LCD_PIXEL_WIDTH;
 	layer_cfg.WindowY0 = 0;
 	layer_cfg.WindowY1 = LCD_PIXEL_HEIGHT; 
+#if LCD_USE_L8
+	layer_cfg.PixelFormat = LTDC_PIXEL_FORMAT_L8;
+#else
 	layer_cfg.PixelFormat = LTDC_PIXEL_FORMAT_RGB565;
+#endif
 	layer_cfg.FBStartAdress = SDRAM_START_ADR;
 	layer_cfg.Alpha = 255;
 	layer_cfg.Alpha0 = 0;
@@ -623,7 +872,29 @@ static void TM_LCD_INT_InitLayers(void) {
 
 	/* Init layer 2 */
 	HAL_LTDC_ConfigLayer(&LTDCHandle, &layer_cfg, 1);
+	
+#if LCD_USE_L8
+	/* Load default palette and enable color lookup on both layers */
+	TM_LCD_INT_InitCLUT();
+	HAL_LTDC_EnableCLUT(&LTDCHandle, 0);
+	HAL_LTDC_EnableCLUT(&LTDCHandle, 1);
+#endif
+}
+
+#if LCD_USE_L8
+static void TM_LCD_INT_InitCLUT(void) {
+	uint32_t color;
+	uint16_t i;
+	
+	/* RGB332 palette, index bits are RRRGGGBB */
+	for (i = 0; i < 256; i++) {
+		color  = (((i >> 5) & 0x07) * 255 / 7) << 16;
+		color |= (((i >> 2) & 0x07) * 255 / 7) << 8;
+		color |= (((i >> 0) & 0x03) * 255 / 3);
+		TM_LCD_SetCLUT(i, &color, 1);
+	}
 }
+#endif
 
 /* ILI9341 related functions */
 #if defined(LCD_USE_STM32F429_DISCOVERY)
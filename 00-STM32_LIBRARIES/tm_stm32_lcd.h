@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-12-lcd-for-stm32fxxx/
- * @version v1.0
+ * @version v1.5
  * @ide     Keil uVision
  * @license MIT
  * @brief   Library template 
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_LCD_H
-#define TM_LCD_H 100
+#define TM_LCD_H 150
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -93,11 +93,90 @@ extern "C" {
  *
  * For list of all supported fonts, check @ref TM_FONTS library with description.
  *
+ * \par Fast string drawing
+ *
+ * Characters are expanded from font data to 8-bit alpha glyphs on first use and stored in small cache.
+ * Cached glyphs are drawn with DMA2D in one transfer each, and @ref TM_LCD_Puts fills background
+ * for entire run of characters on a line at once, instead of drawing every pixel separately.
+ *
+ * DMA2D can not rotate bitmaps, so fast drawing is used in normal orientation (1) only.
+ * In other orientations or when glyph does not fit to cache, characters are drawn pixel by pixel.
+ *
+ * Cache can be customized in defines.h file:
+ *
+\code
+//Number of cached glyphs, set to 0 to disable cache
+#define LCD_GLYPH_CACHE_COUNT      16
+//Maximal glyph size in bytes (width * height), 16x26 font is largest
+#define LCD_GLYPH_CACHE_SIZE       (16 * 26)
+\endcode
+ *
+ * \par Double buffering without tearing
+ *
+ * Layer 1 can be switched between 2 frame buffers (memory of layer 1 and layer 2) at vertical blanking.
+ * Draw to back buffer after @ref TM_LCD_BeginFrame and show it with @ref TM_LCD_Present.
+ * New address is loaded by LTDC in vertical blanking period, so there is no tearing and no copy of entire frame.
+ *
+\code
+while (1) {
+    //Wait till back buffer is not displayed anymore and select it for drawing
+    TM_LCD_BeginFrame();
+    
+    //Draw complete frame
+    TM_LCD_Fill(LCD_COLOR_WHITE);
+    TM_LCD_Puts("Hello");
+    
+    //Show frame on next vertical blanking, function does not wait
+    TM_LCD_Present();
+}
+\endcode
+ *
+ * When LTDC loads new address, @ref TM_LCD_PresentCallback is called from interrupt, previous front buffer is free from that moment.
+ * Layer 2 is made transparent on first @ref TM_LCD_BeginFrame call.
+ *
+ * \par 8-bit indexed frame buffer
+ *
+ * With L8 mode, each pixel is 1 byte index to color lookup table (CLUT) of 256 colors.
+ * Frame buffers use half of memory and LTDC reads half of data from SDRAM, so more bandwidth is left for CPU and DMA2D.
+ *
+\code
+//Use 8-bit indexed colors
+#define LCD_USE_L8                 1
+\endcode
+ *
+ * CLUT is loaded with RGB332 palette on init and LCD_COLOR_xxx defines are indexes to this palette.
+ * Own palette can be loaded with @ref TM_LCD_SetCLUT function.
+ *
+ * DMA2D can not blend to L8 buffer, so glyph cache is disabled and characters are drawn pixel by pixel.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added glyph cache, characters are drawn with DMA2D alpha blending
+  - TM_LCD_Puts fills background for all characters in a line at once
+  
+ Version 1.2
+  - October 14, 2026
+  - Added TM_LCD_BeginFrame and TM_LCD_Present functions for double buffering, synchronized to vertical blanking
+  
+ Version 1.3
+  - October 14, 2026
+  - Packed fonts are supported, drawn in cells of max glyph width
+  - Added LCD_FONT_DEFAULT setting
+  
+ Version 1.4
+  - October 14, 2026
+  - Added 8-bit indexed (L8) frame buffer mode with color lookup table
+  - Added TM_LCD_SetCLUT function
+  
+ Version 1.5
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
 \endverbatim
  *
  * \par Dependencies
@@ -126,6 +205,11 @@ extern "C" {
  * @{
  */
 
+/* 8-bit indexed frame buffer */
+#ifndef LCD_USE_L8
+#define LCD_USE_L8                 0
+#endif
+
 #if defined(LCD_USE_STM32F7_DISCOVERY) || defined(STM32F7_DISCOVERY)
 	/* Check define */
 	#ifndef LCD_USE_STM32F7_DISCOVERY
@@ -135,7 +219,7 @@ extern "C" {
 	/* Set pixel settings */
 	#define LCD_PIXEL_WIDTH        480
 	#define LCD_PIXEL_HEIGHT       272
-	#define LCD_PIXEL_SIZE         2
+	#define LCD_PIXEL_SIZE         (LCD_USE_L8 ? 1 : 2)
 	
 	/* LCD configuration */
 	#define LCD_HSYNC              41
@@ -156,7 +240,7 @@ extern "C" {
 	/* Set pixel settings */
 	#define LCD_PIXEL_WIDTH        640
 	#define LCD_PIXEL_HEIGHT       480
-	#define LCD_PIXEL_SIZE         2
+	#define LCD_PIXEL_SIZE         (LCD_USE_L8 ? 1 : 2)
 	
 	/* LCD configuration */
 	#define LCD_HSYNC              30
@@ -177,7 +261,7 @@ extern "C" {
 	/* STM32F429-Discovery */
 	#define LCD_PIXEL_WIDTH        240
 	#define LCD_PIXEL_HEIGHT       320
-	#define LCD_PIXEL_SIZE         2
+	#define LCD_PIXEL_SIZE         (LCD_USE_L8 ? 1 : 2)
 
 	/* LCD configuration */
 	#define LCD_HSYNC              9
@@ -195,12 +279,52 @@ extern "C" {
 #define LCD_FRAME_BUFFER           ((uint32_t)SDRAM_START_ADR)
 #define LCD_BUFFER_OFFSET          ((uint32_t)(LCD_PIXEL_WIDTH * LCD_PIXEL_HEIGHT * LCD_PIXEL_SIZE))
 
+/* LTDC NVIC priority for frame presentation */
+#ifndef LCD_NVIC_PRIORITY
+#define LCD_NVIC_PRIORITY          NVIC_PRIORITY_NORMAL
+#endif
+
+/* Number of cached font glyphs, DMA2D can not blend glyphs to L8 buffer */
+#ifndef LCD_GLYPH_CACHE_COUNT
+#if LCD_USE_L8
+#define LCD_GLYPH_CACHE_COUNT      0
+#else
+#define LCD_GLYPH_CACHE_COUNT      16
+#endif
+#endif
+
+/* Font selected after init */
+#ifndef LCD_FONT_DEFAULT
+#define LCD_FONT_DEFAULT           TM_Font_11x18
+#endif
+
+/* Maximal size of one glyph in bytes, one byte per pixel */
+#ifndef LCD_GLYPH_CACHE_SIZE
+#define LCD_GLYPH_CACHE_SIZE       (16 * 26)
+#endif
+
 /**
  * @defgroup TM_LCD_Color
  * @brief    LCD Colors
  * @{
  */
 
+#if LCD_USE_L8
+/* Indexes to default RGB332 color lookup table */
+#define LCD_COLOR_WHITE            0xFF
+#define LCD_COLOR_BLACK            0x00
+#define LCD_COLOR_RED              0xE0
+#define LCD_COLOR_GREEN            0x1C
+#define LCD_COLOR_GREEN2           0xB8
+#define LCD_COLOR_BLUE             0x03
+#define LCD_COLOR_BLUE2            0x13
+#define LCD_COLOR_YELLOW           0xFC
+#define LCD_COLOR_ORANGE           0xEC
+#define LCD_COLOR_CYAN             0x1F
+#define LCD_COLOR_MAGENTA          0xAA
+#define LCD_COLOR_GRAY             0x6D
+#define LCD_COLOR_BROWN            0xAD
+#else
 #define LCD_COLOR_WHITE            0xFFFF
 #define LCD_COLOR_BLACK            0x0000
 #define LCD_COLOR_RED              0xF800
@@ -214,6 +338,7 @@ extern "C" {
 #define LCD_COLOR_MAGENTA          0xA254
 #define LCD_COLOR_GRAY             0x7BEF
 #define LCD_COLOR_BROWN            0xBBCA
+#endif
 
 /**
  * @}
@@ -542,6 +667,51 @@ TM_LCD_Result_t TM_LCD_Layer2To1(void);
  */
 TM_LCD_Result_t TM_LCD_Layer1To2(void);
 
+/**
+ * @brief  Starts new frame, back buffer is selected for drawing
+ * @note   Function waits until frame from previous @ref TM_LCD_Present call is displayed,
+ *            so back buffer is not read by LTDC anymore
+ * @param  None
+ * @retval Member of @ref TM_LCD_Result_t enumeration
+ */
+TM_LCD_Result_t TM_LCD_BeginFrame(void);
+
+/**
+ * @brief  Shows back buffer on LCD at next vertical blanking
+ * @note   Function does not wait, use @ref TM_LCD_IsPresenting or @ref TM_LCD_PresentCallback to check when it is displayed
+ * @param  None
+ * @retval Member of @ref TM_LCD_Result_t enumeration
+ */
+TM_LCD_Result_t TM_LCD_Present(void);
+
+/**
+ * @brief  Checks if presented frame still waits for vertical blanking
+ * @param  None
+ * @retval Presenting status:
+ *            - 0: Frame is displayed, back buffer is free
+ *            - > 0: Frame is waiting for vertical blanking
+ */
+uint8_t TM_LCD_IsPresenting(void);
+
+/**
+ * @brief  Frame presented callback, called from LTDC interrupt when new frame buffer is loaded
+ * @note   From this moment, previous front buffer can be used for drawing
+ * @note   With __weak parameter to prevent link errors if not defined by user.
+ * @param  None
+ * @retval None
+ */
+void TM_LCD_PresentCallback(void);
+
+/**
+ * @brief  Sets colors in color lookup table of both layers, used in L8 mode
+ * @note   Change is visible immediately, call it in vertical blanking to avoid artifacts on screen
+ * @param  Start: First index in table to set, 0 to 255
+ * @param  *Colors: Pointer to colors in 0x00RRGGBB format
+ * @param  Count: Number of colors to set
+ * @retval Member of @ref TM_LCD_Result_t enumeration
+ */
+TM_LCD_Result_t TM_LCD_SetCLUT(uint8_t Start, const uint32_t* Colors, uint16_t Count);
+
 /**
  * @}
  */
@@ -0,0 +1,679 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_lcd_spi.h"
+
+/* ILI9341 commands */
+#define ILI9341_SOFT_RESET          0x01
+#define ILI9341_SLEEP_OUT           0x11
+#define ILI9341_DISPLAY_OFF         0x28
+#define ILI9341_DISPLAY_ON          0x29
+#define ILI9341_COLUMN_ADDR         0x2A
+#define ILI9341_PAGE_ADDR           0x2B
+#define ILI9341_GRAM                0x2C
+#define ILI9341_MAC                 0x36
+#define ILI9341_PIXEL_FORMAT        0x3A
+
+/* Memory access control values for each orientation, BGR panel */
+#define ILI9341_MAC_180             0x88
+#define ILI9341_MAC_NORMAL          0x48
+#define ILI9341_MAC_90              0x28
+#define ILI9341_MAC_270             0xE8
+
+/* Pin macros */
+#define LCD_SPI_CS_HIGH             TM_GPIO_SetPinHigh(LCD_SPI_CS_PORT, LCD_SPI_CS_PIN)
+#define LCD_SPI_CS_LOW              TM_GPIO_SetPinLow(LCD_SPI_CS_PORT, LCD_SPI_CS_PIN)
+#define LCD_SPI_DC_HIGH             TM_GPIO_SetPinHigh(LCD_SPI_DC_PORT, LCD_SPI_DC_PIN)
+#define LCD_SPI_DC_LOW              TM_GPIO_SetPinLow(LCD_SPI_DC_PORT, LCD_SPI_DC_PIN)
+
+/* Private structure */
+typedef struct {
+	uint16_t Width;
+	uint16_t Height;
+	uint8_t Orientation;
+	
+	/* Strings */
+	uint16_t CurrentX;
+	uint16_t CurrentY;
+	uint16_t StartX;
+	uint16_t ForegroundColor;
+	uint16_t BackgroundColor;
+	TM_FONT_t* CurrentFont;
+	
+	/* Current tile */
+	uint16_t* Tile;
+	int16_t TileX;
+	int16_t TileY;
+	int16_t TileWidth;
+	int16_t TileHeight;
+	uint8_t NextTile;
+	uint8_t Busy;
+} TM_LCD_SPI_INT_t;
+
+/* Private variables */
+static TM_LCD_SPI_INT_t LCD_SPI;
+static uint16_t LCD_SPI_Tiles[2][LCD_SPI_TILE_PIXELS];
+
+/* ILI9341 init sequence, command, number of parameters and parameters, terminated with 0 */
+static const uint8_t LCD_SPI_InitSequence[] = {
+	0xCF, 3, 0x00, 0xC1, 0x30,                   /* Power control B */
+	0xED, 4, 0x64, 0x03, 0x12, 0x81,             /* Power on sequence */
+	0xE8, 3, 0x85, 0x00, 0x78,                   /* Driver timing control A */
+	0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,       /* Power control A */
+	0xF7, 1, 0x20,                               /* Pump ratio control */
+	0xEA, 2, 0x00, 0x00,                         /* Driver timing control B */
+	0xC0, 1, 0x23,                               /* Power control 1 */
+	0xC1, 1, 0x10,                               /* Power control 2 */
+	0xC5, 2, 0x3E, 0x28,                         /* VCOM control 1 */
+	0xC7, 1, 0x86,                               /* VCOM control 2 */
+	ILI9341_PIXEL_FORMAT, 1, 0x55,               /* 16 bits per pixel */
+	0xB1, 2, 0x00, 0x18,                         /* Frame rate control */
+	0xB6, 3, 0x08, 0x82, 0x27,                   /* Display function control */
+	0xF2, 1, 0x00,                               /* 3 gamma disable */
+	0x26, 1, 0x01,                               /* Gamma curve */
+	0xE0, 15, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00,
+	0xE1, 15, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F,
+	0x00
+};
+
+/* Private functions */
+static void TM_LCD_SPI_INT_SendCommand(uint8_t cmd, const uint8_t* data, uint8_t count);
+static void TM_LCD_SPI_INT_Wait(void);
+static void TM_LCD_SPI_INT_SetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+static void TM_LCD_SPI_INT_FillSpan(uint16_t* dst, uint16_t color, uint32_t count);
+static TM_LCD_SPI_Result_t TM_LCD_SPI_INT_CheckLine(char c);
+static void TM_LCD_SPI_INT_DrawChar(char c);
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_Init(void) {
+	const uint8_t* seq;
+	
+	/* Init control pins, chip select high */
+	TM_GPIO_Init(LCD_SPI_CS_PORT, LCD_SPI_CS_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High);
+	TM_GPIO_Init(LCD_SPI_DC_PORT, LCD_SPI_DC_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High);
+	LCD_SPI_CS_HIGH;
+	
+	/* Init SPI and DMA */
+	TM_SPI_InitFull(LCD_SPI_SPI, LCD_SPI_PINSPACK, LCD_SPI_PRESCALER, TM_SPI_Mode_0, SPI_MODE_MASTER, SPI_FIRSTBIT_MSB);
+	TM_SPI_DMA_Init(LCD_SPI_SPI);
+	
+	/* Reset LCD */
+#if LCD_SPI_USE_RST
+	TM_GPIO_Init(LCD_SPI_RST_PORT, LCD_SPI_RST_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_Low);
+	TM_GPIO_SetPinLow(LCD_SPI_RST_PORT, LCD_SPI_RST_PIN);
+	HAL_Delay(10);
+	TM_GPIO_SetPinHigh(LCD_SPI_RST_PORT, LCD_SPI_RST_PIN);
+#else
+	TM_LCD_SPI_INT_SendCommand(ILI9341_SOFT_RESET, NULL, 0);
+#endif
+	HAL_Delay(120);
+	
+	/* Send init sequence */
+	for (seq = LCD_SPI_InitSequence; *seq; seq += 2 + seq[1]) {
+		TM_LCD_SPI_INT_SendCommand(seq[0], &seq[2], seq[1]);
+	}
+	
+	/* Wake up */
+	TM_LCD_SPI_INT_SendCommand(ILI9341_SLEEP_OUT, NULL, 0);
+	HAL_Delay(120);
+	
+	/* Set default settings */
+	LCD_SPI.CurrentFont = &LCD_SPI_FONT_DEFAULT;
+	LCD_SPI.ForegroundColor = LCD_COLOR_BLACK;
+	LCD_SPI.BackgroundColor = LCD_COLOR_WHITE;
+	LCD_SPI.Tile = NULL;
+	LCD_SPI.NextTile = 0;
+	LCD_SPI.Busy = 0;
+	
+	/* Normal orientation */
+	TM_LCD_SPI_SetOrientation(1);
+	
+	/* Turn display on */
+	return TM_LCD_SPI_DisplayOn();
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetOrientation(uint8_t orientation) {
+	uint8_t mac;
+	
+	/* Get memory access control value and size */
+	switch (orientation) {
+		case 0: mac = ILI9341_MAC_180; break;
+		case 1: mac = ILI9341_MAC_NORMAL; break;
+		case 2: mac = ILI9341_MAC_90; break;
+		case 3: mac = ILI9341_MAC_270; break;
+		default: return TM_LCD_SPI_Result_Error;
+	}
+	if (orientation < 2) {
+		LCD_SPI.Width = LCD_SPI_WIDTH;
+		LCD_SPI.Height = LCD_SPI_HEIGHT;
+	} else {
+		LCD_SPI.Width = LCD_SPI_HEIGHT;
+		LCD_SPI.Height = LCD_SPI_WIDTH;
+	}
+	LCD_SPI.Orientation = orientation;
+	
+	/* Reset string position */
+	LCD_SPI.CurrentX = LCD_SPI.CurrentY = LCD_SPI.StartX = 0;
+	
+	/* Send to LCD */
+	TM_LCD_SPI_INT_SendCommand(ILI9341_MAC, &mac, 1);
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+uint16_t TM_LCD_SPI_GetWidth(void) {
+	return LCD_SPI.Width;
+}
+
+uint16_t TM_LCD_SPI_GetHeight(void) {
+	return LCD_SPI.Height;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DisplayOn(void) {
+	/* Send command */
+	TM_LCD_SPI_INT_SendCommand(ILI9341_DISPLAY_ON, NULL, 0);
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DisplayOff(void) {
+	/* Send command */
+	TM_LCD_SPI_INT_SendCommand(ILI9341_DISPLAY_OFF, NULL, 0);
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_Render(TM_LCD_SPI_Draw_t Draw, void* Param) {
+	/* Draw whole screen */
+	return TM_LCD_SPI_RenderArea(0, 0, LCD_SPI.Width, LCD_SPI.Height, Draw, Param);
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_RenderArea(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, TM_LCD_SPI_Draw_t Draw, void* Param) {
+	uint16_t lines, row, end;
+	
+	/* Check area */
+	if (Width == 0 || Height == 0 || (X + Width) > LCD_SPI.Width || (Y + Height) > LCD_SPI.Height) {
+		return TM_LCD_SPI_Result_Error;
+	}
+	
+	/* Number of lines in one tile */
+	lines = LCD_SPI_TILE_PIXELS / Width;
+	
+	/* Draw tiles from top to bottom */
+	for (row = Y, end = Y + Height; row < end; row += lines) {
+		/* Select free tile buffer, other one may still be transmitted */
+		LCD_SPI.Tile = LCD_SPI_Tiles[LCD_SPI.NextTile];
+		LCD_SPI.TileX = X;
+		LCD_SPI.TileY = row;
+		LCD_SPI.TileWidth = Width;
+		LCD_SPI.TileHeight = (end - row) < lines ? (end - row) : lines;
+		
+		/* Draw tile, while previous tile is being transmitted */
+		Draw(Param);
+		
+		/* Wait for previous tile and set LCD window */
+		TM_LCD_SPI_INT_Wait();
+		TM_LCD_SPI_INT_SetWindow(X, row, X + Width - 1, row + LCD_SPI.TileHeight - 1);
+		
+		/* Send pixels in 16-bit mode, chip select stays low until transfer is done */
+		TM_SPI_SetDataSize(LCD_SPI_SPI, TM_SPI_DataSize_16b);
+		LCD_SPI_DC_HIGH;
+		LCD_SPI_CS_LOW;
+		LCD_SPI.Busy = 1;
+		TM_SPI_DMA_Transmit(LCD_SPI_SPI, (uint8_t *)LCD_SPI.Tile, NULL, LCD_SPI.TileWidth * LCD_SPI.TileHeight);
+		
+		/* Swap buffers */
+		LCD_SPI.NextTile ^= 1;
+	}
+	
+	/* Drawing is possible only inside render */
+	LCD_SPI.Tile = NULL;
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+uint8_t TM_LCD_SPI_IsBusy(void) {
+	return LCD_SPI.Busy && TM_SPI_DMA_Transmitting(LCD_SPI_SPI);
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_Fill(uint32_t color) {
+	/* Fill whole tile */
+	if (LCD_SPI.Tile) {
+		TM_LCD_SPI_INT_FillSpan(LCD_SPI.Tile, color, LCD_SPI.TileWidth * LCD_SPI.TileHeight);
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawPixel(uint16_t X, uint16_t Y, uint32_t color) {
+	int32_t x = (int32_t)X - LCD_SPI.TileX, y = (int32_t)Y - LCD_SPI.TileY;
+	
+	/* Draw only when inside tile */
+	if (LCD_SPI.Tile && x >= 0 && x < LCD_SPI.TileWidth && y >= 0 && y < LCD_SPI.TileHeight) {
+		LCD_SPI.Tile[y * LCD_SPI.TileWidth + x] = color;
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint32_t color) {
+	int32_t dx, dy, sx, sy, err, e2;
+	
+	/* Horizontal and vertical lines are rectangles */
+	if (x0 == x1 || y0 == y1) {
+		return TM_LCD_SPI_DrawFilledRectangle(
+			x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1,
+			(x0 < x1 ? x1 - x0 : x0 - x1) + 1, (y0 < y1 ? y1 - y0 : y0 - y1) + 1,
+			color
+		);
+	}
+	
+	/* Skip lines completely above or below tile */
+	if (
+		LCD_SPI.Tile == NULL ||
+		(y0 < LCD_SPI.TileY && y1 < LCD_SPI.TileY) ||
+		(y0 >= LCD_SPI.TileY + LCD_SPI.TileHeight && y1 >= LCD_SPI.TileY + LCD_SPI.TileHeight)
+	) {
+		return TM_LCD_SPI_Result_Ok;
+	}
+	
+	/* Bresenham algorithm */
+	dx = x1 > x0 ? x1 - x0 : x0 - x1;
+	dy = y1 > y0 ? y1 - y0 : y0 - y1;
+	sx = x0 < x1 ? 1 : -1;
+	sy = y0 < y1 ? 1 : -1;
+	err = (dx > dy ? dx : -dy) / 2;
+	
+	while (1) {
+		TM_LCD_SPI_DrawPixel(x0, y0, color);
+		if (x0 == x1 && y0 == y1) {
+			break;
+		}
+		e2 = err;
+		if (e2 > -dx) {
+			err -= dy;
+			x0 += sx;
+		}
+		if (e2 < dy) {
+			err += dx;
+			y0 += sy;
+		}
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawRectangle(uint16_t x0, uint16_t y0, uint16_t Width, uint16_t Height, uint32_t color) {
+	/* Check size */
+	if (Width == 0 || Height == 0) {
+		return TM_LCD_SPI_Result_Ok;
+	}
+	
+	/* Draw 4 lines */
+	TM_LCD_SPI_DrawFilledRectangle(x0, y0, Width, 1, color);
+	TM_LCD_SPI_DrawFilledRectangle(x0, y0 + Height - 1, Width, 1, color);
+	TM_LCD_SPI_DrawFilledRectangle(x0, y0, 1, Height, color);
+	TM_LCD_SPI_DrawFilledRectangle(x0 + Width - 1, y0, 1, Height, color);
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawFilledRectangle(uint16_t x0, uint16_t y0, uint16_t Width, uint16_t Height, uint32_t color) {
+	int32_t left, right, top, bottom;
+	uint16_t* dst;
+	
+	/* Check tile */
+	if (LCD_SPI.Tile == NULL) {
+		return TM_LCD_SPI_Result_Ok;
+	}
+	
+	/* Clip to tile */
+	left = (int32_t)x0 - LCD_SPI.TileX;
+	top = (int32_t)y0 - LCD_SPI.TileY;
+	right = left + Width;
+	bottom = top + Height;
+	if (left < 0) {
+		left = 0;
+	}
+	if (top < 0) {
+		top = 0;
+	}
+	if (right > LCD_SPI.TileWidth) {
+		right = LCD_SPI.TileWidth;
+	}
+	if (bottom > LCD_SPI.TileHeight) {
+		bottom = LCD_SPI.TileHeight;
+	}
+	if (left >= right || top >= bottom) {
+		return TM_LCD_SPI_Result_Ok;
+	}
+	
+	/* Full tile width rows are one span */
+	dst = &LCD_SPI.Tile[top * LCD_SPI.TileWidth + left];
+	if (left == 0 && right == LCD_SPI.TileWidth) {
+		TM_LCD_SPI_INT_FillSpan(dst, color, (bottom - top) * LCD_SPI.TileWidth);
+	} else {
+		for (; top < bottom; top++) {
+			TM_LCD_SPI_INT_FillSpan(dst, color, right - left);
+			dst += LCD_SPI.TileWidth;
+		}
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawCircle(int16_t x0, int16_t y0, int16_t r, uint32_t color) {
+	int16_t f = 1 - r;
+	int16_t ddF_x = 1;
+	int16_t ddF_y = -2 * r;
+	int16_t x = 0;
+	int16_t y = r;
+	
+	/* Skip when circle is not in tile */
+	if (LCD_SPI.Tile == NULL || (y0 + r) < LCD_SPI.TileY || (y0 - r) >= (LCD_SPI.TileY + LCD_SPI.TileHeight)) {
+		return TM_LCD_SPI_Result_Ok;
+	}
+
+	TM_LCD_SPI_DrawPixel(x0, y0 + r, color);
+	TM_LCD_SPI_DrawPixel(x0, y0 - r, color);
+	TM_LCD_SPI_DrawPixel(x0 + r, y0, color);
+	TM_LCD_SPI_DrawPixel(x0 - r, y0, color);
+
+	while (x < y) {
+		if (f >= 0) {
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f += ddF_x;
+
+		TM_LCD_SPI_DrawPixel(x0 + x, y0 + y, color);
+		TM_LCD_SPI_DrawPixel(x0 - x, y0 + y, color);
+		TM_LCD_SPI_DrawPixel(x0 + x, y0 - y, color);
+		TM_LCD_SPI_DrawPixel(x0 - x, y0 - y, color);
+
+		TM_LCD_SPI_DrawPixel(x0 + y, y0 + x, color);
+		TM_LCD_SPI_DrawPixel(x0 - y, y0 + x, color);
+		TM_LCD_SPI_DrawPixel(x0 + y, y0 - x, color);
+		TM_LCD_SPI_DrawPixel(x0 - y, y0 - x, color);
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawFilledCircle(int16_t x0, int16_t y0, int16_t r, uint32_t color) {
+	int16_t f = 1 - r;
+	int16_t ddF_x = 1;
+	int16_t ddF_y = -2 * r;
+	int16_t x = 0;
+	int16_t y = r;
+	
+	/* Skip when circle is not in tile */
+	if (LCD_SPI.Tile == NULL || (y0 + r) < LCD_SPI.TileY || (y0 - r) >= (LCD_SPI.TileY + LCD_SPI.TileHeight)) {
+		return TM_LCD_SPI_Result_Ok;
+	}
+	
+	/* Middle line */
+	TM_LCD_SPI_DrawFilledRectangle(x0 - r, y0, 2 * r + 1, 1, color);
+
+	/* Draw horizontal spans */
+	while (x < y) {
+		if (f >= 0) {
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f += ddF_x;
+
+		TM_LCD_SPI_DrawFilledRectangle(x0 - x, y0 + y, 2 * x + 1, 1, color);
+		TM_LCD_SPI_DrawFilledRectangle(x0 - x, y0 - y, 2 * x + 1, 1, color);
+		TM_LCD_SPI_DrawFilledRectangle(x0 - y, y0 + x, 2 * y + 1, 1, color);
+		TM_LCD_SPI_DrawFilledRectangle(x0 - y, y0 - x, 2 * y + 1, 1, color);
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetXY(uint16_t X, uint16_t Y) {
+	/* Check if we are inside LCD */
+	if (X >= LCD_SPI.Width || Y >= LCD_SPI.Height) {
+		return TM_LCD_SPI_Result_Error;
+	}
+	
+	/* Set new values */
+	LCD_SPI.CurrentX = X;
+	LCD_SPI.CurrentY = Y;
+	LCD_SPI.StartX = X;
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetFont(TM_FONT_t* Font) {
+	/* Set font */
+	LCD_SPI.CurrentFont = Font;
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetColors(uint32_t Foreground, uint32_t Background) {
+	/* Set new colors */
+	LCD_SPI.ForegroundColor = Foreground;
+	LCD_SPI.BackgroundColor = Background;
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_Putc(char c) {
+	/* Go to new line if needed */
+	if (TM_LCD_SPI_INT_CheckLine(c) != TM_LCD_SPI_Result_Ok) {
+		return TM_LCD_SPI_Result_Error;
+	}
+	
+	/* Draw character */
+	if (c != '\n') {
+		TM_LCD_SPI_INT_DrawChar(c);
+		
+		/* Set new current X location */
+		LCD_SPI.CurrentX += LCD_SPI.CurrentFont->FontWidth;
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+TM_LCD_SPI_Result_t TM_LCD_SPI_Puts(char* str) {
+	/* Send till string ends or error returned */
+	while (*str) {
+		if (TM_LCD_SPI_Putc(*str++) != TM_LCD_SPI_Result_Ok) {
+			return TM_LCD_SPI_Result_Error;
+		}
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+/* Private functions */
+static void TM_LCD_SPI_INT_SendCommand(uint8_t cmd, const uint8_t* data, uint8_t count) {
+	/* Wait for tile transfer, SPI goes back to 8-bit mode */
+	TM_LCD_SPI_INT_Wait();
+	
+	/* Send command */
+	LCD_SPI_CS_LOW;
+	LCD_SPI_DC_LOW;
+	TM_SPI_Send(LCD_SPI_SPI, cmd);
+	
+	/* Send parameters */
+	LCD_SPI_DC_HIGH;
+	while (count--) {
+		TM_SPI_Send(LCD_SPI_SPI, *data++);
+	}
+	LCD_SPI_CS_HIGH;
+}
+
+static void TM_LCD_SPI_INT_Wait(void) {
+	/* Nothing to wait */
+	if (!LCD_SPI.Busy) {
+		return;
+	}
+	
+	/* Wait for DMA and SPI */
+	while (TM_SPI_DMA_Transmitting(LCD_SPI_SPI));
+	LCD_SPI_CS_HIGH;
+	LCD_SPI.Busy = 0;
+	
+	/* Received data are not used, clear RX and overrun flags */
+	(void)LCD_SPI_SPI->DR;
+	(void)LCD_SPI_SPI->SR;
+	
+	/* Back to 8-bit mode for commands */
+	TM_SPI_SetDataSize(LCD_SPI_SPI, TM_SPI_DataSize_8b);
+}
+
+static void TM_LCD_SPI_INT_SetWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+	uint8_t data[4];
+	
+	/* Set columns */
+	data[0] = x0 >> 8;
+	data[1] = x0 & 0xFF;
+	data[2] = x1 >> 8;
+	data[3] = x1 & 0xFF;
+	TM_LCD_SPI_INT_SendCommand(ILI9341_COLUMN_ADDR, data, 4);
+	
+	/* Set pages */
+	data[0] = y0 >> 8;
+	data[1] = y0 & 0xFF;
+	data[2] = y1 >> 8;
+	data[3] = y1 & 0xFF;
+	TM_LCD_SPI_INT_SendCommand(ILI9341_PAGE_ADDR, data, 4);
+	
+	/* Start memory write */
+	TM_LCD_SPI_INT_SendCommand(ILI9341_GRAM, NULL, 0);
+}
+
+static void TM_LCD_SPI_INT_FillSpan(uint16_t* dst, uint16_t color, uint32_t count) {
+	uint32_t c = color | ((uint32_t)color << 16);
+	uint32_t* ptr;
+	uint32_t n;
+	
+	/* Align to word */
+	if (((uint32_t)dst & 0x02) && count) {
+		*dst++ = color;
+		count--;
+	}
+	ptr = (uint32_t *)dst;
+	
+	/* 8 pixels in each iteration */
+	for (n = count >> 3; n > 0; n--) {
+		ptr[0] = c;
+		ptr[1] = c;
+		ptr[2] = c;
+		ptr[3] = c;
+		ptr += 4;
+	}
+	
+	/* Remaining pixel pairs */
+	for (n = (count & 0x07) >> 1; n > 0; n--) {
+		*ptr++ = c;
+	}
+	
+	/* Last pixel */
+	if (count & 0x01) {
+		*(uint16_t *)ptr = color;
+	}
+}
+
+static TM_LCD_SPI_Result_t TM_LCD_SPI_INT_CheckLine(char c) {
+	/* Check current coordinates */
+	if ((LCD_SPI.CurrentX + LCD_SPI.CurrentFont->FontWidth) >= LCD_SPI.Width || c == '\n') {
+		/* Go to new line */
+		LCD_SPI.CurrentY += LCD_SPI.CurrentFont->FontHeight;
+		LCD_SPI.CurrentX = LCD_SPI.StartX;
+		
+		/* Check X */
+		if ((LCD_SPI.CurrentX + LCD_SPI.CurrentFont->FontWidth) >= LCD_SPI.Width) {
+			LCD_SPI.CurrentX = 0;
+		}
+		
+		/* Check for Y position */
+		if (LCD_SPI.CurrentY >= LCD_SPI.Height) {
+			return TM_LCD_SPI_Result_Error;
+		}
+	}
+	
+	/* Return OK */
+	return TM_LCD_SPI_Result_Ok;
+}
+
+static void TM_LCD_SPI_INT_DrawChar(char c) {
+	TM_FONT_GLYPH_t Glyph;
+	int32_t x, y, row, end, col, width;
+	uint16_t* dst;
+	uint16_t fg = LCD_SPI.ForegroundColor, bg = LCD_SPI.BackgroundColor;
+	uint32_t b;
+	
+	/* Get rows of cell inside tile */
+	x = (int32_t)LCD_SPI.CurrentX - LCD_SPI.TileX;
+	y = (int32_t)LCD_SPI.CurrentY - LCD_SPI.TileY;
+	row = y < 0 ? -y : 0;
+	end = (y + LCD_SPI.CurrentFont->FontHeight) > LCD_SPI.TileHeight ? LCD_SPI.TileHeight - y : LCD_SPI.CurrentFont->FontHeight;
+	width = LCD_SPI.CurrentFont->FontWidth;
+	
+	/* Skip when character is not in tile */
+	if (LCD_SPI.Tile == NULL || row >= end || x >= LCD_SPI.TileWidth || (x + width) <= 0) {
+		return;
+	}
+	
+	/* Get font glyph */
+	TM_FONT_GetGlyph(LCD_SPI.CurrentFont, c, &Glyph);
+	
+	/* Draw rows in tile */
+	for (; row < end; row++) {
+		b = TM_FONT_GetRow(&Glyph, row);
+		dst = &LCD_SPI.Tile[(y + row) * LCD_SPI.TileWidth + x];
+		for (col = 0; col < width; col++) {
+			if ((x + col) >= 0 && (x + col) < LCD_SPI.TileWidth) {
+				dst[col] = ((b << col) & 0x8000) ? fg : bg;
+			}
+		}
+	}
+}
@@ -0,0 +1,474 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   ILI9341 SPI LCD with tile rendering and DMA for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_LCD_SPI_H
+#define TM_LCD_SPI_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_LCD_SPI
+ * @brief    ILI9341 SPI LCD with tile rendering and DMA for STM32Fxxx
+ * @{
+ *
+ * Library is graphics backend for ILI9341 class displays connected over SPI, for devices without LTDC and DMA2D, like STM32F401 and STM32F411.
+ * It has the same drawing functions as @ref TM_LCD library, but draws to small tile buffer in RAM instead of frame buffer in SDRAM.
+ *
+ * \par Tile rendering
+ *
+ * There is no memory for whole frame, so screen is drawn in horizontal bands (tiles).
+ * User draw function is called once for each tile and all drawing functions are clipped to current tile.
+ * When tile is drawn, it is sent to LCD with @ref TM_SPI_DMA_Transmit in 16-bit mode.
+ *
+ * Library has 2 tile buffers, next tile is drawn while previous one is transmitted by DMA, so drawing and transfer overlap.
+ * Fills are written 2 pixels at a time with unrolled 32-bit stores.
+ *
+\code
+//Draw function, called for each tile, must draw the same content every time
+void Draw(void* Param) {
+	TM_LCD_SPI_Fill(LCD_COLOR_WHITE);
+	TM_LCD_SPI_DrawFilledCircle(120, 160, 50, LCD_COLOR_RED);
+	
+	TM_LCD_SPI_SetXY(10, 10);
+	TM_LCD_SPI_Puts("Hello");
+}
+
+//Init LCD
+TM_LCD_SPI_Init();
+
+//Draw whole screen
+TM_LCD_SPI_Render(Draw, NULL);
+
+//Redraw only part of screen
+TM_LCD_SPI_RenderArea(0, 0, 120, 30, Draw, NULL);
+\endcode
+ *
+ * \note  Draw function can be called more times for one render, so it should not change state except LCD position and colors
+ * \note  Drawing functions have effect only inside draw function
+ * \note  Tile buffers are used by DMA, do not place them to CCM RAM
+ *
+ * \par Default pinout
+ *
+\verbatim
+LCD     STM32Fxxx       Description
+
+SCK     PA5             SPI1 clock
+SDI     PA7             SPI1 MOSI
+CS      PA4             Chip select
+D/C     PA3             Data/command select
+RESET   PA2             Reset pin, optional
+\endverbatim
+ *
+ * Settings can be changed in defines.h file:
+ *
+\code
+//SPI and pins pack, SPI DMA must be available for SPI
+#define LCD_SPI_SPI               SPI1
+#define LCD_SPI_PINSPACK          TM_SPI_PinsPack_1
+#define LCD_SPI_PRESCALER         SPI_BAUDRATEPRESCALER_2
+
+//Control pins
+#define LCD_SPI_CS_PORT           GPIOA
+#define LCD_SPI_CS_PIN            GPIO_PIN_4
+#define LCD_SPI_DC_PORT           GPIOA
+#define LCD_SPI_DC_PIN            GPIO_PIN_3
+#define LCD_SPI_RST_PORT          GPIOA
+#define LCD_SPI_RST_PIN           GPIO_PIN_2
+
+//Do not use reset pin, software reset is used
+#define LCD_SPI_USE_RST           0
+
+//Number of pixels in one tile buffer, 2 buffers are used
+#define LCD_SPI_TILE_PIXELS       (320 * 16)
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM GPIO
+ - TM SPI
+ - TM SPI DMA
+ - TM FONTS
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_spi.h"
+#include "tm_stm32_spi_dma.h"
+#include "tm_stm32_fonts.h"
+
+/**
+ * @defgroup TM_LCD_SPI_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* SPI settings */
+#ifndef LCD_SPI_SPI
+#define LCD_SPI_SPI               SPI1
+#define LCD_SPI_PINSPACK          TM_SPI_PinsPack_1
+#endif
+
+/* SPI prescaler, ILI9341 write cycle is min 100 ns */
+#ifndef LCD_SPI_PRESCALER
+#define LCD_SPI_PRESCALER         SPI_BAUDRATEPRESCALER_2
+#endif
+
+/* Chip select pin */
+#ifndef LCD_SPI_CS_PORT
+#define LCD_SPI_CS_PORT           GPIOA
+#define LCD_SPI_CS_PIN            GPIO_PIN_4
+#endif
+
+/* Data/command pin */
+#ifndef LCD_SPI_DC_PORT
+#define LCD_SPI_DC_PORT           GPIOA
+#define LCD_SPI_DC_PIN            GPIO_PIN_3
+#endif
+
+/* Reset pin */
+#ifndef LCD_SPI_RST_PORT
+#define LCD_SPI_RST_PORT          GPIOA
+#define LCD_SPI_RST_PIN           GPIO_PIN_2
+#endif
+
+/* Use reset pin, set to 0 when not connected and software reset is used */
+#ifndef LCD_SPI_USE_RST
+#define LCD_SPI_USE_RST           1
+#endif
+
+/* LCD size in normal orientation */
+#ifndef LCD_SPI_WIDTH
+#define LCD_SPI_WIDTH             240
+#define LCD_SPI_HEIGHT            320
+#endif
+
+/* Number of pixels in one tile buffer */
+#ifndef LCD_SPI_TILE_PIXELS
+#define LCD_SPI_TILE_PIXELS       (320 * 16)
+#endif
+
+/* Font selected after init */
+#ifndef LCD_SPI_FONT_DEFAULT
+#define LCD_SPI_FONT_DEFAULT      TM_Font_11x18
+#endif
+
+/* Check tile size, one line must fit and DMA count is 16-bit */
+#if LCD_SPI_TILE_PIXELS < LCD_SPI_WIDTH || LCD_SPI_TILE_PIXELS < LCD_SPI_HEIGHT || LCD_SPI_TILE_PIXELS > 65535
+#error "LCD_SPI_TILE_PIXELS must be at least one line of LCD and less than 65536!"
+#endif
+
+/**
+ * @defgroup TM_LCD_SPI_Color
+ * @brief    LCD colors in RGB565 format, the same as in @ref TM_LCD
+ * @{
+ */
+
+#ifndef LCD_COLOR_WHITE
+#define LCD_COLOR_WHITE            0xFFFF
+#define LCD_COLOR_BLACK            0x0000
+#define LCD_COLOR_RED              0xF800
+#define LCD_COLOR_GREEN            0x07E0
+#define LCD_COLOR_GREEN2           0xB723
+#define LCD_COLOR_BLUE             0x001F
+#define LCD_COLOR_BLUE2            0x051D
+#define LCD_COLOR_YELLOW           0xFFE0
+#define LCD_COLOR_ORANGE           0xFBE4
+#define LCD_COLOR_CYAN             0x07FF
+#define LCD_COLOR_MAGENTA          0xA254
+#define LCD_COLOR_GRAY             0x7BEF
+#define LCD_COLOR_BROWN            0xBBCA
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_LCD_SPI_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  LCD result enumeration
+ */
+typedef enum {
+	TM_LCD_SPI_Result_Ok = 0x00,  /*!< Everything OK */
+	TM_LCD_SPI_Result_Error       /*!< An error occurred */
+} TM_LCD_SPI_Result_t;
+
+/**
+ * @brief  Draw function called for each tile
+ * @param  *Param: User parameter from render function
+ * @retval None
+ */
+typedef void (*TM_LCD_SPI_Draw_t)(void* Param);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_LCD_SPI_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes SPI, SPI DMA, control pins and LCD
+ * @param  None
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_Init(void);
+
+/**
+ * @brief  Sets LCD orientation
+ * @param  orientation: LCD orientation, the same values as in @ref TM_LCD:
+ *            - 0: 180 degrees
+ *            - 1: Normal mode
+ *            - 2: 90 degrees
+ *            - 3: 270 degrees
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetOrientation(uint8_t orientation);
+
+/**
+ * @brief  Gets LCD width in current orientation
+ * @param  None
+ * @retval LCD width in units of pixels
+ */
+uint16_t TM_LCD_SPI_GetWidth(void);
+
+/**
+ * @brief  Gets LCD height in current orientation
+ * @param  None
+ * @retval LCD height in units of pixels
+ */
+uint16_t TM_LCD_SPI_GetHeight(void);
+
+/**
+ * @brief  Turns display on
+ * @param  None
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DisplayOn(void);
+
+/**
+ * @brief  Turns display off
+ * @param  None
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DisplayOff(void);
+
+/**
+ * @brief  Draws whole screen
+ * @param  Draw: Draw function, called once for each tile
+ * @param  *Param: User parameter for draw function
+ * @note   Function returns when last tile transfer is started, it does not wait for it
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_Render(TM_LCD_SPI_Draw_t Draw, void* Param);
+
+/**
+ * @brief  Draws part of screen
+ * @note   Coordinates in draw function are absolute, pixels outside area are ignored
+ * @param  X: Area left coordinate
+ * @param  Y: Area top coordinate
+ * @param  Width: Area width
+ * @param  Height: Area height
+ * @param  Draw: Draw function, called once for each tile
+ * @param  *Param: User parameter for draw function
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_RenderArea(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, TM_LCD_SPI_Draw_t Draw, void* Param);
+
+/**
+ * @brief  Checks if tile transfer is in progress
+ * @param  None
+ * @retval Transfer status:
+ *            - 0: LCD is idle
+ *            - > 0: Tile is being transmitted
+ */
+uint8_t TM_LCD_SPI_IsBusy(void);
+
+/**
+ * @brief  Fills current tile with color
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_Fill(uint32_t color);
+
+/**
+ * @brief  Draws pixel
+ * @param  X: X coordinate
+ * @param  Y: Y coordinate
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawPixel(uint16_t X, uint16_t Y, uint32_t color);
+
+/**
+ * @brief  Draws line
+ * @param  x0: Start X coordinate
+ * @param  y0: Start Y coordinate
+ * @param  x1: End X coordinate
+ * @param  y1: End Y coordinate
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint32_t color);
+
+/**
+ * @brief  Draws rectangle
+ * @param  x0: Top left X coordinate
+ * @param  y0: Top left Y coordinate
+ * @param  Width: Rectangle width
+ * @param  Height: Rectangle height
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawRectangle(uint16_t x0, uint16_t y0, uint16_t Width, uint16_t Height, uint32_t color);
+
+/**
+ * @brief  Draws filled rectangle
+ * @param  x0: Top left X coordinate
+ * @param  y0: Top left Y coordinate
+ * @param  Width: Rectangle width
+ * @param  Height: Rectangle height
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawFilledRectangle(uint16_t x0, uint16_t y0, uint16_t Width, uint16_t Height, uint32_t color);
+
+/**
+ * @brief  Draws circle
+ * @param  x0: Center X coordinate
+ * @param  y0: Center Y coordinate
+ * @param  r: Circle radius
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawCircle(int16_t x0, int16_t y0, int16_t r, uint32_t color);
+
+/**
+ * @brief  Draws filled circle
+ * @param  x0: Center X coordinate
+ * @param  y0: Center Y coordinate
+ * @param  r: Circle radius
+ * @param  color: Color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_DrawFilledCircle(int16_t x0, int16_t y0, int16_t r, uint32_t color);
+
+/**
+ * @brief  Sets position for string drawing
+ * @param  X: X coordinate
+ * @param  Y: Y coordinate
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetXY(uint16_t X, uint16_t Y);
+
+/**
+ * @brief  Sets font for string drawing
+ * @param  *Font: Pointer to @ref TM_FONT_t font
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetFont(TM_FONT_t* Font);
+
+/**
+ * @brief  Sets colors for string drawing
+ * @param  Foreground: Text color in RGB565 format
+ * @param  Background: Background color in RGB565 format
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_SetColors(uint32_t Foreground, uint32_t Background);
+
+/**
+ * @brief  Draws character at current position
+ * @param  c: Character to draw
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_Putc(char c);
+
+/**
+ * @brief  Draws string at current position
+ * @param  *str: Pointer to string
+ * @retval Member of @ref TM_LCD_SPI_Result_t enumeration
+ */
+TM_LCD_SPI_Result_t TM_LCD_SPI_Puts(char* str);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,337 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_logfs.h"
+
+/* Header identification */
+#define LOGFS_MAGIC              0x464C4F47
+#define LOGFS_DATA_OFFSET        (2 * LOGFS_SECTOR_SIZE)
+
+/* Number of batches which are not part of valid records. Batches written after last header update may overwrite oldest records */
+#define LOGFS_RESERVED_BATCHES   (LOGFS_HEADER_INTERVAL + 1)
+
+/* Header structure, first sector of each header copy */
+typedef struct {
+	uint32_t Magic;      /* LOGFS_MAGIC */
+	uint32_t RecordSize; /* Record size in bytes */
+	uint32_t Capacity;   /* Number of records in file */
+	uint32_t Head;       /* Index of next record */
+	uint32_t Count;      /* Number of valid records */
+	uint32_t Sequence;   /* Header sequence number */
+	uint32_t Crc;        /* CRC of members above */
+} TM_LOGFS_INT_Header_t;
+
+/* Private functions */
+static FRESULT TM_LOGFS_INT_WriteHeader(TM_LOGFS_t* Log);
+static FRESULT TM_LOGFS_INT_ReadHeader(TM_LOGFS_t* Log, uint8_t slot, TM_LOGFS_INT_Header_t* Header);
+static FRESULT TM_LOGFS_INT_WriteBatch(TM_LOGFS_t* Log);
+
+FRESULT TM_LOGFS_Open(TM_LOGFS_t* Log, const char* path, uint32_t RecordSize, uint32_t Capacity) {
+	TM_LOGFS_INT_Header_t hdr[2];
+	FRESULT res;
+	uint32_t rpb, size;
+	UINT br;
+	uint8_t slot;
+	
+	/* Check record size */
+	if (RecordSize == 0 || (LOGFS_SECTOR_SIZE % RecordSize) != 0) {
+		return FR_INVALID_PARAMETER;
+	}
+	
+	/* Round capacity to batches, at least one batch more than reserved */
+	rpb = LOGFS_BATCH_SIZE / RecordSize;
+	Capacity = ((Capacity + rpb - 1) / rpb) * rpb;
+	if (Capacity < (LOGFS_RESERVED_BATCHES + 1) * rpb) {
+		Capacity = (LOGFS_RESERVED_BATCHES + 1) * rpb;
+	}
+	size = LOGFS_DATA_OFFSET + Capacity * RecordSize;
+	
+	/* Init CRC unit for header checks */
+	TM_CRC_Init();
+	
+	/* Fill structure */
+	memset(Log, 0, sizeof(TM_LOGFS_t));
+	Log->RecordSize = RecordSize;
+	Log->Capacity = Capacity;
+	
+	/* Try to open existing file */
+	res = f_open(&Log->File, path, FA_OPEN_EXISTING | FA_READ | FA_WRITE);
+	if (res == FR_OK) {
+		/* Read both headers */
+		TM_LOGFS_INT_ReadHeader(Log, 0, &hdr[0]);
+		TM_LOGFS_INT_ReadHeader(Log, 1, &hdr[1]);
+		
+		/* Select valid header with higher sequence number */
+		if (hdr[0].Magic == LOGFS_MAGIC && hdr[1].Magic == LOGFS_MAGIC) {
+			slot = (hdr[1].Sequence - hdr[0].Sequence) < 0x80000000UL ? 1 : 0;
+		} else if (hdr[0].Magic == LOGFS_MAGIC) {
+			slot = 0;
+		} else if (hdr[1].Magic == LOGFS_MAGIC) {
+			slot = 1;
+		} else {
+			f_close(&Log->File);
+			return FR_NO_FILESYSTEM;
+		}
+		
+		/* Check format */
+		if (
+			hdr[slot].RecordSize != RecordSize ||
+			hdr[slot].Capacity != Capacity ||
+			hdr[slot].Head >= Capacity ||
+			hdr[slot].Count > (Capacity - LOGFS_RESERVED_BATCHES * rpb) ||
+			f_size(&Log->File) < size
+		) {
+			f_close(&Log->File);
+			return FR_INVALID_PARAMETER;
+		}
+		
+		/* Restore state */
+		Log->Head = hdr[slot].Head;
+		Log->Count = hdr[slot].Count;
+		Log->Sequence = hdr[slot].Sequence + 1;
+	} else if (res == FR_NO_FILE) {
+		/* Create new file */
+		if ((res = f_open(&Log->File, path, FA_CREATE_NEW | FA_READ | FA_WRITE)) != FR_OK) {
+			return res;
+		}
+		
+		/* Allocate contiguous space, or normal cluster chain if there is no contiguous space */
+		if (TM_FATFS_Preallocate(&Log->File, size) != FR_OK) {
+			if ((res = f_lseek(&Log->File, size)) != FR_OK || f_tell(&Log->File) != size) {
+				f_close(&Log->File);
+				f_unlink(path);
+				return res != FR_OK ? res : FR_DENIED;
+			}
+		}
+		
+		/* Write both headers, file may contain old data */
+		if (
+			(res = TM_LOGFS_INT_WriteHeader(Log)) != FR_OK ||
+			(res = TM_LOGFS_INT_WriteHeader(Log)) != FR_OK
+		) {
+			f_close(&Log->File);
+			return res;
+		}
+	} else {
+		return res;
+	}
+	
+#if _USE_FASTSEEK
+	/* Seek without FAT access, table is small for contiguous file */
+	TM_FATFS_FastSeekEnable(&Log->File, &Log->FastSeek);
+#endif
+	
+	/* Load records of partially written batch */
+	Log->BatchStart = Log->Head - (Log->Head % rpb);
+	Log->Pending = Log->Head - Log->BatchStart;
+	if (Log->Pending) {
+		if (
+			(res = f_lseek(&Log->File, LOGFS_DATA_OFFSET + Log->BatchStart * RecordSize)) != FR_OK ||
+			(res = f_read(&Log->File, Log->Buffer, Log->Pending * RecordSize, &br)) != FR_OK
+		) {
+			TM_LOGFS_Close(Log);
+			return res;
+		}
+	}
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+FRESULT TM_LOGFS_Write(TM_LOGFS_t* Log, const void* Record) {
+	uint32_t rpb = LOGFS_BATCH_SIZE / Log->RecordSize;
+	FRESULT res = FR_OK;
+	
+	/* Add record to batch */
+	memcpy(&((uint8_t *)Log->Buffer)[Log->Pending * Log->RecordSize], Record, Log->RecordSize);
+	Log->Pending++;
+	
+	/* Update state, reserved batches are not counted */
+	Log->Head = Log->BatchStart + Log->Pending;
+	if (Log->Head >= Log->Capacity) {
+		Log->Head = 0;
+	}
+	if (Log->Count < (Log->Capacity - LOGFS_RESERVED_BATCHES * rpb)) {
+		Log->Count++;
+	}
+	
+	/* Write full batch */
+	if (Log->Pending == rpb) {
+		res = TM_LOGFS_INT_WriteBatch(Log);
+		
+		/* Start new batch */
+		Log->BatchStart = Log->Head;
+		Log->Pending = 0;
+		
+		/* Update header from time to time */
+		if (res == FR_OK && ++Log->Batches >= LOGFS_HEADER_INTERVAL) {
+			res = TM_LOGFS_INT_WriteHeader(Log);
+		}
+	}
+	
+	/* Return result */
+	return res;
+}
+
+FRESULT TM_LOGFS_Read(TM_LOGFS_t* Log, uint32_t index, void* Record) {
+	uint32_t r;
+	FRESULT res;
+	UINT br;
+	
+	/* Check index */
+	if (index >= Log->Count) {
+		return FR_INVALID_PARAMETER;
+	}
+	
+	/* Get record position in ring */
+	r = (Log->Head + Log->Capacity - Log->Count + index) % Log->Capacity;
+	
+	/* Record is in RAM batch */
+	if (r >= Log->BatchStart && r < (Log->BatchStart + Log->Pending)) {
+		memcpy(Record, &((uint8_t *)Log->Buffer)[(r - Log->BatchStart) * Log->RecordSize], Log->RecordSize);
+		return FR_OK;
+	}
+	
+	/* Read from file */
+	if ((res = f_lseek(&Log->File, LOGFS_DATA_OFFSET + r * Log->RecordSize)) != FR_OK) {
+		return res;
+	}
+	return f_read(&Log->File, Record, Log->RecordSize, &br);
+}
+
+FRESULT TM_LOGFS_Sync(TM_LOGFS_t* Log) {
+	FRESULT res;
+	
+	/* Write partial batch, records stay in RAM until batch is full */
+	if (Log->Pending && (res = TM_LOGFS_INT_WriteBatch(Log)) != FR_OK) {
+		return res;
+	}
+	
+	/* Header points to written data only */
+	return TM_LOGFS_INT_WriteHeader(Log);
+}
+
+FRESULT TM_LOGFS_Close(TM_LOGFS_t* Log) {
+	FRESULT res;
+	
+	/* Write pending records */
+	res = TM_LOGFS_Sync(Log);
+	
+#if _USE_FASTSEEK
+	/* Release table */
+	TM_FATFS_FastSeekDisable(&Log->File, &Log->FastSeek);
+#endif
+	
+	/* Close file */
+	if (f_close(&Log->File) != FR_OK && res == FR_OK) {
+		res = FR_DISK_ERR;
+	}
+	
+	/* Return result */
+	return res;
+}
+
+/*******************************************************************/
+/*                    LOGFS PRIVATE FUNCTIONS                      */
+/*******************************************************************/
+static FRESULT TM_LOGFS_INT_WriteHeader(TM_LOGFS_t* Log) {
+	TM_LOGFS_INT_Header_t hdr;
+	FRESULT res;
+	UINT bw;
+	
+	/* Fill header */
+	hdr.Magic = LOGFS_MAGIC;
+	hdr.RecordSize = Log->RecordSize;
+	hdr.Capacity = Log->Capacity;
+	hdr.Head = Log->BatchStart + Log->Pending;
+	hdr.Count = Log->Count;
+	hdr.Sequence = Log->Sequence;
+	hdr.Crc = TM_CRC_Calculate32((uint32_t *)&hdr, 6, 1);
+	
+	/* Write to slot, selected by sequence number */
+	if ((res = f_lseek(&Log->File, (Log->Sequence & 1) * LOGFS_SECTOR_SIZE)) != FR_OK) {
+		return res;
+	}
+	if ((res = f_write(&Log->File, &hdr, sizeof(hdr), &bw)) != FR_OK) {
+		return res;
+	}
+	
+	/* Flush sector to card */
+	if ((res = f_sync(&Log->File)) != FR_OK) {
+		return res;
+	}
+	
+	/* Next header goes to other slot */
+	Log->Sequence++;
+	Log->Batches = 0;
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+static FRESULT TM_LOGFS_INT_ReadHeader(TM_LOGFS_t* Log, uint8_t slot, TM_LOGFS_INT_Header_t* Header) {
+	FRESULT res;
+	UINT br;
+	
+	/* Read header */
+	if (
+		(res = f_lseek(&Log->File, slot * LOGFS_SECTOR_SIZE)) != FR_OK ||
+		(res = f_read(&Log->File, Header, sizeof(*Header), &br)) != FR_OK ||
+		br != sizeof(*Header)
+	) {
+		Header->Magic = 0;
+		return res != FR_OK ? res : FR_INT_ERR;
+	}
+	
+	/* Check CRC */
+	if (Header->Magic != LOGFS_MAGIC || TM_CRC_Calculate32((uint32_t *)Header, 6, 1) != Header->Crc) {
+		Header->Magic = 0;
+		return FR_NO_FILESYSTEM;
+	}
+	
+	/* Return OK */
+	return FR_OK;
+}
+
+static FRESULT TM_LOGFS_INT_WriteBatch(TM_LOGFS_t* Log) {
+	uint32_t size;
+	FRESULT res;
+	UINT bw;
+	
+	/* Write whole sectors, FATFS then writes directly from buffer */
+	size = Log->Pending * Log->RecordSize;
+	size = ((size + LOGFS_SECTOR_SIZE - 1) / LOGFS_SECTOR_SIZE) * LOGFS_SECTOR_SIZE;
+	
+	/* Write data */
+	if ((res = f_lseek(&Log->File, LOGFS_DATA_OFFSET + Log->BatchStart * Log->RecordSize)) != FR_OK) {
+		return res;
+	}
+	if ((res = f_write(&Log->File, Log->Buffer, size, &bw)) != FR_OK) {
+		return res;
+	}
+	
+	/* Return result */
+	return bw == size ? FR_OK : FR_DISK_ERR;
+}
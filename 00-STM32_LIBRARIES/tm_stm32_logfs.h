@@ -0,0 +1,278 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Append-only ring log file with fixed size records on top of FATFS
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_LOGFS_H
+#define TM_LOGFS_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_LOGFS
+ * @brief    Append-only ring log file with fixed size records on top of FATFS
+ * @{
+ *
+ * High rate logging with f_write and f_sync updates FAT and directory entry all the time,
+ * which is slow and wears memory card. This library uses one preallocated file of fixed size as ring buffer for records.
+ *
+ * Records are collected in RAM and written in sector aligned batches directly to file data,
+ * so file size and cluster chain do not change after file is created. Only small header in first sectors of file is updated,
+ * once per LOGFS_HEADER_INTERVAL batches and on @ref TM_LOGFS_Sync call.
+ *
+ * \par File format
+ *
+\verbatim
+ - Sector 0 and 1: Header copies, written alternately with sequence number and CRC
+ - Sector 2 and more: Records, Capacity * RecordSize bytes
+\endverbatim
+ *
+ * On open, valid header with highest sequence number is used. After power loss, records written after last header update are lost.
+ *
+ * When log is full, oldest batch of records is overwritten. Batch being written and batches written since last header update
+ * are not counted as valid records, so header never points to overwritten data.
+ * Maximal number of records in log is Capacity - (LOGFS_HEADER_INTERVAL + 1) batches.
+ *
+ * \par Configuration
+ *
+ * Record size must be divider of 512 bytes (for example 16, 32 or 64 bytes), use padding in record structure for other sizes.
+ *
+\code
+//Number of sectors in one write batch, RAM buffer is in log structure
+#define LOGFS_BATCH_SECTORS      8
+
+//Number of batches between header updates
+#define LOGFS_HEADER_INTERVAL    16
+\endcode
+ *
+ * When fast seek is enabled in FATFS (_USE_FASTSEEK), it is used for file to avoid FAT reads on seek.
+ *
+ * \par Example
+ *
+\code
+typedef struct {
+	uint32_t Time;
+	int16_t Values[6];
+} Sample_t; //16 bytes
+
+TM_LOGFS_t Log;
+Sample_t s;
+
+//Mount SD card, then open or create log with 1 million records
+if (TM_LOGFS_Open(&Log, "SD:/sensor.log", sizeof(Sample_t), 1000000) == FR_OK) {
+	//Add records, data are written in batches
+	TM_LOGFS_Write(&Log, &s);
+	
+	//Read oldest record
+	TM_LOGFS_Read(&Log, 0, &s);
+	
+	//Close log before card is removed
+	TM_LOGFS_Close(&Log);
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM FATFS
+ - TM CRC
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_fatfs.h"
+#include "tm_stm32_crc.h"
+
+/* Check FATFS version */
+#if TM_FATFS_H < 150
+#error "Please update TM FATFS LIB, minimum required version is 1.5. Download available on stm32f4-discovery.com website"
+#endif
+
+/**
+ * @defgroup TM_LOGFS_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Number of sectors in one write batch
+ */
+#ifndef LOGFS_BATCH_SECTORS
+#define LOGFS_BATCH_SECTORS      8
+#endif
+
+/**
+ * @brief  Number of batches written between header updates
+ */
+#ifndef LOGFS_HEADER_INTERVAL
+#define LOGFS_HEADER_INTERVAL    16
+#endif
+
+/* Sector size and batch size in bytes */
+#define LOGFS_SECTOR_SIZE        512
+#define LOGFS_BATCH_SIZE         (LOGFS_BATCH_SECTORS * LOGFS_SECTOR_SIZE)
+
+/**
+ * @brief  Gets number of valid records in log
+ * @param  *Log: Pointer to opened @ref TM_LOGFS_t structure
+ * @retval Number of records
+ */
+#define TM_LOGFS_GetCount(Log)   ((Log)->Count)
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_LOGFS_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Log structure
+ * @note   Members are private and should not be modified by user
+ */
+typedef struct {
+	FIL File;                  /*!< Log file */
+	uint32_t RecordSize;       /*!< Size of one record in bytes */
+	uint32_t Capacity;         /*!< Number of records in file */
+	uint32_t Head;             /*!< Index of next record to write */
+	uint32_t Count;            /*!< Number of valid records */
+	uint32_t Sequence;         /*!< Sequence number of next header write */
+	uint32_t BatchStart;       /*!< Index of first record in RAM batch */
+	uint32_t Pending;          /*!< Number of records in RAM batch */
+	uint32_t Batches;          /*!< Number of batches written since last header update */
+#if _USE_FASTSEEK
+	TM_FATFS_FastSeek_t FastSeek; /*!< Fast seek table */
+#endif
+	uint32_t Buffer[LOGFS_BATCH_SIZE / 4]; /*!< RAM batch buffer */
+} TM_LOGFS_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_LOGFS_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Opens existing log file or creates new preallocated one
+ * @note   Volume must be mounted first. New file is allocated contiguous when there is enough contiguous free space
+ * @param  *Log: Pointer to empty @ref TM_LOGFS_t structure
+ * @param  *path: Path to log file
+ * @param  RecordSize: Size of one record in bytes, must be divider of 512
+ * @param  Capacity: Number of records in file, rounded up to multiple of records in one batch.
+ *            Minimal capacity is LOGFS_HEADER_INTERVAL + 2 batches
+ * @retval Member of FRESULT:
+ *            - FR_OK: Log is opened
+ *            - FR_INVALID_PARAMETER: Record size is not valid or existing file has different format
+ *            - FR_NO_FILESYSTEM: Existing file has no valid header
+ *            - FR_DENIED: Not enough free space for new file
+ */
+FRESULT TM_LOGFS_Open(TM_LOGFS_t* Log, const char* path, uint32_t RecordSize, uint32_t Capacity);
+
+/**
+ * @brief  Adds record to log
+ * @note   Only RAM copy is done until batch is full
+ * @param  *Log: Pointer to opened @ref TM_LOGFS_t structure
+ * @param  *Record: Pointer to record data, RecordSize bytes
+ * @retval FR_OK on success, error code of FATFS write otherwise
+ */
+FRESULT TM_LOGFS_Write(TM_LOGFS_t* Log, const void* Record);
+
+/**
+ * @brief  Reads record from log
+ * @param  *Log: Pointer to opened @ref TM_LOGFS_t structure
+ * @param  index: Record index, 0 is oldest record and TM_LOGFS_GetCount() - 1 is newest record
+ * @param  *Record: Pointer to memory to save record to, RecordSize bytes
+ * @retval FR_OK on success, FR_INVALID_PARAMETER if index is not valid
+ */
+FRESULT TM_LOGFS_Read(TM_LOGFS_t* Log, uint32_t index, void* Record);
+
+/**
+ * @brief  Writes records from RAM batch and header to file
+ * @note   Call it when records must survive power loss
+ * @param  *Log: Pointer to opened @ref TM_LOGFS_t structure
+ * @retval FR_OK on success, error code of FATFS otherwise
+ */
+FRESULT TM_LOGFS_Sync(TM_LOGFS_t* Log);
+
+/**
+ * @brief  Writes pending records and closes log file
+ * @param  *Log: Pointer to opened @ref TM_LOGFS_t structure
+ * @retval FR_OK on success, error code of FATFS otherwise
+ */
+FRESULT TM_LOGFS_Close(TM_LOGFS_t* Log);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
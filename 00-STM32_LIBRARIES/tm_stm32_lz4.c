@@ -0,0 +1,289 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_lz4.h"
+
+/* LZ4 format constants */
+#define LZ4_MAGIC                 0x184D2204
+#define LZ4_SKIPPABLE_MAGIC       0x184D2A50
+#define LZ4_MIN_MATCH             4
+#define LZ4_LAST_LITERALS         5
+#define LZ4_MATCH_LIMIT           12
+#define LZ4_UNCOMPRESSED          0x80000000
+
+/* Hash of 4 bytes */
+#define LZ4_HASH(x)               (((x) * 2654435761U) >> (32 - LZ4_HASH_BITS))
+
+
+/* Frame header: magic, version 1 with independent blocks, 64kB max block size, header checksum */
+static const uint8_t LZ4_FrameHeader[] = {0x04, 0x22, 0x4D, 0x18, 0x60, 0x40, 0x82};
+
+/* Private functions */
+static uint32_t TM_LZ4_INT_Write(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+static uint8_t TM_LZ4_INT_Flush(TM_STREAM_t* Stream);
+static void TM_LZ4_INT_Block(TM_LZ4_t* Lz4);
+static void TM_LZ4_INT_Put(TM_LZ4_t* Lz4, const uint8_t* data, uint32_t count);
+static void TM_LZ4_INT_Put32(TM_LZ4_t* Lz4, uint32_t value);
+static void TM_LZ4_INT_Output(TM_LZ4_t* Lz4);
+static uint8_t* TM_LZ4_INT_Length(uint8_t* dst, uint32_t len);
+
+/* Read 4 bytes from any address, compiler uses one unaligned load on Cortex-M3/M4/M7 */
+static __INLINE uint32_t TM_LZ4_INT_Read32(const uint8_t* p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+/* Compressor output */
+static const TM_STREAM_Ops_t LZ4_Stream = {TM_LZ4_INT_Write, TM_LZ4_INT_Flush};
+
+void TM_LZ4_Init(TM_LZ4_t* Lz4, TM_STREAM_t* Stream, TM_STREAM_t* Output) {
+	/* Reset compressor */
+	Lz4->Output = Output;
+	Lz4->In = 0;
+	Lz4->Out = 0;
+	Lz4->FrameOpen = 0;
+	Lz4->RawBytes = 0;
+	Lz4->CompressedBytes = 0;
+	Lz4->Errors = 0;
+	
+	/* Init input stream */
+	TM_STREAM_Init(Stream, &LZ4_Stream, Lz4, 0);
+}
+
+uint32_t TM_LZ4_CompressBlock(uint16_t* Hash, const uint8_t* src, uint32_t count, uint8_t* dst) {
+	const uint8_t* ip = src;
+	const uint8_t* anchor = src;
+	const uint8_t* ref;
+	const uint8_t* mflimit = src + count - LZ4_MATCH_LIMIT;
+	const uint8_t* matchlimit = src + count - LZ4_LAST_LITERALS;
+	uint8_t* op = dst;
+	uint8_t* token;
+	uint32_t seq, h, len, lit;
+	
+	/* Search matches, last match must start 12 bytes before end of block */
+	while (count > LZ4_MATCH_LIMIT && ip < mflimit) {
+		/* Get last position with the same hash, table is only a hint */
+		seq = TM_LZ4_INT_Read32(ip);
+		h = LZ4_HASH(seq);
+		ref = src + Hash[h];
+		Hash[h] = ip - src;
+		
+		/* Check match */
+		if (ref >= ip || (ip - ref) > 0xFFFF || TM_LZ4_INT_Read32(ref) != seq) {
+			ip++;
+			continue;
+		}
+		
+		/* Extend match, last 5 bytes are always literals */
+		len = LZ4_MIN_MATCH;
+		while ((ip + len) < matchlimit && ip[len] == ref[len]) {
+			len++;
+		}
+		
+		/* Token and literals */
+		lit = ip - anchor;
+		token = op++;
+		*token = (lit >= 15 ? 15 : lit) << 4;
+		if (lit >= 15) {
+			op = TM_LZ4_INT_Length(op, lit - 15);
+		}
+		memcpy(op, anchor, lit);
+		op += lit;
+		
+		/* Offset, little endian */
+		*op++ = (ip - ref) & 0xFF;
+		*op++ = (ip - ref) >> 8;
+		
+		/* Match length */
+		len -= LZ4_MIN_MATCH;
+		*token |= len >= 15 ? 15 : len;
+		if (len >= 15) {
+			op = TM_LZ4_INT_Length(op, len - 15);
+		}
+		
+		/* Continue after match */
+		ip += len + LZ4_MIN_MATCH;
+		anchor = ip;
+	}
+	
+	/* Last literals */
+	lit = src + count - anchor;
+	*op++ = (lit >= 15 ? 15 : lit) << 4;
+	if (lit >= 15) {
+		op = TM_LZ4_INT_Length(op, lit - 15);
+	}
+	memcpy(op, anchor, lit);
+	op += lit;
+	
+	/* Return compressed size */
+	return op - dst;
+}
+
+/* Private functions */
+static uint32_t TM_LZ4_INT_Write(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	TM_LZ4_t* Lz4 = (TM_LZ4_t *)Stream->Handle;
+	const uint8_t* data;
+	uint32_t size, n, written = 0;
+	uint8_t i;
+	
+	/* Collect parts to input block */
+	for (i = 0; i < count; i++) {
+		data = Vectors[i].Data;
+		size = Vectors[i].Size;
+		while (size) {
+			n = LZ4_BLOCK_SIZE - Lz4->In;
+			if (n > size) {
+				n = size;
+			}
+			memcpy(&Lz4->Block[Lz4->In], data, n);
+			Lz4->In += n;
+			Lz4->RawBytes += n;
+			written += n;
+			data += n;
+			size -= n;
+			
+			/* Compress full block */
+			if (Lz4->In == LZ4_BLOCK_SIZE) {
+				TM_LZ4_INT_Block(Lz4);
+			}
+		}
+	}
+	
+	/* All data are accepted */
+	return written;
+}
+
+static uint8_t TM_LZ4_INT_Flush(TM_STREAM_t* Stream) {
+	TM_LZ4_t* Lz4 = (TM_LZ4_t *)Stream->Handle;
+	uint32_t pad;
+	
+	/* Compress partial block */
+	if (Lz4->In) {
+		TM_LZ4_INT_Block(Lz4);
+	}
+	
+	/* Finish frame with end mark */
+	if (Lz4->FrameOpen) {
+		TM_LZ4_INT_Put32(Lz4, 0);
+		Lz4->FrameOpen = 0;
+	}
+	
+	/* Pad to sector boundary with skippable frame, it needs at least 8 bytes */
+	pad = (512 - (Lz4->Out % 512)) % 512;
+	if (pad > 0 && pad < 8) {
+		pad += 512;
+	}
+	if (pad) {
+		TM_LZ4_INT_Put32(Lz4, LZ4_SKIPPABLE_MAGIC);
+		TM_LZ4_INT_Put32(Lz4, pad - 8);
+		for (pad -= 8; pad; pad--) {
+			TM_LZ4_INT_Put(Lz4, (const uint8_t *)"", 1);
+		}
+	}
+	
+	/* Write whole sectors which are left */
+	TM_LZ4_INT_Output(Lz4);
+	
+	/* Flush output */
+	return TM_STREAM_Flush(Lz4->Output);
+}
+
+static void TM_LZ4_INT_Block(TM_LZ4_t* Lz4) {
+	uint32_t size;
+	
+	/* Start frame */
+	if (!Lz4->FrameOpen) {
+		TM_LZ4_INT_Put(Lz4, LZ4_FrameHeader, sizeof(LZ4_FrameHeader));
+		Lz4->FrameOpen = 1;
+	}
+	
+	/* Compress after block size, output memory has space for whole block */
+	size = TM_LZ4_CompressBlock(Lz4->Hash, Lz4->Block, Lz4->In, &Lz4->Data[Lz4->Out + 4]);
+	
+	/* Store block when it is not smaller */
+	if (size >= Lz4->In) {
+		size = Lz4->In;
+		memcpy(&Lz4->Data[Lz4->Out + 4], Lz4->Block, size);
+		size |= LZ4_UNCOMPRESSED;
+	}
+	
+	/* Block size, little endian */
+	Lz4->Data[Lz4->Out + 0] = size & 0xFF;
+	Lz4->Data[Lz4->Out + 1] = (size >> 8) & 0xFF;
+	Lz4->Data[Lz4->Out + 2] = (size >> 16) & 0xFF;
+	Lz4->Data[Lz4->Out + 3] = size >> 24;
+	Lz4->Out += 4 + (size & ~LZ4_UNCOMPRESSED);
+	Lz4->In = 0;
+	
+	/* Write full chunks */
+	TM_LZ4_INT_Output(Lz4);
+}
+
+static void TM_LZ4_INT_Put(TM_LZ4_t* Lz4, const uint8_t* data, uint32_t count) {
+	/* Copy to output memory, it is always below chunk size before put */
+	memcpy(&Lz4->Data[Lz4->Out], data, count);
+	Lz4->Out += count;
+	
+	/* Write full chunks */
+	TM_LZ4_INT_Output(Lz4);
+}
+
+static void TM_LZ4_INT_Put32(TM_LZ4_t* Lz4, uint32_t value) {
+	uint8_t b[4];
+	
+	/* Little endian */
+	b[0] = value & 0xFF;
+	b[1] = (value >> 8) & 0xFF;
+	b[2] = (value >> 16) & 0xFF;
+	b[3] = value >> 24;
+	TM_LZ4_INT_Put(Lz4, b, 4);
+}
+
+static void TM_LZ4_INT_Output(TM_LZ4_t* Lz4) {
+	/* Write chunks of output size, so output position stays sector aligned */
+	while (Lz4->Out >= LZ4_OUTPUT_SIZE) {
+		if (TM_STREAM_Write(Lz4->Output, Lz4->Data, LZ4_OUTPUT_SIZE) != LZ4_OUTPUT_SIZE) {
+			Lz4->Errors++;
+		}
+		Lz4->CompressedBytes += LZ4_OUTPUT_SIZE;
+		
+		/* Move rest to the beginning */
+		Lz4->Out -= LZ4_OUTPUT_SIZE;
+		memmove(Lz4->Data, &Lz4->Data[LZ4_OUTPUT_SIZE], Lz4->Out);
+	}
+}
+
+static uint8_t* TM_LZ4_INT_Length(uint8_t* dst, uint32_t len) {
+	/* Length above 15 is sum of bytes, 255 means next byte follows */
+	while (len >= 255) {
+		*dst++ = 255;
+		len -= 255;
+	}
+	*dst++ = len;
+	
+	/* Return new output pointer */
+	return dst;
+}
@@ -0,0 +1,237 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Streaming LZ4 compression for logs on STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_LZ4_H
+#define TM_LZ4_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_LZ4
+ * @brief    Streaming LZ4 compression for logs on STM32Fxxx
+ * @{
+ *
+ * Library is compression stage between log producer and output, for example FatFs file.
+ * Data written to compressor stream are collected in blocks of @ref LZ4_BLOCK_SIZE bytes,
+ * each block is compressed independently and output gets compressed data in chunks of @ref LZ4_OUTPUT_SIZE bytes.
+ * RAM use is fixed and known at compile time, no dynamic memory is used.
+ *
+ * \par Output format
+ *
+ * Output is standard LZ4 frame, so log files can be decompressed on PC with lz4 tool:
+ *
+\verbatim
+lz4 -d sensor.lz4 sensor.bin
+\endverbatim
+ *
+ * On @ref TM_STREAM_Flush, partial block is compressed, frame is finished and padded with LZ4 skippable frame
+ * to 512 bytes boundary, so file always grows by whole sectors. Next data start new frame,
+ * lz4 tool decompresses more frames in one file one after another.
+ *
+ * \par Configuration
+ *
+ * RAM in @ref TM_LZ4_t structure is about 2 * @ref LZ4_BLOCK_SIZE + @ref LZ4_OUTPUT_SIZE + 2 * 2^@ref LZ4_HASH_BITS bytes.
+ * Defaults use about 12kB, for low RAM devices smaller blocks and hash table can be set in defines.h file:
+ *
+\code
+//Input block size, compression is better with bigger blocks
+#define LZ4_BLOCK_SIZE       1024
+
+//Number of bits for match hash table
+#define LZ4_HASH_BITS        8
+
+//Output chunk size, multiple of 512 bytes
+#define LZ4_OUTPUT_SIZE      512
+\endcode
+ *
+ * \par Example
+ *
+\code
+TM_LZ4_t Lz4;
+TM_STREAM_t File, Log;
+
+//Open file, then make file stream and compressor stream
+TM_STREAM_InitFatFs(&File, &fil);
+TM_LZ4_Init(&Lz4, &Log, &File);
+
+//Write records to compressor stream
+TM_STREAM_Write(&Log, &sample, sizeof(sample));
+
+//Write everything to file and sync it, before card is removed
+TM_STREAM_Flush(&Log);
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM STREAM
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_stream.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_LZ4_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Input block size, max 65536 bytes */
+#ifndef LZ4_BLOCK_SIZE
+#define LZ4_BLOCK_SIZE       4096
+#endif
+
+/* Number of bits for match hash table, table has 2^LZ4_HASH_BITS entries of 2 bytes */
+#ifndef LZ4_HASH_BITS
+#define LZ4_HASH_BITS        10
+#endif
+
+/* Output chunk size, multiple of 512 bytes */
+#ifndef LZ4_OUTPUT_SIZE
+#define LZ4_OUTPUT_SIZE      2048
+#endif
+
+/* Check settings */
+#if LZ4_BLOCK_SIZE > 65536 || LZ4_BLOCK_SIZE < 16
+#error "LZ4_BLOCK_SIZE must be between 16 and 65536 bytes!"
+#endif
+#if (LZ4_OUTPUT_SIZE % 512) != 0 || LZ4_OUTPUT_SIZE == 0
+#error "LZ4_OUTPUT_SIZE must be multiple of 512 bytes!"
+#endif
+
+/**
+ * @brief  Maximal compressed size of block
+ * @param  size: Input block size
+ * @retval Maximal compressed size
+ */
+#define LZ4_COMPRESS_BOUND(size)    ((size) + (size) / 255 + 16)
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_LZ4_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Compressor structure
+ */
+typedef struct {
+	TM_STREAM_t* Output;                     /*!< Pointer to output stream */
+	uint32_t In;                             /*!< Number of bytes in input block */
+	uint32_t Out;                            /*!< Number of bytes in output memory */
+	uint8_t FrameOpen;                       /*!< Set to 1 when frame header was written */
+	uint32_t RawBytes;                       /*!< Number of bytes written to compressor */
+	uint32_t CompressedBytes;                /*!< Number of bytes given to output, with headers and padding */
+	uint32_t Errors;                         /*!< Number of output chunks which were not written completely */
+	uint16_t Hash[1 << LZ4_HASH_BITS];       /*!< Match hash table */
+	uint8_t Block[LZ4_BLOCK_SIZE];           /*!< Input block */
+	uint8_t Data[LZ4_OUTPUT_SIZE + 4 + LZ4_COMPRESS_BOUND(LZ4_BLOCK_SIZE)]; /*!< Output memory */
+} TM_LZ4_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_LZ4_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes compressor stream
+ * @param  *Lz4: Pointer to empty @ref TM_LZ4_t structure, must stay valid
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure for compressor input
+ * @param  *Output: Pointer to initialized output stream, for example @ref TM_STREAM_InitFatFs
+ * @retval None
+ */
+void TM_LZ4_Init(TM_LZ4_t* Lz4, TM_STREAM_t* Stream, TM_STREAM_t* Output);
+
+/**
+ * @brief  Compresses one block in LZ4 block format
+ * @note   Hash table content is only used as hint and does not need to be initialized
+ * @param  *Hash: Pointer to hash table with 2^@ref LZ4_HASH_BITS entries
+ * @param  *src: Pointer to input data
+ * @param  count: Number of input bytes, max 65536
+ * @param  *dst: Pointer to output memory, at least @ref LZ4_COMPRESS_BOUND(count) bytes
+ * @retval Number of bytes in compressed block
+ */
+uint32_t TM_LZ4_CompressBlock(uint16_t* Hash, const uint8_t* src, uint32_t count, uint8_t* dst);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,336 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_mem.h"
+
+/* Engines, saved in lower 2 bits of handle */
+#define MEM_ENGINE_CPU          0
+#define MEM_ENGINE_DMA          1
+#define MEM_ENGINE_DMA2D        2
+
+/* Sequence number in upper 30 bits of handle */
+#define MEM_HANDLE(engine, seq) (((seq) << 2) | (engine))
+
+/* Engine state */
+typedef struct {
+	volatile uint32_t Seq;  /* Sequence number of last started operation */
+	volatile uint8_t Busy;  /* Last operation is in progress */
+} TM_MEM_INT_Engine_t;
+
+static TM_MEM_INT_Engine_t MEM_Engines[3];
+static TM_MEM_Stats_t MEM_Stats;
+static DMA_HandleTypeDef MEM_DMAHandle;
+static uint8_t MEM_DMAReady;
+static uint32_t MEM_Pattern;
+#if MEM_USE_DMA2D
+static uint32_t MEM_DMA2DAddress;
+static uint32_t MEM_DMA2DSize;
+#endif
+
+/* Private functions */
+static TM_MEM_Handle_t TM_MEM_INT_Begin(uint8_t engine);
+static uint8_t TM_MEM_INT_DMAAccess(uint32_t address, uint32_t size);
+static TM_MEM_Handle_t TM_MEM_INT_StartDMA(uint32_t dst, uint32_t src, uint32_t size, uint8_t fill, uint8_t value);
+static void TM_MEM_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+#if MEM_USE_DMA2D
+static TM_MEM_Handle_t TM_MEM_INT_FillDMA2D(uint32_t dst, uint8_t value, uint32_t size);
+static void TM_MEM_INT_DMA2DCheck(void);
+#endif
+
+uint8_t TM_MEM_Init(void) {
+	/* Claim stream, low priority so peripherals are not delayed by background copies */
+	MEM_DMAReady = 0;
+	if (TM_DMA_Claim(MEM_DMA_STREAM, MEM_DMA_OWNER, TM_DMA_Priority_Low)) {
+		/* Enable clock */
+		TM_DMA_Init(MEM_DMA_STREAM, NULL);
+		
+		/* Memory to memory needs FIFO, data sizes and bursts are set for each transfer */
+		memset(&MEM_DMAHandle, 0, sizeof(MEM_DMAHandle));
+		MEM_DMAHandle.Init.Channel = MEM_DMA_CHANNEL;
+		MEM_DMAHandle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+		MEM_DMAHandle.Init.PeriphInc = DMA_PINC_ENABLE;
+		MEM_DMAHandle.Init.MemInc = DMA_MINC_ENABLE;
+		MEM_DMAHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+		MEM_DMAHandle.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+		MEM_DMAHandle.Init.Mode = DMA_NORMAL;
+		MEM_DMAHandle.Init.Priority = DMA_PRIORITY_LOW;
+		MEM_DMAHandle.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+		MEM_DMAHandle.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+		MEM_DMAHandle.Init.MemBurst = DMA_MBURST_SINGLE;
+		MEM_DMAHandle.Init.PeriphBurst = DMA_PBURST_SINGLE;
+		TM_DMA_Init(MEM_DMA_STREAM, &MEM_DMAHandle);
+		
+		/* End of transfer is reported from stream interrupt */
+		TM_DMA_SetStreamCallback(MEM_DMA_STREAM, TM_MEM_INT_DMACallback, NULL);
+		MEM_DMAReady = 1;
+	}
+	
+#if MEM_USE_DMA2D
+	/* Enable DMA2D clock */
+	__HAL_RCC_DMA2D_CLK_ENABLE();
+#endif
+	
+	/* Return status */
+	return MEM_DMAReady;
+}
+
+TM_MEM_Handle_t TM_MEM_CopyAsync(void* Destination, const void* Source, uint32_t Size) {
+	uint32_t dst = (uint32_t)Destination;
+	uint32_t src = (uint32_t)Source;
+	
+	/* Large blocks on DMA2 stream */
+	if (MEM_DMAReady && Size >= MEM_DMA_THRESHOLD && TM_MEM_INT_DMAAccess(dst, Size) && TM_MEM_INT_DMAAccess(src, Size)) {
+		return TM_MEM_INT_StartDMA(dst, src, Size, 0, 0);
+	}
+	
+	/* Small blocks with CPU */
+	memcpy(Destination, Source, Size);
+	MEM_Stats.CPUCount++;
+	
+	/* Done already */
+	return TM_MEM_HANDLE_DONE;
+}
+
+TM_MEM_Handle_t TM_MEM_FillAsync(void* Destination, uint8_t Value, uint32_t Size) {
+	uint32_t dst = (uint32_t)Destination;
+	
+	/* Large blocks on DMA2D or DMA2 stream */
+	if (Size >= MEM_DMA_THRESHOLD && TM_MEM_INT_DMAAccess(dst, Size)) {
+#if MEM_USE_DMA2D
+		/* DMA2D writes 32-bit pixels */
+		if (!(dst & 0x03)) {
+			return TM_MEM_INT_FillDMA2D(dst, Value, Size);
+		}
+#endif
+		if (MEM_DMAReady) {
+			return TM_MEM_INT_StartDMA(dst, 0, Size, 1, Value);
+		}
+	}
+	
+	/* Small blocks with CPU */
+	memset(Destination, Value, Size);
+	MEM_Stats.CPUCount++;
+	
+	/* Done already */
+	return TM_MEM_HANDLE_DONE;
+}
+
+uint8_t TM_MEM_IsDone(TM_MEM_Handle_t Handle) {
+	uint8_t engine = Handle & 0x03;
+	
+	/* CPU operations are always done */
+	if (engine == MEM_ENGINE_CPU || engine > MEM_ENGINE_DMA2D) {
+		return 1;
+	}
+	
+#if MEM_USE_DMA2D
+	/* DMA2D has no interrupt, check registers */
+	if (engine == MEM_ENGINE_DMA2D) {
+		TM_MEM_INT_DMA2DCheck();
+	}
+#endif
+	
+	/* Done when engine is idle or started newer operation */
+	return !MEM_Engines[engine].Busy || MEM_Engines[engine].Seq != (Handle >> 2);
+}
+
+void TM_MEM_Wait(TM_MEM_Handle_t Handle) {
+	/* Wait till done */
+	while (!TM_MEM_IsDone(Handle));
+}
+
+void TM_MEM_GetStats(TM_MEM_Stats_t* Stats) {
+	/* Copy statistics */
+	*Stats = MEM_Stats;
+}
+
+/* Private functions */
+static TM_MEM_Handle_t TM_MEM_INT_Begin(uint8_t engine) {
+	TM_MEM_INT_Engine_t* e = &MEM_Engines[engine];
+	
+	/* Wait for previous operation on engine */
+	TM_MEM_Wait(MEM_HANDLE(engine, e->Seq));
+	
+	/* New operation */
+	e->Seq = (e->Seq + 1) & 0x3FFFFFFF;
+	e->Busy = 1;
+	
+	/* Return handle */
+	return MEM_HANDLE(engine, e->Seq);
+}
+
+static uint8_t TM_MEM_INT_DMAAccess(uint32_t address, uint32_t size) {
+#if defined(CCMDATARAM_BASE)
+	/* CCM RAM is connected to CPU only */
+	if (address < (CCMDATARAM_BASE + 0x10000) && (address + size) > CCMDATARAM_BASE) {
+		return 0;
+	}
+#endif
+	
+	/* Memory is accessible */
+	return 1;
+}
+
+static TM_MEM_Handle_t TM_MEM_INT_StartDMA(uint32_t dst, uint32_t src, uint32_t size, uint8_t fill, uint8_t value) {
+	TM_MEM_Handle_t handle;
+	uint32_t align, width, items, cr;
+	
+	/* Widest data size allowed by alignment, fill source is always aligned */
+	align = fill ? dst : (dst | src);
+	if (!(align & 0x03)) {
+		width = 4;
+	} else if (!(align & 0x01)) {
+		width = 2;
+	} else {
+		width = 1;
+	}
+	items = size / width;
+	
+	/* Wait for previous transfer */
+	handle = TM_MEM_INT_Begin(MEM_ENGINE_DMA);
+	
+	/* Bytes after last item by CPU */
+	if (fill) {
+		memset((void *)(dst + items * width), value, size - items * width);
+	} else {
+		memcpy((void *)(dst + items * width), (void *)(src + items * width), size - items * width);
+	}
+	
+	/* Data size, increment and bursts for this transfer */
+	cr = MEM_DMA_STREAM->CR & ~(DMA_SxCR_PSIZE | DMA_SxCR_MSIZE | DMA_SxCR_PINC | DMA_SxCR_PBURST | DMA_SxCR_MBURST);
+	if (width == 4) {
+		cr |= DMA_PDATAALIGN_WORD | DMA_MDATAALIGN_WORD;
+	} else if (width == 2) {
+		cr |= DMA_PDATAALIGN_HALFWORD | DMA_MDATAALIGN_HALFWORD;
+	} else {
+		cr |= DMA_PDATAALIGN_BYTE | DMA_MDATAALIGN_BYTE;
+	}
+	
+	/* Burst of 4 items must not cross 1kB boundary, use it only when address is aligned to burst */
+	if (!(dst & (width * 4 - 1))) {
+		cr |= DMA_MBURST_INC4;
+	}
+	if (fill) {
+		/* Fixed source with pattern */
+		MEM_Pattern = value * 0x01010101UL;
+		src = (uint32_t)&MEM_Pattern;
+	} else {
+		cr |= DMA_PINC_ENABLE;
+		if (!(src & (width * 4 - 1))) {
+			cr |= DMA_PBURST_INC4;
+		}
+	}
+	MEM_DMA_STREAM->CR = cr;
+	
+	/* Start transfer, split to parts by TM DMA */
+	if (!TM_DMA_StartLong(&MEM_DMAHandle, src, dst, items)) {
+		/* Stream was not free, do it with CPU */
+		MEM_Engines[MEM_ENGINE_DMA].Busy = 0;
+		if (fill) {
+			memset((void *)dst, value, items * width);
+		} else {
+			memcpy((void *)dst, (void *)src, items * width);
+		}
+		MEM_Stats.CPUCount++;
+		return TM_MEM_HANDLE_DONE;
+	}
+	MEM_Stats.DMACount++;
+	
+	/* Return handle */
+	return handle;
+}
+
+static void TM_MEM_INT_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	/* Stream is stopped on error */
+	if (flags & DMA_FLAG_TEIF) {
+		MEM_Stats.Errors++;
+		MEM_Engines[MEM_ENGINE_DMA].Busy = 0;
+	} else if (flags & DMA_FLAG_TCIF) {
+		/* Last part is finished */
+		MEM_Engines[MEM_ENGINE_DMA].Busy = 0;
+	}
+}
+
+#if MEM_USE_DMA2D
+static TM_MEM_Handle_t TM_MEM_INT_FillDMA2D(uint32_t dst, uint8_t value, uint32_t size) {
+	TM_MEM_Handle_t handle;
+	uint32_t pixels = size / 4;
+	uint32_t width, lines, done;
+	
+	/* One line when it fits, otherwise lines of fixed size */
+	if (pixels <= 16383) {
+		width = pixels;
+		lines = 1;
+	} else {
+		width = MEM_DMA2D_LINE;
+		lines = pixels / width;
+		if (lines > 0xFFFF) {
+			lines = 0xFFFF;
+		}
+	}
+	done = width * lines * 4;
+	
+	/* Wait for previous transfer */
+	handle = TM_MEM_INT_Begin(MEM_ENGINE_DMA2D);
+	
+	/* Bytes after last line by CPU */
+	memset((void *)(dst + done), value, size - done);
+	
+	/* Remove dirty lines, so they are not written over DMA2D data */
+	TM_DMA_InvalidateCache((void *)dst, done);
+	MEM_DMA2DAddress = dst;
+	MEM_DMA2DSize = done;
+	
+	/* Register to memory, 32-bit pixels without offset between lines */
+	DMA2D->IFCR = DMA2D_IFSR_CTCIF | DMA2D_IFSR_CTEIF | DMA2D_IFSR_CCEIF;
+	DMA2D->OPFCCR = CM_ARGB8888;
+	DMA2D->OCOLR = value * 0x01010101UL;
+	DMA2D->OMAR = dst;
+	DMA2D->OOR = 0;
+	DMA2D->NLR = (width << 16) | lines;
+	DMA2D->CR = DMA2D_R2M | DMA2D_CR_START;
+	MEM_Stats.DMA2DCount++;
+	
+	/* Return handle */
+	return handle;
+}
+
+static void TM_MEM_INT_DMA2DCheck(void) {
+	/* Transfer is finished when start bit is cleared */
+	if (!MEM_Engines[MEM_ENGINE_DMA2D].Busy || (DMA2D->CR & DMA2D_CR_START)) {
+		return;
+	}
+	
+	/* Check errors and clear flags */
+	if (DMA2D->ISR & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) {
+		MEM_Stats.Errors++;
+	}
+	DMA2D->IFCR = DMA2D_IFSR_CTCIF | DMA2D_IFSR_CTEIF | DMA2D_IFSR_CCEIF;
+	
+	/* CPU must read data written by DMA2D */
+	TM_DMA_InvalidateCache((void *)MEM_DMA2DAddress, MEM_DMA2DSize);
+	MEM_Engines[MEM_ENGINE_DMA2D].Busy = 0;
+}
+#endif
@@ -0,0 +1,272 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Hardware assisted memory copy and fill for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_MEM_H
+#define TM_MEM_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_MEM
+ * @brief    Hardware assisted memory copy and fill for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Large copies and clears (frame buffers, FFT buffers, FatFs staging buffers) run in background on DMA2 memory to memory stream
+ * or on DMA2D register to memory mode, while CPU continues with other work. Each function returns handle of operation,
+ * which is checked with @ref TM_MEM_IsDone or waited for with @ref TM_MEM_Wait before memory is used.
+ *
+ * Engine is selected by size and alignment:
+ *
+ *  - Blocks smaller than @ref MEM_DMA_THRESHOLD and blocks in CCM RAM are done by CPU, handle is done immediately
+ *  - Copy uses DMA2 stream with widest data size allowed by alignment of source and destination, with bursts when aligned to 16 bytes
+ *  - Fill uses DMA2D register to memory mode with 32-bit pixels when enabled and destination is 4 bytes aligned, DMA2 stream otherwise
+ *  - Bytes at the end which do not fit to data size of engine are done by CPU before function returns
+ *
+ * When engine is busy with previous operation, new operation waits for it first. Operations on DMA2 and DMA2D can run at the same time,
+ * wait for handle of previous operation when memory areas overlap.
+ *
+\code
+TM_MEM_Handle_t h1, h2;
+
+//Claim DMA2 stream
+TM_MEM_Init();
+
+//Clear back buffer and copy samples to FFT input at the same time
+h1 = TM_MEM_FillAsync((void *)SDRAM_START_ADR, 0x00, 480 * 272 * 2);
+h2 = TM_MEM_CopyAsync(fft_input, adc_samples, sizeof(fft_input));
+
+//Do other work
+Process();
+
+//Wait for both
+TM_MEM_Wait(h1);
+TM_MEM_Wait(h2);
+\endcode
+ *
+ * \par DMA2D
+ *
+ * DMA2D is used for fill when MEM_USE_DMA2D is set to 1 in defines.h file. TM DMA2D GRAPHIC library does not check if DMA2D is used
+ * by someone else, so wait for graphic transfers with @ref TM_DMA2DGRAPHIC_WaitIdle before fill and do not draw until fill is done.
+ *
+\code
+//Use DMA2D for fill
+#define MEM_USE_DMA2D         1
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM DMA
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_dma.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_MEM_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Check device */
+#if defined(STM32F0xx)
+#error "TM MEM is not available on STM32F0xx devices"
+#endif
+
+/* Blocks smaller than this number of bytes are done by CPU */
+#ifndef MEM_DMA_THRESHOLD
+#define MEM_DMA_THRESHOLD         512
+#endif
+
+/* DMA2 stream for memory to memory transfers, only DMA2 can do memory to memory */
+#ifndef MEM_DMA_STREAM
+#define MEM_DMA_STREAM            DMA2_Stream0
+#define MEM_DMA_CHANNEL           DMA_CHANNEL_0
+#endif
+
+/* Owner of stream in TM DMA stream registry */
+#ifndef MEM_DMA_OWNER
+#define MEM_DMA_OWNER             TM_DMA_Request_User
+#endif
+
+/* Use DMA2D for fill */
+#ifndef MEM_USE_DMA2D
+#define MEM_USE_DMA2D             0
+#endif
+
+/* Pixels in one DMA2D line for fill of more than 16383 pixels, 1 to 16383 */
+#ifndef MEM_DMA2D_LINE
+#define MEM_DMA2D_LINE            256
+#endif
+
+#if MEM_USE_DMA2D && !defined(DMA2D)
+#error "DMA2D is not available on this device, set MEM_USE_DMA2D to 0!"
+#endif
+#if MEM_DMA2D_LINE < 1 || MEM_DMA2D_LINE > 16383
+#error "MEM_DMA2D_LINE must be between 1 and 16383!"
+#endif
+
+/**
+ * @brief  Handle of operation which was done by CPU, it is always done
+ */
+#define TM_MEM_HANDLE_DONE        ((TM_MEM_Handle_t)0)
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_MEM_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Handle of memory operation
+ */
+typedef uint32_t TM_MEM_Handle_t;
+
+/**
+ * @brief  Operation statistics
+ */
+typedef struct {
+	uint32_t CPUCount;   /*!< Number of operations done by CPU */
+	uint32_t DMACount;   /*!< Number of operations started on DMA2 stream */
+	uint32_t DMA2DCount; /*!< Number of operations started on DMA2D */
+	uint32_t Errors;     /*!< Number of transfer errors */
+} TM_MEM_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_MEM_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes memory service and claims DMA2 stream
+ * @param  None
+ * @retval Initialization status:
+ *            - 0: Stream is owned by someone else, DMA2 is not used
+ *            - > 0: Initialized
+ */
+uint8_t TM_MEM_Init(void);
+
+/**
+ * @brief  Starts copy of memory block
+ * @note   Areas must not overlap, source must stay unchanged until operation is done
+ * @param  *Destination: Pointer to destination memory
+ * @param  *Source: Pointer to source memory
+ * @param  Size: Number of bytes to copy
+ * @retval Handle of operation
+ */
+TM_MEM_Handle_t TM_MEM_CopyAsync(void* Destination, const void* Source, uint32_t Size);
+
+/**
+ * @brief  Starts fill of memory block with byte value
+ * @param  *Destination: Pointer to destination memory
+ * @param  Value: Value to fill memory with
+ * @param  Size: Number of bytes to fill
+ * @retval Handle of operation
+ */
+TM_MEM_Handle_t TM_MEM_FillAsync(void* Destination, uint8_t Value, uint32_t Size);
+
+/**
+ * @brief  Checks if operation is done
+ * @param  Handle: Handle of operation
+ * @retval Operation status:
+ *            - 0: Operation is in progress
+ *            - > 0: Operation is done, memory can be used
+ */
+uint8_t TM_MEM_IsDone(TM_MEM_Handle_t Handle);
+
+/**
+ * @brief  Waits till operation is done
+ * @param  Handle: Handle of operation
+ * @retval None
+ */
+void TM_MEM_Wait(TM_MEM_Handle_t Handle);
+
+/**
+ * @brief  Gets operation statistics
+ * @param  *Stats: Pointer to @ref TM_MEM_Stats_t structure to save statistics to
+ * @retval None
+ */
+void TM_MEM_GetStats(TM_MEM_Stats_t* Stats);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,288 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_modbus.h"
+
+/* Receiver timeout in bits, 3.5 characters of 11 bits, fixed 1.75ms above 19200 bauds */
+#define MODBUS_RTO_BITS(baudrate)      ((baudrate) > 19200 ? ((baudrate) * 7 / 4000) : 39)
+
+/* Pointer to first initialized interface */
+static TM_MODBUS_t* MODBUS_First;
+
+#if defined(CRC_POL_POL)
+/* CRC-16/MODBUS settings for CRC unit */
+static TM_CRC_Context_t MODBUS_CRC;
+#endif
+
+/* Private functions */
+static TM_MODBUS_t* TM_MODBUS_INT_Get(USART_TypeDef* USARTx);
+
+TM_MODBUS_Result_t TM_MODBUS_Init(TM_MODBUS_t* Modbus, USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, uint32_t baudrate, uint32_t Parity, uint8_t Address, GPIO_TypeDef* DE_Port, uint16_t DE_Pin) {
+	TM_MODBUS_t* m;
+	
+	/* Check parameters */
+	if (Modbus == NULL || baudrate == 0 || Address > 247) {
+		return TM_MODBUS_Result_Error;
+	}
+	
+	/* Fill structure */
+	memset(Modbus, 0, sizeof(TM_MODBUS_t));
+	Modbus->USARTx = USARTx;
+	Modbus->Address = Address;
+	Modbus->DE_Port = DE_Port;
+	Modbus->DE_Pin = DE_Pin;
+	
+	/* Init driver enable pin, receiver is active */
+	if (DE_Port != NULL) {
+		TM_GPIO_Init(DE_Port, DE_Pin, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High);
+		TM_GPIO_SetPinLow(DE_Port, DE_Pin);
+	}
+	
+	/* Init USART, 11 bits per character */
+	TM_USART_Init(USARTx, pinspack, baudrate);
+	if (Parity == USART_PARITY_NONE) {
+		TM_USART_SetFormat(USARTx, baudrate, USART_WORDLENGTH_8B, USART_PARITY_NONE, USART_STOPBITS_2);
+	} else {
+		TM_USART_SetFormat(USARTx, baudrate, USART_WORDLENGTH_9B, Parity, USART_STOPBITS_1);
+	}
+	
+#if defined(USART_CR2_RTOEN)
+	/* Disable USART, registers below can only be changed when disabled */
+	USARTx->CR1 &= ~USART_CR1_UE;
+	
+	/* Use hardware driver enable on RTS pin */
+	if (DE_Port == NULL) {
+		USARTx->CR3 |= USART_CR3_DEM;
+	}
+	
+	/* Set receiver timeout, not all USARTs have this feature */
+	USARTx->RTOR = MODBUS_RTO_BITS(baudrate);
+	USARTx->CR2 |= USART_CR2_RTOEN;
+	if ((USARTx->CR2 & USART_CR2_RTOEN) && USARTx->RTOR) {
+		Modbus->Timeout = 1;
+	}
+	
+	/* Enable USART back */
+	USARTx->CR1 |= USART_CR1_UE;
+#endif
+	
+#if defined(CRC_POL_POL)
+	/* Init CRC unit for CRC-16/MODBUS */
+	TM_CRC_Init();
+	TM_CRC_ContextInit(&MODBUS_CRC, TM_CRC_CRC16_MODBUS);
+#endif
+	
+	/* Add to list, only once */
+	for (m = MODBUS_First; m != NULL && m != Modbus; m = m->Next);
+	if (m == NULL) {
+		Modbus->Next = MODBUS_First;
+		MODBUS_First = Modbus;
+	}
+	
+	/* Clear received data and enable frame end interrupt */
+	TM_USART_ClearBuffer(USARTx);
+#if defined(USART_CR1_RTOIE)
+	if (Modbus->Timeout) {
+		USARTx->CR1 |= USART_CR1_RTOIE;
+	} else {
+		USARTx->CR1 |= USART_CR1_IDLEIE;
+	}
+#else
+	USARTx->CR1 |= USART_CR1_IDLEIE;
+#endif
+	
+	/* Return OK */
+	return TM_MODBUS_Result_Ok;
+}
+
+TM_MODBUS_Result_t TM_MODBUS_Send(TM_MODBUS_t* Modbus, uint8_t Address, const uint8_t* PDU, uint16_t count) {
+	uint16_t crc;
+	
+	/* Check parameters */
+	if (count == 0 || count > (MODBUS_FRAME_SIZE - 3)) {
+		return TM_MODBUS_Result_Error;
+	}
+	
+	/* Previous frame must be sent */
+	if (Modbus->Transmitting) {
+		return TM_MODBUS_Result_Busy;
+	}
+	
+	/* Build frame, CRC low byte is sent first */
+	Modbus->TXFrame[0] = Address;
+	memcpy(&Modbus->TXFrame[1], PDU, count);
+	crc = TM_MODBUS_CRC(Modbus->TXFrame, count + 1);
+	Modbus->TXFrame[count + 1] = crc & 0xFF;
+	Modbus->TXFrame[count + 2] = crc >> 8;
+	
+	/* Enable driver */
+	Modbus->Transmitting = 1;
+	if (Modbus->DE_Port != NULL) {
+		TM_GPIO_SetPinHigh(Modbus->DE_Port, Modbus->DE_Pin);
+	}
+	
+	/* Send frame */
+	TM_USART_Send(Modbus->USARTx, Modbus->TXFrame, count + 3);
+	
+	/* Release driver after last stop bit */
+	Modbus->USARTx->CR1 |= USART_CR1_TCIE;
+	
+	/* Return OK */
+	return TM_MODBUS_Result_Ok;
+}
+
+uint16_t TM_MODBUS_CRC(const uint8_t* data, uint16_t count) {
+#if defined(CRC_POL_POL)
+	uint32_t irq, crc;
+	
+	/* CRC unit is shared with interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Calculate in hardware */
+	TM_CRC_ContextReset(&MODBUS_CRC);
+	crc = TM_CRC_ContextUpdate(&MODBUS_CRC, data, count);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return CRC */
+	return (uint16_t)crc;
+#else
+	uint16_t crc = 0xFFFF;
+	uint8_t i;
+	
+	/* Calculate in software, reflected polynomial */
+	while (count--) {
+		crc ^= *data++;
+		for (i = 0; i < 8; i++) {
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+		}
+	}
+	
+	/* Return CRC */
+	return crc;
+#endif
+}
+
+/************************************/
+/*    USART INTERRUPT CALLBACKS     */
+/************************************/
+void TM_USART_INT_TXCompleteCallback(USART_TypeDef* USARTx) {
+	TM_MODBUS_t* Modbus = TM_MODBUS_INT_Get(USARTx);
+	
+	/* Disable interrupt, flag stays set until next transmission */
+	USARTx->CR1 &= ~USART_CR1_TCIE;
+	
+	/* Check interface */
+	if (Modbus == NULL) {
+		return;
+	}
+	
+	/* Disable driver */
+	if (Modbus->DE_Port != NULL) {
+		TM_GPIO_SetPinLow(Modbus->DE_Port, Modbus->DE_Pin);
+	}
+	
+	/* Remove local echo and start receiving */
+	TM_USART_ClearBuffer(USARTx);
+	Modbus->Transmitting = 0;
+}
+
+void TM_USART_INT_RXTimeoutCallback(USART_TypeDef* USARTx) {
+	TM_MODBUS_t* Modbus = TM_MODBUS_INT_Get(USARTx);
+	TM_BUFFER_t* Buffer = TM_USART_GetBuffer(USARTx);
+	uint32_t count;
+	
+	/* Check interface */
+	if (Modbus == NULL) {
+		return;
+	}
+	
+	/* Get frame size */
+	count = TM_BUFFER_GetFull(Buffer);
+	if (count == 0) {
+		return;
+	}
+	
+	/* Local echo is removed when transmission is done */
+	if (Modbus->Transmitting) {
+		return;
+	}
+	
+	/* Check frame size */
+	if (count > MODBUS_FRAME_SIZE) {
+		Modbus->Overflows++;
+		TM_USART_ClearBuffer(USARTx);
+		return;
+	}
+	
+	/* Read frame, buffer is empty for next frame */
+	count = TM_BUFFER_Read(Buffer, Modbus->RXFrame, count);
+	
+	/* Check frame size and CRC, CRC over whole frame is 0 */
+	if (count < 4 || TM_MODBUS_CRC(Modbus->RXFrame, count) != 0) {
+		Modbus->CRCErrors++;
+		return;
+	}
+	
+	/* Check address, master receives all frames */
+	if (
+		Modbus->Address != 0 &&
+		Modbus->RXFrame[0] != Modbus->Address &&
+		Modbus->RXFrame[0] != MODBUS_BROADCAST
+	) {
+		return;
+	}
+	
+	/* Frame is valid */
+	Modbus->Frames++;
+	
+	/* Call user callback */
+	TM_MODBUS_FrameCallback(Modbus, Modbus->RXFrame[0], &Modbus->RXFrame[1], count - 3);
+}
+
+/************************************/
+/*         DEFAULT CALLBACKS        */
+/************************************/
+__weak void TM_MODBUS_FrameCallback(TM_MODBUS_t* Modbus, uint8_t Address, uint8_t* PDU, uint16_t count) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_MODBUS_FrameCallback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static TM_MODBUS_t* TM_MODBUS_INT_Get(USART_TypeDef* USARTx) {
+	TM_MODBUS_t* m;
+	
+	/* Find interface for USART */
+	for (m = MODBUS_First; m != NULL; m = m->Next) {
+		if (m->USARTx == USARTx) {
+			break;
+		}
+	}
+	
+	/* Return interface */
+	return m;
+}
@@ -0,0 +1,264 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.1
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Modbus RTU over RS-485 for STM32Fxxx with TM USART
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_MODBUS_H
+#define TM_MODBUS_H 110
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_MODBUS
+ * @brief    Modbus RTU over RS-485 for STM32Fxxx with TM USART
+ * @{
+ *
+ * Library handles Modbus RTU frame layer on top of @ref TM_USART library. Received bytes are stored in USART buffer
+ * as before, end of frame is detected in interrupt and complete frames are passed to @ref TM_MODBUS_FrameCallback.
+ * No polling of USART buffer is needed.
+ *
+ * \par End of frame
+ *
+ * On STM32F0xx and STM32F7xx USARTs with receiver timeout feature, timeout is set to 3.5 characters
+ * (fixed 1.75ms above 19200 bauds), as required by Modbus RTU.
+ * On STM32F4xx and USARTs without receiver timeout, IDLE line interrupt is used, which ends frame after 1 character of silence.
+ *
+ * \par Driver enable
+ *
+ * RS-485 transceiver driver is enabled only while frame is transmitted:
+ *  - When DE GPIO pin is given, pin is set before first byte and cleared in transmission complete interrupt after last stop bit
+ *  - When DE pin is NULL on STM32F0xx and STM32F7xx, USART hardware driver enable on RTS pin is used. Initialize RTS pin as alternate function
+ *    in @ref TM_USART_InitCustomPinsCallback. On other devices no DE pin is used (auto direction transceiver)
+ *
+ * Local echo received during transmission is removed from buffer.
+ *
+ * \par CRC
+ *
+ * CRC-16/MODBUS is calculated with @ref TM_CRC unit on devices with programmable polynomial (STM32F07x, STM32F09x and STM32F7xx),
+ * otherwise in software.
+ *
+\code
+TM_MODBUS_t Modbus;
+
+//Slave with address 0x11 on USART2, 19200 bauds, even parity, DE on PA1
+TM_MODBUS_Init(&Modbus, USART2, TM_USART_PinsPack_1, 19200, USART_PARITY_EVEN, 0x11, GPIOA, GPIO_PIN_1);
+
+//Called from USART interrupt for each valid frame for this slave
+void TM_MODBUS_FrameCallback(TM_MODBUS_t* Modbus, uint8_t Address, uint8_t* PDU, uint16_t count) {
+	//PDU[0] is function code, answer is sent from main loop or here
+	TM_MODBUS_Send(Modbus, Modbus->Address, Answer, AnswerCount);
+}
+\endcode
+ *
+ * @note  Master is initialized with address 0 and receives all frames
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM USART
+ - TM GPIO
+ - TM CRC
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_usart.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_crc.h"
+#include "string.h"
+
+/* Check USART library version */
+#if TM_USART_H < 210
+#error "TM USART library version must be greater or equal to 2.1. Please redownload TM USART library!"
+#endif
+
+/**
+ * @defgroup TM_MODBUS_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Maximal frame size with address and CRC, 256 bytes by Modbus RTU specification */
+#ifndef MODBUS_FRAME_SIZE
+#define MODBUS_FRAME_SIZE        256
+#endif
+
+/* Broadcast address, accepted by all slaves */
+#define MODBUS_BROADCAST         0x00
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_MODBUS_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_MODBUS_Result_Ok = 0x00, /*!< Everything OK */
+	TM_MODBUS_Result_Busy,      /*!< Frame is still transmitting */
+	TM_MODBUS_Result_Error      /*!< Invalid parameters */
+} TM_MODBUS_Result_t;
+
+/**
+ * @brief  Modbus interface structure
+ */
+typedef struct _TM_MODBUS_t {
+	USART_TypeDef* USARTx;              /*!< Pointer to USART */
+	uint8_t Address;                    /*!< Own slave address, 0 for master which receives all frames */
+	GPIO_TypeDef* DE_Port;              /*!< GPIO port for driver enable pin, NULL when not used */
+	uint16_t DE_Pin;                    /*!< GPIO pin for driver enable */
+	uint8_t Timeout;                    /*!< Set to 1 when hardware receiver timeout is used, 0 for IDLE line */
+	volatile uint8_t Transmitting;      /*!< Set to 1 while frame is transmitted */
+	uint32_t Frames;                    /*!< Number of received valid frames */
+	uint32_t CRCErrors;                 /*!< Number of frames with wrong CRC or too short */
+	uint32_t Overflows;                 /*!< Number of frames longer than @ref MODBUS_FRAME_SIZE */
+	uint8_t RXFrame[MODBUS_FRAME_SIZE]; /*!< Last received frame */
+	uint8_t TXFrame[MODBUS_FRAME_SIZE]; /*!< Frame being transmitted */
+	struct _TM_MODBUS_t* Next;          /*!< Next interface, library use only */
+} TM_MODBUS_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_MODBUS_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes USART and Modbus RTU interface
+ * @note   Frame format is 8 data bits with parity and 1 stop bit or without parity and 2 stop bits
+ * @param  *Modbus: Pointer to empty @ref TM_MODBUS_t structure, must stay valid
+ * @param  *USARTx: Pointer to USART to use
+ * @param  pinspack: USART pins, parameter can be a value of @ref TM_USART_PinsPack_t enumeration
+ * @param  baudrate: Baudrate for USART
+ * @param  Parity: Parity, USART_PARITY_NONE, USART_PARITY_EVEN or USART_PARITY_ODD
+ * @param  Address: Own slave address 1 to 247, or 0 for master
+ * @param  *DE_Port: GPIO port for driver enable pin or NULL for hardware driver enable
+ * @param  DE_Pin: GPIO pin for driver enable
+ * @retval Member of @ref TM_MODBUS_Result_t enumeration
+ */
+TM_MODBUS_Result_t TM_MODBUS_Init(TM_MODBUS_t* Modbus, USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, uint32_t baudrate, uint32_t Parity, uint8_t Address, GPIO_TypeDef* DE_Port, uint16_t DE_Pin);
+
+/**
+ * @brief  Sends frame with address and CRC
+ * @note   Function returns when last byte is written to USART, driver is disabled later from interrupt.
+ *         PDU is copied, so it can be reused immediately
+ * @param  *Modbus: Pointer to @ref TM_MODBUS_t structure
+ * @param  Address: Slave address for master or own address for slave
+ * @param  *PDU: Pointer to function code and data
+ * @param  count: Number of bytes in PDU, max @ref MODBUS_FRAME_SIZE - 3
+ * @retval Member of @ref TM_MODBUS_Result_t enumeration
+ */
+TM_MODBUS_Result_t TM_MODBUS_Send(TM_MODBUS_t* Modbus, uint8_t Address, const uint8_t* PDU, uint16_t count);
+
+/**
+ * @brief  Checks if frame is still transmitting
+ * @param  *Modbus: Pointer to @ref TM_MODBUS_t structure
+ * @retval 1 when transmitting, 0 otherwise
+ */
+static __INLINE uint8_t TM_MODBUS_Transmitting(TM_MODBUS_t* Modbus) {
+	return Modbus->Transmitting;
+}
+
+/**
+ * @brief  Calculates CRC-16/MODBUS
+ * @param  *data: Pointer to data
+ * @param  count: Number of bytes
+ * @retval CRC value, low byte is sent first
+ */
+uint16_t TM_MODBUS_CRC(const uint8_t* data, uint16_t count);
+
+/**
+ * @brief  Callback for received valid frame
+ * @note   Called from USART interrupt. For slave, only frames for own and broadcast address are passed
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *Modbus: Pointer to @ref TM_MODBUS_t structure
+ * @param  Address: Address from frame
+ * @param  *PDU: Pointer to function code and data, valid until next frame is received
+ * @param  count: Number of bytes in PDU, without address and CRC
+ * @retval None
+ */
+void TM_MODBUS_FrameCallback(TM_MODBUS_t* Modbus, uint8_t Address, uint8_t* PDU, uint16_t count);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
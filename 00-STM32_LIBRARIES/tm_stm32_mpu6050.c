@@ -31,6 +31,7 @@
 #define MPU6050_GYRO_CONFIG			0x1B
 #define MPU6050_ACCEL_CONFIG		0x1C
 #define MPU6050_MOTION_THRESH		0x1F
+#define MPU6050_FIFO_EN				0x23
 #define MPU6050_INT_PIN_CFG			0x37
 #define MPU6050_INT_ENABLE			0x38
 #define MPU6050_INT_STATUS			0x3A
@@ -71,6 +72,20 @@
 #define MPU6050_ACCE_SENS_8			((float) 4096)
 #define MPU6050_ACCE_SENS_16		((float) 2048)
 
+/* FIFO bits */
+#define MPU6050_FIFO_EN_ACCEL_GYRO	0x78
+#define MPU6050_USER_CTRL_FIFO_EN	0x40
+#define MPU6050_USER_CTRL_FIFO_RST	0x04
+#define MPU6050_INT_PIN_CFG_LATCH	0x20
+#define MPU6050_FIFO_SIZE			1024
+
+static void TM_MPU6050_INT_ConvertAxis(int16_t* src, float* dst, uint16_t count, float mult, int16_t offset, uint8_t RemoveMean);
+#if I2C_QUEUE_SIZE > 0
+static void TM_MPU6050_INT_FifoCountDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+static void TM_MPU6050_INT_FifoDataDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+static void TM_MPU6050_INT_FifoResetDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+#endif
+
 
 TM_MPU6050_Result_t TM_MPU6050_Init(TM_MPU6050_t* DataStruct, TM_MPU6050_Device_t DeviceNumber, TM_MPU6050_Accelerometer_t AccelerometerSensitivity, TM_MPU6050_Gyroscope_t GyroscopeSensitivity) {
 	uint8_t temp;
@@ -293,3 +308,264 @@ TM_MPU6050_Result_t TM_MPU6050_ReadAll(TM_MPU6050_t* DataStruct) {
 	/* Return OK */
 	return TM_MPU6050_Result_Ok;
 }
+
+#if MPU6050_USE_SERIES
+TM_MPU6050_Result_t TM_MPU6050_ReadSeries(TM_MPU6050_t* DataStruct, TM_SERIES_t* Series, uint16_t Row, uint8_t Channel) {
+	/* Check channels */
+	if ((uint16_t)Channel + 6 > Series->ChannelCount) {
+		return TM_MPU6050_Result_Error;
+	}
+	
+	/* Read all data */
+	if (TM_MPU6050_ReadAll(DataStruct) != TM_MPU6050_Result_Ok) {
+		return TM_MPU6050_Result_Error;
+	}
+	
+	/* Save raw values, each axis to own column */
+	TM_SERIES_SET(Series, Row, Channel, DataStruct->Accelerometer_X);
+	TM_SERIES_SET(Series, Row, Channel + 1, DataStruct->Accelerometer_Y);
+	TM_SERIES_SET(Series, Row, Channel + 2, DataStruct->Accelerometer_Z);
+	TM_SERIES_SET(Series, Row, Channel + 3, DataStruct->Gyroscope_X);
+	TM_SERIES_SET(Series, Row, Channel + 4, DataStruct->Gyroscope_Y);
+	TM_SERIES_SET(Series, Row, Channel + 5, DataStruct->Gyroscope_Z);
+	
+	/* Return OK */
+	return TM_MPU6050_Result_Ok;
+}
+#endif
+
+TM_MPU6050_Result_t TM_MPU6050_ConvertBatch(TM_MPU6050_t* DataStruct, TM_MPU6050_Batch_t* Batch, TM_MPU6050_BatchFloat_t* Output, TM_MPU6050_Calibration_t* Calibration, uint8_t RemoveMean) {
+	TM_MPU6050_Calibration_t none = {0, 0, 0, 0, 0, 0};
+	uint16_t count = Batch->Count;
+	
+	/* Check samples */
+	if (count == 0) {
+		return TM_MPU6050_Result_Error;
+	}
+	
+	/* No calibration */
+	if (Calibration == NULL) {
+		Calibration = &none;
+	}
+	
+	/* Convert each axis */
+	TM_MPU6050_INT_ConvertAxis(Batch->Accelerometer_X, Output->Accelerometer_X, count, DataStruct->Acce_Mult, Calibration->Accelerometer_X, RemoveMean);
+	TM_MPU6050_INT_ConvertAxis(Batch->Accelerometer_Y, Output->Accelerometer_Y, count, DataStruct->Acce_Mult, Calibration->Accelerometer_Y, RemoveMean);
+	TM_MPU6050_INT_ConvertAxis(Batch->Accelerometer_Z, Output->Accelerometer_Z, count, DataStruct->Acce_Mult, Calibration->Accelerometer_Z, RemoveMean);
+	TM_MPU6050_INT_ConvertAxis(Batch->Gyroscope_X, Output->Gyroscope_X, count, DataStruct->Gyro_Mult, Calibration->Gyroscope_X, RemoveMean);
+	TM_MPU6050_INT_ConvertAxis(Batch->Gyroscope_Y, Output->Gyroscope_Y, count, DataStruct->Gyro_Mult, Calibration->Gyroscope_Y, RemoveMean);
+	TM_MPU6050_INT_ConvertAxis(Batch->Gyroscope_Z, Output->Gyroscope_Z, count, DataStruct->Gyro_Mult, Calibration->Gyroscope_Z, RemoveMean);
+	
+	/* Return OK */
+	return TM_MPU6050_Result_Ok;
+}
+
+/* Private functions */
+static void TM_MPU6050_INT_ConvertAxis(int16_t* src, float* dst, uint16_t count, float mult, int16_t offset, uint8_t RemoveMean) {
+#if MPU6050_USE_ARM_MATH
+	float32_t mean;
+	
+	/* Raw value is Q15 number, convert and scale back to physical units */
+	arm_q15_to_float((q15_t *)src, dst, count);
+	arm_scale_f32(dst, mult * (float32_t)32768, dst, count);
+	
+	/* Remove calibration offset */
+	if (offset) {
+		arm_offset_f32(dst, -(float32_t)offset * mult, dst, count);
+	}
+	
+	/* Remove mean value */
+	if (RemoveMean) {
+		arm_mean_f32(dst, count, &mean);
+		arm_offset_f32(dst, -mean, dst, count);
+	}
+#else
+	float sub;
+	int32_t sum = 0;
+	uint16_t i;
+	
+	/* Sum for mean value */
+	if (RemoveMean) {
+		for (i = 0; i < count; i++) {
+			sum += src[i];
+		}
+	}
+	
+	/* Value subtracted from each sample in raw units */
+	sub = (float)offset;
+	if (RemoveMean) {
+		sub = (float)sum / (float)count;
+	}
+	
+	/* Convert */
+	for (i = 0; i < count; i++) {
+		dst[i] = ((float)src[i] - sub) * mult;
+	}
+#endif
+}
+
+#if I2C_QUEUE_SIZE > 0
+TM_MPU6050_Result_t TM_MPU6050_EnableFifo(TM_MPU6050_t* DataStruct, TM_MPU6050_Fifo_t* Fifo, TM_MPU6050_Batch_t* Batch, uint16_t Watermark) {
+	uint8_t temp;
+	
+	/* Check watermark */
+	if (Watermark == 0 || Watermark > MPU6050_FIFO_MAX_SAMPLES) {
+		return TM_MPU6050_Result_Error;
+	}
+	
+	/* Fill structure */
+	Fifo->Device = DataStruct;
+	Fifo->Batch = Batch;
+	Fifo->Watermark = Watermark;
+	Fifo->Pending = 0;
+	Fifo->Busy = 0;
+	Fifo->Overflows = 0;
+	Fifo->Dropped = 0;
+	Fifo->Errors = 0;
+	
+	/* Disable and reset FIFO */
+	TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_RST);
+	
+	/* Accelerometer and gyroscope data go to FIFO */
+	if (TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO) != TM_I2C_Result_Ok) {
+		/* Return error */
+		return TM_MPU6050_Result_Error;
+	}
+	
+	/* Interrupt pin pulses for each sample, no need to clear it */
+	TM_I2C_Read(MPU6050_I2C, DataStruct->Address, MPU6050_INT_PIN_CFG, &temp);
+	temp &= ~MPU6050_INT_PIN_CFG_LATCH;
+	TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_INT_PIN_CFG, temp);
+	
+	/* Enable data ready interrupt */
+	TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_INT_ENABLE, 0x01);
+	
+	/* Enable FIFO */
+	TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+	
+	/* Return OK */
+	return TM_MPU6050_Result_Ok;
+}
+
+TM_MPU6050_Result_t TM_MPU6050_DisableFifo(TM_MPU6050_t* DataStruct) {
+	/* Disable interrupts */
+	TM_MPU6050_DisableInterrupts(DataStruct);
+	
+	/* Disable FIFO */
+	TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_FIFO_EN, 0x00);
+	if (TM_I2C_Write(MPU6050_I2C, DataStruct->Address, MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_RST) != TM_I2C_Result_Ok) {
+		/* Return error */
+		return TM_MPU6050_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_MPU6050_Result_Ok;
+}
+
+void TM_MPU6050_FifoIRQHandler(TM_MPU6050_Fifo_t* Fifo) {
+	/* Count samples until watermark is reached */
+	if (++Fifo->Pending < Fifo->Watermark || Fifo->Busy) {
+		return;
+	}
+	
+	/* Start burst, first read number of bytes in FIFO */
+	Fifo->Pending = 0;
+	Fifo->Busy = 1;
+	if (!TM_I2C_ReadMultiQueued(MPU6050_I2C, Fifo->Device->Address, MPU6050_FIFO_COUNTH, Fifo->FifoCount, 2, TM_MPU6050_INT_FifoCountDone, Fifo)) {
+		/* Queue full, try on next sample */
+		Fifo->Busy = 0;
+	}
+}
+
+__weak void TM_MPU6050_FifoCallback(TM_MPU6050_Fifo_t* Fifo, uint16_t samples) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_MPU6050_FifoCallback could be implemented in the user file
+	*/
+}
+
+static void TM_MPU6050_INT_FifoCountDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_MPU6050_Fifo_t* Fifo = (TM_MPU6050_Fifo_t *)Param;
+	uint16_t samples;
+	
+	/* Check transaction */
+	if (result != TM_I2C_Result_Ok) {
+		Fifo->Errors++;
+		Fifo->Busy = 0;
+		return;
+	}
+	
+	/* Get number of bytes in FIFO */
+	samples = (uint16_t)(data[0] << 8 | data[1]);
+	
+	/* FIFO overflow, data are not aligned to samples anymore, reset FIFO */
+	if (samples >= MPU6050_FIFO_SIZE) {
+		Fifo->Overflows++;
+		Fifo->Ctrl = MPU6050_USER_CTRL_FIFO_EN | MPU6050_USER_CTRL_FIFO_RST;
+		if (!TM_I2C_WriteMultiQueued(I2Cx, device_address, MPU6050_USER_CTRL, &Fifo->Ctrl, 1, TM_MPU6050_INT_FifoResetDone, Fifo)) {
+			Fifo->Busy = 0;
+		}
+		return;
+	}
+	
+	/* Get number of complete samples */
+	samples /= MPU6050_FIFO_SAMPLE_SIZE;
+	if (samples > MPU6050_FIFO_MAX_SAMPLES) {
+		samples = MPU6050_FIFO_MAX_SAMPLES;
+	}
+	
+	/* Read all samples in one burst */
+	if (samples == 0 || !TM_I2C_ReadMultiQueued(I2Cx, device_address, MPU6050_FIFO_R_W, Fifo->Buffer, samples * MPU6050_FIFO_SAMPLE_SIZE, TM_MPU6050_INT_FifoDataDone, Fifo)) {
+		Fifo->Busy = 0;
+	}
+}
+
+static void TM_MPU6050_INT_FifoDataDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_MPU6050_Fifo_t* Fifo = (TM_MPU6050_Fifo_t *)Param;
+	TM_MPU6050_Batch_t* Batch = Fifo->Batch;
+	uint16_t samples, i, pos;
+	
+	/* Burst done */
+	Fifo->Busy = 0;
+	
+	/* Check transaction */
+	if (result != TM_I2C_Result_Ok) {
+		Fifo->Errors++;
+		return;
+	}
+	
+	/* Get number of samples to unpack */
+	samples = count / MPU6050_FIFO_SAMPLE_SIZE;
+	if (samples > (uint16_t)(Batch->Size - Batch->Count)) {
+		Fifo->Dropped += samples - (Batch->Size - Batch->Count);
+		samples = Batch->Size - Batch->Count;
+	}
+	
+	/* Unpack samples, same order as in data registers */
+	pos = Batch->Count;
+	for (i = 0; i < samples; i++, pos++, data += MPU6050_FIFO_SAMPLE_SIZE) {
+		Batch->Accelerometer_X[pos] = (int16_t)(data[0] << 8 | data[1]);
+		Batch->Accelerometer_Y[pos] = (int16_t)(data[2] << 8 | data[3]);
+		Batch->Accelerometer_Z[pos] = (int16_t)(data[4] << 8 | data[5]);
+		Batch->Gyroscope_X[pos] = (int16_t)(data[6] << 8 | data[7]);
+		Batch->Gyroscope_Y[pos] = (int16_t)(data[8] << 8 | data[9]);
+		Batch->Gyroscope_Z[pos] = (int16_t)(data[10] << 8 | data[11]);
+	}
+	Batch->Count = pos;
+	
+	/* Call user function */
+	TM_MPU6050_FifoCallback(Fifo, samples);
+}
+
+static void TM_MPU6050_INT_FifoResetDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_MPU6050_Fifo_t* Fifo = (TM_MPU6050_Fifo_t *)Param;
+	
+	/* Check transaction */
+	if (result != TM_I2C_Result_Ok) {
+		Fifo->Errors++;
+	}
+	
+	/* FIFO is empty now */
+	Fifo->Pending = 0;
+	Fifo->Busy = 0;
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/10/hal-library-30-mpu6050-for-stm32fxxx
- * @version v1.0
+ * @version v1.2
  * @ide     Keil uVision
  * @license MIT
  * @brief   MPU6050 library for STM32Fxxx devices
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_MPU6050_H
-#define TM_MPU6050_H 100
+#define TM_MPU6050_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -54,6 +54,8 @@ extern "C" {
 - Set custom output data rate for measurements
 - Enable/disable interrupts
 - Up to 2 MPU devices at a time
+- Burst acquisition through sensor FIFO
+- Batch conversion of samples to physical units
 \endverbatim
  *
  * \par MPU6050 interrupts
@@ -80,6 +82,51 @@ extern "C" {
  *
  * \note  There are already some predefined constants in library for some "standard" data rates
  *
+ * \par FIFO burst acquisition
+ *
+ * For high data rates, sensor can buffer accelerometer and gyroscope samples to internal 1024 bytes FIFO.
+ * Each sample is 12 bytes long, so sensor can hold up to 85 samples.
+ *
+ * MPU6050 has no FIFO watermark interrupt, so library counts DataReady interrupt pulses instead.
+ * Call @ref TM_MPU6050_FifoIRQHandler from your EXTI interrupt for MPU IRQ pin (rising edge).
+ * When watermark number of samples is reached, library reads FIFO count and then all samples in single burst,
+ * using @ref TM_I2C transaction queue. If DMA is linked to I2C handle, burst is done with DMA.
+ * Samples are unpacked to user arrays in @ref TM_MPU6050_Batch_t structure (separate array for each axis)
+ * and @ref TM_MPU6050_FifoCallback is called after each burst.
+ *
+ * Transaction queue must be enabled in TM I2C library, open defines.h file and add:
+ *
+\code
+//Enable I2C transaction queue
+#define I2C_QUEUE_SIZE             4
+//Max number of samples in one FIFO burst, default 32
+#define MPU6050_FIFO_MAX_SAMPLES   32
+\endcode
+ *
+ * \note  Gyroscope output rate is 8 kHz only when digital low pass filter is disabled, accelerometer output rate is always 1 kHz.
+ *         At higher sample rates, accelerometer values in FIFO are repeated.
+ * \note  Each sample needs 12 bytes on I2C bus, at 400 kHz bus clock about 3.5 kHz is maximal sustainable sample rate.
+ *
+ * \par Batch conversion
+ *
+ * Samples in @ref TM_MPU6050_Batch_t can be converted to "g" and "degrees/s" at once with @ref TM_MPU6050_ConvertBatch.
+ * Optional calibration offsets in raw units are subtracted and mean value of batch can be removed from each axis.
+ *
+ * Conversion can use ARM CMSIS MATH library (see @ref TM_FFT for setup). Raw values are used as Q15 numbers,
+ * converted with arm_q15_to_float and scaled with arm_scale_f32 over whole arrays.
+ * To enable it, open defines.h file and add define:
+ *
+\code
+//Use ARM MATH for batch conversion
+#define MPU6050_USE_ARM_MATH    1
+\endcode
+ *
+ * \par Series store
+ *
+ * With MPU6050_USE_SERIES set to 1 in defines.h file, @ref TM_MPU6050_ReadSeries writes raw accelerometer
+ * and gyroscope values to 6 consecutive channels of @ref TM_SERIES store, in order Ax, Ay, Az, Gx, Gy, Gz.
+ * Channel scale is LSB per unit for selected range, for example 16384 for +-2g and 131 for +-250 degrees/s.
+ *
  * \par Default pinout
  * 
 @verbatim
@@ -107,6 +154,18 @@ MPU6050_I2C_PINSPACK      TM_I2C_PinsPack_1
 @verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added FIFO burst acquisition with interrupt driven I2C transfers
+  
+ Version 1.2
+  - October 14, 2026
+  - Added TM_MPU6050_ConvertBatch function with optional ARM MATH support
+  
+ Version 1.3
+  - October 14, 2026
+  - Added TM_MPU6050_ReadSeries function for TM SERIES store
 @endverbatim
  *
  * \par Dependencies
@@ -115,6 +174,8 @@ MPU6050_I2C_PINSPACK      TM_I2C_PinsPack_1
  - STM32Fxxx HAL
  - defines.h
  - TM I2C
+ - ARM MATH, if MPU6050_USE_ARM_MATH is enabled
+ - TM SERIES, if MPU6050_USE_SERIES is enabled
 @endverbatim
  */
 
@@ -122,6 +183,24 @@ MPU6050_I2C_PINSPACK      TM_I2C_PinsPack_1
 #include "defines.h"
 #include "tm_stm32_i2c.h"
 
+/* Use ARM MATH for batch conversion */
+#ifndef MPU6050_USE_ARM_MATH
+#define MPU6050_USE_ARM_MATH           0
+#endif
+
+#if MPU6050_USE_ARM_MATH
+#include "arm_math.h"
+#endif
+
+/* Series store support */
+#ifndef MPU6050_USE_SERIES
+#define MPU6050_USE_SERIES             0
+#endif
+
+#if MPU6050_USE_SERIES
+#include "tm_stm32_series.h"
+#endif
+
 /**
  * @defgroup TM_MPU6050_Macros
  * @brief    Library defines
@@ -154,6 +233,19 @@ MPU6050_I2C_PINSPACK      TM_I2C_PinsPack_1
 /**
  * @}
  */
+
+/* Max number of samples read in one FIFO burst */
+#ifndef MPU6050_FIFO_MAX_SAMPLES
+#define MPU6050_FIFO_MAX_SAMPLES       32
+#endif
+
+/* Number of bytes for one sample in FIFO, accelerometer and gyroscope */
+#define MPU6050_FIFO_SAMPLE_SIZE       12
+
+/* Check FIFO size, sensor FIFO is 1024 bytes */
+#if MPU6050_FIFO_MAX_SAMPLES < 1 || MPU6050_FIFO_MAX_SAMPLES > 85
+#error "MPU6050_FIFO_MAX_SAMPLES must be between 1 and 85"
+#endif
  
 /**
  * @}
@@ -238,6 +330,65 @@ typedef union _TM_MPU6050_Interrupt_t {
 	uint8_t Status;
 } TM_MPU6050_Interrupt_t;
 
+/**
+ * @brief  Batch of samples, stored as separate arrays for each axis
+ * @note   Arrays are provided by user and must have at least Size elements
+ */
+typedef struct _TM_MPU6050_Batch_t {
+	int16_t* Accelerometer_X; /*!< Accelerometer X axis samples */
+	int16_t* Accelerometer_Y; /*!< Accelerometer Y axis samples */
+	int16_t* Accelerometer_Z; /*!< Accelerometer Z axis samples */
+	int16_t* Gyroscope_X;     /*!< Gyroscope X axis samples */
+	int16_t* Gyroscope_Y;     /*!< Gyroscope Y axis samples */
+	int16_t* Gyroscope_Z;     /*!< Gyroscope Z axis samples */
+	uint16_t Size;            /*!< Number of elements in each array */
+	volatile uint16_t Count;  /*!< Number of samples stored. Set to 0 by user when samples are processed */
+} TM_MPU6050_Batch_t;
+
+/**
+ * @brief  Batch of converted samples, stored as separate arrays for each axis
+ * @note   Arrays are provided by user and must have at least as many elements as converted batch
+ */
+typedef struct _TM_MPU6050_BatchFloat_t {
+	float* Accelerometer_X; /*!< Accelerometer X axis in "g" */
+	float* Accelerometer_Y; /*!< Accelerometer Y axis in "g" */
+	float* Accelerometer_Z; /*!< Accelerometer Z axis in "g" */
+	float* Gyroscope_X;     /*!< Gyroscope X axis in "degrees/s" */
+	float* Gyroscope_Y;     /*!< Gyroscope Y axis in "degrees/s" */
+	float* Gyroscope_Z;     /*!< Gyroscope Z axis in "degrees/s" */
+} TM_MPU6050_BatchFloat_t;
+
+/**
+ * @brief  Calibration offsets in raw units, subtracted from raw values before conversion
+ */
+typedef struct _TM_MPU6050_Calibration_t {
+	int16_t Accelerometer_X; /*!< Accelerometer X axis offset */
+	int16_t Accelerometer_Y; /*!< Accelerometer Y axis offset */
+	int16_t Accelerometer_Z; /*!< Accelerometer Z axis offset */
+	int16_t Gyroscope_X;     /*!< Gyroscope X axis offset */
+	int16_t Gyroscope_Y;     /*!< Gyroscope Y axis offset */
+	int16_t Gyroscope_Z;     /*!< Gyroscope Z axis offset */
+} TM_MPU6050_Calibration_t;
+
+/**
+ * @brief  FIFO acquisition structure
+ */
+typedef struct _TM_MPU6050_Fifo_t {
+	/* Private */
+	TM_MPU6050_t* Device;                  /*!< Pointer to device. Only for private use */
+	uint16_t Watermark;                    /*!< Number of samples to start burst. Only for private use */
+	volatile uint16_t Pending;             /*!< Samples since last burst. Only for private use */
+	volatile uint8_t Busy;                 /*!< Burst in progress. Only for private use */
+	uint8_t Ctrl;                          /*!< Value for user control register write. Only for private use */
+	uint8_t FifoCount[2];                  /*!< FIFO count register value. Only for private use */
+	uint8_t Buffer[MPU6050_FIFO_MAX_SAMPLES * MPU6050_FIFO_SAMPLE_SIZE]; /*!< Raw burst data. Only for private use */
+	/* Public */
+	TM_MPU6050_Batch_t* Batch;             /*!< Pointer to batch where samples are unpacked */
+	uint32_t Overflows;                    /*!< Number of sensor FIFO overflows */
+	uint32_t Dropped;                      /*!< Number of samples dropped because batch was full */
+	uint32_t Errors;                       /*!< Number of failed I2C transactions */
+} TM_MPU6050_Fifo_t;
+
 /**
  * @}
  */
@@ -347,6 +498,71 @@ TM_MPU6050_Result_t TM_MPU6050_ReadTemperature(TM_MPU6050_t* DataStruct);
  */
 TM_MPU6050_Result_t TM_MPU6050_ReadAll(TM_MPU6050_t* DataStruct);
 
+#if MPU6050_USE_SERIES || defined(DOXYGEN)
+/**
+ * @brief  Reads accelerometer and gyroscope data from sensor directly to row of series store
+ * @note   Raw values are saved to 6 channels from Channel on, in order Ax, Ay, Az, Gx, Gy, Gz
+ * @note   Available when MPU6050_USE_SERIES is enabled
+ * @param  *DataStruct: Pointer to @ref TM_MPU6050_t structure
+ * @param  *Series: Pointer to @ref TM_SERIES_t store
+ * @param  Row: Row index from @ref TM_SERIES_AddRow
+ * @param  Channel: Channel index for accelerometer X axis
+ * @retval Member of @ref TM_MPU6050_Result_t:
+ *            - TM_MPU6050_Result_Ok: everything is OK
+ *            - Other: in other cases
+ */
+TM_MPU6050_Result_t TM_MPU6050_ReadSeries(TM_MPU6050_t* DataStruct, TM_SERIES_t* Series, uint16_t Row, uint8_t Channel);
+#endif
+
+/**
+ * @brief  Converts batch of raw samples to "g" and "degrees/s"
+ * @param  *DataStruct: Pointer to @ref TM_MPU6050_t structure indicating MPU6050 device with sensitivities used
+ * @param  *Batch: Pointer to @ref TM_MPU6050_Batch_t structure with raw samples. Batch->Count samples are converted
+ * @param  *Output: Pointer to @ref TM_MPU6050_BatchFloat_t structure with user arrays for converted samples
+ * @param  *Calibration: Pointer to @ref TM_MPU6050_Calibration_t structure with offsets. Set to NULL if not used
+ * @param  RemoveMean: Set to 1 to subtract mean value of batch from each axis, useful for vibration analysis
+ * @retval Member of @ref TM_MPU6050_Result_t enumeration
+ */
+TM_MPU6050_Result_t TM_MPU6050_ConvertBatch(TM_MPU6050_t* DataStruct, TM_MPU6050_Batch_t* Batch, TM_MPU6050_BatchFloat_t* Output, TM_MPU6050_Calibration_t* Calibration, uint8_t RemoveMean);
+
+/**
+ * @brief  Enables FIFO for accelerometer and gyroscope and DataReady interrupt pulses
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *DataStruct: Pointer to @ref TM_MPU6050_t structure indicating MPU6050 device
+ * @param  *Fifo: Pointer to empty @ref TM_MPU6050_Fifo_t structure
+ * @param  *Batch: Pointer to @ref TM_MPU6050_Batch_t structure with user arrays for samples
+ * @param  Watermark: Number of samples to start FIFO burst read, up to MPU6050_FIFO_MAX_SAMPLES
+ * @retval Member of @ref TM_MPU6050_Result_t enumeration
+ */
+TM_MPU6050_Result_t TM_MPU6050_EnableFifo(TM_MPU6050_t* DataStruct, TM_MPU6050_Fifo_t* Fifo, TM_MPU6050_Batch_t* Batch, uint16_t Watermark);
+
+/**
+ * @brief  Disables FIFO and interrupts
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *DataStruct: Pointer to @ref TM_MPU6050_t structure indicating MPU6050 device
+ * @retval Member of @ref TM_MPU6050_Result_t enumeration
+ */
+TM_MPU6050_Result_t TM_MPU6050_DisableFifo(TM_MPU6050_t* DataStruct);
+
+/**
+ * @brief  Handles DataReady interrupt pulse from sensor
+ * @note   Call this function from EXTI interrupt for MPU6050 IRQ pin
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0
+ * @param  *Fifo: Pointer to @ref TM_MPU6050_Fifo_t structure
+ * @retval None
+ */
+void TM_MPU6050_FifoIRQHandler(TM_MPU6050_Fifo_t* Fifo);
+
+/**
+ * @brief  Called when FIFO burst is finished and samples are unpacked to batch
+ * @note   Called from I2C interrupt
+ * @param  *Fifo: Pointer to @ref TM_MPU6050_Fifo_t structure
+ * @param  samples: Number of new samples added to batch
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_MPU6050_FifoCallback(TM_MPU6050_Fifo_t* Fifo, uint16_t samples);
+
 /**
  * @}
  */
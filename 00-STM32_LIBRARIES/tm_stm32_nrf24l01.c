@@ -151,6 +151,11 @@
 #define NRF24L01_DPL_P4			4
 #define NRF24L01_DPL_P5			5
 
+/* Feature register */
+#define NRF24L01_EN_DPL			2
+#define NRF24L01_EN_ACK_PAY		1
+#define NRF24L01_EN_DYN_ACK		0
+
 /* Transmitter power*/
 #define NRF24L01_M18DBM			0 //-18 dBm
 #define NRF24L01_M12DBM			1 //-12 dBm
@@ -177,6 +182,8 @@
 #define NRF24L01_REUSE_TX_PL_MASK			0xE3
 #define NRF24L01_ACTIVATE_MASK				0x50 
 #define NRF24L01_R_RX_PL_WID_MASK			0x60
+#define NRF24L01_W_ACK_PAYLOAD_MASK			0xA8 //Last 3 bits will indicate pipe
+#define NRF24L01_W_TX_PAYLOAD_NOACK_MASK	0xB0
 #define NRF24L01_NOP_MASK					0xFF
 
 /* Flush FIFOs */
@@ -188,13 +195,78 @@
 
 #define NRF24L01_CHECK_BIT(reg, bit)       (reg & (1 << bit))
 
+#if NRF24L01_USE_IRQ
+/* Interrupt flags in status register */
+#define NRF24L01_IRQ_FLAGS					0x70
+
+/* Interrupt mode SPI transfer states */
+typedef enum {
+	TM_NRF24L01_INT_State_Idle = 0x00, /* No SPI transfer */
+	TM_NRF24L01_INT_State_Status,      /* Reading status and FIFO status registers */
+	TM_NRF24L01_INT_State_Clear,       /* Clearing interrupt flags */
+	TM_NRF24L01_INT_State_FlushTx,     /* Flushing TX FIFO */
+	TM_NRF24L01_INT_State_FlushRx,     /* Flushing RX FIFO after invalid payload length */
+	TM_NRF24L01_INT_State_ReadWidth,   /* Reading dynamic payload length */
+	TM_NRF24L01_INT_State_ReadPayload, /* Reading payload from RX FIFO */
+	TM_NRF24L01_INT_State_WritePayload,/* Writing payload to TX FIFO */
+	TM_NRF24L01_INT_State_WriteAck,    /* Writing ACK payload to TX FIFO */
+	TM_NRF24L01_INT_State_Mode         /* Switching between RX and TX mode */
+} TM_NRF24L01_INT_State_t;
+
+/* Payload in software TX queue, RX buffers and ACK payloads */
+typedef struct {
+	uint8_t Length;
+	uint8_t NoAck;
+	uint8_t Data[32];
+} TM_NRF24L01_INT_Payload_t;
+
+/* RX buffer of one pipe */
+typedef struct {
+	TM_NRF24L01_INT_Payload_t Queue[NRF24L01_RX_QUEUE_SIZE];
+	volatile uint16_t In, Out, Count;
+} TM_NRF24L01_INT_Pipe_t;
+
+/* Interrupt mode structure */
+typedef struct {
+	volatile TM_NRF24L01_INT_State_t State; /* Current SPI transfer */
+	volatile uint8_t Pending;               /* Status has to be read again after current transfer */
+	uint8_t Status;                         /* Last status register value */
+	uint8_t FifoStatus;                     /* Last FIFO status register value */
+	uint8_t TxMode;                         /* Set when module is in TX mode */
+	uint16_t Prescaler;                     /* SPI prescaler for DMA jobs */
+	uint8_t TX_Buffer[33];                  /* SPI DMA TX data, command and payload */
+	uint8_t RX_Buffer[33];                  /* SPI DMA RX data, status and payload */
+	TM_NRF24L01_INT_Payload_t TxQueue[NRF24L01_TX_QUEUE_SIZE];
+	volatile uint16_t TxIn, TxOut, TxCount;
+	TM_NRF24L01_INT_Pipe_t Pipes[NRF24L01_PIPES];
+	uint8_t NextPipe;                       /* First pipe checked in TM_NRF24L01_IRQ_GetData */
+	TM_NRF24L01_INT_Payload_t Ack[NRF24L01_PIPES];
+	volatile uint8_t AckPending;            /* Bit for each pipe with ACK payload to write */
+	volatile uint32_t Lost;                 /* Number of lost payloads */
+} TM_NRF24L01_INT_IRQ_t;
+#endif
+
 typedef struct {
 	uint8_t PayloadSize;				//Payload size
 	uint8_t Channel;					//Channel selected
 	TM_NRF24L01_OutputPower_t OutPwr;	//Output power
 	TM_NRF24L01_DataRate_t DataRate;	//Data rate
+	uint8_t DynamicPayload;				//Dynamic payload length enabled
 } TM_NRF24L01_t;
 
+/* Frequency hopping structure */
+typedef struct {
+	uint8_t Table[NRF24L01_HOP_CHANNELS];    /* Channels in hopping order */
+	uint8_t Count;                           /* Number of channels in table */
+	uint8_t Index;                           /* Table entry used in current slot */
+	uint32_t Slot;                           /* Current slot number */
+	volatile uint32_t Ticks;                 /* Slots counted by timer, not yet processed */
+	uint32_t Blacklist;                      /* Bit for each blacklisted table entry */
+	uint16_t Penalty[NRF24L01_HOP_CHANNELS]; /* Slots until blacklisted entry is released, 0 when set by user */
+	uint8_t Sent[NRF24L01_HOP_CHANNELS];     /* Payloads sent in current window */
+	uint16_t Retr[NRF24L01_HOP_CHANNELS];    /* Retransmissions in current window */
+} TM_NRF24L01_INT_Hop_t;
+
 /* Private functions */
 void TM_NRF24L01_InitPins(void);
 void TM_NRF24L01_WriteBit(uint8_t reg, uint8_t bit, uint8_t value);
@@ -204,10 +276,31 @@ void TM_NRF24L01_ReadRegisterMulti(uint8_t reg, uint8_t* data, uint8_t count);
 void TM_NRF24L01_WriteRegisterMulti(uint8_t reg, uint8_t *data, uint8_t count);
 void TM_NRF24L01_SoftwareReset(void);
 uint8_t TM_NRF24L01_RxFifoEmpty(void);
+static uint8_t TM_NRF24L01_INT_HopIndex(uint32_t slot);
+static void TM_NRF24L01_INT_HopTune(void);
+static uint8_t TM_NRF24L01_INT_HopBlacklist(uint8_t index);
 
 /* NRF structure */
 static TM_NRF24L01_t TM_NRF24L01_Struct;
 
+/* Frequency hopping structure */
+static TM_NRF24L01_INT_Hop_t TM_NRF24L01_HopStruct;
+
+#if NRF24L01_USE_IRQ
+/* Interrupt mode structure */
+static TM_NRF24L01_INT_IRQ_t TM_NRF24L01_IRQ;
+
+/* Private interrupt mode functions */
+static void TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_t state, uint8_t count);
+static void TM_NRF24L01_INT_ReadStatus(void);
+static void TM_NRF24L01_INT_ReadPayload(uint8_t length);
+static void TM_NRF24L01_INT_Push(uint8_t pipe, uint8_t* data, uint8_t length);
+static void TM_NRF24L01_INT_Next(void);
+static void TM_NRF24L01_INT_Kick(void);
+static void TM_NRF24L01_INT_SPICallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param);
+static void TM_NRF24L01_INT_EXTICallback(uint16_t GPIO_Pin, void* Param);
+#endif
+
 void TM_NRF24L01_InitPins(void) {
 	/* Init pins */
 	/* CNS pin */
@@ -240,6 +333,7 @@ uint8_t TM_NRF24L01_Init(uint8_t channel, uint8_t payload_size) {
 	TM_NRF24L01_Struct.PayloadSize = payload_size;
 	TM_NRF24L01_Struct.OutPwr = TM_NRF24L01_OutputPower_0dBm;
 	TM_NRF24L01_Struct.DataRate = TM_NRF24L01_DataRate_2M;
+	TM_NRF24L01_Struct.DynamicPayload = 0;
 	
 	/* Reset nRF24L01+ to power on registers values */
 	TM_NRF24L01_SoftwareReset();
@@ -298,6 +392,64 @@ void TM_NRF24L01_SetTxAddress(uint8_t *adr) {
 	TM_NRF24L01_WriteRegisterMulti(NRF24L01_REG_TX_ADDR, adr, 5);
 }
 
+uint8_t TM_NRF24L01_SetPipeAddress(uint8_t pipe, uint8_t* adr) {
+	/* Check pipe */
+	if (pipe >= NRF24L01_PIPES) {
+		return 0;
+	}
+	
+	NRF24L01_CE_LOW;
+	if (pipe < 2) {
+		/* Full address for pipes 0 and 1 */
+		TM_NRF24L01_WriteRegisterMulti(NRF24L01_REG_RX_ADDR_P0 + pipe, adr, 5);
+	} else {
+		/* Only LSB byte for other pipes */
+		TM_NRF24L01_WriteRegister(NRF24L01_REG_RX_ADDR_P0 + pipe, adr[0]);
+	}
+	
+	/* Enable pipe */
+	TM_NRF24L01_WriteBit(NRF24L01_REG_EN_RXADDR, pipe, 1);
+	NRF24L01_CE_HIGH;
+	
+	/* Return OK */
+	return 1;
+}
+
+void TM_NRF24L01_EnablePipe(uint8_t pipe, uint8_t enable) {
+	if (pipe < NRF24L01_PIPES) {
+		TM_NRF24L01_WriteBit(NRF24L01_REG_EN_RXADDR, pipe, enable);
+	}
+}
+
+void TM_NRF24L01_SetDynamicPayload(uint8_t enable) {
+	/* Save setting */
+	TM_NRF24L01_Struct.DynamicPayload = enable ? 1 : 0;
+	
+	/* Enable feature and dynamic length on all pipes */
+	TM_NRF24L01_WriteBit(NRF24L01_REG_FEATURE, NRF24L01_EN_DPL, enable);
+	TM_NRF24L01_WriteRegister(NRF24L01_REG_DYNPD, enable ? 0x3F : 0x00);
+}
+
+void TM_NRF24L01_SetAckPayload(uint8_t enable) {
+	TM_NRF24L01_WriteBit(NRF24L01_REG_FEATURE, NRF24L01_EN_ACK_PAY, enable);
+}
+
+void TM_NRF24L01_WriteAckPayload(uint8_t pipe, uint8_t* data, uint8_t length) {
+	/* Check parameters */
+	if (pipe >= NRF24L01_PIPES || length == 0) {
+		return;
+	}
+	if (length > 32) {
+		length = 32;
+	}
+	
+	NRF24L01_CSN_LOW;
+	/* Send write ACK payload command with pipe number */
+	TM_SPI_Send(NRF24L01_SPI, NRF24L01_W_ACK_PAYLOAD_MASK | pipe);
+	TM_SPI_WriteMulti(NRF24L01_SPI, data, length);
+	NRF24L01_CSN_HIGH;
+}
+
 void TM_NRF24L01_WriteBit(uint8_t reg, uint8_t bit, uint8_t value) {
 	uint8_t tmp;
 	/* Read register */
@@ -376,7 +528,16 @@ void TM_NRF24L01_PowerDown(void) {
 }
 
 void TM_NRF24L01_Transmit(uint8_t *data) {
-	uint8_t count = TM_NRF24L01_Struct.PayloadSize;
+	TM_NRF24L01_TransmitLength(data, TM_NRF24L01_Struct.PayloadSize);
+}
+
+void TM_NRF24L01_TransmitLength(uint8_t *data, uint8_t length) {
+	/* Fixed payload size must be used without dynamic payload length */
+	if (!TM_NRF24L01_Struct.DynamicPayload) {
+		length = TM_NRF24L01_Struct.PayloadSize;
+	} else if (length > 32) {
+		length = 32;
+	}
 
 	/* Chip enable put to low, disable it */
 	NRF24L01_CE_LOW;
@@ -392,7 +553,7 @@ void TM_NRF24L01_Transmit(uint8_t *data) {
 	/* Send write payload command */
 	TM_SPI_Send(NRF24L01_SPI, NRF24L01_W_TX_PAYLOAD_MASK);
 	/* Fill payload with data*/
-	TM_SPI_WriteMulti(NRF24L01_SPI, data, count);
+	TM_SPI_WriteMulti(NRF24L01_SPI, data, length);
 	/* Disable SPI */
 	NRF24L01_CSN_HIGH;
 	
@@ -401,17 +562,54 @@ void TM_NRF24L01_Transmit(uint8_t *data) {
 }
 
 void TM_NRF24L01_GetData(uint8_t* data) {
+	TM_NRF24L01_GetDataPipe(data, NULL);
+}
+
+uint8_t TM_NRF24L01_GetDataPipe(uint8_t* data, uint8_t* pipe) {
+	uint8_t status, length;
+	
+	/* Pipe number of first payload in RX FIFO, 7 when empty */
+	status = (TM_NRF24L01_GetStatus() >> NRF24L01_RX_P_NO) & 0x07;
+	if (status >= NRF24L01_PIPES) {
+		return 0;
+	}
+	
+	/* Get payload length */
+	if (TM_NRF24L01_Struct.DynamicPayload) {
+		NRF24L01_CSN_LOW;
+		TM_SPI_Send(NRF24L01_SPI, NRF24L01_R_RX_PL_WID_MASK);
+		length = TM_SPI_Send(NRF24L01_SPI, NRF24L01_NOP_MASK);
+		NRF24L01_CSN_HIGH;
+		
+		/* Length not valid, payload must be flushed */
+		if (length == 0 || length > 32) {
+			NRF24L01_FLUSH_RX;
+			TM_NRF24L01_WriteRegister(NRF24L01_REG_STATUS, (1 << NRF24L01_RX_DR));
+			return 0;
+		}
+	} else {
+		length = TM_NRF24L01_Struct.PayloadSize;
+	}
+	
 	/* Pull down chip select */
 	NRF24L01_CSN_LOW;
 	/* Send read payload command*/
 	TM_SPI_Send(NRF24L01_SPI, NRF24L01_R_RX_PAYLOAD_MASK);
 	/* Read payload */
-	TM_SPI_SendMulti(NRF24L01_SPI, data, data, TM_NRF24L01_Struct.PayloadSize);
+	TM_SPI_ReadMulti(NRF24L01_SPI, data, NRF24L01_NOP_MASK, length);
 	/* Pull up chip select */
 	NRF24L01_CSN_HIGH;
 	
 	/* Reset status register, clear RX_DR interrupt flag */
 	TM_NRF24L01_WriteRegister(NRF24L01_REG_STATUS, (1 << NRF24L01_RX_DR));
+	
+	/* Save pipe */
+	if (pipe) {
+		*pipe = status;
+	}
+	
+	/* Return number of bytes */
+	return length;
 }
 
 uint8_t TM_NRF24L01_DataReady(void) {
@@ -553,3 +751,804 @@ void TM_NRF24L01_Clear_Interrupts(void) {
 	TM_NRF24L01_WriteRegister(0x07, 0x70);
 }
 
+uint8_t TM_NRF24L01_GetRPD(void) {
+	/* Only first bit is used */
+	return TM_NRF24L01_ReadRegister(NRF24L01_REG_RPD) & 0x01;
+}
+
+uint8_t TM_NRF24L01_ScanChannel(uint8_t channel, uint8_t samples) {
+	uint8_t config, old, count = 0;
+	
+	/* Check channel */
+	if (channel > 125) {
+		return 0;
+	}
+	
+	/* Save current settings */
+	config = TM_NRF24L01_ReadRegister(NRF24L01_REG_CONFIG);
+	old = TM_NRF24L01_Struct.Channel;
+	
+	/* RPD works in RX mode only */
+	NRF24L01_CE_LOW;
+	TM_NRF24L01_WriteRegister(NRF24L01_REG_CONFIG, NRF24L01_CONFIG | (1 << NRF24L01_PWR_UP) | (1 << NRF24L01_PRIM_RX));
+	
+	/* Oscillator startup from power down mode */
+	if (!NRF24L01_CHECK_BIT(config, NRF24L01_PWR_UP)) {
+		Delay(1500);
+	}
+	
+	/* Go to channel */
+	TM_NRF24L01_SetChannel(channel);
+	
+	/* RPD is cleared when RX mode is left, so start RX for each sample */
+	while (samples--) {
+		NRF24L01_CE_HIGH;
+		
+		/* 130us for RX settling and 40us for RPD */
+		Delay(200);
+		if (TM_NRF24L01_GetRPD()) {
+			count++;
+		}
+		NRF24L01_CE_LOW;
+	}
+	
+	/* Restore channel and mode */
+	TM_NRF24L01_SetChannel(old);
+	TM_NRF24L01_WriteRegister(NRF24L01_REG_CONFIG, config);
+	if (NRF24L01_CHECK_BIT(config, NRF24L01_PRIM_RX) && NRF24L01_CHECK_BIT(config, NRF24L01_PWR_UP)) {
+		NRF24L01_CE_HIGH;
+	}
+	
+	/* Return number of detected carriers */
+	return count;
+}
+
+void TM_NRF24L01_ScanChannels(uint8_t* busy, uint8_t samples) {
+	uint8_t i;
+	
+	/* Scan all channels */
+	for (i = 0; i <= 125; i++) {
+		busy[i] = TM_NRF24L01_ScanChannel(i, samples);
+	}
+}
+
+uint8_t TM_NRF24L01_HopInit(uint32_t seed, uint8_t first, uint8_t last, uint8_t count) {
+	uint8_t channels[126];
+	uint8_t i, j, tmp, range;
+	
+	/* Check parameters */
+	if (first > last || last > 125 || count == 0) {
+		return 0;
+	}
+	range = last - first + 1;
+	if (count > range) {
+		count = range;
+	}
+	if (count > NRF24L01_HOP_CHANNELS) {
+		count = NRF24L01_HOP_CHANNELS;
+	}
+	
+	/* Seed must not be zero for xorshift generator */
+	if (!seed) {
+		seed = 0x2545F491;
+	}
+	
+	/* Shuffle all channels in range, both sides get the same order for the same seed */
+	for (i = 0; i < range; i++) {
+		channels[i] = first + i;
+	}
+	for (i = range - 1; i > 0; i--) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		j = seed % (i + 1);
+		tmp = channels[i];
+		channels[i] = channels[j];
+		channels[j] = tmp;
+	}
+	
+	/* Reset structure and use first channels from shuffled range */
+	memset((void *)&TM_NRF24L01_HopStruct, 0, sizeof(TM_NRF24L01_HopStruct));
+	memcpy(TM_NRF24L01_HopStruct.Table, channels, count);
+	TM_NRF24L01_HopStruct.Count = count;
+	
+	/* Go to channel of slot 0 */
+	TM_NRF24L01_HopStruct.Index = TM_NRF24L01_INT_HopIndex(0);
+	TM_NRF24L01_INT_HopTune();
+	
+	/* Return number of channels */
+	return count;
+}
+
+void TM_NRF24L01_HopTick(void) {
+	/* Count slot, processed in main loop */
+	TM_NRF24L01_HopStruct.Ticks++;
+}
+
+uint32_t TM_NRF24L01_Hop(void) {
+	uint32_t ticks, irq;
+	uint8_t i;
+	
+	/* Hopping not initialized */
+	if (!TM_NRF24L01_HopStruct.Count) {
+		return 0;
+	}
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Take all counted slots */
+	ticks = TM_NRF24L01_HopStruct.Ticks;
+	TM_NRF24L01_HopStruct.Ticks = 0;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Slot did not change */
+	if (!ticks) {
+		return 0;
+	}
+	
+	/* Release blacklisted entries after penalty */
+	for (i = 0; i < TM_NRF24L01_HopStruct.Count; i++) {
+		if (TM_NRF24L01_HopStruct.Penalty[i]) {
+			if (TM_NRF24L01_HopStruct.Penalty[i] > ticks) {
+				TM_NRF24L01_HopStruct.Penalty[i] -= ticks;
+			} else {
+				TM_NRF24L01_HopStruct.Penalty[i] = 0;
+				TM_NRF24L01_HopStruct.Blacklist &= ~(1UL << i);
+			}
+		}
+	}
+	
+	/* Go to channel of new slot */
+	TM_NRF24L01_HopStruct.Slot += ticks;
+	TM_NRF24L01_HopStruct.Index = TM_NRF24L01_INT_HopIndex(TM_NRF24L01_HopStruct.Slot);
+	TM_NRF24L01_INT_HopTune();
+	
+	/* Return number of passed slots */
+	return ticks;
+}
+
+void TM_NRF24L01_HopSync(uint32_t slot) {
+	/* Slots counted so far are not valid anymore */
+	TM_NRF24L01_HopStruct.Ticks = 0;
+	
+	/* Go to channel of slot */
+	TM_NRF24L01_HopStruct.Slot = slot;
+	if (TM_NRF24L01_HopStruct.Count) {
+		TM_NRF24L01_HopStruct.Index = TM_NRF24L01_INT_HopIndex(slot);
+		TM_NRF24L01_INT_HopTune();
+	}
+}
+
+uint32_t TM_NRF24L01_HopGetSlot(void) {
+	return TM_NRF24L01_HopStruct.Slot;
+}
+
+uint8_t TM_NRF24L01_HopUpdate(TM_NRF24L01_Transmit_Status_t status) {
+	uint8_t i = TM_NRF24L01_HopStruct.Index;
+	uint16_t retr;
+	
+	/* Check status */
+	if (!TM_NRF24L01_HopStruct.Count || status == TM_NRF24L01_Transmit_Status_Sending) {
+		return 0;
+	}
+	
+	/* ARC_CNT is at maximum when payload is lost */
+	TM_NRF24L01_HopStruct.Retr[i] += TM_NRF24L01_GetRetransmissionsCount();
+	if (++TM_NRF24L01_HopStruct.Sent[i] < NRF24L01_HOP_WINDOW) {
+		return 0;
+	}
+	
+	/* Window is full, start new one */
+	retr = TM_NRF24L01_HopStruct.Retr[i];
+	TM_NRF24L01_HopStruct.Sent[i] = 0;
+	TM_NRF24L01_HopStruct.Retr[i] = 0;
+	
+	/* Check channel quality */
+	if (retr > NRF24L01_HOP_MAX_RETR) {
+		return TM_NRF24L01_INT_HopBlacklist(i);
+	}
+	
+	/* Channel is OK */
+	return 0;
+}
+
+uint8_t TM_NRF24L01_HopScan(uint8_t samples, uint8_t threshold) {
+	uint8_t i, count = 0;
+	
+	/* Scan all good channels in table */
+	for (i = 0; i < TM_NRF24L01_HopStruct.Count; i++) {
+		if (!(TM_NRF24L01_HopStruct.Blacklist & (1UL << i)) && TM_NRF24L01_ScanChannel(TM_NRF24L01_HopStruct.Table[i], samples) > threshold) {
+			count += TM_NRF24L01_INT_HopBlacklist(i);
+		}
+	}
+	
+	/* Current slot may use other channel now */
+	TM_NRF24L01_HopStruct.Index = TM_NRF24L01_INT_HopIndex(TM_NRF24L01_HopStruct.Slot);
+	TM_NRF24L01_INT_HopTune();
+	
+	/* Return number of blacklisted channels */
+	return count;
+}
+
+uint32_t TM_NRF24L01_HopGetBlacklist(void) {
+	return TM_NRF24L01_HopStruct.Blacklist;
+}
+
+void TM_NRF24L01_HopSetBlacklist(uint32_t blacklist) {
+	uint8_t i;
+	
+	/* Nothing changed */
+	if (blacklist == TM_NRF24L01_HopStruct.Blacklist) {
+		return;
+	}
+	
+	/* Entries set by user are not released, entries removed by user are released now */
+	for (i = 0; i < TM_NRF24L01_HopStruct.Count; i++) {
+		TM_NRF24L01_HopStruct.Penalty[i] = 0;
+	}
+	TM_NRF24L01_HopStruct.Blacklist = blacklist;
+	
+	/* Current slot may use other channel now */
+	if (TM_NRF24L01_HopStruct.Count) {
+		TM_NRF24L01_HopStruct.Index = TM_NRF24L01_INT_HopIndex(TM_NRF24L01_HopStruct.Slot);
+		TM_NRF24L01_INT_HopTune();
+	}
+}
+
+static uint8_t TM_NRF24L01_INT_HopIndex(uint32_t slot) {
+	uint8_t i, index;
+	
+	/* Blacklisted slot uses next good entry in table */
+	for (i = 0; i < TM_NRF24L01_HopStruct.Count; i++) {
+		index = (slot + i) % TM_NRF24L01_HopStruct.Count;
+		if (!(TM_NRF24L01_HopStruct.Blacklist & (1UL << index))) {
+			return index;
+		}
+	}
+	
+	/* All entries are blacklisted */
+	return slot % TM_NRF24L01_HopStruct.Count;
+}
+
+static void TM_NRF24L01_INT_HopTune(void) {
+	uint8_t channel = TM_NRF24L01_HopStruct.Table[TM_NRF24L01_HopStruct.Index];
+	
+	/* Already on channel */
+	if (channel == TM_NRF24L01_Struct.Channel) {
+		return;
+	}
+	
+	/* Channel is changed in standby mode, RX mode is started again */
+	NRF24L01_CE_LOW;
+	TM_NRF24L01_SetChannel(channel);
+	if (TM_NRF24L01_ReadBit(NRF24L01_REG_CONFIG, NRF24L01_PRIM_RX)) {
+		NRF24L01_CE_HIGH;
+	}
+}
+
+static uint8_t TM_NRF24L01_INT_HopBlacklist(uint8_t index) {
+	uint8_t i, good = 0;
+	
+	/* Already blacklisted */
+	if (TM_NRF24L01_HopStruct.Blacklist & (1UL << index)) {
+		return 0;
+	}
+	
+	/* Count good channels */
+	for (i = 0; i < TM_NRF24L01_HopStruct.Count; i++) {
+		if (!(TM_NRF24L01_HopStruct.Blacklist & (1UL << i))) {
+			good++;
+		}
+	}
+	
+	/* Keep minimal number of good channels */
+	if (good <= NRF24L01_HOP_MIN_CHANNELS) {
+		return 0;
+	}
+	
+	/* Blacklist entry for some time */
+	TM_NRF24L01_HopStruct.Blacklist |= 1UL << index;
+	TM_NRF24L01_HopStruct.Penalty[index] = NRF24L01_HOP_PENALTY;
+	TM_NRF24L01_HopStruct.Sent[index] = 0;
+	TM_NRF24L01_HopStruct.Retr[index] = 0;
+	
+	/* Return blacklisted */
+	return 1;
+}
+
+#if NRF24L01_USE_IRQ
+uint8_t TM_NRF24L01_IRQ_Init(void) {
+	/* Reset interrupt mode structure */
+	memset((void *)&TM_NRF24L01_IRQ, 0, sizeof(TM_NRF24L01_IRQ));
+	
+	/* Use the same SPI prescaler as set on SPI initialization */
+	TM_NRF24L01_IRQ.Prescaler = NRF24L01_SPI->CR1 & SPI_CR1_BR;
+	
+	/* Module is in RX mode after initialization */
+	TM_NRF24L01_IRQ.TxMode = 0;
+	
+	/* Enable W_TX_PAYLOAD_NOACK command */
+	TM_NRF24L01_WriteBit(NRF24L01_REG_FEATURE, NRF24L01_EN_DYN_ACK, 1);
+	
+	/* Init SPI DMA, SPI is initialized in TM_NRF24L01_Init */
+	TM_SPI_DMA_Init(NRF24L01_SPI);
+	
+	/* IRQ pin goes low when any interrupt flag is set */
+	if (TM_EXTI_AttachCallback(NRF24L01_IRQ_PORT, NRF24L01_IRQ_PIN, TM_EXTI_Trigger_Falling, TM_NRF24L01_INT_EXTICallback, NULL) != TM_EXTI_Result_Ok) {
+		return 0;
+	}
+	
+	/* Read status once, IRQ pin may be already low */
+	TM_NRF24L01_INT_Kick();
+	
+	/* Return OK */
+	return 1;
+}
+
+uint8_t TM_NRF24L01_IRQ_Transmit(uint8_t* data, uint8_t NoAck) {
+	return TM_NRF24L01_IRQ_TransmitLength(data, TM_NRF24L01_Struct.PayloadSize, NoAck);
+}
+
+uint8_t TM_NRF24L01_IRQ_TransmitLength(uint8_t* data, uint8_t length, uint8_t NoAck) {
+	TM_NRF24L01_INT_Payload_t* p;
+	uint32_t irq;
+	
+	/* Fixed payload size must be used without dynamic payload length */
+	if (!TM_NRF24L01_Struct.DynamicPayload) {
+		length = TM_NRF24L01_Struct.PayloadSize;
+	} else if (length == 0 || length > 32) {
+		return 0;
+	}
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Check for free entry */
+	if (TM_NRF24L01_IRQ.TxCount >= NRF24L01_TX_QUEUE_SIZE) {
+		if (!irq) {
+			__enable_irq();
+		}
+		return 0;
+	}
+	
+	/* Copy payload */
+	p = &TM_NRF24L01_IRQ.TxQueue[TM_NRF24L01_IRQ.TxIn];
+	p->Length = length;
+	p->NoAck = NoAck;
+	memcpy(p->Data, data, length);
+	if (++TM_NRF24L01_IRQ.TxIn >= NRF24L01_TX_QUEUE_SIZE) {
+		TM_NRF24L01_IRQ.TxIn = 0;
+	}
+	TM_NRF24L01_IRQ.TxCount++;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Start writing to TX FIFO */
+	TM_NRF24L01_INT_Kick();
+	
+	/* Return OK */
+	return 1;
+}
+
+uint8_t TM_NRF24L01_IRQ_WriteAckPayload(uint8_t pipe, uint8_t* data, uint8_t length) {
+	uint32_t irq;
+	
+	/* Check parameters */
+	if (pipe >= NRF24L01_PIPES || length == 0 || length > 32) {
+		return 0;
+	}
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Save payload, replace old one */
+	TM_NRF24L01_IRQ.Ack[pipe].Length = length;
+	memcpy(TM_NRF24L01_IRQ.Ack[pipe].Data, data, length);
+	TM_NRF24L01_IRQ.AckPending |= 1 << pipe;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Start writing to TX FIFO */
+	TM_NRF24L01_INT_Kick();
+	
+	/* Return OK */
+	return 1;
+}
+
+uint16_t TM_NRF24L01_IRQ_TxPending(void) {
+	return TM_NRF24L01_IRQ.TxCount;
+}
+
+uint8_t TM_NRF24L01_IRQ_GetData(uint8_t* data, uint8_t* pipe) {
+	uint8_t i, p, length;
+	
+	/* Start with pipe after last read one */
+	for (i = 0; i < NRF24L01_PIPES; i++) {
+		p = (TM_NRF24L01_IRQ.NextPipe + i) % NRF24L01_PIPES;
+		if (TM_NRF24L01_IRQ.Pipes[p].Count) {
+			length = TM_NRF24L01_IRQ_GetPipeData(p, data);
+			TM_NRF24L01_IRQ.NextPipe = (p + 1) % NRF24L01_PIPES;
+			if (pipe) {
+				*pipe = p;
+			}
+			return length;
+		}
+	}
+	
+	/* No data */
+	return 0;
+}
+
+uint8_t TM_NRF24L01_IRQ_GetPipeData(uint8_t pipe, uint8_t* data) {
+	TM_NRF24L01_INT_Pipe_t* Pipe;
+	uint8_t length;
+	uint32_t irq;
+	
+	/* Check for data */
+	if (pipe >= NRF24L01_PIPES || TM_NRF24L01_IRQ.Pipes[pipe].Count == 0) {
+		return 0;
+	}
+	Pipe = &TM_NRF24L01_IRQ.Pipes[pipe];
+	
+	/* Copy payload */
+	length = Pipe->Queue[Pipe->Out].Length;
+	memcpy(data, Pipe->Queue[Pipe->Out].Data, length);
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Remove payload from buffer */
+	if (++Pipe->Out >= NRF24L01_RX_QUEUE_SIZE) {
+		Pipe->Out = 0;
+	}
+	Pipe->Count--;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Return number of bytes */
+	return length;
+}
+
+uint16_t TM_NRF24L01_IRQ_DataAvailable(void) {
+	uint16_t count = 0;
+	uint8_t i;
+	
+	/* Sum all pipes */
+	for (i = 0; i < NRF24L01_PIPES; i++) {
+		count += TM_NRF24L01_IRQ.Pipes[i].Count;
+	}
+	
+	return count;
+}
+
+uint16_t TM_NRF24L01_IRQ_PipeDataAvailable(uint8_t pipe) {
+	if (pipe >= NRF24L01_PIPES) {
+		return 0;
+	}
+	return TM_NRF24L01_IRQ.Pipes[pipe].Count;
+}
+
+uint32_t TM_NRF24L01_IRQ_GetLost(void) {
+	return TM_NRF24L01_IRQ.Lost;
+}
+
+__weak void TM_NRF24L01_IRQ_Callback(TM_NRF24L01_IRQ_t* IRQ) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+             the TM_NRF24L01_IRQ_Callback could be implemented in the user file
+	*/
+}
+
+static void TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_t state, uint8_t count) {
+	TM_SPI_DMA_Job_t job;
+	
+	/* Fill job, buffers are static */
+	job.CS_Port = NRF24L01_CSN_PORT;
+	job.CS_Pin = NRF24L01_CSN_PIN;
+	job.Mode = TM_SPI_Mode_0;
+	job.Prescaler = TM_NRF24L01_IRQ.Prescaler;
+	job.TX_Buffer = TM_NRF24L01_IRQ.TX_Buffer;
+	job.RX_Buffer = TM_NRF24L01_IRQ.RX_Buffer;
+	job.Count = count;
+	job.Callback = TM_NRF24L01_INT_SPICallback;
+	job.Param = NULL;
+	
+	/* Set state before job, callback may be called immediately */
+	TM_NRF24L01_IRQ.State = state;
+	
+	/* SPI queue is full, try again on next IRQ or transmit */
+	if (!TM_SPI_DMA_Enqueue(NRF24L01_SPI, &job)) {
+		TM_NRF24L01_IRQ.Pending = 1;
+		TM_NRF24L01_IRQ.State = TM_NRF24L01_INT_State_Idle;
+	}
+}
+
+static void TM_NRF24L01_INT_ReadStatus(void) {
+	/* First byte is status register, second is FIFO status register */
+	TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_READ_REGISTER_MASK(NRF24L01_REG_FIFO_STATUS);
+	TM_NRF24L01_IRQ.TX_Buffer[1] = NRF24L01_NOP_MASK;
+	TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_Status, 2);
+}
+
+static void TM_NRF24L01_INT_ReadPayload(uint8_t length) {
+	TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_R_RX_PAYLOAD_MASK;
+	memset(&TM_NRF24L01_IRQ.TX_Buffer[1], NRF24L01_NOP_MASK, length);
+	TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_ReadPayload, length + 1);
+}
+
+static void TM_NRF24L01_INT_Push(uint8_t pipe, uint8_t* data, uint8_t length) {
+	TM_NRF24L01_INT_Pipe_t* Pipe;
+	
+	/* Pipe number is 7 when RX FIFO is empty */
+	if (pipe >= NRF24L01_PIPES) {
+		return;
+	}
+	Pipe = &TM_NRF24L01_IRQ.Pipes[pipe];
+	
+	/* Check for free entry */
+	if (Pipe->Count >= NRF24L01_RX_QUEUE_SIZE) {
+		TM_NRF24L01_IRQ.Lost++;
+		return;
+	}
+	
+	/* Save payload */
+	Pipe->Queue[Pipe->In].Length = length;
+	memcpy(Pipe->Queue[Pipe->In].Data, data, length);
+	if (++Pipe->In >= NRF24L01_RX_QUEUE_SIZE) {
+		Pipe->In = 0;
+	}
+	Pipe->Count++;
+}
+
+static void TM_NRF24L01_INT_Next(void) {
+	TM_NRF24L01_INT_Payload_t* p;
+	uint8_t flags = TM_NRF24L01_IRQ.Status & NRF24L01_IRQ_FLAGS;
+	uint8_t fifo = TM_NRF24L01_IRQ.FifoStatus;
+	uint8_t pipe;
+	uint32_t irq;
+	
+	/* Clear interrupt flags first, IRQ pin goes high */
+	if (flags) {
+		TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_WRITE_REGISTER_MASK(NRF24L01_REG_STATUS);
+		TM_NRF24L01_IRQ.TX_Buffer[1] = flags;
+		TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_Clear, 2);
+		return;
+	}
+	
+	/* Read received payload */
+	if (!NRF24L01_CHECK_BIT(fifo, NRF24L01_RX_EMPTY)) {
+		if (TM_NRF24L01_Struct.DynamicPayload) {
+			/* Read payload length first */
+			TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_R_RX_PL_WID_MASK;
+			TM_NRF24L01_IRQ.TX_Buffer[1] = NRF24L01_NOP_MASK;
+			TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_ReadWidth, 2);
+		} else {
+			TM_NRF24L01_INT_ReadPayload(TM_NRF24L01_Struct.PayloadSize);
+		}
+		return;
+	}
+	
+	/* Write ACK payloads in RX mode */
+	if (!TM_NRF24L01_IRQ.TxMode && TM_NRF24L01_IRQ.AckPending && !NRF24L01_CHECK_BIT(fifo, NRF24L01_FIFO_FULL)) {
+		/* Get interrupt status */
+		irq = __get_PRIMASK();
+
+		/* Disable interrupts */
+		__disable_irq();
+		
+		/* Find first pipe, copy payload and clear pending bit */
+		for (pipe = 0; !(TM_NRF24L01_IRQ.AckPending & (1 << pipe)); pipe++);
+		p = &TM_NRF24L01_IRQ.Ack[pipe];
+		TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_W_ACK_PAYLOAD_MASK | pipe;
+		memcpy(&TM_NRF24L01_IRQ.TX_Buffer[1], p->Data, p->Length);
+		TM_NRF24L01_IRQ.AckPending &= ~(1 << pipe);
+		
+		/* Enable IRQ if necessary */
+		if (!irq) {
+			__enable_irq();
+		}
+		
+		TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_WriteAck, p->Length + 1);
+		return;
+	}
+	
+	/* Fill TX FIFO from software queue */
+	if (TM_NRF24L01_IRQ.TxCount && !NRF24L01_CHECK_BIT(fifo, NRF24L01_FIFO_FULL)) {
+		if (!TM_NRF24L01_IRQ.TxMode) {
+			/* ACK payloads left in TX FIFO would be sent as normal data */
+			if (!NRF24L01_CHECK_BIT(fifo, NRF24L01_TX_EMPTY)) {
+				TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_FLUSH_TX_MASK;
+				TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_FlushTx, 1);
+				return;
+			}
+			
+			/* Go to TX mode, CE stays high after that and payloads are sent as they are written */
+			NRF24L01_CE_LOW;
+			TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_WRITE_REGISTER_MASK(NRF24L01_REG_CONFIG);
+			TM_NRF24L01_IRQ.TX_Buffer[1] = NRF24L01_CONFIG | (1 << NRF24L01_PWR_UP);
+			TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_Mode, 2);
+			return;
+		}
+		
+		/* Write payload */
+		p = &TM_NRF24L01_IRQ.TxQueue[TM_NRF24L01_IRQ.TxOut];
+		TM_NRF24L01_IRQ.TX_Buffer[0] = p->NoAck ? NRF24L01_W_TX_PAYLOAD_NOACK_MASK : NRF24L01_W_TX_PAYLOAD_MASK;
+		memcpy(&TM_NRF24L01_IRQ.TX_Buffer[1], p->Data, p->Length);
+		TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_WritePayload, p->Length + 1);
+		return;
+	}
+	
+	/* Everything sent, go back to RX mode */
+	if (TM_NRF24L01_IRQ.TxMode && !TM_NRF24L01_IRQ.TxCount && NRF24L01_CHECK_BIT(fifo, NRF24L01_TX_EMPTY)) {
+		NRF24L01_CE_LOW;
+		TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_WRITE_REGISTER_MASK(NRF24L01_REG_CONFIG);
+		TM_NRF24L01_IRQ.TX_Buffer[1] = NRF24L01_CONFIG | (1 << NRF24L01_PWR_UP) | (1 << NRF24L01_PRIM_RX);
+		TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_Mode, 2);
+		return;
+	}
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Nothing to do, wait for IRQ pin or new data */
+	flags = TM_NRF24L01_IRQ.Pending;
+	TM_NRF24L01_IRQ.Pending = 0;
+	TM_NRF24L01_IRQ.State = flags ? TM_NRF24L01_INT_State_Status : TM_NRF24L01_INT_State_Idle;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Something happened during transfers */
+	if (flags) {
+		TM_NRF24L01_INT_ReadStatus();
+	}
+}
+
+static void TM_NRF24L01_INT_Kick(void) {
+	uint32_t irq;
+	uint8_t start;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Start if idle, otherwise read status after current transfers */
+	start = TM_NRF24L01_IRQ.State == TM_NRF24L01_INT_State_Idle;
+	if (start) {
+		TM_NRF24L01_IRQ.State = TM_NRF24L01_INT_State_Status;
+	} else {
+		TM_NRF24L01_IRQ.Pending = 1;
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Start reading status */
+	if (start) {
+		TM_NRF24L01_INT_ReadStatus();
+	}
+}
+
+static void TM_NRF24L01_INT_SPICallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param) {
+	TM_NRF24L01_IRQ_t IRQ;
+	uint32_t irq;
+	
+	/* On DMA error start again with status */
+	if (!status) {
+		TM_NRF24L01_INT_ReadStatus();
+		return;
+	}
+	
+	switch (TM_NRF24L01_IRQ.State) {
+		case TM_NRF24L01_INT_State_Status:
+			/* Save registers */
+			TM_NRF24L01_IRQ.Status = RX_Buffer[0];
+			TM_NRF24L01_IRQ.FifoStatus = RX_Buffer[1];
+			break;
+		case TM_NRF24L01_INT_State_Clear:
+			/* Notify user */
+			IRQ.Status = TM_NRF24L01_IRQ.Status;
+			TM_NRF24L01_IRQ_Callback(&IRQ);
+			
+			/* Payload in TX FIFO is not removed, flush it */
+			if (NRF24L01_CHECK_BIT(IRQ.Status, NRF24L01_MAX_RT)) {
+				TM_NRF24L01_IRQ.Lost++;
+				TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_FLUSH_TX_MASK;
+				TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_FlushTx, 1);
+				return;
+			}
+			
+			/* Read status again, new flags may be set meanwhile */
+			TM_NRF24L01_INT_ReadStatus();
+			return;
+		case TM_NRF24L01_INT_State_ReadWidth:
+			/* Length not valid, payload must be flushed */
+			if (RX_Buffer[1] == 0 || RX_Buffer[1] > 32) {
+				TM_NRF24L01_IRQ.Lost++;
+				TM_NRF24L01_IRQ.TX_Buffer[0] = NRF24L01_FLUSH_RX_MASK;
+				TM_NRF24L01_INT_Start(TM_NRF24L01_INT_State_FlushRx, 1);
+				return;
+			}
+			
+			/* Read payload */
+			TM_NRF24L01_INT_ReadPayload(RX_Buffer[1]);
+			return;
+		case TM_NRF24L01_INT_State_ReadPayload:
+			/* Save payload to pipe buffer, first byte is status with pipe number */
+			TM_NRF24L01_INT_Push((RX_Buffer[0] >> NRF24L01_RX_P_NO) & 0x07, &RX_Buffer[1], count - 1);
+			
+			/* Check for more payloads */
+			TM_NRF24L01_INT_ReadStatus();
+			return;
+		case TM_NRF24L01_INT_State_WritePayload:
+			/* Remove payload from queue, interrupts disabled against TM_NRF24L01_IRQ_Transmit */
+			irq = __get_PRIMASK();
+			__disable_irq();
+			if (++TM_NRF24L01_IRQ.TxOut >= NRF24L01_TX_QUEUE_SIZE) {
+				TM_NRF24L01_IRQ.TxOut = 0;
+			}
+			TM_NRF24L01_IRQ.TxCount--;
+			if (!irq) {
+				__enable_irq();
+			}
+			
+			/* Check for free TX FIFO slot */
+			TM_NRF24L01_INT_ReadStatus();
+			return;
+		case TM_NRF24L01_INT_State_WriteAck:
+		case TM_NRF24L01_INT_State_FlushTx:
+		case TM_NRF24L01_INT_State_FlushRx:
+			TM_NRF24L01_INT_ReadStatus();
+			return;
+		case TM_NRF24L01_INT_State_Mode:
+			/* Mode changed, start RX or TX */
+			TM_NRF24L01_IRQ.TxMode = !TM_NRF24L01_IRQ.TxMode;
+			NRF24L01_CE_HIGH;
+			break;
+		default:
+			break;
+	}
+	
+	/* Decide what to do next */
+	TM_NRF24L01_INT_Next();
+}
+
+static void TM_NRF24L01_INT_EXTICallback(uint16_t GPIO_Pin, void* Param) {
+	/* Any interrupt flag set */
+	TM_NRF24L01_INT_Kick();
+}
+#endif
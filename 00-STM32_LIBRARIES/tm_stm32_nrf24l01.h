@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/09/hal-library-25-nrf24l01-for-stm32fxxx/
- * @version v1.0
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   Library template 
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_NRF24L01_H
-#define TM_NRF24L01_H 100
+#define TM_NRF24L01_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -94,12 +94,170 @@ IRQ			Not used	Interrupt pin. Goes low when active. Pin functionality is active,
 #define NRF24L01_CE_PORT			GPIOD
 #define NRF24L01_CE_PIN				GPIO_Pin_8
 \endcode
+ *
+ * \par Multiple pipes, dynamic payload length and ACK payloads
+ *
+ * nRF24L01+ can receive data on 6 pipes at the same time, each pipe has its own address.
+ * Pipes 0 and 1 have full 5-bytes address, pipes 2 to 5 share 4 MSB bytes with pipe 1 and only LSB byte is set.
+ * Use @ref TM_NRF24L01_SetPipeAddress function to set address of each pipe.
+ * Pipe 1 address is the same as set with @ref TM_NRF24L01_SetMyAddress
+ * and pipe 0 is used for auto ACK when transmitting, it is set with @ref TM_NRF24L01_SetTxAddress.
+ *
+ * With @ref TM_NRF24L01_SetDynamicPayload, each packet can have its own length up to 32 bytes,
+ * so short packets do not waste air time. Use @ref TM_NRF24L01_TransmitLength to send them
+ * and @ref TM_NRF24L01_GetDataPipe to receive them together with pipe number.
+ *
+ * With @ref TM_NRF24L01_SetAckPayload enabled, receiver can add data to ACK packet
+ * for each pipe using @ref TM_NRF24L01_WriteAckPayload function. Transmitter receives them on pipe 0.
+ * Dynamic payload length must be enabled on both sides for ACK payloads.
+ *
+ * \par Interrupt and DMA mode
+ *
+ * In default mode, each function waits for SPI and user has to poll @ref TM_NRF24L01_DataReady
+ * and @ref TM_NRF24L01_GetTransmissionStatus functions.
+ *
+ * Library can also work in interrupt mode, where IRQ pin falling edge starts SPI DMA transfers
+ * which read status and FIFO status registers, read received payloads to RX buffer and
+ * keep all 3 TX FIFO slots in nRF24L01+ filled from software TX queue.
+ * Module is switched to TX mode when there are data in TX queue and back to RX mode when everything is sent.
+ *
+ * Payloads can be sent with W_TX_PAYLOAD_NOACK command, where receiver does not send ACK back.
+ * This allows continuous streaming without waiting for ACK on each packet.
+ *
+ * To enable interrupt mode, open defines.h file and add lines below:
+ *
+\code
+//Enable interrupt and DMA mode
+#define NRF24L01_USE_IRQ          1
+
+//Change IRQ pin
+#define NRF24L01_IRQ_PORT         GPIOD
+#define NRF24L01_IRQ_PIN          GPIO_PIN_9
+
+//Number of payloads in software TX queue and in RX buffer of each pipe
+#define NRF24L01_TX_QUEUE_SIZE    8
+#define NRF24L01_RX_QUEUE_SIZE    4
+
+//DMA job queue on SPI must be enabled
+#define SPI_DMA_QUEUE_SIZE        4
+\endcode
+ *
+ * After @ref TM_NRF24L01_Init function, call @ref TM_NRF24L01_IRQ_Init to start interrupt mode.
+ * Then use @ref TM_NRF24L01_IRQ_Transmit and @ref TM_NRF24L01_IRQ_GetData functions.
+ * Each pipe has its own RX buffer, read data from one pipe with @ref TM_NRF24L01_IRQ_GetPipeData function.
+ *
+ * @note   Other functions which access nRF24L01+ over SPI must not be used when interrupt mode is active
+ *
+ * \par Channel scan and frequency hopping
+ *
+ * nRF24L01+ has received power detector (RPD), which is set when signal above -64dBm is present on channel.
+ * @ref TM_NRF24L01_ScanChannel samples RPD on one channel and returns how many times carrier was detected,
+ * @ref TM_NRF24L01_ScanChannels does the same for all 126 channels.
+ *
+ * With frequency hopping, transmitter and receiver change channel in each time slot.
+ * Both sides build the same hopping table from the same seed with @ref TM_NRF24L01_HopInit.
+ * Timer calls @ref TM_NRF24L01_HopTick on each slot and main loop calls @ref TM_NRF24L01_Hop,
+ * which moves to channel of current slot. Slots are counted, so hop is not missed when main loop is late.
+ *
+ * Transmitter reports result of each transmission with @ref TM_NRF24L01_HopUpdate.
+ * Retransmissions from OBSERVE_TX register are counted for each channel and when they are above
+ * NRF24L01_HOP_MAX_RETR in NRF24L01_HOP_WINDOW payloads, channel is blacklisted for NRF24L01_HOP_PENALTY slots.
+ * @ref TM_NRF24L01_HopScan blacklists channels where carrier is detected, before link is used.
+ * Slots of blacklisted channels use next good channel in table, so less air time is wasted on retransmissions.
+ *
+ * Transmitter decides about blacklist. It sends slot number and blacklist in payload and receiver
+ * follows it with @ref TM_NRF24L01_HopSync and @ref TM_NRF24L01_HopSetBlacklist.
+ * When receiver loses the link, it can stop hopping and wait on one channel, transmitter comes to it at least once in table.
+ *
+ * Add lines below in defines.h to change settings:
+ *
+\code
+//Maximal number of channels in hopping table, up to 32
+#define NRF24L01_HOP_CHANNELS       16
+
+//Payloads in window and maximal sum of retransmissions in window
+#define NRF24L01_HOP_WINDOW         32
+#define NRF24L01_HOP_MAX_RETR       32
+
+//Number of slots for blacklisted channel and minimal number of good channels
+#define NRF24L01_HOP_PENALTY        4096
+#define NRF24L01_HOP_MIN_CHANNELS   4
+\endcode
+ *
+ * Transmitter example, payload starts with slot number and blacklist:
+ *
+\code
+//Timer callback, called every 5ms
+void HopTimer(TM_DELAY_Timer_t* Timer, void* Param) {
+	TM_NRF24L01_HopTick();
+}
+
+//Same seed and channels on both sides
+TM_NRF24L01_HopInit(0x1234ABCD, 2, 80, 16);
+TM_NRF24L01_HopScan(10, 2);
+TM_DELAY_TimerCreate(5, 1, 1, HopTimer, NULL);
+
+while (1) {
+	//New slot, send one payload
+	if (TM_NRF24L01_Hop()) {
+		slot = TM_NRF24L01_HopGetSlot();
+		mask = TM_NRF24L01_HopGetBlacklist();
+		memcpy(&data[0], &slot, 4);
+		memcpy(&data[4], &mask, 4);
+		TM_NRF24L01_Transmit(data);
+		
+		//Wait for transmission and update channel statistics
+		do {
+			status = TM_NRF24L01_GetTransmissionStatus();
+		} while (status == TM_NRF24L01_Transmit_Status_Sending);
+		TM_NRF24L01_HopUpdate(status);
+		TM_NRF24L01_PowerUpRx();
+	}
+}
+\endcode
+ *
+ * Receiver example, timer is restarted on each payload to stay aligned with transmitter:
+ *
+\code
+TM_NRF24L01_HopInit(0x1234ABCD, 2, 80, 16);
+Timer = TM_DELAY_TimerCreate(5, 1, 1, HopTimer, NULL);
+
+while (1) {
+	TM_NRF24L01_Hop();
+	if (TM_NRF24L01_DataReady()) {
+		TM_NRF24L01_GetData(data);
+		memcpy(&slot, &data[0], 4);
+		memcpy(&mask, &data[4], 4);
+		TM_NRF24L01_HopSetBlacklist(mask);
+		TM_NRF24L01_HopSync(slot);
+		TM_DELAY_TimerReset(Timer);
+	}
+}
+\endcode
+ *
+ * @note   Channel scan and frequency hopping can not be used in interrupt mode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added interrupt mode with SPI DMA transfers, software TX queue and RX buffer
+  - Added W_TX_PAYLOAD_NOACK support for streaming in interrupt mode
+  
+ Version 1.2
+  - October 14, 2026
+  - Added addresses for all 6 RX pipes, dynamic payload length and ACK payloads
+  - Added RX buffer for each pipe in interrupt mode
+  - TM_NRF24L01_IRQ_GetData returns payload length and pipe number
+  
+ Version 1.3
+  - October 14, 2026
+  - Added channel scan with received power detector
+  - Added frequency hopping with timer driven slots and adaptive channel blacklist
 \endverbatim
  *
  * \par Dependencies
@@ -109,12 +267,39 @@ IRQ			Not used	Interrupt pin. Goes low when active. Pin functionality is active,
  - defines.h
  - TM SPI
  - TM GPIO
+ - TM DELAY
+ - TM EXTI (interrupt mode only)
+ - TM SPI DMA (interrupt mode only)
+ - string.h
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_spi.h"
 #include "tm_stm32_gpio.h"
+#include "tm_stm32_delay.h"
+#include "string.h"
+
+/* Interrupt mode is disabled by default */
+#ifndef NRF24L01_USE_IRQ
+#define NRF24L01_USE_IRQ            0
+#endif
+
+#if NRF24L01_USE_IRQ
+#include "tm_stm32_exti.h"
+#include "tm_stm32_spi_dma.h"
+
+/* Check libraries versions */
+#if TM_EXTI_H < 120
+#error "Please update TM EXTI LIB, minimum required version is 1.2.0. Download available on stm32f4-discovery.com website"
+#endif
+#if TM_SPI_DMA_H < 110
+#error "Please update TM SPI DMA LIB, minimum required version is 1.1.0. Download available on stm32f4-discovery.com website"
+#endif
+#if SPI_DMA_QUEUE_SIZE == 0
+#error "NRF24L01 interrupt mode needs SPI DMA job queue, set SPI_DMA_QUEUE_SIZE in defines.h"
+#endif
+#endif
 
 /**
  * @defgroup TM_NRF24L01P_Macros
@@ -140,6 +325,58 @@ IRQ			Not used	Interrupt pin. Goes low when active. Pin functionality is active,
 #define NRF24L01_CE_PIN				GPIO_PIN_8
 #endif
 
+/* IRQ pin for interrupt mode */
+#ifndef NRF24L01_IRQ_PIN
+#define NRF24L01_IRQ_PORT			GPIOD
+#define NRF24L01_IRQ_PIN			GPIO_PIN_9
+#endif
+
+/* Number of payloads in software TX queue for interrupt mode */
+#ifndef NRF24L01_TX_QUEUE_SIZE
+#define NRF24L01_TX_QUEUE_SIZE		8
+#endif
+
+/* Number of payloads in RX buffer of each pipe for interrupt mode */
+#ifndef NRF24L01_RX_QUEUE_SIZE
+#define NRF24L01_RX_QUEUE_SIZE		4
+#endif
+
+/* Maximal number of channels in hopping table */
+#ifndef NRF24L01_HOP_CHANNELS
+#define NRF24L01_HOP_CHANNELS		16
+#endif
+
+/* Number of payloads in window for channel quality check */
+#ifndef NRF24L01_HOP_WINDOW
+#define NRF24L01_HOP_WINDOW			32
+#endif
+
+/* Channel is blacklisted when sum of retransmissions in window is above this value */
+#ifndef NRF24L01_HOP_MAX_RETR
+#define NRF24L01_HOP_MAX_RETR		32
+#endif
+
+/* Number of slots before blacklisted channel is used again */
+#ifndef NRF24L01_HOP_PENALTY
+#define NRF24L01_HOP_PENALTY		4096
+#endif
+
+/* Channels are not blacklisted when less good channels would be left */
+#ifndef NRF24L01_HOP_MIN_CHANNELS
+#define NRF24L01_HOP_MIN_CHANNELS	4
+#endif
+
+/* Check hopping settings */
+#if NRF24L01_HOP_CHANNELS < 1 || NRF24L01_HOP_CHANNELS > 32
+#error "NRF24L01_HOP_CHANNELS must be between 1 and 32!"
+#endif
+#if NRF24L01_HOP_WINDOW < 1 || NRF24L01_HOP_WINDOW > 255 || NRF24L01_HOP_PENALTY > 65535
+#error "NRF24L01_HOP_WINDOW must be between 1 and 255 and NRF24L01_HOP_PENALTY up to 65535!"
+#endif
+
+/* Number of RX pipes */
+#define NRF24L01_PIPES				6
+
 /* Pins configuration */
 #define NRF24L01_CE_LOW				TM_GPIO_SetPinLow(NRF24L01_CE_PORT, NRF24L01_CE_PIN)
 #define NRF24L01_CE_HIGH			TM_GPIO_SetPinHigh(NRF24L01_CE_PORT, NRF24L01_CE_PIN)
@@ -243,6 +480,52 @@ void TM_NRF24L01_SetMyAddress(uint8_t* adr);
  */
 void TM_NRF24L01_SetTxAddress(uint8_t* adr);
 
+/**
+ * @brief  Sets receive address of pipe
+ * @note   Pipe is also enabled for receiving
+ * @param  pipe: Pipe number, 0 to 5
+ * @param  *adr: Pointer to address. For pipes 0 and 1 address is 5 bytes long,
+ *         for pipes 2 to 5 only first byte is used as LSB, other bytes are the same as in pipe 1
+ * @retval Address status:
+ *            - 0: Pipe number is not valid
+ *            - > 0: Address set
+ */
+uint8_t TM_NRF24L01_SetPipeAddress(uint8_t pipe, uint8_t* adr);
+
+/**
+ * @brief  Enables or disables receiving on pipe
+ * @param  pipe: Pipe number, 0 to 5
+ * @param  enable: Set to 1 to enable pipe or 0 to disable it
+ * @retval None
+ */
+void TM_NRF24L01_EnablePipe(uint8_t pipe, uint8_t enable);
+
+/**
+ * @brief  Enables or disables dynamic payload length on all pipes
+ * @note   When disabled, payload size is the same as "payload_size" parameter on initialization
+ * @param  enable: Set to 1 to enable dynamic payload length or 0 to disable it
+ * @retval None
+ */
+void TM_NRF24L01_SetDynamicPayload(uint8_t enable);
+
+/**
+ * @brief  Enables or disables payloads in ACK packets
+ * @note   Dynamic payload length must be enabled with @ref TM_NRF24L01_SetDynamicPayload
+ * @param  enable: Set to 1 to enable ACK payloads or 0 to disable them
+ * @retval None
+ */
+void TM_NRF24L01_SetAckPayload(uint8_t enable);
+
+/**
+ * @brief  Writes payload which will be sent with next ACK packet on pipe
+ * @note   Used in RX mode, ACK payloads must be enabled with @ref TM_NRF24L01_SetAckPayload
+ * @param  pipe: Pipe number, 0 to 5
+ * @param  *data: Pointer to 8-bit array with data
+ * @param  length: Number of bytes, up to 32
+ * @retval None
+ */
+void TM_NRF24L01_WriteAckPayload(uint8_t pipe, uint8_t* data, uint8_t length);
+
 /**
  * @brief  Gets number of retransmissions needed in last transmission
  * @param  None
@@ -291,6 +574,15 @@ TM_NRF24L01_Transmit_Status_t TM_NRF24L01_GetTransmissionStatus(void);
  */
 void TM_NRF24L01_Transmit(uint8_t *data);
 
+/**
+ * @brief  Transmits data with custom length with NRF24L01+ to another NRF module
+ * @note   Dynamic payload length must be enabled with @ref TM_NRF24L01_SetDynamicPayload on both modules
+ * @param  *data: Pointer to 8-bit array with data
+ * @param  length: Number of bytes to send, up to 32
+ * @retval None
+ */
+void TM_NRF24L01_TransmitLength(uint8_t *data, uint8_t length);
+
 /**
  * @brief  Checks if data is ready to be read from NRF24L01+
  * @param  None
@@ -307,6 +599,14 @@ uint8_t TM_NRF24L01_DataReady(void);
  */
 void TM_NRF24L01_GetData(uint8_t *data);
 
+/**
+ * @brief  Gets data and pipe number from NRF24L01+
+ * @param  *data: Pointer to 8-bits array where data from NRF will be saved, at least 32 bytes long
+ * @param  *pipe: Pointer to variable where pipe number will be saved. Set to NULL if not used
+ * @retval Number of received bytes, 0 if RX FIFO is empty or received length is not valid
+ */
+uint8_t TM_NRF24L01_GetDataPipe(uint8_t *data, uint8_t* pipe);
+
 /**
  * @brief  Sets working channel
  * @note   Channel value is just an offset in units MHz from 2.4GHz
@@ -347,6 +647,228 @@ uint8_t TM_NRF24L01_Read_Interrupts(TM_NRF24L01_IRQ_t* IRQ);
  */
 void TM_NRF24L01_Clear_Interrupts(void);
 
+/**
+ * @brief  Checks received power detector on current channel
+ * @note   Module must be in RX mode for at least 170us before RPD is valid
+ * @param  None
+ * @retval RPD status:
+ *            - 0: No carrier on channel
+ *            - > 0: Signal above -64dBm was detected
+ */
+uint8_t TM_NRF24L01_GetRPD(void);
+
+/**
+ * @brief  Measures how busy is channel using received power detector
+ * @note   Each sample takes about 200us. Module returns to previous channel and mode after scan
+ * @param  channel: Channel to scan, 0 to 125
+ * @param  samples: Number of RPD samples
+ * @retval Number of samples where carrier was detected
+ */
+uint8_t TM_NRF24L01_ScanChannel(uint8_t channel, uint8_t samples);
+
+/**
+ * @brief  Measures all channels using received power detector
+ * @param  *busy: Pointer to 126 bytes long array where number of detected carriers for each channel will be saved
+ * @param  samples: Number of RPD samples for each channel
+ * @retval None
+ */
+void TM_NRF24L01_ScanChannels(uint8_t* busy, uint8_t samples);
+
+/**
+ * @brief  Builds hopping table and goes to channel of slot 0
+ * @note   Transmitter and receiver must use the same parameters to get the same table.
+ *         Blacklist and channel statistics are cleared
+ * @param  seed: Seed for pseudo random order of channels
+ * @param  first: First channel which can be used, 0 to 125
+ * @param  last: Last channel which can be used, 0 to 125
+ * @param  count: Number of channels in table, up to NRF24L01_HOP_CHANNELS
+ * @retval Number of channels in table, 0 if parameters are not valid
+ */
+uint8_t TM_NRF24L01_HopInit(uint32_t seed, uint8_t first, uint8_t last, uint8_t count);
+
+/**
+ * @brief  Counts new time slot
+ * @note   Call it from timer interrupt with slot period, it does not access SPI
+ * @param  None
+ * @retval None
+ */
+void TM_NRF24L01_HopTick(void);
+
+/**
+ * @brief  Moves to channel of current slot after @ref TM_NRF24L01_HopTick was called
+ * @note   Call it from main loop, when module is not transmitting.
+ *         Module stays in RX mode if it was in RX mode before
+ * @param  None
+ * @retval Number of slots passed since last call, 0 if slot did not change
+ */
+uint32_t TM_NRF24L01_Hop(void);
+
+/**
+ * @brief  Sets current slot number, used by receiver to follow transmitter
+ * @param  slot: Slot number received from transmitter
+ * @retval None
+ */
+void TM_NRF24L01_HopSync(uint32_t slot);
+
+/**
+ * @brief  Gets current slot number
+ * @param  None
+ * @retval Current slot number
+ */
+uint32_t TM_NRF24L01_HopGetSlot(void);
+
+/**
+ * @brief  Updates statistics of current channel after transmission is done
+ * @note   Used on transmitter, before new transmission is started
+ * @param  status: Transmission status from @ref TM_NRF24L01_GetTransmissionStatus
+ * @retval Blacklist status:
+ *            - 0: Blacklist did not change
+ *            - > 0: Channel was added to blacklist
+ */
+uint8_t TM_NRF24L01_HopUpdate(TM_NRF24L01_Transmit_Status_t status);
+
+/**
+ * @brief  Blacklists table channels where carrier is detected
+ * @note   Used on transmitter, usually before link is used
+ * @param  samples: Number of RPD samples for each channel
+ * @param  threshold: Channel is blacklisted when carrier is detected in more samples
+ * @retval Number of blacklisted channels
+ */
+uint8_t TM_NRF24L01_HopScan(uint8_t samples, uint8_t threshold);
+
+/**
+ * @brief  Gets blacklist of hopping table
+ * @param  None
+ * @retval Bit for each table entry, set when channel is blacklisted
+ */
+uint32_t TM_NRF24L01_HopGetBlacklist(void);
+
+/**
+ * @brief  Sets blacklist of hopping table, used by receiver to follow transmitter
+ * @param  blacklist: Bit for each table entry, set when channel is blacklisted
+ * @retval None
+ */
+void TM_NRF24L01_HopSetBlacklist(uint32_t blacklist);
+
+#if NRF24L01_USE_IRQ || defined(__DOXYGEN__)
+
+/**
+ * @brief  Starts interrupt and DMA mode
+ * @note   Module must be initialized with @ref TM_NRF24L01_Init first.
+ *         This function initializes SPI DMA and EXTI line on IRQ pin.
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  None
+ * @retval Initialization status:
+ *            - 0: EXTI line is not available
+ *            - > 0: Interrupt mode started
+ */
+uint8_t TM_NRF24L01_IRQ_Init(void);
+
+/**
+ * @brief  Adds payload to software TX queue
+ * @note   Payload is copied, length is the same as "payload_size" parameter on initialization.
+ *         Use @ref TM_NRF24L01_IRQ_TransmitLength for custom length.
+ *         Transmission starts immediately and module is switched to TX mode.
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  *data: Pointer to 8-bit array with data
+ * @param  NoAck: Set to 1 to send payload with W_TX_PAYLOAD_NOACK command, receiver will not send ACK
+ * @retval Queue status:
+ *            - 0: TX queue is full
+ *            - > 0: Payload added to queue
+ */
+uint8_t TM_NRF24L01_IRQ_Transmit(uint8_t* data, uint8_t NoAck);
+
+/**
+ * @brief  Adds payload with custom length to software TX queue
+ * @note   Dynamic payload length must be enabled with @ref TM_NRF24L01_SetDynamicPayload on both modules
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  *data: Pointer to 8-bit array with data
+ * @param  length: Number of bytes to send, up to 32
+ * @param  NoAck: Set to 1 to send payload with W_TX_PAYLOAD_NOACK command, receiver will not send ACK
+ * @retval Queue status:
+ *            - 0: TX queue is full or length is not valid
+ *            - > 0: Payload added to queue
+ */
+uint8_t TM_NRF24L01_IRQ_TransmitLength(uint8_t* data, uint8_t length, uint8_t NoAck);
+
+/**
+ * @brief  Sets payload which will be sent with next ACK packet on pipe
+ * @note   Payload is copied and written to nRF24L01+ when module is in RX mode.
+ *         Previous ACK payload for the same pipe, not yet written, is replaced
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  pipe: Pipe number, 0 to 5
+ * @param  *data: Pointer to 8-bit array with data
+ * @param  length: Number of bytes, up to 32
+ * @retval Status:
+ *            - 0: Pipe or length is not valid
+ *            - > 0: Payload saved
+ */
+uint8_t TM_NRF24L01_IRQ_WriteAckPayload(uint8_t pipe, uint8_t* data, uint8_t length);
+
+/**
+ * @brief  Gets number of payloads in software TX queue, not yet written to nRF24L01+
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  None
+ * @retval Number of pending payloads
+ */
+uint16_t TM_NRF24L01_IRQ_TxPending(void);
+
+/**
+ * @brief  Gets received payload from RX buffer of any pipe
+ * @note   Pipes are checked one after another, so no pipe can block others
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  *data: Pointer to 8-bit array where payload will be saved, at least 32 bytes long
+ * @param  *pipe: Pointer to variable where pipe number will be saved. Set to NULL if not used
+ * @retval Number of bytes in payload, 0 if RX buffers are empty
+ */
+uint8_t TM_NRF24L01_IRQ_GetData(uint8_t* data, uint8_t* pipe);
+
+/**
+ * @brief  Gets received payload from RX buffer of pipe
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  pipe: Pipe number, 0 to 5
+ * @param  *data: Pointer to 8-bit array where payload will be saved, at least 32 bytes long
+ * @retval Number of bytes in payload, 0 if RX buffer of pipe is empty
+ */
+uint8_t TM_NRF24L01_IRQ_GetPipeData(uint8_t pipe, uint8_t* data);
+
+/**
+ * @brief  Gets number of payloads in RX buffers of all pipes
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  None
+ * @retval Number of received payloads
+ */
+uint16_t TM_NRF24L01_IRQ_DataAvailable(void);
+
+/**
+ * @brief  Gets number of payloads in RX buffer of pipe
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  pipe: Pipe number, 0 to 5
+ * @retval Number of received payloads
+ */
+uint16_t TM_NRF24L01_IRQ_PipeDataAvailable(uint8_t pipe);
+
+/**
+ * @brief  Gets number of lost payloads
+ * @note   Payload is lost when maximum number of retransmissions is reached or when RX buffer is full
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  None
+ * @retval Number of lost payloads
+ */
+uint32_t TM_NRF24L01_IRQ_GetLost(void);
+
+/**
+ * @brief  Interrupt callback, called when nRF24L01+ interrupt flags are cleared
+ * @note   Called from interrupt context
+ * @note   Available when NRF24L01_USE_IRQ is enabled
+ * @param  *IRQ: Pointer to @ref TM_NRF24L01_IRQ_t structure with status register value
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_NRF24L01_IRQ_Callback(TM_NRF24L01_IRQ_t* IRQ);
+
+#endif
+
 /* Private */
 void TM_NRF24L01_WriteRegister(uint8_t reg, uint8_t value);
 
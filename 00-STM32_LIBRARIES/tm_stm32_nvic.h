@@ -0,0 +1,372 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.1
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Central NVIC priority plan and interrupt locks for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_NVIC_H
+#define TM_NVIC_H 110
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_NVIC
+ * @brief    Central NVIC priority plan and interrupt locks for STM32Fxxx
+ * @{
+ *
+ * All libraries take preemption priority for their interrupts from this table.
+ * Priorities are grouped to tiers, lower number means more urgent interrupt:
+ *
+\verbatim
+ Tier                     F4/F7  F0  Libraries
+ NVIC_PRIORITY_REALTIME     0     0  None, reserved for user interrupts which are never masked by libraries
+ NVIC_PRIORITY_CRITICAL     1     1  DMA1, DMA2, PVD, GPS PPS
+ NVIC_PRIORITY_HIGH         3     1  USART, CAN
+ NVIC_PRIORITY_NORMAL       5     2  DELAY async, I2C, USB, Ethernet, LCD, DMA2D, SDIO
+ NVIC_PRIORITY_LOW          8     3  EXTI, RTC, DELAY microseconds timer
+ NVIC_PRIORITY_IDLE        15     3  RNG, QSPI flash
+\endverbatim
+ *
+ * Tier values or priority of single library can be changed in defines.h file:
+ *
+\code
+//Move all EXTI lines to idle tier
+#define EXTI_NVIC_PRIORITY      NVIC_PRIORITY_IDLE
+
+//Make normal tier callable from FreeRTOS API with configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY = 6
+#define NVIC_PRIORITY_NORMAL    6
+\endcode
+ *
+ * HAL uses NVIC_PRIORITYGROUP_4 on STM32F4xx and STM32F7xx, so all bits are preemption priority and subpriorities are ignored.
+ *
+ * \par Compile time check
+ *
+ * When NVIC_PLAN_CHECK is 1, which is default, compilation fails when:
+ *
+ *  - Priority does not fit to number of priority bits of device
+ *  - Low value interrupt (EXTI, RTC, RNG or QSPI flash) can preempt DMA interrupts
+ *  - Library interrupt has priority above @ref NVIC_LOCK_PRIORITY when BASEPRI locks are used
+ *
+ * \par Critical sections
+ *
+ * Libraries protect data shared with interrupts with @ref TM_NVIC_Lock and @ref TM_NVIC_Unlock.
+ * By default they disable all interrupts with PRIMASK, same as before.
+ *
+ * On STM32F4xx and STM32F7xx, critical sections can use BASEPRI instead. In this case only interrupts with priority
+ * @ref NVIC_LOCK_PRIORITY and lower are masked, nested, more urgent interrupts are never delayed by library code:
+ *
+\code
+//Use BASEPRI, interrupts with priority 0 keep running in library critical sections
+#define NVIC_USE_BASEPRI        1
+\endcode
+ *
+ * @note  Interrupt above @ref NVIC_LOCK_PRIORITY must not call any library function which uses critical section
+ *
+ * \par Nested interrupt budget
+ *
+ * Worst case latency of interrupt is its own handler plus handlers of all interrupts with more urgent tier plus longest critical section.
+ * Keep @ref NVIC_PRIORITY_CRITICAL handlers short, TM DMA and TM EXTI can move callbacks out of interrupt with @ref TM_DEFER.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Added DELAY_US_NVIC_PRIORITY for microseconds timer of TM DELAY on STM32F0xx
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+
+/**
+ * @defgroup TM_NVIC_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Priority tiers, Cortex-M0 has only 4 levels */
+#if __NVIC_PRIO_BITS == 2
+#ifndef NVIC_PRIORITY_REALTIME
+#define NVIC_PRIORITY_REALTIME          0x00
+#endif
+#ifndef NVIC_PRIORITY_CRITICAL
+#define NVIC_PRIORITY_CRITICAL          0x01
+#endif
+#ifndef NVIC_PRIORITY_HIGH
+#define NVIC_PRIORITY_HIGH              0x01
+#endif
+#ifndef NVIC_PRIORITY_NORMAL
+#define NVIC_PRIORITY_NORMAL            0x02
+#endif
+#ifndef NVIC_PRIORITY_LOW
+#define NVIC_PRIORITY_LOW               0x03
+#endif
+#ifndef NVIC_PRIORITY_IDLE
+#define NVIC_PRIORITY_IDLE              0x03
+#endif
+#else
+#ifndef NVIC_PRIORITY_REALTIME
+#define NVIC_PRIORITY_REALTIME          0x00
+#endif
+#ifndef NVIC_PRIORITY_CRITICAL
+#define NVIC_PRIORITY_CRITICAL          0x01
+#endif
+#ifndef NVIC_PRIORITY_HIGH
+#define NVIC_PRIORITY_HIGH              0x03
+#endif
+#ifndef NVIC_PRIORITY_NORMAL
+#define NVIC_PRIORITY_NORMAL            0x05
+#endif
+#ifndef NVIC_PRIORITY_LOW
+#define NVIC_PRIORITY_LOW               0x08
+#endif
+#ifndef NVIC_PRIORITY_IDLE
+#define NVIC_PRIORITY_IDLE              0x0F
+#endif
+#endif
+
+/* Library priorities */
+#ifndef DMA1_NVIC_PREEMPTION_PRIORITY
+#define DMA1_NVIC_PREEMPTION_PRIORITY   NVIC_PRIORITY_CRITICAL
+#endif
+#ifndef DMA2_NVIC_PREEMPTION_PRIORITY
+#define DMA2_NVIC_PREEMPTION_PRIORITY   NVIC_PRIORITY_CRITICAL
+#endif
+#ifndef PVD_NVIC_PRIORITY
+#define PVD_NVIC_PRIORITY               NVIC_PRIORITY_CRITICAL
+#endif
+#ifndef GPS_PPS_NVIC_PRIORITY
+#define GPS_PPS_NVIC_PRIORITY           NVIC_PRIORITY_CRITICAL
+#endif
+#ifndef USART_NVIC_PRIORITY
+#define USART_NVIC_PRIORITY             NVIC_PRIORITY_HIGH
+#endif
+#ifndef CAN_NVIC_PRIORITY
+#define CAN_NVIC_PRIORITY               NVIC_PRIORITY_HIGH
+#endif
+#ifndef DELAY_ASYNC_NVIC_PRIORITY
+#define DELAY_ASYNC_NVIC_PRIORITY       NVIC_PRIORITY_NORMAL
+#endif
+#ifndef I2C_NVIC_PRIORITY
+#define I2C_NVIC_PRIORITY               NVIC_PRIORITY_NORMAL
+#endif
+#ifndef USB_NVIC_PRIORITY
+#define USB_NVIC_PRIORITY               NVIC_PRIORITY_NORMAL
+#endif
+#ifndef ETHERNETIF_NVIC_PRIORITY
+#define ETHERNETIF_NVIC_PRIORITY        NVIC_PRIORITY_NORMAL
+#endif
+#ifndef LCD_NVIC_PRIORITY
+#define LCD_NVIC_PRIORITY               NVIC_PRIORITY_NORMAL
+#endif
+#ifndef DMA2D_GRAPHIC_NVIC_PRIORITY
+#define DMA2D_GRAPHIC_NVIC_PRIORITY     NVIC_PRIORITY_NORMAL
+#endif
+#ifndef FATFS_SDIO_NVIC_PRIORITY
+#define FATFS_SDIO_NVIC_PRIORITY        NVIC_PRIORITY_NORMAL
+#endif
+#ifndef EXTI_NVIC_PRIORITY
+#define EXTI_NVIC_PRIORITY              NVIC_PRIORITY_LOW
+#endif
+#ifndef RTC_NVIC_PRIORITY
+#define RTC_NVIC_PRIORITY               NVIC_PRIORITY_LOW
+#endif
+#ifndef DELAY_US_NVIC_PRIORITY
+#define DELAY_US_NVIC_PRIORITY          NVIC_PRIORITY_LOW
+#endif
+#ifndef RNG_NVIC_PRIORITY
+#define RNG_NVIC_PRIORITY               NVIC_PRIORITY_IDLE
+#endif
+#ifndef QSPIFLASH_NVIC_PRIORITY
+#define QSPIFLASH_NVIC_PRIORITY         NVIC_PRIORITY_IDLE
+#endif
+
+/* Use BASEPRI for library critical sections instead of PRIMASK */
+#ifndef NVIC_USE_BASEPRI
+#define NVIC_USE_BASEPRI                0
+#endif
+
+/* Interrupts with this priority and lower are masked in library critical sections when BASEPRI is used */
+#ifndef NVIC_LOCK_PRIORITY
+#define NVIC_LOCK_PRIORITY              NVIC_PRIORITY_CRITICAL
+#endif
+
+/* Check priority plan on compile time */
+#ifndef NVIC_PLAN_CHECK
+#define NVIC_PLAN_CHECK                 1
+#endif
+
+#if NVIC_USE_BASEPRI && defined(STM32F0xx)
+#error "NVIC_USE_BASEPRI is not supported on Cortex-M0, disable it in defines.h!"
+#endif
+#if NVIC_USE_BASEPRI && (NVIC_LOCK_PRIORITY < 1 || NVIC_LOCK_PRIORITY >= (1 << __NVIC_PRIO_BITS))
+#error "NVIC_LOCK_PRIORITY must be between 1 and lowest priority, BASEPRI with 0 does not mask anything!"
+#endif
+
+/* Priority is outside range of device */
+#define NVIC_INT_INVALID(priority)      ((priority) < 0 || (priority) >= (1 << __NVIC_PRIO_BITS))
+
+/* Priority can preempt DMA interrupts */
+#define NVIC_INT_ABOVE_DMA(priority)    ((priority) < DMA1_NVIC_PREEMPTION_PRIORITY || (priority) < DMA2_NVIC_PREEMPTION_PRIORITY)
+
+/* Priority is not masked by library critical sections */
+#define NVIC_INT_ABOVE_LOCK(priority)   (NVIC_USE_BASEPRI && (priority) < NVIC_LOCK_PRIORITY)
+
+#if NVIC_PLAN_CHECK
+#if NVIC_INT_INVALID(DMA1_NVIC_PREEMPTION_PRIORITY) || NVIC_INT_INVALID(DMA2_NVIC_PREEMPTION_PRIORITY) || \
+	NVIC_INT_INVALID(PVD_NVIC_PRIORITY) || NVIC_INT_INVALID(GPS_PPS_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(USART_NVIC_PRIORITY) || NVIC_INT_INVALID(CAN_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(DELAY_ASYNC_NVIC_PRIORITY) || NVIC_INT_INVALID(I2C_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(USB_NVIC_PRIORITY) || NVIC_INT_INVALID(ETHERNETIF_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(LCD_NVIC_PRIORITY) || NVIC_INT_INVALID(DMA2D_GRAPHIC_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(FATFS_SDIO_NVIC_PRIORITY) || NVIC_INT_INVALID(EXTI_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(RTC_NVIC_PRIORITY) || NVIC_INT_INVALID(DELAY_US_NVIC_PRIORITY) || NVIC_INT_INVALID(RNG_NVIC_PRIORITY) || \
+	NVIC_INT_INVALID(QSPIFLASH_NVIC_PRIORITY)
+#error "NVIC priority does not fit to number of priority bits of device, check NVIC priorities in defines.h!"
+#endif
+#if NVIC_INT_ABOVE_DMA(EXTI_NVIC_PRIORITY) || NVIC_INT_ABOVE_DMA(RTC_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_DMA(RNG_NVIC_PRIORITY) || NVIC_INT_ABOVE_DMA(QSPIFLASH_NVIC_PRIORITY)
+#error "EXTI, RTC, RNG and QSPIFLASH NVIC priorities must not be above DMA1 and DMA2 NVIC priorities!"
+#endif
+#if NVIC_INT_ABOVE_LOCK(DMA1_NVIC_PREEMPTION_PRIORITY) || NVIC_INT_ABOVE_LOCK(DMA2_NVIC_PREEMPTION_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(PVD_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(GPS_PPS_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(USART_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(CAN_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(DELAY_ASYNC_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(I2C_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(USB_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(ETHERNETIF_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(LCD_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(DMA2D_GRAPHIC_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(FATFS_SDIO_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(EXTI_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(RTC_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(DELAY_US_NVIC_PRIORITY) || NVIC_INT_ABOVE_LOCK(RNG_NVIC_PRIORITY) || \
+	NVIC_INT_ABOVE_LOCK(QSPIFLASH_NVIC_PRIORITY)
+#error "Library NVIC priorities must be equal or below NVIC_LOCK_PRIORITY when NVIC_USE_BASEPRI is used!"
+#endif
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_NVIC_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Enters library critical section
+ * @note   Masks interrupts with @ref NVIC_LOCK_PRIORITY and lower with BASEPRI or all interrupts with PRIMASK.
+ *         Critical sections can be nested, each lock must be followed by @ref TM_NVIC_Unlock with returned state
+ * @param  None
+ * @retval Previous state, pass it to @ref TM_NVIC_Unlock
+ */
+static __INLINE uint32_t TM_NVIC_Lock(void) {
+	uint32_t state;
+#if NVIC_USE_BASEPRI
+	uint32_t irq;
+	
+	/* Get current mask level */
+	state = __get_BASEPRI();
+	
+	/* Only raise level, Cortex-M7 r0p1 needs interrupts disabled while BASEPRI is written */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	__set_BASEPRI_MAX(NVIC_LOCK_PRIORITY << (8 - __NVIC_PRIO_BITS));
+	if (!irq) {
+		__enable_irq();
+	}
+#else
+	/* Get interrupt status */
+	state = __get_PRIMASK();
+	
+	/* Disable interrupts */
+	__disable_irq();
+#endif
+	
+	/* Return previous state */
+	return state;
+}
+
+/**
+ * @brief  Leaves library critical section
+ * @param  State: Value returned from @ref TM_NVIC_Lock
+ * @retval None
+ */
+static __INLINE void TM_NVIC_Unlock(uint32_t State) {
+#if NVIC_USE_BASEPRI
+	/* Restore mask level */
+	__set_BASEPRI(State);
+#else
+	/* Enable IRQ if necessary */
+	if (!State) {
+		__enable_irq();
+	}
+#endif
+}
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,58 @@
  */
 #include "tm_stm32_onewire.h"
 
+#if ONEWIRE_CRC8_MODE == 1
+/* CRC8 for lower and upper nibble */
+static const uint8_t OneWire_CRC8_Low[16] = {
+	0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41
+};
+static const uint8_t OneWire_CRC8_High[16] = {
+	0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8, 0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
+#elif ONEWIRE_CRC8_MODE == 2
+/* CRC8 for each byte value */
+static const uint8_t OneWire_CRC8_Table[256] = {
+	0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+	0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+	0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+	0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+	0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+	0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+	0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+	0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+	0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+	0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+	0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+	0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+	0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+	0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+	0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+	0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35
+};
+#elif ONEWIRE_CRC8_MODE == 3
+/* Hardware CRC8 context, x^8 + x^5 + x^4 + 1, reflected */
+static TM_CRC_Context_t OneWire_CRC8_Context = {0x31, 0, 0, 8, 1};
+#endif
+
+/* Parallel search private functions */
+static uint32_t TM_OneWire_INT_MultiModer(uint16_t pins);
+static uint16_t TM_OneWire_INT_MultiReset(GPIO_TypeDef* GPIOx, uint16_t pins);
+static void TM_OneWire_INT_MultiWrite(GPIO_TypeDef* GPIOx, uint16_t pins, uint16_t ones);
+static uint16_t TM_OneWire_INT_MultiRead(GPIO_TypeDef* GPIOx, uint16_t pins);
+
+#if ONEWIRE_USE_USART
+/* Slot bytes */
+#define ONEWIRE_USART_RESET        0xF0
+#define ONEWIRE_USART_BIT_1        0xFF
+#define ONEWIRE_USART_BIT_0        0x00
+
+/* Private functions */
+static uint8_t TM_OneWire_INT_USARTTransfer(TM_OneWire_t* OneWireStruct, uint16_t count);
+static uint8_t TM_OneWire_INT_USARTReset(TM_OneWire_t* OneWireStruct);
+static uint8_t TM_OneWire_INT_USARTBit(TM_OneWire_t* OneWireStruct, uint8_t bit);
+static void TM_OneWire_INT_USARTBytes(TM_OneWire_t* OneWireStruct, const uint8_t* tx, uint8_t* rx, uint16_t count);
+#endif
+
 void TM_OneWire_Init(TM_OneWire_t* OneWireStruct, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
 	/* Initialize delay if it was not already */
 	TM_DELAY_Init();
@@ -35,11 +87,43 @@ void TM_OneWire_Init(TM_OneWire_t* OneWireStruct, GPIO_TypeDef* GPIOx, uint16_t
 	/* Save settings */
 	OneWireStruct->GPIOx = GPIOx;
 	OneWireStruct->GPIO_Pin = GPIO_Pin;
+#if ONEWIRE_USE_USART
+	OneWireStruct->USARTx = NULL;
+#endif
+}
+
+#if ONEWIRE_USE_USART
+void TM_OneWire_InitUSART(TM_OneWire_t* OneWireStruct, USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+	/* Init USART with slot baudrate and DMA for TX */
+	TM_USART_Init(USARTx, pinspack, 115200);
+	TM_USART_DMA_Init(USARTx);
+	
+	/* TX pin as open-drain */
+	GPIOx->OTYPER |= GPIO_Pin;
+	
+	/* Single wire half-duplex mode, TX is internally connected to RX */
+	USARTx->CR1 &= ~USART_CR1_UE;
+	USARTx->CR3 |= USART_CR3_HDSEL;
+	USARTx->CR1 |= USART_CR1_UE;
+	
+	/* Save settings */
+	OneWireStruct->GPIOx = GPIOx;
+	OneWireStruct->GPIO_Pin = GPIO_Pin;
+	OneWireStruct->USARTx = USARTx;
+	OneWireStruct->BRR = USARTx->BRR;
 }
+#endif
 
 uint8_t TM_OneWire_Reset(TM_OneWire_t* OneWireStruct) {
 	uint8_t i;
 	
+#if ONEWIRE_USE_USART
+	/* Reset over USART */
+	if (OneWireStruct->USARTx) {
+		return TM_OneWire_INT_USARTReset(OneWireStruct);
+	}
+#endif
+	
 	/* Line low, and wait 480us */
 	ONEWIRE_LOW(OneWireStruct);
 	ONEWIRE_OUTPUT(OneWireStruct);
@@ -60,6 +144,14 @@ uint8_t TM_OneWire_Reset(TM_OneWire_t* OneWireStruct) {
 }
 
 void TM_OneWire_WriteBit(TM_OneWire_t* OneWireStruct, uint8_t bit) {
+#if ONEWIRE_USE_USART
+	/* Write slot over USART */
+	if (OneWireStruct->USARTx) {
+		TM_OneWire_INT_USARTBit(OneWireStruct, bit);
+		return;
+	}
+#endif
+	
 	if (bit) {
 		/* Set line low */
 		ONEWIRE_LOW(OneWireStruct);
@@ -90,6 +182,13 @@ void TM_OneWire_WriteBit(TM_OneWire_t* OneWireStruct, uint8_t bit) {
 uint8_t TM_OneWire_ReadBit(TM_OneWire_t* OneWireStruct) {
 	uint8_t bit = 0;
 	
+#if ONEWIRE_USE_USART
+	/* Read slot over USART */
+	if (OneWireStruct->USARTx) {
+		return TM_OneWire_INT_USARTBit(OneWireStruct, 1);
+	}
+#endif
+	
 	/* Line low */
 	ONEWIRE_LOW(OneWireStruct);
 	ONEWIRE_OUTPUT(OneWireStruct);
@@ -114,6 +213,15 @@ uint8_t TM_OneWire_ReadBit(TM_OneWire_t* OneWireStruct) {
 
 void TM_OneWire_WriteByte(TM_OneWire_t* OneWireStruct, uint8_t byte) {
 	uint8_t i = 8;
+	
+#if ONEWIRE_USE_USART
+	/* Write all 8 slots in one transfer */
+	if (OneWireStruct->USARTx) {
+		TM_OneWire_INT_USARTBytes(OneWireStruct, &byte, NULL, 1);
+		return;
+	}
+#endif
+	
 	/* Write 8 bits */
 	while (i--) {
 		/* LSB bit is first */
@@ -124,6 +232,15 @@ void TM_OneWire_WriteByte(TM_OneWire_t* OneWireStruct, uint8_t byte) {
 
 uint8_t TM_OneWire_ReadByte(TM_OneWire_t* OneWireStruct) {
 	uint8_t i = 8, byte = 0;
+	
+#if ONEWIRE_USE_USART
+	/* Read all 8 slots in one transfer */
+	if (OneWireStruct->USARTx) {
+		TM_OneWire_INT_USARTBytes(OneWireStruct, NULL, &byte, 1);
+		return byte;
+	}
+#endif
+	
 	while (i--) {
 		byte >>= 1;
 		byte |= (TM_OneWire_ReadBit(OneWireStruct) << 7);
@@ -132,6 +249,36 @@ uint8_t TM_OneWire_ReadByte(TM_OneWire_t* OneWireStruct) {
 	return byte;
 }
 
+void TM_OneWire_WriteBytes(TM_OneWire_t* OneWireStruct, const uint8_t* data, uint16_t count) {
+#if ONEWIRE_USE_USART
+	/* Write in blocks */
+	if (OneWireStruct->USARTx) {
+		TM_OneWire_INT_USARTBytes(OneWireStruct, data, NULL, count);
+		return;
+	}
+#endif
+	
+	/* Write byte by byte */
+	while (count--) {
+		TM_OneWire_WriteByte(OneWireStruct, *data++);
+	}
+}
+
+void TM_OneWire_ReadBytes(TM_OneWire_t* OneWireStruct, uint8_t* data, uint16_t count) {
+#if ONEWIRE_USE_USART
+	/* Read in blocks */
+	if (OneWireStruct->USARTx) {
+		TM_OneWire_INT_USARTBytes(OneWireStruct, NULL, data, count);
+		return;
+	}
+#endif
+	
+	/* Read byte by byte */
+	while (count--) {
+		*data++ = TM_OneWire_ReadByte(OneWireStruct);
+	}
+}
+
 uint8_t TM_OneWire_First(TM_OneWire_t* OneWireStruct) {
 	/* Reset search values */
 	TM_OneWire_ResetSearch(OneWireStruct);
@@ -326,26 +473,183 @@ void TM_OneWire_FamilySkipSetup(TM_OneWire_t* OneWireStruct) {
 	}
 }
 
+uint16_t TM_OneWire_MultiFirst(TM_OneWire_t** Buses, uint8_t count) {
+	uint8_t i;
+	
+	/* Reset search values */
+	for (i = 0; i < count; i++) {
+		TM_OneWire_ResetSearch(Buses[i]);
+	}
+	
+	/* Start with searching */
+	return TM_OneWire_MultiSearch(Buses, count, ONEWIRE_CMD_SEARCHROM);
+}
+
+uint16_t TM_OneWire_MultiNext(TM_OneWire_t** Buses, uint8_t count) {
+	/* Leave the search state alone */
+	return TM_OneWire_MultiSearch(Buses, count, ONEWIRE_CMD_SEARCHROM);
+}
+
+uint16_t TM_OneWire_MultiSearch(TM_OneWire_t** Buses, uint8_t count, uint8_t command) {
+	GPIO_TypeDef* GPIOx;
+	TM_OneWire_t* ow;
+	uint16_t active = 0, pins = 0, id_bits, cmp_bits, ones, result = 0;
+	uint8_t last_zero[16];
+	uint8_t id_bit_number, rom_byte_number, rom_byte_mask;
+	uint8_t i, search_direction;
+	
+	/* Check parameters */
+	if (!count || count > 16) {
+		return 0;
+	}
+	GPIOx = Buses[0]->GPIOx;
+	
+	/* Select buses which are not done yet */
+	for (i = 0; i < count; i++) {
+		/* All buses must be on the same port */
+		if (Buses[i]->GPIOx != GPIOx) {
+			return 0;
+		}
+#if ONEWIRE_USE_USART
+		if (Buses[i]->USARTx) {
+			return 0;
+		}
+#endif
+		
+		last_zero[i] = 0;
+		if (!Buses[i]->LastDeviceFlag) {
+			active |= 1 << i;
+			pins |= Buses[i]->GPIO_Pin;
+		}
+	}
+	
+	/* 1-Wire reset on all active buses, presence pulse is low */
+	if (pins) {
+		ones = TM_OneWire_INT_MultiReset(GPIOx, pins);
+		for (i = 0; i < count; i++) {
+			if ((active & (1 << i)) && (ones & Buses[i]->GPIO_Pin)) {
+				active &= ~(1 << i);
+				pins &= ~Buses[i]->GPIO_Pin;
+			}
+		}
+	}
+	
+	/* Issue the search command */
+	if (pins) {
+		for (i = 0; i < 8; i++) {
+			TM_OneWire_INT_MultiWrite(GPIOx, pins, (command & (1 << i)) ? pins : 0);
+		}
+	}
+	
+	/* Loop to do the search on all buses together */
+	rom_byte_number = 0;
+	rom_byte_mask = 1;
+	for (id_bit_number = 1; id_bit_number < 65 && pins; id_bit_number++) {
+		/* Read a bit and its complement on all buses */
+		id_bits = TM_OneWire_INT_MultiRead(GPIOx, pins);
+		cmp_bits = TM_OneWire_INT_MultiRead(GPIOx, pins);
+		ones = 0;
+		
+		for (i = 0; i < count; i++) {
+			if (!(active & (1 << i))) {
+				continue;
+			}
+			ow = Buses[i];
+			
+			/* Check for no devices on 1-wire */
+			if ((id_bits & ow->GPIO_Pin) && (cmp_bits & ow->GPIO_Pin)) {
+				active &= ~(1 << i);
+				pins &= ~ow->GPIO_Pin;
+				continue;
+			}
+			
+			/* All devices coupled have 0 or 1 */
+			if (((id_bits ^ cmp_bits) & ow->GPIO_Pin)) {
+				/* Bit write value for search */
+				search_direction = (id_bits & ow->GPIO_Pin) > 0;
+			} else {
+				/* If this discrepancy is before the Last Discrepancy on a previous next then pick the same as last time */
+				if (id_bit_number < ow->LastDiscrepancy) {
+					search_direction = ((ow->ROM_NO[rom_byte_number] & rom_byte_mask) > 0);
+				} else {
+					/* If equal to last pick 1, if not then pick 0 */
+					search_direction = (id_bit_number == ow->LastDiscrepancy);
+				}
+				
+				/* If 0 was picked then record its position in LastZero */
+				if (search_direction == 0) {
+					last_zero[i] = id_bit_number;
+					
+					/* Check for Last discrepancy in family */
+					if (id_bit_number < 9) {
+						ow->LastFamilyDiscrepancy = id_bit_number;
+					}
+				}
+			}
+			
+			/* Set or clear the bit in the ROM byte rom_byte_number with mask rom_byte_mask */
+			if (search_direction) {
+				ow->ROM_NO[rom_byte_number] |= rom_byte_mask;
+				ones |= ow->GPIO_Pin;
+			} else {
+				ow->ROM_NO[rom_byte_number] &= ~rom_byte_mask;
+			}
+		}
+		
+		/* Serial number search direction write bit on all buses */
+		if (pins) {
+			TM_OneWire_INT_MultiWrite(GPIOx, pins, ones);
+		}
+		
+		/* Shift the mask, if the mask is 0 then go to new SerialNum byte */
+		rom_byte_mask <<= 1;
+		if (rom_byte_mask == 0) {
+			rom_byte_number++;
+			rom_byte_mask = 1;
+		}
+	}
+	
+	/* Update search state for each bus */
+	for (i = 0; i < count; i++) {
+		ow = Buses[i];
+		
+		/* Search successful when bus stayed active through all 64 bits */
+		if ((active & (1 << i)) && ow->ROM_NO[0]) {
+			ow->LastDiscrepancy = last_zero[i];
+			
+			/* Check for last device */
+			if (ow->LastDiscrepancy == 0) {
+				ow->LastDeviceFlag = 1;
+			}
+			result |= 1 << i;
+		} else {
+			/* If no device found then reset counters so next 'search' will be like a first */
+			ow->LastDiscrepancy = 0;
+			ow->LastDeviceFlag = 0;
+			ow->LastFamilyDiscrepancy = 0;
+		}
+	}
+	
+	/* Return buses with found device */
+	return result;
+}
+
 uint8_t TM_OneWire_GetROM(TM_OneWire_t* OneWireStruct, uint8_t index) {
 	return OneWireStruct->ROM_NO[index];
 }
 
 void TM_OneWire_Select(TM_OneWire_t* OneWireStruct, uint8_t* addr) {
-	uint8_t i;
 	TM_OneWire_WriteByte(OneWireStruct, ONEWIRE_CMD_MATCHROM);
 	
-	for (i = 0; i < 8; i++) {
-		TM_OneWire_WriteByte(OneWireStruct, *(addr + i));
-	}
+	/* Write ROM address */
+	TM_OneWire_WriteBytes(OneWireStruct, addr, 8);
 }
 
 void TM_OneWire_SelectWithPointer(TM_OneWire_t* OneWireStruct, uint8_t *ROM) {
-	uint8_t i;
 	TM_OneWire_WriteByte(OneWireStruct, ONEWIRE_CMD_MATCHROM);
 	
-	for (i = 0; i < 8; i++) {
-		TM_OneWire_WriteByte(OneWireStruct, *(ROM + i));
-	}	
+	/* Write ROM address */
+	TM_OneWire_WriteBytes(OneWireStruct, ROM, 8);
 }
 
 void TM_OneWire_GetFullROM(TM_OneWire_t* OneWireStruct, uint8_t *firstIndex) {
@@ -356,6 +660,28 @@ void TM_OneWire_GetFullROM(TM_OneWire_t* OneWireStruct, uint8_t *firstIndex) {
 }
 
 uint8_t TM_OneWire_CRC8(uint8_t *addr, uint8_t len) {
+#if ONEWIRE_CRC8_MODE == 1
+	uint8_t crc = 0;
+	
+	/* Process byte with 2 nibble tables */
+	while (len--) {
+		crc ^= *addr++;
+		crc = OneWire_CRC8_Low[crc & 0x0F] ^ OneWire_CRC8_High[crc >> 4];
+	}
+#elif ONEWIRE_CRC8_MODE == 2
+	uint8_t crc = 0;
+	
+	/* Process byte with table */
+	while (len--) {
+		crc = OneWire_CRC8_Table[crc ^ *addr++];
+	}
+#elif ONEWIRE_CRC8_MODE == 3
+	uint8_t crc;
+	
+	/* Calculate in hardware */
+	TM_CRC_ContextReset(&OneWire_CRC8_Context);
+	crc = (uint8_t)TM_CRC_ContextUpdate(&OneWire_CRC8_Context, addr, len);
+#else
 	uint8_t crc = 0, inbyte, i, mix;
 	
 	while (len--) {
@@ -369,7 +695,225 @@ uint8_t TM_OneWire_CRC8(uint8_t *addr, uint8_t len) {
 			inbyte >>= 1;
 		}
 	}
+#endif
 	
 	/* Return calculated CRC */
 	return crc;
 }
+
+uint16_t TM_OneWire_ValidateROMs(uint8_t* ROMs, uint16_t count) {
+	uint16_t i, valid = 0;
+	uint8_t* rom = ROMs;
+	uint8_t j;
+	
+	/* Go through all ROMs */
+	for (i = 0; i < count; i++, rom += 8) {
+		/* CRC over whole ROM including CRC byte is 0 when valid, all zeros ROM is not valid */
+		if (!rom[0] || TM_OneWire_CRC8(rom, 8)) {
+			continue;
+		}
+		
+		/* Move valid ROM to first free position */
+		if (rom != &ROMs[valid * 8]) {
+			for (j = 0; j < 8; j++) {
+				ROMs[valid * 8 + j] = rom[j];
+			}
+		}
+		valid++;
+	}
+	
+	/* Return number of valid ROMs */
+	return valid;
+}
+
+/* Private functions */
+static uint32_t TM_OneWire_INT_MultiModer(uint16_t pins) {
+	uint32_t moder = 0;
+	uint8_t i;
+	
+	/* 01 bits combination for output on each pin */
+	for (i = 0; i < 16; i++) {
+		if (pins & (1 << i)) {
+			moder |= 0x01 << (2 * i);
+		}
+	}
+	
+	return moder;
+}
+
+static uint16_t TM_OneWire_INT_MultiReset(GPIO_TypeDef* GPIOx, uint16_t pins) {
+	uint32_t out = TM_OneWire_INT_MultiModer(pins);
+	uint32_t in = GPIOx->MODER & ~(out * 0x03);
+	uint16_t value;
+	
+	/* Lines low, and wait 480us */
+	GPIOx->BSRR = (uint32_t)pins << 16;
+	GPIOx->MODER = in | out;
+	ONEWIRE_DELAY(480);
+	
+	/* Release lines and wait for 70us */
+	GPIOx->MODER = in;
+	ONEWIRE_DELAY(70);
+	
+	/* Check all lines at once */
+	value = GPIOx->IDR & pins;
+	
+	/* Delay for 410 us */
+	ONEWIRE_DELAY(410);
+	
+	/* Return high lines, these have no presence pulse */
+	return value;
+}
+
+static void TM_OneWire_INT_MultiWrite(GPIO_TypeDef* GPIOx, uint16_t pins, uint16_t ones) {
+	uint32_t out = TM_OneWire_INT_MultiModer(pins);
+	uint32_t in = GPIOx->MODER & ~(out * 0x03);
+	uint32_t zeros = in | TM_OneWire_INT_MultiModer(pins & ~ones);
+	
+	/* Lines low */
+	GPIOx->BSRR = (uint32_t)pins << 16;
+	GPIOx->MODER = in | out;
+	ONEWIRE_DELAY(10);
+	
+	/* Release lines with bit 1, keep lines with bit 0 low */
+	GPIOx->MODER = zeros;
+	ONEWIRE_DELAY(55);
+	
+	/* Release all lines */
+	GPIOx->MODER = in;
+	ONEWIRE_DELAY(5);
+}
+
+static uint16_t TM_OneWire_INT_MultiRead(GPIO_TypeDef* GPIOx, uint16_t pins) {
+	uint32_t out = TM_OneWire_INT_MultiModer(pins);
+	uint32_t in = GPIOx->MODER & ~(out * 0x03);
+	uint16_t value;
+	
+	/* Lines low */
+	GPIOx->BSRR = (uint32_t)pins << 16;
+	GPIOx->MODER = in | out;
+	ONEWIRE_DELAY(3);
+	
+	/* Release lines */
+	GPIOx->MODER = in;
+	ONEWIRE_DELAY(10);
+	
+	/* Read all lines at once */
+	value = GPIOx->IDR & pins;
+	
+	/* Wait 50us to complete 60us period */
+	ONEWIRE_DELAY(50);
+	
+	/* Return bit values */
+	return value;
+}
+
+#if ONEWIRE_USE_USART
+static uint8_t TM_OneWire_INT_USARTTransfer(TM_OneWire_t* OneWireStruct, uint16_t count) {
+	USART_TypeDef* USARTx = OneWireStruct->USARTx;
+	uint32_t start;
+	uint16_t i;
+	
+	/* Discard old received data */
+	TM_USART_ClearBuffer(USARTx);
+	
+	/* Send slots, DMA is free as it is only used here */
+	if (!TM_USART_DMA_Send(USARTx, OneWireStruct->Slots, count)) {
+		return 1;
+	}
+	
+	/* Wait for echo of all slots without blocking interrupts */
+	start = HAL_GetTick();
+	while (TM_USART_BufferCount(USARTx) < count) {
+		if ((HAL_GetTick() - start) > ONEWIRE_USART_TIMEOUT) {
+			return 1;
+		}
+	}
+	
+	/* Replace slots with echo */
+	for (i = 0; i < count; i++) {
+		OneWireStruct->Slots[i] = TM_USART_Getc(USARTx);
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+static uint8_t TM_OneWire_INT_USARTReset(TM_OneWire_t* OneWireStruct) {
+	USART_TypeDef* USARTx = OneWireStruct->USARTx;
+	uint8_t status;
+	
+	/* Reset pulse at 9600 bauds */
+	USARTx->CR1 &= ~USART_CR1_UE;
+	USARTx->BRR = OneWireStruct->BRR * 12;
+	USARTx->CR1 |= USART_CR1_UE;
+	
+	/* Send reset, presence pulse changes echo */
+	OneWireStruct->Slots[0] = ONEWIRE_USART_RESET;
+	status = TM_OneWire_INT_USARTTransfer(OneWireStruct, 1) || OneWireStruct->Slots[0] == ONEWIRE_USART_RESET;
+	
+	/* Back to slot baudrate */
+	USARTx->CR1 &= ~USART_CR1_UE;
+	USARTx->BRR = OneWireStruct->BRR;
+	USARTx->CR1 |= USART_CR1_UE;
+	
+	/* Return value of presence pulse, 0 = OK, 1 = ERROR */
+	return status;
+}
+
+static uint8_t TM_OneWire_INT_USARTBit(TM_OneWire_t* OneWireStruct, uint8_t bit) {
+	/* Send slot */
+	OneWireStruct->Slots[0] = bit ? ONEWIRE_USART_BIT_1 : ONEWIRE_USART_BIT_0;
+	if (TM_OneWire_INT_USARTTransfer(OneWireStruct, 1)) {
+		return 0;
+	}
+	
+	/* Bit is 1 when nobody pulled line low */
+	return OneWireStruct->Slots[0] == ONEWIRE_USART_BIT_1;
+}
+
+static void TM_OneWire_INT_USARTBytes(TM_OneWire_t* OneWireStruct, const uint8_t* tx, uint8_t* rx, uint16_t count) {
+	uint8_t i, byte, bytes;
+	
+	while (count) {
+		/* Number of bytes in one transfer */
+		bytes = ONEWIRE_USART_SLOTS / 8;
+		if (bytes > count) {
+			bytes = count;
+		}
+		
+		/* Encode bytes, LSB first, read slots are 1 */
+		for (i = 0; i < bytes * 8; i++) {
+			byte = tx ? tx[i / 8] : 0xFF;
+			OneWireStruct->Slots[i] = (byte & (1 << (i % 8))) ? ONEWIRE_USART_BIT_1 : ONEWIRE_USART_BIT_0;
+		}
+		
+		/* Transfer slots */
+		if (TM_OneWire_INT_USARTTransfer(OneWireStruct, bytes * 8)) {
+			/* Error, read bytes are invalid */
+			for (i = 0; i < bytes * 8; i++) {
+				OneWireStruct->Slots[i] = ONEWIRE_USART_BIT_0;
+			}
+		}
+		
+		/* Decode received bytes */
+		if (rx) {
+			for (i = 0; i < bytes; i++) {
+				rx[i] = 0;
+			}
+			for (i = 0; i < bytes * 8; i++) {
+				if (OneWireStruct->Slots[i] == ONEWIRE_USART_BIT_1) {
+					rx[i / 8] |= 1 << (i % 8);
+				}
+			}
+			rx += bytes;
+		}
+		
+		/* Next block */
+		if (tx) {
+			tx += bytes;
+		}
+		count -= bytes;
+	}
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-05-onewire-for-stm32fxxx/
- * @version v1.0
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   Onewire library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_ONEWIRE_H
-#define TM_ONEWIRE_H 100
+#define TM_ONEWIRE_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -52,11 +52,80 @@ extern "C" {
  * @brief    Onewire library for STM32Fxxx devices - http://stm32f4-discovery.com/2015/07/hal-library-05-onewire-for-stm32fxxx/
  * @{
  *
+ * \par CRC8 calculation
+ *
+ * Dallas CRC8 is used for each ROM and scratchpad read. Calculation method can be selected in defines.h file:
+ *
+\code
+//Select CRC8 method
+// - 0: Bit by bit, no tables
+// - 1: 2 tables with 16 entries (32 bytes of flash), default
+// - 2: Table with 256 entries (256 bytes of flash)
+// - 3: Hardware CRC unit via TM CRC, only for devices with programmable polynomial (STM32F0xx with POL register, STM32F7xx)
+#define ONEWIRE_CRC8_MODE      1
+\endcode
+ *
+ * \note  For hardware mode, CRC unit must be initialized with @ref TM_CRC_Init first and must not be used by DMA at the same time
+ *
+ * \par USART physical layer
+ *
+ * Instead of GPIO bit-banging with delays and disabled interrupts, OneWire bus can be driven by USART in single wire half-duplex mode.
+ * Each OneWire time slot is one USART byte at 115200 bauds (0xFF for 1 and read slot, 0x00 for 0) and reset pulse is 0xF0 at 9600 bauds.
+ * Slot bytes are sent with @ref TM_USART_DMA and their echo is read back from USART buffer, so timing is generated by hardware.
+ *
+ * USART TX pin is switched to open-drain and must have pull-up resistor to VCC. RX pin is not used.
+ * Use @ref TM_OneWire_InitUSART instead of @ref TM_OneWire_Init, all other functions work as before.
+ *
+ * USART physical layer is STM32F4xx and STM32F7xx only and must be enabled in defines.h file:
+ *
+\code
+//Enable USART physical layer
+#define ONEWIRE_USE_USART          1
+//Number of slot bytes sent in one DMA transfer, must not be greater than USART buffer size
+#define ONEWIRE_USART_SLOTS        32
+//Timeout in milliseconds for USART transfer
+#define ONEWIRE_USART_TIMEOUT      10
+\endcode
+ *
+ * \par Parallel search
+ *
+ * When more OneWire buses are on the same GPIO port, all of them can be searched at the same time with
+ * @ref TM_OneWire_MultiFirst and @ref TM_OneWire_MultiNext functions. Every time slot drives and samples
+ * all pins with single MODER and IDR access, so enumeration time does not grow with number of buses.
+ *
+\code
+TM_OneWire_t* Buses[4] = {&OneWire1, &OneWire2, &OneWire3, &OneWire4};
+uint16_t found;
+
+found = TM_OneWire_MultiFirst(Buses, 4);
+while (found) {
+	//Bit i is set when Buses[i]->ROM_NO holds new device
+	found = TM_OneWire_MultiNext(Buses, 4);
+}
+\endcode
+ *
+ * \note  Other pins on the same port must not be reconfigured from interrupts during search.
+ *        USART physical layer buses are not supported
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added table and hardware CRC8 calculation methods
+  - Added TM_OneWire_ValidateROMs function to check enumerated ROM table
+  
+ Version 1.2
+  - October 14, 2026
+  - Added USART physical layer with DMA slot generation
+  - Added TM_OneWire_WriteBytes and TM_OneWire_ReadBytes functions
+  
+ Version 1.3
+  - October 14, 2026
+  - Added parallel search on more buses on the same GPIO port
 \endverbatim
  *
  * \par Dependencies
@@ -66,6 +135,8 @@ extern "C" {
  - defines.h
  - TM DELAY
  - TM GPIO
+ - TM CRC, when ONEWIRE_CRC8_MODE is 3
+ - TM USART DMA, when ONEWIRE_USE_USART is enabled
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
@@ -73,6 +144,41 @@ extern "C" {
 #include "tm_stm32_delay.h"
 #include "tm_stm32_gpio.h"
 
+/* CRC8 calculation method */
+#ifndef ONEWIRE_CRC8_MODE
+#define ONEWIRE_CRC8_MODE      1
+#endif
+
+/* Hardware CRC8 needs programmable polynomial */
+#if ONEWIRE_CRC8_MODE == 3
+#include "tm_stm32_crc.h"
+#if !defined(CRC_POL_POL)
+#error "CRC unit without programmable polynomial can not be used for OneWire CRC8. Select another ONEWIRE_CRC8_MODE!"
+#endif
+#endif
+
+/* USART physical layer */
+#ifndef ONEWIRE_USE_USART
+#define ONEWIRE_USE_USART          0
+#endif
+
+#if ONEWIRE_USE_USART
+#if defined(STM32F0xx)
+#error "OneWire USART physical layer is not supported on STM32F0xx devices!"
+#endif
+#include "tm_stm32_usart_dma.h"
+
+/* Number of slot bytes in one transfer */
+#ifndef ONEWIRE_USART_SLOTS
+#define ONEWIRE_USART_SLOTS        32
+#endif
+
+/* Transfer timeout in milliseconds */
+#ifndef ONEWIRE_USART_TIMEOUT
+#define ONEWIRE_USART_TIMEOUT      10
+#endif
+#endif
+
 /**
  * @defgroup TM_ONEWIRE_Macros
  * @brief    Library defines
@@ -120,6 +226,11 @@ typedef struct {
 	uint8_t LastFamilyDiscrepancy; /*!< Search private */
 	uint8_t LastDeviceFlag;        /*!< Search private */
 	uint8_t ROM_NO[8];             /*!< 8-bytes address of last search device */
+#if ONEWIRE_USE_USART
+	USART_TypeDef* USARTx;         /*!< USART for physical layer, NULL when GPIO is used */
+	uint32_t BRR;                  /*!< USART baudrate register value for time slots */
+	uint8_t Slots[ONEWIRE_USART_SLOTS]; /*!< Slot bytes for DMA transfer */
+#endif
 } TM_OneWire_t;
 
 /**
@@ -141,6 +252,20 @@ typedef struct {
  */
 void TM_OneWire_Init(TM_OneWire_t* OneWireStruct, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
 
+/**
+ * @brief  Initializes OneWire bus on USART in single wire half-duplex mode
+ * @note   Available when ONEWIRE_USE_USART is enabled
+ * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t empty working onewire structure
+ * @param  *USARTx: Pointer to USART used for onewire channel
+ * @param  pinspack: USART pins pack, @ref TM_USART_PinsPack_t
+ * @param  *GPIOx: Pointer to GPIO port of USART TX pin
+ * @param  GPIO_Pin: USART TX pin, switched to open-drain
+ * @retval None
+ */
+#if ONEWIRE_USE_USART
+void TM_OneWire_InitUSART(TM_OneWire_t* OneWireStruct, USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+#endif
+
 /**
  * @brief  Resets OneWire bus
  * 
@@ -165,6 +290,26 @@ uint8_t TM_OneWire_ReadByte(TM_OneWire_t* OneWireStruct);
  */
 void TM_OneWire_WriteByte(TM_OneWire_t* OneWireStruct, uint8_t byte);
 
+/**
+ * @brief  Writes multiple bytes to bus
+ * @note   With USART physical layer, more bytes are sent in one DMA transfer
+ * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working onewire structure
+ * @param  *data: Pointer to data to write
+ * @param  count: Number of bytes to write
+ * @retval None
+ */
+void TM_OneWire_WriteBytes(TM_OneWire_t* OneWireStruct, const uint8_t* data, uint16_t count);
+
+/**
+ * @brief  Reads multiple bytes from bus
+ * @note   With USART physical layer, more bytes are read in one DMA transfer
+ * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working onewire structure
+ * @param  *data: Pointer to array to save read bytes
+ * @param  count: Number of bytes to read
+ * @retval None
+ */
+void TM_OneWire_ReadBytes(TM_OneWire_t* OneWireStruct, uint8_t* data, uint16_t count);
+
 /**
  * @brief  Writes single bit to onewire bus
  * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working onewire structure
@@ -229,6 +374,34 @@ uint8_t TM_OneWire_First(TM_OneWire_t* OneWireStruct);
  */
 uint8_t TM_OneWire_Next(TM_OneWire_t* OneWireStruct);
 
+/**
+ * @brief  Starts parallel search on more buses, reset states first
+ * @note   All buses must use GPIO pins on the same GPIO port
+ * @param  **Buses: Pointer to table of pointers to @ref TM_OneWire_t working onewire structures
+ * @param  count: Number of buses, 16 max
+ * @retval Bit mask of buses where new device was found, bit 0 is for first bus
+ */
+uint16_t TM_OneWire_MultiFirst(TM_OneWire_t** Buses, uint8_t count);
+
+/**
+ * @brief  Continues parallel search on more buses
+ * @note   Use @ref TM_OneWire_MultiFirst to start searching
+ * @param  **Buses: Pointer to table of pointers to @ref TM_OneWire_t working onewire structures
+ * @param  count: Number of buses, 16 max
+ * @retval Bit mask of buses where new device was found, bit 0 is for first bus
+ */
+uint16_t TM_OneWire_MultiNext(TM_OneWire_t** Buses, uint8_t count);
+
+/**
+ * @brief  Searches for next device on more buses at the same time
+ * @note   Not meant for public use. Use @ref TM_OneWire_MultiFirst and @ref TM_OneWire_MultiNext for this.
+ * @param  **Buses: Pointer to table of pointers to @ref TM_OneWire_t working onewire structures
+ * @param  count: Number of buses, 16 max
+ * @param  command: Search command
+ * @retval Bit mask of buses where new device was found, bit 0 is for first bus
+ */
+uint16_t TM_OneWire_MultiSearch(TM_OneWire_t** Buses, uint8_t count, uint8_t command);
+
 /**
  * @brief  Gets ROM number from device from search
  * @param  *OneWireStruct: Pointer to @ref TM_OneWire_t working onewire
@@ -270,6 +443,15 @@ void TM_OneWire_SelectWithPointer(TM_OneWire_t* OneWireStruct, uint8_t* ROM);
  */
 uint8_t TM_OneWire_CRC8(uint8_t* addr, uint8_t len);
 
+/**
+ * @brief  Validates table of ROM addresses found with @ref TM_OneWire_First and @ref TM_OneWire_Next
+ * @note   Invalid ROMs (wrong CRC or all zeros) are removed and valid ones are moved to the beginning of table
+ * @param  *ROMs: Pointer to table of 8-bytes long ROM addresses, stored one after another
+ * @param  count: Number of ROM addresses in table
+ * @retval Number of valid ROM addresses at the beginning of table
+ */
+uint16_t TM_OneWire_ValidateROMs(uint8_t* ROMs, uint16_t count);
+
 /**
  * @}
  */
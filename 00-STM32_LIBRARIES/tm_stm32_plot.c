@@ -0,0 +1,238 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_plot.h"
+
+/* Private functions */
+static int16_t TM_PLOT_INT_GetRow(TM_PLOT_t* Plot, int16_t sample);
+static void TM_PLOT_INT_DrawColumn(TM_PLOT_t* Plot, uint16_t* column, uint32_t mirror, int16_t row);
+static void TM_PLOT_INT_SetLayer(TM_PLOT_t* Plot);
+
+TM_LCD_Result_t TM_PLOT_Init(TM_PLOT_t* Plot, TM_PLOT_Mode_t Mode, uint16_t x, uint16_t y, uint16_t width, uint16_t height, int32_t min, int32_t max, uint32_t color, uint32_t background) {
+	/* Check parameters, physical LCD size is used as plot is drawn directly to memory */
+	if (
+		TM_LCD_GetOrientation() != 1 ||
+		width < 2 || height < 2 || max <= min ||
+		(x + width) > LCD_PIXEL_WIDTH ||
+		(y + height) > LCD_PIXEL_HEIGHT
+	) {
+		return TM_LCD_Result_Error;
+	}
+	
+	/* Fill settings */
+	Plot->Mode = Mode;
+	Plot->X = x;
+	Plot->Y = y;
+	Plot->Width = width;
+	Plot->Height = height;
+	Plot->Min = min;
+	Plot->Max = max;
+	Plot->Scale = (uint32_t)(((uint64_t)(height - 1) << 16) / (uint32_t)(max - min));
+	Plot->Color = (uint16_t)color;
+	Plot->Background = (uint16_t)background;
+	
+	/* Set memory */
+	if (Mode == TM_PLOT_Mode_Layer) {
+		/* Own ring of columns, 2 times plot width */
+		Plot->Memory = (uint16_t *)PLOT_LAYER_MEMORY;
+		Plot->Pitch = 2 * width;
+	} else {
+		/* Top left corner of plot in frame buffer */
+		Plot->Memory = (uint16_t *)TM_LCD_GetFrameBuffer() + y * LCD_PIXEL_WIDTH + x;
+		Plot->Pitch = LCD_PIXEL_WIDTH;
+	}
+	
+	/* Clear plot */
+	TM_PLOT_Clear(Plot);
+	
+	/* Return OK */
+	return TM_LCD_Result_Ok;
+}
+
+void TM_PLOT_DeInit(TM_PLOT_t* Plot) {
+	/* Disable layer 2 in layer mode */
+	if (Plot->Mode == TM_PLOT_Mode_Layer) {
+		LTDC_Layer2->CR &= ~LTDC_LxCR_LEN;
+		LTDC->SRCR = LTDC_SRCR_VBR;
+	}
+}
+
+void TM_PLOT_Clear(TM_PLOT_t* Plot) {
+	uint16_t* row = Plot->Memory;
+	uint32_t x, y, width;
+	
+	/* Queued DMA2D drawing may still use frame buffer */
+	TM_DMA2DGRAPHIC_WaitIdle();
+	
+	/* Fill memory with background, whole ring in layer mode */
+	width = Plot->Mode == TM_PLOT_Mode_Layer ? Plot->Pitch : Plot->Width;
+	for (y = 0; y < Plot->Height; y++) {
+		for (x = 0; x < width; x++) {
+			row[x] = Plot->Background;
+		}
+		row += Plot->Pitch;
+	}
+	
+	/* Reset ring */
+	Plot->Head = 0;
+	Plot->LastY = -1;
+	
+	/* Show ring on layer 2 */
+	if (Plot->Mode == TM_PLOT_Mode_Layer) {
+		TM_PLOT_INT_SetLayer(Plot);
+	}
+}
+
+void TM_PLOT_AddSample(TM_PLOT_t* Plot, int16_t sample) {
+	/* Add one sample */
+	TM_PLOT_AddSamples(Plot, &sample, 1);
+}
+
+void TM_PLOT_AddSamples(TM_PLOT_t* Plot, const int16_t* Samples, uint16_t count) {
+	uint16_t* column;
+	uint16_t i;
+	
+	/* Only last samples fit to plot, previous one is used as start of line */
+	if (count > Plot->Width) {
+		Plot->LastY = TM_PLOT_INT_GetRow(Plot, Samples[count - Plot->Width - 1]);
+		Samples += count - Plot->Width;
+		count = Plot->Width;
+	}
+	if (count == 0) {
+		return;
+	}
+	
+	if (Plot->Mode == TM_PLOT_Mode_Layer) {
+		/* Each column is written at ring position and at position + width */
+		for (i = 0; i < count; i++) {
+			TM_PLOT_INT_DrawColumn(Plot, &Plot->Memory[Plot->Head], Plot->Width, TM_PLOT_INT_GetRow(Plot, Samples[i]));
+			
+			/* Go to next column */
+			if (++Plot->Head >= Plot->Width) {
+				Plot->Head = 0;
+			}
+		}
+		
+		/* Oldest column is at head, move layer start there */
+		LTDC_Layer2->CFBAR = (uint32_t)&Plot->Memory[Plot->Head];
+		
+		/* Reload shadow registers at vertical blanking */
+		LTDC->SRCR = LTDC_SRCR_VBR;
+	} else {
+		/* Move old columns left with one transfer, DMA2D reads ahead of writes so overlap to the left is safe */
+		if (count < Plot->Width) {
+			TM_DMA2DGRAPHIC_CopyBuffer(
+				&Plot->Memory[count],
+				Plot->Memory,
+				Plot->Width - count,
+				Plot->Height,
+				Plot->Pitch - (Plot->Width - count),
+				Plot->Pitch - (Plot->Width - count)
+			);
+		}
+		
+		/* Wait for transfer before CPU writes new columns */
+		TM_DMA2DGRAPHIC_WaitIdle();
+		
+		/* Draw new columns on the right side */
+		column = &Plot->Memory[Plot->Width - count];
+		for (i = 0; i < count; i++) {
+			TM_PLOT_INT_DrawColumn(Plot, column++, 0, TM_PLOT_INT_GetRow(Plot, Samples[i]));
+		}
+	}
+}
+
+/* Private functions */
+static int16_t TM_PLOT_INT_GetRow(TM_PLOT_t* Plot, int16_t sample) {
+	/* Limit sample to plot range */
+	if (sample <= Plot->Min) {
+		return Plot->Height - 1;
+	}
+	if (sample >= Plot->Max) {
+		return 0;
+	}
+	
+	/* Max is on top, row 0 */
+	return (int16_t)(((uint32_t)(Plot->Max - sample) * Plot->Scale + 0x8000) >> 16);
+}
+
+static void TM_PLOT_INT_DrawColumn(TM_PLOT_t* Plot, uint16_t* column, uint32_t mirror, int16_t row) {
+	int16_t top, bottom, y;
+	
+	/* Line from previous sample to new one, first sample is only one pixel */
+	if (Plot->LastY < 0) {
+		Plot->LastY = row;
+	}
+	if (Plot->LastY < row) {
+		top = Plot->LastY;
+		bottom = row;
+	} else {
+		top = row;
+		bottom = Plot->LastY;
+	}
+	Plot->LastY = row;
+	
+	/* Write whole column, mirror is second copy of column in ring */
+	for (y = 0; y < Plot->Height; y++) {
+		if (y >= top && y <= bottom) {
+			*column = Plot->Color;
+		} else {
+			*column = Plot->Background;
+		}
+		if (mirror) {
+			column[mirror] = *column;
+		}
+		column += Plot->Pitch;
+	}
+}
+
+static void TM_PLOT_INT_SetLayer(TM_PLOT_t* Plot) {
+	uint32_t hbp, vbp;
+	
+	/* Accumulated back porch, window coordinates of LTDC start after it */
+	hbp = (LTDC->BPCR >> 16) & 0xFFF;
+	vbp = LTDC->BPCR & 0x7FF;
+	
+	/* Window is at plot position */
+	LTDC_Layer2->WHPCR = ((hbp + Plot->X + Plot->Width) << 16) | (hbp + Plot->X + 1);
+	LTDC_Layer2->WVPCR = ((vbp + Plot->Y + Plot->Height) << 16) | (vbp + Plot->Y + 1);
+	
+	/* RGB565, opaque */
+	LTDC_Layer2->PFCR = LTDC_PIXEL_FORMAT_RGB565;
+	LTDC_Layer2->CACR = 255;
+	LTDC_Layer2->DCCR = 0;
+	LTDC_Layer2->BFCR = LTDC_BLENDING_FACTOR1_CA | LTDC_BLENDING_FACTOR2_CA;
+	
+	/* Line length is plot width, pitch is ring width */
+	LTDC_Layer2->CFBAR = (uint32_t)&Plot->Memory[Plot->Head];
+	LTDC_Layer2->CFBLR = ((Plot->Pitch * 2) << 16) | (Plot->Width * 2 + 3);
+	LTDC_Layer2->CFBLNR = Plot->Height;
+	
+	/* Enable layer */
+	LTDC_Layer2->CR |= LTDC_LxCR_LEN;
+	
+	/* Reload shadow registers at vertical blanking */
+	LTDC->SRCR = LTDC_SRCR_VBR;
+}
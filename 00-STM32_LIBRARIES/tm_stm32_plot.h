@@ -0,0 +1,250 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Scrolling waveform plot on LTDC layer with incremental drawing for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_PLOT_H
+#define TM_PLOT_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_PLOT
+ * @brief    Scrolling waveform plot on LTDC layer with incremental drawing for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Library draws scrolling trace of samples, for example ADC data. New sample is added on the right side
+ * of plot and old samples move to the left. Only new columns are drawn, so drawing time depends on number
+ * of new samples and not on plot width.
+ *
+ * Each column is drawn with background color and vertical line from previous to current sample.
+ *
+ * \par Layer mode
+ *
+ * Plot uses LTDC layer 2 with own memory, @ref PLOT_LAYER_MEMORY. Memory is ring of columns,
+ * which is 2 times wider than plot. Each new column is written twice, at ring position and at position + plot width,
+ * so visible part of ring is always contiguous in memory.
+ * Scrolling is done only by moving LTDC layer start address, which is reloaded in vertical blanking period.
+ * Nothing is copied at all.
+ *
+ * Layer 2 window is set to plot position and layer 1 is visible around it.
+ *
+ * @note  Layer 2 is owned by plot in this mode. Do not use @ref TM_LCD_SetLayer2, @ref TM_LCD_SetLayer2Opacity,
+ *        layer functions and double buffering of TM LCD library at the same time.
+ *
+ * \par DMA2D mode
+ *
+ * Plot is drawn on layer 1, returned by @ref TM_LCD_GetFrameBuffer. On each @ref TM_PLOT_AddSamples call,
+ * plot area is moved left for number of new samples with one DMA2D memory to memory transfer
+ * and only new columns are drawn on the right side. Use this mode when layer 2 is used for something else.
+ *
+ * @note  Content of frame buffer is moved, so double buffering (@ref TM_LCD_BeginFrame) can not be used in this mode
+ *
+ * Both modes work in normal LCD orientation only, which is default orientation.
+ *
+\code
+TM_PLOT_t Plot;
+
+//Init LCD first
+TM_LCD_Init();
+
+//Plot 400x200 pixels at 40,36 for 12-bit ADC values
+TM_PLOT_Init(&Plot, TM_PLOT_Mode_Layer, 40, 36, 400, 200, 0, 4095, LCD_COLOR_GREEN, LCD_COLOR_BLACK);
+
+while (1) {
+	//Add all new samples at once, for example half of DMA buffer
+	if (samples_ready) {
+		TM_PLOT_AddSamples(&Plot, adc_samples, 64);
+	}
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32F4xx/STM32F7xx HAL
+ - defines.h
+ - TM LCD
+ - TM DMA2D GRAPHIC
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_lcd.h"
+#include "tm_stm32_dma2d_graphic.h"
+
+/**
+ * @defgroup TM_PLOT_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Memory for column ring in layer mode, 2 * width * height * 2 bytes is used. Default is after both LCD layers */
+#ifndef PLOT_LAYER_MEMORY
+#define PLOT_LAYER_MEMORY    (LCD_FRAME_BUFFER + 2 * LCD_BUFFER_OFFSET)
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_PLOT_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Plot scrolling mode
+ */
+typedef enum _TM_PLOT_Mode_t {
+	TM_PLOT_Mode_Layer = 0x00, /*!< Plot on LTDC layer 2, scrolling by moving layer start address */
+	TM_PLOT_Mode_DMA2D         /*!< Plot on layer 1, scrolling by one DMA2D transfer */
+} TM_PLOT_Mode_t;
+
+/**
+ * @brief  Plot structure
+ * @note   Values are set in @ref TM_PLOT_Init function and should not be changed by user
+ */
+typedef struct _TM_PLOT_t {
+	TM_PLOT_Mode_t Mode; /*!< Scrolling mode */
+	uint16_t X;          /*!< X position of top left corner on LCD */
+	uint16_t Y;          /*!< Y position of top left corner on LCD */
+	uint16_t Width;      /*!< Plot width in pixels, one column per sample */
+	uint16_t Height;     /*!< Plot height in pixels */
+	int32_t Min;         /*!< Sample value at bottom of plot */
+	int32_t Max;         /*!< Sample value at top of plot */
+	uint32_t Scale;      /*!< Pixels per sample value, 16.16 fixed point */
+	uint16_t Color;      /*!< Trace color in RGB565 format */
+	uint16_t Background; /*!< Background color in RGB565 format */
+	uint16_t* Memory;    /*!< Start of plot memory, column ring in layer mode or frame buffer in DMA2D mode */
+	uint32_t Pitch;      /*!< Number of pixels between 2 rows in memory */
+	uint16_t Head;       /*!< Ring position of next column in layer mode */
+	int16_t LastY;       /*!< Row of last sample, -1 when plot is empty */
+} TM_PLOT_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_PLOT_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes plot and clears it with background color
+ * @note   LCD must be initialized first
+ * @param  *Plot: Pointer to empty @ref TM_PLOT_t structure
+ * @param  Mode: Scrolling mode. This parameter can be a value of @ref TM_PLOT_Mode_t enumeration
+ * @param  x: X position of top left corner on LCD
+ * @param  y: Y position of top left corner on LCD
+ * @param  width: Plot width in pixels
+ * @param  height: Plot height in pixels
+ * @param  min: Sample value at bottom of plot
+ * @param  max: Sample value at top of plot, must be greater than min
+ * @param  color: Trace color in RGB565 format
+ * @param  background: Background color in RGB565 format
+ * @retval Member of @ref TM_LCD_Result_t enumeration
+ */
+TM_LCD_Result_t TM_PLOT_Init(TM_PLOT_t* Plot, TM_PLOT_Mode_t Mode, uint16_t x, uint16_t y, uint16_t width, uint16_t height, int32_t min, int32_t max, uint32_t color, uint32_t background);
+
+/**
+ * @brief  Disables plot layer in layer mode. In DMA2D mode plot area stays on LCD
+ * @param  *Plot: Pointer to @ref TM_PLOT_t structure
+ * @retval None
+ */
+void TM_PLOT_DeInit(TM_PLOT_t* Plot);
+
+/**
+ * @brief  Adds new samples to the right side of plot, oldest samples are removed on the left
+ * @note   Only new columns are drawn. When more samples than plot width are added, only last are drawn
+ * @param  *Plot: Pointer to @ref TM_PLOT_t structure
+ * @param  *Samples: Pointer to samples, values outside min and max are drawn at plot edge
+ * @param  count: Number of samples
+ * @retval None
+ */
+void TM_PLOT_AddSamples(TM_PLOT_t* Plot, const int16_t* Samples, uint16_t count);
+
+/**
+ * @brief  Adds one sample to the right side of plot
+ * @param  *Plot: Pointer to @ref TM_PLOT_t structure
+ * @param  sample: Sample value
+ * @retval None
+ */
+void TM_PLOT_AddSample(TM_PLOT_t* Plot, int16_t sample);
+
+/**
+ * @brief  Clears plot with background color
+ * @param  *Plot: Pointer to @ref TM_PLOT_t structure
+ * @retval None
+ */
+void TM_PLOT_Clear(TM_PLOT_t* Plot);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,237 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_pool.h"
+#if POOL_FREERTOS_HEAP
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/* Block size rounded up to words */
+#define POOL_WORDS(size)      (((size) + 3) / 4)
+
+/* Private pool structure */
+typedef struct {
+	uint32_t* Start;      /* First block */
+	uint32_t* End;        /* Memory after last block */
+	uint32_t* Free;       /* First free block, first word of free block points to next free block */
+	uint16_t Words;       /* Block size in words */
+	uint16_t Count;       /* Number of blocks */
+	uint16_t Used;        /* Used blocks */
+	uint16_t MaxUsed;     /* Maximal used blocks */
+	uint32_t Fails;       /* Failed allocations */
+} TM_POOL_INT_t;
+
+/* Pools memory, at least 1 word each */
+static uint32_t POOL_Memory0[POOL_WORDS(POOL_BLOCK_SIZE_0) * POOL_BLOCK_COUNT_0 + 1] POOL_MEMORY_ATTRIBUTE;
+static uint32_t POOL_Memory1[POOL_WORDS(POOL_BLOCK_SIZE_1) * POOL_BLOCK_COUNT_1 + 1] POOL_MEMORY_ATTRIBUTE;
+static uint32_t POOL_Memory2[POOL_WORDS(POOL_BLOCK_SIZE_2) * POOL_BLOCK_COUNT_2 + 1] POOL_MEMORY_ATTRIBUTE;
+static uint32_t POOL_Memory3[POOL_WORDS(POOL_BLOCK_SIZE_3) * POOL_BLOCK_COUNT_3 + 1] POOL_MEMORY_ATTRIBUTE;
+
+/* Pools */
+static TM_POOL_INT_t POOL_Pools[POOL_COUNT] = {
+	{POOL_Memory0, NULL, NULL, POOL_WORDS(POOL_BLOCK_SIZE_0), POOL_BLOCK_COUNT_0, 0, 0, 0},
+	{POOL_Memory1, NULL, NULL, POOL_WORDS(POOL_BLOCK_SIZE_1), POOL_BLOCK_COUNT_1, 0, 0, 0},
+	{POOL_Memory2, NULL, NULL, POOL_WORDS(POOL_BLOCK_SIZE_2), POOL_BLOCK_COUNT_2, 0, 0, 0},
+	{POOL_Memory3, NULL, NULL, POOL_WORDS(POOL_BLOCK_SIZE_3), POOL_BLOCK_COUNT_3, 0, 0, 0},
+};
+static uint8_t POOL_Initialized = 0;
+
+/* Private functions */
+static void TM_POOL_INT_Init(void);
+
+void* TM_POOL_Alloc(size_t size) {
+	TM_POOL_INT_t* pool;
+	uint32_t* block = NULL;
+	uint32_t irq;
+	uint8_t i, first = POOL_COUNT;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Init pools */
+	if (!POOL_Initialized) {
+		TM_POOL_INT_Init();
+	}
+	
+	/* Find smallest pool with free block */
+	for (i = 0; i < POOL_COUNT; i++) {
+		pool = &POOL_Pools[i];
+		if (pool->Count == 0 || (pool->Words * 4) < size) {
+			continue;
+		}
+		if (first == POOL_COUNT) {
+			first = i;
+		}
+		
+		/* Take first free block, if empty try bigger pool */
+		if (pool->Free) {
+			block = pool->Free;
+			pool->Free = *(uint32_t **)block;
+			if (++pool->Used > pool->MaxUsed) {
+				pool->MaxUsed = pool->Used;
+			}
+			break;
+		}
+	}
+	
+	/* Count failure to smallest pool for this size */
+	if (block == NULL && first < POOL_COUNT) {
+		POOL_Pools[first].Fails++;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return block */
+	return block;
+}
+
+void TM_POOL_Free(void* ptr) {
+	TM_POOL_INT_t* pool;
+	uint32_t* block = (uint32_t *)ptr;
+	uint32_t irq;
+	uint8_t i;
+	
+	/* Check pointer */
+	if (ptr == NULL || !POOL_Initialized) {
+		return;
+	}
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Find pool of block */
+	for (i = 0; i < POOL_COUNT; i++) {
+		pool = &POOL_Pools[i];
+		if (block >= pool->Start && block < pool->End) {
+			/* Put block to beginning of free list */
+			*(uint32_t **)block = pool->Free;
+			pool->Free = block;
+			pool->Used--;
+			break;
+		}
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+uint8_t TM_POOL_GetStats(uint8_t pool, TM_POOL_Stats_t* Stats) {
+	/* Check pool */
+	if (pool >= POOL_COUNT || POOL_Pools[pool].Count == 0) {
+		return 0;
+	}
+	
+	/* Save statistics */
+	Stats->BlockSize = POOL_Pools[pool].Words * 4;
+	Stats->Count = POOL_Pools[pool].Count;
+	Stats->Used = POOL_Pools[pool].Used;
+	Stats->MaxUsed = POOL_Pools[pool].MaxUsed;
+	Stats->Fails = POOL_Pools[pool].Fails;
+	
+	/* Return OK */
+	return 1;
+}
+
+#if POOL_FREERTOS_HEAP
+/***************************************************/
+/*                FreeRTOS heap functions          */
+/***************************************************/
+
+void* pvPortMalloc(size_t xWantedSize) {
+	void* ptr;
+	
+	/* Take block, pools are protected with disabled interrupts */
+	ptr = TM_POOL_Alloc(xWantedSize);
+	traceMALLOC(ptr, xWantedSize);
+	
+#if configUSE_MALLOC_FAILED_HOOK == 1
+	/* Call hook on failure */
+	if (ptr == NULL) {
+		extern void vApplicationMallocFailedHook(void);
+		vApplicationMallocFailedHook();
+	}
+#endif
+	
+	/* Return block */
+	return ptr;
+}
+
+void vPortFree(void* pv) {
+	/* Return block to pool, static task stacks are ignored */
+	TM_POOL_Free(pv);
+	traceFREE(pv, 0);
+}
+
+void vPortInitialiseBlocks(void) {
+	/* Pools are initialized on first allocation */
+}
+
+size_t xPortGetFreeHeapSize(void) {
+	size_t size = 0;
+	uint8_t i;
+	
+	/* Count free blocks in all pools */
+	for (i = 0; i < POOL_COUNT; i++) {
+		size += (size_t)(POOL_Pools[i].Count - POOL_Pools[i].Used) * POOL_Pools[i].Words * 4;
+	}
+	
+	return size;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+	size_t size = 0;
+	uint8_t i;
+	
+	/* Each pool can reach its high water mark at different time, result is not bigger than real minimum */
+	for (i = 0; i < POOL_COUNT; i++) {
+		size += (size_t)(POOL_Pools[i].Count - POOL_Pools[i].MaxUsed) * POOL_Pools[i].Words * 4;
+	}
+	
+	return size;
+}
+#endif
+
+/* Called with disabled interrupts */
+static void TM_POOL_INT_Init(void) {
+	TM_POOL_INT_t* pool;
+	uint16_t i, j;
+	
+	for (i = 0; i < POOL_COUNT; i++) {
+		pool = &POOL_Pools[i];
+		pool->End = pool->Start + pool->Words * pool->Count;
+		pool->Free = NULL;
+		
+		/* Link all blocks to free list, from last to first */
+		for (j = pool->Count; j > 0; j--) {
+			uint32_t* block = pool->Start + (j - 1) * pool->Words;
+			*(uint32_t **)block = pool->Free;
+			pool->Free = block;
+		}
+	}
+	
+	POOL_Initialized = 1;
+}
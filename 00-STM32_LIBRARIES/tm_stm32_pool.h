@@ -0,0 +1,276 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.2
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Fixed block memory pool allocator for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_POOL_H
+#define TM_POOL_H 120
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_POOL
+ * @brief    Fixed block memory pool allocator for STM32Fxxx
+ * @{
+ *
+ * Library allocates memory from up to 4 pools of fixed size blocks, which are allocated at compile time.
+ * Allocation and free take constant time and memory can not fragment like heap does.
+ *
+ * @ref TM_POOL_Alloc takes block from smallest pool with blocks big enough for requested size.
+ * If that pool is empty, next bigger pool is used.
+ *
+ * \par Use with other libraries
+ *
+ * Libraries which allocate memory with @ref LIB_ALLOC_FUNC and @ref LIB_FREE_FUNC (TM BUTTON, TM STRING, TM BUFFER, TM FFT, TM FATFS, TM GPS)
+ * use pools instead of malloc when LIB_USE_POOL is enabled in defines.h file.
+ *
+\code
+//Use pools in all libraries
+#define LIB_USE_POOL          1
+\endcode
+ *
+ * \par Configuration
+ *
+ * Pool is disabled when its block count is 0. Block size is rounded up to multiple of 4 bytes.
+ *
+\code
+//Pool 0: 16 blocks of 16 bytes
+#define POOL_BLOCK_SIZE_0     16
+#define POOL_BLOCK_COUNT_0    16
+//Pool 1: 8 blocks of 64 bytes
+#define POOL_BLOCK_SIZE_1     64
+#define POOL_BLOCK_COUNT_1    8
+//Pool 2: 4 blocks of 256 bytes
+#define POOL_BLOCK_SIZE_2     256
+#define POOL_BLOCK_COUNT_2    4
+//Pool 3: disabled
+#define POOL_BLOCK_SIZE_3     1024
+#define POOL_BLOCK_COUNT_3    0
+
+//Place pools memory to CCM RAM or SDRAM section, defined in linker script
+#define POOL_MEMORY_ATTRIBUTE __attribute__((section(".ccmram")))
+\endcode
+ *
+ * @note   CCM RAM can not be accessed by DMA, do not place pools there if memory is used for DMA buffers
+ *
+ * \par FreeRTOS heap
+ *
+ * When @ref POOL_FREERTOS_HEAP is enabled, library implements FreeRTOS heap functions (pvPortMalloc, vPortFree, ...)
+ * with pools, so tasks, queues, semaphores and TM library objects all come from the same compile-time memory.
+ * Allocation time is constant and memory can not fragment after long uptime.
+ * Pool sizes must fit task control block, queues and task stacks, or stacks can be static with osThreadStaticDef in cmsis_os.h.
+ * Use @ref TM_POOL_GetStats to tune block counts.
+ *
+\code
+//Static allocation profile
+#define LIB_USE_POOL          1
+#define POOL_FREERTOS_HEAP    1
+\endcode
+ *
+ * @note   Do not add any heap_x.c file from FreeRTOS/portable/MemMang to project when FreeRTOS heap is in pools
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added FreeRTOS heap implementation with pools
+  
+ Version 1.2
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - FreeRTOS (only when POOL_FREERTOS_HEAP)
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+
+/**
+ * @defgroup TM_POOL_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Pools block sizes in bytes and number of blocks
+ * @note   Pools must be ordered by block size, smallest first
+ */
+#ifndef POOL_BLOCK_SIZE_0
+#define POOL_BLOCK_SIZE_0     16
+#endif
+#ifndef POOL_BLOCK_COUNT_0
+#define POOL_BLOCK_COUNT_0    16
+#endif
+#ifndef POOL_BLOCK_SIZE_1
+#define POOL_BLOCK_SIZE_1     64
+#endif
+#ifndef POOL_BLOCK_COUNT_1
+#define POOL_BLOCK_COUNT_1    8
+#endif
+#ifndef POOL_BLOCK_SIZE_2
+#define POOL_BLOCK_SIZE_2     256
+#endif
+#ifndef POOL_BLOCK_COUNT_2
+#define POOL_BLOCK_COUNT_2    4
+#endif
+#ifndef POOL_BLOCK_SIZE_3
+#define POOL_BLOCK_SIZE_3     1024
+#endif
+#ifndef POOL_BLOCK_COUNT_3
+#define POOL_BLOCK_COUNT_3    0
+#endif
+
+/**
+ * @brief  Attribute for pools memory, to place it to custom linker section
+ */
+#ifndef POOL_MEMORY_ATTRIBUTE
+#define POOL_MEMORY_ATTRIBUTE
+#endif
+
+/**
+ * @brief  Implement FreeRTOS heap with pools, disabled by default
+ */
+#ifndef POOL_FREERTOS_HEAP
+#define POOL_FREERTOS_HEAP    0
+#endif
+
+/**
+ * @brief  Number of pools
+ */
+#define POOL_COUNT            4
+
+/* Set library allocation functions */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#ifndef LIB_ALLOC_FUNC
+#define LIB_ALLOC_FUNC        TM_POOL_Alloc
+#endif
+#ifndef LIB_FREE_FUNC
+#define LIB_FREE_FUNC         TM_POOL_Free
+#endif
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_POOL_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Pool statistics
+ */
+typedef struct {
+	uint32_t BlockSize;   /*!< Size of one block in bytes */
+	uint16_t Count;       /*!< Number of all blocks */
+	uint16_t Used;        /*!< Number of currently used blocks */
+	uint16_t MaxUsed;     /*!< High water mark, maximal number of used blocks at the same time */
+	uint32_t Fails;       /*!< Number of allocations which could not be served because pool and all bigger pools were empty */
+} TM_POOL_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_POOL_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Allocates memory block
+ * @note   Pools are initialized on first call
+ * @param  size: Number of bytes to allocate
+ * @retval Pointer to allocated memory or NULL if no block is available
+ */
+void* TM_POOL_Alloc(size_t size);
+
+/**
+ * @brief  Frees memory block allocated with @ref TM_POOL_Alloc
+ * @param  *ptr: Pointer to memory. NULL and pointers outside pools are ignored
+ * @retval None
+ */
+void TM_POOL_Free(void* ptr);
+
+/**
+ * @brief  Gets statistics of one pool
+ * @param  pool: Pool number, 0 to POOL_COUNT - 1
+ * @param  *Stats: Pointer to @ref TM_POOL_Stats_t structure to save statistics to
+ * @retval Status:
+ *            - 0: Pool does not exist or is disabled
+ *            - > 0: Statistics saved
+ */
+uint8_t TM_POOL_GetStats(uint8_t pool, TM_POOL_Stats_t* Stats);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,396 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_power.h"
+
+/* RTC write protection keys */
+#define POWER_RTC_UNLOCK()        do { RTC->WPR = 0xCA; RTC->WPR = 0x53; } while (0)
+#define POWER_RTC_LOCK()          (RTC->WPR = 0xFF)
+
+/* Registered hooks and statistics */
+static TM_POWER_Hook_t* Power_Hooks = NULL;
+static TM_POWER_Stats_t Power_Stats;
+
+/* Maximal wakeup latency rounded up to milliseconds */
+static uint32_t Power_WakeupMs = 0;
+
+#if POWER_USE_PVD
+/* Voltage status from last PVD event */
+static __IO uint8_t Power_VoltageLow = 0;
+#endif
+
+/* Private functions */
+static uint8_t TM_POWER_INT_Suspend(void);
+static void TM_POWER_INT_Resume(TM_POWER_Hook_t* Last);
+static uint32_t TM_POWER_INT_GetRTCClock(void);
+static uint32_t TM_POWER_INT_GetRTCTime(void);
+static uint32_t TM_POWER_INT_Stop(uint32_t Millis, uint32_t rtcclock);
+
+TM_POWER_Result_t TM_POWER_Init(void) {
+	/* Enable PWR clock and access to RTC registers */
+	__HAL_RCC_PWR_CLK_ENABLE();
+	HAL_PWR_EnableBkUpAccess();
+	
+	/* Reset statistics */
+	memset(&Power_Stats, 0, sizeof(Power_Stats));
+	Power_WakeupMs = 0;
+	
+	/* Wakeup latency is measured with DWT counter */
+	if (!TM_GENERAL_DWTCounterEnable()) {
+		return TM_POWER_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_POWER_Result_Ok;
+}
+
+void TM_POWER_AddHook(TM_POWER_Hook_t* Hook, uint8_t (*Suspend)(TM_POWER_Hook_t *), void (*Resume)(TM_POWER_Hook_t *), void (*Voltage)(TM_POWER_Hook_t *, uint8_t), void* UserParameters) {
+	TM_POWER_Hook_t** tmp;
+	uint32_t irq;
+	
+	/* Fill settings */
+	Hook->Suspend = Suspend;
+	Hook->Resume = Resume;
+	Hook->Voltage = Voltage;
+	Hook->UserParameters = UserParameters;
+	Hook->Next = NULL;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Add to end of list, hooks are called in order */
+	tmp = &Power_Hooks;
+	while (*tmp) {
+		tmp = &(*tmp)->Next;
+	}
+	*tmp = Hook;
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+void TM_POWER_RemoveHook(TM_POWER_Hook_t* Hook) {
+	TM_POWER_Hook_t** tmp;
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Find hook and remove it */
+	for (tmp = &Power_Hooks; *tmp; tmp = &(*tmp)->Next) {
+		if (*tmp == Hook) {
+			*tmp = Hook->Next;
+			Hook->Next = NULL;
+			break;
+		}
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+TM_POWER_Mode_t TM_POWER_Idle(void) {
+	TM_POWER_Mode_t mode = TM_POWER_Mode_Sleep;
+	uint32_t irq, idle, rtcclock, min;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+	
+	/* Disable interrupts, pending interrupt still wakes up core */
+	__disable_irq();
+	
+	/* Minimal idle time for Stop mode, wakeup timer is set earlier for latency */
+	min = POWER_STOP_MIN_TIME + Power_WakeupMs;
+	
+	/* Stop mode needs RTC wakeup timer and enough time till first software timer */
+	rtcclock = TM_POWER_INT_GetRTCClock();
+	if (rtcclock && TM_DELAY_GetIdleTime() >= min) {
+		/* Drivers must be idle */
+		if (TM_POWER_INT_Suspend()) {
+			/* Stop SysTick, time is checked again with timers up to maximal tickless period */
+			idle = TM_DELAY_StopTicks(min);
+			if (idle) {
+				/* Go to Stop mode, SysTick and hooks are started again inside */
+				Power_Stats.StopTime += TM_POWER_INT_Stop(idle - Power_WakeupMs, rtcclock);
+				Power_Stats.StopCount++;
+				mode = TM_POWER_Mode_Stop;
+			} else {
+				/* Timer expires earlier, resume all drivers */
+				TM_POWER_INT_Resume(NULL);
+			}
+		} else {
+			/* Driver is busy */
+			Power_Stats.BusyCount++;
+		}
+	}
+	
+	/* Sleep mode when Stop mode was not used */
+	if (mode == TM_POWER_Mode_Sleep) {
+		/* Stretch SysTick period, do not sleep if SysTick interrupt is pending */
+		if (TM_DELAY_SuppressTicks(DELAY_TICKLESS_MAX_PERIOD)) {
+			/* Wait for wake up interrupt */
+			__WFI();
+			Power_Stats.SleepCount++;
+		} else {
+			mode = TM_POWER_Mode_Run;
+		}
+		
+		/* Process slept time in SysTick if woken by other interrupt */
+		TM_DELAY_ResumeTicks();
+	}
+	
+	/* Enable interrupts, process interrupt which woke up core */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Return used mode */
+	return mode;
+}
+
+void TM_POWER_GetStats(TM_POWER_Stats_t* Stats) {
+	uint32_t irq;
+	
+	/* Copy with disabled interrupts */
+	irq = TM_NVIC_Lock();
+	memcpy(Stats, &Power_Stats, sizeof(TM_POWER_Stats_t));
+	TM_NVIC_Unlock(irq);
+}
+
+void TM_POWER_Dump(void (*OutputFunc)(char *)) {
+	TM_POWER_Stats_t stats;
+	char str[64];
+	
+	/* Get statistics */
+	TM_POWER_GetStats(&stats);
+	
+	/* Print statistics */
+	sprintf(str, "Stop: %lu times, %lu ms\n", (unsigned long)stats.StopCount, (unsigned long)stats.StopTime);
+	OutputFunc(str);
+	sprintf(str, "Sleep: %lu times, busy: %lu times\n", (unsigned long)stats.SleepCount, (unsigned long)stats.BusyCount);
+	OutputFunc(str);
+	sprintf(str, "Wakeup: %lu us, max %lu us\n", (unsigned long)stats.WakeupLast, (unsigned long)stats.WakeupMax);
+	OutputFunc(str);
+}
+
+#if POWER_USE_PVD
+uint8_t TM_POWER_VoltageLow(void) {
+	return Power_VoltageLow;
+}
+
+/* PVD interrupt user callback from TM PVD library */
+void TM_PVD_Handler(uint8_t status) {
+	TM_POWER_Hook_t* hook;
+	
+	/* Save status */
+	Power_VoltageLow = status ? 1 : 0;
+	
+	/* Notify drivers */
+	for (hook = Power_Hooks; hook; hook = hook->Next) {
+		if (hook->Voltage) {
+			hook->Voltage(hook, Power_VoltageLow);
+		}
+	}
+}
+#endif
+
+/******************************************************************/
+/*                          PRIVATE FUNCTIONS                     */
+/******************************************************************/
+/* Called with disabled interrupts */
+static uint8_t TM_POWER_INT_Suspend(void) {
+	TM_POWER_Hook_t* hook;
+	
+	/* Suspend drivers in order */
+	for (hook = Power_Hooks; hook; hook = hook->Next) {
+		if (hook->Suspend && !hook->Suspend(hook)) {
+			/* Driver is busy, resume already suspended drivers */
+			TM_POWER_INT_Resume(hook);
+			return 0;
+		}
+	}
+	
+#if POWER_USE_SDRAM
+	/* SDRAM self-refresh, after drivers which may use SDRAM */
+	while (FMC_Bank5_6->SDSR & FMC_SDSR_BUSY);
+	FMC_Bank5_6->SDCMR = FMC_SDRAM_CMD_SELFREFRESH_MODE | SDRAM_COMMAND_TARGET_BANK;
+	while (FMC_Bank5_6->SDSR & FMC_SDSR_BUSY);
+#endif
+	
+	/* All drivers are suspended */
+	return 1;
+}
+
+/* Called with disabled interrupts, resumes hooks before Last or all when NULL */
+static void TM_POWER_INT_Resume(TM_POWER_Hook_t* Last) {
+	TM_POWER_Hook_t* hook;
+	
+#if POWER_USE_SDRAM
+	/* SDRAM back to normal mode, before drivers which may use SDRAM */
+	if (Last == NULL) {
+		FMC_Bank5_6->SDCMR = FMC_SDRAM_CMD_NORMAL_MODE | SDRAM_COMMAND_TARGET_BANK;
+		while (FMC_Bank5_6->SDSR & FMC_SDSR_BUSY);
+	}
+#endif
+	
+	/* Resume drivers in order */
+	for (hook = Power_Hooks; hook && hook != Last; hook = hook->Next) {
+		if (hook->Resume) {
+			hook->Resume(hook);
+		}
+	}
+}
+
+/* Gets RTC clock for wakeup timer, 0 when Stop mode can not be used */
+static uint32_t TM_POWER_INT_GetRTCClock(void) {
+	/* RTC must run and wakeup timer must not be used by user */
+	if (!(RCC->BDCR & RCC_BDCR_RTCEN) || (RTC->CR & RTC_CR_WUTE)) {
+		return 0;
+	}
+	
+	/* Only LSE and LSI run in Stop mode */
+	switch (RCC->BDCR & RCC_BDCR_RTCSEL) {
+		case RCC_BDCR_RTCSEL_0:
+			return LSE_VALUE;
+		case RCC_BDCR_RTCSEL_1:
+			return LSI_VALUE;
+		default:
+			return 0;
+	}
+}
+
+/* Gets RTC time of day in units of subseconds */
+static uint32_t TM_POWER_INT_GetRTCTime(void) {
+	uint32_t ssr, tr, prediv;
+	
+	/* Reading SSR locks TR and DR till DR is read */
+	ssr = RTC->SSR;
+	tr = RTC->TR;
+	(void)RTC->DR;
+	
+	/* Subseconds count down from synchronous prescaler */
+	prediv = RTC->PRER & RTC_PRER_PREDIV_S;
+	
+	/* Seconds of day from BCD */
+	tr = ((tr >> 20) & 0x03) * 36000 + ((tr >> 16) & 0x0F) * 3600 +
+	     ((tr >> 12) & 0x07) * 600 + ((tr >> 8) & 0x0F) * 60 +
+	     ((tr >> 4) & 0x07) * 10 + (tr & 0x0F);
+	
+	/* Return time in subseconds */
+	return tr * (prediv + 1) + (prediv - ssr);
+}
+
+/* Called with disabled interrupts and suspended hooks, returns time in Stop mode in milliseconds */
+static uint32_t TM_POWER_INT_Stop(uint32_t Millis, uint32_t rtcclock) {
+	uint32_t ticks, start, wakeup, hsi, timeout, prediv, enabled;
+	
+	/* Wakeup timer counts RTC clock divided by 16, 16-bit counter */
+	ticks = (uint32_t)(((uint64_t)Millis * rtcclock) / 16000);
+	if (ticks < 1) {
+		ticks = 1;
+	}
+	if (ticks > 0x10000) {
+		ticks = 0x10000;
+	}
+	
+	/* Set wakeup timer */
+	POWER_RTC_UNLOCK();
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE | RTC_CR_WUCKSEL);
+	timeout = 0xFFFF;
+	while (!(RTC->ISR & RTC_ISR_WUTWF) && --timeout);
+	RTC->WUTR = ticks - 1;
+	RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) & 0xFFFF;
+	RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+	POWER_RTC_LOCK();
+	
+	/* EXTI line 22 wakes up core, NVIC must be enabled for wakeup with disabled interrupts */
+	__HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG();
+	__HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_RISING_EDGE();
+	__HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_IT();
+	enabled = NVIC->ISER[(uint32_t)RTC_WKUP_IRQn >> 5] & (1UL << ((uint32_t)RTC_WKUP_IRQn & 0x1F));
+	NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+	NVIC_EnableIRQ(RTC_WKUP_IRQn);
+	
+	/* Time before Stop mode for early wakeup */
+	start = TM_POWER_INT_GetRTCTime();
+	
+	/* Go to Stop mode */
+	HAL_PWR_EnterSTOPMode(POWER_STOP_REGULATOR, PWR_STOPENTRY_WFI);
+	
+	/* Core runs from HSI now, start PLL again */
+	wakeup = DWT->CYCCNT;
+	TM_RCC_RestoreProfile();
+	hsi = DWT->CYCCNT - wakeup;
+	wakeup = DWT->CYCCNT;
+	
+	/* Check wakeup source */
+	POWER_RTC_UNLOCK();
+	if (RTC->ISR & RTC_ISR_WUTF) {
+		/* Wakeup timer expired, exact time */
+		Millis = (uint32_t)(((uint64_t)ticks * 16000) / rtcclock);
+	} else {
+		/* Woken up by other interrupt, shadow registers must be synchronized after Stop mode */
+		RTC->ISR = ~(RTC_ISR_RSF | RTC_ISR_INIT) & 0xFFFF;
+		timeout = 0xFFFF;
+		while (!(RTC->ISR & RTC_ISR_RSF) && --timeout);
+		
+		/* Elapsed subseconds, time of day may overflow at midnight */
+		prediv = (RTC->PRER & RTC_PRER_PREDIV_S) + 1;
+		ticks = TM_POWER_INT_GetRTCTime();
+		if (ticks < start) {
+			ticks += 86400 * prediv;
+		}
+		Millis = (uint32_t)(((uint64_t)(ticks - start) * 1000) / prediv);
+	}
+	
+	/* Disable wakeup timer */
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) & 0xFFFF;
+	POWER_RTC_LOCK();
+	
+	/* Clear wakeup interrupt, handler is not called */
+	__HAL_RTC_WAKEUPTIMER_EXTI_DISABLE_IT();
+	__HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG();
+	NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+	if (!enabled) {
+		NVIC_DisableIRQ(RTC_WKUP_IRQn);
+	}
+	
+	/* Add stopped time to SysTick time */
+	TM_DELAY_StartTicks(Millis);
+	
+	/* Resume drivers */
+	TM_POWER_INT_Resume(NULL);
+	
+	/* Wakeup latency, HSI part and rest with restored core clock */
+	Power_Stats.WakeupLast = (uint32_t)(((uint64_t)hsi * 1000000) / HSI_VALUE + ((uint64_t)(DWT->CYCCNT - wakeup) * 1000000) / SystemCoreClock);
+	if (Power_Stats.WakeupLast > Power_Stats.WakeupMax) {
+		Power_Stats.WakeupMax = Power_Stats.WakeupLast;
+		Power_WakeupMs = (Power_Stats.WakeupMax + 999) / 1000;
+	}
+	
+	/* Return time in Stop mode */
+	return Millis;
+}
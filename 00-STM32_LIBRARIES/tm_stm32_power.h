@@ -0,0 +1,342 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Power mode manager with Stop mode and driver suspend/resume hooks for STM32F4/7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_POWER_H
+#define TM_POWER_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_POWER
+ * @brief    Power mode manager with Stop mode and driver suspend/resume hooks for STM32F4/7xx
+ * @{
+ *
+ * Library selects low power mode each time main loop is idle. Stop mode is used when all registered drivers
+ * are idle and first software timer from @ref TM_DELAY library expires later than @ref POWER_STOP_MIN_TIME
+ * plus measured wakeup latency. Otherwise core goes to sleep mode, the same as with @ref TM_CPULOAD_GoToSleepMode.
+ *
+ * In Stop mode, all clocks except LSE and LSI are stopped, peripheral registers and SRAM are retained.
+ * RTC wakeup timer wakes up core before first software timer expires, any EXTI line, like button or PVD, wakes it up earlier.
+ * After wakeup, PLL is started again with @ref TM_RCC_RestoreProfile and time spent in Stop mode is added to SysTick time.
+ * All of this is done with disabled interrupts, so interrupt which woke up core is executed with restored clocks.
+ *
+ * \par Driver hooks
+ *
+ * Drivers which must not be stopped in the middle of transfer or must prepare for Stop mode register hook
+ * with @ref TM_POWER_AddHook. Suspend function returns 0 when driver is busy, then Stop mode is not used this time
+ * and already suspended drivers are resumed. Hooks are called in order in which they were added, with disabled interrupts.
+ * Hook structures are owned by user, no memory is allocated.
+ *
+\code
+//USART hook, wait for TX buffer and last byte
+uint8_t USART_Suspend(TM_POWER_Hook_t* Hook) {
+	TM_BUFFER_t* tx = TM_USART_GetTXBuffer(USART1);
+	
+	//Busy when data are still in transmission
+	if ((tx && TM_BUFFER_GetFull(tx)) || !(USART1->SR & USART_SR_TC)) {
+		return 0;
+	}
+	return 1;
+}
+
+//Add hook with suspend function only
+TM_POWER_AddHook(&USART_Hook, USART_Suspend, NULL, NULL, NULL);
+\endcode
+ *
+ * Clock profile is the same after wakeup, so USART baudrate and SPI or I2C prescalers stay valid.
+ * Drivers which change clock profile with @ref TM_RCC_SetProfile use clock callbacks from @ref TM_RCC library instead.
+ *
+ * When @ref POWER_USE_SDRAM is enabled, SDRAM is put to self-refresh mode after all hooks are suspended
+ * and back to normal mode before hooks are resumed, so SDRAM content is kept in Stop mode.
+ *
+ * \par Wakeup latency
+ *
+ * Time from core wakeup till all hooks are resumed is measured with DWT counter each time and reported
+ * with @ref TM_POWER_GetStats and @ref TM_POWER_Dump. Maximal latency is added to minimal stop time
+ * and wakeup timer is set earlier for this time, so software timers are not delayed.
+ * Regulator startup time before core starts is not included, check datasheet for values.
+ *
+ * \par Voltage events
+ *
+ * When @ref POWER_USE_PVD is enabled, library implements @ref TM_PVD_Handler and calls voltage function of each hook,
+ * so drivers can save data or stop writing to flash when voltage falls below threshold set with @ref TM_PVD_Enable.
+ * PVD works in Stop mode too and wakes up core. Brownout reset level is set with @ref TM_BOR library.
+ *
+ * \par Requirements
+ *
+\verbatim
+ - TM DELAY in tickless mode, DELAY_TICKLESS must be set to 1
+ - RTC running from LSE or LSI, initialized with TM_RTC_Init
+ - RTC wakeup timer must not be used by user, Stop mode is not used when it is enabled with TM_RTC_Interrupts
+ - Stop mode is not used while TM DELAY asynchronous delay is pending
+\endverbatim
+ *
+ * Options can be changed in defines.h file:
+ *
+\code
+//Minimal time in Stop mode in milliseconds, sleep mode is used for shorter idle time
+#define POWER_STOP_MIN_TIME      5
+
+//Regulator in Stop mode, low power regulator has longer wakeup time
+#define POWER_STOP_REGULATOR     PWR_LOWPOWERREGULATOR_ON
+
+//Put SDRAM to self-refresh mode in Stop mode
+#define POWER_USE_SDRAM          1
+
+//Call hooks on PVD events
+#define POWER_USE_PVD            1
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM GENERAL
+ - TM RCC
+ - TM DELAY
+ - TM SDRAM, when POWER_USE_SDRAM is used
+ - TM PVD, when POWER_USE_PVD is used
+ - stdio.h
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_general.h"
+#include "tm_stm32_rcc.h"
+#include "tm_stm32_delay.h"
+#include "stdio.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_POWER_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Minimal time in Stop mode in milliseconds */
+#ifndef POWER_STOP_MIN_TIME
+#define POWER_STOP_MIN_TIME      5
+#endif
+
+/* Regulator mode in Stop mode */
+#ifndef POWER_STOP_REGULATOR
+#define POWER_STOP_REGULATOR     PWR_LOWPOWERREGULATOR_ON
+#endif
+
+/* SDRAM self-refresh in Stop mode */
+#ifndef POWER_USE_SDRAM
+#define POWER_USE_SDRAM          0
+#endif
+
+/* Hooks are called on PVD events */
+#ifndef POWER_USE_PVD
+#define POWER_USE_PVD            0
+#endif
+
+/* Include libraries */
+#if POWER_USE_SDRAM
+#include "tm_stm32_sdram.h"
+#endif
+#if POWER_USE_PVD
+#include "tm_stm32_pvd.h"
+#endif
+
+/* Check settings */
+#if defined(STM32F0xx)
+#error "TM POWER library supports STM32F4xx and STM32F7xx devices only!"
+#endif
+#if !DELAY_TICKLESS
+#error "TM POWER library needs DELAY_TICKLESS enabled in TM DELAY library!"
+#endif
+#if POWER_STOP_MIN_TIME < 1
+#error "POWER_STOP_MIN_TIME must be at least 1 millisecond!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_POWER_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_POWER_Result_Ok = 0x00, /*!< Everything OK */
+	TM_POWER_Result_Error      /*!< DWT counter has not started */
+} TM_POWER_Result_t;
+
+/**
+ * @brief  Power mode used by @ref TM_POWER_Idle
+ */
+typedef enum {
+	TM_POWER_Mode_Run = 0x00, /*!< Core did not sleep, interrupt was already pending */
+	TM_POWER_Mode_Sleep,      /*!< Core was in sleep mode */
+	TM_POWER_Mode_Stop        /*!< Core was in Stop mode */
+} TM_POWER_Mode_t;
+
+/**
+ * @brief  Driver hook structure
+ */
+typedef struct _TM_POWER_Hook_t {
+	uint8_t (*Suspend)(struct _TM_POWER_Hook_t *);        /*!< Called before Stop mode, returns 0 when driver is busy. Can be NULL */
+	void (*Resume)(struct _TM_POWER_Hook_t *);            /*!< Called after wakeup with restored clocks. Can be NULL */
+	void (*Voltage)(struct _TM_POWER_Hook_t *, uint8_t);  /*!< Called from PVD interrupt, 1 when voltage is below threshold. Can be NULL */
+	void* UserParameters;                                 /*!< User parameters */
+	struct _TM_POWER_Hook_t* Next;                        /*!< Next hook in list. Use with care */
+} TM_POWER_Hook_t;
+
+/**
+ * @brief  Power statistics
+ */
+typedef struct {
+	uint32_t StopCount;   /*!< Number of Stop mode entries */
+	uint32_t SleepCount;  /*!< Number of sleep mode entries */
+	uint32_t BusyCount;   /*!< Number of times when Stop mode was possible, but driver was busy */
+	uint32_t StopTime;    /*!< Total time in Stop mode in units of milliseconds */
+	uint32_t WakeupLast;  /*!< Last wakeup latency in units of microseconds */
+	uint32_t WakeupMax;   /*!< Maximal wakeup latency in units of microseconds */
+} TM_POWER_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_POWER_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes power manager
+ * @note   System clock must be set with @ref TM_RCC_InitSystem and TM DELAY and TM RTC libraries initialized first
+ * @param  None
+ * @retval Member of @ref TM_POWER_Result_t enumeration
+ */
+TM_POWER_Result_t TM_POWER_Init(void);
+
+/**
+ * @brief  Adds driver hook to list
+ * @param  *Hook: Pointer to empty @ref TM_POWER_Hook_t structure, must be valid till hook is removed
+ * @param  *Suspend: Function called before Stop mode, returns 0 when driver is busy. Can be NULL
+ * @param  *Resume: Function called after wakeup. Can be NULL
+ * @param  *Voltage: Function called on PVD event when @ref POWER_USE_PVD is enabled. Can be NULL
+ * @param  *UserParameters: Pointer to user parameters saved to hook
+ * @retval None
+ */
+void TM_POWER_AddHook(TM_POWER_Hook_t* Hook, uint8_t (*Suspend)(TM_POWER_Hook_t *), void (*Resume)(TM_POWER_Hook_t *), void (*Voltage)(TM_POWER_Hook_t *, uint8_t), void* UserParameters);
+
+/**
+ * @brief  Removes driver hook from list
+ * @param  *Hook: Pointer to @ref TM_POWER_Hook_t structure to remove
+ * @retval None
+ */
+void TM_POWER_RemoveHook(TM_POWER_Hook_t* Hook);
+
+/**
+ * @brief  Puts core to lowest possible power mode till next interrupt
+ * @note   Call from main loop when there is nothing to do or from FreeRTOS idle hook.
+ *         Must not be called from interrupt
+ * @param  None
+ * @retval Member of @ref TM_POWER_Mode_t enumeration
+ */
+TM_POWER_Mode_t TM_POWER_Idle(void);
+
+/**
+ * @brief  Gets power statistics
+ * @param  *Stats: Pointer to @ref TM_POWER_Stats_t structure to fill
+ * @retval None
+ */
+void TM_POWER_GetStats(TM_POWER_Stats_t* Stats);
+
+/**
+ * @brief  Prints power statistics
+ * @param  *OutputFunc: Pointer to function which outputs string, for example over USART
+ * @retval None
+ */
+void TM_POWER_Dump(void (*OutputFunc)(char *));
+
+#if POWER_USE_PVD || defined(DOXYGEN)
+/**
+ * @brief  Checks voltage status from last PVD event
+ * @note   Available when @ref POWER_USE_PVD is enabled
+ * @param  None
+ * @retval 1 when voltage is below PVD threshold, 0 otherwise
+ */
+uint8_t TM_POWER_VoltageLow(void);
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
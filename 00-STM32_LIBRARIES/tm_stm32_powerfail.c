@@ -0,0 +1,273 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_powerfail.h"
+
+/* Flag values in backup SRAM */
+#define POWERFAIL_FLAG_RUNNING    0x52554E21
+#define POWERFAIL_FLAG_CLEAN      0x434C4E21
+
+/* Data in backup SRAM */
+typedef struct {
+	uint32_t Flag;                /* Shutdown flag */
+	uint32_t Count;               /* Number of power fails */
+	uint32_t Check;               /* Inverted count for validation */
+} TM_POWERFAIL_Backup_t;
+
+#define POWERFAIL_BACKUP          ((volatile TM_POWERFAIL_Backup_t *)(BKPSRAM_BASE + POWERFAIL_BKPSRAM_OFFSET))
+
+/* Private variables */
+static TM_POWERFAIL_Handler_t* IRQ_Handlers;
+static TM_POWERFAIL_Handler_t* Flush_Handlers;
+static TM_POWERFAIL_Handler_t File_Handlers[POWERFAIL_FILES];
+static volatile uint8_t Failed;   /* Set in PVD interrupt */
+static uint8_t Done;              /* Flush stage finished */
+static uint32_t FailTime;         /* Tick when power fail was detected */
+
+/* Private functions */
+static void TM_POWERFAIL_INT_Insert(TM_POWERFAIL_Handler_t** List, TM_POWERFAIL_Handler_t* Handler);
+static uint8_t TM_POWERFAIL_INT_Remove(TM_POWERFAIL_Handler_t** List, TM_POWERFAIL_Handler_t* Handler);
+static void TM_POWERFAIL_INT_SyncFile(void* Param);
+
+TM_POWERFAIL_State_t TM_POWERFAIL_Init(TM_PVD_Level_t Level) {
+	TM_POWERFAIL_State_t state = TM_POWERFAIL_State_Unknown;
+	
+	/* Enable access to backup domain and backup SRAM */
+	__HAL_RCC_PWR_CLK_ENABLE();
+	HAL_PWR_EnableBkUpAccess();
+	__HAL_RCC_BKPSRAM_CLK_ENABLE();
+	
+	/* Keep backup SRAM content on VBAT */
+	HAL_PWREx_EnableBkUpReg();
+	
+	/* Check previous shutdown */
+	if (POWERFAIL_BACKUP->Check == ~POWERFAIL_BACKUP->Count) {
+		if (POWERFAIL_BACKUP->Flag == POWERFAIL_FLAG_CLEAN) {
+			state = TM_POWERFAIL_State_Clean;
+		} else if (POWERFAIL_BACKUP->Flag == POWERFAIL_FLAG_RUNNING) {
+			state = TM_POWERFAIL_State_Unclean;
+		}
+	}
+	
+	/* Start counting again on invalid data */
+	if (state == TM_POWERFAIL_State_Unknown) {
+		POWERFAIL_BACKUP->Count = 0;
+		POWERFAIL_BACKUP->Check = 0xFFFFFFFF;
+	}
+	
+	/* We are running now */
+	POWERFAIL_BACKUP->Flag = POWERFAIL_FLAG_RUNNING;
+	
+	/* Reset status */
+	Failed = 0;
+	Done = 0;
+	
+	/* Enable PVD on falling voltage */
+	TM_PVD_Enable(Level, TM_PVD_Trigger_Falling);
+	
+	/* Return previous state */
+	return state;
+}
+
+void TM_POWERFAIL_AddHandler(TM_POWERFAIL_Handler_t* Handler, TM_POWERFAIL_Context_t Context, uint8_t Priority, void (*Function)(void*), void* Param) {
+	uint32_t irq;
+	
+	/* Fill handler */
+	Handler->Function = Function;
+	Handler->Param = Param;
+	Handler->Priority = Priority;
+	
+	/* Disable interrupts, IRQ list is used in PVD interrupt */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Add to list */
+	TM_POWERFAIL_INT_Insert(Context == TM_POWERFAIL_Context_IRQ ? &IRQ_Handlers : &Flush_Handlers, Handler);
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_POWERFAIL_RemoveHandler(TM_POWERFAIL_Handler_t* Handler) {
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Remove from any list */
+	if (!TM_POWERFAIL_INT_Remove(&IRQ_Handlers, Handler)) {
+		TM_POWERFAIL_INT_Remove(&Flush_Handlers, Handler);
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+uint8_t TM_POWERFAIL_AddFile(FIL* fil, uint8_t Priority) {
+	uint8_t i;
+	
+	/* Find free slot */
+	for (i = 0; i < POWERFAIL_FILES; i++) {
+		if (File_Handlers[i].Param == NULL) {
+			/* Add as flush handler */
+			TM_POWERFAIL_AddHandler(&File_Handlers[i], TM_POWERFAIL_Context_Flush, Priority, TM_POWERFAIL_INT_SyncFile, fil);
+			
+			/* Return OK */
+			return 1;
+		}
+	}
+	
+	/* No free slot */
+	return 0;
+}
+
+void TM_POWERFAIL_RemoveFile(FIL* fil) {
+	uint8_t i;
+	
+	/* Find file */
+	for (i = 0; i < POWERFAIL_FILES; i++) {
+		if (File_Handlers[i].Param == fil) {
+			/* Remove handler */
+			TM_POWERFAIL_RemoveHandler(&File_Handlers[i]);
+			
+			/* Slot is free */
+			File_Handlers[i].Param = NULL;
+			break;
+		}
+	}
+}
+
+uint8_t TM_POWERFAIL_Process(void) {
+	TM_POWERFAIL_Handler_t* Handler;
+	uint8_t clean = 1;
+	
+	/* Power is OK */
+	if (!Failed) {
+		return 0;
+	}
+	
+	/* Already done, wait for reset */
+	if (Done) {
+		return 1;
+	}
+	
+	/* Process handlers in priority order */
+	for (Handler = Flush_Handlers; Handler; Handler = Handler->Next) {
+		/* Check remaining time */
+		if ((HAL_GetTick() - FailTime) >= POWERFAIL_HOLDUP_TIME) {
+			clean = 0;
+			break;
+		}
+		
+		/* Call handler */
+		Handler->Function(Handler->Param);
+	}
+	
+	/* Everything was saved in time, mark clean shutdown */
+	if (clean && (HAL_GetTick() - FailTime) < POWERFAIL_HOLDUP_TIME) {
+		POWERFAIL_BACKUP->Flag = POWERFAIL_FLAG_CLEAN;
+	} else {
+		clean = 0;
+	}
+	
+	/* Flush stage is done */
+	Done = 1;
+	
+	/* Call user function */
+	TM_POWERFAIL_DoneCallback(clean);
+	
+	/* Power fail in progress */
+	return 1;
+}
+
+uint32_t TM_POWERFAIL_GetCount(void) {
+	return POWERFAIL_BACKUP->Count;
+}
+
+/* Private functions */
+static void TM_POWERFAIL_INT_Insert(TM_POWERFAIL_Handler_t** List, TM_POWERFAIL_Handler_t* Handler) {
+	/* Find position, handlers with same priority are called in order they were added */
+	while (*List && (*List)->Priority <= Handler->Priority) {
+		List = &(*List)->Next;
+	}
+	
+	/* Insert */
+	Handler->Next = *List;
+	*List = Handler;
+}
+
+static uint8_t TM_POWERFAIL_INT_Remove(TM_POWERFAIL_Handler_t** List, TM_POWERFAIL_Handler_t* Handler) {
+	/* Find and remove from list */
+	for (; *List; List = &(*List)->Next) {
+		if (*List == Handler) {
+			*List = Handler->Next;
+			Handler->Next = NULL;
+			return 1;
+		}
+	}
+	
+	/* Not in list */
+	return 0;
+}
+
+static void TM_POWERFAIL_INT_SyncFile(void* Param) {
+	/* Write cached data, FAT and directory entry */
+	f_sync((FIL *)Param);
+}
+
+/* Callbacks */
+__weak void TM_POWERFAIL_DoneCallback(uint8_t clean) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_POWERFAIL_DoneCallback could be implemented in the user file
+	*/
+}
+
+/* PVD handler */
+void TM_PVD_Handler(uint8_t status) {
+	TM_POWERFAIL_Handler_t* Handler;
+	
+	/* Voltage is above level or power fail already detected */
+	if (!status || Failed) {
+		return;
+	}
+	
+	/* Save time for flush stage */
+	FailTime = HAL_GetTick();
+	Failed = 1;
+	
+	/* Count power fails */
+	POWERFAIL_BACKUP->Count++;
+	POWERFAIL_BACKUP->Check = ~POWERFAIL_BACKUP->Count;
+	
+	/* Stop producers */
+	for (Handler = IRQ_Handlers; Handler; Handler = Handler->Next) {
+		Handler->Function(Handler->Param);
+	}
+}
@@ -0,0 +1,308 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Power fail flush for FATFS files and logs on PVD early warning for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_POWERFAIL_H
+#define TM_POWERFAIL_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_POWERFAIL
+ * @brief    Power fail flush for FATFS files and logs on PVD early warning for STM32Fxxx
+ * @{
+ *
+ * When supply voltage falls below PVD level, there is short holdup time before brown-out reset.
+ * Library uses this time to save buffered data, so files do not have to be synced all the time while logging.
+ *
+ * \par Power fail sequence
+ *
+\verbatim
+ 1. PVD interrupt: handlers added with TM_POWERFAIL_Context_IRQ are called immediately in priority order,
+    use them to stop DMA producers (ADC, UART RX, ...) so no new data are generated
+ 2. TM_POWERFAIL_Process: files and handlers added with TM_POWERFAIL_Context_Flush are processed in priority order,
+    files are synced with f_sync, which writes cached data, FAT and directory entry
+ 3. When everything is done within POWERFAIL_HOLDUP_TIME, clean shutdown flag is written to backup SRAM
+\endverbatim
+ *
+ * Flush stage does not run in interrupt, because FATFS is not reentrant and file might be in the middle of f_write.
+ * Call @ref TM_POWERFAIL_Process from the same context which writes to files, main loop or logging thread.
+ * When function returns 1, power fail is in progress and files must not be written anymore.
+ *
+ * Time limit is checked before each handler, handler which is already running can not be stopped.
+ * Use lower priority values for more important data, they are handled first.
+ *
+ * On next startup, @ref TM_POWERFAIL_Init returns if previous shutdown was clean.
+ * After unclean shutdown, file system check or log recovery can be done.
+ *
+\code
+TM_POWERFAIL_Handler_t ADC_Stop, Log_Sync;
+
+void ADC_StopFunction(void* Param) {
+	HAL_ADC_Stop_DMA(&hadc);
+}
+
+void Log_SyncFunction(void* Param) {
+	TM_LOGFS_Sync((TM_LOGFS_t *)Param);
+}
+
+if (TM_POWERFAIL_Init(TM_PVD_Level_6) == TM_POWERFAIL_State_Unclean) {
+	//Check log files
+}
+
+TM_POWERFAIL_AddHandler(&ADC_Stop, TM_POWERFAIL_Context_IRQ, 0, ADC_StopFunction, NULL);
+TM_POWERFAIL_AddHandler(&Log_Sync, TM_POWERFAIL_Context_Flush, 0, Log_SyncFunction, &Log);
+TM_POWERFAIL_AddFile(&fil, 1);
+
+while (1) {
+	if (TM_POWERFAIL_Process()) {
+		//Power is failing, wait for reset
+		continue;
+	}
+	
+	f_write(&fil, data, len, &bw);
+}
+\endcode
+ *
+ * @note  Library implements @ref TM_PVD_Handler function, do not define it in your code
+ * @note  Backup SRAM keeps clean shutdown flag only when VBAT is connected. Without VBAT,
+ *        state after power up is @ref TM_POWERFAIL_State_Unknown
+ * @note  Library uses backup SRAM and is available on STM32F4xx and STM32F7xx devices with backup SRAM
+ *
+ * To change settings, open defines.h file and add lines:
+ *
+\code
+//Time in milliseconds available for flush stage, depends on supply capacitors and current consumption
+#define POWERFAIL_HOLDUP_TIME       20
+
+//Maximal number of files added with TM_POWERFAIL_AddFile
+#define POWERFAIL_FILES             4
+
+//Offset of library data in backup SRAM, 12 bytes are used
+#define POWERFAIL_BKPSRAM_OFFSET    0xFF0
+\endcode
+ *
+ * For fast reaction, set PVD_NVIC_PRIORITY in defines.h to high priority (low value).
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM PVD
+ - TM FATFS
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_pvd.h"
+#include "tm_stm32_fatfs.h"
+
+/**
+ * @defgroup TM_POWERFAIL_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Time in milliseconds available for flush stage */
+#ifndef POWERFAIL_HOLDUP_TIME
+#define POWERFAIL_HOLDUP_TIME       20
+#endif
+
+/* Maximal number of files */
+#ifndef POWERFAIL_FILES
+#define POWERFAIL_FILES             4
+#endif
+
+/* Offset of library data in backup SRAM */
+#ifndef POWERFAIL_BKPSRAM_OFFSET
+#define POWERFAIL_BKPSRAM_OFFSET    0xFF0
+#endif
+
+/* Check device */
+#if !defined(BKPSRAM_BASE)
+#error "TM POWERFAIL needs backup SRAM, it is not available on this device"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_POWERFAIL_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  State of previous shutdown
+ */
+typedef enum {
+	TM_POWERFAIL_State_Unknown = 0x00, /*!< Backup SRAM has no valid data, first power up or VBAT was not connected */
+	TM_POWERFAIL_State_Clean,          /*!< Power fail flush was finished in time */
+	TM_POWERFAIL_State_Unclean         /*!< Reset or power loss without finished flush */
+} TM_POWERFAIL_State_t;
+
+/**
+ * @brief  Context where handler is called
+ */
+typedef enum {
+	TM_POWERFAIL_Context_IRQ = 0x00,   /*!< Called from PVD interrupt, for stopping data producers */
+	TM_POWERFAIL_Context_Flush         /*!< Called from @ref TM_POWERFAIL_Process, for writing data */
+} TM_POWERFAIL_Context_t;
+
+/**
+ * @brief  Power fail handler
+ * @note   Structure is filled by @ref TM_POWERFAIL_AddHandler function and must stay valid, do not use local variables
+ */
+typedef struct _TM_POWERFAIL_Handler_t {
+	void (*Function)(void* Param);          /*!< Handler function */
+	void* Param;                            /*!< User parameter for handler function */
+	uint8_t Priority;                       /*!< Handler priority, lower value is called first */
+	struct _TM_POWERFAIL_Handler_t* Next;   /*!< Next handler in list. Private use */
+} TM_POWERFAIL_Handler_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_POWERFAIL_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes library, checks state of previous shutdown and enables PVD
+ * @param  Level: PVD level for power fail warning. This parameter can be a value of @ref TM_PVD_Level_t enumeration
+ * @retval State of previous shutdown, member of @ref TM_POWERFAIL_State_t enumeration
+ */
+TM_POWERFAIL_State_t TM_POWERFAIL_Init(TM_PVD_Level_t Level);
+
+/**
+ * @brief  Adds power fail handler
+ * @param  *Handler: Pointer to empty @ref TM_POWERFAIL_Handler_t structure
+ * @param  Context: Context where handler is called. This parameter can be a value of @ref TM_POWERFAIL_Context_t enumeration
+ * @param  Priority: Handler priority, lower value is called first
+ * @param  *Function: Handler function
+ * @param  *Param: User parameter for handler function
+ * @retval None
+ */
+void TM_POWERFAIL_AddHandler(TM_POWERFAIL_Handler_t* Handler, TM_POWERFAIL_Context_t Context, uint8_t Priority, void (*Function)(void*), void* Param);
+
+/**
+ * @brief  Removes power fail handler
+ * @param  *Handler: Pointer to @ref TM_POWERFAIL_Handler_t structure
+ * @retval None
+ */
+void TM_POWERFAIL_RemoveHandler(TM_POWERFAIL_Handler_t* Handler);
+
+/**
+ * @brief  Adds opened file which is synced in flush stage
+ * @note   Remove file with @ref TM_POWERFAIL_RemoveFile before it is closed
+ * @param  *fil: Pointer to opened file
+ * @param  Priority: Flush priority, lower value is synced first
+ * @retval Add status:
+ *            - 0: No free slot, increase POWERFAIL_FILES
+ *            - > 0: File added
+ */
+uint8_t TM_POWERFAIL_AddFile(FIL* fil, uint8_t Priority);
+
+/**
+ * @brief  Removes file from power fail handling
+ * @param  *fil: Pointer to file added with @ref TM_POWERFAIL_AddFile
+ * @retval None
+ */
+void TM_POWERFAIL_RemoveFile(FIL* fil);
+
+/**
+ * @brief  Runs flush stage when power fail was detected
+ * @note   Call it periodically from context which writes to files
+ * @param  None
+ * @retval Power fail status:
+ *            - 0: Power is OK
+ *            - 1: Power fail in progress, do not write to files anymore
+ */
+uint8_t TM_POWERFAIL_Process(void);
+
+/**
+ * @brief  Gets number of power fails while device was powered from VBAT
+ * @param  None
+ * @retval Number of detected power fails
+ */
+uint32_t TM_POWERFAIL_GetCount(void);
+
+/**
+ * @brief  Called when flush stage is finished
+ * @param  clean: Set to 1 when everything was flushed in time, 0 otherwise
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_POWERFAIL_DoneCallback(uint8_t clean);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+
+ */
+#include "tm_stm32_prng.h"
+
+/* Number of initialized contexts, mixed to seed */
+static uint32_t PRNG_Contexts;
+
+/* Private functions */
+static uint32_t TM_PRNG_INT_Mix(uint32_t* x);
+static void TM_PRNG_INT_Entropy(uint32_t* Entropy);
+
+void TM_PRNG_Init(TM_PRNG_t* Prng) {
+	uint32_t entropy[4], x;
+	uint8_t i;
+	
+	/* Get hardware entropy */
+	TM_PRNG_INT_Entropy(entropy);
+	
+	/* Mix entropy, so even weak entropy gives well distributed state */
+	x = ++PRNG_Contexts;
+	for (i = 0; i < 4; i++) {
+		x ^= entropy[i];
+		Prng->S[i] = TM_PRNG_INT_Mix(&x);
+	}
+	
+	/* State must not be all zeros */
+	if (!(Prng->S[0] | Prng->S[1] | Prng->S[2] | Prng->S[3])) {
+		Prng->S[0] = 1;
+	}
+}
+
+void TM_PRNG_Seed(TM_PRNG_t* Prng, uint32_t Seed) {
+	uint8_t i;
+	
+	/* Expand seed to state, result is never all zeros */
+	for (i = 0; i < 4; i++) {
+		Prng->S[i] = TM_PRNG_INT_Mix(&Seed);
+	}
+}
+
+void TM_PRNG_Jump(TM_PRNG_t* Prng) {
+	static const uint32_t jump[4] = {0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B};
+	uint32_t s[4] = {0, 0, 0, 0};
+	uint8_t i, b;
+	
+	/* Sum states selected by jump polynomial */
+	for (i = 0; i < 4; i++) {
+		for (b = 0; b < 32; b++) {
+			if (jump[i] & (1UL << b)) {
+				s[0] ^= Prng->S[0];
+				s[1] ^= Prng->S[1];
+				s[2] ^= Prng->S[2];
+				s[3] ^= Prng->S[3];
+			}
+			TM_PRNG_Get(Prng);
+		}
+	}
+	
+	/* Save new state */
+	memcpy(Prng->S, s, sizeof(s));
+}
+
+int32_t TM_PRNG_Between(TM_PRNG_t* Prng, int32_t Min, int32_t Max) {
+	uint32_t range = (uint32_t)Max - (uint32_t)Min + 1;
+	
+	/* Full 32-bit range */
+	if (range == 0) {
+		return (int32_t)TM_PRNG_Get(Prng);
+	}
+	
+	/* Offset from minimum */
+	return (int32_t)((uint32_t)Min + TM_PRNG_Range(Prng, range));
+}
+
+void TM_PRNG_Fill(TM_PRNG_t* Prng, void* Data, uint32_t count) {
+	uint8_t* ptr = (uint8_t *)Data;
+	uint32_t value;
+	
+	/* Unaligned start */
+	while (count && ((uint32_t)ptr & 0x03)) {
+		*ptr++ = TM_PRNG_Get(Prng) >> 24;
+		count--;
+	}
+	
+	/* Aligned words */
+	while (count >= 4) {
+		*(uint32_t *)ptr = TM_PRNG_Get(Prng);
+		ptr += 4;
+		count -= 4;
+	}
+	
+	/* Last bytes */
+	if (count) {
+		value = TM_PRNG_Get(Prng);
+		memcpy(ptr, &value, count);
+	}
+}
+
+void TM_PRNG_FillRange(TM_PRNG_t* Prng, uint32_t* Data, uint32_t count, uint32_t Range) {
+	/* Fill array */
+	while (count--) {
+		*Data++ = TM_PRNG_Range(Prng, Range);
+	}
+}
+
+/* Private functions */
+static uint32_t TM_PRNG_INT_Mix(uint32_t* x) {
+	uint32_t z;
+	
+	/* Weyl sequence with MurmurHash3 finalizer */
+	z = (*x += 0x9E3779B9);
+	z = (z ^ (z >> 16)) * 0x85EBCA6B;
+	z = (z ^ (z >> 13)) * 0xC2B2AE35;
+	return z ^ (z >> 16);
+}
+
+static void TM_PRNG_INT_Entropy(uint32_t* Entropy) {
+#if defined(RNG)
+	/* Init RNG if not already */
+	if (!(RNG->CR & RNG_CR_RNGEN)) {
+		TM_RNG_Init();
+	}
+	
+	/* True random numbers */
+	TM_RNG_Fill(Entropy, 4 * sizeof(uint32_t));
+#else
+	uint32_t x = 0;
+	uint8_t i;
+	
+	/* Unique ID makes seed different on each device */
+	Entropy[0] = TM_ID_GetUnique32(0);
+	Entropy[1] = TM_ID_GetUnique32(1);
+	Entropy[2] = TM_ID_GetUnique32(2);
+	Entropy[3] = 0;
+	
+	/* Enable internal reference voltage */
+	TM_ADC_InitADC(PRNG_SEED_ADC);
+#if defined(ADC_CCR_TSVREFE)
+	ADC->CCR |= ADC_CCR_TSVREFE;
+#else
+	ADC->CCR |= ADC_CCR_VREFEN;
+#endif
+	
+	/* Lowest bits of conversions are noise, SysTick adds timing jitter */
+	for (i = 0; i < 64; i++) {
+		Entropy[3] = (Entropy[3] << 2) | (Entropy[3] >> 30);
+		Entropy[3] ^= TM_ADC_Read(PRNG_SEED_ADC, TM_ADC_Channel_17) ^ SysTick->VAL;
+		
+		/* Spread noise over all words */
+		if ((i & 0x0F) == 0x0F) {
+			Entropy[i >> 4] ^= TM_PRNG_INT_Mix(&x) ^ Entropy[3];
+		}
+	}
+#endif
+}
@@ -0,0 +1,285 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Fast xoshiro128** pseudo random number generator seeded from hardware for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_PRNG_H
+#define TM_PRNG_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_PRNG
+ * @brief    Fast xoshiro128** pseudo random number generator seeded from hardware for STM32Fxxx
+ * @{
+ *
+ * Library implements xoshiro128** generator with 128-bit state. One number costs a few shifts, XORs and 2 multiplications,
+ * generator functions are inline. Numbers are not cryptographically secure, use @ref TM_RNG library for keys.
+ *
+ * Each user has own @ref TM_PRNG_t context, so interrupt and main code do not share state and need no locking.
+ *
+ * \par Seed
+ *
+ * @ref TM_PRNG_Init seeds context from hardware:
+ *  - On devices with RNG peripheral, seed is read with @ref TM_RNG library. RNG is initialized if it is not already
+ *  - Other devices (STM32F0xx) use 96-bit unique ID, noise of internal reference voltage read with ADC and SysTick counter.
+ *      Seed is different on each device and on each reset, but it is not of cryptographic quality
+ *
+ * For repeatable sequences in tests and simulations, use @ref TM_PRNG_Seed with fixed value.
+ * For more independent streams from one seed, use @ref TM_PRNG_Jump, which skips 2^64 numbers.
+ *
+\code
+TM_PRNG_t Prng;
+
+//Seed from hardware
+TM_PRNG_Init(&Prng);
+
+//Random backoff between 1 and 16 slots
+slots = TM_PRNG_Range(&Prng, 16) + 1;
+
+//Fill buffer with dither noise
+TM_PRNG_Fill(&Prng, Noise, sizeof(Noise));
+\endcode
+ *
+ * \par Settings
+ *
+\code
+//ADC used for seed on devices without RNG peripheral
+#define PRNG_SEED_ADC       ADC1
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - attributes.h
+ - TM RNG (devices with RNG)
+ - TM ID and TM ADC (devices without RNG)
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+#include "string.h"
+#if defined(RNG)
+#include "tm_stm32_rng.h"
+#else
+#include "tm_stm32_id.h"
+#include "tm_stm32_adc.h"
+#endif
+
+/**
+ * @defgroup TM_PRNG_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* ADC for seed on devices without RNG */
+#ifndef PRNG_SEED_ADC
+#define PRNG_SEED_ADC       ADC1
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_PRNG_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Generator context
+ */
+typedef struct {
+	uint32_t S[4];            /*!< Generator state, must not be all zeros */
+} TM_PRNG_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_PRNG_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Seeds generator context from hardware
+ * @note   Each call gives different state, also for more contexts initialized one after another
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @retval None
+ */
+void TM_PRNG_Init(TM_PRNG_t* Prng);
+
+/**
+ * @brief  Seeds generator context from value, the same seed gives the same sequence
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @param  Seed: Seed value, all values including 0 are valid
+ * @retval None
+ */
+void TM_PRNG_Seed(TM_PRNG_t* Prng, uint32_t Seed);
+
+/**
+ * @brief  Advances generator for 2^64 numbers
+ * @note   Use it to make non-overlapping sequences for more contexts from one seed
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @retval None
+ */
+void TM_PRNG_Jump(TM_PRNG_t* Prng);
+
+/**
+ * @brief  Gets 32-bit random number
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @retval 32-bit random number
+ */
+static __INLINE uint32_t TM_PRNG_Get(TM_PRNG_t* Prng) {
+	uint32_t* s = Prng->S;
+	uint32_t result = s[1] * 5;
+	uint32_t t = s[1] << 9;
+	
+	/* Scramble */
+	result = ((result << 7) | (result >> 25)) * 9;
+	
+	/* Advance state */
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 11) | (s[3] >> 21);
+	
+	/* Return number */
+	return result;
+}
+
+/**
+ * @brief  Gets random number lower than range, without bias
+ * @note   Multiplication is used instead of division, slow path with division is taken very rarely
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @param  Range: Number of possible values, result is from 0 to Range - 1. When 0, result is 0
+ * @retval Random number in range
+ */
+static __INLINE uint32_t TM_PRNG_Range(TM_PRNG_t* Prng, uint32_t Range) {
+	uint64_t m = (uint64_t)TM_PRNG_Get(Prng) * Range;
+	uint32_t threshold;
+	
+	/* Reject numbers which would make some results more likely */
+	if ((uint32_t)m < Range) {
+		threshold = (0 - Range) % Range;
+		while ((uint32_t)m < threshold) {
+			m = (uint64_t)TM_PRNG_Get(Prng) * Range;
+		}
+	}
+	
+	/* Upper 32 bits are result */
+	return (uint32_t)(m >> 32);
+}
+
+/**
+ * @brief  Gets random number between 2 values
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @param  Min: Lowest possible value
+ * @param  Max: Highest possible value, must not be lower than Min
+ * @retval Random number from Min to Max, both included
+ */
+int32_t TM_PRNG_Between(TM_PRNG_t* Prng, int32_t Min, int32_t Max);
+
+/**
+ * @brief  Gets random float number
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @retval Random number from 0 to 1, 1 is not included
+ */
+static __INLINE float TM_PRNG_Float(TM_PRNG_t* Prng) {
+	/* 24 bits fit float mantissa */
+	return (float)(TM_PRNG_Get(Prng) >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief  Fills memory with random bytes
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @param  *Data: Pointer to memory to fill
+ * @param  count: Number of bytes to fill
+ * @retval None
+ */
+void TM_PRNG_Fill(TM_PRNG_t* Prng, void* Data, uint32_t count);
+
+/**
+ * @brief  Fills array with random numbers lower than range
+ * @param  *Prng: Pointer to @ref TM_PRNG_t context
+ * @param  *Data: Pointer to array to fill
+ * @param  count: Number of elements in array
+ * @param  Range: Number of possible values, see @ref TM_PRNG_Range
+ * @retval None
+ */
+void TM_PRNG_FillRange(TM_PRNG_t* Prng, uint32_t* Data, uint32_t count, uint32_t Range);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,220 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_profile.h"
+
+/* Zones table */
+static TM_PROFILE_Zone_t PROFILE_Zones[PROFILE_MAX_ZONES];
+static uint16_t PROFILE_ZonesCount = 0;
+
+/* Cycles needed to read DWT counter twice */
+static uint32_t PROFILE_Overhead = 0;
+
+uint8_t TM_PROFILE_Init(void) {
+	uint32_t c;
+	
+	/* Enable DWT counter */
+	if (!TM_GENERAL_DWTCounterEnable()) {
+		return 0;
+	}
+	
+	/* Measure empty zone */
+	c = TM_GENERAL_DWTCounterGetValue();
+	PROFILE_Overhead = TM_GENERAL_DWTCounterGetValue() - c;
+	
+	/* Clear statistics */
+	TM_PROFILE_Reset();
+	
+	/* Return OK */
+	return 1;
+}
+
+TM_PROFILE_Zone_t* TM_PROFILE_GetZone(const char* name) {
+	TM_PROFILE_Zone_t* zone = NULL;
+	uint32_t irq;
+	uint16_t i;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Check if zone already exists */
+	for (i = 0; i < PROFILE_ZonesCount; i++) {
+		if (strcmp(PROFILE_Zones[i].Name, name) == 0) {
+			zone = &PROFILE_Zones[i];
+			break;
+		}
+	}
+	
+	/* Create new zone */
+	if (zone == NULL && PROFILE_ZonesCount < PROFILE_MAX_ZONES) {
+		zone = &PROFILE_Zones[PROFILE_ZonesCount++];
+		memset(zone, 0, sizeof(TM_PROFILE_Zone_t));
+		zone->Name = name;
+		zone->Min = 0xFFFFFFFF;
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Return zone */
+	return zone;
+}
+
+void TM_PROFILE_Record(TM_PROFILE_Zone_t* Zone, uint32_t cycles) {
+	uint32_t irq, bin;
+	
+	/* Check zone */
+	if (Zone == NULL) {
+		return;
+	}
+	
+	/* Remove measurement overhead */
+	if (cycles > PROFILE_Overhead) {
+		cycles -= PROFILE_Overhead;
+	} else {
+		cycles = 0;
+	}
+	
+	/* Get histogram bin from highest set bit */
+	bin = 32 - __CLZ(cycles);
+	if (bin > PROFILE_HIST_FIRST) {
+		bin -= PROFILE_HIST_FIRST;
+	} else {
+		bin = 0;
+	}
+	if (bin >= PROFILE_HIST_BINS) {
+		bin = PROFILE_HIST_BINS - 1;
+	}
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Update statistics */
+	Zone->Count++;
+	Zone->Total += cycles;
+	if (cycles < Zone->Min) {
+		Zone->Min = cycles;
+	}
+	if (cycles > Zone->Max) {
+		Zone->Max = cycles;
+	}
+	Zone->Hist[bin]++;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_PROFILE_Reset(void) {
+	uint32_t irq;
+	uint16_t i;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Clear all zones */
+	for (i = 0; i < PROFILE_ZonesCount; i++) {
+		PROFILE_Zones[i].Count = 0;
+		PROFILE_Zones[i].Min = 0xFFFFFFFF;
+		PROFILE_Zones[i].Max = 0;
+		PROFILE_Zones[i].Total = 0;
+		memset(PROFILE_Zones[i].Hist, 0, sizeof(PROFILE_Zones[i].Hist));
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+TM_PROFILE_Zone_t* TM_PROFILE_GetZoneByIndex(uint16_t index) {
+	/* Check index */
+	if (index >= PROFILE_ZonesCount) {
+		return NULL;
+	}
+	
+	/* Return zone */
+	return &PROFILE_Zones[index];
+}
+
+void TM_PROFILE_Dump(void (*OutputFunc)(char *)) {
+	TM_PROFILE_Zone_t zone;
+	char str[64];
+	uint32_t irq;
+	uint16_t i, j;
+	
+	/* Header */
+	OutputFunc("Zone                     Count        Min        Max       Mean\n");
+	
+	for (i = 0; i < PROFILE_ZonesCount; i++) {
+		/* Get consistent copy of zone */
+		irq = __get_PRIMASK();
+		__disable_irq();
+		zone = PROFILE_Zones[i];
+		if (!irq) {
+			__enable_irq();
+		}
+		
+		/* Zone statistics */
+		if (zone.Count) {
+			sprintf(str, "%-20.20s %10lu %10lu %10lu %10lu\n", zone.Name, (unsigned long)zone.Count, (unsigned long)zone.Min, (unsigned long)zone.Max, (unsigned long)(zone.Total / zone.Count));
+		} else {
+			sprintf(str, "%-20.20s %10lu %10s %10s %10s\n", zone.Name, 0UL, "-", "-", "-");
+		}
+		OutputFunc(str);
+		
+		/* Histogram, upper limit of each bin */
+		for (j = 0; j < PROFILE_HIST_BINS; j++) {
+			if (zone.Hist[j] == 0) {
+				continue;
+			}
+			if (j < (PROFILE_HIST_BINS - 1)) {
+				sprintf(str, "  < %10lu: %10lu\n", (unsigned long)(1UL << (PROFILE_HIST_FIRST + j)), (unsigned long)zone.Hist[j]);
+			} else {
+				sprintf(str, "  >=%10lu: %10lu\n", (unsigned long)(1UL << (PROFILE_HIST_FIRST + j - 1)), (unsigned long)zone.Hist[j]);
+			}
+			OutputFunc(str);
+		}
+	}
+}
+
+void TM_PROFILE_ITMOutput(char* str) {
+	/* Send all characters */
+	while (*str) {
+		ITM_SendChar(*str++);
+	}
+}
@@ -0,0 +1,300 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   DWT cycle counter based code profiler for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_PROFILE_H
+#define TM_PROFILE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_PROFILE
+ * @brief    DWT cycle counter based code profiler for STM32Fxxx
+ * @{
+ *
+ * Library measures execution time of code zones in CPU cycles using DWT cycle counter.
+ * For each zone, minimal, maximal and mean time, number of executions and histogram are saved in fixed table.
+ *
+ * Zone is marked with @ref TM_PROFILE_ZONE_BEGIN and @ref TM_PROFILE_ZONE_END macros, which must be used in the same function.
+ * Zones can be nested and can be used in interrupts too.
+ *
+\code
+TM_PROFILE_ZONE_BEGIN("I2C read");
+TM_I2C_ReadMulti(I2C1, 0xD0, 0x3B, data, 14);
+TM_PROFILE_ZONE_END();
+\endcode
+ *
+ * \par Histogram
+ *
+ * Each zone has @ref PROFILE_HIST_BINS histogram bins. Bin 0 counts executions shorter than 2^PROFILE_HIST_FIRST cycles,
+ * each next bin has twice bigger upper limit and last bin counts all longer executions.
+ *
+ * \par Output
+ *
+ * Results are printed with @ref TM_PROFILE_Dump function which uses user output function for strings.
+ * This can be USART, USB CDC or ITM SWO output with @ref TM_PROFILE_ITMOutput function.
+ *
+\code
+//Print over USART
+void USART_Output(char* str) {
+	TM_USART_Puts(USART1, str);
+}
+
+TM_PROFILE_Dump(USART_Output);
+
+//Print over SWO
+TM_PROFILE_Dump(TM_PROFILE_ITMOutput);
+\endcode
+ *
+ * \par Configuration
+ *
+\code
+//Disable profiler, zone macros are then empty
+#define PROFILE_ENABLED     0
+//Number of zones in table
+#define PROFILE_MAX_ZONES   16
+//Number of histogram bins
+#define PROFILE_HIST_BINS   12
+//Upper limit of first histogram bin is 2^PROFILE_HIST_FIRST cycles
+#define PROFILE_HIST_FIRST  6
+\endcode
+ *
+ * @note   Library is not supported on STM32F0xx series, because Cortex-M0 does not have DWT cycle counter
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM GENERAL
+ - stdio.h
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_general.h"
+#include "stdio.h"
+#include "string.h"
+
+/* Check for DWT */
+#if defined(STM32F0xx)
+#error "Profiler library is not supported on STM32F0xx devices!"
+#endif
+
+/**
+ * @defgroup TM_PROFILE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Profiler enable, set to 0 to remove all measurements
+ */
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED       1
+#endif
+
+/**
+ * @brief  Maximal number of profiled zones
+ */
+#ifndef PROFILE_MAX_ZONES
+#define PROFILE_MAX_ZONES     16
+#endif
+
+/**
+ * @brief  Number of histogram bins for each zone
+ */
+#ifndef PROFILE_HIST_BINS
+#define PROFILE_HIST_BINS     12
+#endif
+
+/**
+ * @brief  Upper limit of first histogram bin is 2^PROFILE_HIST_FIRST cycles
+ */
+#ifndef PROFILE_HIST_FIRST
+#define PROFILE_HIST_FIRST    6
+#endif
+
+#if PROFILE_ENABLED || defined(DOXYGEN)
+/**
+ * @brief  Starts profiled zone
+ * @note   Zone is registered in table on first execution
+ * @param  name: Zone name, string literal
+ * @retval None
+ */
+#define TM_PROFILE_ZONE_BEGIN(name)   {                                          \
+	static TM_PROFILE_Zone_t* TM_PROFILE_Zone = NULL;                            \
+	uint32_t TM_PROFILE_Start;                                                   \
+	if (TM_PROFILE_Zone == NULL) {                                               \
+		TM_PROFILE_Zone = TM_PROFILE_GetZone(name);                              \
+	}                                                                            \
+	TM_PROFILE_Start = TM_GENERAL_DWTCounterGetValue()
+
+/**
+ * @brief  Ends profiled zone started with @ref TM_PROFILE_ZONE_BEGIN
+ * @param  None
+ * @retval None
+ */
+#define TM_PROFILE_ZONE_END()                                                    \
+	TM_PROFILE_Record(TM_PROFILE_Zone, TM_GENERAL_DWTCounterGetValue() - TM_PROFILE_Start); \
+	}
+#else
+#define TM_PROFILE_ZONE_BEGIN(name)   {
+#define TM_PROFILE_ZONE_END()         }
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_PROFILE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Profiled zone structure
+ */
+typedef struct {
+	const char* Name;                   /*!< Zone name */
+	uint32_t Count;                     /*!< Number of executions */
+	uint32_t Min;                       /*!< Minimal execution time in cycles */
+	uint32_t Max;                       /*!< Maximal execution time in cycles */
+	uint64_t Total;                     /*!< Sum of all execution times in cycles */
+	uint32_t Hist[PROFILE_HIST_BINS];   /*!< Histogram of execution times */
+} TM_PROFILE_Zone_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_PROFILE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes profiler and DWT counter
+ * @param  None
+ * @retval DWT Status:
+ *            - 0: DWT has not started, hardware/software reset is required
+ *            - > 0: DWT has started and profiler is ready to use
+ */
+uint8_t TM_PROFILE_Init(void);
+
+/**
+ * @brief  Gets zone from table by name, creates new zone if it does not exist
+ * @note   Used by @ref TM_PROFILE_ZONE_BEGIN macro
+ * @param  *name: Zone name
+ * @retval Pointer to @ref TM_PROFILE_Zone_t structure or NULL if table is full
+ */
+TM_PROFILE_Zone_t* TM_PROFILE_GetZone(const char* name);
+
+/**
+ * @brief  Records one execution of zone
+ * @note   Used by @ref TM_PROFILE_ZONE_END macro
+ * @param  *Zone: Pointer to @ref TM_PROFILE_Zone_t structure, NULL is ignored
+ * @param  cycles: Execution time in CPU cycles
+ * @retval None
+ */
+void TM_PROFILE_Record(TM_PROFILE_Zone_t* Zone, uint32_t cycles);
+
+/**
+ * @brief  Clears statistics of all zones, zones stay registered
+ * @param  None
+ * @retval None
+ */
+void TM_PROFILE_Reset(void);
+
+/**
+ * @brief  Gets zone from table by index
+ * @param  index: Zone index, starting from 0
+ * @retval Pointer to @ref TM_PROFILE_Zone_t structure or NULL if zone does not exist
+ */
+TM_PROFILE_Zone_t* TM_PROFILE_GetZoneByIndex(uint16_t index);
+
+/**
+ * @brief  Prints statistics of all zones
+ * @param  *OutputFunc: Pointer to function which outputs string
+ * @retval None
+ */
+void TM_PROFILE_Dump(void (*OutputFunc)(char *));
+
+/**
+ * @brief  Outputs string over ITM stimulus port 0 (SWO)
+ * @note   Can be used as output function for @ref TM_PROFILE_Dump
+ * @param  *str: String to output
+ * @retval None
+ */
+void TM_PROFILE_ITMOutput(char* str);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/09/hal-library-26-power-voltage-detector-pvd-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   PVD Voltage detector for STM32Fxxx
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_PVD_H
-#define TM_PVD_H 100
+#define TM_PVD_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -74,6 +74,10 @@ extern "C" {
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
 \endverbatim
  *
  * \par Dependencies
@@ -97,7 +101,7 @@ extern "C" {
 
 /* NVIC preemption priority */
 #ifndef PVD_NVIC_PRIORITY
-#define PVD_NVIC_PRIORITY      0x04
+#define PVD_NVIC_PRIORITY      NVIC_PRIORITY_CRITICAL
 #endif
 
 /* NVIC subpriority */
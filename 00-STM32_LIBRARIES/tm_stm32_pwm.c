@@ -0,0 +1,430 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+
+ */
+#include "tm_stm32_pwm.h"
+
+/* Private structure for pin table */
+typedef struct {
+	TIM_TypeDef* TIM;         /* Timer */
+	uint8_t Channel;          /* Channel index */
+	uint8_t PinsPack;         /* Pinspack */
+	GPIO_TypeDef* GPIOx;      /* GPIO port */
+	uint16_t Pin;             /* GPIO pin */
+} TM_PWM_INT_Pin_t;
+
+/* Pins for channels, see pinout table in header */
+static const TM_PWM_INT_Pin_t PWM_Pins[] = {
+	{TIM1, 0, 0, GPIOA, GPIO_PIN_8},  {TIM1, 1, 0, GPIOA, GPIO_PIN_9},  {TIM1, 2, 0, GPIOA, GPIO_PIN_10}, {TIM1, 3, 0, GPIOA, GPIO_PIN_11},
+	{TIM1, 0, 1, GPIOE, GPIO_PIN_9},  {TIM1, 1, 1, GPIOE, GPIO_PIN_11}, {TIM1, 2, 1, GPIOE, GPIO_PIN_13}, {TIM1, 3, 1, GPIOE, GPIO_PIN_14},
+	{TIM2, 0, 0, GPIOA, GPIO_PIN_0},  {TIM2, 1, 0, GPIOA, GPIO_PIN_1},  {TIM2, 2, 0, GPIOA, GPIO_PIN_2},  {TIM2, 3, 0, GPIOA, GPIO_PIN_3},
+	{TIM2, 0, 1, GPIOA, GPIO_PIN_5},  {TIM2, 1, 1, GPIOB, GPIO_PIN_3},  {TIM2, 2, 1, GPIOB, GPIO_PIN_10}, {TIM2, 3, 1, GPIOB, GPIO_PIN_11},
+	{TIM2, 0, 2, GPIOA, GPIO_PIN_15},
+	{TIM3, 0, 0, GPIOA, GPIO_PIN_6},  {TIM3, 1, 0, GPIOA, GPIO_PIN_7},  {TIM3, 2, 0, GPIOB, GPIO_PIN_0},  {TIM3, 3, 0, GPIOB, GPIO_PIN_1},
+	{TIM3, 0, 1, GPIOB, GPIO_PIN_4},  {TIM3, 1, 1, GPIOB, GPIO_PIN_5},  {TIM3, 2, 1, GPIOC, GPIO_PIN_8},  {TIM3, 3, 1, GPIOC, GPIO_PIN_9},
+	{TIM3, 0, 2, GPIOC, GPIO_PIN_6},  {TIM3, 1, 2, GPIOC, GPIO_PIN_7},
+	{TIM4, 0, 0, GPIOB, GPIO_PIN_6},  {TIM4, 1, 0, GPIOB, GPIO_PIN_7},  {TIM4, 2, 0, GPIOB, GPIO_PIN_8},  {TIM4, 3, 0, GPIOB, GPIO_PIN_9},
+	{TIM4, 0, 1, GPIOD, GPIO_PIN_12}, {TIM4, 1, 1, GPIOD, GPIO_PIN_13}, {TIM4, 2, 1, GPIOD, GPIO_PIN_14}, {TIM4, 3, 1, GPIOD, GPIO_PIN_15},
+	{TIM5, 0, 0, GPIOA, GPIO_PIN_0},  {TIM5, 1, 0, GPIOA, GPIO_PIN_1},  {TIM5, 2, 0, GPIOA, GPIO_PIN_2},  {TIM5, 3, 0, GPIOA, GPIO_PIN_3},
+#if defined(GPIOI)
+	{TIM5, 0, 1, GPIOH, GPIO_PIN_10}, {TIM5, 1, 1, GPIOH, GPIO_PIN_11}, {TIM5, 2, 1, GPIOH, GPIO_PIN_12}, {TIM5, 3, 1, GPIOI, GPIO_PIN_0},
+#endif
+#if defined(TIM8)
+	{TIM8, 0, 0, GPIOC, GPIO_PIN_6},  {TIM8, 1, 0, GPIOC, GPIO_PIN_7},  {TIM8, 2, 0, GPIOC, GPIO_PIN_8},  {TIM8, 3, 0, GPIOC, GPIO_PIN_9},
+#if defined(GPIOI)
+	{TIM8, 0, 1, GPIOI, GPIO_PIN_5},  {TIM8, 1, 1, GPIOI, GPIO_PIN_6},  {TIM8, 2, 1, GPIOI, GPIO_PIN_7},  {TIM8, 3, 1, GPIOI, GPIO_PIN_2},
+#endif
+#endif
+};
+
+/* DMA burst address of CCR1 register, in words from timer base */
+#define PWM_DBA_CCR1             13
+
+/* Private functions */
+static uint8_t TM_PWM_INT_GetInfo(TIM_TypeDef* TIMx, uint32_t* Clock, uint8_t* AF, TM_DMA_Request_t* Request);
+static void TM_PWM_INT_StreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+
+TM_PWM_Result_t TM_PWM_InitTimer(TIM_TypeDef* TIMx, TM_PWM_TIM_t* TIM_Data, uint32_t Frequency) {
+	uint32_t clock, ticks, max;
+	uint8_t af;
+	TM_DMA_Request_t request;
+	
+	/* Get timer clock */
+	if (Frequency == 0 || !TM_PWM_INT_GetInfo(TIMx, &clock, &af, &request)) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Timer ticks for one period, with prescaler 1 */
+	ticks = clock / Frequency;
+	if (ticks < 2) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* TIM2 and TIM5 are 32-bit timers */
+	max = (TIMx == TIM2 || TIMx == TIM5) ? 0xFFFFFFFF : 0x10000;
+	
+	/* Clear structure */
+	memset(TIM_Data, 0, sizeof(TM_PWM_TIM_t));
+	
+	/* Lowest prescaler gives best resolution */
+	TIM_Data->TIM = TIMx;
+	TIM_Data->Prescaler = (ticks - 1) / max + 1;
+	TIM_Data->Period = ticks / TIM_Data->Prescaler;
+	TIM_Data->TickFrequency = clock / TIM_Data->Prescaler;
+	TIM_Data->Frequency = TIM_Data->TickFrequency / TIM_Data->Period;
+	
+	/* Prescaler is 16-bit on all timers */
+	if (TIM_Data->Prescaler > 0x10000) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Configure timer, preload for auto reload register */
+	TIMx->CR1 = TIM_CR1_ARPE;
+	TIMx->PSC = TIM_Data->Prescaler - 1;
+	TIMx->ARR = TIM_Data->Period - 1;
+	
+	/* Load settings and start counter */
+	TIMx->EGR = TIM_EGR_UG;
+	TIMx->CR1 |= TIM_CR1_CEN;
+	
+	/* Return OK */
+	return TM_PWM_Result_Ok;
+}
+
+TM_PWM_Result_t TM_PWM_InitChannel(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, TM_PWM_PinsPack_t PinsPack) {
+	TIM_TypeDef* TIMx = TIM_Data->TIM;
+	volatile uint32_t* CCMR;
+	uint32_t clock, shift;
+	uint8_t af, i;
+	TM_DMA_Request_t request;
+	
+	/* Check parameters */
+	if (Channel > TM_PWM_Channel_4 || !TM_PWM_INT_GetInfo(TIMx, &clock, &af, &request)) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Init pin */
+	if (PinsPack == TM_PWM_PinsPack_Custom) {
+		TM_PWM_InitCustomPinsCallback(TIMx, Channel, af);
+	} else {
+		/* Find pin in table */
+		for (i = 0; i < sizeof(PWM_Pins) / sizeof(PWM_Pins[0]); i++) {
+			if (PWM_Pins[i].TIM == TIMx && PWM_Pins[i].Channel == Channel && PWM_Pins[i].PinsPack == PinsPack) {
+				break;
+			}
+		}
+		
+		/* Pin does not exist */
+		if (i == sizeof(PWM_Pins) / sizeof(PWM_Pins[0])) {
+			return TM_PWM_Result_Error;
+		}
+		TM_GPIO_InitAlternate(PWM_Pins[i].GPIOx, PWM_Pins[i].Pin, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High, af);
+	}
+	
+	/* Duty cycle starts at 0 */
+	(&TIMx->CCR1)[Channel] = 0;
+	
+	/* PWM mode 1 with preload, CCR value is used from next update */
+	CCMR = Channel < TM_PWM_Channel_3 ? &TIMx->CCMR1 : &TIMx->CCMR2;
+	shift = (Channel & 0x01) * 8;
+	*CCMR = (*CCMR & ~(0xFFUL << shift)) | ((TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1PE) << shift);
+	
+	/* Enable output, active high */
+	TIMx->CCER = (TIMx->CCER & ~(TIM_CCER_CC1P << (Channel * 4))) | (TIM_CCER_CC1E << (Channel * 4));
+	
+	/* Advanced timers need main output enabled */
+	if (IS_TIM_ADVANCED_INSTANCE(TIMx)) {
+		TIMx->BDTR |= TIM_BDTR_MOE;
+	}
+	
+	/* Channel is initialized */
+	TIM_Data->Channels |= 1 << Channel;
+	
+	/* Return OK */
+	return TM_PWM_Result_Ok;
+}
+
+TM_PWM_Result_t TM_PWM_SetChannel(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, uint32_t Pulse) {
+	/* Check parameters */
+	if (Channel > TM_PWM_Channel_4 || !(TIM_Data->Channels & (1 << Channel)) || Pulse > TIM_Data->Period) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Set compare value */
+	(&TIM_Data->TIM->CCR1)[Channel] = Pulse;
+	
+	/* Return OK */
+	return TM_PWM_Result_Ok;
+}
+
+TM_PWM_Result_t TM_PWM_SetChannelPercent(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, float Percent) {
+	/* Check limits */
+	if (Percent < 0 || Percent > 100) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Set pulse, rounded */
+	return TM_PWM_SetChannel(TIM_Data, Channel, (uint32_t)((float)TIM_Data->Period * Percent / 100.0f + 0.5f));
+}
+
+TM_PWM_Result_t TM_PWM_SetChannelMicros(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, uint32_t Micros) {
+	/* Set pulse, 64-bit to prevent overflow on fast timers */
+	return TM_PWM_SetChannel(TIM_Data, Channel, (uint32_t)((uint64_t)TIM_Data->TickFrequency * Micros / 1000000));
+}
+
+TM_PWM_Result_t TM_PWM_StartBurst(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t FirstChannel, uint8_t Channels, const uint16_t* Buffer, uint16_t Periods, uint8_t Circular) {
+	TIM_TypeDef* TIMx = TIM_Data->TIM;
+	DMA_Stream_TypeDef* Stream;
+	uint32_t clock, length = (uint32_t)Channels * Periods;
+	uint8_t af;
+	TM_DMA_Request_t request;
+	
+	/* Check parameters */
+	if (
+		!TM_PWM_INT_GetInfo(TIMx, &clock, &af, &request) || /*!< Invalid timer */
+		request == TM_DMA_Request_None ||                   /*!< Timer without burst support */
+		Channels == 0 || FirstChannel + Channels > 4 ||     /*!< Invalid channels */
+		length == 0 || length > 0xFFFF                      /*!< Too long for one DMA transfer */
+	) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Check if already running */
+	if (TIM_Data->Active) {
+		return TM_PWM_Result_Busy;
+	}
+	
+	/* Allocate stream on first burst */
+	if (TIM_Data->hdma.Instance == NULL) {
+		if ((Stream = TM_DMA_Allocate(request, TM_DMA_Priority_Default, NULL, &TIM_Data->hdma.Init.Channel)) == NULL) {
+			return TM_PWM_Result_Error;
+		}
+		TIM_Data->hdma.Instance = Stream;
+	}
+	
+	/* Set DMA settings, 16-bit writes to DMAR register */
+	TIM_Data->hdma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	TIM_Data->hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+	TIM_Data->hdma.Init.MemInc = DMA_MINC_ENABLE;
+	TIM_Data->hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	TIM_Data->hdma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	TIM_Data->hdma.Init.Mode = Circular ? DMA_CIRCULAR : DMA_NORMAL;
+	TIM_Data->hdma.Init.Priority = DMA_PRIORITY_HIGH;
+	TIM_Data->hdma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	TIM_Data->hdma.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	TIM_Data->hdma.Init.MemBurst = DMA_MBURST_SINGLE;
+	TIM_Data->hdma.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init stream, transfer complete is handled in library callback */
+	TM_DMA_Init(TIM_Data->hdma.Instance, &TIM_Data->hdma);
+	TM_DMA_SetStreamCallback(TIM_Data->hdma.Instance, TM_PWM_INT_StreamCallback, TIM_Data);
+	TM_DMA_EnableInterrupts(TIM_Data->hdma.Instance);
+	
+	/* Burst of Channels writes starting at CCR of first channel */
+	TIMx->DCR = ((uint32_t)(Channels - 1) << 8) | (PWM_DBA_CCR1 + FirstChannel);
+	
+	/* Start DMA */
+	TIM_Data->Active = 1;
+	TM_DMA_Start(&TIM_Data->hdma, (uint32_t)Buffer, (uint32_t)&TIMx->DMAR, length);
+	
+	/* Request DMA on each update event */
+	TIMx->DIER |= TIM_DIER_UDE;
+	
+	/* Return OK */
+	return TM_PWM_Result_Ok;
+}
+
+void TM_PWM_StopBurst(TM_PWM_TIM_t* TIM_Data) {
+	/* Check if running */
+	if (!TIM_Data->Active) {
+		return;
+	}
+	
+	/* Stop requests and stream */
+	TIM_Data->TIM->DIER &= ~TIM_DIER_UDE;
+	TIM_Data->hdma.Instance->CR &= ~DMA_SxCR_EN;
+	while (TIM_Data->hdma.Instance->CR & DMA_SxCR_EN);
+	
+	/* Clear flags, stream is not active anymore */
+	TM_DMA_ClearFlags(TIM_Data->hdma.Instance);
+	TIM_Data->Active = 0;
+}
+
+uint8_t TM_PWM_BurstActive(TM_PWM_TIM_t* TIM_Data) {
+	/* Return status */
+	return TIM_Data->Active;
+}
+
+TM_PWM_Result_t TM_PWM_WS2812_Init(TM_PWM_WS2812_t* Strip, TIM_TypeDef* TIMx, TM_PWM_Channel_t Channel, TM_PWM_PinsPack_t PinsPack, uint16_t* Buffer, uint16_t Leds) {
+	uint32_t clock;
+	uint8_t af;
+	TM_DMA_Request_t request;
+	uint16_t i;
+	
+	/* Timer must support DMA burst */
+	if (!TM_PWM_INT_GetInfo(TIMx, &clock, &af, &request) || request == TM_DMA_Request_None) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Init timer and channel */
+	if (
+		TM_PWM_InitTimer(TIMx, &Strip->TIM, TM_PWM_WS2812_FREQUENCY) != TM_PWM_Result_Ok ||
+		TM_PWM_InitChannel(&Strip->TIM, Channel, PinsPack) != TM_PWM_Result_Ok
+	) {
+		return TM_PWM_Result_Error;
+	}
+	
+	/* Bit timings, 0.4us high for 0 and 0.8us high for 1 of 1.25us bit */
+	Strip->Channel = Channel;
+	Strip->Buffer = Buffer;
+	Strip->Leds = Leds;
+	Strip->T0H = Strip->TIM.Period * 8 / 25;
+	Strip->T1H = Strip->TIM.Period * 16 / 25;
+	
+	/* All LEDs black */
+	for (i = 0; i < Leds * 24; i++) {
+		Buffer[i] = Strip->T0H;
+	}
+	
+	/* Line stays low for reset time after data */
+	for (i = 0; i < PWM_WS2812_RESET_PERIODS; i++) {
+		Buffer[Leds * 24 + i] = 0;
+	}
+	
+	/* Return OK */
+	return TM_PWM_Result_Ok;
+}
+
+void TM_PWM_WS2812_SetColor(TM_PWM_WS2812_t* Strip, uint16_t Led, uint8_t R, uint8_t G, uint8_t B) {
+	uint16_t* bits;
+	uint32_t color;
+	uint8_t i;
+	
+	/* Check LED */
+	if (Led >= Strip->Leds) {
+		return;
+	}
+	
+	/* LED takes colors in GRB order, MSB first */
+	bits = &Strip->Buffer[Led * 24];
+	color = ((uint32_t)G << 16) | ((uint32_t)R << 8) | B;
+	for (i = 0; i < 24; i++) {
+		bits[i] = (color & (0x800000 >> i)) ? Strip->T1H : Strip->T0H;
+	}
+}
+
+TM_PWM_Result_t TM_PWM_WS2812_Update(TM_PWM_WS2812_t* Strip) {
+	/* Send all bits and reset periods */
+	return TM_PWM_StartBurst(&Strip->TIM, Strip->Channel, 1, Strip->Buffer, TM_PWM_WS2812_BUFFER_SIZE(Strip->Leds), 0);
+}
+
+uint8_t TM_PWM_WS2812_IsBusy(TM_PWM_WS2812_t* Strip) {
+	/* Reset periods are part of burst */
+	return Strip->TIM.Active;
+}
+
+__weak void TM_PWM_BurstCompleteCallback(TM_PWM_TIM_t* TIM_Data) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_PWM_BurstCompleteCallback could be implemented in the user file
+	*/
+}
+
+__weak void TM_PWM_InitCustomPinsCallback(TIM_TypeDef* TIMx, TM_PWM_Channel_t Channel, uint16_t AlternateFunction) {
+	/* Custom user function. */
+	/* In case user needs functionality for custom pins, this function should be declared outside this library */
+}
+
+/* Private functions */
+static uint8_t TM_PWM_INT_GetInfo(TIM_TypeDef* TIMx, uint32_t* Clock, uint8_t* AF, TM_DMA_Request_t* Request) {
+	uint8_t apb2 = 0;
+	
+	/* Enable clock and get alternate function and DMA request for burst */
+	*Request = TM_DMA_Request_None;
+	if (TIMx == TIM1) {
+		__HAL_RCC_TIM1_CLK_ENABLE();
+		*AF = GPIO_AF1_TIM1;
+		*Request = TM_DMA_Request_TIM1_UP;
+		apb2 = 1;
+	} else if (TIMx == TIM2) {
+		__HAL_RCC_TIM2_CLK_ENABLE();
+		*AF = GPIO_AF1_TIM2;
+	} else if (TIMx == TIM3) {
+		__HAL_RCC_TIM3_CLK_ENABLE();
+		*AF = GPIO_AF2_TIM3;
+		*Request = TM_DMA_Request_TIM3_UP;
+	} else if (TIMx == TIM4) {
+		__HAL_RCC_TIM4_CLK_ENABLE();
+		*AF = GPIO_AF2_TIM4;
+		*Request = TM_DMA_Request_TIM4_UP;
+	} else if (TIMx == TIM5) {
+		__HAL_RCC_TIM5_CLK_ENABLE();
+		*AF = GPIO_AF2_TIM5;
+#if defined(TIM8)
+	} else if (TIMx == TIM8) {
+		__HAL_RCC_TIM8_CLK_ENABLE();
+		*AF = GPIO_AF3_TIM8;
+		*Request = TM_DMA_Request_TIM8_UP;
+		apb2 = 1;
+#endif
+	} else {
+		/* Timer not supported */
+		return 0;
+	}
+	
+	/* Timer clock is twice the APB clock when APB prescaler is not 1 */
+	if (apb2) {
+		*Clock = HAL_RCC_GetPCLK2Freq();
+		if (RCC->CFGR & RCC_CFGR_PPRE2_2) {
+			*Clock *= 2;
+		}
+	} else {
+		*Clock = HAL_RCC_GetPCLK1Freq();
+		if (RCC->CFGR & RCC_CFGR_PPRE1_2) {
+			*Clock *= 2;
+		}
+	}
+	
+	/* Timer is supported */
+	return 1;
+}
+
+static void TM_PWM_INT_StreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	TM_PWM_TIM_t* TIM_Data = (TM_PWM_TIM_t *)Param;
+	
+	/* Stop on error */
+	if (flags & DMA_FLAG_TEIF) {
+		TM_PWM_StopBurst(TIM_Data);
+		return;
+	}
+	
+	/* Normal burst finished, last values stay in CCR registers */
+	if ((flags & DMA_FLAG_TCIF) && !(DMA_Stream->CR & DMA_SxCR_CIRC)) {
+		TIM_Data->TIM->DIER &= ~TIM_DIER_UDE;
+		TIM_Data->Active = 0;
+		
+		/* Call user function */
+		TM_PWM_BurstCompleteCallback(TIM_Data);
+	}
+}
@@ -0,0 +1,425 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   PWM library with DMA burst updates and WS2812 encoder for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_PWM_H
+#define TM_PWM_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_PWM
+ * @brief    PWM library with DMA burst updates and WS2812 encoder for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Library works with timer registers directly, HAL TIM driver is not used.
+ *
+ * \par Pinout
+ *
+\verbatim
+       |PINSPACK 1           |PINSPACK 2           |PINSPACK 3
+TIMX   |CH1  CH2  CH3  CH4   |CH1  CH2  CH3  CH4   |CH1  CH2  CH3  CH4
+       |                     |                     |
+TIM1   |PA8  PA9  PA10 PA11  |PE9  PE11 PE13 PE14  |-    -    -    -
+TIM2   |PA0  PA1  PA2  PA3   |PA5  PB3  PB10 PB11  |PA15 -    -    -
+TIM3   |PA6  PA7  PB0  PB1   |PB4  PB5  PC8  PC9   |PC6  PC7  -    -
+TIM4   |PB6  PB7  PB8  PB9   |PD12 PD13 PD14 PD15  |-    -    -    -
+TIM5   |PA0  PA1  PA2  PA3   |PH10 PH11 PH12 PI0   |-    -    -    -
+TIM8   |PC6  PC7  PC8  PC9   |PI5  PI6  PI7  PI2   |-    -    -    -
+\endverbatim
+ *
+ * \par PWM
+ *
+ * Timer is initialized for PWM frequency with @ref TM_PWM_InitTimer, prescaler is as low as possible for best resolution.
+ * Each channel is initialized separately and duty cycle is set in timer ticks, percents or microseconds.
+ * New duty cycle is used from next PWM period, so output never has glitch.
+ *
+\code
+TM_PWM_TIM_t TIM4_Data;
+
+//Init TIM4 with 1kHz PWM, LED on PD12 with 25% duty cycle
+TM_PWM_InitTimer(TIM4, &TIM4_Data, 1000);
+TM_PWM_InitChannel(&TIM4_Data, TM_PWM_Channel_1, TM_PWM_PinsPack_2);
+TM_PWM_SetChannelPercent(&TIM4_Data, TM_PWM_Channel_1, 25);
+\endcode
+ *
+ * \par DMA burst updates
+ *
+ * Timer DMA burst writes new values to more consecutive CCR registers on each update event from buffer with @ref TM_PWM_StartBurst.
+ * Buffer holds values for all channels of first period, then for all channels of next period and so on.
+ * With circular mode, buffer is repeated until @ref TM_PWM_StopBurst is called, for example for sine tables of multi-phase motor control.
+ * CPU is not used during burst at all.
+ *
+ * DMA burst is supported on TIM1, TIM3, TIM4 and TIM8, streams are allocated with TM DMA library.
+ * TIM2 and TIM5 have 32-bit CCR registers where 16-bit DMA writes are duplicated to upper half, they can be used for normal PWM only.
+ *
+\code
+//3 phases, 4 periods per cycle
+uint16_t Phases[4 * 3] = {...};
+
+//Update CH1, CH2 and CH3 of TIM1 each period, repeat forever
+TM_PWM_StartBurst(&TIM1_Data, TM_PWM_Channel_1, 3, Phases, 4, 1);
+\endcode
+ *
+ * \par WS2812 LEDs
+ *
+ * WS2812 encoder runs timer at 800kHz and sends 1 PWM period for each bit of colors. Duty cycle for each bit is saved to bit buffer
+ * when color is set, so strip update is only one DMA burst. Bit buffer holds @ref TM_PWM_WS2812_BUFFER_SIZE elements,
+ * 2 bytes for each bit and zero periods at the end for reset time, which is about 15kB for 300 LEDs.
+ *
+\code
+static uint16_t Bits[TM_PWM_WS2812_BUFFER_SIZE(300)];
+TM_PWM_WS2812_t Strip;
+
+//Strip on PB0, TIM3 channel 3
+TM_PWM_WS2812_Init(&Strip, TIM3, TM_PWM_Channel_3, TM_PWM_PinsPack_1, Bits, 300);
+
+//Set colors and send them
+TM_PWM_WS2812_SetColor(&Strip, 0, 0xFF, 0x00, 0x00);
+TM_PWM_WS2812_SetColor(&Strip, 1, 0x00, 0xFF, 0x00);
+TM_PWM_WS2812_Update(&Strip);
+\endcode
+ *
+ * On STM32F7xx, data cache is cleaned by TM DMA library when burst starts.
+ * When buffer is changed during circular burst, clean it with @ref TM_DMA_CleanCache function.
+ *
+ * \par Settings
+ *
+\code
+//Number of zero periods after WS2812 data, 224 periods is 280us
+#define PWM_WS2812_RESET_PERIODS    224
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - attributes.h
+ - TM GPIO
+ - TM DMA
+ - string.h
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_dma.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_PWM_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of zero periods after WS2812 data for reset, 280us for newer WS2812B */
+#ifndef PWM_WS2812_RESET_PERIODS
+#define PWM_WS2812_RESET_PERIODS    224
+#endif
+
+/**
+ * @brief  WS2812 bit frequency in units of Hz
+ */
+#define TM_PWM_WS2812_FREQUENCY     800000
+
+/**
+ * @brief  Number of elements in WS2812 bit buffer for LEDs
+ * @param  leds: Number of LEDs on strip
+ * @retval Number of uint16_t elements
+ */
+#define TM_PWM_WS2812_BUFFER_SIZE(leds)    ((leds) * 24 + PWM_WS2812_RESET_PERIODS)
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_PWM_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  PWM result enumeration
+ */
+typedef enum {
+	TM_PWM_Result_Ok = 0x00,  /*!< Everything OK */
+	TM_PWM_Result_Error,      /*!< Invalid timer, channel or parameter */
+	TM_PWM_Result_Busy        /*!< DMA burst is already running */
+} TM_PWM_Result_t;
+
+/**
+ * @brief  Timer channel enumeration
+ */
+typedef enum {
+	TM_PWM_Channel_1 = 0x00,  /*!< Channel 1 */
+	TM_PWM_Channel_2,         /*!< Channel 2 */
+	TM_PWM_Channel_3,         /*!< Channel 3 */
+	TM_PWM_Channel_4          /*!< Channel 4 */
+} TM_PWM_Channel_t;
+
+/**
+ * @brief  PWM pinspack enumeration
+ */
+typedef enum {
+	TM_PWM_PinsPack_1 = 0x00, /*!< Use Pinspack1 from Pinout table for channel */
+	TM_PWM_PinsPack_2,        /*!< Use Pinspack2 from Pinout table for channel */
+	TM_PWM_PinsPack_3,        /*!< Use Pinspack3 from Pinout table for channel */
+	TM_PWM_PinsPack_Custom    /*!< Use custom pin for channel, callback will be called, look @ref TM_PWM_InitCustomPinsCallback */
+} TM_PWM_PinsPack_t;
+
+/**
+ * @brief  Timer working structure
+ * @note   Structure is filled by @ref TM_PWM_InitTimer function and should not be changed by user
+ */
+typedef struct {
+	TIM_TypeDef* TIM;         /*!< Pointer to timer */
+	uint32_t Frequency;       /*!< Real PWM frequency in units of Hz */
+	uint32_t Period;          /*!< Number of timer ticks in one PWM period */
+	uint32_t Prescaler;       /*!< Timer clock divider */
+	uint32_t TickFrequency;   /*!< Timer tick frequency in units of Hz */
+	uint8_t Channels;         /*!< Bit mask of initialized channels */
+	volatile uint8_t Active;  /*!< Set to 1 when DMA burst is running */
+	DMA_HandleTypeDef hdma;   /*!< DMA handle for burst updates, stream is allocated on first burst */
+} TM_PWM_TIM_t;
+
+/**
+ * @brief  WS2812 strip structure
+ */
+typedef struct {
+	TM_PWM_TIM_t TIM;         /*!< Timer working structure */
+	TM_PWM_Channel_t Channel; /*!< Timer channel for strip */
+	uint16_t* Buffer;         /*!< Pointer to bit buffer with @ref TM_PWM_WS2812_BUFFER_SIZE elements */
+	uint16_t Leds;            /*!< Number of LEDs on strip */
+	uint16_t T0H;             /*!< Timer ticks for high time of 0 bit */
+	uint16_t T1H;             /*!< Timer ticks for high time of 1 bit */
+} TM_PWM_WS2812_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_PWM_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes timer for PWM at selected frequency
+ * @note   Timer clock is enabled and counter is started, channels are not initialized
+ * @param  *TIMx: Pointer to timer, TIM1 to TIM5 or TIM8
+ * @param  *TIM_Data: Pointer to empty @ref TM_PWM_TIM_t structure for timer
+ * @param  Frequency: PWM frequency in units of Hz
+ * @retval Member of @ref TM_PWM_Result_t enumeration:
+ *            - @ref TM_PWM_Result_Ok: Timer is initialized
+ *            - @ref TM_PWM_Result_Error: Invalid timer or frequency can not be made from timer clock
+ */
+TM_PWM_Result_t TM_PWM_InitTimer(TIM_TypeDef* TIMx, TM_PWM_TIM_t* TIM_Data, uint32_t Frequency);
+
+/**
+ * @brief  Initializes timer channel in PWM mode 1 with pin, duty cycle is 0
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  PinsPack: Pinspack for channel pin. This parameter can be a value of @ref TM_PWM_PinsPack_t enumeration
+ * @retval Member of @ref TM_PWM_Result_t enumeration:
+ *            - @ref TM_PWM_Result_Ok: Channel is initialized
+ *            - @ref TM_PWM_Result_Error: Pin does not exist for channel
+ */
+TM_PWM_Result_t TM_PWM_InitChannel(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, TM_PWM_PinsPack_t PinsPack);
+
+/**
+ * @brief  Sets duty cycle of channel in timer ticks
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  Pulse: High time in timer ticks, 0 to Period member of @ref TM_PWM_TIM_t structure
+ * @retval Member of @ref TM_PWM_Result_t enumeration:
+ *            - @ref TM_PWM_Result_Ok: Duty cycle is set
+ *            - @ref TM_PWM_Result_Error: Channel is not initialized or pulse is longer than period
+ */
+TM_PWM_Result_t TM_PWM_SetChannel(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, uint32_t Pulse);
+
+/**
+ * @brief  Sets duty cycle of channel in percents
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  Percent: Duty cycle from 0 to 100
+ * @retval Member of @ref TM_PWM_Result_t enumeration, see @ref TM_PWM_SetChannel
+ */
+TM_PWM_Result_t TM_PWM_SetChannelPercent(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, float Percent);
+
+/**
+ * @brief  Sets high time of channel in microseconds
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  Micros: High time in units of microseconds, for example 1500 for servo middle position
+ * @retval Member of @ref TM_PWM_Result_t enumeration, see @ref TM_PWM_SetChannel
+ */
+TM_PWM_Result_t TM_PWM_SetChannelMicros(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t Channel, uint32_t Micros);
+
+/**
+ * @brief  Starts DMA burst which writes consecutive channels on each timer update event
+ * @note   Channels should be initialized before. Buffer must stay valid until burst is finished
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @param  FirstChannel: First channel to update. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  Channels: Number of channels updated each period, 1 to 4 including first channel
+ * @param  *Buffer: Pointer to values in timer ticks, Channels values for each period
+ * @param  Periods: Number of periods in buffer
+ * @param  Circular: Set to 1 to repeat buffer until @ref TM_PWM_StopBurst is called
+ * @retval Member of @ref TM_PWM_Result_t enumeration:
+ *            - @ref TM_PWM_Result_Ok: Burst is started
+ *            - @ref TM_PWM_Result_Error: Timer does not support DMA burst, invalid parameter or no free DMA stream
+ *            - @ref TM_PWM_Result_Busy: Burst is already running on timer
+ */
+TM_PWM_Result_t TM_PWM_StartBurst(TM_PWM_TIM_t* TIM_Data, TM_PWM_Channel_t FirstChannel, uint8_t Channels, const uint16_t* Buffer, uint16_t Periods, uint8_t Circular);
+
+/**
+ * @brief  Stops DMA burst, last written values stay in CCR registers
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @retval None
+ */
+void TM_PWM_StopBurst(TM_PWM_TIM_t* TIM_Data);
+
+/**
+ * @brief  Checks if DMA burst is running
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of initialized timer
+ * @retval Burst status:
+ *            - 0: Burst is not running
+ *            - > 0: Burst is running
+ */
+uint8_t TM_PWM_BurstActive(TM_PWM_TIM_t* TIM_Data);
+
+/**
+ * @brief  Initializes WS2812 LED strip on timer channel, all LEDs are set to black
+ * @note   Timer is initialized at @ref TM_PWM_WS2812_FREQUENCY, other channels of the same timer can not be used
+ * @param  *Strip: Pointer to empty @ref TM_PWM_WS2812_t structure
+ * @param  *TIMx: Pointer to timer with DMA burst support, TIM1, TIM3, TIM4 or TIM8
+ * @param  Channel: Timer channel connected to strip. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  PinsPack: Pinspack for channel pin. This parameter can be a value of @ref TM_PWM_PinsPack_t enumeration
+ * @param  *Buffer: Pointer to bit buffer with @ref TM_PWM_WS2812_BUFFER_SIZE(Leds) elements
+ * @param  Leds: Number of LEDs on strip
+ * @retval Member of @ref TM_PWM_Result_t enumeration:
+ *            - @ref TM_PWM_Result_Ok: Strip is initialized
+ *            - @ref TM_PWM_Result_Error: Timer or channel can not be used
+ */
+TM_PWM_Result_t TM_PWM_WS2812_Init(TM_PWM_WS2812_t* Strip, TIM_TypeDef* TIMx, TM_PWM_Channel_t Channel, TM_PWM_PinsPack_t PinsPack, uint16_t* Buffer, uint16_t Leds);
+
+/**
+ * @brief  Sets color of one LED in bit buffer
+ * @note   Color is sent on next @ref TM_PWM_WS2812_Update call.
+ *         When changed during update, LED may get mix of old and new color until next update
+ * @param  *Strip: Pointer to @ref TM_PWM_WS2812_t structure
+ * @param  Led: LED index, 0 is first LED on strip
+ * @param  R: Red color
+ * @param  G: Green color
+ * @param  B: Blue color
+ * @retval None
+ */
+void TM_PWM_WS2812_SetColor(TM_PWM_WS2812_t* Strip, uint16_t Led, uint8_t R, uint8_t G, uint8_t B);
+
+/**
+ * @brief  Sends bit buffer to strip with DMA burst
+ * @note   Function returns immediately, check @ref TM_PWM_WS2812_IsBusy for end of update
+ * @param  *Strip: Pointer to @ref TM_PWM_WS2812_t structure
+ * @retval Member of @ref TM_PWM_Result_t enumeration:
+ *            - @ref TM_PWM_Result_Ok: Update is started
+ *            - @ref TM_PWM_Result_Error: No free DMA stream
+ *            - @ref TM_PWM_Result_Busy: Previous update is not finished yet
+ */
+TM_PWM_Result_t TM_PWM_WS2812_Update(TM_PWM_WS2812_t* Strip);
+
+/**
+ * @brief  Checks if strip update is in progress, including reset time
+ * @param  *Strip: Pointer to @ref TM_PWM_WS2812_t structure
+ * @retval Update status:
+ *            - 0: Strip is ready for new update
+ *            - > 0: Update is in progress
+ */
+uint8_t TM_PWM_WS2812_IsBusy(TM_PWM_WS2812_t* Strip);
+
+/**
+ * @brief  Burst complete callback, called from DMA interrupt when burst in normal mode is finished
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *TIM_Data: Pointer to @ref TM_PWM_TIM_t structure of timer
+ * @retval None
+ */
+void TM_PWM_BurstCompleteCallback(TM_PWM_TIM_t* TIM_Data);
+
+/**
+ * @brief  Callback for custom pins initialization
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *TIMx: Pointer to timer which needs custom pin
+ * @param  Channel: Timer channel. This parameter can be a value of @ref TM_PWM_Channel_t enumeration
+ * @param  AlternateFunction: Alternate function number which should be used for GPIO pin
+ * @retval None
+ */
+void TM_PWM_InitCustomPinsCallback(TIM_TypeDef* TIMx, TM_PWM_Channel_t Channel, uint16_t AlternateFunction);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
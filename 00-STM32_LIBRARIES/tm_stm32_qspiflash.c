@@ -28,13 +28,59 @@
 /* Private QSPI handle */
 static QSPI_HandleTypeDef QSPIHandle;
 
+/* Memory mapped mode is active */
+static uint8_t QSPI_MemoryMapped = 0;
+
+/* Code is executed from QSPI, memory mapped mode must stay active */
+static uint8_t QSPI_XIP = 0;
+
+/* Background operation in progress */
+#define QSPI_OPERATION_NONE               0x00
+#define QSPI_OPERATION_READ               0x01
+#define QSPI_OPERATION_WRITE              0x02 /* Page is sent with DMA */
+#define QSPI_OPERATION_WRITE_WAIT         0x03 /* Page is being programmed */
+#define QSPI_OPERATION_ERASE              0x04
+
+/* Erase suspend state */
+#define QSPI_SUSPEND_NONE                 0x00
+#define QSPI_SUSPEND_USER                 0x01 /* Suspended with BSP_QSPI_EraseSuspend */
+#define QSPI_SUSPEND_READ                 0x02 /* Suspended for background read, resumed when read is done */
+
+static volatile uint8_t QSPI_Operation = QSPI_OPERATION_NONE;
+static volatile uint8_t QSPI_EraseSuspended = QSPI_SUSPEND_NONE;
+
+/* Background write progress */
+static uint8_t* QSPI_AsyncData;
+static uint32_t QSPI_AsyncAddress, QSPI_AsyncEnd, QSPI_AsyncSize;
+
+#if QSPI_USE_DMA
+/* DMA handle for QSPI */
+static DMA_HandleTypeDef QSPIDMAHandle;
+#endif
+
 /* Private functions */
 static uint8_t QSPI_ResetMemory          (QSPI_HandleTypeDef *hqspi);
 static uint8_t QSPI_DummyCyclesCfg       (QSPI_HandleTypeDef *hqspi);
 static uint8_t QSPI_WriteEnable          (QSPI_HandleTypeDef *hqspi);
 static uint8_t QSPI_AutoPollingMemReady  (QSPI_HandleTypeDef *hqspi, uint32_t Timeout);
+static uint8_t QSPI_AutoPollingMemReady_IT(QSPI_HandleTypeDef *hqspi);
+static uint8_t QSPI_ReadFlagStatus       (QSPI_HandleTypeDef *hqspi, uint8_t* reg);
+static uint8_t QSPI_ReadCommand          (QSPI_HandleTypeDef *hqspi, uint32_t ReadAddr, uint32_t Size);
+static uint8_t QSPI_Erase_IT             (uint8_t Instruction, uint32_t Address);
+static uint8_t QSPI_SuspendErase         (void);
+static uint8_t QSPI_ResumeErase          (void);
+static void    QSPI_Finish               (uint8_t status);
+#if QSPI_USE_DMA
+static uint8_t QSPI_DMAInit              (void);
+static uint8_t QSPI_WritePage_DMA        (void);
+#endif
 
 uint8_t BSP_QSPI_Init(void) {
+	/* Memory can not be reset while code is executed from it */
+	if (QSPI_XIP) {
+		return QSPI_BUSY;
+	}
+
 	QSPIHandle.Instance = QUADSPI;
 
 	/* Call the DeInit function to reset the driver */
@@ -55,6 +101,11 @@ uint8_t BSP_QSPI_Init(void) {
 	QSPIHandle.Init.FlashID            = QSPI_FLASH_ID_1;
 	QSPIHandle.Init.DualFlash          = QSPI_DUALFLASH_DISABLE;
 
+	/* Command mode after init, no background operation */
+	QSPI_MemoryMapped = 0;
+	QSPI_Operation = QSPI_OPERATION_NONE;
+	QSPI_EraseSuspended = QSPI_SUSPEND_NONE;
+
 	/* Try to initialize memory */
 	if (HAL_QSPI_Init(&QSPIHandle) != HAL_OK) {
 		return QSPI_ERROR;
@@ -71,6 +122,13 @@ uint8_t BSP_QSPI_Init(void) {
 		return QSPI_NOT_SUPPORTED;
 	}
 
+#if QSPI_USE_DMA
+	/* DMA for background transfers */
+	if (QSPI_DMAInit() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+#endif
+
 	/* QSPI is OK */
 	return QSPI_OK;
 }
@@ -80,6 +138,11 @@ uint8_t BSP_QSPI_Init(void) {
   * @retval QSPI memory status
   */
 uint8_t BSP_QSPI_DeInit(void) {
+	/* Memory can not be disabled while code is executed from it */
+	if (QSPI_XIP) {
+		return QSPI_BUSY;
+	}
+
 	QSPIHandle.Instance = QUADSPI;
 
 	/* Call the DeInit function to reset the driver */
@@ -90,38 +153,49 @@ uint8_t BSP_QSPI_DeInit(void) {
 	/* System level De-initialization */
 	BSP_QSPI_MspDeInit(&QSPIHandle, NULL);
 
+	/* Background operation is lost */
+	QSPI_Operation = QSPI_OPERATION_NONE;
+	QSPI_EraseSuspended = QSPI_SUSPEND_NONE;
+
 	return QSPI_OK;
 }
 
 uint8_t BSP_QSPI_Read(uint8_t* pData, uint32_t ReadAddr, uint32_t Size)
 {
-	QSPI_CommandTypeDef s_command;
+	uint8_t status, resume = 0;
 
-	/* Initialize the read command */
-	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-	s_command.Instruction       = QUAD_INOUT_FAST_READ_CMD;
-	s_command.AddressMode       = QSPI_ADDRESS_4_LINES;
-	s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
-	s_command.Address           = ReadAddr;
-	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-	s_command.DataMode          = QSPI_DATA_4_LINES;
-	s_command.DummyCycles       = N25Q128A_DUMMY_CYCLES_READ_QUAD;
-	s_command.NbData            = Size;
-	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
-	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+	/* Memory is already visible in address space */
+	if (QSPI_MemoryMapped) {
+		memcpy(pData, (uint8_t *)(QSPI_MEMORY_ADDRESS + ReadAddr), Size);
+		return QSPI_OK;
+	}
 
-	/* Configure the command */
-	if (HAL_QSPI_Command(&QSPIHandle, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
-		return QSPI_ERROR;
+	/* Suspend erase running in background */
+	if (QSPI_Operation == QSPI_OPERATION_ERASE) {
+		status = QSPI_SuspendErase();
+		if (status == QSPI_ERROR) {
+			return QSPI_ERROR;
+		}
+		resume = status == QSPI_SUSPENDED;
+	} else if (QSPI_Operation != QSPI_OPERATION_NONE) {
+		return QSPI_BUSY;
 	}
 
-	/* Reception of the data */
-	if (HAL_QSPI_Receive(&QSPIHandle, pData, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
-		return QSPI_ERROR;
+	/* Configure the command and receive the data */
+	status = QSPI_OK;
+	if (
+		QSPI_ReadCommand(&QSPIHandle, ReadAddr, Size) != QSPI_OK ||
+		HAL_QSPI_Receive(&QSPIHandle, pData, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK
+	) {
+		status = QSPI_ERROR;
 	}
 
-	return QSPI_OK;
+	/* Continue with erase */
+	if (resume && QSPI_ResumeErase() != QSPI_OK) {
+		status = QSPI_ERROR;
+	}
+
+	return status;
 }
 
 /**
@@ -135,6 +209,16 @@ uint8_t BSP_QSPI_Write(uint8_t* pData, uint32_t WriteAddr, uint32_t Size) {
 	QSPI_CommandTypeDef s_command;
 	uint32_t end_addr, current_size, current_addr;
 
+	/* Check for background operation */
+	if (QSPI_Operation != QSPI_OPERATION_NONE || QSPI_EraseSuspended) {
+		return QSPI_BUSY;
+	}
+
+	/* Commands can not be sent in memory mapped mode */
+	if (BSP_QSPI_CommandMode() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+
 	/* Calculation of the size between the write address and the end of the page */
 	current_addr = 0;
 
@@ -207,6 +291,18 @@ uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress)
 {
   QSPI_CommandTypeDef s_command;
 
+  /* Check for background operation */
+  if (QSPI_Operation != QSPI_OPERATION_NONE || QSPI_EraseSuspended)
+  {
+    return QSPI_BUSY;
+  }
+
+  /* Commands can not be sent in memory mapped mode */
+  if (BSP_QSPI_CommandMode() != QSPI_OK)
+  {
+    return QSPI_ERROR;
+  }
+
   /* Initialize the erase command */
   s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
   s_command.Instruction       = SUBSECTOR_ERASE_CMD;
@@ -249,6 +345,18 @@ uint8_t BSP_QSPI_Erase_Chip(void)
 {
   QSPI_CommandTypeDef s_command;
 
+  /* Check for background operation */
+  if (QSPI_Operation != QSPI_OPERATION_NONE || QSPI_EraseSuspended)
+  {
+    return QSPI_BUSY;
+  }
+
+  /* Commands can not be sent in memory mapped mode */
+  if (BSP_QSPI_CommandMode() != QSPI_OK)
+  {
+    return QSPI_ERROR;
+  }
+
   /* Initialize the erase command */
   s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
   s_command.Instruction       = BULK_ERASE_CMD;
@@ -287,29 +395,22 @@ uint8_t BSP_QSPI_Erase_Chip(void)
   */
 uint8_t BSP_QSPI_GetStatus(void)
 {
-  QSPI_CommandTypeDef s_command;
   uint8_t reg;
 
-  /* Initialize the read flag status register command */
-  s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-  s_command.Instruction       = READ_FLAG_STATUS_REG_CMD;
-  s_command.AddressMode       = QSPI_ADDRESS_NONE;
-  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-  s_command.DataMode          = QSPI_DATA_1_LINE;
-  s_command.DummyCycles       = 0;
-  s_command.NbData            = 1;
-  s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
-  s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-  s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+  /* Memory is busy with background operation, status is polled by QSPI */
+  if (QSPI_Operation != QSPI_OPERATION_NONE)
+  {
+    return QSPI_BUSY;
+  }
 
-  /* Configure the command */
-  if (HAL_QSPI_Command(&QSPIHandle, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+  /* Commands can not be sent in memory mapped mode */
+  if (BSP_QSPI_CommandMode() != QSPI_OK)
   {
     return QSPI_ERROR;
   }
 
-  /* Reception of the data */
-  if (HAL_QSPI_Receive(&QSPIHandle, &reg, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+  /* Read flag status register */
+  if (QSPI_ReadFlagStatus(&QSPIHandle, &reg) != QSPI_OK)
   {
     return QSPI_ERROR;
   }
@@ -360,6 +461,18 @@ uint8_t BSP_QSPI_MemoryMappedMode(void)
   QSPI_CommandTypeDef      s_command;
   QSPI_MemoryMappedTypeDef s_mem_mapped_cfg;
 
+  /* Already in memory mapped mode */
+  if (QSPI_MemoryMapped)
+  {
+    return QSPI_OK;
+  }
+
+  /* Check for background operation */
+  if (QSPI_Operation != QSPI_OPERATION_NONE || QSPI_EraseSuspended)
+  {
+    return QSPI_BUSY;
+  }
+
   /* Configure the command for the read instruction */
   s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
   s_command.Instruction       = QUAD_INOUT_FAST_READ_CMD;
@@ -381,9 +494,264 @@ uint8_t BSP_QSPI_MemoryMappedMode(void)
     return QSPI_ERROR;
   }
 
+  /* Memory is now visible at QSPI_MEMORY_ADDRESS */
+  QSPI_MemoryMapped = 1;
+
   return QSPI_OK;
 }
 
+uint8_t BSP_QSPI_CommandMode(void) {
+	/* Already in command mode */
+	if (!QSPI_MemoryMapped) {
+		return QSPI_OK;
+	}
+
+	/* Code is executed from memory */
+	if (QSPI_XIP) {
+		return QSPI_BUSY;
+	}
+
+	/* Abort memory mapped mode */
+	if (HAL_QSPI_Abort(&QSPIHandle) != HAL_OK) {
+		return QSPI_ERROR;
+	}
+
+	/* Commands can be sent again */
+	QSPI_MemoryMapped = 0;
+
+	return QSPI_OK;
+}
+
+uint8_t* BSP_QSPI_GetPointer(uint32_t Address) {
+	/* Enable memory mapped mode if needed */
+	if (BSP_QSPI_MemoryMappedMode() != QSPI_OK) {
+		return NULL;
+	}
+
+	/* Return pointer to memory */
+	return (uint8_t *)(QSPI_MEMORY_ADDRESS + Address);
+}
+
+uint8_t BSP_QSPI_EnableXIP(void) {
+#if defined(STM32F7xx)
+	MPU_Region_InitTypeDef MPU_InitStruct;
+#endif
+
+	/* Already enabled */
+	if (QSPI_XIP) {
+		return QSPI_OK;
+	}
+
+	/* Initialize memory if not yet */
+	if (QSPIHandle.State == HAL_QSPI_STATE_RESET && BSP_QSPI_Init() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+
+#if defined(STM32F7xx)
+	/* Disable MPU during configuration */
+	HAL_MPU_Disable();
+
+	/* Whole 256 MB QSPI address space, no access, prevents speculative reads outside memory */
+	MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+	MPU_InitStruct.Number = QSPI_MPU_REGION_NUMBER;
+	MPU_InitStruct.BaseAddress = QSPI_MEMORY_ADDRESS;
+	MPU_InitStruct.Size = MPU_REGION_SIZE_256MB;
+	MPU_InitStruct.SubRegionDisable = 0x00;
+	MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL0;
+	MPU_InitStruct.AccessPermission = MPU_REGION_NO_ACCESS;
+	MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+	MPU_InitStruct.IsShareable = MPU_ACCESS_SHAREABLE;
+	MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+	MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+	HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+	/* Memory itself, normal read only memory, cacheable write through, executable */
+	MPU_InitStruct.Number = QSPI_MPU_REGION_NUMBER + 1;
+	MPU_InitStruct.Size = POSITION_VAL(N25Q128A_FLASH_SIZE) - 1;
+	MPU_InitStruct.AccessPermission = MPU_REGION_PRIV_RO_URO;
+	MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+	MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+	MPU_InitStruct.IsCacheable = MPU_ACCESS_CACHEABLE;
+	HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+	/* Enable MPU, default memory map for other memory */
+	HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+#endif
+
+	/* Memory mapped mode, background operations must be finished */
+	if (BSP_QSPI_MemoryMappedMode() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+
+#if defined(STM32F7xx)
+	/* Drop instructions and data cached before memory was mapped */
+	SCB_InvalidateICache();
+	if (SCB->CCR & SCB_CCR_DC_Msk) {
+		SCB_InvalidateDCache_by_Addr((uint32_t *)QSPI_MEMORY_ADDRESS, N25Q128A_FLASH_SIZE);
+	}
+#endif
+
+	/* Memory stays mapped from now on */
+	QSPI_XIP = 1;
+
+	return QSPI_OK;
+}
+
+uint8_t BSP_QSPI_Erase_Sector_IT(uint32_t SectorAddress) {
+	/* Start sector erase */
+	return QSPI_Erase_IT(SECTOR_ERASE_CMD, SectorAddress);
+}
+
+uint8_t BSP_QSPI_Erase_Block_IT(uint32_t BlockAddress) {
+	/* Start subsector erase */
+	return QSPI_Erase_IT(SUBSECTOR_ERASE_CMD, BlockAddress);
+}
+
+uint8_t BSP_QSPI_EraseSuspend(void) {
+	/* Already suspended */
+	if (QSPI_EraseSuspended) {
+		return QSPI_SUSPENDED;
+	}
+
+	/* Erase must be in progress */
+	if (QSPI_Operation != QSPI_OPERATION_ERASE) {
+		return QSPI_ERROR;
+	}
+
+	/* Suspend erase */
+	return QSPI_SuspendErase();
+}
+
+uint8_t BSP_QSPI_EraseResume(void) {
+	/* Only erase suspended by user can be resumed */
+	if (QSPI_EraseSuspended != QSPI_SUSPEND_USER || QSPI_Operation != QSPI_OPERATION_NONE) {
+		return QSPI_ERROR;
+	}
+
+	/* Resume erase */
+	return QSPI_ResumeErase();
+}
+
+uint8_t BSP_QSPI_IsBusy(void) {
+	/* Check background operation */
+	if (QSPI_Operation != QSPI_OPERATION_NONE) {
+		return QSPI_BUSY;
+	}
+	if (QSPI_EraseSuspended) {
+		return QSPI_SUSPENDED;
+	}
+	return QSPI_OK;
+}
+
+#if QSPI_USE_DMA
+uint8_t BSP_QSPI_Read_DMA(uint8_t* pData, uint32_t ReadAddr, uint32_t Size) {
+	uint8_t status;
+
+	/* Check size, DMA can transfer up to 65535 bytes */
+	if (Size == 0 || Size > 0xFFFF) {
+		return QSPI_ERROR;
+	}
+
+	/* Commands can not be sent in memory mapped mode */
+	if (BSP_QSPI_CommandMode() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+
+	/* Suspend erase running in background, resume it when read is done */
+	if (QSPI_Operation == QSPI_OPERATION_ERASE) {
+		status = QSPI_SuspendErase();
+		if (status == QSPI_ERROR) {
+			return QSPI_ERROR;
+		}
+		if (status == QSPI_SUSPENDED) {
+			QSPI_EraseSuspended = QSPI_SUSPEND_READ;
+		}
+	} else if (QSPI_Operation != QSPI_OPERATION_NONE) {
+		return QSPI_BUSY;
+	}
+
+#if defined(STM32F7xx)
+	/* Write back cached data before DMA writes to buffer */
+	SCB_CleanInvalidateDCache_by_Addr((uint32_t *)((uint32_t)pData & ~0x1F), Size + ((uint32_t)pData & 0x1F));
+#endif
+
+	/* Save buffer for cache invalidation */
+	QSPI_AsyncData = pData;
+	QSPI_AsyncSize = Size;
+
+	/* Start reception */
+	QSPI_Operation = QSPI_OPERATION_READ;
+	if (
+		QSPI_ReadCommand(&QSPIHandle, ReadAddr, Size) != QSPI_OK ||
+		HAL_QSPI_Receive_DMA(&QSPIHandle, pData) != HAL_OK
+	) {
+		QSPI_Operation = QSPI_OPERATION_NONE;
+
+		/* Continue with erase if it was suspended for this read */
+		if (QSPI_EraseSuspended == QSPI_SUSPEND_READ) {
+			QSPI_ResumeErase();
+		}
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+uint8_t BSP_QSPI_Write_DMA(uint8_t* pData, uint32_t WriteAddr, uint32_t Size) {
+	/* Check for background operation */
+	if (QSPI_Operation != QSPI_OPERATION_NONE || QSPI_EraseSuspended) {
+		return QSPI_BUSY;
+	}
+
+	/* Nothing to write */
+	if (Size == 0) {
+		return QSPI_OK;
+	}
+
+	/* Commands can not be sent in memory mapped mode */
+	if (BSP_QSPI_CommandMode() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+
+#if defined(STM32F7xx)
+	/* DMA reads from memory, write back cached data */
+	SCB_CleanDCache_by_Addr((uint32_t *)((uint32_t)pData & ~0x1F), Size + ((uint32_t)pData & 0x1F));
+#endif
+
+	/* Save write progress */
+	QSPI_AsyncData = pData;
+	QSPI_AsyncAddress = WriteAddr;
+	QSPI_AsyncEnd = WriteAddr + Size;
+
+	/* Start with first page, next pages are started from interrupt */
+	QSPI_Operation = QSPI_OPERATION_WRITE;
+	if (QSPI_WritePage_DMA() != QSPI_OK) {
+		QSPI_Operation = QSPI_OPERATION_NONE;
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+#endif
+
+__weak void BSP_QSPI_ReadCpltCallback(uint8_t status) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+	   the BSP_QSPI_ReadCpltCallback could be implemented in the user file
+	*/
+}
+
+__weak void BSP_QSPI_WriteCpltCallback(uint8_t status) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+	   the BSP_QSPI_WriteCpltCallback could be implemented in the user file
+	*/
+}
+
+__weak void BSP_QSPI_EraseCpltCallback(uint8_t status) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+	   the BSP_QSPI_EraseCpltCallback could be implemented in the user file
+	*/
+}
+
 /**
   * @}
   */
@@ -441,7 +809,7 @@ __weak void BSP_QSPI_MspInit(QSPI_HandleTypeDef *hqspi, void *Params)
 
   /*##-3- Configure the NVIC for QSPI #########################################*/
   /* NVIC configuration for QSPI interrupt */
-  HAL_NVIC_SetPriority(QUADSPI_IRQn, 0x0F, 0);
+  HAL_NVIC_SetPriority(QUADSPI_IRQn, QSPIFLASH_NVIC_PRIORITY, 0);
   HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
 
 }
@@ -632,3 +1000,409 @@ static uint8_t QSPI_AutoPollingMemReady(QSPI_HandleTypeDef *hqspi, uint32_t Time
 
 	return QSPI_OK;
 }
+
+static uint8_t QSPI_AutoPollingMemReady_IT(QSPI_HandleTypeDef *hqspi) {
+	QSPI_CommandTypeDef     s_command;
+	QSPI_AutoPollingTypeDef s_config;
+
+	/* Configure automatic polling mode in interrupt mode, status match interrupt comes when memory is ready */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = READ_STATUS_REG_CMD;
+	s_command.AddressMode       = QSPI_ADDRESS_NONE;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_1_LINE;
+	s_command.DummyCycles       = 0;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	s_config.Match           = 0;
+	s_config.Mask            = N25Q128A_SR_WIP;
+	s_config.MatchMode       = QSPI_MATCH_MODE_AND;
+	s_config.StatusBytesSize = 1;
+	s_config.Interval        = 0x10;
+	s_config.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+	if (HAL_QSPI_AutoPolling_IT(hqspi, &s_command, &s_config) != HAL_OK) {
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+static uint8_t QSPI_ReadFlagStatus(QSPI_HandleTypeDef *hqspi, uint8_t* reg) {
+	QSPI_CommandTypeDef s_command;
+
+	/* Initialize the read flag status register command */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = READ_FLAG_STATUS_REG_CMD;
+	s_command.AddressMode       = QSPI_ADDRESS_NONE;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_1_LINE;
+	s_command.DummyCycles       = 0;
+	s_command.NbData            = 1;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Configure the command */
+	if (HAL_QSPI_Command(hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
+		return QSPI_ERROR;
+	}
+
+	/* Reception of the data */
+	if (HAL_QSPI_Receive(hqspi, reg, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+static uint8_t QSPI_ReadCommand(QSPI_HandleTypeDef *hqspi, uint32_t ReadAddr, uint32_t Size) {
+	QSPI_CommandTypeDef s_command;
+
+	/* Initialize the read command */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = QUAD_INOUT_FAST_READ_CMD;
+	s_command.AddressMode       = QSPI_ADDRESS_4_LINES;
+	s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
+	s_command.Address           = ReadAddr;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_4_LINES;
+	s_command.DummyCycles       = N25Q128A_DUMMY_CYCLES_READ_QUAD;
+	s_command.NbData            = Size;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Configure the command */
+	if (HAL_QSPI_Command(hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+static uint8_t QSPI_Erase_IT(uint8_t Instruction, uint32_t Address) {
+	QSPI_CommandTypeDef s_command;
+
+	/* Check for background operation */
+	if (QSPI_Operation != QSPI_OPERATION_NONE || QSPI_EraseSuspended) {
+		return QSPI_BUSY;
+	}
+
+	/* Commands can not be sent in memory mapped mode */
+	if (BSP_QSPI_CommandMode() != QSPI_OK) {
+		return QSPI_ERROR;
+	}
+
+	/* Initialize the erase command */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = Instruction;
+	s_command.AddressMode       = QSPI_ADDRESS_1_LINE;
+	s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
+	s_command.Address           = Address;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_NONE;
+	s_command.DummyCycles       = 0;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Enable write operations and send the command */
+	if (
+		QSPI_WriteEnable(&QSPIHandle) != QSPI_OK ||
+		HAL_QSPI_Command(&QSPIHandle, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK
+	) {
+		return QSPI_ERROR;
+	}
+
+	/* Wait for end of erase in interrupt */
+	QSPI_Operation = QSPI_OPERATION_ERASE;
+	if (QSPI_AutoPollingMemReady_IT(&QSPIHandle) != QSPI_OK) {
+		QSPI_Operation = QSPI_OPERATION_NONE;
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+static uint8_t QSPI_SuspendErase(void) {
+	QSPI_CommandTypeDef     s_command;
+	QSPI_AutoPollingTypeDef s_config;
+	uint8_t reg;
+
+	/* Status match interrupt must not come while polling is stopped */
+	HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
+
+	/* Erase finished before interrupt was disabled */
+	if (QSPI_Operation != QSPI_OPERATION_ERASE) {
+		HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+		return QSPI_OK;
+	}
+
+	/* Status already matched, erase is done, finish it here */
+	if (__HAL_QSPI_GET_FLAG(&QSPIHandle, QSPI_FLAG_SM)) {
+		HAL_QSPI_IRQHandler(&QSPIHandle);
+		HAL_NVIC_ClearPendingIRQ(QUADSPI_IRQn);
+		HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+		return QSPI_OK;
+	}
+
+	/* Stop automatic polling */
+	__HAL_QSPI_DISABLE_IT(&QSPIHandle, QSPI_IT_SM | QSPI_IT_TE);
+	HAL_QSPI_Abort(&QSPIHandle);
+	__HAL_QSPI_CLEAR_FLAG(&QSPIHandle, QSPI_FLAG_SM | QSPI_FLAG_TE);
+	HAL_NVIC_ClearPendingIRQ(QUADSPI_IRQn);
+	HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+
+	/* Send suspend command */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = PROG_ERASE_SUSPEND_CMD;
+	s_command.AddressMode       = QSPI_ADDRESS_NONE;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_NONE;
+	s_command.DummyCycles       = 0;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	if (HAL_QSPI_Command(&QSPIHandle, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
+		QSPI_Finish(QSPI_ERROR);
+		return QSPI_ERROR;
+	}
+
+	/* Wait for suspend latency, memory is ready when erase is suspended */
+	s_config.Match           = N25Q128A_FSR_READY;
+	s_config.Mask            = N25Q128A_FSR_READY;
+	s_config.MatchMode       = QSPI_MATCH_MODE_AND;
+	s_config.StatusBytesSize = 1;
+	s_config.Interval        = 0x10;
+	s_config.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+	s_command.Instruction    = READ_FLAG_STATUS_REG_CMD;
+	s_command.DataMode       = QSPI_DATA_1_LINE;
+
+	if (
+		HAL_QSPI_AutoPolling(&QSPIHandle, &s_command, &s_config, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK ||
+		QSPI_ReadFlagStatus(&QSPIHandle, &reg) != QSPI_OK
+	) {
+		QSPI_Finish(QSPI_ERROR);
+		return QSPI_ERROR;
+	}
+
+	/* Erase was finished before suspend command */
+	if ((reg & N25Q128A_FSR_ERSUS) == 0) {
+		QSPI_Finish((reg & N25Q128A_FSR_ERERR) ? QSPI_ERROR : QSPI_OK);
+		return QSPI_OK;
+	}
+
+	/* Erase is suspended, memory accepts other commands */
+	QSPI_Operation = QSPI_OPERATION_NONE;
+	QSPI_EraseSuspended = QSPI_SUSPEND_USER;
+	return QSPI_SUSPENDED;
+}
+
+static uint8_t QSPI_ResumeErase(void) {
+	QSPI_CommandTypeDef s_command;
+
+	/* Erase is active again */
+	QSPI_EraseSuspended = QSPI_SUSPEND_NONE;
+	QSPI_Operation = QSPI_OPERATION_ERASE;
+
+	/* Send resume command */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = PROG_ERASE_RESUME_CMD;
+	s_command.AddressMode       = QSPI_ADDRESS_NONE;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_NONE;
+	s_command.DummyCycles       = 0;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Wait for end of erase in interrupt */
+	if (
+		HAL_QSPI_Command(&QSPIHandle, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK ||
+		QSPI_AutoPollingMemReady_IT(&QSPIHandle) != QSPI_OK
+	) {
+		QSPI_Finish(QSPI_ERROR);
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+static void QSPI_Finish(uint8_t status) {
+	uint8_t operation = QSPI_Operation;
+
+	/* Operation is done, callback may start new one */
+	QSPI_Operation = QSPI_OPERATION_NONE;
+
+	/* Call user callback */
+	if (operation == QSPI_OPERATION_READ) {
+		BSP_QSPI_ReadCpltCallback(status);
+	} else if (operation == QSPI_OPERATION_WRITE || operation == QSPI_OPERATION_WRITE_WAIT) {
+		BSP_QSPI_WriteCpltCallback(status);
+	} else if (operation == QSPI_OPERATION_ERASE) {
+		BSP_QSPI_EraseCpltCallback(status);
+	}
+}
+
+#if QSPI_USE_DMA
+static uint8_t QSPI_DMAInit(void) {
+	/* Enable DMA clock */
+	QSPI_DMA_CLK_ENABLE();
+
+	/* DMA stream, direction is changed by HAL for each transfer */
+	QSPIDMAHandle.Instance                 = QSPI_DMA_STREAM;
+	QSPIDMAHandle.Init.Channel             = QSPI_DMA_CHANNEL;
+	QSPIDMAHandle.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+	QSPIDMAHandle.Init.PeriphInc           = DMA_PINC_DISABLE;
+	QSPIDMAHandle.Init.MemInc              = DMA_MINC_ENABLE;
+	QSPIDMAHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	QSPIDMAHandle.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+	QSPIDMAHandle.Init.Mode                = DMA_NORMAL;
+	QSPIDMAHandle.Init.Priority            = DMA_PRIORITY_HIGH;
+	QSPIDMAHandle.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+	QSPIDMAHandle.Init.FIFOThreshold       = DMA_FIFO_THRESHOLD_FULL;
+	QSPIDMAHandle.Init.MemBurst            = DMA_MBURST_SINGLE;
+	QSPIDMAHandle.Init.PeriphBurst         = DMA_PBURST_SINGLE;
+
+	/* Initialize DMA */
+	HAL_DMA_DeInit(&QSPIDMAHandle);
+	if (HAL_DMA_Init(&QSPIDMAHandle) != HAL_OK) {
+		return QSPI_ERROR;
+	}
+
+	/* Link DMA to QSPI handle */
+	__HAL_LINKDMA(&QSPIHandle, hdma, QSPIDMAHandle);
+
+	/* NVIC configuration for DMA interrupt */
+	HAL_NVIC_SetPriority(QSPI_DMA_IRQn, QSPIFLASH_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(QSPI_DMA_IRQn);
+
+	return QSPI_OK;
+}
+
+static uint8_t QSPI_WritePage_DMA(void) {
+	QSPI_CommandTypeDef s_command;
+
+	/* Write up to the end of page */
+	QSPI_AsyncSize = N25Q128A_PAGE_SIZE - (QSPI_AsyncAddress % N25Q128A_PAGE_SIZE);
+	if (QSPI_AsyncSize > (QSPI_AsyncEnd - QSPI_AsyncAddress)) {
+		QSPI_AsyncSize = QSPI_AsyncEnd - QSPI_AsyncAddress;
+	}
+
+	/* Initialize the program command */
+	s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	s_command.Instruction       = EXT_QUAD_IN_FAST_PROG_CMD;
+	s_command.AddressMode       = QSPI_ADDRESS_4_LINES;
+	s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
+	s_command.Address           = QSPI_AsyncAddress;
+	s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	s_command.DataMode          = QSPI_DATA_4_LINES;
+	s_command.DummyCycles       = 0;
+	s_command.NbData            = QSPI_AsyncSize;
+	s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Enable write operations, configure the command and start transmission */
+	if (
+		QSPI_WriteEnable(&QSPIHandle) != QSPI_OK ||
+		HAL_QSPI_Command(&QSPIHandle, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK ||
+		HAL_QSPI_Transmit_DMA(&QSPIHandle, QSPI_AsyncData) != HAL_OK
+	) {
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+/* DMA stream interrupt handler */
+void QSPI_DMA_IRQHandler(void) {
+	HAL_DMA_IRQHandler(&QSPIDMAHandle);
+}
+#endif
+
+/* QSPI interrupt handler */
+void QUADSPI_IRQHandler(void) {
+	HAL_QSPI_IRQHandler(&QSPIHandle);
+}
+
+/* Page is sent, wait for end of programming */
+void HAL_QSPI_TxCpltCallback(QSPI_HandleTypeDef *hqspi) {
+	if (QSPI_Operation != QSPI_OPERATION_WRITE) {
+		return;
+	}
+
+	/* Update progress */
+	QSPI_AsyncData += QSPI_AsyncSize;
+	QSPI_AsyncAddress += QSPI_AsyncSize;
+
+	/* Poll status in hardware */
+	QSPI_Operation = QSPI_OPERATION_WRITE_WAIT;
+	if (QSPI_AutoPollingMemReady_IT(hqspi) != QSPI_OK) {
+		QSPI_Finish(QSPI_ERROR);
+	}
+}
+
+/* Background read is done */
+void HAL_QSPI_RxCpltCallback(QSPI_HandleTypeDef *hqspi) {
+	if (QSPI_Operation != QSPI_OPERATION_READ) {
+		return;
+	}
+
+#if defined(STM32F7xx)
+	/* Drop cached data, buffer was written by DMA */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)((uint32_t)QSPI_AsyncData & ~0x1F), QSPI_AsyncSize + ((uint32_t)QSPI_AsyncData & 0x1F));
+#endif
+
+	/* Continue with erase if it was suspended for this read */
+	QSPI_Operation = QSPI_OPERATION_NONE;
+	if (QSPI_EraseSuspended == QSPI_SUSPEND_READ) {
+		QSPI_ResumeErase();
+	}
+
+	/* Call user callback */
+	BSP_QSPI_ReadCpltCallback(QSPI_OK);
+}
+
+/* Memory is ready after program or erase */
+void HAL_QSPI_StatusMatchCallback(QSPI_HandleTypeDef *hqspi) {
+	uint8_t reg;
+
+#if QSPI_USE_DMA
+	/* Program next page */
+	if (QSPI_Operation == QSPI_OPERATION_WRITE_WAIT && QSPI_AsyncAddress < QSPI_AsyncEnd) {
+		QSPI_Operation = QSPI_OPERATION_WRITE;
+		if (QSPI_WritePage_DMA() != QSPI_OK) {
+			QSPI_Finish(QSPI_ERROR);
+		}
+		return;
+	}
+#endif
+
+	/* Operation is done, check error flags */
+	if (QSPI_Operation == QSPI_OPERATION_WRITE_WAIT || QSPI_Operation == QSPI_OPERATION_ERASE) {
+		if (QSPI_ReadFlagStatus(hqspi, &reg) != QSPI_OK) {
+			QSPI_Finish(QSPI_ERROR);
+		} else if ((reg & (N25Q128A_FSR_PRERR | N25Q128A_FSR_VPPERR | N25Q128A_FSR_PGERR | N25Q128A_FSR_ERERR)) != 0) {
+			QSPI_Finish(QSPI_ERROR);
+		} else {
+			QSPI_Finish(QSPI_OK);
+		}
+	}
+}
+
+/* Transfer error or DMA error during background operation */
+void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *hqspi) {
+	if (QSPI_Operation == QSPI_OPERATION_NONE) {
+		return;
+	}
+
+	/* Stop transfer and report error */
+	HAL_QSPI_Abort(hqspi);
+	QSPI_Finish(QSPI_ERROR);
+}
@@ -3,10 +3,10 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.4
  * @ide     Keil uVision
  * @license MIT
- * @brief   Library template 
+ * @brief   N25Q128A QSPI flash memory library
  *	
 \verbatim
    ----------------------------------------------------------------------
@@ -34,8 +34,8 @@
    ----------------------------------------------------------------------
 \endverbatim
  */
-#ifndef TM_LIBRARY_H
-#define TM_LIBRARY_H 100
+#ifndef TM_QSPIFLASH_H
+#define TM_QSPIFLASH_H 140
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -48,15 +48,160 @@ extern "C" {
  */
 
 /**
- * @defgroup TM_LIBNAME
- * @brief    Library description here
+ * @defgroup TM_QSPIFLASH
+ * @brief    N25Q128A QSPI flash memory library for STM32F446xx and STM32F7xx devices
  * @{
+ *
+ * \par Memory mapped mode
+ *
+ * In memory mapped mode, QSPI flash is visible in CPU address space at @ref QSPI_MEMORY_ADDRESS
+ * and can be read by CPU, DMA or DMA2D like internal memory, without command for each read.
+ *
+ * Use @ref BSP_QSPI_GetPointer() to get pointer to data in flash. It switches memory to memory mapped mode if needed.
+ * Read only data like font tables, images or read only file system images can be used directly from returned pointer.
+ *
+ * @ref BSP_QSPI_Write() and erase functions switch memory back to command mode automatically.
+ * Pointers are not valid while memory is in command mode, call @ref BSP_QSPI_GetPointer() again after write or erase.
+ *
+\code
+//Use font stored in QSPI flash at address 0x10000
+TM_FONT_t Font;
+Font.FontWidth = 11;
+Font.FontHeight = 18;
+Font.data = (const uint16_t *)BSP_QSPI_GetPointer(0x10000);
+
+//Copy 100x100 pixels image from QSPI flash at address 0x20000 directly to LCD with DMA2D
+TM_DMA2DGRAPHIC_CopyBuffer(BSP_QSPI_GetPointer(0x20000), LCD_FRAME_BUFFER, 100, 100, 0, LCD_WIDTH - 100);
+\endcode
+ *
+ * \par Execute in place
+ *
+ * Code which is not time critical (user interface, test routines) and large constant data (fonts, images)
+ * can be executed and read directly from QSPI flash to save internal flash. Mark them with __qspi and __qspi_const
+ * attributes from attributes.h, linker script or scatter file must place .qspi and .qspi_rodata sections to QSPI memory:
+ *
+\code
+//GCC linker script, add region to MEMORY
+QSPI (rx)       : ORIGIN = 0x90000000, LENGTH = 16M
+
+//and section to SECTIONS
+.qspi :
+{
+  . = ALIGN(4);
+  *(.qspi)
+  *(.qspi*)
+  . = ALIGN(4);
+} >QSPI
+
+//Keil scatter file, add load region
+LR_QSPI 0x90000000 0x01000000 {
+  ER_QSPI 0x90000000 0x01000000 {
+    *(.qspi, .qspi_rodata)
+  }
+}
+\endcode
+ *
+ * Memory mapped mode must be active before first function or constant from QSPI is used.
+ * Call @ref BSP_QSPI_EnableXIP() in main right after clock and HAL initialization, code until then runs from internal flash.
+ * It configures MPU region for QSPI as cacheable, read only memory, so CPU instruction cache and data cache work for QSPI,
+ * and blocks speculative accesses to unused part of QSPI address space.
+ *
+\code
+//Menu code is stored in QSPI flash
+__qspi void Menu_Show(void) {
+	...
+}
+
+int main(void) {
+	//Init system clock and HAL, executed from internal flash
+	TM_RCC_InitSystem();
+	HAL_Init();
+
+	//Make QSPI code and data available
+	if (BSP_QSPI_EnableXIP() != QSPI_OK) {
+		//Code in QSPI can not be used
+		while (1);
+	}
+
+	//Call function in QSPI flash
+	Menu_Show();
+}
+\endcode
+ *
+ * @note   Interrupt vector table, interrupt handlers which may run before @ref BSP_QSPI_EnableXIP and time critical code
+ *         must stay in internal flash. Functions from this library are never placed to QSPI.
+ * @note   When XIP is enabled, memory stays in memory mapped mode: write, erase and background operations return
+ *         @ref QSPI_BUSY as commands would stop code execution from QSPI.
+ *
+ * \par Background operations
+ *
+ * Program and erase take up to hundreds of milliseconds, most of that time memory is busy with internal operation.
+ * @ref BSP_QSPI_Write_DMA, @ref BSP_QSPI_Erase_Block_IT and @ref BSP_QSPI_Erase_Sector_IT start operation and return immediately.
+ * Status register is then polled by QSPI peripheral in hardware, interrupt comes only when memory is ready.
+ * @ref BSP_QSPI_WriteCpltCallback or @ref BSP_QSPI_EraseCpltCallback is called from interrupt when operation is finished.
+ *
+ * @ref BSP_QSPI_Read_DMA reads data with DMA in background and calls @ref BSP_QSPI_ReadCpltCallback.
+ * DMA functions are available when QSPI_USE_DMA is enabled, library then handles DMA stream interrupt:
+ *
+\code
+//Enable DMA for QSPI, DMA2 Stream 7 by default
+#define QSPI_USE_DMA                      1
+
+//TM DMA library must not define handler for the same stream
+#define DMA2_STREAM7_DISABLE_IRQHANDLER
+\endcode
+ *
+ * \par Erase suspend
+ *
+ * When data are read while erase is running in background, erase is suspended, data are read and erase is resumed,
+ * so reading waits for suspend latency only and not for whole erase. This is done automatically in @ref BSP_QSPI_Read
+ * and @ref BSP_QSPI_Read_DMA, erase can also be suspended manually with @ref BSP_QSPI_EraseSuspend and @ref BSP_QSPI_EraseResume.
+ *
+ * Other functions return @ref QSPI_BUSY while background operation is in progress or erase is suspended.
+ *
+ * @note   Library handles QUADSPI_IRQHandler and implements HAL_QSPI_TxCpltCallback, HAL_QSPI_RxCpltCallback,
+ *         HAL_QSPI_StatusMatchCallback and HAL_QSPI_ErrorCallback, do not implement them in your project
+ *
+ * @note   Data in erased sector are not valid until erase is finished
+ * @note   On STM32F7xx, DMA buffers should be aligned to 32 bytes and multiple of 32 bytes for cache maintenance
+ *
+\code
+//Erase log sector in background
+BSP_QSPI_Erase_Block_IT(LOG_ADDRESS);
+
+//Assets can be loaded meanwhile, erase is suspended during read
+BSP_QSPI_Read(Image, IMAGE_ADDRESS, sizeof(Image));
+
+//Called from interrupt when erase is done
+void BSP_QSPI_EraseCpltCallback(uint8_t status) {
+	//Write log in background
+	BSP_QSPI_Write_DMA(Log, LOG_ADDRESS, sizeof(Log));
+}
+\endcode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Added library header with memory settings and pinout
+  - Added memory mapped mode tracking with BSP_QSPI_GetPointer and BSP_QSPI_CommandMode functions
+
+ Version 1.2
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
+
+ Version 1.3
+  - October 14, 2026
+  - Added DMA reads and page program in background with hardware status polling in interrupt mode
+  - Added erase in background with erase suspend and resume, reads suspend running erase automatically
+
+ Version 1.4
+  - October 14, 2026
+  - Added @ref BSP_QSPI_EnableXIP() for code execution from QSPI flash with MPU and cache configuration
 \endverbatim
  *
  * \par Dependencies
@@ -64,38 +209,366 @@ extern "C" {
 \verbatim
  - STM32Fxxx HAL
  - defines.h
+ - string.h
 \endverbatim
  */
 
 #include "stm32fxxx_hal.h"
 #include "defines.h"
+#include "string.h"
 
 /**
- * @defgroup TM_LIB_Macros
+ * @defgroup TM_QSPIFLASH_Macros
  * @brief    Library defines
  * @{
  */
-/* Macros here */
+
+/* Memory status */
+#define QSPI_OK                           ((uint8_t)0x00) /*!< Operation OK */
+#define QSPI_ERROR                        ((uint8_t)0x01) /*!< Operation failed */
+#define QSPI_BUSY                         ((uint8_t)0x02) /*!< Memory is busy */
+#define QSPI_NOT_SUPPORTED                ((uint8_t)0x04) /*!< Memory does not respond */
+#define QSPI_SUSPENDED                    ((uint8_t)0x08) /*!< Program or erase is suspended */
+
+/* Address where memory is visible in memory mapped mode */
+#define QSPI_MEMORY_ADDRESS               ((uint32_t)0x90000000)
+
+/* N25Q128A memory settings */
+#define N25Q128A_FLASH_SIZE               0x1000000 /* 128 MBits => 16 MBytes */
+#define N25Q128A_SECTOR_SIZE              0x10000   /* 256 sectors of 64 kBytes */
+#define N25Q128A_SUBSECTOR_SIZE           0x1000    /* 4096 subsectors of 4 kBytes */
+#define N25Q128A_PAGE_SIZE                0x100     /* 65536 pages of 256 bytes */
+
+#define N25Q128A_DUMMY_CYCLES_READ        8
+#define N25Q128A_DUMMY_CYCLES_READ_QUAD   10
+
+#define N25Q128A_BULK_ERASE_MAX_TIME      250000
+#define N25Q128A_SECTOR_ERASE_MAX_TIME    3000
+#define N25Q128A_SUBSECTOR_ERASE_MAX_TIME 800
+
+/* N25Q128A commands */
+#define RESET_ENABLE_CMD                  0x66
+#define RESET_MEMORY_CMD                  0x99
+#define READ_STATUS_REG_CMD               0x05
+#define READ_FLAG_STATUS_REG_CMD          0x70
+#define READ_VOL_CFG_REG_CMD              0x85
+#define WRITE_VOL_CFG_REG_CMD             0x81
+#define WRITE_ENABLE_CMD                  0x06
+#define QUAD_INOUT_FAST_READ_CMD          0xEB
+#define EXT_QUAD_IN_FAST_PROG_CMD         0x12
+#define SUBSECTOR_ERASE_CMD               0x20
+#define SECTOR_ERASE_CMD                  0xD8
+#define PROG_ERASE_SUSPEND_CMD            0x75
+#define PROG_ERASE_RESUME_CMD             0x7A
+#define BULK_ERASE_CMD                    0xC7
+
+/* N25Q128A registers */
+#define N25Q128A_SR_WIP                   ((uint8_t)0x01) /*!< Write in progress */
+#define N25Q128A_SR_WREN                  ((uint8_t)0x02) /*!< Write enable latch */
+#define N25Q128A_VCR_NB_DUMMY             ((uint8_t)0xF0) /*!< Number of dummy clock cycles */
+#define N25Q128A_FSR_PRERR                ((uint8_t)0x02) /*!< Protection error */
+#define N25Q128A_FSR_PGSUS                ((uint8_t)0x04) /*!< Program operation suspended */
+#define N25Q128A_FSR_VPPERR               ((uint8_t)0x08) /*!< Invalid voltage during program or erase */
+#define N25Q128A_FSR_PGERR                ((uint8_t)0x10) /*!< Program error */
+#define N25Q128A_FSR_ERERR                ((uint8_t)0x20) /*!< Erase error */
+#define N25Q128A_FSR_ERSUS                ((uint8_t)0x40) /*!< Erase operation suspended */
+#define N25Q128A_FSR_READY                ((uint8_t)0x80) /*!< Ready or command in progress */
+
+/* Alternate function names on STM32F7xx */
+#if !defined(GPIO_AF9_QSPI) && defined(GPIO_AF9_QUADSPI)
+#define GPIO_AF9_QSPI                     GPIO_AF9_QUADSPI
+#define GPIO_AF10_QSPI                    GPIO_AF10_QUADSPI
+#endif
+
+/* Default pinout, CS = PB6, CLK = PF10, D0 = PF8, D1 = PF9, D2 = PF7, D3 = PF6 */
+#ifndef QSPI_CS_PIN
+#define QSPI_CS_PIN                       GPIO_PIN_6
+#define QSPI_CS_GPIO_PORT                 GPIOB
+#define QSPI_CS_GPIO_CLK_ENABLE()         __HAL_RCC_GPIOB_CLK_ENABLE()
+#endif
+
+#ifndef QSPI_CLK_PIN
+#define QSPI_CLK_PIN                      GPIO_PIN_10
+#define QSPI_CLK_GPIO_PORT                GPIOF
+#endif
+
+#ifndef QSPI_DX_GPIO_PORT
+#define QSPI_D0_PIN                       GPIO_PIN_8
+#define QSPI_D1_PIN                       GPIO_PIN_9
+#define QSPI_D2_PIN                       GPIO_PIN_7
+#define QSPI_D3_PIN                       GPIO_PIN_6
+#define QSPI_DX_GPIO_PORT                 GPIOF
+#define QSPI_DX_CLK_GPIO_CLK_ENABLE()     __HAL_RCC_GPIOF_CLK_ENABLE()
+#endif
+
+/* NVIC preemption priority for QSPI and DMA interrupts, used for background operations only */
+#ifndef QSPIFLASH_NVIC_PRIORITY
+#define QSPIFLASH_NVIC_PRIORITY           NVIC_PRIORITY_IDLE
+#endif
+
+/* Use DMA for background reads and writes */
+#ifndef QSPI_USE_DMA
+#define QSPI_USE_DMA                      0
+#endif
+
+/* DMA stream for QSPI, DMA2 Stream 7 Channel 3 on STM32F446xx and STM32F7xx */
+#ifndef QSPI_DMA_STREAM
+#define QSPI_DMA_STREAM                   DMA2_Stream7
+#define QSPI_DMA_CHANNEL                  DMA_CHANNEL_3
+#define QSPI_DMA_IRQn                     DMA2_Stream7_IRQn
+#define QSPI_DMA_IRQHandler               DMA2_Stream7_IRQHandler
+#define QSPI_DMA_CLK_ENABLE()             __HAL_RCC_DMA2_CLK_ENABLE()
+#endif
+
+/* First of two MPU regions used for execute in place, QSPI address space and QSPI memory itself.
+   TM DMA library uses region 7 by default */
+#ifndef QSPI_MPU_REGION_NUMBER
+#define QSPI_MPU_REGION_NUMBER            5
+#endif
+
+/* QSPI peripheral clock and reset */
+#define QSPI_CLK_ENABLE()                 __HAL_RCC_QSPI_CLK_ENABLE()
+#define QSPI_CLK_DISABLE()                __HAL_RCC_QSPI_CLK_DISABLE()
+#define QSPI_FORCE_RESET()                __HAL_RCC_QSPI_FORCE_RESET()
+#define QSPI_RELEASE_RESET()              __HAL_RCC_QSPI_RELEASE_RESET()
+
 /**
  * @}
  */
  
 /**
- * @defgroup TM_LIB_Typedefs
+ * @defgroup TM_QSPIFLASH_Typedefs
  * @brief    Library Typedefs
  * @{
  */
-/* Typedefs here */
+
+/**
+ * @brief  QSPI memory information
+ */
+typedef struct {
+	uint32_t FlashSize;          /*!< Size of the flash */
+	uint32_t EraseSectorSize;    /*!< Size of sectors for the erase operation */
+	uint32_t EraseSectorsNumber; /*!< Number of sectors for the erase operation */
+	uint32_t ProgPageSize;       /*!< Size of pages for the program operation */
+	uint32_t ProgPagesNumber;    /*!< Number of pages for the program operation */
+} QSPI_InfoTypeDef;
+
 /**
  * @}
  */
 
 /**
- * @defgroup TM_LIB_Functions
+ * @defgroup TM_QSPIFLASH_Functions
  * @brief    Library Functions
  * @{
  */
-/* Functions here */
+
+/**
+ * @brief  Initializes QSPI interface and memory
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_Init(void);
+
+/**
+ * @brief  De-initializes QSPI interface
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_DeInit(void);
+
+/**
+ * @brief  Reads data from QSPI memory
+ * @note   In memory mapped mode, data are copied from memory mapped region
+ * @param  *pData: Pointer to data to be read
+ * @param  ReadAddr: Read start address
+ * @param  Size: Size of data to read
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_Read(uint8_t* pData, uint32_t ReadAddr, uint32_t Size);
+
+/**
+ * @brief  Writes data to QSPI memory
+ * @note   Memory is switched to command mode if needed
+ * @param  *pData: Pointer to data to be written
+ * @param  WriteAddr: Write start address
+ * @param  Size: Size of data to write
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_Write(uint8_t* pData, uint32_t WriteAddr, uint32_t Size);
+
+/**
+ * @brief  Erases subsector (4 kB) of QSPI memory
+ * @note   Memory is switched to command mode if needed
+ * @param  BlockAddress: Address of subsector to erase
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress);
+
+/**
+ * @brief  Erases entire QSPI memory
+ * @note   Memory is switched to command mode if needed
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_Erase_Chip(void);
+
+/**
+ * @brief  Reads current status of QSPI memory
+ * @note   Memory is switched to command mode if needed
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_GetStatus(void);
+
+/**
+ * @brief  Fills structure with memory configuration
+ * @param  *pInfo: Pointer to @ref QSPI_InfoTypeDef structure
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_GetInfo(QSPI_InfoTypeDef* pInfo);
+
+/**
+ * @brief  Configures QSPI in memory mapped mode
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_MemoryMappedMode(void);
+
+/**
+ * @brief  Leaves memory mapped mode so commands can be sent to memory
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_CommandMode(void);
+
+/**
+ * @brief  Gets pointer to data in QSPI memory, memory is switched to memory mapped mode if needed
+ * @param  Address: Address in QSPI memory
+ * @retval Pointer to data or NULL if memory mapped mode can not be enabled
+ */
+uint8_t* BSP_QSPI_GetPointer(uint32_t Address);
+
+/**
+ * @brief  Enables execute in place from QSPI memory
+ * @note   Initializes memory if needed, configures MPU on STM32F7xx devices and enables memory mapped mode permanently.
+ *         Must be called before any code or constant in .qspi sections is used
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_EnableXIP(void);
+
+/**
+ * @brief  Erases sector (64 kB) of QSPI memory in background
+ * @note   @ref BSP_QSPI_EraseCpltCallback is called when erase is finished
+ * @param  SectorAddress: Address of sector to erase
+ * @retval QSPI memory status, @ref QSPI_BUSY when other background operation is in progress
+ */
+uint8_t BSP_QSPI_Erase_Sector_IT(uint32_t SectorAddress);
+
+/**
+ * @brief  Erases subsector (4 kB) of QSPI memory in background
+ * @note   @ref BSP_QSPI_EraseCpltCallback is called when erase is finished
+ * @param  BlockAddress: Address of subsector to erase
+ * @retval QSPI memory status, @ref QSPI_BUSY when other background operation is in progress
+ */
+uint8_t BSP_QSPI_Erase_Block_IT(uint32_t BlockAddress);
+
+/**
+ * @brief  Suspends erase running in background
+ * @note   Data outside erased sector can be read until @ref BSP_QSPI_EraseResume is called
+ * @param  None
+ * @retval QSPI memory status:
+ *            - @ref QSPI_SUSPENDED: Erase is suspended
+ *            - @ref QSPI_OK: Erase was already finished, @ref BSP_QSPI_EraseCpltCallback was called
+ *            - @ref QSPI_ERROR: No erase in progress or communication error
+ */
+uint8_t BSP_QSPI_EraseSuspend(void);
+
+/**
+ * @brief  Resumes erase suspended with @ref BSP_QSPI_EraseSuspend
+ * @param  None
+ * @retval QSPI memory status
+ */
+uint8_t BSP_QSPI_EraseResume(void);
+
+/**
+ * @brief  Checks background operation status
+ * @note   Status is not read from memory
+ * @param  None
+ * @retval QSPI memory status:
+ *            - @ref QSPI_OK: No background operation
+ *            - @ref QSPI_BUSY: Read, write or erase is in progress
+ *            - @ref QSPI_SUSPENDED: Erase is suspended
+ */
+uint8_t BSP_QSPI_IsBusy(void);
+
+#if QSPI_USE_DMA || defined(DOXYGEN)
+/**
+ * @brief  Reads data from QSPI memory with DMA in background
+ * @note   Available when QSPI_USE_DMA is enabled
+ * @note   @ref BSP_QSPI_ReadCpltCallback is called when data are read. Running erase is suspended during read
+ * @param  *pData: Pointer to buffer for data, must stay valid until callback is called
+ * @param  ReadAddr: Read start address
+ * @param  Size: Size of data to read, up to 65535 bytes
+ * @retval QSPI memory status, @ref QSPI_BUSY when other background operation is in progress
+ */
+uint8_t BSP_QSPI_Read_DMA(uint8_t* pData, uint32_t ReadAddr, uint32_t Size);
+
+/**
+ * @brief  Writes data to QSPI memory in background, pages are sent with DMA
+ * @note   Available when QSPI_USE_DMA is enabled
+ * @note   @ref BSP_QSPI_WriteCpltCallback is called when all pages are programmed
+ * @param  *pData: Pointer to data to be written, must stay valid until callback is called
+ * @param  WriteAddr: Write start address
+ * @param  Size: Size of data to write
+ * @retval QSPI memory status, @ref QSPI_BUSY when other background operation is in progress
+ */
+uint8_t BSP_QSPI_Write_DMA(uint8_t* pData, uint32_t WriteAddr, uint32_t Size);
+#endif
+
+/**
+ * @brief  Called from interrupt when background read is finished
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  status: QSPI memory status of operation
+ * @retval None
+ */
+void BSP_QSPI_ReadCpltCallback(uint8_t status);
+
+/**
+ * @brief  Called from interrupt when background write is finished
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  status: QSPI memory status of operation
+ * @retval None
+ */
+void BSP_QSPI_WriteCpltCallback(uint8_t status);
+
+/**
+ * @brief  Called from interrupt when background erase is finished
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  status: QSPI memory status of operation
+ * @retval None
+ */
+void BSP_QSPI_EraseCpltCallback(uint8_t status);
+
+/**
+ * @brief  QSPI MSP initialization, configures GPIO, clocks and NVIC
+ * @note   With __weak parameter to allow different pinout in user file
+ * @param  *hqspi: QSPI handle
+ * @param  *Params: Not used
+ * @retval None
+ */
+void BSP_QSPI_MspInit(QSPI_HandleTypeDef *hqspi, void *Params);
+
+/**
+ * @brief  QSPI MSP de-initialization
+ * @note   With __weak parameter to allow different pinout in user file
+ * @param  *hqspi: QSPI handle
+ * @param  *Params: Not used
+ * @retval None
+ */
+void BSP_QSPI_MspDeInit(QSPI_HandleTypeDef *hqspi, void *Params);
+
 /**
  * @}
  */
@@ -0,0 +1,247 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_queue.h"
+
+/* Pointer to slot for position, first word is sequence number */
+#define QUEUE_SLOT(Queue, pos)    (&(Queue)->Memory[((pos) & (Queue)->Mask) * (Queue)->SlotWords])
+
+/* Private functions */
+static uint8_t TM_QUEUE_INT_CAS(volatile uint32_t* Address, uint32_t* Expected, uint32_t Desired);
+static uint32_t TM_QUEUE_INT_Reserve(TM_QUEUE_t* Queue, volatile uint32_t* Index, uint32_t Offset, uint32_t count, uint32_t* Pos);
+
+uint8_t TM_QUEUE_Init(TM_QUEUE_t* Queue, uint32_t* Memory, uint16_t ItemSize, uint32_t Count) {
+	uint32_t i;
+	
+	/* Set queue values to all zeros */
+	memset(Queue, 0, sizeof(TM_QUEUE_t));
+	
+	/* Check for power of 2 count */
+	if (Count < 2 || ItemSize == 0 || (Count & (Count - 1))) {
+		return 1;
+	}
+	
+	/* Set values */
+	Queue->ItemSize = ItemSize;
+	Queue->SlotWords = TM_QUEUE_SLOT_WORDS(ItemSize);
+	Queue->Mask = Count - 1;
+	Queue->Memory = Memory;
+	
+	/* Check if malloc should be used */
+	if (!Queue->Memory) {
+		/* Try to allocate */
+		Queue->Memory = (uint32_t *) LIB_ALLOC_FUNC(TM_QUEUE_MEMORY_WORDS(ItemSize, Count) * sizeof(uint32_t));
+		
+		/* Check if allocated */
+		if (!Queue->Memory) {
+			return 1;
+		}
+		Queue->Allocated = 1;
+	}
+	
+	/* Each slot is free for producer at its position */
+	for (i = 0; i < Count; i++) {
+		QUEUE_SLOT(Queue, i)[0] = i;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_QUEUE_Free(TM_QUEUE_t* Queue) {
+	/* Check queue structure */
+	if (Queue == NULL) {
+		return;
+	}
+	
+	/* If malloc was used for allocation */
+	if (Queue->Allocated) {
+		/* Free memory */
+		LIB_FREE_FUNC(Queue->Memory);
+	}
+	
+	/* Clear queue */
+	Queue->Memory = NULL;
+	Queue->Allocated = 0;
+}
+
+uint8_t TM_QUEUE_Put(TM_QUEUE_t* Queue, const void* Item) {
+	/* Put one item */
+	return TM_QUEUE_PutMulti(Queue, Item, 1);
+}
+
+uint8_t TM_QUEUE_Get(TM_QUEUE_t* Queue, void* Item) {
+	/* Get one item */
+	return TM_QUEUE_GetMulti(Queue, Item, 1);
+}
+
+uint32_t TM_QUEUE_PutMulti(TM_QUEUE_t* Queue, const void* Items, uint32_t count) {
+	const uint8_t* src = (const uint8_t *)Items;
+	uint32_t pos, n, i;
+	
+	/* Check queue structure */
+	if (Queue == NULL || Queue->Memory == NULL || count == 0) {
+		return 0;
+	}
+	
+	/* Take free slots, slot is free when its sequence equals position */
+	n = TM_QUEUE_INT_Reserve(Queue, &Queue->Head, 0, count, &pos);
+	
+	/* Copy items to slots */
+	for (i = 0; i < n; i++) {
+		memcpy(&QUEUE_SLOT(Queue, pos + i)[1], src, Queue->ItemSize);
+		src += Queue->ItemSize;
+	}
+	
+	/* Items must be written before they are visible to consumers */
+	__DMB();
+	
+	/* Mark slots as filled */
+	for (i = 0; i < n; i++) {
+		QUEUE_SLOT(Queue, pos + i)[0] = pos + i + 1;
+	}
+	
+	/* Return number of saved items */
+	return n;
+}
+
+uint32_t TM_QUEUE_GetMulti(TM_QUEUE_t* Queue, void* Items, uint32_t count) {
+	uint8_t* dst = (uint8_t *)Items;
+	uint32_t pos, n, i;
+	
+	/* Check queue structure */
+	if (Queue == NULL || Queue->Memory == NULL || count == 0) {
+		return 0;
+	}
+	
+	/* Take filled slots, slot is filled when its sequence equals position + 1 */
+	n = TM_QUEUE_INT_Reserve(Queue, &Queue->Tail, 1, count, &pos);
+	
+	/* Copy items from slots */
+	for (i = 0; i < n; i++) {
+		memcpy(dst, &QUEUE_SLOT(Queue, pos + i)[1], Queue->ItemSize);
+		dst += Queue->ItemSize;
+	}
+	
+	/* Items must be read before slots are given to producers */
+	__DMB();
+	
+	/* Mark slots as free for next round */
+	for (i = 0; i < n; i++) {
+		QUEUE_SLOT(Queue, pos + i)[0] = pos + i + Queue->Mask + 1;
+	}
+	
+	/* Return number of copied items */
+	return n;
+}
+
+uint32_t TM_QUEUE_GetCount(TM_QUEUE_t* Queue) {
+	uint32_t tail, head;
+	
+	/* Read tail first, count is never negative then */
+	tail = Queue->Tail;
+	head = Queue->Head;
+	
+	return head - tail;
+}
+
+/* Private functions */
+static uint8_t TM_QUEUE_INT_CAS(volatile uint32_t* Address, uint32_t* Expected, uint32_t Desired) {
+#if !defined(STM32F0xx)
+	uint32_t value;
+	
+	/* Exclusive access, store fails if any other context accessed memory or exception happened */
+	do {
+		value = __LDREXW(Address);
+		if (value != *Expected) {
+			/* Value changed, return new value */
+			__CLREX();
+			*Expected = value;
+			return 0;
+		}
+	} while (__STREXW(Desired, Address));
+	
+	/* Value stored */
+	return 1;
+#else
+	uint32_t irq, value;
+	uint8_t status = 0;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+	
+	/* Disable interrupts, Cortex-M0 does not have exclusive access instructions */
+	__disable_irq();
+	
+	/* Compare and swap */
+	value = *Address;
+	if (value == *Expected) {
+		*Address = Desired;
+		status = 1;
+	} else {
+		*Expected = value;
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	return status;
+#endif
+}
+
+static uint32_t TM_QUEUE_INT_Reserve(TM_QUEUE_t* Queue, volatile uint32_t* Index, uint32_t Offset, uint32_t count, uint32_t* Pos) {
+	uint32_t pos, n;
+	int32_t diff = -1;
+	
+	pos = *Index;
+	while (1) {
+		/* Count ready slots from position */
+		for (n = 0; n < count; n++) {
+			diff = (int32_t)(QUEUE_SLOT(Queue, pos + n)[0] - (pos + n + Offset));
+			if (diff != 0) {
+				break;
+			}
+		}
+		
+		if (n) {
+			/* Take slots, position is updated when other context took them first */
+			if (TM_QUEUE_INT_CAS(Index, &pos, pos + n)) {
+				/* Slot data is accessed after sequence is checked */
+				__DMB();
+				
+				*Pos = pos;
+				return n;
+			}
+		} else if (diff < 0) {
+			/* Queue is full for producers or empty for consumers */
+			return 0;
+		} else {
+			/* Other context took this position, try again */
+			pos = *Index;
+		}
+	}
+}
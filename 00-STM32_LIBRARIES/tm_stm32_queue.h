@@ -0,0 +1,261 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Lock-free multi producer multi consumer queue for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_QUEUE_H
+#define TM_QUEUE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_QUEUE
+ * @brief    Lock-free multi producer multi consumer queue for STM32Fxxx
+ * @{
+ *
+ * Queue holds fixed number of slots with fixed item size. Any number of tasks and interrupts
+ * can put items to queue and get items from queue at the same time, no lock or critical section is used.
+ *
+ * Each slot has sequence number which tells whether slot is free for producer or filled for consumer.
+ * Positions are taken with compare and swap, made with LDREX/STREX instructions on Cortex-M3/M4/M7.
+ * Cortex-M0 does not have these instructions, so compare and swap is done with disabled interrupts for few cycles.
+ *
+ * Functions never wait for other producer or consumer. When item which is next in order is still being written
+ * by interrupted producer, queue is reported as empty until item is complete.
+ *
+ * Batch functions take or fill more consecutive slots with one compare and swap.
+ *
+\code
+//Queue of 64 samples
+TM_QUEUE_t Queue;
+uint32_t QueueMemory[TM_QUEUE_MEMORY_WORDS(sizeof(Sample_t), 64)];
+
+TM_QUEUE_Init(&Queue, QueueMemory, sizeof(Sample_t), 64);
+
+//Interrupt
+TM_QUEUE_Put(&Queue, &sample);
+
+//Any worker task
+if (TM_QUEUE_Get(&Queue, &sample)) {
+	//Process sample
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - string.h
+ - stdlib.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "string.h"
+#include "stdlib.h"
+
+/**
+ * @defgroup TM_QUEUE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
+/* Memory allocation function */
+#ifndef LIB_ALLOC_FUNC
+#define LIB_ALLOC_FUNC    malloc
+#endif
+
+/* Memory free function */
+#ifndef LIB_FREE_FUNC
+#define LIB_FREE_FUNC     free
+#endif
+
+/**
+ * @brief  Number of words in one slot, sequence number and item rounded up to words
+ * @param  ItemSize: Item size in units of bytes
+ */
+#define TM_QUEUE_SLOT_WORDS(ItemSize)            (1 + (((ItemSize) + 3) / 4))
+
+/**
+ * @brief  Number of words needed for queue memory
+ * @param  ItemSize: Item size in units of bytes
+ * @param  Count: Number of slots, must be power of 2
+ */
+#define TM_QUEUE_MEMORY_WORDS(ItemSize, Count)   (TM_QUEUE_SLOT_WORDS(ItemSize) * (Count))
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_QUEUE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Queue structure
+ */
+typedef struct {
+	uint32_t* Memory;          /*!< Slots memory. This is private member */
+	uint32_t Mask;             /*!< Number of slots - 1. This is private member */
+	uint16_t ItemSize;         /*!< Item size in units of bytes */
+	uint16_t SlotWords;        /*!< Slot size in units of words. This is private member */
+	uint8_t Allocated;         /*!< Set when memory is allocated by library. This is private member */
+	volatile uint32_t Head;    /*!< Next position for producers. This is private member */
+	volatile uint32_t Tail;    /*!< Next position for consumers. This is private member */
+} TM_QUEUE_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_QUEUE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes queue
+ * @note   Must be called before any producer or consumer uses queue
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @param  *Memory: Pointer to word aligned memory of @ref TM_QUEUE_MEMORY_WORDS words.
+ *            Set to NULL to allocate memory with @ref LIB_ALLOC_FUNC
+ * @param  ItemSize: Size of one item in units of bytes
+ * @param  Count: Number of slots, must be power of 2 and at least 2
+ * @retval Status:
+ *            - 0: Queue initialized
+ *            - > 0: Wrong count or memory allocation failed
+ */
+uint8_t TM_QUEUE_Init(TM_QUEUE_t* Queue, uint32_t* Memory, uint16_t ItemSize, uint32_t Count);
+
+/**
+ * @brief  Frees queue memory if it was allocated by library
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @retval None
+ */
+void TM_QUEUE_Free(TM_QUEUE_t* Queue);
+
+/**
+ * @brief  Puts one item to queue
+ * @note   Can be called from any task or interrupt
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @param  *Item: Pointer to item of ItemSize bytes to copy to queue
+ * @retval Status:
+ *            - 0: Queue is full
+ *            - > 0: Item saved
+ */
+uint8_t TM_QUEUE_Put(TM_QUEUE_t* Queue, const void* Item);
+
+/**
+ * @brief  Gets one item from queue
+ * @note   Can be called from any task or interrupt
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @param  *Item: Pointer to memory of ItemSize bytes where item will be copied
+ * @retval Status:
+ *            - 0: Queue is empty
+ *            - > 0: Item copied
+ */
+uint8_t TM_QUEUE_Get(TM_QUEUE_t* Queue, void* Item);
+
+/**
+ * @brief  Puts more items to consecutive slots with one position update
+ * @note   Can be called from any task or interrupt
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @param  *Items: Pointer to array of items
+ * @param  count: Number of items in array
+ * @retval Number of items saved, less than count when queue is full
+ */
+uint32_t TM_QUEUE_PutMulti(TM_QUEUE_t* Queue, const void* Items, uint32_t count);
+
+/**
+ * @brief  Gets more items from consecutive slots with one position update
+ * @note   Can be called from any task or interrupt
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @param  *Items: Pointer to array where items will be copied
+ * @param  count: Max number of items to get
+ * @retval Number of items copied
+ */
+uint32_t TM_QUEUE_GetMulti(TM_QUEUE_t* Queue, void* Items, uint32_t count);
+
+/**
+ * @brief  Gets number of items in queue
+ * @note   Value may be changed by other producers and consumers before it is used
+ * @param  *Queue: Pointer to @ref TM_QUEUE_t structure
+ * @retval Number of taken slots, including slots which are still being written or read
+ */
+uint32_t TM_QUEUE_GetCount(TM_QUEUE_t* Queue);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
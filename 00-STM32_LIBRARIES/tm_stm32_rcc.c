@@ -25,10 +25,37 @@
  */
 #include "tm_stm32_rcc.h"
 
-TM_RCC_Result_t TM_RCC_InitSystem(void) {
-	RCC_ClkInitTypeDef RCC_ClkInitStruct;
-	RCC_OscInitTypeDef RCC_OscInitStruct;
+/* Devices with over-drive mode */
+#if defined(STM32F427xx) || defined(STM32F437xx) || defined(STM32F429xx) || defined(STM32F439xx) || defined(STM32F446xx)  || defined(STM32F469xx) || defined(STM32F479xx) || defined(STM32F7xx)
+#define RCC_OVERDRIVE         1
+#else
+#define RCC_OVERDRIVE         0
+#endif
+
+/* Lowest voltage scaling for low power profile */
+#if defined(PWR_REGULATOR_VOLTAGE_SCALE3)
+#define RCC_VOLTAGE_SCALE_LOW PWR_REGULATOR_VOLTAGE_SCALE3
+#elif defined(PWR_REGULATOR_VOLTAGE_SCALE2)
+#define RCC_VOLTAGE_SCALE_LOW PWR_REGULATOR_VOLTAGE_SCALE2
+#endif
+
+/* HSI trimming value */
+#if defined(RCC_HSICALIBRATION_DEFAULT)
+#define RCC_HSI_CALIBRATION   RCC_HSICALIBRATION_DEFAULT
+#else
+#define RCC_HSI_CALIBRATION   0x10
+#endif
+
+/* Current profile and clock change callbacks */
+static TM_RCC_Profile_t RCC_Profile = TM_RCC_Profile_Max;
+static TM_RCC_ClockCallback_t RCC_Callbacks[RCC_CLOCK_CALLBACKS];
+
+/* Private functions */
+static TM_RCC_Result_t TM_RCC_INT_StartPLL(TM_RCC_Profile_t Profile);
+static TM_RCC_Result_t TM_RCC_INT_SwitchToHSI(void);
+static uint32_t TM_RCC_INT_GetLatency(uint32_t hclk);
 
+TM_RCC_Result_t TM_RCC_InitSystem(void) {
 #if defined(STM32F7xx) && !defined(DISABLE_CACHE)
 	/* Enable I-Cache */
 	SCB_EnableICache();
@@ -45,6 +72,124 @@ TM_RCC_Result_t TM_RCC_InitSystem(void) {
 	__HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
 #endif
 	
+	/* Start with maximal performance */
+	RCC_Profile = TM_RCC_Profile_Max;
+	
+	/* Start PLL and select it as system clock */
+	return TM_RCC_INT_StartPLL(TM_RCC_Profile_Max);
+}
+
+TM_RCC_Result_t TM_RCC_SetProfile(TM_RCC_Profile_t Profile) {
+	RCC_OscInitTypeDef RCC_OscInitStruct;
+	uint8_t i;
+	
+	/* Already active */
+	if (Profile == RCC_Profile) {
+		return TM_RCC_Result_Ok;
+	}
+	
+	/* Run from HSI while PLL and regulator are reconfigured */
+	if (TM_RCC_INT_SwitchToHSI() != TM_RCC_Result_Ok) {
+		return TM_RCC_Result_Error;
+	}
+	
+#if RCC_OVERDRIVE
+	/* Disable over-drive, system clock must not be PLL */
+	HAL_PWREx_DisableOverDrive();
+#endif
+	
+	/* Disable PLL */
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_OFF;
+	if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+		return TM_RCC_Result_Error;
+	}
+	
+	/* Profile is changed from here */
+	RCC_Profile = Profile;
+	
+	if (Profile == TM_RCC_Profile_LowPower) {
+		/* Disable HSE, HSI stays system clock */
+		if (RCC_OSCILLATORTYPE == RCC_OSCILLATORTYPE_HSE) {
+			RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+			RCC_OscInitStruct.HSEState = RCC_HSE_OFF;
+			RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+			HAL_RCC_OscConfig(&RCC_OscInitStruct);
+		}
+		
+#if !defined(STM32F0xx)
+		/* Set lowest voltage scaling, PLL is off */
+		__HAL_PWR_VOLTAGESCALING_CONFIG(RCC_VOLTAGE_SCALE_LOW);
+#endif
+	} else {
+#if !defined(STM32F0xx)
+		/* Set voltage scaling for PLL */
+		__HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+#endif
+		
+		/* Start PLL and select it as system clock */
+		if (TM_RCC_INT_StartPLL(Profile) != TM_RCC_Result_Ok) {
+			return TM_RCC_Result_Error;
+		}
+	}
+	
+	/* Notify drivers about new clocks */
+	for (i = 0; i < RCC_CLOCK_CALLBACKS; i++) {
+		if (RCC_Callbacks[i]) {
+			RCC_Callbacks[i]();
+		}
+	}
+	
+	/* Return OK */
+	return TM_RCC_Result_Ok;
+}
+
+TM_RCC_Profile_t TM_RCC_GetProfile(void) {
+	return RCC_Profile;
+}
+
+TM_RCC_Result_t TM_RCC_RestoreProfile(void) {
+	/* Low power profile runs from HSI, which is already system clock */
+	if (RCC_Profile == TM_RCC_Profile_LowPower) {
+		return TM_RCC_Result_Ok;
+	}
+	
+	/* Start PLL and select it as system clock */
+	return TM_RCC_INT_StartPLL(RCC_Profile);
+}
+
+TM_RCC_Result_t TM_RCC_AddClockCallback(TM_RCC_ClockCallback_t Callback) {
+	uint8_t i;
+	
+	/* Find free entry */
+	for (i = 0; i < RCC_CLOCK_CALLBACKS; i++) {
+		if (RCC_Callbacks[i] == NULL || RCC_Callbacks[i] == Callback) {
+			RCC_Callbacks[i] = Callback;
+			return TM_RCC_Result_Ok;
+		}
+	}
+	
+	/* No memory */
+	return TM_RCC_Result_Error;
+}
+
+void TM_RCC_RemoveClockCallback(TM_RCC_ClockCallback_t Callback) {
+	uint8_t i;
+	
+	/* Remove from list */
+	for (i = 0; i < RCC_CLOCK_CALLBACKS; i++) {
+		if (RCC_Callbacks[i] == Callback) {
+			RCC_Callbacks[i] = NULL;
+		}
+	}
+}
+
+/* Private functions */
+static TM_RCC_Result_t TM_RCC_INT_StartPLL(TM_RCC_Profile_t Profile) {
+	RCC_ClkInitTypeDef RCC_ClkInitStruct;
+	RCC_OscInitTypeDef RCC_OscInitStruct;
+	uint32_t latency;
+	
 	/* Enable HSE Oscillator and activate PLL with HSE as source */
 	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE;
 	
@@ -60,6 +205,7 @@ TM_RCC_Result_t TM_RCC_InitSystem(void) {
 	} else {
 		RCC_OscInitStruct.HSEState = RCC_HSE_OFF;
 		RCC_OscInitStruct.HSIState = RCC_HSI_ON;
+		RCC_OscInitStruct.HSICalibrationValue = RCC_HSI_CALIBRATION;
 		RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
 #if defined(STM32F0xx)
 		RCC_OscInitStruct.PLL.PREDIV = RCC_PREDIV_DIV1;
@@ -90,7 +236,7 @@ TM_RCC_Result_t TM_RCC_InitSystem(void) {
 		return TM_RCC_Result_Error;
 	}
 
-#if defined(STM32F427xx) || defined(STM32F437xx) || defined(STM32F429xx) || defined(STM32F439xx) || defined(STM32F446xx)  || defined(STM32F469xx) || defined(STM32F479xx) || defined(STM32F7xx)
+#if RCC_OVERDRIVE
 	/* Activate the Over-Drive mode */
 	if (HAL_PWREx_EnableOverDrive() != HAL_OK) {
 		return TM_RCC_Result_Error;
@@ -99,12 +245,18 @@ TM_RCC_Result_t TM_RCC_InitSystem(void) {
 
 	/* Select PLL as system clock source and configure the HCLK, PCLK1 and PCLK2 clocks dividers */
 	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
-	RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
 	RCC_ClkInitStruct.ClockType = (RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1);
 #if !defined(STM32F0xx)
 	RCC_ClkInitStruct.ClockType |= RCC_CLOCKTYPE_PCLK2;
 #endif
 	
+	/* Balanced profile runs core at half speed, APB clocks stay the same when possible */
+	if (Profile == TM_RCC_Profile_Balanced) {
+		RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV2;
+	} else {
+		RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+	}
+	
 #if defined(STM32F405xx) || \
 	defined(STM32F415xx) || \
 	defined(STM32F407xx) || \
@@ -118,24 +270,79 @@ TM_RCC_Result_t TM_RCC_InitSystem(void) {
 	defined(STM32F479xx) || \
 	defined(STM32F7xx) 
 	
-	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;  
-	RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+	RCC_ClkInitStruct.APB1CLKDivider = Profile == TM_RCC_Profile_Balanced ? RCC_HCLK_DIV2 : RCC_HCLK_DIV4;
+	RCC_ClkInitStruct.APB2CLKDivider = Profile == TM_RCC_Profile_Balanced ? RCC_HCLK_DIV1 : RCC_HCLK_DIV2;
 #elif defined(STM32F0xx)
 	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
 #else
-	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;  
-	RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;  
+	RCC_ClkInitStruct.APB1CLKDivider = Profile == TM_RCC_Profile_Balanced ? RCC_HCLK_DIV1 : RCC_HCLK_DIV2;
+	RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
 #endif
 	
-	/* Try to init */
+	/* Get flash latency for core clock */
 #if defined(STM32F0xx)
-	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK) {
+	latency = FLASH_LATENCY_1;
 #else
-	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_6) != HAL_OK) {
+	if (RCC_OSCILLATORTYPE == RCC_OSCILLATORTYPE_HSE) {
+		latency = HSE_VALUE;
+	} else {
+		latency = HSI_VALUE;
+	}
+	latency = latency / RCC_PLLM * RCC_PLLN / RCC_PLLP;
+	if (Profile == TM_RCC_Profile_Balanced) {
+		latency /= 2;
+	}
+	latency = TM_RCC_INT_GetLatency(latency);
 #endif
+	
+	/* Try to init */
+	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, latency) != HAL_OK) {
 		return TM_RCC_Result_Error;
 	}
 	
 	/* Return OK */
 	return TM_RCC_Result_Ok;
 }
+
+static TM_RCC_Result_t TM_RCC_INT_SwitchToHSI(void) {
+	RCC_ClkInitTypeDef RCC_ClkInitStruct;
+	RCC_OscInitTypeDef RCC_OscInitStruct;
+	
+	/* Enable HSI, PLL is not changed */
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
+	RCC_OscInitStruct.HSIState = RCC_HSI_ON;
+	RCC_OscInitStruct.HSICalibrationValue = RCC_HSI_CALIBRATION;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+	if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+		return TM_RCC_Result_Error;
+	}
+	
+	/* HSI as system clock without dividers, flash latency is decreased after switch by HAL */
+	RCC_ClkInitStruct.ClockType = (RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1);
+#if !defined(STM32F0xx)
+	RCC_ClkInitStruct.ClockType |= RCC_CLOCKTYPE_PCLK2;
+	RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+#endif
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+	RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK) {
+		return TM_RCC_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_RCC_Result_Ok;
+}
+
+static uint32_t TM_RCC_INT_GetLatency(uint32_t hclk) {
+	/* One wait state for each 30 MHz at 2.7 to 3.6 V supply */
+	uint32_t ws = (hclk - 1) / 30000000;
+	
+	/* Check maximal value */
+	if (ws > 7) {
+		ws = 7;
+	}
+	
+	/* FLASH_LATENCY_x values are the same as number of wait states */
+	return ws;
+}
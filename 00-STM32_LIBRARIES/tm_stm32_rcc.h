@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-01-rcc-for-stm32fxxx/
- * @version v1.1
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   RCC Library for STM32F4xx and STM32F7xx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_RCC_H
-#define TM_RCC_H 110
+#define TM_RCC_H 130
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -55,6 +55,35 @@ extern "C" {
  * RCC library provides initialization of clock at the beginning. Function @ref TM_RCC_InitSystem should be called at beginning of @ref main function to initialize system.
  *
  * @note  In case of STM32F7xx is used, this library also enables CACHE for Instructions and Data.
+ *
+ * \par Clock profiles
+ *
+ * System clock can be changed at runtime with @ref TM_RCC_SetProfile function:
+ *
+\verbatim
+- Max performance: PLL settings from defines.h, same as after TM_RCC_InitSystem
+- Balanced: the same PLL, core clock (HCLK) divided by 2, APB clocks stay the same when possible
+- Low power: PLL and HSE are disabled, core runs from HSI, regulator is set to lowest voltage scale
+\endverbatim
+ *
+ * System clock is switched to HSI first, then PLL, over-drive and voltage scaling are changed
+ * and new clock is selected. Flash wait states are set for new core clock and SysTick is updated by HAL.
+ *
+ * Drivers which depend on peripheral clocks must recompute their settings after each change.
+ * Add their update functions with @ref TM_RCC_AddClockCallback, for example:
+ *
+\code
+TM_RCC_AddClockCallback(TM_USART_UpdateClock);
+TM_RCC_AddClockCallback(TM_DELAY_UpdateClock);
+\endcode
+ *
+ * For SPI, add own function which sets prescaler from @ref TM_SPI_GetPrescalerFromMaxFrequency again.
+ *
+ * Maximal number of callbacks can be changed in defines.h:
+ *
+\code
+#define RCC_CLOCK_CALLBACKS    8
+\endcode
  *
  * \par Changelog
  *
@@ -65,6 +94,16 @@ extern "C" {
  Version 1.1
   - October 10, 2015
   - Added support for STM32F469 devices
+
+ Version 1.2
+  - October 14, 2026
+  - Added runtime clock profiles, @ref TM_RCC_SetProfile() function
+  - Added clock change callbacks for drivers
+  - Flash latency is calculated from core clock
+
+ Version 1.3
+  - October 14, 2026
+  - Added @ref TM_RCC_RestoreProfile() function to start PLL again after Stop mode
 \endverbatim
  *
  * \par Dependencies
@@ -92,6 +131,11 @@ extern "C" {
 #define RCC_PLLQ              7
 #endif
 
+/* Number of clock change callbacks */
+#ifndef RCC_CLOCK_CALLBACKS
+#define RCC_CLOCK_CALLBACKS   4
+#endif
+
 /**
  * @}
  */
@@ -110,6 +154,20 @@ typedef enum {
 	TM_RCC_Result_Error      /*!< An error occurred */
 } TM_RCC_Result_t;
 
+/**
+ * @brief  RCC clock profiles
+ */
+typedef enum {
+	TM_RCC_Profile_Max = 0x00, /*!< Maximal performance, PLL settings from defines.h */
+	TM_RCC_Profile_Balanced,   /*!< PLL with core clock divided by 2 */
+	TM_RCC_Profile_LowPower    /*!< HSI without PLL, lowest voltage scale */
+} TM_RCC_Profile_t;
+
+/**
+ * @brief  Clock change callback, called after new profile is active
+ */
+typedef void (*TM_RCC_ClockCallback_t)(void);
+
 /**
  * @} TM_RCC_Typedefs
  */
@@ -129,6 +187,46 @@ typedef enum {
  */
 TM_RCC_Result_t TM_RCC_InitSystem(void);
 
+/**
+ * @brief  Changes system clock profile
+ * @note   Peripherals keep working during switch, but their clocks change. Do not call during transfers
+ *         which depend on clock, like USART transmission, and do not call from interrupt
+ * @note   System must be initialized first with @ref TM_RCC_InitSystem
+ * @param  Profile: New clock profile. This parameter can be a value of @ref TM_RCC_Profile_t enumeration
+ * @retval Member of @ref TM_RCC_Result_t enumeration
+ */
+TM_RCC_Result_t TM_RCC_SetProfile(TM_RCC_Profile_t Profile);
+
+/**
+ * @brief  Gets active clock profile
+ * @param  None
+ * @retval Member of @ref TM_RCC_Profile_t enumeration
+ */
+TM_RCC_Profile_t TM_RCC_GetProfile(void);
+
+/**
+ * @brief  Starts oscillators and PLL of active profile again after wakeup from Stop mode
+ * @note   Core wakes up from Stop mode with HSI as system clock. Clocks are the same as before Stop mode after this call,
+ *         so clock change callbacks are not called
+ * @param  None
+ * @retval Member of @ref TM_RCC_Result_t enumeration
+ */
+TM_RCC_Result_t TM_RCC_RestoreProfile(void);
+
+/**
+ * @brief  Adds function which is called after each clock profile change
+ * @param  Callback: Function to call
+ * @retval Member of @ref TM_RCC_Result_t enumeration, error when there is no free entry
+ */
+TM_RCC_Result_t TM_RCC_AddClockCallback(TM_RCC_ClockCallback_t Callback);
+
+/**
+ * @brief  Removes clock change callback
+ * @param  Callback: Function to remove
+ * @retval None
+ */
+void TM_RCC_RemoveClockCallback(TM_RCC_ClockCallback_t Callback);
+
 /**
  * @}
  */
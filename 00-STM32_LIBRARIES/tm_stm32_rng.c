@@ -18,26 +18,173 @@
  */
 #include "tm_stm32_rng.h"
 
+/* Set handler name */
+#if defined(STM32F7xx) && !defined(HASH)
+#define RNG_IRQ_HANDLER       RNG_IRQHandler
+#else
+#define RNG_IRQ_HANDLER       HASH_RNG_IRQHandler
+#endif
+
+/* Pool mask */
+#define RNG_POOL_MASK         (RNG_POOL_SIZE - 1)
+
+#if RNG_POOL_SIZE > 0
+/* Pool of random numbers, filled from RNG interrupt */
+static uint32_t RNG_Pool[RNG_POOL_SIZE];
+static volatile uint32_t RNG_PoolIn, RNG_PoolOut;
+#endif
+
+/* Last value from RNG for continuous test and number of errors */
+static uint32_t RNG_Last;
+static volatile uint32_t RNG_Errors;
+
+/* Private functions */
+static uint8_t TM_RNG_INT_Read(uint32_t* value);
+
 void TM_RNG_Init(void) {
 	/* Enable RNG clock source */
 	__HAL_RCC_RNG_CLK_ENABLE();
 	
+	/* Reset status */
+	RNG_Errors = 0;
+	
 	/* RNG Peripheral enable */
 	RNG->CR |= RNG_CR_RNGEN;
+	
+	/* First number is only used for continuous test */
+	while (!TM_RNG_INT_Read(&RNG_Last));
+	
+#if RNG_POOL_SIZE > 0
+	/* Empty pool */
+	RNG_PoolIn = RNG_PoolOut = 0;
+	
+	/* Enable interrupt, pool is filled in background */
+	HAL_NVIC_SetPriority(HASH_RNG_IRQn, RNG_NVIC_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(HASH_RNG_IRQn);
+	RNG->CR |= RNG_CR_IE;
+#endif
 }
 
 void TM_RNG_DeInit(void) {
-	/* Disable RNG peripheral */
-	RNG->CR &= ~RNG_CR_RNGEN;
+	/* Disable RNG peripheral and interrupt */
+	RNG->CR &= ~(RNG_CR_RNGEN | RNG_CR_IE);
+	
+#if RNG_POOL_SIZE > 0
+	/* Disable NVIC */
+	HAL_NVIC_DisableIRQ(HASH_RNG_IRQn);
+#endif
 	
 	/* Disable RNG clock source */
 	__HAL_RCC_RNG_CLK_DISABLE();
 }
 
 uint32_t TM_RNG_Get(void) {
-	/* Wait until one RNG number is ready */
-	while (!(RNG->SR & (RNG_SR_DRDY)));
+	uint32_t value;
+	
+	/* Get one number, waits when pool is empty */
+	TM_RNG_Fill(&value, sizeof(value));
+	
+	/* Return random number */
+	return value;
+}
+
+void TM_RNG_Fill(void* Data, uint32_t count) {
+	uint8_t* ptr = (uint8_t *)Data;
+	uint32_t value, len;
+	
+	while (count) {
+#if RNG_POOL_SIZE > 0
+		/* Wait for interrupt to add number to pool */
+		while (RNG_PoolIn == RNG_PoolOut);
+		
+		/* Take number from pool */
+		value = RNG_Pool[RNG_PoolOut & RNG_POOL_MASK];
+		RNG_PoolOut++;
+		
+		/* Pool has free space, enable refill if it was stopped */
+		RNG->CR |= RNG_CR_IE;
+#else
+		/* Read directly from RNG */
+		while (!TM_RNG_INT_Read(&value));
+#endif
+		
+		/* Copy bytes */
+		len = count < sizeof(value) ? count : sizeof(value);
+		memcpy(ptr, &value, len);
+		ptr += len;
+		count -= len;
+	}
+}
+
+uint32_t TM_RNG_Available(void) {
+#if RNG_POOL_SIZE > 0
+	/* Number of bytes in pool */
+	return (RNG_PoolIn - RNG_PoolOut) * sizeof(uint32_t);
+#else
+	/* Nothing buffered */
+	return 0;
+#endif
+}
+
+uint32_t TM_RNG_GetErrors(void) {
+	return RNG_Errors;
+}
 
-	/* Get a 32-bit Random number */
-	return RNG->DR;
+#if RNG_POOL_SIZE > 0
+void RNG_IRQ_HANDLER(void) {
+	uint32_t value;
+	
+	/* Pool is full, stop interrupts until numbers are read */
+	if ((RNG_PoolIn - RNG_PoolOut) >= RNG_POOL_SIZE) {
+		RNG->CR &= ~RNG_CR_IE;
+		return;
+	}
+	
+	/* Check if RNG has new number or error */
+	if (TM_RNG_INT_Read(&value)) {
+		/* Add to pool */
+		RNG_Pool[RNG_PoolIn & RNG_POOL_MASK] = value;
+		RNG_PoolIn++;
+	}
+}
+#endif
+
+/* Private functions */
+static uint8_t TM_RNG_INT_Read(uint32_t* value) {
+	uint32_t sr = RNG->SR;
+	uint32_t v;
+	
+	/* Seed error, clear flag and restart RNG, data in DR are not valid */
+	if (sr & (RNG_SR_SEIS | RNG_SR_SECS)) {
+		RNG->SR = ~RNG_SR_SEIS;
+		RNG->CR &= ~RNG_CR_RNGEN;
+		RNG->CR |= RNG_CR_RNGEN;
+		RNG_Errors++;
+		return 0;
+	}
+	
+	/* Clock error, RNG continues by itself when clock is correct */
+	if (sr & RNG_SR_CEIS) {
+		RNG->SR = ~RNG_SR_CEIS;
+		RNG_Errors++;
+	}
+	
+	/* No data yet */
+	if (!(sr & RNG_SR_DRDY)) {
+		return 0;
+	}
+	
+	/* Read number */
+	v = RNG->DR;
+	
+	/* Continuous test, each number must be different from previous one */
+	if (v == RNG_Last) {
+		RNG_Errors++;
+		return 0;
+	}
+	RNG_Last = v;
+	
+	/* Number is valid */
+	*value = v;
+	return 1;
 }
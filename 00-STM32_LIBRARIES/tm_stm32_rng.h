@@ -3,10 +3,10 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-18-rng-for-stm32fxxx/
- * @version v1.0
+ * @version v1.2
  * @ide     Keil uVision
  * @license MIT
- * @brief   Library template 
+ * @brief   Random number generator library for STM32Fxxx devices
  *	
 \verbatim
    ----------------------------------------------------------------------
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_RNG_H
-#define TM_RNG_H 100
+#define TM_RNG_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -52,11 +52,41 @@ extern "C" {
  * @brief    Random number generator library for STM32Fxxx devices - http://stm32f4-discovery.com/2015/07/hal-library-18-rng-for-stm32fxxx/
  * @{
  *
+ * \par Random pool
+ *
+ * RNG interrupt fills pool of random numbers in background, so @ref TM_RNG_Get and @ref TM_RNG_Fill
+ * only copy numbers from memory and wait only when pool is empty. When pool is full, RNG interrupt is disabled
+ * until numbers are read.
+ *
+ * Seed and clock errors are recovered automatically. Each new number is compared to previous one
+ * (FIPS PUB 140-2 continuous test) and discarded when the same. Number of errors can be read with @ref TM_RNG_GetErrors.
+ *
+ * To change pool settings, open defines.h file and add lines:
+ *
+\code
+//Number of 32-bit words in pool, power of 2. Set to 0 to disable pool and interrupt, RNG is read directly
+#define RNG_POOL_SIZE        32
+
+//NVIC priority for RNG interrupt
+#define RNG_NVIC_PRIORITY    0x0F
+\endcode
+ *
+ * @note  RNG interrupt is shared with HASH peripheral on some devices
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Added interrupt filled pool of random numbers and @ref TM_RNG_Fill() function
+  - Seed and clock errors are recovered, continuous test on each number
+
+ Version 1.2
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
 \endverbatim
  *
  * \par Dependencies
@@ -64,10 +94,37 @@ extern "C" {
 \verbatim
  - STM32Fxxx HAL
  - defines.h
+ - string.h
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
 #include "defines.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_RNG_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of 32-bit words in pool filled from interrupt, 0 to disable */
+#ifndef RNG_POOL_SIZE
+#define RNG_POOL_SIZE        32
+#endif
+
+/* NVIC priority for RNG interrupt */
+#ifndef RNG_NVIC_PRIORITY
+#define RNG_NVIC_PRIORITY    NVIC_PRIORITY_IDLE
+#endif
+
+/* Check pool size */
+#if RNG_POOL_SIZE > 0 && (RNG_POOL_SIZE & (RNG_POOL_SIZE - 1))
+#error "RNG_POOL_SIZE must be power of 2!"
+#endif
+
+/**
+ * @}
+ */
 
 /**
  * @defgroup TM_RNG_Functions
@@ -91,11 +148,35 @@ void TM_RNG_DeInit(void);
 
 /**
  * @brief  Gets 32-bit random number
+ * @note   Number is taken from pool, function waits only when pool is empty
  * @param  None
  * @retval 32-bit random number
  */
 uint32_t TM_RNG_Get(void);
 
+/**
+ * @brief  Fills memory with random bytes
+ * @note   Numbers are taken from pool, function waits only when pool is empty
+ * @param  *Data: Pointer to memory to fill
+ * @param  count: Number of bytes to fill
+ * @retval None
+ */
+void TM_RNG_Fill(void* Data, uint32_t count);
+
+/**
+ * @brief  Gets number of random bytes in pool, which can be read without waiting
+ * @param  None
+ * @retval Number of bytes in pool, always 0 when pool is disabled
+ */
+uint32_t TM_RNG_Available(void);
+
+/**
+ * @brief  Gets number of seed, clock and continuous test errors since initialization
+ * @param  None
+ * @retval Number of errors
+ */
+uint32_t TM_RNG_GetErrors(void);
+
 /**
  * @}
  */
@@ -49,13 +49,126 @@ void TM_RE_Init(TM_RE_t* data, GPIO_TypeDef* GPIO_A_Port, uint16_t GPIO_A_Pin, G
 	data->Diff = 0;
 	data->Absolute = 0;
 	data->LastA = 1;
+	data->TIMx = NULL;
+	data->IndexFlag = 0;
+	data->Index = 0;
+	data->Velocity = 0;
+	data->LastTime = HAL_GetTick();
+}
+
+uint8_t TM_RE_InitTimer(TM_RE_t* data, TIM_TypeDef* TIMx, GPIO_TypeDef* GPIO_A_Port, uint16_t GPIO_A_Pin, GPIO_TypeDef* GPIO_B_Port, uint16_t GPIO_B_Pin, uint8_t AF) {
+	/* Enable timer clock */
+	if (TIMx == TIM1) {
+		__HAL_RCC_TIM1_CLK_ENABLE();
+	} else if (TIMx == TIM2) {
+		__HAL_RCC_TIM2_CLK_ENABLE();
+	} else if (TIMx == TIM3) {
+		__HAL_RCC_TIM3_CLK_ENABLE();
+#if defined(TIM4)
+	} else if (TIMx == TIM4) {
+		__HAL_RCC_TIM4_CLK_ENABLE();
+#endif
+#if defined(TIM5)
+	} else if (TIMx == TIM5) {
+		__HAL_RCC_TIM5_CLK_ENABLE();
+#endif
+#if defined(TIM8)
+	} else if (TIMx == TIM8) {
+		__HAL_RCC_TIM8_CLK_ENABLE();
+#endif
+	} else {
+		return 1;
+	}
+	
+	/* Save parameters */
+	data->GPIO_A = GPIO_A_Port;
+	data->GPIO_B = GPIO_B_Port;
+	data->GPIO_PIN_A = GPIO_A_Pin;
+	data->GPIO_PIN_B = GPIO_B_Pin;
+	data->TIMx = TIMx;
+	
+	/* Pins as timer inputs */
+	TM_GPIO_InitAlternate(GPIO_A_Port, GPIO_A_Pin, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Low, AF);
+	TM_GPIO_InitAlternate(GPIO_B_Port, GPIO_B_Pin, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Low, AF);
+	
+	/* Encoder mode 3, count on both TI1 and TI2 edges */
+	TIMx->CR1 = 0;
+	TIMx->PSC = 0;
+	TIMx->ARR = 0xFFFF;
+	TIMx->SMCR = (TIMx->SMCR & ~TIM_SMCR_SMS) | TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1;
+	
+	/* TI1 and TI2 inputs with filter */
+	TIMx->CCMR1 = TIM_CCMR1_CC1S_0 | TIM_CCMR1_IC1F_0 | TIM_CCMR1_IC1F_1 | TIM_CCMR1_CC2S_0 | TIM_CCMR1_IC2F_0 | TIM_CCMR1_IC2F_1;
+	TIMx->CCER &= ~(TIM_CCER_CC1P | TIM_CCER_CC1NP | TIM_CCER_CC2P | TIM_CCER_CC2NP);
+	
+	/* Start counting */
+	TIMx->CNT = 0;
+	TIMx->CR1 |= TIM_CR1_CEN;
+	
+	/* Set default mode */
+	data->Mode = TM_RE_Mode_Zero;
+	
+	/* Set default */
+	data->RE_Count = 0;
+	data->Diff = 0;
+	data->Absolute = 0;
+	data->LastCNT = 0;
+	data->IndexFlag = 0;
+	data->Index = 0;
+	data->Velocity = 0;
+	data->LastTime = HAL_GetTick();
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_RE_EnableIndex(TM_RE_t* data, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint8_t AF) {
+	TIM_TypeDef* TIMx = data->TIMx;
+	
+	/* Check mode */
+	if (TIMx == NULL) {
+		return;
+	}
+	
+	/* Pin as timer input */
+	TM_GPIO_InitAlternate(GPIOx, GPIO_Pin, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_Low, AF);
+	
+	/* Capture counter on TI3 rising edge */
+	TIMx->CCMR2 = (TIMx->CCMR2 & ~0xFF) | TIM_CCMR2_CC3S_0 | TIM_CCMR2_IC3F_0 | TIM_CCMR2_IC3F_1;
+	TIMx->CCER = (TIMx->CCER & ~(TIM_CCER_CC3P | TIM_CCER_CC3NP)) | TIM_CCER_CC3E;
+	TIMx->SR = ~TIM_SR_CC3IF;
 }
 
 TM_RE_Rotate_t TM_RE_Get(TM_RE_t* data) {
+	uint32_t time;
+	uint16_t cnt;
+	
+	/* Hardware encoder mode */
+	if (data->TIMx) {
+		/* Get counter difference, 16-bit counter can overflow */
+		cnt = data->TIMx->CNT;
+		data->RE_Count += (int16_t)(cnt - data->LastCNT);
+		data->LastCNT = cnt;
+		
+		/* Check for index pulse, reading capture register clears flag */
+		data->IndexFlag = 0;
+		if (data->TIMx->SR & TIM_SR_CC3IF) {
+			data->Index = data->RE_Count - (int16_t)(cnt - (uint16_t)data->TIMx->CCR3);
+			data->IndexFlag = 1;
+		}
+	}
+	
 	/* Calculate everything */
 	data->Diff = data->RE_Count - data->Absolute;
 	data->Absolute = data->RE_Count;
 	
+	/* Calculate velocity over time from last check */
+	time = HAL_GetTick();
+	if (time != data->LastTime) {
+		data->Velocity = data->Diff * 1000 / (int32_t)(time - data->LastTime);
+		data->LastTime = time;
+	}
+	
 	/* Check */
 	if (data->RE_Count < 0) {
 		RETURN_WITH_STATUS(data, TM_RE_Rotate_Decrement);
@@ -69,6 +182,15 @@ TM_RE_Rotate_t TM_RE_Get(TM_RE_t* data) {
 void TM_RE_SetMode(TM_RE_t* data, TM_RE_Mode_t mode) {
 	/* Set mode */
 	data->Mode = mode;
+	
+	/* Invert TI1 polarity to change direction in hardware encoder mode */
+	if (data->TIMx) {
+		if (mode == TM_RE_Mode_One) {
+			data->TIMx->CCER |= TIM_CCER_CC1P;
+		} else {
+			data->TIMx->CCER &= ~TIM_CCER_CC1P;
+		}
+	}
 }
 
 void TM_RE_Process(TM_RE_t* data) {
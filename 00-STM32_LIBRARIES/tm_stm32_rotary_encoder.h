@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   Rotary encoder library for STM32F4xx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_RE_H
-#define TM_RE_H 100
+#define TM_RE_H 110
 
 /**
  * @addtogroup TM_STM32Fxxx_HAL_Libraries
@@ -60,11 +60,30 @@
  *
  * Library allows you to turn this mode "on the fly" anytime you want. Look for @ref TM_RE_SetMode() function for that.
  *
+ * \par Hardware encoder mode
+ *
+ * For high speed encoders, use @ref TM_RE_InitTimer instead of @ref TM_RE_Init. Pins A and B must be connected to
+ * channel 1 and channel 2 of timer (TIM1, TIM2, TIM3, TIM4, TIM5 or TIM8) and timer counts all 4 edges in encoder mode.
+ * No interrupts are used, @ref TM_RE_Get reads counter register and calculates difference, @ref TM_RE_Process is not needed.
+ *
+ * Optional index pulse can be connected to channel 3 of the same timer and enabled with @ref TM_RE_EnableIndex.
+ * Counter value on last index pulse is then saved in Index member on each @ref TM_RE_Get call.
+ *
+ * \par Velocity
+ *
+ * On each @ref TM_RE_Get call, velocity in counts per second is calculated from difference and time since previous call.
+ * Call @ref TM_RE_Get periodically, for example every 10 ms, to get velocity over this window.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added hardware encoder mode with timer encoder interface
+  - Added optional index pulse capture and velocity calculation
 \endverbatim
  *
  * \par Dependencies
@@ -119,6 +138,12 @@ typedef struct {
 	GPIO_TypeDef* GPIO_B;    /*!< Pointer to GPIOx for Rotary encode B pin. Meant for private use */
 	uint16_t GPIO_PIN_A;     /*!< GPIO pin for rotary encoder A pin. This pin is also set for interrupt */
 	uint16_t GPIO_PIN_B;     /*!< GPIO pin for rotary encoder B pin. */
+	TIM_TypeDef* TIMx;       /*!< Timer used in hardware encoder mode, NULL when EXTI is used. Meant for private use */
+	uint16_t LastCNT;        /*!< Counter value on last check in hardware encoder mode. Meant for private use */
+	uint8_t IndexFlag;       /*!< Set to 1 when index pulse was detected since last check, for public use */
+	int32_t Index;           /*!< Absolute value on last index pulse, for public use */
+	int32_t Velocity;        /*!< Velocity in counts per second between last two checks, for public use */
+	uint32_t LastTime;       /*!< Time of last check in milliseconds. Meant for private use */
 } TM_RE_t;
 
 /**
@@ -138,6 +163,32 @@ typedef struct {
  */
 void TM_RE_Init(TM_RE_t* data, GPIO_TypeDef* GPIO_A_Port, uint16_t GPIO_A_Pin, GPIO_TypeDef* GPIO_B_Port, uint16_t GPIO_B_Pin);
 
+/**
+ * @brief  Prepare Rotary Encoder to work in hardware encoder mode
+ * @note   Pin A must be timer channel 1 and pin B timer channel 2
+ * @param  *data: Pointer to @ref TM_RE_t structure
+ * @param  *TIMx: Pointer to timer with encoder interface, TIM1, TIM2, TIM3, TIM4, TIM5 or TIM8
+ * @param  *GPIO_A_Port: Pointer to GPIOx for pin A
+ * @param  GPIO_A_Pin: Pin A, timer channel 1
+ * @param  *GPIO_B_Port: Pointer to GPIOx for pin B
+ * @param  GPIO_B_Pin: Pin B, timer channel 2
+ * @param  AF: GPIO alternate function for timer
+ * @retval Initialization status:
+ *            - 0: Initialized
+ *            - > 0: Timer is not supported
+ */
+uint8_t TM_RE_InitTimer(TM_RE_t* data, TIM_TypeDef* TIMx, GPIO_TypeDef* GPIO_A_Port, uint16_t GPIO_A_Pin, GPIO_TypeDef* GPIO_B_Port, uint16_t GPIO_B_Pin, uint8_t AF);
+
+/**
+ * @brief  Enables index pulse capture in hardware encoder mode
+ * @param  *data: Pointer to @ref TM_RE_t structure initialized with @ref TM_RE_InitTimer
+ * @param  *GPIOx: Pointer to GPIOx for index pin
+ * @param  GPIO_Pin: Index pin, timer channel 3
+ * @param  AF: GPIO alternate function for timer
+ * @retval None
+ */
+void TM_RE_EnableIndex(TM_RE_t* data, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint8_t AF);
+
 /**
  * @brief  Set rotary encoder custom mode
  * @param  *data: Pointer to @ref TM_RE_t structure for specific rotary encoder input
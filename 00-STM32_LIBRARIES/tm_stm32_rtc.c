@@ -39,15 +39,39 @@
 #define RTC_BCD2BIN(x)                  ((((x) >> 4) & 0x0F) * 10 + ((x) & 0x0F))
 #define RTC_CHAR2NUM(x)                 ((x) - '0')
 #define RTC_CHARISNUM(x)                ((x) >= '0' && (x) <= '9')
+#define RTC_DAYS_TO_OFFSET              719468       /* Days from 01.03.0000 to 01.01.1970 */
 
 /* Internal functions */
 static void TM_RTC_Config(TM_RTC_ClockSource_t source);
+#if RTC_TIMESTAMP
+static uint64_t TM_RTC_INT_ReadMicros(void);
+static void TM_RTC_INT_TimestampRebase(void);
+static void TM_RTC_INT_TimestampDiscipline(uint32_t cycles, uint64_t reference, uint8_t source, uint32_t baseline);
+
+/* Timestamp state, protected with disabled interrupts */
+static uint32_t RTC_TS_Cycles;                  /* DWT cycle counter at last update */
+static uint64_t RTC_TS_Micros;                  /* Timestamp at last update */
+static uint32_t RTC_TS_Mult;                    /* Microseconds per cycle, 0.32 fixed point */
+static int32_t RTC_TS_Adjust;                   /* Phase slew part of multiplier */
+static uint32_t RTC_TS_NominalMult;             /* Microseconds per cycle from HCLK */
+static uint64_t RTC_TS_TotalCycles;             /* Extended 64-bit cycle counter at last update */
+static uint64_t RTC_TS_RefCycles;               /* Extended cycle counter at reference point */
+static uint64_t RTC_TS_RefMicros;               /* Reference time at reference point */
+static uint8_t RTC_TS_RefSource;                /* Reference source, 0 = RTC, 1 = external */
+static uint8_t RTC_TS_External;                 /* Set when disciplined from external reference since last update */
+static uint32_t RTC_TS_LastDR;                  /* Cached RTC date register */
+static uint32_t RTC_TS_LastDay;                 /* Seconds at 00:00:00 of cached date */
+#endif
 
 /* RTC Handle */
 static RTC_HandleTypeDef hRTC;
 static RTC_DateTypeDef RTC_DateStruct;
 static RTC_TimeTypeDef RTC_TimeStruct;
 
+/* Last converted day in each direction, date is packed as year << 16 | month << 8 | day */
+static volatile uint32_t RTC_DayCacheForward, RTC_DayCacheForwardDays;
+static volatile uint32_t RTC_DayCacheBackward, RTC_DayCacheBackwardDays;
+
 /* Days in a month */
 static uint8_t RTC_Months[2][12] = {
 	{31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},	/* Not leap year */
@@ -196,6 +220,13 @@ TM_RTC_Result_t TM_RTC_SetDateTime(TM_RTC_t* data, TM_RTC_Format_t format) {
 	/* Init RTC */
 	HAL_RTC_Init(&hRTC);
 	
+#if RTC_TIMESTAMP
+	/* RTC time base changed, restart frequency measurement */
+	if (RTC_TS_Mult) {
+		TM_RTC_INT_TimestampRebase();
+	}
+#endif
+	
 	/* Return OK */
 	return TM_RTC_Result_Ok;
 }
@@ -409,23 +440,31 @@ TM_RTC_Result_t TM_RTC_Interrupts(TM_RTC_Int_t int_value) {
 }
 
 uint32_t TM_RTC_GetUnixTimeStamp(TM_RTC_t* data) {
-	uint32_t days = 0, seconds = 0;
-	uint16_t i;
-	uint16_t year = (uint16_t) (data->Year + 2000);
-	/* Year is below offset year */
-	if (year < RTC_OFFSET_YEAR) {
-		return 0;
-	}
-	/* Days in back years */
-	for (i = RTC_OFFSET_YEAR; i < year; i++) {
-		days += RTC_DAYS_IN_YEAR(i);
-	}
-	/* Days in current year */
-	for (i = 1; i < data->Month; i++) {
-		days += RTC_Months[RTC_LEAP_YEAR(year)][i - 1];
+	uint32_t days, seconds, year, month, era, yoe, doy, date;
+	
+	year = data->Year + 2000;
+	month = data->Month;
+	date = year << 16 | month << 8 | data->Day;
+	
+	/* Same day as last time, use cached day count */
+	/* Check days again after read, cache may be updated from interrupt meanwhile */
+	days = RTC_DayCacheForwardDays;
+	if (RTC_DayCacheForward != date || RTC_DayCacheForwardDays != days) {
+		/* Year starts with march, february is last month in year */
+		if (month <= 2) {
+			year--;
+		}
+		era = year / 400;
+		yoe = year - era * 400;
+		doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + data->Day - 1;
+		days = era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - RTC_DAYS_TO_OFFSET;
+		
+		/* Save to cache */
+		RTC_DayCacheForward = 0;
+		RTC_DayCacheForwardDays = days;
+		RTC_DayCacheForward = date;
 	}
-	/* Day starts with 1 */
-	days += data->Day - 1;
+	
 	seconds = days * RTC_SECONDS_PER_DAY;
 	seconds += data->Hours * RTC_SECONDS_PER_HOUR;
 	seconds += data->Minutes * RTC_SECONDS_PER_MINUTE;
@@ -436,7 +475,7 @@ uint32_t TM_RTC_GetUnixTimeStamp(TM_RTC_t* data) {
 }
 
 TM_RTC_Result_t TM_RTC_GetDateTimeFromUnix(TM_RTC_t* data, uint32_t unix) {
-	uint16_t year;
+	uint32_t days, date, era, doe, yoe, doy, mp, year;
 	
 	/* Store unix time to unix in struct */
 	data->Unix = unix;
@@ -451,55 +490,87 @@ TM_RTC_Result_t TM_RTC_GetDateTimeFromUnix(TM_RTC_t* data, uint32_t unix) {
 	/* Get hours */
 	data->Hours = unix % 24;
 	/* Go to days */
-	unix /= 24;
+	days = unix / 24;
 	
 	/* Get week day */
 	/* Monday is day one */
-	data->WeekDay = (unix + 3) % 7 + 1;
-
-	/* Get year */
-	year = 1970;
-	while (1) {
-		if (RTC_LEAP_YEAR(year)) {
-			if (unix >= 366) {
-				unix -= 366;
-			} else {
-				break;
-			}
-		} else if (unix >= 365) {
-			unix -= 365;
-		} else {
-			break;
+	data->WeekDay = (days + 3) % 7 + 1;
+	
+	/* Same day as last time, use cached date */
+	/* Check day again after read, cache may be updated from interrupt meanwhile */
+	date = RTC_DayCacheBackward;
+	if (RTC_DayCacheBackwardDays != days || RTC_DayCacheBackward != date || !date) {
+		/* Days from 01.03.0000, year starts with march */
+		days += RTC_DAYS_TO_OFFSET;
+		era = days / 146097;
+		doe = days - era * 146097;
+		yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+		doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+		mp = (5 * doy + 2) / 153;
+		year = yoe + era * 400;
+		date = doy - (153 * mp + 2) / 5 + 1;
+		mp = mp < 10 ? mp + 3 : mp - 9;
+		if (mp <= 2) {
+			year++;
 		}
-		year++;
+		date |= (year - 2000) << 16 | mp << 8;
+		
+		/* Save to cache */
+		RTC_DayCacheBackward = 0;
+		RTC_DayCacheBackwardDays = days - RTC_DAYS_TO_OFFSET;
+		RTC_DayCacheBackward = date;
 	}
+	
 	/* Get year in xx format */
-	data->Year = (uint8_t) (year - 2000);
-	/* Get month */
-	for (data->Month = 0; data->Month < 12; data->Month++) {
-		if (RTC_LEAP_YEAR(year)) {
-			if (unix >= (uint32_t)RTC_Months[1][data->Month]) {
-				unix -= RTC_Months[1][data->Month];
-			} else {
-				break;
-			}
-		} else if (unix >= (uint32_t)RTC_Months[0][data->Month]) {
-			unix -= RTC_Months[0][data->Month];
-		} else {
-			break;
-		}
-	}
+	data->Year = (uint8_t)(date >> 16);
 	/* Get month */
 	/* Month starts with 1 */
-	data->Month++;
+	data->Month = (uint8_t)(date >> 8);
 	/* Get date */
 	/* Date starts with 1 */
-	data->Day = unix + 1;
+	data->Day = (uint8_t)date;
+	
+	/* Return OK */
+	return TM_RTC_Result_Ok;
+}
 
+TM_RTC_Result_t TM_RTC_SetCalibration(int32_t ppb) {
+	int32_t steps;
+	
+	/* One step is 1 / 2^20 of RTCCLK, about 953.67 ppb */
+	steps = (int32_t)(((int64_t)ppb * (1 << 20) + (ppb >= 0 ? 500000000 : -500000000)) / 1000000000);
+	
+	/* Check range, plus pulses add 512 steps and minus pulses remove up to 511 steps */
+	if (steps > 512 || steps < -511) {
+		return TM_RTC_Result_Error;
+	}
+	
+	/* Set smooth calibration */
+	if (steps > 0) {
+		if (HAL_RTCEx_SetSmoothCalib(&hRTC, RTC_SMOOTHCALIB_PERIOD_32SEC, RTC_SMOOTHCALIB_PLUSPULSES_SET, 512 - steps) != HAL_OK) {
+			return TM_RTC_Result_Error;
+		}
+	} else {
+		if (HAL_RTCEx_SetSmoothCalib(&hRTC, RTC_SMOOTHCALIB_PERIOD_32SEC, RTC_SMOOTHCALIB_PLUSPULSES_RESET, -steps) != HAL_OK) {
+			return TM_RTC_Result_Error;
+		}
+	}
+	
 	/* Return OK */
 	return TM_RTC_Result_Ok;
 }
 
+int32_t TM_RTC_GetCalibration(void) {
+	int32_t steps;
+	
+	/* Plus pulses add 512 steps, minus pulses remove steps */
+	steps = (RTC->CALR & RTC_CALR_CALP) ? 512 : 0;
+	steps -= RTC->CALR & RTC_CALR_CALM;
+	
+	/* Return in ppb */
+	return (int32_t)((int64_t)steps * 1000000000 / (1 << 20));
+}
+
 TM_RTC_Result_t TM_RTC_EnableAlarm(TM_RTC_Alarm_t Alarm, TM_RTC_AlarmTime_t* DataTime, TM_RTC_Format_t format) {
 	RTC_AlarmTypeDef salarmstructure;
 	
@@ -572,12 +643,12 @@ TM_RTC_Result_t TM_RTC_DisableAlarm(TM_RTC_Alarm_t Alarm) {
 
 void TM_RTC_WriteBackupRegister(uint8_t location, uint32_t value) {
 	/* Write data to backup register */
-	*(uint32_t *)((&RTC->BKP0R) + 4 * location) = value;
+	(&RTC->BKP0R)[location] = value;
 }
 
 uint32_t TM_RTC_ReadBackupRegister(uint8_t location) {
 	/* Read data from backup register */
-	return *(uint32_t *)((&RTC->BKP0R) + 4 * location);
+	return (&RTC->BKP0R)[location];
 }
 
 /* Callbacks */
@@ -597,6 +668,13 @@ __weak void TM_RTC_AlarmBHandler(void) {
 void RTC_WKUP_IRQHandler(void) {
 	/* Check for RTC interrupt */
 	if (__HAL_RTC_WAKEUPTIMER_GET_IT(&hRTC, RTC_IT_WUT) != RESET) {
+#if RTC_TIMESTAMP
+		/* Discipline timestamp */
+		if (RTC_TS_Mult) {
+			TM_RTC_TimestampUpdate();
+		}
+#endif
+		
 		/* Call user function */
 		TM_RTC_WakeupHandler();
 		
@@ -630,3 +708,226 @@ void RTC_Alarm_IRQHandler(void) {
 	/* Clear EXTI line 22 bit */
 	__HAL_RTC_ALARM_EXTI_CLEAR_FLAG();
 }
+
+#if RTC_TIMESTAMP
+void TM_RTC_TimestampInit(void) {
+	uint32_t irq;
+	
+	/* Enable DWT cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	
+	/* Nominal microseconds per cycle */
+	RTC_TS_NominalMult = (uint32_t)((1000000ULL << 32) / HAL_RCC_GetHCLKFreq());
+	
+	/* Invalidate date cache */
+	RTC_TS_LastDR = 0;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Start from current RTC time */
+	RTC_TS_Mult = RTC_TS_NominalMult;
+	RTC_TS_Cycles = DWT->CYCCNT;
+	RTC_TS_TotalCycles = 0;
+	RTC_TS_Micros = TM_RTC_INT_ReadMicros();
+	RTC_TS_Adjust = 0;
+	RTC_TS_RefCycles = 0;
+	RTC_TS_RefMicros = RTC_TS_Micros;
+	RTC_TS_RefSource = 0;
+	RTC_TS_External = 0;
+	
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+uint64_t TM_RTC_GetTimestamp(void) {
+	uint32_t irq;
+	uint64_t micros;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Extrapolate from last update */
+	micros = RTC_TS_Micros + (((uint64_t)(DWT->CYCCNT - RTC_TS_Cycles) * RTC_TS_Mult) >> 32);
+	
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	return micros;
+}
+
+void TM_RTC_TimestampUpdate(void) {
+	uint32_t irq, cycles;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	cycles = DWT->CYCCNT;
+	if (RTC_TS_External) {
+		/* Disciplined from external reference since last update, only move base to prevent counter overflow */
+		RTC_TS_External = 0;
+		RTC_TS_Micros += ((uint64_t)(cycles - RTC_TS_Cycles) * RTC_TS_Mult) >> 32;
+		RTC_TS_TotalCycles += cycles - RTC_TS_Cycles;
+		RTC_TS_Cycles = cycles;
+	} else {
+		/* Discipline against RTC, subseconds resolution is about 1ms so long interval is needed */
+		TM_RTC_INT_TimestampDiscipline(cycles, TM_RTC_INT_ReadMicros(), 0, 10000000);
+	}
+	
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_RTC_TimestampDiscipline(uint32_t Cycles, uint64_t Micros) {
+	uint32_t irq;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Reference is exact, frequency can be measured after 1 second */
+	TM_RTC_INT_TimestampDiscipline(Cycles, Micros, 1, 1000000);
+	RTC_TS_External = 1;
+	
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+uint64_t TM_RTC_GetMicros(void) {
+	uint32_t irq;
+	uint64_t micros;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Cache is shared with timestamp */
+	micros = TM_RTC_INT_ReadMicros();
+	
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	return micros;
+}
+
+static void TM_RTC_INT_TimestampDiscipline(uint32_t cycles, uint64_t reference, uint8_t source, uint32_t baseline) {
+	uint32_t delta, mult, limit;
+	uint64_t elapsed_cycles, elapsed_micros;
+	int64_t error, adjust;
+	
+	/* Reference point is before base, timestamps after it were already given out */
+	delta = cycles - RTC_TS_Cycles;
+	if ((int32_t)delta < 0) {
+		return;
+	}
+	
+	/* Move base to reference point, timestamp stays continuous */
+	RTC_TS_Micros += ((uint64_t)delta * RTC_TS_Mult) >> 32;
+	RTC_TS_Cycles = cycles;
+	RTC_TS_TotalCycles += delta;
+	
+	/* Reference source changed, restart frequency measurement */
+	if (source != RTC_TS_RefSource) {
+		RTC_TS_RefSource = source;
+		RTC_TS_RefCycles = RTC_TS_TotalCycles;
+		RTC_TS_RefMicros = reference;
+	}
+	
+	/* Measure frequency over whole interval from reference point */
+	elapsed_cycles = RTC_TS_TotalCycles - RTC_TS_RefCycles;
+	elapsed_micros = reference - RTC_TS_RefMicros;
+	mult = RTC_TS_Mult - (uint32_t)RTC_TS_Adjust;
+	if (reference > RTC_TS_RefMicros && elapsed_micros >= baseline) {
+		/* Scale down cycles, keep microseconds shifted by 20 bits to fit into 64 bits */
+		mult = (uint32_t)((elapsed_micros << 20) / (elapsed_cycles >> 12));
+		
+		/* Restart reference before shifted value overflows, keep measured frequency */
+		if (elapsed_micros >= (1ULL << 40)) {
+			RTC_TS_RefCycles = RTC_TS_TotalCycles;
+			RTC_TS_RefMicros = reference;
+		}
+	}
+	
+	/* Phase error against reference */
+	error = (int64_t)(reference - RTC_TS_Micros);
+	if (error > RTC_TIMESTAMP_STEP) {
+		/* Too far behind reference, step forward */
+		RTC_TS_Micros = reference;
+		error = 0;
+	}
+	
+	/* Slew error over next update interval, assume it has the same length as last one */
+	/* Limit slew to half of frequency so timestamp never goes backwards */
+	adjust = 0;
+	if (delta) {
+		adjust = (error * (1LL << 32)) / (int64_t)delta;
+		limit = mult / 2;
+		if (adjust > (int64_t)limit) {
+			adjust = limit;
+		} else if (adjust < -(int64_t)limit) {
+			adjust = -(int64_t)limit;
+		}
+	}
+	RTC_TS_Adjust = (int32_t)adjust;
+	RTC_TS_Mult = (uint32_t)((int64_t)mult + adjust);
+}
+
+static uint64_t TM_RTC_INT_ReadMicros(void) {
+	uint32_t ssr, tr, dr, seconds;
+	TM_RTC_t tmp;
+	
+	/* Reading SSR locks TR and DR shadow registers until DR is read */
+	ssr = RTC->SSR;
+	tr = RTC->TR;
+	dr = RTC->DR;
+	
+	/* Date changes once per day, cache its conversion */
+	if (dr != RTC_TS_LastDR) {
+		tmp.Year = RTC_BCD2BIN((dr >> 16) & 0xFF);
+		tmp.Month = RTC_BCD2BIN((dr >> 8) & 0x1F);
+		tmp.Day = RTC_BCD2BIN(dr & 0x3F);
+		tmp.Hours = 0;
+		tmp.Minutes = 0;
+		tmp.Seconds = 0;
+		RTC_TS_LastDay = TM_RTC_GetUnixTimeStamp(&tmp);
+		RTC_TS_LastDR = dr;
+	}
+	
+	/* Add time of day */
+	seconds = RTC_TS_LastDay;
+	seconds += RTC_BCD2BIN((tr >> 16) & 0x3F) * RTC_SECONDS_PER_HOUR;
+	seconds += RTC_BCD2BIN((tr >> 8) & 0x7F) * RTC_SECONDS_PER_MINUTE;
+	seconds += RTC_BCD2BIN(tr & 0x7F);
+	
+	/* Subseconds count down from RTC_SYNC_PREDIV */
+	return (uint64_t)seconds * 1000000 + ((RTC_SYNC_PREDIV - (ssr & RTC_SYNC_PREDIV)) * 1000000UL) / (RTC_SYNC_PREDIV + 1);
+}
+
+static void TM_RTC_INT_TimestampRebase(void) {
+	uint32_t irq, cycles;
+	
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Move base to current point */
+	cycles = DWT->CYCCNT;
+	RTC_TS_Micros += ((uint64_t)(cycles - RTC_TS_Cycles) * RTC_TS_Mult) >> 32;
+	RTC_TS_TotalCycles += cycles - RTC_TS_Cycles;
+	RTC_TS_Cycles = cycles;
+	
+	/* New reference point on new RTC time, external reference is not affected */
+	RTC_TS_LastDR = 0;
+	if (RTC_TS_RefSource == 0) {
+		RTC_TS_RefCycles = RTC_TS_TotalCycles;
+		RTC_TS_RefMicros = TM_RTC_INT_ReadMicros();
+	}
+	
+	if (!irq) {
+		__enable_irq();
+	}
+}
+#endif
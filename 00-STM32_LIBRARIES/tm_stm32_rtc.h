@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-24-rtc-for-stm32fxxx/
- * @version 1.0
+ * @version v1.5
  * @ide     Keil uVision
  * @license MIT
  * @brief   Internal RTC library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_RTC_H
-#define TM_RTC_H 100
+#define TM_RTC_H 150
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -69,6 +69,8 @@ extern "C" {
 - Support to write data in string format
 - Date and time are checked before saved for valid input data
 - Get days in month and year
+- Monotonic 64-bit microsecond timestamp disciplined by RTC, with RTC_TIMESTAMP option
+- RTC smooth calibration in ppb
 \endverbatim
  *
  * \par Pinout for RTC external 32768Hz crystal
@@ -83,6 +85,30 @@ extern "C" {
  * \par Changelog
  *
 \verbatim
+ Version 1.5
+   - October 14, 2026
+   - Default NVIC priority is taken from TM NVIC priority plan
+
+ Version 1.4
+   - October 14, 2026
+   - Fixed backup register address calculation, registers above 0 were written to wrong address
+
+ Version 1.3
+   - October 14, 2026
+   - Added TM_RTC_SetCalibration and TM_RTC_GetCalibration functions for RTC smooth calibration
+   - Timestamp can be disciplined from external reference with TM_RTC_TimestampDiscipline, for example GPS PPS
+   - Added TM_RTC_GetMicros function
+
+ Version 1.2
+   - October 14, 2026
+   - Unix timestamp to date and date to unix timestamp conversions are done in constant time without loops
+   - Last converted day is cached, only time fields are calculated while day does not change
+
+ Version 1.1
+   - October 14, 2026
+   - Added monotonic 64-bit microsecond timestamp, enabled with RTC_TIMESTAMP define
+   - Timestamp runs from DWT cycle counter and is disciplined against RTC seconds and subseconds
+
  Version 1.0
    - First release
 \endverbatim
@@ -119,7 +145,7 @@ extern "C" {
 #endif
 /* NVIC global Priority set */
 #ifndef RTC_NVIC_PRIORITY
-#define RTC_NVIC_PRIORITY               0x04
+#define RTC_NVIC_PRIORITY               NVIC_PRIORITY_LOW
 #endif
 /* Sub priority for wakeup trigger */
 #ifndef RTC_NVIC_WAKEUP_SUBPRIORITY
@@ -128,6 +154,26 @@ extern "C" {
 /* Sub priority for alarm trigger */
 #ifndef RTC_NVIC_ALARM_SUBPRIORITY
 #define RTC_NVIC_ALARM_SUBPRIORITY      0x01
+#endif
+
+/**
+ * @brief  Enables monotonic 64-bit microsecond timestamp
+ * @note   Timestamp is read from DWT cycle counter and disciplined against RTC on every wakeup interrupt.
+ *         Wakeup interrupt must be enabled with @ref TM_RTC_Interrupts with period of 10 seconds or less,
+ *         or @ref TM_RTC_TimestampUpdate must be called by user at least every 10 seconds
+ * @note   Not available on STM32F0xx devices, they don't have DWT cycle counter
+ */
+#ifndef RTC_TIMESTAMP
+#define RTC_TIMESTAMP                   0
+#endif
+
+/* Maximal forward error in microseconds which is slewed, bigger forward errors step timestamp immediately */
+#ifndef RTC_TIMESTAMP_STEP
+#define RTC_TIMESTAMP_STEP              1000000
+#endif
+
+#if RTC_TIMESTAMP && defined(STM32F0xx)
+#error "RTC_TIMESTAMP is not supported on STM32F0xx devices!"
 #endif
 
  /**
@@ -369,6 +415,74 @@ TM_RTC_Result_t TM_RTC_EnableAlarm(TM_RTC_Alarm_t Alarm, TM_RTC_AlarmTime_t* Ala
  */
 TM_RTC_Result_t TM_RTC_DisableAlarm(TM_RTC_Alarm_t Alarm);
 
+/**
+ * @brief  Sets RTC smooth calibration
+ * @note   Calibration is applied over 32 seconds cycle with resolution of about 0.954 ppm
+ * @param  ppb: Frequency correction in parts per billion, positive value speeds up RTC.
+ *            Valid range is from -487328 to 488281
+ * @retval Member of @ref TM_RTC_Result_t enumeration
+ */
+TM_RTC_Result_t TM_RTC_SetCalibration(int32_t ppb);
+
+/**
+ * @brief  Gets current RTC smooth calibration
+ * @param  None
+ * @retval Frequency correction in parts per billion, positive value speeds up RTC
+ */
+int32_t TM_RTC_GetCalibration(void);
+
+#if RTC_TIMESTAMP || __DOXYGEN__
+
+/**
+ * @brief  Initializes monotonic timestamp and aligns it to current RTC time
+ * @note   RTC has to be initialized first before you can use this method.
+ * @note   Can be called again to restart timestamp from RTC. In this case timestamp may go backwards
+ * @param  None
+ * @retval None
+ */
+void TM_RTC_TimestampInit(void);
+
+/**
+ * @brief  Gets current monotonic timestamp
+ * @note   Timestamp is in units of microseconds from 01.01.1970 00:00:00 and never goes backwards
+ * @note   Function does not access RTC registers and can be called from any interrupt
+ * @param  None
+ * @retval Microseconds from 01.01.1970 00:00:00
+ */
+uint64_t TM_RTC_GetTimestamp(void);
+
+/**
+ * @brief  Disciplines timestamp against RTC
+ * @note   Called automatically from RTC wakeup interrupt.
+ *         If wakeup interrupt is not used, call it at least every 10 seconds
+ * @note   Frequency of timestamp is measured against RTC and phase error is slewed over next update interval.
+ *         Forward errors bigger than RTC_TIMESTAMP_STEP step timestamp immediately, backward errors are always slewed
+ * @param  None
+ * @retval None
+ */
+void TM_RTC_TimestampUpdate(void);
+
+/**
+ * @brief  Disciplines timestamp against external reference
+ * @note   While external reference is used, @ref TM_RTC_TimestampUpdate only prevents cycle counter overflow.
+ *         When external reference stops, timestamp is disciplined against RTC again
+ * @note   Reference should be given at least every 10 seconds, for example from GPS PPS interrupt
+ * @param  Cycles: DWT cycle counter value at reference point
+ * @param  Micros: Exact time at reference point in microseconds from 01.01.1970 00:00:00
+ * @retval None
+ */
+void TM_RTC_TimestampDiscipline(uint32_t Cycles, uint64_t Micros);
+
+/**
+ * @brief  Reads current RTC time directly from registers
+ * @note   Resolution is limited by RTC subseconds, about 1ms with default RTC_SYNC_PREDIV
+ * @param  None
+ * @retval RTC time in microseconds from 01.01.1970 00:00:00
+ */
+uint64_t TM_RTC_GetMicros(void);
+
+#endif /* RTC_TIMESTAMP */
+
 /**
  * @brief  RTC Wakeup handler function. Called when wakeup interrupt is triggered
  * @note   Called from my RTC library
@@ -0,0 +1,645 @@
+/**
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software,
+ * | and to permit persons to whom the Software is furnished to do so,
+ * | subject to the following conditions:
+ * |
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * |
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_rtos.h"
+
+/* Check interrupt priorities, completion interrupts call FreeRTOS API */
+#if RTOS_USE_I2C && I2C_NVIC_PRIORITY < configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#error "I2C_NVIC_PRIORITY must be greater or equal to configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY!"
+#endif
+#if (RTOS_USE_SPI_DMA || RTOS_USE_USART_DMA) && (DMA1_NVIC_PREEMPTION_PRIORITY < configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY || DMA2_NVIC_PREEMPTION_PRIORITY < configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY)
+#error "DMA1_NVIC_PREEMPTION_PRIORITY and DMA2_NVIC_PREEMPTION_PRIORITY must be greater or equal to configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY!"
+#endif
+
+/* Private structure */
+typedef struct {
+	void* Bus;                /*!< Peripheral pointer, NULL when entry is free */
+	SemaphoreHandle_t Mutex;  /*!< Recursive mutex for bus */
+	TM_RTOS_Wait_t Wait;      /*!< Wait structure for blocking transfers on bus */
+} TM_RTOS_INT_Bus_t;
+
+/* Private variables */
+static TM_RTOS_INT_Bus_t RTOS_Buses[RTOS_MAX_BUSES];
+
+#if RTOS_USE_TICKLESS
+/* CPU load used in idle */
+static TM_CPULOAD_t* RTOS_CPULoad = NULL;
+#endif
+
+#if RTOS_USE_MONITOR
+/* Monitored queue */
+typedef struct {
+	void* Queue;                                /*!< Queue handle, NULL when entry is free */
+	const char* Name;                           /*!< Queue name in report */
+	uint32_t Stamps[RTOS_MONITOR_QUEUE_DEPTH];  /*!< Send times of tracked items in queue */
+	uint8_t In;                                 /*!< Index for next timestamp */
+	uint8_t Out;                                /*!< Index of oldest timestamp */
+	uint8_t Count;                              /*!< Number of tracked items in queue */
+	uint16_t Untracked;                         /*!< Number of items in queue without timestamp */
+	uint16_t HighWater;                         /*!< Max number of items in queue */
+	uint32_t Samples;                           /*!< Number of measured items */
+	uint64_t TotalLatency;                      /*!< Sum of latencies for average */
+	uint32_t MaxLatency;                        /*!< Max latency */
+} TM_RTOS_INT_Queue_t;
+
+/* Monitored queues and task status array for report */
+static TM_RTOS_INT_Queue_t RTOS_Queues[RTOS_MONITOR_MAX_QUEUES];
+static TaskStatus_t RTOS_Tasks[RTOS_MONITOR_MAX_TASKS];
+#endif
+
+/* Private functions */
+static TM_RTOS_INT_Bus_t* TM_RTOS_INT_FindBus(void* Bus);
+static TM_RTOS_INT_Bus_t* TM_RTOS_INT_GetBus(void* Bus);
+#if RTOS_USE_MONITOR
+static TM_RTOS_INT_Queue_t* TM_RTOS_INT_FindQueue(void* Queue);
+#endif
+#if RTOS_USE_I2C
+static void TM_RTOS_INT_I2CCallback(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+#endif
+#if RTOS_USE_SPI_DMA
+static void TM_RTOS_INT_SPICallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param);
+#endif
+#if RTOS_USE_USART_DMA
+static void TM_RTOS_INT_USARTCallback(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, void* Param);
+#endif
+
+TM_RTOS_Result_t TM_RTOS_Lock(void* Bus, uint32_t Timeout) {
+	TM_RTOS_INT_Bus_t* bus = TM_RTOS_INT_GetBus(Bus);
+	
+	/* Check bus */
+	if (bus == NULL) {
+		return TM_RTOS_Result_Error;
+	}
+	
+	/* Take mutex */
+	if (xSemaphoreTakeRecursive(bus->Mutex, Timeout) != pdTRUE) {
+		return TM_RTOS_Result_Busy;
+	}
+	
+	/* Bus locked */
+	return TM_RTOS_Result_Ok;
+}
+
+void TM_RTOS_Unlock(void* Bus) {
+	TM_RTOS_INT_Bus_t* bus = TM_RTOS_INT_FindBus(Bus);
+	
+	/* Give mutex back */
+	if (bus != NULL) {
+		xSemaphoreGiveRecursive(bus->Mutex);
+	}
+}
+
+uint32_t TM_RTOS_Prepare(TM_RTOS_Wait_t* Wait) {
+	uint32_t token;
+	
+	/* Remove old notifications, for example from transfer which timed out */
+	ulTaskNotifyTake(pdTRUE, 0);
+	
+	/* Set new transfer */
+	taskENTER_CRITICAL();
+	token = ++Wait->Token;
+	Wait->Task = xTaskGetCurrentTaskHandle();
+	Wait->Result = TM_RTOS_Result_Error;
+	Wait->Pending = 1;
+	taskEXIT_CRITICAL();
+	
+	/* Return token */
+	return token;
+}
+
+TM_RTOS_Result_t TM_RTOS_Block(TM_RTOS_Wait_t* Wait, uint32_t Timeout) {
+	TickType_t start = xTaskGetTickCount(), elapsed;
+	
+	/* Wait until transfer is signaled */
+	while (Wait->Pending) {
+		elapsed = xTaskGetTickCount() - start;
+		
+		/* Check timeout */
+		if (Timeout != portMAX_DELAY && elapsed >= Timeout) {
+			taskENTER_CRITICAL();
+			if (Wait->Pending) {
+				/* Ignore signal for this transfer from now */
+				Wait->Token++;
+				Wait->Task = NULL;
+				Wait->Pending = 0;
+				Wait->Result = TM_RTOS_Result_Timeout;
+			}
+			taskEXIT_CRITICAL();
+			break;
+		}
+		
+		/* Sleep until notification */
+		ulTaskNotifyTake(pdTRUE, Timeout == portMAX_DELAY ? portMAX_DELAY : (Timeout - elapsed));
+	}
+	
+	/* Return result */
+	return Wait->Result;
+}
+
+void TM_RTOS_Signal(TM_RTOS_Wait_t* Wait, uint32_t Token, TM_RTOS_Result_t Result) {
+	TaskHandle_t task = NULL;
+	BaseType_t woken = pdFALSE;
+	UBaseType_t status;
+	
+	/* Works from task and from interrupt */
+	status = portSET_INTERRUPT_MASK_FROM_ISR();
+	if (Wait->Pending && Wait->Token == Token) {
+		Wait->Result = Result;
+		Wait->Pending = 0;
+		task = Wait->Task;
+		Wait->Task = NULL;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(status);
+	
+	/* Wake up task */
+	if (task != NULL) {
+		if (__get_IPSR()) {
+			vTaskNotifyGiveFromISR(task, &woken);
+			portYIELD_FROM_ISR(woken);
+		} else {
+			xTaskNotifyGive(task);
+		}
+	}
+}
+
+#if RTOS_USE_I2C
+TM_RTOS_Result_t TM_RTOS_I2C_ReadMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t* data, uint16_t count, uint32_t Timeout) {
+	TM_RTOS_Result_t result;
+	TM_RTOS_INT_Bus_t* bus;
+	uint32_t token;
+	
+	/* Lock bus */
+	if ((result = TM_RTOS_Lock(I2Cx, Timeout)) != TM_RTOS_Result_Ok) {
+		return result;
+	}
+	bus = TM_RTOS_INT_FindBus(I2Cx);
+	
+	/* Queue transaction and wait for it */
+	token = TM_RTOS_Prepare(&bus->Wait);
+	if (!TM_I2C_ReadMultiQueued(I2Cx, device_address, register_address, data, count, TM_RTOS_INT_I2CCallback, (void *)token)) {
+		TM_RTOS_Signal(&bus->Wait, token, TM_RTOS_Result_Error);
+	}
+	result = TM_RTOS_Block(&bus->Wait, Timeout);
+	
+	/* Unlock bus */
+	TM_RTOS_Unlock(I2Cx);
+	
+	/* Return result */
+	return result;
+}
+
+TM_RTOS_Result_t TM_RTOS_I2C_WriteMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t* data, uint16_t count, uint32_t Timeout) {
+	TM_RTOS_Result_t result;
+	TM_RTOS_INT_Bus_t* bus;
+	uint32_t token;
+	
+	/* Lock bus */
+	if ((result = TM_RTOS_Lock(I2Cx, Timeout)) != TM_RTOS_Result_Ok) {
+		return result;
+	}
+	bus = TM_RTOS_INT_FindBus(I2Cx);
+	
+	/* Queue transaction and wait for it */
+	token = TM_RTOS_Prepare(&bus->Wait);
+	if (!TM_I2C_WriteMultiQueued(I2Cx, device_address, register_address, data, count, TM_RTOS_INT_I2CCallback, (void *)token)) {
+		TM_RTOS_Signal(&bus->Wait, token, TM_RTOS_Result_Error);
+	}
+	result = TM_RTOS_Block(&bus->Wait, Timeout);
+	
+	/* Unlock bus */
+	TM_RTOS_Unlock(I2Cx);
+	
+	/* Return result */
+	return result;
+}
+
+TM_RTOS_Result_t TM_RTOS_I2C_ReadMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, uint32_t Timeout) {
+	TM_RTOS_Result_t result;
+	TM_RTOS_INT_Bus_t* bus;
+	uint32_t token;
+	
+	/* Lock bus */
+	if ((result = TM_RTOS_Lock(I2Cx, Timeout)) != TM_RTOS_Result_Ok) {
+		return result;
+	}
+	bus = TM_RTOS_INT_FindBus(I2Cx);
+	
+	/* Queue transaction and wait for it */
+	token = TM_RTOS_Prepare(&bus->Wait);
+	if (!TM_I2C_ReadMultiNoRegisterQueued(I2Cx, device_address, data, count, TM_RTOS_INT_I2CCallback, (void *)token)) {
+		TM_RTOS_Signal(&bus->Wait, token, TM_RTOS_Result_Error);
+	}
+	result = TM_RTOS_Block(&bus->Wait, Timeout);
+	
+	/* Unlock bus */
+	TM_RTOS_Unlock(I2Cx);
+	
+	/* Return result */
+	return result;
+}
+
+TM_RTOS_Result_t TM_RTOS_I2C_WriteMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, uint32_t Timeout) {
+	TM_RTOS_Result_t result;
+	TM_RTOS_INT_Bus_t* bus;
+	uint32_t token;
+	
+	/* Lock bus */
+	if ((result = TM_RTOS_Lock(I2Cx, Timeout)) != TM_RTOS_Result_Ok) {
+		return result;
+	}
+	bus = TM_RTOS_INT_FindBus(I2Cx);
+	
+	/* Queue transaction and wait for it */
+	token = TM_RTOS_Prepare(&bus->Wait);
+	if (!TM_I2C_WriteMultiNoRegisterQueued(I2Cx, device_address, data, count, TM_RTOS_INT_I2CCallback, (void *)token)) {
+		TM_RTOS_Signal(&bus->Wait, token, TM_RTOS_Result_Error);
+	}
+	result = TM_RTOS_Block(&bus->Wait, Timeout);
+	
+	/* Unlock bus */
+	TM_RTOS_Unlock(I2Cx);
+	
+	/* Return result */
+	return result;
+}
+#endif
+
+#if RTOS_USE_SPI_DMA
+TM_RTOS_Result_t TM_RTOS_SPI_Transmit(SPI_TypeDef* SPIx, const TM_SPI_DMA_Job_t* Job, uint32_t Timeout) {
+	TM_RTOS_Result_t result;
+	TM_RTOS_INT_Bus_t* bus;
+	TM_SPI_DMA_Job_t job;
+	
+	/* Lock bus */
+	if ((result = TM_RTOS_Lock(SPIx, Timeout)) != TM_RTOS_Result_Ok) {
+		return result;
+	}
+	bus = TM_RTOS_INT_FindBus(SPIx);
+	
+	/* Copy job with our callback */
+	job = *Job;
+	job.Callback = TM_RTOS_INT_SPICallback;
+	
+	/* Queue job and wait for it */
+	job.Param = (void *)TM_RTOS_Prepare(&bus->Wait);
+	if (!TM_SPI_DMA_Enqueue(SPIx, &job)) {
+		TM_RTOS_Signal(&bus->Wait, (uint32_t)job.Param, TM_RTOS_Result_Error);
+	}
+	result = TM_RTOS_Block(&bus->Wait, Timeout);
+	
+	/* Unlock bus */
+	TM_RTOS_Unlock(SPIx);
+	
+	/* Return result */
+	return result;
+}
+#endif
+
+#if RTOS_USE_USART_DMA
+TM_RTOS_Result_t TM_RTOS_USART_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, uint32_t Timeout) {
+	TM_RTOS_Result_t result;
+	TM_RTOS_INT_Bus_t* bus;
+	uint32_t token;
+	
+	/* Lock bus */
+	if ((result = TM_RTOS_Lock(USARTx, Timeout)) != TM_RTOS_Result_Ok) {
+		return result;
+	}
+	bus = TM_RTOS_INT_FindBus(USARTx);
+	
+	/* Queue data and wait for it */
+	token = TM_RTOS_Prepare(&bus->Wait);
+	if (!TM_USART_DMA_SendQueued(USARTx, DataArray, count, TM_RTOS_INT_USARTCallback, (void *)token)) {
+		TM_RTOS_Signal(&bus->Wait, token, TM_RTOS_Result_Error);
+	}
+	result = TM_RTOS_Block(&bus->Wait, Timeout);
+	
+	/* Unlock bus */
+	TM_RTOS_Unlock(USARTx);
+	
+	/* Return result */
+	return result;
+}
+#endif
+
+#if RTOS_USE_TICKLESS
+void TM_RTOS_TicklessInit(TM_CPULOAD_t* CPU_Load) {
+	/* Save CPU load structure */
+	RTOS_CPULoad = CPU_Load;
+}
+
+void TM_RTOS_SuppressTicksAndSleep(uint32_t ExpectedIdleTime) {
+	uint32_t irq;
+	
+	/* Check if initialized */
+	if (RTOS_CPULoad == NULL) {
+		return;
+	}
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+	
+	/* Disable interrupts, they are executed after sleep */
+	__disable_irq();
+	
+	/* Task may be made ready by interrupt since scheduler was suspended */
+	if (eTaskConfirmSleepModeStatus() != eAbortSleep) {
+		/* Sleep till next FreeRTOS timeout or software timer, missed ticks are given in SysTick */
+		TM_CPULOAD_GoToSleepModeTickless(RTOS_CPULoad, ExpectedIdleTime);
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+#endif
+
+#if RTOS_USE_MONITOR
+TM_RTOS_Result_t TM_RTOS_MonitorAddQueue(QueueHandle_t Queue, const char* Name) {
+	TM_RTOS_Result_t result = TM_RTOS_Result_Error;
+	uint8_t i;
+	
+	/* Check queue */
+	if (Queue == NULL) {
+		return TM_RTOS_Result_Error;
+	}
+	
+#if !defined(STM32F0xx)
+	/* Enable DWT cycle counter for timestamps */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	
+	/* Trace hooks use list from critical sections */
+	taskENTER_CRITICAL();
+	
+	/* Find free entry */
+	if (TM_RTOS_INT_FindQueue(Queue) == NULL) {
+		for (i = 0; i < RTOS_MONITOR_MAX_QUEUES; i++) {
+			if (RTOS_Queues[i].Queue == NULL) {
+				memset(&RTOS_Queues[i], 0, sizeof(RTOS_Queues[i]));
+				RTOS_Queues[i].Name = Name;
+				
+				/* Set queue last, hooks search for it */
+				RTOS_Queues[i].Queue = Queue;
+				result = TM_RTOS_Result_Ok;
+				break;
+			}
+		}
+	} else {
+		/* Already monitored */
+		result = TM_RTOS_Result_Ok;
+	}
+	
+	taskEXIT_CRITICAL();
+	
+	/* Return result */
+	return result;
+}
+
+void TM_RTOS_MonitorResetQueues(void) {
+	uint8_t i;
+	
+	/* Reset statistics, items in queues stay tracked */
+	taskENTER_CRITICAL();
+	for (i = 0; i < RTOS_MONITOR_MAX_QUEUES; i++) {
+		RTOS_Queues[i].HighWater = RTOS_Queues[i].Count + RTOS_Queues[i].Untracked;
+		RTOS_Queues[i].Samples = 0;
+		RTOS_Queues[i].TotalLatency = 0;
+		RTOS_Queues[i].MaxLatency = 0;
+	}
+	taskEXIT_CRITICAL();
+}
+
+void TM_RTOS_MonitorDump(void (*OutputFunc)(char *)) {
+	static const char States[] = "XRBSD";
+	TM_RTOS_INT_Queue_t copy;
+	char str[96];
+	UBaseType_t count, i;
+	
+	/* Get status of all tasks, stack high-water mark is calculated for each task */
+	count = uxTaskGetSystemState(RTOS_Tasks, RTOS_MONITOR_MAX_TASKS, NULL);
+	
+	/* Output tasks, stack is in words */
+	OutputFunc("Task             Prio State MinFreeStack\n");
+	if (count == 0) {
+		OutputFunc("Too many tasks, increase RTOS_MONITOR_MAX_TASKS\n");
+	}
+	for (i = 0; i < count; i++) {
+		sprintf(str, "%-16.16s %4lu %5c %12lu\n",
+			RTOS_Tasks[i].pcTaskName,
+			(unsigned long)RTOS_Tasks[i].uxCurrentPriority,
+			(uint32_t)RTOS_Tasks[i].eCurrentState < 5 ? States[RTOS_Tasks[i].eCurrentState] : '?',
+			(unsigned long)RTOS_Tasks[i].usStackHighWaterMark
+		);
+		OutputFunc(str);
+	}
+	
+	/* Output heap */
+#if RTOS_MONITOR_MIN_EVER_HEAP
+	sprintf(str, "Heap free %lu, min ever free %lu bytes\n", (unsigned long)xPortGetFreeHeapSize(), (unsigned long)xPortGetMinimumEverFreeHeapSize());
+#else
+	sprintf(str, "Heap free %lu bytes\n", (unsigned long)xPortGetFreeHeapSize());
+#endif
+	OutputFunc(str);
+	
+	/* Output queues, latency in microseconds */
+	OutputFunc("Queue          Items HighWater   Samples    AvgUs    MaxUs\n");
+	for (i = 0; i < RTOS_MONITOR_MAX_QUEUES; i++) {
+		/* Get consistent copy of counters */
+		taskENTER_CRITICAL();
+		copy = RTOS_Queues[i];
+		taskEXIT_CRITICAL();
+		
+		/* Check entry */
+		if (copy.Queue == NULL) {
+			continue;
+		}
+		
+		sprintf(str, "%-12.12s %7lu %9lu %9lu %8lu %8lu\n",
+			copy.Name ? copy.Name : "",
+			(unsigned long)(copy.Count + copy.Untracked),
+			(unsigned long)copy.HighWater,
+			(unsigned long)copy.Samples,
+			(unsigned long)(copy.Samples ? RTOS_MONITOR_TIME_TO_US((uint32_t)(copy.TotalLatency / copy.Samples)) : 0),
+			(unsigned long)RTOS_MONITOR_TIME_TO_US(copy.MaxLatency)
+		);
+		OutputFunc(str);
+	}
+}
+
+void TM_RTOS_MonitorQueueSend(void* Queue) {
+	TM_RTOS_INT_Queue_t* q = TM_RTOS_INT_FindQueue(Queue);
+	
+	/* Check if queue is monitored */
+	if (q == NULL) {
+		return;
+	}
+	
+	/* Timestamp item, items after first untracked item stay untracked to keep FIFO order */
+	if (q->Untracked == 0 && q->Count < RTOS_MONITOR_QUEUE_DEPTH) {
+		q->Stamps[q->In] = RTOS_MONITOR_GET_TIME();
+		if (++q->In >= RTOS_MONITOR_QUEUE_DEPTH) {
+			q->In = 0;
+		}
+		q->Count++;
+	} else {
+		q->Untracked++;
+	}
+	
+	/* Save max number of items */
+	if ((q->Count + q->Untracked) > q->HighWater) {
+		q->HighWater = q->Count + q->Untracked;
+	}
+}
+
+void TM_RTOS_MonitorQueueReceive(void* Queue) {
+	TM_RTOS_INT_Queue_t* q = TM_RTOS_INT_FindQueue(Queue);
+	uint32_t latency;
+	
+	/* Check if queue is monitored */
+	if (q == NULL) {
+		return;
+	}
+	
+	/* Oldest item is always tracked one when there is any */
+	if (q->Count) {
+		latency = RTOS_MONITOR_GET_TIME() - q->Stamps[q->Out];
+		if (++q->Out >= RTOS_MONITOR_QUEUE_DEPTH) {
+			q->Out = 0;
+		}
+		q->Count--;
+		
+		/* Update statistics */
+		q->Samples++;
+		q->TotalLatency += latency;
+		if (latency > q->MaxLatency) {
+			q->MaxLatency = latency;
+		}
+	} else if (q->Untracked) {
+		q->Untracked--;
+	}
+}
+#endif
+
+/* Private functions */
+static TM_RTOS_INT_Bus_t* TM_RTOS_INT_FindBus(void* Bus) {
+	uint8_t i;
+	
+	/* Find bus in list */
+	for (i = 0; i < RTOS_MAX_BUSES; i++) {
+		if (RTOS_Buses[i].Bus == Bus) {
+			return &RTOS_Buses[i];
+		}
+	}
+	
+	/* Not found */
+	return NULL;
+}
+
+static TM_RTOS_INT_Bus_t* TM_RTOS_INT_GetBus(void* Bus) {
+	TM_RTOS_INT_Bus_t* bus;
+	uint8_t i;
+	
+	/* Check if bus already exists */
+	if ((bus = TM_RTOS_INT_FindBus(Bus)) != NULL) {
+		return bus;
+	}
+	
+	/* Stop other tasks, mutex create can not be done in critical section */
+	vTaskSuspendAll();
+	
+	/* Check again, other task could create it */
+	if ((bus = TM_RTOS_INT_FindBus(Bus)) == NULL) {
+		for (i = 0; i < RTOS_MAX_BUSES; i++) {
+			if (RTOS_Buses[i].Bus == NULL) {
+				/* Create mutex */
+				RTOS_Buses[i].Mutex = xSemaphoreCreateRecursiveMutex();
+				if (RTOS_Buses[i].Mutex != NULL) {
+					/* Set bus last, interrupts can search for it */
+					RTOS_Buses[i].Bus = Bus;
+					bus = &RTOS_Buses[i];
+				}
+				break;
+			}
+		}
+	}
+	
+	/* Start other tasks */
+	xTaskResumeAll();
+	
+	/* Return bus, NULL when list is full or there is no memory */
+	return bus;
+}
+
+#if RTOS_USE_MONITOR
+static TM_RTOS_INT_Queue_t* TM_RTOS_INT_FindQueue(void* Queue) {
+	uint8_t i;
+	
+	/* Find queue in list */
+	for (i = 0; i < RTOS_MONITOR_MAX_QUEUES; i++) {
+		if (RTOS_Queues[i].Queue == Queue) {
+			return &RTOS_Queues[i];
+		}
+	}
+	
+	/* Not monitored */
+	return NULL;
+}
+#endif
+
+#if RTOS_USE_I2C
+static void TM_RTOS_INT_I2CCallback(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_RTOS_INT_Bus_t* bus = TM_RTOS_INT_FindBus(I2Cx);
+	
+	/* Wake up task */
+	if (bus != NULL) {
+		TM_RTOS_Signal(&bus->Wait, (uint32_t)Param, result == TM_I2C_Result_Ok ? TM_RTOS_Result_Ok : TM_RTOS_Result_Error);
+	}
+}
+#endif
+
+#if RTOS_USE_SPI_DMA
+static void TM_RTOS_INT_SPICallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param) {
+	TM_RTOS_INT_Bus_t* bus = TM_RTOS_INT_FindBus(SPIx);
+	
+	/* Wake up task */
+	if (bus != NULL) {
+		TM_RTOS_Signal(&bus->Wait, (uint32_t)Param, status ? TM_RTOS_Result_Ok : TM_RTOS_Result_Error);
+	}
+}
+#endif
+
+#if RTOS_USE_USART_DMA
+static void TM_RTOS_INT_USARTCallback(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, void* Param) {
+	TM_RTOS_INT_Bus_t* bus = TM_RTOS_INT_FindBus(USARTx);
+	
+	/* Wake up task */
+	if (bus != NULL) {
+		TM_RTOS_Signal(&bus->Wait, (uint32_t)Param, TM_RTOS_Result_Ok);
+	}
+}
+#endif
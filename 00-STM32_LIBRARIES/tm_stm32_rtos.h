@@ -0,0 +1,574 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.2
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   FreeRTOS blocking transfers for TM I2C, SPI DMA and USART DMA libraries
+ *
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_RTOS_H
+#define TM_RTOS_H 120
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_RTOS
+ * @brief    FreeRTOS blocking transfers for TM I2C, SPI DMA and USART DMA libraries
+ * @{
+ *
+ * Transfer functions in TM libraries wait for end of transfer in loop, when used from FreeRTOS task,
+ * task uses all its CPU time only to wait.
+ *
+ * Library uses queued (interrupt driven) transfers of TM libraries instead. Task which starts transfer
+ * is blocked on task notification and completion interrupt wakes it up, so other tasks can run in the meantime
+ * or CPU goes to sleep from idle task.
+ *
+ * Each bus (I2Cx, SPIx or USARTx) has its own recursive mutex, so only one task uses bus at a time.
+ * When more transfers must be done together (for example read-modify-write on device), lock bus around them:
+ *
+\code
+//Other tasks can not use I2C1 between these 2 transfers
+TM_RTOS_Lock(I2C1, portMAX_DELAY);
+TM_RTOS_I2C_ReadMulti(I2C1, 0xD0, 0x6B, &reg, 1, 10);
+reg |= 0x01;
+TM_RTOS_I2C_WriteMulti(I2C1, 0xD0, 0x6B, &reg, 1, 10);
+TM_RTOS_Unlock(I2C1);
+\endcode
+ *
+ * Functions below can be used for your own interrupt driven code:
+ *
+\code
+//Task
+TM_RTOS_Prepare(&Wait);
+StartMyTransfer();
+result = TM_RTOS_Block(&Wait, 100);
+
+//Interrupt when transfer is done
+TM_RTOS_Signal(&Wait, TM_RTOS_Wait_Token(&Wait), TM_RTOS_Result_Ok);
+\endcode
+ *
+ * \par Configuration
+ *
+ * Enable parts of library you need in defines.h file. Queue of selected library must be enabled too:
+ *
+\code
+//Blocking I2C functions, I2C_QUEUE_SIZE must be greater than 0
+#define RTOS_USE_I2C          1
+
+//Blocking SPI DMA functions, SPI_DMA_QUEUE_SIZE must be greater than 0
+#define RTOS_USE_SPI_DMA      1
+
+//Blocking USART DMA functions
+#define RTOS_USE_USART_DMA    1
+
+//Max number of buses with mutex
+#define RTOS_MAX_BUSES        8
+\endcode
+ *
+ * @note  Interrupts which finish transfers call FreeRTOS API. Their priority must be lower (numerically greater or equal)
+ *        than configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, set DMA1_NVIC_PREEMPTION_PRIORITY, DMA2_NVIC_PREEMPTION_PRIORITY
+ *        and I2C_NVIC_PRIORITY in defines.h file.
+ *
+ * @note  Task notification value of calling task is used by library during blocking call.
+ *
+ * FreeRTOSConfig.h must have INCLUDE_xTaskGetCurrentTaskHandle and configUSE_RECURSIVE_MUTEXES set to 1.
+ *
+ * \par Tickless idle
+ *
+ * With @ref RTOS_USE_TICKLESS, idle task sleeps without SysTick interrupts until next FreeRTOS timeout,
+ * next @ref TM_DELAY software timer (including @ref TM_BUTTON port scanning) or any other interrupt.
+ * FreeRTOS tick is driven by @ref TM_DELAY library and missed ticks are given to FreeRTOS after wakeup.
+ * Sleep is done with @ref TM_CPULOAD library, so CPU load is still measured.
+ *
+\code
+//defines.h
+#define RTOS_USE_TICKLESS     1
+#define DELAY_TICKLESS        1
+#define DELAY_RTOS            1
+#define CPULOAD_TICKLESS      1
+
+//FreeRTOSConfig.h, inside block with SystemCoreClock declaration
+extern void TM_RTOS_SuppressTicksAndSleep(uint32_t ExpectedIdleTime);
+
+//FreeRTOSConfig.h, FreeRTOS port must not use SysTick
+#define configUSE_TICKLESS_IDLE                 2
+#define portSUPPRESS_TICKS_AND_SLEEP(x)         TM_RTOS_SuppressTicksAndSleep(x)
+
+//main.c, before scheduler is started
+TM_CPULOAD_Init(&CPU_LOAD);
+TM_DELAY_Init();
+TM_RTOS_TicklessInit(&CPU_LOAD);
+\endcode
+ *
+ * @note  SysTick_Handler must call only HAL_IncTick() and configTICK_RATE_HZ must be 1000
+ *
+ * \par Runtime monitor
+ *
+ * With @ref RTOS_USE_MONITOR, @ref TM_RTOS_MonitorDump prints stack high-water mark of each task,
+ * current and minimum ever free heap and enqueue-to-dequeue latency of registered queues.
+ * Use it to shrink task stacks, heap and queue lengths to what application really needs.
+ *
+ * Queue latency is measured with FreeRTOS trace hooks. Each item put to registered queue gets timestamp
+ * and latency is calculated when item is received. Only @ref RTOS_MONITOR_QUEUE_DEPTH items per queue are timestamped,
+ * items above are counted as untracked. Items sent to front of queue make measurement approximate.
+ *
+\code
+//defines.h
+#define RTOS_USE_MONITOR      1
+
+//FreeRTOSConfig.h, inside block with SystemCoreClock declaration
+extern void TM_RTOS_MonitorQueueSend(void* Queue);
+extern void TM_RTOS_MonitorQueueReceive(void* Queue);
+
+//FreeRTOSConfig.h, trace hooks
+#define traceQUEUE_SEND(pxQueue)                TM_RTOS_MonitorQueueSend(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)       TM_RTOS_MonitorQueueSend(pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)             TM_RTOS_MonitorQueueReceive(pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)    TM_RTOS_MonitorQueueReceive(pxQueue)
+
+//Register queue after it is created
+Queue = xQueueCreate(16, sizeof(uint32_t));
+TM_RTOS_MonitorAddQueue(Queue, "Sensor");
+
+//Print report over USB CDC when host sends 'm'
+void CDC_Output(char* str) {
+	TM_USBD_CDC_Puts(TM_USB_FS, str);
+}
+
+if (TM_USBD_CDC_Getc(TM_USB_FS, &ch) && ch == 'm') {
+	TM_RTOS_MonitorDump(CDC_Output);
+}
+\endcode
+ *
+ * @note  FreeRTOSConfig.h must have configUSE_TRACE_FACILITY set to 1.
+ *        Minimum ever free heap is available with heap_4 and heap_5 only, set @ref RTOS_MONITOR_MIN_EVER_HEAP to 0 for other heaps
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added tickless idle with TM DELAY and TM CPULOAD libraries
+  
+ Version 1.2
+  - October 14, 2026
+  - Added runtime monitor for task stacks, heap and queue latency
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - FreeRTOS
+ - TM I2C       (only when RTOS_USE_I2C)
+ - TM SPI DMA   (only when RTOS_USE_SPI_DMA)
+ - TM USART DMA (only when RTOS_USE_USART_DMA)
+ - TM DELAY     (only when RTOS_USE_TICKLESS)
+ - TM CPULOAD   (only when RTOS_USE_TICKLESS)
+ - STDIO        (only when RTOS_USE_MONITOR)
+ - STRING       (only when RTOS_USE_MONITOR)
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/**
+ * @defgroup TM_RTOS_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Blocking I2C functions */
+#ifndef RTOS_USE_I2C
+#define RTOS_USE_I2C          0
+#endif
+
+/* Blocking SPI DMA functions */
+#ifndef RTOS_USE_SPI_DMA
+#define RTOS_USE_SPI_DMA      0
+#endif
+
+/* Blocking USART DMA functions */
+#ifndef RTOS_USE_USART_DMA
+#define RTOS_USE_USART_DMA    0
+#endif
+
+/* Tickless idle with TM DELAY and TM CPULOAD */
+#ifndef RTOS_USE_TICKLESS
+#define RTOS_USE_TICKLESS     0
+#endif
+
+/* Max number of buses with mutex */
+#ifndef RTOS_MAX_BUSES
+#define RTOS_MAX_BUSES        8
+#endif
+
+/* Runtime monitor for stacks, heap and queues */
+#ifndef RTOS_USE_MONITOR
+#define RTOS_USE_MONITOR      0
+#endif
+
+/* Max number of tasks in monitor report */
+#ifndef RTOS_MONITOR_MAX_TASKS
+#define RTOS_MONITOR_MAX_TASKS      16
+#endif
+
+/* Max number of queues with latency measurement */
+#ifndef RTOS_MONITOR_MAX_QUEUES
+#define RTOS_MONITOR_MAX_QUEUES     4
+#endif
+
+/* Number of timestamped items for each queue */
+#ifndef RTOS_MONITOR_QUEUE_DEPTH
+#define RTOS_MONITOR_QUEUE_DEPTH    16
+#endif
+
+/* Minimum ever free heap, available with heap_4 and heap_5 */
+#ifndef RTOS_MONITOR_MIN_EVER_HEAP
+#define RTOS_MONITOR_MIN_EVER_HEAP  1
+#endif
+
+/* Time for queue latency and conversion to microseconds, DWT cycle counter or HAL tick on STM32F0xx */
+#ifndef RTOS_MONITOR_GET_TIME
+#if defined(STM32F0xx)
+#define RTOS_MONITOR_GET_TIME()       HAL_GetTick()
+#define RTOS_MONITOR_TIME_TO_US(x)    ((x) * 1000)
+#else
+#define RTOS_MONITOR_GET_TIME()       (DWT->CYCCNT)
+#define RTOS_MONITOR_TIME_TO_US(x)    ((x) / (SystemCoreClock / 1000000))
+#endif
+#endif
+
+#if RTOS_USE_I2C
+#include "tm_stm32_i2c.h"
+#endif
+#if RTOS_USE_SPI_DMA
+#include "tm_stm32_spi_dma.h"
+#endif
+#if RTOS_USE_USART_DMA
+#include "tm_stm32_usart_dma.h"
+#endif
+#if RTOS_USE_TICKLESS
+#include "tm_stm32_delay.h"
+#include "tm_stm32_cpu_load.h"
+#endif
+#if RTOS_USE_MONITOR
+#include "queue.h"
+#include "stdio.h"
+#include "string.h"
+#endif
+
+/* Check FreeRTOS configuration */
+#if !INCLUDE_xTaskGetCurrentTaskHandle || !configUSE_RECURSIVE_MUTEXES
+#error "TM RTOS needs INCLUDE_xTaskGetCurrentTaskHandle and configUSE_RECURSIVE_MUTEXES set to 1 in FreeRTOSConfig.h file!"
+#endif
+
+/* Check queues */
+#if RTOS_USE_I2C && I2C_QUEUE_SIZE == 0
+#error "TM RTOS needs I2C_QUEUE_SIZE greater than 0 for I2C functions!"
+#endif
+#if RTOS_USE_SPI_DMA && SPI_DMA_QUEUE_SIZE == 0
+#error "TM RTOS needs SPI_DMA_QUEUE_SIZE greater than 0 for SPI DMA functions!"
+#endif
+
+/* Check tickless idle configuration */
+#if RTOS_USE_TICKLESS && configUSE_TICKLESS_IDLE != 2
+#error "TM RTOS needs configUSE_TICKLESS_IDLE set to 2 in FreeRTOSConfig.h file for tickless idle!"
+#endif
+#if RTOS_USE_TICKLESS && (!DELAY_TICKLESS || !DELAY_RTOS || !CPULOAD_TICKLESS)
+#error "TM RTOS needs DELAY_TICKLESS, DELAY_RTOS and CPULOAD_TICKLESS set to 1 for tickless idle!"
+#endif
+
+/* Check monitor configuration */
+#if RTOS_USE_MONITOR && !configUSE_TRACE_FACILITY
+#error "TM RTOS needs configUSE_TRACE_FACILITY set to 1 in FreeRTOSConfig.h file for runtime monitor!"
+#endif
+#if RTOS_USE_MONITOR && (RTOS_MONITOR_QUEUE_DEPTH < 1 || RTOS_MONITOR_QUEUE_DEPTH > 255)
+#error "RTOS_MONITOR_QUEUE_DEPTH must be between 1 and 255!"
+#endif
+
+/**
+ * @brief  Gets token of current transfer for @ref TM_RTOS_Signal() function
+ * @param  *Wait: Pointer to @ref TM_RTOS_Wait_t structure
+ * @retval Transfer token
+ */
+#define TM_RTOS_Wait_Token(Wait)    ((Wait)->Token)
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_RTOS_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_RTOS_Result_Ok = 0x00, /*!< Transfer finished successfully */
+	TM_RTOS_Result_Error,     /*!< Transfer finished with error or could not be started */
+	TM_RTOS_Result_Timeout,   /*!< Transfer did not finish in time, it can still finish later */
+	TM_RTOS_Result_Busy       /*!< Bus is locked by other task */
+} TM_RTOS_Result_t;
+
+/**
+ * @brief  Wait structure for one blocking transfer
+ * @note   Structure must stay valid after timeout, because transfer can finish later. Do not put it on stack
+ */
+typedef struct {
+	TaskHandle_t Task;                  /*!< Task waiting for transfer, NULL when none */
+	volatile uint32_t Token;            /*!< Token of current transfer, old transfers are ignored after timeout */
+	volatile uint8_t Pending;           /*!< Set to 1 when transfer is in progress */
+	volatile TM_RTOS_Result_t Result;   /*!< Transfer result */
+} TM_RTOS_Wait_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_RTOS_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Locks bus for current task
+ * @note   Mutex is recursive, same task can lock bus more times and must unlock it the same number of times
+ * @param  *Bus: Pointer to peripheral used as bus, for example I2C1, SPI2 or USART1
+ * @param  Timeout: Max time to wait for bus in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_Lock(void* Bus, uint32_t Timeout);
+
+/**
+ * @brief  Unlocks bus locked with @ref TM_RTOS_Lock()
+ * @param  *Bus: Pointer to peripheral used as bus
+ * @retval None
+ */
+void TM_RTOS_Unlock(void* Bus);
+
+/**
+ * @brief  Prepares wait structure for new transfer for current task
+ * @note   Must be called before transfer is started
+ * @param  *Wait: Pointer to @ref TM_RTOS_Wait_t structure
+ * @retval Token for new transfer, pass it to @ref TM_RTOS_Signal() function
+ */
+uint32_t TM_RTOS_Prepare(TM_RTOS_Wait_t* Wait);
+
+/**
+ * @brief  Blocks current task until transfer is signaled or timeout occurs
+ * @param  *Wait: Pointer to @ref TM_RTOS_Wait_t structure
+ * @param  Timeout: Max time to wait in units of RTOS ticks
+ * @retval Transfer result, member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_Block(TM_RTOS_Wait_t* Wait, uint32_t Timeout);
+
+/**
+ * @brief  Signals end of transfer and wakes up waiting task
+ * @note   Can be called from interrupt or from task
+ * @param  *Wait: Pointer to @ref TM_RTOS_Wait_t structure
+ * @param  Token: Transfer token from @ref TM_RTOS_Prepare(). Signal is ignored when it does not match current transfer
+ * @param  Result: Transfer result
+ * @retval None
+ */
+void TM_RTOS_Signal(TM_RTOS_Wait_t* Wait, uint32_t Token, TM_RTOS_Result_t Result);
+
+#if RTOS_USE_I2C || defined(DOXYGEN)
+/**
+ * @brief  Reads multiple bytes from device register, task is blocked until transaction is finished
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  register_address: Register address from where read will be done
+ * @param  *data: Pointer to data array to store data from slave
+ * @param  count: Number of elements to read from device
+ * @param  Timeout: Max time to wait for bus and transaction in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_I2C_ReadMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t register_address, uint8_t* data, uint16_t count, uint32_t Timeout);
+
+/**
+ * @brief  Writes multiple bytes to device register, task is blocked until transaction is finished
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  register_address: Register address where write will be done
+ * @param  *data: Pointer to data to write
+ * @param  count: Number of elements to write
+ * @param  Timeout: Max time to wait for bus and transaction in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_I2C_WriteMulti(I2C_TypeDef* I2Cx, uint8_t device_address, uint16_t register_address, uint8_t* data, uint16_t count, uint32_t Timeout);
+
+/**
+ * @brief  Reads multiple bytes from device without register address, task is blocked until transaction is finished
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  *data: Pointer to data array to store data from slave
+ * @param  count: Number of elements to read from device
+ * @param  Timeout: Max time to wait for bus and transaction in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_I2C_ReadMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, uint32_t Timeout);
+
+/**
+ * @brief  Writes multiple bytes to device without register address, task is blocked until transaction is finished
+ * @param  *I2Cx: Pointer to I2Cx peripheral to be used in communication
+ * @param  device_address: 7-bit, left aligned device address used for communication
+ * @param  *data: Pointer to data to write
+ * @param  count: Number of elements to write
+ * @param  Timeout: Max time to wait for bus and transaction in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_I2C_WriteMultiNoRegister(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, uint32_t Timeout);
+#endif
+
+#if RTOS_USE_SPI_DMA || defined(DOXYGEN)
+/**
+ * @brief  Exchanges data over SPI with DMA, task is blocked until job is finished
+ * @note   Callback and Param members of job are not used, library sets its own
+ * @param  *SPIx: Pointer to SPIx peripheral to be used
+ * @param  *Job: Pointer to @ref TM_SPI_DMA_Job_t job with chip select, mode, prescaler and buffers
+ * @param  Timeout: Max time to wait for bus and job in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_SPI_Transmit(SPI_TypeDef* SPIx, const TM_SPI_DMA_Job_t* Job, uint32_t Timeout);
+#endif
+
+#if RTOS_USE_USART_DMA || defined(DOXYGEN)
+/**
+ * @brief  Sends data over USART with DMA, task is blocked until last byte is sent to USART
+ * @param  *USARTx: Pointer to USARTx peripheral to be used
+ * @param  *DataArray: Pointer to data to send
+ * @param  count: Number of bytes to send
+ * @param  Timeout: Max time to wait for bus and transfer in units of RTOS ticks
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_USART_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, uint32_t Timeout);
+#endif
+
+#if RTOS_USE_MONITOR || defined(DOXYGEN)
+/**
+ * @brief  Adds queue to runtime monitor for latency measurement
+ * @note   Semaphores and mutexes can be added too, latency is then time from give to take
+ * @param  Queue: Queue handle
+ * @param  *Name: Queue name in report, string must stay valid
+ * @retval Member of @ref TM_RTOS_Result_t enumeration
+ */
+TM_RTOS_Result_t TM_RTOS_MonitorAddQueue(QueueHandle_t Queue, const char* Name);
+
+/**
+ * @brief  Resets latency statistics of all registered queues
+ * @param  None
+ * @retval None
+ */
+void TM_RTOS_MonitorResetQueues(void);
+
+/**
+ * @brief  Prints stack high-water marks of all tasks, heap usage and queue latencies
+ * @note   Must be called from one task only, report is made in static memory
+ * @param  *OutputFunc: Pointer to function which outputs string
+ * @retval None
+ */
+void TM_RTOS_MonitorDump(void (*OutputFunc)(char *));
+
+/**
+ * @brief  Queue send trace hook, set it to traceQUEUE_SEND and traceQUEUE_SEND_FROM_ISR in FreeRTOSConfig.h file
+ * @note   Called by FreeRTOS inside critical section
+ * @param  *Queue: Queue handle
+ * @retval None
+ */
+void TM_RTOS_MonitorQueueSend(void* Queue);
+
+/**
+ * @brief  Queue receive trace hook, set it to traceQUEUE_RECEIVE and traceQUEUE_RECEIVE_FROM_ISR in FreeRTOSConfig.h file
+ * @note   Called by FreeRTOS inside critical section
+ * @param  *Queue: Queue handle
+ * @retval None
+ */
+void TM_RTOS_MonitorQueueReceive(void* Queue);
+#endif
+
+#if RTOS_USE_TICKLESS || defined(DOXYGEN)
+/**
+ * @brief  Sets CPU load structure used for sleep in idle task
+ * @note   Must be called before scheduler is started, idle task does not sleep before
+ * @param  *CPU_Load: Pointer to initialized @ref TM_CPULOAD_t structure
+ * @retval None
+ */
+void TM_RTOS_TicklessInit(TM_CPULOAD_t* CPU_Load);
+
+/**
+ * @brief  Sleeps in idle task without SysTick interrupts, used for portSUPPRESS_TICKS_AND_SLEEP in FreeRTOSConfig.h
+ * @note   Called by FreeRTOS with scheduler suspended
+ * @param  ExpectedIdleTime: Number of ticks till next task is unblocked
+ * @retval None
+ */
+void TM_RTOS_SuppressTicksAndSleep(uint32_t ExpectedIdleTime);
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,6 +18,43 @@
  */
 #include "tm_stm32_sdram.h"
 
+#if SDRAM_USE_RTOS_HEAP
+#include "FreeRTOS.h"
+#endif
+
+/* Section boundaries from linker */
+#if SDRAM_USE_SECTION
+#if defined(__CC_ARM)
+extern uint32_t Image$$RW_SDRAM$$ZI$$Base[];
+extern uint32_t Image$$RW_SDRAM$$ZI$$Length[];
+#define SDRAM_SECTION_START         ((uint32_t)Image$$RW_SDRAM$$ZI$$Base)
+#define SDRAM_SECTION_END           ((uint32_t)Image$$RW_SDRAM$$ZI$$Base + (uint32_t)Image$$RW_SDRAM$$ZI$$Length)
+#else
+extern uint32_t _ssdram[];
+extern uint32_t _esdram[];
+#define SDRAM_SECTION_START         ((uint32_t)_ssdram)
+#define SDRAM_SECTION_END           ((uint32_t)_esdram)
+#endif
+#define SDRAM_HEAP_START            SDRAM_SECTION_END
+#else
+#define SDRAM_HEAP_START            (SDRAM_START_ADR + SDRAM_HEAP_OFFSET)
+#endif
+#define SDRAM_HEAP_END              (SDRAM_START_ADR + SDRAM_MEMORY_SIZE)
+
+/* Heap block header, takes one alignment unit before user memory */
+typedef struct _TM_SDRAM_Block_t {
+	uint32_t Size;                   /* Block size including header */
+	struct _TM_SDRAM_Block_t* Next;  /* Next free block, address ordered */
+} TM_SDRAM_Block_t;
+
+#define SDRAM_HEAP_ALIGN_UP(x)      (((x) + SDRAM_HEAP_ALIGN - 1) & ~(uint32_t)(SDRAM_HEAP_ALIGN - 1))
+#define SDRAM_HEAP_HEADER           SDRAM_HEAP_ALIGN_UP(sizeof(TM_SDRAM_Block_t))
+
+/* Heap state */
+static uint8_t SDRAM_Initialized = 0;
+static uint32_t SDRAM_HeapTop = 0;
+static TM_SDRAM_Block_t* SDRAM_FreeList = NULL;
+
 /* Internal functions */
 static void TM_SDRAM_InitPins(void);
 
@@ -25,12 +62,10 @@ uint8_t TM_SDRAM_Init(void) {
 	SDRAM_HandleTypeDef SDRAMHandle;
 	FMC_SDRAM_TimingTypeDef Timing;
 	FMC_SDRAM_CommandTypeDef Command;
-
-	volatile uint32_t timeout = SDRAM_TIMEOUT;
-	static uint8_t initialized = 0;
+	volatile uint32_t timeout;
 	
 	/* Already initialized */
-	if (initialized) {
+	if (SDRAM_Initialized) {
 		return 1;
 	}
 	
@@ -83,8 +118,8 @@ uint8_t TM_SDRAM_Init(void) {
 	/* Send command */
 	HAL_SDRAM_SendCommand(&SDRAMHandle, &Command, SDRAM_TIMEOUT);
 	
-	/* Little delay */
-	timeout = SDRAM_TIMEOUT * 0xF;
+	/* Power-up delay, about 4 cycles per loop */
+	timeout = SDRAM_POWERUP_DELAY * (SystemCoreClock / 4000000);
 	while (timeout--);
 	
 	/* Configure a PALL (precharge all) command */ 
@@ -119,24 +154,29 @@ uint8_t TM_SDRAM_Init(void) {
 	/* Set the device refresh rate */
 	HAL_SDRAM_ProgramRefreshRate(&SDRAMHandle, SDRAM_REFRESH_COUNT); 
 	
-	/* Little delay */
-	timeout = SDRAM_TIMEOUT * 0xF;
-	while (timeout--);
-	
 	/* Check if everything goes right */
 	/* Write 0x45 at location 0x50 and check if result is the same on read operation */
 	TM_SDRAM_Write8(0x50, 0x45);
 	
 	/* Read and check */
 	if (TM_SDRAM_Read8(0x50) == 0x45) {
+#if SDRAM_USE_SECTION
+		/* Variables in SDRAM section are zero */
+		memset((void *)SDRAM_SECTION_START, 0, SDRAM_SECTION_END - SDRAM_SECTION_START);
+#endif
+		
+		/* Empty heap starts after section */
+		SDRAM_HeapTop = SDRAM_HEAP_ALIGN_UP(SDRAM_HEAP_START);
+		SDRAM_FreeList = NULL;
+		
 		/* Initialized OK */
-		initialized = 1;
+		SDRAM_Initialized = 1;
 		/* Initialized OK */
 		return 1;
 	}
 	
 	/* Not initialized OK */
-	initialized = 0;
+	SDRAM_Initialized = 0;
 	
 	/* Not ok */
 	return 0;
@@ -151,6 +191,167 @@ __weak uint8_t TM_SDRAM_InitCustomPinsCallback(uint16_t AlternateFunction) {
 	return 0;
 }
 
+void* TM_SDRAM_Malloc(size_t size) {
+	TM_SDRAM_Block_t *blk, *prev, *rest;
+	uint32_t total, primask;
+	
+	/* Check SDRAM and size */
+	if (!SDRAM_Initialized || size == 0 || size > SDRAM_MEMORY_SIZE) {
+		return NULL;
+	}
+	
+	/* Block size with header */
+	total = SDRAM_HEAP_ALIGN_UP(size) + SDRAM_HEAP_HEADER;
+	
+	/* Disable interrupts */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	
+	/* First fit in freed blocks */
+	for (prev = NULL, blk = SDRAM_FreeList; blk != NULL; prev = blk, blk = blk->Next) {
+		if (blk->Size >= total) {
+			break;
+		}
+	}
+	
+	if (blk != NULL) {
+		/* Split block when rest is usable */
+		if ((blk->Size - total) >= (SDRAM_HEAP_HEADER + SDRAM_HEAP_ALIGN)) {
+			rest = (TM_SDRAM_Block_t *)((uint8_t *)blk + total);
+			rest->Size = blk->Size - total;
+			rest->Next = blk->Next;
+			blk->Size = total;
+			blk->Next = rest;
+		}
+		
+		/* Remove from free list */
+		if (prev != NULL) {
+			prev->Next = blk->Next;
+		} else {
+			SDRAM_FreeList = blk->Next;
+		}
+	} else if ((SDRAM_HEAP_END - SDRAM_HeapTop) >= total) {
+		/* Take from top */
+		blk = (TM_SDRAM_Block_t *)SDRAM_HeapTop;
+		blk->Size = total;
+		SDRAM_HeapTop += total;
+	}
+	
+	/* Enable interrupts back */
+	__set_PRIMASK(primask);
+	
+	/* Return user memory */
+	return blk != NULL ? (uint8_t *)blk + SDRAM_HEAP_HEADER : NULL;
+}
+
+void TM_SDRAM_Free(void* ptr) {
+	TM_SDRAM_Block_t *blk, *prev, *before, *next;
+	uint32_t primask;
+	
+	/* Check pointer */
+	if (ptr == NULL || (uint32_t)ptr < (SDRAM_HEAP_START + SDRAM_HEAP_HEADER) || (uint32_t)ptr >= SDRAM_HeapTop) {
+		return;
+	}
+	blk = (TM_SDRAM_Block_t *)((uint8_t *)ptr - SDRAM_HEAP_HEADER);
+	
+	/* Disable interrupts */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Find position in address ordered list, before is block in front of prev */
+	before = NULL;
+	for (prev = NULL, next = SDRAM_FreeList; next != NULL && next < blk; before = prev, prev = next, next = next->Next);
+	
+	/* Merge with next block */
+	if (next != NULL && ((uint8_t *)blk + blk->Size) == (uint8_t *)next) {
+		blk->Size += next->Size;
+		next = next->Next;
+	}
+	blk->Next = next;
+	
+	/* Merge with previous block or link after it */
+	if (prev != NULL && ((uint8_t *)prev + prev->Size) == (uint8_t *)blk) {
+		prev->Size += blk->Size;
+		prev->Next = blk->Next;
+		blk = prev;
+		prev = before;
+	} else if (prev != NULL) {
+		prev->Next = blk;
+	} else {
+		SDRAM_FreeList = blk;
+	}
+	
+	/* Last free block touches top, return it to free space */
+	if (blk->Next == NULL && ((uint32_t)blk + blk->Size) == SDRAM_HeapTop) {
+		SDRAM_HeapTop = (uint32_t)blk;
+		if (prev != NULL) {
+			prev->Next = NULL;
+		} else {
+			SDRAM_FreeList = NULL;
+		}
+	}
+	
+	/* Enable interrupts back */
+	__set_PRIMASK(primask);
+}
+
+uint32_t TM_SDRAM_GetFreeSize(void) {
+	TM_SDRAM_Block_t* blk;
+	uint32_t size, primask;
+	
+	/* Check SDRAM */
+	if (!SDRAM_Initialized) {
+		return 0;
+	}
+	
+	/* Disable interrupts */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Free space on top and freed blocks */
+	size = SDRAM_HEAP_END - SDRAM_HeapTop;
+	for (blk = SDRAM_FreeList; blk != NULL; blk = blk->Next) {
+		size += blk->Size;
+	}
+	
+	/* Enable interrupts back */
+	__set_PRIMASK(primask);
+	
+	/* Return size */
+	return size;
+}
+
+#if SDRAM_USE_RTOS_HEAP
+uint8_t TM_SDRAM_InitRTOSHeap(uint8_t* internal, size_t internal_size, size_t sdram_size) {
+	static HeapRegion_t regions[3];
+	uint8_t* sdram;
+	uint8_t i = 0;
+	
+	/* Allocate SDRAM part */
+	if ((sdram = (uint8_t *)TM_SDRAM_Malloc(sdram_size)) == NULL) {
+		return 0;
+	}
+	
+	/* Regions must be ordered by address, internal RAM is always before SDRAM */
+	if (internal != NULL && internal_size) {
+		regions[i].pucStartAddress = internal;
+		regions[i].xSizeInBytes = internal_size;
+		i++;
+	}
+	regions[i].pucStartAddress = sdram;
+	regions[i].xSizeInBytes = sdram_size;
+	i++;
+	regions[i].pucStartAddress = NULL;
+	regions[i].xSizeInBytes = 0;
+	
+	/* Give regions to FreeRTOS */
+	vPortDefineHeapRegions(regions);
+	
+	/* Return OK */
+	return 1;
+}
+#endif
+
 /* Private functions */
 static void TM_SDRAM_InitPins(void) {
 	/* Try to initialize from user */
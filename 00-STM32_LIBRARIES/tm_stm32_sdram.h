@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-11-sdram-for-stm32fxxx/
- * @version v1.1
+ * @version v1.3
  * @ide     Keil uVision
  * @license MIT
  * @brief   External SDRAM for STM32F429-Discovery, STM32F439-EVAL, STM32F469-Discovery or STM32F7-Discovery boards
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_SDRAM_H
-#define TM_SDRAM_H 110
+#define TM_SDRAM_H 130
 
 /**
  * @addtogroup TM_STM32Fxxx_HAL_Libraries
@@ -95,6 +95,69 @@ PC3  <-> FMC_SDCKE0 | PD0  <-> FMC_D2   | PE0  <-> FMC_NBL0  | PF0  <-> FMC_A0
                     |                   | PE14 <-> FMC_D11   | PF14 <-> FMC_A8    |                     |
                     |                   | PE15 <-> FMC_D12   | PF15 <-> FMC_A9    |                     |
 \endverbatim 
+ *
+ * \par Variables in SDRAM
+ *
+ * Use __sdram attribute from attributes.h file to place large buffers to SDRAM instead of hardcoded addresses.
+ * Section is not initialized by startup code, because SDRAM is not ready at that time. When SDRAM_USE_SECTION is enabled,
+ * @ref TM_SDRAM_Init sets section to zero after SDRAM is initialized, so do not use variables before.
+ *
+\code
+//Enable section support in defines.h
+#define SDRAM_USE_SECTION     1
+
+//Variable in SDRAM
+__sdram float FFT_Buffer[65536];
+\endcode
+ *
+ * For GCC, add section to linker script (SDRAM memory must be defined in MEMORY part):
+ *
+\code
+.sdram (NOLOAD) :
+{
+	. = ALIGN(4);
+	_ssdram = .;
+	*(.sdram)
+	*(.sdram*)
+	. = ALIGN(4);
+	_esdram = .;
+} >SDRAM
+\endcode
+ *
+ * For Keil uVision, add execution region to scatter file:
+ *
+\code
+RW_SDRAM 0xD0000000 UNINIT 0x00800000  {
+	*(.sdram)
+}
+\endcode
+ *
+ * \par SDRAM heap
+ *
+ * Memory after section (or after SDRAM_HEAP_OFFSET when section is not used) can be allocated with @ref TM_SDRAM_Malloc.
+ * Freed blocks are kept in address ordered list and merged with neighbours, last block is returned to free space.
+ *
+\code
+//Skip first 1MB, used for LCD frame buffers at hardcoded addresses
+#define SDRAM_HEAP_OFFSET     0x100000
+
+//Alignment of allocated blocks, 32 bytes is data cache line on STM32F7xx
+#define SDRAM_HEAP_ALIGN      32
+\endcode
+ *
+ * Part of SDRAM heap can be given to FreeRTOS heap_5 memory manager, together with internal RAM.
+ * Call @ref TM_SDRAM_InitRTOSHeap once before first FreeRTOS object is created:
+ *
+\code
+//Enable FreeRTOS heap functions
+#define SDRAM_USE_RTOS_HEAP   1
+
+static uint8_t ucHeap[16 * 1024];
+
+//Use 16kB of internal RAM and 1MB of SDRAM for FreeRTOS heap
+TM_SDRAM_Init();
+TM_SDRAM_InitRTOSHeap(ucHeap, sizeof(ucHeap), 1024 * 1024);
+\endcode
  *
  * \par STM32F429-Discovery pinout
  *
@@ -154,6 +217,14 @@ PC0  <-> FMC_SDNWE | PD0  <-> FMC_D2   | PE0  <-> FMC_NBL0  | PF0  <-> FMC_A0
  Version 1.1
   - October 10, 2015
   - Added support for STM32F469-Discovery
+  
+ Version 1.2
+  - October 14, 2026
+  - Added __sdram section support and SDRAM heap allocator with optional FreeRTOS heap_5 region
+  
+ Version 1.3
+  - October 14, 2026
+  - Faster initialization, fixed busy loops replaced with power-up delay in microseconds
 \endverbatim
  *
  * \par Dependencies
@@ -169,6 +240,7 @@ PC0  <-> FMC_SDNWE | PD0  <-> FMC_D2   | PE0  <-> FMC_NBL0  | PF0  <-> FMC_A0
 #include "defines.h"
 #include "attributes.h"
 #include "tm_stm32_gpio.h"
+#include "string.h"
 
 /**
  * @defgroup TM_SDRAM_Macros
@@ -278,6 +350,46 @@ PC0  <-> FMC_SDNWE | PD0  <-> FMC_D2   | PE0  <-> FMC_NBL0  | PF0  <-> FMC_A0
 /* Timeout for SDRAM initialization */
 #define SDRAM_TIMEOUT                   ((uint32_t)0xFFFF) 
 
+/**
+ * @brief  Delay in microseconds after clock enable command, before precharge.
+ *         Check datasheet of your SDRAM, most devices need 100us, some 200us
+ */
+#ifndef SDRAM_POWERUP_DELAY
+#define SDRAM_POWERUP_DELAY             200
+#endif
+
+/**
+ * @brief  Set section to zero on initialization, .sdram section must exist in linker script
+ */
+#ifndef SDRAM_USE_SECTION
+#define SDRAM_USE_SECTION               0
+#endif
+
+/**
+ * @brief  Heap start offset from SDRAM start when section is not used
+ */
+#ifndef SDRAM_HEAP_OFFSET
+#define SDRAM_HEAP_OFFSET               0
+#endif
+
+/**
+ * @brief  Alignment of heap blocks in units of bytes, must be power of 2 and at least 8
+ */
+#ifndef SDRAM_HEAP_ALIGN
+#if defined(STM32F7xx)
+#define SDRAM_HEAP_ALIGN                32
+#else
+#define SDRAM_HEAP_ALIGN                8
+#endif
+#endif
+
+/**
+ * @brief  Enables @ref TM_SDRAM_InitRTOSHeap function for FreeRTOS heap_5 memory manager
+ */
+#ifndef SDRAM_USE_RTOS_HEAP
+#define SDRAM_USE_RTOS_HEAP             0
+#endif
+
 /**
  * @}
  */
@@ -384,6 +496,42 @@ uint8_t TM_SDRAM_Init(void);
  */
 uint8_t TM_SDRAM_InitCustomPinsCallback(uint16_t AlternateFunction);
 
+/**
+ * @brief  Allocates memory block from SDRAM heap
+ * @note   SDRAM must be initialized first with @ref TM_SDRAM_Init function
+ * @param  size: Number of bytes to allocate
+ * @retval Pointer to allocated memory, aligned to SDRAM_HEAP_ALIGN bytes, or NULL if there is not enough memory
+ */
+void* TM_SDRAM_Malloc(size_t size);
+
+/**
+ * @brief  Frees memory block allocated with @ref TM_SDRAM_Malloc
+ * @param  *ptr: Pointer to memory. NULL and pointers outside heap are ignored
+ * @retval None
+ */
+void TM_SDRAM_Free(void* ptr);
+
+/**
+ * @brief  Gets free heap size
+ * @param  None
+ * @retval Number of free bytes, including freed blocks. Largest block can be smaller because of fragmentation
+ */
+uint32_t TM_SDRAM_GetFreeSize(void);
+
+#if SDRAM_USE_RTOS_HEAP || defined(DOXYGEN)
+/**
+ * @brief  Defines FreeRTOS heap_5 regions with internal RAM and memory allocated from SDRAM heap
+ * @note   Must be called once, before any FreeRTOS object is created. heap_5.c must be used in project
+ * @param  *internal: Pointer to internal RAM for heap or NULL if not used
+ * @param  internal_size: Size of internal RAM region in units of bytes
+ * @param  sdram_size: Number of bytes allocated from SDRAM heap for FreeRTOS heap
+ * @retval Status:
+ *            - 0: Not enough SDRAM memory
+ *            - > 0: Heap regions defined
+ */
+uint8_t TM_SDRAM_InitRTOSHeap(uint8_t* internal, size_t internal_size, size_t sdram_size);
+#endif
+
 /**
  * @}
  */
@@ -0,0 +1,495 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_sdram_bench.h"
+
+#if SDRAM_BENCH_BUFFER_SIZE > 65535 || SDRAM_BENCH_SIZE < (2 * SDRAM_BENCH_BUFFER_SIZE)
+#error "SDRAM_BENCH_BUFFER_SIZE must be less than 65536 and less than half of SDRAM_BENCH_SIZE!"
+#endif
+
+/* Test description */
+typedef struct {
+	const char* Name;
+	TM_SDRAM_BENCH_Master_t Master;
+	TM_SDRAM_BENCH_Type_t Type;
+	uint8_t Width;
+	uint8_t Offset;
+	uint8_t Burst;
+} TM_SDRAM_BENCH_Test_t;
+
+/* Shortcuts for test table */
+#define BENCH_CPU(name, type, width, offset)  {name, TM_SDRAM_BENCH_Master_CPU, TM_SDRAM_BENCH_Type_##type, width, offset, 1}
+#define BENCH_DMA(name, type, width, burst)   {name, TM_SDRAM_BENCH_Master_DMA2, TM_SDRAM_BENCH_Type_##type, width, 0, burst}
+#define BENCH_DMA2D(name, type, width)        {name, TM_SDRAM_BENCH_Master_DMA2D, TM_SDRAM_BENCH_Type_##type, width, 0, 1}
+
+/* All tests */
+static const TM_SDRAM_BENCH_Test_t BENCH_Tests[] = {
+	BENCH_CPU("CPU write 8", SeqWrite, 1, 0),
+	BENCH_CPU("CPU read 8", SeqRead, 1, 0),
+	BENCH_CPU("CPU write 16", SeqWrite, 2, 0),
+	BENCH_CPU("CPU read 16", SeqRead, 2, 0),
+	BENCH_CPU("CPU write 32", SeqWrite, 4, 0),
+	BENCH_CPU("CPU read 32", SeqRead, 4, 0),
+	BENCH_CPU("CPU write 64", SeqWrite, 8, 0),
+	BENCH_CPU("CPU read 64", SeqRead, 8, 0),
+	BENCH_CPU("CPU write 16 unaligned", SeqWrite, 2, 1),
+	BENCH_CPU("CPU read 16 unaligned", SeqRead, 2, 1),
+	BENCH_CPU("CPU write 32 unaligned", SeqWrite, 4, 1),
+	BENCH_CPU("CPU read 32 unaligned", SeqRead, 4, 1),
+	BENCH_CPU("CPU random write 8", RandWrite, 1, 0),
+	BENCH_CPU("CPU random read 8", RandRead, 1, 0),
+	BENCH_CPU("CPU random write 16", RandWrite, 2, 0),
+	BENCH_CPU("CPU random read 16", RandRead, 2, 0),
+	BENCH_CPU("CPU random write 32", RandWrite, 4, 0),
+	BENCH_CPU("CPU random read 32", RandRead, 4, 0),
+	BENCH_CPU("CPU latency 32", Latency, 4, 0),
+	BENCH_DMA("DMA2 write 8", SeqWrite, 1, 1),
+	BENCH_DMA("DMA2 read 8", SeqRead, 1, 1),
+	BENCH_DMA("DMA2 copy 8", Copy, 1, 1),
+	BENCH_DMA("DMA2 write 8 burst", SeqWrite, 1, 4),
+	BENCH_DMA("DMA2 read 8 burst", SeqRead, 1, 4),
+	BENCH_DMA("DMA2 copy 8 burst", Copy, 1, 4),
+	BENCH_DMA("DMA2 write 16", SeqWrite, 2, 1),
+	BENCH_DMA("DMA2 read 16", SeqRead, 2, 1),
+	BENCH_DMA("DMA2 copy 16", Copy, 2, 1),
+	BENCH_DMA("DMA2 write 16 burst", SeqWrite, 2, 4),
+	BENCH_DMA("DMA2 read 16 burst", SeqRead, 2, 4),
+	BENCH_DMA("DMA2 copy 16 burst", Copy, 2, 4),
+	BENCH_DMA("DMA2 write 32", SeqWrite, 4, 1),
+	BENCH_DMA("DMA2 read 32", SeqRead, 4, 1),
+	BENCH_DMA("DMA2 copy 32", Copy, 4, 1),
+	BENCH_DMA("DMA2 write 32 burst", SeqWrite, 4, 4),
+	BENCH_DMA("DMA2 read 32 burst", SeqRead, 4, 4),
+	BENCH_DMA("DMA2 copy 32 burst", Copy, 4, 4),
+#if defined(DMA2D)
+	BENCH_DMA2D("DMA2D fill ARGB8888", Fill, 4),
+	BENCH_DMA2D("DMA2D copy ARGB8888", Copy, 4),
+	BENCH_DMA2D("DMA2D fill RGB565", Fill, 2),
+	BENCH_DMA2D("DMA2D copy RGB565", Copy, 2),
+#endif
+};
+
+#define BENCH_TESTS_COUNT           (sizeof(BENCH_Tests) / sizeof(BENCH_Tests[0]))
+#define BENCH_PTR(offset)           (SDRAM_BENCH_ADDR + (offset))
+
+/* DMA2D line width in pixels */
+#define BENCH_DMA2D_WIDTH           256
+
+/* Internal RAM buffer for DMA tests */
+static uint32_t BENCH_Buffer[SDRAM_BENCH_BUFFER_SIZE / 4];
+
+/* Read values are stored here so compiler does not remove reads */
+static volatile uint32_t BENCH_Sink;
+
+/* Private functions */
+static void TM_SDRAM_BENCH_Prepare(void);
+static uint32_t TM_SDRAM_BENCH_RunCPU(const TM_SDRAM_BENCH_Test_t* Test, uint32_t* Accesses);
+static uint32_t TM_SDRAM_BENCH_RunDMA(const TM_SDRAM_BENCH_Test_t* Test, uint32_t* Accesses);
+#if defined(DMA2D)
+static uint32_t TM_SDRAM_BENCH_RunDMA2D(const TM_SDRAM_BENCH_Test_t* Test, uint32_t* Accesses);
+#endif
+
+/* Sequential and random access loops */
+#define BENCH_SEQ_WRITE(type, addr, n)      do {                 \
+	volatile type* p = (volatile type *)(addr);                   \
+	uint32_t cnt = (n) >> 2;                                     \
+	while (cnt--) {                                              \
+		p[0] = (type)cnt; p[1] = (type)cnt;                      \
+		p[2] = (type)cnt; p[3] = (type)cnt;                      \
+		p += 4;                                                  \
+	}                                                            \
+} while (0)
+
+#define BENCH_SEQ_READ(type, addr, n)       do {                 \
+	volatile type* p = (volatile type *)(addr);                   \
+	uint32_t cnt = (n) >> 2, sum = 0;                            \
+	while (cnt--) {                                              \
+		sum += (uint32_t)p[0]; sum += (uint32_t)p[1];            \
+		sum += (uint32_t)p[2]; sum += (uint32_t)p[3];            \
+		p += 4;                                                  \
+	}                                                            \
+	BENCH_Sink = sum;                                            \
+} while (0)
+
+#define BENCH_RAND_WRITE(type, addr, n)     do {                 \
+	volatile type* p = (volatile type *)(addr);                   \
+	uint32_t cnt = (n), x = 0x12345678;                          \
+	while (cnt--) {                                              \
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;                 \
+		p[x & ((n) - 1)] = (type)x;                              \
+	}                                                            \
+} while (0)
+
+#define BENCH_RAND_READ(type, addr, n)      do {                 \
+	volatile type* p = (volatile type *)(addr);                   \
+	uint32_t cnt = (n), x = 0x12345678, sum = 0;                 \
+	while (cnt--) {                                              \
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;                 \
+		sum += (uint32_t)p[x & ((n) - 1)];                       \
+	}                                                            \
+	BENCH_Sink = sum;                                            \
+} while (0)
+
+uint8_t TM_SDRAM_BENCH_Init(void) {
+	/* Init SDRAM */
+	if (!TM_SDRAM_Init()) {
+		return 0;
+	}
+	
+	/* Enable DMA clocks */
+	__HAL_RCC_DMA2_CLK_ENABLE();
+#if defined(DMA2D)
+	__HAL_RCC_DMA2D_CLK_ENABLE();
+#endif
+	
+	/* Enable cycle counter */
+	return TM_GENERAL_DWTCounterEnable();
+}
+
+uint16_t TM_SDRAM_BENCH_Run(TM_SDRAM_BENCH_Result_t* Results, uint16_t count) {
+	const TM_SDRAM_BENCH_Test_t* Test;
+	TM_SDRAM_BENCH_Result_t* Result;
+	uint32_t primask, accesses = 0;
+	uint16_t i;
+	
+	/* Check count */
+	if (count > BENCH_TESTS_COUNT) {
+		count = BENCH_TESTS_COUNT;
+	}
+	
+	for (i = 0; i < count; i++) {
+		Test = &BENCH_Tests[i];
+		Result = &Results[i];
+		
+		/* Copy test description */
+		Result->Name = Test->Name;
+		Result->Master = Test->Master;
+		Result->Type = Test->Type;
+		Result->Width = Test->Width;
+		Result->Offset = Test->Offset;
+		Result->Burst = Test->Burst;
+		Result->Flags = 0;
+		
+		/* Save conditions */
+#if defined(LTDC)
+		if (LTDC->GCR & LTDC_GCR_LTDCEN) {
+			Result->Flags |= SDRAM_BENCH_FLAG_LTDC;
+		}
+#endif
+#if defined(STM32F7xx)
+		if (SCB->CCR & SCB_CCR_DC_Msk) {
+			Result->Flags |= SDRAM_BENCH_FLAG_DCACHE;
+		}
+#endif
+		
+		/* No interrupts during test */
+		primask = __get_PRIMASK();
+		__disable_irq();
+		
+		/* Run test */
+		switch (Test->Master) {
+			case TM_SDRAM_BENCH_Master_CPU:
+				Result->Cycles = TM_SDRAM_BENCH_RunCPU(Test, &accesses);
+				break;
+			case TM_SDRAM_BENCH_Master_DMA2:
+				Result->Cycles = TM_SDRAM_BENCH_RunDMA(Test, &accesses);
+				break;
+#if defined(DMA2D)
+			case TM_SDRAM_BENCH_Master_DMA2D:
+				Result->Cycles = TM_SDRAM_BENCH_RunDMA2D(Test, &accesses);
+				break;
+#endif
+			default:
+				Result->Cycles = 0;
+				accesses = 0;
+				break;
+		}
+		
+		/* Restore interrupts */
+		if (!primask) {
+			__enable_irq();
+		}
+		
+		/* Calculate results */
+		Result->Accesses = accesses;
+		Result->Bytes = accesses * Test->Width;
+		if (Result->Cycles) {
+			Result->BytesPerSec = (uint32_t)(((uint64_t)Result->Bytes * SystemCoreClock) / Result->Cycles);
+		} else {
+			Result->BytesPerSec = 0;
+		}
+		if (accesses) {
+			Result->CyclesPerAccess = (uint32_t)(((uint64_t)Result->Cycles * 100) / accesses);
+		} else {
+			Result->CyclesPerAccess = 0;
+		}
+	}
+	
+	/* Return number of tests */
+	return count;
+}
+
+void TM_SDRAM_BENCH_Dump(const TM_SDRAM_BENCH_Result_t* Results, uint16_t count, void (*OutputFunc)(char *)) {
+	static const char* Masters[] = {"CPU", "DMA2", "DMA2D"};
+	static const char* Types[] = {"SeqWrite", "SeqRead", "RandWrite", "RandRead", "Latency", "Copy", "Fill"};
+	char str[160];
+	uint16_t i;
+	
+	/* Header */
+	OutputFunc("Name,Master,Type,Width,Offset,Burst,LTDC,DCache,Bytes,Cycles,MBps,CyclesPerAccess\n");
+	
+	for (i = 0; i < count; i++) {
+		sprintf(str, "%s,%s,%s,%u,%u,%u,%u,%u,%lu,%lu,%lu.%02lu,%lu.%02lu\n",
+			Results[i].Name,
+			Masters[Results[i].Master],
+			Types[Results[i].Type],
+			(unsigned)Results[i].Width,
+			(unsigned)Results[i].Offset,
+			(unsigned)Results[i].Burst,
+			(unsigned)!!(Results[i].Flags & SDRAM_BENCH_FLAG_LTDC),
+			(unsigned)!!(Results[i].Flags & SDRAM_BENCH_FLAG_DCACHE),
+			(unsigned long)Results[i].Bytes,
+			(unsigned long)Results[i].Cycles,
+			(unsigned long)(Results[i].BytesPerSec / 1000000), (unsigned long)((Results[i].BytesPerSec / 10000) % 100),
+			(unsigned long)(Results[i].CyclesPerAccess / 100), (unsigned long)(Results[i].CyclesPerAccess % 100)
+		);
+		OutputFunc(str);
+	}
+}
+
+/******************************************************************/
+/*                          PRIVATE FUNCTIONS                     */
+/******************************************************************/
+static void TM_SDRAM_BENCH_Prepare(void) {
+	/* Write data from cache to SDRAM and make sure next accesses go to SDRAM */
+#if defined(STM32F7xx)
+	if (SCB->CCR & SCB_CCR_DC_Msk) {
+		SCB_CleanInvalidateDCache();
+	}
+#endif
+	
+	/* Reset counter */
+	TM_GENERAL_DWTCounterSetValue(0);
+}
+
+static uint32_t TM_SDRAM_BENCH_RunCPU(const TM_SDRAM_BENCH_Test_t* Test, uint32_t* Accesses) {
+	uint32_t addr = BENCH_PTR(Test->Offset);
+	uint32_t n, i, idx;
+	volatile uint32_t* p;
+	
+	/* Number of accesses, keep unaligned accesses inside area */
+	if (Test->Type == TM_SDRAM_BENCH_Type_SeqWrite || Test->Type == TM_SDRAM_BENCH_Type_SeqRead) {
+		n = ((SDRAM_BENCH_SIZE - Test->Offset) / Test->Width) & ~(uint32_t)3;
+	} else {
+		n = SDRAM_BENCH_SIZE / Test->Width;
+	}
+	*Accesses = n;
+	
+	/* Build chain of indexes for latency test, full period LCG visits all words once */
+	if (Test->Type == TM_SDRAM_BENCH_Type_Latency) {
+		p = (volatile uint32_t *)addr;
+		for (i = 0; i < n; i++) {
+			p[i] = (i * 1664525UL + 1013904223UL) & (n - 1);
+		}
+	}
+	
+	/* Start measurement */
+	TM_SDRAM_BENCH_Prepare();
+	
+	switch (Test->Type) {
+		case TM_SDRAM_BENCH_Type_SeqWrite:
+			switch (Test->Width) {
+				case 1: BENCH_SEQ_WRITE(uint8_t, addr, n); break;
+				case 2: BENCH_SEQ_WRITE(uint16_t, addr, n); break;
+				case 4: BENCH_SEQ_WRITE(uint32_t, addr, n); break;
+				default: BENCH_SEQ_WRITE(uint64_t, addr, n); break;
+			}
+			break;
+		case TM_SDRAM_BENCH_Type_SeqRead:
+			switch (Test->Width) {
+				case 1: BENCH_SEQ_READ(uint8_t, addr, n); break;
+				case 2: BENCH_SEQ_READ(uint16_t, addr, n); break;
+				case 4: BENCH_SEQ_READ(uint32_t, addr, n); break;
+				default: BENCH_SEQ_READ(uint64_t, addr, n); break;
+			}
+			break;
+		case TM_SDRAM_BENCH_Type_RandWrite:
+			switch (Test->Width) {
+				case 1: BENCH_RAND_WRITE(uint8_t, addr, n); break;
+				case 2: BENCH_RAND_WRITE(uint16_t, addr, n); break;
+				default: BENCH_RAND_WRITE(uint32_t, addr, n); break;
+			}
+			break;
+		case TM_SDRAM_BENCH_Type_RandRead:
+			switch (Test->Width) {
+				case 1: BENCH_RAND_READ(uint8_t, addr, n); break;
+				case 2: BENCH_RAND_READ(uint16_t, addr, n); break;
+				default: BENCH_RAND_READ(uint32_t, addr, n); break;
+			}
+			break;
+		case TM_SDRAM_BENCH_Type_Latency:
+			/* Next address depends on loaded value */
+			p = (volatile uint32_t *)addr;
+			idx = 0;
+			for (i = n; i; i--) {
+				idx = p[idx];
+			}
+			BENCH_Sink = idx;
+			break;
+		default:
+			break;
+	}
+	
+	/* Return cycles */
+	return TM_GENERAL_DWTCounterGetValue();
+}
+
+static uint32_t TM_SDRAM_BENCH_RunDMA(const TM_SDRAM_BENCH_Test_t* Test, uint32_t* Accesses) {
+	DMA_HandleTypeDef DMAHandle;
+	uint32_t src, dst, srcstep, dststep, chunks, cycles;
+	
+	/* Configure memory to memory stream, FIFO is required for memory to memory mode */
+	memset(&DMAHandle, 0, sizeof(DMAHandle));
+	DMAHandle.Instance = SDRAM_BENCH_DMA_STREAM;
+	DMAHandle.Init.Channel = SDRAM_BENCH_DMA_CHANNEL;
+	DMAHandle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+	DMAHandle.Init.PeriphInc = DMA_PINC_ENABLE;
+	DMAHandle.Init.MemInc = DMA_MINC_ENABLE;
+	DMAHandle.Init.Mode = DMA_NORMAL;
+	DMAHandle.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	DMAHandle.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+	DMAHandle.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	if (Test->Width == 1) {
+		DMAHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+		DMAHandle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	} else if (Test->Width == 2) {
+		DMAHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+		DMAHandle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	} else {
+		DMAHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+		DMAHandle.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	}
+	if (Test->Burst == 4) {
+		DMAHandle.Init.PeriphBurst = DMA_PBURST_INC4;
+		DMAHandle.Init.MemBurst = DMA_MBURST_INC4;
+	} else {
+		DMAHandle.Init.PeriphBurst = DMA_PBURST_SINGLE;
+		DMAHandle.Init.MemBurst = DMA_MBURST_SINGLE;
+	}
+	if (HAL_DMA_Init(&DMAHandle) != HAL_OK) {
+		*Accesses = 0;
+		return 0;
+	}
+	
+	/* Source (peripheral port) and destination (memory port) in internal buffer sized chunks */
+	if (Test->Type == TM_SDRAM_BENCH_Type_SeqWrite) {
+		src = (uint32_t)BENCH_Buffer;
+		srcstep = 0;
+		dst = BENCH_PTR(0);
+		dststep = SDRAM_BENCH_BUFFER_SIZE;
+		chunks = SDRAM_BENCH_SIZE / SDRAM_BENCH_BUFFER_SIZE;
+	} else if (Test->Type == TM_SDRAM_BENCH_Type_SeqRead) {
+		src = BENCH_PTR(0);
+		srcstep = SDRAM_BENCH_BUFFER_SIZE;
+		dst = (uint32_t)BENCH_Buffer;
+		dststep = 0;
+		chunks = SDRAM_BENCH_SIZE / SDRAM_BENCH_BUFFER_SIZE;
+	} else {
+		src = BENCH_PTR(0);
+		srcstep = SDRAM_BENCH_BUFFER_SIZE;
+		dst = BENCH_PTR(SDRAM_BENCH_SIZE / 2);
+		dststep = SDRAM_BENCH_BUFFER_SIZE;
+		chunks = SDRAM_BENCH_SIZE / 2 / SDRAM_BENCH_BUFFER_SIZE;
+	}
+	*Accesses = chunks * (SDRAM_BENCH_BUFFER_SIZE / Test->Width);
+	
+	/* Start measurement */
+	TM_SDRAM_BENCH_Prepare();
+	
+	while (chunks--) {
+		HAL_DMA_Start(&DMAHandle, src, dst, SDRAM_BENCH_BUFFER_SIZE / Test->Width);
+		HAL_DMA_PollForTransfer(&DMAHandle, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY);
+		src += srcstep;
+		dst += dststep;
+	}
+	
+	/* Save cycles */
+	cycles = TM_GENERAL_DWTCounterGetValue();
+	
+	/* Release stream */
+	HAL_DMA_DeInit(&DMAHandle);
+	
+	/* Return cycles */
+	return cycles;
+}
+
+#if defined(DMA2D)
+static uint32_t TM_SDRAM_BENCH_RunDMA2D(const TM_SDRAM_BENCH_Test_t* Test, uint32_t* Accesses) {
+	DMA2D_HandleTypeDef DMA2DHandle;
+	uint32_t lines = SDRAM_BENCH_SIZE / (Test->Width * BENCH_DMA2D_WIDTH);
+	uint32_t cycles;
+	
+	/* Configure DMA2D */
+	memset(&DMA2DHandle, 0, sizeof(DMA2DHandle));
+	DMA2DHandle.Instance = DMA2D;
+	DMA2DHandle.Init.Mode = Test->Type == TM_SDRAM_BENCH_Type_Fill ? DMA2D_R2M : DMA2D_M2M;
+	DMA2DHandle.Init.ColorMode = Test->Width == 4 ? DMA2D_ARGB8888 : DMA2D_RGB565;
+	DMA2DHandle.Init.OutputOffset = 0;
+	if (HAL_DMA2D_Init(&DMA2DHandle) != HAL_OK) {
+		*Accesses = 0;
+		return 0;
+	}
+	
+	/* Foreground layer for copy, first half of area is copied to second half */
+	if (Test->Type == TM_SDRAM_BENCH_Type_Copy) {
+		DMA2DHandle.LayerCfg[1].InputColorMode = Test->Width == 4 ? CM_ARGB8888 : CM_RGB565;
+		DMA2DHandle.LayerCfg[1].InputOffset = 0;
+		DMA2DHandle.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
+		DMA2DHandle.LayerCfg[1].InputAlpha = 0xFF;
+		HAL_DMA2D_ConfigLayer(&DMA2DHandle, 1);
+		lines /= 2;
+	}
+	*Accesses = lines * BENCH_DMA2D_WIDTH;
+	
+	/* Start measurement */
+	TM_SDRAM_BENCH_Prepare();
+	
+	if (Test->Type == TM_SDRAM_BENCH_Type_Fill) {
+		HAL_DMA2D_Start(&DMA2DHandle, 0x00FF00FF, BENCH_PTR(0), BENCH_DMA2D_WIDTH, lines);
+	} else {
+		HAL_DMA2D_Start(&DMA2DHandle, BENCH_PTR(0), BENCH_PTR(SDRAM_BENCH_SIZE / 2), BENCH_DMA2D_WIDTH, lines);
+	}
+	HAL_DMA2D_PollForTransfer(&DMA2DHandle, HAL_MAX_DELAY);
+	
+	/* Save cycles */
+	cycles = TM_GENERAL_DWTCounterGetValue();
+	
+	/* Release DMA2D */
+	HAL_DMA2D_DeInit(&DMA2DHandle);
+	
+	/* Return cycles */
+	return cycles;
+}
+#endif
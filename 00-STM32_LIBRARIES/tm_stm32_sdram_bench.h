@@ -0,0 +1,304 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   SDRAM bandwidth and latency benchmark for CPU, DMA2 and DMA2D
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_SDRAM_BENCH_H
+#define TM_SDRAM_BENCH_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_SDRAM_BENCH
+ * @brief    SDRAM bandwidth and latency benchmark for CPU, DMA2 and DMA2D
+ * @{
+ *
+ * Library measures how fast external SDRAM is for different bus masters and access patterns.
+ * All tests are timed with DWT cycle counter, interrupts are disabled during each test.
+ *
+ * \par Tests
+ *
+\verbatim
+ - CPU:   Sequential write/read with 8, 16, 32 and 64-bit accesses, aligned and unaligned
+ - CPU:   Random write/read with 8, 16 and 32-bit accesses
+ - CPU:   Read latency with dependent loads (pointer chase), one load must finish before next address is known
+ - DMA2:  Memory to memory write (internal RAM to SDRAM), read (SDRAM to internal RAM) and SDRAM to SDRAM copy,
+          with 8, 16 and 32-bit data size, single and INCR4 burst
+ - DMA2D: Register to memory fill and memory to memory copy in ARGB8888 and RGB565 modes (only when DMA2D exists)
+\endverbatim
+ *
+ * Random CPU tests include index generation time (few cycles per access), use latency test for pure SDRAM access time.
+ *
+ * \par LCD contention
+ *
+ * When LTDC is enabled and scanning frame buffer from SDRAM, it shares FMC with other masters.
+ * Each result has @ref SDRAM_BENCH_FLAG_LTDC flag set when LTDC was enabled during test.
+ * Run benchmark once with LCD disabled and once with LCD enabled to compare results.
+ *
+ * \par Configuration
+ *
+ * Test area must not overlap frame buffers or variables in SDRAM, because it is overwritten.
+ *
+\code
+//Start address of test area, default is in second half of SDRAM
+#define SDRAM_BENCH_ADDR         (SDRAM_START_ADR + SDRAM_MEMORY_SIZE / 2)
+
+//Size of test area in bytes, must be power of 2
+#define SDRAM_BENCH_SIZE         0x10000
+
+//Internal RAM buffer size for DMA read and write tests
+#define SDRAM_BENCH_BUFFER_SIZE  4096
+
+//DMA2 stream and channel for memory to memory tests
+#define SDRAM_BENCH_DMA_STREAM   DMA2_Stream0
+#define SDRAM_BENCH_DMA_CHANNEL  DMA_CHANNEL_0
+\endcode
+ *
+ * On STM32F7xx with data cache enabled, cache is cleaned and invalidated before each test and
+ * @ref SDRAM_BENCH_FLAG_DCACHE flag is set in result. CPU results then show cached performance.
+ *
+ * \par Example
+ *
+\code
+//Print over USART
+void USART_Output(char* str) {
+	TM_USART_Puts(USART1, str);
+}
+
+TM_SDRAM_BENCH_Result_t Results[SDRAM_BENCH_TESTS];
+uint16_t count;
+
+//Init SDRAM and DWT counter
+if (TM_SDRAM_BENCH_Init()) {
+	//Run all tests
+	count = TM_SDRAM_BENCH_Run(Results, SDRAM_BENCH_TESTS);
+	
+	//Print results as CSV lines
+	TM_SDRAM_BENCH_Dump(Results, count, USART_Output);
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM SDRAM
+ - TM GENERAL
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_sdram.h"
+#include "tm_stm32_general.h"
+#include "stdio.h"
+
+/* Check SDRAM version */
+#if TM_SDRAM_H < 120
+#error "Please update TM SDRAM LIB, minimum required version is 1.2. Download available on stm32f4-discovery.com website"
+#endif
+
+/**
+ * @defgroup TM_SDRAM_BENCH_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Start address of test area in SDRAM
+ */
+#ifndef SDRAM_BENCH_ADDR
+#define SDRAM_BENCH_ADDR         (SDRAM_START_ADR + SDRAM_MEMORY_SIZE / 2)
+#endif
+
+/**
+ * @brief  Size of test area in units of bytes, must be power of 2
+ */
+#ifndef SDRAM_BENCH_SIZE
+#define SDRAM_BENCH_SIZE         0x10000
+#endif
+
+/**
+ * @brief  Internal RAM buffer size for DMA read and write tests in units of bytes
+ */
+#ifndef SDRAM_BENCH_BUFFER_SIZE
+#define SDRAM_BENCH_BUFFER_SIZE  4096
+#endif
+
+/**
+ * @brief  DMA2 stream and channel used for memory to memory tests
+ */
+#ifndef SDRAM_BENCH_DMA_STREAM
+#define SDRAM_BENCH_DMA_STREAM   DMA2_Stream0
+#define SDRAM_BENCH_DMA_CHANNEL  DMA_CHANNEL_0
+#endif
+
+/**
+ * @brief  Number of tests in benchmark
+ */
+#if defined(DMA2D)
+#define SDRAM_BENCH_TESTS        41
+#else
+#define SDRAM_BENCH_TESTS        37
+#endif
+
+#define SDRAM_BENCH_FLAG_LTDC    0x01 /*!< LTDC was scanning frame buffer during test */
+#define SDRAM_BENCH_FLAG_DCACHE  0x02 /*!< Data cache was enabled during test */
+
+#if (SDRAM_BENCH_SIZE & (SDRAM_BENCH_SIZE - 1)) != 0
+#error "SDRAM_BENCH_SIZE must be power of 2!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_SDRAM_BENCH_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Bus master which accesses SDRAM in test
+ */
+typedef enum {
+	TM_SDRAM_BENCH_Master_CPU = 0x00, /*!< CPU load and store instructions */
+	TM_SDRAM_BENCH_Master_DMA2,       /*!< DMA2 memory to memory stream */
+	TM_SDRAM_BENCH_Master_DMA2D       /*!< Chrom-ART DMA2D */
+} TM_SDRAM_BENCH_Master_t;
+
+/**
+ * @brief  Test access pattern
+ */
+typedef enum {
+	TM_SDRAM_BENCH_Type_SeqWrite = 0x00, /*!< Sequential write */
+	TM_SDRAM_BENCH_Type_SeqRead,         /*!< Sequential read */
+	TM_SDRAM_BENCH_Type_RandWrite,       /*!< Random write */
+	TM_SDRAM_BENCH_Type_RandRead,        /*!< Random read */
+	TM_SDRAM_BENCH_Type_Latency,         /*!< Dependent random reads */
+	TM_SDRAM_BENCH_Type_Copy,            /*!< SDRAM to SDRAM copy, bytes are counted once */
+	TM_SDRAM_BENCH_Type_Fill             /*!< Fill with constant value */
+} TM_SDRAM_BENCH_Type_t;
+
+/**
+ * @brief  Result of one test
+ */
+typedef struct {
+	const char* Name;               /*!< Test name */
+	TM_SDRAM_BENCH_Master_t Master; /*!< Bus master */
+	TM_SDRAM_BENCH_Type_t Type;     /*!< Access pattern */
+	uint8_t Width;                  /*!< Access width in units of bytes, pixel size for DMA2D */
+	uint8_t Offset;                 /*!< Address offset from aligned address */
+	uint8_t Burst;                  /*!< DMA burst length in beats, 1 for single transfers */
+	uint8_t Flags;                  /*!< Test conditions, SDRAM_BENCH_FLAG_x flags */
+	uint32_t Bytes;                 /*!< Number of bytes transferred */
+	uint32_t Accesses;              /*!< Number of accesses (transfers or pixels) */
+	uint32_t Cycles;                /*!< Number of CPU cycles for test */
+	uint32_t BytesPerSec;           /*!< Bandwidth in units of bytes per second */
+	uint32_t CyclesPerAccess;       /*!< CPU cycles per access multiplied by 100 */
+} TM_SDRAM_BENCH_Result_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_SDRAM_BENCH_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes SDRAM, DWT counter and clocks for DMA2 and DMA2D
+ * @param  None
+ * @retval Initialization status:
+ *            - 0: SDRAM or DWT counter is not working
+ *            - > 0: Benchmark is ready
+ */
+uint8_t TM_SDRAM_BENCH_Init(void);
+
+/**
+ * @brief  Runs benchmark tests
+ * @note   Test area content is destroyed
+ * @param  *Results: Pointer to array of @ref TM_SDRAM_BENCH_Result_t structures for results
+ * @param  count: Number of elements in array. Use SDRAM_BENCH_TESTS to run all tests
+ * @retval Number of tests done
+ */
+uint16_t TM_SDRAM_BENCH_Run(TM_SDRAM_BENCH_Result_t* Results, uint16_t count);
+
+/**
+ * @brief  Prints results as CSV lines with header line
+ * @param  *Results: Pointer to array of results from @ref TM_SDRAM_BENCH_Run
+ * @param  count: Number of results in array
+ * @param  *OutputFunc: Pointer to function which outputs string, for example over USART or USB CDC
+ * @retval None
+ */
+void TM_SDRAM_BENCH_Dump(const TM_SDRAM_BENCH_Result_t* Results, uint16_t count, void (*OutputFunc)(char *));
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
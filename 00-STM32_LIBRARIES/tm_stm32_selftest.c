@@ -0,0 +1,535 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_selftest.h"
+
+/* Chunk size is for full speed when it reaches this percentage of largest chunk speed */
+#define SELFTEST_CHUNK_PERCENT        90
+
+/* Private functions */
+static uint32_t TM_SELFTEST_INT_Speed(uint32_t bytes, uint32_t cycles);
+#if SELFTEST_USE_CLOCK
+static void TM_SELFTEST_INT_Clock(TM_SELFTEST_Report_t* Report);
+static uint8_t TM_SELFTEST_INT_ClockEdge(uint32_t* cycles);
+#endif
+#if SELFTEST_USE_SDRAM
+static void TM_SELFTEST_INT_SDRAM(TM_SELFTEST_Report_t* Report);
+#endif
+#if SELFTEST_USE_SPI
+static void TM_SELFTEST_INT_SPI(TM_SELFTEST_Report_t* Report);
+#endif
+#if SELFTEST_USE_SDIO
+static void TM_SELFTEST_INT_SDIO(TM_SELFTEST_Report_t* Report);
+#endif
+#if SELFTEST_USE_USB
+static void TM_SELFTEST_INT_USB(TM_SELFTEST_Report_t* Report);
+#endif
+#if SELFTEST_USE_USART
+static void TM_SELFTEST_INT_USART(TM_SELFTEST_Report_t* Report);
+#endif
+
+/* Test buffers */
+#if SELFTEST_USE_SPI
+static uint8_t SELFTEST_SPI_TX[SELFTEST_SPI_SIZE];
+static uint8_t SELFTEST_SPI_RX[SELFTEST_SPI_SIZE];
+#endif
+#if SELFTEST_USE_SDIO
+static uint32_t SELFTEST_SDIO_Buffer[SELFTEST_SDIO_SECTORS * 512 / 4];
+#endif
+
+/******************************************************************/
+/*                          PUBLIC FUNCTIONS                      */
+/******************************************************************/
+TM_SELFTEST_Result_t TM_SELFTEST_Init(void) {
+	/* All tests are timed with DWT counter */
+	if (!TM_GENERAL_DWTCounterEnable()) {
+		return TM_SELFTEST_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_SELFTEST_Result_Ok;
+}
+
+void TM_SELFTEST_Run(TM_SELFTEST_Report_t* Report) {
+	/* Tests which are not run have zero values */
+	memset(Report, 0, sizeof(TM_SELFTEST_Report_t));
+	
+	/* Report is valid only for this version and clock */
+	Report->Version = TM_SELFTEST_H;
+	Report->Size = sizeof(TM_SELFTEST_Report_t);
+	Report->CoreClock = SystemCoreClock;
+	
+	/* Run enabled tests */
+#if SELFTEST_USE_CLOCK
+	TM_SELFTEST_INT_Clock(Report);
+#endif
+#if SELFTEST_USE_SDRAM
+	TM_SELFTEST_INT_SDRAM(Report);
+#endif
+#if SELFTEST_USE_SPI
+	TM_SELFTEST_INT_SPI(Report);
+#endif
+#if SELFTEST_USE_SDIO
+	TM_SELFTEST_INT_SDIO(Report);
+#endif
+#if SELFTEST_USE_USB
+	TM_SELFTEST_INT_USB(Report);
+#endif
+#if SELFTEST_USE_USART
+	TM_SELFTEST_INT_USART(Report);
+#endif
+}
+
+TM_SELFTEST_Result_t TM_SELFTEST_Save(const TM_SELFTEST_Report_t* Report) {
+	/* Write to flash, unchanged report does not use flash */
+	if (TM_FLASHKV_Write(SELFTEST_KEY, Report, sizeof(TM_SELFTEST_Report_t)) != TM_FLASHKV_Result_Ok) {
+		return TM_SELFTEST_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_SELFTEST_Result_Ok;
+}
+
+TM_SELFTEST_Result_t TM_SELFTEST_Load(TM_SELFTEST_Report_t* Report) {
+	TM_FLASHKV_Result_t res;
+	uint16_t length;
+	
+	/* Read from flash */
+	res = TM_FLASHKV_Read(SELFTEST_KEY, Report, sizeof(TM_SELFTEST_Report_t), &length);
+	if (res == TM_FLASHKV_Result_NotFound) {
+		return TM_SELFTEST_Result_NotFound;
+	}
+	if (res == TM_FLASHKV_Result_InvalidSize) {
+		return TM_SELFTEST_Result_Invalid;
+	}
+	if (res != TM_FLASHKV_Result_Ok) {
+		return TM_SELFTEST_Result_Error;
+	}
+	
+	/* Report must be from this version and for current clock settings */
+	if (
+		length != sizeof(TM_SELFTEST_Report_t) ||
+		Report->Version != TM_SELFTEST_H ||
+		Report->Size != sizeof(TM_SELFTEST_Report_t) ||
+		Report->CoreClock != SystemCoreClock
+	) {
+		return TM_SELFTEST_Result_Invalid;
+	}
+	
+	/* Return OK */
+	return TM_SELFTEST_Result_Ok;
+}
+
+void TM_SELFTEST_Print(const TM_SELFTEST_Report_t* Report, void (*OutputFunc)(char *)) {
+	static const char* Status[] = {"not run", "OK", "error", "not available"};
+	char str[96];
+	
+	/* Header */
+	sprintf(str, "Self-test, core %lu Hz\n", (unsigned long)Report->CoreClock);
+	OutputFunc(str);
+	
+	/* Only tests which were run */
+	if (Report->Clock.Status != TM_SELFTEST_Status_NotRun) {
+		sprintf(str, "Clock: %s, %lu Hz, %ld ppm\n",
+			Status[Report->Clock.Status & 0x03],
+			(unsigned long)Report->Clock.Measured,
+			(long)Report->Clock.ErrorPPM
+		);
+		OutputFunc(str);
+	}
+	if (Report->SDRAM.Status != TM_SELFTEST_Status_NotRun) {
+		sprintf(str, "SDRAM: %s, write %lu.%02lu MB/s, read %lu.%02lu MB/s, %lu errors\n",
+			Status[Report->SDRAM.Status & 0x03],
+			(unsigned long)(Report->SDRAM.Write / 1000000), (unsigned long)((Report->SDRAM.Write / 10000) % 100),
+			(unsigned long)(Report->SDRAM.Read / 1000000), (unsigned long)((Report->SDRAM.Read / 10000) % 100),
+			(unsigned long)Report->SDRAM.Errors
+		);
+		OutputFunc(str);
+	}
+	if (Report->SPI.Status != TM_SELFTEST_Status_NotRun) {
+		sprintf(str, "SPI: %s, %lu Hz, %lu.%02lu MB/s, chunk %u bytes\n",
+			Status[Report->SPI.Status & 0x03],
+			(unsigned long)Report->SPI.Clock,
+			(unsigned long)(Report->SPI.Speed / 1000000), (unsigned long)((Report->SPI.Speed / 10000) % 100),
+			(unsigned)Report->SPI.Chunk
+		);
+		OutputFunc(str);
+	}
+	if (Report->SD.Status != TM_SELFTEST_Status_NotRun) {
+		sprintf(str, "SDIO: %s, %lu.%02lu MB/s, chunk %u sectors\n",
+			Status[Report->SD.Status & 0x03],
+			(unsigned long)(Report->SD.Speed / 1000000), (unsigned long)((Report->SD.Speed / 10000) % 100),
+			(unsigned)Report->SD.Chunk
+		);
+		OutputFunc(str);
+	}
+	if (Report->USB.Status != TM_SELFTEST_Status_NotRun) {
+		sprintf(str, "USB: %s, %lu.%02lu MB/s\n",
+			Status[Report->USB.Status & 0x03],
+			(unsigned long)(Report->USB.Speed / 1000000), (unsigned long)((Report->USB.Speed / 10000) % 100)
+		);
+		OutputFunc(str);
+	}
+	if (Report->USART.Status != TM_SELFTEST_Status_NotRun) {
+		sprintf(str, "USART: %s, %lu baud\n",
+			Status[Report->USART.Status & 0x03],
+			(unsigned long)Report->USART.Baudrate
+		);
+		OutputFunc(str);
+	}
+}
+
+/******************************************************************/
+/*                          PRIVATE FUNCTIONS                     */
+/******************************************************************/
+static uint32_t TM_SELFTEST_INT_Speed(uint32_t bytes, uint32_t cycles) {
+	/* Bytes per second */
+	if (cycles == 0) {
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)bytes * SystemCoreClock) / cycles);
+}
+
+#if SELFTEST_USE_CLOCK
+static uint8_t TM_SELFTEST_INT_ClockEdge(uint32_t* cycles) {
+	uint32_t timeout = SystemCoreClock / 1000;
+	
+	/* Capture every 8 LSE periods is 244 us, interrupts are disabled only for one capture */
+	__disable_irq();
+	TIM5->SR = ~TIM_SR_CC4IF;
+	while (!(TIM5->SR & TIM_SR_CC4IF) && --timeout);
+	*cycles = TM_GENERAL_DWTCounterGetValue();
+	__enable_irq();
+	
+	/* Return status */
+	return timeout > 0;
+}
+
+static void TM_SELFTEST_INT_Clock(TM_SELFTEST_Report_t* Report) {
+	uint32_t start, end, tick, periods, expected, clock_enabled;
+	uint64_t cycles;
+	
+	/* Start LSE, it can take up to 2 seconds */
+	if (!(RCC->BDCR & RCC_BDCR_LSERDY)) {
+		__HAL_RCC_PWR_CLK_ENABLE();
+		HAL_PWR_EnableBkUpAccess();
+		RCC->BDCR |= RCC_BDCR_LSEON;
+		
+		tick = HAL_GetTick();
+		while (!(RCC->BDCR & RCC_BDCR_LSERDY)) {
+			if ((HAL_GetTick() - tick) > 2000) {
+				/* No LSE crystal */
+				Report->Clock.Status = TM_SELFTEST_Status_NotAvailable;
+				return;
+			}
+		}
+	}
+	
+	/* LSE to TIM5 channel 4, capture every 8 rising edges */
+	clock_enabled = RCC->APB1ENR & RCC_APB1ENR_TIM5EN;
+	__HAL_RCC_TIM5_CLK_ENABLE();
+	TIM5->CR1 = 0;
+	TIM5->OR = TIM_OR_TI4_RMP_1;
+	TIM5->CCMR2 = TIM_CCMR2_CC4S_0 | TIM_CCMR2_IC4PSC;
+	TIM5->CCER = TIM_CCER_CC4E;
+	TIM5->ARR = 0xFFFFFFFF;
+	TIM5->CR1 = TIM_CR1_CEN;
+	
+	/* Measure DWT cycles between two captures, test time apart */
+	if (TM_SELFTEST_INT_ClockEdge(&start)) {
+		tick = HAL_GetTick();
+		while ((HAL_GetTick() - tick) < SELFTEST_CLOCK_TIME);
+		if (TM_SELFTEST_INT_ClockEdge(&end)) {
+			cycles = (uint32_t)(end - start);
+			
+			/* Number of LSE periods is multiple of 8, core clock is accurate enough to round it */
+			periods = (uint32_t)((cycles * 4096 + SystemCoreClock / 2) / SystemCoreClock) * 8;
+			expected = (uint32_t)(((uint64_t)periods * SystemCoreClock) / 32768);
+			
+			/* Calculate results */
+			Report->Clock.Measured = (uint32_t)((cycles * 32768) / periods);
+			Report->Clock.ErrorPPM = (int32_t)((((int64_t)cycles - expected) * 1000000) / expected);
+			Report->Clock.Status = TM_SELFTEST_Status_Ok;
+		}
+	}
+	
+	/* No capture, LSE is not connected to TIM5 */
+	if (Report->Clock.Status == TM_SELFTEST_Status_NotRun) {
+		Report->Clock.Status = TM_SELFTEST_Status_Error;
+	}
+	
+	/* Release timer */
+	TIM5->CR1 = 0;
+	TIM5->CCER = 0;
+	TIM5->CCMR2 = 0;
+	TIM5->OR = 0;
+	if (!clock_enabled) {
+		__HAL_RCC_TIM5_CLK_DISABLE();
+	}
+}
+#endif
+
+#if SELFTEST_USE_SDRAM
+static void TM_SELFTEST_INT_SDRAM(TM_SELFTEST_Report_t* Report) {
+	volatile uint32_t* ptr = (volatile uint32_t *)SELFTEST_SDRAM_ADDR;
+	uint32_t i, value, start, errors = 0;
+	
+	/* Write and read from SDRAM, not from cache */
+#if defined(STM32F7xx)
+	if (SCB->CCR & SCB_CCR_DC_Msk) {
+		SCB_CleanInvalidateDCache();
+	}
+#endif
+	
+	/* Sequential write, pattern changes all data bits */
+	value = 0;
+	start = TM_GENERAL_DWTCounterGetValue();
+	for (i = 0; i < SELFTEST_SDRAM_SIZE / 4; i++) {
+		ptr[i] = value;
+		value += 0x9E3779B9;
+	}
+	Report->SDRAM.Write = TM_SELFTEST_INT_Speed(SELFTEST_SDRAM_SIZE, TM_GENERAL_DWTCounterGetValue() - start);
+	
+#if defined(STM32F7xx)
+	if (SCB->CCR & SCB_CCR_DC_Msk) {
+		SCB_CleanInvalidateDCache();
+	}
+#endif
+	
+	/* Sequential read with check */
+	value = 0;
+	start = TM_GENERAL_DWTCounterGetValue();
+	for (i = 0; i < SELFTEST_SDRAM_SIZE / 4; i++) {
+		if (ptr[i] != value) {
+			errors++;
+		}
+		value += 0x9E3779B9;
+	}
+	Report->SDRAM.Read = TM_SELFTEST_INT_Speed(SELFTEST_SDRAM_SIZE, TM_GENERAL_DWTCounterGetValue() - start);
+	
+	/* Save status */
+	Report->SDRAM.Errors = errors;
+	Report->SDRAM.Status = errors ? TM_SELFTEST_Status_Error : TM_SELFTEST_Status_Ok;
+}
+#endif
+
+#if SELFTEST_USE_SPI
+static void TM_SELFTEST_INT_SPI(TM_SELFTEST_Report_t* Report) {
+	uint32_t pclk, i, chunk, offset, start, speed;
+	uint8_t presc;
+	
+	/* SPI1, SPI4, SPI5 and SPI6 are on APB2 */
+	pclk = HAL_RCC_GetPCLK1Freq();
+	if (
+		SELFTEST_SPI == SPI1
+#ifdef SPI4
+		|| SELFTEST_SPI == SPI4
+#endif
+#ifdef SPI5
+		|| SELFTEST_SPI == SPI5
+#endif
+#ifdef SPI6
+		|| SELFTEST_SPI == SPI6
+#endif
+	) {
+		pclk = HAL_RCC_GetPCLK2Freq();
+	}
+	
+	/* Test pattern */
+	for (i = 0; i < SELFTEST_SPI_SIZE; i++) {
+		SELFTEST_SPI_TX[i] = (uint8_t)(i * 0x35 + 0x5A);
+	}
+	
+	/* Find fastest prescaler, 2 to 256, with correct loopback data */
+	for (presc = 0; presc < 8; presc++) {
+		TM_SPI_InitFull(SELFTEST_SPI, SELFTEST_SPI_PINSPACK, presc << 3, TM_SPI_Mode_0, SPI_MODE_MASTER, SPI_FIRSTBIT_MSB);
+		memset(SELFTEST_SPI_RX, 0, SELFTEST_SPI_SIZE);
+		TM_SPI_SendMulti(SELFTEST_SPI, SELFTEST_SPI_TX, SELFTEST_SPI_RX, SELFTEST_SPI_SIZE);
+		if (memcmp(SELFTEST_SPI_TX, SELFTEST_SPI_RX, SELFTEST_SPI_SIZE) == 0) {
+			break;
+		}
+	}
+	
+	/* Not working at all, MOSI is probably not connected to MISO */
+	if (presc == 8) {
+		Report->SPI.Status = TM_SELFTEST_Status_Error;
+		return;
+	}
+	Report->SPI.Prescaler = presc << 3;
+	Report->SPI.Clock = pclk >> (presc + 1);
+	
+	/* DMA transfers of different chunk sizes, largest first */
+	TM_SPI_DMA_Init(SELFTEST_SPI);
+	for (chunk = SELFTEST_SPI_SIZE; chunk >= 16; chunk >>= 1) {
+		/* Send whole buffer in chunks */
+		start = TM_GENERAL_DWTCounterGetValue();
+		for (offset = 0; offset < SELFTEST_SPI_SIZE; offset += chunk) {
+			TM_SPI_DMA_Transmit(SELFTEST_SPI, &SELFTEST_SPI_TX[offset], &SELFTEST_SPI_RX[offset], chunk);
+			while (TM_SPI_DMA_Transmitting(SELFTEST_SPI));
+		}
+		speed = TM_SELFTEST_INT_Speed(SELFTEST_SPI_SIZE, TM_GENERAL_DWTCounterGetValue() - start);
+		
+		/* Speed with largest chunk is reference */
+		if (chunk == SELFTEST_SPI_SIZE) {
+			Report->SPI.Speed = speed;
+		}
+		
+		/* Smaller chunk is still fast enough */
+		if ((uint64_t)speed * 100 >= (uint64_t)Report->SPI.Speed * SELFTEST_CHUNK_PERCENT) {
+			Report->SPI.Chunk = chunk;
+		} else {
+			break;
+		}
+	}
+	
+	/* Check data from DMA transfers */
+	Report->SPI.Status = memcmp(SELFTEST_SPI_TX, SELFTEST_SPI_RX, SELFTEST_SPI_SIZE) == 0 ? TM_SELFTEST_Status_Ok : TM_SELFTEST_Status_Error;
+}
+#endif
+
+#if SELFTEST_USE_SDIO
+static void TM_SELFTEST_INT_SDIO(TM_SELFTEST_Report_t* Report) {
+	uint32_t chunk, sector, start, speed;
+	
+	/* Card must be inserted */
+	if (TM_FATFS_SD_SDIO_disk_initialize() & STA_NOINIT) {
+		Report->SD.Status = TM_SELFTEST_Status_NotAvailable;
+		return;
+	}
+	
+	/* Read the same number of sectors with different chunk sizes, largest first */
+	for (chunk = SELFTEST_SDIO_SECTORS; chunk >= 1; chunk >>= 1) {
+		start = TM_GENERAL_DWTCounterGetValue();
+		for (sector = 0; sector < 4 * SELFTEST_SDIO_SECTORS; sector += chunk) {
+			if (TM_FATFS_SD_SDIO_disk_read((BYTE *)SELFTEST_SDIO_Buffer, sector, chunk) != RES_OK) {
+				Report->SD.Status = TM_SELFTEST_Status_Error;
+				return;
+			}
+		}
+		speed = TM_SELFTEST_INT_Speed(4 * SELFTEST_SDIO_SECTORS * 512, TM_GENERAL_DWTCounterGetValue() - start);
+		
+		/* Speed with largest chunk is reference */
+		if (chunk == SELFTEST_SDIO_SECTORS) {
+			Report->SD.Speed = speed;
+		}
+		
+		/* Smaller chunk is still fast enough */
+		if ((uint64_t)speed * 100 >= (uint64_t)Report->SD.Speed * SELFTEST_CHUNK_PERCENT) {
+			Report->SD.Chunk = chunk;
+		} else {
+			break;
+		}
+	}
+	
+	/* Test done */
+	Report->SD.Status = TM_SELFTEST_Status_Ok;
+}
+#endif
+
+#if SELFTEST_USE_USB
+static void TM_SELFTEST_INT_USB(TM_SELFTEST_Report_t* Report) {
+	static const char Line[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz\r\n";
+	uint32_t tick, sent = 0;
+	
+	/* Device must be configured by host */
+	if (TM_USBD_IsDeviceReady(SELFTEST_USB) != TM_USBD_Result_Ok) {
+		Report->USB.Status = TM_SELFTEST_Status_NotAvailable;
+		return;
+	}
+	
+	/* Send as much as host reads, printable lines for terminal */
+	tick = HAL_GetTick();
+	while ((HAL_GetTick() - tick) < SELFTEST_USB_TIME) {
+		sent += TM_USBD_CDC_PutArray(SELFTEST_USB, (uint8_t *)Line, sizeof(Line) - 1);
+		TM_USBD_CDC_Process(SELFTEST_USB);
+	}
+	
+	/* Host did not read, terminal is not opened */
+	if (sent < 1024) {
+		Report->USB.Status = TM_SELFTEST_Status_NotAvailable;
+		return;
+	}
+	
+	/* Bytes accepted to TX buffer per second */
+	Report->USB.Speed = (uint32_t)(((uint64_t)sent * 1000) / SELFTEST_USB_TIME);
+	Report->USB.Status = TM_SELFTEST_Status_Ok;
+}
+#endif
+
+#if SELFTEST_USE_USART
+static void TM_SELFTEST_INT_USART(TM_SELFTEST_Report_t* Report) {
+	static const uint32_t Baudrates[] = {6000000, 4000000, 3000000, 2000000, 1500000, 1000000, 921600, 460800, 230400, 115200};
+	uint8_t data[16], i, j, c;
+	uint32_t pclk, tick;
+	
+	/* USART1 and USART6 are on APB2 */
+	pclk = HAL_RCC_GetPCLK1Freq();
+	if (
+		SELFTEST_USART == USART1
+#ifdef USART6
+		|| SELFTEST_USART == USART6
+#endif
+	) {
+		pclk = HAL_RCC_GetPCLK2Freq();
+	}
+	
+	/* Test pattern */
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)(i * 0x35 + 0x5A);
+	}
+	
+	/* Highest baudrate first, 16 times oversampling */
+	for (i = 0; i < sizeof(Baudrates) / sizeof(Baudrates[0]); i++) {
+		if (Baudrates[i] > pclk / 16) {
+			continue;
+		}
+		
+		/* Send pattern and wait for loopback data */
+		TM_USART_Init(SELFTEST_USART, SELFTEST_USART_PINSPACK, Baudrates[i]);
+		TM_USART_ClearBuffer(SELFTEST_USART);
+		TM_USART_Send(SELFTEST_USART, data, sizeof(data));
+		tick = HAL_GetTick();
+		while (TM_USART_BufferCount(SELFTEST_USART) < sizeof(data) && (HAL_GetTick() - tick) < 10);
+		
+		/* Check data */
+		for (j = 0; j < sizeof(data); j++) {
+			c = TM_USART_Getc(SELFTEST_USART);
+			if (c != data[j]) {
+				break;
+			}
+		}
+		
+		/* All data correct */
+		if (j == sizeof(data)) {
+			Report->USART.Baudrate = Baudrates[i];
+			Report->USART.Status = TM_SELFTEST_Status_Ok;
+			return;
+		}
+	}
+	
+	/* Not working at all, TX is probably not connected to RX */
+	Report->USART.Status = TM_SELFTEST_Status_Error;
+}
+#endif
@@ -0,0 +1,415 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Board self-test with bandwidth and clock calibration report
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_SELFTEST_H
+#define TM_SELFTEST_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_SELFTEST
+ * @brief    Board self-test with bandwidth and clock calibration report
+ * @{
+ *
+ * Library measures what a board actually achieves, instead of what datasheet says.
+ * Results are saved to flash with @ref TM_FLASHKV library, so drivers can read them on next boot
+ * and select prescalers and DMA chunk sizes for this unit.
+ *
+ * Run tests on first boot, when report is not in flash, or on command, for example from terminal.
+ * All tests are timed with DWT cycle counter.
+ *
+ * \par Tests
+ *
+\verbatim
+ - Clock: Core clock is measured against 32.768 kHz LSE crystal with TIM5 channel 4 input capture,
+          error is reported in ppm. LSE is started if not running yet
+ - SDRAM: CPU 32-bit sequential write and read with data check
+ - SPI:   Fastest prescaler with correct data in loopback and DMA chunk size for full speed.
+          MOSI must be connected to MISO
+ - SDIO:  Card read speed for different numbers of sectors in one read and chunk size for full speed.
+          Only reads are done, card content is not changed
+ - USB:   USB CDC transmit speed to host. Terminal must be opened on host
+ - USART: Highest baudrate with correct data in loopback. TX must be connected to RX
+\endverbatim
+ *
+ * Chunk size for full speed is the smallest one which reaches 90% of speed of the largest chunk.
+ * Larger chunks only use more memory.
+ *
+ * \par Configuration
+ *
+ * All tests except clock test are disabled by default, because they need peripherals and wiring of your board.
+ *
+\code
+//Clock test, disable on boards without LSE crystal
+#define SELFTEST_USE_CLOCK       1
+//Clock test duration in milliseconds
+#define SELFTEST_CLOCK_TIME      250
+
+//SDRAM test, area is overwritten
+#define SELFTEST_USE_SDRAM       1
+#define SELFTEST_SDRAM_ADDR      (SDRAM_START_ADR + SDRAM_MEMORY_SIZE / 2)
+#define SELFTEST_SDRAM_SIZE      0x10000
+
+//SPI loopback test
+#define SELFTEST_USE_SPI         1
+#define SELFTEST_SPI             SPI5
+#define SELFTEST_SPI_PINSPACK    TM_SPI_PinsPack_1
+
+//SDIO read test
+#define SELFTEST_USE_SDIO        1
+
+//USB CDC test, USB CDC must be initialized and started by user
+#define SELFTEST_USE_USB         1
+#define SELFTEST_USB             TM_USB_FS
+
+//USART loopback test
+#define SELFTEST_USE_USART       1
+#define SELFTEST_USART           USART6
+#define SELFTEST_USART_PINSPACK  TM_USART_PinsPack_1
+
+//Key for report in flash key-value store
+#define SELFTEST_KEY             0x5354
+\endcode
+ *
+ * @note  SPI and USART are left initialized with last tested settings, initialize them again after test
+ *
+ * \par Example
+ *
+\code
+//Print over USART
+void USART_Output(char* str) {
+	TM_USART_Puts(USART1, str);
+}
+
+TM_SELFTEST_Report_t Report;
+
+TM_FLASHKV_Init();
+TM_SELFTEST_Init();
+
+//Run tests when report is not saved yet or is from different clock settings
+if (TM_SELFTEST_Load(&Report) != TM_SELFTEST_Result_Ok) {
+	TM_SELFTEST_Run(&Report);
+	TM_SELFTEST_Save(&Report);
+}
+
+//Print compact report
+TM_SELFTEST_Print(&Report, USART_Output);
+
+//Driver uses measured SPI prescaler
+if (Report.SPI.Status == TM_SELFTEST_Status_Ok) {
+	TM_SPI_InitFull(SPI5, TM_SPI_PinsPack_1, Report.SPI.Prescaler, TM_SPI_Mode_0, SPI_MODE_MASTER, SPI_FIRSTBIT_MSB);
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM GENERAL
+ - TM FLASHKV
+ - TM SDRAM, when SDRAM test is used
+ - TM SPI and TM SPI DMA, when SPI test is used
+ - FATFS SDIO driver, when SDIO test is used
+ - TM USB DEVICE CDC, when USB test is used
+ - TM USART, when USART test is used
+\endverbatim
+ */
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_general.h"
+#include "tm_stm32_flashkv.h"
+#include "stdio.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_SELFTEST_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Tests, only clock test is enabled by default */
+#ifndef SELFTEST_USE_CLOCK
+#define SELFTEST_USE_CLOCK       1
+#endif
+#ifndef SELFTEST_USE_SDRAM
+#define SELFTEST_USE_SDRAM       0
+#endif
+#ifndef SELFTEST_USE_SPI
+#define SELFTEST_USE_SPI         0
+#endif
+#ifndef SELFTEST_USE_SDIO
+#define SELFTEST_USE_SDIO        0
+#endif
+#ifndef SELFTEST_USE_USB
+#define SELFTEST_USE_USB         0
+#endif
+#ifndef SELFTEST_USE_USART
+#define SELFTEST_USE_USART       0
+#endif
+
+/* Clock test duration in milliseconds */
+#ifndef SELFTEST_CLOCK_TIME
+#define SELFTEST_CLOCK_TIME      250
+#endif
+
+/* SDRAM test area */
+#ifndef SELFTEST_SDRAM_ADDR
+#define SELFTEST_SDRAM_ADDR      (SDRAM_START_ADR + SDRAM_MEMORY_SIZE / 2)
+#endif
+#ifndef SELFTEST_SDRAM_SIZE
+#define SELFTEST_SDRAM_SIZE      0x10000
+#endif
+
+/* SPI for loopback test */
+#ifndef SELFTEST_SPI
+#define SELFTEST_SPI             SPI1
+#define SELFTEST_SPI_PINSPACK    TM_SPI_PinsPack_1
+#endif
+
+/* Maximal DMA chunk size in SPI test in bytes, also size of test buffers */
+#ifndef SELFTEST_SPI_SIZE
+#define SELFTEST_SPI_SIZE        1024
+#endif
+
+/* Maximal number of sectors in one SDIO read, also size of test buffer */
+#ifndef SELFTEST_SDIO_SECTORS
+#define SELFTEST_SDIO_SECTORS    16
+#endif
+
+/* USB CDC mode and test duration in milliseconds */
+#ifndef SELFTEST_USB
+#define SELFTEST_USB             TM_USB_FS
+#endif
+#ifndef SELFTEST_USB_TIME
+#define SELFTEST_USB_TIME        500
+#endif
+
+/* USART for loopback test */
+#ifndef SELFTEST_USART
+#define SELFTEST_USART           USART1
+#define SELFTEST_USART_PINSPACK  TM_USART_PinsPack_1
+#endif
+
+/* Key for report in flash key-value store */
+#ifndef SELFTEST_KEY
+#define SELFTEST_KEY             0x5354
+#endif
+
+/* Include libraries for enabled tests */
+#if SELFTEST_USE_SDRAM
+#include "tm_stm32_sdram.h"
+#endif
+#if SELFTEST_USE_SPI
+#include "tm_stm32_spi.h"
+#include "tm_stm32_spi_dma.h"
+#endif
+#if SELFTEST_USE_SDIO
+#include "diskio.h"
+#endif
+#if SELFTEST_USE_USB
+#include "tm_stm32_usb_device_cdc.h"
+#endif
+#if SELFTEST_USE_USART
+#include "tm_stm32_usart.h"
+#endif
+
+/* Check settings */
+#if SELFTEST_USE_CLOCK && !defined(TIM5)
+#error "Clock test needs TIM5 with LSE input capture!"
+#endif
+#if (SELFTEST_SPI_SIZE & (SELFTEST_SPI_SIZE - 1)) || SELFTEST_SPI_SIZE < 16
+#error "SELFTEST_SPI_SIZE must be power of 2 and at least 16!"
+#endif
+#if (SELFTEST_SDIO_SECTORS & (SELFTEST_SDIO_SECTORS - 1)) || SELFTEST_SDIO_SECTORS == 0
+#error "SELFTEST_SDIO_SECTORS must be power of 2!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_SELFTEST_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_SELFTEST_Result_Ok = 0x00,   /*!< Everything OK */
+	TM_SELFTEST_Result_Error,       /*!< Flash error or DWT counter is not available */
+	TM_SELFTEST_Result_NotFound,    /*!< Report is not in flash */
+	TM_SELFTEST_Result_Invalid      /*!< Report in flash is for different library version or clock settings */
+} TM_SELFTEST_Result_t;
+
+/**
+ * @brief  Status of one test, saved as byte in report
+ */
+typedef enum {
+	TM_SELFTEST_Status_NotRun = 0x00, /*!< Test is disabled */
+	TM_SELFTEST_Status_Ok,            /*!< Test passed, values are valid */
+	TM_SELFTEST_Status_Error,         /*!< Test failed, for example data check error at all speeds */
+	TM_SELFTEST_Status_NotAvailable   /*!< Hardware is missing, for example no LSE, no card or USB not connected */
+} TM_SELFTEST_Status_t;
+
+/**
+ * @brief  Test report, saved to flash as is
+ */
+typedef struct {
+	uint16_t Version;             /*!< Report version, TM_SELFTEST_H value */
+	uint16_t Size;                /*!< Report size in bytes */
+	uint32_t CoreClock;           /*!< SystemCoreClock when tests were done, results are not valid for other clock settings */
+	struct {
+		uint8_t Status;           /*!< Member of @ref TM_SELFTEST_Status_t */
+		int32_t ErrorPPM;         /*!< Core clock error against LSE in units of ppm, positive when core is faster */
+		uint32_t Measured;        /*!< Measured core clock in units of Hz */
+	} Clock;                      /*!< Core clock accuracy */
+	struct {
+		uint8_t Status;           /*!< Member of @ref TM_SELFTEST_Status_t */
+		uint32_t Write;           /*!< Write speed in units of bytes per second */
+		uint32_t Read;            /*!< Read speed in units of bytes per second */
+		uint32_t Errors;          /*!< Number of words with wrong data */
+	} SDRAM;                      /*!< SDRAM bandwidth */
+	struct {
+		uint8_t Status;           /*!< Member of @ref TM_SELFTEST_Status_t */
+		uint16_t Prescaler;       /*!< Fastest working prescaler, SPI_BAUDRATEPRESCALER_x value for @ref TM_SPI_InitFull */
+		uint32_t Clock;           /*!< SPI clock with this prescaler in units of Hz */
+		uint32_t Speed;           /*!< DMA transfer speed with largest chunk in units of bytes per second */
+		uint16_t Chunk;           /*!< DMA chunk size in bytes for full speed */
+	} SPI;                        /*!< SPI bandwidth */
+	struct {
+		uint8_t Status;           /*!< Member of @ref TM_SELFTEST_Status_t */
+		uint32_t Speed;           /*!< Read speed with largest chunk in units of bytes per second */
+		uint16_t Chunk;           /*!< Number of sectors in one read for full speed */
+	} SD;                         /*!< SD card bandwidth */
+	struct {
+		uint8_t Status;           /*!< Member of @ref TM_SELFTEST_Status_t */
+		uint32_t Speed;           /*!< CDC transmit speed to host in units of bytes per second */
+	} USB;                        /*!< USB CDC bandwidth */
+	struct {
+		uint8_t Status;           /*!< Member of @ref TM_SELFTEST_Status_t */
+		uint32_t Baudrate;        /*!< Highest working baudrate */
+	} USART;                      /*!< USART speed */
+} TM_SELFTEST_Report_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_SELFTEST_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes DWT counter for test timing
+ * @param  None
+ * @retval Member of @ref TM_SELFTEST_Result_t enumeration
+ */
+TM_SELFTEST_Result_t TM_SELFTEST_Init(void);
+
+/**
+ * @brief  Runs all enabled tests
+ * @note   Tests take about 1 second, more with USB test. Interrupts stay enabled, tests use them
+ * @param  *Report: Pointer to @ref TM_SELFTEST_Report_t structure for results
+ * @retval None
+ */
+void TM_SELFTEST_Run(TM_SELFTEST_Report_t* Report);
+
+/**
+ * @brief  Saves report to flash key-value store with SELFTEST_KEY key
+ * @param  *Report: Pointer to @ref TM_SELFTEST_Report_t structure with results
+ * @retval Member of @ref TM_SELFTEST_Result_t enumeration
+ */
+TM_SELFTEST_Result_t TM_SELFTEST_Save(const TM_SELFTEST_Report_t* Report);
+
+/**
+ * @brief  Loads report from flash key-value store
+ * @note   @ref TM_FLASHKV_Init must be called first
+ * @param  *Report: Pointer to @ref TM_SELFTEST_Report_t structure to fill
+ * @retval Member of @ref TM_SELFTEST_Result_t enumeration:
+ *            - @ref TM_SELFTEST_Result_Ok: Report loaded and valid for current core clock
+ *            - @ref TM_SELFTEST_Result_NotFound: Report is not saved
+ *            - @ref TM_SELFTEST_Result_Invalid: Report is for other version or core clock, tests should be run again
+ */
+TM_SELFTEST_Result_t TM_SELFTEST_Load(TM_SELFTEST_Report_t* Report);
+
+/**
+ * @brief  Prints compact report, one line for each test
+ * @param  *Report: Pointer to @ref TM_SELFTEST_Report_t structure with results
+ * @param  *OutputFunc: Pointer to function which outputs string, for example over USART or USB CDC
+ * @retval None
+ */
+void TM_SELFTEST_Print(const TM_SELFTEST_Report_t* Report, void (*OutputFunc)(char *));
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,257 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_sensorhub.h"
+
+/* Hub structure */
+typedef struct {
+	TM_SENSORHUB_Sensor_t* First;                  /* List of sensors */
+	TM_SENSORHUB_Sensor_t* Active[SENSORHUB_BUSES]; /* Sensor with active transaction on each bus */
+	TM_SERIES_t* Series;                           /* Store for results */
+	uint16_t Frame;                                /* Time between rows */
+	uint16_t Row;                                  /* Row of current frame */
+	uint32_t Frames;                               /* Number of frames */
+	uint32_t FrameTime;                            /* Time of next frame */
+} TM_SENSORHUB_INT_t;
+
+static TM_SENSORHUB_INT_t SENSORHUB;
+
+/* Private functions */
+static void TM_SENSORHUB_INT_Finish(TM_SENSORHUB_Sensor_t* Sensor, uint32_t now, uint8_t result);
+static TM_SENSORHUB_Sensor_t* TM_SENSORHUB_INT_Pick(uint8_t Bus, uint32_t now);
+static uint8_t TM_SENSORHUB_INT_Start(TM_SENSORHUB_Sensor_t* Sensor, uint32_t now);
+
+uint8_t TM_SENSORHUB_Init(TM_SERIES_t* Series, uint16_t Frame) {
+	/* Check frame time */
+	if (Series != NULL && Frame == 0) {
+		return 0;
+	}
+	
+	/* Reset hub, first row is added on first update */
+	memset(&SENSORHUB, 0, sizeof(SENSORHUB));
+	SENSORHUB.Series = Series;
+	SENSORHUB.Frame = Frame;
+	SENSORHUB.FrameTime = HAL_GetTick();
+	
+	/* Return OK */
+	return 1;
+}
+
+uint8_t TM_SENSORHUB_Add(TM_SENSORHUB_Sensor_t* Sensor) {
+	TM_SENSORHUB_Sensor_t* s;
+	TM_SENSORHUB_Sensor_t** last = &SENSORHUB.First;
+	uint32_t offset = 0;
+	
+	/* Check sensor */
+	if (Sensor->Bus >= SENSORHUB_BUSES || Sensor->Period == 0 || Sensor->Start == NULL) {
+		return 0;
+	}
+	
+	/* Sum durations of sensors on the same bus and find end of list */
+	for (s = SENSORHUB.First; s != NULL; s = s->NextSensor) {
+		if (s == Sensor) {
+			return 0;
+		}
+		if (s->Bus == Sensor->Bus) {
+			offset += s->Duration;
+		}
+		last = &s->NextSensor;
+	}
+	
+	/* First start is after sensors already on the bus */
+	Sensor->Due = HAL_GetTick() + offset;
+	Sensor->Next = Sensor->Due;
+	Sensor->Phase = 0;
+	Sensor->Active = 0;
+	Sensor->Result = 0;
+	Sensor->NextSensor = NULL;
+	TM_SENSORHUB_ResetStats(Sensor);
+	
+	/* Add to end of list */
+	*last = Sensor;
+	
+	/* Return OK */
+	return 1;
+}
+
+void TM_SENSORHUB_Done(TM_SENSORHUB_Sensor_t* Sensor, uint8_t Ok) {
+	/* Save result, processed in update */
+	Sensor->Result = Ok ? 1 : 2;
+}
+
+uint8_t TM_SENSORHUB_Update(void) {
+	TM_SENSORHUB_Sensor_t* s;
+	uint32_t now = HAL_GetTick();
+	uint8_t bus, started = 0;
+	
+	/* New frame row */
+	if (SENSORHUB.Series != NULL && (int32_t)(now - SENSORHUB.FrameTime) >= 0) {
+		SENSORHUB.Row = TM_SERIES_AddRow(SENSORHUB.Series, SENSORHUB.FrameTime);
+		SENSORHUB.Frames++;
+		SENSORHUB.FrameTime += SENSORHUB.Frame;
+		
+		/* Update was late for more than one frame, skip missed rows */
+		if ((int32_t)(now - SENSORHUB.FrameTime) >= 0) {
+			SENSORHUB.FrameTime = now + SENSORHUB.Frame;
+		}
+	}
+	
+	/* Finish ended and timed out transactions */
+	for (bus = 0; bus < SENSORHUB_BUSES; bus++) {
+		s = SENSORHUB.Active[bus];
+		if (s == NULL) {
+			continue;
+		}
+		if (s->Result) {
+			TM_SENSORHUB_INT_Finish(s, now, s->Result);
+		} else if ((now - s->Started) > ((uint32_t)s->Duration + SENSORHUB_TIMEOUT)) {
+			TM_SENSORHUB_INT_Finish(s, now, 2);
+		}
+	}
+	
+	/* Start due sensors on free buses */
+	for (bus = 0; bus < SENSORHUB_BUSES; bus++) {
+		while (SENSORHUB.Active[bus] == NULL) {
+			s = TM_SENSORHUB_INT_Pick(bus, now);
+			if (s == NULL) {
+				break;
+			}
+			started += TM_SENSORHUB_INT_Start(s, now);
+		}
+	}
+	
+	/* Return number of started transactions */
+	return started;
+}
+
+uint8_t TM_SENSORHUB_IsBusy(uint8_t Bus) {
+	/* Check bus */
+	if (Bus >= SENSORHUB_BUSES) {
+		return 0;
+	}
+	return SENSORHUB.Active[Bus] != NULL;
+}
+
+void TM_SENSORHUB_ResetStats(TM_SENSORHUB_Sensor_t* Sensor) {
+	/* Reset counters */
+	Sensor->Reads = 0;
+	Sensor->Errors = 0;
+	Sensor->Overruns = 0;
+	Sensor->Jitter = 0;
+	Sensor->JitterMax = 0;
+}
+
+/* Private functions */
+static TM_SENSORHUB_Sensor_t* TM_SENSORHUB_INT_Pick(uint8_t Bus, uint32_t now) {
+	TM_SENSORHUB_Sensor_t* s;
+	TM_SENSORHUB_Sensor_t* best = NULL;
+	
+	/* Due sensor on bus with oldest due time */
+	for (s = SENSORHUB.First; s != NULL; s = s->NextSensor) {
+		if (s->Bus != Bus || s->Active || (int32_t)(now - s->Due) < 0) {
+			continue;
+		}
+		if (best == NULL || (int32_t)(s->Due - best->Due) < 0) {
+			best = s;
+		}
+	}
+	return best;
+}
+
+static uint8_t TM_SENSORHUB_INT_Start(TM_SENSORHUB_Sensor_t* Sensor, uint32_t now) {
+	uint32_t late = now - Sensor->Due;
+	
+	/* Phase 0 is start of new sample */
+	if (Sensor->Phase == 0) {
+		/* Jitter of sample time */
+		Sensor->Jitter = late > 0xFFFF ? 0xFFFF : (uint16_t)late;
+		if (Sensor->Jitter > Sensor->JitterMax) {
+			Sensor->JitterMax = Sensor->Jitter;
+		}
+		
+		/* Sample belongs to current frame */
+		Sensor->Frame = SENSORHUB.Frames;
+		Sensor->Row = SENSORHUB.Row;
+		
+		/* Keep cadence from due time, skip periods which are already missed */
+		Sensor->Next = Sensor->Due + Sensor->Period;
+		if ((int32_t)(now - Sensor->Next) >= 0) {
+			Sensor->Overruns += (now - Sensor->Next) / Sensor->Period + 1;
+			Sensor->Next = now + Sensor->Period;
+		}
+	}
+	
+	/* Occupy bus */
+	Sensor->Result = 0;
+	Sensor->Active = 1;
+	Sensor->Started = now;
+	SENSORHUB.Active[Sensor->Bus] = Sensor;
+	
+	/* Start transaction */
+	if (!Sensor->Start(Sensor, Sensor->Phase)) {
+		TM_SENSORHUB_INT_Finish(Sensor, now, 2);
+		return 0;
+	}
+	
+	/* Blocking driver finished already, bus is free for next sensor */
+	if (Sensor->Result) {
+		TM_SENSORHUB_INT_Finish(Sensor, now, Sensor->Result);
+	}
+	return 1;
+}
+
+static void TM_SENSORHUB_INT_Finish(TM_SENSORHUB_Sensor_t* Sensor, uint32_t now, uint8_t result) {
+	TM_SERIES_t* series = SENSORHUB.Series;
+	
+	/* Release bus */
+	Sensor->Active = 0;
+	SENSORHUB.Active[Sensor->Bus] = NULL;
+	
+	/* Phase 0 done, read after settle time */
+	if (result == 1 && Sensor->Phase == 0 && Sensor->Settle) {
+		Sensor->Phase = 1;
+		Sensor->Due = now + Sensor->Settle;
+		return;
+	}
+	
+	/* Wait for next period */
+	Sensor->Phase = 0;
+	Sensor->Due = Sensor->Next;
+	
+	/* Check result */
+	if (result != 1) {
+		Sensor->Errors++;
+		return;
+	}
+	Sensor->Reads++;
+	
+	/* Publish to row of sample, if it was not overwritten yet */
+	if (Sensor->Publish != NULL) {
+		if (series != NULL && (SENSORHUB.Frames - Sensor->Frame) >= series->Size) {
+			series = NULL;
+		}
+		Sensor->Publish(Sensor, series, Sensor->Row);
+	}
+}
@@ -0,0 +1,297 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Sensor hub scheduler for periodic multi-sensor polling on STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_SENSORHUB_H
+#define TM_SENSORHUB_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_SENSORHUB
+ * @brief    Sensor hub scheduler for periodic multi-sensor polling on STM32Fxxx
+ * @{
+ *
+ * Sensors are registered with period, bus index and expected bus time of one transaction.
+ * @ref TM_SENSORHUB_Update is called from main loop and starts transactions, so polling cadence is not hand written in main.c anymore.
+ *
+ * Only one transaction is active on each bus. When bus is free, sensor with the oldest due time on that bus is started (earliest deadline first),
+ * sensors on different buses run at the same time. Sensors are added with phase offset of durations of sensors already on the same bus,
+ * so sensors with the same period do not wait for each other. Cadence is kept from due time, so late start does not move next samples.
+ *
+ * Sensor starts transaction with asynchronous driver (queued I2C, DMA, input capture) and reports end with @ref TM_SENSORHUB_Done
+ * from driver callback, also from interrupt. Blocking drivers simply call @ref TM_SENSORHUB_Done before start function returns.
+ *
+ * \par Two phase sensors
+ *
+ * Sensors with conversion time, like DS18B20, set Settle member to conversion time. Phase 0 starts conversion and releases bus,
+ * phase 1 is started after settle time as soon as bus is free to read result. Other sensors use bus during conversion.
+ *
+ * \par Series store
+ *
+ * When hub is initialized with @ref TM_SERIES store, new row is added every frame. On success, Publish function
+ * gets row of frame in which sensor was started, so samples of different sensors are aligned by time.
+ * Sensors with longer period than frame leave @ref SERIES_INVALID in rows where they were not read.
+ *
+\code
+//Bus indexes
+#define BUS_ONEWIRE    0
+#define BUS_I2C1       1
+
+//DS18B20, conversion in phase 0, read in phase 1
+int16_t DS_Raw;
+uint8_t DS_Start(TM_SENSORHUB_Sensor_t* Sensor, uint8_t Phase) {
+	if (Phase == 0) {
+		TM_DS18B20_StartAll(&OneWire);
+		TM_SENSORHUB_Done(Sensor, 1);
+	} else {
+		TM_SENSORHUB_Done(Sensor, TM_DS18B20_ReadRaw(&OneWire, ROM, &DS_Raw));
+	}
+	return 1;
+}
+void DS_Publish(TM_SENSORHUB_Sensor_t* Sensor, TM_SERIES_t* Series, uint16_t Row) {
+	TM_SERIES_SET(Series, Row, Sensor->Channel, DS_Raw);
+}
+
+//MPU6050, queued I2C read of accelerometer, ends in I2C interrupt
+uint8_t MPU_Data[6];
+void MPU_Callback(I2C_TypeDef* I2Cx, uint8_t address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_SENSORHUB_Done((TM_SENSORHUB_Sensor_t *)Param, result == TM_I2C_Result_Ok);
+}
+uint8_t MPU_Start(TM_SENSORHUB_Sensor_t* Sensor, uint8_t Phase) {
+	return TM_I2C_ReadMultiQueued(MPU6050_I2C, MPU6050.Address, 0x3B, MPU_Data, 6, MPU_Callback, Sensor);
+}
+
+//Name, bus, first channel, period, duration, settle, start, publish
+TM_SENSORHUB_Sensor_t DS = {"ds18b20", BUS_ONEWIRE, 0, 1000, 15, 750, DS_Start, DS_Publish};
+TM_SENSORHUB_Sensor_t MPU = {"mpu6050", BUS_I2C1, 1, 10, 1, 0, MPU_Start, MPU_Publish};
+
+//Row every 10ms
+TM_SENSORHUB_Init(&Series, 10);
+TM_SENSORHUB_Add(&DS);
+TM_SENSORHUB_Add(&MPU);
+while (1) {
+	TM_SENSORHUB_Update();
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM SERIES
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_series.h"
+
+/**
+ * @defgroup TM_SENSORHUB_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of buses, bus index in sensor is from 0 to SENSORHUB_BUSES - 1 */
+#ifndef SENSORHUB_BUSES
+#define SENSORHUB_BUSES         4
+#endif
+
+/* Time in milliseconds over expected duration before transaction is treated as failed */
+#ifndef SENSORHUB_TIMEOUT
+#define SENSORHUB_TIMEOUT       100
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_SENSORHUB_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/* Forward declaration */
+struct _TM_SENSORHUB_Sensor_t;
+
+/**
+ * @brief  Starts sensor transaction
+ * @param  *Sensor: Pointer to sensor
+ * @param  Phase: 0 for first transaction, 1 for read after settle time
+ * @retval Start status:
+ *            - 0: Transaction not started, counted as error
+ *            - > 0: Transaction started, @ref TM_SENSORHUB_Done will be called
+ */
+typedef uint8_t (*TM_SENSORHUB_Start_t)(struct _TM_SENSORHUB_Sensor_t* Sensor, uint8_t Phase);
+
+/**
+ * @brief  Publishes sensor result
+ * @note   Called from @ref TM_SENSORHUB_Update after successful read
+ * @param  *Sensor: Pointer to sensor
+ * @param  *Series: Pointer to series store or NULL if hub has no store or row was already overwritten
+ * @param  Row: Row of frame when sensor was started
+ * @retval None
+ */
+typedef void (*TM_SENSORHUB_Publish_t)(struct _TM_SENSORHUB_Sensor_t* Sensor, TM_SERIES_t* Series, uint16_t Row);
+
+/**
+ * @brief  Sensor structure
+ */
+typedef struct _TM_SENSORHUB_Sensor_t {
+	const char* Name;               /*!< Sensor name */
+	uint8_t Bus;                    /*!< Bus index, sensors on the same bus never run at the same time */
+	uint8_t Channel;                /*!< First series channel used by sensor */
+	uint16_t Period;                /*!< Read period in milliseconds */
+	uint16_t Duration;              /*!< Expected bus time of one transaction in milliseconds */
+	uint16_t Settle;                /*!< Time between phase 0 and phase 1 in milliseconds, 0 for single transaction */
+	TM_SENSORHUB_Start_t Start;     /*!< Start function */
+	TM_SENSORHUB_Publish_t Publish; /*!< Publish function, can be NULL */
+	void* Param;                    /*!< User parameter */
+	uint32_t Reads;                 /*!< Number of successful reads */
+	uint32_t Errors;                /*!< Number of failed or timed out transactions */
+	uint32_t Overruns;              /*!< Number of skipped periods, sensor could not be read in time */
+	uint16_t Jitter;                /*!< Delay of last start after due time in milliseconds */
+	uint16_t JitterMax;             /*!< Maximal delay of start after due time in milliseconds */
+	uint32_t Due;                   /*!< Time of next transaction start. This is private member */
+	uint32_t Next;                  /*!< Time of next period. This is private member */
+	uint32_t Started;               /*!< Start time of active transaction. This is private member */
+	uint32_t Frame;                 /*!< Frame number of sample. This is private member */
+	uint16_t Row;                   /*!< Series row of sample. This is private member */
+	uint8_t Phase;                  /*!< Next or active phase. This is private member */
+	uint8_t Active;                 /*!< Transaction is active on bus. This is private member */
+	volatile uint8_t Result;        /*!< Transaction result, 0 = pending, 1 = OK, 2 = error. This is private member */
+	struct _TM_SENSORHUB_Sensor_t* NextSensor; /*!< Next sensor in list. This is private member */
+} TM_SENSORHUB_Sensor_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_SENSORHUB_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes sensor hub and removes all sensors
+ * @param  *Series: Pointer to @ref TM_SERIES_t store for results or NULL if not used
+ * @param  Frame: Time between series rows in milliseconds, usually period of fastest sensor
+ * @retval Initialization status:
+ *            - 0: Frame is 0 and store is used
+ *            - > 0: Initialized
+ */
+uint8_t TM_SENSORHUB_Init(TM_SERIES_t* Series, uint16_t Frame);
+
+/**
+ * @brief  Adds sensor to hub
+ * @note   Public members must be set before, sensor structure must stay valid while hub is running
+ * @param  *Sensor: Pointer to @ref TM_SENSORHUB_Sensor_t structure
+ * @retval Add status:
+ *            - 0: Bus index, period or start function is not valid
+ *            - > 0: Sensor added
+ */
+uint8_t TM_SENSORHUB_Add(TM_SENSORHUB_Sensor_t* Sensor);
+
+/**
+ * @brief  Reports end of sensor transaction
+ * @note   Can be called from interrupt or from start function itself
+ * @param  *Sensor: Pointer to sensor
+ * @param  Ok: Set to 1 when transaction was successful, 0 otherwise
+ * @retval None
+ */
+void TM_SENSORHUB_Done(TM_SENSORHUB_Sensor_t* Sensor, uint8_t Ok);
+
+/**
+ * @brief  Finishes ended transactions and starts due sensors on free buses
+ * @note   Must be called periodically from main loop, publish and start functions are called from here
+ * @param  None
+ * @retval Number of transactions started
+ */
+uint8_t TM_SENSORHUB_Update(void);
+
+/**
+ * @brief  Checks if bus has active transaction
+ * @param  Bus: Bus index
+ * @retval Bus status:
+ *            - 0: Bus is free
+ *            - > 0: Bus is busy
+ */
+uint8_t TM_SENSORHUB_IsBusy(uint8_t Bus);
+
+/**
+ * @brief  Resets statistics of sensor
+ * @param  *Sensor: Pointer to sensor
+ * @retval None
+ */
+void TM_SENSORHUB_ResetStats(TM_SENSORHUB_Sensor_t* Sensor);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
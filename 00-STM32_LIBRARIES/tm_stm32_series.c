@@ -0,0 +1,252 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_series.h"
+
+/* Private functions */
+static uint16_t TM_SERIES_INT_Rows(TM_SERIES_t* Series, uint16_t Last);
+static void TM_SERIES_INT_Put16(uint8_t* data, uint16_t value);
+
+uint8_t TM_SERIES_Init(TM_SERIES_t* Series, uint32_t* Time, TM_SERIES_Channel_t* Channels, uint8_t ChannelCount, uint16_t Size) {
+	/* Check parameters */
+	if (Time == NULL || Channels == NULL || ChannelCount == 0 || Size == 0) {
+		return 0;
+	}
+	
+	/* Fill structure */
+	Series->Time = Time;
+	Series->Channels = Channels;
+	Series->ChannelCount = ChannelCount;
+	Series->Size = Size;
+	TM_SERIES_Clear(Series);
+	
+	/* Return OK */
+	return 1;
+}
+
+void TM_SERIES_Clear(TM_SERIES_t* Series) {
+	/* Reset ring */
+	Series->Count = 0;
+	Series->Head = 0;
+	Series->Overwritten = 0;
+}
+
+uint16_t TM_SERIES_AddRow(TM_SERIES_t* Series, uint32_t Time) {
+	uint16_t row = Series->Head;
+	uint8_t i;
+	
+	/* Oldest row is overwritten */
+	if (Series->Count < Series->Size) {
+		Series->Count++;
+	} else {
+		Series->Overwritten++;
+	}
+	if (++Series->Head >= Series->Size) {
+		Series->Head = 0;
+	}
+	
+	/* Set timestamp, samples are not valid until written */
+	Series->Time[row] = Time;
+	for (i = 0; i < Series->ChannelCount; i++) {
+		Series->Channels[i].Data[row] = SERIES_INVALID;
+	}
+	
+	/* Return row index */
+	return row;
+}
+
+uint8_t TM_SERIES_GetSpans(TM_SERIES_t* Series, uint16_t Last, TM_SERIES_Span_t* Spans) {
+	uint16_t rows = TM_SERIES_INT_Rows(Series, Last);
+	
+	/* Empty store */
+	if (!rows) {
+		return 0;
+	}
+	
+	/* Rows end just before head */
+	if (rows <= Series->Head) {
+		Spans[0].Start = Series->Head - rows;
+		Spans[0].Length = rows;
+		return 1;
+	}
+	
+	/* Rows wrap around end of arrays */
+	Spans[0].Start = Series->Size - (rows - Series->Head);
+	Spans[0].Length = rows - Series->Head;
+	Spans[1].Start = 0;
+	Spans[1].Length = Series->Head;
+	
+	/* Head is 0 when last row is at the end of arrays */
+	return Series->Head ? 2 : 1;
+}
+
+uint16_t TM_SERIES_GetStats(TM_SERIES_t* Series, uint8_t Channel, uint16_t Last, TM_SERIES_Stats_t* Stats) {
+	TM_SERIES_Span_t Spans[2];
+	const int16_t* data;
+	int32_t sum = 0;
+	int16_t min = INT16_MAX, max = INT16_MIN, v;
+	uint16_t count = 0, i, n;
+	uint8_t s, spans;
+	
+	/* Check channel */
+	spans = Channel < Series->ChannelCount ? TM_SERIES_GetSpans(Series, Last, Spans) : 0;
+	
+	/* Loop over contiguous samples */
+	for (s = 0; s < spans; s++) {
+		data = &Series->Channels[Channel].Data[Spans[s].Start];
+		n = Spans[s].Length;
+		for (i = 0; i < n; i++) {
+			v = data[i];
+			if (v == SERIES_INVALID) {
+				continue;
+			}
+			if (v < min) {
+				min = v;
+			}
+			if (v > max) {
+				max = v;
+			}
+			sum += v;
+			count++;
+		}
+	}
+	
+	/* Save statistics */
+	Stats->Count = count;
+	Stats->Sum = sum;
+	if (count) {
+		Stats->Min = min;
+		Stats->Max = max;
+		Stats->Mean = sum >= 0 ? sum / count : -((-sum + count - 1) / count);
+	} else {
+		Stats->Min = Stats->Max = Stats->Mean = SERIES_INVALID;
+	}
+	
+	/* Return number of valid samples */
+	return count;
+}
+
+uint16_t TM_SERIES_Filter(TM_SERIES_t* Series, uint8_t Channel, uint16_t Last, uint8_t Shift, int16_t* Output) {
+	TM_SERIES_Span_t Spans[2];
+	const int16_t* data;
+	int32_t y = 0;
+	uint16_t count = 0, i, n;
+	uint8_t s, spans, first = 1;
+	
+	/* Check parameters */
+	if (Channel >= Series->ChannelCount || Shift > 15) {
+		return 0;
+	}
+	spans = TM_SERIES_GetSpans(Series, Last, Spans);
+	
+	/* Loop over contiguous samples, filter state has 16 fractional bits */
+	for (s = 0; s < spans; s++) {
+		data = &Series->Channels[Channel].Data[Spans[s].Start];
+		n = Spans[s].Length;
+		for (i = 0; i < n; i++) {
+			if (data[i] != SERIES_INVALID) {
+				if (first) {
+					/* Start from first valid sample */
+					y = (int32_t)data[i] << 16;
+					first = 0;
+				} else {
+					y += (((int32_t)data[i] << 16) - y) >> Shift;
+				}
+			}
+			Output[count++] = first ? SERIES_INVALID : (int16_t)((y + 0x8000) >> 16);
+		}
+	}
+	
+	/* Return number of samples */
+	return count;
+}
+
+uint32_t TM_SERIES_Pack(TM_SERIES_t* Series, uint16_t Last, uint8_t* Buffer, uint32_t Size) {
+	TM_SERIES_Span_t Spans[2];
+	const int16_t* data;
+	uint8_t* ptr;
+	uint32_t row, prev;
+	uint16_t rows, i, n;
+	uint8_t c, s, spans;
+	
+	/* Header with first timestamp is 7 bytes, each next row has time difference and samples */
+	rows = TM_SERIES_INT_Rows(Series, Last);
+	if (Size < 7 + 2 * (uint32_t)Series->ChannelCount) {
+		return 0;
+	}
+	row = 1 + (Size - 7 - 2 * (uint32_t)Series->ChannelCount) / (2 + 2 * (uint32_t)Series->ChannelCount);
+	if (rows > row) {
+		rows = row;
+	}
+	spans = TM_SERIES_GetSpans(Series, rows, Spans);
+	if (!spans) {
+		return 0;
+	}
+	
+	/* Header */
+	TM_SERIES_INT_Put16(&Buffer[0], rows);
+	Buffer[2] = Series->ChannelCount;
+	prev = Series->Time[Spans[0].Start];
+	TM_SERIES_INT_Put16(&Buffer[3], prev & 0xFFFF);
+	TM_SERIES_INT_Put16(&Buffer[5], prev >> 16);
+	ptr = &Buffer[7];
+	
+	/* Timestamp differences */
+	for (s = 0; s < spans; s++) {
+		n = Spans[s].Length;
+		for (i = s ? 0 : 1; i < n; i++) {
+			row = Series->Time[Spans[s].Start + i];
+			TM_SERIES_INT_Put16(ptr, row - prev);
+			ptr += 2;
+			prev = row;
+		}
+	}
+	
+	/* Columns, one after another */
+	for (c = 0; c < Series->ChannelCount; c++) {
+		for (s = 0; s < spans; s++) {
+			data = &Series->Channels[c].Data[Spans[s].Start];
+			n = Spans[s].Length;
+			for (i = 0; i < n; i++) {
+				TM_SERIES_INT_Put16(ptr, data[i]);
+				ptr += 2;
+			}
+		}
+	}
+	
+	/* Return number of bytes */
+	return ptr - Buffer;
+}
+
+static uint16_t TM_SERIES_INT_Rows(TM_SERIES_t* Series, uint16_t Last) {
+	/* Limit to rows in store */
+	return Last < Series->Count ? Last : Series->Count;
+}
+
+static void TM_SERIES_INT_Put16(uint8_t* data, uint16_t value) {
+	/* Little endian */
+	data[0] = value & 0xFF;
+	data[1] = value >> 8;
+}
@@ -0,0 +1,313 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Time series sample store with column for each channel
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_SERIES_H
+#define TM_SERIES_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_SERIES
+ * @brief    Time series sample store with column for each channel
+ * @{
+ *
+ * Store keeps samples of many channels, for example temperatures from DS18B20 sensors, temperature and humidity from AM2301
+ * and accelerometer and gyroscope axes from MPU6050, together with one shared timestamp column.
+ *
+ * Each channel has its own array of samples (structure of arrays), so all samples of one channel are in contiguous memory.
+ * Statistics, filtering and packing are simple loops over one array, without copying values from sensor structures first.
+ * Samples are 16-bit fixed point numbers, value in units is sample divided by channel scale,
+ * for example scale 10 for AM2301 temperature in tenths of degree and 16 for raw DS18B20 temperature.
+ *
+ * Rows make ring buffer, oldest row is overwritten when store is full.
+ * One row has timestamp and one sample for each channel. New row is added with @ref TM_SERIES_AddRow
+ * and all its samples are set to @ref SERIES_INVALID, so channels which were not read are skipped in statistics.
+ * Drivers write samples to row directly with their series functions,
+ * enable them in defines.h file with AM2301_USE_SERIES, DS18B20_USE_SERIES and MPU6050_USE_SERIES.
+ *
+ * Last rows of store are in at most 2 contiguous spans, get them with @ref TM_SERIES_GetSpans for custom processing.
+ *
+\code
+#define ROWS    256
+
+//Columns, memory is owned by user
+uint32_t Time[ROWS];
+int16_t Temp[ROWS], Hum[ROWS], Water[ROWS];
+int16_t Acc[6][ROWS];
+
+TM_SERIES_Channel_t Channels[] = {
+	{"TEMP", Temp, 10},
+	{"HUM", Hum, 10},
+	{"WATER", Water, 16},
+	{"AX", Acc[0], 1}, {"AY", Acc[1], 1}, {"AZ", Acc[2], 1},
+	{"GX", Acc[3], 1}, {"GY", Acc[4], 1}, {"GZ", Acc[5], 1},
+};
+TM_SERIES_t Series;
+TM_SERIES_Stats_t Stats;
+
+TM_SERIES_Init(&Series, Time, Channels, 9, ROWS);
+
+//Each second, drivers write to new row
+row = TM_SERIES_AddRow(&Series, HAL_GetTick());
+TM_AM2301_ReadSeries(&AM2301, &Series, row, 0);
+TM_DS18B20_ReadSeries(&OneWire, ROM, &Series, row, 2);
+TM_MPU6050_ReadSeries(&MPU6050, &Series, row, 3);
+
+//Statistics of temperature in last minute
+TM_SERIES_GetStats(&Series, 0, 60, &Stats);
+
+//Pack last 32 rows to buffer for transmission
+len = TM_SERIES_Pack(&Series, 32, Buffer, sizeof(Buffer));
+\endcode
+ *
+ * \par Packet format
+ *
+ * @ref TM_SERIES_Pack writes data column after column, all numbers are little endian:
+ *  - Number of rows, 16-bit and number of channels, 8-bit
+ *  - Timestamp of first row, 32-bit
+ *  - Timestamp differences to previous row, 16-bit for each next row
+ *  - Samples of first channel for all rows, 16-bit each, then samples of second channel, ...
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_SERIES_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Sample value for channel which was not written in row
+ */
+#define SERIES_INVALID             ((int16_t)0x8000)
+
+/**
+ * @brief  Gets pointer to sample of channel in row
+ * @param  Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Row: Row index from @ref TM_SERIES_AddRow
+ * @param  Channel: Channel index
+ * @retval Pointer to 16-bit sample
+ */
+#define TM_SERIES_CELL(Series, Row, Channel)       (&(Series)->Channels[(Channel)].Data[(Row)])
+
+/**
+ * @brief  Sets sample of channel in row
+ * @param  Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Row: Row index from @ref TM_SERIES_AddRow
+ * @param  Channel: Channel index
+ * @param  Value: 16-bit fixed point value
+ * @retval None
+ */
+#define TM_SERIES_SET(Series, Row, Channel, Value) (*TM_SERIES_CELL(Series, Row, Channel) = (int16_t)(Value))
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_SERIES_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Channel column
+ */
+typedef struct {
+	const char* Name; /*!< Channel name */
+	int16_t* Data;    /*!< Pointer to array of samples, at least Size elements from @ref TM_SERIES_t */
+	uint16_t Scale;   /*!< Value in units is sample divided by scale */
+} TM_SERIES_Channel_t;
+
+/**
+ * @brief  Series store structure
+ */
+typedef struct {
+	uint32_t* Time;                /*!< Pointer to timestamp column, at least Size elements */
+	TM_SERIES_Channel_t* Channels; /*!< Pointer to table of channels */
+	uint8_t ChannelCount;          /*!< Number of channels */
+	uint16_t Size;                 /*!< Maximal number of rows */
+	uint16_t Count;                /*!< Number of rows with data */
+	uint16_t Head;                 /*!< Index of next row */
+	uint32_t Overwritten;          /*!< Number of rows overwritten when store was full */
+} TM_SERIES_t;
+
+/**
+ * @brief  Contiguous span of rows
+ */
+typedef struct {
+	uint16_t Start;  /*!< Index of first row */
+	uint16_t Length; /*!< Number of rows */
+} TM_SERIES_Span_t;
+
+/**
+ * @brief  Channel statistics
+ */
+typedef struct {
+	uint16_t Count; /*!< Number of valid samples */
+	int16_t Min;    /*!< Minimal sample */
+	int16_t Max;    /*!< Maximal sample */
+	int32_t Sum;    /*!< Sum of valid samples */
+	int16_t Mean;   /*!< Mean of valid samples, rounded down */
+} TM_SERIES_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_SERIES_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes empty series store
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @param  *Time: Pointer to timestamp column with Size elements
+ * @param  *Channels: Pointer to table of channels, Data member of each channel must have Size elements
+ * @param  ChannelCount: Number of channels
+ * @param  Size: Maximal number of rows
+ * @retval Initialization status:
+ *            - 0: Parameters are not valid
+ *            - > 0: Store initialized
+ */
+uint8_t TM_SERIES_Init(TM_SERIES_t* Series, uint32_t* Time, TM_SERIES_Channel_t* Channels, uint8_t ChannelCount, uint16_t Size);
+
+/**
+ * @brief  Removes all rows from store
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @retval None
+ */
+void TM_SERIES_Clear(TM_SERIES_t* Series);
+
+/**
+ * @brief  Adds new row with timestamp, oldest row is overwritten when store is full
+ * @note   All samples in row are set to @ref SERIES_INVALID
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Time: Timestamp of row, for example HAL tick in milliseconds
+ * @retval Row index for @ref TM_SERIES_SET and driver series functions
+ */
+uint16_t TM_SERIES_AddRow(TM_SERIES_t* Series, uint32_t Time);
+
+/**
+ * @brief  Gets contiguous spans of last rows, oldest first
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Last: Number of last rows, all rows are used when larger than number of rows in store
+ * @param  *Spans: Pointer to array of 2 @ref TM_SERIES_Span_t structures
+ * @retval Number of used spans, 0 to 2
+ */
+uint8_t TM_SERIES_GetSpans(TM_SERIES_t* Series, uint16_t Last, TM_SERIES_Span_t* Spans);
+
+/**
+ * @brief  Calculates minimum, maximum and mean of channel in last rows
+ * @note   Samples with @ref SERIES_INVALID value are skipped
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Channel: Channel index
+ * @param  Last: Number of last rows
+ * @param  *Stats: Pointer to @ref TM_SERIES_Stats_t structure to save statistics to
+ * @retval Number of valid samples
+ */
+uint16_t TM_SERIES_GetStats(TM_SERIES_t* Series, uint8_t Channel, uint16_t Last, TM_SERIES_Stats_t* Stats);
+
+/**
+ * @brief  Filters channel in last rows with first order low pass filter, y += (x - y) / 2^Shift
+ * @note   Samples with @ref SERIES_INVALID value are not used and previous output is repeated
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Channel: Channel index
+ * @param  Last: Number of last rows
+ * @param  Shift: Filter strength, 0 to 15, 0 means no filtering
+ * @param  *Output: Pointer to array where filtered samples will be saved, oldest first
+ * @retval Number of samples saved to output
+ */
+uint16_t TM_SERIES_Filter(TM_SERIES_t* Series, uint8_t Channel, uint16_t Last, uint8_t Shift, int16_t* Output);
+
+/**
+ * @brief  Packs last rows to buffer for transmission, column after column
+ * @note   When buffer is too small for all last rows, newest rows which fit are packed
+ * @param  *Series: Pointer to @ref TM_SERIES_t structure
+ * @param  Last: Number of last rows
+ * @param  *Buffer: Pointer to output buffer
+ * @param  Size: Size of buffer in bytes
+ * @retval Number of bytes written to buffer, 0 if buffer is too small for one row
+ */
+uint32_t TM_SERIES_Pack(TM_SERIES_t* Series, uint16_t Last, uint8_t* Buffer, uint32_t Size);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,6 +18,32 @@
  */
 #include "tm_stm32_spi.h"
 
+/* Only SPIs enabled in defines.h are compiled in, all available SPIs when none is enabled */
+#if defined(TM_SPI1_ENABLED) || defined(TM_SPI2_ENABLED) || defined(TM_SPI3_ENABLED) || defined(TM_SPI4_ENABLED) || defined(TM_SPI5_ENABLED) || defined(TM_SPI6_ENABLED)
+#define SPI_INT_SELECTED            1
+#else
+#define SPI_INT_SELECTED            0
+#endif
+
+#if defined(SPI1) && (!SPI_INT_SELECTED || defined(TM_SPI1_ENABLED))
+#define SPI_INT_USE_SPI1
+#endif
+#if defined(SPI2) && (!SPI_INT_SELECTED || defined(TM_SPI2_ENABLED))
+#define SPI_INT_USE_SPI2
+#endif
+#if defined(SPI3) && (!SPI_INT_SELECTED || defined(TM_SPI3_ENABLED))
+#define SPI_INT_USE_SPI3
+#endif
+#if defined(SPI4) && (!SPI_INT_SELECTED || defined(TM_SPI4_ENABLED))
+#define SPI_INT_USE_SPI4
+#endif
+#if defined(SPI5) && (!SPI_INT_SELECTED || defined(TM_SPI5_ENABLED))
+#define SPI_INT_USE_SPI5
+#endif
+#if defined(SPI6) && (!SPI_INT_SELECTED || defined(TM_SPI6_ENABLED))
+#define SPI_INT_USE_SPI6
+#endif
+
 /* Defines for alternate functions */
 #if defined(STM32F4xx) || defined(STM32F7xx)
 #define GPIO_AFx_SPI1    GPIO_AF5_SPI1
@@ -40,73 +66,148 @@ void TM_SPI3_INT_InitPins(TM_SPI_PinsPack_t pinspack);
 void TM_SPI4_INT_InitPins(TM_SPI_PinsPack_t pinspack);
 void TM_SPI5_INT_InitPins(TM_SPI_PinsPack_t pinspack);
 void TM_SPI6_INT_InitPins(TM_SPI_PinsPack_t pinspack);
+static void TM_SPI_INT_WaitEnd(SPI_TypeDef* SPIx);
+static void TM_SPI_INT_FlushRX(SPI_TypeDef* SPIx);
+static void TM_SPI_INT_Exchange(SPI_TypeDef* SPIx, uint8_t* dataOut, uint8_t* dataIn, uint8_t dummy, uint32_t count);
+static void TM_SPI_INT_Exchange16(SPI_TypeDef* SPIx, uint16_t* dataOut, uint16_t* dataIn, uint16_t dummy, uint32_t count);
 
-void TM_SPI_Init(SPI_TypeDef* SPIx, TM_SPI_PinsPack_t pinspack) {
-	/* Init with default settings */
-#ifdef SPI1
-	if (SPIx == SPI1) {
-		TM_SPIx_Init(SPI1, pinspack, TM_SPI1_MODE, TM_SPI1_PRESCALER, TM_SPI1_MASTERSLAVE, TM_SPI1_FIRSTBIT);
-	}
+/* 
+ * Maximal number of frames sent but not yet read, RX can never overflow.
+ * STM32F0xx and STM32F7xx have 32-bit RX FIFO, STM32F4xx has only data register
+ */
+#if defined(SPI_SR_FRLVL)
+#define SPI_INT_WINDOW8                4
+#define SPI_INT_WINDOW16               2
+#else
+#define SPI_INT_WINDOW8                1
+#define SPI_INT_WINDOW16               1
 #endif
-#ifdef SPI2
-	if (SPIx == SPI2) {
-		TM_SPIx_Init(SPI2, pinspack, TM_SPI2_MODE, TM_SPI2_PRESCALER, TM_SPI2_MASTERSLAVE, TM_SPI2_FIRSTBIT);
-	}
+
+/* SPI index in config table, only available instances are included */
+typedef enum {
+#ifdef SPI_INT_USE_SPI1
+	SPI_INT_SPI1,
 #endif
-#ifdef SPI3
-	if (SPIx == SPI3) {
-		TM_SPIx_Init(SPI3, pinspack, TM_SPI3_MODE, TM_SPI3_PRESCALER, TM_SPI3_MASTERSLAVE, TM_SPI3_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI2
+	SPI_INT_SPI2,
 #endif
-#ifdef SPI4
-	if (SPIx == SPI4) {
-		TM_SPIx_Init(SPI4, pinspack, TM_SPI4_MODE, TM_SPI4_PRESCALER, TM_SPI4_MASTERSLAVE, TM_SPI4_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI3
+	SPI_INT_SPI3,
 #endif
-#ifdef SPI5
-	if (SPIx == SPI5) {
-		TM_SPIx_Init(SPI5, pinspack, TM_SPI5_MODE, TM_SPI5_PRESCALER, TM_SPI5_MASTERSLAVE, TM_SPI5_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI4
+	SPI_INT_SPI4,
 #endif
-#ifdef SPI6
-	if (SPIx == SPI6) {
-		TM_SPIx_Init(SPI6, pinspack, TM_SPI6_MODE, TM_SPI6_PRESCALER, TM_SPI6_MASTERSLAVE, TM_SPI6_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI5
+	SPI_INT_SPI5,
 #endif
-}
+#ifdef SPI_INT_USE_SPI6
+	SPI_INT_SPI6,
+#endif
+	SPI_INT_COUNT
+} TM_SPI_INT_Index_t;
 
-void TM_SPI_InitWithMode(SPI_TypeDef* SPIx, TM_SPI_PinsPack_t pinspack, TM_SPI_Mode_t SPI_Mode) {
-	/* Init with custom mode, 0, 1, 2, 3 */
-#ifdef SPI1
-	if (SPIx == SPI1) {
-		TM_SPIx_Init(SPI1, pinspack, SPI_Mode, TM_SPI1_PRESCALER, TM_SPI1_MASTERSLAVE, TM_SPI1_FIRSTBIT);
-	}
+/* Constant settings for each SPI */
+typedef struct {
+	SPI_TypeDef* SPIx;                             /* Pointer to SPI instance */
+#if STATS_ENABLED
+	const char* Name;                              /* Name for statistics */
+#endif
+	void (*InitPins)(TM_SPI_PinsPack_t pinspack);  /* Function for pins initialization */
+	uint32_t RCC_Mask;                             /* Clock enable bit */
+	uint8_t APB2;                                  /* Set to 1 when SPI is on APB2 bus, 0 for APB1 */
+	TM_SPI_Mode_t Mode;                            /* Default SPI mode */
+	uint16_t Prescaler;                            /* Default prescaler */
+	uint16_t MasterSlave;                          /* Default master or slave mode */
+	uint16_t FirstBit;                             /* Default first bit */
+	uint16_t DataSize;                             /* Default data size */
+} TM_SPI_INT_Config_t;
+
+/* Name is included only with statistics */
+#if STATS_ENABLED
+#define SPI_INT_NAME(x)                #x,
+#else
+#define SPI_INT_NAME(x)
 #endif
-#ifdef SPI2
-	if (SPIx == SPI2) {
-		TM_SPIx_Init(SPI2, pinspack, SPI_Mode, TM_SPI2_PRESCALER, TM_SPI2_MASTERSLAVE, TM_SPI2_FIRSTBIT);
-	}
+
+static const TM_SPI_INT_Config_t SPI_Config[SPI_INT_COUNT] = {
+#ifdef SPI_INT_USE_SPI1
+	[SPI_INT_SPI1] = {SPI1, SPI_INT_NAME(SPI1) TM_SPI1_INT_InitPins, RCC_APB2ENR_SPI1EN, 1, TM_SPI1_MODE, TM_SPI1_PRESCALER, TM_SPI1_MASTERSLAVE, TM_SPI1_FIRSTBIT, TM_SPI1_DATASIZE},
 #endif
-#ifdef SPI3
-	if (SPIx == SPI3) {
-		TM_SPIx_Init(SPI3, pinspack, SPI_Mode, TM_SPI3_PRESCALER, TM_SPI3_MASTERSLAVE, TM_SPI3_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI2
+	[SPI_INT_SPI2] = {SPI2, SPI_INT_NAME(SPI2) TM_SPI2_INT_InitPins, RCC_APB1ENR_SPI2EN, 0, TM_SPI2_MODE, TM_SPI2_PRESCALER, TM_SPI2_MASTERSLAVE, TM_SPI2_FIRSTBIT, TM_SPI2_DATASIZE},
 #endif
-#ifdef SPI4
-	if (SPIx == SPI4) {
-		TM_SPIx_Init(SPI4, pinspack, SPI_Mode, TM_SPI4_PRESCALER, TM_SPI4_MASTERSLAVE, TM_SPI4_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI3
+	[SPI_INT_SPI3] = {SPI3, SPI_INT_NAME(SPI3) TM_SPI3_INT_InitPins, RCC_APB1ENR_SPI3EN, 0, TM_SPI3_MODE, TM_SPI3_PRESCALER, TM_SPI3_MASTERSLAVE, TM_SPI3_FIRSTBIT, TM_SPI3_DATASIZE},
 #endif
-#ifdef SPI5
-	if (SPIx == SPI5) {
-		TM_SPIx_Init(SPI5, pinspack, SPI_Mode, TM_SPI5_PRESCALER, TM_SPI5_MASTERSLAVE, TM_SPI5_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI4
+	[SPI_INT_SPI4] = {SPI4, SPI_INT_NAME(SPI4) TM_SPI4_INT_InitPins, RCC_APB2ENR_SPI4EN, 1, TM_SPI4_MODE, TM_SPI4_PRESCALER, TM_SPI4_MASTERSLAVE, TM_SPI4_FIRSTBIT, TM_SPI4_DATASIZE},
 #endif
-#ifdef SPI6
-	if (SPIx == SPI6) {
-		TM_SPIx_Init(SPI6, pinspack, SPI_Mode, TM_SPI6_PRESCALER, TM_SPI6_MASTERSLAVE, TM_SPI6_FIRSTBIT);
-	}
+#ifdef SPI_INT_USE_SPI5
+	[SPI_INT_SPI5] = {SPI5, SPI_INT_NAME(SPI5) TM_SPI5_INT_InitPins, RCC_APB2ENR_SPI5EN, 1, TM_SPI5_MODE, TM_SPI5_PRESCALER, TM_SPI5_MASTERSLAVE, TM_SPI5_FIRSTBIT, TM_SPI5_DATASIZE},
+#endif
+#ifdef SPI_INT_USE_SPI6
+	[SPI_INT_SPI6] = {SPI6, SPI_INT_NAME(SPI6) TM_SPI6_INT_InitPins, RCC_APB2ENR_SPI6EN, 1, TM_SPI6_MODE, TM_SPI6_PRESCALER, TM_SPI6_MASTERSLAVE, TM_SPI6_FIRSTBIT, TM_SPI6_DATASIZE},
 #endif
+};
+
+/* Index from SPI base address, bits 13:10 are different for all SPIs on STM32F0xx, STM32F4xx and STM32F7xx */
+#define SPI_INT_ID(SPIx)               ((((uint32_t)(SPIx)) >> 10) & 0x0F)
+
+static const uint8_t SPI_Index[16] = {
+#ifdef SPI_INT_USE_SPI1
+	[SPI_INT_ID(SPI1_BASE)] = SPI_INT_SPI1,
+#endif
+#ifdef SPI_INT_USE_SPI2
+	[SPI_INT_ID(SPI2_BASE)] = SPI_INT_SPI2,
+#endif
+#ifdef SPI_INT_USE_SPI3
+	[SPI_INT_ID(SPI3_BASE)] = SPI_INT_SPI3,
+#endif
+#ifdef SPI_INT_USE_SPI4
+	[SPI_INT_ID(SPI4_BASE)] = SPI_INT_SPI4,
+#endif
+#ifdef SPI_INT_USE_SPI5
+	[SPI_INT_ID(SPI5_BASE)] = SPI_INT_SPI5,
+#endif
+#ifdef SPI_INT_USE_SPI6
+	[SPI_INT_ID(SPI6_BASE)] = SPI_INT_SPI6,
+#endif
+};
+
+/* Index of SPI in config table, resolved at compile time when only one SPI is enabled */
+#define SPI_INT_INDEX(SPIx)            (SPI_INT_COUNT == 1 ? 0 : SPI_Index[SPI_INT_ID(SPIx)])
+
+#if STATS_ENABLED
+/* Statistics for each SPI */
+static TM_STATS_t SPI_Stats[SPI_INT_COUNT];
+
+/* Gets statistics block for SPI */
+#define SPI_INT_STATS(SPIx)            (&SPI_Stats[SPI_INT_INDEX(SPIx)])
+#endif
+
+/* Gets constant config for SPI, NULL if SPI is not valid */
+static const TM_SPI_INT_Config_t* TM_SPI_INT_GetConfig(SPI_TypeDef* SPIx) {
+	const TM_SPI_INT_Config_t* cfg = &SPI_Config[SPI_INT_INDEX(SPIx)];
+	
+	return cfg->SPIx == SPIx ? cfg : NULL;
+}
+
+void TM_SPI_Init(SPI_TypeDef* SPIx, TM_SPI_PinsPack_t pinspack) {
+	const TM_SPI_INT_Config_t* cfg = TM_SPI_INT_GetConfig(SPIx);
+	
+	/* Init with default settings */
+	if (cfg) {
+		TM_SPIx_Init(SPIx, pinspack, cfg->Mode, cfg->Prescaler, cfg->MasterSlave, cfg->FirstBit);
+	}
+}
+
+void TM_SPI_InitWithMode(SPI_TypeDef* SPIx, TM_SPI_PinsPack_t pinspack, TM_SPI_Mode_t SPI_Mode) {
+	const TM_SPI_INT_Config_t* cfg = TM_SPI_INT_GetConfig(SPIx);
+	
+	/* Init with custom mode, 0, 1, 2, 3 */
+	if (cfg) {
+		TM_SPIx_Init(SPIx, pinspack, SPI_Mode, cfg->Prescaler, cfg->MasterSlave, cfg->FirstBit);
+	}
 }
 
 void TM_SPI_InitFull(
@@ -118,39 +219,11 @@ void TM_SPI_InitFull(
 	uint16_t SPI_FirstBit           \
 ) {
 	/* Init FULL SPI settings by user */
-#ifdef SPI1
-	if (SPIx == SPI1) {
-		TM_SPIx_Init(SPI1, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
-	}
-#endif
-#ifdef SPI2
-	if (SPIx == SPI2) {
-		TM_SPIx_Init(SPI2, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
-	}
-#endif
-#ifdef SPI3
-	if (SPIx == SPI3) {
-		TM_SPIx_Init(SPI3, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
-	}
-#endif
-#ifdef SPI4
-	if (SPIx == SPI4) {
-		TM_SPIx_Init(SPI4, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
-	}
-#endif
-#ifdef SPI5
-	if (SPIx == SPI5) {
-		TM_SPIx_Init(SPI5, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
-	}
-#endif
-#ifdef SPI6
-	if (SPIx == SPI6) {
-		TM_SPIx_Init(SPI6, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
-	}
-#endif
+	TM_SPIx_Init(SPIx, pinspack, SPI_Mode_t, SPI_BaudRatePrescaler, SPI_Mode, SPI_FirstBit);
 }
 
 uint16_t TM_SPI_GetPrescalerFromMaxFrequency(SPI_TypeDef* SPIx, uint32_t MAX_SPI_Frequency) {
+	const TM_SPI_INT_Config_t* cfg = TM_SPI_INT_GetConfig(SPIx);
 	uint32_t APB_Frequency;
 	uint8_t i;
 	
@@ -160,20 +233,7 @@ uint16_t TM_SPI_GetPrescalerFromMaxFrequency(SPI_TypeDef* SPIx, uint32_t MAX_SPI
 	}
 	
 	/* Calculate max SPI clock */
-	if (0
-#ifdef SPI1	
-		|| SPIx == SPI1
-#endif
-#ifdef SPI4
-		|| SPIx == SPI4
-#endif
-#ifdef SPI5
-		|| SPIx == SPI5
-#endif
-#ifdef SPI6
-		|| SPIx == SPI6
-#endif
-	) {
+	if (cfg && cfg->APB2) {
 		APB_Frequency = HAL_RCC_GetPCLK2Freq();
 	} else {
 		APB_Frequency = HAL_RCC_GetPCLK1Freq();
@@ -236,117 +296,98 @@ void TM_SPI_SendMulti(SPI_TypeDef* SPIx, uint8_t* dataOut, uint8_t* dataIn, uint
 	/* Check if SPI is enabled */
 	SPI_CHECK_ENABLED(SPIx);
 	
-	while (count--) {
-		/* Wait busy */
-		SPI_WAIT_TX(SPIx);
-		
-		/* Fill output buffer with data */
-		*(__IO uint8_t *)&SPIx->DR = *dataOut++;
-		
-		/* Wait for SPI to end everything */
-		SPI_WAIT_RX(SPIx);
-		
-		/* Read data register */
-		*dataIn++ = *(__IO uint8_t *)&SPIx->DR;
-	}
+	/* Exchange data */
+	TM_SPI_INT_Exchange(SPIx, dataOut, dataIn, 0, count);
 }
 
 void TM_SPI_WriteMulti(SPI_TypeDef* SPIx, uint8_t* dataOut, uint32_t count) {
+#if defined(SPI_SR_FTLVL)
+	/* Data packing is possible only for frames up to 8 bits */
+	uint8_t pack = (SPIx->CR2 & SPI_CR2_DS) <= (SPI_CR2_DS_0 | SPI_CR2_DS_1 | SPI_CR2_DS_2);
+#endif
+	
 	/* Check if SPI is enabled */
 	SPI_CHECK_ENABLED(SPIx);
 	
-	while (count--) {
-		/* Wait busy */
-		SPI_WAIT_TX(SPIx);
+	/* Count transfer */
+	TM_STATS_INC(SPI_INT_STATS(SPIx), Transfers);
+	TM_STATS_ADD(SPI_INT_STATS(SPIx), TxBytes, count);
+	
+	/* Wait for previous transmissions to complete if DMA TX enabled for SPI */
+	TM_SPI_INT_WaitEnd(SPIx);
+	
+	/* Received data are ignored, keep TX buffer full all the time */
+	while (count) {
+		/* Wait for free space in TX buffer */
+		while (!(SPIx->SR & SPI_SR_TXE));
+		
+#if defined(SPI_SR_FTLVL)
+		/* TX FIFO is at most half full, pack 2 bytes with one write */
+		if (pack && count > 1) {
+			*(__IO uint16_t *)&SPIx->DR = (uint16_t)dataOut[0] | ((uint16_t)dataOut[1] << 8);
+			dataOut += 2;
+			count -= 2;
+			continue;
+		}
+#endif
 		
 		/* Fill output buffer with data */
 		*(__IO uint8_t *)&SPIx->DR = *dataOut++;
-		
-		/* Wait for SPI to end everything */
-		SPI_WAIT_RX(SPIx);
-		
-		/* Read data register */
-		(void)*(__IO uint16_t *)&SPIx->DR;
+		count--;
 	}
+	
+	/* Wait for SPI to end everything and drop received data */
+	TM_SPI_INT_WaitEnd(SPIx);
+	TM_SPI_INT_FlushRX(SPIx);
 }
 
 void TM_SPI_ReadMulti(SPI_TypeDef* SPIx, uint8_t* dataIn, uint8_t dummy, uint32_t count) {
 	/* Check if SPI is enabled */
 	SPI_CHECK_ENABLED(SPIx);
 	
-	while (count--) {
-		/* Wait busy */
-		SPI_WAIT_TX(SPIx);
-		
-		/* Fill output buffer with data */
-		*(__IO uint8_t *)&SPIx->DR = dummy;
-		
-		/* Wait for SPI to end everything */
-		SPI_WAIT_RX(SPIx);
-		
-		/* Save data to buffer */
-		*dataIn++ = *(__IO uint8_t *)&SPIx->DR;
-	}
+	/* Exchange data, send dummy bytes */
+	TM_SPI_INT_Exchange(SPIx, NULL, dataIn, dummy, count);
 }
 
 void TM_SPI_SendMulti16(SPI_TypeDef* SPIx, uint16_t* dataOut, uint16_t* dataIn, uint32_t count) {
 	/* Check if SPI is enabled */
 	SPI_CHECK_ENABLED(SPIx);
 	
-	while (count--) {
-		/* Wait busy */
-		SPI_WAIT_TX(SPIx);
-		
-		/* Fill output buffer with data */
-		*(__IO uint16_t *)&SPIx->DR = *dataOut++;
-		
-		/* Wait for SPI to end everything */
-		SPI_WAIT_RX(SPIx);
-		
-		/* Read data register */
-		*dataIn++ = *(__IO uint16_t *)&SPIx->DR;
-	}
+	/* Exchange data */
+	TM_SPI_INT_Exchange16(SPIx, dataOut, dataIn, 0, count);
 }
 
 void TM_SPI_WriteMulti16(SPI_TypeDef* SPIx, uint16_t* dataOut, uint32_t count) {
 	/* Check if SPI is enabled */
 	SPI_CHECK_ENABLED(SPIx);
 	
+	/* Count transfer */
+	TM_STATS_INC(SPI_INT_STATS(SPIx), Transfers);
+	TM_STATS_ADD(SPI_INT_STATS(SPIx), TxBytes, 2 * count);
+	
+	/* Wait for previous transmissions to complete if DMA TX enabled for SPI */
+	TM_SPI_INT_WaitEnd(SPIx);
+	
+	/* Received data are ignored, keep TX buffer full all the time */
 	while (count--) {
-		/* Wait busy */
-		SPI_WAIT_TX(SPIx);
+		/* Wait for free space in TX buffer */
+		while (!(SPIx->SR & SPI_SR_TXE));
 		
 		/* Fill output buffer with data */
 		*(__IO uint16_t *)&SPIx->DR = *dataOut++;
-		
-		/* Wait for SPI to end everything */
-		SPI_WAIT_RX(SPIx);
-		
-		/* Read data register */
-		(void)*(__IO uint16_t *)&SPIx->DR;
 	}
+	
+	/* Wait for SPI to end everything and drop received data */
+	TM_SPI_INT_WaitEnd(SPIx);
+	TM_SPI_INT_FlushRX(SPIx);
 }
 
 void TM_SPI_ReadMulti16(SPI_TypeDef* SPIx, uint16_t* dataIn, uint16_t dummy, uint32_t count) {
 	/* Check if SPI is enabled */
 	SPI_CHECK_ENABLED(SPIx);
 	
-	/* Wait for previous transmissions to complete if DMA TX enabled for SPI */
-	SPI_WAIT_TX(SPIx);
-	
-	while (count--) {
-		/* Wait busy */
-		SPI_WAIT_TX(SPIx);
-		
-		/* Fill output buffer with data */
-		SPIx->DR = dummy;
-		
-		/* Wait for SPI to end everything */
-		SPI_WAIT_RX(SPIx);
-		
-		/* Save data to buffer */
-		*dataIn++ = SPIx->DR;
-	}
+	/* Exchange data, send dummy values */
+	TM_SPI_INT_Exchange16(SPIx, NULL, dataIn, dummy, count);
 }
 
 __weak void TM_SPI_InitCustomPinsCallback(SPI_TypeDef* SPIx, uint16_t AlternateFunction) { 
@@ -358,83 +399,33 @@ __weak void TM_SPI_InitCustomPinsCallback(SPI_TypeDef* SPIx, uint16_t AlternateF
 /* Private functions */
 static void TM_SPIx_Init(SPI_TypeDef* SPIx, TM_SPI_PinsPack_t pinspack, TM_SPI_Mode_t SPI_Mode, uint16_t SPI_BaudRatePrescaler, uint16_t SPI_MasterSlave, uint16_t SPI_FirstBit) {
 	SPI_HandleTypeDef SPIHandle;
+	const TM_SPI_INT_Config_t* cfg = TM_SPI_INT_GetConfig(SPIx);
+	
+	/* Check valid SPI */
+	if (cfg == NULL) {
+		return;
+	}
+	
+	/* Register statistics */
+	TM_STATS_REGISTER(SPI_INT_STATS(SPIx), cfg->Name);
 	
 	/* Save instance */
 	SPIHandle.Instance = SPIx;
 	
-#ifdef SPI1	
-	if (SPIx == SPI1) {
-		/* Enable SPI clock */
-		__HAL_RCC_SPI1_CLK_ENABLE();
-		
-		/* Init pins */
-		TM_SPI1_INT_InitPins(pinspack);
-		
-		/* Set options */
-		SPIHandle.Init.DataSize = TM_SPI1_DATASIZE;
-	}
-#endif
-#ifdef SPI2
-	if (SPIx == SPI2) {
-		/* Enable SPI clock */
-		__HAL_RCC_SPI2_CLK_ENABLE();
-		
-		/* Init pins */
-		TM_SPI2_INT_InitPins(pinspack);
-		
-		/* Set options */
-		SPIHandle.Init.DataSize = TM_SPI2_DATASIZE;
+	/* Enable SPI clock */
+	if (cfg->APB2) {
+		RCC->APB2ENR |= cfg->RCC_Mask;
+		(void)RCC->APB2ENR;
+	} else {
+		RCC->APB1ENR |= cfg->RCC_Mask;
+		(void)RCC->APB1ENR;
 	}
-#endif
-#ifdef SPI3
-	if (SPIx == SPI3) {
-		/* Enable SPI clock */
-		__HAL_RCC_SPI3_CLK_ENABLE();
-		
-		/* Init pins */
-		TM_SPI3_INT_InitPins(pinspack);
-		
-		/* Set options */
-		SPIHandle.Init.DataSize = TM_SPI3_DATASIZE;
 	
-	}
-#endif
-#ifdef SPI4
-	if (SPIx == SPI4) {
-		/* Enable SPI clock */
-		__HAL_RCC_SPI4_CLK_ENABLE();
-		
-		/* Init pins */
-		TM_SPI4_INT_InitPins(pinspack);
-		
-		/* Set options */
-		SPIHandle.Init.DataSize = TM_SPI4_DATASIZE;
-	}
-#endif
-#ifdef SPI5
-	if (SPIx == SPI5) {
-		/* Enable SPI clock */
-		__HAL_RCC_SPI5_CLK_ENABLE();
-		
-		/* Init pins */
-		TM_SPI5_INT_InitPins(pinspack);
-		
-		/* Set options */
-		SPIHandle.Init.DataSize = TM_SPI5_DATASIZE;
-	}
-#endif
-#ifdef SPI6
-	if (SPIx == SPI6) {
-		/* Enable SPI clock */
-		__HAL_RCC_SPI6_CLK_ENABLE();
-		
-		/* Init pins */
-		TM_SPI6_INT_InitPins(pinspack);
-		
-		/* Set options */
-		SPIHandle.Init.DataSize = TM_SPI6_DATASIZE;
-	}
-#endif
+	/* Init pins */
+	cfg->InitPins(pinspack);
+	
+	/* Set options */
+	SPIHandle.Init.DataSize = cfg->DataSize;
 
 	/* Fill SPI settings */
 	SPIHandle.Init.BaudRatePrescaler = SPI_BaudRatePrescaler;
@@ -478,7 +469,90 @@ static void TM_SPIx_Init(SPI_TypeDef* SPIx, TM_SPI_PinsPack_t pinspack, TM_SPI_M
 }
 
 /* Private functions */
-#ifdef SPI1
+static void TM_SPI_INT_WaitEnd(SPI_TypeDef* SPIx) {
+#if defined(SPI_SR_FTLVL)
+	/* Wait TX FIFO empty */
+	while (SPIx->SR & SPI_SR_FTLVL);
+#endif
+	/* Wait last frame to be shifted out */
+	while (!(SPIx->SR & SPI_SR_TXE) || (SPIx->SR & SPI_SR_BSY));
+}
+
+static void TM_SPI_INT_FlushRX(SPI_TypeDef* SPIx) {
+#if defined(SPI_SR_FRLVL)
+	/* Read all data from RX FIFO */
+	while (SPIx->SR & SPI_SR_FRLVL) {
+		(void)*(__IO uint8_t *)&SPIx->DR;
+	}
+#else
+	/* Read data register */
+	(void)SPIx->DR;
+#endif
+	/* Clear overrun flag, DR and SR read sequence */
+	(void)SPIx->SR;
+}
+
+static void TM_SPI_INT_Exchange(SPI_TypeDef* SPIx, uint8_t* dataOut, uint8_t* dataIn, uint8_t dummy, uint32_t count) {
+	uint32_t tx = count;
+	
+	/* Count transfer, dummy frames are not counted as transmitted data */
+	TM_STATS_INC(SPI_INT_STATS(SPIx), Transfers);
+	TM_STATS_ADD(SPI_INT_STATS(SPIx), RxBytes, count);
+	if (dataOut) {
+		TM_STATS_ADD(SPI_INT_STATS(SPIx), TxBytes, count);
+	}
+	
+	/* Wait for previous transmissions to complete if DMA TX enabled for SPI */
+	TM_SPI_INT_WaitEnd(SPIx);
+	TM_SPI_INT_FlushRX(SPIx);
+	
+	/* Keep up to window frames on the way, so SPI does not wait between frames */
+	while (count) {
+		/* Send next frame when there is space */
+		if (tx && (count - tx) < SPI_INT_WINDOW8 && (SPIx->SR & SPI_SR_TXE)) {
+			*(__IO uint8_t *)&SPIx->DR = dataOut ? *dataOut++ : dummy;
+			tx--;
+		}
+		
+		/* Read received frame */
+		if (SPIx->SR & SPI_SR_RXNE) {
+			*dataIn++ = *(__IO uint8_t *)&SPIx->DR;
+			count--;
+		}
+	}
+}
+
+static void TM_SPI_INT_Exchange16(SPI_TypeDef* SPIx, uint16_t* dataOut, uint16_t* dataIn, uint16_t dummy, uint32_t count) {
+	uint32_t tx = count;
+	
+	/* Count transfer, dummy frames are not counted as transmitted data */
+	TM_STATS_INC(SPI_INT_STATS(SPIx), Transfers);
+	TM_STATS_ADD(SPI_INT_STATS(SPIx), RxBytes, 2 * count);
+	if (dataOut) {
+		TM_STATS_ADD(SPI_INT_STATS(SPIx), TxBytes, 2 * count);
+	}
+	
+	/* Wait for previous transmissions to complete if DMA TX enabled for SPI */
+	TM_SPI_INT_WaitEnd(SPIx);
+	TM_SPI_INT_FlushRX(SPIx);
+	
+	/* Keep up to window frames on the way, so SPI does not wait between frames */
+	while (count) {
+		/* Send next frame when there is space */
+		if (tx && (count - tx) < SPI_INT_WINDOW16 && (SPIx->SR & SPI_SR_TXE)) {
+			*(__IO uint16_t *)&SPIx->DR = dataOut ? *dataOut++ : dummy;
+			tx--;
+		}
+		
+		/* Read received frame */
+		if (SPIx->SR & SPI_SR_RXNE) {
+			*dataIn++ = *(__IO uint16_t *)&SPIx->DR;
+			count--;
+		}
+	}
+}
+
+#ifdef SPI_INT_USE_SPI1
 void TM_SPI1_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 	/* Init SPI pins */
 #if defined(GPIOA)
@@ -498,7 +572,7 @@ void TM_SPI1_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef SPI2
+#ifdef SPI_INT_USE_SPI2
 void TM_SPI2_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 	/* Init SPI pins */
 #if defined(GPIOB) && defined(GPIOC)
@@ -530,7 +604,7 @@ void TM_SPI2_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef SPI3
+#ifdef SPI_INT_USE_SPI3
 void TM_SPI3_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 	/* Enable SPI pins */
 #if defined(GPIOB)
@@ -550,7 +624,7 @@ void TM_SPI3_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef SPI4
+#ifdef SPI_INT_USE_SPI4
 void TM_SPI4_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 	/* Init SPI pins */
 #if defined(GPIOE)
@@ -570,7 +644,7 @@ void TM_SPI4_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef SPI5
+#ifdef SPI_INT_USE_SPI5
 void TM_SPI5_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 	/* Init SPI pins */
 #if defined(GPIOF)
@@ -591,7 +665,7 @@ void TM_SPI5_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef SPI6
+#ifdef SPI_INT_USE_SPI6
 void TM_SPI6_INT_InitPins(TM_SPI_PinsPack_t pinspack) {
 #if defined(GPIOG)
 	if (pinspack == TM_SPI_PinsPack_1) {
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-08-spi-for-stm32fxxx/
- * @version v1.0
+ * @version v1.4
  * @ide     Keil uVision
  * @license MIT
  * @brief   SPI library for STM32Fxxx
@@ -27,7 +27,7 @@
 \endverbatim
  */
 #ifndef TM_SPI_H
-#define TM_SPI_H 100
+#define TM_SPI_H 140
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -90,6 +90,17 @@ SPI6    |PG14   PG12    PG13    |
 #define TM_SPIx_MASTERSLAVE SPI_MODE_MASTER
 //Specify mode of operation, clock polarity and clock phase
 #define TM_SPIx_MODE        TM_SPI_Mode_0
+\endcode
+ *
+ * \par Enabled SPIs only
+ *
+ * By default, settings and pins initialization are compiled for all SPIs on device.
+ * When at least one SPI is enabled in defines.h, only enabled SPIs are included.
+ * With only one SPI enabled, lookup from SPI pointer is resolved at compile time.
+ *
+\code
+//Change x with 1-6, to match your SPI
+#define TM_SPIx_ENABLED
 \endcode
  *
  * \par Changelog
@@ -97,6 +108,24 @@ SPI6    |PG14   PG12    PG13    |
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - SPI clocks, pins and default settings are taken from constant table instead of if chains
+  
+ Version 1.2
+  - October 14, 2026
+  - Multi byte functions do not wait for SPI to be idle between frames
+  - Write only functions keep TX buffer full and drop received data at the end
+  - STM32F0xx and STM32F7xx use RX/TX FIFO and data packing for 8-bit writes
+
+ Version 1.3
+  - October 14, 2026
+  - Added optional TM STATS counters for each SPI, enabled with STATS_ENABLED
+
+ Version 1.4
+  - October 14, 2026
+  - Only SPIs enabled with TM_SPIx_ENABLED in defines.h are compiled in when at least one is enabled
 \endverbatim
  *
  * \par Dependencies
@@ -106,6 +135,7 @@ SPI6    |PG14   PG12    PG13    |
  - defines.h
  - attributes.h
  - TM GPIO
+ - TM STATS
 \endverbatim
  */
 
@@ -113,6 +143,7 @@ SPI6    |PG14   PG12    PG13    |
 #include "defines.h"
 #include "attributes.h"
 #include "tm_stm32_gpio.h"
+#include "tm_stm32_stats.h"
 
 /**
  * @defgroup TM_SPI_Typedefs
@@ -24,43 +24,79 @@ typedef struct {
 	DMA_Stream_TypeDef* TX_Stream;
 	uint32_t RX_Channel;
 	DMA_Stream_TypeDef* RX_Stream;
+	TM_DMA_Request_t TX_Request;
+	TM_DMA_Request_t RX_Request;
 	uint32_t Dummy32;
 	uint16_t Dummy16;
+#if SPI_DMA_QUEUE_SIZE > 0
+	TM_SPI_DMA_Job_t Queue[SPI_DMA_QUEUE_SIZE];
+	volatile uint16_t In;
+	volatile uint16_t Out;
+	volatile uint16_t Count;
+	volatile uint8_t Active;
+#endif
+	TM_SPI_DMA_Slave_t* Slave;
 } TM_SPI_DMA_INT_t;
 
 /* Private variables */
 #ifdef SPI1
-static TM_SPI_DMA_INT_t SPI1_DMA_INT = {SPI1_DMA_TX_CHANNEL, SPI1_DMA_TX_STREAM, SPI1_DMA_RX_CHANNEL, SPI1_DMA_RX_STREAM};
+static TM_SPI_DMA_INT_t SPI1_DMA_INT = {SPI1_DMA_TX_CHANNEL, SPI1_DMA_TX_STREAM, SPI1_DMA_RX_CHANNEL, SPI1_DMA_RX_STREAM, TM_DMA_Request_SPI1_TX, TM_DMA_Request_SPI1_RX};
 #endif
 #ifdef SPI2
-static TM_SPI_DMA_INT_t SPI2_DMA_INT = {SPI2_DMA_TX_CHANNEL, SPI2_DMA_TX_STREAM, SPI2_DMA_RX_CHANNEL, SPI2_DMA_RX_STREAM};
+static TM_SPI_DMA_INT_t SPI2_DMA_INT = {SPI2_DMA_TX_CHANNEL, SPI2_DMA_TX_STREAM, SPI2_DMA_RX_CHANNEL, SPI2_DMA_RX_STREAM, TM_DMA_Request_SPI2_TX, TM_DMA_Request_SPI2_RX};
 #endif
 #ifdef SPI3
-static TM_SPI_DMA_INT_t SPI3_DMA_INT = {SPI3_DMA_TX_CHANNEL, SPI3_DMA_TX_STREAM, SPI3_DMA_RX_CHANNEL, SPI3_DMA_RX_STREAM};
+static TM_SPI_DMA_INT_t SPI3_DMA_INT = {SPI3_DMA_TX_CHANNEL, SPI3_DMA_TX_STREAM, SPI3_DMA_RX_CHANNEL, SPI3_DMA_RX_STREAM, TM_DMA_Request_SPI3_TX, TM_DMA_Request_SPI3_RX};
 #endif
 #ifdef SPI4
-static TM_SPI_DMA_INT_t SPI4_DMA_INT = {SPI4_DMA_TX_CHANNEL, SPI4_DMA_TX_STREAM, SPI4_DMA_RX_CHANNEL, SPI4_DMA_RX_STREAM};
+static TM_SPI_DMA_INT_t SPI4_DMA_INT = {SPI4_DMA_TX_CHANNEL, SPI4_DMA_TX_STREAM, SPI4_DMA_RX_CHANNEL, SPI4_DMA_RX_STREAM, TM_DMA_Request_SPI4_TX, TM_DMA_Request_SPI4_RX};
 #endif
 #ifdef SPI5
-static TM_SPI_DMA_INT_t SPI5_DMA_INT = {SPI5_DMA_TX_CHANNEL, SPI5_DMA_TX_STREAM, SPI5_DMA_RX_CHANNEL, SPI5_DMA_RX_STREAM};
+static TM_SPI_DMA_INT_t SPI5_DMA_INT = {SPI5_DMA_TX_CHANNEL, SPI5_DMA_TX_STREAM, SPI5_DMA_RX_CHANNEL, SPI5_DMA_RX_STREAM, TM_DMA_Request_SPI5_TX, TM_DMA_Request_SPI5_RX};
 #endif
 #ifdef SPI6
-static TM_SPI_DMA_INT_t SPI6_DMA_INT = {SPI6_DMA_TX_CHANNEL, SPI6_DMA_TX_STREAM, SPI6_DMA_RX_CHANNEL, SPI6_DMA_RX_STREAM};
+static TM_SPI_DMA_INT_t SPI6_DMA_INT = {SPI6_DMA_TX_CHANNEL, SPI6_DMA_TX_STREAM, SPI6_DMA_RX_CHANNEL, SPI6_DMA_RX_STREAM, TM_DMA_Request_SPI6_TX, TM_DMA_Request_SPI6_RX};
 #endif
 
 /* Private functions */
 static TM_SPI_DMA_INT_t* TM_SPI_DMA_INT_GetSettings(SPI_TypeDef* SPIx);
+static uint8_t TM_SPI_DMA_INT_Transmit(SPI_TypeDef* SPIx, uint8_t* TX_Buffer, uint8_t* RX_Buffer, uint16_t count, uint8_t irq);
+#if SPI_DMA_QUEUE_SIZE > 0
+static void TM_SPI_DMA_INT_StartNext(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings);
+static void TM_SPI_DMA_INT_Finished(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings, uint8_t status);
+static void TM_SPI_DMA_INT_RXStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+#endif
+static void TM_SPI_DMA_INT_SlaveArm(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings, uint8_t index);
+static uint16_t TM_SPI_DMA_INT_SlaveStopDMA(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings);
+static void TM_SPI_DMA_INT_SlaveReset(SPI_TypeDef* SPIx);
+static void TM_SPI_DMA_INT_SlaveNSS(uint16_t GPIO_Pin, void* Param);
 	
 void TM_SPI_DMA_Init(SPI_TypeDef* SPIx) {
+	DMA_Stream_TypeDef* Stream;
+	
 	/* Init DMA TX mode */
 	/* Assuming SPI is already initialized and clock is enabled */
 	
 	/* Get USART settings */
 	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
 	
+	/* Allocate streams, other free stream is selected if default is used by other peripheral */
+	if ((Stream = TM_DMA_Allocate(Settings->TX_Request, TM_DMA_Priority_Default, Settings->TX_Stream, &Settings->TX_Channel)) != NULL) {
+		Settings->TX_Stream = Stream;
+	}
+	if ((Stream = TM_DMA_Allocate(Settings->RX_Request, TM_DMA_Priority_Default, Settings->RX_Stream, &Settings->RX_Channel)) != NULL) {
+		Settings->RX_Stream = Stream;
+	}
+	
 	/* Init both streams */
 	TM_DMA_Init(Settings->TX_Stream, NULL);
 	TM_DMA_Init(Settings->RX_Stream, NULL);
+	
+#if SPI_DMA_QUEUE_SIZE > 0
+	/* RX stream finishes last, use it to process queue */
+	TM_DMA_SetStreamCallback(Settings->RX_Stream, TM_SPI_DMA_INT_RXStreamCallback, SPIx);
+	TM_DMA_EnableInterrupts(Settings->RX_Stream);
+#endif
 }
 
 void TM_SPI_DMA_InitWithStreamAndChannel(SPI_TypeDef* SPIx, DMA_Stream_TypeDef* TX_Stream, uint32_t TX_Channel, DMA_Stream_TypeDef* RX_Stream, uint32_t RX_Channel) {
@@ -84,9 +120,18 @@ void TM_SPI_DMA_Deinit(SPI_TypeDef* SPIx) {
 	/* Deinit DMA Streams */
 	TM_DMA_DeInit(Settings->TX_Stream);
 	TM_DMA_DeInit(Settings->RX_Stream);
+	
+	/* Release streams */
+	TM_DMA_Release(Settings->TX_Stream, Settings->TX_Request);
+	TM_DMA_Release(Settings->RX_Stream, Settings->RX_Request);
 }
 
 uint8_t TM_SPI_DMA_Transmit(SPI_TypeDef* SPIx, uint8_t* TX_Buffer, uint8_t* RX_Buffer, uint16_t count) {
+	/* Start without interrupts */
+	return TM_SPI_DMA_INT_Transmit(SPIx, TX_Buffer, RX_Buffer, count, 0);
+}
+
+static uint8_t TM_SPI_DMA_INT_Transmit(SPI_TypeDef* SPIx, uint8_t* TX_Buffer, uint8_t* RX_Buffer, uint16_t count, uint8_t irq) {
 	DMA_HandleTypeDef DMA_InitStruct;
 	
 	/* Get USART settings */
@@ -118,9 +163,24 @@ uint8_t TM_SPI_DMA_Transmit(SPI_TypeDef* SPIx, uint8_t* TX_Buffer, uint8_t* RX_B
 	/* Set dummy memory to default */
 	Settings->Dummy16 = 0x12;
 	
-	/* Set memory size */
-	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	/* Set memory size, half words are used when SPI is in 16-bit mode */
+#if defined(STM32F7xx)
+	if ((SPIx->CR2 & SPI_CR2_DS) == SPI_CR2_DS) {
+		/* RXNE on 16-bit data in FIFO */
+		SPIx->CR2 &= ~SPI_CR2_FRXTH;
+#else
+	if (SPIx->CR1 & SPI_CR1_DFF) {
+#endif
+		DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+		DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	} else {
+#if defined(STM32F7xx)
+		/* RXNE on 8-bit data in FIFO */
+		SPIx->CR2 |= SPI_CR2_FRXTH;
+#endif
+		DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+		DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	}
 
 	/*******************************************************/
 	/*                       RX DMA                        */
@@ -146,6 +206,11 @@ uint8_t TM_SPI_DMA_Transmit(SPI_TypeDef* SPIx, uint8_t* TX_Buffer, uint8_t* RX_B
 	/* Start TX stream */
 	TM_DMA_Init(Settings->RX_Stream, &DMA_InitStruct);
 	
+	/* Enable transfer complete and error interrupts, DMA init clears them */
+	if (irq) {
+		Settings->RX_Stream->CR |= DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+	}
+	
 	/* Start DMA */
 	if (RX_Buffer != NULL) {
 		TM_DMA_Start(&DMA_InitStruct, (uint32_t) &SPIx->DR, (uint32_t) RX_Buffer, count);
@@ -286,11 +351,19 @@ uint8_t TM_SPI_DMA_Transmitting(SPI_TypeDef* SPIx) {
 	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
 	
 	/* Check if TX or RX DMA are working */
-	return (
+	if (
 		Settings->RX_Stream->NDTR || /*!< RX is working */
 		Settings->TX_Stream->NDTR || /*!< TX is working */
 		SPI_IS_BUSY(SPIx)            /*!< SPI is busy */
-	);
+	) {
+		return 1;
+	}
+	
+	/* Transfer finished, invalidate cache for received data */
+	TM_DMA_InvalidateStreamCache(Settings->RX_Stream);
+	
+	/* Not transmitting */
+	return 0;
 }
 
 DMA_Stream_TypeDef* TM_SPI_DMA_GetStreamTX(SPI_TypeDef* SPIx) {
@@ -321,7 +394,416 @@ void TM_SPI_DMA_DisableInterrupts(SPI_TypeDef* SPIx) {
 	TM_DMA_DisableInterrupts(Settings->RX_Stream);
 }
 
+#if SPI_DMA_QUEUE_SIZE > 0
+uint8_t TM_SPI_DMA_Enqueue(SPI_TypeDef* SPIx, const TM_SPI_DMA_Job_t* Job) {
+	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
+	uint32_t irq;
+	uint8_t start;
+	
+	/* Check job */
+	if (Job->Count == 0 || (Job->TX_Buffer == NULL && Job->RX_Buffer == NULL)) {
+		return 0;
+	}
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Check for free entry */
+	if (Settings->Count >= SPI_DMA_QUEUE_SIZE) {
+		TM_NVIC_Unlock(irq);
+		return 0;
+	}
+	
+	/* Save job */
+	Settings->Queue[Settings->In] = *Job;
+	if (++Settings->In >= SPI_DMA_QUEUE_SIZE) {
+		Settings->In = 0;
+	}
+	
+	/* Start if queue was empty */
+	start = (Settings->Count++ == 0);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Start job, DMA interrupt continues with next ones */
+	if (start) {
+		TM_SPI_DMA_INT_StartNext(SPIx, Settings);
+	}
+	
+	/* Return OK */
+	return 1;
+}
+
+uint16_t TM_SPI_DMA_QueuePending(SPI_TypeDef* SPIx) {
+	return TM_SPI_DMA_INT_GetSettings(SPIx)->Count;
+}
+#endif
+
+uint8_t TM_SPI_DMA_SlaveStart(SPI_TypeDef* SPIx, TM_SPI_DMA_Slave_t* Slave) {
+	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
+	
+	/* Check settings */
+	if (
+		Slave->Size == 0 || Slave->NSS_Port == NULL ||
+		Slave->RX_Buffer[0] == NULL || Slave->RX_Buffer[1] == NULL ||
+		Slave->TX_Buffer[0] == NULL || Slave->TX_Buffer[1] == NULL
+	) {
+		return 0;
+	}
+	
+	/* SPI must be slave and DMA must be free */
+	if ((SPIx->CR1 & SPI_CR1_MSTR) || Settings->Slave != NULL || Settings->RX_Stream->NDTR || Settings->TX_Stream->NDTR) {
+		return 0;
+	}
+	
+	/* Init ready pin, host must wait until DMA is armed */
+	if (Slave->Ready_Port != NULL) {
+		TM_GPIO_Init(Slave->Ready_Port, Slave->Ready_Pin, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High);
+		TM_GPIO_SetPinLow(Slave->Ready_Port, Slave->Ready_Pin);
+	}
+	
+	/* Both pairs are free */
+	Slave->Busy[0] = 0;
+	Slave->Busy[1] = 0;
+	Slave->Armed = 0;
+	Slave->Packets = 0;
+	Slave->Errors = 0;
+	Settings->Slave = Slave;
+	
+	/* Start from clean SPI */
+	TM_SPI_DMA_INT_SlaveReset(SPIx);
+	
+	/* Packet ends when host releases NSS */
+	if (TM_EXTI_AttachCallback(Slave->NSS_Port, Slave->NSS_Pin, TM_EXTI_Trigger_Rising, TM_SPI_DMA_INT_SlaveNSS, SPIx) != TM_EXTI_Result_Ok) {
+		Settings->Slave = NULL;
+		return 0;
+	}
+	
+	/* Arm first pair */
+	TM_SPI_DMA_INT_SlaveArm(SPIx, Settings, 0);
+	
+	/* Return OK */
+	return 1;
+}
+
+void TM_SPI_DMA_SlaveStop(SPI_TypeDef* SPIx) {
+	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
+	TM_SPI_DMA_Slave_t* Slave = Settings->Slave;
+	
+	/* Check if active */
+	if (Slave == NULL) {
+		return;
+	}
+	
+	/* Stop packet framing */
+	TM_EXTI_Detach(Slave->NSS_Pin);
+	Settings->Slave = NULL;
+	Slave->Armed = 0;
+	
+	/* Host must not start new packets */
+	if (Slave->Ready_Port != NULL) {
+		TM_GPIO_SetPinLow(Slave->Ready_Port, Slave->Ready_Pin);
+	}
+	
+	/* Stop DMA and leave SPI enabled without CRC, as after TM SPI init */
+	TM_SPI_DMA_INT_SlaveStopDMA(SPIx, Settings);
+	TM_SPI_DMA_INT_SlaveReset(SPIx);
+	SPIx->CR1 &= ~SPI_CR1_CRCEN;
+	SPIx->CR1 |= SPI_CR1_SPE;
+}
+
+uint8_t TM_SPI_DMA_SlaveRelease(SPI_TypeDef* SPIx, uint8_t* RX_Buffer) {
+	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
+	TM_SPI_DMA_Slave_t* Slave = Settings->Slave;
+	uint32_t irq;
+	uint8_t index;
+	
+	/* Check if active */
+	if (Slave == NULL) {
+		return 0;
+	}
+	
+	/* Find pair */
+	if (RX_Buffer == Slave->RX_Buffer[0]) {
+		index = 0;
+	} else if (RX_Buffer == Slave->RX_Buffer[1]) {
+		index = 1;
+	} else {
+		return 0;
+	}
+	
+	/* Disable interrupts, NSS interrupt changes state too */
+	irq = TM_NVIC_Lock();
+	
+	/* Check ownership */
+	if (!Slave->Busy[index]) {
+		TM_NVIC_Unlock(irq);
+		return 0;
+	}
+	Slave->Busy[index] = 0;
+	
+	/* Host is waiting, arm released pair */
+	if (!Slave->Armed) {
+		TM_SPI_DMA_INT_SlaveArm(SPIx, Settings, index);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return OK */
+	return 1;
+}
+
 /* Private functions */
+static void TM_SPI_DMA_INT_SlaveArm(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings, uint8_t index) {
+	TM_SPI_DMA_Slave_t* Slave = Settings->Slave;
+	
+	/* Set CRC, SPI is disabled after reset */
+	SPIx->CR1 &= ~SPI_CR1_CRCEN;
+	if (Slave->CRC_Polynomial) {
+		SPIx->CRCPR = Slave->CRC_Polynomial;
+#if defined(STM32F7xx)
+		/* CRC length follows data size */
+		if ((SPIx->CR2 & SPI_CR2_DS) == SPI_CR2_DS) {
+			SPIx->CR1 |= SPI_CR1_CRCL;
+		} else {
+			SPIx->CR1 &= ~SPI_CR1_CRCL;
+		}
+#endif
+		SPIx->CR1 |= SPI_CR1_CRCEN;
+	}
+	
+	/* Start DMA streams before SPI, so first data are ready when host starts clocking */
+	Slave->Active = index;
+	TM_SPI_DMA_INT_Transmit(SPIx, Slave->TX_Buffer[index], Slave->RX_Buffer[index], Slave->Size, 0);
+	SPIx->CR1 |= SPI_CR1_SPE;
+	Slave->Armed = 1;
+	
+	/* Host can start packet */
+	if (Slave->Ready_Port != NULL) {
+		TM_GPIO_SetPinHigh(Slave->Ready_Port, Slave->Ready_Pin);
+	}
+}
+
+static uint16_t TM_SPI_DMA_INT_SlaveStopDMA(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings) {
+	uint16_t remaining;
+	
+	/* Disable SPI DMA requests */
+	SPIx->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+	
+	/* Stop both streams and mark them free */
+	Settings->TX_Stream->CR &= ~DMA_SxCR_EN;
+	Settings->RX_Stream->CR &= ~DMA_SxCR_EN;
+	while ((Settings->TX_Stream->CR & DMA_SxCR_EN) || (Settings->RX_Stream->CR & DMA_SxCR_EN));
+	remaining = Settings->RX_Stream->NDTR;
+	Settings->TX_Stream->NDTR = 0;
+	Settings->RX_Stream->NDTR = 0;
+	TM_DMA_ClearFlag(Settings->TX_Stream, DMA_FLAG_ALL);
+	TM_DMA_ClearFlag(Settings->RX_Stream, DMA_FLAG_ALL);
+	
+	/* Return number of data not received */
+	return remaining;
+}
+
+static void TM_SPI_DMA_INT_SlaveReset(SPI_TypeDef* SPIx) {
+	uint32_t cr1, cr2;
+	
+	/* Save settings, SPI is left disabled */
+	cr1 = SPIx->CR1 & ~SPI_CR1_SPE;
+	cr2 = SPIx->CR2 & ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+	
+	/* Reset peripheral, this is the only way to clear TX data and CRC left from aborted packet */
+#ifdef SPI1
+	if (SPIx == SPI1) {
+		RCC->APB2RSTR |= RCC_APB2RSTR_SPI1RST;
+		RCC->APB2RSTR &= ~RCC_APB2RSTR_SPI1RST;
+	}
+#endif
+#ifdef SPI2
+	if (SPIx == SPI2) {
+		RCC->APB1RSTR |= RCC_APB1RSTR_SPI2RST;
+		RCC->APB1RSTR &= ~RCC_APB1RSTR_SPI2RST;
+	}
+#endif
+#ifdef SPI3
+	if (SPIx == SPI3) {
+		RCC->APB1RSTR |= RCC_APB1RSTR_SPI3RST;
+		RCC->APB1RSTR &= ~RCC_APB1RSTR_SPI3RST;
+	}
+#endif
+#ifdef SPI4
+	if (SPIx == SPI4) {
+		RCC->APB2RSTR |= RCC_APB2RSTR_SPI4RST;
+		RCC->APB2RSTR &= ~RCC_APB2RSTR_SPI4RST;
+	}
+#endif
+#ifdef SPI5
+	if (SPIx == SPI5) {
+		RCC->APB2RSTR |= RCC_APB2RSTR_SPI5RST;
+		RCC->APB2RSTR &= ~RCC_APB2RSTR_SPI5RST;
+	}
+#endif
+#ifdef SPI6
+	if (SPIx == SPI6) {
+		RCC->APB2RSTR |= RCC_APB2RSTR_SPI6RST;
+		RCC->APB2RSTR &= ~RCC_APB2RSTR_SPI6RST;
+	}
+#endif
+	
+	/* Restore settings */
+	SPIx->CR2 = cr2;
+	SPIx->CR1 = cr1;
+}
+
+static void TM_SPI_DMA_INT_SlaveNSS(uint16_t GPIO_Pin, void* Param) {
+	SPI_TypeDef* SPIx = (SPI_TypeDef *)Param;
+	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
+	TM_SPI_DMA_Slave_t* Slave = Settings->Slave;
+	uint16_t count;
+	uint8_t index, status;
+	
+	/* Edge without armed packet, host did not wait for ready pin */
+	if (Slave == NULL || !Slave->Armed) {
+		return;
+	}
+	
+	/* Host can not start next packet until next pair is armed */
+	Slave->Armed = 0;
+	if (Slave->Ready_Port != NULL) {
+		TM_GPIO_SetPinLow(Slave->Ready_Port, Slave->Ready_Pin);
+	}
+	
+	/* Stop DMA and get number of received data */
+	count = Slave->Size - TM_SPI_DMA_INT_SlaveStopDMA(SPIx, Settings);
+	
+	/* With CRC, packet must be complete and CRC from host valid */
+	status = 1;
+	if (Slave->CRC_Polynomial && (count != Slave->Size || (SPIx->SR & SPI_SR_CRCERR))) {
+		status = 0;
+	}
+	
+	/* Clear SPI for next packet */
+	TM_SPI_DMA_INT_SlaveReset(SPIx);
+	
+	/* Received data are valid in memory */
+	TM_DMA_InvalidateStreamCache(Settings->RX_Stream);
+	
+	/* Give pair to user */
+	index = Slave->Active;
+	Slave->Busy[index] = 1;
+	Slave->Packets++;
+	if (!status) {
+		Slave->Errors++;
+	}
+	
+	/* Arm other pair immediately if user released it */
+	if (!Slave->Busy[index ^ 1]) {
+		TM_SPI_DMA_INT_SlaveArm(SPIx, Settings, index ^ 1);
+	}
+	
+	/* Call user callback */
+	if (Slave->Callback) {
+		Slave->Callback(SPIx, Slave->RX_Buffer[index], count, status, Slave->Param);
+	}
+}
+
+#if SPI_DMA_QUEUE_SIZE > 0
+static void TM_SPI_DMA_INT_StartNext(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings) {
+	TM_SPI_DMA_Job_t* j;
+	uint32_t cr1;
+	
+	/* Check for pending job, job may be already started from callback */
+	if (Settings->Count == 0 || Settings->Active) {
+		return;
+	}
+	
+	/* Get first job */
+	j = &Settings->Queue[Settings->Out];
+	
+	/* Calculate clock polarity, phase and prescaler bits */
+	cr1 = j->Prescaler & SPI_CR1_BR;
+	if (j->Mode == TM_SPI_Mode_1 || j->Mode == TM_SPI_Mode_3) {
+		cr1 |= SPI_CR1_CPHA;
+	}
+	if (j->Mode == TM_SPI_Mode_2 || j->Mode == TM_SPI_Mode_3) {
+		cr1 |= SPI_CR1_CPOL;
+	}
+	
+	/* Reconfigure SPI only when settings are different from previous job */
+	if ((SPIx->CR1 & (SPI_CR1_BR | SPI_CR1_CPHA | SPI_CR1_CPOL)) != cr1) {
+		SPIx->CR1 &= ~SPI_CR1_SPE;
+		SPIx->CR1 = (SPIx->CR1 & ~(SPI_CR1_BR | SPI_CR1_CPHA | SPI_CR1_CPOL)) | cr1;
+		SPIx->CR1 |= SPI_CR1_SPE;
+	}
+	
+	/* Select device */
+	if (j->CS_Port) {
+		TM_GPIO_SetPinLow(j->CS_Port, j->CS_Pin);
+	}
+	
+	/* Start DMA, finish with error if DMA is used by someone else */
+	Settings->Active = 1;
+	if (!TM_SPI_DMA_INT_Transmit(SPIx, j->TX_Buffer, j->RX_Buffer, j->Count, 1)) {
+		TM_SPI_DMA_INT_Finished(SPIx, Settings, 0);
+	}
+}
+
+static void TM_SPI_DMA_INT_Finished(SPI_TypeDef* SPIx, TM_SPI_DMA_INT_t* Settings, uint8_t status) {
+	TM_SPI_DMA_Job_t j;
+	
+	/* Remove from queue before callback, so callback can add new job */
+	j = Settings->Queue[Settings->Out];
+	if (++Settings->Out >= SPI_DMA_QUEUE_SIZE) {
+		Settings->Out = 0;
+	}
+	Settings->Count--;
+	Settings->Active = 0;
+	
+	/* Deselect device */
+	if (j.CS_Port) {
+		TM_GPIO_SetPinHigh(j.CS_Port, j.CS_Pin);
+	}
+	
+	/* Call user callback */
+	if (j.Callback) {
+		j.Callback(SPIx, j.RX_Buffer, j.Count, status, j.Param);
+	}
+	
+	/* Start next job */
+	TM_SPI_DMA_INT_StartNext(SPIx, Settings);
+}
+
+static void TM_SPI_DMA_INT_RXStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	SPI_TypeDef* SPIx = (SPI_TypeDef *)Param;
+	TM_SPI_DMA_INT_t* Settings = TM_SPI_DMA_INT_GetSettings(SPIx);
+	
+	/* Process only queued jobs and only on complete or error */
+	if (!Settings->Active || !(flags & (DMA_FLAG_TCIF | DMA_FLAG_TEIF))) {
+		return;
+	}
+	
+	/* Disable stream interrupts and SPI DMA requests */
+	DMA_Stream->CR &= ~(DMA_SxCR_TCIE | DMA_SxCR_TEIE);
+	SPIx->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+	
+	/* Stop both streams on error, so they are free for next job */
+	if (flags & DMA_FLAG_TEIF) {
+		Settings->TX_Stream->CR &= ~DMA_SxCR_EN;
+		DMA_Stream->CR &= ~DMA_SxCR_EN;
+		while ((Settings->TX_Stream->CR & DMA_SxCR_EN) || (DMA_Stream->CR & DMA_SxCR_EN));
+		Settings->TX_Stream->NDTR = 0;
+		DMA_Stream->NDTR = 0;
+	}
+	
+	/* Wait for SPI to finish last byte before chip select goes high */
+	while (SPIx->SR & SPI_SR_BSY);
+	
+	/* Finish job and start next */
+	TM_SPI_DMA_INT_Finished(SPIx, Settings, !(flags & DMA_FLAG_TEIF));
+}
+#endif
+
 static TM_SPI_DMA_INT_t* TM_SPI_DMA_INT_GetSettings(SPI_TypeDef* SPIx) {
 	TM_SPI_DMA_INT_t* result;
 #ifdef SPI1
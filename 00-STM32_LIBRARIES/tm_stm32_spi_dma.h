@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2016/04/hal-library-33-dma-extension-for-spi-on-stm32fxxx
- * @version v1.0
+ * @version v1.6
  * @ide     Keil uVision
  * @license MIT
  * @brief   DMA functionality for TM SPI library for STM32F4xx and STM32F7xx devices
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_SPI_DMA_H
-#define TM_SPI_DMA_H 100
+#define TM_SPI_DMA_H 160
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -65,12 +65,101 @@ SPI4     | DMA2 | DMA Stream 1  | DMA Channel 4  | DMA Stream 0  | DMA Channel 4
 SPI5     | DMA2 | DMA Stream 6  | DMA Channel 7  | DMA Stream 5  | DMA Channel 7 
 SPI6     | DMA2 | DMA Stream 5  | DMA Channel 1  | DMA Stream 6  | DMA Channel 0 
 @endverbatim
+ *
+ * \par 16-bit data size
+ *
+ * When SPI is set to 16-bit mode with @ref TM_SPI_SetDataSize, @ref TM_SPI_DMA_Transmit transfers half words
+ * and count parameter is number of half words, for example to send RGB565 pixels to display.
+ *
+ * \par Job queue
+ *
+ * When more devices with different settings share one SPI, jobs can be added to queue with @ref TM_SPI_DMA_Enqueue.
+ * Each job has its own chip select pin, SPI mode, prescaler, TX and RX buffers and callback.
+ * Jobs are done one after another from RX DMA stream interrupt. SPI mode and prescaler are changed
+ * only when they are different from current SPI settings, chip select is handled by library.
+ *
+ * Queue is disabled by default, because library then uses RX DMA stream callback for each SPI.
+ * To enable it, open defines.h file and add define:
+ *
+\code
+//Number of jobs in queue for each SPI
+#define SPI_DMA_QUEUE_SIZE    8
+\endcode
+ *
+ * @note   Chip select pins must be initialized as outputs and set high by user
+ * @note   Data are not copied, memory must stay valid until callback is called
+ * @note   Only 8-bit data size is supported in queue
+ * @note   Do not use other SPI functions on SPI peripheral while its queue is not empty
+ *
+ * \par Slave packet mode
+ *
+ * SPI can work as slave to external host, for example as coprocessor to Linux board.
+ * Data are exchanged in packets, one packet for each chip select (NSS) low period.
+ * User gives two pairs of RX and TX buffers, DMA is armed with one pair while user works with other one (ping-pong).
+ * There are no interrupts for each byte, library uses only NSS rising edge interrupt to finish packet.
+ *
+ * Flow control is done with ready pin, which is active (high) when DMA is armed and host can start new packet.
+ * When packet is finished, ready pin goes low, callback is called with received data and other pair is armed if it is free.
+ * Pair stays in user ownership until @ref TM_SPI_DMA_SlaveRelease is called, fill TX buffer before release.
+ * When both pairs are in user ownership, ready pin stays low and host must wait.
+ *
+ * When CRC polynomial is set, SPI hardware CRC unit adds CRC after packet data and checks CRC from host.
+ * In this case host must always send full packet of Size bytes plus CRC, shorter packets are reported with error status.
+ * Without CRC, host may send shorter packets and callback gets number of received bytes.
+ *
+\code
+//Init SPI as slave and DMA for it
+TM_SPI_InitFull(SPI2, TM_SPI_PinsPack_2, SPI_BAUDRATEPRESCALER_2, TM_SPI_Mode_0, SPI_MODE_SLAVE, SPI_FIRSTBIT_MSB);
+TM_SPI_DMA_Init(SPI2);
+
+//Set packet settings and start, Slave structure must stay valid while slave mode is active
+Slave.RX_Buffer[0] = RX0; Slave.TX_Buffer[0] = TX0;
+Slave.RX_Buffer[1] = RX1; Slave.TX_Buffer[1] = TX1;
+Slave.Size = 256;
+Slave.NSS_Port = GPIOB; Slave.NSS_Pin = GPIO_PIN_12;
+Slave.Ready_Port = GPIOB; Slave.Ready_Pin = GPIO_PIN_11;
+Slave.CRC_Polynomial = 0x07;
+Slave.Callback = PacketCallback;
+TM_SPI_DMA_SlaveStart(SPI2, &Slave);
+
+//In packet callback or later, process RX data, fill TX buffer of same pair and release it
+TM_SPI_DMA_SlaveRelease(SPI2, RX_Buffer);
+\endcode
+ *
+ * @note   SPI must be initialized in slave mode with software NSS, which is default in @ref TM_SPI library
+ * @note   NSS pin is used as EXTI input, others libraries must not use EXTI on the same line
+ * @note   SPI peripheral is reset after each packet to clear CRC and stale data from host abort
+ * @note   MISO is always driven by slave, only one slave can be on the bus
  *
  * \par Changelog
  *
 @verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added optional DMA job queue with chip select, mode and prescaler for each job
+  
+ Version 1.2
+  - October 14, 2026
+  - Added data cache maintenance for STM32F7xx, RX buffer is invalidated when transfer is finished
+  
+ Version 1.3
+  - October 14, 2026
+  - Streams are allocated with TM DMA stream registry, other free stream is used when default stream is taken
+  
+ Version 1.4
+  - October 14, 2026
+  - TM_SPI_DMA_Transmit uses half word transfers when SPI is set to 16-bit data size
+  
+ Version 1.5
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+  
+ Version 1.6
+  - October 14, 2026
+  - Added slave packet mode with NSS framing, ping-pong buffers, ready pin and hardware CRC
 @endverbatim
  *
  * \par Dependencies
@@ -80,6 +169,7 @@ SPI6     | DMA2 | DMA Stream 5  | DMA Channel 1  | DMA Stream 6  | DMA Channel 0
  - defines.h
  - TM DMA
  - TM SPI
+ - TM EXTI
  - stdlib.h
 @endverbatim
  */
@@ -87,8 +177,14 @@ SPI6     | DMA2 | DMA Stream 5  | DMA Channel 1  | DMA Stream 6  | DMA Channel 0
 #include "defines.h"
 #include "tm_stm32_dma.h"
 #include "tm_stm32_spi.h"
+#include "tm_stm32_exti.h"
 #include "stdlib.h"
 
+/* Check DMA library version */
+#if TM_DMA_H < 140
+#error "TM DMA library version must be greater or equal to 1.4. Please redownload TM DMA library!"
+#endif
+
 /**
  * @defgroup TM_SPI_DMA_Macros
  * @brief    Library defines
@@ -145,6 +241,11 @@ SPI6     | DMA2 | DMA Stream 5  | DMA Channel 1  | DMA Stream 6  | DMA Channel 0
 #define SPI5_DMA_RX_CHANNEL   DMA_CHANNEL_7
 #endif
 
+/* Number of jobs in queue for each SPI, 0 disables queue */
+#ifndef SPI_DMA_QUEUE_SIZE
+#define SPI_DMA_QUEUE_SIZE    0
+#endif
+
 /* SPI6 TX and RX default settings */
 #ifndef SPI6_DMA_TX_STREAM
 #define SPI6_DMA_TX_STREAM    DMA2_Stream5
@@ -164,7 +265,57 @@ SPI6     | DMA2 | DMA Stream 5  | DMA Channel 1  | DMA Stream 6  | DMA Channel 0
  * @brief    Library Typedefs
  * @{
  */
-/* Typedefs here */
+
+/**
+ * @brief  Callback for finished queued SPI job
+ * @param  *SPIx: Pointer to SPIx peripheral where job was done
+ * @param  *RX_Buffer: Pointer to RX buffer of job, can be NULL
+ * @param  count: Number of bytes in job
+ * @param  status: Job status, 1 when job was done successfully, 0 on DMA error
+ * @param  *Param: Pointer to user parameter from job
+ * @retval None
+ */
+typedef void (*TM_SPI_DMA_Callback_t)(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param);
+
+/**
+ * @brief  Queued SPI DMA job
+ */
+typedef struct {
+	GPIO_TypeDef* CS_Port;          /*!< Chip select GPIO port, NULL when chip select is not used */
+	uint16_t CS_Pin;                /*!< Chip select GPIO pin, active low */
+	TM_SPI_Mode_t Mode;             /*!< SPI mode for job. This parameter can be a value of @ref TM_SPI_Mode_t enumeration */
+	uint16_t Prescaler;             /*!< SPI prescaler for job, SPI_BAUDRATEPRESCALER_x value */
+	uint8_t* TX_Buffer;             /*!< Pointer to TX data, NULL to send dummy bytes */
+	uint8_t* RX_Buffer;             /*!< Pointer to RX data, NULL when received data are not needed */
+	uint16_t Count;                 /*!< Number of bytes to exchange */
+	TM_SPI_DMA_Callback_t Callback; /*!< Finished callback, can be NULL */
+	void* Param;                    /*!< User parameter for callback */
+} TM_SPI_DMA_Job_t;
+
+/**
+ * @brief  SPI slave packet mode settings
+ * @note   Structure is used by library while slave mode is active and must stay valid
+ */
+typedef struct {
+	uint8_t* RX_Buffer[2];          /*!< Pointers to RX buffers for both pairs, each Size bytes long */
+	uint8_t* TX_Buffer[2];          /*!< Pointers to TX buffers for both pairs, each Size bytes long */
+	uint16_t Size;                  /*!< Maximal packet size in bytes, without CRC */
+	GPIO_TypeDef* NSS_Port;         /*!< NSS GPIO port, pin is initialized as EXTI input by library */
+	uint16_t NSS_Pin;               /*!< NSS GPIO pin */
+	GPIO_TypeDef* Ready_Port;       /*!< Ready GPIO port, NULL when ready pin is not used */
+	uint16_t Ready_Pin;             /*!< Ready GPIO pin, initialized as output by library, high when host can start packet */
+	uint16_t CRC_Polynomial;        /*!< SPI CRC polynomial, 0 disables CRC */
+	TM_SPI_DMA_Callback_t Callback; /*!< Packet callback, status is 0 on CRC error or short packet when CRC is used */
+	void* Param;                    /*!< User parameter for callback */
+	
+	/* Private */
+	volatile uint8_t Busy[2];       /*!< Pair is in user ownership */
+	volatile uint8_t Active;        /*!< Index of armed pair */
+	volatile uint8_t Armed;         /*!< DMA is armed and host can start packet */
+	uint32_t Packets;               /*!< Number of received packets */
+	uint32_t Errors;                /*!< Number of packets with error */
+} TM_SPI_DMA_Slave_t;
+
 /**
  * @}
  */
@@ -214,7 +365,7 @@ void TM_SPI_DMA_Deinit(SPI_TypeDef* SPIx);
  *            Set this parameter to NULL, if you want to sent "0x00" and only receive data into *RX_Buffer pointer
  * @param  *RX_Buffer: Pointer to RX_Buffer where DMA will save data from SPI.
  *            Set this parameter to NULL, if you don't want to receive any data, only sent from TX_Buffer
- * @param  count: Number of bytes to be send/received over SPI with DMA
+ * @param  count: Number of bytes to be send/received over SPI with DMA, number of half words when SPI is in 16-bit mode
  * @retval Transmission started status:
  *            - 0: DMA has not started with sending data
  *            - > 0: DMA has started with sending data
@@ -306,6 +457,57 @@ void TM_SPI_DMA_EnableInterrupts(SPI_TypeDef* SPIx);
  */
 void TM_SPI_DMA_DisableInterrupts(SPI_TypeDef* SPIx);
 
+/**
+ * @brief  Adds job to SPI queue
+ * @note   Available when SPI_DMA_QUEUE_SIZE is greater than 0
+ * @note   Job is started immediately if queue is empty, otherwise when previous jobs are finished
+ * @param  *SPIx: Pointer to SPIx peripheral where job will be done. SPI and its DMA must be initialized first
+ * @param  *Job: Pointer to @ref TM_SPI_DMA_Job_t job settings. Structure is copied, buffers must stay valid until callback is called
+ * @retval Queue status:
+ *            - 0: Queue is full or job is not valid, job was not added
+ *            - > 0: Job added to queue
+ */
+uint8_t TM_SPI_DMA_Enqueue(SPI_TypeDef* SPIx, const TM_SPI_DMA_Job_t* Job);
+
+/**
+ * @brief  Gets number of jobs in SPI queue, including active one
+ * @note   Available when SPI_DMA_QUEUE_SIZE is greater than 0
+ * @param  *SPIx: Pointer to SPIx peripheral
+ * @retval Number of pending jobs
+ */
+uint16_t TM_SPI_DMA_QueuePending(SPI_TypeDef* SPIx);
+
+/**
+ * @brief  Starts SPI slave packet mode
+ * @note   SPI must be initialized in slave mode and @ref TM_SPI_DMA_Init called before
+ * @note   Both buffer pairs are free after start, TX buffers must be filled before
+ * @param  *SPIx: Pointer to SPIx peripheral
+ * @param  *Slave: Pointer to @ref TM_SPI_DMA_Slave_t settings. Structure must stay valid until @ref TM_SPI_DMA_SlaveStop is called
+ * @retval Start status:
+ *            - 0: Settings are not valid or DMA is in use
+ *            - > 0: Slave mode started, ready pin is high
+ */
+uint8_t TM_SPI_DMA_SlaveStart(SPI_TypeDef* SPIx, TM_SPI_DMA_Slave_t* Slave);
+
+/**
+ * @brief  Stops SPI slave packet mode
+ * @note   Packet in progress is dropped without callback
+ * @param  *SPIx: Pointer to SPIx peripheral
+ * @retval None
+ */
+void TM_SPI_DMA_SlaveStop(SPI_TypeDef* SPIx);
+
+/**
+ * @brief  Releases buffer pair back to library after packet was processed
+ * @note   When DMA is not armed because both pairs were in user ownership, released pair is armed and ready pin goes high
+ * @param  *SPIx: Pointer to SPIx peripheral
+ * @param  *RX_Buffer: RX buffer of pair to release, as passed to callback
+ * @retval Release status:
+ *            - 0: Buffer does not belong to slave or pair is not in user ownership
+ *            - > 0: Pair released
+ */
+uint8_t TM_SPI_DMA_SlaveRelease(SPI_TypeDef* SPIx, uint8_t* RX_Buffer);
+
 /**
  * @}
  */
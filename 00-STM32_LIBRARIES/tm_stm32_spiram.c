@@ -0,0 +1,607 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_spiram.h"
+
+/* Memory commands */
+#define SPIRAM_CMD_READ            0x03
+#define SPIRAM_CMD_FAST_READ       0x0B
+#define SPIRAM_CMD_WRITE           0x02
+#define SPIRAM_CMD_WRITE_ENABLE    0x06
+#define SPIRAM_CMD_READ_STATUS     0x05
+#define SPIRAM_CMD_READ_ID         0x9F
+#define SPIRAM_CMD_RESET_ENABLE    0x66
+#define SPIRAM_CMD_RESET           0x99
+
+/* Known good die value in PSRAM ID */
+#define SPIRAM_PSRAM_KGD           0x5D
+
+/* Read command */
+#if SPIRAM_FAST_READ
+#define SPIRAM_CMD_DATA_READ       SPIRAM_CMD_FAST_READ
+#else
+#define SPIRAM_CMD_DATA_READ       SPIRAM_CMD_READ
+#endif
+
+/* Command, address and dummy byte */
+#define SPIRAM_HEADER_SIZE         (SPIRAM_ADDRESS_BYTES + 2)
+
+/* CS pin */
+#define SPIRAM_CS_LOW              TM_GPIO_SetPinLow(SPIRAM_CS_PORT, SPIRAM_CS_PIN)
+#define SPIRAM_CS_HIGH             TM_GPIO_SetPinHigh(SPIRAM_CS_PORT, SPIRAM_CS_PIN)
+
+#if SPIRAM_CACHE_LINES > 0
+/* Empty cache line */
+#define SPIRAM_CACHE_NONE          0xFFFFFFFF
+
+/* Cache line */
+typedef struct {
+	uint32_t Data[SPIRAM_CACHE_LINE_SIZE / 4]; /* Line data, word aligned for DMA */
+	uint32_t Address;                          /* Line address in memory or SPIRAM_CACHE_NONE */
+	uint8_t Dirty;                             /* Line is changed and not written to memory */
+} TM_SPIRAM_INT_Line_t;
+#endif
+
+#if SPIRAM_USE_ASYNC
+/* Asynchronous transfer phases */
+typedef enum {
+	TM_SPIRAM_INT_Phase_WriteEnable = 0x00,
+	TM_SPIRAM_INT_Phase_Header,
+	TM_SPIRAM_INT_Phase_Data
+} TM_SPIRAM_INT_Phase_t;
+
+/* Asynchronous transfer */
+typedef struct {
+	uint8_t Header[SPIRAM_HEADER_SIZE]; /* Command and address of current chunk */
+	uint8_t* Data;                      /* Data of current chunk */
+	uint32_t Address;                   /* Memory address of current chunk */
+	uint32_t Remaining;                 /* Bytes left, including current chunk */
+	uint16_t Chunk;                     /* Bytes in current chunk */
+	uint8_t Write;                      /* Transfer direction */
+	TM_SPIRAM_INT_Phase_t Phase;        /* Current job */
+	TM_SPIRAM_Callback_t Callback;      /* User callback */
+	void* Param;                        /* User parameter */
+} TM_SPIRAM_INT_Async_t;
+#endif
+
+/* Private variables */
+static uint8_t SPIRAM_Initialized;
+static uint16_t SPIRAM_Prescaler;
+#if SPIRAM_CACHE_LINES > 0
+static TM_SPIRAM_INT_Line_t SPIRAM_Cache[SPIRAM_CACHE_LINES];
+#endif
+#if SPIRAM_USE_ASYNC
+static TM_SPIRAM_INT_Async_t SPIRAM_Async;
+static volatile uint8_t SPIRAM_Busy;
+#endif
+
+/* Private functions */
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_Check(uint32_t Address, uint32_t Count);
+static uint8_t TM_SPIRAM_INT_Header(uint8_t* header, uint8_t cmd, uint32_t addr);
+static uint32_t TM_SPIRAM_INT_ChunkSize(uint32_t addr, uint32_t count);
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_Transfer(uint32_t addr, uint8_t* data, uint32_t count, uint8_t write);
+#if SPIRAM_CACHE_LINES > 0
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_CacheAccess(uint32_t addr, uint8_t* data, uint32_t count, uint8_t write);
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_CacheSync(uint32_t addr, uint32_t count, uint8_t invalidate);
+#endif
+#if SPIRAM_USE_ASYNC
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_AsyncStart(uint32_t addr, uint8_t* data, uint32_t count, uint8_t write, TM_SPIRAM_Callback_t Callback, void* Param);
+static uint8_t TM_SPIRAM_INT_AsyncChunk(void);
+static uint8_t TM_SPIRAM_INT_AsyncJob(uint8_t* tx, uint8_t* rx, uint16_t count);
+static void TM_SPIRAM_INT_AsyncCallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param);
+static void TM_SPIRAM_INT_AsyncFinish(TM_SPIRAM_Result_t result);
+#endif
+
+TM_SPIRAM_Result_t TM_SPIRAM_Init(void) {
+	uint8_t id[2];
+#if SPIRAM_CACHE_LINES > 0
+	uint16_t i;
+#endif
+	
+	/* Already initialized, memory content is kept */
+	if (SPIRAM_Initialized) {
+		return TM_SPIRAM_Result_Ok;
+	}
+	
+	/* Init delay functions */
+	TM_DELAY_Init();
+	
+	/* Init CS pin and SPI */
+	TM_GPIO_Init(SPIRAM_CS_PORT, SPIRAM_CS_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_UP, TM_GPIO_Speed_High);
+	SPIRAM_CS_HIGH;
+	SPIRAM_Prescaler = TM_SPI_GetPrescalerFromMaxFrequency(SPIRAM_SPI, SPIRAM_MAX_FREQUENCY);
+	TM_SPI_InitFull(SPIRAM_SPI, SPIRAM_SPI_PINSPACK, SPIRAM_Prescaler, TM_SPI_Mode_0, SPI_MODE_MASTER, SPI_FIRSTBIT_MSB);
+#if SPIRAM_DMA
+	TM_SPI_DMA_Init(SPIRAM_SPI);
+#endif
+	
+#if SPIRAM_TYPE == SPIRAM_TYPE_PSRAM
+	/* PSRAM needs 150 us after power up */
+	Delayms(1);
+	
+	/* Reset memory */
+	SPIRAM_CS_LOW;
+	TM_SPI_Send(SPIRAM_SPI, SPIRAM_CMD_RESET_ENABLE);
+	SPIRAM_CS_HIGH;
+	SPIRAM_CS_LOW;
+	TM_SPI_Send(SPIRAM_SPI, SPIRAM_CMD_RESET);
+	SPIRAM_CS_HIGH;
+	
+	/* Read ID, command is followed by 3 address bytes */
+	SPIRAM_CS_LOW;
+	TM_SPI_Send(SPIRAM_SPI, SPIRAM_CMD_READ_ID);
+	TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	id[0] = TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	id[1] = TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	SPIRAM_CS_HIGH;
+	
+	/* Check known good die value */
+	if (id[1] != SPIRAM_PSRAM_KGD) {
+		return TM_SPIRAM_Result_Error;
+	}
+#else
+	/* Read status register twice, FRAM is never busy */
+	SPIRAM_CS_LOW;
+	TM_SPI_Send(SPIRAM_SPI, SPIRAM_CMD_READ_STATUS);
+	id[0] = TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	id[1] = TM_SPI_Send(SPIRAM_SPI, 0xFF);
+	SPIRAM_CS_HIGH;
+	
+	/* MISO is high when memory does not respond */
+	if ((id[0] & 0x01) || (id[1] & 0x01)) {
+		return TM_SPIRAM_Result_Error;
+	}
+#endif
+	
+#if SPIRAM_CACHE_LINES > 0
+	/* Empty cache */
+	for (i = 0; i < SPIRAM_CACHE_LINES; i++) {
+		SPIRAM_Cache[i].Address = SPIRAM_CACHE_NONE;
+		SPIRAM_Cache[i].Dirty = 0;
+	}
+#endif
+	
+	/* Memory is ready */
+	SPIRAM_Initialized = 1;
+	
+	/* Return OK */
+	return TM_SPIRAM_Result_Ok;
+}
+
+TM_SPIRAM_Result_t TM_SPIRAM_Read(uint32_t Address, void* Data, uint32_t Count) {
+	TM_SPIRAM_Result_t result;
+	
+	/* Check state and range */
+	if ((result = TM_SPIRAM_INT_Check(Address, Count)) != TM_SPIRAM_Result_Ok || Count == 0) {
+		return result;
+	}
+	
+#if SPIRAM_CACHE_LINES > 0
+	/* Short reads go through cache */
+	if (Count < SPIRAM_CACHE_LINE_SIZE) {
+		return TM_SPIRAM_INT_CacheAccess(Address, (uint8_t *)Data, Count, 0);
+	}
+	
+	/* Write changed lines in range first, memory is then up to date */
+	if ((result = TM_SPIRAM_INT_CacheSync(Address, Count, 0)) != TM_SPIRAM_Result_Ok) {
+		return result;
+	}
+#endif
+	
+	/* Read directly from memory */
+	return TM_SPIRAM_INT_Transfer(Address, (uint8_t *)Data, Count, 0);
+}
+
+TM_SPIRAM_Result_t TM_SPIRAM_Write(uint32_t Address, const void* Data, uint32_t Count) {
+	TM_SPIRAM_Result_t result;
+	
+	/* Check state and range */
+	if ((result = TM_SPIRAM_INT_Check(Address, Count)) != TM_SPIRAM_Result_Ok || Count == 0) {
+		return result;
+	}
+	
+#if SPIRAM_CACHE_LINES > 0
+	/* Short writes go through cache */
+	if (Count < SPIRAM_CACHE_LINE_SIZE) {
+		return TM_SPIRAM_INT_CacheAccess(Address, (uint8_t *)Data, Count, 1);
+	}
+	
+	/* Lines in range would be old after write */
+	if ((result = TM_SPIRAM_INT_CacheSync(Address, Count, 1)) != TM_SPIRAM_Result_Ok) {
+		return result;
+	}
+#endif
+	
+	/* Write directly to memory */
+	return TM_SPIRAM_INT_Transfer(Address, (uint8_t *)Data, Count, 1);
+}
+
+TM_SPIRAM_Result_t TM_SPIRAM_Flush(void) {
+	TM_SPIRAM_Result_t result;
+	
+	/* Check state */
+	if ((result = TM_SPIRAM_INT_Check(0, 0)) != TM_SPIRAM_Result_Ok) {
+		return result;
+	}
+	
+#if SPIRAM_CACHE_LINES > 0
+	/* Write all changed lines */
+	return TM_SPIRAM_INT_CacheSync(0, SPIRAM_MEMORY_SIZE, 0);
+#else
+	/* Nothing to write */
+	return TM_SPIRAM_Result_Ok;
+#endif
+}
+
+#if SPIRAM_USE_ASYNC
+TM_SPIRAM_Result_t TM_SPIRAM_ReadAsync(uint32_t Address, void* Data, uint32_t Count, TM_SPIRAM_Callback_t Callback, void* Param) {
+	return TM_SPIRAM_INT_AsyncStart(Address, (uint8_t *)Data, Count, 0, Callback, Param);
+}
+
+TM_SPIRAM_Result_t TM_SPIRAM_WriteAsync(uint32_t Address, const void* Data, uint32_t Count, TM_SPIRAM_Callback_t Callback, void* Param) {
+	return TM_SPIRAM_INT_AsyncStart(Address, (uint8_t *)Data, Count, 1, Callback, Param);
+}
+
+uint8_t TM_SPIRAM_IsBusy(void) {
+	return SPIRAM_Busy;
+}
+#endif
+
+/* Private functions */
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_Check(uint32_t Address, uint32_t Count) {
+	/* Check if memory is ready */
+	if (!SPIRAM_Initialized) {
+		return TM_SPIRAM_Result_Error;
+	}
+#if SPIRAM_USE_ASYNC
+	if (SPIRAM_Busy) {
+		return TM_SPIRAM_Result_Busy;
+	}
+#endif
+	
+	/* Check range, written to avoid overflow */
+	if (Count > SPIRAM_MEMORY_SIZE || Address > SPIRAM_MEMORY_SIZE - Count) {
+		return TM_SPIRAM_Result_Address;
+	}
+	
+	/* Return OK */
+	return TM_SPIRAM_Result_Ok;
+}
+
+static uint8_t TM_SPIRAM_INT_Header(uint8_t* header, uint8_t cmd, uint32_t addr) {
+	uint8_t len = 0;
+	
+	/* Command and address, MSB first */
+	header[len++] = cmd;
+#if SPIRAM_ADDRESS_BYTES == 3
+	header[len++] = (uint8_t)(addr >> 16);
+#endif
+	header[len++] = (uint8_t)(addr >> 8);
+	header[len++] = (uint8_t)(addr);
+	
+	/* Fast read has 8 wait cycles */
+	if (cmd == SPIRAM_CMD_FAST_READ) {
+		header[len++] = 0xFF;
+	}
+	
+	/* Return header length */
+	return len;
+}
+
+static uint32_t TM_SPIRAM_INT_ChunkSize(uint32_t addr, uint32_t count) {
+#if SPIRAM_PAGE_SIZE > 0
+	/* Burst wraps at page boundary */
+	if (count > SPIRAM_PAGE_SIZE - (addr % SPIRAM_PAGE_SIZE)) {
+		count = SPIRAM_PAGE_SIZE - (addr % SPIRAM_PAGE_SIZE);
+	}
+#endif
+	
+	/* Limit time of chip select */
+	if (count > SPIRAM_MAX_BURST) {
+		count = SPIRAM_MAX_BURST;
+	}
+	
+	/* Return chunk length */
+	return count;
+}
+
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_Transfer(uint32_t addr, uint8_t* data, uint32_t count, uint8_t write) {
+	uint8_t header[SPIRAM_HEADER_SIZE], len;
+	uint32_t chunk;
+	
+	while (count) {
+		/* Get bytes for one chip select */
+		chunk = TM_SPIRAM_INT_ChunkSize(addr, count);
+		
+#if SPIRAM_TYPE == SPIRAM_TYPE_FRAM
+		/* Write enable is cleared after each write */
+		if (write) {
+			SPIRAM_CS_LOW;
+			TM_SPI_Send(SPIRAM_SPI, SPIRAM_CMD_WRITE_ENABLE);
+			SPIRAM_CS_HIGH;
+		}
+#endif
+		
+		/* Send command and address */
+		len = TM_SPIRAM_INT_Header(header, write ? SPIRAM_CMD_WRITE : SPIRAM_CMD_DATA_READ, addr);
+		SPIRAM_CS_LOW;
+		TM_SPI_WriteMulti(SPIRAM_SPI, header, len);
+		
+#if SPIRAM_DMA
+		/* Long parts with DMA */
+		if (chunk >= SPIRAM_DMA_MIN) {
+			if (!TM_SPI_DMA_Transmit(SPIRAM_SPI, write ? data : NULL, write ? NULL : data, (uint16_t)chunk)) {
+				SPIRAM_CS_HIGH;
+				return TM_SPIRAM_Result_Error;
+			}
+			while (TM_SPI_DMA_Transmitting(SPIRAM_SPI));
+		} else
+#endif
+		if (write) {
+			TM_SPI_WriteMulti(SPIRAM_SPI, data, chunk);
+		} else {
+			TM_SPI_ReadMulti(SPIRAM_SPI, data, 0xFF, chunk);
+		}
+		SPIRAM_CS_HIGH;
+		
+		/* Go to next chunk */
+		addr += chunk;
+		data += chunk;
+		count -= chunk;
+	}
+	
+	/* Return OK */
+	return TM_SPIRAM_Result_Ok;
+}
+
+#if SPIRAM_CACHE_LINES > 0
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_CacheAccess(uint32_t addr, uint8_t* data, uint32_t count, uint8_t write) {
+	TM_SPIRAM_INT_Line_t* line;
+	uint32_t base, offset, len;
+	
+	while (count) {
+		/* Line for address, direct mapped */
+		base = addr & ~(uint32_t)(SPIRAM_CACHE_LINE_SIZE - 1);
+		offset = addr - base;
+		len = SPIRAM_CACHE_LINE_SIZE - offset;
+		if (len > count) {
+			len = count;
+		}
+		line = &SPIRAM_Cache[(base / SPIRAM_CACHE_LINE_SIZE) % SPIRAM_CACHE_LINES];
+		
+		/* Line holds other address */
+		if (line->Address != base) {
+			/* Write back changed line */
+			if (line->Address != SPIRAM_CACHE_NONE && line->Dirty) {
+				if (TM_SPIRAM_INT_Transfer(line->Address, (uint8_t *)line->Data, SPIRAM_CACHE_LINE_SIZE, 1) != TM_SPIRAM_Result_Ok) {
+					return TM_SPIRAM_Result_Error;
+				}
+			}
+			line->Address = SPIRAM_CACHE_NONE;
+			line->Dirty = 0;
+			
+			/* Load line, not needed when whole line is written */
+			if (!write || len < SPIRAM_CACHE_LINE_SIZE) {
+				if (TM_SPIRAM_INT_Transfer(base, (uint8_t *)line->Data, SPIRAM_CACHE_LINE_SIZE, 0) != TM_SPIRAM_Result_Ok) {
+					return TM_SPIRAM_Result_Error;
+				}
+			}
+			line->Address = base;
+		}
+		
+		/* Copy data */
+		if (write) {
+			memcpy((uint8_t *)line->Data + offset, data, len);
+			line->Dirty = 1;
+		} else {
+			memcpy(data, (uint8_t *)line->Data + offset, len);
+		}
+		
+		/* Go to next line */
+		addr += len;
+		data += len;
+		count -= len;
+	}
+	
+	/* Return OK */
+	return TM_SPIRAM_Result_Ok;
+}
+
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_CacheSync(uint32_t addr, uint32_t count, uint8_t invalidate) {
+	TM_SPIRAM_INT_Line_t* line;
+	uint16_t i;
+	
+	for (i = 0; i < SPIRAM_CACHE_LINES; i++) {
+		line = &SPIRAM_Cache[i];
+		
+		/* Check if line is inside range */
+		if (line->Address == SPIRAM_CACHE_NONE || line->Address + SPIRAM_CACHE_LINE_SIZE <= addr || line->Address >= addr + count) {
+			continue;
+		}
+		
+		/* Write changed line */
+		if (line->Dirty) {
+			if (TM_SPIRAM_INT_Transfer(line->Address, (uint8_t *)line->Data, SPIRAM_CACHE_LINE_SIZE, 1) != TM_SPIRAM_Result_Ok) {
+				return TM_SPIRAM_Result_Error;
+			}
+			line->Dirty = 0;
+		}
+		
+		/* Drop line */
+		if (invalidate) {
+			line->Address = SPIRAM_CACHE_NONE;
+		}
+	}
+	
+	/* Return OK */
+	return TM_SPIRAM_Result_Ok;
+}
+#endif
+
+#if SPIRAM_USE_ASYNC
+static TM_SPIRAM_Result_t TM_SPIRAM_INT_AsyncStart(uint32_t addr, uint8_t* data, uint32_t count, uint8_t write, TM_SPIRAM_Callback_t Callback, void* Param) {
+	TM_SPIRAM_Result_t result;
+	
+	/* Check state and range */
+	if ((result = TM_SPIRAM_INT_Check(addr, count)) != TM_SPIRAM_Result_Ok) {
+		return result;
+	}
+	if (count == 0) {
+		return TM_SPIRAM_Result_Error;
+	}
+	
+#if SPIRAM_CACHE_LINES > 0
+	/* Cache must be up to date before DMA starts */
+	if ((result = TM_SPIRAM_INT_CacheSync(addr, count, write)) != TM_SPIRAM_Result_Ok) {
+		return result;
+	}
+#endif
+	
+	/* Save transfer */
+	SPIRAM_Async.Address = addr;
+	SPIRAM_Async.Data = data;
+	SPIRAM_Async.Remaining = count;
+	SPIRAM_Async.Write = write;
+	SPIRAM_Async.Callback = Callback;
+	SPIRAM_Async.Param = Param;
+	SPIRAM_Busy = 1;
+	
+	/* Start first chunk, next ones are started from DMA interrupt */
+	if (!TM_SPIRAM_INT_AsyncChunk()) {
+		SPIRAM_CS_HIGH;
+		SPIRAM_Busy = 0;
+		return TM_SPIRAM_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_SPIRAM_Result_Ok;
+}
+
+static uint8_t TM_SPIRAM_INT_AsyncChunk(void) {
+	/* Get bytes for one chip select */
+	SPIRAM_Async.Chunk = (uint16_t)TM_SPIRAM_INT_ChunkSize(SPIRAM_Async.Address, SPIRAM_Async.Remaining);
+	
+	/* Select memory */
+	SPIRAM_CS_LOW;
+	
+#if SPIRAM_TYPE == SPIRAM_TYPE_FRAM
+	/* Write enable is cleared after each write */
+	if (SPIRAM_Async.Write) {
+		SPIRAM_Async.Phase = TM_SPIRAM_INT_Phase_WriteEnable;
+		SPIRAM_Async.Header[0] = SPIRAM_CMD_WRITE_ENABLE;
+		return TM_SPIRAM_INT_AsyncJob(SPIRAM_Async.Header, NULL, 1);
+	}
+#endif
+	
+	/* Send command and address */
+	SPIRAM_Async.Phase = TM_SPIRAM_INT_Phase_Header;
+	return TM_SPIRAM_INT_AsyncJob(
+		SPIRAM_Async.Header, NULL, 
+		TM_SPIRAM_INT_Header(SPIRAM_Async.Header, SPIRAM_Async.Write ? SPIRAM_CMD_WRITE : SPIRAM_CMD_DATA_READ, SPIRAM_Async.Address)
+	);
+}
+
+static uint8_t TM_SPIRAM_INT_AsyncJob(uint8_t* tx, uint8_t* rx, uint16_t count) {
+	TM_SPI_DMA_Job_t job;
+	
+	/* Chip select is handled by library, it must stay low between header and data */
+	job.CS_Port = NULL;
+	job.CS_Pin = 0;
+	job.Mode = TM_SPI_Mode_0;
+	job.Prescaler = SPIRAM_Prescaler;
+	job.TX_Buffer = tx;
+	job.RX_Buffer = rx;
+	job.Count = count;
+	job.Callback = TM_SPIRAM_INT_AsyncCallback;
+	job.Param = NULL;
+	
+	/* Add to queue */
+	return TM_SPI_DMA_Enqueue(SPIRAM_SPI, &job);
+}
+
+static void TM_SPIRAM_INT_AsyncCallback(SPI_TypeDef* SPIx, uint8_t* RX_Buffer, uint16_t count, uint8_t status, void* Param) {
+	/* DMA error */
+	if (!status) {
+		TM_SPIRAM_INT_AsyncFinish(TM_SPIRAM_Result_Error);
+		return;
+	}
+	
+	switch (SPIRAM_Async.Phase) {
+		case TM_SPIRAM_INT_Phase_WriteEnable:
+			/* Write enable is latched on rising edge of chip select */
+			SPIRAM_CS_HIGH;
+			SPIRAM_CS_LOW;
+			SPIRAM_Async.Phase = TM_SPIRAM_INT_Phase_Header;
+			status = TM_SPIRAM_INT_AsyncJob(
+				SPIRAM_Async.Header, NULL, 
+				TM_SPIRAM_INT_Header(SPIRAM_Async.Header, SPIRAM_CMD_WRITE, SPIRAM_Async.Address)
+			);
+			break;
+		case TM_SPIRAM_INT_Phase_Header:
+			/* Transfer data with the same chip select */
+			SPIRAM_Async.Phase = TM_SPIRAM_INT_Phase_Data;
+			status = TM_SPIRAM_INT_AsyncJob(
+				SPIRAM_Async.Write ? SPIRAM_Async.Data : NULL, 
+				SPIRAM_Async.Write ? NULL : SPIRAM_Async.Data, 
+				SPIRAM_Async.Chunk
+			);
+			break;
+		default:
+			/* Chunk is done */
+			SPIRAM_CS_HIGH;
+			SPIRAM_Async.Address += SPIRAM_Async.Chunk;
+			SPIRAM_Async.Data += SPIRAM_Async.Chunk;
+			SPIRAM_Async.Remaining -= SPIRAM_Async.Chunk;
+			
+			/* All data transferred */
+			if (SPIRAM_Async.Remaining == 0) {
+				TM_SPIRAM_INT_AsyncFinish(TM_SPIRAM_Result_Ok);
+				return;
+			}
+			
+			/* Start next chunk */
+			status = TM_SPIRAM_INT_AsyncChunk();
+			break;
+	}
+	
+	/* Queue is full, SPI is used by someone else */
+	if (!status) {
+		TM_SPIRAM_INT_AsyncFinish(TM_SPIRAM_Result_Error);
+	}
+}
+
+static void TM_SPIRAM_INT_AsyncFinish(TM_SPIRAM_Result_t result) {
+	/* Release memory before callback, so callback can start new transfer */
+	SPIRAM_CS_HIGH;
+	SPIRAM_Busy = 0;
+	
+	/* Call user callback */
+	if (SPIRAM_Async.Callback) {
+		SPIRAM_Async.Callback(result, SPIRAM_Async.Param);
+	}
+}
+#endif
@@ -0,0 +1,402 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   SPI PSRAM and FRAM memory driver for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_SPIRAM_H
+#define TM_SPIRAM_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_SPIRAM
+ * @brief    SPI PSRAM and FRAM memory driver for STM32Fxxx
+ * @{
+ *
+ * Library adds external RAM to devices without FMC, for example STM32F401 and STM32F411.
+ * Memory is not mapped to address space, data are copied between internal RAM and memory with read and write functions.
+ *
+ * Supported memories:
+ *  - SPI PSRAM (APS6404, ESP-PSRAM64, LY68L6400, ...) with fast read (0x0B), write (0x02), 24-bit address and 1 kB page
+ *  - SPI FRAM (MB85RSxx, FM25Vxx, CY15Bxx, ...) with read (0x03), write enable (0x06) and write (0x02). FRAM keeps data when power is off.
+ *
+ * Transfers are split on page boundaries and to at most SPIRAM_MAX_BURST bytes for each chip select,
+ * longer parts of transfer are done with DMA on STM32F4xx and STM32F7xx devices.
+ *
+ * @note   SPI is used only for memory, chip select is handled by library
+ * @note   DMA buffers can not be in CCM RAM on STM32F4xx devices
+ *
+\code
+//Use FRAM with 32 kB on SPI2
+#define SPIRAM_TYPE               SPIRAM_TYPE_FRAM
+#define SPIRAM_MEMORY_SIZE        0x8000
+#define SPIRAM_SPI                SPI2
+#define SPIRAM_SPI_PINSPACK       TM_SPI_PinsPack_2
+#define SPIRAM_CS_PORT            GPIOB
+#define SPIRAM_CS_PIN             GPIO_PIN_12
+\endcode
+ *
+ * \par Write-back cache
+ *
+ * Many small accesses, for example single variables or list nodes, are slow because each one needs command and address.
+ * When SPIRAM_CACHE_LINES is greater than 0, reads and writes shorter than SPIRAM_CACHE_LINE_SIZE go through direct mapped cache in internal RAM.
+ * Changed lines are written to memory when line is reused, before longer transfer in the same range or with @ref TM_SPIRAM_Flush.
+ *
+\code
+//8 lines of 32 bytes, 256 bytes of RAM
+#define SPIRAM_CACHE_LINES        8
+#define SPIRAM_CACHE_LINE_SIZE    32
+\endcode
+ *
+ * \par Asynchronous streaming
+ *
+ * When SPI_DMA_QUEUE_SIZE is greater than 0, @ref TM_SPIRAM_ReadAsync and @ref TM_SPIRAM_WriteAsync
+ * start transfer with TM SPI DMA job queue and return immediately. Callback is called from DMA interrupt when all data are transferred,
+ * so for example network or logging buffers are moved to memory while CPU does other work.
+ *
+\code
+//Move full logging buffer to memory, buffer can be reused in callback
+void LogSaved(TM_SPIRAM_Result_t result, void* Param) {
+	LogBufferFree = 1;
+}
+
+TM_SPIRAM_WriteAsync(LogAddress, LogBuffer, sizeof(LogBuffer), LogSaved, NULL);
+\endcode
+ *
+ * \par FatFs and FFT
+ *
+ * FatFs can use memory as RAM disk (or nonvolatile disk with FRAM) with fatfs/drivers/fatfs_spiram.c driver, see @ref TM_FATFS_SPIRAM.
+ * Part of memory which is not used by disk is free for other buffers.
+ *
+ * FFT functions need samples in internal RAM. Buffers are kept in memory and copied to FFT buffers before processing,
+ * for example history of input blocks or spectrum lines for waterfall display:
+ *
+\code
+//Save spectrum line after processing
+TM_SPIRAM_Write(SPECTRUM_ADDRESS + line * FFT_SIZE / 2 * sizeof(float32_t), FFT.Output, FFT_SIZE / 2 * sizeof(float32_t));
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM SPI
+ - TM SPI DMA (only on STM32F4xx and STM32F7xx)
+ - TM GPIO
+ - TM DELAY
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_spi.h"
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_delay.h"
+#include "string.h"
+
+/* DMA for STM32F4xx and STM32F7xx */
+#if defined(STM32F4xx) || defined(STM32F7xx)
+#include "tm_stm32_spi_dma.h"
+#define SPIRAM_DMA                1
+#else
+#define SPIRAM_DMA                0
+#endif
+
+/**
+ * @defgroup TM_SPIRAM_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Memory types */
+#define SPIRAM_TYPE_PSRAM         0 /*!< SPI pseudo static RAM */
+#define SPIRAM_TYPE_FRAM          1 /*!< SPI ferroelectric RAM */
+
+/* Memory type */
+#ifndef SPIRAM_TYPE
+#define SPIRAM_TYPE               SPIRAM_TYPE_PSRAM
+#endif
+
+/* Memory size in units of bytes, 8 MB PSRAM or 32 kB FRAM by default */
+#ifndef SPIRAM_MEMORY_SIZE
+#if SPIRAM_TYPE == SPIRAM_TYPE_PSRAM
+#define SPIRAM_MEMORY_SIZE        0x800000
+#else
+#define SPIRAM_MEMORY_SIZE        0x8000
+#endif
+#endif
+
+/* Number of address bytes, FRAM up to 64 kB uses 2 bytes */
+#ifndef SPIRAM_ADDRESS_BYTES
+#if SPIRAM_MEMORY_SIZE > 0x10000
+#define SPIRAM_ADDRESS_BYTES      3
+#else
+#define SPIRAM_ADDRESS_BYTES      2
+#endif
+#endif
+
+/* Page size, burst can not cross page boundary. 0 when memory has no pages */
+#ifndef SPIRAM_PAGE_SIZE
+#if SPIRAM_TYPE == SPIRAM_TYPE_PSRAM
+#define SPIRAM_PAGE_SIZE          1024
+#else
+#define SPIRAM_PAGE_SIZE          0
+#endif
+#endif
+
+/* Maximal number of data bytes for one chip select.
+   PSRAM needs chip select high for refresh every 8 us (tCEM) at high temperature, lower this value in that case */
+#ifndef SPIRAM_MAX_BURST
+#if SPIRAM_PAGE_SIZE > 0
+#define SPIRAM_MAX_BURST          SPIRAM_PAGE_SIZE
+#else
+#define SPIRAM_MAX_BURST          0xFFFF
+#endif
+#endif
+
+/* Use fast read command with dummy byte, needed for PSRAM above 33 MHz */
+#ifndef SPIRAM_FAST_READ
+#if SPIRAM_TYPE == SPIRAM_TYPE_PSRAM
+#define SPIRAM_FAST_READ          1
+#else
+#define SPIRAM_FAST_READ          0
+#endif
+#endif
+
+/* Maximal SPI clock in units of Hz */
+#ifndef SPIRAM_MAX_FREQUENCY
+#define SPIRAM_MAX_FREQUENCY      40000000
+#endif
+
+/* SPI settings */
+#ifndef SPIRAM_SPI
+#define SPIRAM_SPI                SPI1
+#define SPIRAM_SPI_PINSPACK       TM_SPI_PinsPack_1
+#endif
+
+/* CS pin settings */
+#ifndef SPIRAM_CS_PIN
+#define SPIRAM_CS_PORT            GPIOA
+#define SPIRAM_CS_PIN             GPIO_PIN_4
+#endif
+
+/* Minimal number of bytes transferred with DMA, shorter parts are faster without DMA setup */
+#ifndef SPIRAM_DMA_MIN
+#define SPIRAM_DMA_MIN            16
+#endif
+
+/* Number of cache lines, 0 disables cache */
+#ifndef SPIRAM_CACHE_LINES
+#define SPIRAM_CACHE_LINES        0
+#endif
+
+/* Size of one cache line in units of bytes, power of 2 */
+#ifndef SPIRAM_CACHE_LINE_SIZE
+#define SPIRAM_CACHE_LINE_SIZE    32
+#endif
+
+/* Asynchronous functions with SPI DMA queue */
+#if SPIRAM_DMA && SPI_DMA_QUEUE_SIZE > 0
+#define SPIRAM_USE_ASYNC          1
+#else
+#define SPIRAM_USE_ASYNC          0
+#endif
+
+/* Check settings */
+#if SPIRAM_ADDRESS_BYTES != 2 && SPIRAM_ADDRESS_BYTES != 3
+#error "SPIRAM_ADDRESS_BYTES must be 2 or 3!"
+#endif
+#if SPIRAM_MAX_BURST < 1 || SPIRAM_MAX_BURST > 0xFFFF
+#error "SPIRAM_MAX_BURST must be between 1 and 65535!"
+#endif
+#if SPIRAM_CACHE_LINES > 0 && (SPIRAM_CACHE_LINE_SIZE & (SPIRAM_CACHE_LINE_SIZE - 1))
+#error "SPIRAM_CACHE_LINE_SIZE must be power of 2!"
+#endif
+#if SPIRAM_CACHE_LINES > 0 && SPIRAM_PAGE_SIZE > 0 && (SPIRAM_PAGE_SIZE % SPIRAM_CACHE_LINE_SIZE)
+#error "SPIRAM_CACHE_LINE_SIZE must divide SPIRAM_PAGE_SIZE!"
+#endif
+
+/**
+ * @brief  Gets memory size in units of bytes
+ * @param  None
+ * @retval Memory size
+ */
+#define TM_SPIRAM_GetSize()       ((uint32_t)SPIRAM_MEMORY_SIZE)
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_SPIRAM_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Result enumeration
+ */
+typedef enum {
+	TM_SPIRAM_Result_Ok = 0x00, /*!< Everything OK */
+	TM_SPIRAM_Result_Error,     /*!< Memory does not respond, is not initialized or DMA error */
+	TM_SPIRAM_Result_Busy,      /*!< Asynchronous transfer is in progress */
+	TM_SPIRAM_Result_Address    /*!< Address range is outside memory */
+} TM_SPIRAM_Result_t;
+
+/**
+ * @brief  Callback for finished asynchronous transfer
+ * @note   Called from DMA interrupt
+ * @param  result: Transfer result. This parameter is a value of @ref TM_SPIRAM_Result_t enumeration
+ * @param  *Param: Pointer to user parameter
+ * @retval None
+ */
+typedef void (*TM_SPIRAM_Callback_t)(TM_SPIRAM_Result_t result, void* Param);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_SPIRAM_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes SPI, chip select pin and memory
+ * @note   Memory is initialized only once, next calls return OK, so FatFs driver and user code can both call it
+ * @param  None
+ * @retval Member of @ref TM_SPIRAM_Result_t enumeration
+ */
+TM_SPIRAM_Result_t TM_SPIRAM_Init(void);
+
+/**
+ * @brief  Reads data from memory
+ * @param  Address: Address in memory to read from
+ * @param  *Data: Pointer to buffer for data
+ * @param  Count: Number of bytes to read
+ * @retval Member of @ref TM_SPIRAM_Result_t enumeration
+ */
+TM_SPIRAM_Result_t TM_SPIRAM_Read(uint32_t Address, void* Data, uint32_t Count);
+
+/**
+ * @brief  Writes data to memory
+ * @note   With cache enabled, short writes may stay in cache until @ref TM_SPIRAM_Flush
+ * @param  Address: Address in memory to write to
+ * @param  *Data: Pointer to data to write
+ * @param  Count: Number of bytes to write
+ * @retval Member of @ref TM_SPIRAM_Result_t enumeration
+ */
+TM_SPIRAM_Result_t TM_SPIRAM_Write(uint32_t Address, const void* Data, uint32_t Count);
+
+/**
+ * @brief  Writes all changed cache lines to memory
+ * @note   Does nothing when cache is disabled
+ * @param  None
+ * @retval Member of @ref TM_SPIRAM_Result_t enumeration
+ */
+TM_SPIRAM_Result_t TM_SPIRAM_Flush(void);
+
+#if SPIRAM_USE_ASYNC || defined(DOXYGEN)
+/**
+ * @brief  Starts reading data from memory in background
+ * @note   Available when SPI_DMA_QUEUE_SIZE is greater than 0
+ * @param  Address: Address in memory to read from
+ * @param  *Data: Pointer to buffer for data, must stay valid until callback is called
+ * @param  Count: Number of bytes to read
+ * @param  Callback: Function called from DMA interrupt when transfer is finished, can be NULL
+ * @param  *Param: Pointer to user parameter for callback
+ * @retval Member of @ref TM_SPIRAM_Result_t enumeration, callback is called only when transfer was started with OK status
+ */
+TM_SPIRAM_Result_t TM_SPIRAM_ReadAsync(uint32_t Address, void* Data, uint32_t Count, TM_SPIRAM_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Starts writing data to memory in background
+ * @note   Available when SPI_DMA_QUEUE_SIZE is greater than 0
+ * @param  Address: Address in memory to write to
+ * @param  *Data: Pointer to data to write, must stay valid until callback is called
+ * @param  Count: Number of bytes to write
+ * @param  Callback: Function called from DMA interrupt when transfer is finished, can be NULL
+ * @param  *Param: Pointer to user parameter for callback
+ * @retval Member of @ref TM_SPIRAM_Result_t enumeration, callback is called only when transfer was started with OK status
+ */
+TM_SPIRAM_Result_t TM_SPIRAM_WriteAsync(uint32_t Address, const void* Data, uint32_t Count, TM_SPIRAM_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Checks if asynchronous transfer is in progress
+ * @note   Available when SPI_DMA_QUEUE_SIZE is greater than 0
+ * @param  None
+ * @retval Transfer status:
+ *            - 0: Memory is free
+ *            - > 0: Transfer is in progress
+ */
+uint8_t TM_SPIRAM_IsBusy(void);
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
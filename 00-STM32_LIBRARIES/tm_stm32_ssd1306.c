@@ -25,22 +25,48 @@
  */
 #include "tm_stm32_ssd1306.h"
 
+#if SSD1306_USE_SPI
+/* Write command */
+#define SSD1306_WRITECOMMAND(command)      SSD1306_SPI_WriteCommand(command)
+/* Control pins */
+#define SSD1306_CS_HIGH                    TM_GPIO_SetPinHigh(SSD1306_CS_PORT, SSD1306_CS_PIN)
+#define SSD1306_CS_LOW                     TM_GPIO_SetPinLow(SSD1306_CS_PORT, SSD1306_CS_PIN)
+#define SSD1306_DC_HIGH                    TM_GPIO_SetPinHigh(SSD1306_DC_PORT, SSD1306_DC_PIN)
+#define SSD1306_DC_LOW                     TM_GPIO_SetPinLow(SSD1306_DC_PORT, SSD1306_DC_PIN)
+#else
 /* Write command */
 #define SSD1306_WRITECOMMAND(command)      TM_I2C_Write(SSD1306_I2C, SSD1306_I2C_ADDR, 0x00, (command))
 /* Write data */
 #define SSD1306_WRITEDATA(data)            TM_I2C_Write(SSD1306_I2C, SSD1306_I2C_ADDR, 0x40, (data))
+#endif
 /* Absolute value */
 #define ABS(x)   ((x) > 0 ? (x) : -(x))
 
+/* Number of pages, 8 rows each */
+#define SSD1306_PAGES                      (SSD1306_HEIGHT / 8)
+
 /* SSD1306 data buffer */
 static uint8_t SSD1306_Buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
 
+/* Changed column range for each page, page is clean when start > end */
+static uint8_t SSD1306_DirtyStart[SSD1306_PAGES];
+static uint8_t SSD1306_DirtyEnd[SSD1306_PAGES];
+
+/* Private functions */
+static void SSD1306_SetDirtyAll(void);
+static void SSD1306_PutGlyphPages(const TM_FONT_GLYPH_t* Glyph, uint8_t height, SSD1306_COLOR_t color);
+#if SSD1306_USE_SPI
+static void SSD1306_SPI_WriteCommand(uint8_t command);
+static void SSD1306_SPI_Wait(void);
+#endif
+
 /* Private SSD1306 structure */
 typedef struct {
 	uint16_t CurrentX;
 	uint16_t CurrentY;
 	uint8_t Inverted;
 	uint8_t Initialized;
+	uint8_t Busy;
 } SSD1306_t;
 
 /* Private variable */
@@ -50,6 +76,23 @@ uint8_t TM_SSD1306_Init(void) {
 	/* Init delay */
 	TM_DELAY_Init();
 	
+#if SSD1306_USE_SPI
+	/* Init control pins, chip select high */
+	TM_GPIO_Init(SSD1306_CS_PORT, SSD1306_CS_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High);
+	TM_GPIO_Init(SSD1306_DC_PORT, SSD1306_DC_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_High);
+	TM_GPIO_Init(SSD1306_RST_PORT, SSD1306_RST_PIN, TM_GPIO_Mode_OUT, TM_GPIO_OType_PP, TM_GPIO_PuPd_NOPULL, TM_GPIO_Speed_Low);
+	SSD1306_CS_HIGH;
+	
+	/* Init SPI and DMA */
+	TM_SPI_InitFull(SSD1306_SPI, SSD1306_SPI_PINSPACK, SSD1306_SPI_PRESCALER, TM_SPI_Mode_0, SPI_MODE_MASTER, SPI_FIRSTBIT_MSB);
+	TM_SPI_DMA_Init(SSD1306_SPI);
+	SSD1306.Busy = 0;
+	
+	/* Reset LCD */
+	TM_GPIO_SetPinLow(SSD1306_RST_PORT, SSD1306_RST_PIN);
+	Delayms(1);
+	TM_GPIO_SetPinHigh(SSD1306_RST_PORT, SSD1306_RST_PIN);
+#else
 	/* Init I2C */
 	TM_I2C_Init(SSD1306_I2C, SSD1306_I2C_PINSPACK, 400000);
 	
@@ -58,6 +101,7 @@ uint8_t TM_SSD1306_Init(void) {
 		/* Return false */
 		return 0;
 	}
+#endif
 	
 	/* A little delay */
 	Delayms(100);
@@ -65,7 +109,11 @@ uint8_t TM_SSD1306_Init(void) {
 	/* Init LCD */
 	SSD1306_WRITECOMMAND(0xAE); //display off
 	SSD1306_WRITECOMMAND(0x20); //Set Memory Addressing Mode   
+#if SSD1306_USE_SPI
+	SSD1306_WRITECOMMAND(0x00); //Horizontal Addressing Mode, changed pages are sent in one transfer
+#else
 	SSD1306_WRITECOMMAND(0x10); //00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
+#endif
 	SSD1306_WRITECOMMAND(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
 	SSD1306_WRITECOMMAND(0xC8); //Set COM Output Scan Direction
 	SSD1306_WRITECOMMAND(0x00); //---set low column address
@@ -110,16 +158,85 @@ uint8_t TM_SSD1306_Init(void) {
 }
 
 void TM_SSD1306_UpdateScreen(void) {
-	uint8_t m;
+#if SSD1306_USE_SPI
+	uint8_t m, first = 0xFF, last = 0;
+	
+	/* Get range of changed pages */
+	for (m = 0; m < SSD1306_PAGES; m++) {
+		if (SSD1306_DirtyStart[m] <= SSD1306_DirtyEnd[m]) {
+			if (first == 0xFF) {
+				first = m;
+			}
+			last = m;
+			
+			/* Page is clean */
+			SSD1306_DirtyStart[m] = 0xFF;
+			SSD1306_DirtyEnd[m] = 0;
+		}
+	}
+	
+	/* Nothing changed */
+	if (first == 0xFF) {
+		return;
+	}
 	
-	for (m = 0; m < 8; m++) {
-		SSD1306_WRITECOMMAND(0xB0 + m);
-		SSD1306_WRITECOMMAND(0x00);
-		SSD1306_WRITECOMMAND(0x10);
+	/* Set full width column range and changed pages, waits for previous transfer */
+	SSD1306_WRITECOMMAND(0x21);
+	SSD1306_WRITECOMMAND(0x00);
+	SSD1306_WRITECOMMAND(SSD1306_WIDTH - 1);
+	SSD1306_WRITECOMMAND(0x22);
+	SSD1306_WRITECOMMAND(first);
+	SSD1306_WRITECOMMAND(last);
+	
+	/* Send pages in one DMA transfer, chip select is released when done */
+	SSD1306_DC_HIGH;
+	SSD1306_CS_LOW;
+	SSD1306.Busy = 1;
+	TM_SPI_DMA_Send(SSD1306_SPI, &SSD1306_Buffer[SSD1306_WIDTH * first], SSD1306_WIDTH * (last - first + 1));
+#else
+	uint8_t m, start, end;
+	uint8_t cmd[3];
+	
+	for (m = 0; m < SSD1306_PAGES; m++) {
+		start = SSD1306_DirtyStart[m];
+		end = SSD1306_DirtyEnd[m];
+		
+		/* Nothing changed on this page */
+		if (start > end) {
+			continue;
+		}
 		
-		/* Write multi data */
-		TM_I2C_WriteMulti(SSD1306_I2C, SSD1306_I2C_ADDR, 0x40, &SSD1306_Buffer[SSD1306_WIDTH * m], SSD1306_WIDTH);
+		/* Set page and start column in one transaction */
+		cmd[0] = 0xB0 + m;
+		cmd[1] = 0x00 | (start & 0x0F);
+		cmd[2] = 0x10 | (start >> 4);
+		TM_I2C_WriteMulti(SSD1306_I2C, SSD1306_I2C_ADDR, 0x00, cmd, 3);
+		
+		/* Write changed columns only */
+		TM_I2C_WriteMulti(SSD1306_I2C, SSD1306_I2C_ADDR, 0x40, &SSD1306_Buffer[SSD1306_WIDTH * m + start], end - start + 1);
+		
+		/* Page is clean */
+		SSD1306_DirtyStart[m] = 0xFF;
+		SSD1306_DirtyEnd[m] = 0;
 	}
+#endif
+}
+
+void TM_SSD1306_UpdateScreenFull(void) {
+	/* Mark everything as changed */
+	SSD1306_SetDirtyAll();
+	
+	/* Update screen */
+	TM_SSD1306_UpdateScreen();
+}
+
+uint8_t TM_SSD1306_IsBusy(void) {
+#if SSD1306_USE_SPI
+	return SSD1306.Busy && TM_SPI_DMA_Transmitting(SSD1306_SPI);
+#else
+	/* I2C update is blocking */
+	return 0;
+#endif
 }
 
 void TM_SSD1306_ToggleInvert(void) {
@@ -132,14 +249,22 @@ void TM_SSD1306_ToggleInvert(void) {
 	for (i = 0; i < sizeof(SSD1306_Buffer); i++) {
 		SSD1306_Buffer[i] = ~SSD1306_Buffer[i];
 	}
+	
+	/* Everything changed */
+	SSD1306_SetDirtyAll();
 }
 
 void TM_SSD1306_Fill(SSD1306_COLOR_t color) {
 	/* Set memory */
 	memset(SSD1306_Buffer, (color == SSD1306_COLOR_BLACK) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
+	
+	/* Everything changed */
+	SSD1306_SetDirtyAll();
 }
 
 void TM_SSD1306_DrawPixel(uint16_t x, uint16_t y, SSD1306_COLOR_t color) {
+	uint8_t page;
+	
 	if (
 		x >= SSD1306_WIDTH ||
 		y >= SSD1306_HEIGHT
@@ -159,6 +284,15 @@ void TM_SSD1306_DrawPixel(uint16_t x, uint16_t y, SSD1306_COLOR_t color) {
 	} else {
 		SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
 	}
+	
+	/* Extend changed column range of this page */
+	page = y / 8;
+	if (x < SSD1306_DirtyStart[page]) {
+		SSD1306_DirtyStart[page] = x;
+	}
+	if (x > SSD1306_DirtyEnd[page]) {
+		SSD1306_DirtyEnd[page] = x;
+	}
 }
 
 void TM_SSD1306_GotoXY(uint16_t x, uint16_t y) {
@@ -168,21 +302,36 @@ void TM_SSD1306_GotoXY(uint16_t x, uint16_t y) {
 }
 
 char TM_SSD1306_Putc(char ch, TM_FONT_t* Font, SSD1306_COLOR_t color) {
+	TM_FONT_GLYPH_t Glyph;
 	uint32_t i, b, j;
 	
+	/* Get glyph, packed fonts can be proportional */
+	TM_FONT_GetGlyph(Font, ch, &Glyph);
+	
 	/* Check available space in LCD */
 	if (
-		SSD1306_WIDTH <= (SSD1306.CurrentX + Font->FontWidth) ||
+		SSD1306_WIDTH <= (SSD1306.CurrentX + Glyph.Width) ||
 		SSD1306_HEIGHT <= (SSD1306.CurrentY + Font->FontHeight)
 	) {
 		/* Error */
 		return 0;
 	}
 	
+	/* Glyph starts on page boundary, write column bytes directly */
+	if ((SSD1306.CurrentY & 0x07) == 0) {
+		SSD1306_PutGlyphPages(&Glyph, Font->FontHeight, color);
+		
+		/* Increase pointer */
+		SSD1306.CurrentX += Glyph.Width;
+		
+		/* Return character written */
+		return ch;
+	}
+	
 	/* Go through font */
 	for (i = 0; i < Font->FontHeight; i++) {
-		b = Font->data[(ch - 32) * Font->FontHeight + i];
-		for (j = 0; j < Font->FontWidth; j++) {
+		b = TM_FONT_GetRow(&Glyph, i);
+		for (j = 0; j < Glyph.Width; j++) {
 			if ((b << j) & 0x8000) {
 				TM_SSD1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR_t) color);
 			} else {
@@ -192,7 +341,7 @@ char TM_SSD1306_Putc(char ch, TM_FONT_t* Font, SSD1306_COLOR_t color) {
 	}
 	
 	/* Increase pointer */
-	SSD1306.CurrentX += Font->FontWidth;
+	SSD1306.CurrentX += Glyph.Width;
 	
 	/* Return character written */
 	return ch;
@@ -491,3 +640,95 @@ void SSD1306_OFF(void) {
 	SSD1306_WRITECOMMAND(0x10);
 	SSD1306_WRITECOMMAND(0xAE);  
 }
+
+/* Private functions */
+static void SSD1306_PutGlyphPages(const TM_FONT_GLYPH_t* Glyph, uint8_t height, SSD1306_COLOR_t color) {
+	uint16_t rows[8];
+	uint8_t* buff;
+	uint8_t i, j, r, n, page, mask, col, invert;
+	
+	/* Nothing to draw */
+	if (Glyph->Width == 0) {
+		return;
+	}
+	
+	/* Glyph rows have set pixels, invert for black text or inverted display */
+	invert = (color == SSD1306_COLOR_BLACK) ^ (SSD1306.Inverted != 0);
+	
+	/* Go through glyph, 8 rows for each page */
+	for (i = 0; i < height; i += 8) {
+		/* Last page can be partially used */
+		n = (height - i) > 8 ? 8 : (height - i);
+		mask = (uint8_t)((1 << n) - 1);
+		
+		/* Rows for this page */
+		for (r = 0; r < n; r++) {
+			rows[r] = TM_FONT_GetRow(Glyph, i + r);
+		}
+		
+		/* Transpose rows to column bytes, bit 0 is top row of page */
+		page = (SSD1306.CurrentY + i) / 8;
+		buff = &SSD1306_Buffer[page * SSD1306_WIDTH + SSD1306.CurrentX];
+		for (j = 0; j < Glyph->Width; j++) {
+			col = 0;
+			for (r = 0; r < n; r++) {
+				if (rows[r] & (0x8000 >> j)) {
+					col |= 1 << r;
+				}
+			}
+			if (invert) {
+				col = ~col;
+			}
+			
+			/* Rows of next glyph line below are kept */
+			buff[j] = (buff[j] & ~mask) | (col & mask);
+		}
+		
+		/* Extend changed column range of this page */
+		if (SSD1306.CurrentX < SSD1306_DirtyStart[page]) {
+			SSD1306_DirtyStart[page] = SSD1306.CurrentX;
+		}
+		if (SSD1306.CurrentX + Glyph->Width - 1 > SSD1306_DirtyEnd[page]) {
+			SSD1306_DirtyEnd[page] = SSD1306.CurrentX + Glyph->Width - 1;
+		}
+	}
+}
+
+static void SSD1306_SetDirtyAll(void) {
+	uint8_t m;
+	
+	/* All columns on all pages */
+	for (m = 0; m < SSD1306_PAGES; m++) {
+		SSD1306_DirtyStart[m] = 0;
+		SSD1306_DirtyEnd[m] = SSD1306_WIDTH - 1;
+	}
+}
+
+#if SSD1306_USE_SPI
+static void SSD1306_SPI_WriteCommand(uint8_t command) {
+	/* Wait for screen update */
+	SSD1306_SPI_Wait();
+	
+	/* Send command */
+	SSD1306_DC_LOW;
+	SSD1306_CS_LOW;
+	TM_SPI_Send(SSD1306_SPI, command);
+	SSD1306_CS_HIGH;
+}
+
+static void SSD1306_SPI_Wait(void) {
+	/* Nothing to wait */
+	if (!SSD1306.Busy) {
+		return;
+	}
+	
+	/* Wait for DMA and SPI */
+	while (TM_SPI_DMA_Transmitting(SSD1306_SPI));
+	SSD1306_CS_HIGH;
+	SSD1306.Busy = 0;
+	
+	/* Received data are not used, clear RX and overrun flags */
+	(void)SSD1306_SPI->DR;
+	(void)SSD1306_SPI->SR;
+}
+#endif
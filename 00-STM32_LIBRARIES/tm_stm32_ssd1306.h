@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.4
  * @ide     Keil uVision
  * @license MIT
  * @brief   Library for 128x64 SSD1306 I2C LCD
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_SSD1306_H
-#define TM_SSD1306_H 100
+#define TM_SSD1306_H 140
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -49,15 +49,24 @@ extern "C" {
 
 /**
  * @defgroup TM_SSD1306
- * @brief    Library for 128x64 SSD1306 I2C LCD
+ * @brief    Library for 128x64 SSD1306 I2C or SPI LCD
  * @{
  *
- * This SSD1306 LCD uses I2C for communication
+ * This SSD1306 LCD uses I2C or SPI for communication
  *
  * Library features functions for drawing lines, rectangles and circles.
  *
  * It also allows you to draw texts and characters using appropriate functions provided in library.
  *
+ * \par Partial screen update
+ *
+ * Library tracks changed columns on each page (8 rows) of internal RAM.
+ * @ref TM_SSD1306_UpdateScreen() sends only changed part of each page to LCD,
+ * so updating one character takes only a few bytes on I2C instead of entire 1kB buffer.
+ * In SPI mode, full width of changed pages is sent.
+ *
+ * Use @ref TM_SSD1306_UpdateScreenFull() if LCD RAM content was lost, for example after @ref SSD1306_OFF().
+ *
  * \par Default pinout
  *
 \verbatim
@@ -67,6 +76,28 @@ VCC        |3.3V         |
 GND        |GND          |
 SCL        |PA8          |Serial clock line
 SDA        |PC9          |Serial data line
+\endverbatim
+ *
+ * \par SPI mode
+ *
+ * Set @ref SSD1306_USE_SPI to 1 in defines.h file to use panel in 4-wire SPI mode.
+ * LCD is then set to horizontal addressing mode and @ref TM_SSD1306_UpdateScreen() sends all changed pages
+ * in one @ref TM_SPI_DMA_Send transfer and returns immediately. Entire 1kB screen takes less than 1ms at 10MHz.
+ *
+ * Next command or update waits for previous transfer to finish. Use @ref TM_SSD1306_IsBusy() to check transfer status.
+ *
+ * \note  Changes made to buffer during transfer may be sent in the same transfer and are sent again on next update
+ *
+\verbatim
+SSD1306    |STM32Fxxx    |DESCRIPTION
+
+VCC        |3.3V         |
+GND        |GND          |
+D0         |PA5          |SPI1 clock
+D1         |PA7          |SPI1 MOSI
+CS         |PA4          |Chip select
+DC         |PA3          |Data/command select
+RES        |PA2          |Reset pin
 \endverbatim
  *
  * \par Select custom I2C settings
@@ -84,6 +115,20 @@ SDA        |PC9          |Serial data line
 //Select custom width and height if your LCD differs in size
 #define SSD1306_WIDTH            128
 #define SSD1306_HEIGHT           64
+
+//Use SPI instead of I2C
+#define SSD1306_USE_SPI          1
+
+//Select custom SPI and pins, SPI DMA must be available for SPI
+#define SSD1306_SPI              SPI1
+#define SSD1306_SPI_PINSPACK     TM_SPI_PinsPack_1
+#define SSD1306_SPI_PRESCALER    SPI_BAUDRATEPRESCALER_8
+#define SSD1306_CS_PORT          GPIOA
+#define SSD1306_CS_PIN           GPIO_PIN_4
+#define SSD1306_DC_PORT          GPIOA
+#define SSD1306_DC_PIN           GPIO_PIN_3
+#define SSD1306_RST_PORT         GPIOA
+#define SSD1306_RST_PIN          GPIO_PIN_2
 \endcode
  *
  * \par Changelog
@@ -91,6 +136,25 @@ SDA        |PC9          |Serial data line
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - TM_SSD1306_UpdateScreen sends only changed columns of changed pages
+  - Page and column address commands sent in single I2C transaction
+  - Added TM_SSD1306_UpdateScreenFull function
+  
+ Version 1.2
+  - October 14, 2026
+  - Packed proportional fonts are drawn with own width of each glyph
+  
+ Version 1.3
+  - October 14, 2026
+  - Added SPI mode with DMA screen update
+  - Added TM_SSD1306_IsBusy function
+  
+ Version 1.4
+  - October 14, 2026
+  - Text at Y position multiple of 8 is written to buffer one column byte at a time instead of pixel by pixel
 \endverbatim
  *
  * \par Dependencies
@@ -99,6 +163,7 @@ SDA        |PC9          |Serial data line
  - STM32Fxxx HAL
  - defines.h
  - TM I2C
+ - TM SPI, TM SPI DMA and TM GPIO in SPI mode
  - TM FONTS
  - TM DELAY
  - string.h
@@ -108,10 +173,22 @@ SDA        |PC9          |Serial data line
 
 #include "stm32fxxx_hal.h"
 #include "defines.h"
-#include "tm_stm32_i2c.h"
 #include "tm_stm32_fonts.h"
 #include "tm_stm32_delay.h"
 
+/* Use SPI instead of I2C */
+#ifndef SSD1306_USE_SPI
+#define SSD1306_USE_SPI          0
+#endif
+
+#if SSD1306_USE_SPI
+#include "tm_stm32_gpio.h"
+#include "tm_stm32_spi.h"
+#include "tm_stm32_spi_dma.h"
+#else
+#include "tm_stm32_i2c.h"
+#endif
+
 #include "stdlib.h"
 #include "string.h"
 
@@ -134,6 +211,31 @@ SDA        |PC9          |Serial data line
 //#define SSD1306_I2C_ADDR       0x7A
 #endif
 
+/* SPI settings */
+#ifndef SSD1306_SPI
+#define SSD1306_SPI              SPI1
+#define SSD1306_SPI_PINSPACK     TM_SPI_PinsPack_1
+#endif
+
+/* SPI prescaler, SSD1306 clock cycle is min 100ns */
+#ifndef SSD1306_SPI_PRESCALER
+#define SSD1306_SPI_PRESCALER    SPI_BAUDRATEPRESCALER_8
+#endif
+
+/* SPI control pins */
+#ifndef SSD1306_CS_PORT
+#define SSD1306_CS_PORT          GPIOA
+#define SSD1306_CS_PIN           GPIO_PIN_4
+#endif
+#ifndef SSD1306_DC_PORT
+#define SSD1306_DC_PORT          GPIOA
+#define SSD1306_DC_PIN           GPIO_PIN_3
+#endif
+#ifndef SSD1306_RST_PORT
+#define SSD1306_RST_PORT         GPIOA
+#define SSD1306_RST_PIN          GPIO_PIN_2
+#endif
+
 /* SSD1306 settings */
 /* SSD1306 width in pixels */
 #ifndef SSD1306_WIDTH
@@ -178,17 +280,36 @@ typedef enum {
  * @retval Initialization status:
  *           - 0: LCD was not detected on I2C port
  *           - > 0: LCD initialized OK and ready to use
+ * @note   LCD can not be detected in SPI mode, function always succeeds
  */
 uint8_t TM_SSD1306_Init(void);
 
 /** 
  * @brief  Updates buffer from internal RAM to LCD
  * @note   This function must be called each time you do some changes to LCD, to update buffer from RAM to LCD
+ * @note   Only areas changed since last update are sent to LCD
  * @param  None
  * @retval None
  */
 void TM_SSD1306_UpdateScreen(void);
 
+/** 
+ * @brief  Updates entire buffer from internal RAM to LCD, regardless of changes
+ * @param  None
+ * @retval None
+ */
+void TM_SSD1306_UpdateScreenFull(void);
+
+/**
+ * @brief  Checks if screen update is in progress
+ * @note   Screen update runs in background only in SPI mode
+ * @param  None
+ * @retval Transfer status:
+ *            - 0: LCD is idle
+ *            - > 0: Screen update is in progress
+ */
+uint8_t TM_SSD1306_IsBusy(void);
+
 /**
  * @brief  Toggles pixels invertion inside internal RAM
  * @note   @ref TM_SSD1306_UpdateScreen() must be called after that in order to see updated LCD screen
@@ -225,6 +346,7 @@ void TM_SSD1306_GotoXY(uint16_t x, uint16_t y);
 
 /**
  * @brief  Puts character to internal RAM
+ * @note   When Y position is multiple of 8, glyph is written directly as column bytes of display pages, which is much faster
  * @note   @ref TM_SSD1306_UpdateScreen() must be called after that in order to see updated LCD screen
  * @param  ch: Character to be written
  * @param  *Font: Pointer to @ref TM_FONT_t structure with used font
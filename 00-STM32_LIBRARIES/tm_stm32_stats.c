@@ -0,0 +1,123 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_stats.h"
+
+/* Registered blocks */
+static TM_STATS_t* STATS_First = NULL;
+
+void TM_STATS_Register(TM_STATS_t* Stats, const char* Name) {
+	TM_STATS_t* s;
+	uint32_t irq;
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Set name */
+	Stats->Name = Name;
+	
+	/* Check if already registered */
+	for (s = STATS_First; s != NULL; s = s->Next) {
+		if (s == Stats) {
+			break;
+		}
+	}
+	
+	/* Add to the beginning of list */
+	if (s == NULL) {
+		Stats->Next = STATS_First;
+		STATS_First = Stats;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+TM_STATS_t* TM_STATS_GetFirst(void) {
+	return STATS_First;
+}
+
+TM_STATS_t* TM_STATS_Find(const char* Name) {
+	TM_STATS_t* s;
+	
+	/* Compare names */
+	for (s = STATS_First; s != NULL; s = s->Next) {
+		if (strcmp(s->Name, Name) == 0) {
+			return s;
+		}
+	}
+	
+	/* Not found */
+	return NULL;
+}
+
+void TM_STATS_Reset(void) {
+	TM_STATS_t* s;
+	uint32_t irq;
+	
+	for (s = STATS_First; s != NULL; s = s->Next) {
+		/* Disable interrupts */
+		irq = TM_NVIC_Lock();
+		
+		/* Clear counters, keep name and link */
+		s->RxBytes = 0;
+		s->TxBytes = 0;
+		s->Transfers = 0;
+		s->Errors = 0;
+		s->Timeouts = 0;
+		s->Dropped = 0;
+		s->MaxLatency = 0;
+		s->HighWater = 0;
+		
+		/* Enable interrupts back */
+		TM_NVIC_Unlock(irq);
+	}
+}
+
+void TM_STATS_Dump(void (*OutputFunc)(char *)) {
+	TM_STATS_t* s;
+	TM_STATS_t copy;
+	char str[112];
+	uint32_t irq;
+	
+	/* Header */
+	OutputFunc("Name          RxBytes    TxBytes  Transfers   Errors Timeouts  Dropped  Latency HighWater\n");
+	
+	for (s = STATS_First; s != NULL; s = s->Next) {
+		/* Get consistent copy of counters */
+		irq = TM_NVIC_Lock();
+		copy = *s;
+		TM_NVIC_Unlock(irq);
+		
+		/* Output counters */
+		sprintf(str, "%-10.10s %10lu %10lu %10lu %8lu %8lu %8lu %8lu %9lu\n",
+			copy.Name,
+			(unsigned long)copy.RxBytes, (unsigned long)copy.TxBytes, (unsigned long)copy.Transfers,
+			(unsigned long)copy.Errors, (unsigned long)copy.Timeouts, (unsigned long)copy.Dropped,
+			(unsigned long)copy.MaxLatency, (unsigned long)copy.HighWater
+		);
+		OutputFunc(str);
+	}
+}
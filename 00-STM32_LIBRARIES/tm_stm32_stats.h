@@ -0,0 +1,299 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.1
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Runtime statistics counters registry for STM32Fxxx drivers
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_STATS_H
+#define TM_STATS_H 110
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_STATS
+ * @brief    Runtime statistics counters registry for STM32Fxxx drivers
+ * @{
+ *
+ * Each driver instance has its own @ref TM_STATS_t block with counters for bytes, transfers, errors,
+ * timeouts, dropped data, maximal latency and buffer high-water mark.
+ * Blocks are registered in one list, which can be printed or sent over CDC or Ethernet.
+ *
+ * Statistics are disabled by default. When @ref STATS_ENABLED is 0, all macros are empty and drivers have no extra code or RAM.
+ * When enabled, each event costs one increment.
+ *
+ * \par Drivers with statistics
+ *
+ *  - TM USART: RxBytes, TxBytes, Transfers (send calls), Errors (overrun, framing, noise and parity), Dropped (RX buffer full), HighWater (RX buffer)
+ *  - TM SPI: RxBytes, TxBytes, Transfers
+ *  - TM I2C: RxBytes, TxBytes, Transfers, Errors (all failed transfers), Timeouts, Dropped (queue full), HighWater (queue)
+ *  - FatFs diskio: RxBytes, TxBytes, Transfers, Errors, MaxLatency for each physical drive
+ *
+ * \par Time base
+ *
+ * Latency is measured with @ref STATS_GET_TIME, which is HAL tick in milliseconds by default.
+ * It can be changed to DWT cycle counter for better resolution.
+ *
+\code
+//Enable statistics in defines.h
+#define STATS_ENABLED     1
+//Use cycle counter for latency, DWT must be enabled with TM_GENERAL_DWTCounterEnable
+#define STATS_GET_TIME()  (DWT->CYCCNT)
+
+//Print all registered blocks
+void USART_Output(char* str) {
+	TM_USART_Puts(USART1, str);
+}
+
+TM_STATS_Dump(USART_Output);
+
+//Go through all blocks
+TM_STATS_t* s;
+for (s = TM_STATS_GetFirst(); s != NULL; s = s->Next) {
+	//Send s->Name, s->Errors, ...
+}
+\endcode
+ *
+ * \par Custom drivers
+ *
+\code
+static TM_STATS_t MyStats;
+
+void MyDriver_Init(void) {
+	TM_STATS_REGISTER(&MyStats, "MYDRV");
+}
+
+void MyDriver_Send(uint8_t* data, uint16_t count) {
+	TM_STATS_INC(&MyStats, Transfers);
+	TM_STATS_ADD(&MyStats, TxBytes, count);
+}
+\endcode
+ *
+ * @note   Counters are not protected. If the same counter is changed from interrupt and from main code at the same time,
+ *         one change can be lost. Drivers update each counter from one context only.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - stdio.h
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "stdio.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_STATS_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Statistics enable, disabled by default
+ */
+#ifndef STATS_ENABLED
+#define STATS_ENABLED             0
+#endif
+
+/**
+ * @brief  Time base for latency measurements, milliseconds by default
+ */
+#ifndef STATS_GET_TIME
+#define STATS_GET_TIME()          HAL_GetTick()
+#endif
+
+#if STATS_ENABLED || defined(DOXYGEN)
+/**
+ * @brief  Registers statistics block and sets its name
+ * @param  s: Pointer to @ref TM_STATS_t structure
+ * @param  name: Block name, string literal
+ * @retval None
+ */
+#define TM_STATS_REGISTER(s, name)    TM_STATS_Register((s), (name))
+
+/**
+ * @brief  Increases counter by 1
+ * @param  s: Pointer to @ref TM_STATS_t structure
+ * @param  field: Counter name, for example Errors
+ * @retval None
+ */
+#define TM_STATS_INC(s, field)        ((s)->field++)
+
+/**
+ * @brief  Increases counter by value
+ * @param  s: Pointer to @ref TM_STATS_t structure
+ * @param  field: Counter name, for example TxBytes
+ * @param  n: Value to add
+ * @retval None
+ */
+#define TM_STATS_ADD(s, field, n)     ((s)->field += (n))
+
+/**
+ * @brief  Saves value to counter if it is bigger than current
+ * @note   Value is evaluated twice
+ * @param  s: Pointer to @ref TM_STATS_t structure
+ * @param  field: Counter name, for example HighWater
+ * @param  v: New value
+ * @retval None
+ */
+#define TM_STATS_MAX(s, field, v)     do { if ((uint32_t)(v) > (s)->field) { (s)->field = (uint32_t)(v); } } while (0)
+
+/**
+ * @brief  Gets current time for latency measurement
+ * @param  None
+ * @retval Current time in @ref STATS_GET_TIME units
+ */
+#define TM_STATS_TIME()               STATS_GET_TIME()
+#else
+#define TM_STATS_REGISTER(s, name)    ((void)0)
+#define TM_STATS_INC(s, field)        ((void)0)
+#define TM_STATS_ADD(s, field, n)     ((void)0)
+#define TM_STATS_MAX(s, field, v)     ((void)0)
+#define TM_STATS_TIME()               0
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_STATS_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Statistics block for one driver instance
+ */
+typedef struct _TM_STATS_t {
+	const char* Name;                /*!< Instance name, for example USART2 */
+	uint32_t RxBytes;                /*!< Number of received bytes */
+	uint32_t TxBytes;                /*!< Number of transmitted bytes */
+	uint32_t Transfers;              /*!< Number of transfers */
+	uint32_t Errors;                 /*!< Number of errors */
+	uint32_t Timeouts;               /*!< Number of timeouts */
+	uint32_t Dropped;                /*!< Number of dropped bytes or transfers, buffer or queue was full */
+	uint32_t MaxLatency;             /*!< Maximal time of one transfer in @ref STATS_GET_TIME units */
+	uint32_t HighWater;              /*!< Maximal number of elements in buffer or queue */
+	struct _TM_STATS_t* Next;        /*!< Next block in registry, used by library */
+} TM_STATS_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_STATS_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Registers statistics block, block is added only once
+ * @note   Use @ref TM_STATS_REGISTER macro in drivers, so call is removed when statistics are disabled
+ * @param  *Stats: Pointer to @ref TM_STATS_t structure
+ * @param  *Name: Block name
+ * @retval None
+ */
+void TM_STATS_Register(TM_STATS_t* Stats, const char* Name);
+
+/**
+ * @brief  Gets first registered block, others are linked with Next member
+ * @param  None
+ * @retval Pointer to @ref TM_STATS_t structure or NULL if no block is registered
+ */
+TM_STATS_t* TM_STATS_GetFirst(void);
+
+/**
+ * @brief  Finds registered block by name
+ * @param  *Name: Block name
+ * @retval Pointer to @ref TM_STATS_t structure or NULL if block does not exist
+ */
+TM_STATS_t* TM_STATS_Find(const char* Name);
+
+/**
+ * @brief  Clears counters of all registered blocks
+ * @param  None
+ * @retval None
+ */
+void TM_STATS_Reset(void);
+
+/**
+ * @brief  Prints counters of all registered blocks
+ * @param  *OutputFunc: Pointer to function which outputs string
+ * @retval None
+ */
+void TM_STATS_Dump(void (*OutputFunc)(char *));
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
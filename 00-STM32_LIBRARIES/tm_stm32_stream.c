@@ -0,0 +1,333 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_stream.h"
+
+/* Private functions */
+static uint8_t TM_STREAM_INT_Drain(TM_STREAM_t* Stream);
+static uint32_t TM_STREAM_INT_Buffer(TM_STREAM_t* Stream, const uint8_t* data, uint32_t size);
+static uint32_t TM_STREAM_INT_TeeWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+static uint8_t TM_STREAM_INT_TeeFlush(TM_STREAM_t* Stream);
+static uint32_t TM_STREAM_INT_MemoryWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+
+/* Outputs */
+static const TM_STREAM_Ops_t STREAM_Tee = {TM_STREAM_INT_TeeWrite, TM_STREAM_INT_TeeFlush};
+static const TM_STREAM_Ops_t STREAM_Memory = {TM_STREAM_INT_MemoryWrite, NULL};
+
+#if STREAM_USE_USART
+static uint32_t TM_STREAM_INT_USARTWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+static const TM_STREAM_Ops_t STREAM_USART = {TM_STREAM_INT_USARTWrite, NULL};
+#endif
+#if STREAM_USE_CDC
+static uint32_t TM_STREAM_INT_CDCWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+static const TM_STREAM_Ops_t STREAM_CDC = {TM_STREAM_INT_CDCWrite, NULL};
+#endif
+#if STREAM_USE_FATFS
+static uint32_t TM_STREAM_INT_FatFsWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+static uint8_t TM_STREAM_INT_FatFsFlush(TM_STREAM_t* Stream);
+static const TM_STREAM_Ops_t STREAM_FatFs = {TM_STREAM_INT_FatFsWrite, TM_STREAM_INT_FatFsFlush};
+#endif
+
+void TM_STREAM_Init(TM_STREAM_t* Stream, const TM_STREAM_Ops_t* Ops, void* Handle, uint32_t Param) {
+	/* Fill structure */
+	Stream->Ops = Ops;
+	Stream->Handle = Handle;
+	Stream->Param = Param;
+	Stream->Buffer = NULL;
+	Stream->Written = 0;
+	Stream->Dropped = 0;
+}
+
+void TM_STREAM_InitMemory(TM_STREAM_t* Stream, TM_BUFFER_t* Buffer) {
+	TM_STREAM_Init(Stream, &STREAM_Memory, Buffer, 0);
+}
+
+void TM_STREAM_InitTee(TM_STREAM_t* Stream, TM_STREAM_t** Streams, uint8_t count) {
+	TM_STREAM_Init(Stream, &STREAM_Tee, Streams, count);
+}
+
+#if STREAM_USE_USART
+void TM_STREAM_InitUSART(TM_STREAM_t* Stream, USART_TypeDef* USARTx) {
+	TM_STREAM_Init(Stream, &STREAM_USART, USARTx, 0);
+}
+#endif
+
+#if STREAM_USE_CDC
+void TM_STREAM_InitCDC(TM_STREAM_t* Stream, TM_USB_t USB_Mode) {
+	TM_STREAM_Init(Stream, &STREAM_CDC, NULL, (uint32_t)USB_Mode);
+}
+#endif
+
+#if STREAM_USE_FATFS
+void TM_STREAM_InitFatFs(TM_STREAM_t* Stream, FIL* fil) {
+	TM_STREAM_Init(Stream, &STREAM_FatFs, fil, 0);
+}
+#endif
+
+void TM_STREAM_SetBuffer(TM_STREAM_t* Stream, TM_BUFFER_t* Buffer) {
+	/* Write old buffered data */
+	if (Stream->Buffer != NULL) {
+		TM_STREAM_INT_Drain(Stream);
+	}
+	
+	/* Set new buffer */
+	Stream->Buffer = Buffer;
+}
+
+uint32_t TM_STREAM_WriteV(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	uint32_t total = 0, written = 0, n;
+	uint8_t i;
+	
+	/* Get number of bytes */
+	for (i = 0; i < count; i++) {
+		total += Vectors[i].Size;
+	}
+	
+	/* Unbuffered stream, output gets all parts at once */
+	if (Stream->Buffer == NULL) {
+		written = Stream->Ops->Write(Stream, Vectors, count);
+		Stream->Written += written;
+		Stream->Dropped += total - written;
+		return written;
+	}
+	
+	/* Copy parts to buffer */
+	for (i = 0; i < count; i++) {
+		n = TM_STREAM_INT_Buffer(Stream, Vectors[i].Data, Vectors[i].Size);
+		written += n;
+		if (n < Vectors[i].Size) {
+			break;
+		}
+	}
+	
+	/* Count data which did not fit */
+	Stream->Dropped += total - written;
+	
+	/* Return number of bytes written */
+	return written;
+}
+
+uint32_t TM_STREAM_Write(TM_STREAM_t* Stream, const void* Data, uint32_t count) {
+	TM_STREAM_Vector_t v;
+	
+	/* Write as one part */
+	v.Data = Data;
+	v.Size = count;
+	return TM_STREAM_WriteV(Stream, &v, 1);
+}
+
+uint32_t TM_STREAM_Puts(TM_STREAM_t* Stream, const char* str) {
+	return TM_STREAM_Write(Stream, str, strlen(str));
+}
+
+uint8_t TM_STREAM_Flush(TM_STREAM_t* Stream) {
+	uint8_t result = 0;
+	
+	/* Write buffered data */
+	if (Stream->Buffer != NULL) {
+		result = TM_STREAM_INT_Drain(Stream);
+	}
+	
+	/* Flush output */
+	if (Stream->Ops->Flush != NULL && Stream->Ops->Flush(Stream)) {
+		result = 1;
+	}
+	
+	/* Return status */
+	return result;
+}
+
+/* Private functions */
+static uint8_t TM_STREAM_INT_Drain(TM_STREAM_t* Stream) {
+	TM_STREAM_Vector_t v;
+	uint8_t* ptr;
+	uint32_t n;
+	
+	/* Write contiguous parts of buffer memory */
+	while ((v.Size = TM_BUFFER_GetReadSpan(Stream->Buffer, &ptr)) > 0) {
+		v.Data = ptr;
+		n = Stream->Ops->Write(Stream, &v, 1);
+		TM_BUFFER_CommitRead(Stream->Buffer, n);
+		Stream->Written += n;
+		
+		/* Output did not accept all */
+		if (n < v.Size) {
+			return 1;
+		}
+	}
+	
+	/* All data written */
+	return 0;
+}
+
+static uint32_t TM_STREAM_INT_Buffer(TM_STREAM_t* Stream, const uint8_t* data, uint32_t size) {
+	TM_STREAM_Vector_t v;
+	uint32_t written = 0, n;
+	
+	while (size) {
+		/* Big part and empty buffer, output gets it directly */
+		if (size >= Stream->Buffer->Size && TM_BUFFER_GetFull(Stream->Buffer) == 0) {
+			v.Data = data;
+			v.Size = size;
+			n = Stream->Ops->Write(Stream, &v, 1);
+			Stream->Written += n;
+			return written + n;
+		}
+		
+		/* Copy to buffer */
+		n = TM_BUFFER_Write(Stream->Buffer, (uint8_t *)data, size);
+		data += n;
+		size -= n;
+		written += n;
+		
+		/* Buffer is full, write it to output */
+		if (size && TM_STREAM_INT_Drain(Stream)) {
+			break;
+		}
+	}
+	
+	/* Return number of bytes accepted */
+	return written;
+}
+
+static uint32_t TM_STREAM_INT_TeeWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	TM_STREAM_t** streams = (TM_STREAM_t **)Stream->Handle;
+	uint32_t written = 0xFFFFFFFF, n;
+	uint8_t i;
+	
+	/* Write the same parts to all streams */
+	for (i = 0; i < Stream->Param; i++) {
+		n = TM_STREAM_WriteV(streams[i], Vectors, count);
+		if (n < written) {
+			written = n;
+		}
+	}
+	
+	/* Return smallest number of bytes written */
+	return Stream->Param ? written : 0;
+}
+
+static uint8_t TM_STREAM_INT_TeeFlush(TM_STREAM_t* Stream) {
+	TM_STREAM_t** streams = (TM_STREAM_t **)Stream->Handle;
+	uint8_t i, result = 0;
+	
+	/* Flush all streams */
+	for (i = 0; i < Stream->Param; i++) {
+		result |= TM_STREAM_Flush(streams[i]);
+	}
+	
+	/* Return status */
+	return result;
+}
+
+static uint32_t TM_STREAM_INT_MemoryWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	uint32_t written = 0, n;
+	uint8_t i;
+	
+	/* Copy parts until buffer is full */
+	for (i = 0; i < count; i++) {
+		n = TM_BUFFER_Write((TM_BUFFER_t *)Stream->Handle, (uint8_t *)Vectors[i].Data, Vectors[i].Size);
+		written += n;
+		if (n < Vectors[i].Size) {
+			break;
+		}
+	}
+	
+	/* Return number of bytes written */
+	return written;
+}
+
+#if STREAM_USE_USART
+static uint32_t TM_STREAM_INT_USARTWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	const uint8_t* data;
+	uint32_t written = 0, size, n;
+	uint8_t i;
+	
+	/* Send parts, in blocks allowed by USART library */
+	for (i = 0; i < count; i++) {
+		data = Vectors[i].Data;
+		for (size = Vectors[i].Size; size; size -= n) {
+			n = size > 0xFFFF ? 0xFFFF : size;
+			TM_USART_Send((USART_TypeDef *)Stream->Handle, (uint8_t *)data, n);
+			data += n;
+			written += n;
+		}
+	}
+	
+	/* Return number of bytes written */
+	return written;
+}
+#endif
+
+#if STREAM_USE_CDC
+static uint32_t TM_STREAM_INT_CDCWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	const uint8_t* data;
+	uint32_t written = 0, size, n, w;
+	uint8_t i;
+	
+	/* Copy parts to CDC buffer until it is full */
+	for (i = 0; i < count; i++) {
+		data = Vectors[i].Data;
+		for (size = Vectors[i].Size; size; size -= n) {
+			n = size > 0xFFFF ? 0xFFFF : size;
+			w = TM_USBD_CDC_PutArray((TM_USB_t)Stream->Param, (uint8_t *)data, n);
+			data += w;
+			written += w;
+			if (w < n) {
+				return written;
+			}
+		}
+	}
+	
+	/* Return number of bytes written */
+	return written;
+}
+#endif
+
+#if STREAM_USE_FATFS
+static uint32_t TM_STREAM_INT_FatFsWrite(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count) {
+	uint32_t written = 0;
+	uint8_t i;
+	UINT bw;
+	
+	/* Write parts to file until error or disk full */
+	for (i = 0; i < count; i++) {
+		if (f_write((FIL *)Stream->Handle, Vectors[i].Data, Vectors[i].Size, &bw) != FR_OK) {
+			break;
+		}
+		written += bw;
+		if (bw < Vectors[i].Size) {
+			break;
+		}
+	}
+	
+	/* Return number of bytes written */
+	return written;
+}
+
+static uint8_t TM_STREAM_INT_FatFsFlush(TM_STREAM_t* Stream) {
+	return f_sync((FIL *)Stream->Handle) != FR_OK;
+}
+#endif
@@ -0,0 +1,347 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Buffered output streams with gather writes for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_STREAM_H
+#define TM_STREAM_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_STREAM
+ * @brief    Buffered output streams with gather writes for STM32Fxxx
+ * @{
+ *
+ * Library gives one write API for different outputs: USART, USB CDC, FatFs file, @ref TM_BUFFER_t or user output.
+ * Each output is @ref TM_STREAM_t structure with pointer to @ref TM_STREAM_Ops_t functions table,
+ * so code which formats data does not know where data go.
+ *
+ * \par Gather writes
+ *
+ * Record can be made of more parts in different memory (header, formatted value, constant string)
+ * and written with one @ref TM_STREAM_WriteV call, without copying parts to temporary memory first.
+ *
+ * \par Buffered streams
+ *
+ * Stream can own @ref TM_BUFFER_t set with @ref TM_STREAM_SetBuffer. Small writes are collected in buffer
+ * and output gets them in big blocks when buffer is full or on @ref TM_STREAM_Flush.
+ * This helps for FatFs, where each write call has big overhead, buffer size multiple of 512 bytes is the best.
+ * Writes bigger than empty buffer go directly to output.
+ *
+ * \par Tee
+ *
+ * Tee stream writes the same parts to more streams. Parts are passed by reference, so unbuffered outputs
+ * get data from original memory and buffered ones copy it once to own buffer.
+ *
+\code
+TM_STREAM_t Serial, Log, Tee;
+TM_STREAM_t* Outputs[] = {&Serial, &Log};
+TM_STREAM_Vector_t Record[3];
+uint8_t FileBuffer[2048];
+TM_BUFFER_t Buffer;
+char value[12];
+
+//Outputs
+TM_STREAM_InitUSART(&Serial, USART1);
+TM_STREAM_InitFatFs(&Log, &fil);
+TM_BUFFER_Init(&Buffer, sizeof(FileBuffer), FileBuffer);
+TM_STREAM_SetBuffer(&Log, &Buffer);
+TM_STREAM_InitTee(&Tee, Outputs, 2);
+
+//One record to both outputs
+Record[0].Data = "T=";
+Record[0].Size = 2;
+Record[1].Data = value;
+Record[1].Size = TM_FMT_Fixed(value, temperature, 2);
+Record[2].Data = "\r\n";
+Record[2].Size = 2;
+TM_STREAM_WriteV(&Tee, Record, 3);
+
+//Write buffered data to file
+TM_STREAM_Flush(&Tee);
+\endcode
+ *
+ * \par Outputs
+ *
+ * USART, USB CDC and FatFs outputs must be enabled in defines.h file, because they need these libraries:
+ *
+\code
+//Enable outputs
+#define STREAM_USE_USART     1
+#define STREAM_USE_CDC       1
+#define STREAM_USE_FATFS     1
+\endcode
+ *
+ * User output is made with own @ref TM_STREAM_Ops_t table and @ref TM_STREAM_Init.
+ *
+ * @note  Streams are not reentrant, do not write to the same stream from interrupts and main loop
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - TM USART when STREAM_USE_USART is enabled
+ - TM USB DEVICE CDC when STREAM_USE_CDC is enabled
+ - TM FATFS when STREAM_USE_FATFS is enabled
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_buffer.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_STREAM_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* USART output support */
+#ifndef STREAM_USE_USART
+#define STREAM_USE_USART     0
+#endif
+
+/* USB CDC output support */
+#ifndef STREAM_USE_CDC
+#define STREAM_USE_CDC       0
+#endif
+
+/* FatFs file output support */
+#ifndef STREAM_USE_FATFS
+#define STREAM_USE_FATFS     0
+#endif
+
+#if STREAM_USE_USART
+#include "tm_stm32_usart.h"
+#endif
+#if STREAM_USE_CDC
+#include "tm_stm32_usb_device_cdc.h"
+#endif
+#if STREAM_USE_FATFS
+#include "tm_stm32_fatfs.h"
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_STREAM_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  One part of data for gather write
+ */
+typedef struct {
+	const void* Data; /*!< Pointer to data */
+	uint32_t Size;    /*!< Number of bytes */
+} TM_STREAM_Vector_t;
+
+/* Forward declaration */
+struct _TM_STREAM_t;
+
+/**
+ * @brief  Output functions table
+ */
+typedef struct {
+	uint32_t (*Write)(struct _TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count); /*!< Writes all parts to output, returns number of bytes written */
+	uint8_t (*Flush)(struct _TM_STREAM_t* Stream);                                                   /*!< Flushes output, returns 0 on success. Can be NULL */
+} TM_STREAM_Ops_t;
+
+/**
+ * @brief  Stream structure
+ */
+typedef struct _TM_STREAM_t {
+	const TM_STREAM_Ops_t* Ops; /*!< Pointer to output functions */
+	void* Handle;               /*!< Output handle, for example USART or file pointer */
+	uint32_t Param;             /*!< Output parameter, for example USB mode or number of tee streams */
+	TM_BUFFER_t* Buffer;        /*!< Pointer to stream buffer or NULL for unbuffered stream */
+	uint32_t Written;           /*!< Number of bytes given to output */
+	uint32_t Dropped;           /*!< Number of bytes which output did not accept */
+} TM_STREAM_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_STREAM_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes stream with user output
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure
+ * @param  *Ops: Pointer to output functions table, must stay valid
+ * @param  *Handle: Output handle, saved to @ref TM_STREAM_t.Handle
+ * @param  Param: Output parameter, saved to @ref TM_STREAM_t.Param
+ * @retval None
+ */
+void TM_STREAM_Init(TM_STREAM_t* Stream, const TM_STREAM_Ops_t* Ops, void* Handle, uint32_t Param);
+
+/**
+ * @brief  Initializes stream which writes to @ref TM_BUFFER_t
+ * @note   Data which do not fit to buffer are dropped
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure to write to
+ * @retval None
+ */
+void TM_STREAM_InitMemory(TM_STREAM_t* Stream, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Initializes tee stream, which writes to more streams
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure
+ * @param  **Streams: Array of pointers to streams, must stay valid
+ * @param  count: Number of streams in array
+ * @retval None
+ */
+void TM_STREAM_InitTee(TM_STREAM_t* Stream, TM_STREAM_t** Streams, uint8_t count);
+
+#if STREAM_USE_USART || defined(DOXYGEN)
+/**
+ * @brief  Initializes stream which writes to USART with @ref TM_USART_Send
+ * @note   USART must be initialized. In TX buffer mode data are copied to TX buffer
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure
+ * @param  *USARTx: Pointer to USART
+ * @retval None
+ */
+void TM_STREAM_InitUSART(TM_STREAM_t* Stream, USART_TypeDef* USARTx);
+#endif
+
+#if STREAM_USE_CDC || defined(DOXYGEN)
+/**
+ * @brief  Initializes stream which writes to USB CDC with @ref TM_USBD_CDC_PutArray
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure
+ * @param  USB_Mode: USB mode, member of @ref TM_USB_t enumeration
+ * @retval None
+ */
+void TM_STREAM_InitCDC(TM_STREAM_t* Stream, TM_USB_t USB_Mode);
+#endif
+
+#if STREAM_USE_FATFS || defined(DOXYGEN)
+/**
+ * @brief  Initializes stream which writes to opened file
+ * @note   @ref TM_STREAM_Flush also syncs file
+ * @param  *Stream: Pointer to empty @ref TM_STREAM_t structure
+ * @param  *fil: Pointer to file opened for writing, must stay valid
+ * @retval None
+ */
+void TM_STREAM_InitFatFs(TM_STREAM_t* Stream, FIL* fil);
+#endif
+
+/**
+ * @brief  Sets buffer for stream
+ * @note   Buffer is flushed to output first when buffer is changed
+ * @param  *Stream: Pointer to @ref TM_STREAM_t structure
+ * @param  *Buffer: Pointer to initialized empty @ref TM_BUFFER_t structure or NULL to disable buffering
+ * @retval None
+ */
+void TM_STREAM_SetBuffer(TM_STREAM_t* Stream, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Writes more parts of data to stream
+ * @param  *Stream: Pointer to @ref TM_STREAM_t structure
+ * @param  *Vectors: Pointer to array of @ref TM_STREAM_Vector_t parts
+ * @param  count: Number of parts
+ * @retval Number of bytes written to stream
+ */
+uint32_t TM_STREAM_WriteV(TM_STREAM_t* Stream, const TM_STREAM_Vector_t* Vectors, uint8_t count);
+
+/**
+ * @brief  Writes data to stream
+ * @param  *Stream: Pointer to @ref TM_STREAM_t structure
+ * @param  *Data: Pointer to data
+ * @param  count: Number of bytes
+ * @retval Number of bytes written to stream
+ */
+uint32_t TM_STREAM_Write(TM_STREAM_t* Stream, const void* Data, uint32_t count);
+
+/**
+ * @brief  Writes string to stream, without terminating zero
+ * @param  *Stream: Pointer to @ref TM_STREAM_t structure
+ * @param  *str: Pointer to string
+ * @retval Number of bytes written to stream
+ */
+uint32_t TM_STREAM_Puts(TM_STREAM_t* Stream, const char* str);
+
+/**
+ * @brief  Writes buffered data to output and flushes output
+ * @param  *Stream: Pointer to @ref TM_STREAM_t structure
+ * @retval Flush status:
+ *            - 0: All data were written
+ *            - > 0: Output error, data which were not written stay in buffer
+ */
+uint8_t TM_STREAM_Flush(TM_STREAM_t* Stream);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -53,7 +53,6 @@ TM_STRING_t* TM_STRING_Create(uint16_t size) {
 }
 
 uint16_t TM_STRING_AddString(TM_STRING_t* String, char* str) {
-	TM_STRING_t* ptr;
 	char** tmp1;
 	uint16_t i;
 	
@@ -64,45 +63,35 @@ uint16_t TM_STRING_AddString(TM_STRING_t* String, char* str) {
 	
 	/* Check if memory available */
 	if (String->Count >= String->Size) {
-		/* Create new string with more memory */
-		ptr = TM_STRING_Create(String->Size + 1);
+		/* Allocate bigger array for pointers */
 		tmp1 = (char **) LIB_ALLOC_FUNC((String->Size + 1) * sizeof(char *));
 		
 		/* Check if allocated */
-		if (ptr == NULL || tmp1 == NULL) {
+		if (tmp1 == NULL) {
 			return 0;
 		}
 		
-		/* New string is allocated, copy old pointers to new */
-		/* Store old value */
+		/* Copy old pointers to new array */
 		for (i = 0; i < String->Size; i++) {
 			tmp1[i] = String->Strings[i];
 		}
 		
-		/* Save new pointer location */
-		String->Strings = ptr->Strings;
-		
-		/* Copy pointers from old to new */
-		for (i = 0; i < String->Size; i++) {
-			String->Strings[i] = tmp1[i];
-		}
+		/* Free old array and save new one */
+		LIB_FREE_FUNC(String->Strings);
+		String->Strings = tmp1;
 		
 		/* Set new size */
-		String->Size = ptr->Size;
-		
-		/* Set tmp old pointer to free */
-		ptr->Strings = tmp1;
-		
-		/* Free tmp1 memory */
-		free(tmp1);
-		
-		/* Free tmp structure */
-		TM_STRING_Free(ptr);
+		String->Size++;
 	}
 	
 	/* Allocate memory for string */
 	String->Strings[String->Count] = (char *) LIB_ALLOC_FUNC((strlen(str) + 1) * sizeof(char));
 	
+	/* Check if allocated */
+	if (String->Strings[String->Count] == NULL) {
+		return 0;
+	}
+	
 	/* Copy content to string */
 	strcpy(String->Strings[String->Count], str);
 	
@@ -133,7 +122,7 @@ TM_STRING_t* TM_STRING_ReplaceString(TM_STRING_t* String, uint16_t pos, char* st
 	/* Check size */
 	if (strlen(str) > strlen(String->Strings[pos])) {
 		/* Allocate new memory */
-		tmp = (char *) LIB_ALLOC_FUNC((strlen(str) + 1) * sizeof(char *));
+		tmp = (char *) LIB_ALLOC_FUNC((strlen(str) + 1) * sizeof(char));
 		
 		/* Check if allocated */
 		if (tmp == NULL) {
@@ -240,3 +229,180 @@ void TM_STRING_FreeAll(TM_STRING_t* String) {
 	TM_STRING_Free(String);
 }
 
+
+/* Private functions */
+static uint8_t TM_STRING_INT_Hash(const char* str, uint32_t* len);
+
+uint8_t TM_STRING_ArenaInit(TM_STRING_ARENA_t* Arena, void* Memory, uint32_t size, uint16_t count, uint8_t flags) {
+	uint32_t tables;
+	
+	/* Clear structure */
+	memset(Arena, 0, sizeof(TM_STRING_ARENA_t));
+	
+	/* Memory for offsets and hashes */
+	tables = (uint32_t)count * ((flags & TM_STRING_ARENA_INTERN) ? 3 : 2);
+	if (count == 0 || size <= tables) {
+		return 1;
+	}
+	
+	/* Allocate one block for everything */
+	if (Memory == NULL) {
+		Memory = LIB_ALLOC_FUNC(size);
+		if (Memory == NULL) {
+			return 2;
+		}
+		Arena->Memory = Memory;
+	}
+	
+	/* Split memory, offsets first to keep them aligned */
+	Arena->Offsets = (uint16_t *)Memory;
+	if (flags & TM_STRING_ARENA_INTERN) {
+		Arena->Hashes = (uint8_t *)Memory + count * 2;
+	}
+	Arena->Chars = (char *)Memory + tables;
+	
+	/* Offsets are 16-bit */
+	size -= tables;
+	if (size > 0xFFFF) {
+		size = 0xFFFF;
+	}
+	
+	/* Save settings */
+	Arena->CharsSize = size;
+	Arena->Size = count;
+	Arena->Flags = flags;
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_STRING_ArenaInitConst(TM_STRING_ARENA_t* Arena, const char* Chars, uint16_t size, const uint16_t* Offsets, uint16_t count) {
+	/* Clear structure */
+	memset(Arena, 0, sizeof(TM_STRING_ARENA_t));
+	
+	/* Use tables directly */
+	Arena->Chars = Chars;
+	Arena->Offsets = Offsets;
+	Arena->CharsSize = size;
+	Arena->Used = size;
+	Arena->Count = count;
+	Arena->Size = count;
+	Arena->ReadOnly = 1;
+}
+
+uint16_t TM_STRING_ArenaAdd(TM_STRING_ARENA_t* Arena, const char* str) {
+	uint32_t len;
+	uint16_t i;
+	uint8_t hash;
+	
+	/* Check arena */
+	if (Arena->ReadOnly || Arena->Count >= Arena->Size) {
+		return TM_STRING_ARENA_INVALID;
+	}
+	
+	/* Get hash and length in one pass */
+	hash = TM_STRING_INT_Hash(str, &len);
+	
+	/* Return existing string */
+	if (Arena->Hashes) {
+		for (i = 0; i < Arena->Count; i++) {
+			if (
+				Arena->Hashes[i] == hash &&
+				TM_STRING_ArenaLength(Arena, i) == len &&
+				memcmp(TM_STRING_ArenaGet(Arena, i), str, len) == 0
+			) {
+				return i;
+			}
+		}
+	}
+	
+	/* Check memory for string and terminating zero */
+	if (len + 1 > (uint32_t)(Arena->CharsSize - Arena->Used)) {
+		return TM_STRING_ARENA_INVALID;
+	}
+	
+	/* Copy string to end of arena */
+	memcpy((char *)&Arena->Chars[Arena->Used], str, len + 1);
+	((uint16_t *)Arena->Offsets)[Arena->Count] = Arena->Used;
+	if (Arena->Hashes) {
+		Arena->Hashes[Arena->Count] = hash;
+	}
+	Arena->Used += len + 1;
+	
+	/* Return index */
+	return Arena->Count++;
+}
+
+uint16_t TM_STRING_ArenaFind(TM_STRING_ARENA_t* Arena, const char* str) {
+	uint32_t len;
+	uint16_t i;
+	uint8_t hash;
+	
+	/* Get hash and length in one pass */
+	hash = TM_STRING_INT_Hash(str, &len);
+	
+	/* Compare lengths first, they are known for every string */
+	for (i = 0; i < Arena->Count; i++) {
+		if (
+			(Arena->Hashes == NULL || Arena->Hashes[i] == hash) &&
+			TM_STRING_ArenaLength(Arena, i) == len &&
+			memcmp(TM_STRING_ArenaGet(Arena, i), str, len) == 0
+		) {
+			return i;
+		}
+	}
+	
+	/* Not found */
+	return TM_STRING_ARENA_INVALID;
+}
+
+uint16_t TM_STRING_ArenaLength(TM_STRING_ARENA_t* Arena, uint16_t index) {
+	/* Check index */
+	if (index >= Arena->Count) {
+		return 0;
+	}
+	
+	/* Strings are stored one after another */
+	if (index == (Arena->Count - 1)) {
+		return Arena->Used - Arena->Offsets[index] - 1;
+	}
+	return Arena->Offsets[index + 1] - Arena->Offsets[index] - 1;
+}
+
+void TM_STRING_ArenaReset(TM_STRING_ARENA_t* Arena) {
+	/* Strings in flash can not be removed */
+	if (Arena->ReadOnly) {
+		return;
+	}
+	
+	/* Remove all strings */
+	Arena->Count = 0;
+	Arena->Used = 0;
+}
+
+void TM_STRING_ArenaFree(TM_STRING_ARENA_t* Arena) {
+	/* Free memory allocated by library */
+	if (Arena->Memory) {
+		LIB_FREE_FUNC(Arena->Memory);
+	}
+	
+	/* Clear structure */
+	memset(Arena, 0, sizeof(TM_STRING_ARENA_t));
+}
+
+/* Private functions */
+static uint8_t TM_STRING_INT_Hash(const char* str, uint32_t* len) {
+	uint32_t hash = 2166136261UL;
+	const char* ptr = str;
+	
+	/* FNV-1a hash */
+	while (*ptr) {
+		hash = (hash ^ (uint8_t)*ptr++) * 16777619UL;
+	}
+	
+	/* Save length */
+	*len = ptr - str;
+	
+	/* Fold to 8 bits */
+	return (uint8_t)(hash ^ (hash >> 8) ^ (hash >> 16) ^ (hash >> 24));
+}
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    
- * @version v1.0
+ * @version v1.2
  * @ide     Keil uVision
  * @license MIT
  * @brief   String library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_STRING_H
-#define TM_STRING_H 100
+#define TM_STRING_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -60,12 +60,51 @@ extern "C" {
  * If you use Keil uVision, then you can set HEAP memory by simply open startup file (*.s) and increase variable "Heap_Size".
  *
  * For other compilers, check it's manual.
+ *
+ * \par String arena
+ *
+ * @ref TM_STRING_t allocates each string separately, which fragments HEAP when many strings are used, for example for menus.
+ * @ref TM_STRING_ARENA_t keeps all characters in one contiguous memory block and table of offsets for strings.
+ * Memory is taken from user or allocated only once at init, all strings are freed at once with @ref TM_STRING_ArenaReset.
+ *
+ * - Getting string and its length takes constant time
+ * - With @ref TM_STRING_ARENA_INTERN flag, the same string is stored only once and its index is returned when it is added again
+ * - Read only arena uses string table stored in flash, no RAM is used for strings
+ *
+\code
+//Arena with max 64 strings in 1024 bytes of memory, same strings stored once
+TM_STRING_ARENA_t Arena;
+uint32_t ArenaMemory[1024 / 4];
+uint16_t idx;
+
+TM_STRING_ArenaInit(&Arena, ArenaMemory, sizeof(ArenaMemory), 64, TM_STRING_ARENA_INTERN);
+idx = TM_STRING_ArenaAdd(&Arena, "Settings");
+printf("%s: %d\n", TM_STRING_ArenaGet(&Arena, idx), TM_STRING_ArenaLength(&Arena, idx));
+
+//Remove all strings at once
+TM_STRING_ArenaReset(&Arena);
+
+//Read only arena in flash, strings are separated with zero, last zero is added by compiler
+const char MenuChars[] = "Start\0Stop\0Settings";
+const uint16_t MenuOffsets[] = {0, 6, 11};
+
+TM_STRING_ArenaInitConst(&Arena, MenuChars, sizeof(MenuChars), MenuOffsets, 3);
+\endcode
  * 
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - TM POOL can be used for allocations with LIB_USE_POOL
+  - Fixed double free and memory leak when TM_STRING_AddString grows pointers array
+  
+ Version 1.2
+  - October 14, 2026
+  - Added string arena with offsets table, bulk free, interning and read only strings in flash
 \endverbatim
  *
  * \par Dependencies
@@ -90,6 +129,11 @@ extern "C" {
  * @{
  */
 
+/* Use memory pools when enabled */
+#if defined(LIB_USE_POOL) && LIB_USE_POOL
+#include "tm_stm32_pool.h"
+#endif
+
 /* Memory allocation function */
 #ifndef LIB_ALLOC_FUNC
 #define LIB_ALLOC_FUNC    malloc
@@ -100,6 +144,24 @@ extern "C" {
 #define LIB_FREE_FUNC     free
 #endif
 
+/**
+ * @brief  Arena flag, same string is stored only once and its existing index is returned
+ */
+#define TM_STRING_ARENA_INTERN     0x01
+
+/**
+ * @brief  Invalid index, returned when string can not be added or found
+ */
+#define TM_STRING_ARENA_INVALID    0xFFFF
+
+/**
+ * @brief  Number of bytes of memory for arena with desired number of strings and characters
+ * @param  count: Max number of strings
+ * @param  chars: Number of bytes for characters, including terminating zero of each string
+ * @param  flags: Arena flags
+ */
+#define TM_STRING_ARENA_MEMORY_SIZE(count, chars, flags)    ((count) * (((flags) & TM_STRING_ARENA_INTERN) ? 3 : 2) + (chars))
+
 /**
  * @}
  */
@@ -119,6 +181,23 @@ typedef struct {
 	uint32_t Size;     /*!< Number of all allocated pointers for strings */
 } TM_STRING_t;
 
+/**
+ * @brief  String arena structure
+ * @note   All members are private, use arena functions to access strings
+ */
+typedef struct {
+	const char* Chars;        /*!< Pointer to characters of all strings */
+	const uint16_t* Offsets;  /*!< Pointer to offset of each string in characters memory */
+	uint8_t* Hashes;          /*!< Pointer to hash of each string, used for interning */
+	void* Memory;             /*!< Memory allocated by library, NULL if memory is from user */
+	uint16_t CharsSize;       /*!< Size of characters memory in units of bytes */
+	uint16_t Used;            /*!< Number of used bytes in characters memory */
+	uint16_t Count;           /*!< Number of strings in arena */
+	uint16_t Size;            /*!< Max number of strings in arena */
+	uint8_t Flags;            /*!< Arena flags */
+	uint8_t ReadOnly;         /*!< Set when arena is in flash */
+} TM_STRING_ARENA_t;
+
 /**
  * @}
  */
@@ -203,6 +282,89 @@ void TM_STRING_FreeAll(TM_STRING_t* String);
  */
 void TM_STRING_Free(TM_STRING_t* String);
 
+/**
+ * @brief  Initializes string arena
+ * @note   Memory is split to offsets table, hashes table when interning is used, and characters.
+ *            Up to 65535 bytes of characters can be used
+ * @param  *Arena: Pointer to empty @ref TM_STRING_ARENA_t structure
+ * @param  *Memory: Pointer to at least half word aligned memory for arena, see @ref TM_STRING_ARENA_MEMORY_SIZE.
+ *            Set to NULL to allocate one block with @ref LIB_ALLOC_FUNC
+ * @param  size: Memory size in units of bytes
+ * @param  count: Max number of strings in arena
+ * @param  flags: Arena flags, 0 or @ref TM_STRING_ARENA_INTERN
+ * @retval Status:
+ *            - 0: Arena initialized
+ *            - > 0: Memory too small or allocation failed
+ */
+uint8_t TM_STRING_ArenaInit(TM_STRING_ARENA_t* Arena, void* Memory, uint32_t size, uint16_t count, uint8_t flags);
+
+/**
+ * @brief  Initializes read only string arena from string table in flash
+ * @param  *Arena: Pointer to empty @ref TM_STRING_ARENA_t structure
+ * @param  *Chars: Pointer to zero separated strings
+ * @param  size: Size of characters in units of bytes, including last terminating zero
+ * @param  *Offsets: Pointer to table of offsets of each string in characters, in ascending order
+ * @param  count: Number of strings in table
+ * @retval None
+ */
+void TM_STRING_ArenaInitConst(TM_STRING_ARENA_t* Arena, const char* Chars, uint16_t size, const uint16_t* Offsets, uint16_t count);
+
+/**
+ * @brief  Adds string to arena
+ * @note   With @ref TM_STRING_ARENA_INTERN flag, index of already stored equal string is returned
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @param  *str: Pointer to string to copy to arena
+ * @retval String index or @ref TM_STRING_ARENA_INVALID if arena is full or read only
+ */
+uint16_t TM_STRING_ArenaAdd(TM_STRING_ARENA_t* Arena, const char* str);
+
+/**
+ * @brief  Finds string in arena
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @param  *str: Pointer to string to find
+ * @retval String index or @ref TM_STRING_ARENA_INVALID if string is not in arena
+ */
+uint16_t TM_STRING_ArenaFind(TM_STRING_ARENA_t* Arena, const char* str);
+
+/**
+ * @brief  Gets length of string in arena, without terminating zero
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @param  index: String index
+ * @retval String length or 0 if index is not valid
+ */
+uint16_t TM_STRING_ArenaLength(TM_STRING_ARENA_t* Arena, uint16_t index);
+
+/**
+ * @brief  Removes all strings from arena at once
+ * @note   Has no effect on read only arena
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @retval None
+ */
+void TM_STRING_ArenaReset(TM_STRING_ARENA_t* Arena);
+
+/**
+ * @brief  Frees arena memory if it was allocated by library
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @retval None
+ */
+void TM_STRING_ArenaFree(TM_STRING_ARENA_t* Arena);
+
+/**
+ * @brief  Gets pointer to string in arena
+ * @note   Defined as macro for faster execution, index is not checked
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @param  index: String index, between 0 and number of strings - 1
+ * @retval Pointer to string
+ */
+#define TM_STRING_ArenaGet(Arena, index)    (&(Arena)->Chars[(Arena)->Offsets[(index)]])
+
+/**
+ * @brief  Gets number of strings in arena
+ * @param  *Arena: Pointer to @ref TM_STRING_ARENA_t structure
+ * @retval Number of strings
+ */
+#define TM_STRING_ArenaGetCount(Arena)      ((Arena)->Count)
+
 /**
  * @}
  */
@@ -0,0 +1,254 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_telemetry.h"
+
+/* Private functions */
+static uint32_t TM_TELEMETRY_INT_Send(TM_TELEMETRY_t* Telemetry, TM_TELEMETRY_Block_t** Blocks, uint32_t count);
+static void TM_TELEMETRY_INT_Release(TM_TELEMETRY_Block_t* Block);
+static void TM_TELEMETRY_INT_Free(struct pbuf* p);
+
+uint8_t TM_TELEMETRY_Init(TM_TELEMETRY_t* Telemetry, ip_addr_t* Address, uint16_t Port, uint32_t QueueSize) {
+	/* Clear structure */
+	memset(Telemetry, 0, sizeof(TM_TELEMETRY_t));
+	
+	/* Queue of block pointers */
+	if (TM_QUEUE_Init(&Telemetry->Queue, NULL, sizeof(TM_TELEMETRY_Block_t *), QueueSize)) {
+		return 1;
+	}
+	
+	/* Create UDP control block */
+	Telemetry->Pcb = udp_new();
+	if (Telemetry->Pcb == NULL) {
+		TM_QUEUE_Free(&Telemetry->Queue);
+		return 2;
+	}
+	
+	/* Save receiver */
+	ip_addr_set(&Telemetry->Address, Address);
+	Telemetry->Port = Port;
+	
+	/* Return OK */
+	return 0;
+}
+
+void TM_TELEMETRY_DeInit(TM_TELEMETRY_t* Telemetry) {
+	TM_TELEMETRY_Block_t* Block;
+	
+	/* Release blocks which were not sent yet */
+	while (TM_QUEUE_Get(&Telemetry->Queue, &Block)) {
+		TM_TELEMETRY_INT_Release(Block);
+	}
+	
+	/* Free memory */
+	if (Telemetry->Pcb) {
+		udp_remove(Telemetry->Pcb);
+		Telemetry->Pcb = NULL;
+	}
+	TM_QUEUE_Free(&Telemetry->Queue);
+}
+
+void TM_TELEMETRY_BlockInit(TM_TELEMETRY_Block_t* Block, void* Data, uint16_t Length, uint16_t Type, void (*Release)(TM_TELEMETRY_Block_t*), void* UserParameters) {
+	/* Clear structure */
+	memset(Block, 0, sizeof(TM_TELEMETRY_Block_t));
+	
+	/* Fill settings */
+	Block->Data = Data;
+	Block->Length = Length;
+	Block->Type = Type;
+	Block->Release = Release;
+	Block->UserParameters = UserParameters;
+}
+
+uint8_t TM_TELEMETRY_Submit(TM_TELEMETRY_t* Telemetry, TM_TELEMETRY_Block_t* Block) {
+	uint32_t irq;
+	
+	/* Block must fit into one datagram */
+	if (Block->Length > (TELEMETRY_MAX_PAYLOAD - sizeof(TM_TELEMETRY_Header_t) - sizeof(TM_TELEMETRY_Descriptor_t))) {
+		return 3;
+	}
+	
+	/* Take block, producer in other interrupt may try the same */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	if (Block->InUse) {
+		Telemetry->Stats.Busy++;
+		if (!irq) {
+			__enable_irq();
+		}
+		return 1;
+	}
+	Block->InUse = 1;
+	Telemetry->Stats.Submitted++;
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Save data */
+	Block->Telemetry = Telemetry;
+	Block->Timestamp = TELEMETRY_TIMESTAMP();
+	
+	/* Add block to queue */
+	if (!TM_QUEUE_Put(&Telemetry->Queue, &Block)) {
+		irq = __get_PRIMASK();
+		__disable_irq();
+		Telemetry->Stats.QueueFull++;
+		if (!irq) {
+			__enable_irq();
+		}
+		
+		/* Block is free again */
+		Block->InUse = 0;
+		return 2;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+uint32_t TM_TELEMETRY_Process(TM_TELEMETRY_t* Telemetry) {
+	TM_TELEMETRY_Block_t* Blocks[TELEMETRY_MAX_BLOCKS];
+	TM_TELEMETRY_Block_t* Block;
+	uint32_t count = 0, size = sizeof(TM_TELEMETRY_Header_t), sent = 0;
+	
+	/* Pack queued blocks to datagrams */
+	while (TM_QUEUE_Get(&Telemetry->Queue, &Block)) {
+		/* Send current datagram if block does not fit anymore */
+		if (
+			count == TELEMETRY_MAX_BLOCKS ||
+			(size + sizeof(TM_TELEMETRY_Descriptor_t) + Block->Length) > TELEMETRY_MAX_PAYLOAD
+		) {
+			sent += TM_TELEMETRY_INT_Send(Telemetry, Blocks, count);
+			count = 0;
+			size = sizeof(TM_TELEMETRY_Header_t);
+		}
+		
+		/* Add block */
+		Blocks[count++] = Block;
+		size += sizeof(TM_TELEMETRY_Descriptor_t) + Block->Length;
+	}
+	
+	/* Send remaining blocks */
+	if (count) {
+		sent += TM_TELEMETRY_INT_Send(Telemetry, Blocks, count);
+	}
+	
+	/* Return number of datagrams */
+	return sent;
+}
+
+/* Private functions */
+static uint32_t TM_TELEMETRY_INT_Send(TM_TELEMETRY_t* Telemetry, TM_TELEMETRY_Block_t** Blocks, uint32_t count) {
+	TM_TELEMETRY_Header_t header;
+	TM_TELEMETRY_Descriptor_t descriptor;
+	struct pbuf *p, *q;
+	uint8_t* ptr;
+	uint32_t i;
+	err_t err;
+	
+	/* Header with descriptors, space for UDP, IP and Ethernet headers is reserved in front */
+	p = pbuf_alloc(PBUF_TRANSPORT, sizeof(TM_TELEMETRY_Header_t) + count * sizeof(TM_TELEMETRY_Descriptor_t), PBUF_RAM);
+	
+	/* Sequence number is used also when datagram is dropped, receiver sees gap */
+	header.Sequence = Telemetry->Sequence++;
+	
+	/* Drop blocks */
+	if (p == NULL) {
+		for (i = 0; i < count; i++) {
+			TM_TELEMETRY_INT_Release(Blocks[i]);
+		}
+		Telemetry->Stats.AllocErrors += count;
+		return 0;
+	}
+	
+	/* Fill header, payload is not aligned after reserved headers */
+	header.Magic = TELEMETRY_MAGIC;
+	header.Version = TELEMETRY_VERSION;
+	header.Count = count;
+	header.Timestamp = Blocks[0]->Timestamp;
+	ptr = (uint8_t *)p->payload;
+	memcpy(ptr, &header, sizeof(TM_TELEMETRY_Header_t));
+	ptr += sizeof(TM_TELEMETRY_Header_t);
+	
+	/* Add blocks */
+	for (i = 0; i < count; i++) {
+		/* Fill descriptor */
+		descriptor.Type = Blocks[i]->Type;
+		descriptor.Length = Blocks[i]->Length;
+		descriptor.TimeOffset = (int32_t)(Blocks[i]->Timestamp - header.Timestamp);
+		memcpy(ptr, &descriptor, sizeof(TM_TELEMETRY_Descriptor_t));
+		ptr += sizeof(TM_TELEMETRY_Descriptor_t);
+		
+		/* Reference pbuf pointing to user data, chain takes its reference */
+		Blocks[i]->Pbuf.custom_free_function = TM_TELEMETRY_INT_Free;
+		q = pbuf_alloced_custom(PBUF_RAW, Blocks[i]->Length, PBUF_REF, &Blocks[i]->Pbuf, Blocks[i]->Data, Blocks[i]->Length);
+		pbuf_cat(p, q);
+		
+		/* Update stats */
+		Telemetry->Stats.Bytes += Blocks[i]->Length;
+	}
+	Telemetry->Stats.Blocks += count;
+	Telemetry->Stats.InFlight += count;
+	if (Telemetry->Stats.InFlight > Telemetry->Stats.MaxInFlight) {
+		Telemetry->Stats.MaxInFlight = Telemetry->Stats.InFlight;
+	}
+	
+	/* Send datagram, Ethernet driver keeps reference until frame is transmitted */
+	err = udp_sendto(Telemetry->Pcb, p, &Telemetry->Address, Telemetry->Port);
+	
+	/* Free our reference, blocks are released when driver is done */
+	pbuf_free(p);
+	
+	/* Check status */
+	if (err != ERR_OK) {
+		Telemetry->Stats.SendErrors++;
+		return 0;
+	}
+	Telemetry->Stats.Datagrams++;
+	
+	/* Return sent */
+	return 1;
+}
+
+static void TM_TELEMETRY_INT_Release(TM_TELEMETRY_Block_t* Block) {
+	/* Block can be submitted again, also from release callback */
+	Block->InUse = 0;
+	
+	/* Call user function */
+	if (Block->Release) {
+		Block->Release(Block);
+	}
+}
+
+static void TM_TELEMETRY_INT_Free(struct pbuf* p) {
+	/* Custom pbuf is first member of block */
+	TM_TELEMETRY_Block_t* Block = (TM_TELEMETRY_Block_t *)p;
+	
+	/* Block is not in flight anymore */
+	((TM_TELEMETRY_t *)Block->Telemetry)->Stats.InFlight--;
+	
+	/* Release block */
+	TM_TELEMETRY_INT_Release(Block);
+}
@@ -0,0 +1,376 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Zero copy UDP telemetry streaming over lwIP for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_TELEMETRY_H
+#define TM_TELEMETRY_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_TELEMETRY
+ * @brief    Zero copy UDP telemetry streaming over lwIP for STM32Fxxx
+ * @{
+ *
+ * Library sends blocks of samples (ADC DMA buffers, MPU6050 FIFO reads, FFT output) to UDP receiver.
+ * More blocks are packed into one datagram, each datagram starts with header with sequence number and timestamp.
+ *
+ * Sample data is never copied. Each block is given to lwIP as reference pbuf pointing to user buffer
+ * and chained after small header pbuf. Ethernet DMA reads samples directly from user buffer.
+ * When lwIP and Ethernet driver are done with block, release callback is called and buffer can be filled again.
+ *
+ * \par Data flow
+ *
+ * - Producer (usually DMA half/complete interrupt) fills buffer and calls @ref TM_TELEMETRY_Submit.
+ *   Block is saved to lock-free queue, nothing else is done in interrupt.
+ * - @ref TM_TELEMETRY_Process is called from main loop (NO_SYS = 1) or from tcpip thread (tcpip_callback).
+ *   It takes blocks from queue, packs them to datagrams and sends them with lwIP raw API.
+ * - When frame is transmitted, lwIP frees pbufs and block release callback is called.
+ *
+ * \par Backpressure
+ *
+ * Block can not be submitted again until it is released. When queue is full or block is still in use,
+ * submit fails and block must be reused or skipped by producer. All these events are counted in @ref TM_TELEMETRY_Stats_t.
+ * InFlight member tells how many blocks are currently owned by stack, MaxInFlight tells how close stack was to producer.
+ *
+ * \par Datagram format
+ *
+ * All values are little endian. Datagram consists of:
+ *
+ * - @ref TM_TELEMETRY_Header_t, 16 bytes
+ * - Count times @ref TM_TELEMETRY_Descriptor_t, 8 bytes each
+ * - Data of all blocks in the same order as descriptors
+ *
+ * Sequence number increases for every datagram, also when send fails, so receiver can count lost datagrams.
+ *
+ * \par Timestamps
+ *
+ * When RTC_TIMESTAMP is enabled in RTC library, timestamps are from @ref TM_RTC_GetTimestamp.
+ * Otherwise, HAL tick multiplied by 1000 is used. Timestamp is always in units of microseconds.
+ *
+ * \par Select custom settings
+ *
+\code
+//Max payload of one datagram, 1472 bytes fits into one Ethernet frame without fragmentation
+#define TELEMETRY_MAX_PAYLOAD    1472
+
+//Max number of blocks in one datagram
+#define TELEMETRY_MAX_BLOCKS     8
+
+//Custom timestamp function, in units of microseconds
+#define TELEMETRY_TIMESTAMP()    my_micros()
+\endcode
+ *
+ * \par Example
+ *
+\code
+TM_TELEMETRY_t Telemetry;
+TM_TELEMETRY_Block_t Blocks[2];
+uint16_t Samples[2][256];
+
+//Called when stack does not need buffer anymore
+void SamplesReleased(TM_TELEMETRY_Block_t* Block) {
+	//Buffer can be filled again
+}
+
+//Init
+IP4_ADDR(&addr, 192, 168, 0, 10);
+TM_TELEMETRY_Init(&Telemetry, &addr, 5000, 16);
+TM_TELEMETRY_BlockInit(&Blocks[0], Samples[0], sizeof(Samples[0]), 1, SamplesReleased, NULL);
+TM_TELEMETRY_BlockInit(&Blocks[1], Samples[1], sizeof(Samples[1]), 1, SamplesReleased, NULL);
+
+//DMA half transfer interrupt
+TM_TELEMETRY_Submit(&Telemetry, &Blocks[0]);
+
+//DMA transfer complete interrupt
+TM_TELEMETRY_Submit(&Telemetry, &Blocks[1]);
+
+//Main loop
+while (1) {
+	ethernetif_input(&netif);
+	TM_TELEMETRY_Process(&Telemetry);
+	sys_check_timeouts();
+}
+\endcode
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM QUEUE
+ - TM RTC, when RTC_TIMESTAMP is enabled
+ - lwIP
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_queue.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "string.h"
+
+#if defined(RTC_TIMESTAMP) && RTC_TIMESTAMP
+#include "tm_stm32_rtc.h"
+#endif
+
+/**
+ * @defgroup TM_TELEMETRY_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Max payload of one datagram, including header and descriptors */
+#ifndef TELEMETRY_MAX_PAYLOAD
+#define TELEMETRY_MAX_PAYLOAD    1472
+#endif
+
+/* Max number of blocks in one datagram, each block uses one TX descriptor in Ethernet driver */
+#ifndef TELEMETRY_MAX_BLOCKS
+#define TELEMETRY_MAX_BLOCKS     8
+#endif
+
+/* Timestamp function, in units of microseconds */
+#ifndef TELEMETRY_TIMESTAMP
+#if defined(RTC_TIMESTAMP) && RTC_TIMESTAMP
+#define TELEMETRY_TIMESTAMP()    TM_RTC_GetTimestamp()
+#else
+#define TELEMETRY_TIMESTAMP()    ((uint64_t)HAL_GetTick() * 1000)
+#endif
+#endif
+
+/* Datagram header identification and format version */
+#define TELEMETRY_MAGIC          0x4D54
+#define TELEMETRY_VERSION        0x01
+
+/* Reference pbufs with custom free function are needed for zero copy */
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "TELEMETRY: Custom pbufs must be enabled in lwipopts.h, IP_FRAG = 1, IP_FRAG_USES_STATIC_BUF = 0, LWIP_NETIF_TX_SINGLE_PBUF = 0"
+#endif
+
+#if TELEMETRY_MAX_BLOCKS > 255
+#error "TELEMETRY: TELEMETRY_MAX_BLOCKS must not be above 255"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_TELEMETRY_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Datagram header, sent as first 16 bytes of each datagram
+ */
+typedef struct {
+	uint16_t Magic;            /*!< Always @ref TELEMETRY_MAGIC */
+	uint8_t Version;           /*!< Format version, @ref TELEMETRY_VERSION */
+	uint8_t Count;             /*!< Number of blocks in datagram */
+	uint32_t Sequence;         /*!< Datagram sequence number */
+	uint64_t Timestamp;        /*!< Timestamp of first block in datagram, in units of microseconds */
+} TM_TELEMETRY_Header_t;
+
+/**
+ * @brief  Block descriptor, one for each block after header
+ */
+typedef struct {
+	uint16_t Type;             /*!< Block type, set by user */
+	uint16_t Length;           /*!< Block data length in units of bytes */
+	int32_t TimeOffset;        /*!< Block timestamp relative to header timestamp, in units of microseconds */
+} TM_TELEMETRY_Descriptor_t;
+
+/**
+ * @brief  Telemetry block
+ * @note   All members are private, use @ref TM_TELEMETRY_BlockInit to set them
+ */
+typedef struct _TM_TELEMETRY_Block_t {
+	struct pbuf_custom Pbuf;   /*!< Reference pbuf given to lwIP, must be first member. This is private member */
+	void* Data;                /*!< Pointer to block data */
+	void* Telemetry;           /*!< Pointer to @ref TM_TELEMETRY_t block was submitted to. This is private member */
+	uint16_t Length;           /*!< Data length in units of bytes */
+	uint16_t Type;             /*!< Block type, sent in descriptor */
+	volatile uint8_t InUse;    /*!< Set when block is submitted until it is released. This is private member */
+	uint64_t Timestamp;        /*!< Timestamp of last submit, in units of microseconds */
+	void (*Release)(struct _TM_TELEMETRY_Block_t* Block); /*!< Called when block is not used by stack anymore */
+	void* UserParameters;      /*!< Pointer to user parameters */
+} TM_TELEMETRY_Block_t;
+
+/**
+ * @brief  Telemetry statistics
+ */
+typedef struct {
+	uint32_t Submitted;        /*!< Number of submitted blocks */
+	uint32_t Blocks;           /*!< Number of blocks given to stack */
+	uint32_t Datagrams;        /*!< Number of sent datagrams */
+	uint32_t Bytes;            /*!< Number of sent sample bytes, without headers */
+	uint32_t QueueFull;        /*!< Number of submits rejected because queue was full */
+	uint32_t Busy;             /*!< Number of submits rejected because block was not released yet */
+	uint32_t AllocErrors;      /*!< Number of blocks dropped because pbuf could not be allocated */
+	uint32_t SendErrors;       /*!< Number of datagrams lwIP failed to send */
+	uint32_t InFlight;         /*!< Number of blocks currently owned by stack */
+	uint32_t MaxInFlight;      /*!< Max number of blocks owned by stack at the same time */
+} TM_TELEMETRY_Stats_t;
+
+/**
+ * @brief  Telemetry stream structure
+ */
+typedef struct {
+	struct udp_pcb* Pcb;       /*!< UDP control block. This is private member */
+	ip_addr_t Address;         /*!< Receiver IP address */
+	uint16_t Port;             /*!< Receiver UDP port */
+	uint32_t Sequence;         /*!< Sequence number of next datagram */
+	TM_QUEUE_t Queue;          /*!< Queue of submitted blocks. This is private member */
+	TM_TELEMETRY_Stats_t Stats; /*!< Stream statistics */
+} TM_TELEMETRY_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_TELEMETRY_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes telemetry stream
+ * @note   Must be called from lwIP context, after lwIP is initialized
+ * @param  *Telemetry: Pointer to empty @ref TM_TELEMETRY_t structure
+ * @param  *Address: Receiver IP address
+ * @param  Port: Receiver UDP port
+ * @param  QueueSize: Number of blocks which can wait in queue, must be power of 2
+ * @retval Status:
+ *            - 0: Stream initialized
+ *            - > 0: Memory for queue or UDP control block could not be allocated
+ */
+uint8_t TM_TELEMETRY_Init(TM_TELEMETRY_t* Telemetry, ip_addr_t* Address, uint16_t Port, uint32_t QueueSize);
+
+/**
+ * @brief  Deinitializes telemetry stream and frees its memory
+ * @note   Blocks which are still in flight are released by stack later
+ * @param  *Telemetry: Pointer to @ref TM_TELEMETRY_t structure
+ * @retval None
+ */
+void TM_TELEMETRY_DeInit(TM_TELEMETRY_t* Telemetry);
+
+/**
+ * @brief  Initializes telemetry block for user buffer
+ * @param  *Block: Pointer to empty @ref TM_TELEMETRY_Block_t structure
+ * @param  *Data: Pointer to buffer with samples, must stay valid while block is used.
+ *            Buffer must be in memory accessible by Ethernet DMA, otherwise Ethernet driver copies it
+ * @param  Length: Data length in units of bytes
+ * @param  Type: Block type, sent to receiver in descriptor
+ * @param  *Release: Callback called when block is released. Set to NULL if not used
+ * @param  *UserParameters: Pointer to user parameters
+ * @retval None
+ */
+void TM_TELEMETRY_BlockInit(TM_TELEMETRY_Block_t* Block, void* Data, uint16_t Length, uint16_t Type, void (*Release)(TM_TELEMETRY_Block_t*), void* UserParameters);
+
+/**
+ * @brief  Submits block for sending and saves its timestamp
+ * @note   Can be called from any task or interrupt, buffer must not be changed until block is released
+ * @param  *Telemetry: Pointer to @ref TM_TELEMETRY_t structure
+ * @param  *Block: Pointer to @ref TM_TELEMETRY_Block_t block to send
+ * @retval Status:
+ *            - 0: Block is in queue
+ *            - > 0: Block is still in use, queue is full or block is too big for one datagram
+ */
+uint8_t TM_TELEMETRY_Submit(TM_TELEMETRY_t* Telemetry, TM_TELEMETRY_Block_t* Block);
+
+/**
+ * @brief  Sends all submitted blocks, packed to as few datagrams as possible
+ * @note   Must be called from lwIP context, from main loop with NO_SYS = 1 or from tcpip thread
+ * @param  *Telemetry: Pointer to @ref TM_TELEMETRY_t structure
+ * @retval Number of sent datagrams
+ */
+uint32_t TM_TELEMETRY_Process(TM_TELEMETRY_t* Telemetry);
+
+/**
+ * @brief  Checks if block is released by stack
+ * @param  *Block: Pointer to @ref TM_TELEMETRY_Block_t structure
+ * @retval Block status:
+ *            - 0: Block is in use
+ *            - > 0: Block is released and can be filled again
+ */
+#define TM_TELEMETRY_BlockReleased(Block)    (!(Block)->InUse)
+
+/**
+ * @brief  Gets stream statistics
+ * @param  *Telemetry: Pointer to @ref TM_TELEMETRY_t structure
+ * @retval Pointer to @ref TM_TELEMETRY_Stats_t structure
+ */
+#define TM_TELEMETRY_GetStats(Telemetry)     (&(Telemetry)->Stats)
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,22 +37,67 @@
 /* Static driver structure */
 static TM_TOUCH_DRIVER_t TouchDriver;
 
+/* Event queue, written from interrupt in interrupt mode */
+static TM_TOUCH_Event_t TouchEvents[TOUCH_EVENT_QUEUE_SIZE];
+static volatile uint16_t TouchEventsIn, TouchEventsOut;
+static volatile uint32_t TouchEventsLostCount;
+
+/* Touches from previous read for event detection */
+static uint8_t TouchLastCount;
+static uint8_t TouchLastId[10];
+static uint16_t TouchLastX[10], TouchLastY[10];
+
+/* Interrupt mode */
+static uint16_t TouchIntPin;
+static volatile uint8_t TouchBusy, TouchAgain;
+static volatile uint32_t TouchTime;
+
+/* Calibration in native orientation and transform merged with orientation, rounding included in offsets */
+static TM_TOUCH_Calibration_t TouchCal, TouchMatrix;
+static uint8_t TouchCalEnabled, TouchMatrixOrientation;
+static uint16_t TouchMatrixMaxX, TouchMatrixMaxY;
+
+/* Private functions */
+static void TM_TOUCH_INT_Rotate(TM_TOUCH_t* TS);
+static void TM_TOUCH_INT_UpdateMatrix(TM_TOUCH_t* TS);
+static void TM_TOUCH_INT_ToNative(TM_TOUCH_t* TS, const TM_TOUCH_Point_t* Point, int32_t* x, int32_t* y);
+static int32_t TM_TOUCH_INT_Div(int64_t n, int64_t d);
+static void TM_TOUCH_INT_Process(TM_TOUCH_t* TS, uint32_t time);
+static uint8_t TM_TOUCH_INT_AddEvent(TM_TOUCH_EventType_t type, uint8_t id, uint16_t x, uint16_t y, uint32_t time);
+static void TM_TOUCH_INT_StartRead(TM_TOUCH_t* TS);
+static void TM_TOUCH_INT_EXTICallback(uint16_t GPIO_Pin, void* Param);
+
 TM_TOUCH_Result_t TM_TOUCH_Init(TM_TOUCH_DRIVER_t* Driver, TM_TOUCH_t* TS) {
 	/* Set memory to zero */
 	memset((uint8_t *)&TouchDriver, 0, sizeof(TM_TOUCH_DRIVER_t));
+	
+	/* Reset events */
+	TouchEventsIn = TouchEventsOut = 0;
+	TouchEventsLostCount = 0;
+	TouchLastCount = 0;
+	
+	/* Calibration disabled */
+	TouchCalEnabled = 0;
 
 	/* Check for default driver */
 	if (Driver != NULL) {
 		TouchDriver.Init = Driver->Init;
 		TouchDriver.Read = Driver->Read;
+		TouchDriver.ReadAsync = Driver->ReadAsync;
 	} else {
 		/* Set default values */
 #if defined(STM32F439_EVAL) || defined(TOUCH_USE_STM32F439_EVAL)
 		TouchDriver.Init = TM_TOUCH_TS3510_Init;
 		TouchDriver.Read = TM_TOUCH_TS3510_Read;
+#if I2C_QUEUE_SIZE > 0
+		TouchDriver.ReadAsync = TM_TOUCH_TS3510_ReadAsync;
+#endif
 #elif defined(STM32F7_DISCOVERY) || defined(TOUCH_USE_STM32F7_DISCOVERY)
 		TouchDriver.Init = TM_TOUCH_FT5336_Init;
 		TouchDriver.Read = TM_TOUCH_FT5336_Read;
+#if I2C_QUEUE_SIZE > 0
+		TouchDriver.ReadAsync = TM_TOUCH_FT5336_ReadAsync;
+#endif
 #else
 		/* Return error, no default drivers available */
 		return TM_TOUCH_Result_Error;
@@ -71,7 +116,16 @@ TM_TOUCH_Result_t TM_TOUCH_Init(TM_TOUCH_DRIVER_t* Driver, TM_TOUCH_t* TS) {
 
 uint8_t TM_TOUCH_Read(TM_TOUCH_t* TS) {
 	uint8_t status, i;
-	uint16_t tmp;
+	
+	/* Structure is updated from interrupt in interrupt mode */
+	if (TouchIntPin) {
+		return 0;
+	}
+	
+	/* Drivers without touch IDs keep index as ID */
+	for (i = 0; i < 10; i++) {
+		TS->Id[i] = i;
+	}
 	
 	/* Read touch values from sensor */
 	status = TouchDriver.Read(TS);
@@ -81,6 +135,232 @@ uint8_t TM_TOUCH_Read(TM_TOUCH_t* TS) {
 		return status;
 	}
 	
+	/* Check for orientations */
+	TM_TOUCH_INT_Rotate(TS);
+	
+	/* Add events */
+	TM_TOUCH_INT_Process(TS, HAL_GetTick());
+	
+	/* Return OK */
+	return 0;
+}
+
+TM_TOUCH_Result_t TM_TOUCH_InitInterrupt(TM_TOUCH_t* TS, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+	/* Driver must support reads without blocking */
+	if (TouchDriver.ReadAsync == NULL || TouchIntPin) {
+		return TM_TOUCH_Result_Error;
+	}
+	
+	/* Reset state */
+	TouchBusy = 0;
+	TouchAgain = 0;
+	TouchIntPin = GPIO_Pin;
+	
+	/* INT pin is active low */
+	if (TM_EXTI_AttachCallback(GPIOx, GPIO_Pin, TM_EXTI_Trigger_Falling, TM_TOUCH_INT_EXTICallback, TS) != TM_EXTI_Result_Ok) {
+		TouchIntPin = 0;
+		return TM_TOUCH_Result_Error;
+	}
+	
+	/* Read current state, pin may already be low */
+	TM_TOUCH_INT_EXTICallback(GPIO_Pin, TS);
+	
+	/* Return OK */
+	return TM_TOUCH_Result_Ok;
+}
+
+void TM_TOUCH_DeInitInterrupt(TM_TOUCH_t* TS) {
+	/* Check if used */
+	if (!TouchIntPin) {
+		return;
+	}
+	
+	/* Detach interrupt */
+	TM_EXTI_Detach(TouchIntPin);
+	
+	/* Wait for read in progress */
+	while (TouchBusy);
+	
+	/* Back to polling mode */
+	TouchIntPin = 0;
+}
+
+uint16_t TM_TOUCH_GetEvents(TM_TOUCH_Event_t* Events, uint16_t count) {
+	uint16_t out, read = 0;
+	uint32_t irq;
+	
+	/* Disable interrupts, move events can be merged in interrupt */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Copy events until queue is empty */
+	out = TouchEventsOut;
+	while (read < count && out != TouchEventsIn) {
+		Events[read++] = TouchEvents[out];
+		out = (out + 1) & (TOUCH_EVENT_QUEUE_SIZE - 1);
+	}
+	
+	/* Free read events */
+	TouchEventsOut = out;
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Return number of read events */
+	return read;
+}
+
+uint32_t TM_TOUCH_EventsLost(void) {
+	/* Return lost events */
+	return TouchEventsLostCount;
+}
+
+void TM_TOUCH_ReadAsyncDone(TM_TOUCH_t* TS, uint8_t status) {
+	uint32_t irq;
+	uint8_t again;
+	
+	/* Process new touches */
+	if (status == 0) {
+		TM_TOUCH_INT_Rotate(TS);
+		TM_TOUCH_INT_Process(TS, TouchTime);
+	}
+	
+	/* Disable interrupts, INT pin interrupt can come meanwhile */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Read again if INT pin was activated during read */
+	again = TouchAgain;
+	TouchAgain = 0;
+	if (!again) {
+		TouchBusy = 0;
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Start new read */
+	if (again) {
+		TM_TOUCH_INT_StartRead(TS);
+	}
+}
+
+TM_TOUCH_Result_t TM_TOUCH_CalibrationCalculate(TM_TOUCH_t* TS, const TM_TOUCH_Point_t* Display, const TM_TOUCH_Point_t* Touch, TM_TOUCH_Calibration_t* Cal) {
+	int32_t x[3], y[3], X[3], Y[3];
+	int64_t det;
+	uint8_t i;
+	
+	/* Points in native orientation, as calibration is applied before orientation */
+	for (i = 0; i < 3; i++) {
+		TM_TOUCH_INT_ToNative(TS, &Touch[i], &x[i], &y[i]);
+		TM_TOUCH_INT_ToNative(TS, &Display[i], &X[i], &Y[i]);
+	}
+	
+	/* Points on one line can not be used */
+	det = (int64_t)(x[0] - x[2]) * (y[1] - y[2]) - (int64_t)(x[1] - x[2]) * (y[0] - y[2]);
+	if (det == 0) {
+		return TM_TOUCH_Result_Error;
+	}
+	
+	/* Solve coefficients with Cramer's rule, in Q16 format */
+	Cal->A = TM_TOUCH_INT_Div(((int64_t)(X[0] - X[2]) * (y[1] - y[2]) - (int64_t)(X[1] - X[2]) * (y[0] - y[2])) << 16, det);
+	Cal->B = TM_TOUCH_INT_Div(((int64_t)(x[0] - x[2]) * (X[1] - X[2]) - (int64_t)(x[1] - x[2]) * (X[0] - X[2])) << 16, det);
+	Cal->D = TM_TOUCH_INT_Div(((int64_t)(Y[0] - Y[2]) * (y[1] - y[2]) - (int64_t)(Y[1] - Y[2]) * (y[0] - y[2])) << 16, det);
+	Cal->E = TM_TOUCH_INT_Div(((int64_t)(x[0] - x[2]) * (Y[1] - Y[2]) - (int64_t)(x[1] - x[2]) * (Y[0] - Y[2])) << 16, det);
+	
+	/* Offsets from average of all 3 points, rounding error of coefficients is spread evenly */
+	Cal->C = TM_TOUCH_INT_Div(((int64_t)(X[0] + X[1] + X[2]) << 16) - (int64_t)Cal->A * (x[0] + x[1] + x[2]) - (int64_t)Cal->B * (y[0] + y[1] + y[2]), 3);
+	Cal->F = TM_TOUCH_INT_Div(((int64_t)(Y[0] + Y[1] + Y[2]) << 16) - (int64_t)Cal->D * (x[0] + x[1] + x[2]) - (int64_t)Cal->E * (y[0] + y[1] + y[2]), 3);
+	
+	/* Return OK */
+	return TM_TOUCH_Result_Ok;
+}
+
+void TM_TOUCH_SetCalibration(TM_TOUCH_t* TS, const TM_TOUCH_Calibration_t* Cal) {
+	uint32_t irq;
+	
+	/* Disable interrupts, calibration is used in interrupt mode read */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Set calibration and transform for current orientation */
+	if (Cal != NULL) {
+		TouchCal = *Cal;
+		TM_TOUCH_INT_UpdateMatrix(TS);
+		TouchCalEnabled = 1;
+	} else {
+		TouchCalEnabled = 0;
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+#ifdef TOUCH_USE_FLASHKV
+TM_TOUCH_Result_t TM_TOUCH_CalibrationLoad(TM_TOUCH_t* TS) {
+	TM_TOUCH_Calibration_t Cal;
+	uint16_t length;
+	
+	/* Read saved calibration */
+	if (TM_FLASHKV_Read(TOUCH_CALIBRATION_KEY, &Cal, sizeof(Cal), &length) != TM_FLASHKV_Result_Ok || length != sizeof(Cal)) {
+		return TM_TOUCH_Result_Error;
+	}
+	
+	/* Use calibration */
+	TM_TOUCH_SetCalibration(TS, &Cal);
+	
+	/* Return OK */
+	return TM_TOUCH_Result_Ok;
+}
+
+TM_TOUCH_Result_t TM_TOUCH_CalibrationSave(const TM_TOUCH_Calibration_t* Cal) {
+	/* Write to flash, unchanged value does not use flash */
+	if (TM_FLASHKV_Write(TOUCH_CALIBRATION_KEY, Cal, sizeof(TM_TOUCH_Calibration_t)) != TM_FLASHKV_Result_Ok) {
+		return TM_TOUCH_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_TOUCH_Result_Ok;
+}
+#endif
+
+__weak void TM_TOUCH_EventCallback(TM_TOUCH_t* TS) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_TOUCH_EventCallback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static void TM_TOUCH_INT_Rotate(TM_TOUCH_t* TS) {
+	uint8_t i;
+	uint16_t tmp;
+	int32_t x, y;
+	
+	/* Calibration and orientation in one transform */
+	if (TouchCalEnabled) {
+		/* Orientation was changed by user */
+		if (TS->Orientation != TouchMatrixOrientation) {
+			TM_TOUCH_INT_UpdateMatrix(TS);
+		}
+		
+		/* Transform all X and Y values, 64-bit products are single instruction on Cortex-M3/M4/M7 */
+		for (i = 0; i < TS->NumPresses && i < 10; i++) {
+			x = (int32_t)(((int64_t)TouchMatrix.A * TS->X[i] + (int64_t)TouchMatrix.B * TS->Y[i] + TouchMatrix.C) >> 16);
+			y = (int32_t)(((int64_t)TouchMatrix.D * TS->X[i] + (int64_t)TouchMatrix.E * TS->Y[i] + TouchMatrix.F) >> 16);
+			
+			/* Limit to LCD area, points near edges can be outside after calibration */
+			TS->X[i] = x < 0 ? 0 : (x > TouchMatrixMaxX ? TouchMatrixMaxX : x);
+			TS->Y[i] = y < 0 ? 0 : (y > TouchMatrixMaxY ? TouchMatrixMaxY : y);
+		}
+		return;
+	}
+	
 	/* Check for orientations */
 	if (TS->Orientation == 0) {
 		/* Rotate all X and Y values */
@@ -105,7 +385,207 @@ uint8_t TM_TOUCH_Read(TM_TOUCH_t* TS) {
 			TS->Y[i] = TS->MaxX - tmp;
 		}
 	}
+}
+
+static void TM_TOUCH_INT_UpdateMatrix(TM_TOUCH_t* TS) {
+	const TM_TOUCH_Calibration_t* c = &TouchCal;
+	TM_TOUCH_Calibration_t* m = &TouchMatrix;
 	
-	/* Return OK */
-	return 0;
+	/* Merge orientation transform after calibration, the same as in rotate function */
+	if (TS->Orientation == 0) {
+		/* X = MaxX - x, Y = MaxY - y */
+		m->A = -c->A;
+		m->B = -c->B;
+		m->C = ((int32_t)TS->MaxX << 16) - c->C;
+		m->D = -c->D;
+		m->E = -c->E;
+		m->F = ((int32_t)TS->MaxY << 16) - c->F;
+	} else if (TS->Orientation == 2) {
+		/* X = MaxY - y, Y = x */
+		m->A = -c->D;
+		m->B = -c->E;
+		m->C = ((int32_t)TS->MaxY << 16) - c->F;
+		m->D = c->A;
+		m->E = c->B;
+		m->F = c->C;
+	} else if (TS->Orientation == 3) {
+		/* X = y, Y = MaxX - x */
+		m->A = c->D;
+		m->B = c->E;
+		m->C = c->F;
+		m->D = -c->A;
+		m->E = -c->B;
+		m->F = ((int32_t)TS->MaxX << 16) - c->C;
+	} else {
+		/* Native orientation */
+		*m = *c;
+	}
+	
+	/* Add rounding to offsets once */
+	m->C += 0x8000;
+	m->F += 0x8000;
+	
+	/* Limits, X and Y are swapped in orientations 2 and 3 */
+	if (TS->Orientation == 2 || TS->Orientation == 3) {
+		TouchMatrixMaxX = TS->MaxY;
+		TouchMatrixMaxY = TS->MaxX;
+	} else {
+		TouchMatrixMaxX = TS->MaxX;
+		TouchMatrixMaxY = TS->MaxY;
+	}
+	
+	/* Transform is valid for this orientation */
+	TouchMatrixOrientation = TS->Orientation;
+}
+
+static void TM_TOUCH_INT_ToNative(TM_TOUCH_t* TS, const TM_TOUCH_Point_t* Point, int32_t* x, int32_t* y) {
+	/* Inverse of orientation transform */
+	if (TS->Orientation == 0) {
+		*x = TS->MaxX - Point->X;
+		*y = TS->MaxY - Point->Y;
+	} else if (TS->Orientation == 2) {
+		*x = Point->Y;
+		*y = TS->MaxY - Point->X;
+	} else if (TS->Orientation == 3) {
+		*x = TS->MaxX - Point->Y;
+		*y = Point->X;
+	} else {
+		*x = Point->X;
+		*y = Point->Y;
+	}
+}
+
+static int32_t TM_TOUCH_INT_Div(int64_t n, int64_t d) {
+	/* Positive divider */
+	if (d < 0) {
+		n = -n;
+		d = -d;
+	}
+	
+	/* Round to nearest */
+	if (n >= 0) {
+		return (int32_t)((n + d / 2) / d);
+	}
+	return -(int32_t)((-n + d / 2) / d);
+}
+
+static void TM_TOUCH_INT_Process(TM_TOUCH_t* TS, uint32_t time) {
+	uint8_t i, j, added = 0, count;
+	
+	/* Limit number of touches */
+	count = TS->NumPresses > 10 ? 10 : TS->NumPresses;
+	
+	/* Touches from previous read which are not present anymore are released */
+	for (j = 0; j < TouchLastCount; j++) {
+		for (i = 0; i < count && TS->Id[i] != TouchLastId[j]; i++);
+		if (i == count) {
+			added |= TM_TOUCH_INT_AddEvent(TM_TOUCH_EventType_Release, TouchLastId[j], TouchLastX[j], TouchLastY[j], time);
+		}
+	}
+	
+	/* New touches are pressed, others are moved when position has changed */
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < TouchLastCount && TouchLastId[j] != TS->Id[i]; j++);
+		if (j == TouchLastCount) {
+			added |= TM_TOUCH_INT_AddEvent(TM_TOUCH_EventType_Press, TS->Id[i], TS->X[i], TS->Y[i], time);
+		} else if (TouchLastX[j] != TS->X[i] || TouchLastY[j] != TS->Y[i]) {
+			added |= TM_TOUCH_INT_AddEvent(TM_TOUCH_EventType_Move, TS->Id[i], TS->X[i], TS->Y[i], time);
+		}
+	}
+	
+	/* Save touches for next read */
+	for (i = 0; i < count; i++) {
+		TouchLastId[i] = TS->Id[i];
+		TouchLastX[i] = TS->X[i];
+		TouchLastY[i] = TS->Y[i];
+	}
+	TouchLastCount = count;
+	
+	/* Call user function */
+	if (added) {
+		TM_TOUCH_EventCallback(TS);
+	}
+}
+
+static uint8_t TM_TOUCH_INT_AddEvent(TM_TOUCH_EventType_t type, uint8_t id, uint16_t x, uint16_t y, uint32_t time) {
+	uint16_t in = TouchEventsIn, next, i;
+	
+	/* Move is merged with last unread event of the same touch when it is also move */
+	if (type == TM_TOUCH_EventType_Move) {
+		i = in;
+		while (i != TouchEventsOut) {
+			i = (i - 1) & (TOUCH_EVENT_QUEUE_SIZE - 1);
+			if (TouchEvents[i].Id == id) {
+				if (TouchEvents[i].Type == TM_TOUCH_EventType_Move) {
+					TouchEvents[i].X = x;
+					TouchEvents[i].Y = y;
+					TouchEvents[i].Time = time;
+					return 1;
+				}
+				break;
+			}
+		}
+	}
+	
+	/* Check for free space */
+	next = (in + 1) & (TOUCH_EVENT_QUEUE_SIZE - 1);
+	if (next == TouchEventsOut) {
+		TouchEventsLostCount++;
+		return 0;
+	}
+	
+	/* Save event */
+	TouchEvents[in].Time = time;
+	TouchEvents[in].X = x;
+	TouchEvents[in].Y = y;
+	TouchEvents[in].Id = id;
+	TouchEvents[in].Type = type;
+	TouchEventsIn = next;
+	
+	/* Event added */
+	return 1;
+}
+
+static void TM_TOUCH_INT_StartRead(TM_TOUCH_t* TS) {
+	uint8_t i;
+	
+	/* Save time of interrupt */
+	TouchTime = HAL_GetTick();
+	
+	/* Drivers without touch IDs keep index as ID */
+	for (i = 0; i < 10; i++) {
+		TS->Id[i] = i;
+	}
+	
+	/* Start read, done function is called from I2C interrupt */
+	if (TouchDriver.ReadAsync(TS)) {
+		TouchBusy = 0;
+	}
+}
+
+static void TM_TOUCH_INT_EXTICallback(uint16_t GPIO_Pin, void* Param) {
+	uint32_t irq;
+	uint8_t start = 0;
+	
+	/* Disable interrupts, I2C interrupt can finish read meanwhile */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Start read or mark for another read when one is in progress */
+	if (TouchBusy) {
+		TouchAgain = 1;
+	} else {
+		TouchBusy = 1;
+		start = 1;
+	}
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Read all touches */
+	if (start) {
+		TM_TOUCH_INT_StartRead((TM_TOUCH_t *)Param);
+	}
 }
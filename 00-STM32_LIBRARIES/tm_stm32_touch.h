@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-23-touch-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   Touch library for all touch screen controllers
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_TOUCH_H
-#define TM_TOUCH_H 100
+#define TM_TOUCH_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -129,6 +129,87 @@ int main() {
     }
   }
 }
+\endcode
+ *
+ * \par Interrupt mode
+ *
+ * Instead of polling with @ref TM_TOUCH_Read, touch controller INT pin can be used.
+ * On falling edge of INT pin, all touches are read with queued I2C transaction, without blocking main loop.
+ * I2C is used only when controller has new data.
+ *
+ * Each read is compared with previous one and press, move and release events are saved to event queue,
+ * together with time of INT pin interrupt. Move events of the same touch, which were not read yet, are merged
+ * into one event with last position, so queue does not overflow when main loop is slow.
+ *
+ * @note  Interrupt mode needs I2C transaction queue, set I2C_QUEUE_SIZE in defines.h file.
+ *        Touch structure is updated from interrupt
+ *
+\code
+//In defines.h
+#define I2C_QUEUE_SIZE    4
+
+//In main.c, STM32F7-Discovery has FT5336 INT pin on PI13
+TM_TOUCH_Init(NULL, &TS);
+TM_TOUCH_InitInterrupt(&TS, GPIOI, GPIO_PIN_13);
+
+while (1) {
+	TM_TOUCH_Event_t Event;
+	
+	//Process all touch events
+	while (TM_TOUCH_GetEvents(&Event, 1)) {
+		if (Event.Type == TM_TOUCH_EventType_Press) {
+			//Touch with Event.Id pressed at Event.X, Event.Y
+		}
+	}
+}
+\endcode
+ *
+ * \par Calibration
+ *
+ * Resistive and some capacitive panels need calibration to match LCD pixels.
+ * Library uses 3-point affine calibration, which corrects offset, scale, rotation and skew between touch and LCD.
+ *
+ * Calibration is calculated once from 3 points. In read path it is applied in Q16 fixed point format,
+ * merged with orientation transform into one matrix, so each touch needs only integer multiply and add, no float math.
+ *
+ * Calibration is saved in native orientation, so @ref TM_TOUCH_t.Orientation can be changed later.
+ *
+\code
+TM_TOUCH_Calibration_t Cal;
+TM_TOUCH_Point_t Display[3] = {{30, 30}, {450, 136}, {240, 240}};
+TM_TOUCH_Point_t Touch[3];
+
+//Load calibration from flash, needs TOUCH_USE_FLASHKV define
+if (TM_TOUCH_CalibrationLoad(&TS) != TM_TOUCH_Result_Ok) {
+	//Disable calibration, values are not calibrated
+	TM_TOUCH_SetCalibration(&TS, NULL);
+	
+	for (i = 0; i < 3; i++) {
+		//Draw cross at Display[i] and wait for touch
+		//...
+		
+		//Save touch
+		Touch[i].X = TS.X[0];
+		Touch[i].Y = TS.Y[0];
+	}
+	
+	//Calculate, use and save calibration
+	if (TM_TOUCH_CalibrationCalculate(&TS, Display, Touch, &Cal) == TM_TOUCH_Result_Ok) {
+		TM_TOUCH_SetCalibration(&TS, &Cal);
+		TM_TOUCH_CalibrationSave(&Cal);
+	}
+}
+\endcode
+ *
+ * @note  Flash storage uses @ref TM_FLASHKV library, which is not available on STM32F0xx.
+ *        There, save @ref TM_TOUCH_Calibration_t structure somewhere else and set it with @ref TM_TOUCH_SetCalibration.
+ *
+\code
+//Enable calibration load and save with TM FLASHKV library
+#define TOUCH_USE_FLASHKV
+
+//Key for calibration in flash key-value store
+#define TOUCH_CALIBRATION_KEY    0x5443
 \endcode
  *
  * \par Changelog
@@ -136,6 +217,16 @@ int main() {
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added interrupt mode with INT pin, queued I2C reads and touch event queue
+  - Added touch IDs to @ref TM_TOUCH_t structure
+  
+ Version 1.2
+  - October 14, 2026
+  - Added 3-point affine calibration in fixed point, merged with orientation transform
+  - Added calibration load and save with TM FLASHKV library
 \endverbatim
  *
  * \par Dependencies
@@ -147,18 +238,38 @@ int main() {
  - TM TOUCH FT5336
  - TM I2C
  - TM GPIO
+ - TM EXTI
+ - TM FLASHKV, optional
 \endverbatim
  */
 
 #include "stm32fxxx_hal.h"
 #include "defines.h"
+#include "tm_stm32_exti.h"
+#ifdef TOUCH_USE_FLASHKV
+#include "tm_stm32_flashkv.h"
+#endif
 
 /**
  * @defgroup TM_TOUCH_Macros
  * @brief    Library defines
  * @{
  */
-/* Macros here */
+
+/* Number of events in touch event queue for interrupt mode, must be power of 2 */
+#ifndef TOUCH_EVENT_QUEUE_SIZE
+#define TOUCH_EVENT_QUEUE_SIZE    16
+#endif
+
+#if TOUCH_EVENT_QUEUE_SIZE & (TOUCH_EVENT_QUEUE_SIZE - 1)
+#error "TOUCH_EVENT_QUEUE_SIZE must be power of 2!"
+#endif
+
+/* Key for calibration in flash key-value store */
+#ifndef TOUCH_CALIBRATION_KEY
+#define TOUCH_CALIBRATION_KEY     0x5443
+#endif
+
 /**
  * @}
  */
@@ -180,16 +291,62 @@ typedef struct {
 	uint8_t Orientation;  /*!< Touch orientation to match LCD orientation if needed */
 	uint16_t MaxX;        /*!< Touch MAX X value. Maximal value for touch X coordinate */
 	uint16_t MaxY;        /*!< Touch MAX Y value. Maximal value for touch Y coordinate */
+	uint8_t Id[10];       /*!< Touch IDs from controller, set to index by library when controller does not have them */
 } TM_TOUCH_t;
 
 /**
  * @brief  TOUCH Driver structure
  */
 typedef struct {
-	uint8_t (*Init)(TM_TOUCH_t*); /*!< Pointer to init function for touch controller */
-	uint8_t (*Read)(TM_TOUCH_t*); /*!< Pointer to read function for touch controller */
+	uint8_t (*Init)(TM_TOUCH_t*);      /*!< Pointer to init function for touch controller */
+	uint8_t (*Read)(TM_TOUCH_t*);      /*!< Pointer to read function for touch controller */
+	uint8_t (*ReadAsync)(TM_TOUCH_t*); /*!< Pointer to function which starts read without blocking, returns 0 when started.
+	                                        Driver must call @ref TM_TOUCH_ReadAsyncDone when done. Set to NULL if not supported */
 } TM_TOUCH_DRIVER_t;
 
+/**
+ * @brief  Touch event type enumeration
+ */
+typedef enum {
+	TM_TOUCH_EventType_Press = 0x00, /*!< New touch detected */
+	TM_TOUCH_EventType_Move,         /*!< Touch moved to new position */
+	TM_TOUCH_EventType_Release       /*!< Touch released, position is last known position */
+} TM_TOUCH_EventType_t;
+
+/**
+ * @brief  Touch event in event queue
+ */
+typedef struct {
+	uint32_t Time;             /*!< HAL tick when INT pin interrupt occurred, or when @ref TM_TOUCH_Read was called */
+	uint16_t X;                /*!< X position of touch */
+	uint16_t Y;                /*!< Y position of touch */
+	uint8_t Id;                /*!< Touch ID */
+	TM_TOUCH_EventType_t Type; /*!< Event type */
+} TM_TOUCH_Event_t;
+
+/**
+ * @brief  Point for calibration
+ */
+typedef struct {
+	uint16_t X;                /*!< X position */
+	uint16_t Y;                /*!< Y position */
+} TM_TOUCH_Point_t;
+
+/**
+ * @brief  Touch calibration, affine transform in Q16 fixed point format
+ * @note   Transform is from raw controller values to LCD pixels in native orientation:
+ *            - X = (A * x + B * y + C) / 65536
+ *            - Y = (D * x + E * y + F) / 65536
+ */
+typedef struct {
+	int32_t A;                 /*!< X output, coefficient for raw X */
+	int32_t B;                 /*!< X output, coefficient for raw Y */
+	int32_t C;                 /*!< X output, offset */
+	int32_t D;                 /*!< Y output, coefficient for raw X */
+	int32_t E;                 /*!< Y output, coefficient for raw Y */
+	int32_t F;                 /*!< Y output, offset */
+} TM_TOUCH_Calibration_t;
+
 /**
  * @brief  TOUCH result enumeration
  */
@@ -218,6 +375,8 @@ TM_TOUCH_Result_t TM_TOUCH_Init(TM_TOUCH_DRIVER_t* Driver, TM_TOUCH_t* TS);
 
 /**
  * @brief  Reads touch data from sensor 
+ * @note   Read touches are also compared with previous read and events are added to event queue
+ * @note   In interrupt mode, function does not read sensor as structure is already updated from interrupt
  * @param  *TouchData: Poiter to @ref TM_TOUCH_t structure where data will be stored
  * @retval Touch status:
  *            - 0: OK
@@ -225,6 +384,95 @@ TM_TOUCH_Result_t TM_TOUCH_Init(TM_TOUCH_DRIVER_t* Driver, TM_TOUCH_t* TS);
  */
 uint8_t TM_TOUCH_Read(TM_TOUCH_t* TouchData);
 
+/**
+ * @brief  Enables interrupt mode with touch controller INT pin
+ * @note   Touch must be initialized first with @ref TM_TOUCH_Init and driver must support reads without blocking
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure, updated from interrupt
+ * @param  *GPIOx: GPIO port of controller INT pin
+ * @param  GPIO_Pin: GPIO pin of controller INT pin, active low
+ * @retval Member of @ref TM_TOUCH_Result_t enumeration
+ */
+TM_TOUCH_Result_t TM_TOUCH_InitInterrupt(TM_TOUCH_t* TS, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+
+/**
+ * @brief  Disables interrupt mode
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure
+ * @retval None
+ */
+void TM_TOUCH_DeInitInterrupt(TM_TOUCH_t* TS);
+
+/**
+ * @brief  Reads events from touch event queue
+ * @param  *Events: Pointer to array to save events
+ * @param  count: Maximal number of events to read
+ * @retval Number of read events
+ */
+uint16_t TM_TOUCH_GetEvents(TM_TOUCH_Event_t* Events, uint16_t count);
+
+/**
+ * @brief  Gets number of events lost because event queue was full
+ * @param  None
+ * @retval Number of lost events
+ */
+uint32_t TM_TOUCH_EventsLost(void);
+
+/**
+ * @brief  Called by low level driver when read started with ReadAsync function is finished
+ * @note   Called from interrupt, for low level drivers only
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure with new touches
+ * @param  status: Read status, 0 when OK
+ * @retval None
+ */
+void TM_TOUCH_ReadAsyncDone(TM_TOUCH_t* TS, uint8_t status);
+
+/**
+ * @brief  Calculates calibration from 3 points
+ * @note   Points must not be on one line, use points far from each other, for example near 3 corners of LCD
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure with orientation used for points
+ * @param  *Display: Pointer to 3 points on LCD, in current orientation
+ * @param  *Touch: Pointer to 3 touch points, read with @ref TM_TOUCH_Read when calibration was disabled
+ * @param  *Cal: Pointer to @ref TM_TOUCH_Calibration_t structure to save calibration
+ * @retval Member of @ref TM_TOUCH_Result_t enumeration
+ */
+TM_TOUCH_Result_t TM_TOUCH_CalibrationCalculate(TM_TOUCH_t* TS, const TM_TOUCH_Point_t* Display, const TM_TOUCH_Point_t* Touch, TM_TOUCH_Calibration_t* Cal);
+
+/**
+ * @brief  Sets calibration used for all next reads
+ * @note   Transform with orientation is calculated here and again only when orientation changes
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure
+ * @param  *Cal: Pointer to @ref TM_TOUCH_Calibration_t structure, copied. Set to NULL to disable calibration
+ * @retval None
+ */
+void TM_TOUCH_SetCalibration(TM_TOUCH_t* TS, const TM_TOUCH_Calibration_t* Cal);
+
+#if defined(TOUCH_USE_FLASHKV) || defined(DOXYGEN)
+/**
+ * @brief  Loads calibration from flash key-value store and sets it
+ * @note   @ref TM_FLASHKV_Init must be called first
+ * @note   Available when TOUCH_USE_FLASHKV is defined
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure
+ * @retval Member of @ref TM_TOUCH_Result_t enumeration, error when calibration is not saved
+ */
+TM_TOUCH_Result_t TM_TOUCH_CalibrationLoad(TM_TOUCH_t* TS);
+
+/**
+ * @brief  Saves calibration to flash key-value store with TOUCH_CALIBRATION_KEY key
+ * @note   Available when TOUCH_USE_FLASHKV is defined
+ * @param  *Cal: Pointer to @ref TM_TOUCH_Calibration_t structure to save
+ * @retval Member of @ref TM_TOUCH_Result_t enumeration
+ */
+TM_TOUCH_Result_t TM_TOUCH_CalibrationSave(const TM_TOUCH_Calibration_t* Cal);
+#endif
+
+/**
+ * @brief  Called when new events are added to event queue
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @note   In interrupt mode it is called from interrupt
+ * @param  *TS: Pointer to @ref TM_TOUCH_t structure
+ * @retval None
+ */
+void TM_TOUCH_EventCallback(TM_TOUCH_t* TS);
+
 /**
  * @}
  */
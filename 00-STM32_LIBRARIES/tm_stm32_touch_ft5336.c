@@ -28,9 +28,20 @@
 /* Status register */
 #define FT5336_STATUS_REG        0x02
 
+/* Interrupt mode register, 1 = INT pin pulses on each new sample while touched */
+#define FT5336_GMODE_REG         0xA4
+
 /* Start locations for reading pressed touches */
 static uint8_t FT5336_DataRegs[] = {0x03, 0x09, 0x0F, 0x15, 0x1B};
 
+#if I2C_QUEUE_SIZE > 0
+/* Status register and all 5 touches, 6 bytes each, read in one transaction */
+static uint8_t FT5336_Data[1 + 5 * 6];
+
+/* Private functions */
+static void TM_TOUCH_FT5336_INT_ReadDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+#endif
+
 /* Delay function */
 static void FT_Delay(__IO uint32_t d) {
 	while (d--);
@@ -64,6 +75,9 @@ uint8_t TM_TOUCH_FT5336_Init(TM_TOUCH_t* TS) {
 		return 2;
 	}
 	
+	/* INT pin in trigger mode, active for each new sample, used in interrupt mode */
+	TM_I2C_Write(TOUCH_FT5336_I2C, TOUCH_FT5336_I2C_DEV, FT5336_GMODE_REG, 0x01);
+	
 	/* Return 0 = OK */
 	return 0;
 }
@@ -96,11 +110,59 @@ uint8_t TM_TOUCH_FT5336_Read(TM_TOUCH_t* TS) {
 		/* Read 4 bytes in a row */
 		TM_I2C_ReadMulti(TOUCH_FT5336_I2C, TOUCH_FT5336_I2C_DEV, FT5336_DataRegs[i], DataRead, 4);
 		
-		/* Format touches */
+		/* Format touches, touch ID is in upper 4 bits */
 		TS->Y[i] = (DataRead[1]) | ((DataRead[0] & 0x0F) << 8);
 		TS->X[i] = (DataRead[3]) | ((DataRead[2] & 0x0F) << 8);
+		TS->Id[i] = DataRead[2] >> 4;
 	}
 	
 	/* Return OK */
 	return 0;
 }
+
+#if I2C_QUEUE_SIZE > 0
+uint8_t TM_TOUCH_FT5336_ReadAsync(TM_TOUCH_t* TS) {
+	/* Read status and all touches */
+	if (TM_I2C_ReadMultiQueued(TOUCH_FT5336_I2C, TOUCH_FT5336_I2C_DEV, FT5336_STATUS_REG, FT5336_Data, sizeof(FT5336_Data), TM_TOUCH_FT5336_INT_ReadDone, TS)) {
+		/* Read started */
+		return 0;
+	}
+	
+	/* Queue is full */
+	return 1;
+}
+
+/* Private functions */
+static void TM_TOUCH_FT5336_INT_ReadDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	TM_TOUCH_t* TS = (TM_TOUCH_t *)Param;
+	uint8_t i, status;
+	uint8_t* DataRead;
+	
+	/* Check transaction */
+	if (result != TM_I2C_Result_Ok) {
+		TM_TOUCH_ReadAsyncDone(TS, 1);
+		return;
+	}
+	
+	/* Mask status register */
+	status = data[0] & 0x0F;
+	
+	/* Check if max detected more than max number of contacts */
+	if (status > 5) {
+		TM_TOUCH_ReadAsyncDone(TS, 1);
+		return;
+	}
+	
+	/* Format touches, the same as in blocking read */
+	TS->NumPresses = status;
+	for (i = 0; i < TS->NumPresses; i++) {
+		DataRead = &data[1 + 6 * i];
+		TS->Y[i] = (DataRead[1]) | ((DataRead[0] & 0x0F) << 8);
+		TS->X[i] = (DataRead[3]) | ((DataRead[2] & 0x0F) << 8);
+		TS->Id[i] = DataRead[2] >> 4;
+	}
+	
+	/* Read is done */
+	TM_TOUCH_ReadAsyncDone(TS, 0);
+}
+#endif
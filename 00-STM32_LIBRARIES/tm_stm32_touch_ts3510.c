@@ -25,6 +25,18 @@
  */
 #include "tm_stm32_touch_ts3510.h"
 
+/* Private functions */
+static uint8_t TM_TOUCH_TS3510_INT_Parse(TM_TOUCH_t* TS, uint8_t* DataReceive);
+
+#if I2C_QUEUE_SIZE > 0
+/* Command and received data for queued read */
+static uint8_t TS3510_DataSend[] = {0x81, 0x08};
+static uint8_t TS3510_DataReceive[11];
+
+/* Private functions */
+static void TM_TOUCH_TS3510_INT_ReadDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param);
+#endif
+
 uint8_t TM_TOUCH_TS3510_Init(TM_TOUCH_t* TS) {
 	/* Init I2C */
 	TM_I2C_Init(TOUCH_TS3510_I2C, TOUCH_TS3510_I2C_PP, 100000);
@@ -40,7 +52,6 @@ uint8_t TM_TOUCH_TS3510_Init(TM_TOUCH_t* TS) {
 uint8_t TM_TOUCH_TS3510_Read(TM_TOUCH_t* TS) {
 	uint8_t DataSend[] = {0x81, 0x08};
 	uint8_t DataReceive[11];
-	uint16_t X1, Y1, X2, Y2;
 	
 	/* Read data */
 	TM_I2C_WriteReadRepeatedStart(
@@ -54,6 +65,30 @@ uint8_t TM_TOUCH_TS3510_Read(TM_TOUCH_t* TS) {
 		11
 	);
 	
+	/* Format data */
+	return TM_TOUCH_TS3510_INT_Parse(TS, DataReceive);
+}
+
+#if I2C_QUEUE_SIZE > 0
+uint8_t TM_TOUCH_TS3510_ReadAsync(TM_TOUCH_t* TS) {
+	/* Command write and data read, repeated start is replaced with stop and start */
+	if (
+		TM_I2C_WriteMultiQueued(TOUCH_TS3510_I2C, TOUCH_TS3510_I2C_DEV, 0x00, TS3510_DataSend, 2, NULL, NULL) &&
+		TM_I2C_ReadMultiQueued(TOUCH_TS3510_I2C, TOUCH_TS3510_I2C_DEV, 0x8A, TS3510_DataReceive, 11, TM_TOUCH_TS3510_INT_ReadDone, TS)
+	) {
+		/* Read started */
+		return 0;
+	}
+	
+	/* Queue is full */
+	return 1;
+}
+#endif
+
+/* Private functions */
+static uint8_t TM_TOUCH_TS3510_INT_Parse(TM_TOUCH_t* TS, uint8_t* DataReceive) {
+	uint16_t X1, Y1, X2, Y2;
+	
 	/* Format data */
 	X1 = DataReceive[1] << 8 | DataReceive[2];
 	Y1 = DataReceive[3] << 8 | DataReceive[4];
@@ -82,3 +117,14 @@ uint8_t TM_TOUCH_TS3510_Read(TM_TOUCH_t* TS) {
 	/* Everything OK */
 	return 0;
 }
+
+#if I2C_QUEUE_SIZE > 0
+static void TM_TOUCH_TS3510_INT_ReadDone(I2C_TypeDef* I2Cx, uint8_t device_address, uint8_t* data, uint16_t count, TM_I2C_Result_t result, void* Param) {
+	/* Format data and finish read */
+	if (result == TM_I2C_Result_Ok) {
+		TM_TOUCH_ReadAsyncDone((TM_TOUCH_t *)Param, TM_TOUCH_TS3510_INT_Parse((TM_TOUCH_t *)Param, data));
+	} else {
+		TM_TOUCH_ReadAsyncDone((TM_TOUCH_t *)Param, 1);
+	}
+}
+#endif
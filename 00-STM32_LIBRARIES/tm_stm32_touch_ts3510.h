@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-23-touch-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   TS3510 low level library
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_TOUCH_TS3510_H
-#define TM_TOUCH_TS3510_H 100
+#define TM_TOUCH_TS3510_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -74,6 +74,10 @@ extern "C" {
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added read without blocking for interrupt mode of @ref TM_TOUCH library, needs I2C_QUEUE_SIZE
 \endverbatim
  *
  * \par Dependencies
@@ -144,6 +148,16 @@ uint8_t TM_TOUCH_TS3510_Init(TM_TOUCH_t* TS);
  */
 uint8_t TM_TOUCH_TS3510_Read(TM_TOUCH_t* TS);
 
+/**
+ * @brief  Starts read of touches from TS3510 with queued I2C transactions
+ * @note   Available when I2C_QUEUE_SIZE is greater than 0. @ref TM_TOUCH_ReadAsyncDone is called when done
+ * @param  *TS: Pointer to @ref TM_TOUCH_t to save data into
+ * @retval Touch status:
+ *            - 0: Read started
+ *            - > 0: Error, I2C queue is full
+ */
+uint8_t TM_TOUCH_TS3510_ReadAsync(TM_TOUCH_t* TS);
+
 /**
  * @}
  */
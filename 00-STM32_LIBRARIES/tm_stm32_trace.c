@@ -0,0 +1,250 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_trace.h"
+
+/* ITM lock access key */
+#define TRACE_ITM_UNLOCK           0xC5ACCE55
+
+/* Maximal number of loops to wait for ITM FIFO in blocking writes */
+#define TRACE_WAIT_LOOPS           10000
+
+/* Ports and statistics */
+uint32_t TM_TRACE_Ports = 0;
+volatile uint32_t TM_TRACE_Dropped = 0;
+
+/* Zones table */
+static const char* TRACE_Zones[TRACE_MAX_ZONES];
+static uint16_t TRACE_ZonesCount = 0;
+
+/* Private functions */
+static uint8_t TM_TRACE_INT_Wait(uint8_t port);
+static void TM_TRACE_INT_SendName(uint16_t id);
+
+uint8_t TM_TRACE_Init(uint32_t SWOFrequency) {
+	/* Enable DWT counter, enables trace too */
+	if (!TM_GENERAL_DWTCounterEnable()) {
+		return 0;
+	}
+	
+	/* Configure TPIU for NRZ output */
+	if (SWOFrequency) {
+		DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+		TPI->SPPR = 0x02;
+		TPI->ACPR = HAL_RCC_GetHCLKFreq() / SWOFrequency - 1;
+		TPI->FFCR = TPI_FFCR_TrigIn_Msk;
+	}
+	
+	/* Unlock and enable ITM with timestamps and DWT packets */
+	ITM->LAR = TRACE_ITM_UNLOCK;
+	ITM->TCR = 0;
+	ITM->TPR = 0;
+	ITM->TCR = (1UL << ITM_TCR_TraceBusID_Pos) | ITM_TCR_DWTENA_Msk | ITM_TCR_SYNCENA_Msk | ITM_TCR_TSENA_Msk | ITM_TCR_ITMENA_Msk;
+	
+	/* Synchronization packets on CYCCNT bit 26 */
+	DWT->CTRL = (DWT->CTRL & ~DWT_CTRL_SYNCTAP_Msk) | (0x02UL << DWT_CTRL_SYNCTAP_Pos);
+	
+	/* Exception trace */
+#if TRACE_EXCEPTION_TRACE
+	DWT->CTRL |= DWT_CTRL_EXCTRCENA_Msk;
+#else
+	DWT->CTRL &= ~DWT_CTRL_EXCTRCENA_Msk;
+#endif
+	
+	/* PC sampling */
+	TM_TRACE_SetPCSampling(TRACE_PC_SAMPLING);
+	
+	/* Enable library ports */
+	TM_TRACE_EnablePorts(TRACE_PORTS_ALL);
+	
+	/* Return OK */
+	return 1;
+}
+
+void TM_TRACE_EnablePorts(uint32_t Mask) {
+	uint32_t irq;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Enable in ITM and in local mask */
+	ITM->TER |= Mask;
+	TM_TRACE_Ports |= Mask;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_TRACE_DisablePorts(uint32_t Mask) {
+	uint32_t irq;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Disable in local mask and in ITM */
+	TM_TRACE_Ports &= ~Mask;
+	ITM->TER &= ~Mask;
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+}
+
+void TM_TRACE_SetPCSampling(uint8_t Enable) {
+	uint32_t ctrl;
+	
+	/* Stop sampling first */
+	ctrl = DWT->CTRL & ~(DWT_CTRL_PCSAMPLENA_Msk | DWT_CTRL_CYCTAP_Msk | DWT_CTRL_POSTPRESET_Msk | DWT_CTRL_POSTINIT_Msk);
+	DWT->CTRL = ctrl;
+	
+	if (Enable) {
+		/* Set counter reload and start value, then enable */
+		ctrl |= ((uint32_t)TRACE_PC_SAMPLE_PRESET << DWT_CTRL_POSTPRESET_Pos) | ((uint32_t)TRACE_PC_SAMPLE_PRESET << DWT_CTRL_POSTINIT_Pos);
+		if (TRACE_PC_SAMPLE_TAP) {
+			ctrl |= DWT_CTRL_CYCTAP_Msk;
+		}
+		DWT->CTRL = ctrl;
+		DWT->CTRL = ctrl | DWT_CTRL_PCSAMPLENA_Msk;
+	}
+}
+
+uint16_t TM_TRACE_GetZone(const char* name) {
+	uint16_t id = TRACE_ZONE_NONE;
+	uint32_t irq;
+	uint16_t i;
+	
+	/* Get interrupt status */
+	irq = __get_PRIMASK();
+
+	/* Disable interrupts */
+	__disable_irq();
+	
+	/* Check if zone already exists */
+	for (i = 0; i < TRACE_ZonesCount; i++) {
+		if (strcmp(TRACE_Zones[i], name) == 0) {
+			id = i;
+			break;
+		}
+	}
+	
+	/* Register new zone and send its name */
+	if (id == TRACE_ZONE_NONE && TRACE_ZonesCount < TRACE_MAX_ZONES) {
+		id = TRACE_ZonesCount++;
+		TRACE_Zones[id] = name;
+		TM_TRACE_INT_SendName(id);
+	}
+	
+	/* Enable IRQ if necessary */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Return zone ID */
+	return id;
+}
+
+void TM_TRACE_SendNames(void) {
+	uint32_t irq;
+	uint16_t i;
+	
+	for (i = 0; i < TRACE_ZonesCount; i++) {
+		/* Get interrupt status */
+		irq = __get_PRIMASK();
+
+		/* Disable interrupts, name must not be interleaved */
+		__disable_irq();
+		
+		/* Send name */
+		TM_TRACE_INT_SendName(i);
+		
+		/* Enable IRQ if necessary */
+		if (!irq) {
+			__enable_irq();
+		}
+	}
+}
+
+void TM_TRACE_Puts(char* str) {
+	/* Check port */
+	if (!(TM_TRACE_Ports & (1UL << TRACE_PORT_TEXT))) {
+		return;
+	}
+	
+	/* Send all characters */
+	while (*str) {
+		if (!TM_TRACE_INT_Wait(TRACE_PORT_TEXT)) {
+			return;
+		}
+		ITM->PORT[TRACE_PORT_TEXT].u8 = *str++;
+	}
+}
+
+/* Private functions */
+static uint8_t TM_TRACE_INT_Wait(uint8_t port) {
+	uint32_t i = TRACE_WAIT_LOOPS;
+	
+	/* Wait for free FIFO, SWO may not be clocked when debugger is not connected */
+	while (ITM->PORT[port].u32 == 0) {
+		if (--i == 0) {
+			TM_TRACE_Dropped++;
+			return 0;
+		}
+	}
+	
+	/* Return OK */
+	return 1;
+}
+
+static void TM_TRACE_INT_SendName(uint16_t id) {
+	const char* name = TRACE_Zones[id];
+	
+	/* Check port */
+	if (!(TM_TRACE_Ports & (1UL << TRACE_PORT_NAME))) {
+		return;
+	}
+	
+	/* Name record */
+	if (!TM_TRACE_INT_Wait(TRACE_PORT_NAME)) {
+		return;
+	}
+	ITM->PORT[TRACE_PORT_NAME].u32 = TRACE_RECORD(TRACE_TYPE_NAME, id);
+	
+	/* Characters with trailing zero */
+	do {
+		if (!TM_TRACE_INT_Wait(TRACE_PORT_NAME)) {
+			return;
+		}
+		ITM->PORT[TRACE_PORT_NAME].u8 = *name;
+	} while (*name++);
+}
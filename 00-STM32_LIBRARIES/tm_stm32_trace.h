@@ -0,0 +1,460 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   ITM SWO binary event trace for STM32Fxxx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_TRACE_H
+#define TM_TRACE_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_TRACE
+ * @brief    ITM SWO binary event trace for STM32Fxxx
+ * @{
+ *
+ * Library sends binary event records over ITM stimulus ports to SWO pin, without any string formatting.
+ * One event is one 32-bit write to ITM port, which takes only a few CPU cycles,
+ * so tracing can stay enabled in time critical code. ITM adds hardware timestamps to records.
+ *
+ * \par Stimulus ports
+ *
+ * Each event type has its own stimulus port, so host can filter them:
+ *  - @ref TRACE_PORT_TEXT: Text output with @ref TM_TRACE_Puts, same as printf over SWO
+ *  - @ref TRACE_PORT_ISR: Interrupt entry and exit, with @ref TM_TRACE_ISR_ENTER and @ref TM_TRACE_ISR_EXIT
+ *  - @ref TRACE_PORT_DRIVER: Driver events, with @ref TM_TRACE_Driver
+ *  - @ref TRACE_PORT_MARKER: User markers, with @ref TM_TRACE_Marker
+ *  - @ref TRACE_PORT_ZONE: Zone begin and end, with @ref TM_TRACE_ZONE_BEGIN and @ref TM_TRACE_ZONE_END
+ *  - @ref TRACE_PORT_NAME: Zone names, sent once when zone is registered and with @ref TM_TRACE_SendNames
+ *
+ * \par Record format
+ *
+ * All records are 32-bit words, upper 8 bits are record type or ID:
+ *  - ISR: 0x01 = entry, 0x02 = exit, lower bits are exception number (IRQn + 16)
+ *  - Zone: 0x03 = begin, 0x04 = end, lower bits are zone ID
+ *  - Name: 0x05, lower bits are zone ID, followed by name characters as 8-bit writes and 0 at the end
+ *  - Driver: bits 31:24 = driver ID, bits 23:16 = event, bits 15:0 = argument
+ *  - Marker: bits 31:24 = marker ID, bits 23:0 = value
+ *
+ * Records are not blocking. If ITM FIFO of port is full, record is dropped and counted, see @ref TM_TRACE_GetDropped.
+ *
+ * \par Zones
+ *
+ * Zone macros are used the same way as @ref TM_PROFILE zones, so changing prefix selects profiler or trace backend.
+ * Begin and end are sent as records, durations are calculated by host from timestamps.
+ * Text output function can also be used with @ref TM_PROFILE_Dump function.
+ *
+\code
+//Trace zone, same as TM_PROFILE_ZONE_BEGIN and TM_PROFILE_ZONE_END
+TM_TRACE_ZONE_BEGIN("I2C read");
+TM_I2C_ReadMulti(I2C1, 0xD0, 0x3B, data, 14);
+TM_TRACE_ZONE_END();
+
+//Interrupt
+void DMA2_Stream0_IRQHandler(void) {
+	TM_TRACE_ISR_ENTER();
+	HAL_DMA_IRQHandler(&hdma);
+	TM_TRACE_ISR_EXIT();
+}
+
+//Marker with ID 1 and ADC value
+TM_TRACE_Marker(1, adc_value);
+
+//Profiler results over SWO text port
+TM_PROFILE_Dump(TM_TRACE_Puts);
+\endcode
+ *
+ * \par PC sampling
+ *
+ * When enabled, DWT sends periodic PC samples to SWO every (TRACE_PC_SAMPLE_PRESET + 1) * 64 or * 1024 cycles,
+ * depending on TRACE_PC_SAMPLE_TAP. Host can build statistical profile of whole application from them.
+ *
+ * \par SWO output
+ *
+ * If SWO frequency is given to @ref TM_TRACE_Init, library configures TPIU for NRZ (UART) output.
+ * Use 0 if debugger configures TPIU itself. Trace pin is PB3 on STM32F4xx and STM32F7xx.
+ *
+ * \par Configuration
+ *
+\code
+//Disable trace, all macros and inline functions are then empty
+#define TRACE_ENABLED             0
+//Maximal number of registered zones
+#define TRACE_MAX_ZONES           32
+//Enable DWT PC sampling
+#define TRACE_PC_SAMPLING         1
+//PC sampling period, (PRESET + 1) * (TAP ? 1024 : 64) cycles
+#define TRACE_PC_SAMPLE_PRESET    15
+#define TRACE_PC_SAMPLE_TAP       1
+//Enable hardware exception trace, bandwidth heavy
+#define TRACE_EXCEPTION_TRACE     0
+\endcode
+ *
+ * @note   Library is not supported on STM32F0xx series, because Cortex-M0 does not have ITM
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM GENERAL
+ - string.h
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_general.h"
+#include "string.h"
+
+/* Check for ITM */
+#if defined(STM32F0xx)
+#error "Trace library is not supported on STM32F0xx devices!"
+#endif
+
+/**
+ * @defgroup TM_TRACE_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/**
+ * @brief  Trace enable, set to 0 to remove all records
+ */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED             1
+#endif
+
+/**
+ * @brief  Maximal number of registered zones
+ */
+#ifndef TRACE_MAX_ZONES
+#define TRACE_MAX_ZONES           32
+#endif
+
+/**
+ * @brief  DWT PC sampling enable
+ */
+#ifndef TRACE_PC_SAMPLING
+#define TRACE_PC_SAMPLING         1
+#endif
+
+/**
+ * @brief  PC sampling counter reload value, 0 to 15
+ */
+#ifndef TRACE_PC_SAMPLE_PRESET
+#define TRACE_PC_SAMPLE_PRESET    15
+#endif
+
+/**
+ * @brief  PC sampling counter tap, 0 = every 64 cycles, 1 = every 1024 cycles
+ */
+#ifndef TRACE_PC_SAMPLE_TAP
+#define TRACE_PC_SAMPLE_TAP       1
+#endif
+
+/**
+ * @brief  Hardware exception trace enable
+ * @note   Each exception entry, exit and return generates packet, which needs high SWO frequency
+ */
+#ifndef TRACE_EXCEPTION_TRACE
+#define TRACE_EXCEPTION_TRACE     0
+#endif
+
+/* Check PC sampling settings */
+#if TRACE_PC_SAMPLE_PRESET > 15
+#error "TRACE_PC_SAMPLE_PRESET must be between 0 and 15!"
+#endif
+
+/**
+ * @brief  Stimulus ports for records
+ */
+#define TRACE_PORT_TEXT           0 /*!< Text output */
+#define TRACE_PORT_ISR            1 /*!< Interrupt entry and exit */
+#define TRACE_PORT_DRIVER         2 /*!< Driver events */
+#define TRACE_PORT_MARKER         3 /*!< User markers */
+#define TRACE_PORT_ZONE           4 /*!< Zone begin and end */
+#define TRACE_PORT_NAME           5 /*!< Zone names */
+
+/**
+ * @brief  Mask of all ports used by library
+ */
+#define TRACE_PORTS_ALL           0x0000003F
+
+/**
+ * @brief  Record types in upper 8 bits of ISR, zone and name records
+ */
+#define TRACE_TYPE_ISR_ENTER      0x01 /*!< Interrupt entry */
+#define TRACE_TYPE_ISR_EXIT       0x02 /*!< Interrupt exit */
+#define TRACE_TYPE_ZONE_BEGIN     0x03 /*!< Zone begin */
+#define TRACE_TYPE_ZONE_END       0x04 /*!< Zone end */
+#define TRACE_TYPE_NAME           0x05 /*!< Zone name */
+
+/**
+ * @brief  Zone ID when zone table is full
+ */
+#define TRACE_ZONE_NONE           0xFFFF
+
+/**
+ * @brief  Creates record from type or ID and 24-bit value
+ */
+#define TRACE_RECORD(type, value) (((uint32_t)(type) << 24) | ((uint32_t)(value) & 0x00FFFFFF))
+
+#if TRACE_ENABLED || defined(DOXYGEN)
+/**
+ * @brief  Records interrupt entry, must be called in interrupt handler
+ * @note   Exception number is read from IPSR register
+ * @param  None
+ * @retval None
+ */
+#define TM_TRACE_ISR_ENTER()          TM_TRACE_Write(TRACE_PORT_ISR, TRACE_RECORD(TRACE_TYPE_ISR_ENTER, __get_IPSR()))
+
+/**
+ * @brief  Records interrupt exit, must be called in interrupt handler
+ * @param  None
+ * @retval None
+ */
+#define TM_TRACE_ISR_EXIT()           TM_TRACE_Write(TRACE_PORT_ISR, TRACE_RECORD(TRACE_TYPE_ISR_EXIT, __get_IPSR()))
+
+/**
+ * @brief  Starts traced zone
+ * @note   Zone is registered and its name sent on first execution
+ * @param  name: Zone name, string literal
+ * @retval None
+ */
+#define TM_TRACE_ZONE_BEGIN(name)     {                                          \
+	static uint16_t TM_TRACE_ZoneId = TRACE_ZONE_NONE;                           \
+	if (TM_TRACE_ZoneId == TRACE_ZONE_NONE) {                                    \
+		TM_TRACE_ZoneId = TM_TRACE_GetZone(name);                                \
+	}                                                                            \
+	TM_TRACE_Write(TRACE_PORT_ZONE, TRACE_RECORD(TRACE_TYPE_ZONE_BEGIN, TM_TRACE_ZoneId))
+
+/**
+ * @brief  Ends traced zone started with @ref TM_TRACE_ZONE_BEGIN
+ * @param  None
+ * @retval None
+ */
+#define TM_TRACE_ZONE_END()                                                      \
+	TM_TRACE_Write(TRACE_PORT_ZONE, TRACE_RECORD(TRACE_TYPE_ZONE_END, TM_TRACE_ZoneId)); \
+	}
+#else
+#define TM_TRACE_ISR_ENTER()
+#define TM_TRACE_ISR_EXIT()
+#define TM_TRACE_ZONE_BEGIN(name)     {
+#define TM_TRACE_ZONE_END()           }
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_TRACE_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Driver IDs for driver event records
+ */
+typedef enum {
+	TM_TRACE_Driver_USART = 0x01, /*!< USART driver */
+	TM_TRACE_Driver_SPI,          /*!< SPI driver */
+	TM_TRACE_Driver_I2C,          /*!< I2C driver */
+	TM_TRACE_Driver_DMA,          /*!< DMA driver */
+	TM_TRACE_Driver_ADC,          /*!< ADC driver */
+	TM_TRACE_Driver_CAN,          /*!< CAN driver */
+	TM_TRACE_Driver_USB,          /*!< USB driver */
+	TM_TRACE_Driver_ETH,          /*!< Ethernet driver */
+	TM_TRACE_Driver_SDCARD,       /*!< SD card driver */
+	TM_TRACE_Driver_User = 0x80   /*!< First ID for user drivers */
+} TM_TRACE_Driver_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_TRACE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Mask of enabled ports, used by inline functions
+ * @note   Do not change directly, use @ref TM_TRACE_EnablePorts
+ */
+extern uint32_t TM_TRACE_Ports;
+
+/**
+ * @brief  Number of dropped records because ITM FIFO was full
+ */
+extern volatile uint32_t TM_TRACE_Dropped;
+
+/**
+ * @brief  Initializes ITM, DWT and optionally TPIU for SWO output and enables all library ports
+ * @param  SWOFrequency: SWO output frequency in Hz. Use 0 when debugger configures TPIU
+ * @retval Trace status:
+ *            - 0: DWT has not started, hardware/software reset is required
+ *            - > 0: Trace is ready to use
+ */
+uint8_t TM_TRACE_Init(uint32_t SWOFrequency);
+
+/**
+ * @brief  Enables stimulus ports
+ * @param  Mask: Bit mask of ports to enable, bit 0 is port 0
+ * @retval None
+ */
+void TM_TRACE_EnablePorts(uint32_t Mask);
+
+/**
+ * @brief  Disables stimulus ports, records on disabled ports cost only one compare
+ * @param  Mask: Bit mask of ports to disable, bit 0 is port 0
+ * @retval None
+ */
+void TM_TRACE_DisablePorts(uint32_t Mask);
+
+/**
+ * @brief  Enables or disables DWT PC sampling
+ * @param  Enable: Set to 1 to enable or 0 to disable PC sampling
+ * @retval None
+ */
+void TM_TRACE_SetPCSampling(uint8_t Enable);
+
+/**
+ * @brief  Gets zone ID by name, registers new zone and sends its name if it does not exist
+ * @note   Used by @ref TM_TRACE_ZONE_BEGIN macro
+ * @param  *name: Zone name
+ * @retval Zone ID or @ref TRACE_ZONE_NONE if table is full
+ */
+uint16_t TM_TRACE_GetZone(const char* name);
+
+/**
+ * @brief  Sends names of all registered zones again, useful when host started capture late
+ * @param  None
+ * @retval None
+ */
+void TM_TRACE_SendNames(void);
+
+/**
+ * @brief  Outputs string over @ref TRACE_PORT_TEXT port
+ * @note   This function waits for ITM FIFO and can be used as output function for @ref TM_PROFILE_Dump
+ * @param  *str: String to output
+ * @retval None
+ */
+void TM_TRACE_Puts(char* str);
+
+/**
+ * @brief  Gets number of dropped records
+ * @param  None
+ * @retval Number of dropped records
+ */
+#define TM_TRACE_GetDropped()         (TM_TRACE_Dropped)
+
+/**
+ * @brief  Writes 32-bit record to stimulus port, record is dropped if port FIFO is full
+ * @note   Record can be lost if interrupt with trace writes to the same port between FIFO check and write
+ * @param  port: Stimulus port, 0 to 31
+ * @param  value: 32-bit record
+ * @retval None
+ */
+static __INLINE void TM_TRACE_Write(uint8_t port, uint32_t value) {
+#if TRACE_ENABLED
+	/* Check if port is enabled */
+	if (TM_TRACE_Ports & (1UL << port)) {
+		/* Port reads as 1 when FIFO can accept data */
+		if (ITM->PORT[port].u32) {
+			ITM->PORT[port].u32 = value;
+		} else {
+			TM_TRACE_Dropped++;
+		}
+	}
+#endif
+}
+
+/**
+ * @brief  Records driver event
+ * @param  Driver: Driver ID. This parameter can be a value of @ref TM_TRACE_Driver_t enumeration or user ID
+ * @param  Event: Driver specific event, 0 to 255
+ * @param  Arg: Event argument, for example length or status
+ * @retval None
+ */
+static __INLINE void TM_TRACE_Driver(uint8_t Driver, uint8_t Event, uint16_t Arg) {
+	TM_TRACE_Write(TRACE_PORT_DRIVER, ((uint32_t)Driver << 24) | ((uint32_t)Event << 16) | Arg);
+}
+
+/**
+ * @brief  Records user marker
+ * @param  Id: Marker ID, 0 to 255
+ * @param  Value: Marker value, only lower 24 bits are sent
+ * @retval None
+ */
+static __INLINE void TM_TRACE_Marker(uint8_t Id, uint32_t Value) {
+	TM_TRACE_Write(TRACE_PORT_MARKER, TRACE_RECORD(Id, Value));
+}
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
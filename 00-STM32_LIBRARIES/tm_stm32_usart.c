@@ -18,6 +18,52 @@
  */
 #include "tm_stm32_usart.h"
 
+/* Only U(S)ARTs enabled in defines.h are compiled in, all available U(S)ARTs when none is enabled */
+#if defined(TM_USART1_ENABLED) || defined(TM_USART2_ENABLED) || defined(TM_USART3_ENABLED) || defined(TM_UART4_ENABLED) || \
+	defined(TM_UART5_ENABLED) || defined(TM_USART6_ENABLED) || defined(TM_UART7_ENABLED) || defined(TM_UART8_ENABLED) || \
+	defined(TM_USART4_ENABLED) || defined(TM_USART5_ENABLED) || defined(TM_USART7_ENABLED) || defined(TM_USART8_ENABLED)
+#define USART_INT_SELECTED             1
+#else
+#define USART_INT_SELECTED             0
+#endif
+
+#if defined(USART1) && (!USART_INT_SELECTED || defined(TM_USART1_ENABLED))
+#define USART_INT_USE_USART1
+#endif
+#if defined(USART2) && (!USART_INT_SELECTED || defined(TM_USART2_ENABLED))
+#define USART_INT_USE_USART2
+#endif
+#if defined(USART3) && (!USART_INT_SELECTED || defined(TM_USART3_ENABLED))
+#define USART_INT_USE_USART3
+#endif
+#if defined(UART4) && (!USART_INT_SELECTED || defined(TM_UART4_ENABLED))
+#define USART_INT_USE_UART4
+#endif
+#if defined(UART5) && (!USART_INT_SELECTED || defined(TM_UART5_ENABLED))
+#define USART_INT_USE_UART5
+#endif
+#if defined(USART6) && (!USART_INT_SELECTED || defined(TM_USART6_ENABLED))
+#define USART_INT_USE_USART6
+#endif
+#if defined(UART7) && (!USART_INT_SELECTED || defined(TM_UART7_ENABLED))
+#define USART_INT_USE_UART7
+#endif
+#if defined(UART8) && (!USART_INT_SELECTED || defined(TM_UART8_ENABLED))
+#define USART_INT_USE_UART8
+#endif
+#if defined(USART4) && (!USART_INT_SELECTED || defined(TM_USART4_ENABLED))
+#define USART_INT_USE_USART4
+#endif
+#if defined(USART5) && (!USART_INT_SELECTED || defined(TM_USART5_ENABLED))
+#define USART_INT_USE_USART5
+#endif
+#if defined(USART7) && (!USART_INT_SELECTED || defined(TM_USART7_ENABLED))
+#define USART_INT_USE_USART7
+#endif
+#if defined(USART8) && (!USART_INT_SELECTED || defined(TM_USART8_ENABLED))
+#define USART_INT_USE_USART8
+#endif
+
 /* Set alternate function mappings */
 #if defined(STM32F4xx) || defined(STM32F7xx)
 
@@ -130,84 +176,88 @@
 #endif
 
 /* Set variables for buffers */
-#ifdef USART1
+#ifdef USART_INT_USE_USART1
 uint8_t USART1_Buffer[TM_USART1_BUFFER_SIZE];
 #endif
-#ifdef USART2
+#ifdef USART_INT_USE_USART2
 uint8_t USART2_Buffer[TM_USART2_BUFFER_SIZE];
 #endif
-#ifdef USART3
+#ifdef USART_INT_USE_USART3
 uint8_t USART3_Buffer[TM_USART3_BUFFER_SIZE];
 #endif
-#ifdef UART4
+#ifdef USART_INT_USE_UART4
 uint8_t UART4_Buffer[TM_UART4_BUFFER_SIZE];
 #endif
-#ifdef UART5
+#ifdef USART_INT_USE_UART5
 uint8_t UART5_Buffer[TM_UART5_BUFFER_SIZE];
 #endif
-#ifdef USART6
+#ifdef USART_INT_USE_USART6
 uint8_t USART6_Buffer[TM_USART6_BUFFER_SIZE];
 #endif
-#ifdef UART7
+#ifdef USART_INT_USE_UART7
 uint8_t UART7_Buffer[TM_UART7_BUFFER_SIZE];
 #endif
-#ifdef UART8
+#ifdef USART_INT_USE_UART8
 uint8_t UART8_Buffer[TM_UART8_BUFFER_SIZE];
 #endif
 
 /* STM32F0xx added */
-#ifdef USART4
+#ifdef USART_INT_USE_USART4
 uint8_t USART4_Buffer[TM_USART4_BUFFER_SIZE];
 #endif
-#ifdef USART5
+#ifdef USART_INT_USE_USART5
 uint8_t USART5_Buffer[TM_USART5_BUFFER_SIZE];
 #endif
-#ifdef USART7
+#ifdef USART_INT_USE_USART7
 uint8_t USART7_Buffer[TM_USART7_BUFFER_SIZE];
 #endif
-#ifdef USART8
+#ifdef USART_INT_USE_USART8
 uint8_t USART8_Buffer[TM_USART8_BUFFER_SIZE];
 #endif
 
-#ifdef USART1
-TM_BUFFER_t TM_USART1 = {TM_USART1_BUFFER_SIZE, 0, 0, USART1_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART1
+TM_BUFFER_t TM_USART1 = {TM_USART1_BUFFER_SIZE, 0, 0, USART1_Buffer, BUFFER_SIZE_FLAGS(TM_USART1_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef USART2
-TM_BUFFER_t TM_USART2 = {TM_USART2_BUFFER_SIZE, 0, 0, USART2_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART2
+TM_BUFFER_t TM_USART2 = {TM_USART2_BUFFER_SIZE, 0, 0, USART2_Buffer, BUFFER_SIZE_FLAGS(TM_USART2_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef USART3
-TM_BUFFER_t TM_USART3 = {TM_USART3_BUFFER_SIZE, 0, 0, USART3_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART3
+TM_BUFFER_t TM_USART3 = {TM_USART3_BUFFER_SIZE, 0, 0, USART3_Buffer, BUFFER_SIZE_FLAGS(TM_USART3_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef UART4
-TM_BUFFER_t TM_UART4 = {TM_UART4_BUFFER_SIZE, 0, 0, UART4_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_UART4
+TM_BUFFER_t TM_UART4 = {TM_UART4_BUFFER_SIZE, 0, 0, UART4_Buffer, BUFFER_SIZE_FLAGS(TM_UART4_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef UART5
-TM_BUFFER_t TM_UART5 = {TM_UART5_BUFFER_SIZE, 0, 0, UART5_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_UART5
+TM_BUFFER_t TM_UART5 = {TM_UART5_BUFFER_SIZE, 0, 0, UART5_Buffer, BUFFER_SIZE_FLAGS(TM_UART5_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef USART6
-TM_BUFFER_t TM_USART6 = {TM_USART6_BUFFER_SIZE, 0, 0, USART6_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART6
+TM_BUFFER_t TM_USART6 = {TM_USART6_BUFFER_SIZE, 0, 0, USART6_Buffer, BUFFER_SIZE_FLAGS(TM_USART6_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef UART7
-TM_BUFFER_t TM_UART7 = {TM_UART7_BUFFER_SIZE, 0, 0, UART7_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_UART7
+TM_BUFFER_t TM_UART7 = {TM_UART7_BUFFER_SIZE, 0, 0, UART7_Buffer, BUFFER_SIZE_FLAGS(TM_UART7_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef UART8
-TM_BUFFER_t TM_UART8 = {TM_UART8_BUFFER_SIZE, 0, 0, UART8_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_UART8
+TM_BUFFER_t TM_UART8 = {TM_UART8_BUFFER_SIZE, 0, 0, UART8_Buffer, BUFFER_SIZE_FLAGS(TM_UART8_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
 
 /* STM32F0xx added */
-#ifdef USART4
-TM_BUFFER_t TM_USART4 = {TM_USART8_BUFFER_SIZE, 0, 0, USART4_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART4
+TM_BUFFER_t TM_USART4 = {TM_USART4_BUFFER_SIZE, 0, 0, USART4_Buffer, BUFFER_SIZE_FLAGS(TM_USART4_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef USART5
-TM_BUFFER_t TM_USART5 = {TM_USART5_BUFFER_SIZE, 0, 0, USART5_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART5
+TM_BUFFER_t TM_USART5 = {TM_USART5_BUFFER_SIZE, 0, 0, USART5_Buffer, BUFFER_SIZE_FLAGS(TM_USART5_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef USART7
-TM_BUFFER_t TM_USART7 = {TM_USART7_BUFFER_SIZE, 0, 0, USART7_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART7
+TM_BUFFER_t TM_USART7 = {TM_USART7_BUFFER_SIZE, 0, 0, USART7_Buffer, BUFFER_SIZE_FLAGS(TM_USART7_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
-#ifdef USART8
-TM_BUFFER_t TM_USART8 = {TM_USART8_BUFFER_SIZE, 0, 0, USART8_Buffer, 0, USART_STRING_DELIMITER};
+#ifdef USART_INT_USE_USART8
+TM_BUFFER_t TM_USART8 = {TM_USART8_BUFFER_SIZE, 0, 0, USART8_Buffer, BUFFER_SIZE_FLAGS(TM_USART8_BUFFER_SIZE), USART_STRING_DELIMITER};
 #endif
 
+/* Search state for last string used in TM_USART_FindString */
+static TM_BUFFER_Search_t USART_Search;
+static USART_TypeDef* USART_SearchUSART;
+
 /* Private functions */
 void TM_USART1_InitPins(TM_USART_PinsPack_t pinspack);
 void TM_USART2_InitPins(TM_USART_PinsPack_t pinspack);
@@ -217,159 +267,254 @@ void TM_UART5_InitPins(TM_USART_PinsPack_t pinspack);
 void TM_USART6_InitPins(TM_USART_PinsPack_t pinspack);
 void TM_UART7_InitPins(TM_USART_PinsPack_t pinspack);
 void TM_UART8_InitPins(TM_USART_PinsPack_t pinspack);
-static void TM_USART_INT_InsertToBuffer(TM_BUFFER_t* u, uint8_t c);
+#ifdef USART_INT_USE_USART4
+void TM_USART4_InitPins(TM_USART_PinsPack_t pinspack);
+#endif
+#ifdef USART_INT_USE_USART5
+void TM_USART5_InitPins(TM_USART_PinsPack_t pinspack);
+#endif
+#ifdef USART_INT_USE_USART7
+void TM_USART7_InitPins(TM_USART_PinsPack_t pinspack);
+#endif
+#ifdef USART_INT_USE_USART8
+void TM_USART8_InitPins(TM_USART_PinsPack_t pinspack);
+#endif
+__ramfunc static void TM_USART_INT_InsertToBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* u, uint8_t c);
+static void TM_USART_INT_WriteToTXBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* tx, uint8_t* DataArray, uint16_t count);
 static void TM_USART_INT_ClearAllFlags(USART_TypeDef* USARTx, IRQn_Type irq);
-static TM_BUFFER_t* TM_USART_INT_GetUSARTBuffer(USART_TypeDef* USARTx);
-static uint8_t TM_USART_INT_GetSubPriority(USART_TypeDef* USARTx);
+static __INLINE void TM_USART_INT_Events(USART_TypeDef* USARTx);
 uint8_t TM_USART_BufferFull(USART_TypeDef* USARTx);
 
-/* Private initializator function */
-static void TM_USART_INT_Init(
-	USART_TypeDef* USARTx,
-	TM_USART_PinsPack_t pinspack,
-	uint32_t baudrate,
-	TM_USART_HardwareFlowControl_t FlowControl,
-	uint32_t Mode,
-	uint32_t Parity,
-	uint32_t StopBits,
-	uint32_t WordLength
-);
+/* USART index in config table, only available instances are included */
+typedef enum {
+#ifdef USART_INT_USE_USART1
+	USART_INT_USART1,
+#endif
+#ifdef USART_INT_USE_USART2
+	USART_INT_USART2,
+#endif
+#ifdef USART_INT_USE_USART3
+	USART_INT_USART3,
+#endif
+#ifdef USART_INT_USE_UART4
+	USART_INT_UART4,
+#endif
+#ifdef USART_INT_USE_UART5
+	USART_INT_UART5,
+#endif
+#ifdef USART_INT_USE_USART6
+	USART_INT_USART6,
+#endif
+#ifdef USART_INT_USE_UART7
+	USART_INT_UART7,
+#endif
+#ifdef USART_INT_USE_UART8
+	USART_INT_UART8,
+#endif
 
-void TM_USART_Init(USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, uint32_t baudrate) {
-#ifdef USART1
-	if (USARTx == USART1) {
-		TM_USART_INT_Init(USART1, pinspack, baudrate, TM_USART1_HARDWARE_FLOW_CONTROL, TM_USART1_MODE, TM_USART1_PARITY, TM_USART1_STOP_BITS, TM_USART1_WORD_LENGTH);
-	}
+/* STM32F0xx added */
+#ifdef USART_INT_USE_USART4
+	USART_INT_USART4,
+#endif
+#ifdef USART_INT_USE_USART5
+	USART_INT_USART5,
+#endif
+#ifdef USART_INT_USE_USART7
+	USART_INT_USART7,
+#endif
+#ifdef USART_INT_USE_USART8
+	USART_INT_USART8,
+#endif
+	USART_INT_COUNT
+} TM_USART_INT_Index_t;
+
+/* Constant settings for each U(S)ART */
+typedef struct {
+	USART_TypeDef* USARTx;                           /* Pointer to USART instance */
+#if STATS_ENABLED
+	const char* Name;                                /* Name for statistics */
+#endif
+	TM_BUFFER_t* Buffer;                             /* Pointer to receive buffer */
+	void (*InitPins)(TM_USART_PinsPack_t pinspack);  /* Function for pins initialization */
+	uint32_t RCC_Mask;                               /* Clock enable bit, reset bit is on the same position in RSTR register */
+	uint8_t APB2;                                    /* Set to 1 when USART is on APB2 bus, 0 for APB1 */
+	uint8_t SubPriority;                             /* NVIC subpriority */
+	IRQn_Type IRQ;                                   /* NVIC IRQ channel */
+	uint32_t FlowControl;                            /* Default hardware flow control */
+	uint32_t Mode;                                   /* Default mode */
+	uint32_t Parity;                                 /* Default parity */
+	uint32_t StopBits;                               /* Default stop bits */
+	uint32_t WordLength;                             /* Default word length */
+} TM_USART_INT_Config_t;
+
+/* Name is included only with statistics */
+#if STATS_ENABLED
+#define USART_INT_NAME(x)              #x,
+#else
+#define USART_INT_NAME(x)
 #endif
-#ifdef USART2
-	if (USARTx == USART2) {
-		TM_USART_INT_Init(USART2, pinspack, baudrate, TM_USART2_HARDWARE_FLOW_CONTROL, TM_USART2_MODE, TM_USART2_PARITY, TM_USART2_STOP_BITS, TM_USART2_WORD_LENGTH);
-	}
+
+static const TM_USART_INT_Config_t USART_Config[USART_INT_COUNT] = {
+#ifdef USART_INT_USE_USART1
+	[USART_INT_USART1] = {USART1, USART_INT_NAME(USART1) &TM_USART1, TM_USART1_InitPins, RCC_APB2ENR_USART1EN, 1, 0, IRQ_USART1,
+		TM_USART1_HARDWARE_FLOW_CONTROL, TM_USART1_MODE, TM_USART1_PARITY, TM_USART1_STOP_BITS, TM_USART1_WORD_LENGTH},
 #endif
-#ifdef USART3
-	if (USARTx == USART3) {
-		TM_USART_INT_Init(USART3, pinspack, baudrate, TM_USART3_HARDWARE_FLOW_CONTROL, TM_USART3_MODE, TM_USART3_PARITY, TM_USART3_STOP_BITS, TM_USART3_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART2
+	[USART_INT_USART2] = {USART2, USART_INT_NAME(USART2) &TM_USART2, TM_USART2_InitPins, RCC_APB1ENR_USART2EN, 0, 1, IRQ_USART2,
+		TM_USART2_HARDWARE_FLOW_CONTROL, TM_USART2_MODE, TM_USART2_PARITY, TM_USART2_STOP_BITS, TM_USART2_WORD_LENGTH},
 #endif
-#ifdef UART4
-	if (USARTx == UART4) {
-		TM_USART_INT_Init(UART4, pinspack, baudrate, TM_UART4_HARDWARE_FLOW_CONTROL, TM_UART4_MODE, TM_UART4_PARITY, TM_UART4_STOP_BITS, TM_UART4_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART3
+	[USART_INT_USART3] = {USART3, USART_INT_NAME(USART3) &TM_USART3, TM_USART3_InitPins, RCC_APB1ENR_USART3EN, 0, 2, IRQ_USART3,
+		TM_USART3_HARDWARE_FLOW_CONTROL, TM_USART3_MODE, TM_USART3_PARITY, TM_USART3_STOP_BITS, TM_USART3_WORD_LENGTH},
 #endif
-#ifdef UART5
-	if (USARTx == UART5) {
-		TM_USART_INT_Init(UART5, pinspack, baudrate, TM_UART5_HARDWARE_FLOW_CONTROL, TM_UART5_MODE, TM_UART5_PARITY, TM_UART5_STOP_BITS, TM_UART5_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_UART4
+	[USART_INT_UART4] = {UART4, USART_INT_NAME(UART4) &TM_UART4, TM_UART4_InitPins, RCC_APB1ENR_UART4EN, 0, 4, IRQ_UART4,
+		TM_UART4_HARDWARE_FLOW_CONTROL, TM_UART4_MODE, TM_UART4_PARITY, TM_UART4_STOP_BITS, TM_UART4_WORD_LENGTH},
 #endif
-#ifdef USART6
-	if (USARTx == USART6) {
-		TM_USART_INT_Init(USART6, pinspack, baudrate, TM_USART6_HARDWARE_FLOW_CONTROL, TM_USART6_MODE, TM_USART6_PARITY, TM_USART6_STOP_BITS, TM_USART6_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_UART5
+	[USART_INT_UART5] = {UART5, USART_INT_NAME(UART5) &TM_UART5, TM_UART5_InitPins, RCC_APB1ENR_UART5EN, 0, 5, IRQ_UART5,
+		TM_UART5_HARDWARE_FLOW_CONTROL, TM_UART5_MODE, TM_UART5_PARITY, TM_UART5_STOP_BITS, TM_UART5_WORD_LENGTH},
 #endif
-#ifdef UART7
-	if (USARTx == UART7) {
-		TM_USART_INT_Init(UART7, pinspack, baudrate, TM_UART7_HARDWARE_FLOW_CONTROL, TM_UART7_MODE, TM_UART7_PARITY, TM_UART7_STOP_BITS, TM_UART7_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART6
+	[USART_INT_USART6] = {USART6, USART_INT_NAME(USART6) &TM_USART6, TM_USART6_InitPins, RCC_APB2ENR_USART6EN, 1, 6, IRQ_USART6,
+		TM_USART6_HARDWARE_FLOW_CONTROL, TM_USART6_MODE, TM_USART6_PARITY, TM_USART6_STOP_BITS, TM_USART6_WORD_LENGTH},
 #endif
-#ifdef UART8
-	if (USARTx == UART8) {
-		TM_USART_INT_Init(UART8, pinspack, baudrate, TM_UART8_HARDWARE_FLOW_CONTROL, TM_UART8_MODE, TM_UART8_PARITY, TM_UART8_STOP_BITS, TM_UART8_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_UART7
+	[USART_INT_UART7] = {UART7, USART_INT_NAME(UART7) &TM_UART7, TM_UART7_InitPins, RCC_APB1ENR_UART7EN, 0, 7, IRQ_UART7,
+		TM_UART7_HARDWARE_FLOW_CONTROL, TM_UART7_MODE, TM_UART7_PARITY, TM_UART7_STOP_BITS, TM_UART7_WORD_LENGTH},
 #endif
-	
-/* STM32F0xx related */
-#ifdef USART4
-	if (USARTx == USART4) {
-		TM_USART_INT_Init(USART4, pinspack, baudrate, TM_USART4_HARDWARE_FLOW_CONTROL, TM_USART4_MODE, TM_USART4_PARITY, TM_USART4_STOP_BITS, TM_USART4_WORD_LENGTH);
-	}
-#endif	
-#ifdef USART5
-	if (USARTx == USART5) {
-		TM_USART_INT_Init(USART5, pinspack, baudrate, TM_USART5_HARDWARE_FLOW_CONTROL, TM_USART5_MODE, TM_USART5_PARITY, TM_USART5_STOP_BITS, TM_USART5_WORD_LENGTH);
-	}
-#endif	
-#ifdef USART7
-	if (USARTx == USART7) {
-		TM_USART_INT_Init(USART7, pinspack, baudrate, TM_USART7_HARDWARE_FLOW_CONTROL, TM_USART7_MODE, TM_USART7_PARITY, TM_USART7_STOP_BITS, TM_USART7_WORD_LENGTH);
-	}
-#endif	
-#ifdef USART8
-	if (USARTx == USART8) {
-		TM_USART_INT_Init(USART8, pinspack, baudrate, TM_USART8_HARDWARE_FLOW_CONTROL, TM_USART8_MODE, TM_USART8_PARITY, TM_USART8_STOP_BITS, TM_USART8_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_UART8
+	[USART_INT_UART8] = {UART8, USART_INT_NAME(UART8) &TM_UART8, TM_UART8_InitPins, RCC_APB1ENR_UART8EN, 0, 8, IRQ_UART8,
+		TM_UART8_HARDWARE_FLOW_CONTROL, TM_UART8_MODE, TM_UART8_PARITY, TM_UART8_STOP_BITS, TM_UART8_WORD_LENGTH},
 #endif
-}
 
-void TM_USART_InitWithFlowControl(USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, uint32_t baudrate, TM_USART_HardwareFlowControl_t FlowControl) {
-#ifdef USART1
-	if (USARTx == USART1) {
-		TM_USART_INT_Init(USART1, pinspack, baudrate, FlowControl, TM_USART1_MODE, TM_USART1_PARITY, TM_USART1_STOP_BITS, TM_USART1_WORD_LENGTH);
-	}
+/* STM32F0xx added */
+#ifdef USART_INT_USE_USART4
+	[USART_INT_USART4] = {USART4, USART_INT_NAME(USART4) &TM_USART4, TM_USART4_InitPins, RCC_APB1ENR_USART4EN, 0, 4, IRQ_USART4,
+		TM_USART4_HARDWARE_FLOW_CONTROL, TM_USART4_MODE, TM_USART4_PARITY, TM_USART4_STOP_BITS, TM_USART4_WORD_LENGTH},
 #endif
-#ifdef USART2
-	if (USARTx == USART2) {
-		TM_USART_INT_Init(USART2, pinspack, baudrate, FlowControl, TM_USART2_MODE, TM_USART2_PARITY, TM_USART2_STOP_BITS, TM_USART2_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART5
+	[USART_INT_USART5] = {USART5, USART_INT_NAME(USART5) &TM_USART5, TM_USART5_InitPins, RCC_APB1ENR_USART5EN, 0, 5, IRQ_USART5,
+		TM_USART5_HARDWARE_FLOW_CONTROL, TM_USART5_MODE, TM_USART5_PARITY, TM_USART5_STOP_BITS, TM_USART5_WORD_LENGTH},
 #endif
-#ifdef USART3
-	if (USARTx == USART3) {
-		TM_USART_INT_Init(USART3, pinspack, baudrate, FlowControl, TM_USART3_MODE, TM_USART3_PARITY, TM_USART3_STOP_BITS, TM_USART3_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART7
+	[USART_INT_USART7] = {USART7, USART_INT_NAME(USART7) &TM_USART7, TM_USART7_InitPins, RCC_APB2ENR_USART7EN, 1, 7, IRQ_USART7,
+		TM_USART7_HARDWARE_FLOW_CONTROL, TM_USART7_MODE, TM_USART7_PARITY, TM_USART7_STOP_BITS, TM_USART7_WORD_LENGTH},
 #endif
-#ifdef UART4
-	if (USARTx == UART4) {
-		TM_USART_INT_Init(UART4, pinspack, baudrate, FlowControl, TM_UART4_MODE, TM_UART4_PARITY, TM_UART4_STOP_BITS, TM_UART4_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART8
+	[USART_INT_USART8] = {USART8, USART_INT_NAME(USART8) &TM_USART8, TM_USART8_InitPins, RCC_APB2ENR_USART8EN, 1, 8, IRQ_USART8,
+		TM_USART8_HARDWARE_FLOW_CONTROL, TM_USART8_MODE, TM_USART8_PARITY, TM_USART8_STOP_BITS, TM_USART8_WORD_LENGTH},
 #endif
-#ifdef UART5
-	if (USARTx == UART5) {
-		TM_USART_INT_Init(UART5, pinspack, baudrate, FlowControl, TM_UART5_MODE, TM_UART5_PARITY, TM_UART5_STOP_BITS, TM_UART5_WORD_LENGTH);
-	}
+};
+
+/* 
+ * Index from USART base address, bits 14:10 are different for all U(S)ARTs on STM32F0xx, STM32F4xx and STM32F7xx
+ * Table below is resolved at compile time and gives O(1) lookup for buffer on each received byte
+ */
+#define USART_INT_ID(USARTx)           ((((uint32_t)(USARTx)) >> 10) & 0x1F)
+
+static const uint8_t USART_Index[32] = {
+#ifdef USART_INT_USE_USART1
+	[USART_INT_ID(USART1_BASE)] = USART_INT_USART1,
 #endif
-#ifdef USART6
-	if (USARTx == USART6) {
-		TM_USART_INT_Init(USART6, pinspack, baudrate, FlowControl, TM_USART6_MODE, TM_USART6_PARITY, TM_USART6_STOP_BITS, TM_USART6_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART2
+	[USART_INT_ID(USART2_BASE)] = USART_INT_USART2,
 #endif
-#ifdef UART7
-	if (USARTx == UART7) {
-		TM_USART_INT_Init(UART7, pinspack, baudrate, FlowControl, TM_UART7_MODE, TM_UART7_PARITY, TM_UART7_STOP_BITS, TM_UART7_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_USART3
+	[USART_INT_ID(USART3_BASE)] = USART_INT_USART3,
 #endif
-#ifdef UART8
-	if (USARTx == UART8) {
-		TM_USART_INT_Init(UART8, pinspack, baudrate, FlowControl, TM_UART8_MODE, TM_UART8_PARITY, TM_UART8_STOP_BITS, TM_UART8_WORD_LENGTH);
-	}
+#ifdef USART_INT_USE_UART4
+	[USART_INT_ID(UART4_BASE)] = USART_INT_UART4,
+#endif
+#ifdef USART_INT_USE_UART5
+	[USART_INT_ID(UART5_BASE)] = USART_INT_UART5,
+#endif
+#ifdef USART_INT_USE_USART6
+	[USART_INT_ID(USART6_BASE)] = USART_INT_USART6,
+#endif
+#ifdef USART_INT_USE_UART7
+	[USART_INT_ID(UART7_BASE)] = USART_INT_UART7,
+#endif
+#ifdef USART_INT_USE_UART8
+	[USART_INT_ID(UART8_BASE)] = USART_INT_UART8,
+#endif
+
+/* STM32F0xx added */
+#ifdef USART_INT_USE_USART4
+	[USART_INT_ID(USART4_BASE)] = USART_INT_USART4,
+#endif
+#ifdef USART_INT_USE_USART5
+	[USART_INT_ID(USART5_BASE)] = USART_INT_USART5,
+#endif
+#ifdef USART_INT_USE_USART7
+	[USART_INT_ID(USART7_BASE)] = USART_INT_USART7,
+#endif
+#ifdef USART_INT_USE_USART8
+	[USART_INT_ID(USART8_BASE)] = USART_INT_USART8,
+#endif
+};
+
+/* Index of USART in config table, resolved at compile time when only one U(S)ART is enabled */
+#define USART_INT_INDEX(USARTx)        (USART_INT_COUNT == 1 ? 0 : USART_Index[USART_INT_ID(USARTx)])
+
+/* Gets constant config for USART */
+#define USART_INT_GetConfig(USARTx)    (&USART_Config[USART_INT_INDEX(USARTx)])
+
+/* Baudrate set for each USART, used when clocks are changed */
+static uint32_t USART_Baudrate[USART_INT_COUNT];
+
+/* TX buffer for each USART, NULL when data are sent directly */
+static TM_BUFFER_t* USART_TXBuffer[USART_INT_COUNT];
+
+#if STATS_ENABLED
+/* Statistics for each USART */
+static TM_STATS_t USART_Stats[USART_INT_COUNT];
+
+/* Gets statistics block for USART */
+#define USART_INT_STATS(USARTx)        (&USART_Stats[USART_INT_INDEX(USARTx)])
+
+/* Receive error flags */
+#if defined(USART_ISR_ORE)
+#define USART_INT_ERROR_FLAGS          (USART_ISR_ORE | USART_ISR_FE | USART_ISR_NE | USART_ISR_PE)
+#else
+#define USART_INT_ERROR_FLAGS          (USART_SR_ORE | USART_SR_FE | USART_SR_NE | USART_SR_PE)
 #endif
-	
-/* STM32F0xx related */
-#ifdef USART4
-	if (USARTx == USART4) {
-		TM_USART_INT_Init(USART4, pinspack, baudrate, FlowControl, TM_USART4_MODE, TM_USART4_PARITY, TM_USART4_STOP_BITS, TM_USART4_WORD_LENGTH);
-	}
-#endif	
-#ifdef USART5
-	if (USARTx == USART5) {
-		TM_USART_INT_Init(USART5, pinspack, baudrate, FlowControl, TM_USART5_MODE, TM_USART5_PARITY, TM_USART5_STOP_BITS, TM_USART5_WORD_LENGTH);
-	}
-#endif	
-#ifdef USART7
-	if (USARTx == USART7) {
-		TM_USART_INT_Init(USART7, pinspack, baudrate, FlowControl, TM_USART7_MODE, TM_USART7_PARITY, TM_USART7_STOP_BITS, TM_USART7_WORD_LENGTH);
-	}
-#endif	
-#ifdef USART8
-	if (USARTx == USART8) {
-		TM_USART_INT_Init(USART8, pinspack, baudrate, FlowControl, TM_USART8_MODE, TM_USART8_PARITY, TM_USART8_STOP_BITS, TM_USART8_WORD_LENGTH);
-	}
 #endif
+
+/* Sets BRR register for baudrate, USART must be disabled on STM32F0xx and STM32F7xx */
+static void TM_USART_INT_SetBaudrate(USART_TypeDef* USARTx, const TM_USART_INT_Config_t* cfg, uint32_t baudrate);
+
+/* Private initializator function */
+static void TM_USART_INT_Init(
+	USART_TypeDef* USARTx,
+	TM_USART_PinsPack_t pinspack,
+	uint32_t baudrate,
+	TM_USART_HardwareFlowControl_t FlowControl,
+	uint32_t Mode,
+	uint32_t Parity,
+	uint32_t StopBits,
+	uint32_t WordLength
+);
+
+void TM_USART_Init(USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, uint32_t baudrate) {
+	const TM_USART_INT_Config_t* cfg = USART_INT_GetConfig(USARTx);
+	
+	/* Init with default settings for USART */
+	TM_USART_INT_Init(USARTx, pinspack, baudrate, (TM_USART_HardwareFlowControl_t)cfg->FlowControl, cfg->Mode, cfg->Parity, cfg->StopBits, cfg->WordLength);
+}
+
+void TM_USART_InitWithFlowControl(USART_TypeDef* USARTx, TM_USART_PinsPack_t pinspack, uint32_t baudrate, TM_USART_HardwareFlowControl_t FlowControl) {
+	const TM_USART_INT_Config_t* cfg = USART_INT_GetConfig(USARTx);
+	
+	/* Init with custom flow control */
+	TM_USART_INT_Init(USARTx, pinspack, baudrate, FlowControl, cfg->Mode, cfg->Parity, cfg->StopBits, cfg->WordLength);
 }
 
 uint8_t TM_USART_Getc(USART_TypeDef* USARTx) {
 	uint8_t c;
 	
 	/* Read character from buffer */
-	if (TM_BUFFER_Read(TM_USART_INT_GetUSARTBuffer(USARTx), &c, 1)) {
+	if (TM_BUFFER_ReadByte(TM_USART_GetBuffer(USARTx), &c)) {
 		return c;
 	}
 	
@@ -378,10 +523,22 @@ uint8_t TM_USART_Getc(USART_TypeDef* USARTx) {
 }
 
 uint16_t TM_USART_Gets(USART_TypeDef* USARTx, char* buffer, uint16_t bufsize) {
-	return TM_BUFFER_ReadString(TM_USART_INT_GetUSARTBuffer(USARTx), buffer, bufsize);
+	return TM_BUFFER_ReadString(TM_USART_GetBuffer(USARTx), buffer, bufsize);
 }
 
 void TM_USART_Puts(USART_TypeDef* USARTx, char* str) {
+	TM_BUFFER_t* tx = USART_TXBuffer[USART_INT_INDEX(USARTx)];
+	
+	/* Add string to TX buffer when set */
+	if (tx) {
+		TM_USART_INT_WriteToTXBuffer(USARTx, tx, (uint8_t *)str, strlen(str));
+		return;
+	}
+	
+	/* Count transfer */
+	TM_STATS_INC(USART_INT_STATS(USARTx), Transfers);
+	TM_STATS_ADD(USART_INT_STATS(USARTx), TxBytes, strlen(str));
+	
 	/* Go through entire string */
 	while (*str) {
 		/* Wait to be ready, buffer empty */
@@ -394,6 +551,18 @@ void TM_USART_Puts(USART_TypeDef* USARTx, char* str) {
 }
 
 void TM_USART_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count) {
+	TM_BUFFER_t* tx = USART_TXBuffer[USART_INT_INDEX(USARTx)];
+	
+	/* Add data to TX buffer when set */
+	if (tx) {
+		TM_USART_INT_WriteToTXBuffer(USARTx, tx, DataArray, count);
+		return;
+	}
+	
+	/* Count transfer */
+	TM_STATS_INC(USART_INT_STATS(USARTx), Transfers);
+	TM_STATS_ADD(USART_INT_STATS(USARTx), TxBytes, count);
+	
 	/* Go through entire data array */
 	while (count--) {
 		/* Wait to be ready, buffer empty */
@@ -406,31 +575,89 @@ void TM_USART_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count) {
 }
 
 int16_t TM_USART_FindCharacter(USART_TypeDef* USARTx, uint8_t c) {
-	return TM_BUFFER_FindElement(TM_USART_INT_GetUSARTBuffer(USARTx), c);
+	return TM_BUFFER_FindElement(TM_USART_GetBuffer(USARTx), c);
 }
 
 int16_t TM_USART_FindString(USART_TypeDef* USARTx, char* str) {
-	return TM_BUFFER_Find(TM_USART_INT_GetUSARTBuffer(USARTx), (uint8_t *)str, strlen(str));
+	uint32_t len = strlen(str);
+	
+	/* Prepare new search if USART or string is not the same as on last call */
+	if (USART_SearchUSART != USARTx || USART_Search.Data != (uint8_t *)str || USART_Search.Size != len) {
+		TM_BUFFER_SearchInit(&USART_Search, (uint8_t *)str, len);
+		USART_SearchUSART = USARTx;
+	}
+	
+	/* Check only data received after last call */
+	return TM_BUFFER_Search(TM_USART_GetBuffer(USARTx), &USART_Search);
 }
 
 uint8_t TM_USART_BufferEmpty(USART_TypeDef* USARTx) {
-	return TM_BUFFER_GetFull(TM_USART_INT_GetUSARTBuffer(USARTx)) == 0;
+	return TM_BUFFER_GetFull(TM_USART_GetBuffer(USARTx)) == 0;
 }
 
 uint8_t TM_USART_BufferFull(USART_TypeDef* USARTx) {
-	return TM_BUFFER_GetFree(TM_USART_INT_GetUSARTBuffer(USARTx)) == 0;
+	return TM_BUFFER_GetFree(TM_USART_GetBuffer(USARTx)) == 0;
 }
 
 uint16_t TM_USART_BufferCount(USART_TypeDef* USARTx) {
-	return TM_BUFFER_GetFull(TM_USART_INT_GetUSARTBuffer(USARTx));
+	return TM_BUFFER_GetFull(TM_USART_GetBuffer(USARTx));
 }
 
 void TM_USART_ClearBuffer(USART_TypeDef* USARTx) {
-	TM_BUFFER_Reset(TM_USART_INT_GetUSARTBuffer(USARTx));
+	TM_BUFFER_Reset(TM_USART_GetBuffer(USARTx));
+	
+	/* Search from the beginning */
+	if (USART_SearchUSART == USARTx) {
+		TM_BUFFER_SearchReset(&USART_Search);
+	}
 }
 
 void TM_USART_SetCustomStringEndCharacter(USART_TypeDef* USARTx, uint8_t Character) {
-	TM_BUFFER_SetStringDelimiter(TM_USART_INT_GetUSARTBuffer(USARTx), Character);
+	TM_BUFFER_SetStringDelimiter(TM_USART_GetBuffer(USARTx), Character);
+}
+
+void TM_USART_SetFormat(USART_TypeDef* USARTx, uint32_t baudrate, uint32_t WordLength, uint32_t Parity, uint32_t StopBits) {
+	const TM_USART_INT_Config_t* cfg = USART_INT_GetConfig(USARTx);
+	
+	/* Check valid USART and baudrate */
+	if (cfg->USARTx != USARTx || baudrate == 0) {
+		return;
+	}
+	
+	/* Wait for last byte to be sent */
+	USART_WAIT(USARTx);
+	while (!(USARTx->USART_STATUS_REG & USART_FLAG_TC));
+	
+	/* Disable USART, registers below can only be changed when disabled */
+	USARTx->CR1 &= ~USART_CR1_UE;
+	
+	/* Set frame format, other bits like interrupt enables are kept */
+	USARTx->CR1 = (USARTx->CR1 & ~(USART_CR1_M | USART_CR1_PCE | USART_CR1_PS)) | WordLength | Parity;
+	USARTx->CR2 = (USARTx->CR2 & ~USART_CR2_STOP) | StopBits;
+	
+	/* Set baudrate */
+	TM_USART_INT_SetBaudrate(USARTx, cfg, baudrate);
+	
+	/* Enable USART back */
+	USARTx->CR1 |= USART_CR1_UE;
+}
+
+void TM_USART_UpdateClock(void) {
+	const TM_USART_INT_Config_t* cfg;
+	uint8_t i;
+	
+	/* Go through all initialized USARTs */
+	for (i = 0; i < USART_INT_COUNT; i++) {
+		cfg = &USART_Config[i];
+		if (!USART_Baudrate[i] || !(cfg->USARTx->CR1 & USART_CR1_UE)) {
+			continue;
+		}
+		
+		/* Set baudrate for new clock, USART is disabled for short time */
+		cfg->USARTx->CR1 &= ~USART_CR1_UE;
+		TM_USART_INT_SetBaudrate(cfg->USARTx, cfg, USART_Baudrate[i]);
+		cfg->USARTx->CR1 |= USART_CR1_UE;
+	}
 }
 
 /************************************/
@@ -442,152 +669,74 @@ __weak void TM_USART_InitCustomPinsCallback(USART_TypeDef* USARTx, uint16_t Alte
 	*/
 }
 
-/* Private functions */
-static void TM_USART_INT_InsertToBuffer(TM_BUFFER_t* u, uint8_t c) {
-	TM_BUFFER_Write(u, &c, 1);
+__weak void TM_USART_INT_IdleLineCallback(USART_TypeDef* USARTx) {
+	/* NOTE: This function Should not be modified, it is implemented in TM USART DMA library for RX DMA mode */
+}
+
+__weak void TM_USART_INT_TXBufferCallback(USART_TypeDef* USARTx) {
+	/* NOTE: This function Should not be modified, it is implemented in TM USART DMA library for TX buffer mode */
 }
 
-static TM_BUFFER_t* TM_USART_INT_GetUSARTBuffer(USART_TypeDef* USARTx) {
-	TM_BUFFER_t* u;
+__weak void TM_USART_INT_RXTimeoutCallback(USART_TypeDef* USARTx) {
+	/* NOTE: This function Should not be modified, it is implemented in TM MODBUS library for frame end detection */
+}
+
+__weak void TM_USART_INT_TXCompleteCallback(USART_TypeDef* USARTx) {
+	/* NOTE: This function Should not be modified, it is implemented in TM MODBUS library for driver enable pin */
+}
+
+/* Private functions */
+__ramfunc static void TM_USART_INT_InsertToBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* u, uint8_t c) {
+#if STATS_ENABLED
+	TM_STATS_t* s = USART_INT_STATS(USARTx);
 	
-#ifdef USART1
-	if (USARTx == USART1) {
-		u = &TM_USART1;
-	}
-#endif
-#ifdef USART2
-	if (USARTx == USART2) {
-		u = &TM_USART2;
-	}
-#endif
-#ifdef USART3
-	if (USARTx == USART3) {
-		u = &TM_USART3;
-	}
-#endif
-#ifdef UART4
-	if (USARTx == UART4) {
-		u = &TM_UART4;
-	}
-#endif
-#ifdef UART5
-	if (USARTx == UART5) {
-		u = &TM_UART5;
-	}
-#endif
-#ifdef USART6
-	if (USARTx == USART6) {
-		u = &TM_USART6;
-	}
-#endif
-#ifdef UART7
-	if (USARTx == UART7) {
-		u = &TM_UART7;
-	}
-#endif
-#ifdef UART8
-	if (USARTx == UART8) {
-		u = &TM_UART8;
+	/* Count byte, dropped when buffer is full */
+	TM_STATS_INC(s, RxBytes);
+	if (!TM_BUFFER_WriteByte(u, c)) {
+		TM_STATS_INC(s, Dropped);
 	}
+	TM_STATS_MAX(s, HighWater, TM_BUFFER_GetFull(u));
+#else
+	TM_BUFFER_WriteByte(u, c);
 #endif
+}
 
-/* STM32F0xx related */
-#ifdef USART4
-	if (USARTx == USART4) {
-		u = &TM_USART4;
-	}
-#endif
-#ifdef USART5
-	if (USARTx == USART5) {
-		u = &TM_USART5;
-	}
-#endif
-#ifdef USART7
-	if (USARTx == USART7) {
-		u = &TM_USART7;
-	}
-#endif
-#ifdef USART8
-	if (USARTx == USART8) {
-		u = &TM_USART8;
-	}
-#endif
+TM_BUFFER_t* TM_USART_GetBuffer(USART_TypeDef* USARTx) {
+	return USART_INT_GetConfig(USARTx)->Buffer;
+}
+
+void TM_USART_SetTXBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* Buffer) {
+	USART_TXBuffer[USART_INT_INDEX(USARTx)] = Buffer;
+}
 
-	return u;
+TM_BUFFER_t* TM_USART_GetTXBuffer(USART_TypeDef* USARTx) {
+	return USART_TXBuffer[USART_INT_INDEX(USARTx)];
 }
 
-static uint8_t TM_USART_INT_GetSubPriority(USART_TypeDef* USARTx) {
-	uint8_t u;
+static void TM_USART_INT_WriteToTXBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* tx, uint8_t* DataArray, uint16_t count) {
+	uint32_t irq, written;
 	
-#ifdef USART1
-	if (USARTx == USART1) {
-		u = 0;
-	}
-#endif
-#ifdef USART2
-	if (USARTx == USART2) {
-		u = 1;
-	}
-#endif
-#ifdef USART3
-	if (USARTx == USART3) {
-		u = 2;
-	}
-#endif
-#ifdef UART4
-	if (USARTx == UART4) {
-		u = 4;
-	}
-#endif
-#ifdef UART5
-	if (USARTx == UART5) {
-		u = 5;
-	}
-#endif
-#ifdef USART6
-	if (USARTx == USART6) {
-		u = 6;
-	}
-#endif
-#ifdef UART7
-	if (USARTx == UART7) {
-		u = 7;
-	}
-#endif
-#ifdef UART8
-	if (USARTx == UART8) {
-		u = 8;
-	}
-#endif
+	/* Disable interrupts, buffer can be written from thread and interrupts */
+	irq = TM_NVIC_Lock();
 	
-
-/* STM32F0xx related */
-#ifdef USART4
-	if (USARTx == USART4) {
-		u = 4;
-	}
-#endif
-#ifdef USART5
-	if (USARTx == USART5) {
-		u = 5;
-	}
-#endif
-#ifdef USART7
-	if (USARTx == USART7) {
-		u = 7;
-	}
-#endif
-#ifdef USART8
-	if (USARTx == USART8) {
-		u = 8;
-	}
-#endif
+	/* Copy data, what does not fit is dropped */
+	written = TM_BUFFER_Write(tx, DataArray, count);
 	
-	return u;
+	/* Start sending if not already */
+	TM_USART_INT_TXBufferCallback(USARTx);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Count transfer */
+	TM_STATS_INC(USART_INT_STATS(USARTx), Transfers);
+	TM_STATS_ADD(USART_INT_STATS(USARTx), TxBytes, written);
+	TM_STATS_ADD(USART_INT_STATS(USARTx), Dropped, count - written);
+	TM_STATS_MAX(USART_INT_STATS(USARTx), HighWater, TM_BUFFER_GetFull(tx));
 }
 
 /* PIN initializations */
-#ifdef USART1
+#ifdef USART_INT_USE_USART1
 void TM_USART1_InitPins(TM_USART_PinsPack_t pinspack) {	
 	/* Init pins */
 #if defined(GPIOA)
@@ -607,7 +756,7 @@ void TM_USART1_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef USART2
+#ifdef USART_INT_USE_USART2
 void TM_USART2_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOA)
@@ -627,7 +776,7 @@ void TM_USART2_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef USART3
+#ifdef USART_INT_USE_USART3
 void TM_USART3_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOB)
@@ -652,7 +801,7 @@ void TM_USART3_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef UART4
+#ifdef USART_INT_USE_UART4
 void TM_UART4_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOA)
@@ -672,7 +821,7 @@ void TM_UART4_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef UART5
+#ifdef USART_INT_USE_UART5
 void TM_UART5_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOC) && defined(GPIOD)
@@ -688,7 +837,7 @@ void TM_UART5_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef USART6
+#ifdef USART_INT_USE_USART6
 void TM_USART6_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOC)
@@ -708,7 +857,7 @@ void TM_USART6_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef UART7
+#ifdef USART_INT_USE_UART7
 void TM_UART7_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOE)
@@ -728,7 +877,7 @@ void TM_UART7_InitPins(TM_USART_PinsPack_t pinspack) {
 }
 #endif
 
-#ifdef UART8
+#ifdef USART_INT_USE_UART8
 void TM_UART8_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOE)
@@ -744,7 +893,7 @@ void TM_UART8_InitPins(TM_USART_PinsPack_t pinspack) {
 #endif
 
 /* STM32F0xx related */
-#ifdef USART4
+#ifdef USART_INT_USE_USART4
 void TM_USART4_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOA)
@@ -768,7 +917,7 @@ void TM_USART4_InitPins(TM_USART_PinsPack_t pinspack) {
 	}
 }
 #endif
-#ifdef USART5
+#ifdef USART_INT_USE_USART5
 void TM_USART5_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOB)
@@ -793,7 +942,7 @@ void TM_USART5_InitPins(TM_USART_PinsPack_t pinspack) {
 	}
 }
 #endif
-#ifdef USART7
+#ifdef USART_INT_USE_USART7
 void TM_USART7_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOC)
@@ -817,7 +966,7 @@ void TM_USART7_InitPins(TM_USART_PinsPack_t pinspack) {
 	}
 }
 #endif
-#ifdef USART8
+#ifdef USART_INT_USE_USART8
 void TM_USART8_InitPins(TM_USART_PinsPack_t pinspack) {
 	/* Init pins */
 #if defined(GPIOC)
@@ -843,153 +992,185 @@ void TM_USART8_InitPins(TM_USART_PinsPack_t pinspack) {
 #endif
 
 /* Interrupt handlers */
-#ifdef USART1
-void USART1_IRQHandler(void) {
+#ifdef USART_INT_USE_USART1
+__ramfunc void USART1_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (USART1->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((USART1->CR1 & USART_CR1_RXNEIE) && (USART1->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_USART1_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_USART1_ReceiveHandler(USART_READ_DATA(USART1));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART1, USART_READ_DATA(USART1));
+		TM_USART_INT_InsertToBuffer(USART1, &TM_USART1, USART_READ_DATA(USART1));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(USART1);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(USART1, IRQ_USART1);
 }
 #endif
 
-#ifdef USART2
-void USART2_IRQHandler(void) {
+#ifdef USART_INT_USE_USART2
+__ramfunc void USART2_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (USART2->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((USART2->CR1 & USART_CR1_RXNEIE) && (USART2->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_USART2_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_USART2_ReceiveHandler(USART_READ_DATA(USART2));
 #else 
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART2, USART_READ_DATA(USART2));
+		TM_USART_INT_InsertToBuffer(USART2, &TM_USART2, USART_READ_DATA(USART2));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(USART2);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(USART2, IRQ_USART2);
 }
 #endif
 
-#ifdef USART3
-void USART3_IRQHandler(void) {
+#ifdef USART_INT_USE_USART3
+__ramfunc void USART3_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (USART3->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((USART3->CR1 & USART_CR1_RXNEIE) && (USART3->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_USART3_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_USART3_ReceiveHandler(USART_READ_DATA(USART3));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART3, USART_READ_DATA(USART3));
+		TM_USART_INT_InsertToBuffer(USART3, &TM_USART3, USART_READ_DATA(USART3));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(USART3);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(USART3, IRQ_USART3);
 }
 #endif
 
-#ifdef UART4
-void UART4_IRQHandler(void) {
+#ifdef USART_INT_USE_UART4
+__ramfunc void UART4_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (UART4->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((UART4->CR1 & USART_CR1_RXNEIE) && (UART4->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_UART4_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_UART4_ReceiveHandler(USART_READ_DATA(UART4));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_UART4, USART_READ_DATA(UART4));
+		TM_USART_INT_InsertToBuffer(UART4, &TM_UART4, USART_READ_DATA(UART4));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(UART4);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(UART4, IRQ_UART4);
 }
 #endif
 
-#ifdef UART5
-void UART5_IRQHandler(void) {
+#ifdef USART_INT_USE_UART5
+__ramfunc void UART5_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (UART5->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((UART5->CR1 & USART_CR1_RXNEIE) && (UART5->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_UART5_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_UART5_ReceiveHandler(USART_READ_DATA(UART5));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_UART5, USART_READ_DATA(UART5));
+		TM_USART_INT_InsertToBuffer(UART5, &TM_UART5, USART_READ_DATA(UART5));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(UART5);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(UART5, IRQ_UART5);
 }
 #endif
 
-#ifdef USART6
-void USART6_IRQHandler(void) {
+#ifdef USART_INT_USE_USART6
+__ramfunc void USART6_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (USART6->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((USART6->CR1 & USART_CR1_RXNEIE) && (USART6->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_USART6_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_USART6_ReceiveHandler(USART_READ_DATA(USART6));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART6, USART_READ_DATA(USART6));
+		TM_USART_INT_InsertToBuffer(USART6, &TM_USART6, USART_READ_DATA(USART6));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(USART6);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(USART6, IRQ_USART6);
 }
 #endif
 
-#ifdef UART7
-void UART7_IRQHandler(void) {
+#ifdef USART_INT_USE_UART7
+__ramfunc void UART7_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (UART7->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((UART7->CR1 & USART_CR1_RXNEIE) && (UART7->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_UART7_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_UART7_ReceiveHandler(USART_READ_DATA(UART7));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_UART7, USART_READ_DATA(UART7));
+		TM_USART_INT_InsertToBuffer(UART7, &TM_UART7, USART_READ_DATA(UART7));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(UART7);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(UART7, IRQ_UART7);
 }
 #endif
 
-#ifdef UART8
-void UART8_IRQHandler(void) {
+#ifdef USART_INT_USE_UART8
+__ramfunc void UART8_IRQHandler(void) {
 	/* Check if interrupt was because data is received */
-	if (UART8->USART_STATUS_REG & USART_ISR_RXNE) {
+	if ((UART8->CR1 & USART_CR1_RXNEIE) && (UART8->USART_STATUS_REG & USART_ISR_RXNE)) {
 #ifdef TM_UART8_USE_CUSTOM_IRQ
 		/* Call user function */
 		TM_UART8_ReceiveHandler(USART_READ_DATA(UART8));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_UART8, USART_READ_DATA(UART8));
+		TM_USART_INT_InsertToBuffer(UART8, &TM_UART8, USART_READ_DATA(UART8));
 #endif
 	}
 	
+	/* Check IDLE line, receiver timeout and transmission complete events */
+	TM_USART_INT_Events(UART8);
+	
 	/* Clear all USART flags */
 	TM_USART_INT_ClearAllFlags(UART8, IRQ_UART8);
 }
 #endif
 
-#if defined(STM32F0xx)
-#ifdef USART8
-void USART3_8_IRQHandler(void) {
+#if defined(STM32F0xx) && (defined(USART_INT_USE_USART3) || defined(USART_INT_USE_USART4) || defined(USART_INT_USE_USART5) || \
+	defined(USART_INT_USE_USART6) || defined(USART_INT_USE_USART7) || defined(USART_INT_USE_USART8))
+/* Shared interrupt for USART3 and above, only enabled USARTs are checked */
+#ifdef USART_INT_USE_USART8
+__ramfunc void USART3_8_IRQHandler(void) {
+#elif defined(USART6)
+__ramfunc void USART3_6_IRQHandler(void) {
+#else
+__ramfunc void USART3_4_IRQHandler(void) {
+#endif
+#ifdef USART_INT_USE_USART3
 	/* Check if interrupt was because data is received */
 	if (USART3->USART_STATUS_REG & USART_ISR_RXNE) {
 #ifdef TM_USART3_USE_CUSTOM_IRQ
@@ -997,10 +1178,14 @@ void USART3_8_IRQHandler(void) {
 		TM_UART8_ReceiveHandler(USART_READ_DATA(USART3));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART3, USART_READ_DATA(USART3));
+		TM_USART_INT_InsertToBuffer(USART3, &TM_USART3, USART_READ_DATA(USART3));
 #endif
 	}
+	TM_USART_INT_Events(USART3);
+	TM_USART_INT_ClearAllFlags(USART3, IRQ_USART3);
+#endif
 
+#ifdef USART_INT_USE_USART4
 	/* Check if interrupt was because data is received */
 	if (USART4->USART_STATUS_REG & USART_ISR_RXNE) {
 #ifdef TM_USART4_USE_CUSTOM_IRQ
@@ -1008,10 +1193,14 @@ void USART3_8_IRQHandler(void) {
 		TM_UART8_ReceiveHandler(USART_READ_DATA(USART4));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART4, USART_READ_DATA(USART4));
+		TM_USART_INT_InsertToBuffer(USART4, &TM_USART4, USART_READ_DATA(USART4));
 #endif
 	}
+	TM_USART_INT_Events(USART4);
+	TM_USART_INT_ClearAllFlags(USART4, IRQ_USART4);
+#endif
 
+#ifdef USART_INT_USE_USART5
 	/* Check if interrupt was because data is received */
 	if (USART5->USART_STATUS_REG & USART_ISR_RXNE) {
 #ifdef TM_USART5_USE_CUSTOM_IRQ
@@ -1019,10 +1208,14 @@ void USART3_8_IRQHandler(void) {
 		TM_UART8_ReceiveHandler(USART_READ_DATA(USART5));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART5, USART_READ_DATA(USART5));
+		TM_USART_INT_InsertToBuffer(USART5, &TM_USART5, USART_READ_DATA(USART5));
 #endif
 	}
+	TM_USART_INT_Events(USART5);
+	TM_USART_INT_ClearAllFlags(USART5, IRQ_USART5);
+#endif
 
+#ifdef USART_INT_USE_USART6
 	/* Check if interrupt was because data is received */
 	if (USART6->USART_STATUS_REG & USART_ISR_RXNE) {
 #ifdef TM_USART6_USE_CUSTOM_IRQ
@@ -1030,10 +1223,14 @@ void USART3_8_IRQHandler(void) {
 		TM_UART8_ReceiveHandler(USART_READ_DATA(USART6));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART6, USART_READ_DATA(USART6));
+		TM_USART_INT_InsertToBuffer(USART6, &TM_USART6, USART_READ_DATA(USART6));
 #endif
 	}
+	TM_USART_INT_Events(USART6);
+	TM_USART_INT_ClearAllFlags(USART6, IRQ_USART6);
+#endif
 
+#ifdef USART_INT_USE_USART7
 	/* Check if interrupt was because data is received */
 	if (USART7->USART_STATUS_REG & USART_ISR_RXNE) {
 #ifdef TM_USART7_USE_CUSTOM_IRQ
@@ -1041,10 +1238,14 @@ void USART3_8_IRQHandler(void) {
 		TM_UART8_ReceiveHandler(USART_READ_DATA(USART7));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART7, USART_READ_DATA(USART7));
+		TM_USART_INT_InsertToBuffer(USART7, &TM_USART7, USART_READ_DATA(USART7));
 #endif
 	}
+	TM_USART_INT_Events(USART7);
+	TM_USART_INT_ClearAllFlags(USART7, IRQ_USART7);
+#endif
 
+#ifdef USART_INT_USE_USART8
 	/* Check if interrupt was because data is received */
 	if (USART8->USART_STATUS_REG & USART_ISR_RXNE) {
 #ifdef TM_USART8_USE_CUSTOM_IRQ
@@ -1052,100 +1253,14 @@ void USART3_8_IRQHandler(void) {
 		TM_UART8_ReceiveHandler(USART_READ_DATA(USART8));
 #else
 		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART8, USART_READ_DATA(USART8));
+		TM_USART_INT_InsertToBuffer(USART8, &TM_USART8, USART_READ_DATA(USART8));
 #endif
 	}
-	
-	/* Clear all USART flags */
-	TM_USART_INT_ClearAllFlags(USART3, IRQ_USART3);
-	TM_USART_INT_ClearAllFlags(USART4, IRQ_USART4);
-	TM_USART_INT_ClearAllFlags(USART5, IRQ_USART5);
-	TM_USART_INT_ClearAllFlags(USART6, IRQ_USART6);
-	TM_USART_INT_ClearAllFlags(USART7, IRQ_USART7);
+	TM_USART_INT_Events(USART8);
 	TM_USART_INT_ClearAllFlags(USART8, IRQ_USART8);
-}
-#elif defined(USART6)
-void USART3_6_IRQHandler(void) {
-	/* Check if interrupt was because data is received */
-	if (USART3->USART_STATUS_REG & USART_ISR_RXNE) {
-#ifdef TM_USART3_USE_CUSTOM_IRQ
-		/* Call user function */
-		TM_UART8_ReceiveHandler(USART_READ_DATA(USART3));
-#else
-		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART3, USART_READ_DATA(USART3));
-#endif
-	}
-
-	/* Check if interrupt was because data is received */
-	if (USART4->USART_STATUS_REG & USART_ISR_RXNE) {
-#ifdef TM_USART4_USE_CUSTOM_IRQ
-		/* Call user function */
-		TM_UART8_ReceiveHandler(USART_READ_DATA(USART4));
-#else
-		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART4, USART_READ_DATA(USART4));
-#endif
-	}
-
-	/* Check if interrupt was because data is received */
-	if (USART5->USART_STATUS_REG & USART_ISR_RXNE) {
-#ifdef TM_USART5_USE_CUSTOM_IRQ
-		/* Call user function */
-		TM_UART8_ReceiveHandler(USART_READ_DATA(USART5));
-#else
-		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART5, USART_READ_DATA(USART5));
-#endif
-	}
-
-	/* Check if interrupt was because data is received */
-	if (USART6->USART_STATUS_REG & USART_ISR_RXNE) {
-#ifdef TM_USART6_USE_CUSTOM_IRQ
-		/* Call user function */
-		TM_UART8_ReceiveHandler(USART_READ_DATA(USART6));
-#else
-		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART6, USART_READ_DATA(USART6));
-#endif
-	}
-	
-	/* Clear all USART flags */
-	TM_USART_INT_ClearAllFlags(USART3);
-	TM_USART_INT_ClearAllFlags(USART4);
-	TM_USART_INT_ClearAllFlags(USART5);
-	TM_USART_INT_ClearAllFlags(USART6);
-}
-#elif defined(USART4)
-void USART3_6_IRQHandler(void) {
-	/* Check if interrupt was because data is received */
-	if (USART3->USART_STATUS_REG & USART_ISR_RXNE) {
-#ifdef TM_USART3_USE_CUSTOM_IRQ
-		/* Call user function */
-		TM_UART8_ReceiveHandler(USART_READ_DATA(USART3));
-#else
-		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART3, USART_READ_DATA(USART3));
-#endif
-	}
-
-	/* Check if interrupt was because data is received */
-	if (USART4->USART_STATUS_REG & USART_ISR_RXNE) {
-#ifdef TM_USART4_USE_CUSTOM_IRQ
-		/* Call user function */
-		TM_UART8_ReceiveHandler(USART_READ_DATA(USART4));
-#else
-		/* Put received data into internal buffer */
-		TM_USART_INT_InsertToBuffer(&TM_USART4, USART_READ_DATA(USART4));
 #endif
-	}
-	
-	/* Clear all USART flags */
-	TM_USART_INT_ClearAllFlags(USART3);
-	TM_USART_INT_ClearAllFlags(USART4);
 }
 #endif
-#endif
 
 static void TM_USART_INT_Init(
 	USART_TypeDef* USARTx,
@@ -1158,182 +1273,35 @@ static void TM_USART_INT_Init(
 	uint32_t WordLength
 ) {
 	UART_HandleTypeDef UARTHandle;
+	const TM_USART_INT_Config_t* cfg = USART_INT_GetConfig(USARTx);
 	IRQn_Type irq;
 	
-	/*
-	 * Initialize USARTx pins
-	 * Set channel for USARTx NVIC
-	 */
-#ifdef USART1
-	if (USARTx == USART1) {
-		/* Enable USART clock */
-		__HAL_RCC_USART1_CLK_ENABLE();
-		__HAL_RCC_USART1_FORCE_RESET();
-		__HAL_RCC_USART1_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART1_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART1;
-	}
-#endif
-#ifdef USART2
-	if (USARTx == USART2) {
-		/* Enable USART clock */
-		__HAL_RCC_USART2_CLK_ENABLE();
-		__HAL_RCC_USART2_FORCE_RESET();
-		__HAL_RCC_USART2_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART2_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART2;
-	}
-#endif
-#ifdef USART3
-	if (USARTx == USART3) {
-		/* Enable USART clock */
-		__HAL_RCC_USART3_CLK_ENABLE();
-		__HAL_RCC_USART3_FORCE_RESET();
-		__HAL_RCC_USART3_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART3_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART3;
-	}
-#endif
-#ifdef UART4
-	if (USARTx == UART4) {
-		/* Enable UART clock */
-		__HAL_RCC_UART4_CLK_ENABLE();
-		__HAL_RCC_UART4_FORCE_RESET();
-		__HAL_RCC_UART4_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_UART4_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_UART4;
-	}
-#endif
-#ifdef UART5
-	if (USARTx == UART5) {
-		/* Enable UART clock */
-		__HAL_RCC_UART5_CLK_ENABLE();
-		__HAL_RCC_UART5_FORCE_RESET();
-		__HAL_RCC_UART5_RELEASE_RESET();
-
-		/* Init pins */
-		TM_UART5_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_UART5;
-	}
-#endif
-#ifdef USART6
-	if (USARTx == USART6) {
-		/* Enable UART clock */
-		__HAL_RCC_USART6_CLK_ENABLE();
-		__HAL_RCC_USART6_FORCE_RESET();
-		__HAL_RCC_USART6_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART6_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART6;
-	}
-#endif
-#ifdef UART7
-	if (USARTx == UART7) {
-		/* Enable UART clock */
-		__HAL_RCC_UART7_CLK_ENABLE();
-		__HAL_RCC_UART7_FORCE_RESET();
-		__HAL_RCC_UART7_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_UART7_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_UART7;
-	}
-#endif
-#ifdef UART8
-	if (USARTx == UART8) {
-		/* Enable UART clock */
-		__HAL_RCC_UART8_CLK_ENABLE();
-		__HAL_RCC_UART8_FORCE_RESET();
-		__HAL_RCC_UART8_RELEASE_RESET();
-
-		/* Init pins */
-		TM_UART8_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_UART8;
+	/* Check valid USART */
+	if (cfg->USARTx != USARTx) {
+		return;
 	}
-#endif
 	
-/* STM32F0xx related */
-#ifdef USART4
-	if (USARTx == USART4) {
-		/* Enable UART clock */
-		__HAL_RCC_USART4_CLK_ENABLE();
-		__HAL_RCC_USART4_FORCE_RESET();
-		__HAL_RCC_USART4_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART4_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART4;
-	}
-#endif
-#ifdef USART5
-	if (USARTx == USART5) {
-		/* Enable UART clock */
-		__HAL_RCC_USART5_CLK_ENABLE();
-		__HAL_RCC_USART5_FORCE_RESET();
-		__HAL_RCC_USART5_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART5_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART5;
-	}
-#endif
-#ifdef USART7
-	if (USARTx == USART7) {
-		/* Enable UART clock */
-		__HAL_RCC_USART7_CLK_ENABLE();
-		__HAL_RCC_USART7_FORCE_RESET();
-		__HAL_RCC_USART7_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART7_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART7;
-	}
-#endif
-#ifdef USART8
-	if (USARTx == USART8) {
-		/* Enable UART clock */
-		__HAL_RCC_USART8_CLK_ENABLE();
-		__HAL_RCC_USART8_FORCE_RESET();
-		__HAL_RCC_USART8_RELEASE_RESET();
-		
-		/* Init pins */
-		TM_USART8_InitPins(pinspack);
-		
-		/* Set IRQ channel */
-		irq = IRQ_USART8;
+	/* Register statistics */
+	TM_STATS_REGISTER(USART_INT_STATS(USARTx), cfg->Name);
+	
+	/* Enable USART clock and reset peripheral */
+	if (cfg->APB2) {
+		RCC->APB2ENR |= cfg->RCC_Mask;
+		(void)RCC->APB2ENR;
+		RCC->APB2RSTR |= cfg->RCC_Mask;
+		RCC->APB2RSTR &= ~cfg->RCC_Mask;
+	} else {
+		RCC->APB1ENR |= cfg->RCC_Mask;
+		(void)RCC->APB1ENR;
+		RCC->APB1RSTR |= cfg->RCC_Mask;
+		RCC->APB1RSTR &= ~cfg->RCC_Mask;
 	}
-#endif
+	
+	/* Init pins */
+	cfg->InitPins(pinspack);
+	
+	/* Set IRQ channel */
+	irq = cfg->IRQ;
 	
 	/* Fill default settings */
 	UARTHandle.Instance = USARTx;
@@ -1352,7 +1320,7 @@ static void TM_USART_INT_Init(
 	HAL_NVIC_DisableIRQ(irq);
 
 	/* Set priority */
-	HAL_NVIC_SetPriority(irq, USART_NVIC_PRIORITY, TM_USART_INT_GetSubPriority(USARTx));
+	HAL_NVIC_SetPriority(irq, USART_NVIC_PRIORITY, cfg->SubPriority);
 	
 	/* Enable interrupt */
 	HAL_NVIC_EnableIRQ(irq);
@@ -1363,14 +1331,65 @@ static void TM_USART_INT_Init(
 	/* Init USART */
 	HAL_UART_Init(&UARTHandle);
 	
+	/* Save baudrate for clock changes */
+	USART_Baudrate[USART_INT_INDEX(USARTx)] = baudrate;
+	
 	/* Enable RX interrupt */
 	USARTx->CR1 |= USART_CR1_RXNEIE;
 }
 
+static void TM_USART_INT_SetBaudrate(USART_TypeDef* USARTx, const TM_USART_INT_Config_t* cfg, uint32_t baudrate) {
+	uint32_t pclk;
+	
+	/* Get USART clock */
+#if defined(STM32F0xx)
+	pclk = HAL_RCC_GetPCLK1Freq();
+#else
+	pclk = cfg->APB2 ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+#endif
+	
+	/* Set baudrate, oversampling by 16 is used */
+	USARTx->BRR = (pclk + baudrate / 2) / baudrate;
+	
+	/* Save baudrate for clock changes */
+	USART_Baudrate[USART_INT_INDEX(USARTx)] = baudrate;
+}
+
 static UART_HandleTypeDef UART_Handle;
+static __INLINE void TM_USART_INT_Events(USART_TypeDef* USARTx) {
+	/* Check if interrupt was because of IDLE line */
+	if ((USARTx->CR1 & USART_CR1_IDLEIE) && (USARTx->USART_STATUS_REG & USART_ISR_IDLE)) {
+		/* Call IDLE line callbacks, IDLE line is also receiver timeout on USARTs without timeout feature */
+		TM_USART_INT_IdleLineCallback(USARTx);
+		TM_USART_INT_RXTimeoutCallback(USARTx);
+	}
+	
+#if defined(USART_CR1_RTOIE)
+	/* Check if interrupt was because of receiver timeout */
+	if ((USARTx->CR1 & USART_CR1_RTOIE) && (USARTx->ISR & USART_ISR_RTOF)) {
+		/* Clear flag and call callback */
+		USARTx->ICR = USART_ICR_RTOCF;
+		TM_USART_INT_RXTimeoutCallback(USARTx);
+	}
+#endif
+	
+	/* Check if interrupt was because last byte has been transmitted */
+	if ((USARTx->CR1 & USART_CR1_TCIE) && (USARTx->USART_STATUS_REG & USART_FLAG_TC)) {
+		/* Callback disables interrupt */
+		TM_USART_INT_TXCompleteCallback(USARTx);
+	}
+}
+
 static void TM_USART_INT_ClearAllFlags(USART_TypeDef* USARTx, IRQn_Type irq) {
 	UART_Handle.Instance = USARTx;
 	
+	/* Count receive errors before flags are cleared */
+#if STATS_ENABLED
+	if (USARTx->USART_STATUS_REG & USART_INT_ERROR_FLAGS) {
+		TM_STATS_INC(USART_INT_STATS(USARTx), Errors);
+	}
+#endif
+	
 #ifdef __HAL_UART_CLEAR_PEFLAG
 	__HAL_UART_CLEAR_PEFLAG(&UART_Handle);
 #endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/07/hal-library-07-usart-for-stm32fxxx
- * @version v1.2.1
+ * @version v2.2
  * @ide     Keil uVision
  * @license MIT
  * @brief   USART Library for STM32Fxxx with receive interrupt
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USART_H
-#define TM_USART_H 121
+#define TM_USART_H 220
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -123,6 +123,20 @@ void TM_X_ReceiveHandler(uint8_t c) {
  *   - TM_USART7_BUFFER_SIZE
  *   - TM_USART8_BUFFER_SIZE
  *	
+ * \par Enabled U(S)ARTs only
+ *
+ * By default, buffers, interrupt handlers and settings are compiled for all U(S)ARTs on device.
+ * When at least one U(S)ART is enabled in defines.h, only enabled U(S)ARTs are included:
+ *
+\code
+//Change X with possible U(S)ARTs: USART1, USART2, USART3, UART4, UART5, USART6, UART7, UART8, for STM32F0xx additions: USART4, USART5, USART7, USART8
+#define TM_X_ENABLED
+\endcode
+ *
+ * When only one U(S)ART is enabled, lookup from USART pointer is resolved at compile time.
+ *
+ * @note  Functions must not be called with U(S)ART which is not enabled
+ *	
  * \par Custom string delimiter for @ref TM_USART_Gets() function
  * 
  * By default, LF (Line Feed) character was used, but now you can select custom character using @ref TM_USART_SetCustomStringEndCharacter() function.
@@ -188,6 +202,49 @@ USART8       |PC2    PC3     |PC8    PC9     |PD13   PD14
   - December 26, 2015
   - On reinitialization USART with other baudrate, USART didn't work properly and needs some time to start.
   - With forcing register reset this has been fixed
+
+ Version 1.3
+  - October 14, 2026
+  - Added @ref TM_USART_GetBuffer() function and IDLE line interrupt handling for RX DMA mode in @ref TM_USART_DMA library
+
+ Version 1.4
+  - October 14, 2026
+  - @ref TM_USART_FindString() checks only data received since last call with the same string
+
+ Version 1.5
+  - October 14, 2026
+  - USART clocks, pins, IRQs and default settings are taken from constant table instead of if chains
+  - @ref TM_USART_GetBuffer() uses table lookup from USART base address
+
+ Version 1.6
+  - October 14, 2026
+  - Added @ref TM_USART_SetFormat() function to change baudrate and frame format without USART reset
+
+ Version 1.7
+  - October 14, 2026
+  - Added @ref TM_USART_UpdateClock() function for runtime clock changes
+
+ Version 1.8
+  - October 14, 2026
+  - Added optional TM STATS counters for each U(S)ART, enabled with STATS_ENABLED
+
+ Version 1.9
+  - October 14, 2026
+  - Only U(S)ARTs enabled with TM_X_ENABLED in defines.h are compiled in when at least one is enabled
+  - Fixed shared USART3_4 interrupt handler name on STM32F0xx devices with 4 USARTs
+
+ Version 2.0
+  - October 14, 2026
+  - Added TX buffer mode, @ref TM_USART_Puts() and @ref TM_USART_Send() only copy data to buffer, used by TM USART DMA library
+
+ Version 2.1
+  - October 14, 2026
+  - Added receiver timeout and transmission complete interrupt callbacks, used by TM MODBUS library
+
+ Version 2.2
+   - October 14, 2026
+   - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+   - Default NVIC priority is taken from TM NVIC priority plan
 \endverbatim
  *
  * \b Dependencies
@@ -199,6 +256,7 @@ USART8       |PC2    PC3     |PC8    PC9     |PD13   PD14
  - defines.h
  - TM GPIO
  - TM BUFFER
+ - TM STATS
 \endverbatim
  */
 #include "stm32fxxx_hal.h"
@@ -206,6 +264,7 @@ USART8       |PC2    PC3     |PC8    PC9     |PD13   PD14
 #include "defines.h"
 #include "tm_stm32_gpio.h"
 #include "tm_stm32_buffer.h"
+#include "tm_stm32_stats.h"
 
 /**
  * @defgroup TM_USART_Typedefs
@@ -295,7 +354,7 @@ typedef enum {
 
 /* NVIC Global Priority */
 #ifndef USART_NVIC_PRIORITY
-#define USART_NVIC_PRIORITY					0x06
+#define USART_NVIC_PRIORITY					NVIC_PRIORITY_HIGH
 #endif
 
 /* U(S)ART settings, can be changed in your defines.h project file */
@@ -509,6 +568,9 @@ typedef enum {
 #if !defined(USART_ISR_RXNE)
 #define USART_ISR_RXNE                      USART_SR_RXNE
 #endif
+#if !defined(USART_ISR_IDLE)
+#define USART_ISR_IDLE                      USART_SR_IDLE
+#endif
 
 /**
  * @brief  Default string delimiter for USART
@@ -518,12 +580,14 @@ typedef enum {
 /* Configuration */
 #if defined(STM32F4XX)
 #define USART_TX_REG(USARTx)                ((USARTx)->DR)
+#define USART_RX_REG(USARTx)                ((USARTx)->DR)
 #define USART_WRITE_DATA(USARTx, data)      ((USARTx)->DR = (data))
 #define USART_READ_DATA(USARTx)             ((USARTx)->DR)
 #define GPIO_AF_UART5                       (GPIO_AF8_UART5)
 #define USART_STATUS_REG                    SR
 #else
 #define USART_TX_REG(USARTx)                ((USARTx)->TDR)
+#define USART_RX_REG(USARTx)                ((USARTx)->RDR)
 #define USART_WRITE_DATA(USARTx, data)      ((USARTx)->TDR = (data))
 #define USART_READ_DATA(USARTx)             ((USARTx)->RDR)
 #define GPIO_AF_UART5                       (GPIO_AF7_UART5)
@@ -568,6 +632,7 @@ void TM_USART_InitWithFlowControl(USART_TypeDef* USARTx, TM_USART_PinsPack_t pin
 
 /**
  * @brief  Puts character to USART port
+ * @note   Character is always sent directly, also when TX buffer is set with @ref TM_USART_SetTXBuffer()
  * @param  *USARTx: Pointer to USARTx peripheral you will use
  * @param  c: character to be send over USART
  * @retval None
@@ -586,6 +651,7 @@ static __INLINE void TM_USART_Putc(USART_TypeDef* USARTx, volatile char c) {
 
 /**
  * @brief  Puts string to USART port
+ * @note   When TX buffer is set with @ref TM_USART_SetTXBuffer(), string is copied to buffer and function returns immediately
  * @param  *USARTx: Pointer to USARTx peripheral you will use
  * @param  *str: Pointer to string to send over USART
  * @retval None
@@ -594,6 +660,8 @@ void TM_USART_Puts(USART_TypeDef* USARTx, char* str);
 
 /**
  * @brief  Sends data array to USART port
+ * @note   When TX buffer is set with @ref TM_USART_SetTXBuffer(), data are copied to buffer and function returns immediately.
+ *         Data which do not fit into buffer are dropped
  * @param  *USARTx: Pointer to USARTx peripheral you will use
  * @param  *DataArray: Pointer to data array to be sent over USART
  * @param  count: Number of elements in data array to be send over USART
@@ -676,6 +744,8 @@ void TM_USART_SetCustomStringEndCharacter(USART_TypeDef* USARTx, uint8_t Charact
 
 /**
  * @brief  Search for string in USART buffer if exists
+ * @note   Search state is kept for last USART and string used. When called again with the same string pointer,
+ *         only data received since last call are checked, so string content must not change between calls
  * @param  *USARTx: Pointer to USARTx peripheral you will use
  * @param  *str: String to be searched
  * @retval Search status:
@@ -684,6 +754,54 @@ void TM_USART_SetCustomStringEndCharacter(USART_TypeDef* USARTx, uint8_t Charact
  */
 int16_t TM_USART_FindString(USART_TypeDef* USARTx, char* str);
 
+/**
+ * @brief  Gets pointer to internal RX cyclic buffer for USARTx
+ * @note   Used by other libraries (like @ref TM_USART_DMA) which write directly to buffer memory
+ * @param  *USARTx: Pointer to USARTx peripheral you will use
+ * @retval Pointer to @ref TM_BUFFER_t structure for USARTx
+ */
+TM_BUFFER_t* TM_USART_GetBuffer(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Sets TX buffer for USARTx
+ * @note   When set, @ref TM_USART_Puts() and @ref TM_USART_Send() copy data to buffer and call @ref TM_USART_INT_TXBufferCallback().
+ *         Buffer is emptied by other library, use @ref TM_USART_DMA_InitTXBuffer() instead of calling this function directly
+ * @param  *USARTx: Pointer to USARTx peripheral you will use
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure for TX data or NULL to send data directly
+ * @retval None
+ */
+void TM_USART_SetTXBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Gets TX buffer for USARTx
+ * @param  *USARTx: Pointer to USARTx peripheral you will use
+ * @retval Pointer to @ref TM_BUFFER_t structure for TX data or NULL when data are sent directly
+ */
+TM_BUFFER_t* TM_USART_GetTXBuffer(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Changes baudrate and frame format of already initialized USART
+ * @note   USART is not reset, so buffer, interrupts and DMA settings are kept.
+ *         Function waits for last byte to be transmitted, then disables USART for short time.
+ *         USART kernel clock must be PCLK
+ * @param  *USARTx: Pointer to USARTx peripheral you will use
+ * @param  baudrate: New baudrate for USART
+ * @param  WordLength: Word length including parity bit, UART_WORDLENGTH_8B or UART_WORDLENGTH_9B
+ * @param  Parity: Parity, UART_PARITY_NONE, UART_PARITY_EVEN or UART_PARITY_ODD
+ * @param  StopBits: Stop bits, UART_STOPBITS_1 or UART_STOPBITS_2
+ * @retval None
+ */
+void TM_USART_SetFormat(USART_TypeDef* USARTx, uint32_t baudrate, uint32_t WordLength, uint32_t Parity, uint32_t StopBits);
+
+/**
+ * @brief  Sets baudrate again for all initialized USARTs after system clock change
+ * @note   Can be added to @ref TM_RCC library with @ref TM_RCC_AddClockCallback.
+ *         USART kernel clock must be PCLK
+ * @param  None
+ * @retval None
+ */
+void TM_USART_UpdateClock(void);
+
 /**
  * @brief  Callback for custom pins initialization for USARTx.
  *
@@ -696,6 +814,46 @@ int16_t TM_USART_FindString(USART_TypeDef* USARTx, char* str);
  */
 void TM_USART_InitCustomPinsCallback(USART_TypeDef* USARTx, uint16_t AlternateFunction);
 
+/**
+ * @brief  Callback for IDLE line interrupt on USARTx
+ * @note   Called from USART interrupt when IDLE line interrupt is enabled.
+ *         It is implemented in @ref TM_USART_DMA library for RX DMA mode and should not be used by user
+ * @note   With __weak parameter to prevent link errors if not defined
+ * @param  *USARTx: Pointer to USARTx where IDLE line was detected
+ * @retval None
+ */
+void TM_USART_INT_IdleLineCallback(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Callback when new data are added to TX buffer
+ * @note   Called with interrupts disabled from @ref TM_USART_Puts() and @ref TM_USART_Send() in TX buffer mode.
+ *         It is implemented in @ref TM_USART_DMA library and should not be used by user
+ * @note   With __weak parameter to prevent link errors if not defined
+ * @param  *USARTx: Pointer to USARTx with new TX data
+ * @retval None
+ */
+void TM_USART_INT_TXBufferCallback(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Callback for receiver timeout or IDLE line interrupt on USARTx
+ * @note   Called from USART interrupt when receiver timeout interrupt (STM32F0xx and STM32F7xx) or IDLE line interrupt is enabled.
+ *         It is implemented in @ref TM_MODBUS library and should not be used by user
+ * @note   With __weak parameter to prevent link errors if not defined
+ * @param  *USARTx: Pointer to USARTx where receiver timeout was detected
+ * @retval None
+ */
+void TM_USART_INT_RXTimeoutCallback(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Callback for transmission complete interrupt on USARTx
+ * @note   Called from USART interrupt when TC interrupt is enabled, callback must disable it.
+ *         It is implemented in @ref TM_MODBUS library and should not be used by user
+ * @note   With __weak parameter to prevent link errors if not defined
+ * @param  *USARTx: Pointer to USARTx where last byte has been transmitted
+ * @retval None
+ */
+void TM_USART_INT_TXCompleteCallback(USART_TypeDef* USARTx);
+
 /**
  * @brief  Callback function for receive interrupt on USART1 in case you have enabled custom USART handler mode 
  * @note   With __weak parameter to prevent link errors if not defined by user
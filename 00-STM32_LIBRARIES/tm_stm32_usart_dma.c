@@ -22,44 +22,71 @@
 typedef struct {
 	uint32_t DMA_Channel;
 	DMA_Stream_TypeDef* DMA_Stream;
+	uint32_t RX_Channel;
+	DMA_Stream_TypeDef* RX_Stream;
+	TM_DMA_Request_t TX_Request;
+	TM_DMA_Request_t RX_Request;
+	TM_USART_DMA_TX_t TX_Queue[TM_USART_DMA_TX_QUEUE_SIZE];
+	volatile uint16_t TX_In;
+	volatile uint16_t TX_Out;
+	volatile uint8_t TX_Active;
+	TM_BUFFER_t* TX_Buffer;
+	volatile uint16_t TX_Span;
 } TM_USART_DMA_INT_t;
 
+/* Active TX transfer */
+#define USART_DMA_TX_NONE         0
+#define USART_DMA_TX_QUEUED       1
+#define USART_DMA_TX_BUFFER       2
+
 /* Create variables if necessary */
 #ifdef USART1
-static TM_USART_DMA_INT_t USART1_DMA_INT = {USART1_DMA_TX_CHANNEL, USART1_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t USART1_DMA_INT = {USART1_DMA_TX_CHANNEL, USART1_DMA_TX_STREAM, USART1_DMA_RX_CHANNEL, USART1_DMA_RX_STREAM, TM_DMA_Request_USART1_TX, TM_DMA_Request_USART1_RX};
 #endif
 #ifdef USART2
-static TM_USART_DMA_INT_t USART2_DMA_INT = {USART2_DMA_TX_CHANNEL, USART2_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t USART2_DMA_INT = {USART2_DMA_TX_CHANNEL, USART2_DMA_TX_STREAM, USART2_DMA_RX_CHANNEL, USART2_DMA_RX_STREAM, TM_DMA_Request_USART2_TX, TM_DMA_Request_USART2_RX};
 #endif
 #ifdef USART3
-static TM_USART_DMA_INT_t USART3_DMA_INT = {USART3_DMA_TX_CHANNEL, USART3_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t USART3_DMA_INT = {USART3_DMA_TX_CHANNEL, USART3_DMA_TX_STREAM, USART3_DMA_RX_CHANNEL, USART3_DMA_RX_STREAM, TM_DMA_Request_USART3_TX, TM_DMA_Request_USART3_RX};
 #endif
 #ifdef UART4
-static TM_USART_DMA_INT_t UART4_DMA_INT = {UART4_DMA_TX_CHANNEL, UART4_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t UART4_DMA_INT = {UART4_DMA_TX_CHANNEL, UART4_DMA_TX_STREAM, UART4_DMA_RX_CHANNEL, UART4_DMA_RX_STREAM, TM_DMA_Request_UART4_TX, TM_DMA_Request_UART4_RX};
 #endif
 #ifdef UART5
-static TM_USART_DMA_INT_t UART5_DMA_INT = {UART5_DMA_TX_CHANNEL, UART5_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t UART5_DMA_INT = {UART5_DMA_TX_CHANNEL, UART5_DMA_TX_STREAM, UART5_DMA_RX_CHANNEL, UART5_DMA_RX_STREAM, TM_DMA_Request_UART5_TX, TM_DMA_Request_UART5_RX};
 #endif
 #ifdef USART6
-static TM_USART_DMA_INT_t USART6_DMA_INT = {USART6_DMA_TX_CHANNEL, USART6_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t USART6_DMA_INT = {USART6_DMA_TX_CHANNEL, USART6_DMA_TX_STREAM, USART6_DMA_RX_CHANNEL, USART6_DMA_RX_STREAM, TM_DMA_Request_USART6_TX, TM_DMA_Request_USART6_RX};
 #endif
 #ifdef UART7
-static TM_USART_DMA_INT_t UART7_DMA_INT = {UART7_DMA_TX_CHANNEL, UART7_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t UART7_DMA_INT = {UART7_DMA_TX_CHANNEL, UART7_DMA_TX_STREAM, UART7_DMA_RX_CHANNEL, UART7_DMA_RX_STREAM, TM_DMA_Request_UART7_TX, TM_DMA_Request_UART7_RX};
 #endif
 #ifdef UART8
-static TM_USART_DMA_INT_t UART8_DMA_INT = {UART8_DMA_TX_CHANNEL, UART8_DMA_TX_STREAM};
+static TM_USART_DMA_INT_t UART8_DMA_INT = {UART8_DMA_TX_CHANNEL, UART8_DMA_TX_STREAM, UART8_DMA_RX_CHANNEL, UART8_DMA_RX_STREAM, TM_DMA_Request_UART8_TX, TM_DMA_Request_UART8_RX};
 #endif
 
 /* Private functions */
 static TM_USART_DMA_INT_t* TM_USART_DMA_INT_GetSettings(USART_TypeDef* USARTx);
+static void TM_USART_DMA_INT_RXUpdate(USART_TypeDef* USARTx, DMA_Stream_TypeDef* DMA_Stream);
+static void TM_USART_DMA_INT_RXStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+static void TM_USART_DMA_INT_TXStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+static void TM_USART_DMA_INT_StartNext(USART_TypeDef* USARTx, TM_USART_DMA_INT_t* Settings);
+static void TM_USART_DMA_INT_StartStream(USART_TypeDef* USARTx, TM_USART_DMA_INT_t* Settings, uint8_t* DataArray, uint16_t count);
 
 void TM_USART_DMA_Init(USART_TypeDef* USARTx) {
 	/* Init DMA TX mode */
 	/* Assuming USART is already initialized and clock is enabled */
 	
+	DMA_Stream_TypeDef* Stream;
+	
 	/* Get USART settings */
 	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
 	
+	/* Allocate stream, other free stream is selected if default is used by other peripheral */
+	if ((Stream = TM_DMA_Allocate(Settings->TX_Request, TM_DMA_Priority_Default, Settings->DMA_Stream, &Settings->DMA_Channel)) != NULL) {
+		Settings->DMA_Stream = Stream;
+	}
+	
 	/* Init stream */
 	TM_DMA_Init(Settings->DMA_Stream, NULL);
 	
@@ -71,6 +98,14 @@ void TM_USART_DMA_Init(USART_TypeDef* USARTx) {
 	
 	/* Reset NDTR register */
 	Settings->DMA_Stream->NDTR = 0;
+	
+	/* Reset TX queue */
+	Settings->TX_In = 0;
+	Settings->TX_Out = 0;
+	Settings->TX_Active = USART_DMA_TX_NONE;
+	
+	/* Set library callback for TX queue */
+	TM_DMA_SetStreamCallback(Settings->DMA_Stream, TM_USART_DMA_INT_TXStreamCallback, USARTx);
 }
 
 void TM_USART_DMA_InitWithStreamAndChannel(USART_TypeDef* USARTx, DMA_Stream_TypeDef* DMA_Stream, uint32_t DMA_Channel) {
@@ -96,8 +131,14 @@ void TM_USART_DMA_Deinit(USART_TypeDef* USARTx) {
 	/* Get USART settings */
 	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
 	
+	/* Remove library callback */
+	TM_DMA_SetStreamCallback(Settings->DMA_Stream, NULL, NULL);
+	
 	/* Deinit DMA Stream */
 	TM_DMA_DeInit(Settings->DMA_Stream);
+	
+	/* Release stream */
+	TM_DMA_Release(Settings->DMA_Stream, Settings->TX_Request);
 }
 
 uint8_t TM_USART_DMA_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count) {
@@ -143,6 +184,205 @@ uint8_t TM_USART_DMA_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t co
 	return 1;
 }
 
+void TM_USART_DMA_InitRX(USART_TypeDef* USARTx) {
+	DMA_HandleTypeDef DMA_InitStruct;
+	DMA_Stream_TypeDef* Stream;
+	
+	/* Get USART settings and buffer */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	TM_BUFFER_t* Buffer = TM_USART_GetBuffer(USARTx);
+	
+	/* Disable RXNE interrupt, DMA will read data now */
+	USARTx->CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_IDLEIE);
+	USARTx->CR3 &= ~USART_CR3_DMAR;
+	
+	/* Allocate stream, other free stream is selected if default is used by other peripheral */
+	if ((Stream = TM_DMA_Allocate(Settings->RX_Request, TM_DMA_Priority_Default, Settings->RX_Stream, &Settings->RX_Channel)) != NULL) {
+		Settings->RX_Stream = Stream;
+	}
+	
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(Settings->RX_Stream, NULL);
+	Settings->RX_Stream->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(Settings->RX_Stream);
+	
+	/* Discard old data in buffer */
+	TM_BUFFER_Reset(Buffer);
+	
+	/* Set DMA options */
+	DMA_InitStruct.Instance = Settings->RX_Stream;
+	DMA_InitStruct.Init.Channel = Settings->RX_Channel;
+	DMA_InitStruct.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	DMA_InitStruct.Init.PeriphInc = DMA_PINC_DISABLE;
+	DMA_InitStruct.Init.MemInc = DMA_MINC_ENABLE;
+	DMA_InitStruct.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	DMA_InitStruct.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	DMA_InitStruct.Init.Mode = DMA_CIRCULAR;
+	DMA_InitStruct.Init.Priority = DMA_PRIORITY_HIGH;
+	DMA_InitStruct.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	DMA_InitStruct.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	DMA_InitStruct.Init.MemBurst = DMA_MBURST_SINGLE;
+	DMA_InitStruct.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(Settings->RX_Stream, &DMA_InitStruct);
+	
+	/* Set library callback for stream and enable interrupts */
+	TM_DMA_SetStreamCallback(Settings->RX_Stream, TM_USART_DMA_INT_RXStreamCallback, USARTx);
+	TM_DMA_EnableInterrupts(Settings->RX_Stream);
+	
+	/* Start circular transfer to buffer memory */
+	TM_DMA_Start(&DMA_InitStruct, (uint32_t) &USART_RX_REG(USARTx), (uint32_t) &Buffer->Buffer[0], Buffer->Size);
+	
+	/* Enable IDLE line interrupt and USART RX DMA */
+	USARTx->CR1 |= USART_CR1_IDLEIE;
+	USARTx->CR3 |= USART_CR3_DMAR;
+}
+
+void TM_USART_DMA_InitRXWithStreamAndChannel(USART_TypeDef* USARTx, DMA_Stream_TypeDef* DMA_Stream, uint32_t DMA_Channel) {
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Set DMA stream and channel */
+	Settings->RX_Stream = DMA_Stream;
+	Settings->RX_Channel = DMA_Channel;
+	
+	/* Init DMA RX */
+	TM_USART_DMA_InitRX(USARTx);
+}
+
+void TM_USART_DMA_DeinitRX(USART_TypeDef* USARTx) {
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Disable USART RX DMA and IDLE line interrupt */
+	USARTx->CR3 &= ~USART_CR3_DMAR;
+	USARTx->CR1 &= ~USART_CR1_IDLEIE;
+	
+	/* Save last received bytes to buffer */
+	TM_USART_DMA_INT_RXUpdate(USARTx, Settings->RX_Stream);
+	
+	/* Remove callback and deinit DMA stream */
+	TM_DMA_DisableInterrupts(Settings->RX_Stream);
+	TM_DMA_SetStreamCallback(Settings->RX_Stream, NULL, NULL);
+	TM_DMA_DeInit(Settings->RX_Stream);
+	TM_DMA_Release(Settings->RX_Stream, Settings->RX_Request);
+	
+	/* Enable RXNE interrupt again */
+	USARTx->CR1 |= USART_CR1_RXNEIE;
+}
+
+DMA_Stream_TypeDef* TM_USART_DMA_GetStreamRX(USART_TypeDef* USARTx) {
+	/* Get USART settings */
+	return TM_USART_DMA_INT_GetSettings(USARTx)->RX_Stream;
+}
+
+uint8_t TM_USART_DMA_SendQueued(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, TM_USART_DMA_Callback_t Callback, void* Param) {
+	TM_USART_DMA_TX_t* TX;
+	uint16_t next;
+	uint32_t irq;
+	
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Check input data */
+	if (count == 0) {
+		return 0;
+	}
+	
+	/* Check if queue is full */
+	next = Settings->TX_In + 1;
+	if (next >= TM_USART_DMA_TX_QUEUE_SIZE) {
+		next = 0;
+	}
+	if (next == Settings->TX_Out) {
+		return 0;
+	}
+	
+	/* Fill queue entry */
+	TX = &Settings->TX_Queue[Settings->TX_In];
+	TX->DataArray = DataArray;
+	TX->Count = count;
+	TX->Callback = Callback;
+	TX->Param = Param;
+	
+	/* Enable stream interrupts if not already */
+	if (!(Settings->DMA_Stream->CR & DMA_SxCR_TCIE)) {
+		TM_DMA_EnableInterrupts(Settings->DMA_Stream);
+	}
+	
+	/* Disable interrupts */
+	irq = TM_NVIC_Lock();
+	
+	/* Add entry to queue */
+	Settings->TX_In = next;
+	
+	/* Start transfer if DMA is not working now */
+	if (!Settings->TX_Active && !Settings->DMA_Stream->NDTR) {
+		TM_USART_DMA_INT_StartNext(USARTx, Settings);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Data added to queue */
+	return 1;
+}
+
+uint16_t TM_USART_DMA_QueueFree(USART_TypeDef* USARTx) {
+	uint16_t in, out;
+	
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Save values */
+	in = Settings->TX_In;
+	out = Settings->TX_Out;
+	
+	/* Calculate free entries, one entry is always empty */
+	if (in >= out) {
+		return TM_USART_DMA_TX_QUEUE_SIZE - 1 - (in - out);
+	}
+	return out - in - 1;
+}
+
+void TM_USART_DMA_InitTXBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* Buffer) {
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Enable stream interrupts, each part of buffer is started from transfer complete interrupt */
+	TM_DMA_EnableInterrupts(Settings->DMA_Stream);
+	
+	/* Set buffer, TM USART functions write to it from now on */
+	Settings->TX_Buffer = Buffer;
+	TM_USART_SetTXBuffer(USARTx, Buffer);
+}
+
+void TM_USART_DMA_DeinitTXBuffer(USART_TypeDef* USARTx) {
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Send data directly from now on */
+	TM_USART_SetTXBuffer(USARTx, NULL);
+	
+	/* Wait till buffer is empty */
+	while (Settings->TX_Buffer && (Settings->TX_Active || TM_BUFFER_GetFull(Settings->TX_Buffer)));
+	
+	/* Remove buffer */
+	Settings->TX_Buffer = NULL;
+}
+
+/* TX buffer callback from TM USART library, called with interrupts disabled */
+void TM_USART_INT_TXBufferCallback(USART_TypeDef* USARTx) {
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Start transfer if DMA is not working now, otherwise transfer complete interrupt continues with new data */
+	if (!Settings->TX_Active && !Settings->DMA_Stream->NDTR) {
+		TM_USART_DMA_INT_StartNext(USARTx, Settings);
+	}
+}
+
 uint8_t TM_USART_DMA_Puts(USART_TypeDef* USARTx, char* DataArray) {
 	/* Call DMA Send function */
 	return TM_USART_DMA_Send(USARTx, (uint8_t *)DataArray, strlen(DataArray));
@@ -153,7 +393,8 @@ uint16_t TM_USART_DMA_Transmitting(USART_TypeDef* USARTx) {
 	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
 	
 	/* DMA has work to do still */
-	if (Settings->DMA_Stream->NDTR) {
+	if (Settings->DMA_Stream->NDTR || Settings->TX_Active || Settings->TX_Out != Settings->TX_In ||
+		(Settings->TX_Buffer && TM_BUFFER_GetFull(Settings->TX_Buffer))) {
 		return 1;
 	}
 
@@ -177,7 +418,147 @@ void TM_USART_DMA_DisableInterrupts(USART_TypeDef* USARTx) {
 	TM_DMA_DisableInterrupts(Settings->DMA_Stream);
 }
 
+/* IDLE line callback from TM USART library */
+void TM_USART_INT_IdleLineCallback(USART_TypeDef* USARTx) {
+	/* Get USART settings */
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	
+	/* Check if RX DMA is active */
+	if (USARTx->CR3 & USART_CR3_DMAR) {
+		/* Invalidate cache, data received after last half-transfer event are not visible yet */
+		TM_DMA_InvalidateStreamCache(Settings->RX_Stream);
+		
+		TM_USART_DMA_INT_RXUpdate(USARTx, Settings->RX_Stream);
+	}
+}
+
+__weak void TM_USART_DMA_RXCallback(USART_TypeDef* USARTx) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_USART_DMA_RXCallback could be implemented in the user file
+	*/
+}
+
 /* Private functions */
+static void TM_USART_DMA_INT_RXUpdate(USART_TypeDef* USARTx, DMA_Stream_TypeDef* DMA_Stream) {
+	TM_BUFFER_t* Buffer = TM_USART_GetBuffer(USARTx);
+	uint32_t in;
+	
+	/* Calculate position where DMA will write next byte */
+	in = Buffer->Size - DMA_Stream->NDTR;
+	
+	/* Check input overflow */
+	if (in >= Buffer->Size) {
+		in = 0;
+	}
+	
+	/* Nothing new received */
+	if (Buffer->In == in) {
+		return;
+	}
+	
+	/* Move input pointer only, data are already in memory */
+	Buffer->In = in;
+	
+	/* Notify user */
+	TM_USART_DMA_RXCallback(USARTx);
+}
+
+static void TM_USART_DMA_INT_RXStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	/* Update buffer on half-transfer and transfer-complete events */
+	if (flags & (DMA_FLAG_HTIF | DMA_FLAG_TCIF)) {
+		TM_USART_DMA_INT_RXUpdate((USART_TypeDef *)Param, DMA_Stream);
+	}
+}
+
+static void TM_USART_DMA_INT_StartNext(USART_TypeDef* USARTx, TM_USART_DMA_INT_t* Settings) {
+	TM_USART_DMA_TX_t* TX;
+	uint8_t* data;
+	uint32_t count;
+	
+	/* Queued transfers first */
+	if (Settings->TX_Out != Settings->TX_In) {
+		TX = &Settings->TX_Queue[Settings->TX_Out];
+		Settings->TX_Active = USART_DMA_TX_QUEUED;
+		TM_USART_DMA_INT_StartStream(USARTx, Settings, TX->DataArray, TX->Count);
+		return;
+	}
+	
+	/* Send contiguous part of TX buffer, rest is sent on next transfer complete */
+	if (Settings->TX_Buffer && (count = TM_BUFFER_GetReadSpan(Settings->TX_Buffer, &data)) > 0) {
+		if (count > 0xFFFF) {
+			count = 0xFFFF;
+		}
+		Settings->TX_Span = count;
+		Settings->TX_Active = USART_DMA_TX_BUFFER;
+		TM_USART_DMA_INT_StartStream(USARTx, Settings, data, count);
+	}
+}
+
+static void TM_USART_DMA_INT_StartStream(USART_TypeDef* USARTx, TM_USART_DMA_INT_t* Settings, uint8_t* DataArray, uint16_t count) {
+	DMA_Stream_TypeDef* Stream = Settings->DMA_Stream;
+	
+	/* Stream is configured directly, write data from cache to memory */
+	TM_DMA_CleanCache(DataArray, count);
+	
+	/* Disable stream and clear flags */
+	Stream->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(Stream);
+	
+	/* Configure stream directly, keep interrupt settings */
+	/* Memory to peripheral, memory increment, byte size, normal mode */
+	Stream->CR = (Stream->CR & (DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE)) |
+	             Settings->DMA_Channel | DMA_MEMORY_TO_PERIPH | DMA_MINC_ENABLE | DMA_PRIORITY_LOW;
+	Stream->FCR &= ~DMA_SxFCR_DMDIS;
+	Stream->PAR = (uint32_t) &USART_TX_REG(USARTx);
+	Stream->M0AR = (uint32_t) DataArray;
+	Stream->NDTR = count;
+	
+	/* Enable USART TX DMA and start stream */
+	USARTx->CR3 |= USART_CR3_DMAT;
+	Stream->CR |= DMA_SxCR_EN;
+}
+
+static void TM_USART_DMA_INT_TXStreamCallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	USART_TypeDef* USARTx = (USART_TypeDef *)Param;
+	TM_USART_DMA_INT_t* Settings = TM_USART_DMA_INT_GetSettings(USARTx);
+	TM_USART_DMA_TX_t* TX;
+	uint16_t out;
+	
+	/* Check for transfer end, transfer error also ends transfer */
+	if (!(flags & (DMA_FLAG_TCIF | DMA_FLAG_TEIF))) {
+		return;
+	}
+	
+	/* Queued transfer has finished */
+	if (Settings->TX_Active == USART_DMA_TX_QUEUED) {
+		TX = &Settings->TX_Queue[Settings->TX_Out];
+		
+		/* Remove entry from queue */
+		out = Settings->TX_Out + 1;
+		if (out >= TM_USART_DMA_TX_QUEUE_SIZE) {
+			out = 0;
+		}
+		Settings->TX_Out = out;
+		Settings->TX_Active = USART_DMA_TX_NONE;
+		
+		/* Call user callback */
+		if (TX->Callback) {
+			TX->Callback(USARTx, TX->DataArray, TX->Count, TX->Param);
+		}
+	}
+	
+	/* Part of TX buffer has been sent, free memory */
+	if (Settings->TX_Active == USART_DMA_TX_BUFFER) {
+		TM_BUFFER_CommitRead(Settings->TX_Buffer, Settings->TX_Span);
+		Settings->TX_Active = USART_DMA_TX_NONE;
+	}
+	
+	/* Start next transfer from queue or TX buffer, stop when both are empty */
+	if (!Settings->TX_Active) {
+		TM_USART_DMA_INT_StartNext(USARTx, Settings);
+	}
+}
+
 static TM_USART_DMA_INT_t* TM_USART_DMA_INT_GetSettings(USART_TypeDef* USARTx) {
 	TM_USART_DMA_INT_t* result;
 #ifdef USART1
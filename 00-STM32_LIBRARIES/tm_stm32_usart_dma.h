@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2016/04/hal-library-32-dma-extension-for-usart-on-stm32fxxx
- * @version v1.0
+ * @version v1.7
  * @ide     Keil uVision
  * @license MIT
  * @brief   DMA TX functionality for USART for STM32F4xx or STM32F7xx devices
@@ -28,7 +28,7 @@
 @endverbatim
  */
 #ifndef TM_USART_DMA_H
-#define TM_USART_DMA_H 100
+#define TM_USART_DMA_H 170
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -49,8 +49,60 @@ extern "C" {
  *
  * It is great feature because you can do other stuff while DMA sends data to USART.
  *
- * It is designed only for TX data from MCU to other world. For RX, @ref TM_USART library already
- * uses RXNE (RX Not Empty) interrupts when data is available and there is no need for RX DMA too right now.
+ * It is designed for TX data from MCU to other world. For RX, @ref TM_USART library by default
+ * uses RXNE (RX Not Empty) interrupts when data is available, one interrupt per received byte.
+ *
+ * \par RX DMA mode
+ *
+ * For high baudrates, RX can be switched to circular DMA mode using @ref TM_USART_DMA_InitRX() function.
+ * DMA writes received bytes directly into internal USART cyclic buffer memory and only IDLE line,
+ * half-transfer and transfer-complete interrupts update input pointer of buffer.
+ *
+ * All @ref TM_USART read functions (@ref TM_USART_Getc(), @ref TM_USART_Gets(), ...) work as before.
+ * When new data are received, @ref TM_USART_DMA_RXCallback() is called from interrupt.
+ *
+ * @note  DMA does not check for free memory in buffer. If data are not read from buffer fast enough,
+ *        DMA will overwrite unread data. Set USART buffer size (TM_USARTx_BUFFER_SIZE) big enough, max 65535 bytes.
+ *
+ * @note  On STM32F7xx, data cache is invalidated for buffer memory on each RX update by TM DMA library.
+ *        For best performance, put USART buffers in non-cacheable memory, see @ref TM_DMA_ConfigNonCacheableRegion().
+ *
+ * \par TX queue
+ *
+ * @ref TM_USART_DMA_Send() returns 0 when DMA is still working. If you have to send many small frames,
+ * use @ref TM_USART_DMA_SendQueued() instead. Function only saves pointer to your data into TX queue for USART
+ * and DMA transfer complete interrupt starts next transfer from queue by itself.
+ *
+ * Data are not copied, so memory must stay valid until transfer is finished.
+ * For each queued transfer you can set callback function, which is called from DMA interrupt when transfer is completed.
+ *
+ * Default queue depth is 8 transfers for each USART. To change it, open defines.h file and add define:
+ *
+\code
+//Number of TX transfers which can wait in queue for each USART
+#define TM_USART_DMA_TX_QUEUE_SIZE    16
+\endcode
+ *
+ * \par TX buffer mode
+ *
+ * With @ref TM_USART_DMA_InitTXBuffer(), @ref TM_USART_Puts() and @ref TM_USART_Send() from @ref TM_USART library
+ * only copy data to cyclic buffer and return immediately, regardless of baudrate.
+ * DMA sends contiguous part of buffer, transfer complete interrupt sends next part until buffer is empty.
+ *
+\code
+//TX buffer for USART2
+uint8_t TXMemory[1024];
+TM_BUFFER_t TXBuffer;
+
+TM_BUFFER_Init(&TXBuffer, sizeof(TXMemory), TXMemory);
+TM_USART_DMA_Init(USART2);
+TM_USART_DMA_InitTXBuffer(USART2, &TXBuffer);
+
+//Returns immediately
+TM_USART_Puts(USART2, "Hello world\n");
+\endcode
+ *
+ * @note  Data which do not fit into buffer are dropped. Queued transfers are sent before data from buffer.
  *
  * @warning This library works for STM32F4xx and STM32F7xx series only.
  *
@@ -75,6 +127,21 @@ UART5      | DMA1 | DMA Stream 7 | DMA Channel 4
 USART6     | DMA2 | DMA Stream 6 | DMA Channel 5
 UART7      | DMA1 | DMA Stream 1 | DMA Channel 5
 UART8      | DMA1 | DMA Stream 0 | DMA Channel 5
+@endverbatim
+ *
+ * Default DMA streams and channels for RX DMA mode:
+ *
+@verbatim
+USARTx     | DMA  | DMA Stream   | DMA Channel
+
+USART1     | DMA2 | DMA Stream 5 | DMA Channel 4
+USART2     | DMA1 | DMA Stream 5 | DMA Channel 4
+USART3     | DMA1 | DMA Stream 1 | DMA Channel 4
+UART4      | DMA1 | DMA Stream 2 | DMA Channel 4
+UART5      | DMA1 | DMA Stream 0 | DMA Channel 4
+USART6     | DMA2 | DMA Stream 1 | DMA Channel 5
+UART7      | DMA1 | DMA Stream 3 | DMA Channel 5
+UART8      | DMA1 | DMA Stream 6 | DMA Channel 5
 @endverbatim
  *
  * \par Changelog
@@ -82,6 +149,34 @@ UART8      | DMA1 | DMA Stream 0 | DMA Channel 5
 @verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Added circular RX DMA mode with IDLE line detection
+
+ Version 1.2
+  - October 14, 2026
+  - Added TX queue with completion callbacks, @ref TM_USART_DMA_SendQueued() function
+
+ Version 1.3
+  - October 14, 2026
+  - Added data cache maintenance for STM32F7xx devices
+
+ Version 1.4
+  - October 14, 2026
+  - Streams are allocated with TM DMA stream registry, other free stream is used when default stream is taken
+
+ Version 1.5
+  - October 14, 2026
+  - Added @ref TM_USART_DMA_RXCallback() function, called when new data are received in RX DMA mode
+
+ Version 1.6
+  - October 14, 2026
+  - Added TX buffer mode, @ref TM_USART_Puts() and @ref TM_USART_Send() are sent with DMA from cyclic buffer
+
+ Version 1.7
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
 @endverbatim
  *
  * \par Dependencies
@@ -102,8 +197,13 @@ UART8      | DMA1 | DMA Stream 0 | DMA Channel 5
 #include "string.h"
 
 /* Check USART library version */
-#if TM_USART_H < 121
-#error "TM USART library version must be greater or equal to 2.5.0. Please redownload TM USART library!"
+#if TM_USART_H < 200
+#error "TM USART library version must be greater or equal to 2.0. Please redownload TM USART library!"
+#endif
+
+/* Check DMA library version */
+#if TM_DMA_H < 140
+#error "TM DMA library version must be greater or equal to 1.4. Please redownload TM DMA library!"
 #endif
 
 /**
@@ -160,6 +260,59 @@ UART8      | DMA1 | DMA Stream 0 | DMA Channel 5
 #define UART8_DMA_TX_CHANNEL      DMA_CHANNEL_5
 #endif
 
+/* Default DMA Stream and Channel for USART1 RX */
+#ifndef USART1_DMA_RX_STREAM
+#define USART1_DMA_RX_STREAM      DMA2_Stream5
+#define USART1_DMA_RX_CHANNEL     DMA_CHANNEL_4
+#endif
+
+/* Default DMA Stream and Channel for USART2 RX */
+#ifndef USART2_DMA_RX_STREAM
+#define USART2_DMA_RX_STREAM      DMA1_Stream5
+#define USART2_DMA_RX_CHANNEL     DMA_CHANNEL_4
+#endif
+
+/* Default DMA Stream and Channel for USART3 RX */
+#ifndef USART3_DMA_RX_STREAM
+#define USART3_DMA_RX_STREAM      DMA1_Stream1
+#define USART3_DMA_RX_CHANNEL     DMA_CHANNEL_4
+#endif
+
+/* Default DMA Stream and Channel for UART4 RX */
+#ifndef UART4_DMA_RX_STREAM
+#define UART4_DMA_RX_STREAM       DMA1_Stream2
+#define UART4_DMA_RX_CHANNEL      DMA_CHANNEL_4
+#endif
+
+/* Default DMA Stream and Channel for UART5 RX */
+#ifndef UART5_DMA_RX_STREAM
+#define UART5_DMA_RX_STREAM       DMA1_Stream0
+#define UART5_DMA_RX_CHANNEL      DMA_CHANNEL_4
+#endif
+
+/* Default DMA Stream and Channel for USART6 RX */
+#ifndef USART6_DMA_RX_STREAM
+#define USART6_DMA_RX_STREAM      DMA2_Stream1
+#define USART6_DMA_RX_CHANNEL     DMA_CHANNEL_5
+#endif
+
+/* Default DMA Stream and Channel for UART7 RX */
+#ifndef UART7_DMA_RX_STREAM
+#define UART7_DMA_RX_STREAM       DMA1_Stream3
+#define UART7_DMA_RX_CHANNEL      DMA_CHANNEL_5
+#endif
+
+/* Default DMA Stream and Channel for UART8 RX */
+#ifndef UART8_DMA_RX_STREAM
+#define UART8_DMA_RX_STREAM       DMA1_Stream6
+#define UART8_DMA_RX_CHANNEL      DMA_CHANNEL_5
+#endif
+
+/* Number of transfers in TX queue for each USART */
+#ifndef TM_USART_DMA_TX_QUEUE_SIZE
+#define TM_USART_DMA_TX_QUEUE_SIZE    8
+#endif
+
 /**
  * @}
  */
@@ -169,7 +322,29 @@ UART8      | DMA1 | DMA Stream 0 | DMA Channel 5
  * @brief    Library Typedefs
  * @{
  */
-/* Typedefs here */
+
+/**
+ * @brief  TX transfer complete callback
+ * @note   Called from DMA interrupt when DMA has transferred last byte of data to USART.
+ *         USART may still be sending last byte at this point
+ * @param  *USARTx: Pointer to USARTx where transfer was done
+ * @param  *DataArray: Pointer to data passed to @ref TM_USART_DMA_SendQueued() function
+ * @param  count: Number of bytes in transfer
+ * @param  *Param: Pointer to user parameter passed to @ref TM_USART_DMA_SendQueued() function
+ * @retval None
+ */
+typedef void (*TM_USART_DMA_Callback_t)(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, void* Param);
+
+/**
+ * @brief  TX queue entry
+ */
+typedef struct {
+	uint8_t* DataArray;               /*!< Pointer to data to send */
+	uint16_t Count;                   /*!< Number of bytes to send */
+	TM_USART_DMA_Callback_t Callback; /*!< Transfer complete callback, can be NULL */
+	void* Param;                      /*!< User parameter for callback */
+} TM_USART_DMA_TX_t;
+
 /**
  * @}
  */
@@ -229,6 +404,43 @@ void TM_USART_DMA_DisableInterrupts(USART_TypeDef* USARTx);
  */
 DMA_Stream_TypeDef* TM_USART_DMA_GetStreamTX(USART_TypeDef* USARTx);
 
+/**
+ * @brief  Initializes USART circular RX DMA mode
+ * @note   USART HAVE TO be previously initialized using @ref TM_USART library
+ *
+ * @note   RXNE interrupt is disabled and DMA writes received data directly to internal USART buffer.
+ *         Everything in buffer before this call is discarded
+ * @param  *USARTx: Pointer to USARTx where you want to enable RX DMA mode
+ * @retval None
+ */
+void TM_USART_DMA_InitRX(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Initializes USART circular RX DMA mode with custom DMA stream and Channel options
+ * @note   USART HAVE TO be previously initialized using @ref TM_USART library
+ *
+ * @note   Use this function only in case default Stream and Channel settings are not good for you
+ * @param  *USARTx: Pointer to USARTx where you want to enable RX DMA mode
+ * @param  *DMA_Stream: Pointer to DMAy_Streamx, where y is DMA (1 or 2) and x is Stream (0 to 7)
+ * @param  DMA_Channel: Select DMA channel for your USART in specific DMA Stream
+ * @retval None
+ */
+void TM_USART_DMA_InitRXWithStreamAndChannel(USART_TypeDef* USARTx, DMA_Stream_TypeDef* DMA_Stream, uint32_t DMA_Channel);
+
+/**
+ * @brief  Deinitializes USART RX DMA mode and enables RXNE interrupt again
+ * @param  *USARTx: Pointer to USARTx where you want to disable RX DMA mode
+ * @retval None
+ */
+void TM_USART_DMA_DeinitRX(USART_TypeDef* USARTx);
+
+/**
+ * @brief  Gets poitner to DMA RX stream for desired USART 
+ * @param  *USARTx: Pointer to USART where you wanna get its stream pointer
+ * @retval Pointer to DMA stream for desired USART
+ */
+DMA_Stream_TypeDef* TM_USART_DMA_GetStreamRX(USART_TypeDef* USARTx);
+
 /**
  * @brief  Puts string to USART port with DMA
  * @note   Try not to use local variables pointers for DMA memory as parameter *str
@@ -252,6 +464,29 @@ uint8_t TM_USART_DMA_Puts(USART_TypeDef* USARTx, char* str);
  */
 uint8_t TM_USART_DMA_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count);
 
+/**
+ * @brief  Adds data to USART TX DMA queue
+ * @note   USART DMA must be initialized first using @ref TM_USART_DMA_Init() or @ref TM_USART_DMA_InitWithStreamAndChannel() functions.
+ *         Interrupts for TX DMA stream are enabled automatically
+ * @note   Data are not copied. Memory must stay valid until transfer is finished, do not use local variables
+ * @param  *USARTx: Pointer to USARTx to use for send
+ * @param  *DataArray: Pointer to array of data to be sent over USART
+ * @param  count: Number of data bytes to be sent over USART with DMA
+ * @param  Callback: Callback function called when transfer is completed. Set to NULL if not used
+ * @param  *Param: Pointer to user parameter passed to callback function
+ * @retval Queue status:
+ *            - 0: Queue is full, data were not added
+ *            - > 0: Data added to queue
+ */
+uint8_t TM_USART_DMA_SendQueued(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, TM_USART_DMA_Callback_t Callback, void* Param);
+
+/**
+ * @brief  Gets number of free entries in USART TX DMA queue
+ * @param  *USARTx: Pointer to USARTx to check queue for
+ * @retval Number of transfers which can still be added to queue
+ */
+uint16_t TM_USART_DMA_QueueFree(USART_TypeDef* USARTx);
+
 /**
  * @brief  Checks if USART DMA TX is still sending data
  * @param  *USARTx: Pointer to USARTx where you want to check if DMA is still working
@@ -261,6 +496,33 @@ uint8_t TM_USART_DMA_Send(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t co
  */
 uint16_t TM_USART_DMA_Transmitting(USART_TypeDef* USARTx);
 
+/**
+ * @brief  Enables TX buffer mode for USART
+ * @note   @ref TM_USART_DMA_Init() must be called first.
+ *         @ref TM_USART_Puts() and @ref TM_USART_Send() copy data to buffer and DMA sends them in background
+ * @param  *USARTx: Pointer to USARTx peripheral you will use
+ * @param  *Buffer: Pointer to initialized @ref TM_BUFFER_t structure for TX data
+ * @retval None
+ */
+void TM_USART_DMA_InitTXBuffer(USART_TypeDef* USARTx, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Disables TX buffer mode for USART
+ * @note   Function waits until all data from buffer are sent
+ * @param  *USARTx: Pointer to USARTx peripheral you will use
+ * @retval None
+ */
+void TM_USART_DMA_DeinitTXBuffer(USART_TypeDef* USARTx);
+
+/**
+ * @brief  RX data callback in RX DMA mode
+ * @note   Called from IDLE line or DMA interrupt when new data were written to USART buffer
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  *USARTx: Pointer to USARTx where data were received
+ * @retval None
+ */
+void TM_USART_DMA_RXCallback(USART_TypeDef* USARTx);
+
 /**
  * @}
  */
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USB_H
-#define TM_USB_H 100
+#define TM_USB_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -215,6 +215,10 @@ PD5  <-> VBUS_EN |
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Default NVIC priority is taken from TM NVIC priority plan
 \endverbatim
  *
  * \par Dependencies
@@ -288,7 +292,7 @@ PD5  <-> VBUS_EN |
 
 /* NVIC preemption priority */
 #ifndef USB_NVIC_PRIORITY
-#define USB_NVIC_PRIORITY          6
+#define USB_NVIC_PRIORITY          NVIC_PRIORITY_NORMAL
 #endif
 
 /* Defines for FS and HS ID modes */
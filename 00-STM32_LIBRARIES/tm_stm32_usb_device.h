@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB Device library for STM32Fxxx devices
@@ -68,6 +68,10 @@ extern "C" {
  * \par Changelog
  *
 \verbatim
+ Version 1.1
+  - October 14, 2026
+  - Serial number string descriptor is taken from cached identity block in TM ID library
+
  Version 1.0
   - First release
 \endverbatim
@@ -78,6 +82,7 @@ extern "C" {
  - STM32Fxxx HAL
  - defines.h
  - TM USB
+ - TM ID
  - USB Stack
  - USB Device Stack
 \endverbatim
@@ -86,6 +91,7 @@ extern "C" {
 #include "stm32fxxx_hal.h"
 #include "defines.h"
 #include "tm_stm32_usb.h"
+#include "tm_stm32_id.h"
 #include "usbd_def.h"
 #include "usbd_core.h"
 
@@ -0,0 +1,584 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_usb_device_audio.h"
+
+/* Exported functions ------------------------------------------------------- */
+extern USBD_DescriptorsTypeDef AUDIO_Desc;
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define USBD_VID                      0x0483
+#define USBD_PID                      0x5730
+#define USBD_LANGID_STRING            0x409
+#define USBD_MANUFACTURER_STRING      "STMicroelectronics"
+#define USBD_PRODUCT_HS_STRING        "Audio in HS Mode"
+#define USBD_PRODUCT_FS_STRING        "Audio in FS Mode"
+#define USBD_CONFIGURATION_HS_STRING  "Audio Config"
+#define USBD_INTERFACE_HS_STRING      "Audio Interface"
+#define USBD_CONFIGURATION_FS_STRING  "Audio Config"
+#define USBD_INTERFACE_FS_STRING      "Audio Interface"
+
+/* Private macro -------------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+uint8_t *USBD_AUDIO_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_AUDIO_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_AUDIO_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_AUDIO_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_AUDIO_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_AUDIO_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_AUDIO_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+#ifdef USB_SUPPORT_USER_STRING_DESC
+uint8_t *USBD_AUDIO_USRStringDesc(USBD_SpeedTypeDef speed, uint8_t idx, uint16_t *length);  
+#endif /* USB_SUPPORT_USER_STRING_DESC */
+
+/* Private variables ---------------------------------------------------------*/
+USBD_DescriptorsTypeDef AUDIO_Desc = {
+	USBD_AUDIO_DeviceDescriptor,
+	USBD_AUDIO_LangIDStrDescriptor, 
+	USBD_AUDIO_ManufacturerStrDescriptor,
+	USBD_AUDIO_ProductStrDescriptor,
+	USBD_AUDIO_SerialStrDescriptor,
+	USBD_AUDIO_ConfigStrDescriptor,
+	USBD_AUDIO_InterfaceStrDescriptor,  
+};
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
+	0x12,                       /* bLength */
+	USB_DESC_TYPE_DEVICE,       /* bDescriptorType */
+	0x00,                       /* bcdUSB */
+	0x02,
+	0x00,                       /* bDeviceClass */
+	0x00,                       /* bDeviceSubClass */
+	0x00,                       /* bDeviceProtocol */
+	USB_MAX_EP0_SIZE,           /* bMaxPacketSize */
+	LOBYTE(USBD_VID),           /* idVendor */
+	HIBYTE(USBD_VID),           /* idVendor */
+	LOBYTE(USBD_PID),           /* idVendor */
+	HIBYTE(USBD_PID),           /* idVendor */
+	0x00,                       /* bcdDevice rel. 2.00 */
+	0x02,
+	USBD_IDX_MFC_STR,           /* Index of manufacturer string */
+	USBD_IDX_PRODUCT_STR,       /* Index of product string */
+	USBD_IDX_SERIAL_STR,        /* Index of serial number string */
+	USBD_MAX_NUM_CONFIGURATION  /* bNumConfigurations */
+}; /* USB_DeviceDescriptor */
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+	USB_LEN_LANGID_STR_DESC,         
+	USB_DESC_TYPE_STRING,       
+	LOBYTE(USBD_LANGID_STRING),
+	HIBYTE(USBD_LANGID_STRING), 
+};
+
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
+
+/* Class interface callbacks */
+static int8_t TM_USBD_AUDIO_INT_Init(void);
+static int8_t TM_USBD_AUDIO_INT_DeInit(void);
+static int8_t TM_USBD_AUDIO_INT_MicStart(void);
+static int8_t TM_USBD_AUDIO_INT_MicStop(void);
+static uint16_t TM_USBD_AUDIO_INT_MicPacket(uint8_t* pbuf, uint16_t max_len);
+static int8_t TM_USBD_AUDIO_INT_SpkStart(void);
+static int8_t TM_USBD_AUDIO_INT_SpkStop(void);
+static void TM_USBD_AUDIO_INT_SpkPacket(uint8_t* pbuf, uint16_t len);
+static uint32_t TM_USBD_AUDIO_INT_SpkFeedback(void);
+
+static USBD_AUDIO_STREAM_ItfTypeDef TM_USBD_AUDIO_fops = {
+	TM_USBD_AUDIO_INT_Init,
+	TM_USBD_AUDIO_INT_DeInit,
+	TM_USBD_AUDIO_INT_MicStart,
+	TM_USBD_AUDIO_INT_MicStop,
+	TM_USBD_AUDIO_INT_MicPacket,
+	TM_USBD_AUDIO_INT_SpkStart,
+	TM_USBD_AUDIO_INT_SpkStop,
+	TM_USBD_AUDIO_INT_SpkPacket,
+	TM_USBD_AUDIO_INT_SpkFeedback
+};
+
+/* Stream status and statistics */
+static __IO uint8_t AUDIO_Active[2];
+static TM_USBD_AUDIO_Stats_t AUDIO_Stats;
+
+#if USBD_AUDIO_STREAM_USE_MIC
+/* Microphone ring, filled by ADC DMA, samples are interleaved */
+#define MIC_RING_SIZE                 (USBD_AUDIO_MIC_BUFFER * USBD_AUDIO_STREAM_MIC_CHANNELS)
+USBD_AUDIO_MEMORY_SECTION __dma_aligned static uint16_t MicBuffer[MIC_RING_SIZE];
+static const TM_ADC_Channel_t* MIC_Channels;
+static uint16_t MicRead;
+#endif
+
+#if USBD_AUDIO_STREAM_USE_SPK
+/* Speaker ring for each channel, read by DAC DMA */
+USBD_AUDIO_MEMORY_SECTION __dma_aligned static uint16_t SpkBuffer[USBD_AUDIO_STREAM_SPK_CHANNELS][USBD_AUDIO_SPK_BUFFER];
+static uint16_t SpkWrite;
+static uint32_t SpkFillAvg;
+
+/* Current DAC read position in samples */
+#define SPK_READ_POS()                ((uint16_t)(USBD_AUDIO_SPK_BUFFER - DAC1_DMA_STREAM->NDTR))
+#endif
+
+/* Nominal feedback, samples per frame in 10.14 format */
+#define AUDIO_FEEDBACK_NOMINAL        (((uint32_t)USBD_AUDIO_STREAM_FREQ << 14) / 1000)
+
+/* Maximal feedback correction, 1/4 sample per frame */
+#define AUDIO_FEEDBACK_MAX_CORR       4096
+
+/************************************************/
+/*            USER PUBLIC FUNCTIONS             */
+/************************************************/
+TM_USBD_Result_t TM_USBD_AUDIO_Init(TM_USB_t USB_Mode, const TM_ADC_Channel_t* MicChannels) {
+	/* ADC and DAC can be used by one USB only */
+	if (USB_Mode == TM_USB_Both) {
+		return TM_USBD_Result_Error;
+	}
+	
+#if USBD_AUDIO_STREAM_USE_MIC
+	/* Check channels */
+	if (MicChannels == NULL) {
+		return TM_USBD_Result_Error;
+	}
+	MIC_Channels = MicChannels;
+#endif
+	
+#ifdef USB_USE_FS
+	/* Init FS mode */
+	if (USB_Mode == TM_USB_FS) {
+		/* Init FS */
+		USBD_Init(&hUSBDevice_FS, &AUDIO_Desc, USB_ID_FS);
+
+		/* Add Supported Class */
+		USBD_RegisterClass(&hUSBDevice_FS, USBD_AUDIO_STREAM_CLASS);
+
+		/* Add Audio Interface Class */
+		USBD_AUDIO_STREAM_RegisterInterface(&hUSBDevice_FS, &TM_USBD_AUDIO_fops);
+	}
+#endif
+	
+#ifdef USB_USE_HS
+	/* Init HS mode, runs at full speed with internal PHY */
+	if (USB_Mode == TM_USB_HS) {
+		/* Init HS */
+		USBD_Init(&hUSBDevice_HS, &AUDIO_Desc, USB_ID_HS);
+
+		/* Add Supported Class */
+		USBD_RegisterClass(&hUSBDevice_HS, USBD_AUDIO_STREAM_CLASS);
+
+		/* Add Audio Interface Class */
+		USBD_AUDIO_STREAM_RegisterInterface(&hUSBDevice_HS, &TM_USBD_AUDIO_fops);
+	}
+#endif
+	
+	/* Return OK */
+	return TM_USBD_Result_Ok;
+}
+
+uint8_t TM_USBD_AUDIO_IsActive(TM_USBD_AUDIO_Stream_t Stream) {
+	/* Return status */
+	return AUDIO_Active[(uint8_t)Stream & 0x01];
+}
+
+void TM_USBD_AUDIO_GetStats(TM_USBD_AUDIO_Stats_t* Stats) {
+	/* Copy statistics */
+	*Stats = AUDIO_Stats;
+}
+
+__weak void TM_USBD_AUDIO_StreamCallback(TM_USBD_AUDIO_Stream_t Stream, uint8_t Active) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_USBD_AUDIO_StreamCallback could be implemented in the user file
+	*/
+}
+
+/************************************************/
+/*               CLASS CALLBACKS                */
+/************************************************/
+static int8_t TM_USBD_AUDIO_INT_Init(void) {
+	/* Streams are started with alternate settings */
+	return 0;
+}
+
+static int8_t TM_USBD_AUDIO_INT_DeInit(void) {
+	/* Stop active streams */
+	if (AUDIO_Active[TM_USBD_AUDIO_Stream_Mic]) {
+		TM_USBD_AUDIO_INT_MicStop();
+	}
+	if (AUDIO_Active[TM_USBD_AUDIO_Stream_Spk]) {
+		TM_USBD_AUDIO_INT_SpkStop();
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_AUDIO_INT_MicStart(void) {
+#if USBD_AUDIO_STREAM_USE_MIC
+	/* Already running */
+	if (AUDIO_Active[TM_USBD_AUDIO_Stream_Mic]) {
+		return 0;
+	}
+	
+	/* Start circular scan, buffer is split in 2 halves */
+	MicRead = 0;
+	if (TM_ADC_StartScan(USBD_AUDIO_ADC, MIC_Channels, NULL, USBD_AUDIO_STREAM_MIC_CHANNELS, MicBuffer, USBD_AUDIO_MIC_BUFFER / 2, USBD_AUDIO_ADC_TRIGGER)) {
+		return -1;
+	}
+	
+	/* Stream is active */
+	AUDIO_Active[TM_USBD_AUDIO_Stream_Mic] = 1;
+	TM_USBD_AUDIO_StreamCallback(TM_USBD_AUDIO_Stream_Mic, 1);
+#endif
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_AUDIO_INT_MicStop(void) {
+#if USBD_AUDIO_STREAM_USE_MIC
+	/* Check if running */
+	if (!AUDIO_Active[TM_USBD_AUDIO_Stream_Mic]) {
+		return 0;
+	}
+	
+	/* Notify user and stop ADC */
+	TM_USBD_AUDIO_StreamCallback(TM_USBD_AUDIO_Stream_Mic, 0);
+	TM_ADC_StopScan(USBD_AUDIO_ADC);
+	AUDIO_Active[TM_USBD_AUDIO_Stream_Mic] = 0;
+#endif
+	
+	/* Return OK */
+	return 0;
+}
+
+static uint16_t TM_USBD_AUDIO_INT_MicPacket(uint8_t* pbuf, uint16_t max_len) {
+#if USBD_AUDIO_STREAM_USE_MIC
+	uint16_t write, avail, max, i;
+	int16_t sample;
+	
+	/* Check if running */
+	if (!AUDIO_Active[TM_USBD_AUDIO_Stream_Mic]) {
+		return 0;
+	}
+	
+	/* Get samples written by DMA, only complete sequences */
+	write = (MIC_RING_SIZE - USBD_AUDIO_ADC_DMA_STREAM->NDTR) / USBD_AUDIO_STREAM_MIC_CHANNELS;
+	if (write >= USBD_AUDIO_MIC_BUFFER) {
+		write = 0;
+	}
+	avail = (write + USBD_AUDIO_MIC_BUFFER - MicRead) % USBD_AUDIO_MIC_BUFFER;
+	
+	/* Host did not read in time, send newest samples only */
+	max = max_len / (USBD_AUDIO_STREAM_MIC_CHANNELS * 2);
+	if (avail > max) {
+		AUDIO_Stats.MicDropped += avail - AUDIO_STREAM_FRAME_SAMPLES;
+		MicRead = (write + USBD_AUDIO_MIC_BUFFER - AUDIO_STREAM_FRAME_SAMPLES) % USBD_AUDIO_MIC_BUFFER;
+		avail = AUDIO_STREAM_FRAME_SAMPLES;
+	}
+	
+#if defined(STM32F7xx)
+	/* Buffer is written by DMA only */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)MicBuffer, sizeof(MicBuffer));
+#endif
+	
+	/* Convert 12-bit unsigned samples to 16-bit signed, directly to USB packet */
+	for (i = 0; i < avail * USBD_AUDIO_STREAM_MIC_CHANNELS; i++) {
+		sample = (int16_t)((MicBuffer[MicRead * USBD_AUDIO_STREAM_MIC_CHANNELS + (i % USBD_AUDIO_STREAM_MIC_CHANNELS)] - 2048) * 16);
+		*pbuf++ = (uint8_t)sample;
+		*pbuf++ = (uint8_t)(sample >> 8);
+		
+		/* Go to next sequence */
+		if ((i % USBD_AUDIO_STREAM_MIC_CHANNELS) == USBD_AUDIO_STREAM_MIC_CHANNELS - 1) {
+			if (++MicRead >= USBD_AUDIO_MIC_BUFFER) {
+				MicRead = 0;
+			}
+		}
+	}
+	
+	/* Update statistics */
+	AUDIO_Stats.MicSamples += avail;
+	
+	/* Return packet size */
+	return avail * USBD_AUDIO_STREAM_MIC_CHANNELS * 2;
+#else
+	return 0;
+#endif
+}
+
+static int8_t TM_USBD_AUDIO_INT_SpkStart(void) {
+#if USBD_AUDIO_STREAM_USE_SPK
+	uint16_t i;
+	
+	/* Already running */
+	if (AUDIO_Active[TM_USBD_AUDIO_Stream_Spk]) {
+		return 0;
+	}
+	
+	/* Fill with silence, write position is half buffer in front of DAC */
+	for (i = 0; i < USBD_AUDIO_SPK_BUFFER; i++) {
+		SpkBuffer[0][i] = 2048;
+#if USBD_AUDIO_STREAM_SPK_CHANNELS == 2
+		SpkBuffer[1][i] = 2048;
+#endif
+	}
+	SpkWrite = USBD_AUDIO_SPK_BUFFER / 2;
+	SpkFillAvg = (USBD_AUDIO_SPK_BUFFER / 2) << 4;
+	
+#if defined(STM32F7xx)
+	/* Buffer is read by DMA */
+	SCB_CleanDCache_by_Addr((uint32_t *)SpkBuffer, sizeof(SpkBuffer));
+#endif
+	
+	/* Start circular streams */
+	if (TM_DAC_StartStream(TM_DAC_Channel_1, SpkBuffer[0], USBD_AUDIO_SPK_BUFFER / 2, USBD_AUDIO_DAC_TRIGGER)) {
+		return -1;
+	}
+#if USBD_AUDIO_STREAM_SPK_CHANNELS == 2
+	if (TM_DAC_StartStream(TM_DAC_Channel_2, SpkBuffer[1], USBD_AUDIO_SPK_BUFFER / 2, USBD_AUDIO_DAC_TRIGGER)) {
+		TM_DAC_StopWaveform(TM_DAC_Channel_1);
+		return -1;
+	}
+#endif
+	
+	/* Stream is active */
+	AUDIO_Active[TM_USBD_AUDIO_Stream_Spk] = 1;
+	TM_USBD_AUDIO_StreamCallback(TM_USBD_AUDIO_Stream_Spk, 1);
+#endif
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_AUDIO_INT_SpkStop(void) {
+#if USBD_AUDIO_STREAM_USE_SPK
+	/* Check if running */
+	if (!AUDIO_Active[TM_USBD_AUDIO_Stream_Spk]) {
+		return 0;
+	}
+	
+	/* Notify user and stop DAC */
+	TM_USBD_AUDIO_StreamCallback(TM_USBD_AUDIO_Stream_Spk, 0);
+	TM_DAC_StopWaveform(TM_DAC_Channel_1);
+#if USBD_AUDIO_STREAM_SPK_CHANNELS == 2
+	TM_DAC_StopWaveform(TM_DAC_Channel_2);
+#endif
+	AUDIO_Active[TM_USBD_AUDIO_Stream_Spk] = 0;
+#endif
+	
+	/* Return OK */
+	return 0;
+}
+
+static void TM_USBD_AUDIO_INT_SpkPacket(uint8_t* pbuf, uint16_t len) {
+#if USBD_AUDIO_STREAM_USE_SPK
+	uint16_t read, fill, frames, i, start;
+	int16_t sample;
+	
+	/* Check if running */
+	if (!AUDIO_Active[TM_USBD_AUDIO_Stream_Spk]) {
+		return;
+	}
+	
+	/* Samples waiting for DAC */
+	frames = len / (USBD_AUDIO_STREAM_SPK_CHANNELS * 2);
+	read = SPK_READ_POS();
+	if (read >= USBD_AUDIO_SPK_BUFFER) {
+		read = 0;
+	}
+	fill = (SpkWrite + USBD_AUDIO_SPK_BUFFER - read) % USBD_AUDIO_SPK_BUFFER;
+	
+	/* Underrun or overrun, start again half buffer in front of DAC */
+	if (fill < AUDIO_STREAM_FRAME_SAMPLES || (fill + frames) >= (USBD_AUDIO_SPK_BUFFER - AUDIO_STREAM_FRAME_SAMPLES)) {
+		SpkWrite = (read + USBD_AUDIO_SPK_BUFFER / 2) % USBD_AUDIO_SPK_BUFFER;
+		fill = USBD_AUDIO_SPK_BUFFER / 2;
+		AUDIO_Stats.SpkResync++;
+	}
+	
+	/* Convert 16-bit signed samples to 12-bit unsigned, directly to DAC buffer */
+	start = SpkWrite;
+	for (i = 0; i < frames; i++) {
+		sample = (int16_t)(pbuf[0] | (pbuf[1] << 8));
+		SpkBuffer[0][SpkWrite] = (uint16_t)(((int32_t)sample + 32768) >> 4);
+#if USBD_AUDIO_STREAM_SPK_CHANNELS == 2
+		sample = (int16_t)(pbuf[2] | (pbuf[3] << 8));
+		SpkBuffer[1][SpkWrite] = (uint16_t)(((int32_t)sample + 32768) >> 4);
+#endif
+		pbuf += USBD_AUDIO_STREAM_SPK_CHANNELS * 2;
+		
+		if (++SpkWrite >= USBD_AUDIO_SPK_BUFFER) {
+			SpkWrite = 0;
+		}
+	}
+	
+#if defined(STM32F7xx)
+	/* Clean written part, it may wrap */
+	if (frames) {
+		if (start < SpkWrite) {
+			SCB_CleanDCache_by_Addr((uint32_t *)&SpkBuffer[0][start & ~0x0F], ((SpkWrite - (start & ~0x0F)) * 2 + 31) & ~31);
+		} else {
+			SCB_CleanDCache_by_Addr((uint32_t *)SpkBuffer[0], sizeof(SpkBuffer[0]));
+		}
+#if USBD_AUDIO_STREAM_SPK_CHANNELS == 2
+		if (start < SpkWrite) {
+			SCB_CleanDCache_by_Addr((uint32_t *)&SpkBuffer[1][start & ~0x0F], ((SpkWrite - (start & ~0x0F)) * 2 + 31) & ~31);
+		} else {
+			SCB_CleanDCache_by_Addr((uint32_t *)SpkBuffer[1], sizeof(SpkBuffer[1]));
+		}
+#endif
+	}
+#else
+	(void)start;
+#endif
+	
+	/* Filtered buffer fill level, 4 fractional bits */
+	SpkFillAvg += (int32_t)((((uint32_t)fill) << 4) - SpkFillAvg) >> 4;
+	
+	/* Update statistics */
+	AUDIO_Stats.SpkSamples += frames;
+#endif
+}
+
+static uint32_t TM_USBD_AUDIO_INT_SpkFeedback(void) {
+	int32_t corr = 0;
+	
+#if USBD_AUDIO_STREAM_USE_SPK
+	/* Buffer is filling up, ask host for less samples and vice versa */
+	corr = ((int32_t)((USBD_AUDIO_SPK_BUFFER / 2) << 4) - (int32_t)SpkFillAvg) * 16;
+	if (corr > AUDIO_FEEDBACK_MAX_CORR) {
+		corr = AUDIO_FEEDBACK_MAX_CORR;
+	} else if (corr < -AUDIO_FEEDBACK_MAX_CORR) {
+		corr = -AUDIO_FEEDBACK_MAX_CORR;
+	}
+#endif
+	
+	/* Save and return value */
+	AUDIO_Stats.Feedback = (uint32_t)((int32_t)AUDIO_FEEDBACK_NOMINAL + corr);
+	return AUDIO_Stats.Feedback;
+}
+
+/************************************************/
+/*             LIBRARY DESCRIPTORS              */
+/************************************************/
+
+/**
+  * @brief  Returns the device descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = sizeof(USBD_DeviceDesc);
+	return (uint8_t*)USBD_DeviceDesc;
+}
+
+/**
+  * @brief  Returns the LangID string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = sizeof(USBD_LangIDDesc);  
+	return (uint8_t*)USBD_LangIDDesc;
+}
+
+/**
+  * @brief  Returns the product string descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {   
+		USBD_GetString((uint8_t *)USBD_PRODUCT_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_PRODUCT_FS_STRING, USBD_StrDesc, length);    
+	}
+	return USBD_StrDesc;
+}
+
+/**
+  * @brief  Returns the manufacturer string descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	USBD_GetString((uint8_t *)USBD_MANUFACTURER_STRING, USBD_StrDesc, length);
+	return USBD_StrDesc;
+}
+
+/**
+  * @brief  Returns the serial number string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = ID_USB_SERIAL_SIZE;
+
+	/* Serial number string descriptor is cached in identity block */
+	return (uint8_t*)TM_ID_Get()->USBSerial;
+}
+
+/**
+  * @brief  Returns the configuration string descriptor.    
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {  
+		USBD_GetString((uint8_t *)USBD_CONFIGURATION_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_CONFIGURATION_FS_STRING, USBD_StrDesc, length); 
+	}
+	return USBD_StrDesc;  
+}
+
+/**
+  * @brief  Returns the interface string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_AUDIO_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {
+		USBD_GetString((uint8_t *)USBD_INTERFACE_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_INTERFACE_FS_STRING, USBD_StrDesc, length);
+	}
+	return USBD_StrDesc;  
+}
+
@@ -0,0 +1,293 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   USB Audio Device library for STM32Fxxx devices
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_USBD_AUDIO_H
+#define TM_USBD_AUDIO_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_USBD_AUDIO
+ * @brief    USB Audio Device library for STM32Fxxx devices - http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @{
+ *
+ * With this library, your STM32F4xx or STM32F7xx device acts like USB microphone and/or USB speaker.
+ * No driver is needed, all major operating systems support USB Audio 1.0 devices.
+ *
+ * @note  Check @ref TM_USB library for configuration settings first!
+ *
+ * \par Main features
+ *
+\verbatim
+- USB Audio 1.0, 16-bit PCM, mono or stereo, one sampling frequency
+- Microphone: ADC scan with circular DMA, samples are sent directly from DMA buffer position
+- Speaker: DAC stream with circular DMA, host rate follows device clock with feedback endpoint
+- Both directions are asynchronous, sample clock is timer on device
+- Full speed only, works on FS or HS (embedded PHY) USB mode
+\endverbatim
+ *
+ * \par How it works
+ *
+ * ADC and DAC are triggered by timers, which must be configured by user to output TRGO at sampling frequency.
+ * Timers can run all the time or can be started in @ref TM_USBD_AUDIO_StreamCallback when host opens stream.
+ *
+ * On each USB frame (1 ms), position of ADC DMA is read and samples collected since last frame are
+ * converted to signed 16-bit and written to USB packet. Number of samples in packet follows ADC clock exactly.
+ *
+ * Received speaker samples are converted to 12-bit and written to DAC DMA buffer, half of buffer ahead of DMA.
+ * Fill level of buffer is sent to host as rate feedback, so host sends a bit more or less samples per frame.
+ *
+\code
+//Timer 2 and timer 6 are configured to update at 48kHz with TRGO on update
+
+//defines.h
+#define USBD_AUDIO_STREAM_FREQ       48000
+#define USBD_AUDIO_ADC_TRIGGER       ADC_EXTERNALTRIGCONV_T2_TRGO
+#define USBD_AUDIO_DAC_TRIGGER       DAC_TRIGGER_T6_TRGO
+
+//Main program
+const TM_ADC_Channel_t MicChannels[] = {TM_ADC_Channel_0};
+
+TM_USB_Init();
+TM_USBD_AUDIO_Init(TM_USB_FS, MicChannels);
+TM_USBD_Start(TM_USB_FS);
+\endcode
+ *
+ * @note  ADC DMA, DAC DMA and USB interrupts are used. DMA buffers must not be in CCM RAM.
+ * @note  On STM32F7xx, DMA buffers are kept coherent with cache maintenance, or can be placed to DTCM with USBD_AUDIO_MEMORY_SECTION.
+ * @note  Microphone packet must fit to TX FIFO of endpoint 1 set in usbd_conf.c (256 bytes on FS by default).
+ *
+ * \par Defines
+ *
+\verbatim
+//Sampling frequency, functions and number of channels, used by USB audio stream class
+#define USBD_AUDIO_STREAM_FREQ            48000
+#define USBD_AUDIO_STREAM_USE_MIC         1
+#define USBD_AUDIO_STREAM_MIC_CHANNELS    1
+#define USBD_AUDIO_STREAM_USE_SPK         1
+#define USBD_AUDIO_STREAM_SPK_CHANNELS    1
+
+//ADC for microphone, its DMA stream must be the one set in TM ADC library
+#define USBD_AUDIO_ADC                    ADC1
+#define USBD_AUDIO_ADC_DMA_STREAM         ADC1_DMA_STREAM
+#define USBD_AUDIO_ADC_TRIGGER            ADC_EXTERNALTRIGCONV_T2_TRGO
+
+//DAC trigger for speaker, DAC channel 1 is left or mono, DAC channel 2 is right
+#define USBD_AUDIO_DAC_TRIGGER            DAC_TRIGGER_T6_TRGO
+
+//Buffer sizes in samples per channel, multiple of 16
+#define USBD_AUDIO_MIC_BUFFER             (8 * AUDIO_STREAM_FRAME_SAMPLES)
+#define USBD_AUDIO_SPK_BUFFER             (8 * AUDIO_STREAM_FRAME_SAMPLES)
+\endverbatim
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM USB
+ - TM USB DEVICE
+ - TM ADC (only when USBD_AUDIO_STREAM_USE_MIC)
+ - TM DAC (only when USBD_AUDIO_STREAM_USE_SPK)
+ - TM DMA
+ - USB Device Stack
+ - USB Device AUDIO stream
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "attributes.h"
+#include "tm_stm32_usb.h"
+#include "tm_stm32_usb_device.h"
+#include "usbd_core.h"
+#include "usbd_audio_stream.h"
+#include "tm_stm32_adc.h"
+#include "tm_stm32_dac.h"
+
+/**
+ * @defgroup TM_USBD_AUDIO_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* ADC for microphone */
+#ifndef USBD_AUDIO_ADC
+#define USBD_AUDIO_ADC                  ADC1
+#define USBD_AUDIO_ADC_DMA_STREAM       ADC1_DMA_STREAM
+#endif
+#ifndef USBD_AUDIO_ADC_TRIGGER
+#define USBD_AUDIO_ADC_TRIGGER          ADC_EXTERNALTRIGCONV_T2_TRGO
+#endif
+
+/* DAC trigger for speaker */
+#ifndef USBD_AUDIO_DAC_TRIGGER
+#define USBD_AUDIO_DAC_TRIGGER          DAC_TRIGGER_T6_TRGO
+#endif
+
+/* Circular buffer sizes in samples per channel */
+#ifndef USBD_AUDIO_MIC_BUFFER
+#define USBD_AUDIO_MIC_BUFFER           (8 * AUDIO_STREAM_FRAME_SAMPLES)
+#endif
+#ifndef USBD_AUDIO_SPK_BUFFER
+#define USBD_AUDIO_SPK_BUFFER           (8 * AUDIO_STREAM_FRAME_SAMPLES)
+#endif
+
+/* Section attribute for DMA buffers, for example DTCM on STM32F7xx */
+#ifndef USBD_AUDIO_MEMORY_SECTION
+#define USBD_AUDIO_MEMORY_SECTION
+#endif
+
+/* Check settings */
+#if defined(STM32F0xx)
+#error "USB audio needs ADC scan and DAC stream with DMA, STM32F4xx or STM32F7xx only!"
+#endif
+#if defined(USB_USE_ULPI_PHY)
+#error "USB audio supports full speed only, external ULPI PHY is not supported!"
+#endif
+#if (USBD_AUDIO_MIC_BUFFER % 16) || (USBD_AUDIO_SPK_BUFFER % 16)
+#error "USBD_AUDIO_MIC_BUFFER and USBD_AUDIO_SPK_BUFFER must be multiple of 16!"
+#endif
+#if USBD_AUDIO_MIC_BUFFER < 4 * AUDIO_STREAM_FRAME_SAMPLES || USBD_AUDIO_SPK_BUFFER < 4 * AUDIO_STREAM_FRAME_SAMPLES
+#error "Audio buffers must hold at least 4 ms of samples!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_USBD_AUDIO_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Audio stream direction
+ */
+typedef enum {
+	TM_USBD_AUDIO_Stream_Mic = 0x00, /*!< Microphone, device to host */
+	TM_USBD_AUDIO_Stream_Spk         /*!< Speaker, host to device */
+} TM_USBD_AUDIO_Stream_t;
+
+/**
+ * @brief  Audio stream statistics
+ */
+typedef struct {
+	uint32_t MicSamples;  /*!< Samples sent to host, per channel */
+	uint32_t MicDropped;  /*!< Samples dropped because host did not read them in time */
+	uint32_t SpkSamples;  /*!< Samples received from host, per channel */
+	uint32_t SpkResync;   /*!< Number of speaker buffer underruns or overruns */
+	uint32_t Feedback;    /*!< Last feedback value, samples per frame in 10.14 format */
+} TM_USBD_AUDIO_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_USBD_AUDIO_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Initializes USB DEVICE for audio class on specific USB mode
+ * @note   ADC and DAC are started when host opens stream, so timers can be configured before or after
+ * @param  USB_Mode: USB Mode where audio will be enabled, @ref TM_USB_FS or @ref TM_USB_HS. Only one mode can be used, ADC and DAC are shared
+ * @param  *MicChannels: Pointer to USBD_AUDIO_STREAM_MIC_CHANNELS ADC channels for microphone, left channel first. Set to NULL when microphone is disabled
+ * @retval Member of @ref TM_USBD_Result_t enumeration
+ */
+TM_USBD_Result_t TM_USBD_AUDIO_Init(TM_USB_t USB_Mode, const TM_ADC_Channel_t* MicChannels);
+
+/**
+ * @brief  Checks if stream is opened by host
+ * @param  Stream: Stream direction. This parameter can be a value of @ref TM_USBD_AUDIO_Stream_t enumeration
+ * @retval 1 when host streams audio, 0 otherwise
+ */
+uint8_t TM_USBD_AUDIO_IsActive(TM_USBD_AUDIO_Stream_t Stream);
+
+/**
+ * @brief  Gets stream statistics
+ * @param  *Stats: Pointer to @ref TM_USBD_AUDIO_Stats_t structure to fill
+ * @retval None
+ */
+void TM_USBD_AUDIO_GetStats(TM_USBD_AUDIO_Stats_t* Stats);
+
+/**
+ * @brief  Called when host opens or closes stream
+ * @note   Called from USB interrupt, right after ADC or DAC DMA is started or before it is stopped
+ * @param  Stream: Stream direction. This parameter can be a value of @ref TM_USBD_AUDIO_Stream_t enumeration
+ * @param  Active: 1 when stream is opened, 0 when it is closed
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_USBD_AUDIO_StreamCallback(TM_USBD_AUDIO_Stream_t Stream, uint8_t Active);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
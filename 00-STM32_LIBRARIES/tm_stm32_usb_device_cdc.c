@@ -38,12 +38,6 @@
 #define USBD_CONFIGURATION_FS_STRING  "VCP Config"
 #define USBD_INTERFACE_FS_STRING      "VCP Interface"
 
-#define DEVICE_ID1                    (0x1FFF7A10)
-#define DEVICE_ID2                    (0x1FFF7A14)
-#define DEVICE_ID3                    (0x1FFF7A18)
-
-#define USB_SIZ_STRING_SERIAL         0x1A
-
 /* Private macro -------------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
 uint8_t *USBD_VCP_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
@@ -72,7 +66,7 @@ USBD_DescriptorsTypeDef VCP_Desc = {
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
 	#pragma data_alignment=4   
 #endif
-__ALIGN_BEGIN uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
+__ALIGN_BEGIN static uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
 	0x12,                       /* bLength */
 	USB_DESC_TYPE_DEVICE,       /* bDescriptorType */
 	0x00,                       /* bcdUSB */
@@ -97,26 +91,17 @@ __ALIGN_BEGIN uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
   #pragma data_alignment=4   
 #endif
-__ALIGN_BEGIN uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+__ALIGN_BEGIN static uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
 	USB_LEN_LANGID_STR_DESC,         
 	USB_DESC_TYPE_STRING,       
 	LOBYTE(USBD_LANGID_STRING),
 	HIBYTE(USBD_LANGID_STRING), 
 };
 
-uint8_t USBD_StringSerial[USB_SIZ_STRING_SERIAL] = {
-	USB_SIZ_STRING_SERIAL,      
-	USB_DESC_TYPE_STRING,    
-};
-
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
   #pragma data_alignment=4   
 #endif
-__ALIGN_BEGIN uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
-
-/* Private functions ---------------------------------------------------------*/
-static void IntToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len);
-static void Get_SerialNum(void);
+__ALIGN_BEGIN static uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
 
 /* External variable */
 extern USBD_CDC_LineCodingTypeDef linecoding[];
@@ -135,6 +120,26 @@ uint8_t USBD_CDC_Buffer_Data_HS_RX[USBD_CDC_RECEIVE_BUFFER_SIZE_HS];
 uint8_t USBD_CDC_Buffer_Data_HS_TX[USBD_CDC_TRANSMIT_BUFFER_SIZE_HS];
 #endif
 
+/* Transfer state for each USB mode */
+typedef struct {
+	TM_BUFFER_t* RX;        /* Ring buffer for received data */
+	TM_BUFFER_t* TX;        /* Ring buffer for data to transmit */
+	uint8_t* RxTmp;         /* One packet memory when RX buffer has no contiguous space */
+	uint32_t TxPending;     /* Number of bytes in transfer, sent directly from TX buffer memory */
+	uint8_t TxZLP;          /* Last transfer was multiple of packet size, zero length packet is needed */
+	uint8_t RxDirect;       /* OUT endpoint receives directly to RX buffer memory */
+	uint8_t RxStopped;      /* OUT endpoint is not armed, RX buffer is full */
+} TM_USBD_CDC_INT_t;
+
+#ifdef USB_USE_FS
+static uint8_t USBD_CDC_Tmp_FS_RX[CDC_DATA_FS_OUT_PACKET_SIZE];
+static TM_USBD_CDC_INT_t USBD_CDC_INT_FS = {&USBD_CDC_Buffer_FS_RX, &USBD_CDC_Buffer_FS_TX, USBD_CDC_Tmp_FS_RX};
+#endif
+#ifdef USB_USE_HS
+static uint8_t USBD_CDC_Tmp_HS_RX[CDC_DATA_HS_OUT_PACKET_SIZE];
+static TM_USBD_CDC_INT_t USBD_CDC_INT_HS = {&USBD_CDC_Buffer_HS_RX, &USBD_CDC_Buffer_HS_TX, USBD_CDC_Tmp_HS_RX};
+#endif
+
 /* Returns pointer to RX buffer for USB */
 static TM_BUFFER_t* TM_USBD_CDC_INT_GetRXBuffer(TM_USB_t USB_Mode) {
 	TM_BUFFER_t* Buffer = 0;
@@ -154,23 +159,158 @@ static TM_BUFFER_t* TM_USBD_CDC_INT_GetRXBuffer(TM_USB_t USB_Mode) {
 	return Buffer;
 }
 
-/* Returns pointer to TX buffer for USB */
-static TM_BUFFER_t* TM_USBD_CDC_INT_GetTXBuffer(TM_USB_t USB_Mode) {
-	TM_BUFFER_t* Buffer = 0;
+/* Returns pointer to transfer state for USB mode */
+static TM_USBD_CDC_INT_t* TM_USBD_CDC_INT_GetMode(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_INT_t* CDC = 0;
 	
 #ifdef USB_USE_FS
 	if (USB_Mode == TM_USB_FS) {
-		Buffer = &USBD_CDC_Buffer_FS_TX;
+		CDC = &USBD_CDC_INT_FS;
 	}
 #endif
 #ifdef USB_USE_HS
 	if (USB_Mode == TM_USB_HS) {
-		Buffer = &USBD_CDC_Buffer_HS_TX;
+		CDC = &USBD_CDC_INT_HS;
 	}
 #endif
 
 	/* Return pointer */
-	return Buffer;
+	return CDC;
+}
+
+/* Returns pointer to active TX buffer for USB */
+static TM_BUFFER_t* TM_USBD_CDC_INT_GetTXBuffer(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_INT_t* CDC = TM_USBD_CDC_INT_GetMode(USB_Mode);
+	
+	/* Return pointer */
+	return CDC ? CDC->TX : 0;
+}
+
+/* Returns pointer to transfer state for USB */
+static TM_USBD_CDC_INT_t* TM_USBD_CDC_INT_Get(USBD_HandleTypeDef* pdev) {
+	TM_USBD_CDC_INT_t* CDC = 0;
+	
+#ifdef USB_USE_FS
+	if (pdev->id == USB_ID_FS) {
+		CDC = &USBD_CDC_INT_FS;
+	}
+#endif
+#ifdef USB_USE_HS
+	if (pdev->id == USB_ID_HS) {
+		CDC = &USBD_CDC_INT_HS;
+	}
+#endif
+
+	/* Return pointer */
+	return CDC;
+}
+
+/* Sets memory for next OUT transfer, returns 0 if RX buffer has no space for full packet */
+static uint8_t TM_USBD_CDC_INT_SetRxBuffer(USBD_HandleTypeDef* pdev, TM_USBD_CDC_INT_t* CDC) {
+	uint32_t size = pdev->dev_speed == USBD_SPEED_HIGH ? CDC_DATA_HS_OUT_PACKET_SIZE : CDC_DATA_FS_OUT_PACKET_SIZE;
+	uint8_t* ptr;
+	
+	if (TM_BUFFER_GetWriteSpan(CDC->RX, &ptr) >= size) {
+		/* Receive directly to RX buffer memory */
+		CDC->RxDirect = 1;
+	} else if (TM_BUFFER_GetFree(CDC->RX) >= size) {
+		/* Packet wraps around buffer end, receive to temporary memory and copy */
+		CDC->RxDirect = 0;
+		ptr = CDC->RxTmp;
+	} else {
+		/* No memory, endpoint will NAK until user reads data */
+		CDC->RxStopped = 1;
+		return 0;
+	}
+	
+	/* Set pointer */
+	CDC->RxStopped = 0;
+	USBD_CDC_SetRxBuffer(pdev, ptr);
+	
+	/* Endpoint can be armed */
+	return 1;
+}
+
+/* Starts next IN transfer from TX buffer memory, TX must not be working */
+static void TM_USBD_CDC_INT_Transmit(USBD_HandleTypeDef* pdev, TM_USBD_CDC_INT_t* CDC) {
+	uint32_t size = pdev->dev_speed == USBD_SPEED_HIGH ? CDC_DATA_HS_IN_PACKET_SIZE : CDC_DATA_FS_IN_PACKET_SIZE;
+	uint32_t count;
+	uint8_t* ptr;
+	
+	/* Previous transfer was sent directly from buffer memory, release it now */
+	if (CDC->TxPending) {
+		TM_BUFFER_CommitRead(CDC->TX, CDC->TxPending);
+		CDC->TxPending = 0;
+	}
+	
+	/* Get data in TX buffer, without copy */
+	count = TM_BUFFER_GetReadSpan(CDC->TX, &ptr);
+	if (count > USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE) {
+		count = USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE;
+	}
+	
+	/* Nothing to send */
+	if (count == 0) {
+		/* Host waits for short packet when transfer ends on packet boundary */
+		if (CDC->TxZLP) {
+			CDC->TxZLP = 0;
+			USBD_CDC_SetTxBuffer(pdev, ptr, 0);
+			USBD_CDC_TransmitPacket(pdev);
+		}
+		return;
+	}
+	
+	/* Memory is released when transfer is done */
+	CDC->TxPending = count;
+	CDC->TxZLP = (count % size) == 0;
+	
+	/* Send data, multiple packets in one transfer */
+	USBD_CDC_SetTxBuffer(pdev, ptr, count);
+	USBD_CDC_TransmitPacket(pdev);
+}
+
+/* Starts transfers which are not started from USB interrupt */
+static void TM_USBD_CDC_INT_Process(USBD_HandleTypeDef* pdev) {
+	USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef *) pdev->pClassData;
+	TM_USBD_CDC_INT_t* CDC = TM_USBD_CDC_INT_Get(pdev);
+	uint32_t irq;
+	
+	/* Not configured by host yet */
+	if (hcdc == NULL || CDC == NULL) {
+		return;
+	}
+	
+	/* Disable interrupts, USB interrupt uses the same state */
+	irq = TM_NVIC_Lock();
+	
+	/* If TX is not working, next transfers are started from transfer complete callback */
+	if (!hcdc->TxState) {
+		TM_USBD_CDC_INT_Transmit(pdev, CDC);
+	}
+	
+	/* User has read data, enable receive again */
+	if (CDC->RxStopped && TM_USBD_CDC_INT_SetRxBuffer(pdev, CDC)) {
+		USBD_CDC_ReceivePacket(pdev);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+void TM_USBD_CDC_INT_InitBuffers(TM_USB_t USB_Mode) {
+#ifdef USB_USE_FS
+	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
+		TM_BUFFER_Init(&USBD_CDC_Buffer_FS_RX, USBD_CDC_RECEIVE_BUFFER_SIZE_FS, USBD_CDC_Buffer_Data_FS_RX);
+		TM_BUFFER_Init(&USBD_CDC_Buffer_FS_TX, USBD_CDC_TRANSMIT_BUFFER_SIZE_FS, USBD_CDC_Buffer_Data_FS_TX);
+	}
+#endif
+	
+#ifdef USB_USE_HS
+	if (USB_Mode == TM_USB_HS || USB_Mode == TM_USB_Both) {
+		TM_BUFFER_Init(&USBD_CDC_Buffer_HS_RX, USBD_CDC_RECEIVE_BUFFER_SIZE_HS, USBD_CDC_Buffer_Data_HS_RX);
+		TM_BUFFER_Init(&USBD_CDC_Buffer_HS_TX, USBD_CDC_TRANSMIT_BUFFER_SIZE_HS, USBD_CDC_Buffer_Data_HS_TX);
+	}
+#endif
 }
 
 /************************************************/
@@ -188,10 +328,6 @@ TM_USBD_Result_t TM_USBD_CDC_Init(TM_USB_t USB_Mode) {
 
 		/* Add CDC Interface Class */
 		USBD_CDC_RegisterInterface(&hUSBDevice_FS, &USBD_CDC_fops[0]);
-		
-		/* Init buffers for TX and RX */
-		TM_BUFFER_Init(&USBD_CDC_Buffer_FS_RX, USBD_CDC_RECEIVE_BUFFER_SIZE_FS, USBD_CDC_Buffer_Data_FS_RX);
-		TM_BUFFER_Init(&USBD_CDC_Buffer_FS_TX, USBD_CDC_TRANSMIT_BUFFER_SIZE_FS, USBD_CDC_Buffer_Data_FS_TX);
 	}
 #endif
 	
@@ -206,75 +342,33 @@ TM_USBD_Result_t TM_USBD_CDC_Init(TM_USB_t USB_Mode) {
 
 		/* Add CDC Interface Class */
 		USBD_CDC_RegisterInterface(&hUSBDevice_HS, &USBD_CDC_fops[1]);
-		
-		/* Init buffers for TX and RX */
-		TM_BUFFER_Init(&USBD_CDC_Buffer_HS_RX, USBD_CDC_RECEIVE_BUFFER_SIZE_HS, USBD_CDC_Buffer_Data_HS_RX);
-		TM_BUFFER_Init(&USBD_CDC_Buffer_HS_TX, USBD_CDC_TRANSMIT_BUFFER_SIZE_HS, USBD_CDC_Buffer_Data_HS_TX);
 	}
 #endif
 	
+	/* Init buffers for TX and RX */
+	TM_USBD_CDC_INT_InitBuffers(USB_Mode);
+	
 	/* Return OK */
 	return TM_USBD_Result_Ok;
 }
 
 void TM_USBD_CDC_Process(TM_USB_t USB_Mode) {
-#if defined(USB_USE_FS) || defined(USB_USE_HS)
-	USBD_HandleTypeDef *pdev;
-	USBD_CDC_HandleTypeDef *hcdc;
-#endif
-
 #ifdef USB_USE_FS
 	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
-		static uint8_t USBD_CDC_tmp_FS[USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE];
-		uint16_t readFS;
-		
-		/* Get pointer */
-		pdev = TM_USBD_GetUSBPointer(TM_USB_FS);
-		hcdc = (USBD_CDC_HandleTypeDef *) pdev->pClassData;
-		
-		/* If TX is not working */
-		if (!hcdc->TxState) {
-			/* Check number of elements in TX buffer for FS */
-			readFS = TM_BUFFER_Read(&USBD_CDC_Buffer_FS_TX, USBD_CDC_tmp_FS, sizeof(USBD_CDC_tmp_FS));
-			
-			/* Check if read anything */
-			if (readFS) {
-				/* Send data */
-				USBD_CDC_SetTxBuffer(pdev, USBD_CDC_tmp_FS, readFS);
-				USBD_CDC_TransmitPacket(pdev);
-			}
-		}
+		TM_USBD_CDC_INT_Process(TM_USBD_GetUSBPointer(TM_USB_FS));
 	}
 #endif
 	
 #ifdef USB_USE_HS
 	if (USB_Mode == TM_USB_HS || USB_Mode == TM_USB_Both) {
-		static uint8_t USBD_CDC_tmp_HS[USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE];
-		uint16_t readHS;
-		
-		/* Get pointer */
-		pdev = TM_USBD_GetUSBPointer(TM_USB_HS);
-		hcdc = (USBD_CDC_HandleTypeDef *) pdev->pClassData;
-		
-		/* If TX is not working */
-		if (!hcdc->TxState) {
-			/* Check number of elements in TX buffer for HS */
-			readHS = TM_BUFFER_Read(&USBD_CDC_Buffer_HS_TX, USBD_CDC_tmp_HS, sizeof(USBD_CDC_tmp_HS));
-			
-			/* Check if read anything */
-			if (readHS) {
-				/* Send data */
-				USBD_CDC_SetTxBuffer(pdev, USBD_CDC_tmp_HS, readHS);
-				USBD_CDC_TransmitPacket(pdev);
-			}
-		}
+		TM_USBD_CDC_INT_Process(TM_USBD_GetUSBPointer(TM_USB_HS));
 	}
 #endif
 }
 
 uint16_t TM_USBD_CDC_Putc(TM_USB_t USB_Mode, char ch) {
 	/* Check for write */
-	if (TM_BUFFER_Write(TM_USBD_CDC_INT_GetTXBuffer(USB_Mode), (uint8_t *)&ch, 1)) {
+	if (TM_BUFFER_WriteByte(TM_USBD_CDC_INT_GetTXBuffer(USB_Mode), (uint8_t)ch)) {
 		/* Process */
 		TM_USBD_CDC_Process(USB_Mode);
 		
@@ -312,7 +406,10 @@ uint16_t TM_USBD_CDC_PutArray(TM_USB_t USB_Mode, uint8_t* buff, uint16_t count)
 
 uint8_t TM_USBD_CDC_Getc(TM_USB_t USB_Mode, char* ch) {
 	/* Try to read from buffer */
-	if (TM_BUFFER_Read(TM_USBD_CDC_INT_GetRXBuffer(USB_Mode), (uint8_t *)ch, 1)) {
+	if (TM_BUFFER_ReadByte(TM_USBD_CDC_INT_GetRXBuffer(USB_Mode), (uint8_t *)ch)) {
+		/* Memory released, receive again if stopped */
+		TM_USBD_CDC_Process(USB_Mode);
+		
 		/* Character read */
 		return 1;
 	}
@@ -322,13 +419,71 @@ uint8_t TM_USBD_CDC_Getc(TM_USB_t USB_Mode, char* ch) {
 }
 
 uint16_t TM_USBD_CDC_Gets(TM_USB_t USB_Mode, char* buff, uint16_t buffsize) {
-	/* Return buffer value */
-	return TM_BUFFER_ReadString(TM_USBD_CDC_INT_GetRXBuffer(USB_Mode), (char *)buff, buffsize);
+	uint16_t ret;
+	
+	/* Read and process */
+	if ((ret = TM_BUFFER_ReadString(TM_USBD_CDC_INT_GetRXBuffer(USB_Mode), (char *)buff, buffsize)) > 0) {
+		TM_USBD_CDC_Process(USB_Mode);
+	}
+	
+	/* Return number of elements in string */
+	return ret;
 }
 
 uint16_t TM_USBD_CDC_GetArray(TM_USB_t USB_Mode, uint8_t* buff, uint16_t count) {
-	/* Return buffer value */
-	return TM_BUFFER_Read(TM_USBD_CDC_INT_GetRXBuffer(USB_Mode), buff, count);
+	uint16_t ret;
+	
+	/* Read and process */
+	if ((ret = TM_BUFFER_Read(TM_USBD_CDC_INT_GetRXBuffer(USB_Mode), buff, count)) > 0) {
+		TM_USBD_CDC_Process(USB_Mode);
+	}
+	
+	/* Return number of elements read */
+	return ret;
+}
+
+TM_BUFFER_t* TM_USBD_CDC_GetRXBuffer(TM_USB_t USB_Mode) {
+	return TM_USBD_CDC_INT_GetRXBuffer(USB_Mode);
+}
+
+uint8_t TM_USBD_CDC_SetTXBuffer(TM_USB_t USB_Mode, TM_BUFFER_t* Buffer) {
+	TM_USBD_CDC_INT_t* CDC = TM_USBD_CDC_INT_GetMode(USB_Mode);
+	uint8_t ret = 0;
+	uint32_t irq;
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return 0;
+	}
+	
+	/* Use internal buffer */
+	if (Buffer == NULL) {
+#ifdef USB_USE_FS
+		if (USB_Mode == TM_USB_FS) {
+			Buffer = &USBD_CDC_Buffer_FS_TX;
+		}
+#endif
+#ifdef USB_USE_HS
+		if (USB_Mode == TM_USB_HS) {
+			Buffer = &USBD_CDC_Buffer_HS_TX;
+		}
+#endif
+	}
+	
+	/* Disable interrupts, USB interrupt uses the same state */
+	irq = TM_NVIC_Lock();
+	
+	/* Memory of current transfer must be released from the same buffer */
+	if (CDC->TxPending == 0) {
+		CDC->TX = Buffer;
+		ret = 1;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return status */
+	return ret;
 }
 
 void TM_USBD_CDC_GetSettings(TM_USB_t USB_Mode, TM_USBD_CDC_Settings_t* Settings) {
@@ -367,22 +522,66 @@ void TM_USBD_CDC_GetSettings(TM_USB_t USB_Mode, TM_USBD_CDC_Settings_t* Settings
 	}
 }
 
+__weak void TM_USBD_CDC_ReceiveCallback(TM_USB_t USB_Mode) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_USBD_CDC_ReceiveCallback could be implemented in the user file
+	*/
+}
+
 /************************************************/
 /*               PRIVATE FUNCTIONS              */
 /************************************************/
-void TM_USBD_CDC_INT_AddToBuffer(USBD_HandleTypeDef* pdev, uint8_t* Values, uint16_t Num) {
-#ifdef USB_USE_FS
-	if (pdev->id == USB_ID_FS) {
-		/* Write to FS RX buffer */
-		TM_BUFFER_Write(&USBD_CDC_Buffer_FS_RX, Values, Num);
+void TM_USBD_CDC_INT_Init(USBD_HandleTypeDef* pdev) {
+	TM_USBD_CDC_INT_t* CDC = TM_USBD_CDC_INT_Get(pdev);
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return;
 	}
-#endif	
-#ifdef USB_USE_HS
-	if (pdev->id == USB_ID_HS) {
-		/* Write to FS TX buffer */
-		TM_BUFFER_Write(&USBD_CDC_Buffer_HS_RX, Values, Num);
+	
+	/* Data in unfinished transfer are sent again */
+	CDC->TxPending = 0;
+	CDC->TxZLP = 0;
+	
+	/* Set memory for first OUT transfer, armed by class driver */
+	TM_USBD_CDC_INT_SetRxBuffer(pdev, CDC);
+}
+
+void TM_USBD_CDC_INT_Receive(USBD_HandleTypeDef* pdev, uint8_t* Values, uint16_t Num) {
+	TM_USBD_CDC_INT_t* CDC = TM_USBD_CDC_INT_Get(pdev);
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return;
 	}
-#endif
+	
+	if (CDC->RxDirect) {
+		/* Data are already in buffer memory */
+		TM_BUFFER_CommitWrite(CDC->RX, Num);
+	} else {
+		/* Copy from temporary memory */
+		TM_BUFFER_Write(CDC->RX, Values, Num);
+	}
+	
+	/* Prepare for next if there is memory */
+	if (TM_USBD_CDC_INT_SetRxBuffer(pdev, CDC)) {
+		USBD_CDC_ReceivePacket(pdev);
+	}
+	
+	/* Notify user, USB ID is the same as USB mode */
+	TM_USBD_CDC_ReceiveCallback((TM_USB_t)pdev->id);
+}
+
+void TM_USBD_CDC_INT_TransmitCplt(USBD_HandleTypeDef* pdev) {
+	TM_USBD_CDC_INT_t* CDC = TM_USBD_CDC_INT_Get(pdev);
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return;
+	}
+	
+	/* Release sent memory and start next transfer */
+	TM_USBD_CDC_INT_Transmit(pdev, CDC);
 }
 
 /************************************************/
@@ -443,12 +642,10 @@ uint8_t *USBD_VCP_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *l
   * @retval Pointer to descriptor buffer
   */
 uint8_t *USBD_VCP_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
-	*length = USB_SIZ_STRING_SERIAL;
+	*length = ID_USB_SERIAL_SIZE;
 
-	/* Update the serial number string descriptor with the data from the unique ID */
-	Get_SerialNum();
-
-	return (uint8_t*)USBD_StringSerial;
+	/* Serial number string descriptor is cached in identity block */
+	return (uint8_t*)TM_ID_Get()->USBSerial;
 }
 
 /**
@@ -481,46 +678,3 @@ uint8_t *USBD_VCP_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *leng
 	return USBD_StrDesc;  
 }
 
-/**
-  * @brief  Create the serial number string descriptor 
-  * @param  None 
-  * @retval None
-  */
-static void Get_SerialNum(void) {
-	uint32_t deviceserial0, deviceserial1, deviceserial2;
-
-	deviceserial0 = *(uint32_t*)DEVICE_ID1;
-	deviceserial1 = *(uint32_t*)DEVICE_ID2;
-	deviceserial2 = *(uint32_t*)DEVICE_ID3;
-
-	deviceserial0 += deviceserial2;
-
-	if (deviceserial0 != 0) {
-		IntToUnicode (deviceserial0, &USBD_StringSerial[2] ,8);
-		IntToUnicode (deviceserial1, &USBD_StringSerial[18] ,4);
-	}
-}
-
-/**
-  * @brief  Convert Hex 32Bits value into char 
-  * @param  value: value to convert
-  * @param  pbuf: pointer to the buffer 
-  * @param  len: buffer length
-  * @retval None
-  */
-static void IntToUnicode (uint32_t value, uint8_t *pbuf , uint8_t len) {
-	uint8_t idx = 0;
-
-	for (idx = 0; idx < len; idx++) {
-		if (((value >> 28)) < 0xA) {
-			pbuf[2 * idx] = (value >> 28) + '0';
-		} else {
-			pbuf[2 * idx] = (value >> 28) + 'A' - 10; 
-		}
-		
-		value = value << 4;
-
-		pbuf[ 2* idx + 1] = 0;
-	}
-}
-
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.4
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB CDC Device library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USBD_CDC_H
-#define TM_USBD_CDC_H 100
+#define TM_USBD_CDC_H 140
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -62,7 +62,26 @@ extern "C" {
 - Works on USB FS or HS mode
 - Can receive/transmit single character, string or custom array
 - Buffer sizes can be selected for user needs
+- Data are received and transmitted directly from ring buffer memory
 \endverbatim
+ *
+ * \par Transfers
+ *
+ * OUT endpoint receives data directly to free memory in RX buffer. When received packet would wrap around
+ * buffer end, one packet temporary memory is used and data are copied. When RX buffer has no space for
+ * one full packet, endpoint NAKs host until user reads data with @ref TM_USBD_CDC_Getc, @ref TM_USBD_CDC_Gets
+ * or @ref TM_USBD_CDC_GetArray function.
+ *
+ * IN endpoint sends data directly from TX buffer memory. Next transfer is started from USB interrupt
+ * when previous is done, so @ref TM_USBD_CDC_Process has to be called only to start first transfer.
+ * Put functions already call it.
+ *
+ * Other libraries can consume RX buffer directly with @ref TM_BUFFER span functions, see @ref TM_USBD_CDC_GetRXBuffer,
+ * and IN endpoint can send from any other buffer, see @ref TM_USBD_CDC_SetTXBuffer. @ref TM_USBD_CDC_BRIDGE uses this
+ * to connect CDC with UART without copy.
+ *
+ * @note  RX buffer must be larger than one OUT packet, 64 bytes in FS mode and 512 bytes in HS mode.
+ *        Power of 2 buffer sizes are recommended for best speed.
  *
  * \par Read terminal settings
  *
@@ -102,15 +121,10 @@ extern "C" {
 //Set this to large value if you will use HS mode with a lot of transmit data to USB CDC
 #define USBD_CDC_TRANSMIT_BUFFER_SIZE_HS   USBD_CDC_BUFFER_SIZE
 
-//Temporary buffer TX size for USB transmissions
-//Used for temporary storage data for USB transmission
+//Maximal TX size for one USB transmission
+//Data are sent directly from TX buffer memory, no temporary storage is used
 //Set to large value if a lot of data will be transmitted from device to USB CDC
 #define USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE  USBD_CDC_BUFFER_SIZE
-
-//Temporary buffer RX size for USB transmissions
-//Used for temporary storage data for USB transmission
-//Set to large value if a lot of data will be received from USB CDC to device
-#define USBD_CDC_TMP_RECEIVE_BUFFER_SIZE   USBD_CDC_BUFFER_SIZE
 \endcode
  *
  * \par Changelog
@@ -118,6 +132,28 @@ extern "C" {
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - TX data are sent to USB directly from TX buffer memory, without temporary copy
+
+ Version 1.2
+  - October 14, 2026
+  - OUT endpoint receives directly to RX buffer memory, NAKs host when RX buffer is full
+  - Next IN transfer is started from transfer complete interrupt, not only from TM_USBD_CDC_Process
+  - Zero length packet is sent when transfer ends on packet boundary
+  - USBD_CDC_TMP_RECEIVE_BUFFER_SIZE is not used anymore
+  - Default HS RX buffer size is at least 2 HS packets
+  - Can be used together with MSC in composite device, check @ref TM_USBD_CDC_MSC
+
+ Version 1.3
+  - October 14, 2026
+  - Added @ref TM_USBD_CDC_GetRXBuffer() and @ref TM_USBD_CDC_SetTXBuffer() functions for zero copy bridges
+  - Added @ref TM_USBD_CDC_ReceiveCallback() function
+
+ Version 1.4
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
 \endverbatim
  *
  * \par Dependencies
@@ -160,10 +196,14 @@ extern "C" {
 #ifndef USBD_CDC_RECEIVE_BUFFER_SIZE_FS
 #define USBD_CDC_RECEIVE_BUFFER_SIZE_FS    USBD_CDC_BUFFER_SIZE
 #endif
-/* Receive buffer size for HS mode */
+/* Receive buffer size for HS mode, at least 2 packets by default */
 #ifndef USBD_CDC_RECEIVE_BUFFER_SIZE_HS
+#if USBD_CDC_BUFFER_SIZE < 2 * CDC_DATA_HS_OUT_PACKET_SIZE
+#define USBD_CDC_RECEIVE_BUFFER_SIZE_HS    (2 * CDC_DATA_HS_OUT_PACKET_SIZE)
+#else
 #define USBD_CDC_RECEIVE_BUFFER_SIZE_HS    USBD_CDC_BUFFER_SIZE
 #endif
+#endif
 /* Transmit buffer size for FS mode */
 #ifndef USBD_CDC_TRANSMIT_BUFFER_SIZE_FS
 #define USBD_CDC_TRANSMIT_BUFFER_SIZE_FS   USBD_CDC_BUFFER_SIZE
@@ -172,13 +212,17 @@ extern "C" {
 #ifndef USBD_CDC_TRANSMIT_BUFFER_SIZE_HS
 #define USBD_CDC_TRANSMIT_BUFFER_SIZE_HS   USBD_CDC_BUFFER_SIZE
 #endif
-/* Temporary buffer TX size for USB transmissions */
+/* Maximal TX size for one USB transmission, sent directly from TX buffer memory */
 #ifndef USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE
 #define USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE  USBD_CDC_BUFFER_SIZE
 #endif
-/* Temporary buffer RX size for USB transmissions */
-#ifndef USBD_CDC_TMP_RECEIVE_BUFFER_SIZE
-#define USBD_CDC_TMP_RECEIVE_BUFFER_SIZE   USBD_CDC_BUFFER_SIZE
+
+/* Check RX buffer sizes, must hold one full OUT packet */
+#if defined(USB_USE_FS) && USBD_CDC_RECEIVE_BUFFER_SIZE_FS <= CDC_DATA_FS_OUT_PACKET_SIZE
+#error "USBD_CDC_RECEIVE_BUFFER_SIZE_FS must be larger than FS OUT packet size!"
+#endif
+#if defined(USB_USE_HS) && USBD_CDC_RECEIVE_BUFFER_SIZE_HS <= CDC_DATA_HS_OUT_PACKET_SIZE
+#error "USBD_CDC_RECEIVE_BUFFER_SIZE_HS must be larger than HS OUT packet size!"
 #endif
 
 /**
@@ -239,7 +283,8 @@ typedef struct {
 TM_USBD_Result_t TM_USBD_CDC_Init(TM_USB_t USB_Mode);
 
 /**
- * @brief  Sends all remaining data from CDC TX buffer to USB out
+ * @brief  Starts transmission of data in CDC TX buffer and enables receive again when RX buffer was full
+ * @note   Next transfers are started from USB interrupt, there is no need to call it in loop
  * @param  USB_Mode: USB Mode where process will be done. This parameter can be a value of @ref TM_USB_t enumeration 
  * @retval None
  */
@@ -305,8 +350,41 @@ uint16_t TM_USBD_CDC_GetArray(TM_USB_t USB_Mode, uint8_t* buff, uint16_t count);
  */
 void TM_USBD_CDC_GetSettings(TM_USB_t USB_Mode, TM_USBD_CDC_Settings_t* Settings);
 
+/**
+ * @brief  Gets pointer to RX buffer with data received from host
+ * @note   Memory read directly from buffer must be released with @ref TM_BUFFER_CommitRead,
+ *         followed by @ref TM_USBD_CDC_Process call to enable receive again if RX buffer was full
+ * @param  USB_Mode: USB mode where to get buffer. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @retval Pointer to @ref TM_BUFFER_t structure or NULL if mode is not enabled
+ */
+TM_BUFFER_t* TM_USBD_CDC_GetRXBuffer(TM_USB_t USB_Mode);
+
+/**
+ * @brief  Sets buffer from which IN endpoint sends data to host
+ * @note   Data are sent directly from buffer memory, put functions write to the same buffer.
+ *         Call @ref TM_USBD_CDC_Process when new data are written to buffer by other source, like DMA
+ * @param  USB_Mode: USB mode where to set buffer. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure with data to send. Set to NULL to use internal TX buffer
+ * @retval Buffer status:
+ *            - 0: IN transfer is in progress or mode not enabled, buffer was not changed
+ *            - > 0: Buffer changed
+ */
+uint8_t TM_USBD_CDC_SetTXBuffer(TM_USB_t USB_Mode, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Receive callback, called when new data from host are added to RX buffer
+ * @note   Called from USB interrupt
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  USB_Mode: USB mode where data were received. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @retval None
+ */
+void TM_USBD_CDC_ReceiveCallback(TM_USB_t USB_Mode);
+
 /* Private functions */
-void TM_USBD_CDC_INT_AddToBuffer(USBD_HandleTypeDef* pdev, uint8_t* Values, uint16_t Num);
+void TM_USBD_CDC_INT_InitBuffers(TM_USB_t USB_Mode);
+void TM_USBD_CDC_INT_Init(USBD_HandleTypeDef* pdev);
+void TM_USBD_CDC_INT_Receive(USBD_HandleTypeDef* pdev, uint8_t* Values, uint16_t Num);
+void TM_USBD_CDC_INT_TransmitCplt(USBD_HandleTypeDef* pdev);
 
 /**
  * @}
@@ -0,0 +1,257 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_usb_device_cdc_bridge.h"
+
+/* Bridge state for each USB mode */
+typedef struct {
+	USART_TypeDef* USARTx;           /* USART connected to CDC, NULL when bridge is not active */
+	TM_USB_t USB_Mode;               /* USB mode of CDC device */
+	TM_BUFFER_t* RX;                 /* CDC RX buffer, data from host */
+	volatile uint32_t TxCount;       /* Number of bytes in UART TX DMA transfer */
+	volatile uint8_t FormatPending;  /* New line coding waits for UART TX to finish */
+	TM_USBD_CDC_Settings_t Settings; /* Last line coding from terminal */
+} TM_USBD_CDC_BRIDGE_INT_t;
+
+#ifdef USB_USE_FS
+static TM_USBD_CDC_BRIDGE_INT_t Bridge_FS = {NULL, TM_USB_FS};
+#endif
+#ifdef USB_USE_HS
+static TM_USBD_CDC_BRIDGE_INT_t Bridge_HS = {NULL, TM_USB_HS};
+#endif
+
+/* Private functions */
+static TM_USBD_CDC_BRIDGE_INT_t* TM_USBD_CDC_BRIDGE_INT_Get(TM_USB_t USB_Mode);
+static void TM_USBD_CDC_BRIDGE_INT_StartTX(TM_USBD_CDC_BRIDGE_INT_t* Bridge);
+static void TM_USBD_CDC_BRIDGE_INT_TXCallback(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, void* Param);
+static void TM_USBD_CDC_BRIDGE_INT_SetFormat(TM_USBD_CDC_BRIDGE_INT_t* Bridge);
+
+TM_USBD_Result_t TM_USBD_CDC_BRIDGE_Init(TM_USB_t USB_Mode, USART_TypeDef* USARTx) {
+	TM_USBD_CDC_BRIDGE_INT_t* Bridge = TM_USBD_CDC_BRIDGE_INT_Get(USB_Mode);
+	
+	/* Check valid */
+	if (Bridge == NULL || Bridge->USARTx != NULL || USARTx == NULL) {
+		return TM_USBD_Result_Error;
+	}
+	
+	/* Init USART DMA, TX from CDC RX buffer and circular RX to USART buffer */
+	TM_USART_DMA_Init(USARTx);
+	TM_USART_DMA_InitRX(USARTx);
+	
+	/* CDC IN endpoint sends directly from USART buffer */
+	if (!TM_USBD_CDC_SetTXBuffer(USB_Mode, TM_USART_GetBuffer(USARTx))) {
+		TM_USART_DMA_DeinitRX(USARTx);
+		TM_USART_DMA_Deinit(USARTx);
+		return TM_USBD_Result_Error;
+	}
+	
+	/* Fill settings */
+	Bridge->RX = TM_USBD_CDC_GetRXBuffer(USB_Mode);
+	Bridge->TxCount = 0;
+	Bridge->FormatPending = 0;
+	memset(&Bridge->Settings, 0, sizeof(Bridge->Settings));
+	
+	/* Bridge is active now */
+	Bridge->USARTx = USARTx;
+	
+	/* Send data which are already received */
+	TM_USBD_CDC_BRIDGE_INT_StartTX(Bridge);
+	
+	/* Return OK */
+	return TM_USBD_Result_Ok;
+}
+
+void TM_USBD_CDC_BRIDGE_DeInit(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_BRIDGE_INT_t* Bridge = TM_USBD_CDC_BRIDGE_INT_Get(USB_Mode);
+	USART_TypeDef* USARTx;
+	
+	/* Check valid */
+	if (Bridge == NULL || Bridge->USARTx == NULL) {
+		return;
+	}
+	
+	/* Stop new UART transfers */
+	Bridge->FormatPending = 1;
+	
+	/* Wait for UART TX transfer to finish */
+	while (Bridge->TxCount);
+	
+	/* Stop UART RX DMA */
+	USARTx = Bridge->USARTx;
+	TM_USART_DMA_DeinitRX(USARTx);
+	
+	/* Wait for IN transfer from USART buffer to finish and set internal CDC TX buffer back */
+	while (!TM_USBD_CDC_SetTXBuffer(USB_Mode, NULL));
+	
+	/* Disable bridge */
+	Bridge->USARTx = NULL;
+	Bridge->FormatPending = 0;
+	TM_USART_DMA_Deinit(USARTx);
+}
+
+void TM_USBD_CDC_BRIDGE_Process(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_BRIDGE_INT_t* Bridge = TM_USBD_CDC_BRIDGE_INT_Get(USB_Mode);
+	uint8_t apply = 0;
+	uint32_t irq;
+	
+	/* Check valid */
+	if (Bridge == NULL || Bridge->USARTx == NULL) {
+		return;
+	}
+	
+	/* Check for new line coding from terminal */
+	TM_USBD_CDC_GetSettings(USB_Mode, &Bridge->Settings);
+	
+	/* Disable interrupts, TX callback uses the same state */
+	irq = TM_NVIC_Lock();
+	
+	/* Do not start new UART transfers until settings are applied */
+	if (Bridge->Settings.Updated) {
+		Bridge->FormatPending = 1;
+	}
+	
+	/* Settings can be applied when UART TX is not working */
+	if (Bridge->FormatPending && Bridge->TxCount == 0) {
+		apply = 1;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Apply settings, function waits for last byte on UART */
+	if (apply) {
+		TM_USBD_CDC_BRIDGE_INT_SetFormat(Bridge);
+		Bridge->FormatPending = 0;
+	}
+	
+	/* Start transfers in both directions if not already */
+	TM_USBD_CDC_BRIDGE_INT_StartTX(Bridge);
+	TM_USBD_CDC_Process(USB_Mode);
+}
+
+/* Called from USB interrupt when data from host are in CDC RX buffer */
+void TM_USBD_CDC_ReceiveCallback(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_BRIDGE_INT_t* Bridge = TM_USBD_CDC_BRIDGE_INT_Get(USB_Mode);
+	
+	/* Start UART transfer */
+	if (Bridge != NULL && Bridge->USARTx != NULL) {
+		TM_USBD_CDC_BRIDGE_INT_StartTX(Bridge);
+	}
+}
+
+/* Called from USART or DMA interrupt when RX DMA has written new data to USART buffer */
+void TM_USART_DMA_RXCallback(USART_TypeDef* USARTx) {
+	/* Start IN transfer from USART buffer if not already */
+#ifdef USB_USE_FS
+	if (Bridge_FS.USARTx == USARTx) {
+		TM_USBD_CDC_Process(TM_USB_FS);
+	}
+#endif
+#ifdef USB_USE_HS
+	if (Bridge_HS.USARTx == USARTx) {
+		TM_USBD_CDC_Process(TM_USB_HS);
+	}
+#endif
+}
+
+/* Private functions */
+static TM_USBD_CDC_BRIDGE_INT_t* TM_USBD_CDC_BRIDGE_INT_Get(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_BRIDGE_INT_t* Bridge = NULL;
+	
+#ifdef USB_USE_FS
+	if (USB_Mode == TM_USB_FS) {
+		Bridge = &Bridge_FS;
+	}
+#endif
+#ifdef USB_USE_HS
+	if (USB_Mode == TM_USB_HS) {
+		Bridge = &Bridge_HS;
+	}
+#endif
+	
+	/* Return pointer */
+	return Bridge;
+}
+
+static void TM_USBD_CDC_BRIDGE_INT_StartTX(TM_USBD_CDC_BRIDGE_INT_t* Bridge) {
+	uint32_t irq, count;
+	uint8_t* ptr;
+	
+	/* Disable interrupts, called from USB, DMA and main context */
+	irq = TM_NVIC_Lock();
+	
+	/* One transfer at a time, memory is released in order */
+	if (Bridge->USARTx != NULL && Bridge->TxCount == 0 && !Bridge->FormatPending) {
+		/* Get received data, without copy */
+		count = TM_BUFFER_GetReadSpan(Bridge->RX, &ptr);
+		if (count > 0xFFFF) {
+			count = 0xFFFF;
+		}
+		
+		/* Send directly from CDC RX buffer, memory is released in callback */
+		if (count && TM_USART_DMA_SendQueued(Bridge->USARTx, ptr, count, TM_USBD_CDC_BRIDGE_INT_TXCallback, Bridge)) {
+			Bridge->TxCount = count;
+		}
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+static void TM_USBD_CDC_BRIDGE_INT_TXCallback(USART_TypeDef* USARTx, uint8_t* DataArray, uint16_t count, void* Param) {
+	TM_USBD_CDC_BRIDGE_INT_t* Bridge = (TM_USBD_CDC_BRIDGE_INT_t *)Param;
+	
+	/* Release sent memory in CDC RX buffer */
+	TM_BUFFER_CommitRead(Bridge->RX, count);
+	Bridge->TxCount = 0;
+	
+	/* Enable OUT endpoint again if it was NAKing host */
+	TM_USBD_CDC_Process(Bridge->USB_Mode);
+	
+	/* Send next data */
+	TM_USBD_CDC_BRIDGE_INT_StartTX(Bridge);
+}
+
+static void TM_USBD_CDC_BRIDGE_INT_SetFormat(TM_USBD_CDC_BRIDGE_INT_t* Bridge) {
+	uint32_t WordLength = UART_WORDLENGTH_8B;
+	uint32_t Parity = UART_PARITY_NONE;
+	uint32_t StopBits = UART_STOPBITS_1;
+	
+	/* Parity bit is part of word on STM32, mark and space parity are not supported */
+	if (Bridge->Settings.Parity == 1 || Bridge->Settings.Parity == 2) {
+		Parity = Bridge->Settings.Parity == 1 ? UART_PARITY_ODD : UART_PARITY_EVEN;
+		if (Bridge->Settings.DataBits == 8) {
+			WordLength = UART_WORDLENGTH_9B;
+		}
+	}
+	
+	/* 1.5 stop bits are not supported */
+	if (Bridge->Settings.Stopbits == 2) {
+		StopBits = UART_STOPBITS_2;
+	}
+	
+	/* Set new format */
+	TM_USART_SetFormat(Bridge->USARTx, Bridge->Settings.Baudrate, WordLength, Parity, StopBits);
+}
@@ -0,0 +1,179 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com
+ * @version v1.1
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   Zero copy USB CDC to UART bridge for STM32F4xx and STM32F7xx
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_USBD_CDC_BRIDGE_H
+#define TM_USBD_CDC_BRIDGE_H 110
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_USBD_CDC_BRIDGE
+ * @brief    Zero copy USB CDC to UART bridge for STM32F4xx and STM32F7xx
+ * @{
+ *
+ * Library connects USB CDC device (Virtual COM port) with USART peripheral, DMA is used on UART side in both directions.
+ * Data are never copied by CPU:
+ *
+\verbatim
+- USB -> UART: UART TX DMA sends directly from CDC RX buffer memory
+- UART -> USB: UART RX DMA writes to USART buffer in circular mode, CDC IN endpoint sends directly from that memory
+\endverbatim
+ *
+ * \par Flow control
+ *
+ * CDC RX buffer memory is released only when UART TX DMA has sent it. When RX buffer has no space for next packet,
+ * OUT endpoint NAKs host until UART catches up, so host is slowed down to UART speed and no data are lost.
+ *
+ * In other direction, circular RX DMA does not check for free memory. If host does not read data fast enough,
+ * DMA overwrites oldest data in USART buffer. Set USART buffer size big enough for your baudrate.
+ *
+ * \par Line coding
+ *
+ * Baudrate, parity and stop bits set in terminal on computer are applied to USART in @ref TM_USBD_CDC_BRIDGE_Process,
+ * using @ref TM_USART_SetFormat. New settings are applied when UART TX DMA transfer in progress is finished.
+ * Supported formats are 7 or 8 data bits with parity and 8 data bits without parity.
+ *
+ * \par Settings for high baudrates
+ *
+ * For 3 Mbaud in both directions, use larger buffers than default in defines.h file, for example on USART6:
+ *
+\code
+//CDC RX buffer, memory for USB -> UART direction
+#define USBD_CDC_RECEIVE_BUFFER_SIZE_FS    2048
+#define USBD_CDC_RECEIVE_BUFFER_SIZE_HS    4096
+
+//USART buffer, memory for UART -> USB direction
+#define TM_USART6_BUFFER_SIZE              4096
+
+//Maximal size of one IN transfer
+#define USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE  2048
+\endcode
+ *
+ * @note  Power of 2 buffer sizes are recommended for best speed.
+ *
+ * @warning Library implements @ref TM_USBD_CDC_ReceiveCallback and @ref TM_USART_DMA_RXCallback functions,
+ *          they must not be implemented by user. CDC put and get functions and USART read functions
+ *          must not be used on bridged USB mode and USART.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+
+ Version 1.1
+  - October 14, 2026
+  - Critical sections use TM_NVIC_Lock and TM_NVIC_Unlock, only library priorities are masked when NVIC_USE_BASEPRI is used
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - TM USART
+ - TM USART DMA
+ - TM USB DEVICE CDC
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_buffer.h"
+#include "tm_stm32_usart.h"
+#include "tm_stm32_usart_dma.h"
+#include "tm_stm32_usb_device_cdc.h"
+
+/**
+ * @defgroup TM_USBD_CDC_BRIDGE_Functions
+ * @brief    Library Functions
+ * @{
+ */
+
+/**
+ * @brief  Connects USB CDC device with USART
+ * @note   USART must be initialized with @ref TM_USART_Init and CDC with @ref TM_USBD_CDC_Init before.
+ *         Both DMA directions for USART are initialized by this function
+ * @param  USB_Mode: USB mode with CDC device, TM_USB_FS or TM_USB_HS. This parameter can be a value of @ref TM_USB_t enumeration
+ * @param  *USARTx: Pointer to USARTx to connect with CDC
+ * @retval Member of @ref TM_USBD_Result_t enumeration
+ */
+TM_USBD_Result_t TM_USBD_CDC_BRIDGE_Init(TM_USB_t USB_Mode, USART_TypeDef* USARTx);
+
+/**
+ * @brief  Disconnects USB CDC device from USART
+ * @note   USART TX DMA transfer in progress is finished first
+ * @param  USB_Mode: USB mode with CDC device. This parameter can be a value of @ref TM_USB_t enumeration
+ * @retval None
+ */
+void TM_USBD_CDC_BRIDGE_DeInit(TM_USB_t USB_Mode);
+
+/**
+ * @brief  Applies line coding from terminal to USART and restarts transfers if needed
+ * @note   Transfers are started from interrupts, function has to be called periodically only for line coding changes
+ * @param  USB_Mode: USB mode with CDC device. This parameter can be a value of @ref TM_USB_t enumeration
+ * @retval None
+ */
+void TM_USBD_CDC_BRIDGE_Process(TM_USB_t USB_Mode);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
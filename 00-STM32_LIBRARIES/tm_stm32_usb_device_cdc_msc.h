@@ -0,0 +1,170 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   USB composite CDC + MSC Device library for STM32Fxxx devices
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_USBD_CDC_MSC_H
+#define TM_USBD_CDC_MSC_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_USBD_CDC_MSC
+ * @brief    USB composite CDC + MSC Device library for STM32Fxxx devices - http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @{
+ *
+ * With this library, your STM32Fxxx device acts like Virtual COM port and SDCARD reader at the same time on one USB port.
+ *
+ * @note  Check @ref TM_USB library for configuration settings first!
+ *
+ * \par Main features
+ *
+\verbatim
+- Works on USB FS or HS mode
+- CDC and MSC functions on one device with Interface Association Descriptor
+- CDC API is the same as in TM USBD CDC library
+- MSC settings are the same as in TM USBD MSC library
+\endverbatim
+ *
+ * \par Interfaces and endpoints
+ *
+\verbatim
+Interface  Class  Endpoints
+0          CDC    0x82 (command, interrupt)
+1          CDC    0x01, 0x81 (data, bulk)
+2          MSC    MSC_EPOUT_ADDR, MSC_EPIN_ADDR (default 0x03, 0x83, bulk)
+\endverbatim
+ *
+ * Each IN endpoint has own TX FIFO in USB core, so CDC transfers do not wait for MSC data and vice versa.
+ * FIFO sizes are set in usbd_conf.c file.
+ *
+ * After @ref TM_USBD_CDC_MSC_Init call, use @ref TM_USBD_Start to start device and TM_USBD_CDC functions to communicate over CDC.
+ *
+\code
+//Init USB core and composite device
+TM_USB_Init();
+TM_USBD_CDC_MSC_Init(TM_USB_FS);
+TM_USBD_Start(TM_USB_FS);
+
+while (1) {
+    //Process CDC data
+    TM_USBD_CDC_Process(TM_USB_FS);
+}
+\endcode
+ *
+ * @note  Windows 7 and older need INF file for CDC function in composite device.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - TM DELAY
+ - TM USB
+ - TM USB DEVICE
+ - TM USB DEVICE CDC
+ - TM USB DEVICE MSC
+ - USB Device Stack
+ - USB Device CDC
+ - USB Device MSC
+ - USB Device CDC MSC
+ - TM FATFS with SDCARD SDIO driver
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_usb.h"
+#include "tm_stm32_usb_device.h"
+#include "tm_stm32_usb_device_cdc.h"
+#include "tm_stm32_usb_device_msc.h"
+#include "usbd_core.h"
+#include "usbd_cdc_msc.h"
+
+/* Check library versions */
+#if TM_USBD_CDC_H < 120
+#error "Please update TM USBD CDC LIB, minimum required version is 1.2. Download available on stm32f4-discovery.com website"
+#endif
+#if TM_USBD_MSC_H < 110
+#error "Please update TM USBD MSC LIB, minimum required version is 1.1. Download available on stm32f4-discovery.com website"
+#endif
+
+/**
+ * @defgroup TM_USBD_CDC_MSC_Functions
+ * @brief    Library Functions
+ * @{
+ */
+ 
+/**
+ * @brief  Initializes USB DEVICE for composite CDC + MSC class on specific USB mode
+ * @param  USB_Mode: USB Mode where composite DEVICE will be enabled. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @retval Member of @ref TM_USBD_Result_t enumeration
+ */
+TM_USBD_Result_t TM_USBD_CDC_MSC_Init(TM_USB_t USB_Mode);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
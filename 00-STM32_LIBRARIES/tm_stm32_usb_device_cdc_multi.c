@@ -0,0 +1,686 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_usb_device_cdc_multi.h"
+
+/* Exported functions ------------------------------------------------------- */
+extern USBD_DescriptorsTypeDef CDC_MULTI_Desc;
+
+/* Private typedef -----------------------------------------------------------*/
+/* Transfer state for one port */
+typedef struct {
+	TM_BUFFER_t RXBuffer;   /* Internal ring buffer for received data */
+	TM_BUFFER_t TXBuffer;   /* Internal ring buffer for data to transmit */
+	TM_BUFFER_t* TX;        /* Active ring buffer for data to transmit */
+	uint8_t* RxTmp;         /* One packet memory when RX buffer has no contiguous space */
+	uint32_t TxPending;     /* Number of bytes in transfer, sent directly from TX buffer memory */
+	uint8_t TxZLP;          /* Last transfer was multiple of packet size, zero length packet is needed */
+	uint8_t RxDirect;       /* OUT endpoint receives directly to RX buffer memory */
+	uint8_t RxStopped;      /* OUT endpoint is not armed, RX buffer is full */
+} TM_USBD_CDC_MULTI_INT_t;
+
+/* Private define ------------------------------------------------------------*/
+#define USBD_VID                      0x0483
+#define USBD_PID                      0x5742
+#define USBD_LANGID_STRING            0x409
+#define USBD_MANUFACTURER_STRING      "STMicroelectronics"
+#define USBD_PRODUCT_HS_STRING        "STM32 Multi Virtual ComPort in HS Mode"
+#define USBD_PRODUCT_FS_STRING        "STM32 Multi Virtual ComPort in FS Mode"
+#define USBD_CONFIGURATION_HS_STRING  "Multi VCP Config"
+#define USBD_INTERFACE_HS_STRING      "Multi VCP Interface"
+#define USBD_CONFIGURATION_FS_STRING  "Multi VCP Config"
+#define USBD_INTERFACE_FS_STRING      "Multi VCP Interface"
+
+/* Private macro -------------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+uint8_t *USBD_CDC_MULTI_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_CDC_MULTI_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_CDC_MULTI_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_CDC_MULTI_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_CDC_MULTI_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_CDC_MULTI_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_CDC_MULTI_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+
+static int8_t TM_USBD_CDC_MULTI_INT_Init(USBD_HandleTypeDef* pdev, uint8_t port);
+static int8_t TM_USBD_CDC_MULTI_INT_DeInit(USBD_HandleTypeDef* pdev, uint8_t port);
+static int8_t TM_USBD_CDC_MULTI_INT_Receive(USBD_HandleTypeDef* pdev, uint8_t port, uint8_t* pbuf, uint32_t len);
+static int8_t TM_USBD_CDC_MULTI_INT_TransmitCplt(USBD_HandleTypeDef* pdev, uint8_t port);
+
+/* Private variables ---------------------------------------------------------*/
+USBD_DescriptorsTypeDef CDC_MULTI_Desc = {
+	USBD_CDC_MULTI_DeviceDescriptor,
+	USBD_CDC_MULTI_LangIDStrDescriptor, 
+	USBD_CDC_MULTI_ManufacturerStrDescriptor,
+	USBD_CDC_MULTI_ProductStrDescriptor,
+	USBD_CDC_MULTI_SerialStrDescriptor,
+	USBD_CDC_MULTI_ConfigStrDescriptor,
+	USBD_CDC_MULTI_InterfaceStrDescriptor,  
+};
+
+/* Interface callbacks, the same for both USB modes, line coding is handled by class */
+static USBD_CDC_MULTI_ItfTypeDef USBD_CDC_MULTI_fops = {
+	TM_USBD_CDC_MULTI_INT_Init,
+	TM_USBD_CDC_MULTI_INT_DeInit,
+	NULL,
+	TM_USBD_CDC_MULTI_INT_Receive,
+	TM_USBD_CDC_MULTI_INT_TransmitCplt
+};
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
+	0x12,                       /* bLength */
+	USB_DESC_TYPE_DEVICE,       /* bDescriptorType */
+	0x00,                       /* bcdUSB */
+	0x02,
+	0xEF,                       /* bDeviceClass: Miscellaneous */
+	0x02,                       /* bDeviceSubClass: Common class */
+	0x01,                       /* bDeviceProtocol: Interface Association Descriptor */
+	USB_MAX_EP0_SIZE,           /* bMaxPacketSize */
+	LOBYTE(USBD_VID),           /* idVendor */
+	HIBYTE(USBD_VID),           /* idVendor */
+	LOBYTE(USBD_PID),           /* idVendor */
+	HIBYTE(USBD_PID),           /* idVendor */
+	0x00,                       /* bcdDevice rel. 2.00 */
+	0x02,
+	USBD_IDX_MFC_STR,           /* Index of manufacturer string */
+	USBD_IDX_PRODUCT_STR,       /* Index of product string */
+	USBD_IDX_SERIAL_STR,        /* Index of serial number string */
+	USBD_MAX_NUM_CONFIGURATION  /* bNumConfigurations */
+}; /* USB_DeviceDescriptor */
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+	USB_LEN_LANGID_STR_DESC,         
+	USB_DESC_TYPE_STRING,       
+	LOBYTE(USBD_LANGID_STRING),
+	HIBYTE(USBD_LANGID_STRING), 
+};
+
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
+
+/* Buffer memory for each port */
+#ifdef USB_USE_FS
+static uint8_t USBD_CDC_MULTI_Data_FS_RX0[USBD_CDC_MULTI_RX_BUFFER_SIZE_0];
+static uint8_t USBD_CDC_MULTI_Data_FS_TX0[USBD_CDC_MULTI_TX_BUFFER_SIZE_0];
+static uint8_t USBD_CDC_MULTI_Tmp_FS_RX0[CDC_DATA_FS_OUT_PACKET_SIZE];
+#if USBD_CDC_MULTI_PORTS > 1
+static uint8_t USBD_CDC_MULTI_Data_FS_RX1[USBD_CDC_MULTI_RX_BUFFER_SIZE_1];
+static uint8_t USBD_CDC_MULTI_Data_FS_TX1[USBD_CDC_MULTI_TX_BUFFER_SIZE_1];
+static uint8_t USBD_CDC_MULTI_Tmp_FS_RX1[CDC_DATA_FS_OUT_PACKET_SIZE];
+#endif
+static TM_USBD_CDC_MULTI_INT_t USBD_CDC_MULTI_INT_FS[USBD_CDC_MULTI_PORTS];
+#endif
+#ifdef USB_USE_HS
+static uint8_t USBD_CDC_MULTI_Data_HS_RX0[USBD_CDC_MULTI_RX_BUFFER_SIZE_0];
+static uint8_t USBD_CDC_MULTI_Data_HS_TX0[USBD_CDC_MULTI_TX_BUFFER_SIZE_0];
+static uint8_t USBD_CDC_MULTI_Tmp_HS_RX0[CDC_DATA_HS_OUT_PACKET_SIZE];
+#if USBD_CDC_MULTI_PORTS > 1
+static uint8_t USBD_CDC_MULTI_Data_HS_RX1[USBD_CDC_MULTI_RX_BUFFER_SIZE_1];
+static uint8_t USBD_CDC_MULTI_Data_HS_TX1[USBD_CDC_MULTI_TX_BUFFER_SIZE_1];
+static uint8_t USBD_CDC_MULTI_Tmp_HS_RX1[CDC_DATA_HS_OUT_PACKET_SIZE];
+#endif
+static TM_USBD_CDC_MULTI_INT_t USBD_CDC_MULTI_INT_HS[USBD_CDC_MULTI_PORTS];
+#endif
+
+/* Returns pointer to port state for USB mode */
+static TM_USBD_CDC_MULTI_INT_t* TM_USBD_CDC_MULTI_INT_GetMode(TM_USB_t USB_Mode, uint8_t Port) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = 0;
+	
+	/* Check port */
+	if (Port >= USBD_CDC_MULTI_PORTS) {
+		return 0;
+	}
+	
+#ifdef USB_USE_FS
+	if (USB_Mode == TM_USB_FS) {
+		CDC = &USBD_CDC_MULTI_INT_FS[Port];
+	}
+#endif
+#ifdef USB_USE_HS
+	if (USB_Mode == TM_USB_HS) {
+		CDC = &USBD_CDC_MULTI_INT_HS[Port];
+	}
+#endif
+
+	/* Return pointer */
+	return CDC;
+}
+
+/* Returns pointer to port state for USB, USB ID is the same as USB mode */
+static TM_USBD_CDC_MULTI_INT_t* TM_USBD_CDC_MULTI_INT_Get(USBD_HandleTypeDef* pdev, uint8_t Port) {
+	return TM_USBD_CDC_MULTI_INT_GetMode((TM_USB_t)pdev->id, Port);
+}
+
+/* Sets memory for next OUT transfer, returns 0 if RX buffer has no space for full packet */
+static uint8_t TM_USBD_CDC_MULTI_INT_SetRxBuffer(USBD_HandleTypeDef* pdev, uint8_t port, TM_USBD_CDC_MULTI_INT_t* CDC) {
+	uint32_t size = pdev->dev_speed == USBD_SPEED_HIGH ? CDC_DATA_HS_OUT_PACKET_SIZE : CDC_DATA_FS_OUT_PACKET_SIZE;
+	uint8_t* ptr;
+	
+	if (TM_BUFFER_GetWriteSpan(&CDC->RXBuffer, &ptr) >= size) {
+		/* Receive directly to RX buffer memory */
+		CDC->RxDirect = 1;
+	} else if (TM_BUFFER_GetFree(&CDC->RXBuffer) >= size) {
+		/* Packet wraps around buffer end, receive to temporary memory and copy */
+		CDC->RxDirect = 0;
+		ptr = CDC->RxTmp;
+	} else {
+		/* No memory, endpoint will NAK until user reads data */
+		CDC->RxStopped = 1;
+		return 0;
+	}
+	
+	/* Set pointer */
+	CDC->RxStopped = 0;
+	USBD_CDC_MULTI_SetRxBuffer(pdev, port, ptr);
+	
+	/* Endpoint can be armed */
+	return 1;
+}
+
+/* Starts next IN transfer from TX buffer memory, TX must not be working */
+static void TM_USBD_CDC_MULTI_INT_Transmit(USBD_HandleTypeDef* pdev, uint8_t port, TM_USBD_CDC_MULTI_INT_t* CDC) {
+	uint32_t size = pdev->dev_speed == USBD_SPEED_HIGH ? CDC_DATA_HS_IN_PACKET_SIZE : CDC_DATA_FS_IN_PACKET_SIZE;
+	uint32_t count;
+	uint8_t* ptr;
+	
+	/* Previous transfer was sent directly from buffer memory, release it now */
+	if (CDC->TxPending) {
+		TM_BUFFER_CommitRead(CDC->TX, CDC->TxPending);
+		CDC->TxPending = 0;
+	}
+	
+	/* Get data in TX buffer, without copy */
+	count = TM_BUFFER_GetReadSpan(CDC->TX, &ptr);
+	if (count > USBD_CDC_MULTI_MAX_TRANSMIT_SIZE) {
+		count = USBD_CDC_MULTI_MAX_TRANSMIT_SIZE;
+	}
+	
+	/* Nothing to send */
+	if (count == 0) {
+		/* Host waits for short packet when transfer ends on packet boundary */
+		if (CDC->TxZLP) {
+			CDC->TxZLP = 0;
+			USBD_CDC_MULTI_SetTxBuffer(pdev, port, ptr, 0);
+			USBD_CDC_MULTI_TransmitPacket(pdev, port);
+		}
+		return;
+	}
+	
+	/* Memory is released when transfer is done */
+	CDC->TxPending = count;
+	CDC->TxZLP = (count % size) == 0;
+	
+	/* Send data, multiple packets in one transfer */
+	USBD_CDC_MULTI_SetTxBuffer(pdev, port, ptr, count);
+	USBD_CDC_MULTI_TransmitPacket(pdev, port);
+}
+
+/* Starts transfers which are not started from USB interrupt */
+static void TM_USBD_CDC_MULTI_INT_Process(USBD_HandleTypeDef* pdev, uint8_t port) {
+	USBD_CDC_MULTI_HandleTypeDef *h = (USBD_CDC_MULTI_HandleTypeDef *) pdev->pClassData;
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_Get(pdev, port);
+	uint32_t irq;
+	
+	/* Not configured by host yet */
+	if (h == NULL || CDC == NULL) {
+		return;
+	}
+	
+	/* Disable interrupts, USB interrupt uses the same state */
+	irq = TM_NVIC_Lock();
+	
+	/* If TX is not working, next transfers are started from transfer complete callback */
+	if (!h->Port[port].TxState) {
+		TM_USBD_CDC_MULTI_INT_Transmit(pdev, port, CDC);
+	}
+	
+	/* User has read data, enable receive again */
+	if (CDC->RxStopped && TM_USBD_CDC_MULTI_INT_SetRxBuffer(pdev, port, CDC)) {
+		USBD_CDC_MULTI_ReceivePacket(pdev, port);
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+}
+
+/* Initializes RX and TX buffers of all ports for USB mode */
+static void TM_USBD_CDC_MULTI_INT_InitBuffers(TM_USB_t USB_Mode) {
+	TM_USBD_CDC_MULTI_INT_t* CDC;
+	
+#ifdef USB_USE_FS
+	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
+		CDC = USBD_CDC_MULTI_INT_FS;
+		TM_BUFFER_Init(&CDC[0].RXBuffer, USBD_CDC_MULTI_RX_BUFFER_SIZE_0, USBD_CDC_MULTI_Data_FS_RX0);
+		TM_BUFFER_Init(&CDC[0].TXBuffer, USBD_CDC_MULTI_TX_BUFFER_SIZE_0, USBD_CDC_MULTI_Data_FS_TX0);
+		CDC[0].RxTmp = USBD_CDC_MULTI_Tmp_FS_RX0;
+		CDC[0].TX = &CDC[0].TXBuffer;
+#if USBD_CDC_MULTI_PORTS > 1
+		TM_BUFFER_Init(&CDC[1].RXBuffer, USBD_CDC_MULTI_RX_BUFFER_SIZE_1, USBD_CDC_MULTI_Data_FS_RX1);
+		TM_BUFFER_Init(&CDC[1].TXBuffer, USBD_CDC_MULTI_TX_BUFFER_SIZE_1, USBD_CDC_MULTI_Data_FS_TX1);
+		CDC[1].RxTmp = USBD_CDC_MULTI_Tmp_FS_RX1;
+		CDC[1].TX = &CDC[1].TXBuffer;
+#endif
+	}
+#endif
+	
+#ifdef USB_USE_HS
+	if (USB_Mode == TM_USB_HS || USB_Mode == TM_USB_Both) {
+		CDC = USBD_CDC_MULTI_INT_HS;
+		TM_BUFFER_Init(&CDC[0].RXBuffer, USBD_CDC_MULTI_RX_BUFFER_SIZE_0, USBD_CDC_MULTI_Data_HS_RX0);
+		TM_BUFFER_Init(&CDC[0].TXBuffer, USBD_CDC_MULTI_TX_BUFFER_SIZE_0, USBD_CDC_MULTI_Data_HS_TX0);
+		CDC[0].RxTmp = USBD_CDC_MULTI_Tmp_HS_RX0;
+		CDC[0].TX = &CDC[0].TXBuffer;
+#if USBD_CDC_MULTI_PORTS > 1
+		TM_BUFFER_Init(&CDC[1].RXBuffer, USBD_CDC_MULTI_RX_BUFFER_SIZE_1, USBD_CDC_MULTI_Data_HS_RX1);
+		TM_BUFFER_Init(&CDC[1].TXBuffer, USBD_CDC_MULTI_TX_BUFFER_SIZE_1, USBD_CDC_MULTI_Data_HS_TX1);
+		CDC[1].RxTmp = USBD_CDC_MULTI_Tmp_HS_RX1;
+		CDC[1].TX = &CDC[1].TXBuffer;
+#endif
+	}
+#endif
+}
+
+/************************************************/
+/*            USER PUBLIC FUNCTIONS             */
+/************************************************/
+TM_USBD_Result_t TM_USBD_CDC_MULTI_Init(TM_USB_t USB_Mode) {
+	/* Init buffers first, class uses them as soon as host configures device */
+	TM_USBD_CDC_MULTI_INT_InitBuffers(USB_Mode);
+	
+#ifdef USB_USE_FS
+	/* Init FS mode */
+	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
+		/* Init FS */
+		USBD_Init(&hUSBDevice_FS, &CDC_MULTI_Desc, USB_ID_FS);
+
+		/* Add Supported Class */
+		USBD_RegisterClass(&hUSBDevice_FS, USBD_CDC_MULTI_CLASS);
+
+		/* Add CDC multi Interface Class */
+		USBD_CDC_MULTI_RegisterInterface(&hUSBDevice_FS, &USBD_CDC_MULTI_fops);
+	}
+#endif
+	
+#ifdef USB_USE_HS
+	/* Init HS mode */
+	if (USB_Mode == TM_USB_HS || USB_Mode == TM_USB_Both) {
+		/* Init HS */
+		USBD_Init(&hUSBDevice_HS, &CDC_MULTI_Desc, USB_ID_HS);
+
+		/* Add Supported Class */
+		USBD_RegisterClass(&hUSBDevice_HS, USBD_CDC_MULTI_CLASS);
+
+		/* Add CDC multi Interface Class */
+		USBD_CDC_MULTI_RegisterInterface(&hUSBDevice_HS, &USBD_CDC_MULTI_fops);
+	}
+#endif
+	
+	/* Return OK */
+	return TM_USBD_Result_Ok;
+}
+
+void TM_USBD_CDC_MULTI_Process(TM_USB_t USB_Mode, uint8_t Port) {
+#ifdef USB_USE_FS
+	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
+		TM_USBD_CDC_MULTI_INT_Process(TM_USBD_GetUSBPointer(TM_USB_FS), Port);
+	}
+#endif
+	
+#ifdef USB_USE_HS
+	if (USB_Mode == TM_USB_HS || USB_Mode == TM_USB_Both) {
+		TM_USBD_CDC_MULTI_INT_Process(TM_USBD_GetUSBPointer(TM_USB_HS), Port);
+	}
+#endif
+}
+
+uint16_t TM_USBD_CDC_MULTI_Putc(TM_USB_t USB_Mode, uint8_t Port, char ch) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_GetMode(USB_Mode, Port);
+	
+	/* Check for write */
+	if (CDC && TM_BUFFER_WriteByte(CDC->TX, (uint8_t)ch)) {
+		/* Process */
+		TM_USBD_CDC_MULTI_Process(USB_Mode, Port);
+		
+		/* Return OK */
+		return 1;
+	}
+	
+	/* Return error */
+	return 0;
+}
+
+uint16_t TM_USBD_CDC_MULTI_Puts(TM_USB_t USB_Mode, uint8_t Port, const char* str) {
+	return TM_USBD_CDC_MULTI_PutArray(USB_Mode, Port, (uint8_t *)str, strlen(str));
+}
+
+uint16_t TM_USBD_CDC_MULTI_PutArray(TM_USB_t USB_Mode, uint8_t Port, uint8_t* buff, uint16_t count) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_GetMode(USB_Mode, Port);
+	uint16_t ret;
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return 0;
+	}
+	
+	/* Write and process */
+	if ((ret = TM_BUFFER_Write(CDC->TX, buff, count)) > 0) {
+		TM_USBD_CDC_MULTI_Process(USB_Mode, Port);
+	}
+	
+	/* Return number of elements added to buffer */
+	return ret;
+}
+
+uint8_t TM_USBD_CDC_MULTI_Getc(TM_USB_t USB_Mode, uint8_t Port, char* ch) {
+	/* Try to read from buffer */
+	if (TM_BUFFER_ReadByte(TM_USBD_CDC_MULTI_GetRXBuffer(USB_Mode, Port), (uint8_t *)ch)) {
+		/* Memory released, receive again if stopped */
+		TM_USBD_CDC_MULTI_Process(USB_Mode, Port);
+		
+		/* Character read */
+		return 1;
+	}
+	
+	/* Return error */
+	return 0;
+}
+
+uint16_t TM_USBD_CDC_MULTI_Gets(TM_USB_t USB_Mode, uint8_t Port, char* buff, uint16_t buffsize) {
+	uint16_t ret;
+	
+	/* Read and process */
+	if ((ret = TM_BUFFER_ReadString(TM_USBD_CDC_MULTI_GetRXBuffer(USB_Mode, Port), buff, buffsize)) > 0) {
+		TM_USBD_CDC_MULTI_Process(USB_Mode, Port);
+	}
+	
+	/* Return number of elements in string */
+	return ret;
+}
+
+uint16_t TM_USBD_CDC_MULTI_GetArray(TM_USB_t USB_Mode, uint8_t Port, uint8_t* buff, uint16_t count) {
+	uint16_t ret;
+	
+	/* Read and process */
+	if ((ret = TM_BUFFER_Read(TM_USBD_CDC_MULTI_GetRXBuffer(USB_Mode, Port), buff, count)) > 0) {
+		TM_USBD_CDC_MULTI_Process(USB_Mode, Port);
+	}
+	
+	/* Return number of elements read */
+	return ret;
+}
+
+TM_BUFFER_t* TM_USBD_CDC_MULTI_GetRXBuffer(TM_USB_t USB_Mode, uint8_t Port) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_GetMode(USB_Mode, Port);
+	
+	/* Return pointer */
+	return CDC ? &CDC->RXBuffer : 0;
+}
+
+uint8_t TM_USBD_CDC_MULTI_SetTXBuffer(TM_USB_t USB_Mode, uint8_t Port, TM_BUFFER_t* Buffer) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_GetMode(USB_Mode, Port);
+	uint8_t ret = 0;
+	uint32_t irq;
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return 0;
+	}
+	
+	/* Use internal buffer */
+	if (Buffer == NULL) {
+		Buffer = &CDC->TXBuffer;
+	}
+	
+	/* Disable interrupts, USB interrupt uses the same state */
+	irq = TM_NVIC_Lock();
+	
+	/* Memory of current transfer must be released from the same buffer */
+	if (CDC->TxPending == 0) {
+		CDC->TX = Buffer;
+		ret = 1;
+	}
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Return status */
+	return ret;
+}
+
+void TM_USBD_CDC_MULTI_GetSettings(TM_USB_t USB_Mode, uint8_t Port, TM_USBD_CDC_MULTI_Settings_t* Settings) {
+	USBD_HandleTypeDef* pdev = TM_USBD_GetUSBPointer(USB_Mode);
+	USBD_CDC_MULTI_HandleTypeDef* h;
+	USBD_CDC_MULTI_PortTypeDef* p;
+	uint8_t opened;
+	
+	/* Settings not updated */
+	Settings->Updated = 0;
+	
+	/* Check if valid and configured by host */
+	if (pdev == NULL || Port >= USBD_CDC_MULTI_PORTS || (h = (USBD_CDC_MULTI_HandleTypeDef *)pdev->pClassData) == NULL) {
+		return;
+	}
+	p = &h->Port[Port];
+	opened = p->ControlLineState & 0x01;
+	
+	/* Check for changes */
+	if (
+		Settings->Baudrate != p->LineCoding.bitrate ||
+		Settings->DataBits != p->LineCoding.datatype ||
+		Settings->Parity != p->LineCoding.paritytype ||
+		Settings->Stopbits != p->LineCoding.format ||
+		Settings->Opened != opened
+	) {
+		Settings->Baudrate = p->LineCoding.bitrate;
+		Settings->DataBits = p->LineCoding.datatype;
+		Settings->Parity = p->LineCoding.paritytype;
+		Settings->Stopbits = p->LineCoding.format;
+		Settings->Opened = opened;
+		
+		/* Settings are updated */
+		Settings->Updated = 1;
+	}
+}
+
+__weak void TM_USBD_CDC_MULTI_ReceiveCallback(TM_USB_t USB_Mode, uint8_t Port) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_USBD_CDC_MULTI_ReceiveCallback could be implemented in the user file
+	*/
+}
+
+/************************************************/
+/*               PRIVATE FUNCTIONS              */
+/************************************************/
+static int8_t TM_USBD_CDC_MULTI_INT_Init(USBD_HandleTypeDef* pdev, uint8_t port) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_Get(pdev, port);
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return USBD_FAIL;
+	}
+	
+	/* Data in unfinished transfer are sent again */
+	CDC->TxPending = 0;
+	CDC->TxZLP = 0;
+	
+	/* Set memory for first OUT transfer, armed by class driver */
+	TM_USBD_CDC_MULTI_INT_SetRxBuffer(pdev, port, CDC);
+	
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t TM_USBD_CDC_MULTI_INT_DeInit(USBD_HandleTypeDef* pdev, uint8_t port) {
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t TM_USBD_CDC_MULTI_INT_Receive(USBD_HandleTypeDef* pdev, uint8_t port, uint8_t* pbuf, uint32_t len) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_Get(pdev, port);
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return USBD_FAIL;
+	}
+	
+	if (CDC->RxDirect) {
+		/* Data are already in buffer memory */
+		TM_BUFFER_CommitWrite(&CDC->RXBuffer, len);
+	} else {
+		/* Copy from temporary memory */
+		TM_BUFFER_Write(&CDC->RXBuffer, pbuf, len);
+	}
+	
+	/* Prepare for next if there is memory */
+	if (TM_USBD_CDC_MULTI_INT_SetRxBuffer(pdev, port, CDC)) {
+		USBD_CDC_MULTI_ReceivePacket(pdev, port);
+	}
+	
+	/* Notify user, USB ID is the same as USB mode */
+	TM_USBD_CDC_MULTI_ReceiveCallback((TM_USB_t)pdev->id, port);
+	
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t TM_USBD_CDC_MULTI_INT_TransmitCplt(USBD_HandleTypeDef* pdev, uint8_t port) {
+	TM_USBD_CDC_MULTI_INT_t* CDC = TM_USBD_CDC_MULTI_INT_Get(pdev, port);
+	
+	/* Check valid */
+	if (CDC == NULL) {
+		return USBD_FAIL;
+	}
+	
+	/* Release sent memory and start next transfer */
+	TM_USBD_CDC_MULTI_INT_Transmit(pdev, port, CDC);
+	
+	/* Return OK */
+	return USBD_OK;
+}
+
+/************************************************/
+/*             LIBRARY DESCRIPTORS              */
+/************************************************/
+
+/**
+  * @brief  Returns the device descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = sizeof(USBD_DeviceDesc);
+	return (uint8_t*)USBD_DeviceDesc;
+}
+
+/**
+  * @brief  Returns the LangID string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = sizeof(USBD_LangIDDesc);  
+	return (uint8_t*)USBD_LangIDDesc;
+}
+
+/**
+  * @brief  Returns the product string descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {   
+		USBD_GetString((uint8_t *)USBD_PRODUCT_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_PRODUCT_FS_STRING, USBD_StrDesc, length);    
+	}
+	return USBD_StrDesc;
+}
+
+/**
+  * @brief  Returns the manufacturer string descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	USBD_GetString((uint8_t *)USBD_MANUFACTURER_STRING, USBD_StrDesc, length);
+	return USBD_StrDesc;
+}
+
+/**
+  * @brief  Returns the serial number string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = ID_USB_SERIAL_SIZE;
+
+	/* Serial number string descriptor is cached in identity block */
+	return (uint8_t*)TM_ID_Get()->USBSerial;
+}
+
+/**
+  * @brief  Returns the configuration string descriptor.    
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {  
+		USBD_GetString((uint8_t *)USBD_CONFIGURATION_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_CONFIGURATION_FS_STRING, USBD_StrDesc, length); 
+	}
+	return USBD_StrDesc;  
+}
+
+/**
+  * @brief  Returns the interface string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_MULTI_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {
+		USBD_GetString((uint8_t *)USBD_INTERFACE_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_INTERFACE_FS_STRING, USBD_StrDesc, length);
+	}
+	return USBD_StrDesc;  
+}
+
@@ -0,0 +1,372 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   USB multi port CDC Device library for STM32Fxxx devices
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_USBD_CDC_MULTI_H
+#define TM_USBD_CDC_MULTI_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_USBD_CDC_MULTI
+ * @brief    USB multi port CDC Device library for STM32Fxxx devices - http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @{
+ *
+ * With this library, your STM32Fxxx device acts like multiple Virtual COM ports on one USB port.
+ * Each port has own endpoints and own RX and TX ring buffers, so for example console and telemetry
+ * streams do not wait for each other.
+ *
+ * @note  Check @ref TM_USB library for configuration settings first!
+ *
+ * \par Main features
+ *
+\verbatim
+- Works on USB FS or HS mode
+- 1 or 2 CDC ports in composite device with Interface Association Descriptor
+- API is the same as in TM USBD CDC library, with additional port parameter
+- Data are received and transmitted directly from ring buffer memory of each port
+- Buffer size can be selected for each port
+\endverbatim
+ *
+ * \par Interfaces and endpoints
+ *
+\verbatim
+Port  Interfaces  Endpoints
+0     0, 1        0x82 (command, interrupt), 0x01, 0x81 (data, bulk)
+1     2, 3        0x84 (command, interrupt), 0x03, 0x83 (data, bulk)
+\endverbatim
+ *
+ * Each port needs 2 IN endpoints and one OUT endpoint. USB OTG cores have 5 IN endpoints besides
+ * control endpoint, so at most 2 ports can be used. FS core on STM32F401/F405/F407/F411/F427/F429 devices
+ * has only 3 IN endpoints besides control endpoint, use HS core for 2 ports there.
+ * FIFO sizes are set in usbd_conf.c file.
+ *
+ * Transfers work the same as in @ref TM_USBD_CDC library. OUT endpoint of port receives directly
+ * to free memory in port RX buffer and NAKs host when buffer is full. IN endpoint sends directly from port TX buffer.
+ *
+\code
+//Init USB core and multi port device
+TM_USB_Init();
+TM_USBD_CDC_MULTI_Init(TM_USB_HS);
+TM_USBD_Start(TM_USB_HS);
+
+//Console on port 0, telemetry on port 1
+TM_USBD_CDC_MULTI_Puts(TM_USB_HS, 0, "Console ready\n");
+TM_USBD_CDC_MULTI_PutArray(TM_USB_HS, 1, samples, sizeof(samples));
+
+while (1) {
+    //Read console
+    if (TM_USBD_CDC_MULTI_Getc(TM_USB_HS, 0, &ch)) {
+        //Process character
+    }
+}
+\endcode
+ *
+ * \par Port settings
+ *
+ * Use defines.h file for copy/paste settings you need and change it.
+ *
+\code
+//Number of ports, 1 or 2
+#define USBD_CDC_MULTI_PORTS               2
+
+//Receive & transmit buffer size for all ports
+#define USBD_CDC_MULTI_BUFFER_SIZE         256
+
+//Buffer sizes for each port, RX buffer must be larger than one OUT packet
+#define USBD_CDC_MULTI_RX_BUFFER_SIZE_0    USBD_CDC_MULTI_BUFFER_SIZE
+#define USBD_CDC_MULTI_TX_BUFFER_SIZE_0    USBD_CDC_MULTI_BUFFER_SIZE
+#define USBD_CDC_MULTI_RX_BUFFER_SIZE_1    USBD_CDC_MULTI_BUFFER_SIZE
+#define USBD_CDC_MULTI_TX_BUFFER_SIZE_1    USBD_CDC_MULTI_BUFFER_SIZE
+
+//Maximal TX size for one USB transmission
+#define USBD_CDC_MULTI_MAX_TRANSMIT_SIZE   USBD_CDC_MULTI_BUFFER_SIZE
+\endcode
+ *
+ * @note  Windows 7 and older need INF file for CDC functions in composite device.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM BUFFER
+ - TM USB
+ - TM USB DEVICE
+ - USB Device Stack
+ - USB Device CDC MULTI
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_buffer.h"
+#include "tm_stm32_usb.h"
+#include "tm_stm32_usb_device.h"
+#include "usbd_core.h"
+#include "usbd_cdc_multi.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_USBD_CDC_MULTI_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Receive & transmit buffer size for all ports */
+#ifndef USBD_CDC_MULTI_BUFFER_SIZE
+#define USBD_CDC_MULTI_BUFFER_SIZE         256
+#endif
+
+/* Default RX buffer size, at least 2 packets when HS mode is used */
+#if defined(USB_USE_HS) && USBD_CDC_MULTI_BUFFER_SIZE < 2 * CDC_DATA_HS_OUT_PACKET_SIZE
+#define USBD_CDC_MULTI_RX_BUFFER_SIZE      (2 * CDC_DATA_HS_OUT_PACKET_SIZE)
+#else
+#define USBD_CDC_MULTI_RX_BUFFER_SIZE      USBD_CDC_MULTI_BUFFER_SIZE
+#endif
+
+/* Buffer sizes for port 0 */
+#ifndef USBD_CDC_MULTI_RX_BUFFER_SIZE_0
+#define USBD_CDC_MULTI_RX_BUFFER_SIZE_0    USBD_CDC_MULTI_RX_BUFFER_SIZE
+#endif
+#ifndef USBD_CDC_MULTI_TX_BUFFER_SIZE_0
+#define USBD_CDC_MULTI_TX_BUFFER_SIZE_0    USBD_CDC_MULTI_BUFFER_SIZE
+#endif
+
+/* Buffer sizes for port 1 */
+#ifndef USBD_CDC_MULTI_RX_BUFFER_SIZE_1
+#define USBD_CDC_MULTI_RX_BUFFER_SIZE_1    USBD_CDC_MULTI_RX_BUFFER_SIZE
+#endif
+#ifndef USBD_CDC_MULTI_TX_BUFFER_SIZE_1
+#define USBD_CDC_MULTI_TX_BUFFER_SIZE_1    USBD_CDC_MULTI_BUFFER_SIZE
+#endif
+
+/* Maximal TX size for one USB transmission, sent directly from TX buffer memory */
+#ifndef USBD_CDC_MULTI_MAX_TRANSMIT_SIZE
+#define USBD_CDC_MULTI_MAX_TRANSMIT_SIZE   USBD_CDC_MULTI_BUFFER_SIZE
+#endif
+
+/* Check RX buffer sizes, must hold one full OUT packet */
+#if defined(USB_USE_HS)
+#define USBD_CDC_MULTI_OUT_PACKET_SIZE     CDC_DATA_HS_OUT_PACKET_SIZE
+#else
+#define USBD_CDC_MULTI_OUT_PACKET_SIZE     CDC_DATA_FS_OUT_PACKET_SIZE
+#endif
+#if USBD_CDC_MULTI_RX_BUFFER_SIZE_0 <= USBD_CDC_MULTI_OUT_PACKET_SIZE || (USBD_CDC_MULTI_PORTS > 1 && USBD_CDC_MULTI_RX_BUFFER_SIZE_1 <= USBD_CDC_MULTI_OUT_PACKET_SIZE)
+#error "USBD_CDC_MULTI_RX_BUFFER_SIZE_x must be larger than OUT packet size!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_USBD_CDC_MULTI_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Settings structure for one CDC port
+ */
+typedef struct {
+	uint32_t Baudrate; /*!< Baudrate, which is set by user on terminal, for example: 115200 */
+	uint8_t Stopbits;  /*!< Stop bits, 0 = 1 stop bit, 1 = 1.5 stop bits, 2 = 2 stop bits */
+	uint8_t DataBits;  /*!< Data bits, 5 to 9 */
+	uint8_t Parity;    /*!< Parity, 0 = none, 1 = odd, 2 = even, 3 = mark, 4 = space */
+	uint8_t Opened;    /*!< Set to 1 when terminal on computer has port opened (DTR line is set) */
+	uint8_t Updated;   /*!< Set to 1 if any parameter has changed since last call */
+} TM_USBD_CDC_MULTI_Settings_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_USBD_CDC_MULTI_Functions
+ * @brief    Library Functions
+ * @{
+ */
+ 
+/**
+ * @brief  Initializes USB DEVICE for multi port CDC class on specific USB mode
+ * @param  USB_Mode: USB Mode where CDC DEVICE will be enabled. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @retval Member of @ref TM_USBD_Result_t enumeration
+ */
+TM_USBD_Result_t TM_USBD_CDC_MULTI_Init(TM_USB_t USB_Mode);
+
+/**
+ * @brief  Starts transmission of data in port TX buffer and enables receive again when port RX buffer was full
+ * @note   Next transfers are started from USB interrupt, there is no need to call it in loop
+ * @param  USB_Mode: USB Mode where process will be done. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @retval None
+ */
+void TM_USBD_CDC_MULTI_Process(TM_USB_t USB_Mode, uint8_t Port);
+
+/**
+ * @brief  Puts character to port
+ * @param  USB_Mode: USB Mode where transmission will be done. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  ch: Character to be sent
+ * @retval Number of characters added to TX buffer
+ */
+uint16_t TM_USBD_CDC_MULTI_Putc(TM_USB_t USB_Mode, uint8_t Port, char ch);
+
+/**
+ * @brief  Puts string to port
+ * @param  USB_Mode: USB Mode where transmission will be done. This parameter can be a value of @ref TM_USB_t enumeration
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *str: Pointer to string to be sent
+ * @retval Number of characters added to TX buffer
+ */
+uint16_t TM_USBD_CDC_MULTI_Puts(TM_USB_t USB_Mode, uint8_t Port, const char* str);
+
+/**
+ * @brief  Puts array of data to port
+ * @param  USB_Mode: USB Mode where transmission will be done. This parameter can be a value of @ref TM_USB_t enumeration
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *buff: Pointer to data to be sent
+ * @param  count: Number of elements to send
+ * @retval Number of elements written to TX buffer
+ */
+uint16_t TM_USBD_CDC_MULTI_PutArray(TM_USB_t USB_Mode, uint8_t Port, uint8_t* buff, uint16_t count);
+
+/**
+ * @brief  Gets character from port RX buffer
+ * @param  USB_Mode: USB Mode where char will be read. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *ch: Pointer to character to store value into
+ * @retval 1 in case character is read or zero if buffer empty
+ */
+uint8_t TM_USBD_CDC_MULTI_Getc(TM_USB_t USB_Mode, uint8_t Port, char* ch);
+
+/**
+ * @brief  Gets string from port RX buffer
+ * @note   Check @ref TM_BUFFER library for more info on how strings are returned
+ * @param  USB_Mode: USB Mode where string will be read. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *buff: Pointer to buffer where string will be saved
+ * @param  buffsize: Buffer size in units of bytes
+ * @retval Number of elements in string
+ */
+uint16_t TM_USBD_CDC_MULTI_Gets(TM_USB_t USB_Mode, uint8_t Port, char* buff, uint16_t buffsize);
+
+/**
+ * @brief  Gets array of data from port RX buffer
+ * @param  USB_Mode: USB Mode where data will be read. This parameter can be a value of @ref TM_USB_t enumeration
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *buff: Pointer to buffer where array will be stored
+ * @param  count: Number of elements to read
+ * @retval Number of elements read from buffer
+ */
+uint16_t TM_USBD_CDC_MULTI_GetArray(TM_USB_t USB_Mode, uint8_t Port, uint8_t* buff, uint16_t count);
+
+/**
+ * @brief  Reads current settings of port set from user terminal
+ * @param  USB_Mode: USB mode where to read settings. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *Settings: Pointer to @ref TM_USBD_CDC_MULTI_Settings_t struture to fill data into
+ * @retval None
+ */
+void TM_USBD_CDC_MULTI_GetSettings(TM_USB_t USB_Mode, uint8_t Port, TM_USBD_CDC_MULTI_Settings_t* Settings);
+
+/**
+ * @brief  Gets pointer to port RX buffer with data received from host
+ * @note   Memory read directly from buffer must be released with @ref TM_BUFFER_CommitRead,
+ *         followed by @ref TM_USBD_CDC_MULTI_Process call to enable receive again if RX buffer was full
+ * @param  USB_Mode: USB mode where to get buffer. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @retval Pointer to @ref TM_BUFFER_t structure or NULL if mode or port is not valid
+ */
+TM_BUFFER_t* TM_USBD_CDC_MULTI_GetRXBuffer(TM_USB_t USB_Mode, uint8_t Port);
+
+/**
+ * @brief  Sets buffer from which port IN endpoint sends data to host
+ * @note   Data are sent directly from buffer memory, put functions write to the same buffer.
+ *         Call @ref TM_USBD_CDC_MULTI_Process when new data are written to buffer by other source, like DMA
+ * @param  USB_Mode: USB mode where to set buffer. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number, 0 to USBD_CDC_MULTI_PORTS - 1
+ * @param  *Buffer: Pointer to @ref TM_BUFFER_t structure with data to send. Set to NULL to use internal TX buffer
+ * @retval Buffer status:
+ *            - 0: IN transfer is in progress or mode or port not valid, buffer was not changed
+ *            - > 0: Buffer changed
+ */
+uint8_t TM_USBD_CDC_MULTI_SetTXBuffer(TM_USB_t USB_Mode, uint8_t Port, TM_BUFFER_t* Buffer);
+
+/**
+ * @brief  Receive callback, called when new data from host are added to port RX buffer
+ * @note   Called from USB interrupt
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  USB_Mode: USB mode where data were received. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  Port: Port number where data were received
+ * @retval None
+ */
+void TM_USBD_CDC_MULTI_ReceiveCallback(TM_USB_t USB_Mode, uint8_t Port);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
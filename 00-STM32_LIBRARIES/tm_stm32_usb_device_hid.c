@@ -0,0 +1,462 @@
+/**	
+ * |----------------------------------------------------------------------
+ * | Copyright (c) 2016 Tilen Majerle
+ * |  
+ * | Permission is hereby granted, free of charge, to any person
+ * | obtaining a copy of this software and associated documentation
+ * | files (the "Software"), to deal in the Software without restriction,
+ * | including without limitation the rights to use, copy, modify, merge,
+ * | publish, distribute, sublicense, and/or sell copies of the Software, 
+ * | and to permit persons to whom the Software is furnished to do so, 
+ * | subject to the following conditions:
+ * | 
+ * | The above copyright notice and this permission notice shall be
+ * | included in all copies or substantial portions of the Software.
+ * | 
+ * | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * | EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * | OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * | AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * | HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * | WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ * | FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * | OTHER DEALINGS IN THE SOFTWARE.
+ * |----------------------------------------------------------------------
+ */
+#include "tm_stm32_usb_device_hid.h"
+
+/* Exported functions ------------------------------------------------------- */
+extern USBD_DescriptorsTypeDef HID_Desc;
+
+/* Private typedef -----------------------------------------------------------*/
+/* Report queue for one USB mode */
+typedef struct {
+	uint8_t Data[USBD_HID_QUEUE_SIZE][USBD_HID_REPORT_IN_SIZE];  /* Report memory, sent directly to endpoint */
+	uint16_t Length[USBD_HID_QUEUE_SIZE];                       /* Report lengths */
+	uint8_t In;                                                 /* Next slot to write */
+	uint8_t Out;                                                /* Next slot to send */
+	uint8_t Count;                                              /* Number of reports in queue, including report in transfer */
+	uint8_t Pending;                                            /* Report at Out slot is in transfer */
+	TM_USBD_HID_Stats_t Stats;                                  /* Report statistics */
+} TM_USBD_HID_INT_t;
+
+/* Private define ------------------------------------------------------------*/
+#define USBD_VID                      0x0483
+#define USBD_PID                      0x5750
+#define USBD_LANGID_STRING            0x409
+#define USBD_MANUFACTURER_STRING      "STMicroelectronics"
+#define USBD_PRODUCT_HS_STRING        "STM32 HID Device in HS Mode"
+#define USBD_PRODUCT_FS_STRING        "STM32 HID Device in FS Mode"
+#define USBD_CONFIGURATION_HS_STRING  "HID Config"
+#define USBD_INTERFACE_HS_STRING      "HID Interface"
+#define USBD_CONFIGURATION_FS_STRING  "HID Config"
+#define USBD_INTERFACE_FS_STRING      "HID Interface"
+
+/* Private macro -------------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+uint8_t *USBD_HID_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_HID_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_HID_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_HID_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_HID_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_HID_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_HID_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+
+static int8_t TM_USBD_HID_INT_Init(USBD_HandleTypeDef* pdev);
+static int8_t TM_USBD_HID_INT_DeInit(USBD_HandleTypeDef* pdev);
+static int8_t TM_USBD_HID_INT_OutReport(USBD_HandleTypeDef* pdev, uint8_t* pbuf, uint16_t len);
+static int8_t TM_USBD_HID_INT_InCplt(USBD_HandleTypeDef* pdev);
+
+/* Private variables ---------------------------------------------------------*/
+USBD_DescriptorsTypeDef HID_Desc = {
+	USBD_HID_DeviceDescriptor,
+	USBD_HID_LangIDStrDescriptor, 
+	USBD_HID_ManufacturerStrDescriptor,
+	USBD_HID_ProductStrDescriptor,
+	USBD_HID_SerialStrDescriptor,
+	USBD_HID_ConfigStrDescriptor,
+	USBD_HID_InterfaceStrDescriptor,  
+};
+
+/* Built-in vendor defined report descriptor, one IN and one OUT report without report ID */
+static const uint8_t USBD_HID_DefaultReport[] = {
+	0x06, 0x00, 0xFF,           /* Usage Page (Vendor Defined 0xFF00) */
+	0x09, 0x01,                 /* Usage (0x01) */
+	0xA1, 0x01,                 /* Collection (Application) */
+	0x15, 0x00,                 /*   Logical Minimum (0) */
+	0x26, 0xFF, 0x00,           /*   Logical Maximum (255) */
+	0x75, 0x08,                 /*   Report Size (8) */
+	0x96, LOBYTE(USBD_HID_REPORT_IN_SIZE), HIBYTE(USBD_HID_REPORT_IN_SIZE),    /* Report Count (IN size) */
+	0x09, 0x01,                 /*   Usage (0x01) */
+	0x81, 0x02,                 /*   Input (Data, Var, Abs) */
+	0x96, LOBYTE(USBD_HID_REPORT_OUT_SIZE), HIBYTE(USBD_HID_REPORT_OUT_SIZE),  /* Report Count (OUT size) */
+	0x09, 0x01,                 /*   Usage (0x01) */
+	0x91, 0x02,                 /*   Output (Data, Var, Abs) */
+	0xC0                        /* End Collection */
+};
+
+/* Interface callbacks, the same for both USB modes, report descriptor is set on init */
+static USBD_HID_REPORT_ItfTypeDef USBD_HID_fops = {
+	USBD_HID_DefaultReport,
+	sizeof(USBD_HID_DefaultReport),
+	TM_USBD_HID_INT_Init,
+	TM_USBD_HID_INT_DeInit,
+	TM_USBD_HID_INT_OutReport,
+	TM_USBD_HID_INT_InCplt
+};
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
+	0x12,                       /* bLength */
+	USB_DESC_TYPE_DEVICE,       /* bDescriptorType */
+	0x00,                       /* bcdUSB */
+	0x02,
+	0x00,                       /* bDeviceClass: Defined in interface */
+	0x00,                       /* bDeviceSubClass */
+	0x00,                       /* bDeviceProtocol */
+	USB_MAX_EP0_SIZE,           /* bMaxPacketSize */
+	LOBYTE(USBD_VID),           /* idVendor */
+	HIBYTE(USBD_VID),           /* idVendor */
+	LOBYTE(USBD_PID),           /* idVendor */
+	HIBYTE(USBD_PID),           /* idVendor */
+	0x00,                       /* bcdDevice rel. 2.00 */
+	0x02,
+	USBD_IDX_MFC_STR,           /* Index of manufacturer string */
+	USBD_IDX_PRODUCT_STR,       /* Index of product string */
+	USBD_IDX_SERIAL_STR,        /* Index of serial number string */
+	USBD_MAX_NUM_CONFIGURATION  /* bNumConfigurations */
+}; /* USB_DeviceDescriptor */
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+	USB_LEN_LANGID_STR_DESC,         
+	USB_DESC_TYPE_STRING,       
+	LOBYTE(USBD_LANGID_STRING),
+	HIBYTE(USBD_LANGID_STRING), 
+};
+
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
+
+/* Report queue for each USB mode */
+#ifdef USB_USE_FS
+static TM_USBD_HID_INT_t USBD_HID_INT_FS;
+#endif
+#ifdef USB_USE_HS
+static TM_USBD_HID_INT_t USBD_HID_INT_HS;
+#endif
+
+/* Returns pointer to report queue for USB mode */
+static TM_USBD_HID_INT_t* TM_USBD_HID_INT_GetMode(TM_USB_t USB_Mode) {
+	TM_USBD_HID_INT_t* HID = 0;
+	
+#ifdef USB_USE_FS
+	if (USB_Mode == TM_USB_FS) {
+		HID = &USBD_HID_INT_FS;
+	}
+#endif
+#ifdef USB_USE_HS
+	if (USB_Mode == TM_USB_HS) {
+		HID = &USBD_HID_INT_HS;
+	}
+#endif
+	/* Return pointer */
+	return HID;
+}
+
+/* Starts transfer of oldest report in queue, must be called with USB interrupt disabled or from USB interrupt */
+static void TM_USBD_HID_INT_Transmit(USBD_HandleTypeDef* pdev, TM_USBD_HID_INT_t* HID) {
+	/* Previous report is still in transfer or queue is empty */
+	if (HID->Pending || HID->Count == 0) {
+		return;
+	}
+	
+	/* Send directly from queue memory, slot is released when host reads report */
+	if (USBD_HID_REPORT_SendReport(pdev, HID->Data[HID->Out], HID->Length[HID->Out]) == USBD_OK) {
+		HID->Pending = 1;
+	}
+}
+
+/************************************************/
+/*            USER PUBLIC FUNCTIONS             */
+/************************************************/
+TM_USBD_Result_t TM_USBD_HID_Init(TM_USB_t USB_Mode, const uint8_t* ReportDesc, uint16_t ReportDescSize) {
+	/* Set report descriptor, applied to descriptors on interface register */
+	if (ReportDesc != NULL && ReportDescSize > 0) {
+		USBD_HID_fops.pReport = ReportDesc;
+		USBD_HID_fops.ReportSize = ReportDescSize;
+	} else {
+		USBD_HID_fops.pReport = USBD_HID_DefaultReport;
+		USBD_HID_fops.ReportSize = sizeof(USBD_HID_DefaultReport);
+	}
+	
+#ifdef USB_USE_FS
+	/* Init FS mode */
+	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
+		/* Reset queue */
+		memset(&USBD_HID_INT_FS, 0, sizeof(USBD_HID_INT_FS));
+		/* Init FS */
+		USBD_Init(&hUSBDevice_FS, &HID_Desc, USB_ID_FS);
+		/* Add Supported Class */
+		USBD_RegisterClass(&hUSBDevice_FS, USBD_HID_REPORT_CLASS);
+		/* Add HID Interface Class */
+		USBD_HID_REPORT_RegisterInterface(&hUSBDevice_FS, &USBD_HID_fops);
+	}
+#endif
+	
+#ifdef USB_USE_HS
+	/* Init HS mode */
+	if (USB_Mode == TM_USB_HS || USB_Mode == TM_USB_Both) {
+		/* Reset queue */
+		memset(&USBD_HID_INT_HS, 0, sizeof(USBD_HID_INT_HS));
+		/* Init HS */
+		USBD_Init(&hUSBDevice_HS, &HID_Desc, USB_ID_HS);
+		/* Add Supported Class */
+		USBD_RegisterClass(&hUSBDevice_HS, USBD_HID_REPORT_CLASS);
+		/* Add HID Interface Class */
+		USBD_HID_REPORT_RegisterInterface(&hUSBDevice_HS, &USBD_HID_fops);
+	}
+#endif
+	
+	/* Return OK */
+	return TM_USBD_Result_Ok;
+}
+
+uint8_t TM_USBD_HID_SendReport(TM_USB_t USB_Mode, const uint8_t* Report, uint16_t Length) {
+	TM_USBD_HID_INT_t* HID = TM_USBD_HID_INT_GetMode(USB_Mode);
+	uint32_t irq;
+	
+	/* Check valid */
+	if (HID == NULL || Length == 0 || Length > USBD_HID_REPORT_IN_SIZE) {
+		return 0;
+	}
+	
+	/* Disable interrupts, USB interrupt uses the same queue */
+	irq = TM_NVIC_Lock();
+	
+	/* Queue is full, newest report is dropped */
+	if (HID->Count >= USBD_HID_QUEUE_SIZE) {
+		HID->Stats.Dropped++;
+		TM_NVIC_Unlock(irq);
+		return 0;
+	}
+	
+	/* Copy report to free slot */
+	memcpy(HID->Data[HID->In], Report, Length);
+	HID->Length[HID->In] = Length;
+	if (++HID->In >= USBD_HID_QUEUE_SIZE) {
+		HID->In = 0;
+	}
+	HID->Count++;
+	
+	/* Start transfer if endpoint is idle, otherwise it is started from transfer complete */
+	TM_USBD_HID_INT_Transmit(TM_USBD_GetUSBPointer(USB_Mode), HID);
+	
+	/* Enable interrupts back */
+	TM_NVIC_Unlock(irq);
+	
+	/* Report added */
+	return 1;
+}
+
+uint16_t TM_USBD_HID_GetFree(TM_USB_t USB_Mode) {
+	TM_USBD_HID_INT_t* HID = TM_USBD_HID_INT_GetMode(USB_Mode);
+	
+	/* Return number of free slots */
+	return HID ? (USBD_HID_QUEUE_SIZE - HID->Count) : 0;
+}
+
+void TM_USBD_HID_GetStats(TM_USB_t USB_Mode, TM_USBD_HID_Stats_t* Stats) {
+	TM_USBD_HID_INT_t* HID = TM_USBD_HID_INT_GetMode(USB_Mode);
+	uint32_t irq;
+	
+	/* Check valid */
+	if (HID == NULL) {
+		memset(Stats, 0, sizeof(TM_USBD_HID_Stats_t));
+		return;
+	}
+	
+	/* Copy consistent values */
+	irq = TM_NVIC_Lock();
+	*Stats = HID->Stats;
+	TM_NVIC_Unlock(irq);
+}
+
+__weak void TM_USBD_HID_ReportCallback(TM_USB_t USB_Mode, uint8_t* Report, uint16_t Length) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+           the TM_USBD_HID_ReportCallback could be implemented in the user file
+	*/
+}
+
+/************************************************/
+/*               PRIVATE FUNCTIONS              */
+/************************************************/
+static int8_t TM_USBD_HID_INT_Init(USBD_HandleTypeDef* pdev) {
+	TM_USBD_HID_INT_t* HID = TM_USBD_HID_INT_GetMode((TM_USB_t)pdev->id);
+	
+	/* Check valid */
+	if (HID == NULL) {
+		return USBD_FAIL;
+	}
+	
+	/* Reports queued before configuration are old, drop them */
+	HID->In = 0;
+	HID->Out = 0;
+	HID->Count = 0;
+	HID->Pending = 0;
+	
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t TM_USBD_HID_INT_DeInit(USBD_HandleTypeDef* pdev) {
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t TM_USBD_HID_INT_OutReport(USBD_HandleTypeDef* pdev, uint8_t* pbuf, uint16_t len) {
+	TM_USBD_HID_INT_t* HID = TM_USBD_HID_INT_GetMode((TM_USB_t)pdev->id);
+	
+	/* Check valid */
+	if (HID == NULL) {
+		return USBD_FAIL;
+	}
+	
+	/* Count report */
+	HID->Stats.Received++;
+	
+	/* Notify user, USB ID is the same as USB mode */
+	TM_USBD_HID_ReportCallback((TM_USB_t)pdev->id, pbuf, len);
+	
+	/* Return OK */
+	return USBD_OK;
+}
+
+static int8_t TM_USBD_HID_INT_InCplt(USBD_HandleTypeDef* pdev) {
+	TM_USBD_HID_INT_t* HID = TM_USBD_HID_INT_GetMode((TM_USB_t)pdev->id);
+	
+	/* Check valid */
+	if (HID == NULL) {
+		return USBD_FAIL;
+	}
+	
+	/* Release sent slot */
+	if (HID->Pending) {
+		HID->Pending = 0;
+		if (++HID->Out >= USBD_HID_QUEUE_SIZE) {
+			HID->Out = 0;
+		}
+		HID->Count--;
+		HID->Stats.Sent++;
+	}
+	
+	/* Start next report */
+	TM_USBD_HID_INT_Transmit(pdev, HID);
+	
+	/* Return OK */
+	return USBD_OK;
+}
+
+/************************************************/
+/*             LIBRARY DESCRIPTORS              */
+/************************************************/
+
+/**
+  * @brief  Returns the device descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = sizeof(USBD_DeviceDesc);
+	return (uint8_t*)USBD_DeviceDesc;
+}
+
+/**
+  * @brief  Returns the LangID string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = sizeof(USBD_LangIDDesc);  
+	return (uint8_t*)USBD_LangIDDesc;
+}
+
+/**
+  * @brief  Returns the product string descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {   
+		USBD_GetString((uint8_t *)USBD_PRODUCT_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_PRODUCT_FS_STRING, USBD_StrDesc, length);    
+	}
+	return USBD_StrDesc;
+}
+
+/**
+  * @brief  Returns the manufacturer string descriptor. 
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	USBD_GetString((uint8_t *)USBD_MANUFACTURER_STRING, USBD_StrDesc, length);
+	return USBD_StrDesc;
+}
+
+/**
+  * @brief  Returns the serial number string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	*length = ID_USB_SERIAL_SIZE;
+
+	/* Serial number string descriptor is cached in identity block */
+	return (uint8_t*)TM_ID_Get()->USBSerial;
+}
+
+/**
+  * @brief  Returns the configuration string descriptor.    
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {  
+		USBD_GetString((uint8_t *)USBD_CONFIGURATION_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_CONFIGURATION_FS_STRING, USBD_StrDesc, length); 
+	}
+	return USBD_StrDesc;  
+}
+
+/**
+  * @brief  Returns the interface string descriptor.        
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_HID_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
+	if (speed == USBD_SPEED_HIGH) {
+		USBD_GetString((uint8_t *)USBD_INTERFACE_HS_STRING, USBD_StrDesc, length);
+	} else {
+		USBD_GetString((uint8_t *)USBD_INTERFACE_FS_STRING, USBD_StrDesc, length);
+	}
+	return USBD_StrDesc;  
+}
+
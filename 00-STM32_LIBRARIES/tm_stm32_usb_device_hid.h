@@ -0,0 +1,252 @@
+/**
+ * @author  Tilen Majerle
+ * @email   tilen@majerle.eu
+ * @website http://stm32f4-discovery.com
+ * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @version v1.0
+ * @ide     Keil uVision
+ * @license MIT
+ * @brief   USB HID Device library for STM32Fxxx devices
+ *	
+\verbatim
+   ----------------------------------------------------------------------
+    Copyright (c) 2016 Tilen Majerle
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, 
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+    AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+   ----------------------------------------------------------------------
+\endverbatim
+ */
+#ifndef TM_USBD_HID_H
+#define TM_USBD_HID_H 100
+
+/* C++ detection */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup TM_STM32Fxxx_HAL_Libraries
+ * @{
+ */
+
+/**
+ * @defgroup TM_USBD_HID
+ * @brief    USB HID Device library for STM32Fxxx devices - http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
+ * @{
+ *
+ * With this library, your STM32Fxxx device acts like HID device with custom reports, for example sensor or button reports.
+ * No driver is needed on host, reports can be read with hidapi or any other HID library.
+ *
+ * @note  Check @ref TM_USB library for configuration settings first!
+ *
+ * \par Main features
+ *
+\verbatim
+- Works on USB FS or HS mode
+- Interrupt IN and OUT endpoints, host polls device every 1 ms by default
+- Custom report descriptor or built-in vendor defined descriptor with one IN and one OUT report
+- Queue of IN reports, can be filled from interrupts
+- Reports are sent directly from queue memory
+\endverbatim
+ *
+ * \par Latency
+ *
+ * Interrupt endpoints have guaranteed bandwidth, host polls IN endpoint every USBD_HID_REPORT_FS_INTERVAL ms
+ * in full speed. Report queued between polls is sent on next poll, so with 1 ms interval host gets
+ * reports at fixed 1 kHz rate, which bulk endpoints used by CDC can not guarantee.
+ *
+ * In high speed (HS mode with external ULPI PHY), interval is 2^(USBD_HID_REPORT_HS_INTERVAL - 1) microframes.
+ * Default value 4 is 1 ms, value 1 polls every microframe, 8 kHz report rate, with reports up to 1024 bytes.
+ *
+ * @note  Multiple transactions per microframe are not used, HAL PCD driver sets multi count for isochronous endpoints only.
+ *        Use larger reports with shorter interval in high speed instead.
+ *
+\code
+//Init USB core and HID device with built-in vendor descriptor
+TM_USB_Init();
+TM_USBD_HID_Init(TM_USB_FS, NULL, 0);
+TM_USBD_Start(TM_USB_FS);
+
+//In timer or EXTI interrupt
+uint8_t report[USBD_HID_REPORT_IN_SIZE];
+report[0] = buttons;
+TM_USBD_HID_SendReport(TM_USB_FS, report, sizeof(report));
+\endcode
+ *
+ * \par Defines
+ *
+\code
+//Report sizes, endpoint packet sizes, 64 max in full speed and 1024 max in high speed
+#define USBD_HID_REPORT_IN_SIZE           64
+#define USBD_HID_REPORT_OUT_SIZE          64
+
+//Polling interval, 1 ms in full speed, 2^(n - 1) * 125 us in high speed
+#define USBD_HID_REPORT_FS_INTERVAL       1
+#define USBD_HID_REPORT_HS_INTERVAL       4
+
+//Number of IN reports in queue
+#define USBD_HID_QUEUE_SIZE               8
+\endcode
+ *
+ * @note  Interrupts which call @ref TM_USBD_HID_SendReport must not have higher priority than NVIC_LOCK_PRIORITY from @ref TM_NVIC library.
+ *
+ * \par Changelog
+ *
+\verbatim
+ Version 1.0
+  - October 14, 2026
+  - First release
+\endverbatim
+ *
+ * \par Dependencies
+ *
+\verbatim
+ - STM32Fxxx HAL
+ - defines.h
+ - TM NVIC
+ - TM USB
+ - TM USB DEVICE
+ - USB Device Stack
+ - USB Device HID report
+\endverbatim
+ */
+
+#include "stm32fxxx_hal.h"
+#include "defines.h"
+#include "tm_stm32_nvic.h"
+#include "tm_stm32_usb.h"
+#include "tm_stm32_usb_device.h"
+#include "usbd_core.h"
+#include "usbd_hid_report.h"
+#include "string.h"
+
+/**
+ * @defgroup TM_USBD_HID_Macros
+ * @brief    Library defines
+ * @{
+ */
+
+/* Number of IN reports in queue */
+#ifndef USBD_HID_QUEUE_SIZE
+#define USBD_HID_QUEUE_SIZE            8
+#endif
+
+/* Check settings */
+#if USBD_HID_QUEUE_SIZE < 2 || USBD_HID_QUEUE_SIZE > 255
+#error "USBD_HID_QUEUE_SIZE must be between 2 and 255!"
+#endif
+
+/**
+ * @}
+ */
+ 
+/**
+ * @defgroup TM_USBD_HID_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  HID report statistics
+ */
+typedef struct {
+	uint32_t Sent;      /*!< IN reports read by host */
+	uint32_t Dropped;   /*!< IN reports dropped because queue was full */
+	uint32_t Received;  /*!< OUT reports received from host */
+} TM_USBD_HID_Stats_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_USBD_HID_Functions
+ * @brief    Library Functions
+ * @{
+ */
+ 
+/**
+ * @brief  Initializes USB DEVICE for HID class on specific USB mode
+ * @note   Both USB modes use the same report descriptor
+ * @param  USB_Mode: USB Mode where HID DEVICE will be enabled. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  *ReportDesc: Pointer to report descriptor, must stay valid. Set to NULL to use built-in vendor defined descriptor
+ *            with one IN report of USBD_HID_REPORT_IN_SIZE bytes and one OUT report of USBD_HID_REPORT_OUT_SIZE bytes
+ * @param  ReportDescSize: Report descriptor size in bytes, ignored when ReportDesc is NULL
+ * @retval Member of @ref TM_USBD_Result_t enumeration
+ */
+TM_USBD_Result_t TM_USBD_HID_Init(TM_USB_t USB_Mode, const uint8_t* ReportDesc, uint16_t ReportDescSize);
+
+/**
+ * @brief  Adds IN report to queue, report is sent on next poll from host
+ * @note   Can be called from interrupts, report is copied to queue
+ * @param  USB_Mode: USB Mode where report will be sent. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  *Report: Pointer to report data, including report ID when descriptor uses report IDs
+ * @param  Length: Report length in bytes, up to USBD_HID_REPORT_IN_SIZE
+ * @retval Report status:
+ *            - 0: Queue is full, mode not valid or report too long, report was dropped
+ *            - > 0: Report added to queue
+ */
+uint8_t TM_USBD_HID_SendReport(TM_USB_t USB_Mode, const uint8_t* Report, uint16_t Length);
+
+/**
+ * @brief  Gets number of free report slots in queue
+ * @param  USB_Mode: USB Mode to check. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @retval Number of reports which can be added to queue
+ */
+uint16_t TM_USBD_HID_GetFree(TM_USB_t USB_Mode);
+
+/**
+ * @brief  Gets report statistics
+ * @param  USB_Mode: USB Mode to check. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  *Stats: Pointer to @ref TM_USBD_HID_Stats_t structure to fill
+ * @retval None
+ */
+void TM_USBD_HID_GetStats(TM_USB_t USB_Mode, TM_USBD_HID_Stats_t* Stats);
+
+/**
+ * @brief  Report callback, called when OUT report is received from host on OUT endpoint or with SET_REPORT request
+ * @note   Called from USB interrupt
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @param  USB_Mode: USB mode where report was received. This parameter can be a value of @ref TM_USB_t enumeration 
+ * @param  *Report: Pointer to report data, valid only during callback
+ * @param  Length: Report length in bytes
+ * @retval None
+ */
+void TM_USBD_HID_ReportCallback(TM_USB_t USB_Mode, uint8_t* Report, uint16_t Length);
+
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+ 
+/**
+ * @}
+ */
+
+/* C++ detection */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
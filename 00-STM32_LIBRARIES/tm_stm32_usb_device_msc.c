@@ -24,23 +24,22 @@
  * |----------------------------------------------------------------------
  */
 #include "tm_stm32_usb_device_msc.h"
+#if USBD_MSC_USE_SDCARD
 #include "fatfs_sd_sdio.h"
+#endif
 
 /* External variables */
 extern USBD_StorageTypeDef USBD_MSC_fops[];
+extern int8_t STORAGE_Inquirydata[];
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
-#define DEVICE_ID1              (0x1FFF7A10)
-#define DEVICE_ID2              (0x1FFF7A14)
-#define DEVICE_ID3              (0x1FFF7A18)
-
-#define USB_SIZ_STRING_SERIAL    0x1A
-
-#define STORAGE_LUN_NBR                  1  
-#define STORAGE_BLK_NBR                  0x10000  
 #define STORAGE_BLK_SIZ                  0x200
 
+/* Product name in inquiry data starts at offset 16 and has 16 characters */
+#define STORAGE_PRODUCT_OFFSET           16
+#define STORAGE_PRODUCT_SIZE             16
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 extern USBD_DescriptorsTypeDef MSC_Desc;
@@ -86,7 +85,7 @@ USBD_DescriptorsTypeDef MSC_Desc = {
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
   #pragma data_alignment=4   
 #endif
-__ALIGN_BEGIN uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
+__ALIGN_BEGIN static uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
 	0x12,                       /* bLength */
 	USB_DESC_TYPE_DEVICE,       /* bDescriptorType */
 	0x00,                       /* bcdUSB */
@@ -111,31 +110,125 @@ __ALIGN_BEGIN uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
   #pragma data_alignment=4   
 #endif
-__ALIGN_BEGIN uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+__ALIGN_BEGIN static uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
 	USB_LEN_LANGID_STR_DESC,         
 	USB_DESC_TYPE_STRING,       
 	LOBYTE(USBD_LANGID_STRING),
 	HIBYTE(USBD_LANGID_STRING), 
 };
 
-uint8_t USBD_StringSerial[USB_SIZ_STRING_SERIAL] = {
-	USB_SIZ_STRING_SERIAL,      
-	USB_DESC_TYPE_STRING,    
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+  #pragma data_alignment=4   
+#endif
+__ALIGN_BEGIN static uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
+
+/* Built-in media drivers */
+#if USBD_MSC_USE_SDCARD
+static int8_t TM_USBD_MSC_INT_SDCARD_Init(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_SDCARD_GetCapacity(uint8_t lun, uint32_t* block_num, uint16_t* block_size);
+static int8_t TM_USBD_MSC_INT_SDCARD_IsReady(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_SDCARD_IsWriteProtected(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_SDCARD_ReadStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t TM_USBD_MSC_INT_SDCARD_WriteStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t TM_USBD_MSC_INT_SDCARD_Wait(uint8_t lun);
+
+const TM_USBD_MSC_Media_t TM_USBD_MSC_Media_SDCARD = {
+	TM_USBD_MSC_INT_SDCARD_Init,
+	TM_USBD_MSC_INT_SDCARD_GetCapacity,
+	TM_USBD_MSC_INT_SDCARD_IsReady,
+	TM_USBD_MSC_INT_SDCARD_IsWriteProtected,
+	TM_USBD_MSC_INT_SDCARD_ReadStart,
+	TM_USBD_MSC_INT_SDCARD_WriteStart,
+	TM_USBD_MSC_INT_SDCARD_Wait,
+	"SD Card"
+};
+#endif
+
+#if USBD_MSC_USE_SDRAM
+static int8_t TM_USBD_MSC_INT_SDRAM_Init(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_SDRAM_GetCapacity(uint8_t lun, uint32_t* block_num, uint16_t* block_size);
+static int8_t TM_USBD_MSC_INT_SDRAM_IsReady(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_SDRAM_IsWriteProtected(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_SDRAM_ReadStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t TM_USBD_MSC_INT_SDRAM_WriteStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t TM_USBD_MSC_INT_SDRAM_Wait(uint8_t lun);
+static void TM_USBD_MSC_INT_SDRAM_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param);
+
+const TM_USBD_MSC_Media_t TM_USBD_MSC_Media_SDRAM = {
+	TM_USBD_MSC_INT_SDRAM_Init,
+	TM_USBD_MSC_INT_SDRAM_GetCapacity,
+	TM_USBD_MSC_INT_SDRAM_IsReady,
+	TM_USBD_MSC_INT_SDRAM_IsWriteProtected,
+	TM_USBD_MSC_INT_SDRAM_ReadStart,
+	TM_USBD_MSC_INT_SDRAM_WriteStart,
+	TM_USBD_MSC_INT_SDRAM_Wait,
+	"SDRAM Disk"
 };
 
+/* SDRAM media state */
+static DMA_HandleTypeDef SDRAM_DMA_Handle;
+static uint8_t SDRAM_Initialized = 0;
+static volatile uint8_t SDRAM_DMA_Done = 1;
+static volatile uint8_t SDRAM_DMA_Error = 0;
+#if defined(STM32F7xx)
+static uint32_t SDRAM_Dst, SDRAM_Size;
+#endif
+#endif
 
-#if defined ( __ICCARM__ ) /*!< IAR Compiler */
-  #pragma data_alignment=4   
+#if USBD_MSC_USE_QSPI
+static int8_t TM_USBD_MSC_INT_QSPI_Init(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_QSPI_GetCapacity(uint8_t lun, uint32_t* block_num, uint16_t* block_size);
+static int8_t TM_USBD_MSC_INT_QSPI_IsReady(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_QSPI_IsWriteProtected(uint8_t lun);
+static int8_t TM_USBD_MSC_INT_QSPI_ReadStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t TM_USBD_MSC_INT_QSPI_WriteStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+static int8_t TM_USBD_MSC_INT_QSPI_Wait(uint8_t lun);
+
+const TM_USBD_MSC_Media_t TM_USBD_MSC_Media_QSPI = {
+	TM_USBD_MSC_INT_QSPI_Init,
+	TM_USBD_MSC_INT_QSPI_GetCapacity,
+	TM_USBD_MSC_INT_QSPI_IsReady,
+	TM_USBD_MSC_INT_QSPI_IsWriteProtected,
+	TM_USBD_MSC_INT_QSPI_ReadStart,
+	TM_USBD_MSC_INT_QSPI_WriteStart,
+	TM_USBD_MSC_INT_QSPI_Wait,
+	"QSPI Flash"
+};
+
+/* QSPI media state, subsector buffer for read-modify-write */
+static uint8_t QSPI_Initialized = 0;
+static int8_t QSPI_Status = 0;
+static uint8_t QSPI_Subsector[N25Q128A_SUBSECTOR_SIZE];
 #endif
-__ALIGN_BEGIN uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
 
-/* Private functions ---------------------------------------------------------*/
-static void IntToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len);
-static void Get_SerialNum(void);
+/* Media driver for each LUN */
+static const TM_USBD_MSC_Media_t* MSC_Media[USBD_MSC_LUNS] = {
+#if USBD_MSC_USE_SDCARD
+	&TM_USBD_MSC_Media_SDCARD
+#else
+	NULL
+#endif
+};
+
+/* Gets media for LUN, NULL when LUN is not valid */
+#define MSC_GET_MEDIA(lun)      ((lun) < USBD_MSC_LUNS ? MSC_Media[(lun)] : NULL)
 
 /************************************************/
 /*            USER PUBLIC FUNCTIONS             */
 /************************************************/
+TM_USBD_Result_t TM_USBD_MSC_SetMedia(uint8_t lun, const TM_USBD_MSC_Media_t* Media) {
+	/* Check LUN */
+	if (lun >= USBD_MSC_LUNS) {
+		return TM_USBD_Result_Error;
+	}
+	
+	/* Save media driver */
+	MSC_Media[lun] = Media;
+	
+	/* Return OK */
+	return TM_USBD_Result_Ok;
+}
+
 TM_USBD_Result_t TM_USBD_MSC_Init(TM_USB_t USB_Mode) {
 #ifdef USB_USE_FS
 	/* Init FS mode */
@@ -173,6 +266,143 @@ TM_USBD_Result_t TM_USBD_MSC_Init(TM_USB_t USB_Mode) {
 /*               DEVICE CALLBACKS               */
 /************************************************/
 int8_t TM_USBD_MSC_InitCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
+	const TM_USBD_MSC_Media_t* media;
+	int8_t* inquiry;
+	uint8_t i, j;
+	int8_t ret = 0;
+	
+	/* Stack calls init for LUN 0 only, init all LUNs */
+	for (i = 0; i < USBD_MSC_LUNS; i++) {
+		media = MSC_Media[i];
+		inquiry = &STORAGE_Inquirydata[i * STANDARD_INQUIRY_DATA_LEN];
+		
+		/* Inquiry data for other LUNs are copied from LUN 0 */
+		if (i) {
+			memcpy(inquiry, STORAGE_Inquirydata, STANDARD_INQUIRY_DATA_LEN);
+		}
+		
+		/* Set product name, padded with spaces */
+		if (media != NULL && media->Product != NULL) {
+			for (j = 0; j < STORAGE_PRODUCT_SIZE && media->Product[j]; j++) {
+				inquiry[STORAGE_PRODUCT_OFFSET + j] = media->Product[j];
+			}
+			for (; j < STORAGE_PRODUCT_SIZE; j++) {
+				inquiry[STORAGE_PRODUCT_OFFSET + j] = ' ';
+			}
+		}
+		
+		/* Init media */
+		if (media != NULL && media->Init(i) != 0 && i == lun) {
+			ret = -1;
+		}
+	}
+	
+	/* Return status */
+	return ret;
+}
+
+int8_t TM_USBD_MSC_GetCapacityCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint32_t* block_num, uint16_t* block_size) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Check media */
+	if (media == NULL) {
+		return -1;
+	}
+	
+	/* Get capacity from media */
+	return media->GetCapacity(lun, block_num, block_size);
+}
+
+int8_t TM_USBD_MSC_IsReadyCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Check media */
+	if (media == NULL) {
+		return -1;
+	}
+	
+	/* Check if media is ready */
+	return media->IsReady(lun);
+}
+
+int8_t TM_USBD_MSC_IsWriteProtectedCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* LUN without media is write protected */
+	if (media == NULL) {
+		return 1;
+	}
+	
+	/* Check if media is write protected */
+	return media->IsWriteProtected(lun);
+}
+
+int8_t TM_USBD_MSC_ReadCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Start read and wait for end */
+	if (media == NULL || media->ReadStart(lun, buf, blk_addr, blk_len) != 0) {
+		return -1;
+	}
+	return media->Wait(lun);
+}
+
+int8_t TM_USBD_MSC_WriteCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Start write and wait for end */
+	if (media == NULL || media->WriteStart(lun, buf, blk_addr, blk_len) != 0) {
+		return -1;
+	}
+	return media->Wait(lun);
+}
+
+int8_t TM_USBD_MSC_ReadStartCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Check media */
+	if (media == NULL) {
+		return -1;
+	}
+	
+	/* Start read in background */
+	return media->ReadStart(lun, buf, blk_addr, blk_len);
+}
+
+int8_t TM_USBD_MSC_WriteStartCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Check media */
+	if (media == NULL) {
+		return -1;
+	}
+	
+	/* Start write in background */
+	return media->WriteStart(lun, buf, blk_addr, blk_len);
+}
+
+int8_t TM_USBD_MSC_WaitCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
+	const TM_USBD_MSC_Media_t* media = MSC_GET_MEDIA(lun);
+	
+	/* Check media */
+	if (media == NULL) {
+		return -1;
+	}
+	
+	/* Wait for transfer started in background */
+	return media->Wait(lun);
+}
+
+int8_t TM_USBD_MSC_GetMaxLunCallback(USBD_HandleTypeDef* Handle) {
+	/* Number of LUNs */
+	return (USBD_MSC_LUNS - 1);
+}
+
+/************************************************/
+/*                 SDCARD MEDIA                 */
+/************************************************/
+#if USBD_MSC_USE_SDCARD
+static int8_t TM_USBD_MSC_INT_SDCARD_Init(uint8_t lun) {
 	/* Init SDCARD */
 	BSP_SD_Init();
 	
@@ -180,7 +410,7 @@ int8_t TM_USBD_MSC_InitCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
 	return 0;
 }
 
-int8_t TM_USBD_MSC_GetCapacityCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint32_t* block_num, uint16_t* block_size) {
+static int8_t TM_USBD_MSC_INT_SDCARD_GetCapacity(uint8_t lun, uint32_t* block_num, uint16_t* block_size) {
 	HAL_SD_CardInfoTypedef info;
 
 	/* Check if card is detected */
@@ -200,7 +430,7 @@ int8_t TM_USBD_MSC_GetCapacityCallback(USBD_HandleTypeDef* Handle, uint8_t lun,
 	return -1;
 }
 
-int8_t TM_USBD_MSC_IsReadyCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
+static int8_t TM_USBD_MSC_INT_SDCARD_IsReady(uint8_t lun) {
 	static int8_t prev_status = 0;
 	int8_t ret = -1;
 
@@ -228,17 +458,14 @@ int8_t TM_USBD_MSC_IsReadyCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
 	return ret;
 }
 
-int8_t TM_USBD_MSC_IsWriteProtectedCallback(USBD_HandleTypeDef* Handle, uint8_t lun) {
+static int8_t TM_USBD_MSC_INT_SDCARD_IsWriteProtected(uint8_t lun) {
 	/* Return if SDCARD is write protected */
 	return BSP_SD_IsWriteProtected();
 }
 
-int8_t TM_USBD_MSC_ReadCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
-	/* If SDCARD is detected */
-	if (BSP_SD_IsDetected()) { 
-		/* Start read with DMA */
-		BSP_SD_ReadBlocks_DMA((uint32_t *)buf, blk_addr * STORAGE_BLK_SIZ, STORAGE_BLK_SIZ, blk_len);
-		
+static int8_t TM_USBD_MSC_INT_SDCARD_ReadStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	/* If SDCARD is detected, start read with DMA in background */
+	if (BSP_SD_IsDetected() && BSP_SD_ReadBlocks_DMA_Start((uint32_t *)buf, (uint64_t)blk_addr * STORAGE_BLK_SIZ, STORAGE_BLK_SIZ, blk_len) == 0) {
 		/* Return OK */
 		return 0;
 	}
@@ -247,12 +474,9 @@ int8_t TM_USBD_MSC_ReadCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t
 	return -1;
 }
 
-int8_t TM_USBD_MSC_WriteCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
-	/* If SDCARD is detected */
-	if (BSP_SD_IsDetected()) { 
-		/* Start read with DMA */
-		BSP_SD_WriteBlocks_DMA((uint32_t *)buf, blk_addr * STORAGE_BLK_SIZ, STORAGE_BLK_SIZ, blk_len);
-		
+static int8_t TM_USBD_MSC_INT_SDCARD_WriteStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	/* If SDCARD is detected, start write with DMA in background */
+	if (BSP_SD_IsDetected() && BSP_SD_WriteBlocks_DMA_Start((uint32_t *)buf, (uint64_t)blk_addr * STORAGE_BLK_SIZ, STORAGE_BLK_SIZ, blk_len) == 0) {
 		/* Return OK */
 		return 0;
 	}
@@ -261,10 +485,271 @@ int8_t TM_USBD_MSC_WriteCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_
 	return -1;
 }
 
-int8_t TM_USBD_MSC_GetMaxLunCallback(USBD_HandleTypeDef* Handle) {
-	/* Number of LUNs */
-	return (STORAGE_LUN_NBR - 1);
+static int8_t TM_USBD_MSC_INT_SDCARD_Wait(uint8_t lun) {
+	/* Wait for DMA transfer started in background */
+	if (BSP_SD_WaitTransfer() == 0) {
+		/* Return OK */
+		return 0;
+	}
+	
+	/* Return error */
+	return -1;
 }
+#endif
+
+/************************************************/
+/*                 SDRAM MEDIA                  */
+/************************************************/
+#if USBD_MSC_USE_SDRAM
+static void TM_USBD_MSC_INT_SDRAM_Start(uint32_t dst, uint32_t src, uint32_t size) {
+	SDRAM_DMA_Error = 0;
+	
+	/* Unaligned buffers are copied by CPU */
+	if ((dst | src) & 0x03) {
+		memcpy((void *)dst, (const void *)src, size);
+		SDRAM_DMA_Done = 1;
+		return;
+	}
+	
+#if defined(STM32F7xx)
+	/* Source must be in memory, destination is invalidated in wait function */
+	SCB_CleanDCache_by_Addr((uint32_t *)src, size);
+	SCB_CleanInvalidateDCache_by_Addr((uint32_t *)dst, size);
+	SDRAM_Dst = dst;
+	SDRAM_Size = size;
+#endif
+	
+	/* Start copy, media packet is less than 0xFFFF words */
+	SDRAM_DMA_Done = 0;
+	TM_DMA_Start(&SDRAM_DMA_Handle, src, dst, size >> 2);
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_Init(uint8_t lun) {
+	/* Already initialized */
+	if (SDRAM_Initialized) {
+		return 0;
+	}
+	
+	/* Init SDRAM */
+	if (!TM_SDRAM_Init()) {
+		return -1;
+	}
+	
+	/* Enable clock, disable stream and clear flags */
+	TM_DMA_Init(USBD_MSC_SDRAM_DMA_STREAM, NULL);
+	USBD_MSC_SDRAM_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	TM_DMA_ClearFlags(USBD_MSC_SDRAM_DMA_STREAM);
+	
+	/* Memory to memory, 32-bit words, both addresses increment */
+	SDRAM_DMA_Handle.Instance = USBD_MSC_SDRAM_DMA_STREAM;
+	SDRAM_DMA_Handle.Init.Channel = USBD_MSC_SDRAM_DMA_CHANNEL;
+	SDRAM_DMA_Handle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+	SDRAM_DMA_Handle.Init.PeriphInc = DMA_PINC_ENABLE;
+	SDRAM_DMA_Handle.Init.MemInc = DMA_MINC_ENABLE;
+	SDRAM_DMA_Handle.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	SDRAM_DMA_Handle.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	SDRAM_DMA_Handle.Init.Mode = DMA_NORMAL;
+	SDRAM_DMA_Handle.Init.Priority = DMA_PRIORITY_HIGH;
+	SDRAM_DMA_Handle.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+	SDRAM_DMA_Handle.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	SDRAM_DMA_Handle.Init.MemBurst = DMA_MBURST_SINGLE;
+	SDRAM_DMA_Handle.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	
+	/* Init HAL */
+	TM_DMA_Init(USBD_MSC_SDRAM_DMA_STREAM, &SDRAM_DMA_Handle);
+	
+	/* Set library callback for stream and enable interrupts */
+	TM_DMA_SetStreamCallback(USBD_MSC_SDRAM_DMA_STREAM, TM_USBD_MSC_INT_SDRAM_DMACallback, NULL);
+	TM_DMA_EnableInterrupts(USBD_MSC_SDRAM_DMA_STREAM);
+	
+	/* Initialized */
+	SDRAM_Initialized = 1;
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_GetCapacity(uint8_t lun, uint32_t* block_num, uint16_t* block_size) {
+	/* Number of blocks in SDRAM area */
+	*block_num = USBD_MSC_SDRAM_SIZE / USBD_MSC_BLOCK_SIZE;
+	*block_size = USBD_MSC_BLOCK_SIZE;
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_IsReady(uint8_t lun) {
+	/* Ready when SDRAM is initialized */
+	return SDRAM_Initialized ? 0 : -1;
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_IsWriteProtected(uint8_t lun) {
+	/* Not protected */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_ReadStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	/* Copy from SDRAM to buffer */
+	TM_USBD_MSC_INT_SDRAM_Start((uint32_t)buf, SDRAM_START_ADR + USBD_MSC_SDRAM_START + blk_addr * USBD_MSC_BLOCK_SIZE, (uint32_t)blk_len * USBD_MSC_BLOCK_SIZE);
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_WriteStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	/* Copy from buffer to SDRAM */
+	TM_USBD_MSC_INT_SDRAM_Start(SDRAM_START_ADR + USBD_MSC_SDRAM_START + blk_addr * USBD_MSC_BLOCK_SIZE, (uint32_t)buf, (uint32_t)blk_len * USBD_MSC_BLOCK_SIZE);
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_SDRAM_Wait(uint8_t lun) {
+	/* Wait for transfer end */
+	while (!SDRAM_DMA_Done);
+	
+#if defined(STM32F7xx)
+	/* Remove stale lines read during copy */
+	if (SDRAM_Size) {
+		SCB_InvalidateDCache_by_Addr((uint32_t *)SDRAM_Dst, SDRAM_Size);
+		SDRAM_Size = 0;
+	}
+#endif
+	
+	/* Return status */
+	return SDRAM_DMA_Error ? -1 : 0;
+}
+
+static void TM_USBD_MSC_INT_SDRAM_DMACallback(DMA_Stream_TypeDef* DMA_Stream, uint32_t flags, void* Param) {
+	/* Check for errors, stream is disabled by hardware */
+	if (flags & (DMA_FLAG_TEIF | DMA_FLAG_DMEIF)) {
+		SDRAM_DMA_Error = 1;
+	} else if (!(flags & DMA_FLAG_TCIF)) {
+		return;
+	}
+	
+	/* Transfer done */
+	SDRAM_DMA_Done = 1;
+}
+#endif
+
+/************************************************/
+/*                  QSPI MEDIA                  */
+/************************************************/
+#if USBD_MSC_USE_QSPI
+static int8_t TM_USBD_MSC_INT_QSPI_Init(uint8_t lun) {
+	/* Init QSPI flash once */
+	if (!QSPI_Initialized) {
+		if (BSP_QSPI_Init() != QSPI_OK) {
+			return -1;
+		}
+		QSPI_Initialized = 1;
+	}
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_QSPI_GetCapacity(uint8_t lun, uint32_t* block_num, uint16_t* block_size) {
+	/* Number of blocks in QSPI area */
+	*block_num = USBD_MSC_QSPI_SIZE / USBD_MSC_BLOCK_SIZE;
+	*block_size = USBD_MSC_BLOCK_SIZE;
+	
+	/* Return OK */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_QSPI_IsReady(uint8_t lun) {
+	/* Ready when QSPI flash is initialized */
+	return QSPI_Initialized ? 0 : -1;
+}
+
+static int8_t TM_USBD_MSC_INT_QSPI_IsWriteProtected(uint8_t lun) {
+	/* Not protected */
+	return 0;
+}
+
+static int8_t TM_USBD_MSC_INT_QSPI_ReadStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	uint32_t addr = USBD_MSC_QSPI_START + blk_addr * USBD_MSC_BLOCK_SIZE;
+	uint32_t size = (uint32_t)blk_len * USBD_MSC_BLOCK_SIZE;
+	
+#if QSPI_USE_DMA
+	/* Start read with DMA in background */
+	QSPI_Status = BSP_QSPI_Read_DMA(buf, addr, size) == QSPI_OK ? 0 : -1;
+#else
+	/* Read data in blocking mode */
+	QSPI_Status = BSP_QSPI_Read(buf, addr, size) == QSPI_OK ? 0 : -1;
+#endif
+	
+	/* Return status */
+	return QSPI_Status;
+}
+
+static int8_t TM_USBD_MSC_INT_QSPI_WriteStart(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len) {
+	uint32_t addr = USBD_MSC_QSPI_START + blk_addr * USBD_MSC_BLOCK_SIZE;
+	uint32_t size = (uint32_t)blk_len * USBD_MSC_BLOCK_SIZE;
+	uint32_t sub, offset, count, i;
+	
+	QSPI_Status = 0;
+	while (size && QSPI_Status == 0) {
+		/* Part of data inside one subsector */
+		sub = addr & ~(N25Q128A_SUBSECTOR_SIZE - 1);
+		offset = addr - sub;
+		count = N25Q128A_SUBSECTOR_SIZE - offset;
+		if (count > size) {
+			count = size;
+		}
+		
+		/* Read current subsector content */
+		if (BSP_QSPI_Read(QSPI_Subsector, sub, N25Q128A_SUBSECTOR_SIZE) != QSPI_OK) {
+			QSPI_Status = -1;
+			break;
+		}
+		
+		/* Write only when data are different */
+		if (memcmp(&QSPI_Subsector[offset], buf, count)) {
+			/* Check if target area is erased */
+			for (i = offset; i < offset + count; i++) {
+				if (QSPI_Subsector[i] != 0xFF) {
+					break;
+				}
+			}
+			
+			if (i == offset + count) {
+				/* Area is erased, program new data only */
+				if (BSP_QSPI_Write(buf, addr, count) != QSPI_OK) {
+					QSPI_Status = -1;
+				}
+			} else {
+				/* Merge new data with subsector, erase it and program it back */
+				memcpy(&QSPI_Subsector[offset], buf, count);
+				if (
+					BSP_QSPI_Erase_Block(sub) != QSPI_OK ||
+					BSP_QSPI_Write(QSPI_Subsector, sub, N25Q128A_SUBSECTOR_SIZE) != QSPI_OK
+				) {
+					QSPI_Status = -1;
+				}
+			}
+		}
+		
+		/* Go to next subsector */
+		addr += count;
+		buf += count;
+		size -= count;
+	}
+	
+	/* Write is done in blocking mode, return status */
+	return QSPI_Status;
+}
+
+static int8_t TM_USBD_MSC_INT_QSPI_Wait(uint8_t lun) {
+	/* Wait for background read */
+	while (BSP_QSPI_IsBusy() == QSPI_BUSY);
+	
+	/* Return status */
+	return QSPI_Status;
+}
+#endif
 
 /************************************************/
 /*             LIBRARY DESCRIPTORS              */
@@ -325,12 +810,10 @@ uint8_t *USBD_MSC_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *l
   * @retval Pointer to descriptor buffer
   */
 uint8_t *USBD_MSC_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length) {
-	*length = USB_SIZ_STRING_SERIAL;
+	*length = ID_USB_SERIAL_SIZE;
 
-	/* Update the serial number string descriptor with the data from the unique ID*/
-	Get_SerialNum();
-
-	return (uint8_t*)USBD_StringSerial;
+	/* Serial number string descriptor is cached in identity block */
+	return (uint8_t*)TM_ID_Get()->USBSerial;
 }
 
 /**
@@ -362,46 +845,4 @@ uint8_t *USBD_MSC_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *leng
 	}
 	return USBD_StrDesc;  
 }
-/**
-  * @brief  Create the serial number string descriptor 
-  * @param  None 
-  * @retval None
-  */
-static void Get_SerialNum(void) {
-	uint32_t deviceserial0, deviceserial1, deviceserial2;
-
-	deviceserial0 = *(uint32_t*)DEVICE_ID1;
-	deviceserial1 = *(uint32_t*)DEVICE_ID2;
-	deviceserial2 = *(uint32_t*)DEVICE_ID3;
-
-	deviceserial0 += deviceserial2;
-
-	if (deviceserial0 != 0) {
-		IntToUnicode (deviceserial0, (uint8_t*)&USBD_StringSerial[2] ,8);
-		IntToUnicode (deviceserial1, (uint8_t*)&USBD_StringSerial[18] ,4);
-	}
-}
-
-/**
-  * @brief  Convert Hex 32Bits value into char 
-  * @param  value: value to convert
-  * @param  pbuf: pointer to the buffer 
-  * @param  len: buffer length
-  * @retval None
-  */
-static void IntToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len) {
-	uint8_t idx = 0;
-
-	for (idx = 0; idx < len; idx ++) {
-		if (((value >> 28)) < 0xA) {
-			pbuf[ 2* idx] = (value >> 28) + '0';
-		} else {
-			pbuf[2* idx] = (value >> 28) + 'A' - 10; 
-		}
-
-		value = value << 4;
-
-		pbuf[ 2* idx + 1] = 0;
-	}
-}
 
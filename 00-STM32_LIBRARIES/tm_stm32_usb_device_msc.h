@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.2
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB MSC Device library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USBD_MSC_H
-#define TM_USBD_MSC_H 100
+#define TM_USBD_MSC_H 120
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -61,7 +61,61 @@ extern "C" {
 \verbatim
 - Works on USB FS or HS mode
 - Driver for SDCARDs is SDIO
+- Pipelined transfers, SDCARD DMA runs while previous packet is on USB
+- Multiple LUNs with SDCARD, SDRAM or QSPI flash media, or custom media
 \endverbatim
+ *
+ * \par Pipelined transfers
+ *
+ * By default, MSC media buffer is split to 2 halves. During READ10 command, next block range is read from SDCARD
+ * with DMA to one half while the other half is sent over USB. During WRITE10 command, next packet is received
+ * from USB while previous one is written to SDCARD.
+ *
+ * Media buffer size can be changed in defines.h file, larger buffer means less transfers on SDCARD:
+ *
+\code
+//MSC media buffer size in bytes, must be multiple of 1024 in pipelined mode, up to 32768
+#define MSC_MEDIA_PACKET     16384
+
+//Disable pipelined transfers, one buffer is used synchronously
+#define USBD_MSC_PIPELINE    0
+\endcode
+ *
+ * @note  USB interrupt waits for SDCARD transfer end, so SDIO and DMA interrupts must have higher priority than USB interrupt.
+ *
+ * \par Media and LUNs
+ *
+ * Each LUN (logical unit, shown as separate drive on computer) has own media driver, set with @ref TM_USBD_MSC_SetMedia before
+ * @ref TM_USBD_MSC_Init is called. Media drivers start transfers in background and report end of transfer on wait call,
+ * which is used by pipelined transfers. Built-in media drivers are enabled in defines.h file:
+ *
+ *  - @ref TM_USBD_MSC_Media_SDCARD: SDCARD with SDIO and DMA (USBD_MSC_USE_SDCARD, enabled by default, used on LUN 0 by default)
+ *  - @ref TM_USBD_MSC_Media_SDRAM: RAM disk in external SDRAM, copied with memory to memory DMA (USBD_MSC_USE_SDRAM)
+ *  - @ref TM_USBD_MSC_Media_QSPI: QSPI flash, read with DMA when QSPI_USE_DMA is enabled in @ref TM_QSPIFLASH (USBD_MSC_USE_QSPI)
+ *
+\code
+//Enable SDRAM and QSPI media, 2 LUNs
+#define USBD_MSC_USE_SDRAM   1
+#define USBD_MSC_USE_QSPI    1
+#define USBD_MSC_LUNS        2
+
+//SDRAM disk uses upper 4MB of SDRAM, rest is used by application
+#define USBD_MSC_SDRAM_START 0x400000
+#define USBD_MSC_SDRAM_SIZE  0x400000
+
+//Main program
+TM_USBD_MSC_SetMedia(0, &TM_USBD_MSC_Media_SDRAM);
+TM_USBD_MSC_SetMedia(1, &TM_USBD_MSC_Media_QSPI);
+TM_USBD_MSC_Init(TM_USB_HS);
+\endcode
+ *
+ * Custom media is structure of @ref TM_USBD_MSC_Media_t type. Read and write start functions may block
+ * until transfer is done when media can not work in background, wait function then only returns status.
+ *
+ * @note  SDRAM RAM disk is empty after reset and must be formatted on computer first.
+ * @note  QSPI flash is erased in 4kB subsectors, written blocks are merged with rest of subsector which is read first.
+ *        Erase is skipped when block area is already erased. Writes are much slower than reads and wear flash memory.
+ * @note  DMA and QSPI interrupts must have higher priority than USB interrupt, media wait function is called from USB interrupt.
  *
  * @note  For using this library, you will also need my SDCARD SDIO driver from @ref TM_FATFS library. Source files can be found in fatfs/drivers/fatfs_sd_sdio.h/c
  *
@@ -72,6 +126,21 @@ extern "C" {
 \verbatim
  Version 1.0
   - First release
+
+ Version 1.1
+  - October 14, 2026
+  - READ10 and WRITE10 are pipelined between USB and SDCARD DMA transfers
+  - MSC_MEDIA_PACKET can be set in defines.h
+  - Fixed WRITE10 calling read callback
+  - Fixed read and write errors not reported to host
+  - Fixed block address overflow on SDCARDs larger than 4GB
+  - MSC uses endpoint 3 by default, so it can be used together with CDC in composite device, check @ref TM_USBD_CDC_MSC
+
+ Version 1.2
+  - October 14, 2026
+  - Added media drivers per LUN with @ref TM_USBD_MSC_SetMedia, multiple LUNs with USBD_MSC_LUNS
+  - Added SDRAM media with memory to memory DMA and QSPI flash media with DMA reads
+  - Fixed address range check on multiple LUNs with different capacities
 \endverbatim
  *
  * \par Dependencies
@@ -85,7 +154,9 @@ extern "C" {
  - TM USB DEVICE
  - USB Device Stack
  - USB Device MSC
- - TM FATFS with SDCARD SDIO driver
+ - TM FATFS with SDCARD SDIO driver (only when USBD_MSC_USE_SDCARD)
+ - TM SDRAM and TM DMA (only when USBD_MSC_USE_SDRAM)
+ - TM QSPI FLASH (only when USBD_MSC_USE_QSPI)
 \endverbatim
  */
 
@@ -98,6 +169,13 @@ extern "C" {
 #include "usbd_msc.h"
 #include "usbd_msc_storage.h"
 #include "string.h"
+#if USBD_MSC_USE_SDRAM
+#include "tm_stm32_sdram.h"
+#include "tm_stm32_dma.h"
+#endif
+#if USBD_MSC_USE_QSPI
+#include "tm_stm32_qspiflash.h"
+#endif
 
 /**
  * @defgroup TM_USBD_MSC_Macros
@@ -105,6 +183,115 @@ extern "C" {
  * @{
  */
 
+/* Pipelined transfers between USB and SDCARD */
+#ifndef USBD_MSC_PIPELINE
+#define USBD_MSC_PIPELINE    1
+#endif
+
+/* Number of LUNs, each LUN is separate drive */
+#ifndef USBD_MSC_LUNS
+#define USBD_MSC_LUNS        1
+#endif
+
+/* Built-in media drivers */
+#ifndef USBD_MSC_USE_SDCARD
+#define USBD_MSC_USE_SDCARD  1
+#endif
+#ifndef USBD_MSC_USE_SDRAM
+#define USBD_MSC_USE_SDRAM   0
+#endif
+#ifndef USBD_MSC_USE_QSPI
+#define USBD_MSC_USE_QSPI    0
+#endif
+
+/* Block size reported to host for SDRAM and QSPI media */
+#ifndef USBD_MSC_BLOCK_SIZE
+#define USBD_MSC_BLOCK_SIZE  512
+#endif
+
+/* SDRAM media area, offset from SDRAM start and size in bytes */
+#ifndef USBD_MSC_SDRAM_START
+#define USBD_MSC_SDRAM_START 0
+#endif
+#ifndef USBD_MSC_SDRAM_SIZE
+#define USBD_MSC_SDRAM_SIZE  (SDRAM_MEMORY_SIZE - USBD_MSC_SDRAM_START)
+#endif
+
+/* DMA stream for SDRAM media, memory to memory transfers are possible on DMA2 only */
+#ifndef USBD_MSC_SDRAM_DMA_STREAM
+#define USBD_MSC_SDRAM_DMA_STREAM  DMA2_Stream1
+#define USBD_MSC_SDRAM_DMA_CHANNEL DMA_CHANNEL_0
+#endif
+
+/* QSPI media area, offset in flash and size in bytes, multiple of 4kB subsectors */
+#ifndef USBD_MSC_QSPI_START
+#define USBD_MSC_QSPI_START  0
+#endif
+#ifndef USBD_MSC_QSPI_SIZE
+#define USBD_MSC_QSPI_SIZE   (N25Q128A_FLASH_SIZE - USBD_MSC_QSPI_START)
+#endif
+
+/* Check LUN settings */
+#if USBD_MSC_LUNS < 1 || USBD_MSC_LUNS > 16
+#error "USBD_MSC_LUNS must be between 1 and 16!"
+#endif
+
+/* Check media buffer size */
+#if USBD_MSC_PIPELINE && (MSC_MEDIA_PACKET % 1024)
+#error "MSC_MEDIA_PACKET must be multiple of 1024 for pipelined transfers!"
+#endif
+#if MSC_MEDIA_PACKET > 32768
+#error "MSC_MEDIA_PACKET can be up to 32768 bytes!"
+#endif
+#if USBD_MSC_USE_QSPI && (USBD_MSC_BLOCK_SIZE > 4096 || (4096 % USBD_MSC_BLOCK_SIZE))
+#error "USBD_MSC_BLOCK_SIZE must divide 4096 bytes for QSPI media!"
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_USBD_MSC_Typedefs
+ * @brief    Library Typedefs
+ * @{
+ */
+
+/**
+ * @brief  Media driver for LUN
+ * @note   All functions return 0 on success or -1 on error
+ */
+typedef struct {
+	int8_t (*Init)(uint8_t lun);                                                           /*!< Initializes media */
+	int8_t (*GetCapacity)(uint8_t lun, uint32_t* block_num, uint16_t* block_size);         /*!< Gets number of blocks and block size */
+	int8_t (*IsReady)(uint8_t lun);                                                        /*!< Checks if media is ready */
+	int8_t (*IsWriteProtected)(uint8_t lun);                                               /*!< Returns 1 if media is write protected */
+	int8_t (*ReadStart)(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);  /*!< Starts reading blocks */
+	int8_t (*WriteStart)(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len); /*!< Starts writing blocks */
+	int8_t (*Wait)(uint8_t lun);                                                           /*!< Waits for started transfer and returns its status */
+	const char* Product;                                                                   /*!< Product name in inquiry data, up to 16 characters */
+} TM_USBD_MSC_Media_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup TM_USBD_MSC_Variables
+ * @brief    Built-in media drivers
+ * @{
+ */
+
+#if USBD_MSC_USE_SDCARD || defined(DOXYGEN)
+extern const TM_USBD_MSC_Media_t TM_USBD_MSC_Media_SDCARD; /*!< SDCARD with SDIO, USBD_MSC_USE_SDCARD must be enabled */
+#endif
+#if USBD_MSC_USE_SDRAM || defined(DOXYGEN)
+extern const TM_USBD_MSC_Media_t TM_USBD_MSC_Media_SDRAM;  /*!< RAM disk in SDRAM, USBD_MSC_USE_SDRAM must be enabled */
+#endif
+#if USBD_MSC_USE_QSPI || defined(DOXYGEN)
+extern const TM_USBD_MSC_Media_t TM_USBD_MSC_Media_QSPI;   /*!< QSPI flash, USBD_MSC_USE_QSPI must be enabled */
+#endif
+
 /**
  * @}
  */
@@ -123,9 +310,18 @@ extern "C" {
  */
 TM_USBD_Result_t TM_USBD_MSC_Init(TM_USB_t USB_Mode);
 
+/**
+ * @brief  Sets media driver for LUN
+ * @note   Must be called before @ref TM_USBD_MSC_Init or @ref TM_USBD_CDC_MSC_Init
+ * @param  lun: LUN number, 0 to USBD_MSC_LUNS - 1
+ * @param  *Media: Pointer to @ref TM_USBD_MSC_Media_t media driver, or NULL for no media
+ * @retval Member of @ref TM_USBD_Result_t enumeration
+ */
+TM_USBD_Result_t TM_USBD_MSC_SetMedia(uint8_t lun, const TM_USBD_MSC_Media_t* Media);
+
 /**
  * @defgroup TM_USBD_MSC_Callbacks
- * @brief    Library callback functions, reserved for future use
+ * @brief    Library callback functions called by USB MSC stack, they forward calls to media driver of LUN
  * @{
  */
  
@@ -136,6 +332,9 @@ int8_t TM_USBD_MSC_IsWriteProtectedCallback(USBD_HandleTypeDef* Handle, uint8_t
 int8_t TM_USBD_MSC_ReadCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
 int8_t TM_USBD_MSC_WriteCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
 int8_t TM_USBD_MSC_GetMaxLunCallback(USBD_HandleTypeDef* Handle);
+int8_t TM_USBD_MSC_ReadStartCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+int8_t TM_USBD_MSC_WriteStartCallback(USBD_HandleTypeDef* Handle, uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len);
+int8_t TM_USBD_MSC_WaitCallback(USBD_HandleTypeDef* Handle, uint8_t lun);
 
 /**
  * @}
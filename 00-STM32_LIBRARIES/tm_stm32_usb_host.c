@@ -139,6 +139,11 @@ TM_USBH_Result_t TM_USBH_Stop(TM_USB_t USB_Mode) {
 }
 
 TM_USBH_Result_t TM_USBH_Process(TM_USB_t USB_Mode) {
+#if (USBH_USE_OS == 1)
+	/* USB host thread processes state machine on events */
+	return TM_USBH_Result_Ok;
+#endif
+	
 #ifdef USB_USE_FS
 	/* Process FS mode */
 	if (USB_Mode == TM_USB_FS || USB_Mode == TM_USB_Both) {
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB Host library for STM32Fxxx devices
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USBH_H
-#define TM_USBH_H 100
+#define TM_USBH_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -68,12 +68,41 @@ extern "C" {
 - Checks if device is connected on FS or HS mode
 - Reads VID and PID of connected device on FS or HS mode
 \endverbatim
+ *
+ * \par Event driven processing with RTOS
+ *
+ * Without RTOS, @ref TM_USBH_Process must be called all the time for each USB port, even when nothing happens on bus.
+ *
+ * With FreeRTOS and CMSIS-RTOS wrapper, USB host stack can create own thread for each USB port.
+ * Connect, disconnect and transfer complete interrupts and SOF timer of class put event to thread message queue
+ * and thread runs state machine only after event. When devices are idle, thread is blocked and uses no CPU time.
+ *
+\code
+//Enable in defines.h file
+#define USBH_USE_OS                1
+
+//Optional thread settings
+#define USBH_PROCESS_PRIO          osPriorityAboveNormal
+#define USBH_PROCESS_STACK_SIZE    (8 * configMINIMAL_STACK_SIZE)
+
+//USB interrupt calls FreeRTOS API, priority must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#define USB_NVIC_PRIORITY          6
+\endcode
+ *
+ * Threads are created in @ref TM_USBH_Init, before or after scheduler is started.
+ * @ref TM_USBH_Process does nothing in this mode and can stay in code.
+ *
+ * @note  USB host callbacks of TM USB libraries are called from USB host thread in this mode
  *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added event driven processing in USB host thread with USBH_USE_OS
 \endverbatim
  *
  * \par Dependencies
@@ -164,6 +193,7 @@ TM_USBH_Result_t TM_USBH_Stop(TM_USB_t USB_Mode);
 /**
  * @brief  Processes USB Host for specific mode
  * @note   This function HAVE TO be called periodically or USB HOST won't work!
+ * @note   When USBH_USE_OS is 1, USB host is processed in own thread and function does nothing
  * @param  USB_Mode: USB Mode to be processed. This parameter can be a value of @ref TM_USB_t enumeration
  * @retval Member of @ref TM_USBH_Result_t enumeration
  */
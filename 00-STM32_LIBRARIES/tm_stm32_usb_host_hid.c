@@ -25,6 +25,31 @@
  */
 #include "tm_stm32_usb_host_hid.h"
 
+#if USBH_HID_QUEUE_SIZE > 0
+/* Reports decoded in HID class event callback, for each port */
+typedef struct {
+	HID_KEYBD_Info_TypeDef Keyboard; /* Last keyboard report */
+	uint8_t KeyboardNew;             /* Set to 1 when keyboard report was not read yet */
+	HID_MOUSE_Info_TypeDef Mouse;    /* Last mouse report */
+	uint8_t MouseNew;                /* Set to 1 when mouse report was not read yet */
+	int32_t DX;                      /* Accumulated mouse movement */
+	int32_t DY;                      /* Accumulated mouse movement */
+} TM_USBH_HID_INT_Port_t;
+
+static TM_USBH_HID_INT_Port_t HID_Ports[2];
+
+/* Event queue */
+static TM_USBH_HID_Event_t HID_Events[USBH_HID_QUEUE_SIZE];
+static volatile uint16_t HID_EventsIn, HID_EventsOut;
+static volatile uint32_t HID_EventsLostCount;
+
+/* Private functions */
+static void TM_USBH_HID_INT_Keyboard(TM_USB_t USB_Mode, TM_USBH_HID_INT_Port_t* Port, HID_KEYBD_Info_TypeDef* k_pinfo);
+static void TM_USBH_HID_INT_Mouse(TM_USB_t USB_Mode, TM_USBH_HID_INT_Port_t* Port, HID_MOUSE_Info_TypeDef* k_minfo);
+static uint8_t TM_USBH_HID_INT_HasKey(HID_KEYBD_Info_TypeDef* k_pinfo, uint8_t key);
+static void TM_USBH_HID_INT_AddEvent(TM_USB_t USB_Mode, TM_USBH_HID_EventType_t type, uint8_t key, uint8_t c, uint8_t modifiers, uint8_t pressed);
+#endif
+
 TM_USBH_Result_t TM_USBH_HID_Init(TM_USB_t USB_Mode) {
 #ifdef USB_USE_FS
 	/* Init HID class for FS */
@@ -78,7 +103,16 @@ TM_USBH_HID_t TM_USBH_HID_GetKeyboard(TM_USB_t USB_Mode, TM_USBH_HID_Keyboard_t*
 	uint8_t i;
 	
 	/* Get keyboard informations */
+#if USBH_HID_QUEUE_SIZE > 0
+	/* Report was already decoded in HID class callback */
+	k_pinfo = NULL;
+	if (HID_Ports[USB_Mode == TM_USB_HS].KeyboardNew) {
+		HID_Ports[USB_Mode == TM_USB_HS].KeyboardNew = 0;
+		k_pinfo = &HID_Ports[USB_Mode == TM_USB_HS].Keyboard;
+	}
+#else
 	k_pinfo = USBH_HID_GetKeybdInfo(TM_USBH_GetUSBPointer(USB_Mode));
+#endif
 
 	/* Check for ASCII value */
 	if (k_pinfo != NULL) {
@@ -117,21 +151,41 @@ TM_USBH_HID_t TM_USBH_HID_GetKeyboard(TM_USB_t USB_Mode, TM_USBH_HID_Keyboard_t*
 
 TM_USBH_HID_t TM_USBH_HID_GetMouse(TM_USB_t USB_Mode, TM_USBH_HID_Mouse_t* MouseStruct) {
 	HID_MOUSE_Info_TypeDef* k_minfo;
-	uint8_t i;
+#if USBH_HID_QUEUE_SIZE > 0
+	int32_t dx, dy;
+#endif
 	
 	/* Reset relative values */
-	MouseStruct->RelativeX = (int8_t)k_minfo->x;
-	MouseStruct->RelativeY = (int8_t)k_minfo->y;
+	MouseStruct->RelativeX = 0;
+	MouseStruct->RelativeY = 0;
 
-	/* Get keyboard informations */
+	/* Get mouse informations */
+#if USBH_HID_QUEUE_SIZE > 0
+	/* Report was already decoded in HID class callback */
+	k_minfo = NULL;
+	if (HID_Ports[USB_Mode == TM_USB_HS].MouseNew) {
+		HID_Ports[USB_Mode == TM_USB_HS].MouseNew = 0;
+		k_minfo = &HID_Ports[USB_Mode == TM_USB_HS].Mouse;
+	}
+#else
 	k_minfo = USBH_HID_GetMouseInfo(TM_USBH_GetUSBPointer(USB_Mode));
+#endif
 
-	/* Check for ASCII value */
+	/* Check for new report */
 	if (k_minfo != NULL) {
+#if USBH_HID_QUEUE_SIZE > 0
+		/* Use movement from all reports since last read */
+		TM_USBH_HID_GetMouseDelta(USB_Mode, &dx, &dy);
+		MouseStruct->AbsoluteX += dx;
+		MouseStruct->AbsoluteY += dy;
+		MouseStruct->RelativeX = dx > 127 ? 127 : (dx < -128 ? -128 : dx);
+		MouseStruct->RelativeY = dy > 127 ? 127 : (dy < -128 ? -128 : dy);
+#else
 		MouseStruct->AbsoluteX += (int8_t)k_minfo->x;
 		MouseStruct->AbsoluteY += (int8_t)k_minfo->y;
 		MouseStruct->RelativeX = (int8_t)k_minfo->x;
 		MouseStruct->RelativeY = (int8_t)k_minfo->y;
+#endif
 		
 		/* Copy buttons */
 		MouseStruct->Buttons[0] = k_minfo->buttons[0];
@@ -145,3 +199,182 @@ TM_USBH_HID_t TM_USBH_HID_GetMouse(TM_USB_t USB_Mode, TM_USBH_HID_Mouse_t* Mouse
 	/* Return ERROR */
 	return TM_USBH_HID_None;
 }
+
+#if USBH_HID_QUEUE_SIZE > 0
+uint16_t TM_USBH_HID_GetEvents(TM_USBH_HID_Event_t* Events, uint16_t count) {
+	uint16_t out = HID_EventsOut, read = 0;
+	
+	/* Copy events until queue is empty */
+	while (read < count && out != HID_EventsIn) {
+		Events[read++] = HID_Events[out];
+		out = (out + 1) & (USBH_HID_QUEUE_SIZE - 1);
+	}
+	
+	/* Free read events */
+	HID_EventsOut = out;
+	
+	/* Return number of read events */
+	return read;
+}
+
+uint32_t TM_USBH_HID_EventsLost(void) {
+	/* Return lost events */
+	return HID_EventsLostCount;
+}
+
+TM_USBH_HID_t TM_USBH_HID_GetMouseDelta(TM_USB_t USB_Mode, int32_t* dx, int32_t* dy) {
+	TM_USBH_HID_INT_Port_t* Port = &HID_Ports[USB_Mode == TM_USB_HS];
+	uint32_t irq;
+	
+	/* Disable interrupts, USB host can run in other thread */
+	irq = __get_PRIMASK();
+	__disable_irq();
+	
+	/* Read and reset movement */
+	*dx = Port->DX;
+	*dy = Port->DY;
+	Port->DX = 0;
+	Port->DY = 0;
+	
+	/* Enable interrupts back */
+	if (!irq) {
+		__enable_irq();
+	}
+	
+	/* Check for movement */
+	if (*dx || *dy) {
+		return TM_USBH_HID_Mouse;
+	}
+	
+	/* No movement */
+	return TM_USBH_HID_None;
+}
+
+__weak void TM_USBH_HID_EventCallback(TM_USBH_HID_Event_t* Event) {
+	/* NOTE: This function Should not be modified, when the callback is needed,
+            the TM_USBH_HID_EventCallback could be implemented in the user file
+	*/
+}
+
+/* Called from HID class for each received report */
+void USBH_HID_EventCallback(USBH_HandleTypeDef *phost) {
+	TM_USB_t USB_Mode = TM_USB_FS;
+	HID_TypeTypeDef type;
+	HID_KEYBD_Info_TypeDef* k_pinfo;
+	HID_MOUSE_Info_TypeDef* k_minfo;
+	
+	/* Get port of report */
+#ifdef USB_USE_HS
+	if (phost == &hUSBHost_HS) {
+		USB_Mode = TM_USB_HS;
+	}
+#endif
+	
+	/* Decode report for device type */
+	type = USBH_HID_GetDeviceType(phost);
+	if (type == HID_KEYBOARD) {
+		k_pinfo = USBH_HID_GetKeybdInfo(phost);
+		if (k_pinfo != NULL) {
+			TM_USBH_HID_INT_Keyboard(USB_Mode, &HID_Ports[USB_Mode], k_pinfo);
+		}
+	} else if (type == HID_MOUSE) {
+		k_minfo = USBH_HID_GetMouseInfo(phost);
+		if (k_minfo != NULL) {
+			TM_USBH_HID_INT_Mouse(USB_Mode, &HID_Ports[USB_Mode], k_minfo);
+		}
+	}
+}
+
+/* Private functions */
+static void TM_USBH_HID_INT_Keyboard(TM_USB_t USB_Mode, TM_USBH_HID_INT_Port_t* Port, HID_KEYBD_Info_TypeDef* k_pinfo) {
+	HID_KEYBD_Info_TypeDef info;
+	uint8_t i, key, modifiers;
+	
+	/* Modifiers in report order */
+	modifiers = 
+		(k_pinfo->lctrl ? TM_USBH_HID_MOD_LCTRL : 0) | (k_pinfo->lshift ? TM_USBH_HID_MOD_LSHIFT : 0) |
+		(k_pinfo->lalt ? TM_USBH_HID_MOD_LALT : 0) | (k_pinfo->lgui ? TM_USBH_HID_MOD_LGUI : 0) |
+		(k_pinfo->rctrl ? TM_USBH_HID_MOD_RCTRL : 0) | (k_pinfo->rshift ? TM_USBH_HID_MOD_RSHIFT : 0) |
+		(k_pinfo->ralt ? TM_USBH_HID_MOD_RALT : 0) | (k_pinfo->rgui ? TM_USBH_HID_MOD_RGUI : 0);
+	
+	/* Keys from previous report which are not in new report are released */
+	for (i = 0; i < 6; i++) {
+		key = Port->Keyboard.keys[i];
+		if (key >= KEY_A && !TM_USBH_HID_INT_HasKey(k_pinfo, key)) {
+			TM_USBH_HID_INT_AddEvent(USB_Mode, TM_USBH_HID_EventType_KeyRelease, key, 0, modifiers, 0);
+		}
+	}
+	
+	/* New keys are pressed, codes below KEY_A are errors */
+	info = *k_pinfo;
+	for (i = 0; i < 6; i++) {
+		key = k_pinfo->keys[i];
+		if (key >= KEY_A && !TM_USBH_HID_INT_HasKey(&Port->Keyboard, key)) {
+			/* Get ASCII value with current shift state, ASCII table ends with last modifier key */
+			info.keys[0] = key;
+			TM_USBH_HID_INT_AddEvent(USB_Mode, TM_USBH_HID_EventType_KeyPress, key, key <= KEY_RIGHT_GUI ? USBH_HID_GetASCIICode(&info) : 0, modifiers, 1);
+		}
+	}
+	
+	/* Save report */
+	Port->Keyboard = *k_pinfo;
+	Port->KeyboardNew = 1;
+}
+
+static void TM_USBH_HID_INT_Mouse(TM_USB_t USB_Mode, TM_USBH_HID_INT_Port_t* Port, HID_MOUSE_Info_TypeDef* k_minfo) {
+	uint8_t i;
+	
+	/* Accumulate movement */
+	Port->DX += (int8_t)k_minfo->x;
+	Port->DY += (int8_t)k_minfo->y;
+	
+	/* Check buttons */
+	for (i = 0; i < 3; i++) {
+		if ((k_minfo->buttons[i] ? 1 : 0) != (Port->Mouse.buttons[i] ? 1 : 0)) {
+			TM_USBH_HID_INT_AddEvent(USB_Mode, TM_USBH_HID_EventType_MouseButton, i, 0, 0, k_minfo->buttons[i] ? 1 : 0);
+		}
+	}
+	
+	/* Save report */
+	Port->Mouse = *k_minfo;
+	Port->MouseNew = 1;
+}
+
+static uint8_t TM_USBH_HID_INT_HasKey(HID_KEYBD_Info_TypeDef* k_pinfo, uint8_t key) {
+	uint8_t i;
+	
+	/* Check all keys in report */
+	for (i = 0; i < 6; i++) {
+		if (k_pinfo->keys[i] == key) {
+			return 1;
+		}
+	}
+	
+	/* Key is not pressed */
+	return 0;
+}
+
+static void TM_USBH_HID_INT_AddEvent(TM_USB_t USB_Mode, TM_USBH_HID_EventType_t type, uint8_t key, uint8_t c, uint8_t modifiers, uint8_t pressed) {
+	uint16_t in = HID_EventsIn, next;
+	
+	/* Check for free space */
+	next = (in + 1) & (USBH_HID_QUEUE_SIZE - 1);
+	if (next == HID_EventsOut) {
+		HID_EventsLostCount++;
+		return;
+	}
+	
+	/* Save event */
+	HID_Events[in].Time = HAL_GetTick();
+	HID_Events[in].USB_Mode = USB_Mode;
+	HID_Events[in].Type = type;
+	HID_Events[in].Key = key;
+	HID_Events[in].Char = c;
+	HID_Events[in].Modifiers = modifiers;
+	HID_Events[in].Pressed = pressed;
+	HID_EventsIn = next;
+	
+	/* Call user function */
+	TM_USBH_HID_EventCallback(&HID_Events[in]);
+}
+#endif
@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB HOST for HID devices library
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USBH_HID_H
-#define TM_USBH_HID_H 100
+#define TM_USBH_HID_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -57,12 +57,48 @@ extern "C" {
  * @note  Check @ref TM_USB library for configuration settings first!
  *
  * It is built on ST's USB HOST stack and requires all libraries from ST.
+ *
+ * \par Report queue
+ *
+ * Each report is decoded when it is received by USB HOST stack, not when application asks for data.
+ * Keyboard reports are compared with previous report and key press and release events, with modifiers,
+ * ASCII value and time, are saved to event queue. Mouse movement is accumulated and button changes are saved to event queue.
+ * Keys typed between 2 reads are not lost anymore and application can read them at any speed.
+ *
+ * @note  Reports are still received in @ref TM_USBH_Process, which must be called often enough.
+ *        Library implements USBH_HID_EventCallback function from USB HOST HID class when queue is used
+ *
+\code
+//Set queue size in defines.h, 0 disables queue
+#define USBH_HID_QUEUE_SIZE    16
+
+//In main loop
+TM_USBH_HID_Event_t Event;
+int32_t dx, dy;
+
+TM_USBH_Process(TM_USB_FS);
+
+//Read typed keys
+while (TM_USBH_HID_GetEvents(&Event, 1)) {
+	if (Event.Type == TM_USBH_HID_EventType_KeyPress && Event.Char) {
+		//Event.Char was typed
+	}
+}
+
+//Read mouse movement since last call
+TM_USBH_HID_GetMouseDelta(TM_USB_FS, &dx, &dy);
+\endcode
  * 
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added report queue with keyboard key events and accumulated mouse movement
+  - Fixed read of uninitialized pointer in @ref TM_USBH_HID_GetMouse
 \endverbatim
  *
  * \par Dependencies
@@ -88,7 +124,26 @@ extern "C" {
  * @brief    Library defines
  * @{
  */
-/* Macros here */
+
+/* Number of events in HID event queue, must be power of 2. Set to 0 to disable queue */
+#ifndef USBH_HID_QUEUE_SIZE
+#define USBH_HID_QUEUE_SIZE    16
+#endif
+
+#if USBH_HID_QUEUE_SIZE & (USBH_HID_QUEUE_SIZE - 1)
+#error "USBH_HID_QUEUE_SIZE must be power of 2!"
+#endif
+
+/* Modifier flags in @ref TM_USBH_HID_Event_t, the same order as in keyboard report */
+#define TM_USBH_HID_MOD_LCTRL     0x01 /*!< Left control */
+#define TM_USBH_HID_MOD_LSHIFT    0x02 /*!< Left shift */
+#define TM_USBH_HID_MOD_LALT      0x04 /*!< Left alt */
+#define TM_USBH_HID_MOD_LGUI      0x08 /*!< Left GUI */
+#define TM_USBH_HID_MOD_RCTRL     0x10 /*!< Right control */
+#define TM_USBH_HID_MOD_RSHIFT    0x20 /*!< Right shift */
+#define TM_USBH_HID_MOD_RALT      0x40 /*!< Right alt */
+#define TM_USBH_HID_MOD_RGUI      0x80 /*!< Right GUI */
+
 /**
  * @}
  */
@@ -145,6 +200,28 @@ typedef struct _TM_USBH_HID_Mouse_t {
 	uint8_t Buttons[3]; /*!< Values for 3 buttons */
 } TM_USBH_HID_Mouse_t;
 
+/**
+ * @brief  HID event type enumeration
+ */
+typedef enum _TM_USBH_HID_EventType_t {
+	TM_USBH_HID_EventType_KeyPress = 0x00, /*!< Keyboard key pressed */
+	TM_USBH_HID_EventType_KeyRelease,      /*!< Keyboard key released */
+	TM_USBH_HID_EventType_MouseButton      /*!< Mouse button state changed */
+} TM_USBH_HID_EventType_t;
+
+/**
+ * @brief  HID event in event queue
+ */
+typedef struct _TM_USBH_HID_Event_t {
+	uint32_t Time;                /*!< HAL tick when report was received */
+	TM_USB_t USB_Mode;            /*!< USB port where device is connected */
+	TM_USBH_HID_EventType_t Type; /*!< Event type */
+	uint8_t Key;                  /*!< HID key code for keyboard, button number 0 to 2 for mouse */
+	uint8_t Char;                 /*!< ASCII code of key with shift applied, 0 when key has no ASCII code */
+	uint8_t Modifiers;            /*!< Modifier keys at the time of report, TM_USBH_HID_MOD_x flags */
+	uint8_t Pressed;              /*!< Mouse button state, 1 when pressed */
+} TM_USBH_HID_Event_t;
+
 /**
  * @}
  */
@@ -185,6 +262,43 @@ TM_USBH_HID_t TM_USBH_HID_GetKeyboard(TM_USB_t USB_Mode, TM_USBH_HID_Keyboard_t*
  */
 TM_USBH_HID_t TM_USBH_HID_GetMouse(TM_USB_t USB_Mode, TM_USBH_HID_Mouse_t* MouseStruct);
 
+/**
+ * @brief  Reads events from HID event queue
+ * @note   Available when USBH_HID_QUEUE_SIZE is greater than 0
+ * @param  *Events: Pointer to array to save events
+ * @param  count: Maximal number of events to read
+ * @retval Number of read events
+ */
+uint16_t TM_USBH_HID_GetEvents(TM_USBH_HID_Event_t* Events, uint16_t count);
+
+/**
+ * @brief  Gets number of events lost because event queue was full
+ * @note   Available when USBH_HID_QUEUE_SIZE is greater than 0
+ * @param  None
+ * @retval Number of lost events
+ */
+uint32_t TM_USBH_HID_EventsLost(void);
+
+/**
+ * @brief  Gets mouse movement accumulated from all reports since last call, and resets it
+ * @note   Available when USBH_HID_QUEUE_SIZE is greater than 0.
+ *         @ref TM_USBH_HID_GetMouse uses and resets the same movement
+ * @param  USB_Mode: USB mode where mouse is connected. This parameter can be a value of @ref TM_USB_t enumeration
+ * @param  *dx: Pointer to save movement in X direction
+ * @param  *dy: Pointer to save movement in Y direction
+ * @retval Member of @ref TM_USBH_HID_t enumeration. @arg TM_USBH_HID_Mouse will be returned if mouse has moved
+ */
+TM_USBH_HID_t TM_USBH_HID_GetMouseDelta(TM_USB_t USB_Mode, int32_t* dx, int32_t* dy);
+
+/**
+ * @brief  Called for each new event added to HID event queue
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ * @note   Called from @ref TM_USBH_Process
+ * @param  *Event: Pointer to new event, also saved to queue
+ * @retval None
+ */
+void TM_USBH_HID_EventCallback(TM_USBH_HID_Event_t* Event);
+
 /**
  * @}
  */
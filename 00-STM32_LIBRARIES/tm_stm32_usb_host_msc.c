@@ -25,6 +25,20 @@
  */
 #include "tm_stm32_usb_host_msc.h"
 
+/* Copy buffers, 2 chunks */
+#ifdef USBH_MSC_COPY_BUFFER_ADDR
+#define USBH_MSC_COPY_BUFFER          ((uint8_t *)(USBH_MSC_COPY_BUFFER_ADDR))
+#else
+static uint32_t USBH_MSC_CopyData[2 * USBH_MSC_COPY_CHUNK_SIZE / 4];
+#define USBH_MSC_COPY_BUFFER          ((uint8_t *)USBH_MSC_CopyData)
+#endif
+
+/* Files for copy */
+static FIL USBH_MSC_CopySrc, USBH_MSC_CopyDst;
+
+/* Private functions */
+static void TM_USBH_MSC_INT_CopyUpdate(TM_USBH_MSC_Copy_t* Copy, uint32_t start);
+
 TM_USBH_Result_t TM_USBH_MSC_Init(TM_USB_t USB_Mode) {
 #ifdef USB_USE_FS
 	/* Init HID class for FS */
@@ -71,3 +85,106 @@ TM_USBH_Result_t TM_USBH_MSC_IsReady(TM_USB_t USB_Mode) {
 	/* Return error */
 	return TM_USBH_Result_Error;
 }
+
+TM_USBH_Result_t TM_USBH_MSC_CopyFile(const char* Source, const char* Destination, TM_USBH_MSC_Copy_t* Copy) {
+	uint8_t* buff;
+	uint32_t start;
+	uint8_t i = 0;
+	UINT br, bw;
+	
+	/* Reset progress */
+	memset(Copy, 0, sizeof(TM_USBH_MSC_Copy_t));
+	
+	/* Open files */
+	if ((Copy->Result = f_open(&USBH_MSC_CopySrc, Source, FA_READ)) != FR_OK) {
+		return TM_USBH_Result_Error;
+	}
+	if ((Copy->Result = f_open(&USBH_MSC_CopyDst, Destination, FA_CREATE_ALWAYS | FA_WRITE)) != FR_OK) {
+		f_close(&USBH_MSC_CopySrc);
+		return TM_USBH_Result_Error;
+	}
+	Copy->Size = f_size(&USBH_MSC_CopySrc);
+	start = HAL_GetTick();
+	
+#if _USE_EXPAND
+	/* Allocate contiguous block, FAT is not updated during copy then */
+	/* When there is no such block, clusters are allocated by f_write */
+	if (Copy->Size) {
+		f_expand(&USBH_MSC_CopyDst, Copy->Size, 1);
+	}
+#endif
+	
+	/* Buffers are written in background by USB driver */
+	TM_FATFS_USB_SetAsyncBuffer(USBH_MSC_COPY_BUFFER, 2 * USBH_MSC_COPY_CHUNK_SIZE);
+	
+	while (Copy->Copied < Copy->Size) {
+		/* Use chunks one after another */
+		buff = &USBH_MSC_COPY_BUFFER[i * USBH_MSC_COPY_CHUNK_SIZE];
+		i ^= 1;
+		
+		/* Previous data in chunk must be written first */
+		while (TM_FATFS_USB_IsPending(buff, USBH_MSC_COPY_CHUNK_SIZE)) {
+			TM_FATFS_USB_Process();
+		}
+		
+		/* Read chunk, other chunk is written to destination meanwhile */
+		if ((Copy->Result = f_read(&USBH_MSC_CopySrc, buff, USBH_MSC_COPY_CHUNK_SIZE, &br)) != FR_OK) {
+			break;
+		}
+		if (br == 0) {
+			break;
+		}
+		
+		/* Write chunk, function returns when transfer is started */
+		if ((Copy->Result = f_write(&USBH_MSC_CopyDst, buff, br, &bw)) != FR_OK) {
+			break;
+		}
+		if (bw != br) {
+			/* Disk is full */
+			Copy->Result = FR_DENIED;
+			break;
+		}
+		
+		/* Update progress */
+		Copy->Copied += br;
+		TM_USBH_MSC_INT_CopyUpdate(Copy, start);
+		
+		/* Call user function */
+		TM_USBH_MSC_CopyCallback(Copy);
+	}
+	
+	/* Close files, destination waits for all background writes */
+	f_close(&USBH_MSC_CopySrc);
+	if (Copy->Result == FR_OK) {
+		Copy->Result = f_close(&USBH_MSC_CopyDst);
+	} else {
+		f_close(&USBH_MSC_CopyDst);
+	}
+	TM_FATFS_USB_SetAsyncBuffer(NULL, 0);
+	
+	/* Final time and throughput */
+	TM_USBH_MSC_INT_CopyUpdate(Copy, start);
+	
+	/* Remove incomplete destination file */
+	if (Copy->Result != FR_OK || Copy->Copied != Copy->Size) {
+		f_unlink(Destination);
+		return TM_USBH_Result_Error;
+	}
+	
+	/* Return OK */
+	return TM_USBH_Result_Ok;
+}
+
+__weak void TM_USBH_MSC_CopyCallback(TM_USBH_MSC_Copy_t* Copy) {
+	/* NOTE: This function should not be modified, when the callback is needed,
+            the TM_USBH_MSC_CopyCallback could be implemented in the user file
+	*/
+}
+
+/* Private functions */
+static void TM_USBH_MSC_INT_CopyUpdate(TM_USBH_MSC_Copy_t* Copy, uint32_t start) {
+	/* Bytes per millisecond are kB/s */
+	Copy->Time = HAL_GetTick() - start;
+	Copy->Throughput = Copy->Time ? Copy->Copied / Copy->Time : 0;
+	Copy->Percent = Copy->Size ? (uint8_t)(((uint64_t)Copy->Copied * 100) / Copy->Size) : 100;
+}
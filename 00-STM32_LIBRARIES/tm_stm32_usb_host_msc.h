@@ -3,7 +3,7 @@
  * @email   tilen@majerle.eu
  * @website http://stm32f4-discovery.com
  * @link    http://stm32f4-discovery.com/2015/08/hal-library-21-multi-purpose-usb-library-for-stm32fxxx/
- * @version v1.0
+ * @version v1.1
  * @ide     Keil uVision
  * @license MIT
  * @brief   USB HOST for MSC devices library
@@ -35,7 +35,7 @@
 \endverbatim
  */
 #ifndef TM_USBH_MSC_H
-#define TM_USBH_MSC_H 100
+#define TM_USBH_MSC_H 110
 
 /* C++ detection */
 #ifdef __cplusplus
@@ -58,11 +58,52 @@ extern "C" {
  *
  * For writing/reading from devices, you will also need @ref TM_FATFS library with driver for USB FS and/or HS modes.
  *
+ * \par Copy between USB ports
+ *
+ * @ref TM_USBH_MSC_CopyFile copies file between 2 devices, for example from FS to HS port.
+ * File is copied in big chunks with 2 buffers. While one buffer is read from source device,
+ * other buffer is written to destination device on the other USB port in background.
+ * Both USB cores transfer at the same time, so copy speed is close to speed of slower device.
+ *
+ * Destination file is allocated in one contiguous block first when possible, so FAT is not updated during copy.
+ * After each chunk, @ref TM_USBH_MSC_CopyCallback is called with progress and throughput.
+ *
+ * Buffers need 2 * USBH_MSC_COPY_CHUNK_SIZE bytes. For big chunks, place them to SDRAM:
+ *
+\verbatim
+//Use SDRAM for copy buffers, SDRAM must be initialized before copy
+#define USBH_MSC_COPY_BUFFER_ADDR     0xD0200000
+//64kB chunks
+#define USBH_MSC_COPY_CHUNK_SIZE      65536
+\endverbatim
+ *
+ * Example:
+ *
+\verbatim
+TM_USBH_MSC_Copy_t Copy;
+
+//Copy file from FS to HS stick
+if (TM_USBH_MSC_CopyFile("USBFS:video.mp4", "USBHS:video.mp4", &Copy) == TM_USBH_Result_Ok) {
+    printf("Copied %u bytes in %u ms, %u kB/s\n", Copy.Copied, Copy.Time, Copy.Throughput);
+}
+
+//Called after each chunk
+void TM_USBH_MSC_CopyCallback(TM_USBH_MSC_Copy_t* Copy) {
+    printf("%d%%, %u kB/s\n", Copy->Percent, Copy->Throughput);
+}
+\endverbatim
+ *
+ * @note  Both devices must be mounted with FATFS before copy. Copy between 2 files on the same port works too, reads and writes are not overlapped then.
+ *
  * \par Changelog
  *
 \verbatim
  Version 1.0
   - First release
+  
+ Version 1.1
+  - October 14, 2026
+  - Added copy engine for file copy between FS and HS ports with overlapped reads and writes
 \endverbatim
  *
  * \par Dependencies
@@ -75,6 +116,7 @@ extern "C" {
  - USB Host Stack
  - USB Host MSC class
  - TM FATFS
+ - FATFS USB driver
 \endverbatim
  */
 
@@ -84,13 +126,30 @@ extern "C" {
 #include "tm_stm32_usb_host.h"
 #include "usbh_msc.h"
 #include "tm_stm32_fatfs.h"
+#include "fatfs_usb.h"
 
 /**
  * @defgroup TM_USBH_MSC_Macros
  * @brief    Library defines
  * @{
  */
-/* Macros here */
+
+/* Size of one copy chunk in bytes, 2 chunks are used */
+#ifndef USBH_MSC_COPY_CHUNK_SIZE
+#define USBH_MSC_COPY_CHUNK_SIZE      16384
+#endif
+
+/* Copy buffers can be placed to external memory, eg. SDRAM, by defining start address */
+/* #define USBH_MSC_COPY_BUFFER_ADDR     0xD0200000 */
+
+/* Check settings */
+#if USBH_MSC_COPY_CHUNK_SIZE % _MAX_SS
+#error "USBH_MSC_COPY_CHUNK_SIZE must be multiple of sector size!"
+#endif
+#if FATFS_USB_QUEUE_LENGTH == 0
+#warning "FATFS_USB_QUEUE_LENGTH is 0, copy will not overlap reads and writes!"
+#endif
+
 /**
  * @}
  */
@@ -101,6 +160,18 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief  Copy progress
+ */
+typedef struct {
+	uint32_t Size;       /*!< Size of source file in bytes */
+	uint32_t Copied;     /*!< Number of bytes read from source and given to destination */
+	uint32_t Time;       /*!< Time from copy start in milliseconds */
+	uint32_t Throughput; /*!< Average copy speed in kB/s */
+	uint8_t Percent;     /*!< Progress in percent */
+	FRESULT Result;      /*!< FATFS result of last operation */
+} TM_USBH_MSC_Copy_t;
+
 /**
  * @}
  */
@@ -132,6 +203,24 @@ TM_USBH_Result_t TM_USBH_MSC_IsConnected(TM_USB_t USB_Mode);
  */
 TM_USBH_Result_t TM_USBH_MSC_IsReady(TM_USB_t USB_Mode);
 
+/**
+ * @brief  Copies file, reads from source and writes to destination are overlapped when files are on different USB ports
+ * @note   Function returns when whole file is copied and destination file is closed
+ * @param  *Source: Path to source file, for example "USBFS:file.bin"
+ * @param  *Destination: Path to destination file, for example "USBHS:file.bin". Existing file is overwritten
+ * @param  *Copy: Pointer to @ref TM_USBH_MSC_Copy_t structure with progress and result
+ * @retval Member of @ref TM_USBH_Result_t enumeration
+ */
+TM_USBH_Result_t TM_USBH_MSC_CopyFile(const char* Source, const char* Destination, TM_USBH_MSC_Copy_t* Copy);
+
+/**
+ * @brief  Called by @ref TM_USBH_MSC_CopyFile after each chunk
+ * @param  *Copy: Pointer to @ref TM_USBH_MSC_Copy_t structure with progress
+ * @retval None
+ * @note   With __weak parameter to prevent link errors if not defined by user
+ */
+void TM_USBH_MSC_CopyCallback(TM_USBH_MSC_Copy_t* Copy);
+
 /**
  * @}
  */
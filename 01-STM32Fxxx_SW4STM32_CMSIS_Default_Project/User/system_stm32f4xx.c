@@ -168,6 +168,12 @@ const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8,
   */
 void SystemInit(void)
 {
+#if defined(__GNUC__) && !defined(__CC_ARM)
+  /* CCM RAM sections from LinkerScript.ld, __ccm and __fastdata variables */
+  extern uint32_t _siccmram, _sccmram, _eccmram;
+  uint32_t *src, *dst;
+#endif
+
   /* FPU settings ------------------------------------------------------------*/
   #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
     SCB->CPACR |= ((3UL << 10*2)|(3UL << 11*2));  /* set CP10 and CP11 Full Access */
@@ -191,6 +197,13 @@ void SystemInit(void)
   /* Disable all interrupts */
   RCC->CIR = 0x00000000;
 
+#if defined(__GNUC__) && !defined(__CC_ARM)
+  /* Copy CCM RAM initial values from flash, startup code copies .data and .ramfunc only */
+  for (src = &_siccmram, dst = &_sccmram; dst < &_eccmram; ) {
+    *dst++ = *src++;
+  }
+#endif
+
 #if defined (DATA_IN_ExtSRAM) || defined (DATA_IN_ExtSDRAM)
   SystemInit_ExtMemCtl(); 
 #endif /* DATA_IN_ExtSRAM || DATA_IN_ExtSDRAM */
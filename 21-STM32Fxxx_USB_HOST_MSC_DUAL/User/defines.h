@@ -52,4 +52,10 @@
 //#define USB_USE_DEVICE
 //#define USB_USE_ULPI_PHY
 
+/* File copy between FS and HS, 2 chunks of 16kB in internal RAM */
+#define USBH_MSC_COPY_CHUNK_SIZE    16384
+/* Bigger chunks can be placed to SDRAM on STM32F429-Discovery, SDRAM must be initialized first */
+//#define USBH_MSC_COPY_CHUNK_SIZE    65536
+//#define USBH_MSC_COPY_BUFFER_ADDR   0xD0000000
+
 #endif
@@ -1,6 +1,9 @@
 /**
  * Keil project example for USB MSC on both USB ports at the same time
  *
+ * When both devices are connected, press button to copy "copy.bin" file from FS to HS device.
+ * Reads from FS and writes to HS are done at the same time.
+ *
  * @note      Check defines.h file for configuration settings!
  *
  * Before you start, select your target, on the right of the "Load" button
@@ -36,6 +39,9 @@ uint32_t written;
 /* Flags */
 uint8_t FS_Printed = 0, HS_Printed = 0;
 uint8_t FS_Mounted = 0, HS_Mounted = 0;
+
+/* Copy progress */
+TM_USBH_MSC_Copy_t Copy;
 	
 int main(void) {
 	/* Init system */
@@ -259,7 +265,38 @@ int main(void) {
 				TM_DISCO_LedOff(LED_RED);
 			}
 		}
+		
+		/* Copy file from FS to HS on button press */
+		if (TM_DISCO_ButtonOnPressed() && FS_Mounted && HS_Mounted) {
+			/* Mount both devices */
+			if (f_mount(&FATFS_USB_FS, "USBFS:", 1) == FR_OK && f_mount(&FATFS_USB_HS, "USBHS:", 1) == FR_OK) {
+				printf("USB FS->HS: Copy started!\n");
+				
+				/* Copy, progress is printed in callback */
+				if (TM_USBH_MSC_CopyFile("USBFS:copy.bin", "USBHS:copy.bin", &Copy) == TM_USBH_Result_Ok) {
+					printf("USB FS->HS: Copied %u bytes in %u ms, %u kB/s\n", (unsigned)Copy.Copied, (unsigned)Copy.Time, (unsigned)Copy.Throughput);
+				} else {
+					printf("USB FS->HS: Copy failed! FRES: %d\n", Copy.Result);
+				}
+			} else {
+				printf("USB FS->HS: Failed to mount!\n");
+			}
+			
+			/* Unmount USB */
+			f_mount(NULL, "USBFS:", 1);
+			f_mount(NULL, "USBHS:", 1);
+		}
+	}
+}
+
+/* Called after each copied chunk */
+void TM_USBH_MSC_CopyCallback(TM_USBH_MSC_Copy_t* Copy) {
+	/* Print every 10% */
+	static uint8_t last = 0;
+	if (Copy->Percent / 10 != last / 10 || Copy->Percent < last) {
+		printf("USB FS->HS: %3d%%, %u kB/s\n", Copy->Percent, (unsigned)Copy->Throughput);
 	}
+	last = Copy->Percent;
 }
 
 /* printf handler */
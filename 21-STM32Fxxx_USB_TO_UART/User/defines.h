@@ -49,4 +49,9 @@
 #define USB_USE_DEVICE
 //#define USB_USE_ULPI
 
+/* Buffers for USB to UART bridge up to 3 Mbaud */
+#define USBD_CDC_RECEIVE_BUFFER_SIZE_HS    4096
+#define USBD_CDC_TMP_TRANSMIT_BUFFER_SIZE  2048
+#define TM_USART6_BUFFER_SIZE              4096
+
 #endif
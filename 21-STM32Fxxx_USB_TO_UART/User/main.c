@@ -22,13 +22,8 @@
 #include "tm_stm32_usb_device.h"
 #include "tm_stm32_usb_device_cdc.h"
 #include "tm_stm32_usart.h"
+#include "tm_stm32_usb_device_cdc_bridge.h"
 
-/* USB CDC settings */
-TM_USBD_CDC_Settings_t USB_Settings;
-
-/* Character value */
-char ch;
-char string_array[30];
 	
 int main(void) {
 	/* Init system */
@@ -43,51 +38,33 @@ int main(void) {
 	/* Init delay */
 	TM_DELAY_Init();
 	
+	/* Init USART, baudrate is changed later from terminal settings */
+	TM_USART_Init(USART6, TM_USART_PinsPack_1, 115200);
+	
 	/* Init USB peripheral */
 	TM_USB_Init();
 	
 	/* Init VCP on HS port */
 	TM_USBD_CDC_Init(TM_USB_HS);
 	
+	/* Connect VCP on HS port with USART6, data are transferred with DMA in both directions */
+	TM_USBD_CDC_BRIDGE_Init(TM_USB_HS, USART6);
+	
 	/* Start USB device mode on HS port */
 	TM_USBD_Start(TM_USB_HS);
 	
 	while (1) {
-		/* Process USB CDC device, send remaining data if needed */
-		/* It is better if you call this in periodic timer, like each ms in SYSTICK handler */
-		TM_USBD_CDC_Process(TM_USB_HS);
+		/* Apply terminal settings to USART when changed */
+		/* Data are transferred from interrupts, this only checks for settings */
+		TM_USBD_CDC_BRIDGE_Process(TM_USB_HS);
 		
 		/* Check if device is ready, if drivers are installed if needed on HS port */
 		if (TM_USBD_IsDeviceReady(TM_USB_HS) == TM_USBD_Result_Ok) {
 			/* Turn on green LED */
 			TM_DISCO_LedOn(LED_GREEN);
-			
-			/* Check if user has changed parameters for COM port */
-			TM_USBD_CDC_GetSettings(TM_USB_HS, &USB_Settings);
-		
-			/* Check if settings updated from user terminal */
-			if (USB_Settings.Updated) {
-				/* Reinit USART, only baudrate works in this example */
-				TM_USART_Init(USART6, TM_USART_PinsPack_1, USB_Settings.Baudrate);
-			}
-		
-			/* Check if anything received on HS port from user */
-			while (TM_USBD_CDC_Getc(TM_USB_HS, &ch)) {
-				/* One character received */
-				
-				/* Send character to USART */
-				TM_USART_Putc(USART6, ch);
-			}
-			
-			/* CHeck if any character received from USART */
-			while (!TM_USART_BufferEmpty(USART6)) {
-				/* Send data over USB CDC */
-				TM_USBD_CDC_Putc(TM_USB_HS, TM_USART_Getc(USART6));
-			}	
 		} else {
 			/* Turn off green LED */
 			TM_DISCO_LedOff(LED_GREEN);
 		}
 	}
 }
-
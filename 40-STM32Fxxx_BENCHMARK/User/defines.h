@@ -0,0 +1,90 @@
+/**
+ * Defines for your entire project at one place
+ * 
+ * @author     Tilen Majerle
+ * @email      tilen@majerle.eu
+ * @website    http://stm32f4-discovery.com
+ * @version    v1.0
+ * @ide        Keil uVision 5
+ * @license    GNU GPL v3
+ *	
+ * |----------------------------------------------------------------------
+ * | Copyright (C) Tilen Majerle, 2015
+ * | 
+ * | This program is free software: you can redistribute it and/or modify
+ * | it under the terms of the GNU General Public License as published by
+ * | the Free Software Foundation, either version 3 of the License, or
+ * | any later version.
+ * |  
+ * | This program is distributed in the hope that it will be useful,
+ * | but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * | MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * | GNU General Public License for more details.
+ * | 
+ * | You should have received a copy of the GNU General Public License
+ * | along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * |----------------------------------------------------------------------
+ */
+#ifndef TM_DEFINES_H
+#define TM_DEFINES_H
+
+/* Put your global defines for all libraries here used in your project */
+
+/* Defines for RCC settings for system */
+/* I've added these defines in options for target in Keil uVision for each target different settings */
+//#define RCC_OSCILLATORTYPE    RCC_OSCILLATORTYPE_HSE /*!< Used to select system oscillator type */
+//#define RCC_PLLM              8                      /*!< Used for PLL M parameter */
+//#define RCC_PLLN              360                    /*!< Used for PLL N parameter */
+//#define RCC_PLLP              2                      /*!< Used for PLL P parameter */
+//#define RCC_PLLQ              7                      /*!< Used for PLL Q parameter */
+//#define RCC_PLLR              10                     /*!< Used for PLL R parameter, available on STM32F446xx */
+
+/* Disable cache */
+#define DISABLE_CACHE
+
+/**********************************************************************/
+/*                      Benchmark related settings                    */
+/**********************************************************************/
+/* Report output, USART6, TX: PC6, RX: PC7 */
+#define BENCH_REPORT_USART          USART6
+#define BENCH_REPORT_PINSPACK       TM_USART_PinsPack_1
+#define BENCH_REPORT_BAUDRATE       921600
+
+/* USART under test, USART1, TX: PA9, RX: PA10, DMA2 Stream7 */
+#define BENCH_USART                 USART1
+#define BENCH_USART_PINSPACK        TM_USART_PinsPack_1
+#define BENCH_USART_BAUDRATE        921600
+
+/* SPI under test, SPI2, MOSI: PB15, MISO: PB14, SCK: PB13, DMA1 Stream4 and Stream3 */
+#define BENCH_SPI                   SPI2
+#define BENCH_SPI_PINSPACK          TM_SPI_PinsPack_2
+#define TM_SPI2_PRESCALER           SPI_BAUDRATEPRESCALER_4
+
+/* I2C under test, I2C3, SDA: PC9, SCL: PA8, tests are skipped if device does not respond */
+/* STMPE811 touch controller on STM32F429-Discovery is used by default, registers are only read */
+#define BENCH_I2C                   I2C3
+#define BENCH_I2C_PINSPACK          TM_I2C_PinsPack_1
+#define BENCH_I2C_CLOCK             400000
+#define BENCH_I2C_ADDRESS           0x82
+
+/* Enable queued transactions for interrupt driven I2C test */
+#define I2C_QUEUE_SIZE              4
+
+/* Enable DMA2D queue for asynchronous fill test */
+#define DMA2D_GRAPHIC_QUEUE_SIZE    16
+
+/**********************************************************************/
+/*                        FATFS related settings                      */
+/**********************************************************************/
+/* Disable handler function inside TM DMA library */
+/* DMA2 Stream3 and Stream6 are used for SDCARD */
+#define DMA2_STREAM6_DISABLE_IRQHANDLER
+#define DMA2_STREAM3_DISABLE_IRQHANDLER
+
+/**********************************************************************/
+/*                          USB related settings                      */
+/**********************************************************************/
+#define USB_USE_FS
+#define USB_USE_DEVICE
+
+#endif
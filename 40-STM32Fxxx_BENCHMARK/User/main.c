@@ -0,0 +1,364 @@
+/**
+ * Keil project example for driver benchmark
+ *
+ * @note      Check defines.h file for configuration settings!
+ *
+ * Before you start, select your target, on the right of the "Load" button
+ *
+ * Benchmark runs standard suite of transfers for USART, SPI, I2C, CRC, DMA2D, FATFS and USB CDC
+ * and prints machine readable report over BENCH_REPORT_USART, one CSV line per test:
+ *
+ *   test,bytes,calls,cycles,bytes_per_s,cycles_per_call,isr_cycles,cpu_load
+ *
+ * - cycles: Total DWT cycles for test, from first call to end of last transfer
+ * - cycles_per_call: Mean cycles spent inside library call (blocking call includes complete transfer)
+ * - isr_cycles: Cycles spent in interrupts while main loop was waiting for asynchronous transfer
+ * - cpu_load: Percentage (multiplied by 100) of CPU time used by calls and interrupts during test
+ *
+ * Lines starting with # are comments, skipped tests are reported with comment line.
+ * Compare reports between builds to catch performance regressions.
+ *
+ * @author    Tilen Majerle
+ * @email     tilen@majerle.eu
+ * @website   http://stm32f4-discovery.com
+ * @ide       Keil uVision 5
+ * @conf      PLL parameters are set in "Options for Target" -> "C/C++" -> "Defines"
+ * @packs     STM32F4xx/STM32F7xx Keil packs are requred with HAL driver support
+ * @stdperiph STM32F4xx/STM32F7xx HAL drivers required
+ */
+/* Include core modules */
+#include "stm32fxxx_hal.h"
+/* Include my libraries here */
+#include "defines.h"
+#include "tm_stm32_disco.h"
+#include "tm_stm32_delay.h"
+#include "tm_stm32_general.h"
+#include "tm_stm32_usart.h"
+#include "tm_stm32_usart_dma.h"
+#include "tm_stm32_spi.h"
+#include "tm_stm32_spi_dma.h"
+#include "tm_stm32_i2c.h"
+#include "tm_stm32_crc.h"
+#include "tm_stm32_sdram.h"
+#include "tm_stm32_dma2d_graphic.h"
+#include "tm_stm32_fatfs.h"
+#include "tm_stm32_usb_device.h"
+#include "tm_stm32_usb_device_cdc.h"
+#include "stdio.h"
+
+/* Size of buffer for one call */
+#define BENCH_BUFFER_SIZE       4096
+
+/* Gap between 2 samples of DWT counter in wait loop, longer gaps are counted as interrupt time */
+#define BENCH_ISR_THRESHOLD     64
+
+/* Size of file for FATFS test */
+#define BENCH_FILE_SIZE         (256 * 1024)
+
+/* Benchmark result */
+typedef struct {
+	uint32_t Bytes;      /* Number of bytes transferred */
+	uint32_t Calls;      /* Number of library calls */
+	uint32_t Cycles;     /* Total number of cycles */
+	uint32_t CallCycles; /* Cycles inside library calls */
+	uint32_t ISRCycles;  /* Cycles in interrupts while waiting */
+} BENCH_Result_t;
+
+/* Test functions, start one transfer and check if asynchronous transfer is still in progress */
+typedef uint8_t (*BENCH_Start_t)(void);
+typedef uint8_t (*BENCH_Busy_t)(void);
+
+/* Data buffers, not on stack because DMA is used */
+uint8_t TX_Buffer[BENCH_BUFFER_SIZE];
+uint8_t RX_Buffer[BENCH_BUFFER_SIZE];
+
+/* Size of one call for current test */
+uint32_t BENCH_Size;
+
+/* FATFS */
+FATFS FS;
+FIL fil;
+
+/* DMA2D fence of last fill and CRC context */
+uint32_t DMA2D_Fence;
+TM_CRC_Context_t CRC_Context;
+
+/* Report string */
+char str[128];
+
+/* Print string to report output */
+static void BENCH_Output(char* s) {
+	TM_USART_Puts(BENCH_REPORT_USART, s);
+}
+
+/* Runs test with number of calls, each call transfers BENCH_Size bytes */
+static uint8_t BENCH_Run(BENCH_Result_t* Result, uint32_t calls, BENCH_Start_t Start, BENCH_Busy_t Busy) {
+	uint32_t start, t, last, now, i;
+	
+	Result->Bytes = calls * BENCH_Size;
+	Result->Calls = calls;
+	Result->CallCycles = 0;
+	Result->ISRCycles = 0;
+	
+	start = TM_GENERAL_DWTCounterGetValue();
+	for (i = 0; i < calls; i++) {
+		/* Cost of library call */
+		t = TM_GENERAL_DWTCounterGetValue();
+		if (!Start()) {
+			return 0;
+		}
+		Result->CallCycles += TM_GENERAL_DWTCounterGetValue() - t;
+		
+		/* Wait asynchronous transfer, count gaps in loop as interrupt time */
+		if (Busy) {
+			last = TM_GENERAL_DWTCounterGetValue();
+			while (Busy()) {
+				now = TM_GENERAL_DWTCounterGetValue();
+				if ((now - last) > BENCH_ISR_THRESHOLD) {
+					Result->ISRCycles += now - last;
+				}
+				last = now;
+			}
+		}
+	}
+	Result->Cycles = TM_GENERAL_DWTCounterGetValue() - start;
+	
+	return 1;
+}
+
+/* Prints result as CSV line */
+static void BENCH_Print(const char* name, BENCH_Result_t* Result) {
+	uint32_t bps = 0, load = 0;
+	
+	if (Result->Cycles) {
+		bps = (uint32_t)(((uint64_t)Result->Bytes * SystemCoreClock) / Result->Cycles);
+		load = (uint32_t)(((uint64_t)(Result->CallCycles + Result->ISRCycles) * 10000) / Result->Cycles);
+		if (load > 10000) {
+			load = 10000;
+		}
+	}
+	
+	sprintf(str, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+		name,
+		(unsigned long)Result->Bytes,
+		(unsigned long)Result->Calls,
+		(unsigned long)Result->Cycles,
+		(unsigned long)bps,
+		(unsigned long)(Result->CallCycles / Result->Calls),
+		(unsigned long)Result->ISRCycles,
+		(unsigned long)load
+	);
+	BENCH_Output(str);
+}
+
+/* Runs and prints test */
+static void BENCH_Test(const char* name, uint32_t size, uint32_t calls, BENCH_Start_t Start, BENCH_Busy_t Busy) {
+	BENCH_Result_t Result;
+	
+	BENCH_Size = size;
+	if (BENCH_Run(&Result, calls, Start, Busy)) {
+		BENCH_Print(name, &Result);
+	} else {
+		sprintf(str, "# %s skipped\n", name);
+		BENCH_Output(str);
+	}
+}
+
+/* USART */
+static uint8_t USART_Send(void) {
+	TM_USART_Send(BENCH_USART, TX_Buffer, BENCH_Size);
+	return 1;
+}
+static uint8_t USART_DMA_Send(void) {
+	return TM_USART_DMA_Send(BENCH_USART, TX_Buffer, BENCH_Size);
+}
+static uint8_t USART_DMA_Busy(void) {
+	return TM_USART_DMA_Transmitting(BENCH_USART) || !(BENCH_USART->USART_STATUS_REG & USART_FLAG_TC);
+}
+
+/* SPI */
+static uint8_t SPI_Send(void) {
+	TM_SPI_SendMulti(BENCH_SPI, TX_Buffer, RX_Buffer, BENCH_Size);
+	return 1;
+}
+static uint8_t SPI_DMA_Send(void) {
+	return TM_SPI_DMA_Transmit(BENCH_SPI, TX_Buffer, RX_Buffer, BENCH_Size);
+}
+static uint8_t SPI_DMA_Busy(void) {
+	return TM_SPI_DMA_Transmitting(BENCH_SPI);
+}
+
+/* I2C */
+static uint8_t I2C_Read(void) {
+	return TM_I2C_ReadMulti(BENCH_I2C, BENCH_I2C_ADDRESS, 0x00, RX_Buffer, BENCH_Size) == TM_I2C_Result_Ok;
+}
+static uint8_t I2C_ReadQueued(void) {
+	return TM_I2C_ReadMultiQueued(BENCH_I2C, BENCH_I2C_ADDRESS, 0x00, RX_Buffer, BENCH_Size, NULL, NULL);
+}
+static uint8_t I2C_Busy(void) {
+	return TM_I2C_QueuePending(BENCH_I2C) > 0;
+}
+
+/* CRC */
+static uint8_t CRC_CPU(void) {
+	TM_CRC_Calculate32((uint32_t *)TX_Buffer, BENCH_Size / 4, 1);
+	return 1;
+}
+static uint8_t CRC_DMA(void) {
+	return TM_CRC_CalculateDMA(&CRC_Context, (uint32_t *)TX_Buffer, BENCH_Size / 4) == 0;
+}
+static uint8_t CRC_Busy(void) {
+	return TM_CRC_DMABusy();
+}
+
+/* DMA2D, fill of entire layer in SDRAM */
+static uint8_t DMA2D_Fill(void) {
+	TM_DMA2DGRAPHIC_Fill(GRAPHIC_COLOR_BLUE);
+	DMA2D_Fence = TM_DMA2DGRAPHIC_InsertFence();
+	return 1;
+}
+static uint8_t DMA2D_Busy(void) {
+	return !TM_DMA2DGRAPHIC_IsFenceDone(DMA2D_Fence);
+}
+
+/* FATFS */
+static uint8_t FATFS_Write(void) {
+	UINT bw;
+	return f_write(&fil, TX_Buffer, BENCH_Size, &bw) == FR_OK && bw == BENCH_Size;
+}
+static uint8_t FATFS_Read(void) {
+	UINT br;
+	return f_read(&fil, RX_Buffer, BENCH_Size, &br) == FR_OK && br == BENCH_Size;
+}
+
+/* USB CDC, call returns when all data are accepted to TX buffer */
+static uint8_t CDC_Send(void) {
+	uint16_t sent = 0;
+	uint32_t timeout = 1000000;
+	
+	while (sent < BENCH_Size && timeout--) {
+		sent += TM_USBD_CDC_PutArray(TM_USB_FS, &TX_Buffer[sent], BENCH_Size - sent);
+		TM_USBD_CDC_Process(TM_USB_FS);
+	}
+	return sent == BENCH_Size;
+}
+
+int main(void) {
+	uint32_t i;
+	
+	/* Init system clock for maximum system speed */
+	TM_RCC_InitSystem();
+	
+	/* Init HAL layer */
+	HAL_Init();
+	
+	/* Init leds */
+	TM_DISCO_LedInit();
+	
+	/* Init delay */
+	TM_DELAY_Init();
+	
+	/* Init DWT counter for measurements */
+	TM_GENERAL_DWTCounterEnable();
+	
+	/* Fill test data */
+	for (i = 0; i < BENCH_BUFFER_SIZE; i++) {
+		TX_Buffer[i] = (uint8_t)i;
+	}
+	
+	/* Init report output */
+	TM_USART_Init(BENCH_REPORT_USART, BENCH_REPORT_PINSPACK, BENCH_REPORT_BAUDRATE);
+	
+	/* Init peripherals under test */
+	TM_USART_Init(BENCH_USART, BENCH_USART_PINSPACK, BENCH_USART_BAUDRATE);
+	TM_USART_DMA_Init(BENCH_USART);
+	TM_SPI_Init(BENCH_SPI, BENCH_SPI_PINSPACK);
+	TM_SPI_DMA_Init(BENCH_SPI);
+	TM_I2C_Init(BENCH_I2C, BENCH_I2C_PINSPACK, BENCH_I2C_CLOCK);
+	TM_CRC_Init();
+	TM_CRC_ContextInit(&CRC_Context, 0x04C11DB7, 32, 0xFFFFFFFF, 0);
+	TM_SDRAM_Init();
+	TM_DMA2DGRAPHIC_Init();
+	
+	/* Init USB device CDC on FS port */
+	TM_USB_Init();
+	TM_USBD_CDC_Init(TM_USB_FS);
+	TM_USBD_Start(TM_USB_FS);
+	
+	/* Give host some time to open virtual COM port */
+	Delayms(3000);
+	
+	/* Report header */
+	sprintf(str, "# TM benchmark, core clock %lu Hz\n", (unsigned long)SystemCoreClock);
+	BENCH_Output(str);
+	BENCH_Output("test,bytes,calls,cycles,bytes_per_s,cycles_per_call,isr_cycles,cpu_load\n");
+	
+	/* USART, blocking and DMA */
+	BENCH_Test("usart_send_16", 16, 64, USART_Send, NULL);
+	BENCH_Test("usart_send_1024", 1024, 4, USART_Send, NULL);
+	BENCH_Test("usart_dma_send_16", 16, 64, USART_DMA_Send, USART_DMA_Busy);
+	BENCH_Test("usart_dma_send_1024", 1024, 4, USART_DMA_Send, USART_DMA_Busy);
+	
+	/* SPI, blocking and DMA */
+	BENCH_Test("spi_sendmulti_16", 16, 256, SPI_Send, NULL);
+	BENCH_Test("spi_sendmulti_4096", 4096, 8, SPI_Send, NULL);
+	BENCH_Test("spi_dma_transmit_16", 16, 256, SPI_DMA_Send, SPI_DMA_Busy);
+	BENCH_Test("spi_dma_transmit_4096", 4096, 8, SPI_DMA_Send, SPI_DMA_Busy);
+	
+	/* I2C, blocking and interrupt driven queue */
+	if (TM_I2C_IsDeviceConnected(BENCH_I2C, BENCH_I2C_ADDRESS) == TM_I2C_Result_Ok) {
+		BENCH_Test("i2c_readmulti_2", 2, 64, I2C_Read, NULL);
+		BENCH_Test("i2c_readmulti_32", 32, 16, I2C_Read, NULL);
+		BENCH_Test("i2c_readqueued_2", 2, 64, I2C_ReadQueued, I2C_Busy);
+		BENCH_Test("i2c_readqueued_32", 32, 16, I2C_ReadQueued, I2C_Busy);
+	} else {
+		BENCH_Output("# i2c skipped, device not connected\n");
+	}
+	
+	/* CRC, CPU feeding and DMA */
+	BENCH_Test("crc_cpu_64", 64, 256, CRC_CPU, NULL);
+	BENCH_Test("crc_cpu_4096", 4096, 16, CRC_CPU, NULL);
+	BENCH_Test("crc_dma_64", 64, 256, CRC_DMA, CRC_Busy);
+	BENCH_Test("crc_dma_4096", 4096, 16, CRC_DMA, CRC_Busy);
+	
+	/* DMA2D, entire layer fill */
+	BENCH_Test("dma2d_fill", DMA2D_GRAPHIC_PIXELS * 2, 16, DMA2D_Fill, DMA2D_Busy);
+	
+	/* FATFS, sequential write and read of file on SD card */
+	if (f_mount(&FS, "SD:", 1) == FR_OK) {
+		if (f_open(&fil, "SD:bench.bin", FA_CREATE_ALWAYS | FA_READ | FA_WRITE) == FR_OK) {
+			BENCH_Test("fatfs_write_512", 512, BENCH_FILE_SIZE / 512, FATFS_Write, NULL);
+			BENCH_Test("fatfs_write_4096", 4096, BENCH_FILE_SIZE / 4096, FATFS_Write, NULL);
+			f_sync(&fil);
+			f_lseek(&fil, 0);
+			BENCH_Test("fatfs_read_512", 512, BENCH_FILE_SIZE / 512, FATFS_Read, NULL);
+			BENCH_Test("fatfs_read_4096", 4096, BENCH_FILE_SIZE / 4096, FATFS_Read, NULL);
+			f_close(&fil);
+			f_unlink("SD:bench.bin");
+		} else {
+			BENCH_Output("# fatfs skipped, file not opened\n");
+		}
+		f_mount(NULL, "SD:", 1);
+	} else {
+		BENCH_Output("# fatfs skipped, card not mounted\n");
+	}
+	
+	/* USB CDC, only when host has opened virtual COM port */
+	if (TM_USBD_IsDeviceReady(TM_USB_FS) == TM_USBD_Result_Ok) {
+		BENCH_Test("usb_cdc_putarray_64", 64, 256, CDC_Send, NULL);
+		BENCH_Test("usb_cdc_putarray_1024", 1024, 64, CDC_Send, NULL);
+	} else {
+		BENCH_Output("# usb_cdc skipped, device not ready\n");
+	}
+	
+	/* End of report */
+	BENCH_Output("# done\n");
+	
+	/* Benchmark done */
+	TM_DISCO_LedOn(LED_ALL);
+	
+	while (1) {
+		/* Process USB CDC device */
+		TM_USBD_CDC_Process(TM_USB_FS);
+	}
+}
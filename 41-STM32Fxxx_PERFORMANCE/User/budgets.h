@@ -0,0 +1,52 @@
+/**
+ * Golden cycle budgets for performance regression test
+ *
+ * Each budget is number of DWT cycles for one run of workload, measured with settings from defines.h.
+ * Test fails when best of PERF_RUNS runs is above budget for more than PERF_TOLERANCE percent.
+ *
+ * After intentional change of performance (faster library, different compiler or optimization level),
+ * set PERF_CALIBRATE to 1 in defines.h, run test on each target and replace values for that target
+ * with defines printed in report.
+ *
+ * FATFS budget depends on SD card, calibrate it with card which is used for testing.
+ */
+#ifndef BUDGETS_H
+#define BUDGETS_H
+
+/* FATFS write time varies with card internal state, larger tolerance is used */
+#ifndef PERF_TOLERANCE_FATFS
+#define PERF_TOLERANCE_FATFS        50
+#endif
+
+#if defined(STM32F429_DISCOVERY)
+/* STM32F429-Discovery, 168 MHz, 240x320 RGB565 LCD in SDRAM */
+#define PERF_BUDGET_BUFFER          90000
+#define PERF_BUDGET_CRC             70000
+#define PERF_BUDGET_FFT             80000
+#define PERF_BUDGET_DMA2D           1000000
+#define PERF_BUDGET_LCD             2500000
+#define PERF_BUDGET_GPS             200000
+#define PERF_BUDGET_FATFS           8000000
+#elif defined(STM32F439_EVAL)
+/* STM32F439-EVAL, 168 MHz, 640x480 RGB565 LCD in SDRAM */
+#define PERF_BUDGET_BUFFER          90000
+#define PERF_BUDGET_CRC             70000
+#define PERF_BUDGET_FFT             80000
+#define PERF_BUDGET_DMA2D           2800000
+#define PERF_BUDGET_LCD             2500000
+#define PERF_BUDGET_GPS             200000
+#define PERF_BUDGET_FATFS           8000000
+#elif defined(STM32F7_DISCOVERY)
+/* STM32F7-Discovery, 216 MHz, cache disabled, 480x272 RGB565 LCD in SDRAM */
+#define PERF_BUDGET_BUFFER          100000
+#define PERF_BUDGET_CRC             70000
+#define PERF_BUDGET_FFT             90000
+#define PERF_BUDGET_DMA2D           1400000
+#define PERF_BUDGET_LCD             2500000
+#define PERF_BUDGET_GPS             220000
+#define PERF_BUDGET_FATFS           10000000
+#else
+#error "No cycle budgets for selected target!"
+#endif
+
+#endif
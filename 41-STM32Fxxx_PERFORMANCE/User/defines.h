@@ -0,0 +1,75 @@
+/**
+ * Defines for your entire project at one place
+ * 
+ * @author     Tilen Majerle
+ * @email      tilen@majerle.eu
+ * @website    http://stm32f4-discovery.com
+ * @version    v1.0
+ * @ide        Keil uVision 5
+ * @license    GNU GPL v3
+ *	
+ * |----------------------------------------------------------------------
+ * | Copyright (C) Tilen Majerle, 2015
+ * | 
+ * | This program is free software: you can redistribute it and/or modify
+ * | it under the terms of the GNU General Public License as published by
+ * | the Free Software Foundation, either version 3 of the License, or
+ * | any later version.
+ * |  
+ * | This program is distributed in the hope that it will be useful,
+ * | but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * | MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * | GNU General Public License for more details.
+ * | 
+ * | You should have received a copy of the GNU General Public License
+ * | along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * |----------------------------------------------------------------------
+ */
+#ifndef TM_DEFINES_H
+#define TM_DEFINES_H
+
+/* Put your global defines for all libraries here used in your project */
+
+/* Defines for RCC settings for system */
+/* I've added these defines in options for target in Keil uVision for each target different settings */
+//#define RCC_OSCILLATORTYPE    RCC_OSCILLATORTYPE_HSE /*!< Used to select system oscillator type */
+//#define RCC_PLLM              8                      /*!< Used for PLL M parameter */
+//#define RCC_PLLN              360                    /*!< Used for PLL N parameter */
+//#define RCC_PLLP              2                      /*!< Used for PLL P parameter */
+//#define RCC_PLLQ              7                      /*!< Used for PLL Q parameter */
+//#define RCC_PLLR              10                     /*!< Used for PLL R parameter, available on STM32F446xx */
+
+/* Disable cache */
+#define DISABLE_CACHE
+
+/**********************************************************************/
+/*                     Performance test settings                      */
+/**********************************************************************/
+/* Report output, USART6, TX: PC6, RX: PC7 */
+#define PERF_REPORT_USART           USART6
+#define PERF_REPORT_PINSPACK        TM_USART_PinsPack_1
+#define PERF_REPORT_BAUDRATE        921600
+
+/* Number of runs for each workload, minimal number of cycles is compared to budget */
+#define PERF_RUNS                   5
+
+/* Allowed overrun of budget in percent */
+#define PERF_TOLERANCE              10
+
+/* Set to 1 to print measured cycles as budget defines for budgets.h */
+#define PERF_CALIBRATE              0
+
+/* GPS USART, RX: PB7, leave pin unconnected, recorded NMEA is written to USART buffer */
+#define GPS_USART                   USART1
+#define GPS_USART_PINSPACK          TM_USART_PinsPack_2
+#define TM_USART1_BUFFER_SIZE       256
+
+/**********************************************************************/
+/*                        FATFS related settings                      */
+/**********************************************************************/
+/* Disable handler function inside TM DMA library */
+/* DMA2 Stream3 and Stream6 are used for SDCARD */
+#define DMA2_STREAM6_DISABLE_IRQHANDLER
+#define DMA2_STREAM3_DISABLE_IRQHANDLER
+
+#endif
@@ -0,0 +1,396 @@
+/**
+ * Keil project example for performance regression test
+ *
+ * @note      Check defines.h file for configuration settings!
+ * @note      Golden cycle budgets for each target are in budgets.h file
+ *
+ * Before you start, select your target, on the right of the "Load" button
+ *
+ * Test runs fixed workloads through TM BUFFER, CRC, FFT, DMA2D GRAPHIC, LCD, GPS and FATFS libraries,
+ * measures them with DWT cycle counter and compares best of PERF_RUNS runs against golden budget.
+ * Report is printed over PERF_REPORT_USART, one CSV line per test:
+ *
+ *   test,cycles,budget,percent,result
+ *
+ * - cycles: Minimal number of DWT cycles of all runs
+ * - budget: Golden number of cycles from budgets.h for selected target
+ * - percent: Cycles in percent of budget
+ * - result: PASS, FAIL when over budget plus tolerance or when workload returned wrong result, SKIP when hardware is missing
+ *
+ * Lines starting with # are comments, last line is "# RESULT: PASS" or "# RESULT: FAIL".
+ * Green led is turned on when all tests pass, red led otherwise.
+ *
+ * @author    Tilen Majerle
+ * @email     tilen@majerle.eu
+ * @website   http://stm32f4-discovery.com
+ * @ide       Keil uVision 5
+ * @conf      PLL parameters are set in "Options for Target" -> "C/C++" -> "Defines"
+ * @packs     STM32F4xx/STM32F7xx Keil packs are requred with HAL driver support
+ * @stdperiph STM32F4xx/STM32F7xx HAL drivers required
+ */
+/* Include core modules */
+#include "stm32fxxx_hal.h"
+/* Include my libraries here */
+#include "defines.h"
+#include "tm_stm32_disco.h"
+#include "tm_stm32_delay.h"
+#include "tm_stm32_general.h"
+#include "tm_stm32_usart.h"
+#include "tm_stm32_buffer.h"
+#include "tm_stm32_crc.h"
+#include "tm_stm32_fft.h"
+#include "tm_stm32_lcd.h"
+#include "tm_stm32_dma2d_graphic.h"
+#include "tm_stm32_gps.h"
+#include "tm_stm32_fatfs.h"
+#include "budgets.h"
+#include "nmea_log.h"
+#include "stdio.h"
+#include "string.h"
+
+/* Size of data buffer for BUFFER, CRC and FATFS workloads */
+#define PERF_DATA_SIZE          4096
+
+/* Number of samples for FFT */
+#define PERF_FFT_SIZE           1024
+
+/* Square wave period in samples for FFT input, peak is expected at bin FFT size / period */
+#define PERF_FFT_PERIOD         32
+
+/* Size of file for FATFS workload */
+#define PERF_FILE_SIZE          (64 * 1024)
+
+/* Bytes written to GPS USART buffer at a time, as they would arrive between 2 updates */
+#define PERF_GPS_CHUNK          64
+
+/* Workload result */
+typedef enum {
+	PERF_Result_Ok = 0x00, /* Workload done, result is valid */
+	PERF_Result_Skip,      /* Hardware for workload is not available */
+	PERF_Result_Error      /* Workload returned wrong result */
+} PERF_Result_t;
+
+/* Workload function */
+typedef PERF_Result_t (*PERF_Workload_t)(void);
+
+/* Test description */
+typedef struct {
+	const char* Name;      /* Test name in report */
+	const char* Define;    /* Budget define name for calibration output */
+	PERF_Workload_t Setup; /* Prepares run, not measured, can be NULL */
+	PERF_Workload_t Run;   /* Measured workload */
+	uint32_t Budget;       /* Golden budget in cycles */
+	uint8_t Tolerance;     /* Allowed overrun in percent */
+} PERF_Test_t;
+
+/* Workloads */
+static PERF_Result_t BUFFER_Setup(void);
+static PERF_Result_t BUFFER_Run(void);
+static PERF_Result_t CRC_Run(void);
+static PERF_Result_t FFT_Setup(void);
+static PERF_Result_t FFT_Run(void);
+static PERF_Result_t DMA2D_Run(void);
+static PERF_Result_t LCD_Run(void);
+static PERF_Result_t GPS_Run(void);
+static PERF_Result_t FATFS_Setup(void);
+static PERF_Result_t FATFS_Run(void);
+
+/* List of tests */
+static const PERF_Test_t Tests[] = {
+	{"buffer_write_read", "PERF_BUDGET_BUFFER", BUFFER_Setup, BUFFER_Run, PERF_BUDGET_BUFFER, PERF_TOLERANCE},
+	{"crc_calculate32", "PERF_BUDGET_CRC", NULL, CRC_Run, PERF_BUDGET_CRC, PERF_TOLERANCE},
+	{"fft_process_f32", "PERF_BUDGET_FFT", FFT_Setup, FFT_Run, PERF_BUDGET_FFT, PERF_TOLERANCE},
+	{"dma2dgraphic_fill", "PERF_BUDGET_DMA2D", NULL, DMA2D_Run, PERF_BUDGET_DMA2D, PERF_TOLERANCE},
+	{"lcd_puts", "PERF_BUDGET_LCD", NULL, LCD_Run, PERF_BUDGET_LCD, PERF_TOLERANCE},
+	{"gps_update_nmea", "PERF_BUDGET_GPS", NULL, GPS_Run, PERF_BUDGET_GPS, PERF_TOLERANCE},
+	{"fatfs_write_seq", "PERF_BUDGET_FATFS", FATFS_Setup, FATFS_Run, PERF_BUDGET_FATFS, PERF_TOLERANCE_FATFS},
+};
+
+/* Data buffers */
+uint8_t Data[PERF_DATA_SIZE];
+uint8_t Copy[PERF_DATA_SIZE];
+
+/* BUFFER workload */
+TM_BUFFER_t Buffer;
+uint8_t BufferData[1024];
+
+/* CRC of data buffer, calculated on first run */
+uint32_t CRC_Reference;
+
+/* FFT workload */
+TM_FFT_F32_t FFT;
+float32_t FFT_Input[PERF_FFT_SIZE * 2];
+float32_t FFT_Output[PERF_FFT_SIZE];
+
+/* GPS workload */
+TM_GPS_t GPS_Data;
+
+/* FATFS */
+FATFS FS;
+FIL fil;
+uint8_t FS_Mounted;
+
+/* Report string */
+char str[128];
+
+/* Print string to report output */
+static void PERF_Output(char* s) {
+	TM_USART_Puts(PERF_REPORT_USART, s);
+}
+
+/* Runs test PERF_RUNS times and saves minimal number of cycles */
+static PERF_Result_t PERF_Measure(const PERF_Test_t* Test, uint32_t* Cycles) {
+	PERF_Result_t res;
+	uint32_t start, cycles, i;
+
+	*Cycles = 0xFFFFFFFF;
+	for (i = 0; i < PERF_RUNS; i++) {
+		/* Prepare run */
+		if (Test->Setup && (res = Test->Setup()) != PERF_Result_Ok) {
+			return res;
+		}
+
+		/* Measure workload */
+		start = TM_GENERAL_DWTCounterGetValue();
+		res = Test->Run();
+		cycles = TM_GENERAL_DWTCounterGetValue() - start;
+		if (res != PERF_Result_Ok) {
+			return res;
+		}
+
+		/* Best run, interrupts can only make it longer */
+		if (cycles < *Cycles) {
+			*Cycles = cycles;
+		}
+	}
+
+	return PERF_Result_Ok;
+}
+
+/* BUFFER, 200 writes and reads of 100 bytes through 1kB buffer, buffer pointers wrap around */
+static PERF_Result_t BUFFER_Setup(void) {
+	TM_BUFFER_Init(&Buffer, sizeof(BufferData), BufferData);
+	return PERF_Result_Ok;
+}
+static PERF_Result_t BUFFER_Run(void) {
+	uint32_t i, offset;
+
+	for (i = 0; i < 200; i++) {
+		offset = (i * 100) % (PERF_DATA_SIZE - 100);
+		if (TM_BUFFER_Write(&Buffer, &Data[offset], 100) != 100) {
+			return PERF_Result_Error;
+		}
+		if (TM_BUFFER_Read(&Buffer, &Copy[offset], 100) != 100) {
+			return PERF_Result_Error;
+		}
+	}
+
+	/* Check data of last read */
+	return memcmp(&Data[offset], &Copy[offset], 100) == 0 ? PERF_Result_Ok : PERF_Result_Error;
+}
+
+/* CRC, 16 calculations of 4kB buffer */
+static PERF_Result_t CRC_Run(void) {
+	uint32_t i, crc;
+
+	for (i = 0; i < 16; i++) {
+		crc = TM_CRC_Calculate32((uint32_t *)Data, PERF_DATA_SIZE / 4, 1);
+
+		/* Save first result as reference */
+		if (!CRC_Reference) {
+			CRC_Reference = crc;
+		}
+		if (crc != CRC_Reference) {
+			return PERF_Result_Error;
+		}
+	}
+
+	return PERF_Result_Ok;
+}
+
+/* FFT, one 1024 samples complex FFT with magnitudes and maximum, input is destroyed by FFT and filled again before each run */
+static PERF_Result_t FFT_Setup(void) {
+	uint16_t i;
+
+	for (i = 0; i < PERF_FFT_SIZE; i++) {
+		TM_FFT_AddToBuffer(&FFT, (i % PERF_FFT_PERIOD) < (PERF_FFT_PERIOD / 2) ? 1.0f : -1.0f);
+	}
+	return PERF_Result_Ok;
+}
+static PERF_Result_t FFT_Run(void) {
+	TM_FFT_Process_F32(&FFT);
+
+	/* Fundamental of square wave or its mirror */
+	if (FFT.MaxIndex != PERF_FFT_SIZE / PERF_FFT_PERIOD && FFT.MaxIndex != PERF_FFT_SIZE - PERF_FFT_SIZE / PERF_FFT_PERIOD) {
+		return PERF_Result_Error;
+	}
+	return PERF_Result_Ok;
+}
+
+/* DMA2D, 4 fills of entire layer */
+static PERF_Result_t DMA2D_Run(void) {
+	TM_DMA2DGRAPHIC_Fill(GRAPHIC_COLOR_BLUE);
+	TM_DMA2DGRAPHIC_Fill(GRAPHIC_COLOR_RED);
+	TM_DMA2DGRAPHIC_Fill(GRAPHIC_COLOR_GREEN);
+	TM_DMA2DGRAPHIC_Fill(GRAPHIC_COLOR_WHITE);
+	TM_DMA2DGRAPHIC_WaitIdle();
+
+	return PERF_Result_Ok;
+}
+
+/* LCD, 8 lines of text with 11x18 font */
+static PERF_Result_t LCD_Run(void) {
+	uint8_t i;
+
+	for (i = 0; i < 8; i++) {
+		TM_LCD_SetXY(5, 5 + i * 20);
+		if (TM_LCD_Puts("TM performance 0123456789") != TM_LCD_Result_Ok) {
+			return PERF_Result_Error;
+		}
+	}
+
+	return PERF_Result_Ok;
+}
+
+/* GPS, recorded NMEA log is written to GPS USART buffer in chunks, each epoch must return new data */
+static PERF_Result_t GPS_Run(void) {
+	TM_BUFFER_t* Buf = TM_USART_GetBuffer(GPS_USART);
+	uint32_t written = 0, epochs = 0;
+
+	while (written < sizeof(NMEA_Log) - 1 || !TM_USART_BufferEmpty(GPS_USART)) {
+		/* Add data as USART interrupt would */
+		if (written < sizeof(NMEA_Log) - 1) {
+			written += TM_BUFFER_Write(Buf, (uint8_t *)&NMEA_Log[written],
+				(sizeof(NMEA_Log) - 1 - written) > PERF_GPS_CHUNK ? PERF_GPS_CHUNK : (sizeof(NMEA_Log) - 1 - written));
+		}
+
+		/* Parse */
+		if (TM_GPS_Update(&GPS_Data) == TM_GPS_Result_NewData) {
+			epochs++;
+		}
+	}
+
+	return epochs == NMEA_LOG_EPOCHS ? PERF_Result_Ok : PERF_Result_Error;
+}
+
+/* FATFS, sequential write of 64kB file in 4kB blocks, including close */
+static PERF_Result_t FATFS_Setup(void) {
+	if (!FS_Mounted) {
+		return PERF_Result_Skip;
+	}
+	if (f_open(&fil, "SD:perf.bin", FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+		return PERF_Result_Skip;
+	}
+	return PERF_Result_Ok;
+}
+static PERF_Result_t FATFS_Run(void) {
+	uint32_t i;
+	UINT bw;
+
+	for (i = 0; i < PERF_FILE_SIZE / PERF_DATA_SIZE; i++) {
+		if (f_write(&fil, Data, PERF_DATA_SIZE, &bw) != FR_OK || bw != PERF_DATA_SIZE) {
+			f_close(&fil);
+			return PERF_Result_Error;
+		}
+	}
+
+	return f_close(&fil) == FR_OK ? PERF_Result_Ok : PERF_Result_Error;
+}
+
+int main(void) {
+	PERF_Result_t res;
+	uint32_t i, cycles, percent, pass = 0, fail = 0, skip = 0;
+
+	/* Init system clock for maximum system speed */
+	TM_RCC_InitSystem();
+
+	/* Init HAL layer */
+	HAL_Init();
+
+	/* Init leds */
+	TM_DISCO_LedInit();
+
+	/* Init delay */
+	TM_DELAY_Init();
+
+	/* Init DWT counter for measurements */
+	TM_GENERAL_DWTCounterEnable();
+
+	/* Fill test data */
+	for (i = 0; i < PERF_DATA_SIZE; i++) {
+		Data[i] = (uint8_t)(i * 7 + (i >> 8));
+	}
+
+	/* Init report output */
+	TM_USART_Init(PERF_REPORT_USART, PERF_REPORT_PINSPACK, PERF_REPORT_BAUDRATE);
+
+	/* Init libraries under test */
+	TM_CRC_Init();
+	TM_FFT_Init_F32(&FFT, PERF_FFT_SIZE, 0);
+	TM_FFT_SetBuffers_F32(&FFT, FFT_Input, FFT_Output);
+	TM_LCD_Init();
+	TM_LCD_SetFont(&TM_Font_11x18);
+	TM_GPS_Init(&GPS_Data, 9600);
+
+	/* Mount card, FATFS test is skipped without card */
+	FS_Mounted = f_mount(&FS, "SD:", 1) == FR_OK;
+
+	/* Report header */
+	sprintf(str, "# TM performance test, core clock %lu Hz, %u runs\n", (unsigned long)SystemCoreClock, (unsigned)PERF_RUNS);
+	PERF_Output(str);
+	PERF_Output("test,cycles,budget,percent,result\n");
+
+	/* Run all tests */
+	for (i = 0; i < sizeof(Tests) / sizeof(Tests[0]); i++) {
+		res = PERF_Measure(&Tests[i], &cycles);
+
+		if (res == PERF_Result_Skip) {
+			sprintf(str, "%s,,%lu,,SKIP\n", Tests[i].Name, (unsigned long)Tests[i].Budget);
+			skip++;
+		} else if (res == PERF_Result_Error) {
+			sprintf(str, "%s,,%lu,,FAIL\n", Tests[i].Name, (unsigned long)Tests[i].Budget);
+			fail++;
+		} else {
+			/* Compare with budget and tolerance */
+			percent = (uint32_t)(((uint64_t)cycles * 100) / Tests[i].Budget);
+			if (percent > 100 + Tests[i].Tolerance) {
+				fail++;
+			} else {
+				pass++;
+			}
+			sprintf(str, "%s,%lu,%lu,%lu,%s\n", Tests[i].Name, (unsigned long)cycles, (unsigned long)Tests[i].Budget,
+				(unsigned long)percent, percent > 100 + Tests[i].Tolerance ? "FAIL" : "PASS");
+		}
+		PERF_Output(str);
+
+#if PERF_CALIBRATE
+		/* Measured value as budget define */
+		if (res == PERF_Result_Ok) {
+			sprintf(str, "# #define %-23s %lu\n", Tests[i].Define, (unsigned long)cycles);
+			PERF_Output(str);
+		}
+#endif
+	}
+
+	/* Summary */
+	sprintf(str, "# PASS %lu, FAIL %lu, SKIP %lu\n", (unsigned long)pass, (unsigned long)fail, (unsigned long)skip);
+	PERF_Output(str);
+	PERF_Output(fail ? "# RESULT: FAIL\n" : "# RESULT: PASS\n");
+
+	/* Show result on leds */
+	if (fail) {
+		TM_DISCO_LedOn(LED_RED);
+	} else {
+		TM_DISCO_LedOn(LED_GREEN);
+	}
+
+	/* Remove test file */
+	if (FS_Mounted) {
+		f_unlink("SD:perf.bin");
+		f_mount(NULL, "SD:", 1);
+	}
+
+	while (1) {
+
+	}
+}
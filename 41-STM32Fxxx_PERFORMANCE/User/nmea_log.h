@@ -0,0 +1,73 @@
+/**
+ * Recorded NMEA output from GPS receiver, 10 epochs at 1 Hz
+ * Each epoch has GPGGA, GPRMC, GPGSA and 3 GPGSV statements
+ */
+#ifndef NMEA_LOG_H
+#define NMEA_LOG_H
+
+/* Number of epochs in log, each one returns new data from TM_GPS_Update */
+#define NMEA_LOG_EPOCHS         10
+
+static const char NMEA_Log[] =
+	"$GPGGA,093512.00,4603.41679,N,01430.34521,E,1,09,0.95,295.0,M,46.5,M,,*57\r\n"
+	"$GPRMC,093512.00,A,4603.41679,N,01430.34521,E,1.500,48.30,141026,,,A*52\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093513.00,4603.41720,N,01430.34584,E,1,09,0.95,295.1,M,46.5,M,,*55\r\n"
+	"$GPRMC,093513.00,A,4603.41720,N,01430.34584,E,1.620,49.30,141026,,,A*51\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093514.00,4603.41761,N,01430.34647,E,1,09,0.95,295.2,M,46.5,M,,*58\r\n"
+	"$GPRMC,093514.00,A,4603.41761,N,01430.34647,E,1.740,50.30,141026,,,A*50\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093515.00,4603.41802,N,01430.34710,E,1,09,0.95,295.3,M,46.5,M,,*51\r\n"
+	"$GPRMC,093515.00,A,4603.41802,N,01430.34710,E,1.860,51.30,141026,,,A*54\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093516.00,4603.41843,N,01430.34773,E,1,09,0.95,295.4,M,46.5,M,,*55\r\n"
+	"$GPRMC,093516.00,A,4603.41843,N,01430.34773,E,1.980,52.30,141026,,,A*5B\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093517.00,4603.41884,N,01430.34836,E,1,09,0.95,295.5,M,46.5,M,,*50\r\n"
+	"$GPRMC,093517.00,A,4603.41884,N,01430.34836,E,2.100,53.30,141026,,,A*5D\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093518.00,4603.41925,N,01430.34899,E,1,09,0.95,295.6,M,46.5,M,,*53\r\n"
+	"$GPRMC,093518.00,A,4603.41925,N,01430.34899,E,2.220,54.30,141026,,,A*5B\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093519.00,4603.41966,N,01430.34962,E,1,09,0.95,295.7,M,46.5,M,,*51\r\n"
+	"$GPRMC,093519.00,A,4603.41966,N,01430.34962,E,2.340,55.30,141026,,,A*5E\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093520.00,4603.42007,N,01430.35025,E,1,09,0.95,295.8,M,46.5,M,,*52\r\n"
+	"$GPRMC,093520.00,A,4603.42007,N,01430.35025,E,2.460,56.30,141026,,,A*54\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n"
+	"$GPGGA,093521.00,4603.42048,N,01430.35088,E,1,09,0.95,295.9,M,46.5,M,,*5E\r\n"
+	"$GPRMC,093521.00,A,4603.42048,N,01430.35088,E,2.580,57.30,141026,,,A*57\r\n"
+	"$GPGSA,A,3,02,05,07,09,13,15,20,21,24,,,,1.62,0.95,1.31*00\r\n"
+	"$GPGSV,3,1,12,02,45,123,42,05,67,045,45,07,12,310,30,09,33,200,38*7C\r\n"
+	"$GPGSV,3,2,12,13,80,010,47,15,22,270,33,18,05,150,,20,55,090,44*71\r\n"
+	"$GPGSV,3,3,12,21,40,060,40,24,18,330,35,26,09,240,28,29,71,180,46*71\r\n";
+
+#endif